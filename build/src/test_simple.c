@@ -0,0 +1,15 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "mgen_error_handling.h"
+#include "mgen_python_ops.h"
+#include "mgen_memory_ops.h"
+
+int add(int x, int y) {
+    return (x + y);
+}
+
+int main() {
+    printf("Hello from MGen-enhanced C code!\n");
+    return 0;
+}
\ No newline at end of file
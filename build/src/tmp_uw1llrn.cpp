@@ -0,0 +1,26 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <set>
+#include <unordered_set>
+#include <algorithm>
+#include <memory>
+#include <cassert>
+#include "runtime/mgen_cpp_runtime.hpp"
+
+using namespace std;
+using namespace mgen;
+
+int simple_test() {
+            std::vector<int> numbers = {};
+            numbers.push_back(10);
+            return mgen::len(numbers);
+}
+
+int main() {
+            auto result = simple_test();
+            mgen::print(result);
+            return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Count a program's heap allocations, for LD_PRELOAD.
+ *
+ * Build: cc -O2 -shared -fPIC -o alloc_count.so alloc_count.c
+ * Use:   MGEN_ALLOC_COUNT_OUTPUT=counts.txt LD_PRELOAD=./alloc_count.so ./program
+ *
+ * Every malloc, calloc, realloc and aligned allocation is counted with its
+ * requested size; at exit "allocations N" and "bytes N" lines are written to
+ * the file named by MGEN_ALLOC_COUNT_OUTPUT. No file is written when the
+ * library was not loaded (e.g. statically linked programs), so callers can
+ * tell "not measured" apart from zero.
+ *
+ * scripts/benchmark.py builds this on demand. It interposes the C library
+ * rather than reading mgen_get_memory_stats(), which only sees mgen_malloc
+ * calls: generated code, STC and the runtime containers allocate with
+ * malloc directly. Requires glibc (__libc_* entry points).
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+
+static atomic_size_t allocation_count;
+static atomic_size_t allocated_bytes;
+
+static void record(size_t size) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocated_bytes, size, memory_order_relaxed);
+}
+
+void* malloc(size_t size) {
+    record(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    record(count * size);
+    return __libc_calloc(count, size);
+}
+
+// A realloc may move the block, so it counts as an allocation of the new size
+void* realloc(void* ptr, size_t size) {
+    record(size);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    record(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    record(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    record(size);
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return 12;  // ENOMEM
+    }
+    *out = ptr;
+    return 0;
+}
+
+// Written with write(2) so reporting does not allocate
+__attribute__((destructor)) static void write_counts(void) {
+    const char* path = getenv("MGEN_ALLOC_COUNT_OUTPUT");
+    if (!path || !*path) {
+        return;
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    char buffer[96];
+    int length = snprintf(buffer, sizeof(buffer), "allocations %zu\nbytes %zu\n",
+                          atomic_load_explicit(&allocation_count, memory_order_relaxed),
+                          atomic_load_explicit(&allocated_bytes, memory_order_relaxed));
+    if (length > 0 && write(fd, buffer, (size_t)length) < 0) {
+        length = 0;
+    }
+    close(fd);
+}
@@ -2,35 +2,58 @@
 """Automated benchmark runner for MGen backends.
 
 This script runs benchmarks across all backends and collects performance metrics:
-- Execution time (wall clock)
+- Execution time (wall clock): median and p95 over repeated runs after
+  warmup, with bootstrap confidence intervals, optionally pinned to one CPU
+- Hardware counters from `perf stat` where available (cycles,
+  instructions, cache misses)
+- Scaling: benchmarks that declare `scale: int = 1` in main() are run at
+  every size given with --scales (e.g. 1 10 100)
 - Compilation time
 - Binary size
 - Lines of generated code
-- Memory usage (basic)
+- Peak resident set size, from one extra run under scripts/peak_rss.c
+- Heap allocation count and bytes, from one extra run with
+  scripts/alloc_count.c preloaded (glibc, dynamically linked binaries)
+- With --compare, a regression gate against a stored baseline
+  (see benchmark_compare.py)
+
+Backend preferences given with --prefer apply to every backend that has
+them, e.g. `--backends c --prefer use_stc_containers=false` benchmarks the
+C backend's hand-written containers instead of STC.
 """
 
 import argparse
 import json
+import os
+import re
 import shutil
 import subprocess
 import sys
+import tempfile
 import time
 from pathlib import Path
-from typing import Any
+from typing import Any, Optional
+
+from benchmark_compare import add_threshold_arguments, gate, save_baseline, thresholds_from_args
+from benchmark_stats import bootstrap_ci, median, percentile
 
 # Add parent directory to path for imports
 sys.path.insert(0, str(Path(__file__).parent.parent / "src"))
 
 from mgen.pipeline import MGenPipeline, PipelineConfig, BuildMode, OptimizationLevel
+from mgen.backends.preferences import PreferencesRegistry
 from mgen.backends.registry import registry
 
 
 class BenchmarkMetrics:
     """Container for benchmark metrics."""
 
-    def __init__(self, name: str, backend: str):
+    def __init__(self, name: str, backend: str, benchmark: Optional[str] = None, scale: int = 1):
         self.name = name
         self.backend = backend
+        # Unscaled benchmark name and input size multiplier (name is e.g. matmul_x10)
+        self.benchmark = benchmark or name
+        self.scale = scale
         self.compilation_time: float = 0.0
         self.execution_time: float = 0.0
         self.binary_size: int = 0
@@ -38,15 +61,64 @@ class BenchmarkMetrics:
         self.success: bool = False
         self.output: str = ""
         self.error: str = ""
+        # Per-run wall clock times; execution_time is their median
+        self.execution_samples: list[float] = []
+        self.execution_time_p95: float = 0.0
+        self.execution_time_ci: tuple[float, float] = (0.0, 0.0)
+        # perf stat event -> count, for one extra run
+        self.counters: dict[str, float] = {}
+        # Peak resident set size in bytes, 0 if not measured
+        self.peak_rss: int = 0
+        # Heap allocations and bytes requested over one run, None if not measured
+        self.allocations: Optional[int] = None
+        self.allocated_bytes: Optional[int] = None
+
+
+# Hardware events collected with perf stat
+PERF_EVENTS = ["cycles", "instructions", "cache-references", "cache-misses", "branch-misses"]
+
+# Per-run timeout in seconds
+RUN_TIMEOUT = 30
+
+# The input size declaration a benchmark's main() uses to opt into --scales
+SCALE_PATTERN = re.compile(r"^(\s*)scale: int = 1$", re.MULTILINE)
 
 
 class BenchmarkRunner:
     """Automated benchmark runner for all backends."""
 
-    def __init__(self, output_dir: Path):
+    def __init__(
+        self,
+        output_dir: Path,
+        warmup: int = 1,
+        repetitions: int = 10,
+        cpu: Optional[int] = None,
+        perf: bool = True,
+        confidence: float = 0.95,
+        preferences: Optional[dict[str, Any]] = None,
+    ):
+        """Initialize the runner.
+
+        Args:
+            output_dir: Directory for generated code, binaries and reports
+            warmup: Untimed runs before measuring (page cache, CPU frequency)
+            repetitions: Timed runs per benchmark
+            cpu: CPU to pin benchmark processes to, or None to not pin
+            perf: Collect perf stat counters when perf is installed
+            confidence: Coverage of the reported confidence intervals
+            preferences: Backend preference overrides, applied where a backend has the key
+        """
         self.output_dir = output_dir
         self.output_dir.mkdir(exist_ok=True)
         self.results: list[BenchmarkMetrics] = []
+        self.warmup = warmup
+        self.repetitions = max(repetitions, 1)
+        self.cpu = cpu
+        self.confidence = confidence
+        self.perf_command = shutil.which("perf") if perf else None
+        self.preferences = preferences or {}
+        # Helper source -> built file, None if it could not be built
+        self._helpers: dict[str, Optional[Path]] = {}
 
     def copy_runtime_libraries(self, build_dir: Path, backend: str) -> None:
         """Copy runtime libraries for the backend."""
@@ -177,7 +249,8 @@ class BenchmarkRunner:
             # Step 1: Generate code only (no build)
             config = PipelineConfig(
                 target_language=backend,
-                build_mode=BuildMode.NONE
+                build_mode=BuildMode.NONE,
+                backend_preferences=self.backend_preferences(backend),
             )
 
             pipeline = MGenPipeline(config=config, target_language=backend)
@@ -209,6 +282,14 @@ class BenchmarkRunner:
             compilation_time = time.time() - start_time
             return False, compilation_time, str(e), None
 
+    def backend_preferences(self, backend: str) -> Any:
+        """Default preferences of backend with the --prefer overrides it knows applied."""
+        preferences = PreferencesRegistry.create_preferences(backend)
+        for key, value in self.preferences.items():
+            if preferences.get(key) is not None:
+                preferences.set(key, value)
+        return preferences
+
     def _manual_compile(self, backend: str, source_file: Path, output_dir: Path, executable_name: str) -> tuple[bool, str]:
         """Manually compile generated code.
 
@@ -236,6 +317,7 @@ class BenchmarkRunner:
                     f"-I{output_dir.absolute()}",
                     f"-I{runtime_path.absolute()}",
                     f"-I{c_backend_path.absolute()}",
+                    f"-I{(c_backend_path / 'ext' / 'stc' / 'include').absolute()}",
                     str(source_file.absolute()),
                     *[str(f.absolute()) for f in runtime_c_files],
                     "-o", str((output_dir / executable_name).absolute())
@@ -375,38 +457,177 @@ class BenchmarkRunner:
         except Exception as e:
             return False, str(e)
 
-    def run_benchmark(
-        self, backend: str, benchmark_name: str
-    ) -> tuple[bool, float, str, str]:
-        """Run a compiled benchmark and measure execution time."""
-        binary = self.find_binary(backend, benchmark_name)
-        if not binary:
-            return False, 0.0, "", "Binary not found"
+    def _pinned_command(self, command: list[str]) -> tuple[list[str], Any]:
+        """Apply CPU pinning to a command.
+
+        Returns:
+            (command, preexec_fn) for subprocess.run
+        """
+        if self.cpu is None:
+            return command, None
+        if hasattr(os, "sched_setaffinity"):
+            cpu = self.cpu
+            return command, lambda: os.sched_setaffinity(0, {cpu})
+        if shutil.which("taskset"):
+            return ["taskset", "-c", str(self.cpu), *command], None
+        return command, None
+
+    def _run_once(self, binary: Path, wrapper: Optional[list[str]] = None) -> tuple[subprocess.CompletedProcess, float]:
+        """Run a binary once and return its result and wall clock time."""
+        command, preexec_fn = self._pinned_command([*(wrapper or []), str(binary)])
+        start_time = time.perf_counter()
+        result = subprocess.run(
+            command,
+            capture_output=True,
+            text=True,
+            timeout=RUN_TIMEOUT,
+            cwd=binary.parent,
+            preexec_fn=preexec_fn,
+        )
+        return result, time.perf_counter() - start_time
+
+    def collect_counters(self, binary: Path) -> dict[str, float]:
+        """Run a binary under perf stat and return its hardware counters.
+
+        This is a separate run, so perf's overhead does not skew the timings.
+        Events the CPU or kernel does not support are left out.
+        """
+        if not self.perf_command:
+            return {}
+        with tempfile.NamedTemporaryFile(suffix=".csv") as stat_file:
+            wrapper = [self.perf_command, "stat", "-x", ",", "-e", ",".join(PERF_EVENTS), "-o", stat_file.name]
+            try:
+                result, _ = self._run_once(binary, wrapper)
+            except (subprocess.TimeoutExpired, OSError):
+                return {}
+            if result.returncode != 0:
+                return {}
+            return parse_perf_stat(Path(stat_file.name).read_text())
+
+    def build_helper(self, source_name: str, output_name: str, *flags: str) -> Optional[Path]:
+        """Compile a measurement helper from scripts/ once per run.
 
+        Returns:
+            The built file, or None without a C compiler or if it fails to build
+        """
+        if source_name not in self._helpers:
+            self._helpers[source_name] = None
+            compiler = next((shutil.which(cc) for cc in ("cc", "gcc", "clang") if shutil.which(cc)), None)
+            output = self.output_dir / output_name
+            if compiler:
+                result = subprocess.run(
+                    [compiler, "-O2", *flags, "-o", str(output), str(Path(__file__).parent / source_name)],
+                    capture_output=True,
+                )
+                if result.returncode == 0:
+                    self._helpers[source_name] = output
+        return self._helpers[source_name]
+
+    def measure_peak_rss(self, binary: Path) -> int:
+        """Run a binary once more and return its peak resident set size in bytes.
+
+        Returns 0 if the helper could not be built or the run fails.
+        """
+        helper = self.build_helper("peak_rss.c", "peak_rss")
+        if helper is None:
+            return 0
+        command, preexec_fn = self._pinned_command([str(helper), str(binary)])
         try:
-            # Run the binary and measure time
-            start_time = time.time()
             result = subprocess.run(
-                [str(binary)],
-                capture_output=True,
-                text=True,
-                timeout=30,
-                cwd=binary.parent,
+                command, capture_output=True, text=True, timeout=RUN_TIMEOUT, cwd=binary.parent, preexec_fn=preexec_fn
             )
-            execution_time = time.time() - start_time
+        except (subprocess.TimeoutExpired, OSError):
+            return 0
+        if result.returncode != 0 or not result.stdout.strip().isdigit():
+            return 0
+        return int(result.stdout) * 1024
 
-            success = result.returncode == 0
-            return success, execution_time, result.stdout.strip(), result.stderr
+    def count_allocations(self, binary: Path) -> Optional[tuple[int, int]]:
+        """Run a binary once more with scripts/alloc_count.c preloaded.
 
+        Returns:
+            (allocations, bytes allocated), or None where the library cannot
+            be preloaded (non-glibc platforms, statically linked binaries)
+        """
+        if not sys.platform.startswith("linux"):
+            return None
+        library = self.build_helper("alloc_count.c", "alloc_count.so", "-shared", "-fPIC")
+        if library is None:
+            return None
+        with tempfile.TemporaryDirectory() as temp_dir:
+            counts_file = Path(temp_dir) / "counts.txt"
+            env = {**os.environ, "LD_PRELOAD": str(library.resolve()), "MGEN_ALLOC_COUNT_OUTPUT": str(counts_file)}
+            command, preexec_fn = self._pinned_command([str(binary)])
+            try:
+                result = subprocess.run(
+                    command, capture_output=True, timeout=RUN_TIMEOUT, cwd=binary.parent, env=env, preexec_fn=preexec_fn
+                )
+            except (subprocess.TimeoutExpired, OSError):
+                return None
+            if result.returncode != 0 or not counts_file.exists():
+                return None
+            counts = dict(line.split() for line in counts_file.read_text().splitlines() if line.strip())
+        return int(counts["allocations"]), int(counts["bytes"])
+
+    def run_benchmark(self, binary: Path, metrics: BenchmarkMetrics) -> None:
+        """Run a compiled benchmark repeatedly and record its timing statistics.
+
+        Fills metrics' success, output, error, execution statistics, peak
+        RSS, allocation counts and counters. A run that fails or times out stops the measurement.
+        """
+        try:
+            for _ in range(self.warmup):
+                self._run_once(binary)
+
+            samples = []
+            for _ in range(self.repetitions):
+                result, elapsed = self._run_once(binary)
+                if result.returncode != 0:
+                    metrics.error = result.stderr
+                    metrics.output = result.stdout.strip()
+                    return
+                samples.append(elapsed)
         except subprocess.TimeoutExpired:
-            return False, 30.0, "", "Timeout (30s)"
+            metrics.error = f"Timeout ({RUN_TIMEOUT}s)"
+            return
         except Exception as e:
-            return False, 0.0, "", str(e)
+            metrics.error = str(e)
+            return
+
+        metrics.success = True
+        metrics.output = result.stdout.strip()
+        metrics.execution_samples = samples
+        metrics.execution_time = median(samples)
+        metrics.execution_time_p95 = percentile(samples, 95)
+        metrics.execution_time_ci = bootstrap_ci(samples, median, self.confidence)
+        metrics.peak_rss = self.measure_peak_rss(binary)
+        allocation_counts = self.count_allocations(binary)
+        if allocation_counts is not None:
+            metrics.allocations, metrics.allocated_bytes = allocation_counts
+        metrics.counters = self.collect_counters(binary)
+
+    def scaled_source(self, source_file: Path, scale: int) -> Optional[Path]:
+        """Write a copy of a benchmark with its input size multiplied by scale.
 
-    def benchmark_single(self, source_file: Path, backend: str) -> BenchmarkMetrics:
+        Returns:
+            The source itself for scale 1, the copy (named <stem>_x<scale>.py),
+            or None if the benchmark does not declare a scale
+        """
+        if scale == 1:
+            return source_file
+        source = source_file.read_text()
+        if not SCALE_PATTERN.search(source):
+            return None
+        scaled_dir = self.output_dir / "scaled"
+        scaled_dir.mkdir(parents=True, exist_ok=True)
+        scaled_file = scaled_dir / f"{source_file.stem}_x{scale}.py"
+        scaled_file.write_text(SCALE_PATTERN.sub(rf"\1scale: int = {scale}", source, count=1))
+        return scaled_file
+
+    def benchmark_single(self, source_file: Path, backend: str, scale: int = 1) -> BenchmarkMetrics:
         """Run a single benchmark for a specific backend."""
         benchmark_name = source_file.stem
-        metrics = BenchmarkMetrics(benchmark_name, backend)
+        metrics = BenchmarkMetrics(benchmark_name, backend, benchmark_name.removesuffix(f"_x{scale}"), scale)
 
         print(f"  [{backend}] {benchmark_name}...", end=" ", flush=True)
 
@@ -432,51 +653,41 @@ class BenchmarkRunner:
         if binary and binary.exists():
             metrics.binary_size = self.get_binary_size(binary)
 
-            # Run benchmark
-            try:
-                start_time = time.time()
-                proc_result = subprocess.run(
-                    [str(binary)],
-                    capture_output=True,
-                    text=True,
-                    timeout=30,
-                    cwd=binary.parent,
+            self.run_benchmark(binary, metrics)
+            if metrics.success:
+                low, high = metrics.execution_time_ci
+                print(
+                    f"OK ({comp_time:.2f}s compile, {metrics.execution_time:.3f}s run "
+                    f"[{low:.3f}, {high:.3f}], {metrics.binary_size // 1024}KB)"
                 )
-                exec_time = time.time() - start_time
-
-                metrics.execution_time = exec_time
-                metrics.output = proc_result.stdout.strip()
-                metrics.success = proc_result.returncode == 0
-
-                if not metrics.success:
-                    metrics.error = proc_result.stderr
-                    print(f"RUN FAILED ({comp_time:.2f}s compile)")
-                else:
-                    print(
-                        f"OK ({comp_time:.2f}s compile, {exec_time:.3f}s run, {metrics.binary_size // 1024}KB)"
-                    )
-            except subprocess.TimeoutExpired:
-                metrics.error = "Timeout (30s)"
+            elif metrics.error.startswith("Timeout"):
                 print(f"TIMEOUT ({comp_time:.2f}s compile)")
-            except Exception as e:
-                metrics.error = str(e)
-                print(f"ERROR ({comp_time:.2f}s compile)")
+            else:
+                print(f"RUN FAILED ({comp_time:.2f}s compile)")
         else:
             metrics.error = f"Binary not found (searched in {self.output_dir / backend / benchmark_name})"
             print(f"BINARY NOT FOUND ({comp_time:.2f}s compile)")
 
         return metrics
 
-    def benchmark_all(self, benchmark_files: list[Path], backends: list[str]) -> None:
-        """Run all benchmarks for all backends."""
+    def benchmark_all(
+        self, benchmark_files: list[Path], backends: list[str], scales: Optional[list[int]] = None
+    ) -> None:
+        """Run all benchmarks for all backends, at every input size in scales."""
+        scales = scales or [1]
         print(f"\nRunning {len(benchmark_files)} benchmarks across {len(backends)} backends...\n")
 
         for benchmark_file in benchmark_files:
-            print(f"Benchmark: {benchmark_file.stem}")
-            for backend in backends:
-                metrics = self.benchmark_single(benchmark_file, backend)
-                self.results.append(metrics)
-            print()
+            for scale in scales:
+                source_file = self.scaled_source(benchmark_file, scale)
+                if source_file is None:
+                    print(f"Benchmark: {benchmark_file.stem} (no scale parameter, skipping {scale}x)\n")
+                    continue
+                print(f"Benchmark: {benchmark_file.stem} ({scale}x)")
+                for backend in backends:
+                    metrics = self.benchmark_single(source_file, backend, scale)
+                    self.results.append(metrics)
+                print()
 
     def generate_summary(self) -> dict[str, Any]:
         """Generate summary statistics."""
@@ -523,15 +734,32 @@ class BenchmarkRunner:
     def save_json_report(self, output_file: Path) -> None:
         """Save detailed results as JSON."""
         data = {
+            "config": {
+                "warmup": self.warmup,
+                "repetitions": self.repetitions,
+                "cpu": self.cpu,
+                "confidence": self.confidence,
+                "perf": self.perf_command is not None,
+                "scales": sorted({m.scale for m in self.results}),
+            },
             "summary": self.generate_summary(),
             "results": [
                 {
                     "name": m.name,
+                    "benchmark": m.benchmark,
+                    "scale": m.scale,
                     "backend": m.backend,
                     "success": m.success,
                     "compilation_time": m.compilation_time,
                     "execution_time": m.execution_time,
+                    "execution_time_p95": m.execution_time_p95,
+                    "execution_time_ci": list(m.execution_time_ci),
+                    "execution_samples": m.execution_samples,
+                    "counters": m.counters,
                     "binary_size": m.binary_size,
+                    "peak_rss": m.peak_rss,
+                    "allocations": m.allocations,
+                    "allocated_bytes": m.allocated_bytes,
                     "lines_of_code": m.lines_of_code,
                     "output": m.output,
                     "error": m.error,
@@ -577,6 +805,36 @@ class BenchmarkRunner:
         print("=" * 80)
 
 
+def parse_perf_stat(text: str) -> dict[str, float]:
+    """Parse `perf stat -x ,` output into event -> count.
+
+    Lines are value,unit,event,...; unsupported or uncounted events have a
+    non-numeric value and are skipped.
+    """
+    counters: dict[str, float] = {}
+    for line in text.splitlines():
+        fields = line.split(",")
+        if len(fields) < 3 or line.startswith("#"):
+            continue
+        try:
+            value = float(fields[0])
+        except ValueError:
+            continue
+        # Hybrid CPUs report e.g. cpu_core/cycles/
+        event = fields[2].split("/")[-2] if fields[2].endswith("/") else fields[2]
+        counters[event] = counters.get(event, 0.0) + value
+    return counters
+
+
+def parse_preference_value(value: str) -> Any:
+    """Convert a --prefer value to bool or int where it reads as one, like the mgen CLI."""
+    if value.lower() in ("true", "false"):
+        return value.lower() == "true"
+    if value.isdigit():
+        return int(value)
+    return value
+
+
 def main():
     """Main entry point."""
     parser = argparse.ArgumentParser(description="Run MGen benchmarks")
@@ -602,13 +860,80 @@ def main():
     parser.add_argument(
         "--category",
         type=str,
-        choices=["algorithms", "data_structures", "all"],
+        choices=["algorithms", "data_structures", "real_world", "all"],
         default="all",
         help="Benchmark category to run",
     )
 
+    parser.add_argument(
+        "--scales",
+        type=int,
+        nargs="+",
+        default=[1],
+        help="Input size multipliers to run each scalable benchmark at (default: 1)",
+    )
+    parser.add_argument(
+        "--warmup",
+        type=int,
+        default=1,
+        help="Untimed runs before measuring (default: 1)",
+    )
+    parser.add_argument(
+        "--repetitions",
+        type=int,
+        default=10,
+        help="Timed runs per benchmark (default: 10)",
+    )
+    parser.add_argument(
+        "--cpu",
+        type=int,
+        default=None,
+        help="Pin benchmark processes to this CPU (default: no pinning)",
+    )
+    parser.add_argument(
+        "--no-perf",
+        action="store_true",
+        help="Do not collect perf stat hardware counters",
+    )
+    parser.add_argument(
+        "--confidence",
+        type=float,
+        default=0.95,
+        help="Confidence level of the reported intervals (default: 0.95)",
+    )
+    parser.add_argument(
+        "--compare",
+        type=str,
+        default=None,
+        metavar="BASELINE",
+        help="Compare against a baseline file and exit non-zero on regressions",
+    )
+    parser.add_argument(
+        "--save-baseline",
+        type=str,
+        default=None,
+        metavar="BASELINE",
+        help="Store this run's results as the baseline (merged per backend and benchmark)",
+    )
+    parser.add_argument(
+        "--prefer",
+        action="append",
+        default=[],
+        metavar="KEY=VALUE",
+        help="Backend preference override, repeatable (e.g. --prefer use_stc_containers=false)",
+    )
+    add_threshold_arguments(parser)
+
     args = parser.parse_args()
 
+    preferences: dict[str, Any] = {}
+    for preference in args.prefer:
+        key, separator, value = preference.partition("=")
+        if not separator:
+            print(f"Error: Invalid preference (expected KEY=VALUE): {preference}")
+            return 1
+        preferences[key.strip()] = parse_preference_value(value.strip())
+
     # Get benchmark files
     benchmark_dir = Path(args.benchmarks)
     if not benchmark_dir.exists():
@@ -632,13 +957,33 @@ def main():
 
     # Create runner and run benchmarks
     output_dir = Path(args.output)
-    runner = BenchmarkRunner(output_dir)
+    runner = BenchmarkRunner(
+        output_dir,
+        warmup=args.warmup,
+        repetitions=args.repetitions,
+        cpu=args.cpu,
+        perf=not args.no_perf,
+        confidence=args.confidence,
+        preferences=preferences,
+    )
 
-    runner.benchmark_all(benchmark_files, backends)
+    runner.benchmark_all(benchmark_files, backends, args.scales)
     runner.print_summary()
     runner.save_json_report(output_dir / "benchmark_results.json")
 
-    return 0
+    data = json.loads((output_dir / "benchmark_results.json").read_text())
+    status = 0
+    if args.compare:
+        baseline_file = Path(args.compare)
+        if not baseline_file.exists():
+            print(f"Error: Baseline file not found: {baseline_file}")
+            return 1
+        status = gate(data, baseline_file, thresholds_from_args(args), args.confidence)
+    if args.save_baseline:
+        save_baseline(data, Path(args.save_baseline))
+        print(f"Baseline saved to: {args.save_baseline}")
+
+    return status
 
 
 if __name__ == "__main__":
@@ -0,0 +1,254 @@
+#!/usr/bin/env python3
+"""Performance regression gate for benchmark results.
+
+Compares a benchmark run against a stored baseline and fails when a metric
+regresses beyond its threshold:
+
+- execution_time: median run time; the change must also be significant
+  (its bootstrap confidence interval excludes zero), so noise alone does
+  not fail the gate
+- binary_size: size of the compiled binary
+- peak_rss: peak resident set size of one run
+
+A baseline file holds one entry per backend and benchmark, so it can be
+refreshed for a single backend without rerunning the others:
+
+    {"version": 1, "baselines": {"cpp": {"matmul": {"execution_time": ..., ...}}}}
+
+A full benchmark_results.json is accepted as a baseline too.
+
+Usage:
+    python scripts/benchmark_compare.py current.json baseline.json
+    python scripts/benchmark_compare.py current.json --save-baseline baseline.json
+"""
+
+import argparse
+import json
+import sys
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Optional
+
+from benchmark_stats import relative_change_ci
+
+BASELINE_VERSION = 1
+
+# Largest tolerated relative increase of each metric (0.10 = 10%)
+DEFAULT_THRESHOLDS = {"execution_time": 0.10, "binary_size": 0.05, "peak_rss": 0.10}
+
+# Result fields stored in a baseline entry
+BASELINE_FIELDS = ("execution_time", "execution_samples", "binary_size", "peak_rss")
+
+
+@dataclass
+class MetricChange:
+    """Change of one metric of one benchmark between baseline and current run."""
+
+    metric: str
+    baseline: float
+    current: float
+    change: float
+    regressed: bool
+
+
+@dataclass
+class BenchmarkDiff:
+    """Comparison of one benchmark on one backend."""
+
+    name: str
+    backend: str
+    changes: dict[str, MetricChange]
+    # Succeeded in the baseline but failed now
+    failed: bool = False
+
+    @property
+    def regressed(self) -> bool:
+        """Whether any metric regressed or the benchmark stopped working."""
+        return self.failed or any(change.regressed for change in self.changes.values())
+
+
+def baseline_from_results(data: dict, existing: Optional[dict] = None) -> dict:
+    """Build a baseline file from a results file.
+
+    Args:
+        data: Parsed benchmark_results.json
+        existing: Baseline to update; entries of backends and benchmarks not
+            in data are kept
+
+    Returns:
+        Baseline file contents
+    """
+    baseline = existing or {"version": BASELINE_VERSION, "baselines": {}}
+    for result in data["results"]:
+        if result["success"]:
+            entry = {field: result[field] for field in BASELINE_FIELDS if field in result}
+            baseline["baselines"].setdefault(result["backend"], {})[result["name"]] = entry
+    return baseline
+
+
+def load_baseline(path: Path) -> dict[tuple[str, str], dict]:
+    """Load a baseline or results file as (benchmark, backend) -> metrics."""
+    data = json.loads(path.read_text())
+    if "baselines" in data:
+        return {
+            (name, backend): entry
+            for backend, entries in data["baselines"].items()
+            for name, entry in entries.items()
+        }
+    return {(result["name"], result["backend"]): result for result in data["results"] if result["success"]}
+
+
+def save_baseline(data: dict, path: Path) -> None:
+    """Store the successful results of a run as the baseline at path, merging with an existing one."""
+    existing = None
+    if path.exists():
+        previous = json.loads(path.read_text())
+        if "baselines" in previous:
+            existing = previous
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(json.dumps(baseline_from_results(data, existing), indent=2) + "\n")
+
+
+def compare_results(
+    results: list[dict],
+    baseline: dict[tuple[str, str], dict],
+    thresholds: Optional[dict[str, float]] = None,
+    confidence: float = 0.95,
+) -> list[BenchmarkDiff]:
+    """Compare results against a baseline.
+
+    Benchmarks without a baseline entry are skipped. Metrics missing or zero
+    on either side (e.g. peak RSS on a platform without wait4) are not compared.
+
+    Returns:
+        One diff per benchmark and backend present in both
+    """
+    limits = {**DEFAULT_THRESHOLDS, **(thresholds or {})}
+    diffs = []
+    for result in sorted(results, key=lambda r: (r["name"], r["backend"])):
+        previous = baseline.get((result["name"], result["backend"]))
+        if previous is None:
+            continue
+        if not result["success"]:
+            diffs.append(BenchmarkDiff(result["name"], result["backend"], {}, failed=True))
+            continue
+
+        changes = {}
+        delta = relative_change_ci(_samples(previous), _samples(result), confidence)
+        if delta is not None:
+            change, low, _ = delta
+            changes["execution_time"] = MetricChange(
+                "execution_time",
+                previous["execution_time"],
+                result["execution_time"],
+                change,
+                change > limits["execution_time"] and low > 0,
+            )
+        for metric in ("binary_size", "peak_rss"):
+            before, after = previous.get(metric) or 0, result.get(metric) or 0
+            if before > 0 and after > 0:
+                change = after / before - 1
+                changes[metric] = MetricChange(metric, before, after, change, change > limits[metric])
+        diffs.append(BenchmarkDiff(result["name"], result["backend"], changes))
+    return diffs
+
+
+def diff_table(diffs: list[BenchmarkDiff]) -> list[str]:
+    """Format diffs as a fixed-width table, one row per benchmark and backend.
+
+    Regressed metrics are marked with "!".
+    """
+    lines = [
+        f"{'Benchmark':<24} {'Backend':<8} {'Time':>10} {'Binary':>10} {'Peak RSS':>10}  Status",
+        "-" * 76,
+    ]
+    for diff in diffs:
+        if diff.failed:
+            cells = ["-", "-", "-"]
+        else:
+            cells = [_cell(diff.changes.get(metric)) for metric in ("execution_time", "binary_size", "peak_rss")]
+        status = "FAILED" if diff.failed else ("REGRESSED" if diff.regressed else "ok")
+        lines.append(f"{diff.name:<24} {diff.backend:<8} {cells[0]:>10} {cells[1]:>10} {cells[2]:>10}  {status}")
+    return lines
+
+
+def _cell(change: Optional[MetricChange]) -> str:
+    """Format one metric change as a signed percentage."""
+    if change is None:
+        return "-"
+    return f"{'!' if change.regressed else ''}{change.change * 100:+.1f}%"
+
+
+def _samples(result: dict) -> list[float]:
+    """Run time samples of a result, falling back to its single execution time."""
+    return result.get("execution_samples") or [result["execution_time"]]
+
+
+def gate(
+    data: dict, baseline_path: Path, thresholds: Optional[dict[str, float]] = None, confidence: float = 0.95
+) -> int:
+    """Print the diff of a run against a baseline file.
+
+    Returns:
+        Exit status: 1 if anything regressed, else 0
+    """
+    diffs = compare_results(data["results"], load_baseline(baseline_path), thresholds, confidence)
+    print(f"\nComparison with baseline {baseline_path}:")
+    if not diffs:
+        print("No benchmarks in common with the baseline")
+        return 0
+    for line in diff_table(diffs):
+        print(line)
+    regressed = [diff for diff in diffs if diff.regressed]
+    if regressed:
+        print(f"\n{len(regressed)} of {len(diffs)} benchmarks regressed")
+        return 1
+    print(f"\nNo regressions in {len(diffs)} benchmarks")
+    return 0
+
+
+def add_threshold_arguments(parser: argparse.ArgumentParser) -> None:
+    """Add the --*-threshold options shared with scripts/benchmark.py."""
+    for metric, flag in (("execution_time", "time"), ("binary_size", "size"), ("peak_rss", "rss")):
+        parser.add_argument(
+            f"--{flag}-threshold",
+            type=float,
+            default=DEFAULT_THRESHOLDS[metric],
+            help=f"Tolerated relative {metric.replace('_', ' ')} increase (default: {DEFAULT_THRESHOLDS[metric]})",
+        )
+
+
+def thresholds_from_args(args: argparse.Namespace) -> dict[str, float]:
+    """Collect the threshold options into compare_results' format."""
+    return {"execution_time": args.time_threshold, "binary_size": args.size_threshold, "peak_rss": args.rss_threshold}
+
+
+def main() -> int:
+    """Main entry point."""
+    parser = argparse.ArgumentParser(description="Compare benchmark results against a baseline")
+    parser.add_argument("results", type=Path, help="benchmark_results.json of the current run")
+    parser.add_argument("baseline", type=Path, nargs="?", help="Baseline or results file to compare against")
+    parser.add_argument("--save-baseline", type=Path, help="Store the current results as the baseline at this path")
+    add_threshold_arguments(parser)
+    args = parser.parse_args()
+
+    if not args.results.exists():
+        print(f"Error: Results file not found: {args.results}")
+        return 1
+    data = json.loads(args.results.read_text())
+    confidence = data.get("config", {}).get("confidence", 0.95)
+
+    status = 0
+    if args.baseline is not None:
+        if not args.baseline.exists():
+            print(f"Error: Baseline file not found: {args.baseline}")
+            return 1
+        status = gate(data, args.baseline, thresholds_from_args(args), confidence)
+    if args.save_baseline is not None:
+        save_baseline(data, args.save_baseline)
+        print(f"Baseline saved to: {args.save_baseline}")
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
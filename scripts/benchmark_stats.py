@@ -0,0 +1,82 @@
+"""Statistics helpers shared by the benchmark runner and report generator.
+
+Run times are not normally distributed (they have a hard lower bound and a
+long tail of interrupted runs), so benchmarks are summarized by their median
+and 95th percentile, with percentile-bootstrap confidence intervals instead
+of mean +/- standard deviation.
+"""
+
+import random
+from typing import Callable, Optional
+
+# Seed for bootstrap resampling, so reports are reproducible
+BOOTSTRAP_SEED = 0x6D67656E
+
+
+def percentile(values: list[float], q: float) -> float:
+    """Return the q-th percentile (0-100) with linear interpolation."""
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    position = (len(ordered) - 1) * q / 100
+    lower = int(position)
+    upper = min(lower + 1, len(ordered) - 1)
+    return ordered[lower] + (ordered[upper] - ordered[lower]) * (position - lower)
+
+
+def median(values: list[float]) -> float:
+    """Return the median of values."""
+    return percentile(values, 50)
+
+
+def bootstrap_ci(
+    values: list[float],
+    statistic: Callable[[list[float]], float] = median,
+    confidence: float = 0.95,
+    resamples: int = 1000,
+) -> tuple[float, float]:
+    """Percentile-bootstrap confidence interval of a statistic.
+
+    Args:
+        values: Samples
+        statistic: Function of a sample list
+        confidence: Coverage of the interval (0-1)
+        resamples: Number of bootstrap resamples
+
+    Returns:
+        (low, high); both equal the statistic when there are fewer than two samples
+    """
+    if len(values) < 2:
+        point = statistic(values) if values else 0.0
+        return point, point
+    rng = random.Random(BOOTSTRAP_SEED)
+    estimates = [statistic(rng.choices(values, k=len(values))) for _ in range(resamples)]
+    tail = (1 - confidence) / 2 * 100
+    return percentile(estimates, tail), percentile(estimates, 100 - tail)
+
+
+def relative_change_ci(
+    baseline: list[float], current: list[float], confidence: float = 0.95, resamples: int = 1000
+) -> Optional[tuple[float, float, float]]:
+    """Relative change of the median from baseline to current, with a bootstrap interval.
+
+    Both sample sets are resampled independently, so the interval accounts
+    for the noise of both runs.
+
+    Returns:
+        (change, low, high) as fractions (0.05 = 5% slower), or None without
+        baseline samples
+    """
+    base_median = median(baseline)
+    if not baseline or not current or base_median <= 0:
+        return None
+    change = median(current) / base_median - 1
+
+    rng = random.Random(BOOTSTRAP_SEED)
+    estimates = []
+    for _ in range(resamples):
+        base = median(rng.choices(baseline, k=len(baseline)))
+        if base > 0:
+            estimates.append(median(rng.choices(current, k=len(current))) / base - 1)
+    tail = (1 - confidence) / 2 * 100
+    return change, percentile(estimates, tail), percentile(estimates, 100 - tail)
@@ -1,11 +1,19 @@
 #!/usr/bin/env python3
-"""Generate Markdown report from benchmark JSON results."""
+"""Generate Markdown report from benchmark JSON results.
+
+With --baseline, run times are compared against an earlier results file and
+each change is reported with a bootstrap confidence interval; a change is
+significant when its interval excludes zero.
+"""
 
 import argparse
 import json
 import sys
 from datetime import datetime
 from pathlib import Path
+from typing import Optional
+
+from benchmark_stats import relative_change_ci
 
 
 def format_time(seconds: float) -> str:
@@ -28,7 +36,130 @@ def format_size(bytes_val: int | float) -> str:
         return f"{bytes_val / (1024 * 1024):.1f}MB"
 
 
-def generate_markdown_report(json_file: Path, output_file: Path) -> None:
+def format_change(change: float) -> str:
+    """Format a relative change as a signed percentage."""
+    return f"{change * 100:+.1f}%"
+
+
+def format_count(value: float) -> str:
+    """Format a hardware counter value."""
+    for threshold, suffix in ((1e9, "G"), (1e6, "M"), (1e3, "K")):
+        if value >= threshold:
+            return f"{value / threshold:.2f}{suffix}"
+    return f"{value:.0f}"
+
+
+def comparison_lines(results: list[dict], baseline_results: list[dict], confidence: float) -> list[str]:
+    """Build the baseline comparison section.
+
+    Only benchmarks that succeeded in both runs are compared. Results from
+    runners without repeated measurements count as one sample, so their
+    changes are never significant.
+    """
+    baseline = {(r["name"], r["backend"]): r for r in baseline_results if r["success"]}
+    lines = [
+        "## Comparison with Baseline",
+        "",
+        f"Median run time change with {confidence * 100:.0f}% bootstrap confidence interval. "
+        "Changes whose interval excludes zero are marked as significant.",
+        "",
+        "| Benchmark | Backend | Baseline | Current | Change | CI | Significant |",
+        "|-----------|---------|----------|---------|--------|----|-------------|",
+    ]
+    for result in sorted(results, key=lambda r: (r["name"], r["backend"])):
+        previous = baseline.get((result["name"], result["backend"]))
+        if not result["success"] or previous is None:
+            continue
+        delta = relative_change_ci(_samples(previous), _samples(result), confidence)
+        if delta is None:
+            continue
+        change, low, high = delta
+        if low > 0:
+            significant = "slower"
+        elif high < 0:
+            significant = "faster"
+        else:
+            significant = "-"
+        lines.append(
+            f"| {result['name']} | {result['backend']} | {format_time(previous['execution_time'])} | "
+            f"{format_time(result['execution_time'])} | {format_change(change)} | "
+            f"[{format_change(low)}, {format_change(high)}] | {significant} |"
+        )
+    return lines
+
+
+def scaling_lines(results: list[dict]) -> list[str]:
+    """Build the scaling section: median run time of each benchmark at every input size.
+
+    The growth column divides the largest size's time by the smallest's and by
+    their size ratio, so 1.00 is linear scaling and the startup cost of small
+    inputs shows up as values below 1.
+    """
+    scales = sorted({r.get("scale", 1) for r in results})
+    if len(scales) < 2:
+        return []
+
+    times: dict[tuple[str, str], dict[int, float]] = {}
+    for result in results:
+        if result["success"]:
+            key = (result.get("benchmark", result["name"]), result["backend"])
+            times.setdefault(key, {})[result.get("scale", 1)] = result["execution_time"]
+
+    header = " | ".join(f"{scale}x" for scale in scales)
+    lines = [
+        "## Scaling",
+        "",
+        "Median run time at each input size. Growth is the time ratio between the largest and smallest "
+        "size divided by their size ratio (1.00 = linear).",
+        "",
+        f"| Benchmark | Backend | {header} | Growth |",
+        "|-----------|---------|" + "|".join("-" * (len(str(scale)) + 3) for scale in scales) + "|--------|",
+    ]
+    for (benchmark, backend), by_scale in sorted(times.items()):
+        if len(by_scale) < 2:
+            continue
+        cells = " | ".join(format_time(by_scale[scale]) if scale in by_scale else "-" for scale in scales)
+        smallest, largest = min(by_scale), max(by_scale)
+        growth = "-"
+        if by_scale[smallest] > 0:
+            growth = f"{by_scale[largest] / by_scale[smallest] / (largest / smallest):.2f}"
+        lines.append(f"| {benchmark} | {backend} | {cells} | {growth} |")
+    return lines
+
+
+def allocation_lines(results: list[dict]) -> list[str]:
+    """Build the allocations section from the counts of preloaded runs.
+
+    Results without counts (statically linked or non-glibc binaries, e.g. Go)
+    are left out.
+    """
+    counted = [r for r in results if r["success"] and r.get("allocations") is not None]
+    if not counted:
+        return []
+    lines = [
+        "## Allocations",
+        "",
+        "Heap allocations (malloc, calloc, realloc) over one run and the bytes they requested.",
+        "",
+        "| Benchmark | Backend | Allocations | Bytes Allocated | Bytes/Alloc |",
+        "|-----------|---------|-------------|-----------------|-------------|",
+    ]
+    for result in sorted(counted, key=lambda r: (r["name"], r["backend"])):
+        allocations = result["allocations"]
+        per_allocation = format_size(result["allocated_bytes"] / allocations) if allocations else "-"
+        lines.append(
+            f"| {result['name']} | {result['backend']} | {format_count(allocations)} | "
+            f"{format_size(result['allocated_bytes'])} | {per_allocation} |"
+        )
+    return lines
+
+
+def _samples(result: dict) -> list[float]:
+    """Run time samples of a result, falling back to its single execution time."""
+    return result.get("execution_samples") or [result["execution_time"]]
+
+
+def generate_markdown_report(json_file: Path, output_file: Path, baseline_file: Optional[Path] = None) -> None:
     """Generate Markdown report from JSON results."""
     with open(json_file, "r") as f:
         data = json.load(f)
@@ -57,12 +188,24 @@ def generate_markdown_report(json_file: Path, output_file: Path) -> None:
         f"- **Total Runs**: {len(results)}",
         f"- **Successful**: {summary['successful_runs']} ({summary['successful_runs'] * 100 // len(results)}%)",
         f"- **Failed**: {summary['failed_runs']}",
+    ]
+    config = data.get("config")
+    if config:
+        pinning = f"CPU {config['cpu']}" if config.get("cpu") is not None else "none"
+        lines.extend(
+            [
+                f"- **Runs**: {config['warmup']} warmup + {config['repetitions']} timed per benchmark",
+                f"- **CPU pinning**: {pinning}",
+                f"- **Hardware counters**: {'perf stat' if config.get('perf') else 'not collected'}",
+            ]
+        )
+    lines.extend([
         "",
         "## Backend Comparison",
         "",
         "| Backend | Success Rate | Avg Compile Time | Avg Run Time | Avg Binary Size | Avg LOC |",
         "|---------|--------------|------------------|--------------|-----------------|---------|",
-    ]
+    ])
 
     for backend in sorted(summary["by_backend"].keys()):
         stats = summary["by_backend"][backend]
@@ -78,6 +221,20 @@ def generate_markdown_report(json_file: Path, output_file: Path) -> None:
             f"| {backend} | {success_rate} | {compile_time} | {run_time} | {binary_size} | {loc} |"
         )
 
+    scaling = scaling_lines(results)
+    if scaling:
+        lines.extend([""] + scaling)
+
+    allocations = allocation_lines(results)
+    if allocations:
+        lines.extend([""] + allocations)
+
+    if baseline_file is not None:
+        with open(baseline_file, "r") as f:
+            baseline_data = json.load(f)
+        confidence = (config or {}).get("confidence", 0.95)
+        lines.extend([""] + comparison_lines(results, baseline_data["results"], confidence))
+
     lines.extend(["", "## Detailed Results", ""])
 
     # Results by benchmark
@@ -87,8 +244,10 @@ def generate_markdown_report(json_file: Path, output_file: Path) -> None:
         # Create comparison table
         lines.extend(
             [
-                "| Backend | Status | Compile Time | Run Time | Binary Size | LOC | Output |",
-                "|---------|--------|--------------|----------|-------------|-----|--------|",
+                "| Backend | Status | Compile Time | Run Time (median) | p95 | Median CI | Binary Size | Peak RSS | LOC "
+                "| Output |",
+                "|---------|--------|--------------|-------------------|-----|-----------|-------------|----------|-----"
+                "|--------|",
             ]
         )
 
@@ -97,18 +256,48 @@ def generate_markdown_report(json_file: Path, output_file: Path) -> None:
             status = "✅" if result["success"] else "❌"
             compile_time = format_time(result["compilation_time"])
             run_time = format_time(result["execution_time"]) if result["success"] else "-"
+            has_p95 = result["success"] and "execution_time_p95" in result
+            p95 = format_time(result["execution_time_p95"]) if has_p95 else "-"
+            ci = result.get("execution_time_ci")
+            ci_text = f"[{format_time(ci[0])}, {format_time(ci[1])}]" if result["success"] and ci else "-"
             binary_size = (
                 format_size(result["binary_size"]) if result["binary_size"] > 0 else "-"
             )
+            peak_rss = format_size(result["peak_rss"]) if result.get("peak_rss") else "-"
             loc = str(result["lines_of_code"]) if result["lines_of_code"] > 0 else "-"
             output = result["output"][:20] if result["output"] else (result["error"][:20] if result["error"] else "-")
 
             lines.append(
-                f"| {result['backend']} | {status} | {compile_time} | {run_time} | {binary_size} | {loc} | {output} |"
+                f"| {result['backend']} | {status} | {compile_time} | {run_time} | {p95} | {ci_text} | "
+                f"{binary_size} | {peak_rss} | {loc} | {output} |"
             )
 
         lines.append("")
 
+        counted = [r for r in benchmark_results if r.get("counters")]
+        if counted:
+            lines.extend(
+                [
+                    "| Backend | Cycles | Instructions | IPC | Cache Misses | Branch Misses |",
+                    "|---------|--------|--------------|-----|--------------|---------------|",
+                ]
+            )
+            for result in sorted(counted, key=lambda x: x["backend"]):
+                counters = result["counters"]
+                cycles = counters.get("cycles")
+                instructions = counters.get("instructions")
+                ipc = f"{instructions / cycles:.2f}" if cycles and instructions else "-"
+                cells = [
+                    format_count(counters[event]) if event in counters else "-"
+                    for event in ("cycles", "instructions")
+                ]
+                misses = [
+                    format_count(counters[event]) if event in counters else "-"
+                    for event in ("cache-misses", "branch-misses")
+                ]
+                lines.append(f"| {result['backend']} | {cells[0]} | {cells[1]} | {ipc} | {misses[0]} | {misses[1]} |")
+            lines.append("")
+
     # Performance rankings
     lines.extend(["## Performance Rankings", "", "### Fastest Execution Time", ""])
 
@@ -214,6 +403,12 @@ def main():
         help="Output Markdown file (default: benchmark_report.md)",
         default="benchmark_report.md",
     )
+    parser.add_argument(
+        "--baseline",
+        type=str,
+        help="Earlier JSON results to compare run times against",
+        default=None,
+    )
 
     args = parser.parse_args()
 
@@ -222,8 +417,13 @@ def main():
         print(f"Error: JSON file not found: {json_file}")
         return 1
 
+    baseline_file = Path(args.baseline) if args.baseline else None
+    if baseline_file is not None and not baseline_file.exists():
+        print(f"Error: Baseline JSON file not found: {baseline_file}")
+        return 1
+
     output_file = Path(args.output)
-    generate_markdown_report(json_file, output_file)
+    generate_markdown_report(json_file, output_file, baseline_file)
 
     return 0
 
@@ -0,0 +1,59 @@
+/*
+ * Run a command and print its peak resident set size to stdout.
+ *
+ * Usage: peak_rss <command> [args...]
+ *
+ * Prints the child's ru_maxrss in kilobytes and exits with the child's exit
+ * status. The command's own output is discarded.
+ *
+ * scripts/benchmark.py compiles this on demand: a child's peak RSS includes
+ * the memory of the process that forked it, so measuring from the Python
+ * runner itself would report the runner's size for every small benchmark.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <command> [args...]\n", argv[0]);
+        return 2;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return 2;
+    }
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            close(null_fd);
+        }
+        execvp(argv[1], argv + 1);
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        perror("wait4");
+        return 2;
+    }
+#ifdef __APPLE__
+    // macOS reports bytes
+    printf("%ld\n", usage.ru_maxrss / 1024);
+#else
+    printf("%ld\n", usage.ru_maxrss);
+#endif
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
@@ -1,11 +1,69 @@
 """Abstract base classes for MGen language backends."""
 
 import ast
+import sys
 from abc import ABC, abstractmethod
 from typing import Any, Optional
 
 from .preferences import BackendPreferences
 
+# Build profiles accepted by AbstractBuilder.compile_direct(profile=...)
+BUILD_PROFILES = ("default", "release")
+
+# "release" profile for GCC-compatible C and C++ compilers: link-time optimization, so runtime
+# helpers from other translation units can be inlined, and one section per function and object
+# so the linker can drop the unreferenced ones
+RELEASE_COMPILE_FLAGS = ["-flto", "-ffunction-sections", "-fdata-sections", "-fno-plt"]
+RELEASE_LINK_FLAGS = ["-Wl,-dead_strip"] if sys.platform == "darwin" else ["-Wl,--gc-sections"]
+
+# Compile and link flag for generated code with OpenMP pragmas (the parallel_loops preference)
+OPENMP_FLAG = "-fopenmp"
+
+# Relaxations of IEEE floating point the fast_math preference may grant, as LLVM fast-math flags, and the
+# GCC-compatible options granting them: reassociation (which lets float reductions vectorize), contraction
+# of a*b+c into FMAs, and no NaNs or infinities (GCC has one option for both), or "fast" for all of them
+FAST_MATH_FLAGS = {
+    "reassoc": ["-fassociative-math", "-fno-signed-zeros", "-fno-trapping-math"],
+    "contract": ["-ffp-contract=fast"],
+    "nnan": ["-ffinite-math-only"],
+    "ninf": ["-ffinite-math-only"],
+    "fast": ["-ffast-math"],
+}
+
+
+def fast_math_modes(value: Any) -> tuple[str, ...]:
+    """The FAST_MATH_FLAGS a fast_math preference names: comma-separated, True for "fast", empty or False for none.
+
+    Raises:
+        ValueError: A mode is not one of FAST_MATH_FLAGS
+    """
+    if value is True:
+        return ("fast",)
+    if not value:
+        return ()
+    modes = tuple(dict.fromkeys(mode.strip() for mode in str(value).split(",") if mode.strip()))
+    unknown = [mode for mode in modes if mode not in FAST_MATH_FLAGS]
+    if unknown:
+        raise ValueError(f"Unknown fast_math mode {unknown[0]!r} (expected {', '.join(FAST_MATH_FLAGS)})")
+    return modes
+
+
+def fast_math_compile_flags(modes: tuple[str, ...]) -> list[str]:
+    """GCC/Clang options granting fast_math modes."""
+    return list(dict.fromkeys(flag for mode in modes for flag in FAST_MATH_FLAGS[mode]))
+
+
+def uses_openmp(source_files: list[str]) -> bool:
+    """Check whether any generated source contains an OpenMP pragma (and so needs OPENMP_FLAG)."""
+    for source_file in source_files:
+        try:
+            with open(source_file) as f:
+                if "#pragma omp" in f.read():
+                    return True
+        except (FileNotFoundError, IsADirectoryError, UnicodeDecodeError):
+            continue
+    return False
+
 
 class LanguageBackend(ABC):
     """Abstract base for all language backends in MGen."""
@@ -65,6 +123,9 @@ class AbstractEmitter(ABC):
     def __init__(self, preferences: Optional[BackendPreferences] = None):
         """Initialize emitter with optional preferences."""
         self.preferences = preferences
+        # Path of the Python file being emitted, for backends that map generated code back to it
+        # (C/C++ #line directives, LLVM debug info); None leaves the output unmapped
+        self.source_file: Optional[str] = None
 
     @abstractmethod
     def emit_function(self, func_node: ast.FunctionDef, type_context: dict[str, str]) -> str:
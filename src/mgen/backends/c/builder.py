@@ -1,11 +1,56 @@
-"""C build system for MGen with integrated runtime libraries."""
+"""C build system for MGen with integrated runtime libraries.
 
+Direct builds link against libmgenrt.a, an archive of the runtime library
+compiled once per (compiler version, target, flags, MGen version) and cached
+under user_cache_dir()/c-runtime/, instead of recompiling every runtime
+source for every program. Aggressive builds (opt_level 3 or lto=True) link
+an LTO variant so runtime calls can be inlined into the program.
+
+Only the runtime a program uses is built into it: builds from source compile
+just the runtime sources behind the runtime headers the program includes
+(transitively, see runtime_sources_for), and the runtime is compiled with one
+section per function so the link drops the functions nothing calls.
+"""
+
+import hashlib
+import os
+import re
+import shutil
 import subprocess
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+from functools import lru_cache
 from pathlib import Path
-from typing import Any
+from typing import Any, Optional
 
+from ...cache import code_fingerprint, user_cache_dir
 from ...common.makefilegen import MakefileGenerator
-from ..base import AbstractBuilder
+from ..base import (
+    OPENMP_FLAG,
+    RELEASE_COMPILE_FLAGS,
+    RELEASE_LINK_FLAGS,
+    AbstractBuilder,
+    fast_math_compile_flags,
+    uses_openmp,
+)
+from ..python_extension import extension_build_flags, extension_filename
+
+RUNTIME_ARCHIVE = "libmgenrt.a"
+
+# Flags the runtime is compiled with, shared with the program
+BASE_FLAGS = ["-Wall", "-Wextra", "-std=c11", "-O2"]
+
+# Fat objects keep the archive usable by non-LTO links and archivers without the LTO plugin
+LTO_FLAGS = ["-flto", "-ffat-lto-objects"]
+
+# The runtime starts a thread for write-behind file output (mgen_file_write_behind)
+THREAD_FLAGS = ["-pthread"]
+
+# One section per runtime function and object, so the link can drop the unused ones
+RUNTIME_SECTION_FLAGS = ["-ffunction-sections", "-fdata-sections"]
+
+# Quoted includes, which name runtime headers (system headers use <...>)
+LOCAL_INCLUDE = re.compile(r'^[ \t]*#[ \t]*include[ \t]*"([^"]+)"', re.MULTILINE)
 
 
 class CBuilder(AbstractBuilder):
@@ -33,15 +78,20 @@ class CBuilder(AbstractBuilder):
             if stc_include_dir.exists():
                 include_dirs.append(str(stc_include_dir))
 
-            # Add runtime sources
-            additional_sources = self.get_runtime_sources()
+            # Add the runtime sources the program uses
+            additional_sources = self.runtime_sources_for(source_files)
+
+        # Loops emitted with #pragma omp parallel for (parallel_loops preference)
+        openmp = [OPENMP_FLAG] if uses_openmp(source_files) else []
+        threads = THREAD_FLAGS if self.use_runtime else []
 
         # Use MakefileGenerator for sophisticated Makefile generation
         generator = MakefileGenerator(
             name=target_name,
             source_dir=".",
             build_dir="build",
-            flags=["-Wall", "-Wextra", "-O2"],
+            flags=["-Wall", "-Wextra", "-O2", *RUNTIME_SECTION_FLAGS, *openmp],
+            ldflags=[*openmp, *threads, *RELEASE_LINK_FLAGS],
             include_dirs=include_dirs,
             compiler="gcc",
             std="c11",
@@ -53,37 +103,81 @@ class CBuilder(AbstractBuilder):
         return generator.generate_makefile()
 
     def compile_direct(self, source_file: str, output_dir: str, **kwargs: Any) -> bool:
-        """Compile C source directly using gcc with MGen runtime support."""
+        """Compile C source directly using gcc with MGen runtime support.
+
+        Keyword options:
+            opt_level (int): 3 links the LTO variant of the runtime archive
+            lto (bool): Override the opt_level choice of LTO
+            profile (str): "release" adds LTO, section garbage collection and -fno-plt
+            cpu (str): Target CPU for -march (e.g. native)
+            pgo_generate (str): Instrument the binary (-fprofile-generate); runs write .gcda profiles here
+            pgo_use (str): Optimize with the .gcda profiles collected in this directory (-fprofile-use)
+            debug (bool): Emit DWARF (-g), which carries the #line mapping of --source-map to the Python file
+            target_mode (str): "extension" builds the CPython module <stem><EXT_SUFFIX> instead of an executable
+            fast_math (tuple[str, ...]): FAST_MATH_FLAGS modes the program's float arithmetic is compiled with
+        """
+        pgo_generate = kwargs.get("pgo_generate")
+        pgo_use = kwargs.get("pgo_use")
+        release = kwargs.get("profile") == "release"
+        lto = kwargs.get("lto", release or kwargs.get("opt_level", 2) >= 3)
+        # Flags beyond BASE_FLAGS and LTO that the runtime archive is built with too
+        extra_flags = [flag for flag in RELEASE_COMPILE_FLAGS if flag != "-flto"] if release else []
+        cpu = kwargs.get("cpu")
+        if cpu and cpu != "generic":
+            extra_flags.append(f"-march={cpu}")
         try:
             source_path = Path(source_file)
             out_dir = Path(output_dir)
             executable_name = source_path.stem
-            output_path = out_dir / executable_name
+            extension = kwargs.get("target_mode") == "extension"
+            output_path = out_dir / (extension_filename(executable_name) if extension else executable_name)
 
             # Build gcc command with base flags
-            cmd = [
-                "gcc",
-                "-Wall",
-                "-Wextra",
-                "-std=c11",
-                "-O2",
-            ]
-
-            # Add MGen runtime support if available
-            if self.use_runtime:
-                # Add include path for runtime
-                cmd.append(f"-I{self.runtime_dir}")
-                # Add include path for STC headers
-                stc_include_dir = Path(__file__).parent / "ext" / "stc" / "include"
-                if stc_include_dir.exists():
-                    cmd.append(f"-I{stc_include_dir}")
+            cmd = ["gcc", *BASE_FLAGS]
+            if lto:
+                cmd.extend(LTO_FLAGS)
+            cmd.extend(extra_flags)
+            # Not part of extra_flags: the runtime archive keeps strict IEEE semantics
+            cmd.extend(fast_math_compile_flags(kwargs.get("fast_math", ())))
+            if kwargs.get("debug"):
+                cmd.append("-g")
+            if extension:
+                cmd.extend(extension_build_flags(executable_name))
+            # The runtime has no OpenMP regions, so its archive is shared with non-OpenMP builds
+            if uses_openmp([str(source_path)]):
+                cmd.append(OPENMP_FLAG)
+
+            # Add include paths for the runtime and STC headers if available
+            cmd.extend(f"-I{include_dir}" for include_dir in self.runtime_include_dirs())
 
-                # Add runtime sources
-                cmd.extend(self.get_runtime_sources())
+            # Profile-guided optimization: profiles are named after the output path, so
+            # the generate and use builds must write the same executable
+            if pgo_generate:
+                cmd.append(f"-fprofile-generate={Path(pgo_generate).resolve()}")
+            elif pgo_use:
+                cmd.append(f"-fprofile-use={Path(pgo_use).resolve()}")
 
             # Add main source file and output (use absolute paths to avoid cwd confusion)
             cmd.extend([str(source_path), "-o", str(output_path)])
 
+            if self.use_runtime:
+                # PGO builds compile the runtime from source so it is instrumented and profiled too, and
+                # extension modules so it is position-independent
+                from_source = pgo_generate or pgo_use or extension
+                # The runtime gets a section per function so the link below keeps only what is called
+                runtime_flags = [*extra_flags, *(flag for flag in RUNTIME_SECTION_FLAGS if flag not in extra_flags)]
+                archive = None if from_source else self.runtime_archive("gcc", lto, runtime_flags)
+                # The archive follows the program so the linker sees its undefined symbols first
+                if archive:
+                    cmd.append(str(archive))
+                else:
+                    cmd.extend(flag for flag in RUNTIME_SECTION_FLAGS if flag not in extra_flags)
+                    cmd.extend(self.runtime_sources_for([str(source_path)]))
+                cmd.extend(THREAD_FLAGS)
+                cmd.extend(RELEASE_LINK_FLAGS)
+            elif release:
+                cmd.extend(RELEASE_LINK_FLAGS)
+
             # Run compilation (don't set cwd to avoid path resolution issues)
             result = subprocess.run(cmd, capture_output=True, text=True)
 
@@ -92,6 +186,63 @@ class CBuilder(AbstractBuilder):
         except Exception:
             return False
 
+    def runtime_include_dirs(self) -> list[Path]:
+        """Include directories of the runtime library and the STC headers it uses."""
+        if not self.use_runtime:
+            return []
+        include_dirs = [self.runtime_dir]
+        stc_include_dir = Path(__file__).parent / "ext" / "stc" / "include"
+        if stc_include_dir.exists():
+            include_dirs.append(stc_include_dir)
+        return include_dirs
+
+    def runtime_archive(
+        self, compiler: str = "gcc", lto: bool = False, extra_flags: Optional[list[str]] = None
+    ) -> Optional[Path]:
+        """Return the cached runtime archive for a compiler, building it on first use.
+
+        Args:
+            compiler: C compiler driver
+            lto: Build the LTO variant (objects carry GIMPLE for link-time optimization)
+            extra_flags: Further code generation flags, e.g. -march or -ffunction-sections
+
+        Returns:
+            Path of libmgenrt.a, or None if it could not be built (callers then
+            compile the runtime sources directly)
+        """
+        identity = _compiler_identity(compiler)
+        if identity is None:
+            return None
+        flags = BASE_FLAGS + (LTO_FLAGS if lto else []) + (extra_flags or [])
+        key = hashlib.sha256(f"{code_fingerprint()}\n{identity}\n{' '.join(flags)}".encode()).hexdigest()[:16]
+        archive = user_cache_dir() / "c-runtime" / key / RUNTIME_ARCHIVE
+        if archive.exists():
+            return archive
+
+        archive.parent.mkdir(parents=True, exist_ok=True)
+        with tempfile.TemporaryDirectory(dir=archive.parent) as work_dir:
+            includes = [f"-I{include_dir}" for include_dir in self.runtime_include_dirs()]
+
+            def compile_object(source: str) -> Optional[str]:
+                obj = str(Path(work_dir) / (Path(source).stem + ".o"))
+                result = subprocess.run([compiler, *flags, *includes, "-c", source, "-o", obj], capture_output=True)
+                return obj if result.returncode == 0 else None
+
+            with ThreadPoolExecutor(max_workers=os.cpu_count() or 1) as pool:
+                objects = list(pool.map(compile_object, self.get_runtime_sources()))
+            if not objects or None in objects:
+                return None
+
+            # gcc-ar loads the LTO plugin so the archive index lists the LTO symbols
+            archiver = shutil.which(f"{compiler}-ar") if lto else None
+            staged = Path(work_dir) / RUNTIME_ARCHIVE
+            result = subprocess.run([archiver or "ar", "rcs", str(staged), *objects], capture_output=True)
+            if result.returncode != 0:
+                return None
+            # Concurrent builds may race to create the same archive; either copy is complete
+            os.replace(staged, archive)
+        return archive
+
     def get_compile_flags(self) -> list[str]:
         """Get C compilation flags including MGen runtime support."""
         flags = ["-Wall", "-Wextra", "-std=c11", "-O2"]
@@ -117,6 +268,35 @@ class CBuilder(AbstractBuilder):
 
         return runtime_sources
 
+    def runtime_sources_for(self, source_files: list[str]) -> list[str]:
+        """The runtime sources a program needs: those behind the runtime headers it includes.
+
+        Follows the quoted includes of the program's files, of the runtime
+        headers they reach and of those headers' sources, and returns each
+        reached mgen_X.c. A fibonacci program reaches the error handling,
+        Python builtins and memory modules, not the string, file, container
+        or parallel ones. Until every file can be read (a Makefile may be
+        generated before its sources are written) the whole runtime is needed.
+        """
+        if not self.use_runtime:
+            return []
+        pending = []
+        for source_file in source_files:
+            try:
+                pending.extend(LOCAL_INCLUDE.findall(Path(source_file).read_text()))
+            except (OSError, UnicodeDecodeError):
+                return self.get_runtime_sources()
+        reached: set[str] = set()
+        while pending:
+            name = pending.pop()
+            if name in reached or not (self.runtime_dir / name).is_file():
+                continue
+            reached.add(name)
+            pending.extend(_runtime_includes(self.runtime_dir / name))
+            if name.endswith(".h") and (self.runtime_dir / (name[:-2] + ".c")).is_file():
+                pending.append(name[:-2] + ".c")
+        return sorted(str(self.runtime_dir / name) for name in reached if name.endswith(".c"))
+
     def get_runtime_headers(self) -> list[str]:
         """Get MGen runtime header files for inclusion."""
         if not self.use_runtime:
@@ -127,3 +307,22 @@ class CBuilder(AbstractBuilder):
             runtime_headers.append(header_file.name)
 
         return runtime_headers
+
+
+@lru_cache(maxsize=None)
+def _runtime_includes(path: Path) -> tuple[str, ...]:
+    """Quoted includes of a runtime file (the runtime does not change while MGen runs)."""
+    return tuple(LOCAL_INCLUDE.findall(path.read_text()))
+
+
+@lru_cache(maxsize=None)
+def _compiler_identity(compiler: str) -> Optional[str]:
+    """Version and target triple of a compiler, or None if it cannot be run."""
+    try:
+        version = subprocess.run([compiler, "-dumpfullversion", "-dumpversion"], capture_output=True, text=True)
+        machine = subprocess.run([compiler, "-dumpmachine"], capture_output=True, text=True)
+    except OSError:
+        return None
+    if version.returncode != 0 or machine.returncode != 0:
+        return None
+    return f"{compiler} {version.stdout.strip()} {machine.stdout.strip()}"
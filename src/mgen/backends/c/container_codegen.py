@@ -19,6 +19,17 @@ from .type_parameter_extractor import TypeParameterExtractor
 class ContainerCodeGenerator:
     """Generate type-specific container implementations inline."""
 
+    # Container types whose hand-tuned runtime implementation is emitted instead of
+    # the generic parameterized template (maps type -> generator method name)
+    SPECIALIZED_CONTAINERS: dict[str, str] = {
+        "map_str_int": "generate_str_int_map",
+        "map_int_int": "generate_map_int_int",
+        "set_int": "generate_set_int",
+        "map_str_str": "generate_map_str_str",
+        "set_str": "generate_set_str",
+        "vec_cstr": "generate_vec_cstr",
+    }
+
     def __init__(self) -> None:
         """Initialize code generator with templates from runtime library."""
         self.runtime_dir = Path(__file__).parent / "runtime"
@@ -115,6 +126,59 @@ class ContainerCodeGenerator:
 
         return "\n".join(filtered_lines)
 
+    def _extract_single_header(self, filename: str, keep_guard: bool = False) -> str:
+        """Extract the body of a single-header runtime file for inline emission.
+
+        Unlike the line filters used for the older hardcoded generators, this only
+        removes the outer include guard, the ``extern "C"`` wrappers and includes of
+        other runtime headers. System includes are kept because the optimized
+        containers need platform headers (e.g. SIMD intrinsics) under ``#if`` guards.
+
+        Args:
+            filename: Runtime library filename (e.g., "mgen_map_int_int.h")
+            keep_guard: Keep the include guard, for shared helper headers that
+                several generated containers emit (e.g., "mgen_str_arena.h")
+
+        Returns:
+            Header body with guards, C++ wrappers and runtime includes removed
+        """
+        code = self._remove_error_handling_macros(self._load_template(filename))
+        lines = code.split("\n")
+
+        # Locate the outer include guard: first #ifndef/#define pair and last #endif
+        guard_lines: set[int] = set()
+        for i, line in enumerate(lines):
+            if keep_guard:
+                break
+            if line.strip().startswith("#ifndef"):
+                guard_lines.update({i, i + 1})
+                break
+        for i in range(len(lines) - 1, -1, -1):
+            if keep_guard:
+                break
+            if lines[i].strip().startswith("#endif"):
+                guard_lines.add(i)
+                break
+
+        body_lines = []
+        in_cplusplus_block = False
+        for i, line in enumerate(lines):
+            stripped = line.strip()
+            if i in guard_lines:
+                continue
+            if stripped == "#ifdef __cplusplus":
+                in_cplusplus_block = True
+                continue
+            if in_cplusplus_block:
+                if stripped.startswith("#endif"):
+                    in_cplusplus_block = False
+                continue
+            if stripped.startswith('#include "'):
+                continue
+            body_lines.append(line)
+
+        return "\n".join(body_lines)
+
     def generate_from_template(self, container_type: str) -> Optional[str]:
         """Generate container code from generic parameterized templates.
 
@@ -165,9 +229,18 @@ class ContainerCodeGenerator:
         # Strip header guards and includes from header
         clean_lines = []
         in_header_guard = False
+        in_cplusplus = False
         for line in header_code.split("\n"):
             stripped = line.strip()
 
+            # Skip the extern "C" open/close blocks (the header also has inline function bodies)
+            if stripped.startswith("#ifdef __cplusplus"):
+                in_cplusplus = True
+                continue
+            if in_cplusplus:
+                in_cplusplus = not stripped.startswith("#endif")
+                continue
+
             # Skip header guards
             if stripped.startswith("#ifndef") and "_H" in stripped:
                 in_header_guard = True
@@ -178,14 +251,8 @@ class ContainerCodeGenerator:
                 in_header_guard = False
                 continue
 
-            # Skip includes, extern C
-            if (
-                stripped.startswith("#include")
-                or stripped.startswith("#ifdef __cplusplus")
-                or stripped.startswith('extern "C"')
-                or stripped.startswith("#endif")
-                or stripped == "}"
-            ):
+            # Skip includes
+            if stripped.startswith("#include") or stripped.startswith("#endif"):
                 continue
 
             clean_lines.append(line)
@@ -209,60 +276,73 @@ class ContainerCodeGenerator:
 
         return "\n".join(sections)
 
+    def generate_runtime_sources(self, container_type: str) -> Optional[tuple[str, str]]:
+        """Instantiate the parameterized templates as a header and a source file of their own.
+
+        Unlike generate_from_template(), which inlines a container into one program, this
+        keeps the header guard and system includes so other runtimes can compile the
+        container separately (the LLVM backend's 64-bit vec_i64, set_i64 and map_i64_i64).
+        Error reporting is dropped like in the inline code; allocation profiling becomes
+        a no-op unless MGEN_PROFILE_ALLOC is defined.
+
+        Args:
+            container_type: Container type identifier (e.g., "vec_i64")
+
+        Returns:
+            (header, source) of mgen_<container_type>.h/.c, or None if no template applies
+        """
+        info = self.extractor.extract(container_type)
+        if not info or info.family not in ("vec", "map", "set"):
+            return None
+
+        template_name = {"vec": "vec_T", "map": "map_K_V", "set": "set_T"}[info.family]
+        header = self.substitution_engine.substitute_from_container_info(
+            self._load_generic_template(f"{template_name}.h.tmpl"), info
+        )
+        impl = self.substitution_engine.substitute_from_container_info(
+            self._load_generic_template(f"{template_name}.c.tmpl"), info
+        )
+
+        # Only the container's own header and system headers stay included
+        own_include = f'#include "mgen_{container_type}.h"'
+        impl_lines = [
+            line
+            for line in self._remove_error_handling_macros(impl).split("\n")
+            if not line.startswith('#include "') or line == own_include
+        ]
+        last_include = max(i for i, line in enumerate(impl_lines) if line.startswith("#include"))
+        impl_lines[last_include + 1 : last_include + 1] = [
+            "",
+            "#if !defined(MGEN_PROFILE_ALLOC)",
+            "#define MGEN_PROFILE_ALLOC(size) ((void)0)",
+            "#endif",
+        ]
+        return header, "\n".join(impl_lines)
+
     def generate_str_int_map(self) -> str:
         """Generate complete implementation for string→int hash table.
 
         This is a prototype that uses the existing runtime library as a template.
         Future versions will support parameterized generation for any key/value types.
+        The shared string hash, arena and intern table are emitted first, guarded like in
+        generate_map_str_str().
 
         Returns:
             Complete C code for string→int map implementation
         """
-        # Load single-header template (contains both interface and implementation)
-        header = self._load_template("mgen_str_int_map.h")
-
-        # Strip includes (we'll handle them separately)
-        code = self._strip_includes_and_headers(header)
-
-        # Remove error handling macros for self-contained code
-        code = self._remove_error_handling_macros(code)
-
-        # Strip header guards and extern C wrappers
-        clean_lines = []
-        in_header_guard = False
-        for line in code.split("\n"):
-            stripped = line.strip()
-
-            # Skip header guards
-            if stripped.startswith("#ifndef") and "_H" in stripped:
-                in_header_guard = True
-                continue
-            if stripped.startswith("#define") and "_H" in stripped:
-                continue
-            if stripped.startswith("#endif") and in_header_guard:
-                in_header_guard = False
-                continue
-
-            # Skip extern C wrappers
-            if (
-                stripped.startswith("#ifdef __cplusplus")
-                or stripped.startswith('extern "C"')
-                or (stripped.startswith("#endif") and not in_header_guard)
-                or (stripped == "}" and not in_header_guard)
-            ):
-                continue
-
-            clean_lines.append(line)
-
-        clean_code = "\n".join(clean_lines)
-
         # Return generated container with header comment
         sections = [
             "// ========== Generated Container: str_int_map ==========",
             "// String → int hash table implementation",
             "// Generated inline for this program (no external dependencies)",
             "",
-            clean_code.strip(),
+            self._extract_single_header("mgen_str_hash.h", keep_guard=True).strip(),
+            "",
+            self._extract_single_header("mgen_str_arena.h", keep_guard=True).strip(),
+            "",
+            self._extract_single_header("mgen_str_intern.h", keep_guard=True).strip(),
+            "",
+            self._extract_single_header("mgen_str_int_map.h").strip(),
             "",
             "// ========== End of Generated Container ==========",
             "",
@@ -332,47 +412,13 @@ class ContainerCodeGenerator:
     def generate_set_int(self) -> str:
         """Generate complete implementation for integer hash set.
 
+        Emits the runtime implementation: chained buckets in a power-of-two
+        table indexed by Fibonacci hashing.
+
         Returns:
             Complete C code for integer hash set implementation
         """
-        # Load single-header template (contains both interface and implementation)
-        header = self._load_template("mgen_set_int.h")
-
-        # Strip includes (we'll handle them separately)
-        code = self._strip_includes_and_headers(header)
-
-        # Remove error handling macros for self-contained code
-        code = self._remove_error_handling_macros(code)
-
-        # Strip header guards and includes from header
-        clean_lines = []
-        in_header_guard = False
-        for line in code.split("\n"):
-            stripped = line.strip()
-
-            # Skip header guards
-            if stripped.startswith("#ifndef") and "_H" in stripped:
-                in_header_guard = True
-                continue
-            if stripped.startswith("#define") and "_H" in stripped:
-                continue
-            if stripped.startswith("#endif") and in_header_guard:
-                in_header_guard = False
-                continue
-
-            # Skip includes, extern C
-            if (
-                stripped.startswith("#include")
-                or stripped.startswith("#ifdef __cplusplus")
-                or stripped.startswith('extern "C"')
-                or stripped.startswith("#endif")
-                or stripped == "}"
-            ):
-                continue
-
-            clean_lines.append(line)
-
-        clean_code = "\n".join(clean_lines)
+        clean_code = self._extract_single_header("mgen_set_int.h")
 
         # Combine into generated implementation
         sections = [
@@ -391,52 +437,18 @@ class ContainerCodeGenerator:
     def generate_map_int_int(self) -> str:
         """Generate complete implementation for int→int hash map.
 
+        Emits the open-addressing (Swiss-table style) runtime implementation,
+        which stores entries inline and does not allocate per insert.
+
         Returns:
             Complete C code for int→int map implementation
         """
-        # Load single-header template (contains both interface and implementation)
-        header = self._load_template("mgen_map_int_int.h")
-
-        # Strip includes (we'll handle them separately)
-        code = self._strip_includes_and_headers(header)
-
-        # Remove error handling macros for self-contained code
-        code = self._remove_error_handling_macros(code)
-
-        # Strip header guards and includes from header
-        clean_lines = []
-        in_header_guard = False
-        for line in code.split("\n"):
-            stripped = line.strip()
-
-            # Skip header guards
-            if stripped.startswith("#ifndef") and "_H" in stripped:
-                in_header_guard = True
-                continue
-            if stripped.startswith("#define") and "_H" in stripped:
-                continue
-            if stripped.startswith("#endif") and in_header_guard:
-                in_header_guard = False
-                continue
-
-            # Skip includes, extern C
-            if (
-                stripped.startswith("#include")
-                or stripped.startswith("#ifdef __cplusplus")
-                or stripped.startswith('extern "C"')
-                or stripped.startswith("#endif")
-                or stripped == "}"
-            ):
-                continue
-
-            clean_lines.append(line)
-
-        clean_code = "\n".join(clean_lines)
+        clean_code = self._extract_single_header("mgen_map_int_int.h")
 
         # Combine into generated implementation
         sections = [
             "// ========== Generated Container: map_int_int ==========",
-            "// Integer → Integer hash map implementation",
+            "// Integer → Integer open-addressing hash map implementation",
             "// Generated inline for this program (no external dependencies)",
             "",
             clean_code.strip(),
@@ -509,55 +521,22 @@ class ContainerCodeGenerator:
     def generate_vec_cstr(self) -> str:
         """Generate complete implementation for string arrays (vector of C strings).
 
+        String bytes live in an arena owned by the vector (see
+        generate_map_str_str() for how the shared arena helpers are emitted).
+
         Returns:
             Complete C code for vec_cstr implementation
         """
-        # Load single-header template (contains both interface and implementation)
-        header = self._load_template("mgen_vec_cstr.h")
-
-        # Strip includes (we'll handle them separately)
-        code = self._strip_includes_and_headers(header)
-
-        # Remove error handling macros for self-contained code
-        code = self._remove_error_handling_macros(code)
-
-        # Strip header guards and includes from header
-        clean_lines = []
-        in_header_guard = False
-        for line in code.split("\n"):
-            stripped = line.strip()
-
-            # Skip header guards
-            if stripped.startswith("#ifndef") and "_H" in stripped:
-                in_header_guard = True
-                continue
-            if stripped.startswith("#define") and "_H" in stripped:
-                continue
-            if stripped.startswith("#endif") and in_header_guard:
-                in_header_guard = False
-                continue
-
-            # Skip includes, extern C
-            if (
-                stripped.startswith("#include")
-                or stripped.startswith("#ifdef __cplusplus")
-                or stripped.startswith('extern "C"')
-                or stripped.startswith("#endif")
-                or stripped == "}"
-            ):
-                continue
-
-            clean_lines.append(line)
-
-        clean_code = "\n".join(clean_lines)
-
-        # Combine into generated implementation
         sections = [
             "// ========== Generated Container: vec_cstr ==========",
-            "// String array (vector of C strings) implementation",
+            "// String array (vector of C strings) with arena-backed storage",
             "// Generated inline for this program (no external dependencies)",
             "",
-            clean_code.strip(),
+            self._extract_single_header("mgen_str_hash.h", keep_guard=True).strip(),
+            "",
+            self._extract_single_header("mgen_str_arena.h", keep_guard=True).strip(),
+            "",
+            self._extract_single_header("mgen_vec_cstr.h").strip(),
             "",
             "// ========== End of Generated Container ==========",
             "",
@@ -680,53 +659,24 @@ class ContainerCodeGenerator:
     def generate_map_str_str(self) -> str:
         """Generate map_str_str (string→string hash map) implementation.
 
+        Keys and values are stored in a chunked string arena owned by the map,
+        so the shared hash and arena helpers are emitted first (guarded, so
+        several string containers can be generated into the same file).
+
         Returns:
             Generated C code for string→string hash map
         """
-        # Load single-header template (contains both interface and implementation)
-        header = self._load_template("mgen_map_str_str.h")
-
-        # Strip includes (we'll handle them separately)
-        code = self._strip_includes_and_headers(header)
-
-        # Remove error handling macros for self-contained code
-        code = self._remove_error_handling_macros(code)
-
-        # Strip header guards and includes from header
-        clean_lines = []
-        in_header_guard = False
-        for line in code.split("\n"):
-            stripped = line.strip()
-
-            # Skip header guards
-            if stripped.startswith("#ifndef") or stripped.startswith("#define") and "_H" in stripped:
-                in_header_guard = True
-                continue
-            if stripped.startswith("#endif") and in_header_guard:
-                in_header_guard = False
-                continue
-
-            # Skip includes and extern C
-            if stripped.startswith("#include"):
-                continue
-            if (
-                stripped.startswith("#ifdef __cplusplus")
-                or stripped.startswith('extern "C"')
-                or stripped.startswith("{")
-            ):
-                continue
-            if stripped.startswith("#endif"):
-                continue
-            if stripped == "}":  # Closing brace for extern C
-                continue
-
-            clean_lines.append(line)
-
-        clean_code = "\n".join(clean_lines)
-
         sections = [
             "// ========== Generated Container: map_str_str ==========",
-            clean_code.strip(),
+            "// String → String hash map with arena-backed key/value storage",
+            "// Generated inline for this program (no external dependencies)",
+            "",
+            self._extract_single_header("mgen_str_hash.h", keep_guard=True).strip(),
+            "",
+            self._extract_single_header("mgen_str_arena.h", keep_guard=True).strip(),
+            "",
+            self._extract_single_header("mgen_map_str_str.h").strip(),
+            "",
             "// ========== End of Generated Container ==========",
             "",
         ]
@@ -736,53 +686,23 @@ class ContainerCodeGenerator:
     def generate_set_str(self) -> str:
         """Generate set_str (string hash set) implementation.
 
+        Values are stored in a chunked string arena owned by the set; see
+        generate_map_str_str() for how the shared arena helpers are emitted.
+
         Returns:
             Generated C code for string hash set
         """
-        # Load single-header template (contains both interface and implementation)
-        header = self._load_template("mgen_set_str.h")
-
-        # Strip includes (we'll handle them separately)
-        code = self._strip_includes_and_headers(header)
-
-        # Remove error handling macros for self-contained code
-        code = self._remove_error_handling_macros(code)
-
-        # Strip header guards and includes from header
-        clean_lines = []
-        in_header_guard = False
-        for line in code.split("\n"):
-            stripped = line.strip()
-
-            # Skip header guards
-            if stripped.startswith("#ifndef") or stripped.startswith("#define") and "_H" in stripped:
-                in_header_guard = True
-                continue
-            if stripped.startswith("#endif") and in_header_guard:
-                in_header_guard = False
-                continue
-
-            # Skip includes and extern C
-            if stripped.startswith("#include"):
-                continue
-            if (
-                stripped.startswith("#ifdef __cplusplus")
-                or stripped.startswith('extern "C"')
-                or stripped.startswith("{")
-            ):
-                continue
-            if stripped.startswith("#endif"):
-                continue
-            if stripped == "}":  # Closing brace for extern C
-                continue
-
-            clean_lines.append(line)
-
-        clean_code = "\n".join(clean_lines)
-
         sections = [
             "// ========== Generated Container: set_str ==========",
-            clean_code.strip(),
+            "// String hash set with arena-backed storage",
+            "// Generated inline for this program (no external dependencies)",
+            "",
+            self._extract_single_header("mgen_str_hash.h", keep_guard=True).strip(),
+            "",
+            self._extract_single_header("mgen_str_arena.h", keep_guard=True).strip(),
+            "",
+            self._extract_single_header("mgen_set_str.h").strip(),
+            "",
             "// ========== End of Generated Container ==========",
             "",
         ]
@@ -801,6 +721,22 @@ class ContainerCodeGenerator:
         Returns:
             Generated C code, or None if type not supported
         """
+        code = self._generate_container_code(container_type)
+        if code is None or "MGEN_PROFILE_ALLOC(" not in code:
+            return code
+
+        # Allocation profiler hooks stay in the generated code; they report to the
+        # profiler when mgen_alloc_profile.h is included first and are no-ops otherwise
+        fallback = "#if !defined(MGEN_PROFILE_ALLOC)\n#define MGEN_PROFILE_ALLOC(size) ((void)0)\n#endif\n"
+        return fallback + code
+
+    def _generate_container_code(self, container_type: str) -> Optional[str]:
+        """Dispatch to the specialized, template or hardcoded generator for a container type."""
+        # Hand-tuned runtime implementations take precedence over generic templates
+        if container_type in self.SPECIALIZED_CONTAINERS:
+            generator: str = self.SPECIALIZED_CONTAINERS[container_type]
+            return str(getattr(self, generator)())
+
         # Try template-based generation first (new approach)
         template_code = self.generate_from_template(container_type)
         if template_code is not None:
@@ -842,18 +778,23 @@ class ContainerCodeGenerator:
         # str_int_map needs: stdlib.h (malloc/free), string.h (strcmp/strdup)
         # vec_int needs: stdlib.h (malloc/free), stdbool.h (bool)
         # set_int needs: stdlib.h (malloc/free), stdbool.h (bool)
-        # map_int_int needs: stdlib.h (malloc/free), stdbool.h (bool)
+        # map_int_int needs: stdlib.h (malloc/free), string.h (memset), stdbool.h (bool), stdint.h (int8_t)
         # vec_vec_int needs: stdlib.h (malloc/free), stdbool.h (bool)
-        # vec_cstr needs: stdlib.h (malloc/free), string.h (strdup), stdbool.h (bool)
+        # vec_cstr needs: stdlib.h (malloc/free), string.h (memcpy/strstr), stdbool.h (bool), stdint.h
         # vec_float needs: stdlib.h (malloc/free), stdbool.h (bool)
         # vec_double needs: stdlib.h (malloc/free), stdbool.h (bool)
-        # map_str_str needs: stdlib.h (malloc/free), string.h (strcmp/strdup), stdbool.h (bool)
-        # set_str needs: stdlib.h (malloc/free), string.h (strcmp/strdup), stdbool.h (bool)
+        # map_str_str needs: stdlib.h (malloc/free), string.h (memcpy/memcmp), stdbool.h (bool), stdint.h
+        # set_str needs: stdlib.h (malloc/free), string.h (memcpy/memcmp), stdbool.h (bool), stdint.h
+        # template maps need: stdlib.h (malloc/realloc), string.h (memset), stdbool.h (bool), stdint.h (uint32_t)
         # These are already in standard includes, but we track them for completeness
-        if container_type in ["map_str_int", "vec_cstr", "map_str_str", "set_str"]:
+        if container_type == "map_str_int":
             return ["<stdlib.h>", "<string.h>", "<stdbool.h>"]
-        elif container_type in ["vec_int", "set_int", "map_int_int", "vec_vec_int", "vec_float", "vec_double"]:
+        elif container_type in ["map_int_int", "map_str_str", "set_str", "vec_cstr"]:
+            return ["<stdlib.h>", "<string.h>", "<stdbool.h>", "<stdint.h>"]
+        elif container_type in ["vec_int", "set_int", "vec_vec_int", "vec_float", "vec_double"]:
             return ["<stdlib.h>", "<stdbool.h>"]
+        elif container_type.startswith("map_"):
+            return ["<stdlib.h>", "<string.h>", "<stdbool.h>", "<stdint.h>"]
 
         return []
 
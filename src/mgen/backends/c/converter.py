@@ -18,25 +18,58 @@ Supported Features:
 """
 
 import ast
-from typing import Any, Optional
-
+import re
+from pathlib import Path
+from typing import Any, Callable, Optional, Union
+
+from ...frontend.dict_updates import DictUpdate, match_dict_update
+from ...frontend.immutability_analyzer import ImmutabilityAnalyzer
+from ...frontend.optimization_hints import LOOP_VECTORIZE, OptimizationHintAnalyzer
+from ...frontend.optimizers.compile_time_evaluator import CompileTimeEvaluator, StringDispatch, StringMatchChain
+from ...frontend.optimizers.loop_analyzer import (
+    PARALLEL_SAFE_BUILTINS,
+    ParallelLoop,
+    memoized_functions,
+    pure_functions,
+)
+from ...frontend.verifiers.bounds_prover import (
+    LoopBoundsProof,
+    bounded_int_sets,
+    loop_bounds_proofs,
+    overflow_free_arithmetic,
+)
 from ..converter_utils import (
     get_augmented_assignment_operator,
     get_standard_binary_operator,
     get_standard_comparison_operator,
     get_standard_unary_operator,
+    line_directive,
+    read_only_dict_literals,
+    render_string_dispatch,
+    restore_generated_lines,
+    struct_of_arrays_classes,
 )
 from ..errors import TypeMappingError, UnsupportedFeatureError
 from ..preferences import BackendPreferences, CPreferences
+from ..python_extension import plan_extension, render_c_extension
 from .container_codegen import ContainerCodeGenerator
 from .containers import CContainerSystem
 from .enhanced_type_inference import EnhancedTypeInferenceEngine, InferredType, TypeConfidence
 from .ext.stc.nested_containers import NestedContainerManager
+from .memory_safety import ContainerLifetimePlanner, ContainerLifetimes
+from .type_parameter_extractor import TypeParameterExtractor
 
 
 class MGenPythonToCConverter:
     """Enhanced Python to C converter with MGen runtime integration."""
 
+    # Vector element types STC compares with ==/<: their declarations get i_use_cmp,
+    # which provides the type-specialized vec_T_find() and vec_T_eq()
+    STC_COMPARABLE_ELEMENTS = frozenset({"int", "float", "double", "bool", "char"})
+
+    # Numeric vectors whose buffers the "aligned_vectors" preference allocates at MGEN_VEC_ALIGNMENT
+    ALIGNED_VECTOR_ELEMENTS = {"vec_int": "int", "vec_float": "float", "vec_double": "double"}
+
     def __init__(self, preferences: Optional[BackendPreferences] = None) -> None:
         """Initialize converter with MGen runtime support.
 
@@ -70,6 +103,10 @@ class MGenPythonToCConverter:
         self.iterator_variables: dict[str, str] = {}
         self.includes_needed: set[str] = set()
         self.use_runtime = True
+        # Scope allocator for function-local temporary strings (None = heap-allocate them)
+        self.scope_allocator_var: Optional[str] = None
+        # String variables the enclosing loops accumulate into an mgen_buffer_t (var -> buffer)
+        self.string_builders: dict[str, str] = {}
 
         # NEW: Enhanced type inference engine
         self.type_engine = EnhancedTypeInferenceEngine()
@@ -78,15 +115,108 @@ class MGenPythonToCConverter:
         # NEW: Nested container support
         self.nested_container_manager = NestedContainerManager()
         self.nested_containers: set[str] = set()  # Track which variables are nested containers
+        self.flat_matrices = False  # Nested containers are emitted as row-major mat_int
 
         # Track function return types for better inference
         self.function_return_types: dict[str, str] = {}
 
-    def convert_code(self, source_code: str) -> str:
-        """Convert Python source code to C code."""
+        # sorted()/list.sort(): C key type of each module function usable as key=, and whether
+        # a list of STC strings is sorted (the sort is instantiated for cstr elements then)
+        self.sort_key_types: dict[str, str] = {}
+        self.sorts_stc_strings = False
+
+        # Loop hints from the frontend, keyed by source line
+        self.loop_hints: dict[int, set[str]] = {}
+        # Loops proven parallel (parallel_loops preference), and whether one encloses the current statement
+        self.parallel_loops: dict[int, ParallelLoop] = {}
+        self.in_parallel_loop = False
+        # "parallel" preference: parallel loops and pure comprehensions run on the mgen_parallel pool,
+        # outlined into chunk functions emitted before the function being converted (None outside one)
+        self.parallel_pool = False
+        self.pure_functions: set[str] = set()
+        self.parallel_functions: Optional[list[str]] = None
+        self.parallel_function_count = 0
+        # Pure functions whose results are cached in a memo table (memoize_pure, @cache)
+        self.memoized: set[str] = set()
+        # instrument: (function, kind, line) of each probe, indexed by site id, and the
+        # function whose statements get loop probes (None outside one)
+        self.probe_sites: list[tuple[str, str, int]] = []
+        self.probe_function: Optional[str] = None
+        # Python file that #line directives attribute functions and statements to (None: no mapping)
+        self.source_file: Optional[str] = None
+
+        # Bounds proofs of range loops, keyed by id() of the loop; subscripts they prove are emitted unchecked
+        self.bounds_proofs: dict[int, LoopBoundsProof] = {}
+        self.safe_subscripts: set[int] = set()
+        # While a loop is versioned on a range check hoisted before it: the subscripts the check covers,
+        # the ranges of the loops it checks and the loop itself
+        self.hoisted_subscripts: Optional[set[int]] = None
+        self.hoisted_ranges: list[tuple[LoopBoundsProof, str, str]] = []
+        self.versioned_loop: Optional[LoopBoundsProof] = None
+        # Placeholder -> (subscript node ids, checked form, unchecked form) of accesses in a versioned loop
+        self.bounds_placeholders: dict[str, tuple[list[int], str, str]] = {}
+
+        # Code point views (mgen_utf8_str_t) of the current function's str parameters indexed in loops
+        self.string_views: dict[str, str] = {}
+
+        # Slices of the current function passed as views of their source's buffer (slice_views)
+        self.slice_views: set[int] = set()
+
+        # Vector locals of the current function only ever bound to buffers it allocates (aligned_vectors)
+        self.aligned_vectors = False
+        self.fresh_vectors: set[str] = set()
+
+        # set[int] locals of the current function stored as bitset_int, with their value domains (bitset_sets)
+        self.bitset_sets: dict[str, int] = {}
+        # int_overflow="check": ids of the function's + - * nodes proven not to overflow
+        self.overflow_free: set[int] = set()
+
+        # string_dispatch: string if/elif chains and read-only str -> int dict literals become decision
+        # trees built at conversion time (str_match_N functions, emitted ahead of the functions); the
+        # current function's dicts map to their table prefix and key count
+        self.compile_time_evaluator = CompileTimeEvaluator()
+        self.string_dispatch_functions: list[str] = []
+        self.constant_str_dicts: dict[str, tuple[str, int]] = {}
+
+        # Fixed-arity tuples of scalars are value structs (mgen_tuple_int_int: struct name -> field
+        # types), returned and unpacked by value; unpacking temporaries are numbered per module
+        self.tuple_structs: dict[str, list[str]] = {}
+        self.tuple_temp_count = 0
+
+        # soa_lists: fields of the classes whose lists are Class_soa structs of one array per field,
+        # and the list and index variable of each enclosing loop over such a list
+        self.soa_classes: dict[str, dict[str, str]] = {}
+        self.soa_loops: dict[str, tuple[str, str]] = {}
+
+        # Drops and buffer reuse of the current function's local containers (container_lifetimes)
+        self.borrowed_params: dict[str, set[int]] = {}
+        self.container_lifetimes = ContainerLifetimes()
+
+        # String maps keyed by interned symbols (intern_strings), and the symbol of each literal key
+        self.intern_strings = False
+        self.string_symbols_enabled = False
+        self.string_symbols: dict[str, str] = {}
+
+        # Generator functions (name -> (parameter names, yielded C type)), lowered to STC coroutines.
+        # While one is converted its locals live in the frame behind "co": Python name -> frame field
+        self.generators: dict[str, tuple[list[str], str]] = {}
+        self.coroutine_fields: dict[str, str] = {}
+        self.coroutine_extra_fields: list[tuple[str, str]] = []
+
+    def convert_code(self, source_code: str, source_file: Optional[str] = None) -> str:
+        """Convert Python source code to C code.
+
+        With source_file, #line directives attribute each function and statement
+        to its line in that file, for compiler diagnostics, debuggers and
+        profilers; the rest of the module keeps its lines in source_file's .c.
+        """
+        self.source_file = source_file
         try:
             tree = ast.parse(source_code)
-            return self._convert_module(tree)
+            code = self._convert_module(tree)
+            if source_file is None:
+                return code
+            return restore_generated_lines(code, Path(source_file).stem + ".c")
         except (UnsupportedFeatureError, TypeMappingError):
             # Re-raise our specific exceptions without wrapping
             raise
@@ -104,6 +234,36 @@ class MGenPythonToCConverter:
         self.type_engine.get_inference_statistics()
         # Debug: Could log stats here if needed
 
+        # Loops the vectorization detector proves independent get MGEN_LOOP_INDEPENDENT,
+        # loops the loop analyzer proves parallel #pragma omp parallel for, or with "parallel"
+        # (and without parallel_loops) a chunk function run on the mgen_parallel pool
+        hints = OptimizationHintAnalyzer().analyze(node)
+        self.loop_hints = hints.loops
+        openmp = self.preferences.get("parallel_loops", False)
+        self.parallel_pool = self.preferences.get("parallel", False) and not openmp
+        self.parallel_loops = hints.parallel if openmp or self.parallel_pool else {}
+        self.pure_functions = pure_functions(node) if self.parallel_pool else set()
+        self.parallel_function_count = 0
+        self.memoized = memoized_functions(node, self.preferences.get("memoize_pure", False))
+        self.probe_sites = []
+        self.extension_mode = self.preferences.get("target_mode", "executable") == "extension"
+        self.aligned_vectors = self.preferences.get("aligned_vectors", False) and not self._hand_written_containers()
+        self.function_signatures: dict[str, tuple[list[str], str]] = {}
+
+        # Subscripts a range loop keeps in bounds skip the runtime check
+        self.bounds_proofs = loop_bounds_proofs(node)
+        self.safe_subscripts = {
+            id(access.node) for proof in self.bounds_proofs.values() for access in proof.accesses if access.proven
+        }
+
+        # Arguments bound to these parameters are neither stored nor kept by the callee
+        borrowable = ImmutabilityAnalyzer().borrowable_parameters(node)
+        self.borrowed_params = {
+            func.name: {i for i, arg in enumerate(func.args.args) if arg.arg in borrowable.get(func.name, set())}
+            for func in node.body
+            if isinstance(func, ast.FunctionDef)
+        }
+
         # Check for comprehensions to enable STC support
         self.uses_comprehensions = self._uses_comprehensions(node)
 
@@ -122,16 +282,32 @@ class MGenPythonToCConverter:
         # First pass: detect container variables to generate STC declarations
         self._detect_container_variables(node)
 
+        # First pass: generator functions, so their callers can resume them
+        self._detect_generators(node)
+
+        # First pass: sorted() and list.sort() need the sort runtime and the key functions' result types
+        self._detect_sorts(node)
+
+        # String maps intern their keys; literal keys are interned once when main starts
+        self.intern_strings = self.preferences.get("intern_strings", True)
+        self.string_symbols = {}
+        self.string_dispatch_functions = []
+        self.tuple_structs = {}
+        self.tuple_temp_count = 0
+        self.soa_classes = struct_of_arrays_classes(node) if self.preferences.get("soa_lists", False) else {}
+        self.string_symbols_enabled = self.intern_strings and any(
+            isinstance(stmt, ast.FunctionDef) and stmt.name == "main" for stmt in node.body
+        )
+
         # Add includes
-        parts.extend(self._generate_includes())
+        includes = self._generate_includes()
+        parts.extend(includes)
+        includes_end = len(parts)
         parts.append("")
 
-        # Check container mode preference
-        container_mode = self.preferences.get("container_mode", "runtime")
-
-        # Add container implementation (runtime includes or generated code)
+        # Add container implementation (STC declarations or hand-written code)
         if self._uses_containers(node) or self.uses_comprehensions or self.container_variables:
-            if container_mode == "generated":
+            if self._hand_written_containers():
                 # Generate inline container implementations
                 parts.extend(self._generate_inline_containers())
                 parts.append("")
@@ -141,6 +317,8 @@ class MGenPythonToCConverter:
                 parts.append("")
 
         # Convert functions and classes
+        symbols_index = len(parts)
+        main_index: Optional[int] = None
         for stmt in node.body:
             if isinstance(stmt, ast.Import):
                 # Process import statements (may add includes)
@@ -149,18 +327,149 @@ class MGenPythonToCConverter:
                 # Process from...import statements (may add includes)
                 self._process_from_import(stmt)
             elif isinstance(stmt, ast.FunctionDef):
-                parts.append(self._convert_function(stmt))
+                if stmt.name in self.generators:
+                    function = self._convert_generator(stmt)
+                else:
+                    self.parallel_functions = []
+                    function = self._convert_function(stmt)
+                    if stmt.name in self.memoized:
+                        function = self._memoize_function(stmt, function)
+                    for outlined in self.parallel_functions:
+                        parts.extend([outlined, ""])
+                    self.parallel_functions = None
+                if stmt.name == "main":
+                    main_index = len(parts)
+                if self.source_file is not None:
+                    function = f"{line_directive(stmt.lineno, self.source_file)}\n{function}"
+                parts.append(function)
                 parts.append("")
             elif isinstance(stmt, ast.ClassDef):
                 parts.append(self._convert_class(stmt))
                 parts.append("")
 
-        # Add main function if not present
-        if not any("main" in part for part in parts):
+        if self.string_symbols:
+            assert main_index is not None
+            parts[main_index] = parts[main_index].replace(" {\n", " {\n    mgen_intern_literals();\n", 1)
+            parts[symbols_index:symbols_index] = [self._generate_string_symbols(), ""]
+        if self.sorts_stc_strings:
+            parts[symbols_index:symbols_index] = [self.STC_STRING_SORT, ""]
+        if self.memoized:
+            parts[symbols_index:symbols_index] = [self.MEMO_SLOTS, ""]
+        for dispatch in reversed(self.string_dispatch_functions):
+            parts[symbols_index:symbols_index] = [dispatch, ""]
+        if self.tuple_structs:
+            parts[symbols_index:symbols_index] = [self._generate_tuple_structs(), ""]
+
+        if self.extension_mode:
+            parts.append(self._generate_extension_module(node))
+        elif not any("main" in part for part in parts):
+            # Add main function if not present
             parts.append(self._generate_main_function())
 
+        if self.probe_sites:
+            parts[includes_end:includes_end] = [
+                "#ifndef MGEN_NO_INSTRUMENT",
+                "#define MGEN_INSTRUMENT",
+                "#endif",
+                f"#define MGEN_INSTRUMENT_MAX_SITES {len(self.probe_sites)}",
+                '#include "mgen_instrument.h"',
+            ]
+
+        # Headers first needed while converting the functions (e.g. str indexing)
+        parts[includes_end:includes_end] = sorted(self.includes_needed.difference(includes))
+
+        if self.extension_mode:
+            # Python.h precedes the standard headers, which it may configure
+            parts[0:0] = ["#define PY_SSIZE_T_CLEAN", "#include <Python.h>"]
+
         return "\n".join(parts)
 
+    def _generate_extension_module(self, node: ast.Module) -> str:
+        """CPython wrappers of the module's functions (the "extension" target mode).
+
+        List parameters must be borrowed, so a wrapper can lend the caller's
+        buffer as the vec without the callee changing or keeping it; returned
+        strings are not exported, as their ownership is not tracked.
+        """
+        self.includes_needed.add('#include "mgen_pyext.h"')
+        result_kinds = frozenset({"int", "float", "bool", "None", "list[int]", "list[float]"})
+        functions, skipped = plan_extension(node, self.function_signatures, result_kinds, self.borrowed_params)
+        expected = {"int": "int", "float": "double", "bool": "bool", "str": "char*", "None": "void"}
+        expected.update({"list[int]": "vec_int", "list[float]": "vec_double"})
+        for function in list(functions):
+            # Representations chosen by other preferences (e.g. soa_lists) have no wrapper
+            kinds = [(kind, c_type) for _, kind, c_type in function.parameters] + [function.result]
+            if any(expected[kind] != c_type for kind, c_type in kinds):
+                functions.remove(function)
+                skipped.append(f"{function.name} (C representation of its signature)")
+        init = ["mgen_intern_literals();"] if self.string_symbols else []
+        return render_c_extension(functions, skipped, init)
+
+    # Entries per memo table; a power of two, overridable with -DMGEN_MEMO_SLOTS=N
+    MEMO_SLOTS = "\n".join(["#ifndef MGEN_MEMO_SLOTS", "#define MGEN_MEMO_SLOTS 4096", "#endif"])
+
+    def _memoize_function(self, node: ast.FunctionDef, function: str) -> str:
+        """Wrap a converted pure function in a lookup of its per-thread direct-mapped memo table.
+
+        The converted body becomes static name_compute; name itself hashes the
+        arguments to one of MGEN_MEMO_SLOTS entries and returns the stored
+        result when the entry holds the same arguments, else computes and
+        overwrites it. Recursive calls go through name, so they hit the table.
+        A collision only costs a recomputation, which purity makes invisible.
+        """
+        name = node.name
+        signature, body = function.split("\n", 1)
+        return_type, rest = signature.split(f" {name}(", 1)
+        params = rest[: -len(") {")]
+        keys = [arg.arg for arg in node.args.args]
+        entry = f"{name}_memo_entry"
+        self.includes_needed.add('#include "mgen_error_handling.h"')
+
+        lines = ["typedef struct {", f"    int keys[{len(keys)}];", f"    {return_type} result;", "    bool used;"]
+        lines.extend([f"}} {entry};", "", f"static MGEN_THREAD_LOCAL {entry} {name}_memo[MGEN_MEMO_SLOTS];", ""])
+        lines.extend([f"{return_type} {name}({params});", "", f"static {return_type} {name}_compute({params}) {{"])
+        lines.extend([body, "", f"{return_type} {name}({params}) {{"])
+        lines.append(f"    unsigned mgen_memo_slot = (unsigned){keys[0]};")
+        lines.extend(f"    mgen_memo_slot = mgen_memo_slot * 0x9E3779B1u + (unsigned){key};" for key in keys[1:])
+        lines.append(f"    {entry}* mgen_memo_entry = &{name}_memo[mgen_memo_slot & (MGEN_MEMO_SLOTS - 1)];")
+        matches = " && ".join(f"mgen_memo_entry->keys[{i}] == {key}" for i, key in enumerate(keys))
+        lines.append(f"    if (mgen_memo_entry->used && {matches}) {{")
+        lines.extend(["        return mgen_memo_entry->result;", "    }"])
+        lines.append(f"    {return_type} mgen_memo_result = {name}_compute({', '.join(keys)});")
+        lines.append(f"    *mgen_memo_entry = ({entry}){{{{{', '.join(keys)}}}, mgen_memo_result, true}};")
+        lines.extend(["    return mgen_memo_result;", "}"])
+        return "\n".join(lines)
+
+    def _generate_string_symbols(self) -> str:
+        """Declare the symbols of the literal map keys, and the function main calls to intern them."""
+        lines = [f"static const char* {symbol};" for symbol in self.string_symbols.values()]
+        lines.append("")
+        lines.append("static void mgen_intern_literals(void) {")
+        for literal, symbol in self.string_symbols.items():
+            lines.append(f"    {symbol} = mgen_str_intern({self._convert_expression(ast.Constant(literal))});")
+        lines.append("}")
+        return "\n".join(lines)
+
+    def _str_map_key(self, function: str, key: ast.expr, key_code: str) -> tuple[str, str]:
+        """Function and key argument of a string map call: a literal key passes its interned symbol.
+
+        Args:
+            function: Plain map function, e.g. "mgen_str_int_map_get"
+            key: Key expression
+            key_code: Converted key
+
+        Returns:
+            (function, key) to emit, the *_symbol variant with the symbol for literal keys
+        """
+        if self.string_symbols_enabled and isinstance(key, ast.Constant) and isinstance(key.value, str):
+            symbol = self.string_symbols.setdefault(key.value, f"str_sym_{len(self.string_symbols)}")
+            return f"{function}_symbol", symbol
+        return function, key_code
+
+    def _new_str_int_map(self) -> str:
+        """Constructor call of a fresh string map."""
+        return "mgen_str_int_map_new_interned()" if self.intern_strings else "mgen_str_int_map_new()"
+
     def _detect_string_methods(self, node: ast.AST) -> None:
         """Pre-scan AST to detect string method usage for include generation."""
         for child in ast.walk(node):
@@ -168,7 +477,7 @@ class MGenPythonToCConverter:
                 method_name = child.func.attr
 
                 # Check if this looks like a string method call
-                if method_name in ["upper", "lower", "strip", "find", "replace", "split"]:
+                if method_name in ["upper", "lower", "strip", "find", "count", "replace", "split"]:
                     # For pre-scan, we're more liberal - assume any call to these methods is a string method
                     self.includes_needed.add('#include "mgen_string_ops.h"')
                     break  # Only need to add it once
@@ -259,6 +568,13 @@ class MGenPythonToCConverter:
         """Pre-scan AST to detect container variable declarations for STC generation."""
         # First pass: detect nested container patterns
         self._detect_nested_containers(node)
+        self.flat_matrices = (
+            self.use_runtime
+            and self.preferences.get("flat_matrices", True)
+            and self._can_use_flat_matrices(node)
+        )
+        if self.flat_matrices:
+            self.includes_needed.add('#include "mgen_mat_int.h"')
 
         for child in ast.walk(node):
             # Look for annotated assignments: var: list = ...
@@ -274,6 +590,10 @@ class MGenPythonToCConverter:
                             "element_type": "int",  # Default to int
                             "c_type": self.type_mapping.get(type_annotation, type_annotation),
                         }
+                else:
+                    annotated = self._annotated_container_type(child.annotation)
+                    if annotated:
+                        self.container_variables.setdefault(var_name, {})["container_type"] = annotated
 
     def _detect_nested_containers(self, node: ast.AST) -> None:
         """Detect patterns like matrix.append(row) or result[i][j] = value to identify 2D containers."""
@@ -328,6 +648,280 @@ class MGenPythonToCConverter:
                         if var_name in list_vars:
                             self.nested_containers.add(var_name)
 
+    def _nested_container_type(self, c_type: str = "vec_vec_int") -> str:
+        """C type for a nested int list: row-major mat_int when _can_use_flat_matrices passed."""
+        return "mat_int" if self.flat_matrices and c_type == "vec_vec_int" else c_type
+
+    def _bitset_type(self, name: str, c_type: str) -> str:
+        """bitset_int for a set_int local bounded_int_sets keeps within the bitset_sets limit, else c_type."""
+        if c_type != "set_int" or name not in self.bitset_sets:
+            return c_type
+        self.includes_needed.add('#include "mgen_bitset_int.h"')
+        return "bitset_int"
+
+    def _bitset_reserve(self, name: str) -> list[str]:
+        """Sizing of a new bitset_int local for its whole domain, so inserts never grow it."""
+        if self.variable_context.get(name) != "bitset_int" or not self.bitset_sets.get(name):
+            return []
+        return [f"bitset_int_reserve(&{name}, {self.bitset_sets[name]});"]
+
+    def _can_use_flat_matrices(self, node: ast.AST) -> bool:
+        """Check that every list[list[int]] and nested container is a rectangular int matrix.
+
+        The choice is all-or-nothing for the module, since matrices flow between
+        functions. Rows must be built with the fill pattern
+
+            row: list[int] = []
+            for j in range(cols):
+                row.append(value)
+            matrix.append(row)
+
+        where nothing in the enclosing loop can change cols, so every row has the
+        same length. Otherwise matrices may only be indexed as m[i][j], measured
+        with len(), assigned, passed to user functions or returned.
+        """
+        functions = {f.name: f for f in ast.walk(node) if isinstance(f, ast.FunctionDef)}
+        matrices = set(self.nested_containers)
+        for child in ast.walk(node):
+            if isinstance(child, ast.AnnAssign) and isinstance(child.target, ast.Name):
+                if self._is_int_matrix_annotation(child.annotation):
+                    matrices.add(child.target.id)
+            elif isinstance(child, ast.arg) and self._is_int_matrix_annotation(child.annotation):
+                matrices.add(child.arg)
+        if not matrices:
+            return False
+        matrix_functions = {name for name, f in functions.items() if self._is_int_matrix_annotation(f.returns)}
+
+        parents: dict[ast.AST, ast.AST] = {}
+        for parent in ast.walk(node):
+            for child in ast.iter_child_nodes(parent):
+                parents[child] = parent
+
+        def enclosing_function(child: ast.AST) -> ast.FunctionDef | None:
+            current = parents.get(child)
+            while current is not None and not isinstance(current, ast.FunctionDef):
+                current = parents.get(current)
+            return current
+
+        def is_matrix_value(value: ast.expr | None) -> bool:
+            if isinstance(value, ast.List):
+                return not value.elts
+            if isinstance(value, ast.Call):
+                return isinstance(value.func, ast.Name) and value.func.id in matrix_functions
+            return isinstance(value, ast.Name) and value.id in matrices
+
+        def is_matrix_argument(call: ast.Call, arg: ast.expr) -> bool:
+            if not isinstance(call.func, ast.Name) or call.func.id not in functions or arg not in call.args:
+                return False
+            params = functions[call.func.id].args.args
+            index = call.args.index(arg)
+            return index < len(params) and params[index].arg in matrices
+
+        # Every binding of a matrix is annotated list[list[int]] and every matrix function returns one
+        for child in ast.walk(node):
+            if isinstance(child, ast.FunctionDef):
+                for arg in child.args.args:
+                    if arg.arg in matrices and not self._is_int_matrix_annotation(arg.annotation):
+                        return False
+            elif isinstance(child, ast.AnnAssign) and isinstance(child.target, ast.Name):
+                if child.target.id in matrices:
+                    if not self._is_int_matrix_annotation(child.annotation) or not is_matrix_value(child.value):
+                        return False
+            elif isinstance(child, ast.Return):
+                function = enclosing_function(child)
+                if function is not None and function.name in matrix_functions:
+                    if not isinstance(child.value, ast.Name) or child.value.id not in matrices:
+                        return False
+
+        appended: set[tuple[str, str]] = set()
+        for child in ast.walk(node):
+            parent = parents.get(child)
+            if isinstance(child, ast.Call) and isinstance(child.func, ast.Name) and child.func.id in matrix_functions:
+                # A matrix-valued call is stored, returned or passed on, never indexed directly
+                if isinstance(parent, ast.Return) or (isinstance(parent, ast.AnnAssign) and parent.value is child):
+                    continue
+                if isinstance(parent, ast.Assign) and len(parent.targets) == 1 and is_matrix_value(parent.targets[0]):
+                    continue
+                if isinstance(parent, ast.Call) and is_matrix_argument(parent, child):
+                    continue
+                return False
+
+            if not isinstance(child, ast.Name) or child.id not in matrices:
+                continue
+
+            if isinstance(parent, ast.AnnAssign):
+                if parent.target is child or is_matrix_value(parent.target):
+                    continue
+                return False
+            if isinstance(parent, ast.Assign):
+                if parent.value is child:
+                    if len(parent.targets) == 1 and is_matrix_value(parent.targets[0]):
+                        continue
+                elif len(parent.targets) == 1 and parent.targets[0] is child and is_matrix_value(parent.value):
+                    continue
+                return False
+            if isinstance(parent, ast.Return):
+                function = enclosing_function(child)
+                if function is not None and function.name in matrix_functions:
+                    continue
+                return False
+            if isinstance(parent, ast.Subscript) and parent.value is child:
+                grandparent = parents.get(parent)
+                if isinstance(parent.slice, ast.Slice):
+                    return False
+                if isinstance(grandparent, ast.Subscript) and grandparent.value is parent:
+                    if not isinstance(grandparent.slice, ast.Slice):
+                        continue
+                if self._is_len_call(grandparent, parent):
+                    continue
+                return False
+            if self._is_len_call(parent, child):
+                continue
+            if isinstance(parent, ast.Call) and is_matrix_argument(parent, child):
+                continue
+            if isinstance(parent, ast.Attribute) and parent.attr == "append":
+                call = parents.get(parent)
+                function = enclosing_function(child)
+                if (
+                    isinstance(call, ast.Call)
+                    and call.func is parent
+                    and function is not None
+                    and (function.name, child.id) not in appended
+                    and self._is_rectangular_row_append(function, call, parents, matrices)
+                ):
+                    appended.add((function.name, child.id))
+                    continue
+                return False
+            return False
+
+        return True
+
+    def _is_int_matrix_annotation(self, annotation: ast.expr | None) -> bool:
+        """Check for the annotation list[list[int]]."""
+        return (
+            isinstance(annotation, ast.Subscript)
+            and isinstance(annotation.value, ast.Name)
+            and annotation.value.id == "list"
+            and self._is_int_list_annotation(annotation.slice)
+        )
+
+    def _is_int_list_annotation(self, annotation: ast.expr | None) -> bool:
+        """Check for the annotation list[int]."""
+        return (
+            isinstance(annotation, ast.Subscript)
+            and isinstance(annotation.value, ast.Name)
+            and annotation.value.id == "list"
+            and isinstance(annotation.slice, ast.Name)
+            and annotation.slice.id == "int"
+        )
+
+    def _is_len_call(self, call: ast.AST | None, arg: ast.expr) -> bool:
+        """Check whether call is len(arg)."""
+        return (
+            isinstance(call, ast.Call)
+            and isinstance(call.func, ast.Name)
+            and call.func.id == "len"
+            and len(call.args) == 1
+            and call.args[0] is arg
+        )
+
+    def _is_rectangular_row_append(
+        self, function: ast.FunctionDef, call: ast.Call, parents: dict[ast.AST, ast.AST], matrices: set[str]
+    ) -> bool:
+        """Check that matrix.append(row) appends a row of loop-invariant length (see _can_use_flat_matrices)."""
+        assert isinstance(call.func, ast.Attribute) and isinstance(call.func.value, ast.Name)
+        matrix_name = call.func.value.id
+        statement = parents.get(call)
+        loop = parents.get(statement)
+        if (
+            len(call.args) != 1
+            or not isinstance(call.args[0], ast.Name)
+            or call.args[0].id in matrices
+            or not isinstance(statement, ast.Expr)
+            or not isinstance(loop, ast.For)
+            or statement not in loop.body
+        ):
+            return False
+        row_name = call.args[0].id
+
+        def mentions(tree: ast.AST, name: str) -> bool:
+            return any(isinstance(n, ast.Name) and n.id == name for n in ast.walk(tree))
+
+        def stored_names(tree: ast.AST) -> set[str]:
+            return {n.id for n in ast.walk(tree) if isinstance(n, ast.Name) and isinstance(n.ctx, ast.Store)}
+
+        # Find row: list[int] = [] and the single fill loop before the append; row is unused elsewhere
+        init = fill = None
+        append_index = loop.body.index(statement)
+        for index, stmt in enumerate(loop.body):
+            if index == append_index or not mentions(stmt, row_name):
+                continue
+            if index > append_index:
+                return False
+            if (
+                init is None
+                and isinstance(stmt, ast.AnnAssign)
+                and isinstance(stmt.target, ast.Name)
+                and stmt.target.id == row_name
+                and self._is_int_list_annotation(stmt.annotation)
+                and isinstance(stmt.value, ast.List)
+                and not stmt.value.elts
+            ):
+                init = stmt
+            elif init is not None and fill is None and self._is_row_fill_loop(stmt, row_name):
+                fill = stmt
+            else:
+                return False
+        if fill is None:
+            return False
+
+        # The row length may only depend on constants and names the function never rebinds
+        length = fill.iter.args[0]  # type: ignore[attr-defined]
+        for sub in ast.walk(length):
+            if not isinstance(sub, (ast.Name, ast.Constant, ast.BinOp, ast.UnaryOp, ast.operator, ast.unaryop, ast.Load)):
+                return False
+        if {n.id for n in ast.walk(length) if isinstance(n, ast.Name)} & stored_names(function):
+            return False
+
+        # The matrix starts out empty and is never rebound in this function
+        bindings = [
+            n
+            for n in ast.walk(function)
+            if isinstance(n, (ast.Assign, ast.AnnAssign, ast.AugAssign, ast.For))
+            and matrix_name in stored_names(n.targets[0] if isinstance(n, ast.Assign) else n.target)
+        ]
+        return (
+            len(bindings) == 1
+            and not isinstance(bindings[0], (ast.AugAssign, ast.For))
+            and isinstance(bindings[0].value, ast.List)
+            and not bindings[0].value.elts
+        )
+
+    def _is_row_fill_loop(self, stmt: ast.stmt, row_name: str) -> bool:
+        """Check for: for _ in range(n): row.append(value)."""
+        if not isinstance(stmt, ast.For) or stmt.orelse or len(stmt.body) != 1:
+            return False
+        iter_call = stmt.iter
+        if not (
+            isinstance(iter_call, ast.Call)
+            and isinstance(iter_call.func, ast.Name)
+            and iter_call.func.id == "range"
+            and len(iter_call.args) == 1
+            and not iter_call.keywords
+        ):
+            return False
+        body = stmt.body[0]
+        return (
+            isinstance(body, ast.Expr)
+            and isinstance(body.value, ast.Call)
+            and isinstance(body.value.func, ast.Attribute)
+            and body.value.func.attr == "append"
+            and isinstance(body.value.func.value, ast.Name)
+            and body.value.func.value.id == row_name
+            and len(body.value.args) == 1
+            and not any(isinstance(n, ast.Name) and n.id == row_name for n in ast.walk(body.value.args[0]))
+        )
+
     def _generate_includes(self) -> list[str]:
         """Generate C includes with MGen runtime support."""
         includes = [
@@ -341,6 +935,10 @@ class MGenPythonToCConverter:
             includes.append("#include <assert.h>")
 
         if self.use_runtime:
+            # Must precede the runtime headers: selects MGEN_RC_RETAIN/RELEASE variants
+            if self.preferences.get("atomic_refcounts", False):
+                includes.append("#define MGEN_ATOMIC_REFCOUNTS")
+
             includes.extend(
                 [
                     '#include "mgen_error_handling.h"',
@@ -352,9 +950,8 @@ class MGenPythonToCConverter:
             if self.container_variables or self._needs_containers():
                 includes.append('#include "mgen_stc_bridge.h"')
 
-            # Check if we need vanilla C string-to-int map (only in runtime mode)
-            container_mode = self.preferences.get("container_mode", "runtime")
-            if self._uses_str_int_map() and container_mode == "runtime":
+            # Check if we need vanilla C string-to-int map (emitted inline with hand-written containers)
+            if self._uses_str_int_map() and not self._hand_written_containers():
                 includes.append('#include "mgen_str_int_map.h"')
 
         # Note: STC includes are handled in _generate_container_declarations()
@@ -402,6 +999,8 @@ class MGenPythonToCConverter:
         for var_info in self.container_variables.values():
             if "element_type" in var_info:
                 container_types.add(var_info["element_type"])
+            if "container_type" in var_info:
+                c_types_used.add(var_info["container_type"])
 
         # Add types for comprehensions (basic integer support for now)
         if hasattr(self, "uses_comprehensions") and self.uses_comprehensions:
@@ -425,6 +1024,11 @@ class MGenPythonToCConverter:
             # Set declaration
             c_types_used.add(f"set_{sanitized}")
 
+        # Flat matrices replace vec_vec_int; their rows are still built in vec_int
+        if self.flat_matrices and "vec_vec_int" in c_types_used:
+            c_types_used.discard("vec_vec_int")
+            c_types_used.add("vec_int")
+
         # Now generate STC declarations for all unique types
         # Sort to ensure vec_int comes before vec_vec_int
         generated_types = set()
@@ -446,10 +1050,17 @@ class MGenPythonToCConverter:
                             "",
                         ]
                     )
+                use_cmp = ["#define i_use_cmp"] if element_type in self.STC_COMPARABLE_ELEMENTS else []
+                aligned = []
+                if self.aligned_vectors and c_type in self.ALIGNED_VECTOR_ELEMENTS:
+                    # mgen_aligned_malloc() and friends; STC undefines i_allocator after the instantiation
+                    aligned = ['#include "mgen_aligned_alloc.h"', "#define i_allocator mgen_aligned"]
                 declarations.extend(
                     [
+                        *aligned,
                         f"#define i_type {c_type}",
                         f"#define i_key {element_type}",
+                        *use_cmp,
                         '#include "stc/vec.h"',
                         "#undef i_type",
                         "#undef i_key",
@@ -524,6 +1135,8 @@ class MGenPythonToCConverter:
         for var_info in self.container_variables.values():
             if "element_type" in var_info:
                 container_types.add(var_info["element_type"])
+            if "container_type" in var_info:
+                c_types_used.add(var_info["container_type"])
 
         # Add types for comprehensions
         if hasattr(self, "uses_comprehensions") and self.uses_comprehensions:
@@ -544,6 +1157,11 @@ class MGenPythonToCConverter:
         # Generate inline implementations for containers
         generated_containers = set()
 
+        # Flat matrices replace vec_vec_int; their rows are still built in vec_int
+        if self.flat_matrices and "vec_vec_int" in c_types_used:
+            c_types_used.discard("vec_vec_int")
+            c_types_used.add("vec_int")
+
         # Generate vec_int first if needed (vec_vec_int depends on it)
         if "vec_vec_int" in c_types_used and "vec_int" not in c_types_used:
             c_types_used.add("vec_int")
@@ -552,26 +1170,16 @@ class MGenPythonToCConverter:
             if c_type in generated_containers:
                 continue
 
-            # Generate supported container types
+            # Hand-tuned containers where they exist, any other vec_T/set_T/map_K_V from the templates
             # Note: vec_int must be generated before vec_vec_int (dependency)
-            if c_type in [
-                "map_str_int",
-                "vec_int",
-                "set_int",
-                "map_int_int",
-                "vec_vec_int",
-                "vec_cstr",
-                "vec_float",
-                "vec_double",
-                "map_str_str",
-                "set_str",
-            ]:
-                generated_code = self.container_generator.generate_container(c_type)
-                if generated_code:
-                    code_lines.append(generated_code)
-                    generated_containers.add(c_type)
-            # For other containers, fall back to STC (for now)
-            # Future: Generate parameterized containers for arbitrary types
+            generated_code = self.container_generator.generate_container(c_type)
+            if generated_code:
+                code_lines.append(generated_code)
+                generated_containers.add(c_type)
+                # The inline code has no includes of its own; these join the includes section
+                self.includes_needed.update(
+                    f"#include {header}" for header in self.container_generator.get_required_includes(c_type)
+                )
 
         return code_lines
 
@@ -585,7 +1193,10 @@ class MGenPythonToCConverter:
         for arg in node.args.args:
             param_type = self._get_type_annotation(arg.annotation) if arg.annotation else "int"
             # Use enhanced type inference for complex types like list[list[int]]
-            if param_type in self.type_mapping:
+            tuple_type = self._tuple_type(arg.annotation)
+            if tuple_type:
+                c_type = tuple_type
+            elif param_type in self.type_mapping:
                 c_type = self.type_mapping[param_type]
             else:
                 # Use enhanced type inference engine for complex/nested types
@@ -594,10 +1205,12 @@ class MGenPythonToCConverter:
             # Check if this parameter is detected as a nested container
             if arg.arg in self.nested_containers and c_type == "vec_int":
                 c_type = "vec_vec_int"
+            c_type = self._nested_container_type(c_type)
 
             # Special case: map_str_int uses pointer type
             if c_type == "map_str_int":
                 c_type = "mgen_str_int_map_t*"
+            c_type = self._soa_list_type(arg.annotation) or c_type
 
             params.append(f"{c_type} {arg.arg}")
             self.variable_context[arg.arg] = c_type
@@ -607,7 +1220,11 @@ class MGenPythonToCConverter:
         if node.returns:
             py_return_type = self._get_type_annotation(node.returns)
             # Use enhanced type inference for complex types like list[list[int]]
-            if py_return_type in self.type_mapping:
+            tuple_type = self._tuple_type(node.returns)
+            if tuple_type:
+                # Multiple return values come back in registers or the caller's frame, not the heap
+                return_type = tuple_type
+            elif py_return_type in self.type_mapping:
                 return_type = self.type_mapping[py_return_type]
             else:
                 # Use enhanced type inference engine for complex/nested types
@@ -627,6 +1244,7 @@ class MGenPythonToCConverter:
                             if returned_var in self.nested_containers:
                                 return_type = "vec_vec_int"
                                 break
+            return_type = self._nested_container_type(return_type)
 
         # Build function signature
         params_str = ", ".join(params) if params else "void"
@@ -634,13 +1252,53 @@ class MGenPythonToCConverter:
 
         # Store function return type for call site inference
         self.function_return_types[node.name] = return_type
+        self.function_signatures[node.name] = ([param.rsplit(" ", 1)[0] for param in params], return_type)
+
+        # Route temporary strings into a per-call scope arena when it is safe to
+        if self.preferences.get("scope_temporaries", False) and self._can_scope_temporaries(node):
+            self.scope_allocator_var = "mgen_scope"
+            self.includes_needed.add('#include "mgen_string_ops.h"')
+
+        if self.preferences.get("container_lifetimes", True):
+            self.container_lifetimes = ContainerLifetimePlanner(self.borrowed_params).plan(node)
+        self.string_views = self._plan_string_views(node)
+        if self.preferences.get("slice_views", True):
+            self.slice_views = self._plan_slice_views(node)
+        if self.aligned_vectors:
+            self.fresh_vectors = self._plan_fresh_vectors(node)
+        bitset_limit = int(self.preferences.get("bitset_sets", 65536))
+        self.bitset_sets = bounded_int_sets(node, bitset_limit) if bitset_limit > 0 else {}
+        if self._checks_int_overflow():
+            self.overflow_free = overflow_free_arithmetic(node)
+        if self.preferences.get("string_dispatch", True):
+            self.constant_str_dicts = self._plan_constant_str_dicts(node)
 
         # Convert function body
         body_lines = []
+        if self.preferences.get("instrument", False):
+            self.probe_function = node.name
+            body_lines.append(self._open_probe("function", node.lineno))
+        if self.scope_allocator_var:
+            body_lines.append(f"mgen_scope_allocator_t* {self.scope_allocator_var} = mgen_scope_new();")
+        for name, view in self.string_views.items():
+            body_lines.append(f"mgen_utf8_str_t {view} = mgen_utf8_view({name});")
         for stmt in node.body:
             converted = self._convert_statement(stmt)
             if converted:
                 body_lines.extend(converted.split("\n"))
+        self.probe_function = None
+        if not (node.body and isinstance(node.body[-1], ast.Return)):
+            body_lines.extend(self._string_view_releases())
+            if self.scope_allocator_var:
+                body_lines.append(f"mgen_scope_free({self.scope_allocator_var});")
+        self.scope_allocator_var = None
+        self.container_lifetimes = ContainerLifetimes()
+        self.string_views = {}
+        self.slice_views = set()
+        self.fresh_vectors = set()
+        self.bitset_sets = {}
+        self.overflow_free = set()
+        self.constant_str_dicts = {}
 
         # Format function
         body = "\n".join(f"    {line}" if line.strip() else "" for line in body_lines)
@@ -649,10 +1307,422 @@ class MGenPythonToCConverter:
         self.current_function_ast = None
         return f"{signature} {{\n{body}\n}}"
 
+    # Annotations of a generator function's return type; the first subscript argument is what it yields
+    GENERATOR_ANNOTATIONS = frozenset({"Iterator", "Iterable", "Generator"})
+    COROUTINE_FRAME = "co"
+
+    def _detect_generators(self, node: ast.Module) -> None:
+        """Find the generator functions of a module and the type each one yields."""
+        self.generators = {}
+        for stmt in node.body:
+            if not isinstance(stmt, ast.FunctionDef):
+                continue
+            if not any(isinstance(child, (ast.Yield, ast.YieldFrom)) for child in ast.walk(stmt)):
+                continue
+            yield_type = "int"
+            returns = stmt.returns
+            if isinstance(returns, ast.Subscript):
+                container = returns.value.attr if isinstance(returns.value, ast.Attribute) else returns.value
+                container_name = container if isinstance(container, str) else getattr(container, "id", "")
+                if container_name in self.GENERATOR_ANNOTATIONS:
+                    element = returns.slice.elts[0] if isinstance(returns.slice, ast.Tuple) else returns.slice
+                    yield_type = self._annotation_c_type(element)
+            self.generators[stmt.name] = ([arg.arg for arg in stmt.args.args], yield_type)
+            self.includes_needed.add('#include "stc/coroutine.h"')
+
+    def _annotation_c_type(self, annotation: ast.expr) -> str:
+        """C type of a parameter or local annotation."""
+        py_type = self._get_type_annotation(annotation)
+        if py_type in self.type_mapping:
+            return self.type_mapping[py_type]
+        return self.type_engine._map_python_to_c_type(py_type)
+
+    def _convert_generator(self, node: ast.FunctionDef) -> str:
+        """Convert a generator function to an STC stackless coroutine.
+
+        Parameters and locals move into a frame struct, so they survive between
+        resumes. The function runs until the next yield, storing the value in
+        the frame, and returns nonzero; it returns CCO_DONE once exhausted.
+        """
+        frame = self.COROUTINE_FRAME
+        params, yield_type = self.generators[node.name]
+        fields: dict[str, str] = {}
+        for arg in node.args.args:
+            fields[arg.arg] = self._annotation_c_type(arg.annotation) if arg.annotation else "int"
+        for child in ast.walk(node):
+            if isinstance(child, (ast.YieldFrom, ast.Try, ast.With, ast.FunctionDef, ast.Lambda)) and child is not node:
+                raise UnsupportedFeatureError(f"Generator {node.name}: {type(child).__name__} is not supported")
+            if isinstance(child, ast.AnnAssign) and isinstance(child.target, ast.Name):
+                c_type = self._annotation_c_type(child.annotation)
+                if c_type not in ("int", "double", "bool", "char*"):
+                    raise UnsupportedFeatureError(f"Generator {node.name}: local {child.target.id} must be a scalar")
+                fields.setdefault(child.target.id, c_type)
+            elif isinstance(child, ast.For) and isinstance(child.target, ast.Name):
+                fields.setdefault(child.target.id, self._generator_loop_type(node.name, child, fields))
+            elif isinstance(child, ast.Return) and child.value is not None:
+                raise UnsupportedFeatureError(f"Generator {node.name}: return with a value is not supported")
+        if "yielded" in fields:
+            raise UnsupportedFeatureError(f"Generator {node.name}: 'yielded' names the frame's value slot")
+        for child in ast.walk(node):
+            if isinstance(child, ast.Name) and isinstance(child.ctx, ast.Store) and child.id not in fields:
+                raise UnsupportedFeatureError(f"Generator {node.name}: local {child.id} needs an annotation")
+
+        self.current_function = node.name
+        self.current_function_ast = node
+        self.function_return_types[node.name] = "int"
+        self.coroutine_fields = {name: f"{frame}->{name}" for name in fields}
+        self.coroutine_extra_fields = []
+        for name, c_type in fields.items():
+            self.variable_context[self.coroutine_fields[name]] = c_type
+
+        body_lines = []
+        frame_body = _CoroutineFrameRenamer(self.coroutine_fields).visit(ast.Module(body=node.body, type_ignores=[]))
+        for stmt in frame_body.body:
+            converted = self._convert_statement(stmt)
+            if converted:
+                body_lines.extend(converted.split("\n"))
+
+        struct_name = f"{node.name}_gen"
+        lines = ["typedef struct {", "    cco_base base;"]
+        lines.extend(f"    {c_type} {name};" for name, c_type in fields.items())
+        lines.extend(f"    {c_type} {name};" for name, c_type in self.coroutine_extra_fields)
+        lines.append(f"    {yield_type} yielded;")
+        lines.append(f"}} {struct_name};")
+        lines.append("")
+        lines.append(f"int {node.name}({struct_name}* {frame}) {{")
+        lines.append(f"    cco_async ({frame}) {{")
+        lines.extend(f"        {line}" if line.strip() else "" for line in body_lines)
+        lines.append("    }")
+        lines.append("    return CCO_DONE;")
+        lines.append("}")
+
+        self.coroutine_fields = {}
+        self.coroutine_extra_fields = []
+        self.current_function = None
+        self.current_function_ast = None
+        return "\n".join(lines)
+
+    def _generator_loop_type(self, generator: str, loop: ast.For, fields: dict[str, str]) -> str:
+        """C type of a generator's loop variable: range() counters and elements of list fields."""
+        if isinstance(loop.iter, ast.Call) and isinstance(loop.iter.func, ast.Name) and loop.iter.func.id == "range":
+            return "int"
+        if isinstance(loop.iter, ast.Name) and fields.get(loop.iter.id, "").startswith("vec_"):
+            return fields[loop.iter.id][4:]
+        raise UnsupportedFeatureError(f"Generator {generator}: loops must iterate range() or a list")
+
+    def _generator_frame(self, call: ast.expr) -> Optional[tuple[str, str, str]]:
+        """Declaration of a fresh frame for a call of a generator function, its variable and yielded type."""
+        if not self._is_generator_call(call):
+            return None
+        assert isinstance(call, ast.Call) and isinstance(call.func, ast.Name)
+        if self.coroutine_fields:
+            raise UnsupportedFeatureError("Generators cannot be consumed inside another generator")
+        params, yield_type = self.generators[call.func.id]
+        if len(call.args) > len(params):
+            raise UnsupportedFeatureError(f"Too many arguments for generator {call.func.id}")
+        bound = dict(zip(params, call.args))
+        for keyword in call.keywords:
+            if keyword.arg not in params:
+                raise UnsupportedFeatureError(f"Unknown argument {keyword.arg} for generator {call.func.id}")
+            bound[keyword.arg] = keyword.value
+        initializers = ", ".join(
+            f".{name} = {self._convert_expression(bound[name])}" for name in params if name in bound
+        )
+        var = self._generate_temp_var_name("gen")
+        return f"{call.func.id}_gen {var} = {{{initializers}}};", var, yield_type
+
+    def _is_generator_call(self, expr: ast.expr) -> bool:
+        """Check whether an expression calls one of the module's generator functions."""
+        return isinstance(expr, ast.Call) and isinstance(expr.func, ast.Name) and expr.func.id in self.generators
+
+    def _convert_generator_reduction(self, func_name: str, call: ast.expr) -> Optional[str]:
+        """sum(), any() or all() over a generator call, consuming it one value at a time."""
+        frame = self._generator_frame(call)
+        if frame is None:
+            return None
+        declaration, var, yield_type = frame
+        resume = f"{call.func.id}(&{var})"  # type: ignore[attr-defined]
+        result = self._generate_temp_var_name(func_name)
+        if func_name == "sum":
+            loop = f"{yield_type} {result} = 0; while ({resume}) {result} += {var}.yielded;"
+        elif yield_type in ("char*", "const char*"):
+            raise UnsupportedFeatureError(f"{func_name}() over a string generator is not supported")
+        elif func_name == "any":
+            loop = f"bool {result} = false; while (!{result} && {resume}) {result} = {var}.yielded;"
+        else:
+            loop = f"bool {result} = true; while ({result} && {resume}) {result} = {var}.yielded;"
+        return f"({{ {declaration} {loop} {result}; }})"
+
+    def _convert_yield(self, expr: ast.Yield) -> str:
+        """Store the yielded value in the frame and suspend the coroutine."""
+        value = self._convert_expression(expr.value) if expr.value is not None else "0"
+        return f"{self.COROUTINE_FRAME}->yielded = {value};\ncco_yield;"
+
     def _convert_statement(self, stmt: ast.stmt) -> str:
-        """Convert Python statement to C code."""
+        """Convert Python statement to C code, releasing the local containers it last uses."""
+        donor = self.container_lifetimes.recycles.get(id(stmt))
+        if self.probe_function is not None and isinstance(stmt, (ast.For, ast.While)):
+            # Probe objects live until the end of the enclosing block: close them after the loop
+            site = len(self.probe_sites)
+            probe = self._open_probe("loop", stmt.lineno)
+            loop = self._convert_single_statement(stmt)
+            converted = "\n".join([probe, loop, f"MGEN_PROBE_CLOSE(mgen_probe_{site});"])
+        else:
+            converted = self._convert_single_statement(stmt)
+        if donor is not None:
+            converted = self._recycle_container(stmt, donor, converted)
+        drops = self._container_drops(self.container_lifetimes.drops_after.get(id(stmt), []))
+        converted = "\n".join([converted, *drops]) if converted and drops else converted or "\n".join(drops)
+        if converted and self.source_file is not None:
+            return f"{line_directive(stmt.lineno, self.source_file)}\n{converted}"
+        return converted
+
+    def _open_probe(self, kind: str, line: int) -> str:
+        """Register an instrumentation site in the current function and open its probe (see mgen_instrument.h)."""
+        assert self.probe_function is not None
+        site = len(self.probe_sites)
+        self.probe_sites.append((self.probe_function, kind, line))
+        return f'MGEN_PROBE(mgen_probe_{site}, {site}, "{self.probe_function}", "{kind}", {line});'
+
+    # Containers whose elements own nothing, so a drop frees everything and nothing else points into them
+    LIFETIME_ELEMENT_TYPES = frozenset({"int", "float", "double", "bool", "char"})
+
+    def _is_managed_container(self, c_type: Optional[str]) -> bool:
+        """Check whether a local of this type is dropped by the lifetime plan."""
+        if c_type is None:
+            return False
+        if c_type.startswith(("vec_", "set_")):
+            return c_type[4:] in self.LIFETIME_ELEMENT_TYPES
+        if c_type == "bitset_int" or self._soa_class_of_type(c_type):
+            return True
+        if c_type.startswith("map_"):
+            parts = c_type[4:].split("_")
+            return len(parts) == 2 and all(part in self.LIFETIME_ELEMENT_TYPES for part in parts)
+        return False
+
+    def _container_drops(self, names: list[str]) -> list[str]:
+        """Drop calls for the planned locals whose type the lifetime plan manages."""
+        drops = []
+        for name in names:
+            c_type = self.variable_context.get(name)
+            if self._is_managed_container(c_type):
+                drops.append(f"{c_type}_drop(&{name});")
+        return drops
+
+    def _plan_slice_views(self, node: ast.FunctionDef) -> set[int]:
+        """Contiguous list slices that can alias their source instead of copying it.
+
+        A slice passed positionally to a borrowed parameter (ImmutabilityAnalyzer)
+        is only read during the call, so the callee gets a vector struct over the
+        source's elements. The source must not appear in the call's other
+        arguments, which could resize it while the view is in use.
+        """
+        views: set[int] = set()
+        for call in ast.walk(node):
+            if not (isinstance(call, ast.Call) and isinstance(call.func, ast.Name)):
+                continue
+            borrowed = self.borrowed_params.get(call.func.id, set())
+            for index, arg in enumerate(call.args):
+                if not (
+                    index in borrowed
+                    and isinstance(arg, ast.Subscript)
+                    and isinstance(arg.slice, ast.Slice)
+                    and arg.slice.step is None
+                    and isinstance(arg.value, ast.Name)
+                ):
+                    continue
+                source = arg.value.id
+                others = [other for other in call.args if other is not arg] + [kw.value for kw in call.keywords]
+                if not any(
+                    isinstance(child, ast.Name) and child.id == source for other in others for child in ast.walk(other)
+                ):
+                    views.add(id(arg))
+        return views
+
+    def _plan_fresh_vectors(self, node: ast.FunctionDef) -> set[str]:
+        """Locals whose every binding is a list display, comprehension or repetition the function allocates.
+
+        Their buffers come from the aligned allocator, and no other name in the
+        function refers to them. Parameters may be slice views or, in extension
+        modules, the caller's buffers, so they never qualify; nor does a local
+        that takes over the buffer of a dead local that does not (see
+        ContainerLifetimePlanner).
+        """
+        fresh: set[str] = set()
+        rebound: set[str] = {arg.arg for arg in node.args.args}
+        for child in ast.walk(node):
+            if isinstance(child, (ast.Assign, ast.AnnAssign)):
+                targets = child.targets if isinstance(child, ast.Assign) else [child.target]
+                allocates = isinstance(child.value, (ast.List, ast.ListComp)) or (
+                    isinstance(child.value, ast.BinOp)
+                    and isinstance(child.value.op, ast.Mult)
+                    and isinstance(child.value.left, ast.List)
+                )
+                for target in targets:
+                    if isinstance(target, ast.Name) and (allocates or child.value is None):
+                        fresh.add(target.id)
+                    else:
+                        rebound.update(self._bound_names(target))
+            elif isinstance(child, (ast.AugAssign, ast.For, ast.comprehension, ast.NamedExpr)):
+                rebound.update(self._bound_names(child.target))
+            elif isinstance(child, ast.withitem) and child.optional_vars is not None:
+                rebound.update(self._bound_names(child.optional_vars))
+        fresh -= rebound
+        donated = {stmt for stmt, donor in self.container_lifetimes.recycles.items() if donor not in fresh}
+        for child in ast.walk(node):
+            if id(child) in donated and isinstance(child, (ast.Assign, ast.AnnAssign)):
+                targets = child.targets if isinstance(child, ast.Assign) else [child.target]
+                fresh.difference_update(target.id for target in targets if isinstance(target, ast.Name))
+        return fresh
+
+    @staticmethod
+    def _bound_names(target: ast.expr) -> set[str]:
+        """Names an assignment target rebinds (element and attribute stores rebind none)."""
+        if isinstance(target, ast.Name):
+            return {target.id}
+        if isinstance(target, (ast.Tuple, ast.List)):
+            return {name for element in target.elts for name in MGenPythonToCConverter._bound_names(element)}
+        if isinstance(target, ast.Starred):
+            return MGenPythonToCConverter._bound_names(target.value)
+        return set()
+
+    def _aligns_loop(self, loop: str) -> bool:
+        """Whether a converted loop is one the vectorization detector proved independent, under aligned_vectors."""
+        return self.aligned_vectors and loop.startswith("MGEN_LOOP_INDEPENDENT\n")
+
+    def _aligned_loop(self, loop: str, own_block: bool = True) -> str:
+        """Read and write a loop's vectors through aligned restrict pointers hoisted before it.
+
+        Applies when every vector the loop names is a fresh local (see
+        _plan_fresh_vectors) used only for its size and direct element
+        accesses: the buffers are then distinct, MGEN_VEC_ALIGNMENT-aligned and
+        not reallocated while the loop runs. The loop and its pointers share a
+        block of their own unless own_block is False (the loop is the body of
+        a block already).
+        """
+        named = {word for word in re.findall(r"\b[A-Za-z_]\w*\b", loop) if word in self.variable_context}
+        vectors = {name for name in named if self.variable_context[name].startswith("vec_")}
+        if not vectors or not vectors <= self.fresh_vectors:
+            return loop
+        pointers = []
+        for name in sorted(vectors):
+            c_type = self.variable_context[name]
+            element = self.ALIGNED_VECTOR_ELEMENTS.get(c_type)
+            pointer = f"{name}_aligned"
+            uses = re.sub(rf"(?<![\w.]){name}\.data\[|{c_type}_size\(&{name}\)", "", loop)
+            if element is None or pointer in self.variable_context or re.search(rf"(?<![\w.]){name}\b", uses):
+                return loop
+            pointers.append((name, element, pointer))
+        lines = []
+        for name, element, pointer in pointers:
+            lines.append(f"{element}* MGEN_RESTRICT {pointer} = MGEN_ASSUME_ALIGNED({name}.data);")
+            loop = re.sub(rf"(?<![\w.]){name}\.data\[", f"{pointer}[", loop)
+        lines.extend(loop.split("\n"))
+        if not own_block:
+            return "\n".join(lines)
+        return "\n".join(["{", *(f"    {line}" for line in lines), "}"])
+
+    def _plan_string_views(self, node: ast.FunctionDef) -> dict[str, str]:
+        """str parameters that get a code point view: indexed or len()'d inside a loop, never rebound.
+
+        A one-off s[i] or len(s) costs one pass either way; in a loop the view makes
+        len() O(1) and s[i] a lookup in its sparse index instead of a walk from the start.
+        """
+        params = {arg.arg for arg in node.args.args if self.variable_context.get(arg.arg) in ("char*", "const char*")}
+        if not params:
+            return {}
+        rebound = {
+            child.id for child in ast.walk(node) if isinstance(child, ast.Name) and isinstance(child.ctx, ast.Store)
+        }
+        views: dict[str, str] = {}
+        for loop in ast.walk(node):
+            if not isinstance(loop, (ast.For, ast.While)):
+                continue
+            for child in ast.walk(loop):
+                name = None
+                if isinstance(child, ast.Subscript) and isinstance(child.value, ast.Name):
+                    name = child.value.id
+                elif (
+                    isinstance(child, ast.Call)
+                    and isinstance(child.func, ast.Name)
+                    and child.func.id == "len"
+                    and len(child.args) == 1
+                    and isinstance(child.args[0], ast.Name)
+                ):
+                    name = child.args[0].id
+                if name in params and name not in rebound:
+                    views[name] = f"{name}_utf8"
+        if views:
+            self.includes_needed.add('#include "mgen_utf8.h"')
+        return dict(sorted(views.items()))
+
+    def _string_view_releases(self) -> list[str]:
+        """Release calls for the current function's string views."""
+        return [f"mgen_utf8_release(&{view});" for view in self.string_views.values()]
+
+    def _string_index(self, name: str, index: str) -> str:
+        """s[i] of a string as a new one-code-point string."""
+        self.includes_needed.add('#include "mgen_utf8.h"')
+        if name in self.string_views:
+            return f"mgen_utf8_at(&{self.string_views[name]}, {index})"
+        return f"mgen_utf8_str_at({name}, {index})"
+
+    def _string_char_test(self, expr: ast.expr, other: str) -> Optional[str]:
+        """s[i] == other for a string subscript expr, or None if expr is not one."""
+        if not (
+            isinstance(expr, ast.Subscript)
+            and not isinstance(expr.slice, ast.Slice)
+            and isinstance(expr.value, ast.Name)
+            and self.variable_context.get(expr.value.id) in ("char*", "const char*")
+        ):
+            return None
+        index = self._convert_expression(expr.slice)
+        name = expr.value.id
+        if name in self.string_views:
+            return f"mgen_utf8_char_is(&{self.string_views[name]}, {index}, {other})"
+        return f"mgen_utf8_str_char_is({name}, {index}, {other})"
+
+    def _string_slice(self, expr: ast.Subscript) -> str:
+        """s[a:b] of a string (code point bounds, Python clamping) as a new string."""
+        slice_obj = expr.slice
+        assert isinstance(slice_obj, ast.Slice) and isinstance(expr.value, ast.Name)
+        if slice_obj.step is not None:
+            raise UnsupportedFeatureError("String slices with a step are not supported")
+        self.includes_needed.add('#include "mgen_utf8.h"')
+        start = self._convert_expression(slice_obj.lower) if slice_obj.lower else "0"
+        stop = self._convert_expression(slice_obj.upper) if slice_obj.upper else "MGEN_UTF8_END"
+        name = expr.value.id
+        if name in self.string_views:
+            return f"mgen_utf8_slice(&{self.string_views[name]}, {start}, {stop})"
+        return f"mgen_utf8_str_slice({name}, {start}, {stop})"
+
+    def _recycle_container(self, stmt: ast.stmt, donor: str, converted: str) -> str:
+        """Let a new container take over a dead local's buffer instead of allocating its own.
+
+        The declaration `T name = {0};` becomes `T name = donor;` plus a clear(),
+        which keeps the donor's capacity. Declarations of another type or form
+        drop the donor first instead.
+        """
+        name = stmt.targets[0].id if isinstance(stmt, ast.Assign) else stmt.target.id  # type: ignore[attr-defined]
+        c_type = self.variable_context.get(name)
+        first, _, rest = converted.partition("\n")
+        if c_type == self.variable_context.get(donor) and self._is_managed_container(c_type):
+            if first == f"{c_type} {name} = {{0}};":
+                recycled = [f"{c_type} {name} = {donor};", f"{c_type}_clear(&{name});"]
+                return "\n".join([*recycled, rest] if rest else recycled)
+        return "\n".join([*self._container_drops([donor]), converted])
+
+    def _convert_single_statement(self, stmt: ast.stmt) -> str:
+        """Convert one Python statement to C code."""
+        update = match_dict_update(stmt)
+        if update is not None:
+            fused = self._convert_dict_update(update)
+            if fused is not None:
+                return fused
         if isinstance(stmt, ast.Return):
             return self._convert_return(stmt)
+        elif isinstance(stmt, ast.Expr) and isinstance(stmt.value, ast.Yield):
+            return self._convert_yield(stmt.value)
         elif isinstance(stmt, ast.Assign):
             return self._convert_assignment(stmt)
         elif isinstance(stmt, ast.AnnAssign):
@@ -662,9 +1732,9 @@ class MGenPythonToCConverter:
         elif isinstance(stmt, ast.If):
             return self._convert_if(stmt)
         elif isinstance(stmt, ast.While):
-            return self._convert_while(stmt)
+            return self._convert_loop_with_string_builders(stmt, self._convert_while)
         elif isinstance(stmt, ast.For):
-            return self._convert_for(stmt)
+            return self._convert_loop_with_string_builders(stmt, self._convert_for)
         elif isinstance(stmt, ast.Expr):
             return self._convert_expression_statement(stmt)
         elif isinstance(stmt, ast.ClassDef):
@@ -683,16 +1753,42 @@ class MGenPythonToCConverter:
         Python programs may return meaningful values, but Unix convention is
         0 = success, non-zero = failure.
         """
+        if self.coroutine_fields:
+            # A generator's return ends it: the next resume reports CCO_DONE
+            return "cco_exit();"
+        scope = self.scope_allocator_var
+        # Local containers still live here are dropped, and the scope freed, after the value is computed
+        releases = self._container_drops(self.container_lifetimes.return_drops.get(id(stmt), []))
+        releases.extend(self._string_view_releases())
+        if scope:
+            releases.append(f"mgen_scope_free({scope});")
         if stmt.value is None:
-            return "return;"
+            return "\n".join([*releases, "return;"])
 
         # Special case: main() should always return 0 for Unix compatibility
         if self.current_function == "main":
             # If returning a value from main, just return 0 instead
-            return "return 0;"
+            return "\n".join([*releases, "return 0;"])
 
-        value_expr = self._convert_expression(stmt.value)
-        return f"return {value_expr};"
+        return_type = self.function_return_types.get(self.current_function or "", "int")
+        if isinstance(stmt.value, ast.Tuple) and return_type in self.tuple_structs:
+            value_expr = self._convert_tuple_literal(stmt.value, return_type)
+        else:
+            value_expr = self._convert_expression(stmt.value)
+        if not releases:
+            return f"return {value_expr};"
+
+        # Strings are copied out of the scope because the caller outlives this call's temporaries
+        if return_type == "void":
+            return "\n".join([f"{value_expr};", *releases, "return;"])
+        result_var = self._generate_temp_var_name("result")
+        if (
+            scope
+            and return_type == "char*"
+            and not (isinstance(stmt.value, ast.Constant) and isinstance(stmt.value.value, str))
+        ):
+            value_expr = f"mgen_strdup({value_expr})"
+        return "\n".join([f"{return_type} {result_var} = {value_expr};", *releases, f"return {result_var};"])
 
     def _convert_assignment(self, stmt: ast.Assign) -> str:
         """Convert assignment statement."""
@@ -701,7 +1797,17 @@ class MGenPythonToCConverter:
 
         target = stmt.targets[0]
 
+        if isinstance(target, ast.Name) and target.id in self.string_builders:
+            return self._convert_string_builder_append(stmt)
+        if isinstance(target, ast.Name) and target.id in self.constant_str_dicts:
+            return ""  # A static table (_plan_constant_str_dicts)
+
+        if isinstance(target, ast.Tuple):
+            return self._convert_tuple_assignment(target, stmt.value)
+
         # Handle attribute assignment (e.g., self.attr = value or obj.attr = value)
+        if isinstance(target, ast.Attribute) and self._soa_field(target):
+            return f"{self._soa_field(target)} = {self._convert_expression(stmt.value)};"
         if isinstance(target, ast.Attribute):
             obj = self._convert_expression(target.value)
             attr_name = target.attr
@@ -737,9 +1843,21 @@ class MGenPythonToCConverter:
                     elif var_name in self.inferred_types:
                         c_type = self.inferred_types[var_name].c_type
 
-                    if c_type == "vec_vec_int":
+                    if c_type == "mat_int":
+                        element = self._bounds_checked(
+                            [target.value, target],
+                            f"*mat_int_at(&{var_name}, {inner_index}, {index})",
+                            f"{var_name}.data[({inner_index}) * {var_name}.stride + ({index})]",
+                        )
+                        return f"{element} = {value_expr};"
+                    elif c_type == "vec_vec_int":
                         # 2D array assignment: get pointer to inner vec, then assign to its data
-                        return f"vec_vec_int_at(&{var_name}, {inner_index})->data[{index}] = {value_expr};"
+                        row = self._bounds_checked(
+                            [target.value],
+                            f"vec_vec_int_at(&{var_name}, {inner_index})->",
+                            f"{var_name}.data[{inner_index}].",
+                        )
+                        return f"{row}data[{index}] = {value_expr};"
                     else:
                         # Variable not properly typed as nested container
                         raise UnsupportedFeatureError(
@@ -766,7 +1884,8 @@ class MGenPythonToCConverter:
                 if c_type:
                     if c_type == "map_str_int":
                         # Vanilla C string map: mgen_str_int_map_insert(dict, key, value)
-                        return f"mgen_str_int_map_insert({obj}, {index}, {value_expr});"
+                        function, key = self._str_map_key("mgen_str_int_map_insert", target.slice, index)
+                        return f"{function}({obj}, {key}, {value_expr});"
                     elif c_type.startswith("map_"):
                         # STC dictionary assignment: map_int_int_insert(&dict, key, value)
                         return f"{c_type}_insert(&{obj}, {index}, {value_expr});"
@@ -797,15 +1916,25 @@ class MGenPythonToCConverter:
                         inferred_type = self._infer_expression_type(stmt.value)
                 else:
                     inferred_type = self._infer_expression_type(stmt.value)
+                if self._infer_expression_type(stmt.value) in self.tuple_structs:
+                    inferred_type = self._infer_expression_type(stmt.value)
+                inferred_type = self._bitset_type(var_name, inferred_type)
 
                 self.variable_context[var_name] = inferred_type
-                return f"{inferred_type} {var_name} = {value_expr};"
+                return "\n".join([f"{inferred_type} {var_name} = {value_expr};", *self._bitset_reserve(var_name)])
 
         else:
             raise UnsupportedFeatureError("Only simple variable and attribute assignment supported")
 
     def _convert_annotated_assignment(self, stmt: ast.AnnAssign) -> str:
         """Convert annotated assignment (e.g., x: int = 5 or self.x: int = 5)."""
+        if isinstance(stmt.target, ast.Name) and stmt.target.id in self.constant_str_dicts:
+            return ""  # A static table (_plan_constant_str_dicts)
+        soa_type = self._soa_list_type(stmt.annotation)
+        if isinstance(stmt.target, ast.Name) and soa_type:
+            self.variable_context[stmt.target.id] = soa_type
+            return f"{soa_type} {stmt.target.id} = {{0}};"
+
         # Handle attribute annotation (e.g., self.attr: type = value)
         if isinstance(stmt.target, ast.Attribute):
             obj = self._convert_expression(stmt.target.value)
@@ -856,9 +1985,12 @@ class MGenPythonToCConverter:
                     # set() constructor call is also an empty literal
                     is_empty_literal = True
 
+            # dict[K, V] / set[T] of scalars name their container; usage scans would guess int
+            c_type = self._annotated_container_type(stmt.annotation) or self._tuple_type(stmt.annotation)
+
             # For empty dict literals, scan forward to find first subscript assignment to infer type
             # Do this BEFORE enhanced type inference because it's more accurate for this case
-            if isinstance(stmt.value, ast.Dict) and len(stmt.value.keys) == 0:
+            if not c_type and isinstance(stmt.value, ast.Dict) and len(stmt.value.keys) == 0:
                 inferred_dict_type = self._infer_dict_type_from_usage(var_name)
                 if inferred_dict_type:
                     c_type = inferred_dict_type
@@ -896,6 +2028,8 @@ class MGenPythonToCConverter:
             # Check if this is a nested container (e.g., matrix: list that appends other lists)
             if var_name in self.nested_containers and type_annotation == "list":
                 c_type = "vec_vec_int"
+            c_type = self._nested_container_type(c_type)
+            c_type = self._bitset_type(var_name, c_type)
 
             self.variable_context[var_name] = c_type
 
@@ -911,7 +2045,11 @@ class MGenPythonToCConverter:
 
             if stmt.value:
                 # Special handling for list/dict/set literals with STC containers
-                if isinstance(stmt.value, ast.List) and c_type.startswith("vec_"):
+                if isinstance(stmt.value, ast.List) and c_type == "mat_int":
+                    # Only empty matrices pass _can_use_flat_matrices: the first row fixes the width
+                    return f"mat_int {var_name} = {{0}};"
+
+                elif isinstance(stmt.value, ast.List) and c_type.startswith("vec_"):
                     # Initialize list from literal: arr: list = [1, 2, 3]
                     # Generate: vec_int arr = {0}; vec_int_push(&arr, 1); vec_int_push(&arr, 2); ...
                     statements = [f"{c_type} {var_name} = {{0}};"]
@@ -927,12 +2065,14 @@ class MGenPythonToCConverter:
                     # Initialize dict from literal: d: dict = {"key": 1, "key2": 2}
                     if c_type == "map_str_int":
                         # Vanilla C string map
-                        statements = [f"mgen_str_int_map_t* {var_name} = mgen_str_int_map_new();"]
+                        statements = [f"mgen_str_int_map_t* {var_name} = {self._new_str_int_map()};"]
                         for key, value in zip(stmt.value.keys, stmt.value.values):
                             if key is not None:
-                                key_code = self._convert_expression(key)
+                                function, key_code = self._str_map_key(
+                                    "mgen_str_int_map_insert", key, self._convert_expression(key)
+                                )
                                 value_code = self._convert_expression(value)
-                                statements.append(f"mgen_str_int_map_insert({var_name}, {key_code}, {value_code});")
+                                statements.append(f"{function}({var_name}, {key_code}, {value_code});")
                         return "\n".join(statements)
                     else:
                         # STC dictionary
@@ -944,14 +2084,17 @@ class MGenPythonToCConverter:
                                 statements.append(f"{c_type}_insert(&{var_name}, {key_code}, {value_code});")
                         return "\n".join(statements)
 
-                elif isinstance(stmt.value, ast.Set) and c_type.startswith("set_"):
+                elif isinstance(stmt.value, ast.Set) and (c_type.startswith("set_") or c_type == "bitset_int"):
                     # Initialize set from literal: s: set = {1, 2, 3}
-                    statements = [f"{c_type} {var_name} = {{0}};"]
+                    statements = [f"{c_type} {var_name} = {{0}};", *self._bitset_reserve(var_name)]
                     for element in stmt.value.elts:
                         element_code = self._convert_expression(element)
                         statements.append(f"{c_type}_insert(&{var_name}, {element_code});")
                     return "\n".join(statements)
 
+                elif isinstance(stmt.value, ast.Tuple) and c_type in self.tuple_structs:
+                    return f"{c_type} {var_name} = {self._convert_tuple_literal(stmt.value, c_type)};"
+
                 else:
                     # Regular assignment
                     value_expr = self._convert_expression(stmt.value)
@@ -962,10 +2105,10 @@ class MGenPythonToCConverter:
                     if c_type == "map_str_int":
                         # Empty dict initialization
                         if value_expr == "{0}" or "Dict" in value_expr:
-                            return f"mgen_str_int_map_t* {var_name} = mgen_str_int_map_new();"
+                            return f"mgen_str_int_map_t* {var_name} = {self._new_str_int_map()};"
                         else:
                             return f"mgen_str_int_map_t* {var_name} = {value_expr};"
-                    return f"{c_type} {var_name} = {value_expr};"
+                    return "\n".join([f"{c_type} {var_name} = {value_expr};", *self._bitset_reserve(var_name)])
             else:
                 # Declaration without initialization
                 if c_type == "map_str_int":
@@ -994,10 +2137,22 @@ class MGenPythonToCConverter:
             if var_name not in self.variable_context:
                 raise TypeMappingError(f"Variable '{var_name}' must be declared before augmented assignment")
 
+            if var_name in self.string_builders:
+                return self._convert_string_builder_append(stmt)
+
             value_expr = self._convert_expression(stmt.value)
+            if isinstance(stmt.op, ast.Add) and self._is_string_type(stmt.target):
+                # += on a char* would be pointer arithmetic: concatenate instead
+                concat = self._convert_binary_op(ast.BinOp(left=stmt.target, op=ast.Add(), right=stmt.value))
+                return f"{var_name} = {concat};"
+            checked = self._checked_int_op(stmt.op, stmt.target, stmt.value, var_name, value_expr)
+            if checked is not None:
+                return f"{var_name} = {checked};"
             return f"{var_name} {op_str} {value_expr};"
 
         # Check if target is an attribute (e.g., self.attr += value or obj.attr += value)
+        elif isinstance(stmt.target, ast.Attribute) and self._soa_field(stmt.target):
+            return f"{self._soa_field(stmt.target)} {op_str} {self._convert_expression(stmt.value)};"
         elif isinstance(stmt.target, ast.Attribute):
             obj = self._convert_expression(stmt.target.value)
             attr_name = stmt.target.attr
@@ -1046,6 +2201,8 @@ class MGenPythonToCConverter:
             return self._convert_set_literal(expr)
         elif isinstance(expr, ast.JoinedStr):
             return self._convert_f_string(expr)
+        elif isinstance(expr, ast.Tuple):
+            return self._convert_tuple_literal(expr)
         else:
             return f"/* Unsupported expression {type(expr).__name__} */"
 
@@ -1074,14 +2231,55 @@ class MGenPythonToCConverter:
         elif isinstance(expr.op, ast.Add) and (self._is_string_type(expr.left) or self._is_string_type(expr.right)):
             # String concatenation using mgen_str_concat
             self.includes_needed.add('#include "mgen_string_ops.h"')
+            if self.scope_allocator_var:
+                return f"mgen_scope_str_concat({self.scope_allocator_var}, {left}, {right})"
             return f"mgen_str_concat({left}, {right})"
         else:
+            checked = None if id(expr) in self.overflow_free else self._checked_int_op(
+                expr.op, expr.left, expr.right, left, right
+            )
+            if checked is not None:
+                return checked
             # Use standard operator mapping from converter_utils for common operators
             op = get_standard_binary_operator(expr.op)
             if op is None:
                 raise UnsupportedFeatureError(f"Unsupported binary operator: {type(expr.op)}")
             return f"({left} {op} {right})"
 
+    def _checks_int_overflow(self) -> bool:
+        """Whether int + - * report OverflowError instead of wrapping (int_overflow="check")."""
+        return self.preferences.get("int_overflow", "wrap") == "check"
+
+    def _checked_int_op(
+        self, op: ast.operator, left_node: ast.expr, right_node: ast.expr, left: str, right: str
+    ) -> Optional[str]:
+        """mgen_int_add/sub/mul(left, right) for int + - * under int_overflow="check", else None."""
+        function = {ast.Add: "mgen_int_add", ast.Sub: "mgen_int_sub", ast.Mult: "mgen_int_mul"}.get(type(op))
+        if function is None or not self._checks_int_overflow():
+            return None
+        if not (self._is_int_expression(left_node) and self._is_int_expression(right_node)):
+            return None
+        self.includes_needed.add('#include "mgen_checked_int.h"')
+        return f"{function}({left}, {right})"
+
+    def _is_int_expression(self, expr: ast.expr) -> bool:
+        """Whether expr is known to be a Python int held in a C int (unknown types are not)."""
+        if isinstance(expr, ast.Constant):
+            return type(expr.value) is int and -(2**31) <= expr.value < 2**31
+        if isinstance(expr, ast.Name):
+            return self.variable_context.get(expr.id) == "int"
+        if isinstance(expr, ast.UnaryOp) and isinstance(expr.op, ast.USub):
+            return self._is_int_expression(expr.operand)
+        if isinstance(expr, ast.BinOp) and isinstance(expr.op, (ast.Add, ast.Sub, ast.Mult, ast.FloorDiv, ast.Mod)):
+            return self._is_int_expression(expr.left) and self._is_int_expression(expr.right)
+        if isinstance(expr, ast.Call) and isinstance(expr.func, ast.Name):
+            if expr.func.id in ("len", "int"):
+                return True
+            return self.function_return_types.get(expr.func.id) == "int"
+        if isinstance(expr, ast.Subscript) and isinstance(expr.value, ast.Name):
+            return self.variable_context.get(expr.value.id) == "vec_int"
+        return False
+
     def _convert_unary_op(self, expr: ast.UnaryOp) -> str:
         """Convert unary operations."""
         operand = self._convert_expression(expr.operand)
@@ -1103,6 +2301,9 @@ class MGenPythonToCConverter:
             right_expr = expr.comparators[0]
             right = self._convert_expression(right_expr)
             is_not_in = isinstance(expr.ops[0], ast.NotIn)
+            if isinstance(right_expr, ast.Name) and right_expr.id in self.constant_str_dicts:
+                match, _ = self.constant_str_dicts[right_expr.id]
+                return f"({match}({left}) {'<' if is_not_in else '>='} 0)"
 
             # Determine container type from variable context
             if isinstance(right_expr, ast.Name):
@@ -1126,17 +2327,20 @@ class MGenPythonToCConverter:
                         result = f"(strstr({right}, {left}) != NULL)"
                     elif c_type == "map_str_int":
                         # Vanilla C string map
-                        result = f"mgen_str_int_map_contains({right}, {left})"
+                        function, key = self._str_map_key("mgen_str_int_map_contains", expr.left, left)
+                        result = f"{function}({right}, {key})"
                     elif c_type.startswith("map_"):
                         # STC dictionary membership: check if key exists
                         result = f"{c_type}_contains(&{right}, {left})"
-                    elif c_type.startswith("set_"):
-                        # Set membership
+                    elif c_type.startswith("set_") or c_type == "bitset_int":
+                        # Set membership (one bit test for bitsets)
                         result = f"{c_type}_contains(&{right}, {left})"
                     elif c_type.startswith("vec_"):
-                        # List membership: use linear search helper
-                        # Note: STC doesn't have built-in contains for vec, need helper
-                        result = f"vec_contains_{c_type}(&{right}, {left})"
+                        # List membership: a linear scan specialized for the element type
+                        if self._hand_written_containers():
+                            result = f"{c_type}_contains(&{right}, {left})"
+                        elif c_type[4:] in self.STC_COMPARABLE_ELEMENTS:
+                            result = f"({c_type}_find(&{right}, {left}).ref != NULL)"
 
                     if result:
                         if is_not_in:
@@ -1149,11 +2353,23 @@ class MGenPythonToCConverter:
         left = self._convert_expression(expr.left)
         right = self._convert_expression(expr.comparators[0])
 
+        # List equality compares element-wise through the type-specialized helper
+        if isinstance(expr.ops[0], (ast.Eq, ast.NotEq)):
+            equal = self._vec_equality(expr.left, expr.comparators[0], left, right)
+            if equal:
+                return f"(!{equal})" if isinstance(expr.ops[0], ast.NotEq) else equal
+
         # Check if we're comparing strings
         left_is_string = self._is_string_type(expr.left)
         right_is_string = self._is_string_type(expr.comparators[0])
 
         if left_is_string or right_is_string:
+            # s[i] == c compares in place instead of copying the code point out
+            if isinstance(expr.ops[0], (ast.Eq, ast.NotEq)):
+                test = self._string_char_test(expr.left, right) or self._string_char_test(expr.comparators[0], left)
+                if test:
+                    return f"(!{test})" if isinstance(expr.ops[0], ast.NotEq) else test
+
             # String comparison - use strcmp()
             self.includes_needed.add("#include <string.h>")
 
@@ -1178,6 +2394,24 @@ class MGenPythonToCConverter:
             raise UnsupportedFeatureError(f"Unsupported comparison: {type(expr.ops[0])}")
         return f"({left} {op} {right})"
 
+    def _vec_equality(self, left_expr: ast.expr, right_expr: ast.expr, left: str, right: str) -> Optional[str]:
+        """Return the equality call for two vectors of the same type, or None.
+
+        Generated containers provide vec_T_equal(); STC vectors of comparable
+        elements provide vec_T_eq().
+        """
+        if not isinstance(left_expr, ast.Name) or not isinstance(right_expr, ast.Name):
+            return None
+        c_type = self.variable_context.get(left_expr.id)
+        if not c_type or not c_type.startswith("vec_") or self.variable_context.get(right_expr.id) != c_type:
+            return None
+
+        if self._hand_written_containers():
+            return f"{c_type}_equal(&{left}, &{right})"
+        if c_type[4:] in self.STC_COMPARABLE_ELEMENTS:
+            return f"{c_type}_eq(&{left}, &{right})"
+        return None
+
     def _convert_boolop(self, expr: ast.BoolOp) -> str:
         """Convert boolean operations (and/or).
 
@@ -1209,6 +2443,14 @@ class MGenPythonToCConverter:
         """Convert function calls."""
         if isinstance(expr.func, ast.Name):
             func_name = expr.func.id
+            if func_name in ("sum", "any", "all") and len(expr.args) == 1:
+                reduction = self._convert_generator_reduction(func_name, expr.args[0])
+                if reduction is not None:
+                    return reduction
+            if func_name in self.generators:
+                raise UnsupportedFeatureError(f"Generator {func_name} can only be iterated or reduced by sum/any/all")
+            if func_name == "sorted":
+                return self._convert_sorted(expr)
             args = [self._convert_expression(arg) for arg in expr.args]
 
             # Check if this is a class instantiation
@@ -1239,6 +2481,10 @@ class MGenPythonToCConverter:
                 return self._convert_type_cast(func_name, expr.args)
 
             # Handle built-in functions with runtime support
+            elif func_name == "len" and len(expr.args) == 1 and self._is_flat_matrix_row(expr.args[0]):
+                # len(m[i]) is the shared column count
+                return f"mat_int_cols(&{expr.args[0].value.id})"  # type: ignore[attr-defined]
+
             elif func_name in ["len", "bool", "abs", "min", "max", "sum", "any", "all", "print"] and self.use_runtime:
                 # Pass original AST args to print for type detection
                 if func_name == "print":
@@ -1291,7 +2537,7 @@ class MGenPythonToCConverter:
             self.includes_needed.add('#include "mgen_string_ops.h"')
             # For now, support int to string (most common case)
             # TODO: Add support for float to string, bool to string, etc.
-            return f"mgen_int_to_string({arg})"
+            return self._int_to_string_expr(arg)
         else:
             raise UnsupportedFeatureError(f"Type cast {cast_type}() not supported")
 
@@ -1302,6 +2548,8 @@ class MGenPythonToCConverter:
             # Determine container type from variable context
             container_name = args[0]
             container_type = None
+            if container_name in self.constant_str_dicts:
+                return str(self.constant_str_dicts[container_name][1])
 
             # Check variable_context for the container type
             if container_name in self.variable_context:
@@ -1313,19 +2561,25 @@ class MGenPythonToCConverter:
             # Check for mgen custom types first (before generic STC types)
             if container_type == "mgen_str_int_map_t*":
                 return f"mgen_str_int_map_size({container_name})"
+            elif container_type == "mat_int":
+                return f"mat_int_rows(&{container_name})"
             elif container_type and container_type.startswith("map_"):
                 # STC map types
                 return f"{container_type}_size(&{container_name})"
-            elif container_type and container_type.startswith("set_"):
+            elif container_type and (container_type.startswith("set_") or container_type == "bitset_int"):
+                return f"{container_type}_size(&{container_name})"
+            elif self._soa_class_of_type(container_type):
                 return f"{container_type}_size(&{container_name})"
             elif container_type and container_type.startswith("vec_"):
                 return f"{container_type}_size(&{container_name})"
             elif container_type and "mgen_string_array" in container_type:
                 return f"mgen_string_array_size({container_name})"
             elif container_type and container_type in ("char*", "const char*", "string"):
-                # String type - use strlen()
-                self.includes_needed.add("#include <string.h>")
-                return f"strlen({container_name})"
+                # Code points, not bytes; a cached view makes it O(1)
+                self.includes_needed.add('#include "mgen_utf8.h"')
+                if container_name in self.string_views:
+                    return f"(int){self.string_views[container_name]}.length"
+                return f"(int)mgen_utf8_len({container_name})"
             else:
                 # Default to vec_int for backward compatibility
                 return f"vec_int_size(&{container_name})"
@@ -1339,37 +2593,62 @@ class MGenPythonToCConverter:
             return f"{func_name}({', '.join(args)})"
 
     def _convert_print_call(self, ast_args: list[ast.expr], converted_args: list[str]) -> str:
-        """Convert print() to printf() with appropriate format specifiers."""
+        """Convert print() to writes into the mgen_stdout buffer (printf() without "buffered_stdout")."""
+        buffered = self.preferences.get("buffered_stdout", True)
+        if buffered:
+            self.includes_needed.add('#include "mgen_stdout.h"')
         if len(ast_args) == 0:
-            return 'printf("\\n")'
-
-        if len(ast_args) == 1:
-            # Single argument - detect type and use appropriate format
-            arg_expr = ast_args[0]
-            c_arg = converted_args[0]
+            return "mgen_stdout_newline()" if buffered else 'printf("\\n")'
+
+        kinds = [self._print_kind(arg) for arg in ast_args]
+        lists = any(kind.endswith("_list") for kind in kinds)
+        if not buffered and not lists:
+            formats = {"str": "%s", "double": "%f", "bool": "%s", "int": "%d"}
+            values = [
+                f'{c_arg} ? "true" : "false"' if kind == "bool" else c_arg for kind, c_arg in zip(kinds, converted_args)
+            ]
+            return f'printf("{" ".join(formats[kind] for kind in kinds)}\\n", {", ".join(values)})'
+
+        # Lists stream their repr() into the stdout buffer from their items: no string is built
+        self.includes_needed.add('#include "mgen_stdout.h"')
+        converted_args = [
+            f"{c_arg}.data, (size_t){c_arg}.size" if kind.endswith("_list") else c_arg
+            for kind, c_arg in zip(kinds, converted_args)
+        ]
+        # Space-separated pieces, the last one ending the line: one comma expression
+        pieces = [f"mgen_stdout_{kind}({c_arg}), mgen_stdout_char(' ')" for kind, c_arg in zip(kinds, converted_args)]
+        pieces[-1] = f"mgen_print_{kinds[-1]}({converted_args[-1]})"
+        if not buffered:
+            # Written out before the next printf()
+            pieces.append("mgen_stdout_flush()")
+        return pieces[0] if len(pieces) == 1 else f"({', '.join(pieces)})"
+
+    def _print_kind(self, arg_expr: ast.expr) -> str:
+        """How print() writes an argument: "str", "double", "bool", "int", or a list kind such as "int_list"."""
+        # Check if it's a string literal
+        if isinstance(arg_expr, ast.Constant) and isinstance(arg_expr.value, str):
+            return "str"
 
-            # Check if it's a string literal
-            if isinstance(arg_expr, ast.Constant) and isinstance(arg_expr.value, str):
-                return f'printf("%s\\n", {c_arg})'
+        # Check variable type from context, or the field type of a tuple element
+        var_type = None
+        if isinstance(arg_expr, ast.Name) and arg_expr.id in self.variable_context:
+            var_type = self.variable_context[arg_expr.id]
+        elif isinstance(arg_expr, ast.Subscript) and self._tuple_field(arg_expr):
+            var_type = self._tuple_field(arg_expr)[1]  # type: ignore[index]
+        if var_type:
+            if var_type in ["str", "char*", "const char*"]:
+                return "str"
+            elif var_type == "double":
+                return "double"
+            elif var_type == "bool":
+                return "bool"
+            elif var_type in ("vec_int", "vec_double"):
+                return f"{var_type[4:]}_list"
+            elif var_type == "vec_cstr" and self._hand_written_containers():
+                return "str_list"  # STC's vec_cstr holds cstr values, not char*
 
-            # Check variable type from context
-            if isinstance(arg_expr, ast.Name):
-                var_name = arg_expr.id
-                if var_name in self.variable_context:
-                    var_type = self.variable_context[var_name]
-                    if var_type in ["str", "char*"]:
-                        return f'printf("%s\\n", {c_arg})'
-                    elif var_type == "double":
-                        return f'printf("%f\\n", {c_arg})'
-                    elif var_type == "bool":
-                        return f'printf("%s\\n", {c_arg} ? "true" : "false")'
-
-            # Default to integer
-            return f'printf("%d\\n", {c_arg})'
-        else:
-            # Multiple arguments - use %d for all (simplified)
-            format_specs = " ".join(["%d"] * len(ast_args))
-            return f'printf("{format_specs}\\n", {", ".join(converted_args)})'
+        # Default to integer
+        return "int"
 
     def _convert_method_call(self, expr: ast.Call) -> str:
         """Convert method calls: obj.method(args) -> ClassName_method(&obj, args)."""
@@ -1393,12 +2672,24 @@ class MGenPythonToCConverter:
         obj = self._convert_expression(obj_expr)
         args = [self._convert_expression(arg) for arg in expr.args]
 
+        if isinstance(obj_expr, ast.Name) and method_name == "append" and self._soa_class(obj_expr.id):
+            return f"{self.variable_context[obj_expr.id]}_push(&{obj}, {args[0]})"
+
+        # Appending a row to a flat matrix copies it into the matrix buffer
+        if isinstance(obj_expr, ast.Name) and self.variable_context.get(obj_expr.id) == "mat_int":
+            if method_name != "append" or len(args) != 1:
+                raise UnsupportedFeatureError(f"Flat matrices do not support .{method_name}()")
+            row = args[0]
+            return f"mat_int_append_row(&{obj}, {row}.data, (size_t){row}.size); vec_int_drop(&{row})"
+
         # Check if this is a string method call
         if self._is_string_type(obj_expr):
             return self._convert_string_method(obj, method_name, args)
 
         # Check if this is a list method call
         if self._is_list_type(obj_expr):
+            if method_name == "sort":
+                return self._convert_list_sort(obj, obj_expr, expr)
             return self._convert_list_method(obj, method_name, args, obj_expr, expr.args)
 
         # Check if this is a set method call
@@ -1438,6 +2729,10 @@ class MGenPythonToCConverter:
                 var_type = self.variable_context[var_name]
                 return var_type in ["str", "char*", "const char*"] or "char*" in var_type
 
+        # s[i] and s[a:b] of a string are strings
+        if isinstance(expr, ast.Subscript):
+            return isinstance(expr.value, ast.Name) and self._is_string_type(expr.value)
+
         # Check if it's a method call that returns a string (for chaining)
         if isinstance(expr, ast.Call) and isinstance(expr.func, ast.Attribute):
             method_name = expr.func.attr
@@ -1501,6 +2796,11 @@ class MGenPythonToCConverter:
                 raise UnsupportedFeatureError("str.find() requires exactly one argument")
             return f"mgen_str_find({obj}, {args[0]})"
 
+        elif method_name == "count":
+            if len(args) != 1:
+                raise UnsupportedFeatureError("str.count() requires exactly one argument")
+            return f"mgen_str_count({obj}, {args[0]})"
+
         elif method_name == "replace":
             if len(args) != 2:
                 raise UnsupportedFeatureError("str.replace() requires exactly two arguments")
@@ -1517,6 +2817,14 @@ class MGenPythonToCConverter:
         else:
             raise UnsupportedFeatureError(f"Unsupported string method: {method_name}")
 
+    def _is_flat_matrix_row(self, expr: ast.expr) -> bool:
+        """Check whether expr is m[i] for a flat matrix m."""
+        return (
+            isinstance(expr, ast.Subscript)
+            and isinstance(expr.value, ast.Name)
+            and self.variable_context.get(expr.value.id) == "mat_int"
+        )
+
     def _is_list_type(self, expr: ast.expr) -> bool:
         """Check if expression represents a list/vector type."""
         # Check if it's a list literal
@@ -1593,6 +2901,165 @@ class MGenPythonToCConverter:
         else:
             raise UnsupportedFeatureError(f"Unsupported list method: {method_name}")
 
+    # Sort of each list type's elements, from mgen_sort.h
+    SORT_FUNCTIONS = {
+        "vec_int": "mgen_sort_int",
+        "vec_double": "mgen_sort_double",
+        "vec_float": "mgen_sort_float",
+        "vec_cstr": "mgen_sort_str",
+        "mgen_string_array_t*": "mgen_sort_str",
+    }
+
+    # mgen_sort.h instantiated for the cstr elements of an STC vec_cstr
+    STC_STRING_SORT = "\n".join(
+        [
+            "#define MGEN_SORT_NAME mgen_sort_cstr",
+            "#define MGEN_SORT_T cstr",
+            "#define MGEN_SORT_LESS(a, b) (strcmp(cstr_str(a), cstr_str(b)) < 0)",
+            '#include "mgen_sort_impl.h"',
+        ]
+    )
+
+    def _detect_sorts(self, node: ast.Module) -> None:
+        """Pre-scan for sorted() and list.sort(), and record the key types of the module's functions."""
+        self.sorts_stc_strings = False
+        self.sort_key_types = {}
+        for stmt in node.body:
+            if isinstance(stmt, ast.FunctionDef) and isinstance(stmt.returns, ast.Name):
+                key_type = {"int": "int", "bool": "int", "float": "double"}.get(stmt.returns.id)
+                if key_type:
+                    self.sort_key_types[stmt.name] = key_type
+        for child in ast.walk(node):
+            if isinstance(child, ast.Call) and (
+                (isinstance(child.func, ast.Name) and child.func.id == "sorted")
+                or (isinstance(child.func, ast.Attribute) and child.func.attr == "sort")
+            ):
+                self.includes_needed.add('#include "mgen_sort.h"')
+                return
+
+    def _sort_list_type(self, expr: ast.expr) -> str:
+        """C type of a list to sort: a list variable, or a call returning a list or split() strings."""
+        c_type: Optional[str] = None
+        if isinstance(expr, ast.Name):
+            c_type = self.variable_context.get(expr.id)
+            if c_type is None and expr.id in self.inferred_types:
+                c_type = self.inferred_types[expr.id].c_type
+        elif isinstance(expr, ast.Call):
+            c_type = self._infer_expression_type(expr)
+        if c_type not in self.SORT_FUNCTIONS:
+            raise UnsupportedFeatureError("Sorting is only supported for lists of int, float or str")
+        return c_type
+
+    def _convert_sorted(self, expr: ast.Call) -> str:
+        """sorted(xs): a sorted copy of the list xs, or the list a call returns sorted in place.
+
+        Example:
+            sorted(xs, reverse=True)  →
+            ({ vec_int sorted_N = vec_int_clone(xs); mgen_sort_int(...); mgen_sort_int_reverse(...); sorted_N; })
+        """
+        if len(expr.args) != 1:
+            raise UnsupportedFeatureError("sorted() takes exactly one positional argument")
+        c_type = self._sort_list_type(expr.args[0])
+        source = self._convert_expression(expr.args[0])
+        result = self._generate_temp_var_name("sorted")
+
+        if not isinstance(expr.args[0], ast.Name):
+            # A call result is a fresh list already
+            copy = f"{c_type} {result} = {source};"
+        elif not c_type.startswith("vec_"):
+            raise UnsupportedFeatureError("sorted() of split() strings needs the split() call as its argument")
+        elif not self._hand_written_containers():
+            copy = f"{c_type} {result} = {c_type}_clone({source});"
+        elif self._has_bulk_vec_api(c_type):
+            copy = f"{c_type} {result} = {c_type}_copy_range(&{source}, 0, {c_type}_size(&{source}));"
+        else:
+            index = self._generate_temp_var_name("copy_idx")
+            copy = (
+                f"{c_type} {result} = {c_type}_init(); "
+                f"for (size_t {index} = 0; {index} < {c_type}_size(&{source}); {index}++) "
+                f"{c_type}_push(&{result}, {source}.data[{index}]);"
+            )
+        return f"({{ {copy} {self._sort_in_place(c_type, result, expr.keywords)} {result}; }})"
+
+    def _convert_list_sort(self, obj: str, obj_expr: ast.expr, expr: ast.Call) -> str:
+        """xs.sort(key=..., reverse=...) as statements sorting the list's buffer in place."""
+        if expr.args:
+            raise UnsupportedFeatureError("list.sort() takes only key= and reverse= keyword arguments")
+        c_type = self._sort_list_type(obj_expr)
+        return f"do {{ {self._sort_in_place(c_type, obj, expr.keywords)} }} while (0)"
+
+    def _sort_in_place(self, c_type: str, obj: str, keywords: list[ast.keyword]) -> str:
+        """Statements sorting the elements of the list obj like list.sort() with the given keywords.
+
+        Plain sorts call the type-specialized pdqsort (radix sort for long int lists), reversed
+        afterwards for reverse=True. key= computes each element's key once and stably sorts by
+        the keys, as Python does.
+        """
+        key: Optional[ast.expr] = None
+        reverse = False
+        for keyword in keywords:
+            if keyword.arg == "key":
+                key = keyword.value
+            elif (
+                keyword.arg == "reverse"
+                and isinstance(keyword.value, ast.Constant)
+                and isinstance(keyword.value.value, bool)
+            ):
+                reverse = keyword.value.value
+            else:
+                raise UnsupportedFeatureError("Sorting only supports key=<function> and reverse=True/False")
+
+        if c_type == "mgen_string_array_t*":
+            data, size = f"{obj}->strings", f"{obj}->count"
+        else:
+            data, size = f"{obj}.data", f"(size_t){c_type}_size(&{obj})"
+        if key is None:
+            sort = self._sort_function(c_type)
+            statements = f"{sort}({data}, {size});"
+            if reverse:
+                statements += f" {sort}_reverse({data}, {size});"
+            return statements
+
+        key_type, key_of = self._sort_key(key, c_type)
+        keys = self._generate_temp_var_name("sort_keys")
+        index = self._generate_temp_var_name("sort_idx")
+        return (
+            f"{key_type}* {keys} = malloc({size} * sizeof({key_type})); "
+            f"for (size_t {index} = 0; {index} < {size}; {index}++) "
+            f"{keys}[{index}] = {key_of(f'{data}[{index}]')}; "
+            f"mgen_sort_by_{key_type}_keys({data}, {size}, sizeof(*{data}), {keys}, "
+            f"{'true' if reverse else 'false'}); "
+            f"free({keys});"
+        )
+
+    def _stc_strings(self, c_type: str) -> bool:
+        """Whether the list's elements are STC cstr values rather than char* strings."""
+        return c_type == "vec_cstr" and not self._hand_written_containers()
+
+    def _sort_function(self, c_type: str) -> str:
+        """Element sort of a list type; sorting STC strings instantiates the sort for cstr."""
+        if self._stc_strings(c_type):
+            self.sorts_stc_strings = True
+            return "mgen_sort_cstr"
+        return self.SORT_FUNCTIONS[c_type]
+
+    def _sort_key(self, key: ast.expr, c_type: str) -> tuple[str, Callable[[str], str]]:
+        """C key type and key expression builder of a key= argument.
+
+        Supported keys are len for lists of str and module functions returning int, bool or
+        float for lists of numbers.
+        """
+        strings = self.SORT_FUNCTIONS[c_type] == "mgen_sort_str"
+        if isinstance(key, ast.Name) and key.id == "len" and strings:
+            self.includes_needed.add('#include "mgen_utf8.h"')
+            if self._stc_strings(c_type):
+                return "int", lambda element: f"(int)mgen_utf8_len(cstr_str(&{element}))"
+            return "int", lambda element: f"(int)mgen_utf8_len({element})"
+        if isinstance(key, ast.Name) and key.id in self.sort_key_types and not strings:
+            name = key.id
+            return self.sort_key_types[name], lambda element: f"{name}({element})"
+        raise UnsupportedFeatureError("Sort key= must be len (for str lists) or a function returning int or float")
+
     def _is_set_type(self, expr: ast.expr) -> bool:
         """Check if expression represents a set type."""
         # Check if it's a set literal
@@ -1612,7 +3079,7 @@ class MGenPythonToCConverter:
             # Check variable context
             if var_name in self.variable_context:
                 var_type = self.variable_context[var_name]
-                return var_type.startswith("set_") or var_type == "set"
+                return var_type.startswith("set_") or var_type in ("set", "bitset_int")
 
         return False
 
@@ -1670,6 +3137,117 @@ class MGenPythonToCConverter:
         else:
             return "int"  # Default fallback
 
+    def _annotated_container_type(self, annotation: ast.expr) -> Optional[str]:
+        """map_K_V for dict[K, V] and set_T for set[T] annotations over int, float and bool.
+
+        Other annotations (str keys or values, nested containers) return None and keep
+        their dedicated representations.
+        """
+        if not isinstance(annotation, ast.Subscript) or not isinstance(annotation.value, ast.Name):
+            return None
+        args = annotation.slice.elts if isinstance(annotation.slice, ast.Tuple) else [annotation.slice]
+        scalars = []
+        for arg in args:
+            if not isinstance(arg, ast.Name) or arg.id not in ("int", "float", "bool"):
+                return None
+            scalars.append(self.type_mapping[arg.id])
+        if annotation.value.id == "dict" and len(scalars) == 2:
+            return f"map_{scalars[0]}_{scalars[1]}"
+        if annotation.value.id == "set" and len(scalars) == 1:
+            return f"set_{scalars[0]}"
+        return None
+
+    # Tuple elements held by value in a tuple struct, by annotation
+    TUPLE_FIELD_TYPES = {"int": "int", "float": "double", "bool": "bool", "str": "char*"}
+
+    def _tuple_type(self, annotation: Optional[ast.expr]) -> Optional[str]:
+        """Struct type of a tuple[T1, ..., Tn] annotation over int, float, bool and str, else None."""
+        if not (
+            isinstance(annotation, ast.Subscript)
+            and isinstance(annotation.value, ast.Name)
+            and annotation.value.id in ("tuple", "Tuple")
+        ):
+            return None
+        args = annotation.slice.elts if isinstance(annotation.slice, ast.Tuple) else [annotation.slice]
+        if not all(isinstance(arg, ast.Name) and arg.id in self.TUPLE_FIELD_TYPES for arg in args):
+            return None  # tuple[int, ...] and tuples of containers have no fixed struct
+        return self._tuple_struct([self.TUPLE_FIELD_TYPES[arg.id] for arg in args])  # type: ignore[attr-defined]
+
+    def _tuple_struct(self, fields: list[str]) -> str:
+        """Name of the value struct with these field types, declared once ahead of the functions."""
+        name = "mgen_tuple_" + "_".join("str" if field == "char*" else field for field in fields)
+        self.tuple_structs.setdefault(name, fields)
+        return name
+
+    def _generate_tuple_structs(self) -> str:
+        """typedef of every tuple struct the module uses: fields f0 .. fN-1."""
+        return "\n".join(
+            f"typedef struct {{ {' '.join(f'{field} f{i};' for i, field in enumerate(fields))} }} {name};"
+            for name, fields in self.tuple_structs.items()
+        )
+
+    def _tuple_field(self, expr: ast.Subscript) -> Optional[tuple[str, str]]:
+        """(field name, C type) of t[i] with t a tuple struct and i a constant, else None."""
+        index = expr.slice
+        negate = isinstance(index, ast.UnaryOp) and isinstance(index.op, ast.USub)
+        if negate:
+            index = index.operand  # type: ignore[attr-defined]
+        if not (isinstance(index, ast.Constant) and type(index.value) is int):
+            return None
+        fields = self.tuple_structs.get(self._infer_expression_type(expr.value))
+        position = -index.value if negate else index.value
+        if fields is None or not -len(fields) <= position < len(fields):
+            return None
+        position %= len(fields)
+        return f"f{position}", fields[position]
+
+    def _convert_tuple_literal(self, expr: ast.Tuple, c_type: Optional[str] = None) -> str:
+        """Compound literal of a tuple struct, of the inferred element types unless c_type is given."""
+        c_type = c_type or self._infer_expression_type(expr)
+        elements = ", ".join(self._convert_expression(element) for element in expr.elts)
+        return f"({c_type}){{{elements}}}"
+
+    def _convert_tuple_assignment(self, target: ast.Tuple, value: ast.expr) -> str:
+        """a, b = ...: every value is read before any name is stored, so swaps need no helper.
+
+        A tuple display is spread over scalar temporaries; any other value must be a tuple
+        struct (e.g. a call returning tuple[int, int]) and is unpacked field by field.
+        """
+        if not all(isinstance(element, ast.Name) for element in target.elts):
+            raise UnsupportedFeatureError("Tuple unpacking is only supported into simple names")
+        sources: list[tuple[str, str]] = []
+        lines = []
+        if isinstance(value, ast.Tuple):
+            if len(value.elts) != len(target.elts):
+                raise UnsupportedFeatureError("Tuple unpacking needs as many names as values")
+            for element in value.elts:
+                c_type = self._infer_expression_type(element)
+                temp = self._tuple_temp()
+                lines.append(f"{c_type} {temp} = {self._convert_expression(element)};")
+                sources.append((temp, c_type))
+        else:
+            tuple_type = self._infer_expression_type(value)
+            fields = self.tuple_structs.get(tuple_type)
+            if fields is None:
+                raise UnsupportedFeatureError("Tuple unpacking needs a tuple[...] of int, float, bool or str")
+            if len(fields) != len(target.elts):
+                raise UnsupportedFeatureError("Tuple unpacking needs as many names as tuple fields")
+            temp = self._tuple_temp()
+            lines.append(f"{tuple_type} {temp} = {self._convert_expression(value)};")
+            sources = [(f"{temp}.f{i}", field) for i, field in enumerate(fields)]
+        for name, (source, c_type) in zip(target.elts, sources):
+            assert isinstance(name, ast.Name)
+            if name.id in self.variable_context:
+                lines.append(f"{name.id} = {source};")
+            else:
+                self.variable_context[name.id] = c_type
+                lines.append(f"{c_type} {name.id} = {source};")
+        return "\n".join(lines)
+
+    def _tuple_temp(self) -> str:
+        self.tuple_temp_count += 1
+        return f"mgen_tuple_tmp_{self.tuple_temp_count}"
+
     def _infer_dict_type_from_usage(self, var_name: str) -> Optional[str]:
         """Infer dict type by scanning forward for subscript assignments.
 
@@ -1730,13 +3308,19 @@ class MGenPythonToCConverter:
             if var_name in self.variable_context:
                 c_type = self.variable_context[var_name]
                 # If it's a container type, return the base type
-                if c_type in ["char*", "int", "double", "bool", "float"]:
+                if c_type in ["char*", "int", "double", "bool", "float"] or c_type in self.tuple_structs:
                     return c_type
             # Fallback to checking inferred types
             if var_name in self.inferred_types:
                 return self.inferred_types[var_name].c_type
             # Default fallback
             return "int"
+        elif isinstance(expr, ast.Subscript) and self._is_string_type(expr):
+            return "char*"
+        elif isinstance(expr, ast.Subscript) and self._tuple_field(expr):
+            return self._tuple_field(expr)[1]  # type: ignore[index]
+        elif isinstance(expr, ast.Tuple):
+            return self._tuple_struct([self._infer_expression_type(element) for element in expr.elts])
         elif isinstance(expr, ast.DictComp):
             # Infer dict comprehension type from key and value expressions
             key_type = self._infer_expression_type(expr.key)
@@ -1788,6 +3372,8 @@ class MGenPythonToCConverter:
                     return "double"
                 elif func_name == "bool":
                     return "bool"
+                elif func_name == "sorted" and expr.args:
+                    return self._sort_list_type(expr.args[0])
                 # Check if we know this function's return type
                 elif func_name in self.function_return_types:
                     return self.function_return_types[func_name]
@@ -1819,6 +3405,17 @@ class MGenPythonToCConverter:
         """Check if container support is needed."""
         return len(self.container_variables) > 0
 
+    def _hand_written_containers(self) -> bool:
+        """Whether containers are the hand-written runtime ones instead of STC instantiations.
+
+        STC (open-addressing hmap/hset, vec) is the default. container_mode="generated"
+        or use_stc_containers=False selects the hand-written containers, the portable
+        fallback that needs nothing but the runtime headers, emitted inline.
+        """
+        if self.preferences.get("container_mode", "runtime") == "generated":
+            return True
+        return not self.preferences.get("use_stc_containers", True)
+
     def _uses_comprehensions(self, node: ast.AST) -> bool:
         """Check if the AST contains comprehensions."""
         for child in ast.walk(node):
@@ -1844,8 +3441,31 @@ class MGenPythonToCConverter:
     return 0;
 }"""
 
+    def _convert_dict_update(self, update: DictUpdate) -> Optional[str]:
+        """Convert a counting update into one find-or-insert, or None for other map types."""
+        c_type = self.variable_context.get(update.container)
+        if c_type is None and update.container in self.inferred_types:
+            c_type = self.inferred_types[update.container].c_type
+        key = self._convert_expression(update.key)
+        increment = self._convert_expression(update.increment)
+        default = self._convert_expression(update.default)
+        if c_type == "map_str_int":
+            function, key = self._str_map_key("mgen_str_int_map_get_or_insert", update.key, key)
+            return f"*{function}({update.container}, {key}, {default}) += {increment};"
+        if c_type == "map_int_int":
+            if self._hand_written_containers():
+                return f"*map_int_int_get_or_insert(&{update.container}, {key}, {default}) += {increment};"
+            # STC insert() keeps an existing entry and returns it either way
+            return f"map_int_int_insert(&{update.container}, {key}, {default}).ref->second += {increment};"
+        return None
+
     def _convert_if(self, stmt: ast.If) -> str:
         """Convert if statements."""
+        if self.preferences.get("string_dispatch", True):
+            chain = self.compile_time_evaluator.string_match_chain(stmt)
+            if chain is not None and self.variable_context.get(chain.subject) in ("char*", "const char*", "cstr"):
+                return self._convert_string_match(chain)
+
         condition = self._convert_expression(stmt.test)
 
         body = []
@@ -1877,6 +3497,96 @@ class MGenPythonToCConverter:
 
         return result
 
+    def _convert_string_match(self, chain: StringMatchChain) -> str:
+        """Branch on the index str_match_N finds for the subject instead of comparing it with every literal.
+
+        The branches stay an if/else-if chain over that index, which compilers
+        turn into a jump table.
+        """
+        match = self._string_dispatch_function(chain.dispatch, chain.key_branches)
+        branch = match.replace("match", "branch")
+        subject = chain.subject
+        if self.variable_context.get(subject) == "cstr":
+            subject = f"cstr_str(&{subject})"  # STC strings of vec_cstr elements
+        result = f"int {branch} = {match}({subject});\n"
+        for index, body in enumerate(chain.branches):
+            result += f"if ({branch} == {index}) {{\n" if index == 0 else f" else if ({branch} == {index}) {{\n"
+            for s in body:
+                converted = self._convert_statement(s)
+                if converted:
+                    for line in converted.split("\n"):
+                        result += f"    {line}\n"
+            result += "}"
+        if len(chain.orelse) == 1 and isinstance(chain.orelse[0], ast.If):
+            result += " else " + self._convert_if(chain.orelse[0])
+        elif chain.orelse:
+            result += " else {\n"
+            for s in chain.orelse:
+                converted = self._convert_statement(s)
+                if converted:
+                    for line in converted.split("\n"):
+                        result += f"    {line}\n"
+            result += "}"
+        return result
+
+    def _string_dispatch_function(self, dispatch: StringDispatch, results: list[int]) -> str:
+        """Emit str_match_N(s): results[i] for the i-th key of dispatch, -1 for any other string."""
+        name = f"str_match_{len(self.string_dispatch_functions)}"
+        body = render_string_dispatch(dispatch, results, "s", "strlen(s)")
+        lines = [f"static inline int {name}(const char* s) {{", *(f"    {line}" for line in body), "}"]
+        self.string_dispatch_functions.append("\n".join(lines))
+        self.includes_needed.add("#include <string.h>")
+        return name
+
+    def _plan_constant_str_dicts(self, node: ast.FunctionDef) -> dict[str, tuple[str, int]]:
+        """Read-only str -> int dict literals of a function, as static tables behind a str_match function.
+
+        Dicts read_only_dict_literals finds only looked up, probed and measured,
+        whose keys are string literals and whose values fold to C ints, need no
+        map built at runtime. d[k] becomes str_table_N_at(k), which sets
+        MGEN_ERROR_KEY for a missing key, k in d tests str_match_N(k) >= 0 and
+        len(d) is the key count.
+
+        Returns:
+            The str_match function and key count of each such dict, by name
+        """
+        annotations = {
+            stmt.target.id: self._get_type_annotation(stmt.annotation)
+            for stmt in node.body
+            if isinstance(stmt, ast.AnnAssign) and isinstance(stmt.target, ast.Name)
+        }
+        tables = {}
+        for name, literal in read_only_dict_literals(node).items():
+            if annotations.get(name, "dict[str, int]") not in ("dict", "dict[str, int]"):
+                continue
+            constant = self.compile_time_evaluator.constant_string_dict(literal)
+            if constant is None or not constant[0]:
+                continue
+            keys, values = constant
+            if not all(type(value) is int and -(2**31) <= value < 2**31 for value in values):
+                continue
+            dispatch = self.compile_time_evaluator.build_string_dispatch(keys)
+            match = self._string_dispatch_function(dispatch, list(range(len(keys))))
+            table = match.replace("match", "table")
+            self.string_dispatch_functions[-1] += "\n".join(
+                [
+                    "",
+                    "",
+                    f"static const int {table}_values[{len(values)}] = {{{', '.join(map(str, values))}}};",
+                    "",
+                    f"static inline int {table}_at(const char* s) {{",
+                    f"    int index = {match}(s);",
+                    "    if (index < 0) {",
+                    '        MGEN_SET_ERROR(MGEN_ERROR_KEY, "Key not in constant dict");',
+                    "        return 0;",
+                    "    }",
+                    f"    return {table}_values[index];",
+                    "}",
+                ]
+            )
+            tables[name] = (match, len(keys))
+        return tables
+
     def _convert_while(self, stmt: ast.While) -> str:
         """Convert while loop."""
         condition = self._convert_expression(stmt.test)
@@ -1892,12 +3602,423 @@ class MGenPythonToCConverter:
         result += "}"
         return result
 
+    def _hash_cursor(self, container_name: str, container_type: str) -> tuple[str, str]:
+        """Cursor function prefix and begin() argument for iterating a map or set variable.
+
+        Every hash container, STC or generated, exposes the same header-inline cursor:
+        X_begin/X_next with it.ref (->first/->second for maps, *ref for sets). The
+        string-keyed fallback map is held by pointer under the mgen_str_int_map prefix.
+        """
+        if container_type in ("map_str_int", "mgen_str_int_map_t*"):
+            return "mgen_str_int_map", container_name
+        return container_type, f"&{container_name}"
+
+    def _hash_element_types(self, container_type: str) -> list[str]:
+        """C types of a map's key and value, or of a set's element (int when unknown)."""
+        if container_type == "mgen_str_int_map_t*":
+            container_type = "map_str_int"
+        info = TypeParameterExtractor().extract(container_type)
+        if info and info.family in ("map", "set"):
+            return [props.c_type for props in info.type_properties]
+        return ["int", "int"] if container_type.startswith("map_") else ["int"]
+
+    # C types a parallel loop may share or privatize, and those its reductions may have:
+    # reassociating a floating-point sum across threads would change its result
+    OMP_REDUCTION_TYPES = frozenset({"int", "long", "long long", "int32_t", "int64_t", "size_t"})
+    OMP_SCALAR_TYPES = OMP_REDUCTION_TYPES | {"double", "float", "bool"}
+    OMP_CONTAINER_TYPES = frozenset({"vec_int", "vec_double", "vec_float", "vec_bool", "vec_vec_int", "mat_int"})
+
+    def _omp_parallel_for(self, plan: ParallelLoop) -> Optional[str]:
+        """Build the OpenMP pragma of a loop the analyzer proved parallel.
+
+        Returns None if a variable of the loop has a type OpenMP cannot share
+        safely (strings, reference counted or hash containers) or a reduction
+        is not integral, so the loop stays serial.
+        """
+        for name in plan.names - plan.loop_variables:
+            c_type = self.variable_context.get(name)
+            if name in plan.reductions:
+                if c_type not in self.OMP_REDUCTION_TYPES:
+                    return None
+            elif c_type not in self.OMP_SCALAR_TYPES and c_type not in self.OMP_CONTAINER_TYPES:
+                return None
+        pragma = "#pragma omp parallel for"
+        if plan.reductions:
+            pragma += f" reduction(+:{', '.join(plan.reductions)})"
+        return pragma
+
+    def _pool_parallel_loop(
+        self, stmt: ast.For, plan: ParallelLoop, declared_before: set[str], start: str, stop: str, body: list[str]
+    ) -> Optional[str]:
+        """Run a loop the analyzer proved parallel on the mgen_parallel pool.
+
+        The body is outlined into a chunk function over trip indexes; the names it
+        shares with the enclosing function are copied in through a context struct
+        (lists by handle, so stores at the loop index reach the shared elements), each
+        chunk sums the reductions locally and mgen_parallel_reduce adds them up.
+
+        Returns None, leaving the loop serial, under the same type restrictions as
+        _omp_parallel_for or when the body cannot be moved out of the function.
+        """
+        if not self._can_outline(stmt):
+            return None
+        fields: list[tuple[str, str]] = [("int", "start")]
+        reductions: list[tuple[str, str]] = []
+        private: list[tuple[str, str]] = []
+        for name in sorted((plan.names - plan.loop_variables) & declared_before):
+            c_type = self.variable_context.get(name)
+            if name in plan.reductions:
+                if c_type not in self.OMP_REDUCTION_TYPES:
+                    return None
+                reductions.append((c_type, name))
+            elif c_type not in self.OMP_SCALAR_TYPES and c_type not in self.OMP_CONTAINER_TYPES:
+                return None
+            elif name in plan.private:
+                private.append((c_type, name))
+            else:
+                fields.append((c_type, name))
+
+        step_arg = stmt.iter.args[2] if len(stmt.iter.args) == 3 else None  # type: ignore[attr-defined]
+        step = step_arg.value if isinstance(step_arg, ast.Constant) else 1
+        loop_var = stmt.target.id  # type: ignore[attr-defined]
+        function = self._new_parallel_function()
+        chunk = f"for (size_t {function}_k = mgen_begin; {function}_k < mgen_end; {function}_k++)"
+        value = f"mgen_ctx->start + (int){function}_k" + (f" * {step}" if step != 1 else "")
+        sums = ", long long* mgen_sums" if reductions else ""
+        lines = self._parallel_context(function, fields)
+        lines.append(f"// Iterations [begin, end) of the parallel loop at line {stmt.lineno}")
+        lines.append(f"static void {function}(void* mgen_arg, size_t mgen_begin, size_t mgen_end{sums}) {{")
+        lines.extend(self._parallel_context_locals(function, fields[1:]))
+        lines.extend(f"    {c_type} {name} = 0;" for c_type, name in reductions)
+        lines.extend(f"    {c_type} {name};" for c_type, name in private)
+        lines.append(f"    {chunk} {{")
+        lines.append(f"        int {loop_var} = {value};")
+        lines.extend(f"        {line}" for line in body)
+        lines.append("    }")
+        lines.extend(f"    mgen_sums[{index}] += {name};" for index, (_, name) in enumerate(reductions))
+        lines.append("}")
+        self.parallel_functions.append("\n".join(lines))  # type: ignore[union-attr]
+
+        count = self._range_trip_count(f"{function}_start", f"{function}_stop", step)
+        threshold = int(self.preferences.get("parallel_threshold", 100000))
+        values = ", ".join([f"{function}_start", *(name for _, name in fields[1:])])
+        result = [
+            "{",
+            f"    int {function}_start = {start};",
+            f"    int {function}_stop = {stop};",
+            f"    {function}_ctx {function}_args = {{{values}}};",
+        ]
+        if reductions:
+            result.append(f"    long long {function}_sums[{len(reductions)}] = {{0}};")
+            result.append(
+                f"    mgen_parallel_reduce({count}, {threshold}, {function}, &{function}_args, {function}_sums, "
+                f"{len(reductions)});"
+            )
+            result.extend(
+                f"    {name} += ({c_type}){function}_sums[{index}];" for index, (c_type, name) in enumerate(reductions)
+            )
+        else:
+            result.append(f"    mgen_parallel_for({count}, {threshold}, {function}, &{function}_args);")
+        result.append("}")
+        return "\n".join(result)
+
+    def _pool_parallel_comprehension(
+        self, node: ast.ListComp, temp_var: str, container_type: str, loop_var: str, step: int, expr_str: str
+    ) -> Optional[list[str]]:
+        """Lines filling an unfiltered range comprehension on the mgen_parallel pool, or None.
+
+        Expects the _sized_range_bounds variables of temp_var; the element must be a
+        scalar and free of side effects, and only read scalars and lists.
+        """
+        element_type = container_type[4:]
+        if element_type not in ("int", "double", "float") or not self._can_outline(node):
+            return None
+        captured = self._parallel_captures(node.elt, loop_var)
+        if captured is None:
+            return None
+        function = self._new_parallel_function()
+        fields = [("int", "start"), *captured, (f"{element_type}*", "out")]
+        value = f"mgen_ctx->start + (int){function}_k" + (f" * {step}" if step != 1 else "")
+        lines = self._parallel_context(function, fields)
+        lines.append(f"// Elements [begin, end) of the comprehension at line {node.lineno}")
+        lines.append(f"static void {function}(void* mgen_arg, size_t mgen_begin, size_t mgen_end) {{")
+        lines.extend(self._parallel_context_locals(function, captured))
+        lines.append(f"    for (size_t {function}_k = mgen_begin; {function}_k < mgen_end; {function}_k++) {{")
+        lines.append(f"        int {loop_var} = {value};")
+        lines.append(f"        mgen_ctx->out[{function}_k] = {expr_str};")
+        lines.append("    }")
+        lines.append("}")
+        self.parallel_functions.append("\n".join(lines))  # type: ignore[union-attr]
+
+        out_var = f"{temp_var}_out"
+        count_var = f"{temp_var}_count"
+        if self._has_bulk_vec_api(container_type):
+            resize = f"{container_type}_resize_uninitialized(&{temp_var}, {count_var})"
+        else:
+            resize = f"{container_type}_resize(&{temp_var}, (isize){count_var}, 0) ? {temp_var}.data : NULL"
+        values = ", ".join([f"{temp_var}_start", *(name for _, name in captured), out_var])
+        threshold = int(self.preferences.get("parallel_threshold", 100000))
+        return [
+            f"    {element_type}* {out_var} = {resize};",
+            f"    if ({out_var}) {{",
+            f"        {function}_ctx {function}_args = {{{values}}};",
+            f"        mgen_parallel_for({count_var}, {threshold}, {function}, &{function}_args);",
+            "    }",
+        ]
+
+    def _pool_parallel_map(self, node: ast.ListComp, container_name: str, result_type: str) -> Optional[str]:
+        """[expr for x in xs] over a vec_int as mgen_parallel_map into a sized result, or None."""
+        generator = node.generators[0]
+        element_type = result_type[4:]
+        if (
+            generator.ifs
+            or element_type not in ("int", "double", "float")
+            or self.variable_context.get(container_name) != "vec_int"
+            or not self._can_outline(node)
+        ):
+            return None
+        loop_var = generator.target.id  # type: ignore[attr-defined]
+        captured = self._parallel_captures(node.elt, loop_var)
+        if captured is None or any(name == container_name for _, name in captured):
+            return None
+        previous = self.variable_context.get(loop_var)
+        self.variable_context[loop_var] = "int"
+        expr_str = self._convert_expression(node.elt)
+        if previous is None:
+            del self.variable_context[loop_var]
+        else:
+            self.variable_context[loop_var] = previous
+
+        function = self._new_parallel_function()
+        lines = self._parallel_context(function, captured) if captured else []
+        lines.append(f"// One element of the comprehension at line {node.lineno}")
+        lines.append(f"static void {function}(void* mgen_arg, const void* mgen_in, void* mgen_out) {{")
+        lines.extend(self._parallel_context_locals(function, captured) if captured else ["    (void)mgen_arg;"])
+        lines.append(f"    int {loop_var} = *(const int*)mgen_in;")
+        lines.append(f"    *({element_type}*)mgen_out = {expr_str};")
+        lines.append("}")
+        self.parallel_functions.append("\n".join(lines))  # type: ignore[union-attr]
+
+        temp_var = self._generate_temp_var_name("comp_result")
+        count_var = f"{temp_var}_count"
+        out_var = f"{temp_var}_out"
+        if self._has_bulk_vec_api(result_type):
+            resize = f"{result_type}_resize_uninitialized(&{temp_var}, {count_var})"
+        else:
+            resize = f"{result_type}_resize(&{temp_var}, (isize){count_var}, 0) ? {temp_var}.data : NULL"
+        threshold = int(self.preferences.get("parallel_threshold", 100000))
+        context = "NULL"
+        result = [
+            "({",
+            f"    {result_type} {temp_var} = {{0}};",
+            f"    size_t {count_var} = (size_t)vec_int_size(&{container_name});",
+            f"    {element_type}* {out_var} = {resize};",
+            f"    if ({out_var}) {{",
+        ]
+        if captured:
+            context = f"&{function}_args"
+            result.append(f"        {function}_ctx {function}_args = {{{', '.join(name for _, name in captured)}}};")
+        result.extend(
+            [
+                f"        mgen_parallel_map({container_name}.data, sizeof(int), {out_var}, sizeof({element_type}), "
+                f"{count_var}, {threshold}, {function}, {context});",
+                "    }",
+                f"    {temp_var};",
+                "})",
+            ]
+        )
+        return "\n".join(result)
+
+    def _can_outline(self, node: ast.AST) -> bool:
+        """Check that code of node can move into a chunk function emitted before the current function."""
+        if self.parallel_functions is None or self.hoisted_subscripts is not None:
+            return False
+        # The chunk function precedes the current function, which it therefore cannot call
+        return not any(
+            isinstance(child, ast.Call) and isinstance(child.func, ast.Name) and child.func.id == self.current_function
+            for child in ast.walk(node)
+        )
+
+    def _parallel_captures(self, expr: ast.expr, loop_var: str) -> Optional[list[tuple[str, str]]]:
+        """(C type, name) of the variables a comprehension element reads, if it may run on the pool.
+
+        The element may only call side-effect-free builtins, math functions and the
+        module's pure functions, and read scalars and lists (see OMP_SCALAR_TYPES).
+        """
+        callees = set()
+        for child in ast.walk(expr):
+            if isinstance(child, (ast.NamedExpr, ast.Lambda, ast.ListComp, ast.SetComp, ast.DictComp)):
+                return None
+            if isinstance(child, (ast.GeneratorExp, ast.Await, ast.Yield, ast.YieldFrom)):
+                return None
+            if isinstance(child, ast.Constant) and isinstance(child.value, str):
+                return None
+            if isinstance(child, ast.Call):
+                func = child.func
+                if child.keywords:
+                    return None
+                if isinstance(func, ast.Name) and (func.id in PARALLEL_SAFE_BUILTINS or func.id in self.pure_functions):
+                    callees.add(id(func))
+                elif isinstance(func, ast.Attribute) and isinstance(func.value, ast.Name) and func.value.id == "math":
+                    callees.add(id(func.value))
+                else:
+                    return None
+            elif isinstance(child, ast.Attribute):
+                if not (isinstance(child.value, ast.Name) and child.value.id == "math"):
+                    return None
+        captured: dict[str, str] = {}
+        for child in ast.walk(expr):
+            if isinstance(child, ast.Name) and id(child) not in callees and child.id != loop_var:
+                c_type = self.variable_context.get(child.id)
+                if c_type not in self.OMP_SCALAR_TYPES and c_type not in self.OMP_CONTAINER_TYPES:
+                    return None
+                captured[child.id] = c_type
+        return [(c_type, name) for name, c_type in sorted(captured.items())]
+
+    def _new_parallel_function(self) -> str:
+        """Name of the next chunk function outlined from the current function."""
+        self.includes_needed.add('#include "mgen_parallel.h"')
+        self.parallel_function_count += 1
+        return f"{self.current_function}_parallel_{self.parallel_function_count}"
+
+    def _parallel_context(self, function: str, fields: list[tuple[str, str]]) -> list[str]:
+        """typedef of a chunk function's context struct."""
+        lines = ["typedef struct {"]
+        lines.extend(f"    {c_type} {name};" for c_type, name in fields)
+        lines.extend([f"}} {function}_ctx;", ""])
+        return lines
+
+    def _parallel_context_locals(self, function: str, fields: list[tuple[str, str]]) -> list[str]:
+        """Chunk function prologue: the context and a local copy of each captured variable."""
+        lines = [f"    {function}_ctx* mgen_ctx = mgen_arg;"]
+        lines.extend(f"    {c_type} {name} = mgen_ctx->{name};" for c_type, name in fields)
+        return lines
+
+    def _bounds_checked(self, nodes: list[ast.AST], checked: str, unchecked: str) -> str:
+        """Choose between the bounds-checked and the direct form of an element access.
+
+        The direct form is used when the range loops around the access prove
+        every subscript in nodes in bounds; when some rely on the range check
+        of the loop being versioned, a placeholder stands for the access until
+        that loop picks the form per version.
+        """
+        if all(id(node) in self.safe_subscripts for node in nodes):
+            return unchecked
+        hoisted = self.hoisted_subscripts
+        if hoisted is not None and all(id(node) in self.safe_subscripts or id(node) in hoisted for node in nodes):
+            placeholder = f"@@mgen_bounds_{len(self.bounds_placeholders)}@@"
+            self.bounds_placeholders[placeholder] = ([id(node) for node in nodes], checked, unchecked)
+            return placeholder
+        return checked
+
+    def _hoist_bounds_checks(self, stmt: ast.For, start: str, stop: str) -> bool:
+        """Let one range check before a loop establish the bounds its proof leaves open.
+
+        The first such loop is versioned: its subscripts are emitted as
+        placeholders and _version_loop emits it twice, behind the check with
+        direct accesses and otherwise checked. The open bounds of loops nested
+        in it join the same check when their ranges are invariant in it.
+
+        Returns:
+            True if stmt is the loop to version
+        """
+        proof = self.bounds_proofs.get(id(stmt))
+        if proof is None or not proof.hoistable_range:
+            return False
+        pending = [access for access in proof.accesses if not access.proven]
+        if not pending:
+            return False
+        if self.versioned_loop is None:
+            self.versioned_loop, self.hoisted_subscripts, self.hoisted_ranges = proof, set(), []
+            versions = True
+        else:
+            outer = self.versioned_loop
+            range_names = {node.id for node in ast.walk(stmt.iter) if isinstance(node, ast.Name)}
+            if range_names & outer.assigned or "_at(" in start + stop:
+                return False
+            pending = [access for access in pending if access.container in outer.stable]
+            versions = False
+        assert self.hoisted_subscripts is not None
+        self.hoisted_subscripts.update(id(access.node) for access in pending)
+        self.hoisted_ranges.append((LoopBoundsProof(stmt, pending), start, stop))
+        return versions
+
+    def _bounds_size(self, container: str, dimension: int) -> Optional[str]:
+        """C expression for the length a subscript's index is checked against, or None if unsupported."""
+        c_type = self.variable_context.get(container, "")
+        if c_type == "mat_int":
+            return f"mat_int_{'cols' if dimension else 'rows'}(&{container})"
+        if dimension == 0 and c_type.startswith("vec_"):
+            return f"{c_type}_size(&{container})"
+        return None
+
+    def _version_loop(self, loop: str) -> str:
+        """Emit a hoisted range check, the loop with direct accesses behind it, and the checked loop otherwise."""
+        ranges, self.hoisted_ranges = self.hoisted_ranges, []
+        self.versioned_loop = self.hoisted_subscripts = None
+
+        conditions = []
+        covered = set()
+        for proof, start, stop in ranges:
+            checks = []
+            lowest: Optional[int] = None
+            highest: dict[str, int] = {}
+            for access in proof.accesses:
+                size = self._bounds_size(access.container, access.dimension)
+                if size is None:
+                    continue
+                covered.add(id(access.node))
+                if access.check_lower:
+                    lowest = access.offset if lowest is None else min(lowest, access.offset)
+                if access.check_upper:
+                    highest[size] = max(highest.get(size, access.offset), access.offset)
+            if lowest is not None:
+                checks.append(f"{self._offset(f'({start})', lowest)} >= 0")
+            checks.extend(f"{self._offset(f'({stop})', offset - 1)} < (int){size}" for size, offset in highest.items())
+            if checks:
+                conditions.append(f"(({start}) >= ({stop}) || ({' && '.join(checks)}))")
+
+        fast = self._resolve_bounds_placeholders(loop, self.safe_subscripts | covered)
+        slow = self._resolve_bounds_placeholders(loop, self.safe_subscripts)
+        if not conditions or fast == slow:
+            return self._aligned_loop(slow) if self._aligns_loop(slow) else slow
+        if self._aligns_loop(fast):
+            fast = self._aligned_loop(fast, own_block=False)
+        result = f"if ({' && '.join(conditions)}) {{\n"
+        result += "".join(f"    {line}\n" for line in fast.split("\n"))
+        result += "} else {\n"
+        result += "".join(f"    {line}\n" for line in slow.split("\n"))
+        return result + "}"
+
+    @staticmethod
+    def _offset(expr: str, offset: int) -> str:
+        """Add an integer constant to a C expression."""
+        if offset == 0:
+            return expr
+        return f"{expr} + {offset}" if offset > 0 else f"{expr} - {-offset}"
+
+    def _resolve_bounds_placeholders(self, code: str, safe: set[int]) -> str:
+        """Replace access placeholders with their direct form if all their subscripts are in safe, else checked."""
+        while "@@mgen_bounds_" in code:
+            for placeholder, (nodes, checked, unchecked) in self.bounds_placeholders.items():
+                if placeholder in code:
+                    code = code.replace(placeholder, unchecked if all(node in safe for node in nodes) else checked)
+        return code
+
     def _convert_for(self, stmt: ast.For) -> str:
         """Convert for loop (supports range() and container iteration)."""
-        if not isinstance(stmt.target, ast.Name):
+        is_items = (
+            isinstance(stmt.iter, ast.Call)
+            and isinstance(stmt.iter.func, ast.Attribute)
+            and stmt.iter.func.attr == "items"
+        )
+        if not isinstance(stmt.target, ast.Name) and not is_items:
             raise UnsupportedFeatureError("Only simple loop variables supported")
 
-        var_name = stmt.target.id
+        var_name = stmt.target.id if isinstance(stmt.target, ast.Name) else ""
+
+        if isinstance(stmt.iter, ast.Name) and self._soa_class(stmt.iter.id):
+            return self._convert_soa_for(stmt, var_name, stmt.iter.id)
 
         # Handle range-based iteration
         if isinstance(stmt.iter, ast.Call) and isinstance(stmt.iter.func, ast.Name) and stmt.iter.func.id == "range":
@@ -1920,18 +4041,43 @@ class MGenPythonToCConverter:
                 raise UnsupportedFeatureError("Invalid range() arguments")
 
             self.variable_context[var_name] = "int"
+            versions = self._hoist_bounds_checks(stmt, start, stop)
 
+            # Only the outermost parallel loop forks threads
+            plan = None if self.in_parallel_loop else self.parallel_loops.get(stmt.lineno)
+            enclosing, self.in_parallel_loop = self.in_parallel_loop, self.in_parallel_loop or plan is not None
+            declared_before = set(self.variable_context)
             body = []
             for s in stmt.body:
                 converted = self._convert_statement(s)
                 if converted:
                     body.extend(converted.split("\n"))
-
-            result = f"for (int {var_name} = {start}; {var_name} < {stop}; {var_name} += {step}) {{\n"
+            self.in_parallel_loop = enclosing
+
+            # Checked after the body so the types of its locals are known
+            if plan is not None and self.parallel_pool:
+                outlined = None
+                if not versions:
+                    outlined = self._pool_parallel_loop(stmt, plan, declared_before, start, stop, body)
+                if outlined is not None:
+                    return outlined
+                plan = None
+            pragma = self._omp_parallel_for(plan) if plan is not None else None
+            if pragma:
+                result = pragma + "\n"
+            elif LOOP_VECTORIZE in self.loop_hints.get(stmt.lineno, ()):
+                result = "MGEN_LOOP_INDEPENDENT\n"
+            else:
+                result = ""
+            # A generator's counter lives in its frame, declared with the other locals
+            declaration = "" if var_name in self.coroutine_fields.values() else "int "
+            result += f"for ({declaration}{var_name} = {start}; {var_name} < {stop}; {var_name} += {step}) {{\n"
             for line in body:
                 result += f"    {line}\n"
             result += "}"
-            return result
+            if versions:
+                return self._version_loop(result)
+            return self._aligned_loop(result) if self._aligns_loop(result) else result
 
         # Handle dict.values(), dict.keys(), dict.items() iteration
         elif (
@@ -1950,47 +4096,11 @@ class MGenPythonToCConverter:
             elif dict_name in self.inferred_types:
                 dict_type = self.inferred_types[dict_name].c_type
 
-            if not dict_type or not dict_type.startswith("map_"):
+            if not dict_type or not (dict_type.startswith("map_") or dict_type == "mgen_str_int_map_t*"):
                 dict_type = "map_int_int"  # Default
 
-            # Generate STC iterator loop
-            iter_var = self._generate_temp_var_name("iter")
-
-            if method == "values":
-                # for value in dict.values()
-                self.variable_context[var_name] = "int"  # TODO: infer value type
-
-                body = []
-                for s in stmt.body:
-                    converted = self._convert_statement(s)
-                    if converted:
-                        body.extend(converted.split("\n"))
-
-                result = f"{dict_type}_iter {iter_var} = {dict_type}_begin(&{dict_name});\n"
-                result += f"for (; {iter_var}.ref; {dict_type}_next(&{iter_var})) {{\n"
-                result += f"    int {var_name} = {iter_var}.ref->second;\n"
-                for line in body:
-                    result += f"    {line}\n"
-                result += "}"
-
-            elif method == "keys":
-                # for key in dict.keys()
-                self.variable_context[var_name] = "int"  # TODO: infer key type
-
-                body = []
-                for s in stmt.body:
-                    converted = self._convert_statement(s)
-                    if converted:
-                        body.extend(converted.split("\n"))
-
-                result = f"{dict_type}_iter {iter_var} = {dict_type}_begin(&{dict_name});\n"
-                result += f"for (; {iter_var}.ref; {dict_type}_next(&{iter_var})) {{\n"
-                result += f"    int {var_name} = {iter_var}.ref->first;\n"
-                for line in body:
-                    result += f"    {line}\n"
-                result += "}"
-
-            else:  # items
+            key_type, value_type = self._hash_element_types(dict_type)
+            if method == "items":
                 # for k, v in dict.items() - tuple unpacking
                 if (
                     not isinstance(stmt.target, ast.Tuple)
@@ -1999,27 +4109,131 @@ class MGenPythonToCConverter:
                     or not isinstance(stmt.target.elts[1], ast.Name)
                 ):
                     raise UnsupportedFeatureError("dict.items() requires 2-tuple unpacking (for k, v in ...)")
+                bindings = [
+                    (key_type, stmt.target.elts[0].id, "first"),
+                    (value_type, stmt.target.elts[1].id, "second"),
+                ]
+            elif method == "keys":
+                bindings = [(key_type, var_name, "first")]
+            else:
+                bindings = [(value_type, var_name, "second")]
+
+            for c_type, name, _field in bindings:
+                self.variable_context[name] = c_type
 
-                key_var = stmt.target.elts[0].id
-                value_var = stmt.target.elts[1].id
+            body = []
+            for s in stmt.body:
+                converted = self._convert_statement(s)
+                if converted:
+                    body.extend(converted.split("\n"))
 
-                self.variable_context[key_var] = "int"  # TODO: infer key type
-                self.variable_context[value_var] = "int"  # TODO: infer value type
+            # Header-inline cursor: a linear scan over the slot array for open-addressing maps
+            prefix, begin_arg = self._hash_cursor(dict_name, dict_type)
+            iter_var = self._generate_temp_var_name("iter")
+            result = f"{prefix}_iter {iter_var} = {prefix}_begin({begin_arg});\n"
+            result += f"for (; {iter_var}.ref; {prefix}_next(&{iter_var})) {{\n"
+            for c_type, name, field in bindings:
+                result += f"    {c_type} {name} = {iter_var}.ref->{field};\n"
+            for line in body:
+                result += f"    {line}\n"
+            result += "}"
+            return result
 
-                body = []
-                for s in stmt.body:
-                    converted = self._convert_statement(s)
-                    if converted:
-                        body.extend(converted.split("\n"))
+        # Handle str.split() iteration (for w in text.split())
+        elif (
+            isinstance(stmt.iter, ast.Call)
+            and isinstance(stmt.iter.func, ast.Attribute)
+            and stmt.iter.func.attr == "split"
+            and self._is_string_type(stmt.iter.func.value)
+        ):
+            if len(stmt.iter.args) > 1:
+                raise UnsupportedFeatureError("str.split() takes at most one argument")
+
+            source = self._convert_expression(stmt.iter.func.value)
+            delimiter = self._convert_expression(stmt.iter.args[0]) if stmt.iter.args else "NULL"
+
+            self.variable_context[var_name] = "char*"
+
+            body = []
+            for s in stmt.body:
+                converted = self._convert_statement(s)
+                if converted:
+                    body.extend(converted.split("\n"))
 
-                result = f"{dict_type}_iter {iter_var} = {dict_type}_begin(&{dict_name});\n"
-                result += f"for (; {iter_var}.ref; {dict_type}_next(&{iter_var})) {{\n"
-                result += f"    int {key_var} = {iter_var}.ref->first;\n"
-                result += f"    int {value_var} = {iter_var}.ref->second;\n"
+            if self._split_tokens_can_borrow(stmt):
+                # Tokens are scanned in place; each one is NUL-terminated into a
+                # single reused scratch buffer instead of being allocated
+                splitter_var = self._generate_temp_var_name("splitter")
+                result = f"mgen_str_splitter_t {splitter_var} = mgen_str_splitter_init({source}, {delimiter});\n"
+                result += f"for (const char* {var_name}; ({var_name} = mgen_str_splitter_next(&{splitter_var})) != NULL;) {{\n"
+                for line in body:
+                    result += f"    {line}\n"
+                result += "}\n"
+                result += f"mgen_str_splitter_free(&{splitter_var});"
+            else:
+                # Tokens may outlive the loop: materialize them
+                tokens_var = self._generate_temp_var_name("tokens")
+                index_var = self._generate_temp_var_name("loop_idx")
+                result = f"mgen_string_array_t* {tokens_var} = mgen_str_split({source}, {delimiter});\n"
+                result += f"for (size_t {index_var} = 0; {index_var} < mgen_string_array_size({tokens_var}); {index_var}++) {{\n"
+                result += f"    const char* {var_name} = mgen_string_array_get({tokens_var}, {index_var});\n"
                 for line in body:
                     result += f"    {line}\n"
                 result += "}"
+            return result
 
+        # Resume a generator once per iteration
+        elif self._is_generator_call(stmt.iter):
+            declaration, gen_var, yield_type = self._generator_frame(stmt.iter)  # type: ignore[misc]
+            self.variable_context[var_name] = yield_type
+            body = []
+            for s in stmt.body:
+                converted = self._convert_statement(s)
+                if converted:
+                    body.extend(converted.split("\n"))
+            result = f"{declaration}\n"
+            result += f"while ({stmt.iter.func.id}(&{gen_var})) {{\n"  # type: ignore[attr-defined]
+            result += f"    {yield_type} {var_name} = {gen_var}.yielded;\n"
+            for line in body:
+                result += f"    {line}\n"
+            result += "}"
+            return result
+
+        # A list in a generator's frame: the index lives in the frame too, so it survives a yield
+        elif isinstance(stmt.iter, ast.Name) and var_name in self.coroutine_fields.values():
+            container_name = stmt.iter.id
+            container_type = self.variable_context.get(container_name, "vec_int")
+            index_field = f"loop_idx_{len(self.coroutine_extra_fields)}"
+            self.coroutine_extra_fields.append((index_field, "size_t"))
+            index_var = f"{self.COROUTINE_FRAME}->{index_field}"
+            body = []
+            for s in stmt.body:
+                converted = self._convert_statement(s)
+                if converted:
+                    body.extend(converted.split("\n"))
+            bound = f"{container_type}_size(&{container_name})"
+            result = f"for ({index_var} = 0; {index_var} < {bound}; {index_var}++) {{\n"
+            result += f"    {var_name} = *{container_type}_at(&{container_name}, {index_var});\n"
+            for line in body:
+                result += f"    {line}\n"
+            result += "}"
+            return result
+
+        # Code points of a string, each NUL-terminated into the iterator's buffer
+        elif isinstance(stmt.iter, ast.Name) and self.variable_context.get(stmt.iter.id) in ("char*", "const char*"):
+            self.includes_needed.add('#include "mgen_utf8.h"')
+            self.variable_context[var_name] = "char*"
+            body = []
+            for s in stmt.body:
+                converted = self._convert_statement(s)
+                if converted:
+                    body.extend(converted.split("\n"))
+            iter_var = self._generate_temp_var_name("chars")
+            result = f"mgen_utf8_iter_t {iter_var} = mgen_utf8_iter({stmt.iter.id});\n"
+            result += f"for (const char* {var_name}; ({var_name} = mgen_utf8_next(&{iter_var})) != NULL;) {{\n"
+            for line in body:
+                result += f"    {line}\n"
+            result += "}"
             return result
 
         # Handle container iteration (for x in container)
@@ -2043,9 +4257,8 @@ class MGenPythonToCConverter:
                 element_type = container_type[4:]  # Remove "vec_" prefix
                 self.variable_context[var_name] = element_type
             elif container_type and container_type.startswith("set_"):
-                # Extract element type from set_TYPE (e.g., set_int -> int)
-                element_type = container_type[4:]  # Remove "set_" prefix
-                self.variable_context[var_name] = element_type
+                # Element C type from set_TYPE (e.g., set_int -> int, set_str -> char*)
+                self.variable_context[var_name] = self._hash_element_types(container_type)[0]
             else:
                 self.variable_context[var_name] = "int"  # Default
 
@@ -2064,9 +4277,8 @@ class MGenPythonToCConverter:
                     result += f"    {line}\n"
                 result += "}"
             elif container_type and container_type.startswith("set_"):
-                # STC set iteration using iterator (var_name already set above)
-                # Extract element type from set_TYPE (e.g., set_int -> int)
-                element_type = container_type[4:]  # Remove "set_" prefix
+                # Set cursor (var_name already set above)
+                element_type = self._hash_element_types(container_type)[0]
                 iter_var = self._generate_temp_var_name("set_iter")
                 result = f"{container_type}_iter {iter_var} = {container_type}_begin(&{container_name});\n"
                 result += f"for (; {iter_var}.ref; {container_type}_next(&{iter_var})) {{\n"
@@ -2097,6 +4309,218 @@ class MGenPythonToCConverter:
         else:
             raise UnsupportedFeatureError("Only for loops with range() or container iteration supported")
 
+    def _split_tokens_can_borrow(self, stmt: ast.For) -> bool:
+        """Check that split() tokens in a for loop never outlive their iteration.
+
+        Borrowed tokens live in a scratch buffer that is overwritten on every
+        iteration, so the loop may only read its variable: binding it to another
+        name or returning it would keep a pointer past the next token. The
+        source string must not be rebound inside the loop either. Containers
+        that receive the token (append/add/insert) store their own copies.
+        """
+        assert isinstance(stmt.target, ast.Name) and isinstance(stmt.iter, ast.Call)
+        var_name = stmt.target.id
+        source = stmt.iter.func.value  # type: ignore[attr-defined]
+        source_name = source.id if isinstance(source, ast.Name) else None
+
+        for node in ast.walk(ast.Module(body=stmt.body, type_ignores=[])):
+            if isinstance(node, (ast.Return, ast.Assign, ast.AnnAssign, ast.AugAssign, ast.Yield)):
+                value = node.value
+                if isinstance(value, ast.Name) and value.id == var_name:
+                    return False
+            if isinstance(node, ast.Name) and isinstance(node.ctx, ast.Store):
+                if node.id in (var_name, source_name):
+                    return False
+        return True
+
+    def _convert_loop_with_string_builders(
+        self, stmt: Union[ast.For, ast.While], convert: Callable[[Any], str]
+    ) -> str:
+        """Convert a loop, building strings it only ever extends in an mgen_buffer_t.
+
+        ``s = s + x`` / ``s += x`` in a loop copies the whole string on every
+        iteration. When the loop never otherwise reads or rebinds ``s``, each
+        piece is appended to one geometrically growing buffer instead, and the
+        buffer is handed back to ``s`` without a copy once the loop finishes.
+        """
+        targets = []
+        if self.preferences.get("string_builder_loops", True):
+            targets = self._find_string_builder_targets(stmt)
+        if not targets:
+            return convert(stmt)
+
+        buffers = {var_name: self._generate_temp_var_name(f"{var_name}_buf") for var_name in targets}
+        self.string_builders.update(buffers)
+        prologue = []
+        epilogue = []
+        for var_name, buffer_var in buffers.items():
+            hint = self._string_builder_capacity_hint(stmt, var_name)
+            prologue.append(f"mgen_buffer_t {buffer_var};")
+            prologue.append(f"mgen_buffer_init(&{buffer_var}, {hint});")
+            prologue.append(f"mgen_buffer_append_str(&{buffer_var}, {var_name});")
+            epilogue.append(f"{var_name} = mgen_buffer_detach(&{buffer_var});")
+
+        try:
+            loop_code = convert(stmt)
+        finally:
+            for var_name in targets:
+                del self.string_builders[var_name]
+
+        return "\n".join([*prologue, loop_code, *epilogue])
+
+    def _string_builder_pieces(self, stmt: ast.stmt, var_name: str) -> Optional[list[ast.expr]]:
+        """Return the pieces appended by ``var = var + a + b`` or ``var += a``, else None."""
+        if isinstance(stmt, ast.AugAssign):
+            if isinstance(stmt.target, ast.Name) and stmt.target.id == var_name and isinstance(stmt.op, ast.Add):
+                return [stmt.value]
+            return None
+
+        if not (
+            isinstance(stmt, ast.Assign)
+            and len(stmt.targets) == 1
+            and isinstance(stmt.targets[0], ast.Name)
+            and stmt.targets[0].id == var_name
+        ):
+            return None
+
+        # Walk down the left spine of the + chain to the variable itself
+        pieces: list[ast.expr] = []
+        value = stmt.value
+        while isinstance(value, ast.BinOp) and isinstance(value.op, ast.Add):
+            pieces.append(value.right)
+            value = value.left
+        if not pieces or not (isinstance(value, ast.Name) and value.id == var_name):
+            return None
+        return pieces[::-1]
+
+    def _find_string_builder_targets(self, stmt: Union[ast.For, ast.While]) -> list[str]:
+        """Find string variables a loop uses only as the accumulator of appends.
+
+        Candidates are declared ``char*`` variables that are not already being
+        built by an enclosing loop. The loop must not read the variable anywhere
+        else (its value is only materialized after the loop) and must not return
+        from inside the body, which would skip the hand-back.
+        """
+        body = ast.Module(body=stmt.body, type_ignores=[])
+        if any(isinstance(node, (ast.Return, ast.Yield)) for node in ast.walk(body)):
+            return []
+
+        candidates: dict[str, list[ast.stmt]] = {}
+        for node in ast.walk(body):
+            if isinstance(node, ast.AugAssign) and isinstance(node.target, ast.Name):
+                name = node.target.id
+            elif isinstance(node, ast.Assign) and len(node.targets) == 1 and isinstance(node.targets[0], ast.Name):
+                name = node.targets[0].id
+            else:
+                continue
+            if self.variable_context.get(name) != "char*" or name in self.string_builders:
+                continue
+            if self._string_builder_pieces(node, name) is not None:
+                candidates.setdefault(name, []).append(node)
+
+        targets = []
+        for name, appends in candidates.items():
+            # Every use of the name must be the accumulator position of an append
+            allowed = {id(stmt_node) for stmt_node in appends}
+            for stmt_node in appends:
+                if isinstance(stmt_node, ast.Assign):
+                    value = stmt_node.value
+                    while isinstance(value, ast.BinOp):
+                        value = value.left
+                    allowed.add(id(value))
+                    allowed.add(id(stmt_node.targets[0]))
+                else:
+                    allowed.add(id(stmt_node.target))  # type: ignore[attr-defined]
+
+            uses = [node for node in ast.walk(stmt) if isinstance(node, ast.Name) and node.id == name]
+            if all(id(node) in allowed for node in uses):
+                targets.append(name)
+        return sorted(targets)
+
+    def _string_builder_capacity_hint(self, stmt: Union[ast.For, ast.While], var_name: str) -> str:
+        """Estimate the bytes a loop appends to var_name, as a C expression (0 when unknown).
+
+        Only ``range(stop)`` / ``range(start, stop)`` loops over names and
+        constants get a hint: trip count times the per-iteration upper bound of
+        the appends directly in the body (literals by length, numbers by their
+        widest text form).
+        """
+        if not (
+            isinstance(stmt, ast.For)
+            and isinstance(stmt.iter, ast.Call)
+            and isinstance(stmt.iter.func, ast.Name)
+            and stmt.iter.func.id == "range"
+            and len(stmt.iter.args) in (1, 2)
+            and all(isinstance(arg, (ast.Name, ast.Constant)) for arg in stmt.iter.args)
+        ):
+            return "0"
+
+        per_iteration = 0
+        for node in stmt.body:
+            pieces = self._string_builder_pieces(node, var_name)
+            if pieces:
+                per_iteration += sum(self._string_builder_piece_size(piece) for piece in pieces)
+        if per_iteration == 0:
+            return "0"
+
+        args = [self._convert_expression(arg) for arg in stmt.iter.args]
+        trip_count = args[0] if len(args) == 1 else f"{args[1]} - {args[0]}"
+        return f"mgen_buffer_capacity_hint({trip_count}, {per_iteration})"
+
+    def _string_builder_piece_size(self, piece: ast.expr) -> int:
+        """Upper-bound text size of one appended piece (a guess for string variables)."""
+        if isinstance(piece, ast.Constant) and isinstance(piece.value, str):
+            return len(piece.value.encode("utf-8"))
+        if isinstance(piece, ast.JoinedStr):
+            return sum(self._string_builder_piece_size(value) for value in piece.values)
+        if isinstance(piece, ast.FormattedValue):
+            piece = piece.value
+        elif isinstance(piece, ast.Call) and isinstance(piece.func, ast.Name) and piece.func.id == "str":
+            piece = piece.args[0] if piece.args else piece
+        value_type = self._infer_expression_type(piece)
+        if value_type == "int":
+            return 11
+        if value_type == "double":
+            return 13
+        return 16
+
+    def _convert_string_builder_append(self, stmt: Union[ast.Assign, ast.AugAssign]) -> str:
+        """Convert an accumulating assignment into appends to the variable's buffer."""
+        target = stmt.target if isinstance(stmt, ast.AugAssign) else stmt.targets[0]
+        assert isinstance(target, ast.Name)
+        buffer_var = self.string_builders[target.id]
+        pieces = self._string_builder_pieces(stmt, target.id)
+        assert pieces is not None
+
+        lines = []
+        for piece in pieces:
+            if isinstance(piece, ast.JoinedStr):
+                parts = [value.value if isinstance(value, ast.FormattedValue) else value for value in piece.values]
+                lines.extend(self._buffer_append_statement(buffer_var, part) for part in parts)
+            elif isinstance(piece, ast.Call) and isinstance(piece.func, ast.Name) and piece.func.id == "str":
+                if len(piece.args) != 1:
+                    raise UnsupportedFeatureError("Type cast str() expects exactly 1 argument")
+                lines.append(self._buffer_append_statement(buffer_var, piece.args[0]))
+            else:
+                lines.append(self._buffer_append_statement(buffer_var, piece))
+        return "\n".join(lines)
+
+    def _buffer_append_statement(self, buffer_var: str, value: ast.expr) -> str:
+        """Append one value's text form to a buffer without an intermediate string."""
+        if isinstance(value, ast.Constant) and isinstance(value.value, str):
+            literal = self._convert_expression(value)
+            return f"mgen_buffer_append(&{buffer_var}, {literal}, sizeof({literal}) - 1);"
+
+        expr_code = self._convert_expression(value)
+        value_type = self._infer_expression_type(value)
+        if value_type == "double":
+            return f"mgen_buffer_append_float(&{buffer_var}, {expr_code});"
+        if value_type in ("char*", "const char*") or self._is_string_type(value):
+            return f"mgen_buffer_append_str(&{buffer_var}, {expr_code});"
+        if value_type == "bool":
+            return f"mgen_buffer_append_str(&{buffer_var}, {expr_code} ? \"True\" : \"False\");"
+        return f"mgen_buffer_append_int(&{buffer_var}, {expr_code});"
+
     def _convert_expression_statement(self, stmt: ast.Expr) -> str:
         """Convert expression statement."""
         # Check if this is a docstring (string literal as standalone statement)
@@ -2143,6 +4567,9 @@ class MGenPythonToCConverter:
 
     def _convert_attribute(self, expr: ast.Attribute) -> str:
         """Convert attribute access."""
+        field = self._soa_field(expr)
+        if field:
+            return field
         obj = self._convert_expression(expr.value)
 
         # If this is a self reference in a method, use pointer access
@@ -2169,13 +4596,30 @@ class MGenPythonToCConverter:
         else:  # Python >= 3.9
             index = self._convert_expression(expr.slice)
 
+        if isinstance(expr.value, ast.Name) and expr.value.id in self.constant_str_dicts:
+            match, _ = self.constant_str_dicts[expr.value.id]
+            return f"{match.replace('match', 'table')}_at({index})"
+        tuple_field = self._tuple_field(expr)
+        if tuple_field:
+            return f"{self._convert_expression(expr.value)}.{tuple_field[0]}"
+
         # Check if this is a nested subscript (e.g., a[i][j])
         if isinstance(expr.value, ast.Subscript):
+            matrix = expr.value.value
+            if isinstance(matrix, ast.Name) and self.variable_context.get(matrix.id) == "mat_int":
+                # Flat matrix: one bounds-checked offset computation, no row pointer
+                row_index = self._convert_expression(expr.value.slice)
+                return self._bounds_checked(
+                    [expr.value, expr],
+                    f"*mat_int_at(&{matrix.id}, {row_index}, {index})",
+                    f"{matrix.id}.data[({row_index}) * {matrix.id}.stride + ({index})]",
+                )
+
             # This is nested - handle the outer subscript first
             inner = self._convert_subscript(expr.value)
             # The inner subscript returns a pointer (vec_int*), so we can use it directly
             # vec_vec_int_at returns vec_int*, so: *vec_int_at(vec_vec_int_at(&a, i), j)
-            return f"*vec_int_at({inner}, {index})"
+            return self._bounds_checked([expr], f"*vec_int_at({inner}, {index})", f"({inner})->data[{index}]")
 
         # Convert object expression
         obj = self._convert_expression(expr.value)
@@ -2193,22 +4637,26 @@ class MGenPythonToCConverter:
                 c_type = self.inferred_types[var_name].c_type
 
             if c_type:
+                if c_type in ("char*", "const char*"):
+                    return self._string_index(var_name, index)
                 # If it's a mgen_string_array_t*, use mgen_string_array_get()
-                if c_type == "mgen_string_array_t*":
+                elif c_type == "mgen_string_array_t*":
                     return f"mgen_string_array_get({obj}, {index})"
                 # If it's a nested vector (vec_vec_int), first access returns a vec_int*
                 elif c_type == "vec_vec_int":
-                    return f"vec_vec_int_at(&{obj}, {index})"
+                    return self._bounds_checked([expr], f"vec_vec_int_at(&{obj}, {index})", f"(&{obj}.data[{index}])")
                 # If it's an STC vector type, use vec_*_at() function
                 elif c_type.startswith("vec_"):
-                    # DEBUG
-                    # print(f"DEBUG SUBSCRIPT: var={var_name}, c_type={c_type}, generating *{c_type}_at")
-                    return f"*{c_type}_at(&{obj}, {index})"
+                    return self._bounds_checked([expr], f"*{c_type}_at(&{obj}, {index})", f"{obj}.data[{index}]")
                 # If it's a map type, use appropriate get function
                 elif c_type == "map_str_int":
                     # Vanilla C string map: returns int*, dereference it
-                    return f"*mgen_str_int_map_get({obj}, {index})"
+                    function, key = self._str_map_key("mgen_str_int_map_get", expr.slice, index)
+                    return f"*{function}({obj}, {key})"
                 elif c_type.startswith("map_"):
+                    if self._hand_written_containers():
+                        # Hand-written map get returns a pointer to the value
+                        return f"*{c_type}_get(&{obj}, {index})"
                     # STC map get returns a pointer to entry, need ->second for value
                     return f"{c_type}_get(&{obj}, {index})->second"
 
@@ -2245,6 +4693,9 @@ class MGenPythonToCConverter:
             elif var_name in self.inferred_types:
                 c_type = self.inferred_types[var_name].c_type
 
+        if c_type in ("char*", "const char*"):
+            return self._string_slice(expr)
+
         if not c_type or not c_type.startswith("vec_"):
             raise UnsupportedFeatureError(f"Slicing only supported for vec_* containers, got {c_type}")
 
@@ -2253,6 +4704,22 @@ class MGenPythonToCConverter:
         stop = self._convert_expression(slice_obj.upper) if slice_obj.upper else f"{c_type}_size(&{obj})"
         step = self._convert_expression(slice_obj.step) if slice_obj.step else "1"
 
+        # Read-only slices share the source's elements: clamp the bounds, no copy
+        if id(expr) in self.slice_views:
+            self.includes_needed.add('#include "mgen_stc_bridge.h"')
+            first = self._generate_temp_var_name("view_first")
+            length = self._generate_temp_var_name("view_len")
+            view_stop = self._convert_expression(slice_obj.upper) if slice_obj.upper else "MGEN_SLICE_END"
+            return (
+                f"({{ size_t {first}; "
+                f"size_t {length} = mgen_slice_range((size_t){c_type}_size(&{obj}), {start}, {view_stop}, &{first}); "
+                f"({c_type}){{.data = {obj}.data + {first}, .size = {length}, .capacity = {length}}}; }})"
+            )
+
+        # Contiguous slices of generated vectors copy the range in one memcpy
+        if not slice_obj.step and self._has_bulk_vec_api(c_type):
+            return f"{c_type}_copy_range(&{obj}, (size_t)({start}), (size_t)({stop}))"
+
         # Generate unique variable name for the slice result
         slice_var = f"slice_result_{id(expr)}"
 
@@ -2307,6 +4774,8 @@ class MGenPythonToCConverter:
         else:
             # Use mgen_sprintf_string helper (needs to be in runtime)
             args_str = ", ".join(args)
+            if self.scope_allocator_var:
+                return f'mgen_scope_sprintf_string({self.scope_allocator_var}, "{format_string}", {args_str})'
             return f'mgen_sprintf_string("{format_string}", {args_str})'
 
     def _to_c_string_expr(self, expr_code: str, node: ast.expr) -> str:
@@ -2328,7 +4797,72 @@ class MGenPythonToCConverter:
         # For other types, we need a temp buffer approach
         # This is a simplified version - in practice would need type inference
         # For now, assume integers and use mgen_int_to_string
-        return f'mgen_int_to_string({expr_code})'
+        return self._int_to_string_expr(expr_code)
+
+    def _int_to_string_expr(self, expr_code: str) -> str:
+        """Convert an int expression to a temporary C string (scope-allocated when active)."""
+        if self.scope_allocator_var:
+            return f"mgen_scope_int_to_string({self.scope_allocator_var}, {expr_code})"
+        return f"mgen_int_to_string({expr_code})"
+
+    def _can_scope_temporaries(self, node: ast.FunctionDef) -> bool:
+        """Check whether a function's temporary strings can die when it returns.
+
+        Scope-allocated strings are freed in one shot on return, so a function
+        only qualifies when none of them can be stored somewhere that outlives
+        the call: no globals, no attribute or subscript stores, and no calls
+        that may keep a pointer argument (container inserts, object methods).
+        Returned strings are copied out of the scope by _convert_return.
+        """
+        string_methods = {"upper", "lower", "strip", "find", "count", "replace", "split", "lstrip", "rstrip"}
+
+        for child in ast.walk(node):
+            if child is not node and isinstance(child, (ast.FunctionDef, ast.Lambda)):
+                return False
+            if isinstance(child, (ast.Global, ast.Nonlocal, ast.Yield, ast.YieldFrom)):
+                return False
+            if isinstance(child, (ast.Attribute, ast.Subscript)) and isinstance(child.ctx, ast.Store):
+                return False
+            if isinstance(child, ast.Call) and isinstance(child.func, ast.Attribute):
+                if child.func.attr not in string_methods:
+                    return False
+            if isinstance(child, ast.Call) and isinstance(child.func, ast.Name):
+                if child.func.id in self.defined_structs:
+                    return False
+
+        # Only worth a scope if the function builds temporary strings
+        str_names = {arg.arg for arg in node.args.args if self._is_str_annotation(arg.annotation)}
+        for child in ast.walk(node):
+            if isinstance(child, ast.AnnAssign) and isinstance(child.target, ast.Name):
+                if self._is_str_annotation(child.annotation):
+                    str_names.add(child.target.id)
+
+        def is_str_operand(operand: ast.expr) -> bool:
+            if isinstance(operand, ast.Constant):
+                return isinstance(operand.value, str)
+            if isinstance(operand, ast.Name):
+                return operand.id in str_names
+            return isinstance(operand, ast.JoinedStr) or (
+                isinstance(operand, ast.BinOp) and isinstance(operand.op, ast.Add) and is_str_operand(operand.left)
+            )
+
+        for child in ast.walk(node):
+            if isinstance(child, ast.JoinedStr) and any(isinstance(v, ast.FormattedValue) for v in child.values):
+                return True
+            if isinstance(child, ast.Call) and isinstance(child.func, ast.Name) and child.func.id == "str":
+                return True
+            if isinstance(child, ast.BinOp) and isinstance(child.op, ast.Add):
+                if is_str_operand(child.left) or is_str_operand(child.right):
+                    return True
+            if isinstance(child, ast.AugAssign) and isinstance(child.op, ast.Add):
+                if is_str_operand(child.target) or is_str_operand(child.value):
+                    return True
+        return False
+
+    @staticmethod
+    def _is_str_annotation(annotation: Optional[ast.expr]) -> bool:
+        """Check for a plain ``str`` annotation."""
+        return isinstance(annotation, ast.Name) and annotation.id == "str"
 
     def _convert_class(self, node: ast.ClassDef) -> str:
         """Convert Python class to C struct with associated methods."""
@@ -2397,8 +4931,111 @@ class MGenPythonToCConverter:
                 parts.append(method_def)
             parts.append("")
 
+        if class_name in self.soa_classes:
+            parts.append(self._generate_soa_list(class_name, instance_vars))
+            parts.append("")
+
         return "\n".join(parts)
 
+    def _generate_soa_list(self, class_name: str, instance_vars: dict[str, str]) -> str:
+        """Generate Class_soa, the list of a struct_of_arrays_classes class: one array per field.
+
+        Loops over one field then read consecutive memory, which the compiler
+        can vectorize. Besides push, size and drop there is a bounds-checked
+        accessor per field, Class_soa_f_at, for the subscripts no loop proves.
+        """
+        soa_type = f"{class_name}_soa"
+        fields = {name: instance_vars[name] for name in self.soa_classes[class_name]}
+        lines = [f"typedef struct {soa_type} {{"]
+        lines.extend(f"    {c_type}* {name};" for name, c_type in fields.items())
+        lines.extend(["    size_t size;", "    size_t capacity;", f"}} {soa_type};", ""])
+
+        lines.append(f"static inline bool {soa_type}_push({soa_type}* soa, {class_name} item) {{")
+        lines.append("    if (soa->size == soa->capacity) {")
+        lines.append("        size_t capacity = soa->capacity ? soa->capacity * 2 : 8;")
+        for name, c_type in fields.items():
+            # A failed realloc leaves the arrays grown so far valid: capacity only grows once all are
+            lines.append(f"        {c_type}* {name} = realloc(soa->{name}, capacity * sizeof({c_type}));")
+            lines.append(f"        if (!{name}) {{")
+            lines.append(f'            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow {class_name} list");')
+            lines.append("            return false;")
+            lines.append("        }")
+            lines.append(f"        soa->{name} = {name};")
+        lines.append("        soa->capacity = capacity;")
+        lines.append("    }")
+        lines.extend(f"    soa->{name}[soa->size] = item.{name};" for name in fields)
+        lines.extend(["    soa->size++;", "    return true;", "}", ""])
+
+        lines.append(f"static inline size_t {soa_type}_size(const {soa_type}* soa) {{")
+        lines.extend(["    return soa->size;", "}", ""])
+
+        for name, c_type in fields.items():
+            lines.append(f"static inline {c_type}* {soa_type}_{name}_at({soa_type}* soa, size_t index) {{")
+            lines.append("    if (index >= soa->size) {")
+            lines.append('        MGEN_SET_ERROR(MGEN_ERROR_INDEX, "Index out of bounds");')
+            lines.append("        return NULL;")
+            lines.append("    }")
+            lines.extend([f"    return &soa->{name}[index];", "}", ""])
+
+        lines.append(f"static inline void {soa_type}_drop({soa_type}* soa) {{")
+        lines.extend(f"    free(soa->{name});" for name in fields)
+        lines.extend([f"    *soa = ({soa_type}){{0}};", "}"])
+        return "\n".join(lines)
+
+    def _soa_list_type(self, annotation: Optional[ast.expr]) -> Optional[str]:
+        """Class_soa for a list[Class] annotation of a struct-of-arrays class, else None."""
+        if isinstance(annotation, ast.Subscript) and isinstance(annotation.value, ast.Name):
+            element = annotation.slice
+            if annotation.value.id == "list" and isinstance(element, ast.Name) and element.id in self.soa_classes:
+                return f"{element.id}_soa"
+        return None
+
+    def _soa_class_of_type(self, c_type: Optional[str]) -> Optional[str]:
+        """The class of a Class_soa type, else None."""
+        if c_type and c_type.endswith("_soa") and c_type[: -len("_soa")] in self.soa_classes:
+            return c_type[: -len("_soa")]
+        return None
+
+    def _soa_class(self, name: str) -> Optional[str]:
+        """The class of a struct-of-arrays list variable, else None."""
+        return self._soa_class_of_type(self.variable_context.get(name))
+
+    def _soa_field(self, expr: ast.Attribute) -> Optional[str]:
+        """The array slot xs[i].f or v.f (v iterating xs) stands for, when xs is a struct-of-arrays list."""
+        if isinstance(expr.value, ast.Name) and expr.value.id in self.soa_loops:
+            soa, index = self.soa_loops[expr.value.id]
+            return f"{soa}.{expr.attr}[{index}]"
+        element = expr.value
+        if not (isinstance(element, ast.Subscript) and isinstance(element.value, ast.Name)):
+            return None
+        if not self._soa_class(element.value.id):
+            return None
+        soa = element.value.id
+        index = self._convert_expression(element.slice)
+        checked = f"(*{self.variable_context[soa]}_{expr.attr}_at(&{soa}, {index}))"
+        return self._bounds_checked([element], checked, f"{soa}.{expr.attr}[{index}]")
+
+    def _convert_soa_for(self, stmt: ast.For, var_name: str, soa: str) -> str:
+        """Loop over a struct-of-arrays list by index; var_name.f in the body reads the f array."""
+        index_var = self._generate_temp_var_name("loop_idx")
+        enclosing = self.soa_loops.get(var_name)
+        self.soa_loops[var_name] = (soa, index_var)
+        body = []
+        for s in stmt.body:
+            converted = self._convert_statement(s)
+            if converted:
+                body.extend(converted.split("\n"))
+        if enclosing is None:
+            del self.soa_loops[var_name]
+        else:
+            self.soa_loops[var_name] = enclosing
+        soa_type = self.variable_context[soa]
+        result = f"for (size_t {index_var} = 0; {index_var} < {soa_type}_size(&{soa}); {index_var}++) {{\n"
+        for line in body:
+            result += f"    {line}\n"
+        result += "}"
+        return result
+
     def _extract_instance_variables(self, class_node: ast.ClassDef) -> dict[str, str]:
         """Extract instance variables from class definition."""
         instance_vars = {}
@@ -2764,12 +5401,23 @@ class MGenPythonToCConverter:
             else:
                 raise UnsupportedFeatureError("Invalid range() arguments in comprehension")
 
+            # A known trip count lets the result be sized with one allocation up front
+            trip_count_step = self._comprehension_range_step(range_args)
+            if trip_count_step is not None:
+                return self._convert_sized_range_comprehension(
+                    node, temp_var, result_container_type, loop_var, start, end, trip_count_step
+                )
+
             loop_code = f"for (int {loop_var} = {start}; {loop_var} < {end}; {loop_var} += {step})"
             loop_var_decl = None  # No separate variable declaration needed for range
 
         # Handle iteration over container variables (e.g., for x in numbers)
         elif isinstance(generator.iter, ast.Name):
             container_name = generator.iter.id
+            if self.parallel_pool:
+                parallel = self._pool_parallel_map(node, container_name, result_container_type)
+                if parallel is not None:
+                    return parallel
             # Use vec_int as default type for now (TODO: proper type inference)
             container_size_call = f"vec_int_size(&{container_name})"
             container_at_call = f"vec_int_at(&{container_name}, __idx_{temp_var})"
@@ -2819,6 +5467,152 @@ class MGenPythonToCConverter:
 
         return comp_code
 
+    def _has_bulk_vec_api(self, c_type: str) -> bool:
+        """Check if c_type is a generated vector with the bulk operations API (fill, copy_range, ...)."""
+        if not self._hand_written_containers():
+            return False
+        return c_type in ("vec_int", "vec_double", "vec_float")
+
+    def _comprehension_range_step(self, range_args: list[ast.expr]) -> Optional[int]:
+        """Return the step of a comprehension range() whose trip count is computable, else None."""
+        if len(range_args) in (1, 2):
+            return 1
+        if len(range_args) == 3:
+            step_arg = range_args[2]
+            if isinstance(step_arg, ast.Constant) and type(step_arg.value) is int and step_arg.value > 0:
+                return step_arg.value
+        return None
+
+    def _range_trip_count(self, start: str, stop: str, step: int) -> str:
+        """C expression for the number of iterations of range(start, stop, step) with step > 0."""
+        span = f"(long long){stop} - {start}"
+        trip_count = f"(size_t)({span})" if step == 1 else f"(size_t)(({span} + {step - 1}) / {step})"
+        return f"{stop} > {start} ? {trip_count} : 0"
+
+    def _sized_range_bounds(self, temp_var: str, start: str, end: str, step: int) -> list[str]:
+        """Lines evaluating range() bounds once into {temp_var}_start/_stop and the trip count into _count."""
+        start_var = f"{temp_var}_start"
+        stop_var = f"{temp_var}_stop"
+        return [
+            f"    int {start_var} = {start};",
+            f"    int {stop_var} = {end};",
+            f"    size_t {temp_var}_count = {self._range_trip_count(start_var, stop_var, step)};",
+        ]
+
+    def _is_injective_in(self, expr: ast.expr, var: str) -> bool:
+        """Check if distinct values of var give distinct values of expr (var, var +/- c, c - var, var * c with c != 0)."""
+        if isinstance(expr, ast.Name):
+            return expr.id == var
+        if isinstance(expr, ast.BinOp) and isinstance(expr.op, (ast.Add, ast.Sub, ast.Mult)):
+            for operand, other in ((expr.left, expr.right), (expr.right, expr.left)):
+                if isinstance(other, ast.Constant) and type(other.value) is int and self._is_injective_in(operand, var):
+                    return not isinstance(expr.op, ast.Mult) or other.value != 0
+        return False
+
+    def _reserved_range_loop(
+        self, generator: ast.comprehension, key: ast.expr, temp_var: str, container_type: str, loop_code: str
+    ) -> Optional[tuple[str, str]]:
+        """Preamble and loop header for a hash comprehension whose final size is the range() trip count.
+
+        Applies when the comprehension is unfiltered and every iteration produces a
+        distinct key, so the container can be reserved once instead of growing:
+
+        size_t t_count = trip count;
+        container_reserve(&t, t_count);
+        for (int i = start; i < stop; i += step)
+
+        range() bounds other than names and constants are first evaluated once into
+        t_start/t_stop, and the loop runs over those. Returns None when the size is
+        not known up front.
+        """
+        if generator.ifs or not isinstance(generator.target, ast.Name):
+            return None
+        iterable = generator.iter
+        if not (isinstance(iterable, ast.Call) and isinstance(iterable.func, ast.Name) and iterable.func.id == "range"):
+            return None
+        step = self._comprehension_range_step(iterable.args)
+        if step is None or not self._is_injective_in(key, generator.target.id):
+            return None
+
+        if len(iterable.args) == 1:
+            start, end = "0", self._convert_expression(iterable.args[0])
+        else:
+            start, end = self._convert_expression(iterable.args[0]), self._convert_expression(iterable.args[1])
+
+        reserve = f"    {container_type}_reserve(&{temp_var}, {temp_var}_count);"
+        if all(isinstance(arg, (ast.Name, ast.Constant)) for arg in iterable.args):
+            count = f"    size_t {temp_var}_count = {self._range_trip_count(start, end, step)};"
+            return f"{count}\n{reserve}", loop_code
+
+        loop_var = generator.target.id
+        preamble = "\n".join([*self._sized_range_bounds(temp_var, start, end, step), reserve])
+        return preamble, f"for (int {loop_var} = {temp_var}_start; {loop_var} < {temp_var}_stop; {loop_var} += {step})"
+
+    def _convert_sized_range_comprehension(
+        self,
+        node: ast.ListComp,
+        temp_var: str,
+        container_type: str,
+        loop_var: str,
+        start: str,
+        end: str,
+        step: int,
+    ) -> str:
+        """Convert [expr for i in range(...)] with a known trip count.
+
+        range() arguments are evaluated once, as in Python. Filtered comprehensions
+        reserve the full trip count and push; unfiltered ones over generated vectors
+        size the result once and store into it directly:
+
+        vec_int result = {0};
+        size_t n = trip count;
+        int* out = vec_int_resize_uninitialized(&result, n);
+        for (size_t k = 0; k < n; k++) { int i = start + k * step; out[k] = expr; }
+        """
+        generator = node.generators[0]
+        if len(generator.ifs) > 1:
+            raise UnsupportedFeatureError("Multiple conditions in comprehensions not yet supported")
+
+        start_var = f"{temp_var}_start"
+        stop_var = f"{temp_var}_stop"
+        count_var = f"{temp_var}_count"
+        expr_str = self._convert_expression(node.elt)
+
+        lines = ["({", f"    {container_type} {temp_var} = {{0}};", *self._sized_range_bounds(temp_var, start, end, step)]
+
+        parallel = None
+        if not generator.ifs and self.parallel_pool:
+            parallel = self._pool_parallel_comprehension(node, temp_var, container_type, loop_var, step, expr_str)
+        if parallel is not None:
+            lines.extend(parallel)
+        elif not generator.ifs and self._has_bulk_vec_api(container_type):
+            element_type = container_type[4:]
+            index_var = f"{temp_var}_k"
+            out_var = f"{temp_var}_out"
+            loop_value = f"{start_var} + (int){index_var}" if step == 1 else f"{start_var} + (int){index_var} * {step}"
+            lines.extend(
+                [
+                    f"    {element_type}* {out_var} = {container_type}_resize_uninitialized(&{temp_var}, {count_var});",
+                    f"    for (size_t {index_var} = 0; {out_var} && {index_var} < {count_var}; {index_var}++) {{",
+                    f"        int {loop_var} = {loop_value};",
+                    f"        {out_var}[{index_var}] = {expr_str};",
+                    "    }",
+                ]
+            )
+        else:
+            condition_code = f"if ({self._convert_expression(generator.ifs[0])}) " if generator.ifs else ""
+            lines.extend(
+                [
+                    f"    {container_type}_reserve(&{temp_var}, {count_var});",
+                    f"    for (int {loop_var} = {start_var}; {loop_var} < {stop_var}; {loop_var} += {step}) {{",
+                    f"        {condition_code}{container_type}_push(&{temp_var}, {expr_str});",
+                    "    }",
+                ]
+            )
+
+        lines.extend([f"    {temp_var};", "})"])
+        return "\n".join(lines)
+
     def _convert_dict_comprehension(self, node: ast.DictComp) -> str:
         """Convert dictionary comprehension to C loop with STC hashmap operations.
 
@@ -2876,11 +5670,12 @@ class MGenPythonToCConverter:
                 dict_name = generator.iter.func.value.id
                 dict_type = self.variable_context.get(dict_name, "map_int_int")
 
-                # Generate code to iterate over STC map
+                # Iterate with the map's cursor
                 iter_var = self._generate_temp_var_name("iter")
+                prefix, begin_arg = self._hash_cursor(dict_name, dict_type)
                 loop_code = f"""
-    {dict_type}_iter {iter_var} = {dict_type}_begin(&{dict_name});
-    for (; {iter_var}.ref; {dict_type}_next(&{iter_var}))"""
+    {prefix}_iter {iter_var} = {prefix}_begin({begin_arg});
+    for (; {iter_var}.ref; {prefix}_next(&{iter_var}))"""
 
                 # In the loop body, extract key and value
                 # For STC maps: iter.ref->first is key, iter.ref->second is value
@@ -2949,17 +5744,21 @@ class MGenPythonToCConverter:
         if use_fallback:
             # Fallback type uses pointer and different API
             comp_code = f"""({{
-    {result_container_type} {temp_var} = mgen_str_int_map_new();
+    {result_container_type} {temp_var} = {self._new_str_int_map()};
     {loop_code} {{
         {loop_body_prefix}{condition_code}mgen_str_int_map_insert({temp_var}, {key_str}, {value_str});
     }}
     {temp_var};
 }})"""
         else:
-            # STC type uses struct and STC API
+            # STC type uses struct and STC API; reserve up front when the size is known
+            preamble = ""
+            reserved = self._reserved_range_loop(generator, node.key, temp_var, result_container_type, loop_code)
+            if reserved:
+                preamble, loop_code = reserved[0] + "\n", reserved[1]
             comp_code = f"""({{
     {result_container_type} {temp_var} = {{0}};
-    {loop_code} {{
+{preamble}    {loop_code} {{
         {loop_body_prefix}{condition_code}{result_container_type}_insert(&{temp_var}, {key_str}, {value_str});
     }}
     {temp_var};
@@ -3072,9 +5871,15 @@ class MGenPythonToCConverter:
         if loop_var_decl:
             loop_body_prefix = f"{loop_var_decl};\n        "
 
+        # Reserve up front when every range() iteration adds a distinct element
+        preamble = ""
+        reserved = self._reserved_range_loop(generator, node.elt, temp_var, result_container_type, loop_code)
+        if reserved:
+            preamble, loop_code = reserved[0] + "\n", reserved[1]
+
         comp_code = f"""({{
     {result_container_type} {temp_var} = {{0}};
-    {loop_code} {{
+{preamble}    {loop_code} {{
         {loop_body_prefix}{condition_code}{result_container_type}_insert(&{temp_var}, {expr_str});
     }}
     {temp_var};
@@ -3132,3 +5937,29 @@ class MGenPythonToCConverter:
         import time
 
         return f"{prefix}_{int(time.time() * 1000000) % 1000000}"
+
+
+class _CoroutineFrameRenamer(ast.NodeTransformer):
+    """Rewrite a generator body to use its frame: names become frame fields and declarations assignments."""
+
+    def __init__(self, fields: dict[str, str]) -> None:
+        self.fields = fields
+
+    def visit_Name(self, node: ast.Name) -> ast.Name:
+        if node.id in self.fields:
+            return ast.copy_location(ast.Name(id=self.fields[node.id], ctx=node.ctx), node)
+        return node
+
+    def visit_Call(self, node: ast.Call) -> ast.Call:
+        # The callee is a function name, never a local
+        node.args = [self.visit(arg) for arg in node.args]
+        node.keywords = [self.visit(keyword) for keyword in node.keywords]
+        if not isinstance(node.func, ast.Name):
+            node.func = self.visit(node.func)
+        return node
+
+    def visit_AnnAssign(self, node: ast.AnnAssign) -> Optional[ast.stmt]:
+        if node.value is None:
+            return None
+        assign = ast.Assign(targets=[self.visit(node.target)], value=self.visit(node.value))
+        return ast.copy_location(assign, node)
@@ -63,7 +63,7 @@ class CEmitter(AbstractEmitter):
         """Generate complete C module using sophisticated py2c conversion."""
         try:
             # Try sophisticated py2c conversion first
-            return self.py2c_converter.convert_code(source_code)
+            return self.py2c_converter.convert_code(source_code, self.source_file)
         except UnsupportedFeatureError as e:
             # Log detailed error and fail gracefully
             error_msg = f"C backend does not support: {e}"
@@ -2,10 +2,15 @@
 
 Analyzes Python code for patterns that could lead to memory safety issues
 when translated to C/C++ (manual memory management, raw pointers).
+
+ContainerLifetimePlanner turns the same static view into a plan the C
+backend follows: where each function-local container is dropped, and which
+dead container's buffer a later container of the same kind takes over.
 """
 
 import ast
-from dataclasses import dataclass
+from collections.abc import Iterable
+from dataclasses import dataclass, field
 from enum import Enum
 from typing import Optional
 
@@ -206,3 +211,215 @@ class MemorySafetyChecker:
             return True
 
         return False
+
+
+@dataclass
+class ContainerLifetimes:
+    """Where a function's local containers end, keyed by id() of statements.
+
+    Attributes:
+        drops_after: Locals to drop after a statement, their last use in the declaring block
+        return_drops: Locals still live at a return, dropped once its value is computed
+        recycles: Declaration -> dead local of the same block whose buffer it takes over
+    """
+
+    drops_after: dict[int, list[str]] = field(default_factory=dict)
+    return_drops: dict[int, list[str]] = field(default_factory=dict)
+    recycles: dict[int, str] = field(default_factory=dict)
+
+
+class ContainerLifetimePlanner:
+    """Static lifetimes of function-local containers.
+
+    A local is managed when it is bound exactly once, to a new list, set or
+    dict (a literal, an empty constructor or a comprehension), and every use
+    only reads or updates it in place: indexing, iteration, membership tests,
+    len()/sum()/min()/max()/any()/all(), its own non-escaping methods, or an
+    argument bound to a borrowable parameter (ImmutabilityAnalyzer) of a
+    module function. A returned, aliased, stored or otherwise passed local
+    stays unmanaged, as do locals used outside the block that declares them.
+
+    A managed local is dropped after the statement of its block that last
+    mentions it, and at every return it is live for. A later empty or literal
+    container of the same kind declared in that block takes its buffer over
+    instead, so the drop and a fresh allocation become a clear().
+    Whether its element types allow either is left to the backend.
+    """
+
+    # Methods that read or update a container without letting it escape
+    IN_PLACE_METHODS = frozenset(
+        {"append", "pop", "insert", "remove", "clear", "add", "discard", "get", "count", "index", "extend", "update",
+         "sort", "reverse"}
+    )
+    # Map views, allowed as the iterable of a for loop
+    VIEW_METHODS = frozenset({"keys", "values", "items"})
+    READING_BUILTINS = frozenset({"len", "sum", "min", "max", "any", "all"})
+    # Methods that copy the elements of their container argument
+    COPYING_METHODS = frozenset({"extend", "update"})
+
+    def __init__(self, borrowable: Optional[dict[str, set[int]]] = None):
+        """Initialize the planner.
+
+        Args:
+            borrowable: Module function -> positions of parameters that neither
+                store nor keep their argument
+        """
+        self.borrowable = borrowable or {}
+
+    def plan(self, func: ast.FunctionDef) -> ContainerLifetimes:
+        """Plan the drops and buffer reuse of the managed locals of func."""
+        self._parents: dict[int, ast.AST] = {}
+        for node in ast.walk(func):
+            for child in ast.iter_child_nodes(node):
+                self._parents[id(child)] = node
+        self._store_counts: dict[str, int] = {}
+        self._mention_counts: dict[str, int] = {}
+        self._excluded = {arg.arg for arg in func.args.args}
+        self._escaping: set[str] = set()
+        for node in ast.walk(func):
+            if isinstance(node, ast.Name):
+                self._mention_counts[node.id] = self._mention_counts.get(node.id, 0) + 1
+                if isinstance(node.ctx, ast.Store):
+                    self._store_counts[node.id] = self._store_counts.get(node.id, 0) + 1
+                elif isinstance(node.ctx, ast.Load) and not self._used_in_place(node):
+                    self._escaping.add(node.id)
+            elif isinstance(node, (ast.Global, ast.Nonlocal)):
+                self._excluded.update(node.names)
+
+        lifetimes = ContainerLifetimes()
+        self._plan_block(func.body, [], lifetimes)
+        return lifetimes
+
+    def _plan_block(self, stmts: list[ast.stmt], live_outer: list[str], lifetimes: ContainerLifetimes) -> None:
+        """Plan one block, given the managed locals of enclosing blocks live while it runs."""
+        # name -> (declaring index, index after which it is dead)
+        spans: dict[str, tuple[int, int]] = {}
+        for index, stmt in enumerate(stmts):
+            name = self._managed_declaration(stmt)
+            if name is None:
+                continue
+            # Every mention must follow the declaration in this block
+            if self._mention_count(stmts[index:], name) != self._mention_counts[name]:
+                continue
+            last = max(i for i, other in enumerate(stmts) if i >= index and self._mention_count([other], name))
+            spans[name] = (index, last)
+
+        # Dead locals hand their buffers to later declarations of the same kind
+        ends = dict(spans)
+        for name, (index, _last) in sorted(spans.items(), key=lambda item: item[1][0]):
+            if not self._is_recyclable(stmts[index]):
+                continue
+            donors = [
+                other
+                for other, (other_index, other_last) in spans.items()
+                if other_last < index
+                and ends[other] == (other_index, other_last)
+                and other not in lifetimes.recycles.values()
+                and self._same_kind(stmts[other_index], stmts[index])
+                and not isinstance(stmts[other_last], ast.Return)
+            ]
+            if donors:
+                donor = max(donors, key=lambda other: spans[other][1])
+                lifetimes.recycles[id(stmts[index])] = donor
+                ends[donor] = (spans[donor][0], index)
+
+        for name, (index, last) in spans.items():
+            if name in lifetimes.recycles.values():
+                continue
+            if not isinstance(stmts[last], ast.Return):
+                lifetimes.drops_after.setdefault(id(stmts[last]), []).append(name)
+
+        for position, stmt in enumerate(stmts):
+            # Live during stmt: declared before it, and not dead or handed over before it
+            live = live_outer + [
+                name for name, (index, end) in ends.items() if index < position and position <= end
+                and not (name in lifetimes.recycles.values() and position == end)
+            ]
+            self._plan_returns(stmt, live, lifetimes)
+
+    def _plan_returns(self, stmt: ast.stmt, live: list[str], lifetimes: ContainerLifetimes) -> None:
+        """Record the live locals at each return in stmt, descending into nested blocks."""
+        if isinstance(stmt, ast.Return):
+            if live:
+                lifetimes.return_drops[id(stmt)] = list(live)
+            return
+        for body in self._blocks(stmt):
+            self._plan_block(body, live, lifetimes)
+
+    @staticmethod
+    def _blocks(stmt: ast.stmt) -> Iterable[list[ast.stmt]]:
+        """Statement lists nested directly in stmt."""
+        if isinstance(stmt, (ast.If, ast.For, ast.While)):
+            yield stmt.body
+            if stmt.orelse:
+                yield stmt.orelse
+        elif isinstance(stmt, ast.With):
+            yield stmt.body
+
+    def _managed_declaration(self, stmt: ast.stmt) -> Optional[str]:
+        """The local a statement binds to a new container, if it qualifies to be managed."""
+        if isinstance(stmt, ast.Assign) and len(stmt.targets) == 1:
+            target, value = stmt.targets[0], stmt.value
+        elif isinstance(stmt, ast.AnnAssign) and stmt.value is not None:
+            target, value = stmt.target, stmt.value
+        else:
+            return None
+        if not isinstance(target, ast.Name) or self._container_kind(value) is None:
+            return None
+        name = target.id
+        if name in self._excluded or name in self._escaping or self._store_counts.get(name) != 1:
+            return None
+        return name
+
+    @staticmethod
+    def _container_kind(value: ast.expr) -> Optional[str]:
+        """"list", "set" or "dict" for an expression creating a new container, else None."""
+        if isinstance(value, (ast.List, ast.ListComp)):
+            return "list"
+        if isinstance(value, (ast.Set, ast.SetComp)):
+            return "set"
+        if isinstance(value, (ast.Dict, ast.DictComp)):
+            return "dict"
+        if isinstance(value, ast.Call) and isinstance(value.func, ast.Name) and not value.args and not value.keywords:
+            return value.func.id if value.func.id in ("list", "set", "dict") else None
+        return None
+
+    def _is_recyclable(self, stmt: ast.stmt) -> bool:
+        """Whether a declaration starts from an empty container it fills itself (literals, constructors)."""
+        value = stmt.value  # type: ignore[attr-defined]
+        return not isinstance(value, (ast.ListComp, ast.SetComp, ast.DictComp))
+
+    def _same_kind(self, first: ast.stmt, second: ast.stmt) -> bool:
+        """Whether two declarations create the same kind of container."""
+        return self._container_kind(first.value) == self._container_kind(second.value)  # type: ignore[attr-defined]
+
+    def _used_in_place(self, name: ast.Name) -> bool:
+        """Whether a load of a name cannot let the container escape."""
+        parent = self._parents.get(id(name))
+        if isinstance(parent, ast.Subscript):
+            return parent.value is name and not isinstance(parent.slice, ast.Slice)
+        if isinstance(parent, ast.Attribute):
+            call = self._parents.get(id(parent))
+            if not (isinstance(call, ast.Call) and call.func is parent):
+                return False
+            if parent.attr in self.VIEW_METHODS:
+                loop = self._parents.get(id(call))
+                return isinstance(loop, ast.For) and loop.iter is call
+            return parent.attr in self.IN_PLACE_METHODS
+        if isinstance(parent, (ast.For, ast.comprehension)):
+            return parent.iter is name
+        if isinstance(parent, ast.Compare):
+            return True
+        if isinstance(parent, ast.Call) and name in parent.args:
+            func = parent.func
+            if isinstance(func, ast.Attribute):
+                return func.attr in self.COPYING_METHODS
+            if isinstance(func, ast.Name):
+                if func.id in self.READING_BUILTINS:
+                    return True
+                return parent.args.index(name) in self.borrowable.get(func.id, set())
+        return False
+
+    @staticmethod
+    def _mention_count(stmts: list[ast.stmt], name: str) -> int:
+        return sum(1 for stmt in stmts for node in ast.walk(stmt) if isinstance(node, ast.Name) and node.id == name)
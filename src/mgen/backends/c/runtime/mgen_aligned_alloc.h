@@ -0,0 +1,96 @@
+/**
+ * Cache-line-aligned buffers for numeric vectors
+ * Single-header implementation for code generation
+ * stb-library style: static inline functions for single-file output
+ *
+ * With the "aligned_vectors" preference the converter declares vec_int,
+ * vec_float and vec_double with "#define i_allocator mgen_aligned", so STC
+ * allocates their buffers through these functions at MGEN_VEC_ALIGNMENT
+ * bytes. Loops the vectorization detector proves independent then read and
+ * write the vectors the function allocated itself through restrict pointers
+ * marked with MGEN_ASSUME_ALIGNED, and compile to aligned vector loads and
+ * stores with no peeling prologue.
+ *
+ * The buffers can be released with free(), as plain STC vectors and the
+ * snapshot loader do. Where aligned_alloc is not available (MSVC, or C
+ * before C11) they are plain malloc buffers and MGEN_ASSUME_ALIGNED
+ * promises nothing.
+ */
+
+#ifndef MGEN_ALIGNED_ALLOC_H
+#define MGEN_ALIGNED_ALLOC_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// One cache line, and the widest vector register (AVX-512)
+#define MGEN_VEC_ALIGNMENT 64
+
+#if !defined(_WIN32) && ((defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L) || defined(__cplusplus))
+#define MGEN_HAVE_ALIGNED_ALLOC 1
+#endif
+
+#if defined(MGEN_HAVE_ALIGNED_ALLOC) && (defined(__GNUC__) || defined(__clang__))
+#define MGEN_ASSUME_ALIGNED(ptr) __builtin_assume_aligned((ptr), MGEN_VEC_ALIGNMENT)
+#else
+#define MGEN_ASSUME_ALIGNED(ptr) (ptr)
+#endif
+
+#if defined(__cplusplus) || !defined(__STDC_VERSION__) || __STDC_VERSION__ < 199901L
+#define MGEN_RESTRICT __restrict
+#else
+#define MGEN_RESTRICT restrict
+#endif
+
+/**
+ * STC allocator interface (i_allocator mgen_aligned): sizes are in bytes
+ */
+static inline void* mgen_aligned_malloc(ptrdiff_t size) {
+#ifdef MGEN_HAVE_ALIGNED_ALLOC
+    // aligned_alloc takes a multiple of the alignment
+    size_t rounded = ((size_t)(size > 0 ? size : 1) + MGEN_VEC_ALIGNMENT - 1) & ~(size_t)(MGEN_VEC_ALIGNMENT - 1);
+    return aligned_alloc(MGEN_VEC_ALIGNMENT, rounded);
+#else
+    return malloc((size_t)(size > 0 ? size : 1));
+#endif
+}
+
+static inline void* mgen_aligned_calloc(ptrdiff_t count, ptrdiff_t size) {
+    size_t bytes = (size_t)count * (size_t)size;
+    void* data = mgen_aligned_malloc((ptrdiff_t)bytes);
+    if (data) {
+        memset(data, 0, bytes);
+    }
+    return data;
+}
+
+// realloc() would drop the alignment: move the live bytes into a new aligned block
+static inline void* mgen_aligned_realloc(void* data, ptrdiff_t old_size, ptrdiff_t size) {
+#ifdef MGEN_HAVE_ALIGNED_ALLOC
+    void* moved = mgen_aligned_malloc(size);
+    if (moved && data) {
+        memcpy(moved, data, (size_t)(old_size < size ? old_size : size));
+        free(data);
+    }
+    return moved;
+#else
+    (void)old_size;
+    return realloc(data, (size_t)(size > 0 ? size : 1));
+#endif
+}
+
+static inline void mgen_aligned_free(void* data, ptrdiff_t size) {
+    (void)size;
+    free(data);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_ALIGNED_ALLOC_H
@@ -0,0 +1,281 @@
+/**
+ * MGen Runtime Library - Sampling Allocation Profiler Implementation
+ */
+
+#include "mgen_alloc_profile.h"
+#include "mgen_error_handling.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Counters are shared between threads; fall back to plain accesses (approximate
+// under contention) on compilers without the __atomic builtins
+#if defined(__GNUC__) || defined(__clang__)
+#define MGEN_PROFILE_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define MGEN_PROFILE_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define MGEN_PROFILE_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_RELAXED)
+#define MGEN_PROFILE_CAS(ptr, expected, desired) \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+#define MGEN_PROFILE_LOAD(ptr) (*(ptr))
+#define MGEN_PROFILE_STORE(ptr, value) (*(ptr) = (value))
+#define MGEN_PROFILE_ADD(ptr, value) (*(ptr) += (value))
+#define MGEN_PROFILE_CAS(ptr, expected, desired) \
+    (*(ptr) == *(expected) ? (*(ptr) = (desired), true) : (*(expected) = *(ptr), false))
+#endif
+
+// Slot states: claimed slots are published once file/line are written
+#define MGEN_PROFILE_SLOT_EMPTY 0
+#define MGEN_PROFILE_SLOT_CLAIMING 1
+#define MGEN_PROFILE_SLOT_READY 2
+
+typedef struct {
+    int state;
+    const char* file;
+    int line;
+    size_t count;
+    size_t bytes;
+    size_t histogram[MGEN_ALLOC_PROFILE_BUCKETS];
+} mgen_profile_slot_t;
+
+// Open-addressed site table keyed by (__FILE__ pointer, __LINE__)
+static mgen_profile_slot_t profile_sites[MGEN_ALLOC_PROFILE_MAX_SITES];
+static mgen_profile_slot_t profile_overflow = {MGEN_PROFILE_SLOT_READY, "(other)", 0, 0, 0, {0}};
+
+static size_t profile_interval = 0;   // 0 = disabled
+static int profile_env_checked = 0;
+static char profile_output_path[512];
+
+// Allocations left to skip before the next sample on this thread
+static MGEN_THREAD_LOCAL size_t profile_countdown = 0;
+
+static const char* const profile_bucket_labels[MGEN_ALLOC_PROFILE_BUCKETS] = {
+    "<=16", "<=32", "<=64", "<=128", "<=256", "<=512", "<=1K", "<=2K", "<=4K", "<=8K", "<=16K", ">16K"};
+
+static size_t mgen_profile_bucket(size_t size) {
+    size_t bucket = 0;
+    size_t limit = 16;
+    while (size > limit && bucket < MGEN_ALLOC_PROFILE_BUCKETS - 1) {
+        limit <<= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static mgen_profile_slot_t* mgen_profile_find_slot(const char* file, int line) {
+    size_t mask = MGEN_ALLOC_PROFILE_MAX_SITES - 1;
+    size_t hash = ((size_t)(uintptr_t)file >> 3) ^ ((size_t)line * 2654435761u);
+    size_t idx = (hash * 2654435761u) & mask;
+
+    for (size_t probes = 0; probes < MGEN_ALLOC_PROFILE_MAX_SITES; probes++) {
+        mgen_profile_slot_t* slot = &profile_sites[idx];
+        int state = MGEN_PROFILE_LOAD(&slot->state);
+        if (state == MGEN_PROFILE_SLOT_EMPTY) {
+            int expected = MGEN_PROFILE_SLOT_EMPTY;
+            if (MGEN_PROFILE_CAS(&slot->state, &expected, MGEN_PROFILE_SLOT_CLAIMING)) {
+                slot->file = file;
+                slot->line = line;
+                MGEN_PROFILE_STORE(&slot->state, MGEN_PROFILE_SLOT_READY);
+                return slot;
+            }
+            state = expected;
+        }
+        // Another thread is publishing this slot: wait for its key
+        while (state == MGEN_PROFILE_SLOT_CLAIMING) {
+            state = MGEN_PROFILE_LOAD(&slot->state);
+        }
+        if (slot->file == file && slot->line == line) {
+            return slot;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return &profile_overflow;
+}
+
+static void mgen_profile_dump_at_exit(void) {
+    if (strcmp(profile_output_path, "-") == 0) {
+        mgen_alloc_profile_dump(stderr);
+        return;
+    }
+
+    FILE* out = fopen(profile_output_path, "w");
+    if (!out) {
+        fprintf(stderr, "mgen: cannot write allocation profile to %s\n", profile_output_path);
+        return;
+    }
+    mgen_alloc_profile_dump(out);
+    fclose(out);
+}
+
+// Start recording if MGEN_ALLOC_PROFILE names an output; runs once per process
+static void mgen_profile_init_from_env(void) {
+    int expected = 0;
+    if (!MGEN_PROFILE_CAS(&profile_env_checked, &expected, 1)) {
+        return;
+    }
+
+    const char* path = getenv("MGEN_ALLOC_PROFILE");
+    if (!path || !*path || strlen(path) >= sizeof(profile_output_path)) {
+        return;
+    }
+    memcpy(profile_output_path, path, strlen(path) + 1);
+
+    const char* interval_str = getenv("MGEN_ALLOC_PROFILE_INTERVAL");
+    size_t interval = interval_str ? (size_t)strtoul(interval_str, NULL, 10) : 1;
+    atexit(mgen_profile_dump_at_exit);
+    MGEN_PROFILE_STORE(&profile_interval, interval ? interval : 1);
+}
+
+void mgen_alloc_profile_enable(size_t sample_interval) {
+    MGEN_PROFILE_STORE(&profile_env_checked, 1);
+    MGEN_PROFILE_STORE(&profile_interval, sample_interval ? sample_interval : 1);
+}
+
+void mgen_alloc_profile_disable(void) {
+    MGEN_PROFILE_STORE(&profile_env_checked, 1);
+    MGEN_PROFILE_STORE(&profile_interval, 0);
+}
+
+void mgen_alloc_profile_reset(void) {
+    // Not synchronized with concurrent recording: call while other threads are quiet
+    memset(profile_sites, 0, sizeof(profile_sites));
+    profile_overflow.count = 0;
+    profile_overflow.bytes = 0;
+    memset(profile_overflow.histogram, 0, sizeof(profile_overflow.histogram));
+}
+
+void mgen_alloc_profile_record(const char* file, int line, size_t size) {
+    size_t interval = MGEN_PROFILE_LOAD(&profile_interval);
+    if (interval == 0) {
+        if (MGEN_PROFILE_LOAD(&profile_env_checked)) {
+            return;
+        }
+        mgen_profile_init_from_env();
+        interval = MGEN_PROFILE_LOAD(&profile_interval);
+        if (interval == 0) {
+            return;
+        }
+    }
+
+    // Each sample stands for interval allocations on this thread
+    if (interval > 1) {
+        if (profile_countdown > 1) {
+            profile_countdown--;
+            return;
+        }
+        profile_countdown = interval;
+    }
+
+    mgen_profile_slot_t* slot = mgen_profile_find_slot(file, line);
+    MGEN_PROFILE_ADD(&slot->count, interval);
+    MGEN_PROFILE_ADD(&slot->bytes, size * interval);
+    MGEN_PROFILE_ADD(&slot->histogram[mgen_profile_bucket(size)], interval);
+}
+
+static const char* mgen_profile_basename(const char* path) {
+    const char* base = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+    return base;
+}
+
+static int mgen_profile_site_compare(const void* a, const void* b) {
+    const mgen_alloc_site_t* lhs = a;
+    const mgen_alloc_site_t* rhs = b;
+    int cmp = strcmp(mgen_profile_basename(lhs->file), mgen_profile_basename(rhs->file));
+    if (cmp != 0) {
+        return cmp;
+    }
+    if (lhs->line != rhs->line) {
+        return lhs->line < rhs->line ? -1 : 1;
+    }
+    return strcmp(lhs->file, rhs->file);
+}
+
+static void mgen_profile_copy_slot(mgen_alloc_site_t* site, const mgen_profile_slot_t* slot) {
+    site->file = slot->file;
+    site->line = slot->line;
+    site->count = MGEN_PROFILE_LOAD(&slot->count);
+    site->bytes = MGEN_PROFILE_LOAD(&slot->bytes);
+    for (size_t i = 0; i < MGEN_ALLOC_PROFILE_BUCKETS; i++) {
+        site->histogram[i] = MGEN_PROFILE_LOAD(&slot->histogram[i]);
+    }
+}
+
+size_t mgen_alloc_profile_snapshot(mgen_alloc_site_t* sites, size_t max_sites) {
+    mgen_alloc_site_t* all = malloc((MGEN_ALLOC_PROFILE_MAX_SITES + 1) * sizeof(mgen_alloc_site_t));
+    if (!all) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate allocation profile snapshot");
+        return 0;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < MGEN_ALLOC_PROFILE_MAX_SITES; i++) {
+        if (MGEN_PROFILE_LOAD(&profile_sites[i].state) == MGEN_PROFILE_SLOT_READY) {
+            mgen_profile_copy_slot(&all[count++], &profile_sites[i]);
+        }
+    }
+    if (MGEN_PROFILE_LOAD(&profile_overflow.count) > 0) {
+        mgen_profile_copy_slot(&all[count++], &profile_overflow);
+    }
+
+    qsort(all, count, sizeof(mgen_alloc_site_t), mgen_profile_site_compare);
+
+    // The same header line inlined into several translation units has one
+    // __FILE__ string per unit: fold those into a single site
+    size_t merged = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (merged > 0 && all[merged - 1].line == all[i].line && strcmp(all[merged - 1].file, all[i].file) == 0) {
+            all[merged - 1].count += all[i].count;
+            all[merged - 1].bytes += all[i].bytes;
+            for (size_t b = 0; b < MGEN_ALLOC_PROFILE_BUCKETS; b++) {
+                all[merged - 1].histogram[b] += all[i].histogram[b];
+            }
+            continue;
+        }
+        all[merged++] = all[i];
+    }
+
+    if (sites) {
+        memcpy(sites, all, (merged < max_sites ? merged : max_sites) * sizeof(mgen_alloc_site_t));
+    }
+    free(all);
+    return merged;
+}
+
+void mgen_alloc_profile_dump(FILE* out) {
+    if (!out) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL output for allocation profile");
+        return;
+    }
+
+    mgen_alloc_site_t* sites = malloc((MGEN_ALLOC_PROFILE_MAX_SITES + 1) * sizeof(mgen_alloc_site_t));
+    if (!sites) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate allocation profile dump");
+        return;
+    }
+    size_t count = mgen_alloc_profile_snapshot(sites, MGEN_ALLOC_PROFILE_MAX_SITES + 1);
+
+    size_t interval = MGEN_PROFILE_LOAD(&profile_interval);
+    fprintf(out, "# mgen allocation profile v1\n");
+    fprintf(out, "# sample_interval %zu\n", interval ? interval : 1);
+    fprintf(out, "# site\tallocs\tbytes\t");
+    for (size_t b = 0; b < MGEN_ALLOC_PROFILE_BUCKETS; b++) {
+        fprintf(out, b ? " %s" : "%s", profile_bucket_labels[b]);
+    }
+    fprintf(out, "\n");
+
+    for (size_t i = 0; i < count; i++) {
+        fprintf(out, "%s:%d\t%zu\t%zu\t", mgen_profile_basename(sites[i].file), sites[i].line, sites[i].count,
+                sites[i].bytes);
+        for (size_t b = 0; b < MGEN_ALLOC_PROFILE_BUCKETS; b++) {
+            fprintf(out, b ? " %zu" : "%zu", sites[i].histogram[b]);
+        }
+        fprintf(out, "\n");
+    }
+    free(sites);
+}
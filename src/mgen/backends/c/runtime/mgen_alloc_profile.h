@@ -0,0 +1,86 @@
+/**
+ * MGen Runtime Library - Sampling Allocation Profiler
+ *
+ * Per-call-site allocation histograms for generated code and the runtime
+ * containers. Allocation sites call MGEN_PROFILE_ALLOC(bytes), which records
+ * the __FILE__/__LINE__ of the call. The hook compiles to nothing unless the
+ * program is built with -DMGEN_ALLOC_PROFILE, so regular builds pay no cost.
+ *
+ * With the hook compiled in, recording starts with
+ * mgen_alloc_profile_enable(), or automatically when the MGEN_ALLOC_PROFILE
+ * environment variable names an output file ("-" for stderr). In that case
+ * the profile is written at exit, and MGEN_ALLOC_PROFILE_INTERVAL sets the
+ * sample interval. Counters are updated atomically, so threads can allocate
+ * concurrently.
+ */
+
+#ifndef MGEN_ALLOC_PROFILE_H
+#define MGEN_ALLOC_PROFILE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Distinct call sites tracked; further sites are folded into "(other)"
+#ifndef MGEN_ALLOC_PROFILE_MAX_SITES
+#define MGEN_ALLOC_PROFILE_MAX_SITES 1024
+#endif
+
+// Size histogram buckets: <=16, <=32, ..., <=16384, larger
+#define MGEN_ALLOC_PROFILE_BUCKETS 12
+
+// Snapshot of one call site; counts are estimates scaled by the sample interval
+typedef struct mgen_alloc_site {
+    const char* file;
+    int line;
+    size_t count;
+    size_t bytes;
+    size_t histogram[MGEN_ALLOC_PROFILE_BUCKETS];
+} mgen_alloc_site_t;
+
+/**
+ * Start recording every sample_interval-th allocation per thread (0 or 1 = all)
+ */
+void mgen_alloc_profile_enable(size_t sample_interval);
+
+/**
+ * Stop recording (collected sites are kept)
+ */
+void mgen_alloc_profile_disable(void);
+
+/**
+ * Discard all collected sites
+ */
+void mgen_alloc_profile_reset(void);
+
+/**
+ * Record an allocation of size bytes at file:line
+ */
+void mgen_alloc_profile_record(const char* file, int line, size_t size);
+
+/**
+ * Copy up to max_sites sites, sorted by file and line, into sites
+ * Returns the number of distinct sites (may exceed max_sites)
+ */
+size_t mgen_alloc_profile_snapshot(mgen_alloc_site_t* sites, size_t max_sites);
+
+/**
+ * Write the profile as text: one line per site, sorted by file and line
+ * Paths are reduced to their basename so profiles from different builds diff cleanly
+ */
+void mgen_alloc_profile_dump(FILE* out);
+
+#ifdef MGEN_ALLOC_PROFILE
+#define MGEN_PROFILE_ALLOC(size) mgen_alloc_profile_record(__FILE__, __LINE__, (size))
+#else
+#define MGEN_PROFILE_ALLOC(size) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_ALLOC_PROFILE_H
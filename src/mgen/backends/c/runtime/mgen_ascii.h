@@ -0,0 +1,387 @@
+/**
+ * ASCII fast paths for string primitives
+ * stb-library style: static functions for single-file output
+ *
+ * Case conversion, whitespace scanning and substring search look at 16 bytes
+ * at a time with SSE2 (x86-64) or NEON (AArch64) and at one byte at a time
+ * elsewhere. Only bytes below 0x80 are classified inline; any other byte goes
+ * through <ctype.h>, so non-ASCII input keeps the locale-aware behavior.
+ * Define MGEN_ASCII_NO_SIMD to force the portable code.
+ */
+
+#ifndef MGEN_ASCII_H
+#define MGEN_ASCII_H
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(MGEN_ASCII_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define MGEN_ASCII_SSE2 1
+#include <emmintrin.h>
+#elif !defined(MGEN_ASCII_NO_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+#define MGEN_ASCII_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MGEN_ASCII_BLOCK 16
+
+/**
+ * Character classification: inline for ASCII, <ctype.h> otherwise
+ */
+static inline bool mgen_ascii_isspace(unsigned char c) {
+    if (c < 0x80) {
+        // ' ' or one of \t \n \v \f \r
+        return c == ' ' || (unsigned char)(c - '\t') < 5;
+    }
+    return isspace(c) != 0;
+}
+
+static inline bool mgen_ascii_isdigit(unsigned char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+static inline bool mgen_ascii_isalpha(unsigned char c) {
+    if (c < 0x80) {
+        return (unsigned char)((c | 0x20) - 'a') < 26;
+    }
+    return isalpha(c) != 0;
+}
+
+static inline bool mgen_ascii_isalnum(unsigned char c) {
+    return mgen_ascii_isdigit(c) || mgen_ascii_isalpha(c);
+}
+
+static inline unsigned char mgen_ascii_lower(unsigned char c) {
+    if (c < 0x80) {
+        return (unsigned char)((unsigned char)(c - 'A') < 26 ? c | 0x20 : c);
+    }
+    return (unsigned char)tolower(c);
+}
+
+static inline unsigned char mgen_ascii_upper(unsigned char c) {
+    if (c < 0x80) {
+        return (unsigned char)((unsigned char)(c - 'a') < 26 ? c & ~0x20 : c);
+    }
+    return (unsigned char)toupper(c);
+}
+
+#if defined(MGEN_ASCII_SSE2)
+
+// Bit i set when byte i of the block is a space; bytes >= 0x80 are never set
+static inline unsigned int mgen_ascii_space_mask(const unsigned char* p) {
+    __m128i block = _mm_loadu_si128((const __m128i*)p);
+    __m128i space = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+    // \t..\r: signed compares are safe because bytes >= 0x80 are negative
+    __m128i control = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('\t' - 1)),
+                                    _mm_cmpgt_epi8(_mm_set1_epi8('\r' + 1), block));
+    return (unsigned int)_mm_movemask_epi8(_mm_or_si128(space, control));
+}
+
+// Bit i set when byte i of the block is >= 0x80
+static inline unsigned int mgen_ascii_high_mask(const unsigned char* p) {
+    return (unsigned int)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)p));
+}
+
+// Convert one ASCII-only block: flip bit 5 of the bytes in [first, first + 25]
+static inline void mgen_ascii_case_block(unsigned char* dst, const unsigned char* src, char first) {
+    __m128i block = _mm_loadu_si128((const __m128i*)src);
+    __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8((char)(first - 1))),
+                                     _mm_cmpgt_epi8(_mm_set1_epi8((char)(first + 26)), block));
+    _mm_storeu_si128((__m128i*)dst, _mm_xor_si128(block, _mm_and_si128(in_range, _mm_set1_epi8(0x20))));
+}
+
+// Bit i set when bytes i and i + offset match needle_first and needle_last
+static inline unsigned int mgen_ascii_candidates(const unsigned char* p, size_t offset, unsigned char needle_first,
+                                                 unsigned char needle_last) {
+    __m128i first = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), _mm_set1_epi8((char)needle_first));
+    __m128i last = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + offset)), _mm_set1_epi8((char)needle_last));
+    return (unsigned int)_mm_movemask_epi8(_mm_and_si128(first, last));
+}
+
+// Bit i set when byte i of the block is c
+static inline unsigned int mgen_ascii_byte_mask(const unsigned char* p, unsigned char c) {
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), _mm_set1_epi8((char)c)));
+}
+
+#elif defined(MGEN_ASCII_NEON)
+
+// NEON has no movemask: narrow each 0x00/0xFF byte to a nibble, then pick bits
+static inline unsigned int mgen_ascii_neon_mask(uint8x16_t lanes) {
+    static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t picked = vandq_u8(lanes, vld1q_u8(bits));
+    return (unsigned int)vaddv_u8(vget_low_u8(picked)) | ((unsigned int)vaddv_u8(vget_high_u8(picked)) << 8);
+}
+
+static inline unsigned int mgen_ascii_space_mask(const unsigned char* p) {
+    uint8x16_t block = vld1q_u8(p);
+    uint8x16_t space = vceqq_u8(block, vdupq_n_u8(' '));
+    uint8x16_t control = vcltq_u8(vsubq_u8(block, vdupq_n_u8('\t')), vdupq_n_u8(5));
+    return mgen_ascii_neon_mask(vorrq_u8(space, control));
+}
+
+static inline unsigned int mgen_ascii_high_mask(const unsigned char* p) {
+    return mgen_ascii_neon_mask(vcgeq_u8(vld1q_u8(p), vdupq_n_u8(0x80)));
+}
+
+static inline void mgen_ascii_case_block(unsigned char* dst, const unsigned char* src, char first) {
+    uint8x16_t block = vld1q_u8(src);
+    uint8x16_t in_range = vcltq_u8(vsubq_u8(block, vdupq_n_u8((uint8_t)first)), vdupq_n_u8(26));
+    vst1q_u8(dst, veorq_u8(block, vandq_u8(in_range, vdupq_n_u8(0x20))));
+}
+
+static inline unsigned int mgen_ascii_candidates(const unsigned char* p, size_t offset, unsigned char needle_first,
+                                                 unsigned char needle_last) {
+    uint8x16_t first = vceqq_u8(vld1q_u8(p), vdupq_n_u8(needle_first));
+    uint8x16_t last = vceqq_u8(vld1q_u8(p + offset), vdupq_n_u8(needle_last));
+    return mgen_ascii_neon_mask(vandq_u8(first, last));
+}
+
+static inline unsigned int mgen_ascii_byte_mask(const unsigned char* p, unsigned char c) {
+    return mgen_ascii_neon_mask(vceqq_u8(vld1q_u8(p), vdupq_n_u8(c)));
+}
+
+#endif
+
+#if defined(MGEN_ASCII_SSE2) || defined(MGEN_ASCII_NEON)
+#define MGEN_ASCII_SIMD 1
+
+static inline unsigned int mgen_ascii_ctz(unsigned int mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctz(mask);
+#else
+    unsigned int n = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static inline unsigned int mgen_ascii_ctz64(uint64_t mask) {
+    unsigned int low = (unsigned int)(mask & 0xFFFFFFFFu);
+    return low ? mgen_ascii_ctz(low) : 32 + mgen_ascii_ctz((unsigned int)(mask >> 32));
+}
+#endif
+
+#define MGEN_ASCII_ONES 0x0101010101010101ull
+
+/**
+ * Flip bit 5 of the bytes of an ASCII-only word that lie in [first, first + 25]
+ * Adding 0x80 - first sets a byte's high bit iff it is >= first; no byte
+ * carries into the next because every byte is below 0x80.
+ */
+static inline uint64_t mgen_ascii_case_word(uint64_t word, unsigned char first) {
+    uint64_t at_least_first = word + MGEN_ASCII_ONES * (uint64_t)(0x80 - first);
+    uint64_t past_last = word + MGEN_ASCII_ONES * (uint64_t)(0x80 - first - 26);
+    return word ^ (((at_least_first & ~past_last) & (MGEN_ASCII_ONES * 0x80)) >> 2);
+}
+
+// Shared body of mgen_ascii_lower_n() and mgen_ascii_upper_n()
+static inline void mgen_ascii_case_n(unsigned char* out, const unsigned char* in, size_t len, bool upper) {
+    size_t i = 0;
+#ifdef MGEN_ASCII_SIMD
+    enum { STEP = MGEN_ASCII_BLOCK };
+#else
+    enum { STEP = sizeof(uint64_t) };
+#endif
+    for (; i + STEP <= len; i += STEP) {
+#ifdef MGEN_ASCII_SIMD
+        if (!mgen_ascii_high_mask(in + i)) {
+            mgen_ascii_case_block(out + i, in + i, upper ? 'a' : 'A');
+            continue;
+        }
+#else
+        uint64_t word;
+        memcpy(&word, in + i, sizeof(word));
+        if (!(word & (MGEN_ASCII_ONES * 0x80))) {
+            word = mgen_ascii_case_word(word, upper ? 'a' : 'A');
+            memcpy(out + i, &word, sizeof(word));
+            continue;
+        }
+#endif
+        for (size_t j = i; j < i + STEP; j++) {
+            out[j] = upper ? mgen_ascii_upper(in[j]) : mgen_ascii_lower(in[j]);
+        }
+    }
+    for (; i < len; i++) {
+        out[i] = upper ? mgen_ascii_upper(in[i]) : mgen_ascii_lower(in[i]);
+    }
+}
+
+/**
+ * Copy len bytes of src to dst with Python str.lower()/str.upper() applied
+ * dst may equal src.
+ */
+static inline void mgen_ascii_lower_n(char* dst, const char* src, size_t len) {
+    mgen_ascii_case_n((unsigned char*)dst, (const unsigned char*)src, len, false);
+}
+
+static inline void mgen_ascii_upper_n(char* dst, const char* src, size_t len) {
+    mgen_ascii_case_n((unsigned char*)dst, (const unsigned char*)src, len, true);
+}
+
+/**
+ * First byte in [p, end) that is not whitespace, or end
+ */
+static inline const char* mgen_ascii_skip_space(const char* p, const char* end) {
+#ifdef MGEN_ASCII_SIMD
+    while (end - p >= MGEN_ASCII_BLOCK && !mgen_ascii_high_mask((const unsigned char*)p)) {
+        unsigned int other = ~mgen_ascii_space_mask((const unsigned char*)p) & 0xFFFFu;
+        if (other) {
+            return p + mgen_ascii_ctz(other);
+        }
+        p += MGEN_ASCII_BLOCK;
+    }
+#endif
+    while (p < end && mgen_ascii_isspace((unsigned char)*p)) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * First whitespace byte in [p, end), or end
+ */
+static inline const char* mgen_ascii_find_space(const char* p, const char* end) {
+#ifdef MGEN_ASCII_SIMD
+    while (end - p >= MGEN_ASCII_BLOCK && !mgen_ascii_high_mask((const unsigned char*)p)) {
+        unsigned int space = mgen_ascii_space_mask((const unsigned char*)p);
+        if (space) {
+            return p + mgen_ascii_ctz(space);
+        }
+        p += MGEN_ASCII_BLOCK;
+    }
+#endif
+    while (p < end && !mgen_ascii_isspace((unsigned char)*p)) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * End of [begin, end) with trailing whitespace removed
+ * Trailing runs are short in practice, so this stays scalar.
+ */
+static inline const char* mgen_ascii_trim_space(const char* begin, const char* end) {
+    while (end > begin && mgen_ascii_isspace((unsigned char)end[-1])) {
+        end--;
+    }
+    return end;
+}
+
+// Failed candidate checks tolerated before a search hands over to strstr(),
+// whose two-way algorithm is linear for needles like "aaab" in "aaaa...a"
+#define MGEN_ASCII_FIND_MISS_LIMIT 64
+
+/**
+ * First occurrence of needle (needle_len bytes) in hay (hay_len bytes), or NULL
+ * Both strings must be NUL-terminated at their lengths. Candidates are
+ * positions whose first and last bytes match the needle's, found a block at a
+ * time; only those are compared in full.
+ */
+static inline const char* mgen_ascii_find(const char* hay, size_t hay_len, const char* needle, size_t needle_len) {
+    if (needle_len == 0) {
+        return hay;
+    }
+    if (needle_len > hay_len) {
+        return NULL;
+    }
+    if (needle_len == 1) {
+        return (const char*)memchr(hay, needle[0], hay_len);
+    }
+
+    const unsigned char* h = (const unsigned char*)hay;
+    const unsigned char first = (unsigned char)needle[0];
+    const unsigned char last = (unsigned char)needle[needle_len - 1];
+    size_t last_start = hay_len - needle_len;  // Last position a match can start at
+    size_t misses = 0;
+    size_t i = 0;
+
+#ifdef MGEN_ASCII_SIMD
+    // Four blocks per step, so text without candidates costs one branch per 64 bytes
+    for (; i + 4 * MGEN_ASCII_BLOCK <= last_start + 1; i += 4 * MGEN_ASCII_BLOCK) {
+        uint64_t candidates = (uint64_t)mgen_ascii_candidates(h + i, needle_len - 1, first, last) |
+                              (uint64_t)mgen_ascii_candidates(h + i + 16, needle_len - 1, first, last) << 16 |
+                              (uint64_t)mgen_ascii_candidates(h + i + 32, needle_len - 1, first, last) << 32 |
+                              (uint64_t)mgen_ascii_candidates(h + i + 48, needle_len - 1, first, last) << 48;
+        while (candidates) {
+            size_t pos = i + mgen_ascii_ctz64(candidates);
+            if (memcmp(h + pos + 1, needle + 1, needle_len - 2) == 0) {
+                return hay + pos;
+            }
+            if (++misses > MGEN_ASCII_FIND_MISS_LIMIT + i / 8) {
+                return strstr(hay + pos, needle);
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    for (; i + MGEN_ASCII_BLOCK <= last_start + 1; i += MGEN_ASCII_BLOCK) {
+        unsigned int candidates = mgen_ascii_candidates(h + i, needle_len - 1, first, last);
+        while (candidates) {
+            size_t pos = i + mgen_ascii_ctz(candidates);
+            if (memcmp(h + pos + 1, needle + 1, needle_len - 2) == 0) {
+                return hay + pos;
+            }
+            if (++misses > MGEN_ASCII_FIND_MISS_LIMIT + i / 8) {
+                return strstr(hay + pos, needle);
+            }
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+
+    while (i <= last_start) {
+        const unsigned char* p = (const unsigned char*)memchr(h + i, first, last_start + 1 - i);
+        if (!p) {
+            return NULL;
+        }
+        size_t pos = (size_t)(p - h);
+        if (h[pos + needle_len - 1] == last && memcmp(p + 1, needle + 1, needle_len - 2) == 0) {
+            return hay + pos;
+        }
+        if (++misses > MGEN_ASCII_FIND_MISS_LIMIT + pos / 8) {
+            return strstr(hay + pos, needle);
+        }
+        i = pos + 1;
+    }
+    return NULL;
+}
+
+/**
+ * Python str.count(): non-overlapping occurrences of needle in hay
+ * Same requirements as mgen_ascii_find(). An empty needle occurs hay_len + 1 times.
+ */
+static inline size_t mgen_ascii_count(const char* hay, size_t hay_len, const char* needle, size_t needle_len) {
+    if (needle_len == 0) {
+        return hay_len + 1;
+    }
+
+    size_t count = 0;
+    const char* end = hay + hay_len;
+    if (needle_len == 1) {
+        for (const char* p = hay; (p = (const char*)memchr(p, needle[0], (size_t)(end - p))) != NULL; p++) {
+            count++;
+        }
+        return count;
+    }
+
+    for (const char* p = hay; (p = mgen_ascii_find(p, (size_t)(end - p), needle, needle_len)) != NULL;
+         p += needle_len) {
+        count++;
+    }
+    return count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_ASCII_H
@@ -0,0 +1,246 @@
+/**
+ * Dense bitset of small non-negative integers
+ * Single-header implementation for code generation
+ * stb-library style: static functions for single-file output
+ *
+ * The converter stores a set[int] local here instead of in set_int when range
+ * analysis bounds every value added to it to a small domain (see
+ * bounded_int_sets). Bit v of the word array records whether v is a member,
+ * so membership is one shift and mask and no value is ever hashed. The words
+ * grow on demand up to the largest value inserted; values outside them,
+ * negative ones included, are simply not members.
+ *
+ * Union, intersection and difference combine whole 64-bit words in plain
+ * loops that compilers vectorize, then recount the members with popcount.
+ */
+
+#ifndef MGEN_BITSET_INT_H
+#define MGEN_BITSET_INT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_error_handling.h"
+#include "mgen_memory_ops.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BITSET_INT_WORD_BITS 64
+
+// Zero-initialized ({0}) is the empty set
+typedef struct {
+    uint64_t* words;
+    size_t word_count;
+    size_t size;  // Members, so len() does not scan the words
+} bitset_int;
+
+static inline size_t bitset_int_popcount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (size_t)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Members among the first word_count words
+static inline size_t bitset_int_count(const uint64_t* words, size_t word_count) {
+    size_t count = 0;
+    for (size_t i = 0; i < word_count; i++) {
+        count += bitset_int_popcount(words[i]);
+    }
+    return count;
+}
+
+/**
+ * Grow the words to hold at least word_count, zeroing the new ones
+ * At least doubles, so inserting increasing values reallocates rarely.
+ */
+static inline bool bitset_int_grow(bitset_int* set, size_t word_count) {
+    size_t new_count = set->word_count * 2;
+    if (new_count < word_count) {
+        new_count = word_count;
+    }
+    MGEN_PROFILE_ALLOC(new_count * sizeof(uint64_t));
+    uint64_t* words = realloc(set->words, new_count * sizeof(uint64_t));
+    if (!words) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow bitset");
+        return false;
+    }
+    memset(words + set->word_count, 0, (new_count - set->word_count) * sizeof(uint64_t));
+    set->words = words;
+    set->word_count = new_count;
+    return true;
+}
+
+/**
+ * Size the words for values in [0, domain) up front
+ */
+static inline bool bitset_int_reserve(bitset_int* set, size_t domain) {
+    if (!set) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL bitset");
+        return false;
+    }
+    size_t word_count = (domain + BITSET_INT_WORD_BITS - 1) / BITSET_INT_WORD_BITS;
+    return word_count <= set->word_count || bitset_int_grow(set, word_count);
+}
+
+/**
+ * Insert a value (must be non-negative)
+ * Returns true if inserted (new), false if already present
+ */
+static inline bool bitset_int_insert(bitset_int* set, int value) {
+    if (!set || value < 0) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL bitset or negative value");
+        return false;
+    }
+    size_t word = (size_t)value / BITSET_INT_WORD_BITS;
+    if (word >= set->word_count && !bitset_int_grow(set, word + 1)) {
+        return false;
+    }
+    uint64_t bit = 1ULL << ((unsigned)value % BITSET_INT_WORD_BITS);
+    if (set->words[word] & bit) {
+        return false;
+    }
+    set->words[word] |= bit;
+    set->size++;
+    return true;
+}
+
+static inline bool bitset_int_contains(const bitset_int* set, int value) {
+    if (!set || value < 0 || (size_t)value / BITSET_INT_WORD_BITS >= set->word_count) {
+        return false;
+    }
+    return (set->words[(size_t)value / BITSET_INT_WORD_BITS] >> ((unsigned)value % BITSET_INT_WORD_BITS)) & 1;
+}
+
+/**
+ * Remove a value if present (Python set.discard)
+ * Returns true if it was a member
+ */
+static inline bool bitset_int_erase(bitset_int* set, int value) {
+    if (!bitset_int_contains(set, value)) {
+        return false;
+    }
+    set->words[(size_t)value / BITSET_INT_WORD_BITS] &= ~(1ULL << ((unsigned)value % BITSET_INT_WORD_BITS));
+    set->size--;
+    return true;
+}
+
+static inline size_t bitset_int_size(const bitset_int* set) {
+    return set ? set->size : 0;
+}
+
+static inline bool bitset_int_empty(const bitset_int* set) {
+    return !set || set->size == 0;
+}
+
+/**
+ * Remove every member (keep the words allocated)
+ */
+static inline void bitset_int_clear(bitset_int* set) {
+    if (!set) {
+        return;
+    }
+    if (set->words) {
+        memset(set->words, 0, set->word_count * sizeof(uint64_t));
+    }
+    set->size = 0;
+}
+
+/**
+ * Free all memory (STC-compatible drop function)
+ */
+static inline void bitset_int_drop(bitset_int* set) {
+    if (!set) {
+        return;
+    }
+    free(set->words);
+    set->words = NULL;
+    set->word_count = 0;
+    set->size = 0;
+}
+
+/**
+ * Python set |= other
+ */
+static inline bool bitset_int_union_with(bitset_int* set, const bitset_int* other) {
+    if (!set || !other) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL bitset");
+        return false;
+    }
+    if (other->word_count > set->word_count && !bitset_int_grow(set, other->word_count)) {
+        return false;
+    }
+    uint64_t* words = set->words;
+    const uint64_t* others = other->words;
+    for (size_t i = 0; i < other->word_count; i++) {
+        words[i] |= others[i];
+    }
+    set->size = bitset_int_count(set->words, set->word_count);
+    return true;
+}
+
+/**
+ * Python set &= other
+ */
+static inline void bitset_int_intersect_with(bitset_int* set, const bitset_int* other) {
+    if (!set || !other) {
+        return;
+    }
+    size_t shared = set->word_count < other->word_count ? set->word_count : other->word_count;
+    uint64_t* words = set->words;
+    const uint64_t* others = other->words;
+    for (size_t i = 0; i < shared; i++) {
+        words[i] &= others[i];
+    }
+    if (set->word_count > shared) {
+        memset(words + shared, 0, (set->word_count - shared) * sizeof(uint64_t));
+    }
+    set->size = bitset_int_count(words, shared);
+}
+
+/**
+ * Python set -= other
+ */
+static inline void bitset_int_difference_with(bitset_int* set, const bitset_int* other) {
+    if (!set || !other) {
+        return;
+    }
+    size_t shared = set->word_count < other->word_count ? set->word_count : other->word_count;
+    uint64_t* words = set->words;
+    const uint64_t* others = other->words;
+    for (size_t i = 0; i < shared; i++) {
+        words[i] &= ~others[i];
+    }
+    set->size = bitset_int_count(words, set->word_count);
+}
+
+/**
+ * Python set == other
+ */
+static inline bool bitset_int_equal(const bitset_int* a, const bitset_int* b) {
+    if (!a || !b || a->size != b->size) {
+        return a == b;
+    }
+    size_t shared = a->word_count < b->word_count ? a->word_count : b->word_count;
+    for (size_t i = 0; i < shared; i++) {
+        if (a->words[i] != b->words[i]) {
+            return false;
+        }
+    }
+    // Equal sizes and equal shared words leave no members beyond them
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_BITSET_INT_H
@@ -0,0 +1,96 @@
+/**
+ * Overflow-checked int arithmetic
+ * Single-header implementation for code generation
+ * stb-library style: static functions for single-file output
+ *
+ * Python ints never overflow; C int silently wraps. With the int_overflow="check"
+ * preference the converter routes +, - and * on int operands through these
+ * functions, except where range analysis proves the result fits (see
+ * overflow_free_arithmetic). The fast path is the compiler's overflow builtin
+ * and one branch predicted not taken, so in-range arithmetic runs at native
+ * speed. On overflow the exact result - a sum, difference or product of two
+ * ints always fits in 64 bits - is reported like an uncaught Python
+ * OverflowError and the program exits, instead of continuing on a wrapped value.
+ */
+
+#ifndef MGEN_CHECKED_INT_H
+#define MGEN_CHECKED_INT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "mgen_error_handling.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MGEN_CHECKED_INT_COLD __attribute__((cold, noinline, noreturn))
+#else
+#define MGEN_CHECKED_INT_COLD
+#endif
+
+/**
+ * Report an int result outside [INT_MIN, INT_MAX] and exit (the rare path)
+ */
+static MGEN_CHECKED_INT_COLD void mgen_int_overflow(char op, int a, int b) {
+    long long exact = op == '+' ? (long long)a + b : op == '-' ? (long long)a - b : (long long)a * b;
+    MGEN_SET_ERROR(MGEN_ERROR_OVERFLOW, "int result out of range");
+    fprintf(stderr, "OverflowError: %d %c %d = %lld does not fit in int\n", a, op, b, exact);
+    exit(1);
+}
+
+static inline int mgen_int_add(int a, int b) {
+#if defined(__GNUC__) || defined(__clang__)
+    int result;
+    if (MGEN_UNLIKELY(__builtin_add_overflow(a, b, &result))) {
+        mgen_int_overflow('+', a, b);
+    }
+    return result;
+#else
+    long long result = (long long)a + b;
+    if (result > INT_MAX || result < INT_MIN) {
+        mgen_int_overflow('+', a, b);
+    }
+    return (int)result;
+#endif
+}
+
+static inline int mgen_int_sub(int a, int b) {
+#if defined(__GNUC__) || defined(__clang__)
+    int result;
+    if (MGEN_UNLIKELY(__builtin_sub_overflow(a, b, &result))) {
+        mgen_int_overflow('-', a, b);
+    }
+    return result;
+#else
+    long long result = (long long)a - b;
+    if (result > INT_MAX || result < INT_MIN) {
+        mgen_int_overflow('-', a, b);
+    }
+    return (int)result;
+#endif
+}
+
+static inline int mgen_int_mul(int a, int b) {
+#if defined(__GNUC__) || defined(__clang__)
+    int result;
+    if (MGEN_UNLIKELY(__builtin_mul_overflow(a, b, &result))) {
+        mgen_int_overflow('*', a, b);
+    }
+    return result;
+#else
+    long long result = (long long)a * b;
+    if (result > INT_MAX || result < INT_MIN) {
+        mgen_int_overflow('*', a, b);
+    }
+    return (int)result;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_CHECKED_INT_H
@@ -325,6 +325,140 @@ int mgen_in_hmap(void* hmap_ptr, const void* key,
 }
 
 // Python-style string formatting for containers
+mgen_error_t mgen_repr_append_int(mgen_buffer_t* out, const void* element) {
+    return mgen_buffer_append_int(out, *(const int*)element);
+}
+
+mgen_error_t mgen_repr_append_double(mgen_buffer_t* out, const void* element) {
+    // Shortest of %.15g..%.17g that reads back as the same double, as repr() does
+    double value = *(const double*)element;
+    char digits[32];
+    int len = 0;
+    for (int precision = 15; precision <= 17; precision++) {
+        len = snprintf(digits, sizeof(digits), "%.*g", precision, value);
+        if (len < 0 || strtod(digits, NULL) == value) {
+            break;
+        }
+    }
+    if (len < 0) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Failed to format float");
+        return MGEN_ERROR_VALUE;
+    }
+    mgen_error_t err = mgen_buffer_append(out, digits, (size_t)len);
+    // Integral values keep a fraction: 2.0, not 2 (nan and inf have letters)
+    if (err == MGEN_OK && strpbrk(digits, ".ein") == NULL) {
+        err = mgen_buffer_append(out, ".0", 2);
+    }
+    return err;
+}
+
+mgen_error_t mgen_repr_append_bool(mgen_buffer_t* out, const void* element) {
+    return *(const bool*)element ? mgen_buffer_append(out, "True", 4) : mgen_buffer_append(out, "False", 5);
+}
+
+mgen_error_t mgen_repr_append_str(mgen_buffer_t* out, const void* element) {
+    const char* str = *(const char* const*)element;
+    if (!str) {
+        return mgen_buffer_append(out, "None", 4);
+    }
+
+    // Single quotes unless the string contains one and no double quote
+    char quote = strchr(str, '\'') && !strchr(str, '"') ? '"' : '\'';
+    mgen_error_t err = mgen_buffer_reserve(out, strlen(str) + 2);
+    if (err == MGEN_OK) {
+        err = mgen_buffer_append_char(out, quote);
+    }
+    for (const char* p = str; *p && err == MGEN_OK; p++) {
+        const char* escape = NULL;
+        switch (*p) {
+            case '\\': escape = "\\\\"; break;
+            case '\n': escape = "\\n"; break;
+            case '\t': escape = "\\t"; break;
+            case '\r': escape = "\\r"; break;
+            default:
+                if (*p == quote) {
+                    err = mgen_buffer_append_char(out, '\\');
+                }
+                break;
+        }
+        if (err == MGEN_OK) {
+            err = escape ? mgen_buffer_append(out, escape, 2) : mgen_buffer_append_char(out, *p);
+        }
+    }
+    return err == MGEN_OK ? mgen_buffer_append_char(out, quote) : err;
+}
+
+mgen_error_t mgen_vec_repr_append(mgen_buffer_t* out, void* vec_ptr,
+                                  size_t (*size_func)(void*),
+                                  void* (*at_func)(void*, size_t),
+                                  mgen_repr_append_t element_append) {
+    if (!out || !vec_ptr || !size_func || !at_func || !element_append) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Invalid parameters for vector representation");
+        return MGEN_ERROR_VALUE;
+    }
+
+    size_t size = size_func(vec_ptr);
+    // Short numbers and ", ": one reservation covers typical lists
+    mgen_error_t err = mgen_buffer_reserve(out, mgen_buffer_capacity_hint((long long)size, 8) + 2);
+    if (err == MGEN_OK) {
+        err = mgen_buffer_append_char(out, '[');
+    }
+    for (size_t i = 0; i < size && err == MGEN_OK; i++) {
+        if (i > 0) {
+            err = mgen_buffer_append(out, ", ", 2);
+        }
+        if (err == MGEN_OK) {
+            err = element_append(out, at_func(vec_ptr, i));
+        }
+    }
+    return err == MGEN_OK ? mgen_buffer_append_char(out, ']') : err;
+}
+
+// Iteration state of mgen_hmap_repr_append
+typedef struct {
+    mgen_buffer_t* out;
+    mgen_repr_append_t key_append;
+    mgen_repr_append_t value_append;
+    bool first;
+    mgen_error_t err;
+} mgen_hmap_repr_state_t;
+
+static void mgen_hmap_repr_entry(void* key, void* value, void* userdata) {
+    mgen_hmap_repr_state_t* state = userdata;
+    if (state->err != MGEN_OK) {
+        return;
+    }
+    if (!state->first) {
+        state->err = mgen_buffer_append(state->out, ", ", 2);
+    }
+    state->first = false;
+    if (state->err == MGEN_OK) {
+        state->err = state->key_append(state->out, key);
+    }
+    if (state->err == MGEN_OK) {
+        state->err = mgen_buffer_append(state->out, ": ", 2);
+    }
+    if (state->err == MGEN_OK) {
+        state->err = state->value_append(state->out, value);
+    }
+}
+
+mgen_error_t mgen_hmap_repr_append(mgen_buffer_t* out, void* hmap_ptr,
+                                   void (*iter_func)(void*, void (*)(void*, void*, void*), void*),
+                                   mgen_repr_append_t key_append,
+                                   mgen_repr_append_t value_append) {
+    if (!out || !hmap_ptr || !iter_func || !key_append || !value_append) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Invalid parameters for hashmap representation");
+        return MGEN_ERROR_VALUE;
+    }
+
+    mgen_hmap_repr_state_t state = {out, key_append, value_append, true, mgen_buffer_append_char(out, '{')};
+    if (state.err == MGEN_OK) {
+        iter_func(hmap_ptr, mgen_hmap_repr_entry, &state);
+    }
+    return state.err == MGEN_OK ? mgen_buffer_append_char(out, '}') : state.err;
+}
+
 char* mgen_vec_repr(void* vec_ptr,
                    size_t (*size_func)(void*),
                    void* (*at_func)(void*, size_t),
@@ -335,45 +469,37 @@ char* mgen_vec_repr(void* vec_ptr,
     }
 
     size_t size = size_func(vec_ptr);
-    if (size == 0) {
-        return mgen_strdup("[]");
+    mgen_buffer_t out;
+    if (mgen_buffer_init(&out, mgen_buffer_capacity_hint((long long)size, 8) + 3) != MGEN_OK) {
+        return NULL;
     }
 
-    // Build representation string
-    mgen_string_array_t* parts = mgen_string_array_new();
-    if (!parts) return NULL;
-
-    for (size_t i = 0; i < size; i++) {
+    // Each element string goes straight into the buffer and is freed
+    mgen_error_t err = mgen_buffer_append_char(&out, '[');
+    bool first = true;
+    for (size_t i = 0; i < size && err == MGEN_OK; i++) {
         void* element = at_func(vec_ptr, i);
-        if (element) {
-            char* elem_repr = element_repr(element);
-            if (elem_repr) {
-                if (mgen_string_array_add(parts, elem_repr) != MGEN_OK) {
-                    free(elem_repr);
-                    mgen_string_array_free(parts);
-                    return NULL;
-                }
-            }
+        char* elem_repr = element ? element_repr(element) : NULL;
+        if (!elem_repr) {
+            continue;
+        }
+        if (!first) {
+            err = mgen_buffer_append(&out, ", ", 2);
         }
+        first = false;
+        if (err == MGEN_OK) {
+            err = mgen_buffer_append_str(&out, elem_repr);
+        }
+        free(elem_repr);
     }
-
-    char* joined = mgen_join(", ", parts);
-    mgen_string_array_free(parts);
-
-    if (!joined) return NULL;
-
-    // Add brackets
-    char* result = malloc(strlen(joined) + 3); // "[]" + null terminator
-    if (!result) {
-        free(joined);
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for vector representation");
+    if (err == MGEN_OK) {
+        err = mgen_buffer_append_char(&out, ']');
+    }
+    if (err != MGEN_OK) {
+        mgen_buffer_destroy(&out);
         return NULL;
     }
-
-    sprintf(result, "[%s]", joined);
-    free(joined);
-
-    return result;
+    return mgen_buffer_detach(&out);
 }
 
 char* mgen_hmap_repr(void* hmap_ptr, char* (*repr_func)(void*)) {
@@ -382,6 +508,5 @@ char* mgen_hmap_repr(void* hmap_ptr, char* (*repr_func)(void*)) {
         return NULL;
     }
 
-    // This would be implemented with actual STC hashmap iteration when available
-    return mgen_strdup("{}"); // Simplified representation
+    return repr_func(hmap_ptr);
 }
@@ -200,12 +200,47 @@ int mgen_in_hmap(void* hmap_ptr, const void* key,
 
 /**
  * Python-style string formatting for containers
+ * Elements are formatted straight into one mgen_buffer_t sized up front;
+ * with an mgen_repr_append_t there is no allocation per element.
+ */
+
+// Appends Python repr() of one element to out
+typedef mgen_error_t (*mgen_repr_append_t)(mgen_buffer_t* out, const void* element);
+
+mgen_error_t mgen_repr_append_int(mgen_buffer_t* out, const void* element);     // const int*
+mgen_error_t mgen_repr_append_double(mgen_buffer_t* out, const void* element);  // const double*: 1.0, 0.1
+mgen_error_t mgen_repr_append_bool(mgen_buffer_t* out, const void* element);    // const bool*: True, False
+mgen_error_t mgen_repr_append_str(mgen_buffer_t* out, const void* element);     // const char* const*: 'a\'b'
+
+/**
+ * Append "[e0, e1, ...]" to out
+ */
+mgen_error_t mgen_vec_repr_append(mgen_buffer_t* out, void* vec_ptr,
+                                  size_t (*size_func)(void*),
+                                  void* (*at_func)(void*, size_t),
+                                  mgen_repr_append_t element_append);
+
+/**
+ * Append "{k0: v0, ...}" to out, visiting the entries with iter_func
+ */
+mgen_error_t mgen_hmap_repr_append(mgen_buffer_t* out, void* hmap_ptr,
+                                   void (*iter_func)(void*, void (*)(void*, void*, void*), void*),
+                                   mgen_repr_append_t key_append,
+                                   mgen_repr_append_t value_append);
+
+/**
+ * Allocated repr of a vector (caller must free)
+ * element_repr returns an allocated string per element; prefer
+ * mgen_vec_repr_append, which needs none
  */
 char* mgen_vec_repr(void* vec_ptr,
                    size_t (*size_func)(void*),
                    void* (*at_func)(void*, size_t),
                    char* (*element_repr)(const void*));
 
+/**
+ * Allocated repr of a hashmap produced by repr_func (caller must free)
+ */
 char* mgen_hmap_repr(void* hmap_ptr,
                     char* (*repr_func)(void*));
 
@@ -5,38 +5,42 @@
 #include "mgen_error_handling.h"
 #include <stdarg.h>
 
-// Global error context
-mgen_error_context_t mgen_last_error = {MGEN_OK, "", NULL, 0, NULL};
+// Per-thread error context
+MGEN_THREAD_LOCAL mgen_error_context_t mgen_last_error = {MGEN_OK, "", NULL, 0, NULL, ""};
 
 void mgen_set_error(mgen_error_t code, const char* message,
                    const char* file, int line, const char* function) {
-    mgen_last_error.code = code;
-    mgen_last_error.file = file;
-    mgen_last_error.line = line;
-    mgen_last_error.function = function;
+    mgen_error_context_t* ctx = &mgen_last_error;
+    ctx->code = code;
+    ctx->file = file;
+    ctx->line = line;
+    ctx->function = function;
 
     if (message) {
-        strncpy(mgen_last_error.message, message, sizeof(mgen_last_error.message) - 1);
-        mgen_last_error.message[sizeof(mgen_last_error.message) - 1] = '\0';
+        strncpy(ctx->message_buffer, message, sizeof(ctx->message_buffer) - 1);
+        ctx->message_buffer[sizeof(ctx->message_buffer) - 1] = '\0';
+        ctx->message = ctx->message_buffer;
     } else {
-        mgen_last_error.message[0] = '\0';
+        ctx->message = "";
     }
 }
 
 void mgen_set_error_fmt(mgen_error_t code, const char* file, int line,
                        const char* function, const char* format, ...) {
-    mgen_last_error.code = code;
-    mgen_last_error.file = file;
-    mgen_last_error.line = line;
-    mgen_last_error.function = function;
+    mgen_error_context_t* ctx = &mgen_last_error;
+    ctx->code = code;
+    ctx->file = file;
+    ctx->line = line;
+    ctx->function = function;
 
     if (format) {
         va_list args;
         va_start(args, format);
-        vsnprintf(mgen_last_error.message, sizeof(mgen_last_error.message), format, args);
+        vsnprintf(ctx->message_buffer, sizeof(ctx->message_buffer), format, args);
         va_end(args);
+        ctx->message = ctx->message_buffer;
     } else {
-        mgen_last_error.message[0] = '\0';
+        ctx->message = "";
     }
 }
 
@@ -49,11 +53,12 @@ const char* mgen_get_last_error_message(void) {
 }
 
 void mgen_clear_error(void) {
-    mgen_last_error.code = MGEN_OK;
-    mgen_last_error.message[0] = '\0';
-    mgen_last_error.file = NULL;
-    mgen_last_error.line = 0;
-    mgen_last_error.function = NULL;
+    mgen_error_context_t* ctx = &mgen_last_error;
+    ctx->code = MGEN_OK;
+    ctx->message = "";
+    ctx->file = NULL;
+    ctx->line = 0;
+    ctx->function = NULL;
 }
 
 int mgen_has_error(void) {
@@ -117,6 +122,8 @@ const char* mgen_error_name(mgen_error_t code) {
             return "PermissionError";
         case MGEN_ERROR_RUNTIME:
             return "RuntimeError";
+        case MGEN_ERROR_OVERFLOW:
+            return "OverflowError";
         default:
             return "UnknownError";
     }
@@ -29,27 +29,66 @@ typedef enum {
     MGEN_ERROR_IO = 7,              // IOError/OSError
     MGEN_ERROR_FILE_NOT_FOUND = 8, // FileNotFoundError
     MGEN_ERROR_PERMISSION = 9,      // PermissionError
-    MGEN_ERROR_RUNTIME = 10         // RuntimeError
+    MGEN_ERROR_RUNTIME = 10,        // RuntimeError
+    MGEN_ERROR_OVERFLOW = 11        // OverflowError
 } mgen_error_t;
 
+// Storage class for per-thread runtime state
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#define MGEN_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define MGEN_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define MGEN_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define MGEN_THREAD_LOCAL __thread
+#else
+#define MGEN_THREAD_LOCAL
+#endif
+
+// Branch hints: error checks in generated code are expected to pass
+#if defined(__GNUC__) || defined(__clang__)
+#define MGEN_LIKELY(x) __builtin_expect(!!(x), 1)
+#define MGEN_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define MGEN_LIKELY(x) (x)
+#define MGEN_UNLIKELY(x) (x)
+#endif
+
 // Error context structure
 typedef struct {
     mgen_error_t code;
-    char message[512];
+    const char* message;        // Static string or message_buffer
     const char* file;
     int line;
     const char* function;
+    char message_buffer[512];   // Backing storage for formatted/copied messages
 } mgen_error_context_t;
 
-// Global error context (thread-local in multi-threaded environments)
-extern mgen_error_context_t mgen_last_error;
+// Per-thread error context: generated code may run on several threads
+extern MGEN_THREAD_LOCAL mgen_error_context_t mgen_last_error;
 
 /**
  * Set error with detailed context information
+ * The message is copied, so it may live in a temporary buffer
  */
 void mgen_set_error(mgen_error_t code, const char* message,
                    const char* file, int line, const char* function);
 
+/**
+ * Set error with a message that outlives the error (e.g. a string literal)
+ * Fast path behind MGEN_SET_ERROR: stores the pointer without copying
+ */
+static inline void mgen_set_error_static(mgen_error_t code, const char* message,
+                                         const char* file, int line, const char* function) {
+    mgen_error_context_t* ctx = &mgen_last_error;
+    ctx->code = code;
+    ctx->message = message ? message : "";
+    ctx->file = file;
+    ctx->line = line;
+    ctx->function = function;
+}
+
 /**
  * Set error with formatted message
  */
@@ -92,8 +131,10 @@ mgen_error_t mgen_errno_to_error(int errno_val);
 const char* mgen_error_name(mgen_error_t code);
 
 // Convenience macros for error handling
+// MGEN_SET_ERROR keeps a pointer to msg: pass a string literal (use
+// mgen_set_error or MGEN_SET_ERROR_FMT for messages built at runtime)
 #define MGEN_SET_ERROR(code, msg) \
-    mgen_set_error((code), (msg), __FILE__, __LINE__, __func__)
+    mgen_set_error_static((code), (msg), __FILE__, __LINE__, __func__)
 
 #define MGEN_SET_ERROR_FMT(code, fmt, ...) \
     mgen_set_error_fmt((code), __FILE__, __LINE__, __func__, (fmt), ##__VA_ARGS__)
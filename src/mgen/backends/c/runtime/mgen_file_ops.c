@@ -4,17 +4,148 @@
 
 #include "mgen_file_ops.h"
 #include "mgen_string_ops.h"
+#include "mgen_ascii.h"
+#include <limits.h>
+#include <stdint.h>
 #include <unistd.h>
 
-// Platform-specific includes for path operations
+#if !defined(_WIN32) && !defined(MGEN_NO_THREADS)
+#define MGEN_WRITE_BEHIND_THREADS 1
+#include <pthread.h>
+#endif
+
+// Platform-specific includes for path operations and file mapping
 #ifdef _WIN32
     #include <windows.h>
     #define PATH_SEPARATOR "\\"
 #else
     #include <libgen.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
     #define PATH_SEPARATOR "/"
 #endif
 
+#ifdef MGEN_WRITE_BEHIND_THREADS
+
+// Double buffer: the caller fills front while the writer thread writes back
+struct mgen_write_behind {
+    char* front;
+    size_t front_len;
+    char* back;
+    size_t back_len;            // Non-zero while the writer thread owns back
+    size_t capacity;
+    bool stop;
+    int error;                  // errno of the first failed background write, sticky
+    pthread_mutex_t lock;
+    pthread_cond_t changed;     // back handed over or written, or stop requested
+    pthread_t thread;
+};
+
+static void* mgen_write_behind_main(void* arg) {
+    mgen_file_t* file = arg;
+    struct mgen_write_behind* wb = file->write_behind;
+    pthread_mutex_lock(&wb->lock);
+    for (;;) {
+        while (wb->back_len == 0 && !wb->stop) {
+            pthread_cond_wait(&wb->changed, &wb->lock);
+        }
+        if (wb->back_len == 0) {
+            break;  // Stopped with nothing pending
+        }
+        // The caller never touches back or the FILE while back_len is set
+        pthread_mutex_unlock(&wb->lock);
+        size_t written = fwrite(wb->back, 1, wb->back_len, file->file);
+        int error = written < wb->back_len ? (errno ? errno : EIO) : 0;
+        pthread_mutex_lock(&wb->lock);
+        if (error && !wb->error) {
+            wb->error = error;
+        }
+        wb->back_len = 0;
+        pthread_cond_broadcast(&wb->changed);
+    }
+    pthread_mutex_unlock(&wb->lock);
+    return NULL;
+}
+
+// Hand the front buffer to the writer thread once it is done with the back one
+static void mgen_write_behind_swap(struct mgen_write_behind* wb) {
+    pthread_mutex_lock(&wb->lock);
+    while (wb->back_len > 0) {
+        pthread_cond_wait(&wb->changed, &wb->lock);
+    }
+    char* buffer = wb->back;
+    wb->back = wb->front;
+    wb->back_len = wb->front_len;
+    wb->front = buffer;
+    wb->front_len = 0;
+    pthread_cond_broadcast(&wb->changed);
+    pthread_mutex_unlock(&wb->lock);
+}
+
+// Wait until every handed-over byte is written; reports (and clears) a background error
+static mgen_error_t mgen_write_behind_drain(mgen_file_t* file) {
+    struct mgen_write_behind* wb = file->write_behind;
+    if (wb->front_len > 0) {
+        mgen_write_behind_swap(wb);
+    }
+    pthread_mutex_lock(&wb->lock);
+    while (wb->back_len > 0) {
+        pthread_cond_wait(&wb->changed, &wb->lock);
+    }
+    int error = wb->error;
+    wb->error = 0;
+    pthread_mutex_unlock(&wb->lock);
+    if (error) {
+        MGEN_SET_ERROR_FMT(mgen_errno_to_error(error), "Failed to write to file '%s': %s", file->filename,
+                           strerror(error));
+        return mgen_errno_to_error(error);
+    }
+    return MGEN_OK;
+}
+
+static bool mgen_write_behind_append(mgen_file_t* file, const char* data, size_t len) {
+    struct mgen_write_behind* wb = file->write_behind;
+    pthread_mutex_lock(&wb->lock);
+    int error = wb->error;
+    pthread_mutex_unlock(&wb->lock);
+    if (error) {
+        MGEN_SET_ERROR_FMT(mgen_errno_to_error(error), "Failed to write to file '%s': %s", file->filename,
+                           strerror(error));
+        return false;
+    }
+    while (len > 0) {
+        size_t take = wb->capacity - wb->front_len < len ? wb->capacity - wb->front_len : len;
+        memcpy(wb->front + wb->front_len, data, take);
+        wb->front_len += take;
+        data += take;
+        len -= take;
+        if (wb->front_len == wb->capacity) {
+            mgen_write_behind_swap(wb);
+        }
+    }
+    return true;
+}
+
+// Stop the writer thread after the last write and free the buffers
+static mgen_error_t mgen_write_behind_stop(mgen_file_t* file) {
+    struct mgen_write_behind* wb = file->write_behind;
+    mgen_error_t result = mgen_write_behind_drain(file);
+    pthread_mutex_lock(&wb->lock);
+    wb->stop = true;
+    pthread_cond_broadcast(&wb->changed);
+    pthread_mutex_unlock(&wb->lock);
+    pthread_join(wb->thread, NULL);
+    pthread_cond_destroy(&wb->changed);
+    pthread_mutex_destroy(&wb->lock);
+    free(wb->front);
+    free(wb->back);
+    free(wb);
+    file->write_behind = NULL;
+    return result;
+}
+
+#endif
+
 mgen_file_t* mgen_open(const char* filename, const char* mode) {
     if (!filename || !mode) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Filename or mode is NULL");
@@ -38,6 +169,12 @@ mgen_file_t* mgen_open(const char* filename, const char* mode) {
     file->filename = mgen_strdup(filename);
     file->mode = mgen_strdup(mode);
     file->is_open = 1;
+    file->block = NULL;
+    file->block_pos = 0;
+    file->block_len = 0;
+    file->line = NULL;
+    file->line_capacity = 0;
+    file->write_behind = NULL;
 
     if (!file->filename || !file->mode) {
         fclose(file->file);
@@ -56,6 +193,11 @@ mgen_error_t mgen_close(mgen_file_t* file) {
         return MGEN_ERROR_VALUE;
     }
 
+#ifdef MGEN_WRITE_BEHIND_THREADS
+    // Close even if a background write failed, but report it
+    mgen_error_t write_error = file->write_behind ? mgen_write_behind_stop(file) : MGEN_OK;
+#endif
+
     if (file->is_open && file->file) {
         if (fclose(file->file) != 0) {
             mgen_error_t error = mgen_errno_to_error(errno);
@@ -68,9 +210,50 @@ mgen_error_t mgen_close(mgen_file_t* file) {
 
     free(file->filename);
     free(file->mode);
+    free(file->block);
+    free(file->line);
     free(file);
 
+#ifdef MGEN_WRITE_BEHIND_THREADS
+    return write_error;
+#else
     return MGEN_OK;
+#endif
+}
+
+/**
+ * Hand read-ahead bytes back to the stream before unbuffered reads/writes
+ */
+static void mgen_file_drop_read_ahead(mgen_file_t* file) {
+    size_t pending = file->block_len - file->block_pos;
+    if (pending > 0) {
+        fseek(file->file, -(long)pending, SEEK_CUR);
+    }
+    file->block_pos = 0;
+    file->block_len = 0;
+}
+
+/**
+ * Make room for capacity bytes in the reused line buffer
+ */
+static int mgen_file_reserve_line(mgen_file_t* file, size_t capacity) {
+    if (capacity <= file->line_capacity) {
+        return 1;
+    }
+
+    size_t new_capacity = file->line_capacity ? file->line_capacity : 128;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+
+    char* new_line = realloc(file->line, new_capacity);
+    if (!new_line) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to resize line buffer");
+        return 0;
+    }
+    file->line = new_line;
+    file->line_capacity = new_capacity;
+    return 1;
 }
 
 char* mgen_read(mgen_file_t* file, size_t size) {
@@ -79,6 +262,8 @@ char* mgen_read(mgen_file_t* file, size_t size) {
         return NULL;
     }
 
+    mgen_file_drop_read_ahead(file);
+
     if (size == 0) {
         // Read entire file
         fseek(file->file, 0, SEEK_END);
@@ -108,45 +293,99 @@ char* mgen_read(mgen_file_t* file, size_t size) {
     return buffer;
 }
 
-char* mgen_readline(mgen_file_t* file) {
+bool mgen_file_next_line_view(mgen_file_t* file, mgen_strview_t* out) {
     if (!file || !file->is_open) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Invalid or closed file handle");
-        return NULL;
+        return false;
     }
 
-    size_t capacity = 128;
-    char* line = malloc(capacity);
-    if (!line) {
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate line buffer");
-        return NULL;
+    if (!file->block) {
+        file->block = malloc(MGEN_FILE_BLOCK_SIZE);
+        if (!file->block) {
+            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate read buffer");
+            return false;
+        }
     }
 
-    size_t length = 0;
-    int c;
-
-    while ((c = fgetc(file->file)) != EOF) {
-        if (length >= capacity - 1) {
-            capacity *= 2;
-            char* new_line = realloc(line, capacity);
-            if (!new_line) {
-                MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to resize line buffer");
-                free(line);
-                return NULL;
+    size_t length = 0;  // Bytes accumulated in file->line
+
+    for (;;) {
+        if (file->block_pos == file->block_len) {
+            file->block_pos = 0;
+            file->block_len = fread(file->block, 1, MGEN_FILE_BLOCK_SIZE, file->file);
+            if (file->block_len == 0) {
+                if (ferror(file->file)) {
+                    MGEN_SET_ERROR(MGEN_ERROR_IO, "Error reading from file");
+                    return false;
+                }
+                break;  // End of file
             }
-            line = new_line;
         }
 
-        line[length++] = (char)c;
-        if (c == '\n') break;
+        // memchr is vectorized by the C library, so this scans a block at a time
+        char* start = file->block + file->block_pos;
+        size_t available = file->block_len - file->block_pos;
+        char* newline = memchr(start, '\n', available);
+        size_t take = newline ? (size_t)(newline - start) + 1 : available;
+
+        if (newline && length == 0) {
+            // Common case: the whole line is inside the block, hand it out in place
+            file->block_pos += take;
+            out->data = start;
+            out->len = take;
+            return true;
+        }
+
+        // Line spans a block boundary: stitch it together in the line buffer
+        if (!mgen_file_reserve_line(file, length + take + 1)) {
+            return false;
+        }
+        memcpy(file->line + length, start, take);
+        length += take;
+        file->block_pos += take;
+
+        if (newline) {
+            break;
+        }
+    }
+
+    if (length == 0) {
+        return false;
+    }
+
+    out->data = file->line;
+    out->len = length;
+    return true;
+}
+
+const char* mgen_file_next_line(mgen_file_t* file, size_t* length) {
+    mgen_strview_t view;
+    if (!mgen_file_next_line_view(file, &view)) {
+        return NULL;
+    }
+
+    // Lines stitched in the line buffer already have room for the terminator
+    if (view.data != file->line) {
+        if (!mgen_file_reserve_line(file, view.len + 1)) {
+            return NULL;
+        }
+        memcpy(file->line, view.data, view.len);
+    }
+    file->line[view.len] = '\0';
+
+    if (length) {
+        *length = view.len;
     }
+    return file->line;
+}
 
-    if (length == 0 && c == EOF) {
-        free(line);
-        return NULL; // End of file
+char* mgen_readline(mgen_file_t* file) {
+    mgen_strview_t view;
+    if (!mgen_file_next_line_view(file, &view)) {
+        return NULL;  // End of file or error
     }
 
-    line[length] = '\0';
-    return line;
+    return mgen_strview_to_cstr(view);
 }
 
 mgen_string_array_t* mgen_readlines(mgen_file_t* file) {
@@ -158,9 +397,10 @@ mgen_string_array_t* mgen_readlines(mgen_file_t* file) {
     mgen_string_array_t* lines = mgen_string_array_new();
     if (!lines) return NULL;
 
-    char* line;
-    while ((line = mgen_readline(file)) != NULL) {
-        if (mgen_string_array_add(lines, line) != MGEN_OK) {
+    mgen_strview_t view;
+    while (mgen_file_next_line_view(file, &view)) {
+        char* line = mgen_strview_to_cstr(view);
+        if (!line || mgen_string_array_add(lines, line) != MGEN_OK) {
             free(line);
             mgen_string_array_free(lines);
             return NULL;
@@ -170,6 +410,515 @@ mgen_string_array_t* mgen_readlines(mgen_file_t* file) {
     return lines;
 }
 
+mgen_csv_reader_t mgen_csv_reader_init(mgen_file_t* file, char delimiter) {
+    mgen_csv_reader_t reader = {file, delimiter, '"', NULL, 0, 0, NULL, 0};
+    return reader;
+}
+
+void mgen_csv_reader_free(mgen_csv_reader_t* reader) {
+    free(reader->fields);
+    free(reader->record);
+    reader->fields = NULL;
+    reader->record = NULL;
+    reader->field_count = reader->field_capacity = reader->record_capacity = 0;
+}
+
+static bool mgen_csv_push(mgen_csv_reader_t* reader, const char* data, size_t len) {
+    if (reader->field_count == reader->field_capacity) {
+        size_t capacity = reader->field_capacity ? reader->field_capacity * 2 : 16;
+        mgen_strview_t* fields = realloc(reader->fields, capacity * sizeof(mgen_strview_t));
+        if (!fields) {
+            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to resize record fields");
+            return false;
+        }
+        reader->fields = fields;
+        reader->field_capacity = capacity;
+    }
+    reader->fields[reader->field_count].data = data;
+    reader->fields[reader->field_count].len = len;
+    reader->field_count++;
+    return true;
+}
+
+/**
+ * Split an unquoted record on the delimiter
+ * Fields are short, so a block's delimiters are found with one compare and
+ * walked as a bit mask instead of calling memchr once per field.
+ */
+static bool mgen_csv_split_plain(mgen_csv_reader_t* reader, const char* data, const char* end) {
+    const char* field = data;
+    const char* p = data;
+#ifdef MGEN_ASCII_SIMD
+    for (; end - p >= MGEN_ASCII_BLOCK; p += MGEN_ASCII_BLOCK) {
+        unsigned int mask = mgen_ascii_byte_mask((const unsigned char*)p, (unsigned char)reader->delimiter);
+        while (mask) {
+            const char* delimiter = p + mgen_ascii_ctz(mask);
+            if (!mgen_csv_push(reader, field, (size_t)(delimiter - field))) {
+                return false;
+            }
+            field = delimiter + 1;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; p < end; p++) {
+        if (*p == reader->delimiter) {
+            if (!mgen_csv_push(reader, field, (size_t)(p - field))) {
+                return false;
+            }
+            field = p + 1;
+        }
+    }
+    return mgen_csv_push(reader, field, (size_t)(end - field));
+}
+
+// Position in a record while scanning quotes
+enum { MGEN_CSV_FIELD_START, MGEN_CSV_PLAIN, MGEN_CSV_QUOTED, MGEN_CSV_QUOTED_QUOTE };
+
+/**
+ * Scanner state after len more bytes of a record
+ * Like csv.reader, a quote only opens a field at its start; after the closing
+ * quote the rest of the field is literal.
+ */
+static int mgen_csv_scan(const mgen_csv_reader_t* reader, const char* data, size_t len, int state) {
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (state == MGEN_CSV_QUOTED) {
+            state = c == reader->quote ? MGEN_CSV_QUOTED_QUOTE : MGEN_CSV_QUOTED;
+        } else if (state == MGEN_CSV_PLAIN) {
+            state = c == reader->delimiter ? MGEN_CSV_FIELD_START : MGEN_CSV_PLAIN;
+        } else if (c == reader->quote) {
+            // Opening quote, or the second quote of an escaped "" inside a quoted field
+            state = MGEN_CSV_QUOTED;
+        } else {
+            state = c == reader->delimiter ? MGEN_CSV_FIELD_START : MGEN_CSV_PLAIN;
+        }
+    }
+    return state;
+}
+
+/**
+ * Split a record containing quotes, unescaping quoted fields in place
+ */
+static bool mgen_csv_split_quoted(mgen_csv_reader_t* reader, char* data, char* end) {
+    char* p = data;
+    for (;;) {
+        char* field = p;
+        char* out = p;
+        bool quoted = p < end && *p == reader->quote;
+        p += quoted;
+        while (p < end && (quoted || *p != reader->delimiter)) {
+            if (quoted && *p == reader->quote) {
+                if (p + 1 < end && p[1] == reader->quote) {
+                    p++;  // "" inside quotes is one quote
+                } else {
+                    quoted = false;
+                    p++;
+                    continue;
+                }
+            }
+            *out++ = *p++;
+        }
+        if (!mgen_csv_push(reader, field, (size_t)(out - field))) {
+            return false;
+        }
+        if (p == end) {
+            return true;
+        }
+        p++;  // Delimiter
+    }
+}
+
+// Append a line to the reader's record buffer
+static bool mgen_csv_append(mgen_csv_reader_t* reader, size_t* length, mgen_strview_t line) {
+    if (*length + line.len > reader->record_capacity) {
+        size_t capacity = reader->record_capacity ? reader->record_capacity : 256;
+        while (capacity < *length + line.len) {
+            capacity *= 2;
+        }
+        char* record = realloc(reader->record, capacity);
+        if (!record) {
+            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to resize record buffer");
+            return false;
+        }
+        reader->record = record;
+        reader->record_capacity = capacity;
+    }
+    memcpy(reader->record + *length, line.data, line.len);
+    *length += line.len;
+    return true;
+}
+
+bool mgen_csv_reader_next(mgen_csv_reader_t* reader) {
+    mgen_strview_t line;
+    reader->field_count = 0;
+    if (!mgen_file_next_line_view(reader->file, &line)) {
+        return false;
+    }
+
+    // Line views point into the handle's own buffers, so they can be unescaped in place
+    char* data = (char*)line.data;
+    size_t len = line.len;
+    bool quotes = memchr(data, reader->quote, len) != NULL;
+    int state = quotes ? mgen_csv_scan(reader, data, len, MGEN_CSV_FIELD_START) : MGEN_CSV_PLAIN;
+    if (state == MGEN_CSV_QUOTED) {
+        // A quoted field continues on the next line. The next read reuses the
+        // line's buffer, so the record is joined in a buffer of its own.
+        size_t length = 0;
+        if (!mgen_csv_append(reader, &length, line)) {
+            return false;
+        }
+        while (state == MGEN_CSV_QUOTED && mgen_file_next_line_view(reader->file, &line)) {
+            state = mgen_csv_scan(reader, line.data, line.len, state);
+            if (!mgen_csv_append(reader, &length, line)) {
+                return false;
+            }
+        }
+        data = reader->record;
+        len = length;
+    }
+
+    if (len > 0 && data[len - 1] == '\n') {
+        len--;
+    }
+    if (len > 0 && data[len - 1] == '\r') {
+        len--;
+    }
+    if (len == 0) {
+        return true;  // Blank line: no fields
+    }
+    return quotes ? mgen_csv_split_quoted(reader, data, data + len) : mgen_csv_split_plain(reader, data, data + len);
+}
+
+bool mgen_csv_parse_int(mgen_strview_t field, long long* out) {
+    const char* p = mgen_ascii_skip_space(field.data, field.data + field.len);
+    const char* end = mgen_ascii_trim_space(p, field.data + field.len);
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+    if (p == end) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "invalid literal for int()");
+        return false;
+    }
+
+    // Accumulate as a negative number: its range includes LLONG_MIN
+    long long value = 0;
+    for (; p < end; p++) {
+        unsigned int digit = (unsigned int)(unsigned char)*p - '0';
+        if (digit > 9) {
+            MGEN_SET_ERROR(MGEN_ERROR_VALUE, "invalid literal for int()");
+            return false;
+        }
+        if (value < (LLONG_MIN + (long long)digit) / 10) {
+            MGEN_SET_ERROR(MGEN_ERROR_VALUE, "int() value out of range");
+            return false;
+        }
+        value = value * 10 - (long long)digit;
+    }
+    if (!negative && value == LLONG_MIN) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "int() value out of range");
+        return false;
+    }
+    *out = negative ? value : -value;
+    return true;
+}
+
+// strtod of a view: it needs a NUL-terminated copy
+static bool mgen_csv_strtod(const char* data, size_t len, double* out) {
+    char small[64];
+    char* copy = len < sizeof(small) ? small : malloc(len + 1);
+    if (!copy) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate number buffer");
+        return false;
+    }
+    memcpy(copy, data, len);
+    copy[len] = '\0';
+    char* stop;
+    *out = strtod(copy, &stop);
+    bool ok = len > 0 && stop == copy + len;
+    if (copy != small) {
+        free(copy);
+    }
+    if (!ok) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "could not convert string to float");
+    }
+    return ok;
+}
+
+bool mgen_csv_parse_double(mgen_strview_t field, double* out) {
+    // Powers of ten that are exact doubles
+    static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* start = mgen_ascii_skip_space(field.data, field.data + field.len);
+    const char* end = mgen_ascii_trim_space(start, field.data + field.len);
+    const char* p = start;
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+
+    // Up to 19 significant digits fit in the mantissa without rounding
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && mgen_ascii_isdigit((unsigned char)*p); p++, any = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+            digits++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && mgen_ascii_isdigit((unsigned char)*p); p++, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            } else {
+                digits++;
+            }
+        }
+    }
+    if (any && p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negative_exponent = q < end && *q == '-';
+        if (q < end && (*q == '-' || *q == '+')) {
+            q++;
+        }
+        int value = 0;
+        const char* first = q;
+        for (; q < end && mgen_ascii_isdigit((unsigned char)*q) && value < 10000; q++) {
+            value = value * 10 + (*q - '0');
+        }
+        if (q > first) {
+            exponent += negative_exponent ? -value : value;
+            p = q;
+        }
+    }
+
+    // Exact when both the mantissa and the power of ten are exact doubles: one rounding
+    if (any && p == end && digits <= 19 && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+        double value = (double)mantissa;
+        value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+        *out = negative ? -value : value;
+        return true;
+    }
+    return mgen_csv_strtod(start, (size_t)(end - start), out);
+}
+
+/**
+ * Read a whole stream into a heap buffer (mmap fallback)
+ */
+static mgen_error_t mgen_mmap_fallback(FILE* stream, const char* filename, mgen_mapped_file_t* mapped) {
+    size_t capacity = MGEN_FILE_BLOCK_SIZE;
+    size_t length = 0;
+    char* buffer = malloc(capacity);
+    if (!buffer) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate read buffer");
+        return MGEN_ERROR_MEMORY;
+    }
+
+    size_t bytes_read;
+    while ((bytes_read = fread(buffer + length, 1, capacity - length, stream)) > 0) {
+        length += bytes_read;
+        if (length == capacity) {
+            char* new_buffer = realloc(buffer, capacity * 2);
+            if (!new_buffer) {
+                MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to resize read buffer");
+                free(buffer);
+                return MGEN_ERROR_MEMORY;
+            }
+            buffer = new_buffer;
+            capacity *= 2;
+        }
+    }
+
+    if (ferror(stream)) {
+        MGEN_SET_ERROR_FMT(MGEN_ERROR_IO, "Error reading from file '%s'", filename);
+        free(buffer);
+        return MGEN_ERROR_IO;
+    }
+
+    if (length == 0) {
+        free(buffer);  // Keep the static "" so munmap has nothing to free
+        return MGEN_OK;
+    }
+
+    mapped->data = buffer;
+    mapped->length = length;
+    return MGEN_OK;
+}
+
+mgen_error_t mgen_mmap_file(const char* filename, mgen_mapped_file_t* mapped) {
+    if (!filename || !mapped) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Filename or mapping is NULL");
+        return MGEN_ERROR_VALUE;
+    }
+
+    mapped->data = "";
+    mapped->length = 0;
+    mapped->is_mapped = 0;
+    mapped->mapping = NULL;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (handle != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(handle, &size) && size.QuadPart == 0) {
+            CloseHandle(handle);
+            return MGEN_OK;  // Empty file: nothing to map
+        }
+
+        HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(handle);  // The mapping keeps the file open
+        if (mapping) {
+            const char* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view) {
+                mapped->data = view;
+                mapped->length = (size_t)size.QuadPart;
+                mapped->is_mapped = 1;
+                mapped->mapping = mapping;
+                return MGEN_OK;
+            }
+            CloseHandle(mapping);
+        }
+    }
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            if (st.st_size == 0) {
+                close(fd);
+                return MGEN_OK;  // Empty file: nothing to map
+            }
+
+            void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);  // The mapping keeps the file referenced
+            if (view != MAP_FAILED) {
+#ifdef POSIX_MADV_SEQUENTIAL
+                posix_madvise(view, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+                mapped->data = view;
+                mapped->length = (size_t)st.st_size;
+                mapped->is_mapped = 1;
+                return MGEN_OK;
+            }
+        } else {
+            close(fd);
+        }
+    }
+#endif
+
+    // Not mappable (or not a regular file): read it the ordinary way
+    FILE* stream = fopen(filename, "rb");
+    if (!stream) {
+        mgen_error_t error = mgen_errno_to_error(errno);
+        MGEN_SET_ERROR_FMT(error, "Failed to open file '%s': %s", filename, strerror(errno));
+        return error;
+    }
+
+    mgen_error_t result = mgen_mmap_fallback(stream, filename, mapped);
+    fclose(stream);
+    return result;
+}
+
+void mgen_munmap_file(mgen_mapped_file_t* mapped) {
+    if (!mapped || !mapped->data) return;
+
+    if (mapped->is_mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapped->data);
+        CloseHandle((HANDLE)mapped->mapping);
+#else
+        munmap((void*)mapped->data, mapped->length);
+#endif
+    } else if (mapped->length > 0) {
+        free((void*)mapped->data);
+    }
+
+    mapped->data = NULL;
+    mapped->length = 0;
+    mapped->is_mapped = 0;
+    mapped->mapping = NULL;
+}
+
+mgen_strview_t mgen_mapped_file_view(const mgen_mapped_file_t* mapped) {
+    mgen_strview_t view = {mapped ? mapped->data : NULL, mapped ? mapped->length : 0};
+    return view;
+}
+
+mgen_error_t mgen_file_write_behind(mgen_file_t* file, size_t buffer_size) {
+    if (!file || !file->is_open) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Invalid or closed file handle");
+        return MGEN_ERROR_VALUE;
+    }
+#ifdef MGEN_WRITE_BEHIND_THREADS
+    if (file->write_behind) {
+        return MGEN_OK;
+    }
+    struct mgen_write_behind* wb = calloc(1, sizeof(*wb));
+    size_t capacity = buffer_size ? buffer_size : MGEN_WRITE_BEHIND_SIZE;
+    if (wb) {
+        wb->front = malloc(capacity);
+        wb->back = malloc(capacity);
+    }
+    if (!wb || !wb->front || !wb->back) {
+        if (wb) {
+            free(wb->front);
+            free(wb->back);
+        }
+        free(wb);
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate write-behind buffers");
+        return MGEN_ERROR_MEMORY;
+    }
+    wb->capacity = capacity;
+    pthread_mutex_init(&wb->lock, NULL);
+    pthread_cond_init(&wb->changed, NULL);
+
+    mgen_file_drop_read_ahead(file);
+    file->write_behind = wb;
+    if (pthread_create(&wb->thread, NULL, mgen_write_behind_main, file) != 0) {
+        // No thread to spare: stay synchronous
+        file->write_behind = NULL;
+        pthread_cond_destroy(&wb->changed);
+        pthread_mutex_destroy(&wb->lock);
+        free(wb->front);
+        free(wb->back);
+        free(wb);
+    }
+#else
+    (void)buffer_size;
+#endif
+    return MGEN_OK;
+}
+
+mgen_error_t mgen_flush(mgen_file_t* file) {
+    if (!file || !file->is_open) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Invalid or closed file handle");
+        return MGEN_ERROR_VALUE;
+    }
+#ifdef MGEN_WRITE_BEHIND_THREADS
+    if (file->write_behind) {
+        mgen_error_t error = mgen_write_behind_drain(file);
+        if (error != MGEN_OK) {
+            return error;
+        }
+    }
+#endif
+    if (fflush(file->file) != 0) {
+        mgen_error_t error = mgen_errno_to_error(errno);
+        MGEN_SET_ERROR_FMT(error, "Failed to flush file '%s': %s", file->filename, strerror(errno));
+        return error;
+    }
+    return MGEN_OK;
+}
+
 int mgen_write(mgen_file_t* file, const char* data) {
     if (!file || !file->is_open) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Invalid or closed file handle");
@@ -182,6 +931,13 @@ int mgen_write(mgen_file_t* file, const char* data) {
     }
 
     size_t len = strlen(data);
+#ifdef MGEN_WRITE_BEHIND_THREADS
+    if (file->write_behind) {
+        return mgen_write_behind_append(file, data, len) ? (int)len : -1;
+    }
+#endif
+
+    mgen_file_drop_read_ahead(file);
     size_t written = fwrite(data, 1, len, file->file);
 
     if (written < len) {
@@ -20,12 +20,25 @@
 extern "C" {
 #endif
 
+#ifndef MGEN_FILE_BLOCK_SIZE
+#define MGEN_FILE_BLOCK_SIZE (64 * 1024)
+#endif
+
 // File handle structure for Python-like file operations
 typedef struct {
     FILE* file;
     char* filename;
     char* mode;
     int is_open;
+
+    // Line reader state (allocated on first line read)
+    char* block;            // MGEN_FILE_BLOCK_SIZE bytes read ahead of the caller
+    size_t block_pos;       // Next unconsumed byte in block
+    size_t block_len;       // Valid bytes in block
+    char* line;             // Reused buffer for lines spanning blocks / NUL termination
+    size_t line_capacity;
+
+    struct mgen_write_behind* write_behind;  // Background writer (mgen_file_write_behind), or NULL
 } mgen_file_t;
 
 /**
@@ -52,18 +65,126 @@ char* mgen_read(mgen_file_t* file, size_t size);
  */
 char* mgen_readline(mgen_file_t* file);
 
+/**
+ * Python "for line in file" iteration step, without allocation
+ * The view (including the trailing newline) points into the handle's block
+ * or line buffer and is valid until the next read on this handle.
+ * Returns false at end of file or on error.
+ */
+bool mgen_file_next_line_view(mgen_file_t* file, mgen_strview_t* out);
+
+/**
+ * Like mgen_file_next_line_view but NUL-terminated in the reused line buffer
+ * Returns NULL at end of file; the optional length excludes the terminator
+ */
+const char* mgen_file_next_line(mgen_file_t* file, size_t* length);
+
 /**
  * Python file.readlines() equivalent
  * Returns array of lines (caller must free)
  */
 mgen_string_array_t* mgen_readlines(mgen_file_t* file);
 
+// Streaming reader of delimited records (RFC 4180 quoting) over a file's line reader
+typedef struct {
+    mgen_file_t* file;
+    char delimiter;
+    char quote;
+    mgen_strview_t* fields;     // Fields of the current record
+    size_t field_count;
+    size_t field_capacity;
+    char* record;               // Records whose quoted fields span lines are joined here
+    size_t record_capacity;
+} mgen_csv_reader_t;
+
+/**
+ * Reader of the records of an open file, split on delimiter ('"' quotes)
+ * The file stays owned by the caller; free the reader with mgen_csv_reader_free.
+ */
+mgen_csv_reader_t mgen_csv_reader_init(mgen_file_t* file, char delimiter);
+
+/**
+ * Read the next record into reader->fields / reader->field_count
+ * Fields are views without the surrounding quotes; escaped quotes ("") are
+ * unescaped in place in the handle's buffers. Views are valid until the next
+ * read on the file. Lines end at \n with an optional \r; like csv.reader, a
+ * blank line is a record with no fields. Returns false at end of file or on error.
+ */
+bool mgen_csv_reader_next(mgen_csv_reader_t* reader);
+
+/**
+ * Release the reader's buffers (not the file)
+ */
+void mgen_csv_reader_free(mgen_csv_reader_t* reader);
+
+/**
+ * Python int(field): optional surrounding whitespace and sign, decimal digits
+ * Locale-independent. Returns false and sets MGEN_ERROR_VALUE on malformed or
+ * out-of-range input.
+ */
+bool mgen_csv_parse_int(mgen_strview_t field, long long* out);
+
+/**
+ * Python float(field)
+ * Short decimal numbers are converted exactly without strtod; anything else
+ * (long mantissas, large exponents, inf/nan) falls back to strtod, which
+ * generated programs run in the "C" locale. Returns false and sets
+ * MGEN_ERROR_VALUE on malformed input.
+ */
+bool mgen_csv_parse_double(mgen_strview_t field, double* out);
+
+// Read-only, whole-file view (memory-mapped when the platform allows it)
+typedef struct {
+    const char* data;  // File contents (NOT NUL-terminated)
+    size_t length;     // Size in bytes
+    int is_mapped;     // 0 when the contents were read into a heap buffer instead
+    void* mapping;     // Platform mapping handle (Windows only)
+} mgen_mapped_file_t;
+
+/**
+ * Map an entire file read-only: zero-copy alternative to mgen_read_file
+ * Falls back to a heap copy for inputs that cannot be mapped (pipes, devices).
+ * Release with mgen_munmap_file.
+ */
+mgen_error_t mgen_mmap_file(const char* filename, mgen_mapped_file_t* mapped);
+
+/**
+ * Release a mapping created by mgen_mmap_file
+ */
+void mgen_munmap_file(mgen_mapped_file_t* mapped);
+
+/**
+ * View over the mapped contents (for the mgen_strview_t helpers)
+ */
+mgen_strview_t mgen_mapped_file_view(const mgen_mapped_file_t* mapped);
+
 /**
  * Python file.write() equivalent
  * Returns number of characters written or -1 on error
  */
 int mgen_write(mgen_file_t* file, const char* data);
 
+#ifndef MGEN_WRITE_BEHIND_SIZE
+#define MGEN_WRITE_BEHIND_SIZE (1024 * 1024)
+#endif
+
+/**
+ * Opt in to write-behind output for a file opened for writing
+ * mgen_write then only copies into one of two buffer_size buffers (0 for
+ * MGEN_WRITE_BEHIND_SIZE); a background thread writes the full one while the
+ * caller fills the other. Errors of the background writes are reported by a
+ * later mgen_write, mgen_flush or mgen_close. mgen_flush and mgen_close are
+ * the barriers: other operations on the handle must come after mgen_flush.
+ * Without threads (_WIN32, MGEN_NO_THREADS) writes stay synchronous.
+ */
+mgen_error_t mgen_file_write_behind(mgen_file_t* file, size_t buffer_size);
+
+/**
+ * Python file.flush() equivalent
+ * With write-behind, waits until every byte written so far reached the OS.
+ */
+mgen_error_t mgen_flush(mgen_file_t* file);
+
 /**
  * Python file.writelines() equivalent
  */
@@ -0,0 +1,226 @@
+/**
+ * Hot-path instrumentation for generated code
+ * Single-header implementation for code generation
+ * stb-library style: static functions for single-file output
+ *
+ * mgen build --instrument (the "instrument" preference) makes the converter
+ * open a probe at the top of every function and around every loop. A probe
+ * counts entries and times the outermost activation of its site, so recursive
+ * calls are counted but not timed twice. Each thread accumulates into its own
+ * record block, linked into a global list on its first probe, so the hot path
+ * takes no lock and no atomic. At exit the blocks are summed into one report
+ * keyed by the Python function and line of each site, written to stderr or to
+ * the file the MGEN_INSTRUMENT environment variable names.
+ *
+ * Probes close through __attribute__((cleanup)) on every return; compilers
+ * without it still count entries but report no time. The generated code
+ * defines MGEN_INSTRUMENT before including this header; building it with
+ * -DMGEN_NO_INSTRUMENT compiles every probe out.
+ *
+ * Times are nanoseconds from clock_gettime(CLOCK_MONOTONIC), or TSC cycles
+ * with -DMGEN_INSTRUMENT_RDTSC on x86.
+ */
+
+#ifndef MGEN_INSTRUMENT_H
+#define MGEN_INSTRUMENT_H
+
+#ifdef MGEN_INSTRUMENT
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mgen_error_handling.h"
+
+#if defined(MGEN_INSTRUMENT_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sites per program; the converter defines it to the number of probes it emits
+#ifndef MGEN_INSTRUMENT_MAX_SITES
+#define MGEN_INSTRUMENT_MAX_SITES 1024
+#endif
+
+typedef struct {
+    const char* function;  // Python function the site is in
+    const char* kind;      // "function" or "loop"
+    int line;              // Python source line
+    int depth;             // Open activations on this thread
+    uint64_t calls;
+    uint64_t elapsed;
+    uint64_t start;
+} mgen_probe_record_t;
+
+typedef struct mgen_probe_block {
+    struct mgen_probe_block* next;
+    mgen_probe_record_t records[MGEN_INSTRUMENT_MAX_SITES];
+} mgen_probe_block_t;
+
+// An open probe; closing it twice is harmless
+typedef struct {
+    mgen_probe_record_t* record;
+} mgen_probe_scope_t;
+
+static mgen_probe_block_t* mgen_probe_blocks = NULL;
+static MGEN_THREAD_LOCAL mgen_probe_block_t* mgen_probe_block = NULL;
+
+static inline uint64_t mgen_probe_now(void) {
+#if defined(MGEN_INSTRUMENT_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+    return (uint64_t)__rdtsc();
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#else
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+static int mgen_probe_compare(const void* a, const void* b) {
+    const mgen_probe_record_t* lhs = (const mgen_probe_record_t*)a;
+    const mgen_probe_record_t* rhs = (const mgen_probe_record_t*)b;
+    if (lhs->elapsed != rhs->elapsed) {
+        return lhs->elapsed > rhs->elapsed ? -1 : 1;
+    }
+    return lhs->calls > rhs->calls ? -1 : lhs->calls < rhs->calls;
+}
+
+/**
+ * Write the summed records of all threads, slowest site first
+ */
+static void mgen_instrument_dump(FILE* out) {
+    static mgen_probe_record_t totals[MGEN_INSTRUMENT_MAX_SITES];
+    size_t count = 0;
+    for (size_t site = 0; site < MGEN_INSTRUMENT_MAX_SITES; site++) {
+        mgen_probe_record_t total = {0};
+        for (mgen_probe_block_t* block = mgen_probe_blocks; block; block = block->next) {
+            const mgen_probe_record_t* record = &block->records[site];
+            if (record->calls > 0) {
+                total.function = record->function;
+                total.kind = record->kind;
+                total.line = record->line;
+                total.calls += record->calls;
+                total.elapsed += record->elapsed;
+            }
+        }
+        if (total.calls > 0) {
+            totals[count++] = total;
+        }
+    }
+    qsort(totals, count, sizeof(mgen_probe_record_t), mgen_probe_compare);
+
+#if defined(MGEN_INSTRUMENT_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+    const char* unit = "cycles";
+#else
+    const char* unit = "ns";
+#endif
+    fprintf(out, "%-24s %-8s %6s %12s %16s %14s\n", "function", "kind", "line", "calls", "total", "per call");
+    for (size_t i = 0; i < count; i++) {
+        const mgen_probe_record_t* total = &totals[i];
+        fprintf(out, "%-24s %-8s %6d %12llu %13llu %s %11llu %s\n", total->function, total->kind, total->line,
+                (unsigned long long)total->calls, (unsigned long long)total->elapsed, unit,
+                (unsigned long long)(total->elapsed / total->calls), unit);
+    }
+}
+
+static void mgen_instrument_report_at_exit(void) {
+    const char* path = getenv("MGEN_INSTRUMENT");
+    if (!path || !*path || strcmp(path, "-") == 0) {
+        mgen_instrument_dump(stderr);
+        return;
+    }
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "mgen: cannot write instrumentation report to %s\n", path);
+        return;
+    }
+    mgen_instrument_dump(out);
+    fclose(out);
+}
+
+// First probe on this thread: allocate its block and publish it for the report
+static mgen_probe_block_t* mgen_probe_thread_block(void) {
+    mgen_probe_block_t* block = (mgen_probe_block_t*)calloc(1, sizeof(mgen_probe_block_t));
+    if (!block) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate instrumentation records");
+        abort();
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    mgen_probe_block_t* head = __atomic_load_n(&mgen_probe_blocks, __ATOMIC_ACQUIRE);
+    do {
+        block->next = head;
+    } while (!__atomic_compare_exchange_n(&mgen_probe_blocks, &head, block, true, __ATOMIC_RELEASE,
+                                          __ATOMIC_ACQUIRE));
+    if (!block->next) {
+        atexit(mgen_instrument_report_at_exit);
+    }
+#else
+    block->next = mgen_probe_blocks;
+    mgen_probe_blocks = block;
+    if (!block->next) {
+        atexit(mgen_instrument_report_at_exit);
+    }
+#endif
+    mgen_probe_block = block;
+    return block;
+}
+
+static inline mgen_probe_scope_t mgen_probe_enter(int site, const char* function, const char* kind, int line) {
+    mgen_probe_block_t* block = mgen_probe_block;
+    if (MGEN_UNLIKELY(!block)) {
+        block = mgen_probe_thread_block();
+    }
+    mgen_probe_record_t* record = &block->records[site];
+    if (MGEN_UNLIKELY(record->calls == 0)) {
+        record->function = function;
+        record->kind = kind;
+        record->line = line;
+    }
+    record->calls++;
+    if (record->depth++ == 0) {
+        record->start = mgen_probe_now();
+    }
+    mgen_probe_scope_t scope = {record};
+    return scope;
+}
+
+static inline void mgen_probe_close(mgen_probe_scope_t* scope) {
+    mgen_probe_record_t* record = scope->record;
+    if (record) {
+        if (--record->depth == 0) {
+            record->elapsed += mgen_probe_now() - record->start;
+        }
+        scope->record = NULL;
+    }
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MGEN_PROBE_CLEANUP __attribute__((cleanup(mgen_probe_close)))
+#else
+#define MGEN_PROBE_CLEANUP
+#endif
+
+// Open probe name for a site; it closes when its scope is left or at MGEN_PROBE_CLOSE
+#define MGEN_PROBE(name, site, function, kind, line) \
+    mgen_probe_scope_t name MGEN_PROBE_CLEANUP = mgen_probe_enter((site), (function), (kind), (line))
+#define MGEN_PROBE_CLOSE(name) mgen_probe_close(&(name))
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+
+#define MGEN_PROBE(name, site, function, kind, line) ((void)0)
+#define MGEN_PROBE_CLOSE(name) ((void)0)
+
+#endif // MGEN_INSTRUMENT
+
+#endif // MGEN_INSTRUMENT_H
@@ -1,7 +1,11 @@
 /**
- * Simple hash map for int → int mappings
- * Clean, type-safe implementation for code generation
+ * Open-addressing hash map for int → int mappings
+ * Swiss-table layout: keys and values live inline in one flat slot array,
+ * with one control byte per slot that is probed a whole group at a time
+ * (SSE2 on x86, NEON on ARM, portable scalar loop elsewhere).
  * stb-library style: static functions for single-file output
+ *
+ * Define MGEN_NO_SIMD to force the portable probing path.
  */
 
 #ifndef MGEN_MAP_INT_INT_H
@@ -9,261 +13,492 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+#if !defined(MGEN_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define MGEN_MAP_INT_INT_SSE2 1
+#elif !defined(MGEN_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define MGEN_MAP_INT_INT_NEON 1
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Hash map entry for separate chaining
-typedef struct mgen_map_int_int_entry {
-    int key;
-    int value;
-    struct mgen_map_int_int_entry* next;
-} mgen_map_int_int_entry_t;
+// Slot storage: key and value stored inline, no per-entry allocation
+// first/second alias key/value so iterator refs read like STC's (it.ref->first)
+typedef struct {
+    union { int key; int first; };
+    union { int value; int second; };
+} mgen_map_int_int_slot_t;
 
 // Hash map structure (STC-compatible naming)
 typedef struct {
-    mgen_map_int_int_entry_t** buckets;
-    size_t bucket_count;
-    size_t size;
+    int8_t* ctrl;                    // One control byte per slot: EMPTY, DELETED or 7-bit hash tag
+    mgen_map_int_int_slot_t* slots;  // Slot array (owns the single backing allocation)
+    size_t capacity;                 // Number of slots (power of two, multiple of the group width)
+    size_t size;                     // Number of live entries
+    size_t growth_left;              // EMPTY slots that can still be claimed before a rehash
 } map_int_int;
 
-/**
- * Create a new int→int map
- * Initial capacity defaults to 16 buckets
- */
+// Cursor over live slots: a linear scan of the slot array (STC-compatible)
+typedef struct {
+    mgen_map_int_int_slot_t* ref;  // Current entry, NULL once past the end
+    const map_int_int* map;
+    size_t index;
+} map_int_int_iter;
 
 /**
- * Insert or update a key-value pair
- * Returns true if inserted (new key), false if updated existing key
+ * Open-addressing hash map for int → int - Implementation
+ * STC-compatible naming for drop-in replacement
  */
 
-/**
- * Get value for a key
- * Returns pointer to value if found, NULL if not found
- */
+#include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MGEN_MAP_INT_INT_EMPTY ((int8_t)-128)
+#define MGEN_MAP_INT_INT_DELETED ((int8_t)-2)
+#define MGEN_MAP_INT_INT_MIN_CAPACITY 16
+
+// Group width is the number of control bytes compared per probe step.
+// LANE_SHIFT converts a bit index in a match mask into a slot offset.
+#if defined(MGEN_MAP_INT_INT_SSE2)
+#define MGEN_MAP_INT_INT_GROUP_WIDTH 16
+#define MGEN_MAP_INT_INT_LANE_SHIFT 0
+#elif defined(MGEN_MAP_INT_INT_NEON)
+#define MGEN_MAP_INT_INT_GROUP_WIDTH 8
+#define MGEN_MAP_INT_INT_LANE_SHIFT 3
+#else
+#define MGEN_MAP_INT_INT_GROUP_WIDTH 8
+#define MGEN_MAP_INT_INT_LANE_SHIFT 0
+#endif
 
-/**
- * Check if key exists in map
- */
+typedef uint64_t mgen_map_int_int_mask_t;
 
 /**
- * Remove a key-value pair
- * Returns true if removed, false if key didn't exist
+ * Bitmask of slots in a group whose control byte equals tag
  */
+static inline mgen_map_int_int_mask_t map_int_int_group_match(const int8_t* group, int8_t tag) {
+#if defined(MGEN_MAP_INT_INT_SSE2)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (mgen_map_int_int_mask_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#elif defined(MGEN_MAP_INT_INT_NEON)
+    uint8x8_t eq = vceq_u8(vld1_u8((const uint8_t*)group), vdup_n_u8((uint8_t)tag));
+    return vget_lane_u64(vreinterpret_u64_u8(eq), 0) & 0x8080808080808080ULL;
+#else
+    mgen_map_int_int_mask_t mask = 0;
+    for (int i = 0; i < MGEN_MAP_INT_INT_GROUP_WIDTH; i++) {
+        if (group[i] == tag) {
+            mask |= (mgen_map_int_int_mask_t)1 << i;
+        }
+    }
+    return mask;
+#endif
+}
 
 /**
- * Get number of entries in map
+ * Bitmask of slots in a group that are EMPTY or DELETED (high bit set)
  */
+static inline mgen_map_int_int_mask_t map_int_int_group_match_free(const int8_t* group) {
+#if defined(MGEN_MAP_INT_INT_SSE2)
+    return (mgen_map_int_int_mask_t)(uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#elif defined(MGEN_MAP_INT_INT_NEON)
+    uint8x8_t neg = vclt_s8(vld1_s8(group), vdup_n_s8(0));
+    return vget_lane_u64(vreinterpret_u64_u8(neg), 0) & 0x8080808080808080ULL;
+#else
+    mgen_map_int_int_mask_t mask = 0;
+    for (int i = 0; i < MGEN_MAP_INT_INT_GROUP_WIDTH; i++) {
+        if (group[i] < 0) {
+            mask |= (mgen_map_int_int_mask_t)1 << i;
+        }
+    }
+    return mask;
+#endif
+}
 
 /**
- * Check if map is empty
+ * Slot offset within a group of the lowest set bit in a match mask
  */
+static inline size_t map_int_int_mask_lowest(mgen_map_int_int_mask_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(mask) >> MGEN_MAP_INT_INT_LANE_SHIFT;
+#else
+    size_t bit = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit >> MGEN_MAP_INT_INT_LANE_SHIFT;
+#endif
+}
 
 /**
- * Clear all entries (keep buckets allocated)
+ * Hash function for integers (64-bit finalizer mix)
+ * Low 7 bits become the control tag, the rest select the probe group.
  */
+static inline uint64_t map_int_int_hash(int key) {
+    uint64_t h = (uint64_t)(uint32_t)key;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
 
 /**
- * Free all memory (STC-compatible drop function)
+ * Maximum number of live entries for a capacity (7/8 load factor)
  */
+static inline size_t map_int_int_max_load(size_t capacity) {
+    return capacity - capacity / 8;
+}
 
 /**
- * Simple hash map for int → int - Implementation
- * STC-compatible naming for drop-in replacement
+ * Allocate empty table storage: slots and control bytes share one block
  */
+static bool map_int_int_alloc(map_int_int* map, size_t capacity) {
+    size_t slot_bytes = capacity * sizeof(mgen_map_int_int_slot_t);
+    MGEN_PROFILE_ALLOC(slot_bytes + capacity);
+    unsigned char* block = malloc(slot_bytes + capacity);
+    if (!block) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate map slots");
+        return false;
+    }
 
-#include "mgen_error_handling.h"
-#include <stdlib.h>
-
-#define DEFAULT_BUCKET_COUNT 16
+    map->slots = (mgen_map_int_int_slot_t*)block;
+    map->ctrl = (int8_t*)(block + slot_bytes);
+    memset(map->ctrl, (unsigned char)MGEN_MAP_INT_INT_EMPTY, capacity);
+    map->capacity = capacity;
+    map->size = 0;
+    map->growth_left = map_int_int_max_load(capacity);
+    return true;
+}
 
 /**
- * Simple hash function for integers
+ * Find the slot holding key; returns map->capacity if absent
  */
-static size_t map_int_int_hash(int key, size_t bucket_count) {
-    // For integers, use modulo with handling for negative values
-    unsigned int u = (key < 0) ? (unsigned int)(-key) : (unsigned int)key;
-    return u % bucket_count;
+static size_t map_int_int_find_index(const map_int_int* map, int key, uint64_t hash) {
+    size_t group_mask = map->capacity / MGEN_MAP_INT_INT_GROUP_WIDTH - 1;
+    size_t group = (size_t)(hash >> 7) & group_mask;
+    int8_t tag = (int8_t)(hash & 0x7F);
+
+    // Triangular probing visits every group exactly once (group count is a power of two)
+    for (size_t step = 1; step <= group_mask + 1; step++) {
+        size_t base = group * MGEN_MAP_INT_INT_GROUP_WIDTH;
+        const int8_t* ctrl = map->ctrl + base;
+
+        mgen_map_int_int_mask_t match = map_int_int_group_match(ctrl, tag);
+        while (match) {
+            size_t index = base + map_int_int_mask_lowest(match);
+            if (map->slots[index].key == key) {
+                return index;
+            }
+            match &= match - 1;
+        }
+
+        // An EMPTY slot ends the probe sequence: the key was never placed further along
+        if (map_int_int_group_match(ctrl, MGEN_MAP_INT_INT_EMPTY)) {
+            break;
+        }
+        group = (group + step) & group_mask;
+    }
+
+    return map->capacity;
 }
 
 /**
- * Create a new entry
+ * Find the first EMPTY or DELETED slot along the probe sequence for hash
  */
-static mgen_map_int_int_entry_t* map_int_int_entry_new(int key, int value) {
-    mgen_map_int_int_entry_t* entry = malloc(sizeof(mgen_map_int_int_entry_t));
-    if (!entry) {
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate map entry");
-        return NULL;
+static size_t map_int_int_find_free(const map_int_int* map, uint64_t hash) {
+    size_t group_mask = map->capacity / MGEN_MAP_INT_INT_GROUP_WIDTH - 1;
+    size_t group = (size_t)(hash >> 7) & group_mask;
+
+    for (size_t step = 1;; step++) {
+        size_t base = group * MGEN_MAP_INT_INT_GROUP_WIDTH;
+        mgen_map_int_int_mask_t free_mask = map_int_int_group_match_free(map->ctrl + base);
+        if (free_mask) {
+            return base + map_int_int_mask_lowest(free_mask);
+        }
+        group = (group + step) & group_mask;
     }
-    entry->key = key;
-    entry->value = value;
-    entry->next = NULL;
-    return entry;
 }
 
 /**
- * Free an entry chain
+ * Rebuild the table at new_capacity, dropping all DELETED markers
  */
-static void map_int_int_entry_free(mgen_map_int_int_entry_t* entry) {
-    while (entry) {
-        mgen_map_int_int_entry_t* next = entry->next;
-        free(entry);
-        entry = next;
+static bool map_int_int_rehash(map_int_int* map, size_t new_capacity) {
+    map_int_int old = *map;
+    if (!map_int_int_alloc(map, new_capacity)) {
+        *map = old;
+        return false;
     }
+
+    for (size_t i = 0; i < old.capacity; i++) {
+        if (old.ctrl[i] >= 0) {
+            uint64_t hash = map_int_int_hash(old.slots[i].key);
+            size_t index = map_int_int_find_free(map, hash);
+            map->ctrl[index] = (int8_t)(hash & 0x7F);
+            map->slots[index] = old.slots[i];
+        }
+    }
+    map->size = old.size;
+    map->growth_left -= old.size;
+
+    free(old.slots);
+    return true;
 }
 
+/**
+ * Create a new int→int map
+ * Initial capacity defaults to 16 slots
+ */
 static map_int_int map_int_int_init(void) {
-    map_int_int map;
-    map.bucket_count = DEFAULT_BUCKET_COUNT;
-    map.size = 0;
-    map.buckets = calloc(DEFAULT_BUCKET_COUNT, sizeof(mgen_map_int_int_entry_t*));
-    if (!map.buckets) {
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate map buckets");
-        map.bucket_count = 0;
-    }
+    map_int_int map = {0};
+    map_int_int_alloc(&map, MGEN_MAP_INT_INT_MIN_CAPACITY);
     return map;
 }
 
-static bool map_int_int_insert(map_int_int* map, int key, int value) {
+/**
+ * Reserve room for at least count entries without further rehashing
+ */
+static bool map_int_int_reserve(map_int_int* map, size_t count) {
     if (!map) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map");
         return false;
     }
 
+    size_t capacity = MGEN_MAP_INT_INT_MIN_CAPACITY;
+    while (map_int_int_max_load(capacity) < count) {
+        capacity *= 2;
+    }
+
+    if (!map->ctrl) {
+        return map_int_int_alloc(map, capacity);
+    }
+    if (capacity <= map->capacity) {
+        return true;
+    }
+    return map_int_int_rehash(map, capacity);
+}
+
+/**
+ * Find the slot of key, adding it with value if absent (*inserted tells which)
+ * Returns the slot index, or map->capacity if the table cannot grow
+ */
+static size_t map_int_int_find_or_add(map_int_int* map, int key, int value, bool* inserted) {
+    *inserted = false;
+
     // Lazy initialization for {0}-initialized maps
-    if (!map->buckets) {
-        map->bucket_count = DEFAULT_BUCKET_COUNT;
-        map->buckets = calloc(DEFAULT_BUCKET_COUNT, sizeof(mgen_map_int_int_entry_t*));
-        if (!map->buckets) {
-            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate map buckets");
-            map->bucket_count = 0;
-            return false;
-        }
+    if (!map->ctrl && !map_int_int_alloc(map, MGEN_MAP_INT_INT_MIN_CAPACITY)) {
+        return map->capacity;
     }
 
-    size_t index = map_int_int_hash(key, map->bucket_count);
+    uint64_t hash = map_int_int_hash(key);
+    size_t index = map_int_int_find_index(map, key, hash);
+    if (index != map->capacity) {
+        return index;
+    }
 
-    // Check if key already exists
-    mgen_map_int_int_entry_t* entry = map->buckets[index];
-    while (entry) {
-        if (entry->key == key) {
-            // Update existing value
-            entry->value = value;
-            return false; // Updated, not inserted
+    index = map_int_int_find_free(map, hash);
+    if (map->ctrl[index] == MGEN_MAP_INT_INT_EMPTY && map->growth_left == 0) {
+        // Out of EMPTY slots: double when genuinely full, otherwise just purge tombstones
+        size_t new_capacity = map->size >= map_int_int_max_load(map->capacity) / 2 ? map->capacity * 2 : map->capacity;
+        if (!map_int_int_rehash(map, new_capacity)) {
+            return map->capacity;
         }
-        entry = entry->next;
+        index = map_int_int_find_free(map, hash);
     }
 
-    // Insert new entry at head of chain
-    mgen_map_int_int_entry_t* new_entry = map_int_int_entry_new(key, value);
-    if (!new_entry) {
-        return false;
+    if (map->ctrl[index] == MGEN_MAP_INT_INT_EMPTY) {
+        map->growth_left--;
     }
-
-    new_entry->next = map->buckets[index];
-    map->buckets[index] = new_entry;
+    map->ctrl[index] = (int8_t)(hash & 0x7F);
+    map->slots[index].key = key;
+    map->slots[index].value = value;
     map->size++;
 
-    return true; // Inserted
+    *inserted = true;
+    return index;
 }
 
-static int* map_int_int_get(map_int_int* map, int key) {
-    if (!map || !map->buckets) {
-        return NULL;
+/**
+ * Insert or update a key-value pair
+ * Returns true if inserted (new key), false if updated existing key
+ */
+static bool map_int_int_insert(map_int_int* map, int key, int value) {
+    if (!map) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map");
+        return false;
     }
 
-    size_t index = map_int_int_hash(key, map->bucket_count);
+    bool inserted;
+    size_t index = map_int_int_find_or_add(map, key, value, &inserted);
+    if (index != map->capacity && !inserted) {
+        // Update existing value
+        map->slots[index].value = value;
+    }
+    return inserted;
+}
 
-    mgen_map_int_int_entry_t* entry = map->buckets[index];
-    while (entry) {
-        if (entry->key == key) {
-            return &entry->value;
-        }
-        entry = entry->next;
+/**
+ * Get the value for key, inserting default_value first if absent
+ * A counting update is one probe: *map_int_int_get_or_insert(&map, key, 0) += 1;
+ * Returns NULL for a NULL map or if the table cannot grow
+ */
+static int* map_int_int_get_or_insert(map_int_int* map, int key, int default_value) {
+    if (!map) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map");
+        return NULL;
     }
 
-    return NULL;
+    bool inserted;
+    size_t index = map_int_int_find_or_add(map, key, default_value, &inserted);
+    return index != map->capacity ? &map->slots[index].value : NULL;
 }
 
-static bool map_int_int_contains(const map_int_int* map, int key) {
-    if (!map || !map->buckets) {
-        return false;
+/**
+ * Get value for a key
+ * Returns pointer to value if found, NULL if not found
+ */
+static int* map_int_int_get(map_int_int* map, int key) {
+    if (!map || !map->ctrl) {
+        return NULL;
     }
 
-    size_t index = map_int_int_hash(key, map->bucket_count);
+    size_t index = map_int_int_find_index(map, key, map_int_int_hash(key));
+    return index != map->capacity ? &map->slots[index].value : NULL;
+}
 
-    mgen_map_int_int_entry_t* entry = map->buckets[index];
-    while (entry) {
-        if (entry->key == key) {
-            return true;
-        }
-        entry = entry->next;
+/**
+ * Check if key exists in map
+ */
+static bool map_int_int_contains(const map_int_int* map, int key) {
+    if (!map || !map->ctrl) {
+        return false;
     }
 
-    return false;
+    return map_int_int_find_index(map, key, map_int_int_hash(key)) != map->capacity;
 }
 
+/**
+ * Remove a key-value pair
+ * Returns true if removed, false if key didn't exist
+ */
 static bool map_int_int_remove(map_int_int* map, int key) {
-    if (!map || !map->buckets) {
-        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL or uninitialized map");
+    if (!map) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map");
+        return false;
+    }
+    if (!map->ctrl) {
         return false;
     }
 
-    size_t index = map_int_int_hash(key, map->bucket_count);
+    size_t index = map_int_int_find_index(map, key, map_int_int_hash(key));
+    if (index == map->capacity) {
+        return false; // Not found
+    }
 
-    mgen_map_int_int_entry_t** entry_ptr = &map->buckets[index];
-    while (*entry_ptr) {
-        mgen_map_int_int_entry_t* entry = *entry_ptr;
-        if (entry->key == key) {
-            *entry_ptr = entry->next;
-            free(entry);
-            map->size--;
-            return true;
-        }
-        entry_ptr = &entry->next;
+    // A group that still has an EMPTY slot has never been probed past, so the
+    // slot can go straight back to EMPTY; otherwise leave a DELETED tombstone.
+    size_t base = index & ~(size_t)(MGEN_MAP_INT_INT_GROUP_WIDTH - 1);
+    if (map_int_int_group_match(map->ctrl + base, MGEN_MAP_INT_INT_EMPTY)) {
+        map->ctrl[index] = MGEN_MAP_INT_INT_EMPTY;
+        map->growth_left++;
+    } else {
+        map->ctrl[index] = MGEN_MAP_INT_INT_DELETED;
     }
+    map->size--;
 
-    return false; // Not found
+    return true;
 }
 
+/**
+ * Get number of entries in map
+ */
 static inline size_t map_int_int_size(const map_int_int* map) {
     return map ? map->size : 0;
 }
 
+/**
+ * Check if map is empty
+ */
 static inline bool map_int_int_empty(const map_int_int* map) {
     return !map || map->size == 0;
 }
 
+/**
+ * Clear all entries (keep slots allocated)
+ */
 static inline void map_int_int_clear(map_int_int* map) {
-    if (!map || !map->buckets) {
+    if (!map || !map->ctrl) {
         return;
     }
 
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        if (map->buckets[i]) {
-            map_int_int_entry_free(map->buckets[i]);
-            map->buckets[i] = NULL;
-        }
-    }
-
+    memset(map->ctrl, (unsigned char)MGEN_MAP_INT_INT_EMPTY, map->capacity);
     map->size = 0;
+    map->growth_left = map_int_int_max_load(map->capacity);
 }
 
+/**
+ * Free all memory (STC-compatible drop function)
+ */
 static void map_int_int_drop(map_int_int* map) {
     if (!map) {
         return;
     }
 
-    map_int_int_clear(map);
-    free(map->buckets);
-    map->buckets = NULL;
-    map->bucket_count = 0;
+    free(map->slots);
+    map->slots = NULL;
+    map->ctrl = NULL;
+    map->capacity = 0;
     map->size = 0;
+    map->growth_left = 0;
 }
 
 
-// Implementation
+/**
+ * Point the cursor at the first live slot at or after its index
+ */
+static inline void map_int_int_iter_seek(map_int_int_iter* iter) {
+    const map_int_int* map = iter->map;
+    while (iter->index < map->capacity && map->ctrl[iter->index] < 0) {
+        iter->index++;
+    }
+    iter->ref = iter->index < map->capacity ? &map->slots[iter->index] : NULL;
+}
+
+/**
+ * Get iterator to beginning of map
+ */
+static inline map_int_int_iter map_int_int_begin(const map_int_int* map) {
+    map_int_int_iter iter = {NULL, map, 0};
+    if (map && map->ctrl) {
+        map_int_int_iter_seek(&iter);
+    }
+    return iter;
+}
+
+/**
+ * Advance iterator to next entry
+ */
+static inline void map_int_int_next(map_int_int_iter* iter) {
+    if (iter->ref) {
+        iter->index++;
+        map_int_int_iter_seek(iter);
+    }
+}
+
+/**
+ * Get past-the-end iterator (ref is NULL)
+ */
+static inline map_int_int_iter map_int_int_end(const map_int_int* map) {
+    map_int_int_iter iter = {NULL, map, map ? map->capacity : 0};
+    return iter;
+}
 
 #ifdef __cplusplus
 }
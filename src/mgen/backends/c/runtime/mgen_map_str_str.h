@@ -2,6 +2,10 @@
  * Simple hash map for string→string mappings
  * Clean, type-safe implementation for code generation
  * stb-library style: static functions for single-file output
+ *
+ * Keys and values are copied into a chunked string arena owned by the map:
+ * inserts do not malloc per string and drop/clear free O(chunks) blocks.
+ * Pointers returned by map_str_str_get stay valid until clear/drop.
  */
 
 #ifndef MGEN_MAP_STR_STR_H
@@ -9,6 +13,8 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "mgen_str_arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,60 +22,32 @@ extern "C" {
 
 // Hash map entry structure
 typedef struct {
-    char* key;
-    char* value;
-    size_t hash;
+    union { char* key; char* first; };      // Arena-owned key (first: STC-compatible alias)
+    union { char* value; char* second; };   // Arena-owned value, or NULL (second: STC alias)
+    size_t hash;                       // Cached key hash
+    uint32_t key_len;                  // Cached key length
+    uint32_t value_cap;                // Bytes available at value (reused on update)
+    char prefix[MGEN_STR_PREFIX_LEN];  // Leading key bytes for fast mismatch rejection
     bool occupied;
+    bool deleted;                      // Tombstone left by erase (keeps probe chains intact)
 } map_str_str_entry;
 
 // Hash map structure
 typedef struct {
     map_str_str_entry* buckets;
     size_t size;           // Number of entries
-    size_t capacity;       // Number of buckets
+    size_t capacity;       // Number of buckets (power of two)
+    size_t tombstones;     // Number of deleted buckets
+    uint64_t seed;         // Key hash seed (see mgen_str_hash.h)
+    mgen_str_arena_t arena;  // Storage for all keys and values
 } map_str_str;
 
-/**
- * Create a new string→string map
- * Supports {0} initialization with lazy bucket allocation
- */
-
-/**
- * Insert or update a key-value pair
- * Takes ownership of copies of both key and value
- */
-
-/**
- * Get value for a key (returns pointer to value or NULL if not found)
- */
-
-/**
- * Check if key exists in map
- */
-
-/**
- * Get number of entries
- */
-
-/**
- * Remove a key-value pair
- */
-
-/**
- * Clear all entries (keep capacity)
- */
-
-/**
- * Free all memory
- */
-
-/**
- * Check if map is empty
- */
-
-/**
- * Reserve capacity
- */
+// Cursor over occupied buckets: a linear scan of the bucket array (STC-compatible)
+typedef struct {
+    map_str_str_entry* ref;  // Current entry, NULL once past the end
+    const map_str_str* map;
+    size_t index;
+} map_str_str_iter;
 
 /**
  * Simple hash map for string→string mappings - Implementation
@@ -77,67 +55,105 @@ typedef struct {
  */
 
 #include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
 #include <stdlib.h>
 #include <string.h>
 
-#define DEFAULT_CAPACITY 16
-#define LOAD_FACTOR 0.75
-#define GROWTH_FACTOR 2
-
-// FNV-1a hash function for strings
-static size_t hash_string(const char* str) {
-    if (!str) return 0;
-
-    size_t hash = 2166136261u;
-    while (*str) {
-        hash ^= (unsigned char)(*str++);
-        hash *= 16777619u;
-    }
-    return hash;
-}
+#define MAP_STR_STR_DEFAULT_CAPACITY 16
 
+/**
+ * Create a new string→string map
+ * Supports {0} initialization with lazy bucket allocation
+ */
 static map_str_str map_str_str_init(void) {
-    map_str_str map;
-    map.buckets = NULL;  // Lazy allocation
-    map.size = 0;
-    map.capacity = 0;
+    map_str_str map = {0};  // Lazy allocation
     return map;
 }
 
-static void map_str_str_grow(map_str_str* map) {
-    size_t new_capacity = (map->capacity == 0) ? DEFAULT_CAPACITY : map->capacity * GROWTH_FACTOR;
-
-    // Allocate new buckets
+/**
+ * Rehash all live entries into new_capacity buckets, dropping tombstones
+ */
+static bool map_str_str_rehash(map_str_str* map, size_t new_capacity) {
+    MGEN_PROFILE_ALLOC(new_capacity * sizeof(map_str_str_entry));
     map_str_str_entry* new_buckets = calloc(new_capacity, sizeof(map_str_str_entry));
     if (!new_buckets) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow string→string map");
-        return;
+        return false;
     }
 
-    // Rehash existing entries
     if (map->buckets) {
         for (size_t i = 0; i < map->capacity; i++) {
             if (map->buckets[i].occupied) {
-                // Find new position
-                size_t hash = map->buckets[i].hash;
-                size_t idx = hash % new_capacity;
-
-                // Linear probing
+                // Linear probing from the cached hash
+                size_t idx = map->buckets[i].hash & (new_capacity - 1);
                 while (new_buckets[idx].occupied) {
-                    idx = (idx + 1) % new_capacity;
+                    idx = (idx + 1) & (new_capacity - 1);
                 }
-
-                // Move entry (transfer ownership)
                 new_buckets[idx] = map->buckets[i];
             }
         }
         free(map->buckets);
+    } else {
+        map->seed = mgen_str_hash_seed(map);
     }
 
     map->buckets = new_buckets;
     map->capacity = new_capacity;
+    map->tombstones = 0;
+    return true;
 }
 
+/**
+ * Find the bucket holding key, or NULL
+ */
+static map_str_str_entry* map_str_str_find(const map_str_str* map, const char* key, size_t hash, size_t len,
+                                           const char* prefix) {
+    size_t mask = map->capacity - 1;
+    size_t idx = hash & mask;
+
+    for (size_t probes = 0; probes < map->capacity; probes++) {
+        map_str_str_entry* entry = &map->buckets[idx];
+        if (!entry->occupied && !entry->deleted) {
+            return NULL;  // Empty slot means key not found
+        }
+        if (entry->occupied && mgen_str_key_equals(entry->hash, entry->key_len, entry->prefix, entry->key, hash,
+                                                   len, prefix, key)) {
+            return entry;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * Store value into an entry, reusing its current arena space when it fits
+ */
+static bool map_str_str_set_value(map_str_str* map, map_str_str_entry* entry, const char* value) {
+    if (!value) {
+        entry->value = NULL;
+        entry->value_cap = 0;
+        return true;
+    }
+
+    size_t len = strlen(value);
+    if (entry->value && len < entry->value_cap) {
+        memcpy(entry->value, value, len + 1);
+        return true;
+    }
+
+    char* copy = mgen_str_arena_strndup(&map->arena, value, len);
+    if (!copy) {
+        return false;
+    }
+    entry->value = copy;
+    entry->value_cap = (uint32_t)(len + 1);
+    return true;
+}
+
+/**
+ * Insert or update a key-value pair
+ * Takes ownership of copies of both key and value
+ */
 static void map_str_str_insert(map_str_str* map, const char* key, const char* value) {
     if (!map) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL string→string map");
@@ -149,193 +165,213 @@ static void map_str_str_insert(map_str_str* map, const char* key, const char* va
         return;
     }
 
-    // Lazy initialization
+    // Lazy initialization, then keep (live + deleted) buckets under 75% load
     if (map->capacity == 0) {
-        map_str_str_grow(map);
+        if (!map_str_str_rehash(map, MAP_STR_STR_DEFAULT_CAPACITY)) {
+            return;
+        }
+    } else if ((map->size + map->tombstones + 1) * 4 > map->capacity * 3) {
+        size_t new_capacity = (map->size + 1) * 2 > map->capacity ? map->capacity * 2 : map->capacity;
+        if (!map_str_str_rehash(map, new_capacity)) {
+            return;
+        }
     }
 
-    // Check load factor
-    if ((double)map->size / map->capacity > LOAD_FACTOR) {
-        map_str_str_grow(map);
-    }
+    size_t len;
+    size_t hash = mgen_str_hash(key, &len, map->seed);
+    char prefix[MGEN_STR_PREFIX_LEN];
+    mgen_str_prefix_init(prefix, key, len);
 
-    size_t hash = hash_string(key);
-    size_t idx = hash % map->capacity;
+    // Update existing key
+    map_str_str_entry* existing = map_str_str_find(map, key, hash, len, prefix);
+    if (existing) {
+        map_str_str_set_value(map, existing, value);
+        return;
+    }
 
-    // Linear probing to find slot
+    // Linear probing to the first free (empty or deleted) slot
+    size_t mask = map->capacity - 1;
+    size_t idx = hash & mask;
     while (map->buckets[idx].occupied) {
-        // Update existing key
-        if (strcmp(map->buckets[idx].key, key) == 0) {
-            free(map->buckets[idx].value);
-            map->buckets[idx].value = value ? strdup(value) : NULL;
-            return;
-        }
-        idx = (idx + 1) % map->capacity;
+        idx = (idx + 1) & mask;
     }
 
-    // Insert new entry
-    map->buckets[idx].key = strdup(key);
-    map->buckets[idx].value = value ? strdup(value) : NULL;
-    map->buckets[idx].hash = hash;
-    map->buckets[idx].occupied = true;
+    map_str_str_entry* entry = &map->buckets[idx];
+    char* key_copy = mgen_str_arena_strndup(&map->arena, key, len);
+    if (!key_copy) {
+        return;
+    }
+    if (entry->deleted) {
+        map->tombstones--;
+    }
+    entry->key = key_copy;
+    entry->value = NULL;
+    entry->value_cap = 0;
+    entry->hash = hash;
+    entry->key_len = (uint32_t)len;
+    memcpy(entry->prefix, prefix, MGEN_STR_PREFIX_LEN);
+    entry->occupied = true;
+    entry->deleted = false;
+    map_str_str_set_value(map, entry, value);
     map->size++;
 }
 
+/**
+ * Get value for a key (returns pointer to value or NULL if not found)
+ */
 static char** map_str_str_get(map_str_str* map, const char* key) {
     if (!map || !key || map->capacity == 0) {
         return NULL;
     }
 
-    size_t hash = hash_string(key);
-    size_t idx = hash % map->capacity;
-    size_t start_idx = idx;
-
-    // Linear probing to find key
-    do {
-        if (map->buckets[idx].occupied) {
-            if (strcmp(map->buckets[idx].key, key) == 0) {
-                return &map->buckets[idx].value;
-            }
-        } else {
-            // Empty slot means key not found
-            return NULL;
-        }
-        idx = (idx + 1) % map->capacity;
-    } while (idx != start_idx);
+    size_t len;
+    size_t hash = mgen_str_hash(key, &len, map->seed);
+    char prefix[MGEN_STR_PREFIX_LEN];
+    mgen_str_prefix_init(prefix, key, len);
 
-    return NULL;
+    map_str_str_entry* entry = map_str_str_find(map, key, hash, len, prefix);
+    return entry ? &entry->value : NULL;
 }
 
+/**
+ * Check if key exists in map
+ */
 static bool map_str_str_contains(map_str_str* map, const char* key) {
     return map_str_str_get(map, key) != NULL;
 }
 
+/**
+ * Get number of entries
+ */
 static inline size_t map_str_str_size(const map_str_str* map) {
     return map ? map->size : 0;
 }
 
+/**
+ * Remove a key-value pair
+ * The strings stay in the arena until the map is cleared or dropped
+ */
 static void map_str_str_erase(map_str_str* map, const char* key) {
     if (!map || !key || map->capacity == 0) {
         return;
     }
 
-    size_t hash = hash_string(key);
-    size_t idx = hash % map->capacity;
-    size_t start_idx = idx;
-
-    // Linear probing to find key
-    do {
-        if (map->buckets[idx].occupied) {
-            if (strcmp(map->buckets[idx].key, key) == 0) {
-                // Free strings and mark as unoccupied
-                free(map->buckets[idx].key);
-                free(map->buckets[idx].value);
-                map->buckets[idx].key = NULL;
-                map->buckets[idx].value = NULL;
-                map->buckets[idx].occupied = false;
-                map->size--;
-                return;
-            }
-        } else {
-            // Empty slot means key not found
-            return;
-        }
-        idx = (idx + 1) % map->capacity;
-    } while (idx != start_idx);
+    size_t len;
+    size_t hash = mgen_str_hash(key, &len, map->seed);
+    char prefix[MGEN_STR_PREFIX_LEN];
+    mgen_str_prefix_init(prefix, key, len);
+
+    map_str_str_entry* entry = map_str_str_find(map, key, hash, len, prefix);
+    if (entry) {
+        entry->key = NULL;
+        entry->value = NULL;
+        entry->occupied = false;
+        entry->deleted = true;
+        map->size--;
+        map->tombstones++;
+    }
 }
 
+/**
+ * Clear all entries (keep capacity and the largest arena chunk)
+ */
 static inline void map_str_str_clear(map_str_str* map) {
     if (!map || !map->buckets) {
         return;
     }
 
-    // Free all strings
-    for (size_t i = 0; i < map->capacity; i++) {
-        if (map->buckets[i].occupied) {
-            free(map->buckets[i].key);
-            free(map->buckets[i].value);
-            map->buckets[i].key = NULL;
-            map->buckets[i].value = NULL;
-            map->buckets[i].occupied = false;
-        }
-    }
-
+    memset(map->buckets, 0, map->capacity * sizeof(map_str_str_entry));
+    mgen_str_arena_reset(&map->arena);
     map->size = 0;
+    map->tombstones = 0;
 }
 
+/**
+ * Free all memory
+ */
 static void map_str_str_drop(map_str_str* map) {
     if (!map) {
         return;
     }
 
-    // Free all strings
-    if (map->buckets) {
-        for (size_t i = 0; i < map->capacity; i++) {
-            if (map->buckets[i].occupied) {
-                free(map->buckets[i].key);
-                free(map->buckets[i].value);
-            }
-        }
-        free(map->buckets);
-    }
+    free(map->buckets);
+    mgen_str_arena_drop(&map->arena);
 
     map->buckets = NULL;
     map->size = 0;
     map->capacity = 0;
+    map->tombstones = 0;
 }
 
+/**
+ * Check if map is empty
+ */
 static inline bool map_str_str_empty(const map_str_str* map) {
     return !map || map->size == 0;
 }
 
+/**
+ * Reserve capacity
+ */
 static void map_str_str_reserve(map_str_str* map, size_t new_capacity) {
     if (!map) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL string→string map");
         return;
     }
 
-    if (new_capacity <= map->capacity) {
+    // Round up to a power of two so probing can mask instead of divide
+    size_t capacity = MAP_STR_STR_DEFAULT_CAPACITY;
+    while (capacity < new_capacity) {
+        capacity *= 2;
+    }
+
+    if (capacity <= map->capacity) {
         return;
     }
 
-    // Save old state
-    map_str_str_entry* old_buckets = map->buckets;
-    size_t old_capacity = map->capacity;
+    map_str_str_rehash(map, capacity);
+}
 
-    // Allocate new buckets
-    map->buckets = calloc(new_capacity, sizeof(map_str_str_entry));
-    if (!map->buckets) {
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to reserve capacity");
-        map->buckets = old_buckets;  // Restore
-        return;
+
+/**
+ * Point the cursor at the first occupied bucket at or after its index
+ */
+static inline void map_str_str_iter_seek(map_str_str_iter* iter) {
+    const map_str_str* map = iter->map;
+    while (iter->index < map->capacity && !map->buckets[iter->index].occupied) {
+        iter->index++;
     }
-    map->capacity = new_capacity;
-    map->size = 0;  // Will be incremented during rehash
-
-    // Rehash existing entries
-    if (old_buckets) {
-        for (size_t i = 0; i < old_capacity; i++) {
-            if (old_buckets[i].occupied) {
-                // Find new position
-                size_t hash = old_buckets[i].hash;
-                size_t idx = hash % new_capacity;
-
-                // Linear probing
-                while (map->buckets[idx].occupied) {
-                    idx = (idx + 1) % new_capacity;
-                }
+    iter->ref = iter->index < map->capacity ? &map->buckets[iter->index] : NULL;
+}
 
-                // Move entry (transfer ownership)
-                map->buckets[idx] = old_buckets[i];
-                map->size++;
-            }
-        }
-        free(old_buckets);
+/**
+ * Get iterator to beginning of map
+ */
+static inline map_str_str_iter map_str_str_begin(const map_str_str* map) {
+    map_str_str_iter iter = {NULL, map, 0};
+    if (map && map->buckets) {
+        map_str_str_iter_seek(&iter);
     }
+    return iter;
 }
 
+/**
+ * Advance iterator to next entry
+ */
+static inline void map_str_str_next(map_str_str_iter* iter) {
+    if (iter->ref) {
+        iter->index++;
+        map_str_str_iter_seek(iter);
+    }
+}
 
-// Implementation
+/**
+ * Get past-the-end iterator (ref is NULL)
+ */
+static inline map_str_str_iter map_str_str_end(const map_str_str* map) {
+    map_str_str_iter iter = {NULL, map, map ? map->capacity : 0};
+    return iter;
+}
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,284 @@
+/**
+ * Row-major 2D matrix of int
+ * Clean, type-safe implementation for code generation
+ * stb-library style: static functions for single-file output
+ *
+ * Replaces vec_vec_int for rectangular matrices: all elements live in one
+ * contiguous buffer, element (i, j) is at data[i * stride + j], and a row
+ * access is an offset computation instead of a pointer load into a separately
+ * allocated row. Views share the parent's buffer and stride.
+ */
+
+#ifndef MGEN_MAT_INT_H
+#define MGEN_MAT_INT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Row-major matrix structure
+typedef struct {
+    int* data;            // Element (i, j) is data[i * stride + j]
+    size_t rows;          // Number of rows
+    size_t cols;          // Number of columns
+    size_t stride;        // Elements between the starts of consecutive rows
+    size_t row_capacity;  // Rows allocated
+    bool owns_data;       // False for views into another matrix
+} mat_int;
+
+/**
+ * Row-major 2D matrix of int - Implementation
+ */
+
+#include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAT_INT_DEFAULT_ROW_CAPACITY 8
+#define MAT_INT_GROWTH_FACTOR 2
+
+// Tile edge for mat_int_matmul: three tiles of ints stay resident in L1/L2
+#ifndef MAT_INT_BLOCK
+#define MAT_INT_BLOCK 64
+#endif
+
+/**
+ * Create a rows x cols matrix with every element set to value
+ */
+static mat_int mat_int_new(size_t rows, size_t cols, int value) {
+    mat_int m = {0};
+    if (cols != 0 && rows > SIZE_MAX / sizeof(int) / cols) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Matrix dimensions too large");
+        return m;
+    }
+
+    m.cols = cols;
+    m.stride = cols;
+    m.owns_data = true;
+    if (rows == 0 || cols == 0) {
+        m.rows = rows;
+        return m;
+    }
+
+    MGEN_PROFILE_ALLOC(rows * cols * sizeof(int));
+    m.data = malloc(rows * cols * sizeof(int));
+    if (!m.data) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate matrix");
+        return m;
+    }
+
+    for (size_t i = 0; i < rows * cols; i++) {
+        m.data[i] = value;
+    }
+    m.rows = rows;
+    m.row_capacity = rows;
+    return m;
+}
+
+static bool mat_int_reserve_rows(mat_int* m, size_t row_capacity) {
+    if (row_capacity <= m->row_capacity) {
+        return true;
+    }
+    if (m->stride != 0 && row_capacity > SIZE_MAX / sizeof(int) / m->stride) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Matrix dimensions too large");
+        return false;
+    }
+
+    MGEN_PROFILE_ALLOC(row_capacity * m->stride * sizeof(int));
+    int* new_data = realloc(m->data, row_capacity * m->stride * sizeof(int));
+    if (!new_data) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow matrix");
+        return false;
+    }
+    m->data = new_data;
+    m->row_capacity = row_capacity;
+    return true;
+}
+
+/**
+ * Append a row of count values
+ * The first row fixes the column count; later rows must match it
+ */
+static void mat_int_append_row(mat_int* m, const int* values, size_t count) {
+    if (!m) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL matrix");
+        return;
+    }
+    if (m->data && !m->owns_data) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Cannot append to a matrix view");
+        return;
+    }
+
+    if (m->rows == 0 && m->row_capacity == 0) {
+        m->cols = count;
+        m->stride = count;
+        m->owns_data = true;
+    } else if (count != m->cols) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Matrix row length does not match column count");
+        return;
+    }
+
+    if (m->rows >= m->row_capacity) {
+        size_t new_capacity =
+            (m->row_capacity == 0) ? MAT_INT_DEFAULT_ROW_CAPACITY : m->row_capacity * MAT_INT_GROWTH_FACTOR;
+        if (!mat_int_reserve_rows(m, new_capacity)) {
+            return;
+        }
+    }
+
+    if (count != 0) {
+        memcpy(m->data + m->rows * m->stride, values, count * sizeof(int));
+    }
+    m->rows++;
+}
+
+/**
+ * Get pointer to element (i, j)
+ * Returns NULL (and sets MGEN_ERROR_INDEX) if out of bounds
+ */
+static int* mat_int_at(mat_int* m, size_t i, size_t j) {
+    if (!m) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL matrix");
+        return NULL;
+    }
+
+    if (i >= m->rows || j >= m->cols) {
+        MGEN_SET_ERROR(MGEN_ERROR_INDEX, "Matrix index out of bounds");
+        return NULL;
+    }
+
+    return &m->data[i * m->stride + j];
+}
+
+/**
+ * Get pointer to the first element of row i (cols contiguous elements)
+ */
+static int* mat_int_row(mat_int* m, size_t i) {
+    if (!m) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL matrix");
+        return NULL;
+    }
+
+    if (i >= m->rows) {
+        MGEN_SET_ERROR(MGEN_ERROR_INDEX, "Matrix row out of bounds");
+        return NULL;
+    }
+
+    return &m->data[i * m->stride];
+}
+
+/**
+ * Get number of rows
+ */
+static inline size_t mat_int_rows(const mat_int* m) {
+    return m ? m->rows : 0;
+}
+
+/**
+ * Get number of columns
+ */
+static inline size_t mat_int_cols(const mat_int* m) {
+    return m ? m->cols : 0;
+}
+
+/**
+ * View rows x cols elements starting at (row, col) without copying
+ * The view keeps the parent's stride and is invalidated when the parent grows or is dropped
+ */
+static mat_int mat_int_view(mat_int* m, size_t row, size_t col, size_t rows, size_t cols) {
+    mat_int view = {0};
+    if (!m) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL matrix");
+        return view;
+    }
+
+    if (row > m->rows || rows > m->rows - row || col > m->cols || cols > m->cols - col) {
+        MGEN_SET_ERROR(MGEN_ERROR_INDEX, "Matrix view out of bounds");
+        return view;
+    }
+
+    view.data = (rows != 0 && cols != 0) ? &m->data[row * m->stride + col] : NULL;
+    view.rows = rows;
+    view.cols = cols;
+    view.stride = m->stride;
+    view.owns_data = false;
+    return view;
+}
+
+/**
+ * Multiply a (n x k) by b (k x m) into a new n x m matrix
+ * Tiled i-k-j loop: the innermost loop streams contiguous rows of b and the result
+ */
+static mat_int mat_int_matmul(const mat_int* a, const mat_int* b) {
+    mat_int result = {0};
+    if (!a || !b) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL matrix");
+        return result;
+    }
+
+    if (a->cols != b->rows) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Matrix dimensions do not match for multiplication");
+        return result;
+    }
+
+    result = mat_int_new(a->rows, b->cols, 0);
+    if (!result.data) {
+        return result;
+    }
+
+    size_t n = a->rows;
+    size_t inner = a->cols;
+    size_t m = b->cols;
+    for (size_t ii = 0; ii < n; ii += MAT_INT_BLOCK) {
+        size_t i_end = (ii + MAT_INT_BLOCK < n) ? ii + MAT_INT_BLOCK : n;
+        for (size_t kk = 0; kk < inner; kk += MAT_INT_BLOCK) {
+            size_t k_end = (kk + MAT_INT_BLOCK < inner) ? kk + MAT_INT_BLOCK : inner;
+            for (size_t jj = 0; jj < m; jj += MAT_INT_BLOCK) {
+                size_t j_end = (jj + MAT_INT_BLOCK < m) ? jj + MAT_INT_BLOCK : m;
+                for (size_t i = ii; i < i_end; i++) {
+                    int* out = &result.data[i * result.stride];
+                    const int* a_row = &a->data[i * a->stride];
+                    for (size_t k = kk; k < k_end; k++) {
+                        int a_ik = a_row[k];
+                        const int* b_row = &b->data[k * b->stride];
+                        for (size_t j = jj; j < j_end; j++) {
+                            out[j] += a_ik * b_row[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Free all memory (STC-compatible drop function)
+ * Views only forget the borrowed buffer
+ */
+static void mat_int_drop(mat_int* m) {
+    if (!m) {
+        return;
+    }
+
+    if (m->owns_data) {
+        free(m->data);
+    }
+    m->data = NULL;
+    m->rows = 0;
+    m->cols = 0;
+    m->stride = 0;
+    m->row_capacity = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_MAT_INT_H
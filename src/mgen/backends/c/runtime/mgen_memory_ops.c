@@ -4,17 +4,26 @@
 
 #include "mgen_memory_ops.h"
 #include <stdarg.h>
+#include <stdint.h>
 
 // Memory tracking globals
 static int memory_tracking_enabled = 0;
 static mgen_memory_stats_t memory_stats = {0};
 
-// Memory pool structure
-struct mgen_memory_pool {
-    char* data;
-    size_t size;
+// Memory pool chunk: chunks are never moved or resized once handed out
+typedef struct mgen_pool_chunk {
+    struct mgen_pool_chunk* next;
     size_t capacity;
     size_t used;
+    char data[];
+} mgen_pool_chunk_t;
+
+// Memory pool structure
+struct mgen_memory_pool {
+    mgen_pool_chunk_t* head;       // Chunk currently being bump-allocated from
+    size_t next_chunk_size;
+    size_t size;                   // Live allocations
+    void* free_lists[MGEN_POOL_SIZE_CLASSES];  // Released blocks by size class
 };
 
 // Scope allocator structure
@@ -24,10 +33,13 @@ typedef struct alloc_entry {
 } alloc_entry_t;
 
 struct mgen_scope_allocator {
-    alloc_entry_t* head;
+    mgen_memory_pool_t* pool;  // Backing arena (created on first use)
+    alloc_entry_t* head;       // Registered heap pointers
     size_t count;
 };
 
+#define MGEN_SCOPE_POOL_SIZE 4096
+
 // Safe memory allocation functions
 void* mgen_malloc(size_t size) {
     if (size == 0) {
@@ -178,75 +190,154 @@ mgen_error_t mgen_memset_safe(void* dest, int value, size_t count, size_t dest_s
 }
 
 // Memory pool implementation
+static mgen_pool_chunk_t* mgen_pool_chunk_new(size_t capacity) {
+    mgen_pool_chunk_t* chunk = malloc(sizeof(mgen_pool_chunk_t) + capacity);
+    if (!chunk) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory pool chunk");
+        return NULL;
+    }
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    return chunk;
+}
+
+// Offset of the first alignment-aligned byte at or after chunk->data + chunk->used
+static size_t mgen_pool_chunk_offset(const mgen_pool_chunk_t* chunk, size_t alignment) {
+    uintptr_t cursor = (uintptr_t)(chunk->data + chunk->used);
+    uintptr_t aligned = (cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    return chunk->used + (size_t)(aligned - cursor);
+}
+
 mgen_memory_pool_t* mgen_memory_pool_new(size_t initial_size) {
     if (initial_size == 0) {
         initial_size = 4096; // Default 4KB
     }
 
-    mgen_memory_pool_t* pool = malloc(sizeof(mgen_memory_pool_t));
+    mgen_memory_pool_t* pool = calloc(1, sizeof(mgen_memory_pool_t));
     if (!pool) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory pool");
         return NULL;
     }
 
-    pool->data = malloc(initial_size);
-    if (!pool->data) {
+    pool->head = mgen_pool_chunk_new(initial_size);
+    if (!pool->head) {
         free(pool);
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory pool data");
         return NULL;
     }
-
-    pool->size = 0;
-    pool->capacity = initial_size;
-    pool->used = 0;
+    pool->next_chunk_size = initial_size * 2;
 
     return pool;
 }
 
-void* mgen_memory_pool_alloc(mgen_memory_pool_t* pool, size_t size) {
+void* mgen_memory_pool_alloc_aligned(mgen_memory_pool_t* pool, size_t size, size_t alignment) {
     if (!pool) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Memory pool is NULL");
         return NULL;
     }
 
-    // Align size to pointer boundary
-    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Memory pool alignment must be a power of two");
+        return NULL;
+    }
 
-    if (pool->used + size > pool->capacity) {
-        // Grow pool
-        size_t new_capacity = pool->capacity * 2;
-        while (new_capacity < pool->used + size) {
-            new_capacity *= 2;
-        }
+    if (size == 0) {
+        size = 1;
+    }
 
-        char* new_data = realloc(pool->data, new_capacity);
-        if (!new_data) {
-            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow memory pool");
+    mgen_pool_chunk_t* head = pool->head;
+    size_t offset = mgen_pool_chunk_offset(head, alignment);
+    if (offset > head->capacity || head->capacity - offset < size) {
+        // Start a new chunk; existing allocations stay where they are
+        size_t needed = size + alignment;
+        size_t capacity = pool->next_chunk_size > needed ? pool->next_chunk_size : needed;
+
+        mgen_pool_chunk_t* chunk = mgen_pool_chunk_new(capacity);
+        if (!chunk) {
             return NULL;
         }
 
-        pool->data = new_data;
-        pool->capacity = new_capacity;
+        if (needed > pool->next_chunk_size / 2) {
+            // Oversized request: dedicated chunk behind the head, which keeps serving small ones
+            chunk->next = head->next;
+            head->next = chunk;
+        } else {
+            chunk->next = head;
+            pool->head = chunk;
+            if (pool->next_chunk_size < MGEN_POOL_MAX_CHUNK) {
+                pool->next_chunk_size *= 2;
+            }
+        }
+
+        head = chunk;
+        offset = mgen_pool_chunk_offset(head, alignment);
     }
 
-    void* ptr = pool->data + pool->used;
-    pool->used += size;
+    head->used = offset + size;
     pool->size++;
+    return head->data + offset;
+}
 
-    return ptr;
+void* mgen_memory_pool_alloc(mgen_memory_pool_t* pool, size_t size) {
+    if (!pool) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Memory pool is NULL");
+        return NULL;
+    }
+
+    // Round up to the pool alignment; small sizes map onto a free list
+    size = size == 0 ? MGEN_POOL_ALIGNMENT : (size + MGEN_POOL_ALIGNMENT - 1) & ~(size_t)(MGEN_POOL_ALIGNMENT - 1);
+
+    size_t size_class = size / MGEN_POOL_ALIGNMENT - 1;
+    if (size_class < MGEN_POOL_SIZE_CLASSES && pool->free_lists[size_class]) {
+        void* block = pool->free_lists[size_class];
+        pool->free_lists[size_class] = *(void**)block;
+        pool->size++;
+        return block;
+    }
+
+    return mgen_memory_pool_alloc_aligned(pool, size, MGEN_POOL_ALIGNMENT);
+}
+
+void mgen_memory_pool_release(mgen_memory_pool_t* pool, void* ptr, size_t size) {
+    if (!pool || !ptr) return;
+
+    size = size == 0 ? MGEN_POOL_ALIGNMENT : (size + MGEN_POOL_ALIGNMENT - 1) & ~(size_t)(MGEN_POOL_ALIGNMENT - 1);
+    pool->size--;
+
+    // Larger blocks are simply forgotten until the next reset
+    size_t size_class = size / MGEN_POOL_ALIGNMENT - 1;
+    if (size_class < MGEN_POOL_SIZE_CLASSES) {
+        *(void**)ptr = pool->free_lists[size_class];
+        pool->free_lists[size_class] = ptr;
+    }
 }
 
 void mgen_memory_pool_reset(mgen_memory_pool_t* pool) {
     if (!pool) return;
 
-    pool->used = 0;
+    // Keep the newest (largest) chunk, release the rest
+    mgen_pool_chunk_t* chunk = pool->head->next;
+    while (chunk) {
+        mgen_pool_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    pool->head->next = NULL;
+    pool->head->used = 0;
+
+    memset(pool->free_lists, 0, sizeof(pool->free_lists));
     pool->size = 0;
 }
 
 void mgen_memory_pool_free(mgen_memory_pool_t* pool) {
     if (!pool) return;
 
-    free(pool->data);
+    mgen_pool_chunk_t* chunk = pool->head;
+    while (chunk) {
+        mgen_pool_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
     free(pool);
 }
 
@@ -258,6 +349,7 @@ mgen_scope_allocator_t* mgen_scope_new(void) {
         return NULL;
     }
 
+    scope->pool = NULL;
     scope->head = NULL;
     scope->count = 0;
 
@@ -270,15 +362,12 @@ void* mgen_scope_alloc(mgen_scope_allocator_t* scope, size_t size) {
         return NULL;
     }
 
-    void* ptr = mgen_malloc(size);
-    if (!ptr) return NULL;
-
-    if (mgen_scope_register(scope, ptr) != MGEN_OK) {
-        mgen_free(&ptr);
-        return NULL;
+    if (!scope->pool) {
+        scope->pool = mgen_memory_pool_new(MGEN_SCOPE_POOL_SIZE);
+        if (!scope->pool) return NULL;
     }
 
-    return ptr;
+    return mgen_memory_pool_alloc(scope->pool, size);
 }
 
 mgen_error_t mgen_scope_register(mgen_scope_allocator_t* scope, void* ptr) {
@@ -292,7 +381,8 @@ mgen_error_t mgen_scope_register(mgen_scope_allocator_t* scope, void* ptr) {
         return MGEN_ERROR_VALUE;
     }
 
-    alloc_entry_t* entry = malloc(sizeof(alloc_entry_t));
+    // Bookkeeping lives in the scope's own arena
+    alloc_entry_t* entry = mgen_scope_alloc(scope, sizeof(alloc_entry_t));
     if (!entry) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate scope entry");
         return MGEN_ERROR_MEMORY;
@@ -309,14 +399,11 @@ mgen_error_t mgen_scope_register(mgen_scope_allocator_t* scope, void* ptr) {
 void mgen_scope_free(mgen_scope_allocator_t* scope) {
     if (!scope) return;
 
-    alloc_entry_t* current = scope->head;
-    while (current) {
-        alloc_entry_t* next = current->next;
+    for (alloc_entry_t* current = scope->head; current; current = current->next) {
         mgen_free(&current->ptr);
-        free(current);
-        current = next;
     }
 
+    mgen_memory_pool_free(scope->pool);
     free(scope);
 }
 
@@ -349,6 +436,25 @@ int mgen_check_memory_leaks(void) {
 }
 
 // Reference counting implementation
+#ifdef MGEN_HAVE_C11_ATOMICS
+#define MGEN_RC_LOAD(count) atomic_load_explicit((count), memory_order_relaxed)
+#define MGEN_RC_STORE(count, value) atomic_store_explicit((count), (value), memory_order_relaxed)
+#define MGEN_RC_INCREMENT(count) atomic_fetch_add_explicit((count), 1, memory_order_relaxed)
+#define MGEN_RC_DECREMENT(count) atomic_fetch_sub_explicit((count), 1, memory_order_release)
+#define MGEN_RC_ACQUIRE_FENCE() atomic_thread_fence(memory_order_acquire)
+#define MGEN_RC_CAS(count, expected, desired) \
+    atomic_compare_exchange_weak_explicit((count), (expected), (desired), memory_order_acquire, memory_order_relaxed)
+#else
+// No C11 atomics: the atomic variants degrade to the plain ones
+#define MGEN_RC_LOAD(count) (*(count))
+#define MGEN_RC_STORE(count, value) (*(count) = (value))
+#define MGEN_RC_INCREMENT(count) ((*(count))++)
+#define MGEN_RC_DECREMENT(count) ((*(count))--)
+#define MGEN_RC_ACQUIRE_FENCE() ((void)0)
+#define MGEN_RC_CAS(count, expected, desired) \
+    (*(count) == *(expected) ? (*(count) = (desired), 1) : (*(expected) = *(count), 0))
+#endif
+
 mgen_refcounted_t* mgen_refcounted_new(size_t data_size, void (*destructor)(void*)) {
     mgen_refcounted_t* obj = malloc(sizeof(mgen_refcounted_t) + data_size);
     if (!obj) {
@@ -356,65 +462,184 @@ mgen_refcounted_t* mgen_refcounted_new(size_t data_size, void (*destructor)(void
         return NULL;
     }
 
-    obj->refcount = 1;
+    MGEN_RC_STORE(&obj->refcount, 1);
+    MGEN_RC_STORE(&obj->weak_count, 1);
     obj->destructor = destructor;
 
     return obj;
 }
 
+// Last strong reference is gone: destroy the data, then drop the implicit weak reference
+static void mgen_refcounted_destroy(mgen_refcounted_t* obj) {
+    if (obj->destructor) {
+        obj->destructor(obj->data);
+    }
+    mgen_weak_ref_release((mgen_weak_ref_t){obj});
+}
+
 mgen_refcounted_t* mgen_refcounted_retain(mgen_refcounted_t* obj) {
     if (!obj) return NULL;
 
-    obj->refcount++;
+    MGEN_RC_STORE(&obj->refcount, MGEN_RC_LOAD(&obj->refcount) + 1);
     return obj;
 }
 
 void mgen_refcounted_release(mgen_refcounted_t* obj) {
     if (!obj) return;
 
-    obj->refcount--;
-    if (obj->refcount <= 0) {
-        if (obj->destructor) {
-            obj->destructor(obj->data);
-        }
-        free(obj);
+    int remaining = MGEN_RC_LOAD(&obj->refcount) - 1;
+    MGEN_RC_STORE(&obj->refcount, remaining);
+    if (remaining <= 0) {
+        mgen_refcounted_destroy(obj);
+    }
+}
+
+mgen_refcounted_t* mgen_refcounted_retain_atomic(mgen_refcounted_t* obj) {
+    if (!obj) return NULL;
+
+    // New references come from existing ones, so no ordering is needed
+    MGEN_RC_INCREMENT(&obj->refcount);
+    return obj;
+}
+
+void mgen_refcounted_release_atomic(mgen_refcounted_t* obj) {
+    if (!obj) return;
+
+    // Release publishes this thread's writes; the acquire fence makes every
+    // thread's writes visible to the one that runs the destructor
+    if (MGEN_RC_DECREMENT(&obj->refcount) == 1) {
+        MGEN_RC_ACQUIRE_FENCE();
+        mgen_refcounted_destroy(obj);
     }
 }
 
 int mgen_refcounted_count(mgen_refcounted_t* obj) {
-    return obj ? obj->refcount : 0;
+    return obj ? MGEN_RC_LOAD(&obj->refcount) : 0;
 }
 
 void* mgen_refcounted_data(mgen_refcounted_t* obj) {
     return obj ? obj->data : NULL;
 }
 
+mgen_weak_ref_t mgen_refcounted_downgrade(mgen_refcounted_t* obj) {
+    mgen_weak_ref_t weak = {obj};
+    if (obj) {
+        MGEN_RC_INCREMENT(&obj->weak_count);
+    }
+    return weak;
+}
+
+mgen_refcounted_t* mgen_refcounted_upgrade(mgen_weak_ref_t weak) {
+    mgen_refcounted_t* obj = weak.obj;
+    if (!obj) return NULL;
+
+    // Only take a strong reference while at least one still exists
+    int count = MGEN_RC_LOAD(&obj->refcount);
+    while (count > 0) {
+        if (MGEN_RC_CAS(&obj->refcount, &count, count + 1)) {
+            return obj;
+        }
+    }
+    return NULL;
+}
+
+void mgen_weak_ref_release(mgen_weak_ref_t weak) {
+    mgen_refcounted_t* obj = weak.obj;
+    if (!obj) return;
+
+    if (MGEN_RC_DECREMENT(&obj->weak_count) == 1) {
+        MGEN_RC_ACQUIRE_FENCE();
+        free(obj);
+    }
+}
+
 // Buffer implementation
-mgen_buffer_t* mgen_buffer_new(size_t initial_capacity) {
-    if (initial_capacity == 0) {
-        initial_capacity = 256; // Default 256 bytes
+static const char mgen_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Grow so at least needed bytes (including the terminator) fit
+static mgen_error_t mgen_buffer_grow(mgen_buffer_t* buffer, size_t needed) {
+    if (needed <= buffer->capacity) {
+        return MGEN_OK;
+    }
+
+    size_t new_capacity = buffer->capacity ? buffer->capacity : MGEN_BUFFER_DEFAULT_CAPACITY;
+    while (new_capacity < needed) {
+        if (new_capacity > SIZE_MAX / 2) {
+            new_capacity = needed;
+            break;
+        }
+        new_capacity *= 2;
+    }
+
+    MGEN_PROFILE_ALLOC(new_capacity);
+    char* new_data = realloc(buffer->data, new_capacity);
+    if (!new_data) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow buffer");
+        return MGEN_ERROR_MEMORY;
+    }
+
+    if (!buffer->data) {
+        new_data[0] = '\0';
+    }
+    buffer->data = new_data;
+    buffer->capacity = new_capacity;
+    return MGEN_OK;
+}
+
+mgen_error_t mgen_buffer_init(mgen_buffer_t* buffer, size_t initial_capacity) {
+    if (!buffer) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Buffer is NULL");
+        return MGEN_ERROR_VALUE;
     }
 
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+    return mgen_buffer_grow(buffer, initial_capacity ? initial_capacity : MGEN_BUFFER_DEFAULT_CAPACITY);
+}
+
+mgen_buffer_t* mgen_buffer_new(size_t initial_capacity) {
     mgen_buffer_t* buffer = malloc(sizeof(mgen_buffer_t));
     if (!buffer) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate buffer");
         return NULL;
     }
 
-    buffer->data = malloc(initial_capacity);
-    if (!buffer->data) {
+    if (mgen_buffer_init(buffer, initial_capacity) != MGEN_OK) {
         free(buffer);
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate buffer data");
         return NULL;
     }
 
-    buffer->size = 0;
-    buffer->capacity = initial_capacity;
-    buffer->data[0] = '\0';
-
     return buffer;
 }
 
+mgen_error_t mgen_buffer_reserve(mgen_buffer_t* buffer, size_t additional) {
+    if (!buffer) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Buffer is NULL");
+        return MGEN_ERROR_VALUE;
+    }
+
+    if (additional > SIZE_MAX - buffer->size - 1) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Buffer reservation too large");
+        return MGEN_ERROR_VALUE;
+    }
+
+    return mgen_buffer_grow(buffer, buffer->size + additional + 1);
+}
+
+size_t mgen_buffer_capacity_hint(long long count, size_t bytes_each) {
+    if (count <= 0 || bytes_each == 0) {
+        return 0;
+    }
+    if ((unsigned long long)count >= MGEN_BUFFER_MAX_HINT / bytes_each) {
+        return MGEN_BUFFER_MAX_HINT;
+    }
+    return (size_t)count * bytes_each;
+}
+
 mgen_error_t mgen_buffer_append(mgen_buffer_t* buffer, const char* data, size_t len) {
     if (!buffer || !data) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Buffer or data is NULL");
@@ -422,19 +647,10 @@ mgen_error_t mgen_buffer_append(mgen_buffer_t* buffer, const char* data, size_t
     }
 
     if (buffer->size + len + 1 > buffer->capacity) {
-        size_t new_capacity = buffer->capacity;
-        while (new_capacity < buffer->size + len + 1) {
-            new_capacity *= 2;
+        mgen_error_t err = mgen_buffer_grow(buffer, buffer->size + len + 1);
+        if (err != MGEN_OK) {
+            return err;
         }
-
-        char* new_data = realloc(buffer->data, new_capacity);
-        if (!new_data) {
-            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow buffer");
-            return MGEN_ERROR_MEMORY;
-        }
-
-        buffer->data = new_data;
-        buffer->capacity = new_capacity;
     }
 
     memcpy(buffer->data + buffer->size, data, len);
@@ -453,6 +669,66 @@ mgen_error_t mgen_buffer_append_str(mgen_buffer_t* buffer, const char* str) {
     return mgen_buffer_append(buffer, str, strlen(str));
 }
 
+mgen_error_t mgen_buffer_append_char(mgen_buffer_t* buffer, char c) {
+    return mgen_buffer_append(buffer, &c, 1);
+}
+
+mgen_error_t mgen_buffer_append_int(mgen_buffer_t* buffer, long long value) {
+    // Digits are written back to front, two at a time
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+
+    while (magnitude >= 100) {
+        size_t pair = (size_t)(magnitude % 100) * 2;
+        magnitude /= 100;
+        *--p = mgen_digit_pairs[pair + 1];
+        *--p = mgen_digit_pairs[pair];
+    }
+    if (magnitude >= 10) {
+        size_t pair = (size_t)magnitude * 2;
+        *--p = mgen_digit_pairs[pair + 1];
+        *--p = mgen_digit_pairs[pair];
+    } else {
+        *--p = (char)('0' + magnitude);
+    }
+    if (value < 0) {
+        *--p = '-';
+    }
+
+    return mgen_buffer_append(buffer, p, (size_t)(end - p));
+}
+
+mgen_error_t mgen_buffer_append_float(mgen_buffer_t* buffer, double value) {
+    if (!buffer) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Buffer is NULL");
+        return MGEN_ERROR_VALUE;
+    }
+
+    // "%g" prints integral values below 1e6 without a fraction or exponent
+    if (value > -1e6 && value < 1e6 && value == (double)(long long)value) {
+        if (value == 0 && 1 / value < 0) {
+            return mgen_buffer_append(buffer, "-0", 2);
+        }
+        return mgen_buffer_append_int(buffer, (long long)value);
+    }
+
+    // "%g" output is at most 13 characters ("-1.23457e+308"); format in place
+    mgen_error_t err = mgen_buffer_reserve(buffer, 32);
+    if (err != MGEN_OK) {
+        return err;
+    }
+    int len = snprintf(buffer->data + buffer->size, 32, "%g", value);
+    if (len < 0) {
+        buffer->data[buffer->size] = '\0';
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Failed to format float");
+        return MGEN_ERROR_VALUE;
+    }
+    buffer->size += (size_t)len;
+    return MGEN_OK;
+}
+
 mgen_error_t mgen_buffer_append_fmt(mgen_buffer_t* buffer, const char* format, ...) {
     if (!buffer || !format) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Buffer or format is NULL");
@@ -475,25 +751,14 @@ mgen_error_t mgen_buffer_append_fmt(mgen_buffer_t* buffer, const char* format, .
     }
 
     // Ensure buffer has enough space
-    if (buffer->size + len + 1 > buffer->capacity) {
-        size_t new_capacity = buffer->capacity;
-        while (new_capacity < buffer->size + len + 1) {
-            new_capacity *= 2;
-        }
-
-        char* new_data = realloc(buffer->data, new_capacity);
-        if (!new_data) {
-            va_end(args);
-            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow buffer");
-            return MGEN_ERROR_MEMORY;
-        }
-
-        buffer->data = new_data;
-        buffer->capacity = new_capacity;
+    mgen_error_t err = mgen_buffer_grow(buffer, buffer->size + (size_t)len + 1);
+    if (err != MGEN_OK) {
+        va_end(args);
+        return err;
     }
 
-    vsnprintf(buffer->data + buffer->size, len + 1, format, args);
-    buffer->size += len;
+    vsnprintf(buffer->data + buffer->size, (size_t)len + 1, format, args);
+    buffer->size += (size_t)len;
     va_end(args);
 
     return MGEN_OK;
@@ -516,9 +781,36 @@ void mgen_buffer_clear(mgen_buffer_t* buffer) {
     }
 }
 
+char* mgen_buffer_detach(mgen_buffer_t* buffer) {
+    if (!buffer) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Buffer is NULL");
+        return NULL;
+    }
+
+    // A buffer whose allocation failed (or was already detached) yields ""
+    if (!buffer->data && mgen_buffer_grow(buffer, 1) != MGEN_OK) {
+        return NULL;
+    }
+
+    char* data = buffer->data;
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+    return data;
+}
+
+void mgen_buffer_destroy(mgen_buffer_t* buffer) {
+    if (!buffer) return;
+
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+}
+
 void mgen_buffer_free(mgen_buffer_t* buffer) {
     if (!buffer) return;
 
     free(buffer->data);
     free(buffer);
-}
\ No newline at end of file
+}
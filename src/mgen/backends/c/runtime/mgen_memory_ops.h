@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +38,14 @@ void* mgen_calloc(size_t count, size_t size);
  */
 void mgen_free(void** ptr);
 
+/**
+ * Allocation macros that also report the call site to the allocation
+ * profiler when built with -DMGEN_ALLOC_PROFILE (see mgen_alloc_profile.h)
+ */
+#define MGEN_MALLOC(size) (MGEN_PROFILE_ALLOC(size), mgen_malloc(size))
+#define MGEN_CALLOC(count, size) (MGEN_PROFILE_ALLOC((count) * (size)), mgen_calloc((count), (size)))
+#define MGEN_REALLOC(ptr, new_size) (MGEN_PROFILE_ALLOC(new_size), mgen_realloc((ptr), (new_size)))
+
 /**
  * Safe memory copy with bounds checking
  */
@@ -56,19 +65,44 @@ mgen_error_t mgen_memset_safe(void* dest, int value, size_t count, size_t dest_s
 
 /**
  * Memory pool for efficient allocation/deallocation
+ * Chunked arena: allocations never move, and small blocks handed back with
+ * mgen_memory_pool_release are recycled through per-size-class free lists.
  */
 typedef struct mgen_memory_pool mgen_memory_pool_t;
 
+// Alignment of every block from mgen_memory_pool_alloc (and the size-class step)
+#define MGEN_POOL_ALIGNMENT 16
+
+// Size classes with free lists: 16, 32, ... 256 bytes
+#define MGEN_POOL_SIZE_CLASSES 16
+
+#ifndef MGEN_POOL_MAX_CHUNK
+#define MGEN_POOL_MAX_CHUNK (1024 * 1024)
+#endif
+
 /**
- * Create a new memory pool
+ * Create a new memory pool (initial_size is the first chunk's capacity)
  */
 mgen_memory_pool_t* mgen_memory_pool_new(size_t initial_size);
 
 /**
- * Allocate from memory pool
+ * Allocate from memory pool (MGEN_POOL_ALIGNMENT-aligned)
+ * Reuses a released block of the same size class when one is available
  */
 void* mgen_memory_pool_alloc(mgen_memory_pool_t* pool, size_t size);
 
+/**
+ * Allocate from memory pool with a stricter power-of-two alignment
+ * These blocks bypass the free lists
+ */
+void* mgen_memory_pool_alloc_aligned(mgen_memory_pool_t* pool, size_t size, size_t alignment);
+
+/**
+ * Return a block to the pool for reuse by allocations of the same size class
+ * size must be the size originally requested
+ */
+void mgen_memory_pool_release(mgen_memory_pool_t* pool, void* ptr, size_t size);
+
 /**
  * Reset memory pool (deallocates all at once)
  */
@@ -81,6 +115,8 @@ void mgen_memory_pool_free(mgen_memory_pool_t* pool);
 
 /**
  * Automatic memory management with scope-based cleanup
+ * mgen_scope_alloc carves blocks out of a memory pool owned by the scope, so
+ * a scope full of temporaries is released with a handful of frees.
  */
 typedef struct mgen_scope_allocator mgen_scope_allocator_t;
 
@@ -91,6 +127,7 @@ mgen_scope_allocator_t* mgen_scope_new(void);
 
 /**
  * Allocate memory that will be automatically freed when scope ends
+ * Blocks are MGEN_POOL_ALIGNMENT-aligned and must not be freed individually
  */
 void* mgen_scope_alloc(mgen_scope_allocator_t* scope, size_t size);
 
@@ -143,13 +180,39 @@ int mgen_check_memory_leaks(void);
 
 /**
  * Reference counting utilities
- */
+ *
+ * Two variants share one object layout: mgen_refcounted_retain/release are
+ * the single-threaded fast path (plain increments), the *_atomic functions
+ * use atomic_int with relaxed increments and release/acquire decrements.
+ * Use one variant per object. Generated code goes through MGEN_RC_RETAIN /
+ * MGEN_RC_RELEASE, which pick the atomic variant when MGEN_ATOMIC_REFCOUNTS
+ * is defined (the C backend's atomic_refcounts preference).
+ *
+ * The intrusive weak count lets a thread hold a non-owning handle: the data
+ * is destroyed with the last strong reference, the block is freed with the
+ * last weak one, and mgen_refcounted_upgrade fails once the data is gone.
+ */
+#if !defined(__cplusplus) && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+    !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define MGEN_HAVE_C11_ATOMICS 1
+typedef atomic_int mgen_refcount_t;
+#else
+typedef int mgen_refcount_t;
+#endif
+
 typedef struct mgen_refcounted {
-    int refcount;
+    mgen_refcount_t refcount;    // Strong references
+    mgen_refcount_t weak_count;  // Weak references, plus one held by all strong references together
     void (*destructor)(void* data);
     char data[];
 } mgen_refcounted_t;
 
+// Non-owning handle produced by mgen_refcounted_downgrade
+typedef struct mgen_weak_ref {
+    mgen_refcounted_t* obj;
+} mgen_weak_ref_t;
+
 /**
  * Create reference counted object
  */
@@ -165,6 +228,16 @@ mgen_refcounted_t* mgen_refcounted_retain(mgen_refcounted_t* obj);
  */
 void mgen_refcounted_release(mgen_refcounted_t* obj);
 
+/**
+ * Increment reference count (thread-safe)
+ */
+mgen_refcounted_t* mgen_refcounted_retain_atomic(mgen_refcounted_t* obj);
+
+/**
+ * Decrement reference count (thread-safe, frees if reaches 0)
+ */
+void mgen_refcounted_release_atomic(mgen_refcounted_t* obj);
+
 /**
  * Get reference count
  */
@@ -175,8 +248,34 @@ int mgen_refcounted_count(mgen_refcounted_t* obj);
  */
 void* mgen_refcounted_data(mgen_refcounted_t* obj);
 
+/**
+ * Create a weak reference (thread-safe)
+ */
+mgen_weak_ref_t mgen_refcounted_downgrade(mgen_refcounted_t* obj);
+
+/**
+ * Get a new strong reference from a weak one, or NULL if the data was destroyed
+ * The caller releases the returned reference
+ */
+mgen_refcounted_t* mgen_refcounted_upgrade(mgen_weak_ref_t weak);
+
+/**
+ * Drop a weak reference (thread-safe)
+ */
+void mgen_weak_ref_release(mgen_weak_ref_t weak);
+
+#ifdef MGEN_ATOMIC_REFCOUNTS
+#define MGEN_RC_RETAIN(obj) mgen_refcounted_retain_atomic(obj)
+#define MGEN_RC_RELEASE(obj) mgen_refcounted_release_atomic(obj)
+#else
+#define MGEN_RC_RETAIN(obj) mgen_refcounted_retain(obj)
+#define MGEN_RC_RELEASE(obj) mgen_refcounted_release(obj)
+#endif
+
 /**
  * Buffer management for string operations
+ * Capacity grows geometrically, so n appends cost O(total bytes); the
+ * contents are always NUL-terminated and can be handed off without a copy.
  */
 typedef struct mgen_buffer {
     char* data;
@@ -184,11 +283,34 @@ typedef struct mgen_buffer {
     size_t capacity;
 } mgen_buffer_t;
 
+// Capacity used when none (or a zero hint) is given
+#define MGEN_BUFFER_DEFAULT_CAPACITY 256
+
+// Upper bound for codegen-time capacity hints; the buffer still grows past it
+#define MGEN_BUFFER_MAX_HINT (16 * 1024 * 1024)
+
 /**
  * Create a new dynamic buffer
  */
 mgen_buffer_t* mgen_buffer_new(size_t initial_capacity);
 
+/**
+ * Initialize a caller-owned (e.g. stack) buffer
+ * Release it with mgen_buffer_detach or mgen_buffer_destroy
+ */
+mgen_error_t mgen_buffer_init(mgen_buffer_t* buffer, size_t initial_capacity);
+
+/**
+ * Make room for additional more bytes so the next appends do not reallocate
+ */
+mgen_error_t mgen_buffer_reserve(mgen_buffer_t* buffer, size_t additional);
+
+/**
+ * Capacity hint for count appends of about bytes_each bytes
+ * Negative counts give 0; results are capped at MGEN_BUFFER_MAX_HINT
+ */
+size_t mgen_buffer_capacity_hint(long long count, size_t bytes_each);
+
 /**
  * Append data to buffer
  */
@@ -199,6 +321,22 @@ mgen_error_t mgen_buffer_append(mgen_buffer_t* buffer, const char* data, size_t
  */
 mgen_error_t mgen_buffer_append_str(mgen_buffer_t* buffer, const char* str);
 
+/**
+ * Append a single character to buffer
+ */
+mgen_error_t mgen_buffer_append_char(mgen_buffer_t* buffer, char c);
+
+/**
+ * Append the decimal form of an integer (no vsnprintf)
+ */
+mgen_error_t mgen_buffer_append_int(mgen_buffer_t* buffer, long long value);
+
+/**
+ * Append a double formatted like "%g"
+ * Integral values are formatted directly; others use one snprintf into the buffer
+ */
+mgen_error_t mgen_buffer_append_float(mgen_buffer_t* buffer, double value);
+
 /**
  * Append formatted string to buffer
  */
@@ -219,6 +357,17 @@ size_t mgen_buffer_size(mgen_buffer_t* buffer);
  */
 void mgen_buffer_clear(mgen_buffer_t* buffer);
 
+/**
+ * Take ownership of the buffer contents without copying (free with free())
+ * The buffer is left empty and may be reused; never returns NULL unless out of memory
+ */
+char* mgen_buffer_detach(mgen_buffer_t* buffer);
+
+/**
+ * Free the contents of a buffer set up with mgen_buffer_init
+ */
+void mgen_buffer_destroy(mgen_buffer_t* buffer);
+
 /**
  * Free buffer
  */
@@ -0,0 +1,311 @@
+/**
+ * MGen Runtime Library - Parallel Loops Implementation
+ */
+
+#include "mgen_parallel.h"
+#include "mgen_error_handling.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if !defined(_WIN32) && !defined(MGEN_NO_THREADS)
+#define MGEN_PARALLEL_THREADS 1
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Chunks per participant's initial share: more balance better, fewer take the part locks less often
+#define MGEN_PARALLEL_CHUNKS 16
+
+// Serial execution, with the sums added to directly
+static void mgen_parallel_serial(size_t count, mgen_parallel_body_t body, mgen_parallel_sum_body_t sum_body, void* ctx,
+                                 long long* sums) {
+    if (count == 0) {
+        return;
+    }
+    if (sum_body) {
+        sum_body(ctx, 0, count, sums);
+    } else {
+        body(ctx, 0, count);
+    }
+}
+
+#ifdef MGEN_PARALLEL_THREADS
+
+// A participant's remaining iterations; padded so neighbouring locks do not share a cache line
+typedef struct {
+    pthread_mutex_t lock;
+    size_t begin;
+    size_t end;
+    char padding[64];
+} mgen_parallel_part_t;
+
+static struct {
+    size_t workers;                 // Pool threads; participant 0 is the caller
+    mgen_parallel_part_t* parts;    // workers + 1
+    pthread_mutex_t job_lock;       // Serializes callers
+    pthread_mutex_t lock;           // Guards generation and busy
+    pthread_cond_t wake;            // generation advanced: a job is ready
+    pthread_cond_t done;            // busy dropped to zero
+    unsigned long long generation;
+    size_t busy;                    // Workers still on the current job
+    // Current job, written before generation advances
+    mgen_parallel_body_t body;
+    mgen_parallel_sum_body_t sum_body;
+    void* ctx;
+    long long* partials;            // sum_count per participant
+    size_t sum_count;
+    size_t grain;
+} mgen_pool;
+
+static pthread_once_t mgen_pool_once = PTHREAD_ONCE_INIT;
+
+// Set on pool threads and on a caller while it works on its job: nested calls run serially
+static MGEN_THREAD_LOCAL bool mgen_parallel_inside;
+
+// Participant index of a pool thread; callers are participant 0
+static MGEN_THREAD_LOCAL size_t mgen_parallel_self;
+
+// Next chunk for participant self: from the front of its own part, else half of the largest other part
+static bool mgen_parallel_next(size_t self, size_t* begin, size_t* end) {
+    size_t participants = mgen_pool.workers + 1;
+    size_t grain = mgen_pool.grain;
+    mgen_parallel_part_t* own = &mgen_pool.parts[self];
+
+    pthread_mutex_lock(&own->lock);
+    if (own->begin < own->end) {
+        *begin = own->begin;
+        *end = own->end - own->begin > grain ? own->begin + grain : own->end;
+        own->begin = *end;
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    // Parts only shrink, so a scan that finds them all empty means the job is (being) finished
+    for (;;) {
+        mgen_parallel_part_t* victim = NULL;
+        size_t most = 0;
+        for (size_t i = 0; i < participants; i++) {
+            mgen_parallel_part_t* part = &mgen_pool.parts[i];
+            if (part == own) {
+                continue;
+            }
+            pthread_mutex_lock(&part->lock);
+            size_t left = part->end - part->begin;
+            pthread_mutex_unlock(&part->lock);
+            if (left > most) {
+                most = left;
+                victim = part;
+            }
+        }
+        if (!victim) {
+            return false;
+        }
+
+        pthread_mutex_lock(&victim->lock);
+        size_t left = victim->end - victim->begin;
+        // The back half, or all of a last chunk
+        size_t take = left > grain ? left / 2 : left;
+        size_t stolen_end = victim->end;
+        victim->end -= take;
+        pthread_mutex_unlock(&victim->lock);
+        if (take == 0) {
+            continue;  // Emptied since the scan
+        }
+
+        *begin = stolen_end - take;
+        *end = take > grain ? *begin + grain : stolen_end;
+        pthread_mutex_lock(&own->lock);
+        own->begin = *end;
+        own->end = stolen_end;
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+}
+
+static void mgen_parallel_work(size_t self) {
+    long long* sums = mgen_pool.partials ? mgen_pool.partials + self * mgen_pool.sum_count : NULL;
+    size_t begin;
+    size_t end;
+    while (mgen_parallel_next(self, &begin, &end)) {
+        if (mgen_pool.sum_body) {
+            mgen_pool.sum_body(mgen_pool.ctx, begin, end, sums);
+        } else {
+            mgen_pool.body(mgen_pool.ctx, begin, end);
+        }
+    }
+}
+
+static void* mgen_parallel_worker(void* arg) {
+    size_t self = (size_t)(uintptr_t)arg;
+    unsigned long long seen = 0;
+    mgen_parallel_inside = true;
+    mgen_parallel_self = self;
+    pthread_mutex_lock(&mgen_pool.lock);
+    for (;;) {
+        while (mgen_pool.generation == seen) {
+            pthread_cond_wait(&mgen_pool.wake, &mgen_pool.lock);
+        }
+        seen = mgen_pool.generation;
+        pthread_mutex_unlock(&mgen_pool.lock);
+        mgen_parallel_work(self);
+        pthread_mutex_lock(&mgen_pool.lock);
+        if (--mgen_pool.busy == 0) {
+            pthread_cond_signal(&mgen_pool.done);
+        }
+    }
+    return NULL;
+}
+
+// Size the pool from MGEN_NUM_THREADS or the online processors and start its (detached) threads
+static void mgen_parallel_start(void) {
+    pthread_mutex_init(&mgen_pool.job_lock, NULL);
+    pthread_mutex_init(&mgen_pool.lock, NULL);
+    pthread_cond_init(&mgen_pool.wake, NULL);
+    pthread_cond_init(&mgen_pool.done, NULL);
+
+    long threads = 0;
+    const char* env = getenv("MGEN_NUM_THREADS");
+    if (env) {
+        threads = strtol(env, NULL, 10);
+    }
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads <= 1) {
+        return;
+    }
+
+    mgen_pool.parts = calloc((size_t)threads, sizeof(mgen_parallel_part_t));
+    if (!mgen_pool.parts) {
+        return;
+    }
+    for (long i = 0; i < threads; i++) {
+        pthread_mutex_init(&mgen_pool.parts[i].lock, NULL);
+    }
+    // Without some of the threads the pool is just smaller
+    for (long i = 1; i < threads; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, mgen_parallel_worker, (void*)(uintptr_t)i) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        mgen_pool.workers++;
+    }
+}
+
+size_t mgen_parallel_threads(void) {
+    pthread_once(&mgen_pool_once, mgen_parallel_start);
+    return mgen_pool.workers + 1;
+}
+
+size_t mgen_parallel_participant(void) {
+    return mgen_parallel_self;
+}
+
+static void mgen_parallel_run(size_t count, size_t threshold, mgen_parallel_body_t body,
+                              mgen_parallel_sum_body_t sum_body, void* ctx, long long* sums, size_t sum_count) {
+    size_t participants = mgen_parallel_threads();
+    if (participants == 1 || count < threshold || count < 2 || mgen_parallel_inside) {
+        mgen_parallel_serial(count, body, sum_body, ctx, sums);
+        return;
+    }
+    long long* partials = NULL;
+    if (sum_body) {
+        partials = calloc(participants * sum_count, sizeof(long long));
+        if (!partials) {
+            mgen_parallel_serial(count, body, sum_body, ctx, sums);
+            return;
+        }
+    }
+
+    pthread_mutex_lock(&mgen_pool.job_lock);
+    for (size_t i = 0; i < participants; i++) {
+        mgen_pool.parts[i].begin = i * count / participants;
+        mgen_pool.parts[i].end = (i + 1) * count / participants;
+    }
+    size_t grain = count / (participants * MGEN_PARALLEL_CHUNKS);
+    mgen_pool.grain = grain > 0 ? grain : 1;
+    mgen_pool.body = body;
+    mgen_pool.sum_body = sum_body;
+    mgen_pool.ctx = ctx;
+    mgen_pool.partials = partials;
+    mgen_pool.sum_count = sum_count;
+
+    pthread_mutex_lock(&mgen_pool.lock);
+    mgen_pool.busy = mgen_pool.workers;
+    mgen_pool.generation++;
+    pthread_cond_broadcast(&mgen_pool.wake);
+    pthread_mutex_unlock(&mgen_pool.lock);
+
+    mgen_parallel_inside = true;
+    mgen_parallel_work(0);
+    mgen_parallel_inside = false;
+
+    pthread_mutex_lock(&mgen_pool.lock);
+    while (mgen_pool.busy > 0) {
+        pthread_cond_wait(&mgen_pool.done, &mgen_pool.lock);
+    }
+    pthread_mutex_unlock(&mgen_pool.lock);
+    pthread_mutex_unlock(&mgen_pool.job_lock);
+
+    if (partials) {
+        for (size_t i = 0; i < participants; i++) {
+            for (size_t j = 0; j < sum_count; j++) {
+                sums[j] += partials[i * sum_count + j];
+            }
+        }
+        free(partials);
+    }
+}
+
+#else
+
+size_t mgen_parallel_threads(void) {
+    return 1;
+}
+
+size_t mgen_parallel_participant(void) {
+    return 0;
+}
+
+static void mgen_parallel_run(size_t count, size_t threshold, mgen_parallel_body_t body,
+                              mgen_parallel_sum_body_t sum_body, void* ctx, long long* sums, size_t sum_count) {
+    (void)threshold;
+    (void)sum_count;
+    mgen_parallel_serial(count, body, sum_body, ctx, sums);
+}
+
+#endif // MGEN_PARALLEL_THREADS
+
+void mgen_parallel_for(size_t count, size_t threshold, mgen_parallel_body_t body, void* ctx) {
+    mgen_parallel_run(count, threshold, body, NULL, ctx, NULL, 0);
+}
+
+void mgen_parallel_reduce(size_t count, size_t threshold, mgen_parallel_sum_body_t body, void* ctx, long long* sums,
+                          size_t sum_count) {
+    mgen_parallel_run(count, threshold, NULL, body, ctx, sums, sum_count);
+}
+
+typedef struct {
+    const char* input;
+    size_t input_size;
+    char* output;
+    size_t output_size;
+    mgen_parallel_map_fn_t fn;
+    void* ctx;
+} mgen_parallel_map_job_t;
+
+static void mgen_parallel_map_range(void* arg, size_t begin, size_t end) {
+    mgen_parallel_map_job_t* job = arg;
+    for (size_t i = begin; i < end; i++) {
+        job->fn(job->ctx, job->input + i * job->input_size, job->output + i * job->output_size);
+    }
+}
+
+void mgen_parallel_map(const void* input, size_t input_size, void* output, size_t output_size, size_t count,
+                       size_t threshold, mgen_parallel_map_fn_t fn, void* ctx) {
+    mgen_parallel_map_job_t job = {input, input_size, output, output_size, fn, ctx};
+    mgen_parallel_for(count, threshold, mgen_parallel_map_range, &job);
+}
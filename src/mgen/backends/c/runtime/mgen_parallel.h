@@ -0,0 +1,74 @@
+/**
+ * MGen Runtime Library - Parallel Loops
+ *
+ * A work-stealing thread pool for the C "parallel" preference: the
+ * converter outlines pure comprehensions and loops the loop analyzer proves
+ * parallel into chunk functions over index ranges and runs them here.
+ *
+ * The pool starts on first use with one thread per online processor
+ * (MGEN_NUM_THREADS overrides it); the calling thread works too. Each
+ * participant owns a contiguous part of the index range and takes chunks
+ * from its front; one that runs out steals the back half of the largest
+ * remaining part, so uneven iterations still balance out. Ranges shorter
+ * than the caller's threshold, calls made from inside a chunk and builds
+ * without threads (_WIN32, MGEN_NO_THREADS) run serially on the caller.
+ * One job runs at a time.
+ */
+
+#ifndef MGEN_PARALLEL_H
+#define MGEN_PARALLEL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Iterations [begin, end) of a parallel loop
+typedef void (*mgen_parallel_body_t)(void* ctx, size_t begin, size_t end);
+
+// Iterations [begin, end) adding their partial results to sums[0..sum_count)
+typedef void (*mgen_parallel_sum_body_t)(void* ctx, size_t begin, size_t end, long long* sums);
+
+// One element of mgen_parallel_map: *out = f(*in)
+typedef void (*mgen_parallel_map_fn_t)(void* ctx, const void* in, void* out);
+
+/**
+ * Threads sharing a job, including the caller (starts the pool)
+ */
+size_t mgen_parallel_threads(void);
+
+/**
+ * Index in [0, mgen_parallel_threads()) of the thread running the current chunk
+ * No two chunks running at once share an index, so chunks can accumulate
+ * into per-participant buffers without locks.
+ */
+size_t mgen_parallel_participant(void);
+
+/**
+ * Run body over [0, count), split across the pool when count >= threshold
+ * Returns after every iteration has run.
+ */
+void mgen_parallel_for(size_t count, size_t threshold, mgen_parallel_body_t body, void* ctx);
+
+/**
+ * mgen_parallel_for whose chunks produce integer sums
+ * Each participant accumulates into its own zeroed partials, which are
+ * added to sums once every chunk is done: exact for integers in any order.
+ */
+void mgen_parallel_reduce(size_t count, size_t threshold, mgen_parallel_sum_body_t body, void* ctx, long long* sums,
+                          size_t sum_count);
+
+/**
+ * Python [f(x) for x in xs] over a vector buffer
+ * fn maps the count elements of input (input_size bytes each) to output
+ * (output_size bytes each), which must not overlap it.
+ */
+void mgen_parallel_map(const void* input, size_t input_size, void* output, size_t output_size, size_t count,
+                       size_t threshold, mgen_parallel_map_fn_t fn, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_PARALLEL_H
@@ -0,0 +1,221 @@
+/**
+ * CPython argument and result conversion for extension-module output
+ * Single-header implementation for code generation
+ * stb-library style: static inline functions for single-file output
+ *
+ * With the "extension" target mode the converter appends METH_FASTCALL
+ * wrappers to the generated code (see python_extension.py), which convert
+ * their arguments with these helpers. A list[int] or list[float] argument
+ * that exports a contiguous one-dimensional buffer of C int or double - an
+ * array('i'), array('d'), or numpy int32/float64 array - is lent to the
+ * function as is: its vec points into the buffer, which stays acquired until
+ * the call returns. Any other sequence is copied once into a temporary array.
+ *
+ * Python.h must be included before this header (and before the C standard
+ * headers, as the generated code does); the module is built with
+ * MGEN_EXTENSION_NAME defined to its import name.
+ */
+
+#ifndef MGEN_PYEXT_H
+#define MGEN_PYEXT_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef MGEN_EXTENSION_NAME
+#error "MGEN_EXTENSION_NAME must name the extension module (e.g. -DMGEN_EXTENSION_NAME=kernels)"
+#endif
+
+#define MGEN_PYEXT_STR_(name) #name
+#define MGEN_PYEXT_STR(name) MGEN_PYEXT_STR_(name)
+#define MGEN_PYEXT_INIT_(name) PyInit_##name
+#define MGEN_PYEXT_INIT(name) MGEN_PYEXT_INIT_(name)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A list argument: a view of the caller's buffer, or a copy of its items
+typedef struct {
+    Py_buffer view;
+    void* data;
+    Py_ssize_t size;
+    bool borrowed;  // view is acquired and data points into it
+    bool copied;    // data was allocated with PyMem_Malloc
+} mgen_pyext_array_t;
+
+static inline int mgen_pyext_arity(const char* function, Py_ssize_t nargs, Py_ssize_t expected) {
+    if (nargs != expected) {
+        PyErr_Format(PyExc_TypeError, "%s() takes %zd positional arguments but %zd were given", function, expected,
+                     nargs);
+        return 0;
+    }
+    return 1;
+}
+
+// Whether a buffer format is one native item of one of codes ("i" for C int, "d" for double)
+static inline bool mgen_pyext_format_matches(const char* format, const char* codes) {
+    if (!format) {
+        return false;  // Unsigned bytes
+    }
+    if (*format == '@') {
+        format++;
+    }
+    return format[0] != '\0' && format[1] == '\0' && strchr(codes, format[0]) != NULL;
+}
+
+/**
+ * Lend obj's buffer when it holds itemsize-byte items in one of codes, else copy its items with store
+ *
+ * Returns 0 on success, -1 with a Python exception set.
+ */
+static inline int mgen_pyext_array(PyObject* obj, mgen_pyext_array_t* out, const char* codes, size_t itemsize,
+                                   int (*store)(PyObject* item, void* data, Py_ssize_t index)) {
+    memset(out, 0, sizeof(*out));
+    if (PyObject_CheckBuffer(obj) && !PyUnicode_Check(obj) && !PyBytes_Check(obj)) {
+        if (PyObject_GetBuffer(obj, &out->view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+            if (out->view.ndim == 1 && (size_t)out->view.itemsize == itemsize &&
+                mgen_pyext_format_matches(out->view.format, codes)) {
+                out->data = out->view.buf;
+                out->size = out->view.shape ? out->view.shape[0] : out->view.len / out->view.itemsize;
+                out->borrowed = true;
+                return 0;
+            }
+            PyBuffer_Release(&out->view);
+        }
+        // Strided, or another item type or shape: convert its items like any sequence
+        PyErr_Clear();
+    }
+
+    PyObject* items = PySequence_Fast(obj, "expected a sequence or a buffer of numbers");
+    if (!items) {
+        return -1;
+    }
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(items);
+    out->data = PyMem_Malloc(size > 0 ? (size_t)size * itemsize : 1);
+    if (!out->data) {
+        Py_DECREF(items);
+        PyErr_NoMemory();
+        return -1;
+    }
+    out->copied = true;
+    out->size = size;
+    PyObject** elements = PySequence_Fast_ITEMS(items);
+    for (Py_ssize_t i = 0; i < size; i++) {
+        if (store(elements[i], out->data, i) < 0) {
+            Py_DECREF(items);
+            return -1;
+        }
+    }
+    Py_DECREF(items);
+    return 0;
+}
+
+static inline void mgen_pyext_release(mgen_pyext_array_t* array) {
+    if (array->borrowed) {
+        PyBuffer_Release(&array->view);
+    } else if (array->copied) {
+        PyMem_Free(array->data);
+    }
+    memset(array, 0, sizeof(*array));
+}
+
+/**
+ * Scalar arguments: 0 on success, -1 with a Python exception set
+ */
+static inline int mgen_pyext_int(PyObject* obj, int* out) {
+    int overflow = 0;
+    long value = PyLong_AsLongAndOverflow(obj, &overflow);
+    if (value == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (overflow || value < INT_MIN || value > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "Python int too large to convert to C int");
+        return -1;
+    }
+    *out = (int)value;
+    return 0;
+}
+
+static inline int mgen_pyext_double(PyObject* obj, double* out) {
+    double value = PyFloat_AsDouble(obj);
+    if (value == -1.0 && PyErr_Occurred()) {
+        return -1;
+    }
+    *out = value;
+    return 0;
+}
+
+static inline int mgen_pyext_bool(PyObject* obj, bool* out) {
+    int value = PyObject_IsTrue(obj);
+    if (value < 0) {
+        return -1;
+    }
+    *out = value != 0;
+    return 0;
+}
+
+// The UTF-8 text stays owned by obj, which the caller keeps alive for the call
+static inline int mgen_pyext_str(PyObject* obj, char** out) {
+    const char* text = PyUnicode_AsUTF8(obj);
+    if (!text) {
+        return -1;
+    }
+    *out = (char*)text;
+    return 0;
+}
+
+static inline int mgen_pyext_store_int(PyObject* item, void* data, Py_ssize_t index) {
+    return mgen_pyext_int(item, (int*)data + index);
+}
+
+static inline int mgen_pyext_store_double(PyObject* item, void* data, Py_ssize_t index) {
+    return mgen_pyext_double(item, (double*)data + index);
+}
+
+/**
+ * List arguments: list[int] lends buffers of C int ('i', and 'l' where long is as wide), list[float] of double
+ */
+static inline int mgen_pyext_int_array(PyObject* obj, mgen_pyext_array_t* out) {
+    return mgen_pyext_array(obj, out, sizeof(long) == sizeof(int) ? "il" : "i", sizeof(int), mgen_pyext_store_int);
+}
+
+static inline int mgen_pyext_double_array(PyObject* obj, mgen_pyext_array_t* out) {
+    return mgen_pyext_array(obj, out, "d", sizeof(double), mgen_pyext_store_double);
+}
+
+/**
+ * List results: a new Python list of the items, or NULL with a Python exception set
+ */
+static inline PyObject* mgen_pyext_int_list(const int* data, ptrdiff_t size) {
+    PyObject* list = PyList_New(size);
+    for (ptrdiff_t i = 0; list && i < size; i++) {
+        PyObject* item = PyLong_FromLong(data[i]);
+        if (!item) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+static inline PyObject* mgen_pyext_double_list(const double* data, ptrdiff_t size) {
+    PyObject* list = PyList_New(size);
+    for (ptrdiff_t i = 0; list && i < size; i++) {
+        PyObject* item = PyFloat_FromDouble(data[i]);
+        if (!item) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_PYEXT_H
@@ -6,9 +6,10 @@
 #include <math.h>
 #include <limits.h>
 #include <float.h>
+#include "mgen_ascii.h"
 
-// Global exception state
-mgen_exception_t mgen_current_exception = {MGEN_OK, "", ""};
+// Exception state (per thread)
+MGEN_THREAD_LOCAL mgen_exception_t mgen_current_exception = {MGEN_OK, "", ""};
 
 /**
  * Python bool() function implementations
@@ -41,6 +42,254 @@ double mgen_abs_float(double value) {
     return fabs(value);
 }
 
+/**
+ * Array reduction kernels
+ *
+ * min/max/sum over arrays run on AVX2 when the CPU supports it (checked at
+ * call time with __builtin_cpu_supports) and on NEON on AArch64, with
+ * portable scalar loops as the fallback. Define MGEN_NO_SIMD to force the
+ * scalar path. Every path returns the same result: float sums keep 16
+ * partial sums in a fixed lane order and combine them the same way.
+ */
+#if !defined(MGEN_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define MGEN_SIMD_AVX2 1
+#include <immintrin.h>
+#define MGEN_AVX2_TARGET __attribute__((target("avx2")))
+#define MGEN_HAVE_AVX2() __builtin_cpu_supports("avx2")
+#elif !defined(MGEN_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#define MGEN_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Partial sums per float sum leaf: 4 AVX2 or 8 NEON vectors
+#define MGEN_SUM_LANES 16
+// Leaf size for pairwise float summation (a multiple of MGEN_SUM_LANES)
+#define MGEN_SUM_BLOCK 256
+
+static int mgen_min_int_scalar(const int* arr, size_t size, int min_val) {
+    for (size_t i = 0; i < size; i++) {
+        if (arr[i] < min_val) {
+            min_val = arr[i];
+        }
+    }
+    return min_val;
+}
+
+static int mgen_max_int_scalar(const int* arr, size_t size, int max_val) {
+    for (size_t i = 0; i < size; i++) {
+        if (arr[i] > max_val) {
+            max_val = arr[i];
+        }
+    }
+    return max_val;
+}
+
+// NaN-skipping: a NaN running value is replaced by the next element
+static double mgen_min_float_scalar(const double* arr, size_t size, double min_val) {
+    for (size_t i = 0; i < size; i++) {
+        if (arr[i] < min_val || isnan(min_val)) {
+            min_val = arr[i];
+        }
+    }
+    return min_val;
+}
+
+static double mgen_max_float_scalar(const double* arr, size_t size, double max_val) {
+    for (size_t i = 0; i < size; i++) {
+        if (arr[i] > max_val || isnan(max_val)) {
+            max_val = arr[i];
+        }
+    }
+    return max_val;
+}
+
+static long long mgen_sum_int_scalar(const int* arr, size_t size) {
+    long long sum = 0;
+    for (size_t i = 0; i < size; i++) {
+        sum += arr[i];
+    }
+    return sum;
+}
+
+// Fold MGEN_SUM_LANES partial sums in a fixed order, then add the tail
+static double mgen_sum_combine(const double* acc, const double* tail, size_t tail_size) {
+    double quad[4];
+    for (size_t l = 0; l < 4; l++) {
+        quad[l] = (acc[l] + acc[4 + l]) + (acc[8 + l] + acc[12 + l]);
+    }
+    double sum = (quad[0] + quad[1]) + (quad[2] + quad[3]);
+    for (size_t i = 0; i < tail_size; i++) {
+        sum += tail[i];
+    }
+    return sum;
+}
+
+static double mgen_sum_float_leaf_scalar(const double* arr, size_t size) {
+    double acc[MGEN_SUM_LANES] = {0};
+    size_t i = 0;
+    for (; i + MGEN_SUM_LANES <= size; i += MGEN_SUM_LANES) {
+        for (size_t l = 0; l < MGEN_SUM_LANES; l++) {
+            acc[l] += arr[i + l];
+        }
+    }
+    return mgen_sum_combine(acc, arr + i, size - i);
+}
+
+#ifdef MGEN_SIMD_AVX2
+// The kernels finish in shared scalar code: each clears the upper YMM halves
+// first to avoid AVX-SSE transition stalls
+MGEN_AVX2_TARGET static int mgen_min_int_avx2(const int* arr, size_t size) {
+    __m256i lo = _mm256_loadu_si256((const __m256i*)arr);
+    size_t i = 8;
+    for (; i + 8 <= size; i += 8) {
+        lo = _mm256_min_epi32(lo, _mm256_loadu_si256((const __m256i*)(arr + i)));
+    }
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, lo);
+    _mm256_zeroupper();
+    return mgen_min_int_scalar(arr + i, size - i, mgen_min_int_scalar(lanes + 1, 7, lanes[0]));
+}
+
+MGEN_AVX2_TARGET static int mgen_max_int_avx2(const int* arr, size_t size) {
+    __m256i hi = _mm256_loadu_si256((const __m256i*)arr);
+    size_t i = 8;
+    for (; i + 8 <= size; i += 8) {
+        hi = _mm256_max_epi32(hi, _mm256_loadu_si256((const __m256i*)(arr + i)));
+    }
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, hi);
+    _mm256_zeroupper();
+    return mgen_max_int_scalar(arr + i, size - i, mgen_max_int_scalar(lanes + 1, 7, lanes[0]));
+}
+
+// Per lane: take x when it is smaller (larger) or the running value is NaN
+MGEN_AVX2_TARGET static inline __m256d mgen_minmax_step_avx2(__m256d best, __m256d x, int want_max) {
+    __m256d better = want_max ? _mm256_cmp_pd(x, best, _CMP_GT_OQ) : _mm256_cmp_pd(x, best, _CMP_LT_OQ);
+    __m256d take = _mm256_or_pd(better, _mm256_cmp_pd(best, best, _CMP_UNORD_Q));
+    return _mm256_blendv_pd(best, x, take);
+}
+
+// Two independent accumulators hide the compare/blend latency
+MGEN_AVX2_TARGET static double mgen_minmax_float_avx2(const double* arr, size_t size, int want_max) {
+    __m256d best0 = _mm256_loadu_pd(arr);
+    __m256d best1 = _mm256_loadu_pd(arr + 4);
+    size_t i = 8;
+    for (; i + 8 <= size; i += 8) {
+        best0 = mgen_minmax_step_avx2(best0, _mm256_loadu_pd(arr + i), want_max);
+        best1 = mgen_minmax_step_avx2(best1, _mm256_loadu_pd(arr + i + 4), want_max);
+    }
+    double lanes[8];
+    _mm256_storeu_pd(lanes, best0);
+    _mm256_storeu_pd(lanes + 4, best1);
+    _mm256_zeroupper();
+    if (want_max) {
+        return mgen_max_float_scalar(arr + i, size - i, mgen_max_float_scalar(lanes + 1, 7, lanes[0]));
+    }
+    return mgen_min_float_scalar(arr + i, size - i, mgen_min_float_scalar(lanes + 1, 7, lanes[0]));
+}
+
+// Widen to 64-bit lanes: cannot overflow below 2^32 elements
+MGEN_AVX2_TARGET static long long mgen_sum_int_avx2(const int* arr, size_t size) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(arr + i))));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(arr + i + 4))));
+    }
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(acc0, acc1));
+    _mm256_zeroupper();
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + mgen_sum_int_scalar(arr + i, size - i);
+}
+
+MGEN_AVX2_TARGET static double mgen_sum_float_leaf_avx2(const double* arr, size_t size) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + MGEN_SUM_LANES <= size; i += MGEN_SUM_LANES) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(arr + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(arr + i + 4));
+        acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(arr + i + 8));
+        acc3 = _mm256_add_pd(acc3, _mm256_loadu_pd(arr + i + 12));
+    }
+    double acc[MGEN_SUM_LANES];
+    _mm256_storeu_pd(acc, acc0);
+    _mm256_storeu_pd(acc + 4, acc1);
+    _mm256_storeu_pd(acc + 8, acc2);
+    _mm256_storeu_pd(acc + 12, acc3);
+    _mm256_zeroupper();
+    return mgen_sum_combine(acc, arr + i, size - i);
+}
+#endif // MGEN_SIMD_AVX2
+
+#ifdef MGEN_SIMD_NEON
+static int mgen_min_int_neon(const int* arr, size_t size) {
+    int32x4_t lo = vld1q_s32(arr);
+    size_t i = 4;
+    for (; i + 4 <= size; i += 4) {
+        lo = vminq_s32(lo, vld1q_s32(arr + i));
+    }
+    return mgen_min_int_scalar(arr + i, size - i, vminvq_s32(lo));
+}
+
+static int mgen_max_int_neon(const int* arr, size_t size) {
+    int32x4_t hi = vld1q_s32(arr);
+    size_t i = 4;
+    for (; i + 4 <= size; i += 4) {
+        hi = vmaxq_s32(hi, vld1q_s32(arr + i));
+    }
+    return mgen_max_int_scalar(arr + i, size - i, vmaxvq_s32(hi));
+}
+
+// Keep the running value unless x is smaller (larger) or the running value is NaN
+static double mgen_minmax_float_neon(const double* arr, size_t size, int want_max) {
+    float64x2_t best = vld1q_f64(arr);
+    size_t i = 2;
+    for (; i + 2 <= size; i += 2) {
+        float64x2_t x = vld1q_f64(arr + i);
+        uint64x2_t better = want_max ? vcgtq_f64(x, best) : vcltq_f64(x, best);
+        uint64x2_t keep = vbicq_u64(vceqq_f64(best, best), better);
+        best = vbslq_f64(keep, best, x);
+    }
+    double lanes[2];
+    vst1q_f64(lanes, best);
+    if (want_max) {
+        return mgen_max_float_scalar(arr + i, size - i, mgen_max_float_scalar(lanes + 1, 1, lanes[0]));
+    }
+    return mgen_min_float_scalar(arr + i, size - i, mgen_min_float_scalar(lanes + 1, 1, lanes[0]));
+}
+
+static long long mgen_sum_int_neon(const int* arr, size_t size) {
+    int64x2_t acc = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        acc = vpadalq_s32(acc, vld1q_s32(arr + i));
+    }
+    return vaddvq_s64(acc) + mgen_sum_int_scalar(arr + i, size - i);
+}
+
+static double mgen_sum_float_leaf_neon(const double* arr, size_t size) {
+    float64x2_t acc[MGEN_SUM_LANES / 2];
+    for (size_t v = 0; v < MGEN_SUM_LANES / 2; v++) {
+        acc[v] = vdupq_n_f64(0.0);
+    }
+    size_t i = 0;
+    for (; i + MGEN_SUM_LANES <= size; i += MGEN_SUM_LANES) {
+        for (size_t v = 0; v < MGEN_SUM_LANES / 2; v++) {
+            acc[v] = vaddq_f64(acc[v], vld1q_f64(arr + i + 2 * v));
+        }
+    }
+    double lanes[MGEN_SUM_LANES];
+    for (size_t v = 0; v < MGEN_SUM_LANES / 2; v++) {
+        vst1q_f64(lanes + 2 * v, acc[v]);
+    }
+    return mgen_sum_combine(lanes, arr + i, size - i);
+}
+#endif // MGEN_SIMD_NEON
+
 /**
  * Python min() and max() implementations
  */
@@ -50,13 +299,16 @@ int mgen_min_int_array(const int* arr, size_t size) {
         return 0;
     }
 
-    int min_val = arr[0];
-    for (size_t i = 1; i < size; i++) {
-        if (arr[i] < min_val) {
-            min_val = arr[i];
-        }
+#if defined(MGEN_SIMD_AVX2)
+    if (size >= 16 && MGEN_HAVE_AVX2()) {
+        return mgen_min_int_avx2(arr, size);
     }
-    return min_val;
+#elif defined(MGEN_SIMD_NEON)
+    if (size >= 8) {
+        return mgen_min_int_neon(arr, size);
+    }
+#endif
+    return mgen_min_int_scalar(arr + 1, size - 1, arr[0]);
 }
 
 int mgen_max_int_array(const int* arr, size_t size) {
@@ -65,13 +317,47 @@ int mgen_max_int_array(const int* arr, size_t size) {
         return 0;
     }
 
-    int max_val = arr[0];
-    for (size_t i = 1; i < size; i++) {
-        if (arr[i] > max_val) {
-            max_val = arr[i];
+#if defined(MGEN_SIMD_AVX2)
+    if (size >= 16 && MGEN_HAVE_AVX2()) {
+        return mgen_max_int_avx2(arr, size);
+    }
+#elif defined(MGEN_SIMD_NEON)
+    if (size >= 8) {
+        return mgen_max_int_neon(arr, size);
+    }
+#endif
+    return mgen_max_int_scalar(arr + 1, size - 1, arr[0]);
+}
+
+#if defined(MGEN_SIMD_AVX2) || defined(MGEN_SIMD_NEON)
+// Lanes may settle on different signed zeros: return the first zero, as the scalar scan does
+static double mgen_first_zero(const double* arr, size_t size, double value) {
+    if (value != 0.0) {
+        return value;
+    }
+    for (size_t i = 0; i < size; i++) {
+        if (arr[i] == 0.0) {
+            return arr[i];
         }
     }
-    return max_val;
+    return value;
+}
+#endif
+
+static double mgen_minmax_float_array(const double* arr, size_t size, int want_max) {
+#if defined(MGEN_SIMD_AVX2)
+    if (size >= 8 && MGEN_HAVE_AVX2()) {
+        return mgen_first_zero(arr, size, mgen_minmax_float_avx2(arr, size, want_max));
+    }
+#elif defined(MGEN_SIMD_NEON)
+    if (size >= 4) {
+        return mgen_first_zero(arr, size, mgen_minmax_float_neon(arr, size, want_max));
+    }
+#endif
+    if (want_max) {
+        return mgen_max_float_scalar(arr + 1, size - 1, arr[0]);
+    }
+    return mgen_min_float_scalar(arr + 1, size - 1, arr[0]);
 }
 
 double mgen_min_float_array(const double* arr, size_t size) {
@@ -79,14 +365,7 @@ double mgen_min_float_array(const double* arr, size_t size) {
         mgen_raise_exception(MGEN_ERROR_VALUE, "min() arg is an empty sequence");
         return 0.0;
     }
-
-    double min_val = arr[0];
-    for (size_t i = 1; i < size; i++) {
-        if (arr[i] < min_val || isnan(min_val)) {
-            min_val = arr[i];
-        }
-    }
-    return min_val;
+    return mgen_minmax_float_array(arr, size, 0);
 }
 
 double mgen_max_float_array(const double* arr, size_t size) {
@@ -94,14 +373,7 @@ double mgen_max_float_array(const double* arr, size_t size) {
         mgen_raise_exception(MGEN_ERROR_VALUE, "max() arg is an empty sequence");
         return 0.0;
     }
-
-    double max_val = arr[0];
-    for (size_t i = 1; i < size; i++) {
-        if (arr[i] > max_val || isnan(max_val)) {
-            max_val = arr[i];
-        }
-    }
-    return max_val;
+    return mgen_minmax_float_array(arr, size, 1);
 }
 
 /**
@@ -110,27 +382,65 @@ double mgen_max_float_array(const double* arr, size_t size) {
 int mgen_sum_int_array(const int* arr, size_t size) {
     if (!arr) return 0;
 
-    int sum = 0;
-    for (size_t i = 0; i < size; i++) {
-        // Check for overflow
-        if ((sum > 0 && arr[i] > INT_MAX - sum) ||
-            (sum < 0 && arr[i] < INT_MIN - sum)) {
-            mgen_raise_exception(MGEN_ERROR_VALUE, "Integer overflow in sum()");
-            return 0;
-        }
-        sum += arr[i];
+    long long sum;
+#if defined(MGEN_SIMD_AVX2)
+    sum = (size >= 16 && MGEN_HAVE_AVX2()) ? mgen_sum_int_avx2(arr, size) : mgen_sum_int_scalar(arr, size);
+#elif defined(MGEN_SIMD_NEON)
+    sum = mgen_sum_int_neon(arr, size);
+#else
+    sum = mgen_sum_int_scalar(arr, size);
+#endif
+
+    // Like Python, only the final value matters: partial sums may leave int range
+    if (sum > INT_MAX || sum < INT_MIN) {
+        mgen_raise_exception(MGEN_ERROR_VALUE, "Integer overflow in sum()");
+        return 0;
     }
-    return sum;
+    return (int)sum;
+}
+
+static double mgen_sum_float_leaf(const double* arr, size_t size) {
+#if defined(MGEN_SIMD_AVX2)
+    if (MGEN_HAVE_AVX2()) {
+        return mgen_sum_float_leaf_avx2(arr, size);
+    }
+#elif defined(MGEN_SIMD_NEON)
+    return mgen_sum_float_leaf_neon(arr, size);
+#endif
+    return mgen_sum_float_leaf_scalar(arr, size);
+}
+
+// Error grows with O(log n) instead of O(n) for a sequential loop
+static double mgen_sum_float_pairwise(const double* arr, size_t size) {
+    if (size <= MGEN_SUM_BLOCK) {
+        return mgen_sum_float_leaf(arr, size);
+    }
+    // Split on a block boundary so both halves are made of full leaves
+    size_t half = (size / 2 + MGEN_SUM_BLOCK - 1) / MGEN_SUM_BLOCK * MGEN_SUM_BLOCK;
+    return mgen_sum_float_pairwise(arr, half) + mgen_sum_float_pairwise(arr + half, size - half);
 }
 
 double mgen_sum_float_array(const double* arr, size_t size) {
     if (!arr) return 0.0;
+    return mgen_sum_float_pairwise(arr, size);
+}
+
+double mgen_sum_float_array_compensated(const double* arr, size_t size) {
+    if (!arr) return 0.0;
 
+    // Neumaier's variant of Kahan summation: also exact when an element dwarfs the sum
     double sum = 0.0;
+    double compensation = 0.0;
     for (size_t i = 0; i < size; i++) {
-        sum += arr[i];
+        double t = sum + arr[i];
+        if (fabs(sum) >= fabs(arr[i])) {
+            compensation += (sum - t) + arr[i];
+        } else {
+            compensation += (arr[i] - t) + sum;
+        }
+        sum = t;
     }
-    return sum;
+    return sum + compensation;
 }
 
 /**
@@ -182,30 +492,30 @@ int mgen_range_has_next(const mgen_range_t* range) {
  * Character classification functions
  */
 int mgen_isalpha_char(char c) {
-    return isalpha((unsigned char)c);
+    return mgen_ascii_isalpha((unsigned char)c);
 }
 
 int mgen_isdigit_char(char c) {
-    return isdigit((unsigned char)c);
+    return mgen_ascii_isdigit((unsigned char)c);
 }
 
 int mgen_isspace_char(char c) {
-    return isspace((unsigned char)c);
+    return mgen_ascii_isspace((unsigned char)c);
 }
 
 int mgen_isalnum_char(char c) {
-    return isalnum((unsigned char)c);
+    return mgen_ascii_isalnum((unsigned char)c);
 }
 
 /**
  * Character case conversion
  */
 char mgen_lower_char(char c) {
-    return (char)tolower((unsigned char)c);
+    return (char)mgen_ascii_lower((unsigned char)c);
 }
 
 char mgen_upper_char(char c) {
-    return (char)toupper((unsigned char)c);
+    return (char)mgen_ascii_upper((unsigned char)c);
 }
 
 /**
@@ -331,14 +641,6 @@ void mgen_clear_exception(void) {
     mgen_current_exception.traceback[0] = '\0';
 }
 
-int mgen_has_exception(void) {
-    return mgen_current_exception.type != MGEN_OK;
-}
-
-const mgen_exception_t* mgen_get_exception(void) {
-    return &mgen_current_exception;
-}
-
 /**
  * Truthiness testing
  */
@@ -14,6 +14,21 @@
 #include <ctype.h>
 #include "mgen_error_handling.h"
 
+/**
+ * Placed before a for loop whose iterations are independent (no aliasing
+ * between the lists it reads and writes), so the compiler vectorizes it
+ * without runtime alias checks
+ */
+#if defined(__clang__)
+#define MGEN_LOOP_INDEPENDENT _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define MGEN_LOOP_INDEPENDENT _Pragma("GCC ivdep")
+#elif defined(_MSC_VER)
+#define MGEN_LOOP_INDEPENDENT __pragma(loop(ivdep))
+#else
+#define MGEN_LOOP_INDEPENDENT
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -50,6 +65,7 @@ double mgen_abs_float(double value);
 
 /**
  * Python min() and max() for arrays
+ * Vectorized on AVX2 (runtime-detected) and NEON; define MGEN_NO_SIMD for scalar only
  */
 int mgen_min_int_array(const int* arr, size_t size);
 int mgen_max_int_array(const int* arr, size_t size);
@@ -58,9 +74,13 @@ double mgen_max_float_array(const double* arr, size_t size);
 
 /**
  * Python sum() for arrays
+ * Int sums raise only when the total leaves int range. Float sums use
+ * pairwise summation; the compensated variant (Neumaier) matches Python 3.12+
+ * sum() more closely at about half the throughput.
  */
 int mgen_sum_int_array(const int* arr, size_t size);
 double mgen_sum_float_array(const double* arr, size_t size);
+double mgen_sum_float_array_compensated(const double* arr, size_t size);
 
 /**
  * Python range() functionality
@@ -145,19 +165,48 @@ typedef struct {
     char traceback[512];
 } mgen_exception_t;
 
-extern mgen_exception_t mgen_current_exception;
+// Per-thread, like mgen_last_error: a raise on one thread is not seen by another
+extern MGEN_THREAD_LOCAL mgen_exception_t mgen_current_exception;
 
 void mgen_raise_exception(mgen_error_t type, const char* message);
 void mgen_clear_exception(void);
-int mgen_has_exception(void);
-const mgen_exception_t* mgen_get_exception(void);
+
+/**
+ * Inline so the check after each call is one load and a branch predicted not taken;
+ * only mgen_raise_exception (the rare path) leaves the caller.
+ */
+static inline int mgen_has_exception(void) {
+    return MGEN_UNLIKELY(mgen_current_exception.type != MGEN_OK);
+}
+
+static inline const mgen_exception_t* mgen_get_exception(void) {
+    return &mgen_current_exception;
+}
+
+/**
+ * Status-return propagation: after a call that may raise, return to our caller
+ * with the exception still set (Python unwinding one frame)
+ */
+#define MGEN_PROPAGATE(retval) \
+    do { \
+        if (mgen_has_exception()) { \
+            return (retval); \
+        } \
+    } while(0)
+
+#define MGEN_PROPAGATE_VOID() \
+    do { \
+        if (mgen_has_exception()) { \
+            return; \
+        } \
+    } while(0)
 
 /**
  * Python-style assert
  */
 #define mgen_assert(condition, message) \
     do { \
-        if (!(condition)) { \
+        if (MGEN_UNLIKELY(!(condition))) { \
             mgen_raise_exception(MGEN_ERROR_RUNTIME, message); \
             return; \
         } \
@@ -165,7 +214,7 @@ const mgen_exception_t* mgen_get_exception(void);
 
 #define mgen_assert_return(condition, message, retval) \
     do { \
-        if (!(condition)) { \
+        if (MGEN_UNLIKELY(!(condition))) { \
             mgen_raise_exception(MGEN_ERROR_RUNTIME, message); \
             return (retval); \
         } \
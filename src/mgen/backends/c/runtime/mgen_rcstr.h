@@ -0,0 +1,359 @@
+/**
+ * Reference counted, copy-on-write strings
+ * stb-library style: static functions for single-file output
+ *
+ * An mgen_rcstr_t is a const char* to the NUL-terminated bytes of an
+ * mgen_refcounted_t block, so it can be handed to any function taking a C
+ * string. Copying the handle with mgen_rcstr_retain shares the bytes: storing
+ * a string in a vec_rcstr, returning it or assigning it costs a refcount
+ * increment instead of a malloc and a copy. The bytes are immutable while
+ * shared; mgen_rcstr_mutable and mgen_rcstr_append copy them into a buffer of
+ * their own first when someone else holds a reference (copy on write), and
+ * work in place otherwise. Slices that are not the whole string are new
+ * strings.
+ *
+ * Only strings made by mgen_rcstr_* may be retained or released: literals and
+ * other char* strings enter through mgen_rcstr_new, which copies them once.
+ * Retain and release follow MGEN_RC_RETAIN/MGEN_RC_RELEASE, so they are
+ * thread-safe under MGEN_ATOMIC_REFCOUNTS. Needs mgen_memory_ops.c.
+ */
+
+#ifndef MGEN_RCSTR_H
+#define MGEN_RCSTR_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_error_handling.h"
+#include "mgen_memory_ops.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef const char* mgen_rcstr_t;
+
+// Payload of the refcounted block: the bytes follow the header directly
+typedef struct {
+    size_t len;
+    size_t capacity;  // Bytes available at bytes, excluding the NUL
+    char bytes[];
+} mgen_rcstr_header_t;
+
+// The header must sit at a size_t-aligned offset of mgen_refcounted_t.data
+typedef char mgen_rcstr_layout_check[offsetof(mgen_refcounted_t, data) % sizeof(size_t) == 0 ? 1 : -1];
+
+static inline mgen_rcstr_header_t* mgen_rcstr_header(mgen_rcstr_t s) {
+    return (mgen_rcstr_header_t*)(s - offsetof(mgen_rcstr_header_t, bytes));
+}
+
+static inline mgen_refcounted_t* mgen_rcstr_block(mgen_rcstr_t s) {
+    return (mgen_refcounted_t*)((char*)mgen_rcstr_header(s) - offsetof(mgen_refcounted_t, data));
+}
+
+/**
+ * Allocate a string with room for capacity bytes, holding a copy of (data, len)
+ */
+static mgen_rcstr_t mgen_rcstr_with_capacity(const char* data, size_t len, size_t capacity) {
+    if (capacity < len) {
+        capacity = len;
+    }
+    mgen_refcounted_t* obj = mgen_refcounted_new(sizeof(mgen_rcstr_header_t) + capacity + 1, NULL);
+    if (!obj) {
+        return NULL;
+    }
+    mgen_rcstr_header_t* header = (mgen_rcstr_header_t*)obj->data;
+    header->len = len;
+    header->capacity = capacity;
+    if (len) {
+        memcpy(header->bytes, data, len);
+    }
+    header->bytes[len] = '\0';
+    return header->bytes;
+}
+
+/**
+ * New string holding a copy of the first len bytes of data (need not be NUL-terminated)
+ */
+static inline mgen_rcstr_t mgen_rcstr_new_n(const char* data, size_t len) {
+    return mgen_rcstr_with_capacity(data, len, len);
+}
+
+/**
+ * New string holding a copy of a C string
+ */
+static inline mgen_rcstr_t mgen_rcstr_new(const char* str) {
+    if (!str) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String is NULL");
+        return NULL;
+    }
+    return mgen_rcstr_new_n(str, strlen(str));
+}
+
+/**
+ * Share s: returns s with one more reference (NULL stays NULL)
+ */
+static inline mgen_rcstr_t mgen_rcstr_retain(mgen_rcstr_t s) {
+    if (s) {
+        MGEN_RC_RETAIN(mgen_rcstr_block(s));
+    }
+    return s;
+}
+
+/**
+ * Drop a reference; the buffer is freed with the last one
+ */
+static inline void mgen_rcstr_release(mgen_rcstr_t s) {
+    if (s) {
+        MGEN_RC_RELEASE(mgen_rcstr_block(s));
+    }
+}
+
+/**
+ * Point *dst at src, sharing it, and drop the string *dst held
+ */
+static inline void mgen_rcstr_assign(mgen_rcstr_t* dst, mgen_rcstr_t src) {
+    mgen_rcstr_retain(src);
+    mgen_rcstr_release(*dst);
+    *dst = src;
+}
+
+/**
+ * Length in bytes, without scanning
+ */
+static inline size_t mgen_rcstr_len(mgen_rcstr_t s) {
+    return s ? mgen_rcstr_header(s)->len : 0;
+}
+
+/**
+ * Number of references to the buffer of s
+ */
+static inline int mgen_rcstr_refcount(mgen_rcstr_t s) {
+    return s ? mgen_refcounted_count(mgen_rcstr_block(s)) : 0;
+}
+
+/**
+ * Writable bytes of *s: the buffer itself when *s holds the only reference,
+ * else a private copy that replaces *s (the other holders keep the original)
+ * Writes must keep the length; use mgen_rcstr_append to grow
+ */
+static char* mgen_rcstr_mutable(mgen_rcstr_t* s) {
+    if (!s || !*s) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String is NULL");
+        return NULL;
+    }
+    if (mgen_rcstr_refcount(*s) > 1) {
+        mgen_rcstr_t copy = mgen_rcstr_new_n(*s, mgen_rcstr_len(*s));
+        if (!copy) {
+            return NULL;
+        }
+        mgen_rcstr_release(*s);
+        *s = copy;
+    }
+    return mgen_rcstr_header(*s)->bytes;
+}
+
+/**
+ * Append the first len bytes of tail to *s (Python s += tail)
+ * In place when *s is unshared and has room; otherwise *s is replaced by a
+ * copy with doubled capacity, so repeated appends cost O(total bytes)
+ */
+static void mgen_rcstr_append_n(mgen_rcstr_t* s, const char* tail, size_t len) {
+    if (!s || !tail) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String is NULL");
+        return;
+    }
+    if (!*s) {
+        *s = mgen_rcstr_new_n(tail, len);
+        return;
+    }
+    mgen_rcstr_header_t* header = mgen_rcstr_header(*s);
+    if (mgen_rcstr_refcount(*s) == 1 && header->capacity - header->len >= len) {
+        memmove(header->bytes + header->len, tail, len);
+        header->len += len;
+        header->bytes[header->len] = '\0';
+        return;
+    }
+
+    mgen_rcstr_t grown = mgen_rcstr_with_capacity(*s, header->len, (header->len + len) * 2);
+    if (!grown) {
+        return;
+    }
+    mgen_rcstr_header_t* grown_header = mgen_rcstr_header(grown);
+    memcpy(grown_header->bytes + header->len, tail, len);
+    grown_header->len = header->len + len;
+    grown_header->bytes[grown_header->len] = '\0';
+    mgen_rcstr_release(*s);
+    *s = grown;
+}
+
+static inline void mgen_rcstr_append(mgen_rcstr_t* s, const char* tail) {
+    if (!tail) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String is NULL");
+        return;
+    }
+    mgen_rcstr_append_n(s, tail, strlen(tail));
+}
+
+/**
+ * New string a + b (either may be a plain C string)
+ */
+static mgen_rcstr_t mgen_rcstr_concat(const char* a, const char* b) {
+    if (!a || !b) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Cannot concatenate NULL strings");
+        return NULL;
+    }
+    size_t len_a = strlen(a);
+    size_t len_b = strlen(b);
+    mgen_rcstr_t result = mgen_rcstr_with_capacity(a, len_a, len_a + len_b);
+    if (!result) {
+        return NULL;
+    }
+    mgen_rcstr_header_t* header = mgen_rcstr_header(result);
+    memcpy(header->bytes + len_a, b, len_b + 1);
+    header->len = len_a + len_b;
+    return result;
+}
+
+/**
+ * s[start:stop] with Python clamping of negative and out-of-range bounds
+ * The whole string is shared; any shorter slice is a new string
+ */
+static mgen_rcstr_t mgen_rcstr_slice(mgen_rcstr_t s, long start, long stop) {
+    if (!s) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String is NULL");
+        return NULL;
+    }
+    long len = (long)mgen_rcstr_len(s);
+    if (start < 0) start = start + len < 0 ? 0 : start + len;
+    if (stop < 0) stop = stop + len < 0 ? 0 : stop + len;
+    if (start > len) start = len;
+    if (stop > len) stop = len;
+    if (stop < start) stop = start;
+
+    if (start == 0 && stop == len) {
+        return mgen_rcstr_retain(s);
+    }
+    return mgen_rcstr_new_n(s + start, (size_t)(stop - start));
+}
+
+/**
+ * Vector of shared strings
+ * Elements are references, not copies: pushing, cloning and returning an
+ * element share the bytes, and drop releases every reference.
+ */
+typedef struct {
+    mgen_rcstr_t* data;
+    size_t size;
+    size_t capacity;
+} vec_rcstr;
+
+#define VEC_RCSTR_DEFAULT_CAPACITY 8
+
+static bool vec_rcstr_reserve(vec_rcstr* vec, size_t capacity) {
+    if (capacity <= vec->capacity) {
+        return true;
+    }
+    mgen_rcstr_t* data = (mgen_rcstr_t*)realloc((void*)vec->data, capacity * sizeof(mgen_rcstr_t));
+    if (!data) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow shared string vector");
+        return false;
+    }
+    vec->data = data;
+    vec->capacity = capacity;
+    return true;
+}
+
+/**
+ * Append s, taking over the caller's reference (e.g. a fresh mgen_rcstr_concat result)
+ */
+static void vec_rcstr_push_owned(vec_rcstr* vec, mgen_rcstr_t s) {
+    if (!vec) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL shared string vector");
+        return;
+    }
+    if (vec->size == vec->capacity &&
+        !vec_rcstr_reserve(vec, vec->capacity ? vec->capacity * 2 : VEC_RCSTR_DEFAULT_CAPACITY)) {
+        mgen_rcstr_release(s);
+        return;
+    }
+    vec->data[vec->size++] = s;
+}
+
+/**
+ * Append a shared reference to s (no copy)
+ */
+static inline void vec_rcstr_push(vec_rcstr* vec, mgen_rcstr_t s) {
+    vec_rcstr_push_owned(vec, mgen_rcstr_retain(s));
+}
+
+/**
+ * Append a copy of a plain C string (literals and other non-shared strings)
+ */
+static inline void vec_rcstr_push_cstr(vec_rcstr* vec, const char* str) {
+    vec_rcstr_push_owned(vec, str ? mgen_rcstr_new(str) : NULL);
+}
+
+/**
+ * Element at index (borrowed: retain it to keep it past the vector)
+ */
+static mgen_rcstr_t vec_rcstr_at(const vec_rcstr* vec, size_t index) {
+    if (!vec || index >= vec->size) {
+        MGEN_SET_ERROR(MGEN_ERROR_INDEX, "Index out of bounds");
+        return NULL;
+    }
+    return vec->data[index];
+}
+
+/**
+ * Replace the element at index with a shared reference to s
+ */
+static void vec_rcstr_set(vec_rcstr* vec, size_t index, mgen_rcstr_t s) {
+    if (!vec || index >= vec->size) {
+        MGEN_SET_ERROR(MGEN_ERROR_INDEX, "Index out of bounds");
+        return;
+    }
+    mgen_rcstr_assign(&vec->data[index], s);
+}
+
+static inline size_t vec_rcstr_size(const vec_rcstr* vec) {
+    return vec ? vec->size : 0;
+}
+
+/**
+ * Copy of the vector sharing every element: O(n) pointer copies, no string copies
+ */
+static vec_rcstr vec_rcstr_clone(const vec_rcstr* vec) {
+    vec_rcstr copy = {0};
+    if (!vec || vec->size == 0 || !vec_rcstr_reserve(&copy, vec->size)) {
+        return copy;
+    }
+    for (size_t i = 0; i < vec->size; i++) {
+        copy.data[i] = mgen_rcstr_retain(vec->data[i]);
+    }
+    copy.size = vec->size;
+    return copy;
+}
+
+static void vec_rcstr_clear(vec_rcstr* vec) {
+    if (!vec) return;
+    for (size_t i = 0; i < vec->size; i++) {
+        mgen_rcstr_release(vec->data[i]);
+    }
+    vec->size = 0;
+}
+
+static void vec_rcstr_drop(vec_rcstr* vec) {
+    if (!vec) return;
+    vec_rcstr_clear(vec);
+    free((void*)vec->data);
+    vec->data = NULL;
+    vec->capacity = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_RCSTR_H
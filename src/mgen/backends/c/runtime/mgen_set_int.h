@@ -2,6 +2,16 @@
  * Simple hash set for integers
  * Single-header implementation for code generation
  * stb-library style: static functions for single-file output
+ *
+ * Separate chaining over a power-of-two bucket array. Buckets are chosen by
+ * Fibonacci hashing (multiply by 2^64/phi, keep the top bits), so there is no
+ * modulo on the hot path and sequential or strided keys spread evenly. The
+ * table doubles once it averages one entry per bucket.
+ *
+ * Doubling is incremental: the previous bucket array is kept alongside the new
+ * one and SET_INT_MIGRATE_STEP of its buckets move over on every insert and
+ * remove, so no single insert relinks the whole set. Lookups check both arrays
+ * until the migration finishes. set_int_reserve sizes the table up front.
  */
 
 #ifndef MGEN_SET_INT_H
@@ -9,14 +19,18 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include "mgen_error_handling.h"
+#include "mgen_memory_ops.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#define SET_INT_DEFAULT_BUCKET_COUNT 16
+#define SET_INT_DEFAULT_BUCKET_COUNT 16  // Must be a power of two
+#define SET_INT_DEFAULT_BUCKET_SHIFT 60  // 64 - log2(SET_INT_DEFAULT_BUCKET_COUNT)
+#define SET_INT_MIGRATE_STEP 2           // Old buckets migrated per insert/remove during a rehash
 
 // Hash set entry for separate chaining
 typedef struct mgen_set_int_entry {
@@ -27,14 +41,19 @@ typedef struct mgen_set_int_entry {
 // Hash set structure (STC-compatible naming)
 typedef struct {
     mgen_set_int_entry_t** buckets;
-    size_t bucket_count;
+    size_t bucket_count;       // Power of two
     size_t size;
+    mgen_memory_pool_t* pool;  // Optional entry allocator (NULL = malloc/free)
+    unsigned bucket_shift;     // 64 - log2(bucket_count)
+    mgen_set_int_entry_t** old_buckets;  // Half-size array still being migrated (NULL when not rehashing)
+    size_t old_bucket_count;             // bucket_count / 2 while migrating
+    size_t migrate_index;                // Old buckets below this index are already empty
 } set_int;
 
 // Iterator support for set traversal
 typedef struct {
     const set_int* set;
-    size_t bucket_index;
+    size_t bucket_index;  // Old buckets first, then the current array
     mgen_set_int_entry_t* current_entry;
     int* ref;  // Pointer to current value (STC-compatible)
 } set_int_iter;
@@ -42,20 +61,119 @@ typedef struct {
 // Internal helper functions
 
 /**
- * Simple hash function for integers
+ * Bucket index for value (Fibonacci hashing)
+ * The xor-shift folds high key bits down first, so keys that differ only above
+ * the bucket bits (multiples of 2^16 and up) still land in different buckets.
  */
-static size_t set_int_hash(int value, size_t bucket_count) {
-    // For integers, we can use identity with modulo
-    // Handle negative values by taking absolute value
-    unsigned int u = (value < 0) ? (unsigned int)(-value) : (unsigned int)value;
-    return u % bucket_count;
+static inline size_t set_int_hash(int value, unsigned bucket_shift) {
+    uint64_t h = (uint64_t)(uint32_t)value;
+    h ^= h >> 15;
+    return (size_t)((h * 0x9E3779B97F4A7C15ULL) >> bucket_shift);
 }
 
 /**
- * Create a new entry
+ * Allocate an empty power-of-two bucket array
  */
-static mgen_set_int_entry_t* set_int_entry_new(int value) {
-    mgen_set_int_entry_t* entry = malloc(sizeof(mgen_set_int_entry_t));
+static bool set_int_alloc_buckets(set_int* set, size_t bucket_count, unsigned bucket_shift) {
+    MGEN_PROFILE_ALLOC(bucket_count * sizeof(mgen_set_int_entry_t*));
+    mgen_set_int_entry_t** buckets = calloc(bucket_count, sizeof(mgen_set_int_entry_t*));
+    if (!buckets) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate set buckets");
+        return false;
+    }
+    set->buckets = buckets;
+    set->bucket_count = bucket_count;
+    set->bucket_shift = bucket_shift;
+    return true;
+}
+
+/**
+ * Relink a chain of entries into the current bucket array (entries themselves do not move)
+ */
+static void set_int_relink(set_int* set, mgen_set_int_entry_t* entry) {
+    while (entry) {
+        mgen_set_int_entry_t* next = entry->next;
+        size_t index = set_int_hash(entry->value, set->bucket_shift);
+        entry->next = set->buckets[index];
+        set->buckets[index] = entry;
+        entry = next;
+    }
+}
+
+/**
+ * Move up to steps old buckets into the current array
+ * Frees the old array once the last bucket has moved
+ */
+static void set_int_migrate(set_int* set, size_t steps) {
+    while (set->old_buckets && steps-- > 0) {
+        mgen_set_int_entry_t* chain = set->old_buckets[set->migrate_index];
+        set->old_buckets[set->migrate_index] = NULL;
+        set_int_relink(set, chain);
+
+        if (++set->migrate_index == set->old_bucket_count) {
+            free(set->old_buckets);
+            set->old_buckets = NULL;
+            set->old_bucket_count = 0;
+            set->migrate_index = 0;
+        }
+    }
+}
+
+/**
+ * Start doubling the bucket array; entries move over in later set_int_migrate calls
+ */
+static bool set_int_grow(set_int* set) {
+    // Steps keep pace with growth, but finish any straggling migration before starting another
+    set_int_migrate(set, SIZE_MAX);
+
+    mgen_set_int_entry_t** old_buckets = set->buckets;
+    size_t old_count = set->bucket_count;
+    if (!set_int_alloc_buckets(set, old_count * 2, set->bucket_shift - 1)) {
+        return false;
+    }
+
+    set->old_buckets = old_buckets;
+    set->old_bucket_count = old_count;
+    set->migrate_index = 0;
+    return true;
+}
+
+/**
+ * Find value in one chain, or NULL
+ */
+static inline mgen_set_int_entry_t* set_int_chain_find(mgen_set_int_entry_t* entry, int value) {
+    while (entry && entry->value != value) {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+/**
+ * Find the entry holding value in either bucket array, or NULL
+ */
+static mgen_set_int_entry_t* set_int_find(const set_int* set, int value) {
+    mgen_set_int_entry_t* entry = set_int_chain_find(set->buckets[set_int_hash(value, set->bucket_shift)], value);
+    if (!entry && set->old_buckets) {
+        // Not migrated yet (the old array has half the buckets: one more shift bit)
+        entry = set_int_chain_find(set->old_buckets[set_int_hash(value, set->bucket_shift + 1)], value);
+    }
+    return entry;
+}
+
+/**
+ * Bucket at a combined iteration index: old buckets come first while migrating
+ */
+static inline mgen_set_int_entry_t* set_int_bucket_at(const set_int* set, size_t index) {
+    return index < set->old_bucket_count ? set->old_buckets[index] : set->buckets[index - set->old_bucket_count];
+}
+
+/**
+ * Create a new entry (from the set's pool when it has one)
+ */
+static mgen_set_int_entry_t* set_int_entry_new(set_int* set, int value) {
+    MGEN_PROFILE_ALLOC(sizeof(mgen_set_int_entry_t));
+    mgen_set_int_entry_t* entry = set->pool ? mgen_memory_pool_alloc(set->pool, sizeof(mgen_set_int_entry_t))
+                                            : malloc(sizeof(mgen_set_int_entry_t));
     if (!entry) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate set entry");
         return NULL;
@@ -65,13 +183,24 @@ static mgen_set_int_entry_t* set_int_entry_new(int value) {
     return entry;
 }
 
+/**
+ * Free a single entry (back to the pool's free list when pooled)
+ */
+static void set_int_entry_release(set_int* set, mgen_set_int_entry_t* entry) {
+    if (set->pool) {
+        mgen_memory_pool_release(set->pool, entry, sizeof(mgen_set_int_entry_t));
+    } else {
+        free(entry);
+    }
+}
+
 /**
  * Free an entry chain
  */
-static void set_int_entry_free(mgen_set_int_entry_t* entry) {
+static void set_int_entry_free(set_int* set, mgen_set_int_entry_t* entry) {
     while (entry) {
         mgen_set_int_entry_t* next = entry->next;
-        free(entry);
+        set_int_entry_release(set, entry);
         entry = next;
     }
 }
@@ -81,14 +210,18 @@ static void set_int_entry_free(mgen_set_int_entry_t* entry) {
  * Initial capacity defaults to 16 buckets
  */
 static set_int set_int_init(void) {
-    set_int set;
-    set.bucket_count = SET_INT_DEFAULT_BUCKET_COUNT;
-    set.size = 0;
-    set.buckets = calloc(SET_INT_DEFAULT_BUCKET_COUNT, sizeof(mgen_set_int_entry_t*));
-    if (!set.buckets) {
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate set buckets");
-        set.bucket_count = 0;
-    }
+    set_int set = {0};
+    set_int_alloc_buckets(&set, SET_INT_DEFAULT_BUCKET_COUNT, SET_INT_DEFAULT_BUCKET_SHIFT);
+    return set;
+}
+
+/**
+ * Create an integer set whose entries are carved from pool
+ * Removed entries are recycled by later inserts; the pool must outlive the set
+ */
+static set_int set_int_init_with_pool(mgen_memory_pool_t* pool) {
+    set_int set = set_int_init();
+    set.pool = pool;
     return set;
 }
 
@@ -103,29 +236,24 @@ static bool set_int_insert(set_int* set, int value) {
     }
 
     // Lazy initialization for {0}-initialized sets
-    if (!set->buckets) {
-        set->bucket_count = SET_INT_DEFAULT_BUCKET_COUNT;
-        set->buckets = calloc(SET_INT_DEFAULT_BUCKET_COUNT, sizeof(mgen_set_int_entry_t*));
-        if (!set->buckets) {
-            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate set buckets");
-            set->bucket_count = 0;
-            return false;
-        }
+    if (!set->buckets && !set_int_alloc_buckets(set, SET_INT_DEFAULT_BUCKET_COUNT, SET_INT_DEFAULT_BUCKET_SHIFT)) {
+        return false;
     }
 
-    size_t index = set_int_hash(value, set->bucket_count);
+    set_int_migrate(set, SET_INT_MIGRATE_STEP);
 
     // Check if value already exists
-    mgen_set_int_entry_t* entry = set->buckets[index];
-    while (entry) {
-        if (entry->value == value) {
-            return false; // Already present
-        }
-        entry = entry->next;
+    if (set_int_find(set, value)) {
+        return false; // Already present
     }
 
-    // Insert new entry at head of chain
-    mgen_set_int_entry_t* new_entry = set_int_entry_new(value);
+    // Insert new entry at head of chain (growing first keeps chains short)
+    if (set->size >= set->bucket_count) {
+        set_int_grow(set);
+    }
+    size_t index = set_int_hash(value, set->bucket_shift);
+
+    mgen_set_int_entry_t* new_entry = set_int_entry_new(set, value);
     if (!new_entry) {
         return false;
     }
@@ -145,17 +273,7 @@ static bool set_int_contains(const set_int* set, int value) {
         return false;
     }
 
-    size_t index = set_int_hash(value, set->bucket_count);
-
-    mgen_set_int_entry_t* entry = set->buckets[index];
-    while (entry) {
-        if (entry->value == value) {
-            return true;
-        }
-        entry = entry->next;
-    }
-
-    return false;
+    return set_int_find(set, value) != NULL;
 }
 
 /**
@@ -168,23 +286,68 @@ static bool set_int_remove(set_int* set, int value) {
         return false;
     }
 
-    size_t index = set_int_hash(value, set->bucket_count);
+    set_int_migrate(set, SET_INT_MIGRATE_STEP);
+
+    // Current array first, then the not-yet-migrated old bucket
+    mgen_set_int_entry_t** chains[2] = {&set->buckets[set_int_hash(value, set->bucket_shift)], NULL};
+    if (set->old_buckets) {
+        chains[1] = &set->old_buckets[set_int_hash(value, set->bucket_shift + 1)];
+    }
 
-    mgen_set_int_entry_t** entry_ptr = &set->buckets[index];
-    while (*entry_ptr) {
-        mgen_set_int_entry_t* entry = *entry_ptr;
-        if (entry->value == value) {
-            *entry_ptr = entry->next;
-            free(entry);
-            set->size--;
-            return true;
+    for (int c = 0; c < 2 && chains[c]; c++) {
+        mgen_set_int_entry_t** entry_ptr = chains[c];
+        while (*entry_ptr) {
+            mgen_set_int_entry_t* entry = *entry_ptr;
+            if (entry->value == value) {
+                *entry_ptr = entry->next;
+                set_int_entry_release(set, entry);
+                set->size--;
+                return true;
+            }
+            entry_ptr = &entry->next;
         }
-        entry_ptr = &entry->next;
     }
 
     return false; // Not found
 }
 
+/**
+ * Size the bucket array for at least count elements
+ * One full relink now, so the inserts that follow never grow or migrate
+ */
+static bool set_int_reserve(set_int* set, size_t count) {
+    if (!set) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL set");
+        return false;
+    }
+
+    if (!set->buckets && !set_int_alloc_buckets(set, SET_INT_DEFAULT_BUCKET_COUNT, SET_INT_DEFAULT_BUCKET_SHIFT)) {
+        return false;
+    }
+    set_int_migrate(set, SIZE_MAX);
+
+    size_t bucket_count = set->bucket_count;
+    unsigned bucket_shift = set->bucket_shift;
+    while (bucket_count < count && bucket_shift > 1) {
+        bucket_count *= 2;
+        bucket_shift--;
+    }
+    if (bucket_count == set->bucket_count) {
+        return true;
+    }
+
+    mgen_set_int_entry_t** old_buckets = set->buckets;
+    size_t old_count = set->bucket_count;
+    if (!set_int_alloc_buckets(set, bucket_count, bucket_shift)) {
+        return false;
+    }
+    for (size_t i = 0; i < old_count; i++) {
+        set_int_relink(set, old_buckets[i]);
+    }
+    free(old_buckets);
+    return true;
+}
+
 /**
  * Get number of elements in set
  */
@@ -209,11 +372,20 @@ static void set_int_clear(set_int* set) {
 
     for (size_t i = 0; i < set->bucket_count; i++) {
         if (set->buckets[i]) {
-            set_int_entry_free(set->buckets[i]);
+            set_int_entry_free(set, set->buckets[i]);
             set->buckets[i] = NULL;
         }
     }
 
+    // Abandon any migration: its remaining chains go too
+    for (size_t i = set->migrate_index; i < set->old_bucket_count; i++) {
+        set_int_entry_free(set, set->old_buckets[i]);
+    }
+    free(set->old_buckets);
+    set->old_buckets = NULL;
+    set->old_bucket_count = 0;
+    set->migrate_index = 0;
+
     set->size = 0;
 }
 
@@ -229,6 +401,7 @@ static void set_int_drop(set_int* set) {
     free(set->buckets);
     set->buckets = NULL;
     set->bucket_count = 0;
+    set->bucket_shift = 0;
     set->size = 0;
 }
 
@@ -247,10 +420,10 @@ static set_int_iter set_int_begin(const set_int* set) {
     }
 
     // Find first non-empty bucket
-    for (size_t i = 0; i < set->bucket_count; i++) {
-        if (set->buckets[i]) {
+    for (size_t i = 0; i < set->old_bucket_count + set->bucket_count; i++) {
+        if (set_int_bucket_at(set, i)) {
             iter.bucket_index = i;
-            iter.current_entry = set->buckets[i];
+            iter.current_entry = set_int_bucket_at(set, i);
             iter.ref = &iter.current_entry->value;
             break;
         }
@@ -278,10 +451,10 @@ static void set_int_next(set_int_iter* iter) {
     }
 
     // Find next non-empty bucket
-    for (size_t i = iter->bucket_index + 1; i < iter->set->bucket_count; i++) {
-        if (iter->set->buckets[i]) {
+    for (size_t i = iter->bucket_index + 1; i < iter->set->old_bucket_count + iter->set->bucket_count; i++) {
+        if (set_int_bucket_at(iter->set, i)) {
             iter->bucket_index = i;
-            iter->current_entry = iter->set->buckets[i];
+            iter->current_entry = set_int_bucket_at(iter->set, i);
             iter->ref = &iter->current_entry->value;
             return;
         }
@@ -292,6 +465,15 @@ static void set_int_next(set_int_iter* iter) {
     iter->ref = NULL;
 }
 
+
+/**
+ * Get past-the-end iterator (ref is NULL)
+ */
+static inline set_int_iter set_int_end(const set_int* set) {
+    set_int_iter iter = {set, set ? set->old_bucket_count + set->bucket_count : 0, NULL, NULL};
+    return iter;
+}
+
 #ifdef __cplusplus
 }
 #endif
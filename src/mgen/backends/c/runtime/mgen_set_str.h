@@ -2,6 +2,9 @@
  * Simple hash set for strings
  * Clean, type-safe implementation for code generation
  * stb-library style: static functions for single-file output
+ *
+ * Values are copied into a chunked string arena owned by the set:
+ * inserts do not malloc per string and drop/clear free O(chunks) blocks.
  */
 
 #ifndef MGEN_SET_STR_H
@@ -9,6 +12,8 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "mgen_str_arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,57 +21,30 @@ extern "C" {
 
 // Hash set entry structure
 typedef struct {
-    char* value;       // String value (owned)
-    size_t hash;
+    char* value;                       // String value (arena-owned)
+    size_t hash;                       // Cached hash
+    uint32_t len;                      // Cached length
+    char prefix[MGEN_STR_PREFIX_LEN];  // Leading bytes for fast mismatch rejection
     bool occupied;
+    bool deleted;                      // Tombstone left by erase (keeps probe chains intact)
 } set_str_entry;
 
 // Hash set structure
 typedef struct {
     set_str_entry* buckets;
     size_t size;           // Number of entries
-    size_t capacity;       // Number of buckets
+    size_t capacity;       // Number of buckets (power of two)
+    size_t tombstones;     // Number of deleted buckets
+    uint64_t seed;         // Value hash seed (see mgen_str_hash.h)
+    mgen_str_arena_t arena;  // Storage for all values
 } set_str;
 
-/**
- * Create a new string set
- * Supports {0} initialization with lazy bucket allocation
- */
-
-/**
- * Insert a string into the set
- * Takes ownership of a copy of the string
- * Returns true if inserted (new), false if already present
- */
-
-/**
- * Check if string is in the set
- */
-
-/**
- * Remove a string from the set
- * Returns true if removed, false if not found
- */
-
-/**
- * Get number of entries
- */
-
-/**
- * Check if set is empty
- */
-
-/**
- * Clear all entries (keep capacity)
- */
-
-/**
- * Free all memory
- */
-
-/**
- * Reserve capacity
- */
+// Cursor over occupied buckets: a linear scan of the bucket array (STC-compatible)
+typedef struct {
+    char** ref;  // Current value, NULL once past the end
+    const set_str* set;
+    size_t index;
+} set_str_iter;
 
 /**
  * Simple hash set for strings - Implementation
@@ -74,67 +52,81 @@ typedef struct {
  */
 
 #include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
 #include <stdlib.h>
 #include <string.h>
 
-#define DEFAULT_CAPACITY 16
-#define LOAD_FACTOR 0.75
-#define GROWTH_FACTOR 2
-
-// FNV-1a hash function for strings
-static size_t hash_string(const char* str) {
-    if (!str) return 0;
-
-    size_t hash = 2166136261u;
-    while (*str) {
-        hash ^= (unsigned char)(*str++);
-        hash *= 16777619u;
-    }
-    return hash;
-}
+#define SET_STR_DEFAULT_CAPACITY 16
 
+/**
+ * Create a new string set
+ * Supports {0} initialization with lazy bucket allocation
+ */
 static set_str set_str_init(void) {
-    set_str set;
-    set.buckets = NULL;  // Lazy allocation
-    set.size = 0;
-    set.capacity = 0;
+    set_str set = {0};  // Lazy allocation
     return set;
 }
 
-static void set_str_grow(set_str* set) {
-    size_t new_capacity = (set->capacity == 0) ? DEFAULT_CAPACITY : set->capacity * GROWTH_FACTOR;
-
-    // Allocate new buckets
+/**
+ * Rehash all live entries into new_capacity buckets, dropping tombstones
+ */
+static bool set_str_rehash(set_str* set, size_t new_capacity) {
+    MGEN_PROFILE_ALLOC(new_capacity * sizeof(set_str_entry));
     set_str_entry* new_buckets = calloc(new_capacity, sizeof(set_str_entry));
     if (!new_buckets) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow string set");
-        return;
+        return false;
     }
 
-    // Rehash existing entries
     if (set->buckets) {
         for (size_t i = 0; i < set->capacity; i++) {
             if (set->buckets[i].occupied) {
-                // Find new position
-                size_t hash = set->buckets[i].hash;
-                size_t idx = hash % new_capacity;
-
-                // Linear probing
+                // Linear probing from the cached hash
+                size_t idx = set->buckets[i].hash & (new_capacity - 1);
                 while (new_buckets[idx].occupied) {
-                    idx = (idx + 1) % new_capacity;
+                    idx = (idx + 1) & (new_capacity - 1);
                 }
-
-                // Move entry (transfer ownership)
                 new_buckets[idx] = set->buckets[i];
             }
         }
         free(set->buckets);
+    } else {
+        set->seed = mgen_str_hash_seed(set);
     }
 
     set->buckets = new_buckets;
     set->capacity = new_capacity;
+    set->tombstones = 0;
+    return true;
 }
 
+/**
+ * Find the bucket holding value, or NULL
+ */
+static set_str_entry* set_str_find(const set_str* set, const char* value, size_t hash, size_t len,
+                                   const char* prefix) {
+    size_t mask = set->capacity - 1;
+    size_t idx = hash & mask;
+
+    for (size_t probes = 0; probes < set->capacity; probes++) {
+        set_str_entry* entry = &set->buckets[idx];
+        if (!entry->occupied && !entry->deleted) {
+            return NULL;  // Empty slot means value not found
+        }
+        if (entry->occupied &&
+            mgen_str_key_equals(entry->hash, entry->len, entry->prefix, entry->value, hash, len, prefix, value)) {
+            return entry;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * Insert a string into the set
+ * Takes ownership of a copy of the string
+ * Returns true if inserted (new), false if already present
+ */
 static bool set_str_insert(set_str* set, const char* value) {
     if (!set) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL string set");
@@ -146,196 +138,203 @@ static bool set_str_insert(set_str* set, const char* value) {
         return false;
     }
 
-    // Lazy initialization
+    // Lazy initialization, then keep (live + deleted) buckets under 75% load
     if (set->capacity == 0) {
-        set_str_grow(set);
-    }
-
-    // Check load factor
-    if ((double)set->size / set->capacity > LOAD_FACTOR) {
-        set_str_grow(set);
+        if (!set_str_rehash(set, SET_STR_DEFAULT_CAPACITY)) {
+            return false;
+        }
+    } else if ((set->size + set->tombstones + 1) * 4 > set->capacity * 3) {
+        size_t new_capacity = (set->size + 1) * 2 > set->capacity ? set->capacity * 2 : set->capacity;
+        if (!set_str_rehash(set, new_capacity)) {
+            return false;
+        }
     }
 
-    size_t hash = hash_string(value);
-    size_t idx = hash % set->capacity;
-    size_t start_idx = idx;
+    size_t len;
+    size_t hash = mgen_str_hash(value, &len, set->seed);
+    char prefix[MGEN_STR_PREFIX_LEN];
+    mgen_str_prefix_init(prefix, value, len);
 
-    // Linear probing to find slot
-    do {
-        if (set->buckets[idx].occupied) {
-            // Check if value already exists
-            if (strcmp(set->buckets[idx].value, value) == 0) {
-                return false;  // Already present
-            }
-        } else {
-            // Found empty slot - insert here
-            set->buckets[idx].value = strdup(value);
-            if (!set->buckets[idx].value) {
-                MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to duplicate string");
-                return false;
-            }
-            set->buckets[idx].hash = hash;
-            set->buckets[idx].occupied = true;
-            set->size++;
-            return true;  // Inserted
-        }
+    if (set_str_find(set, value, hash, len, prefix)) {
+        return false;  // Already present
+    }
 
-        idx = (idx + 1) % set->capacity;
-    } while (idx != start_idx);
+    // Linear probing to the first free (empty or deleted) slot
+    size_t mask = set->capacity - 1;
+    size_t idx = hash & mask;
+    while (set->buckets[idx].occupied) {
+        idx = (idx + 1) & mask;
+    }
 
-    // Set is full (should not happen due to load factor check)
-    MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String set is full");
-    return false;
+    set_str_entry* entry = &set->buckets[idx];
+    char* copy = mgen_str_arena_strndup(&set->arena, value, len);
+    if (!copy) {
+        return false;
+    }
+    if (entry->deleted) {
+        set->tombstones--;
+    }
+    entry->value = copy;
+    entry->hash = hash;
+    entry->len = (uint32_t)len;
+    memcpy(entry->prefix, prefix, MGEN_STR_PREFIX_LEN);
+    entry->occupied = true;
+    entry->deleted = false;
+    set->size++;
+    return true;  // Inserted
 }
 
+/**
+ * Check if string is in the set
+ */
 static bool set_str_contains(const set_str* set, const char* value) {
     if (!set || !value || set->capacity == 0) {
         return false;
     }
 
-    size_t hash = hash_string(value);
-    size_t idx = hash % set->capacity;
-    size_t start_idx = idx;
+    size_t len;
+    size_t hash = mgen_str_hash(value, &len, set->seed);
+    char prefix[MGEN_STR_PREFIX_LEN];
+    mgen_str_prefix_init(prefix, value, len);
 
-    // Linear probing to find value
-    do {
-        if (set->buckets[idx].occupied) {
-            if (strcmp(set->buckets[idx].value, value) == 0) {
-                return true;
-            }
-        } else {
-            // Empty slot means value not found
-            return false;
-        }
-        idx = (idx + 1) % set->capacity;
-    } while (idx != start_idx);
-
-    return false;
+    return set_str_find(set, value, hash, len, prefix) != NULL;
 }
 
+/**
+ * Remove a string from the set
+ * Returns true if removed, false if not found
+ * The string stays in the arena until the set is cleared or dropped
+ */
 static bool set_str_erase(set_str* set, const char* value) {
     if (!set || !value || set->capacity == 0) {
         return false;
     }
 
-    size_t hash = hash_string(value);
-    size_t idx = hash % set->capacity;
-    size_t start_idx = idx;
-
-    // Linear probing to find value
-    do {
-        if (set->buckets[idx].occupied) {
-            if (strcmp(set->buckets[idx].value, value) == 0) {
-                // Free string and mark as unoccupied
-                free(set->buckets[idx].value);
-                set->buckets[idx].value = NULL;
-                set->buckets[idx].occupied = false;
-                set->size--;
-                return true;
-            }
-        } else {
-            // Empty slot means value not found
-            return false;
-        }
-        idx = (idx + 1) % set->capacity;
-    } while (idx != start_idx);
+    size_t len;
+    size_t hash = mgen_str_hash(value, &len, set->seed);
+    char prefix[MGEN_STR_PREFIX_LEN];
+    mgen_str_prefix_init(prefix, value, len);
 
-    return false;
+    set_str_entry* entry = set_str_find(set, value, hash, len, prefix);
+    if (!entry) {
+        return false;
+    }
+
+    entry->value = NULL;
+    entry->occupied = false;
+    entry->deleted = true;
+    set->size--;
+    set->tombstones++;
+    return true;
 }
 
+/**
+ * Get number of elements
+ */
 static inline size_t set_str_size(const set_str* set) {
     return set ? set->size : 0;
 }
 
+/**
+ * Check if set is empty
+ */
 static inline bool set_str_empty(const set_str* set) {
     return !set || set->size == 0;
 }
 
+/**
+ * Clear all entries (keep capacity and the largest arena chunk)
+ */
 static inline void set_str_clear(set_str* set) {
     if (!set || !set->buckets) {
         return;
     }
 
-    // Free all strings
-    for (size_t i = 0; i < set->capacity; i++) {
-        if (set->buckets[i].occupied) {
-            free(set->buckets[i].value);
-            set->buckets[i].value = NULL;
-            set->buckets[i].occupied = false;
-        }
-    }
-
+    memset(set->buckets, 0, set->capacity * sizeof(set_str_entry));
+    mgen_str_arena_reset(&set->arena);
     set->size = 0;
+    set->tombstones = 0;
 }
 
+/**
+ * Free all memory
+ */
 static void set_str_drop(set_str* set) {
     if (!set) {
         return;
     }
 
-    // Free all strings
-    if (set->buckets) {
-        for (size_t i = 0; i < set->capacity; i++) {
-            if (set->buckets[i].occupied) {
-                free(set->buckets[i].value);
-            }
-        }
-        free(set->buckets);
-    }
+    free(set->buckets);
+    mgen_str_arena_drop(&set->arena);
 
     set->buckets = NULL;
     set->size = 0;
     set->capacity = 0;
+    set->tombstones = 0;
 }
 
+/**
+ * Reserve capacity
+ */
 static void set_str_reserve(set_str* set, size_t new_capacity) {
     if (!set) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL string set");
         return;
     }
 
-    if (new_capacity <= set->capacity) {
+    // Round up to a power of two so probing can mask instead of divide
+    size_t capacity = SET_STR_DEFAULT_CAPACITY;
+    while (capacity < new_capacity) {
+        capacity *= 2;
+    }
+
+    if (capacity <= set->capacity) {
         return;
     }
 
-    // Save old state
-    set_str_entry* old_buckets = set->buckets;
-    size_t old_capacity = set->capacity;
+    set_str_rehash(set, capacity);
+}
 
-    // Allocate new buckets
-    set->buckets = calloc(new_capacity, sizeof(set_str_entry));
-    if (!set->buckets) {
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to reserve capacity");
-        set->buckets = old_buckets;  // Restore
-        return;
+
+/**
+ * Point the cursor at the first occupied bucket at or after its index
+ */
+static inline void set_str_iter_seek(set_str_iter* iter) {
+    const set_str* set = iter->set;
+    while (iter->index < set->capacity && !set->buckets[iter->index].occupied) {
+        iter->index++;
     }
-    set->capacity = new_capacity;
-    set->size = 0;  // Will be incremented during rehash
-
-    // Rehash existing entries
-    if (old_buckets) {
-        for (size_t i = 0; i < old_capacity; i++) {
-            if (old_buckets[i].occupied) {
-                // Find new position
-                size_t hash = old_buckets[i].hash;
-                size_t idx = hash % new_capacity;
-
-                // Linear probing
-                while (set->buckets[idx].occupied) {
-                    idx = (idx + 1) % new_capacity;
-                }
+    iter->ref = iter->index < set->capacity ? &set->buckets[iter->index].value : NULL;
+}
 
-                // Move entry (transfer ownership)
-                set->buckets[idx] = old_buckets[i];
-                set->size++;
-            }
-        }
-        free(old_buckets);
+/**
+ * Get iterator to beginning of set
+ */
+static inline set_str_iter set_str_begin(const set_str* set) {
+    set_str_iter iter = {NULL, set, 0};
+    if (set && set->buckets) {
+        set_str_iter_seek(&iter);
     }
+    return iter;
 }
 
+/**
+ * Advance iterator to next value
+ */
+static inline void set_str_next(set_str_iter* iter) {
+    if (iter->ref) {
+        iter->index++;
+        set_str_iter_seek(iter);
+    }
+}
 
-// Implementation
+/**
+ * Get past-the-end iterator (ref is NULL)
+ */
+static inline set_str_iter set_str_end(const set_str* set) {
+    set_str_iter iter = {NULL, set, set ? set->capacity : 0};
+    return iter;
+}
 
 #ifdef __cplusplus
 }
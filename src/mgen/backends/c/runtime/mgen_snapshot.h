@@ -0,0 +1,439 @@
+/**
+ * Binary container snapshots: save a container once, map it at startup
+ * Single-header implementation for code generation
+ * stb-library style: static functions for single-file output
+ *
+ * A snapshot is a flat, pointer-free file: a fixed-width header followed by
+ * the items, 64-byte aligned. Vec snapshots (vec_int, vec_double, vec_float)
+ * hold the raw items. map_str_str snapshots hold an open-addressing slot
+ * table of (hash, key, value) offsets into a blob of NUL-terminated strings,
+ * probed linearly at a load factor of at most one half.
+ *
+ * mgen_snapshot_open maps a snapshot with mgen_mmap_file and checks its header
+ * and bounds; it is then used in place: mgen_snapshot_items and
+ * MGEN_SNAPSHOT_VEC_VIEW see the items, mgen_snapshot_str_str_get looks keys up
+ * in the slot table. Nothing is parsed or copied, so opening costs a few page
+ * faults however large the container. mgen_container_load instead rebuilds an
+ * owned, mutable container from the snapshot (one block copy for vecs).
+ *
+ * Files are written in the byte order of the machine that saves them; one
+ * saved with another byte order, version or container kind is rejected with
+ * MGEN_ERROR_VALUE.
+ */
+
+#ifndef MGEN_SNAPSHOT_H
+#define MGEN_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_aligned_alloc.h"
+#include "mgen_error_handling.h"
+#include "mgen_file_ops.h"
+#include "mgen_map_str_str.h"
+#include "mgen_str_hash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MGEN_SNAPSHOT_MAGIC "MGENSNAP"
+#define MGEN_SNAPSHOT_VERSION 1u
+#define MGEN_SNAPSHOT_BYTE_ORDER 0x01020304u
+#define MGEN_SNAPSHOT_ALIGN 64u
+
+// Container kinds: the item type of a vec, or the map layout
+typedef enum {
+    MGEN_SNAPSHOT_INT = 1,
+    MGEN_SNAPSHOT_DOUBLE = 2,
+    MGEN_SNAPSHOT_FLOAT = 3,
+    MGEN_SNAPSHOT_STR_STR = 16,
+} mgen_snapshot_kind_t;
+
+// File header; every field has a fixed width, so the layout is the same for all compilers
+typedef struct {
+    char magic[8];            // MGEN_SNAPSHOT_MAGIC, not NUL-terminated
+    uint32_t version;         // MGEN_SNAPSHOT_VERSION
+    uint32_t byte_order;      // MGEN_SNAPSHOT_BYTE_ORDER as the saving machine stores it
+    uint32_t kind;            // mgen_snapshot_kind_t
+    uint32_t item_size;       // Bytes per item (vecs) or per slot (maps)
+    uint64_t count;           // Items or entries
+    uint64_t capacity;        // Slots (maps: a power of two); count for vecs
+    uint64_t data_offset;     // File offset of the items or slots
+    uint64_t strings_offset;  // File offset of the string blob (maps)
+    uint64_t strings_size;    // Bytes in the string blob
+    uint64_t seed;            // Key hash seed of the slots (see mgen_str_hash.h)
+} mgen_snapshot_header_t;
+
+// Map slot: offsets into the string blob; key 0 marks an empty slot (the blob starts with a NUL)
+typedef struct {
+    uint64_t hash;
+    uint64_t key;
+    uint64_t value;
+    uint32_t key_len;
+    uint32_t value_len;  // UINT32_MAX: the value is NULL
+} mgen_snapshot_slot_t;
+
+// An open snapshot; release with mgen_snapshot_close
+typedef struct {
+    mgen_mapped_file_t file;
+    const mgen_snapshot_header_t* header;
+} mgen_snapshot_t;
+
+#define MGEN_SNAPSHOT_NULL_VALUE UINT32_MAX
+
+static inline uint64_t mgen_snapshot_align(uint64_t offset) {
+    return (offset + MGEN_SNAPSHOT_ALIGN - 1) & ~(uint64_t)(MGEN_SNAPSHOT_ALIGN - 1);
+}
+
+static inline mgen_snapshot_header_t mgen_snapshot_header(uint32_t kind, uint32_t item_size, uint64_t count) {
+    mgen_snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MGEN_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = MGEN_SNAPSHOT_VERSION;
+    header.byte_order = MGEN_SNAPSHOT_BYTE_ORDER;
+    header.kind = kind;
+    header.item_size = item_size;
+    header.count = count;
+    header.capacity = count;
+    header.data_offset = mgen_snapshot_align(sizeof(mgen_snapshot_header_t));
+    return header;
+}
+
+// Write size bytes at offset, zero-filling the gap after what was written so far
+static bool mgen_snapshot_write_at(FILE* out, uint64_t* written, uint64_t offset, const void* data, size_t size) {
+    static const char zeros[MGEN_SNAPSHOT_ALIGN] = {0};
+    while (*written < offset) {
+        size_t gap = (size_t)(offset - *written < sizeof(zeros) ? offset - *written : sizeof(zeros));
+        if (fwrite(zeros, 1, gap, out) != gap) {
+            return false;
+        }
+        *written += gap;
+    }
+    if (size > 0 && fwrite(data, 1, size, out) != size) {
+        return false;
+    }
+    *written += size;
+    return true;
+}
+
+static mgen_error_t mgen_snapshot_create(const char* path, FILE** out) {
+    if (!path) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Snapshot path is NULL");
+        return MGEN_ERROR_VALUE;
+    }
+    *out = fopen(path, "wb");
+    if (!*out) {
+        MGEN_SET_ERROR_FMT(MGEN_ERROR_IO, "Cannot write snapshot %s", path);
+        return MGEN_ERROR_IO;
+    }
+    return MGEN_OK;
+}
+
+static mgen_error_t mgen_snapshot_finish(FILE* out, const char* path, bool ok) {
+    if (fclose(out) != 0 || !ok) {
+        MGEN_SET_ERROR_FMT(MGEN_ERROR_IO, "Failed writing snapshot %s", path);
+        return MGEN_ERROR_IO;
+    }
+    return MGEN_OK;
+}
+
+/**
+ * Save count items of a vec (see mgen_container_save)
+ */
+static mgen_error_t mgen_snapshot_save_items(const char* path, uint32_t kind, const void* items, size_t count,
+                                             size_t item_size) {
+    FILE* out;
+    mgen_error_t error = mgen_snapshot_create(path, &out);
+    if (error != MGEN_OK) {
+        return error;
+    }
+    mgen_snapshot_header_t header = mgen_snapshot_header(kind, (uint32_t)item_size, count);
+    uint64_t written = 0;
+    bool ok = mgen_snapshot_write_at(out, &written, 0, &header, sizeof(header)) &&
+              mgen_snapshot_write_at(out, &written, header.data_offset, items, count * item_size);
+    return mgen_snapshot_finish(out, path, ok);
+}
+
+/**
+ * Save a map_str_str: its entries are laid out in a new slot table and string blob
+ */
+static mgen_error_t mgen_map_str_str_save(const char* path, const map_str_str* map) {
+    size_t count = map ? map->size : 0;
+    uint64_t capacity = 2;
+    while (capacity < 2 * (uint64_t)count) {
+        capacity <<= 1;
+    }
+    mgen_snapshot_slot_t* slots = (mgen_snapshot_slot_t*)calloc((size_t)capacity, sizeof(mgen_snapshot_slot_t));
+    if (!slots) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate snapshot slots");
+        return MGEN_ERROR_MEMORY;
+    }
+
+    // Blob offsets of each string, assigned in bucket order; offset 0 is the NUL for empty slots
+    mgen_snapshot_header_t header = mgen_snapshot_header(MGEN_SNAPSHOT_STR_STR, sizeof(mgen_snapshot_slot_t), count);
+    header.capacity = capacity;
+    header.strings_size = 1;
+    for (map_str_str_iter it = map_str_str_begin(map); it.ref; map_str_str_next(&it)) {
+        size_t key_len = it.ref->key_len;
+        uint64_t hash = mgen_str_hash_bytes(it.ref->key, key_len, header.seed);
+        uint64_t index = hash & (capacity - 1);
+        while (slots[index].key) {
+            index = (index + 1) & (capacity - 1);
+        }
+        mgen_snapshot_slot_t* slot = &slots[index];
+        slot->hash = hash;
+        slot->key = header.strings_size;
+        slot->key_len = (uint32_t)key_len;
+        header.strings_size += key_len + 1;
+        if (it.ref->value) {
+            size_t value_len = strlen(it.ref->value);
+            slot->value = header.strings_size;
+            slot->value_len = (uint32_t)value_len;
+            header.strings_size += value_len + 1;
+        } else {
+            slot->value_len = MGEN_SNAPSHOT_NULL_VALUE;
+        }
+    }
+    header.strings_offset = mgen_snapshot_align(header.data_offset + capacity * sizeof(mgen_snapshot_slot_t));
+
+    FILE* out;
+    mgen_error_t error = mgen_snapshot_create(path, &out);
+    if (error != MGEN_OK) {
+        free(slots);
+        return error;
+    }
+    uint64_t written = 0;
+    bool ok = mgen_snapshot_write_at(out, &written, 0, &header, sizeof(header)) &&
+              mgen_snapshot_write_at(out, &written, header.data_offset, slots, capacity * sizeof(*slots)) &&
+              mgen_snapshot_write_at(out, &written, header.strings_offset, "", 1);
+    // The strings follow in the order their offsets were assigned
+    for (map_str_str_iter it = map_str_str_begin(map); ok && it.ref; map_str_str_next(&it)) {
+        ok = mgen_snapshot_write_at(out, &written, written, it.ref->key, (size_t)it.ref->key_len + 1);
+        if (ok && it.ref->value) {
+            ok = mgen_snapshot_write_at(out, &written, written, it.ref->value, strlen(it.ref->value) + 1);
+        }
+    }
+    free(slots);
+    return mgen_snapshot_finish(out, path, ok);
+}
+
+static inline uint32_t mgen_snapshot_item_size(uint32_t kind) {
+    switch (kind) {
+        case MGEN_SNAPSHOT_INT:
+            return sizeof(int);
+        case MGEN_SNAPSHOT_DOUBLE:
+            return sizeof(double);
+        case MGEN_SNAPSHOT_FLOAT:
+            return sizeof(float);
+        default:
+            return sizeof(mgen_snapshot_slot_t);
+    }
+}
+
+/**
+ * Map a snapshot of the given kind and check that its header and sections fit the file
+ */
+static mgen_error_t mgen_snapshot_open(const char* path, uint32_t kind, mgen_snapshot_t* snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    mgen_error_t error = mgen_mmap_file(path, &snapshot->file);
+    if (error != MGEN_OK) {
+        return error;
+    }
+    const mgen_snapshot_header_t* header = (const mgen_snapshot_header_t*)snapshot->file.data;
+    uint64_t length = snapshot->file.length;
+    const char* problem = NULL;
+    if (length < sizeof(*header) || memcmp(header->magic, MGEN_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) {
+        problem = "not an mgen snapshot";
+    } else if (header->byte_order != MGEN_SNAPSHOT_BYTE_ORDER || header->version != MGEN_SNAPSHOT_VERSION) {
+        problem = "saved with another byte order or snapshot version";
+    } else if (header->kind != kind) {
+        problem = "holds another container type";
+    } else if (header->data_offset % MGEN_SNAPSHOT_ALIGN != 0 || header->data_offset > length ||
+               header->capacity > (length - header->data_offset) / (header->item_size ? header->item_size : 1)) {
+        problem = "truncated";
+    } else if (kind == MGEN_SNAPSHOT_STR_STR &&
+               (header->item_size != sizeof(mgen_snapshot_slot_t) || header->capacity == 0 ||
+                (header->capacity & (header->capacity - 1)) != 0 || header->count >= header->capacity ||
+                header->strings_offset > length || header->strings_size > length - header->strings_offset ||
+                header->strings_size == 0)) {
+        problem = "has a corrupt slot table";
+    } else if (kind != MGEN_SNAPSHOT_STR_STR &&
+               (header->count != header->capacity || header->item_size != mgen_snapshot_item_size(kind))) {
+        problem = "has a corrupt header";
+    }
+    if (problem) {
+        mgen_munmap_file(&snapshot->file);
+        MGEN_SET_ERROR_FMT(MGEN_ERROR_VALUE, "Snapshot %s %s", path, problem);
+        return MGEN_ERROR_VALUE;
+    }
+    snapshot->header = header;
+    return MGEN_OK;
+}
+
+static void mgen_snapshot_close(mgen_snapshot_t* snapshot) {
+    if (snapshot->header) {
+        mgen_munmap_file(&snapshot->file);
+        snapshot->header = NULL;
+    }
+}
+
+static inline size_t mgen_snapshot_size(const mgen_snapshot_t* snapshot) {
+    return (size_t)snapshot->header->count;
+}
+
+/**
+ * The items of a vec snapshot, in place (valid until mgen_snapshot_close)
+ */
+static inline const void* mgen_snapshot_items(const mgen_snapshot_t* snapshot, size_t* count) {
+    *count = (size_t)snapshot->header->count;
+    return snapshot->file.data + snapshot->header->data_offset;
+}
+
+/**
+ * A read-only vec_T over a vec snapshot's items, for functions that only read their list
+ * It borrows the mapping: never drop, grow or write it
+ */
+#define MGEN_SNAPSHOT_VEC_VIEW(vec_type, snapshot)                                                              \
+    ((vec_type){.data = (void*)((snapshot)->file.data + (snapshot)->header->data_offset),                     \
+                .size = (snapshot)->header->count,                                                             \
+                .capacity = (snapshot)->header->count})
+
+static inline const mgen_snapshot_slot_t* mgen_snapshot_slots(const mgen_snapshot_t* snapshot) {
+    return (const mgen_snapshot_slot_t*)(snapshot->file.data + snapshot->header->data_offset);
+}
+
+static inline const char* mgen_snapshot_string(const mgen_snapshot_t* snapshot, uint64_t offset, uint64_t len) {
+    const mgen_snapshot_header_t* header = snapshot->header;
+    if (offset >= header->strings_size || len >= header->strings_size - offset) {
+        return NULL;  // Out of bounds: a corrupt slot
+    }
+    return snapshot->file.data + header->strings_offset + offset;
+}
+
+/**
+ * Value of key in a map_str_str snapshot, in place (NULL when missing or stored as NULL)
+ */
+static const char* mgen_snapshot_str_str_get(const mgen_snapshot_t* snapshot, const char* key) {
+    const mgen_snapshot_header_t* header = snapshot->header;
+    const mgen_snapshot_slot_t* slots = mgen_snapshot_slots(snapshot);
+    size_t len;
+    uint64_t hash = mgen_str_hash(key, &len, header->seed);
+    uint64_t mask = header->capacity - 1;
+    for (uint64_t index = hash & mask, probes = 0; slots[index].key && probes <= mask;
+         index = (index + 1) & mask, probes++) {
+        const mgen_snapshot_slot_t* slot = &slots[index];
+        if (slot->hash != hash || slot->key_len != len) {
+            continue;
+        }
+        const char* stored = mgen_snapshot_string(snapshot, slot->key, slot->key_len);
+        if (stored && memcmp(stored, key, len) == 0) {
+            if (slot->value_len == MGEN_SNAPSHOT_NULL_VALUE) {
+                return NULL;
+            }
+            return mgen_snapshot_string(snapshot, slot->value, slot->value_len);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Replace a vec's items with a snapshot's: one block copy into a new buffer (see mgen_container_load)
+ */
+static mgen_error_t mgen_snapshot_load_items(const char* path, uint32_t kind, size_t item_size, void** data,
+                                             void* size, void* capacity, size_t size_width) {
+    (void)item_size;  // mgen_snapshot_open checks the items are as wide as kind's
+    if (size_width != sizeof(size_t)) {
+        MGEN_SET_ERROR(MGEN_ERROR_TYPE, "Unsupported vec size field");
+        return MGEN_ERROR_TYPE;
+    }
+    mgen_snapshot_t snapshot;
+    mgen_error_t error = mgen_snapshot_open(path, kind, &snapshot);
+    if (error != MGEN_OK) {
+        return error;
+    }
+    size_t count;
+    const void* items = mgen_snapshot_items(&snapshot, &count);
+    // Aligned like the buffers of aligned_vectors programs, which assume it of their own vectors
+    void* copy = mgen_aligned_malloc((ptrdiff_t)(count * item_size));
+    if (!copy) {
+        mgen_snapshot_close(&snapshot);
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate vec from snapshot");
+        return MGEN_ERROR_MEMORY;
+    }
+    memcpy(copy, items, count * item_size);
+    mgen_snapshot_close(&snapshot);
+    free(*data);
+    *data = copy;
+    memcpy(size, &count, sizeof(count));
+    memcpy(capacity, &count, sizeof(count));
+    return MGEN_OK;
+}
+
+/**
+ * Replace a map_str_str's entries with a snapshot's (the strings are copied into its arena)
+ */
+static mgen_error_t mgen_map_str_str_load(const char* path, map_str_str* map) {
+    mgen_snapshot_t snapshot;
+    mgen_error_t error = mgen_snapshot_open(path, MGEN_SNAPSHOT_STR_STR, &snapshot);
+    if (error != MGEN_OK) {
+        return error;
+    }
+    map_str_str_clear(map);
+    // Twice the entries in buckets keeps the inserts below the map's load factor
+    map_str_str_reserve(map, 2 * mgen_snapshot_size(&snapshot));
+    const mgen_snapshot_slot_t* slots = mgen_snapshot_slots(&snapshot);
+    for (uint64_t index = 0; index < snapshot.header->capacity; index++) {
+        const mgen_snapshot_slot_t* slot = &slots[index];
+        if (!slot->key) {
+            continue;
+        }
+        const char* key = mgen_snapshot_string(&snapshot, slot->key, slot->key_len);
+        const char* value = slot->value_len == MGEN_SNAPSHOT_NULL_VALUE
+                                ? NULL
+                                : mgen_snapshot_string(&snapshot, slot->value, slot->value_len);
+        if (!key || (!value && slot->value_len != MGEN_SNAPSHOT_NULL_VALUE)) {
+            mgen_snapshot_close(&snapshot);
+            MGEN_SET_ERROR_FMT(MGEN_ERROR_VALUE, "Snapshot %s has a corrupt slot table", path);
+            return MGEN_ERROR_VALUE;
+        }
+        map_str_str_insert(map, key, value);
+    }
+    mgen_snapshot_close(&snapshot);
+    return MGEN_OK;
+}
+
+// Snapshot kind of a vec's item pointer
+#define MGEN_SNAPSHOT_ITEM_KIND(items)                                                                         \
+    _Generic((items), int*: MGEN_SNAPSHOT_INT, double*: MGEN_SNAPSHOT_DOUBLE, float*: MGEN_SNAPSHOT_FLOAT)
+
+// Any vec_T of int, double or float (STC or hand-written): both store data, size and capacity
+#define mgen_vec_save(path, vec)                                                                               \
+    mgen_snapshot_save_items((path), MGEN_SNAPSHOT_ITEM_KIND((vec)->data), (vec)->data, (size_t)(vec)->size,   \
+                             sizeof(*(vec)->data))
+#define mgen_vec_load(path, vec)                                                                               \
+    mgen_snapshot_load_items((path), MGEN_SNAPSHOT_ITEM_KIND((vec)->data), sizeof(*(vec)->data),              \
+                             (void**)&(vec)->data, &(vec)->size, &(vec)->capacity, sizeof((vec)->size))
+
+#define mgen_vec_int_save mgen_vec_save
+#define mgen_vec_int_load mgen_vec_load
+#define mgen_vec_double_save mgen_vec_save
+#define mgen_vec_double_load mgen_vec_load
+#define mgen_vec_float_save mgen_vec_save
+#define mgen_vec_float_load mgen_vec_load
+
+/**
+ * Save or load a generated container by its type name, e.g.
+ * mgen_container_save(map_str_str, "table.snap", &table) or mgen_container_load(vec_int, "ids.snap", &ids)
+ * Both return MGEN_OK or the error recorded in mgen_last_error.
+ */
+#define mgen_container_save(type, path, container) mgen_##type##_save((path), (container))
+#define mgen_container_load(type, path, container) mgen_##type##_load((path), (container))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_SNAPSHOT_H
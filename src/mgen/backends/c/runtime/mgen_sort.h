@@ -0,0 +1,217 @@
+/**
+ * Sorting for sorted() and list.sort()
+ * stb-library style: static functions for single-file output
+ *
+ * Instantiates mgen_sort_impl.h (pdqsort, stable merge sort, reverse) for
+ * int, double, float and char* elements, so comparisons are inlined instead
+ * of going through a qsort() comparison function. Large int arrays are radix
+ * sorted. Key sorts (sorted(xs, key=f)) sort (key, index) pairs with the
+ * stable merge sort and then permute the elements, so f runs once per element.
+ */
+
+#ifndef MGEN_SORT_H
+#define MGEN_SORT_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Int arrays at least this long are radix sorted: four counting passes beat
+// n log n comparisons once the histograms are amortized
+#ifndef MGEN_SORT_RADIX_MIN
+#define MGEN_SORT_RADIX_MIN 2048
+#endif
+
+/**
+ * LSD radix sort of count ints, one byte per pass
+ * Passes where every element has the same byte are skipped. Returns false,
+ * leaving data unchanged, if the scratch buffer cannot be allocated.
+ */
+static inline bool mgen_radix_sort_int(int* data, size_t count) {
+    enum { PASSES = sizeof(unsigned int) };
+    // Flipping the sign bit makes the unsigned order the signed order
+    const unsigned int sign = 1u << (sizeof(unsigned int) * CHAR_BIT - 1);
+
+    if (count < 2) {
+        return true;
+    }
+    MGEN_PROFILE_ALLOC(count * sizeof(unsigned int));
+    unsigned int* scratch = malloc(count * sizeof(unsigned int));
+    if (!scratch) {
+        return false;
+    }
+
+    size_t counts[PASSES][256];
+    memset(counts, 0, sizeof(counts));
+    unsigned int* src = (unsigned int*)data;
+    for (size_t i = 0; i < count; i++) {
+        unsigned int key = src[i] ^ sign;
+        for (int pass = 0; pass < PASSES; pass++) {
+            counts[pass][(key >> (pass * CHAR_BIT)) & 0xFF]++;
+        }
+    }
+
+    unsigned int* dst = scratch;
+    for (int pass = 0; pass < PASSES; pass++) {
+        size_t* histogram = counts[pass];
+        unsigned int shift = (unsigned int)pass * CHAR_BIT;
+        if (histogram[((src[0] ^ sign) >> shift) & 0xFF] == count) {
+            continue;
+        }
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            size_t n = histogram[digit];
+            histogram[digit] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; i++) {
+            dst[histogram[((src[i] ^ sign) >> shift) & 0xFF]++] = src[i];
+        }
+        unsigned int* tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != (unsigned int*)data) {
+        memcpy(data, src, count * sizeof(unsigned int));
+    }
+    free(scratch);
+    return true;
+}
+
+#define MGEN_SORT_NAME mgen_sort_int
+#define MGEN_SORT_T int
+#define MGEN_SORT_LESS(a, b) (*(a) < *(b))
+#define MGEN_SORT_RADIX mgen_radix_sort_int
+#include "mgen_sort_impl.h"
+
+#define MGEN_SORT_NAME mgen_sort_double
+#define MGEN_SORT_T double
+#define MGEN_SORT_LESS(a, b) (*(a) < *(b))
+#include "mgen_sort_impl.h"
+
+#define MGEN_SORT_NAME mgen_sort_float
+#define MGEN_SORT_T float
+#define MGEN_SORT_LESS(a, b) (*(a) < *(b))
+#include "mgen_sort_impl.h"
+
+#define MGEN_SORT_NAME mgen_sort_str
+#define MGEN_SORT_T char*
+#define MGEN_SORT_LESS(a, b) (strcmp(*(a), *(b)) < 0)
+#include "mgen_sort_impl.h"
+
+// Sort key of the element at index
+typedef struct {
+    int key;
+    size_t index;
+} mgen_sort_int_key_t;
+
+typedef struct {
+    double key;
+    size_t index;
+} mgen_sort_double_key_t;
+
+#define MGEN_SORT_NAME mgen_sort_int_keys
+#define MGEN_SORT_T mgen_sort_int_key_t
+#define MGEN_SORT_LESS(a, b) ((a)->key < (b)->key)
+#include "mgen_sort_impl.h"
+
+#define MGEN_SORT_NAME mgen_sort_double_keys
+#define MGEN_SORT_T mgen_sort_double_key_t
+#define MGEN_SORT_LESS(a, b) ((a)->key < (b)->key)
+#include "mgen_sort_impl.h"
+
+/**
+ * Rearrange count elements of the given size so element i is the old element order(i)
+ * order(i) is read from the index field at index_offset of the i-th pair.
+ */
+static inline bool mgen_sort_permute(void* data, size_t count, size_t size, const void* pairs, size_t pair_size,
+                                     size_t index_offset) {
+    MGEN_PROFILE_ALLOC(count * size);
+    unsigned char* old = malloc(count * size);
+    if (!old) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate sort buffer");
+        return false;
+    }
+    memcpy(old, data, count * size);
+    const unsigned char* pair = pairs;
+    for (size_t i = 0; i < count; i++) {
+        size_t index;
+        memcpy(&index, pair + i * pair_size + index_offset, sizeof(size_t));
+        memcpy((unsigned char*)data + i * size, old + index * size, size);
+    }
+    free(old);
+    return true;
+}
+
+/**
+ * Stable sort of count elements of the given size by keys[i], like sorted(xs, key=f)
+ * with keys[i] = f(xs[i])
+ * With reverse, equal keys keep their order too: the pairs are built back to front,
+ * stably sorted and read back to front. Returns false if a buffer cannot be
+ * allocated; data is unchanged then.
+ */
+static inline bool mgen_sort_by_int_keys(void* data, size_t count, size_t size, const int* keys, bool reverse) {
+    if (count < 2) {
+        return true;
+    }
+    MGEN_PROFILE_ALLOC(count * sizeof(mgen_sort_int_key_t));
+    mgen_sort_int_key_t* pairs = malloc(count * sizeof(mgen_sort_int_key_t));
+    if (!pairs) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate sort keys");
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        size_t index = reverse ? count - 1 - i : i;
+        pairs[i].key = keys[index];
+        pairs[i].index = index;
+    }
+    mgen_sort_int_keys_stable(pairs, count);
+    if (reverse) {
+        mgen_sort_int_keys_reverse(pairs, count);
+    }
+    bool ok = mgen_sort_permute(data, count, size, pairs, sizeof(*pairs), offsetof(mgen_sort_int_key_t, index));
+    free(pairs);
+    return ok;
+}
+
+/**
+ * Stable sort of count elements of the given size by double keys, see mgen_sort_by_int_keys()
+ */
+static inline bool mgen_sort_by_double_keys(void* data, size_t count, size_t size, const double* keys, bool reverse) {
+    if (count < 2) {
+        return true;
+    }
+    MGEN_PROFILE_ALLOC(count * sizeof(mgen_sort_double_key_t));
+    mgen_sort_double_key_t* pairs = malloc(count * sizeof(mgen_sort_double_key_t));
+    if (!pairs) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate sort keys");
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        size_t index = reverse ? count - 1 - i : i;
+        pairs[i].key = keys[index];
+        pairs[i].index = index;
+    }
+    mgen_sort_double_keys_stable(pairs, count);
+    if (reverse) {
+        mgen_sort_double_keys_reverse(pairs, count);
+    }
+    bool ok = mgen_sort_permute(data, count, size, pairs, sizeof(*pairs), offsetof(mgen_sort_double_key_t, index));
+    free(pairs);
+    return ok;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_SORT_H
@@ -0,0 +1,404 @@
+/**
+ * Type-specialized sorting, instantiated once per element type
+ * stb-library style: static functions for single-file output
+ *
+ * Include after defining, STC style:
+ *
+ *     #define MGEN_SORT_NAME mgen_sort_int      // prefix of the generated functions
+ *     #define MGEN_SORT_T int                   // element type
+ *     #define MGEN_SORT_LESS(a, b) (*(a) < *(b)) // strict weak order on element pointers
+ *     #include "mgen_sort_impl.h"
+ *
+ * Optionally MGEN_SORT_RADIX(data, count) names a non-comparison sort tried first for
+ * at least MGEN_SORT_RADIX_MIN elements; it returns false to fall back to pdqsort.
+ *
+ * which defines
+ *
+ *     void mgen_sort_int(int* data, size_t count);          // pdqsort, not stable
+ *     bool mgen_sort_int_stable(int* data, size_t count);   // merge sort, stable
+ *     void mgen_sort_int_reverse(int* data, size_t count);
+ *
+ * The comparison is a macro, so it is inlined into every loop instead of being
+ * an indirect call per comparison as with qsort(). The header has no include
+ * guard and undefines its parameters at the end.
+ *
+ * pdqsort (pattern-defeating quicksort, Orson Peters): introsort with
+ * insertion sort for short ranges, median-of-3 or ninther pivots, a
+ * partition that collects elements equal to the pivot when the pivot equals
+ * its left neighbour, detection of already sorted partitions, and a heapsort
+ * fallback after log2(n) badly unbalanced partitions.
+ */
+
+#if !defined(MGEN_SORT_NAME) || !defined(MGEN_SORT_T) || !defined(MGEN_SORT_LESS)
+#error "Define MGEN_SORT_NAME, MGEN_SORT_T and MGEN_SORT_LESS before including mgen_sort_impl.h"
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_alloc_profile.h"
+
+#ifndef MGEN_SORT_COMMON
+#define MGEN_SORT_COMMON
+
+#define MGEN_SORT_JOIN_(a, b) a##b
+#define MGEN_SORT_JOIN(a, b) MGEN_SORT_JOIN_(a, b)
+
+// Ranges shorter than this are insertion sorted
+#define MGEN_SORT_INSERTION_MAX 24
+// Ranges longer than this take the ninther (median of three medians) as pivot
+#define MGEN_SORT_NINTHER_MIN 128
+// Element moves after which the sortedness check gives up
+#define MGEN_SORT_PARTIAL_INSERTION_LIMIT 8
+
+static inline int mgen_sort_log2(size_t n) {
+    int log = 0;
+    while (n >>= 1) {
+        log++;
+    }
+    return log;
+}
+
+#endif // MGEN_SORT_COMMON
+
+#define MGEN_SORT_FN(suffix) MGEN_SORT_JOIN(MGEN_SORT_NAME, suffix)
+
+static inline void MGEN_SORT_FN(_swap)(MGEN_SORT_T* a, MGEN_SORT_T* b) {
+    MGEN_SORT_T tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/**
+ * Order *a <= *b <= *c
+ */
+static inline void MGEN_SORT_FN(_sort3)(MGEN_SORT_T* a, MGEN_SORT_T* b, MGEN_SORT_T* c) {
+    if (MGEN_SORT_LESS(b, a)) {
+        MGEN_SORT_FN(_swap)(a, b);
+    }
+    if (MGEN_SORT_LESS(c, b)) {
+        MGEN_SORT_FN(_swap)(b, c);
+        if (MGEN_SORT_LESS(b, a)) {
+            MGEN_SORT_FN(_swap)(a, b);
+        }
+    }
+}
+
+/**
+ * Stable insertion sort of [begin, end)
+ */
+static inline void MGEN_SORT_FN(_insertion)(MGEN_SORT_T* begin, MGEN_SORT_T* end) {
+    if (begin == end) {
+        return;
+    }
+    for (MGEN_SORT_T* cur = begin + 1; cur != end; cur++) {
+        MGEN_SORT_T* sift = cur;
+        MGEN_SORT_T tmp = *cur;
+        while (sift != begin && MGEN_SORT_LESS(&tmp, sift - 1)) {
+            *sift = *(sift - 1);
+            sift--;
+        }
+        *sift = tmp;
+    }
+}
+
+/**
+ * Insertion sort of [begin, end) when begin[-1] is not greater than any element
+ */
+static inline void MGEN_SORT_FN(_unguarded_insertion)(MGEN_SORT_T* begin, MGEN_SORT_T* end) {
+    for (MGEN_SORT_T* cur = begin + 1; cur < end; cur++) {
+        MGEN_SORT_T* sift = cur;
+        MGEN_SORT_T tmp = *cur;
+        while (MGEN_SORT_LESS(&tmp, sift - 1)) {
+            *sift = *(sift - 1);
+            sift--;
+        }
+        *sift = tmp;
+    }
+}
+
+/**
+ * Insertion sort of [begin, end) that gives up after a few moves
+ * Returns true if the range is now sorted
+ */
+static inline bool MGEN_SORT_FN(_partial_insertion)(MGEN_SORT_T* begin, MGEN_SORT_T* end) {
+    if (begin == end) {
+        return true;
+    }
+    size_t moves = 0;
+    for (MGEN_SORT_T* cur = begin + 1; cur != end; cur++) {
+        MGEN_SORT_T* sift = cur;
+        MGEN_SORT_T tmp = *cur;
+        if (!MGEN_SORT_LESS(&tmp, sift - 1)) {
+            continue;
+        }
+        do {
+            *sift = *(sift - 1);
+            sift--;
+        } while (sift != begin && MGEN_SORT_LESS(&tmp, sift - 1));
+        *sift = tmp;
+        moves += (size_t)(cur - sift);
+        if (moves > MGEN_SORT_PARTIAL_INSERTION_LIMIT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline void MGEN_SORT_FN(_sift_down)(MGEN_SORT_T* data, size_t root, size_t count) {
+    MGEN_SORT_T tmp = data[root];
+    for (size_t child; (child = 2 * root + 1) < count; root = child) {
+        if (child + 1 < count && MGEN_SORT_LESS(&data[child], &data[child + 1])) {
+            child++;
+        }
+        if (!MGEN_SORT_LESS(&tmp, &data[child])) {
+            break;
+        }
+        data[root] = data[child];
+    }
+    data[root] = tmp;
+}
+
+static inline void MGEN_SORT_FN(_heapsort)(MGEN_SORT_T* data, size_t count) {
+    for (size_t i = count / 2; i-- > 0;) {
+        MGEN_SORT_FN(_sift_down)(data, i, count);
+    }
+    for (size_t end = count; end-- > 1;) {
+        MGEN_SORT_FN(_swap)(&data[0], &data[end]);
+        MGEN_SORT_FN(_sift_down)(data, 0, end);
+    }
+}
+
+/**
+ * Partition [begin, end) around the pivot *begin: smaller elements left of it, the rest right
+ * Requires an element not less than the pivot at the end. Returns the pivot's final position
+ * and sets *already_partitioned when no element had to move.
+ */
+static inline MGEN_SORT_T* MGEN_SORT_FN(_partition_right)(MGEN_SORT_T* begin, MGEN_SORT_T* end,
+                                                          bool* already_partitioned) {
+    MGEN_SORT_T pivot = *begin;
+    MGEN_SORT_T* first = begin;
+    MGEN_SORT_T* last = end;
+
+    while (MGEN_SORT_LESS(++first, &pivot)) {
+    }
+    // Without an element smaller than the pivot on the left, the scan from the right needs a bound
+    if (first - 1 == begin) {
+        while (first < last && !MGEN_SORT_LESS(--last, &pivot)) {
+        }
+    } else {
+        while (!MGEN_SORT_LESS(--last, &pivot)) {
+        }
+    }
+
+    *already_partitioned = first >= last;
+    while (first < last) {
+        MGEN_SORT_FN(_swap)(first, last);
+        while (MGEN_SORT_LESS(++first, &pivot)) {
+        }
+        while (!MGEN_SORT_LESS(--last, &pivot)) {
+        }
+    }
+
+    MGEN_SORT_T* pivot_pos = first - 1;
+    *begin = *pivot_pos;
+    *pivot_pos = pivot;
+    return pivot_pos;
+}
+
+/**
+ * Partition [begin, end) around *begin with the elements equal to the pivot on the left
+ * Used when the pivot equals the element before the range, so every element on the left
+ * is equal and needs no further sorting. Returns the pivot's final position.
+ */
+static inline MGEN_SORT_T* MGEN_SORT_FN(_partition_left)(MGEN_SORT_T* begin, MGEN_SORT_T* end) {
+    MGEN_SORT_T pivot = *begin;
+    MGEN_SORT_T* first = begin;
+    MGEN_SORT_T* last = end;
+
+    while (MGEN_SORT_LESS(&pivot, --last)) {
+    }
+    if (last + 1 == end) {
+        while (first < last && !MGEN_SORT_LESS(&pivot, ++first)) {
+        }
+    } else {
+        while (!MGEN_SORT_LESS(&pivot, ++first)) {
+        }
+    }
+
+    while (first < last) {
+        MGEN_SORT_FN(_swap)(first, last);
+        while (MGEN_SORT_LESS(&pivot, --last)) {
+        }
+        while (!MGEN_SORT_LESS(&pivot, ++first)) {
+        }
+    }
+
+    *begin = *last;
+    *last = pivot;
+    return last;
+}
+
+/**
+ * Swap elements of a badly unbalanced partition's side into new positions to break patterns
+ */
+static inline void MGEN_SORT_FN(_shuffle)(MGEN_SORT_T* begin, MGEN_SORT_T* end) {
+    size_t size = (size_t)(end - begin);
+    if (size < MGEN_SORT_INSERTION_MAX) {
+        return;
+    }
+    size_t quarter = size / 4;
+    MGEN_SORT_FN(_swap)(begin, begin + quarter);
+    MGEN_SORT_FN(_swap)(end - 1, end - quarter);
+    if (size > MGEN_SORT_NINTHER_MIN) {
+        MGEN_SORT_FN(_swap)(begin + 1, begin + (quarter + 1));
+        MGEN_SORT_FN(_swap)(begin + 2, begin + (quarter + 2));
+        MGEN_SORT_FN(_swap)(end - 2, end - (quarter + 1));
+        MGEN_SORT_FN(_swap)(end - 3, end - (quarter + 2));
+    }
+}
+
+static inline void MGEN_SORT_FN(_loop)(MGEN_SORT_T* begin, MGEN_SORT_T* end, int bad_allowed, bool leftmost) {
+    for (;;) {
+        size_t size = (size_t)(end - begin);
+        if (size < MGEN_SORT_INSERTION_MAX) {
+            if (leftmost) {
+                MGEN_SORT_FN(_insertion)(begin, end);
+            } else {
+                MGEN_SORT_FN(_unguarded_insertion)(begin, end);
+            }
+            return;
+        }
+
+        // Move the pivot to *begin, leaving an element not less than it at the end
+        size_t half = size / 2;
+        if (size > MGEN_SORT_NINTHER_MIN) {
+            MGEN_SORT_FN(_sort3)(begin, begin + half, end - 1);
+            MGEN_SORT_FN(_sort3)(begin + 1, begin + (half - 1), end - 2);
+            MGEN_SORT_FN(_sort3)(begin + 2, begin + (half + 1), end - 3);
+            MGEN_SORT_FN(_sort3)(begin + (half - 1), begin + half, begin + (half + 1));
+            MGEN_SORT_FN(_swap)(begin, begin + half);
+        } else {
+            MGEN_SORT_FN(_sort3)(begin + half, begin, end - 1);
+        }
+
+        // Equal to the element before the range: everything equal to it is already in place
+        if (!leftmost && !MGEN_SORT_LESS(begin - 1, begin)) {
+            begin = MGEN_SORT_FN(_partition_left)(begin, end) + 1;
+            continue;
+        }
+
+        bool already_partitioned;
+        MGEN_SORT_T* pivot = MGEN_SORT_FN(_partition_right)(begin, end, &already_partitioned);
+        size_t left_size = (size_t)(pivot - begin);
+        size_t right_size = (size_t)(end - (pivot + 1));
+
+        if (left_size < size / 8 || right_size < size / 8) {
+            if (--bad_allowed == 0) {
+                MGEN_SORT_FN(_heapsort)(begin, size);
+                return;
+            }
+            MGEN_SORT_FN(_shuffle)(begin, pivot);
+            MGEN_SORT_FN(_shuffle)(pivot + 1, end);
+        } else if (already_partitioned && MGEN_SORT_FN(_partial_insertion)(begin, pivot) &&
+                   MGEN_SORT_FN(_partial_insertion)(pivot + 1, end)) {
+            return;
+        }
+
+        // Recurse into the smaller side so the stack stays O(log n)
+        if (left_size < right_size) {
+            MGEN_SORT_FN(_loop)(begin, pivot, bad_allowed, leftmost);
+            begin = pivot + 1;
+            leftmost = false;
+        } else {
+            MGEN_SORT_FN(_loop)(pivot + 1, end, bad_allowed, false);
+            end = pivot;
+        }
+    }
+}
+
+/**
+ * Sort count elements in place, not stable
+ */
+static inline void MGEN_SORT_NAME(MGEN_SORT_T* data, size_t count) {
+#ifdef MGEN_SORT_RADIX
+    if (count >= MGEN_SORT_RADIX_MIN && MGEN_SORT_RADIX(data, count)) {
+        return;
+    }
+#endif
+    if (count > 1) {
+        MGEN_SORT_FN(_loop)(data, data + count, mgen_sort_log2(count), true);
+    }
+}
+
+/**
+ * Stable merge of the sorted runs [0, mid) and [mid, count) of data through scratch
+ */
+static inline void MGEN_SORT_FN(_merge)(MGEN_SORT_T* data, size_t mid, size_t count, MGEN_SORT_T* scratch) {
+    memcpy(scratch, data, mid * sizeof(MGEN_SORT_T));
+    size_t left = 0;
+    size_t right = mid;
+    size_t out = 0;
+    while (left < mid && right < count) {
+        // Ties take the left element, which keeps the sort stable
+        if (MGEN_SORT_LESS(&data[right], &scratch[left])) {
+            data[out++] = data[right++];
+        } else {
+            data[out++] = scratch[left++];
+        }
+    }
+    while (left < mid) {
+        data[out++] = scratch[left++];
+    }
+}
+
+static inline void MGEN_SORT_FN(_merge_sort)(MGEN_SORT_T* data, size_t count, MGEN_SORT_T* scratch) {
+    if (count < MGEN_SORT_INSERTION_MAX) {
+        MGEN_SORT_FN(_insertion)(data, data + count);
+        return;
+    }
+    size_t mid = count / 2;
+    MGEN_SORT_FN(_merge_sort)(data, mid, scratch);
+    MGEN_SORT_FN(_merge_sort)(data + mid, count - mid, scratch);
+    // Runs already in order need no merge
+    if (MGEN_SORT_LESS(&data[mid], &data[mid - 1])) {
+        MGEN_SORT_FN(_merge)(data, mid, count, scratch);
+    }
+}
+
+/**
+ * Sort count elements in place, keeping equal elements in their original order
+ * Returns false if the scratch buffer (count / 2 elements) could not be allocated,
+ * in which case data is insertion sorted instead, still stable but quadratic.
+ */
+static inline bool MGEN_SORT_FN(_stable)(MGEN_SORT_T* data, size_t count) {
+    if (count < MGEN_SORT_INSERTION_MAX) {
+        MGEN_SORT_FN(_insertion)(data, data + count);
+        return true;
+    }
+    MGEN_PROFILE_ALLOC((count / 2 + 1) * sizeof(MGEN_SORT_T));
+    MGEN_SORT_T* scratch = malloc((count / 2 + 1) * sizeof(MGEN_SORT_T));
+    if (!scratch) {
+        MGEN_SORT_FN(_insertion)(data, data + count);
+        return false;
+    }
+    MGEN_SORT_FN(_merge_sort)(data, count, scratch);
+    free(scratch);
+    return true;
+}
+
+/**
+ * Reverse count elements in place
+ */
+static inline void MGEN_SORT_FN(_reverse)(MGEN_SORT_T* data, size_t count) {
+    for (size_t i = 0, j = count; i + 1 < j; i++, j--) {
+        MGEN_SORT_FN(_swap)(&data[i], &data[j - 1]);
+    }
+}
+
+#undef MGEN_SORT_FN
+#undef MGEN_SORT_NAME
+#undef MGEN_SORT_T
+#undef MGEN_SORT_LESS
+#undef MGEN_SORT_RADIX
@@ -3,10 +3,43 @@
  */
 
 #include "mgen_stc_bridge.h"
+#include "mgen_string_ops.h"
 #include <ctype.h>
+#include "mgen_ascii.h"
 
 #ifdef STC_ENABLED
 
+#include <stc/cstr.h>
+
+cstr mgen_cstr_strip(const cstr* s) {
+    const char* begin = cstr_str(s);
+    const char* end = begin + cstr_size(s);
+    begin = mgen_ascii_skip_space(begin, end);
+    end = mgen_ascii_trim_space(begin, end);
+    return cstr_from_n(begin, (isize)(end - begin));
+}
+
+int mgen_cstr_startswith(const cstr* s, const char* prefix) {
+    size_t len = strlen(prefix);
+    return (size_t)cstr_size(s) >= len && memcmp(cstr_str(s), prefix, len) == 0;
+}
+
+int mgen_cstr_endswith(const cstr* s, const char* suffix) {
+    size_t size = (size_t)cstr_size(s);
+    size_t len = strlen(suffix);
+    return size >= len && memcmp(cstr_str(s) + size - len, suffix, len) == 0;
+}
+
+int mgen_cstr_find(const cstr* s, const char* substr) {
+    const char* str = cstr_str(s);
+    const char* found = mgen_ascii_find(str, (size_t)cstr_size(s), substr, strlen(substr));
+    return found ? (int)(found - str) : -1;
+}
+
+int mgen_cstr_count(const cstr* s, const char* substr) {
+    return (int)mgen_ascii_count(cstr_str(s), (size_t)cstr_size(s), substr, strlen(substr));
+}
+
 // Note: Complex STC functions removed to avoid template dependency issues
 // Only keeping the simple bridge functions needed for basic functionality
 
@@ -279,8 +312,44 @@ char* mgen_container_repr(void* container, const char* type_name,
         return NULL;
     }
 
-    // Simplified implementation - would use mgen_buffer for full version
-    return malloc(1); // Placeholder
+    // "set" and "tuple" take their own brackets; anything else prints as a list
+    bool is_set = type_name && strcmp(type_name, "set") == 0;
+    bool is_tuple = type_name && strcmp(type_name, "tuple") == 0;
+    size_t size = size_func(container);
+    if (is_set && size == 0) {
+        return mgen_strdup("set()");
+    }
+
+    mgen_buffer_t out;
+    if (mgen_buffer_init(&out, mgen_buffer_capacity_hint((long long)size, 8) + 4) != MGEN_OK) {
+        return NULL;
+    }
+    mgen_error_t err = mgen_buffer_append_char(&out, is_set ? '{' : is_tuple ? '(' : '[');
+    for (size_t i = 0; i < size && err == MGEN_OK; i++) {
+        char* elem_repr = element_repr(at_func(container, i));
+        if (!elem_repr) {
+            err = MGEN_ERROR_MEMORY;
+            break;
+        }
+        if (i > 0) {
+            err = mgen_buffer_append(&out, ", ", 2);
+        }
+        if (err == MGEN_OK) {
+            err = mgen_buffer_append_str(&out, elem_repr);
+        }
+        free(elem_repr);
+    }
+    if (err == MGEN_OK && is_tuple && size == 1) {
+        err = mgen_buffer_append_char(&out, ',');
+    }
+    if (err == MGEN_OK) {
+        err = mgen_buffer_append_char(&out, is_set ? '}' : is_tuple ? ')' : ']');
+    }
+    if (err != MGEN_OK) {
+        mgen_buffer_destroy(&out);
+        return NULL;
+    }
+    return mgen_buffer_detach(&out);
 }
 
 // STC registry implementation
@@ -389,16 +458,39 @@ mgen_error_t mgen_normalize_slice(mgen_slice_t* slice, size_t container_size) {
     return MGEN_OK;
 }
 
-void* mgen_vec_slice_impl(void* src_vec, const mgen_slice_t* slice,
-                         size_t (*size_func)(const void*),
-                         void* (*at_func)(void*, size_t),
-                         size_t element_size) {
-    if (!src_vec || !slice || !size_func || !at_func) {
-        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Invalid slice parameters");
-        return NULL;
+mgen_vec_view_t mgen_vec_slice_impl(void* data, size_t size, size_t element_size,
+                                   long long start, long long stop, long long step) {
+    mgen_vec_view_t view = {NULL, 0, 0};
+    if (step == 0) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "slice step cannot be zero");
+        return view;
     }
-
-    // Simplified implementation - would create new vector with sliced elements
-    MGEN_SET_ERROR(MGEN_ERROR_RUNTIME, "Vector slicing not yet implemented");
-    return NULL;
-}
\ No newline at end of file
+    // PySlice_AdjustIndices: omitted bounds depend on the direction
+    long long n = (long long)size;
+    if (start == MGEN_SLICE_NONE) {
+        start = step > 0 ? 0 : n - 1;
+    } else if (start < 0) {
+        start = start + n < 0 ? (step > 0 ? 0 : -1) : start + n;
+    } else if (start >= n) {
+        start = step > 0 ? n : n - 1;
+    }
+    if (stop == MGEN_SLICE_NONE) {
+        stop = step > 0 ? n : -1;
+    } else if (stop < 0) {
+        stop = stop + n < 0 ? (step > 0 ? 0 : -1) : stop + n;
+    } else if (stop >= n) {
+        stop = step > 0 ? n : n - 1;
+    }
+    long long length = 0;
+    if (step > 0 && start < stop) {
+        length = (stop - start - 1) / step + 1;
+    } else if (step < 0 && stop < start) {
+        length = (start - stop - 1) / -step + 1;
+    }
+    if (length > 0) {
+        view.data = (char*)data + start * (long long)element_size;
+        view.length = (size_t)length;
+        view.stride = (ptrdiff_t)(step * (long long)element_size);
+    }
+    return view;
+}
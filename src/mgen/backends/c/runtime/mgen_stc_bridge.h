@@ -11,6 +11,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <stddef.h>
 #include "mgen_error_handling.h"
 
 // STC types and headers are included by the generated code
@@ -258,20 +260,56 @@ typedef struct {
 mgen_error_t mgen_normalize_slice(mgen_slice_t* slice, size_t container_size);
 
 /**
- * Python-style slice operations on STC containers
+ * Python slice bounds clamped to a container of size elements (step 1)
+ * Negative bounds count from the end; pass MGEN_SLICE_END for an omitted stop.
+ * Stores the first index in *first and returns the slice length.
  */
-#ifdef STC_ENABLED
-#define MGEN_VEC_SLICE(vec_type, src_vec, slice) \
-    mgen_vec_slice_impl((src_vec), (slice), \
-                       (size_t(*)(const void*))vec_type##_size, \
-                       (void*(*)(void*, size_t))vec_type##_at, \
-                       sizeof(*vec_type##_at((src_vec), 0)))
-#endif
+#define MGEN_SLICE_END LLONG_MAX
+
+static inline size_t mgen_slice_range(size_t size, long long start, long long stop, size_t* first) {
+    long long n = (long long)size;
+    if (start < 0) {
+        start = start + n < 0 ? 0 : start + n;
+    } else if (start > n) {
+        start = n;
+    }
+    if (stop < 0) {
+        stop = stop + n < 0 ? 0 : stop + n;
+    } else if (stop > n) {
+        stop = n;
+    }
+    *first = (size_t)start;
+    return stop > start ? (size_t)(stop - start) : 0;
+}
 
-void* mgen_vec_slice_impl(void* src_vec, const mgen_slice_t* slice,
-                         size_t (*size_func)(const void*),
-                         void* (*at_func)(void*, size_t),
-                         size_t element_size);
+/**
+ * Non-owning view of a list slice: element i is at data + i * stride bytes
+ * Valid while the source vector is neither resized nor freed. Read-only
+ * consumers take a view instead of a copy; copy it to get a list of its own.
+ */
+typedef struct {
+    void* data;             // First element of the slice (NULL when empty)
+    size_t length;          // Elements in the slice
+    ptrdiff_t stride;       // Bytes from one element to the next; negative for step < 0
+} mgen_vec_view_t;
+
+static inline void* mgen_vec_view_at(const mgen_vec_view_t* view, size_t index) {
+    return (char*)view->data + (ptrdiff_t)index * view->stride;
+}
+
+/**
+ * Python vec[start:stop:step] of any vector as a view
+ * Omitted bounds are MGEN_SLICE_NONE. Returns an empty view and sets
+ * MGEN_ERROR_VALUE when step is 0.
+ */
+#define MGEN_SLICE_NONE LLONG_MIN
+
+#define MGEN_VEC_SLICE(vec_type, src_vec, start, stop, step) \
+    mgen_vec_slice_impl((src_vec)->data, (size_t)vec_type##_size(src_vec), sizeof(*(src_vec)->data), \
+                       (start), (stop), (step))
+
+mgen_vec_view_t mgen_vec_slice_impl(void* data, size_t size, size_t element_size,
+                                   long long start, long long stop, long long step);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,264 @@
+/**
+ * Buffered standard output for print()
+ * stb-library style: static functions for single-file output
+ *
+ * print() appends to one MGEN_STDOUT_BUFFER_SIZE buffer that is written with
+ * a single fwrite when it fills up and at exit, instead of a locked printf
+ * per call. Integers are converted two digits at a time. When stdout is a
+ * terminal the buffer is flushed at every newline, so interactive output
+ * still appears line by line. The buffer is unlocked: generated programs
+ * only print from the main thread (OpenMP loops never contain print()).
+ * Call mgen_stdout_flush() before writing to stdout by other means.
+ */
+
+#ifndef MGEN_STDOUT_H
+#define MGEN_STDOUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define MGEN_STDOUT_ISATTY() _isatty(_fileno(stdout))
+#else
+#include <unistd.h>
+#define MGEN_STDOUT_ISATTY() isatty(STDOUT_FILENO)  // fileno() needs POSIX feature macros under -std=c11
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MGEN_STDOUT_BUFFER_SIZE
+#define MGEN_STDOUT_BUFFER_SIZE (64 * 1024)
+#endif
+
+typedef struct {
+    char data[MGEN_STDOUT_BUFFER_SIZE];
+    size_t len;
+    int mode;                   // 0 until the first write, then MGEN_STDOUT_FULL or MGEN_STDOUT_LINE
+} mgen_stdout_t;
+
+enum { MGEN_STDOUT_FULL = 1, MGEN_STDOUT_LINE = 2 };
+
+static mgen_stdout_t mgen_stdout;
+
+static inline void mgen_stdout_flush(void) {
+    if (mgen_stdout.len > 0) {
+        fwrite(mgen_stdout.data, 1, mgen_stdout.len, stdout);
+        mgen_stdout.len = 0;
+    }
+    fflush(stdout);
+}
+
+// Room for at least n more bytes (n <= MGEN_STDOUT_BUFFER_SIZE)
+static inline char* mgen_stdout_reserve(size_t n) {
+    if (!mgen_stdout.mode) {
+        mgen_stdout.mode = MGEN_STDOUT_ISATTY() ? MGEN_STDOUT_LINE : MGEN_STDOUT_FULL;
+        atexit(mgen_stdout_flush);
+    }
+    if (MGEN_STDOUT_BUFFER_SIZE - mgen_stdout.len < n) {
+        mgen_stdout_flush();
+    }
+    return mgen_stdout.data + mgen_stdout.len;
+}
+
+static inline void mgen_stdout_write(const char* data, size_t len) {
+    if (len > MGEN_STDOUT_BUFFER_SIZE / 2) {
+        // Large writes skip the buffer
+        mgen_stdout_reserve(MGEN_STDOUT_BUFFER_SIZE);
+        fwrite(data, 1, len, stdout);
+        return;
+    }
+    memcpy(mgen_stdout_reserve(len), data, len);
+    mgen_stdout.len += len;
+}
+
+static inline void mgen_stdout_str(const char* str) {
+    if (str) {
+        mgen_stdout_write(str, strlen(str));
+    }
+}
+
+static inline void mgen_stdout_char(char c) {
+    *mgen_stdout_reserve(1) = c;
+    mgen_stdout.len++;
+}
+
+static inline void mgen_stdout_int(long long value) {
+    static const char pairs[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    char digits[24];
+    char* p = digits + sizeof(digits);
+    // Negation in unsigned arithmetic also covers LLONG_MIN
+    unsigned long long magnitude = value < 0 ? 0ull - (unsigned long long)value : (unsigned long long)value;
+    while (magnitude >= 100) {
+        unsigned int pair = (unsigned int)(magnitude % 100) * 2;
+        magnitude /= 100;
+        *--p = pairs[pair + 1];
+        *--p = pairs[pair];
+    }
+    if (magnitude >= 10) {
+        *--p = pairs[magnitude * 2 + 1];
+        *--p = pairs[magnitude * 2];
+    } else {
+        *--p = (char)('0' + magnitude);
+    }
+    if (value < 0) {
+        *--p = '-';
+    }
+    mgen_stdout_write(p, (size_t)(digits + sizeof(digits) - p));
+}
+
+// printf's %f, formatted straight into the buffer
+static inline void mgen_stdout_double(double value) {
+    // %f of the largest doubles is over 300 digits
+    char* out = mgen_stdout_reserve(512);
+    int written = snprintf(out, 512, "%f", value);
+    if (written > 0) {
+        mgen_stdout.len += (size_t)written;
+    }
+}
+
+static inline void mgen_stdout_bool(bool value) {
+    mgen_stdout_write(value ? "true" : "false", value ? 4 : 5);
+}
+
+/**
+ * Python repr() of lists, written element by element into the buffer
+ * No string is built for the list or its elements, so printing a large list
+ * allocates nothing
+ */
+static inline void mgen_stdout_int_list(const int* items, size_t count) {
+    mgen_stdout_char('[');
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            mgen_stdout_write(", ", 2);
+        }
+        mgen_stdout_int(items[i]);
+    }
+    mgen_stdout_char(']');
+}
+
+// repr() of a float: the shortest %g that reads back as the same value, with ".0" when integral
+static inline void mgen_stdout_double_repr(double value) {
+    char* out = mgen_stdout_reserve(32);
+    int written = 0;
+    for (int precision = 15; precision <= 17; precision++) {
+        written = snprintf(out, 32, "%.*g", precision, value);
+        if (written < 0 || strtod(out, NULL) == value) {
+            break;
+        }
+    }
+    if (written <= 0) {
+        return;
+    }
+    bool integral = strpbrk(out, ".ein") == NULL;
+    mgen_stdout.len += (size_t)written;
+    if (integral) {
+        mgen_stdout_write(".0", 2);
+    }
+}
+
+static inline void mgen_stdout_double_list(const double* items, size_t count) {
+    mgen_stdout_char('[');
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            mgen_stdout_write(", ", 2);
+        }
+        mgen_stdout_double_repr(items[i]);
+    }
+    mgen_stdout_char(']');
+}
+
+// Elements are quoted as repr() does: 'a', "it's", 'tab\t'
+static inline void mgen_stdout_str_list(char* const* items, size_t count) {
+    mgen_stdout_char('[');
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            mgen_stdout_write(", ", 2);
+        }
+        const char* str = items[i];
+        if (!str) {
+            mgen_stdout_write("None", 4);
+            continue;
+        }
+        char quote = strchr(str, '\'') && !strchr(str, '"') ? '"' : '\'';
+        mgen_stdout_char(quote);
+        for (const char* p = str; *p; p++) {
+            switch (*p) {
+                case '\\': mgen_stdout_write("\\\\", 2); break;
+                case '\n': mgen_stdout_write("\\n", 2); break;
+                case '\t': mgen_stdout_write("\\t", 2); break;
+                case '\r': mgen_stdout_write("\\r", 2); break;
+                default:
+                    if (*p == quote) {
+                        mgen_stdout_char('\\');
+                    }
+                    mgen_stdout_char(*p);
+                    break;
+            }
+        }
+        mgen_stdout_char(quote);
+    }
+    mgen_stdout_char(']');
+}
+
+/**
+ * End of a print() line: flushed right away when stdout is a terminal
+ */
+static inline void mgen_stdout_newline(void) {
+    mgen_stdout_char('\n');
+    if (mgen_stdout.mode == MGEN_STDOUT_LINE) {
+        mgen_stdout_flush();
+    }
+}
+
+/**
+ * print(value) of one value
+ */
+static inline void mgen_print_str(const char* str) {
+    mgen_stdout_str(str);
+    mgen_stdout_newline();
+}
+
+static inline void mgen_print_int(long long value) {
+    mgen_stdout_int(value);
+    mgen_stdout_newline();
+}
+
+static inline void mgen_print_double(double value) {
+    mgen_stdout_double(value);
+    mgen_stdout_newline();
+}
+
+static inline void mgen_print_bool(bool value) {
+    mgen_stdout_bool(value);
+    mgen_stdout_newline();
+}
+
+static inline void mgen_print_int_list(const int* items, size_t count) {
+    mgen_stdout_int_list(items, count);
+    mgen_stdout_newline();
+}
+
+static inline void mgen_print_double_list(const double* items, size_t count) {
+    mgen_stdout_double_list(items, count);
+    mgen_stdout_newline();
+}
+
+static inline void mgen_print_str_list(char* const* items, size_t count) {
+    mgen_stdout_str_list(items, count);
+    mgen_stdout_newline();
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_STDOUT_H
@@ -0,0 +1,177 @@
+/**
+ * Chunked string arena for container key/value storage
+ * Strings are bump-allocated into slabs owned by a container, so inserts do
+ * not call malloc per string and teardown frees O(chunks) blocks.
+ * stb-library style: static functions for single-file output
+ */
+
+#ifndef MGEN_STR_ARENA_H
+#define MGEN_STR_ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
+#include "mgen_str_hash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MGEN_STR_ARENA_FIRST_CHUNK
+#define MGEN_STR_ARENA_FIRST_CHUNK 4096
+#endif
+
+#ifndef MGEN_STR_ARENA_MAX_CHUNK
+#define MGEN_STR_ARENA_MAX_CHUNK (1024 * 1024)
+#endif
+
+// Number of leading key bytes cached inline in container entries
+#define MGEN_STR_PREFIX_LEN 4
+
+// One slab of string storage; chunks form a singly linked list
+typedef struct mgen_str_arena_chunk {
+    struct mgen_str_arena_chunk* next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} mgen_str_arena_chunk_t;
+
+// Arena structure: head is the chunk currently being bump-allocated from
+typedef struct {
+    mgen_str_arena_chunk_t* head;
+    size_t chunk_count;
+    size_t next_chunk_size;
+} mgen_str_arena_t;
+
+/**
+ * Allocate size bytes from the arena (no alignment guarantees: char data only)
+ */
+static char* mgen_str_arena_alloc(mgen_str_arena_t* arena, size_t size) {
+    mgen_str_arena_chunk_t* head = arena->head;
+    if (head && head->capacity - head->used >= size) {
+        char* ptr = head->data + head->used;
+        head->used += size;
+        return ptr;
+    }
+
+    if (arena->next_chunk_size == 0) {
+        arena->next_chunk_size = MGEN_STR_ARENA_FIRST_CHUNK;
+    }
+
+    // Oversized strings get a dedicated chunk behind the head so the
+    // partially filled head chunk keeps serving small allocations
+    bool dedicated = head && size > arena->next_chunk_size / 2;
+    size_t capacity = size > arena->next_chunk_size ? size : arena->next_chunk_size;
+
+    MGEN_PROFILE_ALLOC(sizeof(mgen_str_arena_chunk_t) + capacity);
+    mgen_str_arena_chunk_t* chunk = malloc(sizeof(mgen_str_arena_chunk_t) + capacity);
+    if (!chunk) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate string arena chunk");
+        return NULL;
+    }
+    chunk->used = size;
+    chunk->capacity = capacity;
+    arena->chunk_count++;
+
+    if (dedicated) {
+        chunk->next = head->next;
+        head->next = chunk;
+    } else {
+        chunk->next = head;
+        arena->head = chunk;
+        if (arena->next_chunk_size < MGEN_STR_ARENA_MAX_CHUNK) {
+            arena->next_chunk_size *= 2;
+        }
+    }
+
+    return chunk->data;
+}
+
+/**
+ * Copy len bytes of str into the arena as a NUL-terminated string
+ */
+static char* mgen_str_arena_strndup(mgen_str_arena_t* arena, const char* str, size_t len) {
+    char* copy = mgen_str_arena_alloc(arena, len + 1);
+    if (!copy) {
+        return NULL;
+    }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/**
+ * Give back the most recent allocation (ptr, size) if nothing was allocated
+ * after it; returns false and leaves the arena untouched otherwise
+ */
+static bool mgen_str_arena_unwind(mgen_str_arena_t* arena, const char* ptr, size_t size) {
+    mgen_str_arena_chunk_t* head = arena->head;
+    if (!head || !ptr || head->used < size || head->data + head->used - size != ptr) {
+        return false;
+    }
+    head->used -= size;
+    return true;
+}
+
+/**
+ * Release all strings but keep the current (largest) chunk for reuse
+ */
+static void mgen_str_arena_reset(mgen_str_arena_t* arena) {
+    if (!arena->head) {
+        return;
+    }
+
+    mgen_str_arena_chunk_t* chunk = arena->head->next;
+    while (chunk) {
+        mgen_str_arena_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->head->next = NULL;
+    arena->head->used = 0;
+    arena->chunk_count = 1;
+}
+
+/**
+ * Free every chunk owned by the arena
+ */
+static void mgen_str_arena_drop(mgen_str_arena_t* arena) {
+    mgen_str_arena_chunk_t* chunk = arena->head;
+    while (chunk) {
+        mgen_str_arena_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->head = NULL;
+    arena->chunk_count = 0;
+    arena->next_chunk_size = 0;
+}
+
+/**
+ * Fill an entry's inline key prefix (zero padded for short keys)
+ */
+static inline void mgen_str_prefix_init(char prefix[MGEN_STR_PREFIX_LEN], const char* str, size_t len) {
+    memset(prefix, 0, MGEN_STR_PREFIX_LEN);
+    memcpy(prefix, str, len < MGEN_STR_PREFIX_LEN ? len : MGEN_STR_PREFIX_LEN);
+}
+
+/**
+ * Compare a stored key against a probe using cached hash, length and prefix
+ * before touching the arena-resident bytes
+ */
+static inline bool mgen_str_key_equals(size_t stored_hash, size_t stored_len, const char* stored_prefix,
+                                       const char* stored, size_t hash, size_t len, const char* prefix,
+                                       const char* str) {
+    return stored_hash == hash && stored_len == len && memcmp(stored_prefix, prefix, MGEN_STR_PREFIX_LEN) == 0 &&
+           (len <= MGEN_STR_PREFIX_LEN || memcmp(stored, str, len) == 0);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_STR_ARENA_H
@@ -0,0 +1,131 @@
+/**
+ * Shared string hash for the string-keyed runtime containers
+ * stb-library style: static functions for single-file output
+ *
+ * wyhash-style: keys are read 8 bytes at a time and folded with 64x64->128
+ * multiplies, so hashing costs a few cycles per word rather than one
+ * multiply per byte. Containers cache the hash and length in their entries,
+ * so rehashing and most mismatching compares never touch the key bytes.
+ *
+ * Every container carries a seed. It is 0 by default, which keeps iteration
+ * order reproducible. Building with -DMGEN_STR_HASH_RANDOMIZE gives each
+ * container a seed of its own, so input crafted to collide under one seed
+ * (e.g. keys read from an untrusted file) cannot force long probe sequences.
+ */
+
+#ifndef MGEN_STR_HASH_H
+#define MGEN_STR_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef MGEN_STR_HASH_RANDOMIZE
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MGEN_STR_HASH_P0 0xa0761d6478bd642fULL
+#define MGEN_STR_HASH_P1 0xe7037ed1a0b428dbULL
+#define MGEN_STR_HASH_P2 0x8ebc6af09c88c6e3ULL
+
+/**
+ * Multiply to 128 bits and fold the halves together
+ */
+static inline uint64_t mgen_str_hash_mum(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    uint64_t lo = (cross << 32) | (uint32_t)lo_lo;
+    uint64_t hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    return lo ^ hi;
+#endif
+}
+
+static inline uint64_t mgen_str_hash_read64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof v);
+    return v;
+}
+
+static inline uint64_t mgen_str_hash_read32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof v);
+    return v;
+}
+
+/**
+ * Hash len bytes of data (need not be NUL-terminated)
+ */
+static inline size_t mgen_str_hash_bytes(const char* data, size_t len, uint64_t seed) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t a, b;
+    seed ^= MGEN_STR_HASH_P0;
+
+    if (len <= 16) {
+        if (len >= 4) {
+            // Two overlapping 4-byte reads from each end cover 4..16 bytes
+            size_t mid = (len >> 3) << 2;
+            a = (mgen_str_hash_read32(p) << 32) | mgen_str_hash_read32(p + mid);
+            b = (mgen_str_hash_read32(p + len - 4) << 32) | mgen_str_hash_read32(p + len - 4 - mid);
+        } else if (len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t remaining = len;
+        while (remaining > 16) {
+            seed = mgen_str_hash_mum(mgen_str_hash_read64(p) ^ MGEN_STR_HASH_P1, mgen_str_hash_read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        // Last 16 bytes, overlapping the previous block when len is not a multiple of 16
+        a = mgen_str_hash_read64(p + remaining - 16);
+        b = mgen_str_hash_read64(p + remaining - 8);
+    }
+
+    return (size_t)mgen_str_hash_mum(MGEN_STR_HASH_P1 ^ len, mgen_str_hash_mum(a ^ MGEN_STR_HASH_P1, b ^ seed));
+}
+
+/**
+ * Hash of a NUL-terminated string, also reporting its length
+ */
+static inline size_t mgen_str_hash(const char* str, size_t* len_out, uint64_t seed) {
+    size_t len = strlen(str);
+    *len_out = len;
+    return mgen_str_hash_bytes(str, len, seed);
+}
+
+/**
+ * Seed for a container that is allocating its first table
+ * 0 unless built with MGEN_STR_HASH_RANDOMIZE
+ */
+static inline uint64_t mgen_str_hash_seed(const void* container) {
+#ifdef MGEN_STR_HASH_RANDOMIZE
+    // Address-space layout, a per-unit counter and the clock: not cryptographic,
+    // but unknown to whoever prepared the input
+    static uint64_t counter = 0;
+    uint64_t entropy = (uint64_t)(uintptr_t)container ^ ((uint64_t)(uintptr_t)&counter << 17);
+    entropy ^= (uint64_t)time(NULL) * MGEN_STR_HASH_P2 ^ (uint64_t)clock();
+    return mgen_str_hash_mum(entropy ^ MGEN_STR_HASH_P0, ++counter ^ MGEN_STR_HASH_P1);
+#else
+    (void)container;
+    return 0;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_STR_HASH_H
@@ -1,7 +1,19 @@
 /**
  * Simple hash table for string -> int mappings
- * Owns string keys (uses strdup/free)
+ * Owns string keys (copied on insert, freed on remove)
  * Clean, understandable implementation without macro magic
+ *
+ * Entries cache their key hash and length: growing the table relinks entries
+ * without rehashing keys, and chain walks only compare bytes on a hash match.
+ *
+ * Growing is incremental: the previous bucket array stays alive and
+ * STR_INT_MAP_MIGRATE_STEP of its buckets move to the new one on each insert
+ * and remove, so no single insert relinks the whole map.
+ *
+ * A map made by mgen_str_int_map_new_interned() keys its entries by symbols
+ * (see mgen_str_intern.h) instead of owned copies: inserting interns the key,
+ * lookups compare pointers and hash by identity, and the *_symbol variants
+ * skip hashing the key bytes altogether for keys that are symbols already.
  */
 
 #ifndef MGEN_STR_INT_MAP_H
@@ -9,6 +21,9 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "mgen_str_hash.h"
+#include "mgen_str_intern.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,30 +31,59 @@ extern "C" {
 
 // Hash table entry
 typedef struct mgen_str_int_entry {
-    char* key;                          // Owned string (strdup'd)
-    int value;
+    union { char* key; char* first; };  // Owned copy of the key, or its symbol (first: STC-compatible alias)
+    union { int value; int second; };
+    size_t hash;                        // Cached key hash
+    size_t key_len;                     // Cached key length
     struct mgen_str_int_entry* next;    // For collision chaining
 } mgen_str_int_entry_t;
 
 // Hash table structure
 typedef struct {
     mgen_str_int_entry_t** buckets;
-    size_t bucket_count;
+    size_t bucket_count;                // Power of two
     size_t size;                        // Number of entries
+    mgen_str_int_entry_t** old_buckets; // Array still being migrated (NULL when not rehashing)
+    size_t old_bucket_count;
+    size_t migrate_index;               // Old buckets below this index are already empty
+    uint64_t seed;                      // Key hash seed (see mgen_str_hash.h)
+    struct mgen_memory_pool* pool;      // Optional entry allocator (NULL = malloc/free)
+    bool interned;                      // Keys are symbols: compared by pointer, hashed by identity
 } mgen_str_int_map_t;
 
+// Cursor over entries: old buckets first while migrating, then the current array
+typedef struct {
+    mgen_str_int_entry_t* ref;          // Current entry, NULL once past the end
+    const mgen_str_int_map_t* map;
+    size_t bucket_index;
+} mgen_str_int_map_iter;
+
 /**
  * Create a new string-to-int map
  * Initial capacity defaults to 16 buckets
  */
 
 /**
- * Create a map with specific initial capacity
+ * Create a map with specific initial capacity (rounded up to a power of two)
+ */
+
+/**
+ * Size the bucket array for at least count entries without further growth
+ */
+
+/**
+ * Create a map whose entries are carved from a memory pool
+ * Removed entries are recycled by later inserts; the pool must outlive the map
+ */
+
+/**
+ * Create a map keyed by interned symbols
+ * Inserted keys are interned rather than copied, and stay valid after the map is freed
  */
 
 /**
  * Insert or update a key-value pair
- * Key is copied (strdup), so caller retains ownership of input string
+ * Key is copied, so caller retains ownership of input string
  * Returns true if inserted, false if updated existing key
  */
 
@@ -48,6 +92,11 @@ typedef struct {
  * Returns pointer to value if found, NULL if not found
  */
 
+/**
+ * *_symbol variants: same as the plain functions for a key that is a symbol
+ * An interned map then looks the key up without reading its bytes
+ */
+
 /**
  * Check if key exists in map
  */
@@ -61,6 +110,10 @@ typedef struct {
  * Get number of entries in map
  */
 
+/**
+ * Iterate entries: for (it = begin(map); it.ref; next(&it)) reads it.ref->key / it.ref->value
+ */
+
 /**
  * Free all memory associated with map
  * Frees all keys and the map structure itself
@@ -76,65 +129,193 @@ typedef struct {
  */
 
 #include "mgen_error_handling.h"
+#include "mgen_memory_ops.h"
 #include <stdlib.h>
 #include <string.h>
 
 #define DEFAULT_BUCKET_COUNT 16
 #define LOAD_FACTOR_THRESHOLD 0.75
+#define STR_INT_MAP_MIGRATE_STEP 2
+
 
 /**
- * djb2 hash function - simple and effective for strings
+ * Return an entry's storage (to the pool's free list when pooled)
  */
-static unsigned long hash_string(const char* str) {
-    unsigned long hash = 5381;
-    int c;
-    while ((c = *str++)) {
-        hash = ((hash << 5) + hash) + c; // hash * 33 + c
+static void entry_release(mgen_str_int_map_t* map, mgen_str_int_entry_t* entry) {
+    if (map->pool) {
+        mgen_memory_pool_release(map->pool, entry, sizeof(mgen_str_int_entry_t));
+    } else {
+        free(entry);
     }
-    return hash;
 }
 
 /**
  * Create a new entry
  */
-static mgen_str_int_entry_t* entry_new(const char* key, int value) {
-    mgen_str_int_entry_t* entry = malloc(sizeof(mgen_str_int_entry_t));
+static mgen_str_int_entry_t* entry_new(mgen_str_int_map_t* map, const char* key, size_t key_len, size_t hash,
+                                       int value) {
+    MGEN_PROFILE_ALLOC(sizeof(mgen_str_int_entry_t));
+    mgen_str_int_entry_t* entry = map->pool ? mgen_memory_pool_alloc(map->pool, sizeof(mgen_str_int_entry_t))
+                                            : malloc(sizeof(mgen_str_int_entry_t));
     if (!entry) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate map entry");
         return NULL;
     }
 
-    entry->key = strdup(key);
+    // malloc + memcpy rather than strdup, which strict ISO C modes do not declare
+    if (map->interned) {
+        entry->key = (char*)key;
+    } else {
+        MGEN_PROFILE_ALLOC(key_len + 1);
+        entry->key = malloc(key_len + 1);
+        if (entry->key) {
+            memcpy(entry->key, key, key_len + 1);
+        }
+    }
     if (!entry->key) {
-        free(entry);
+        entry_release(map, entry);
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to duplicate key");
         return NULL;
     }
 
     entry->value = value;
+    entry->hash = hash;
+    entry->key_len = key_len;
     entry->next = NULL;
     return entry;
 }
 
+/**
+ * Whether entry holds key: symbols are equal only when identical
+ */
+static inline bool entry_matches(const mgen_str_int_map_t* map, const mgen_str_int_entry_t* entry, const char* key,
+                                 size_t key_len, size_t hash) {
+    if (map->interned) {
+        return entry->key == key;
+    }
+    return entry->hash == hash && entry->key_len == key_len && memcmp(entry->key, key, key_len) == 0;
+}
+
+/**
+ * Find the entry for key in one bucket chain, or NULL
+ */
+static mgen_str_int_entry_t* entry_find_in(const mgen_str_int_map_t* map, mgen_str_int_entry_t* entry,
+                                           const char* key, size_t key_len, size_t hash) {
+    while (entry) {
+        if (entry_matches(map, entry, key, key_len, hash)) {
+            return entry;
+        }
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+/**
+ * Find the entry for key in the current or not-yet-migrated bucket array, or NULL
+ */
+static mgen_str_int_entry_t* entry_find(const mgen_str_int_map_t* map, const char* key, size_t key_len,
+                                        size_t hash) {
+    mgen_str_int_entry_t* entry =
+        entry_find_in(map, map->buckets[hash & (map->bucket_count - 1)], key, key_len, hash);
+    if (!entry && map->old_buckets) {
+        entry = entry_find_in(map, map->old_buckets[hash & (map->old_bucket_count - 1)], key, key_len, hash);
+    }
+    return entry;
+}
+
+/**
+ * Relink a chain into the current bucket array by the entries' cached hashes
+ */
+static void entry_relink(mgen_str_int_map_t* map, mgen_str_int_entry_t* entry) {
+    while (entry) {
+        mgen_str_int_entry_t* next = entry->next;
+        size_t index = entry->hash & (map->bucket_count - 1);
+        entry->next = map->buckets[index];
+        map->buckets[index] = entry;
+        entry = next;
+    }
+}
+
+/**
+ * Move up to steps old buckets into the current array, freeing the old array when done
+ */
+static void buckets_migrate(mgen_str_int_map_t* map, size_t steps) {
+    while (map->old_buckets && steps-- > 0) {
+        mgen_str_int_entry_t* chain = map->old_buckets[map->migrate_index];
+        map->old_buckets[map->migrate_index] = NULL;
+        entry_relink(map, chain);
+
+        if (++map->migrate_index == map->old_bucket_count) {
+            free(map->old_buckets);
+            map->old_buckets = NULL;
+            map->old_bucket_count = 0;
+            map->migrate_index = 0;
+        }
+    }
+}
+
+/**
+ * Replace the bucket array with one of new_count buckets
+ * incremental keeps the old array for buckets_migrate; otherwise every entry is relinked now
+ */
+static bool buckets_resize(mgen_str_int_map_t* map, size_t new_count, bool incremental) {
+    buckets_migrate(map, SIZE_MAX);
+
+    MGEN_PROFILE_ALLOC(new_count * sizeof(mgen_str_int_entry_t*));
+    mgen_str_int_entry_t** new_buckets = calloc(new_count, sizeof(mgen_str_int_entry_t*));
+    if (!new_buckets) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow buckets");
+        return false;
+    }
+
+    mgen_str_int_entry_t** old_buckets = map->buckets;
+    size_t old_count = map->bucket_count;
+    map->buckets = new_buckets;
+    map->bucket_count = new_count;
+
+    if (incremental) {
+        map->old_buckets = old_buckets;
+        map->old_bucket_count = old_count;
+        map->migrate_index = 0;
+        return true;
+    }
+
+    for (size_t i = 0; i < old_count; i++) {
+        entry_relink(map, old_buckets[i]);
+    }
+    free(old_buckets);
+    return true;
+}
+
 /**
  * Free an entry and its chain
  */
-static void entry_free(mgen_str_int_entry_t* entry) {
+static void entry_free(mgen_str_int_map_t* map, mgen_str_int_entry_t* entry) {
     while (entry) {
         mgen_str_int_entry_t* next = entry->next;
-        free(entry->key);
-        free(entry);
+        if (!map->interned) {
+            free(entry->key);
+        }
+        entry_release(map, entry);
         entry = next;
     }
 }
 
 static mgen_str_int_map_t* mgen_str_int_map_new_with_capacity(size_t capacity) {
+    size_t bucket_count = 1;
+    while (bucket_count < capacity) {
+        bucket_count *= 2;
+    }
+    capacity = bucket_count;
+
+    MGEN_PROFILE_ALLOC(sizeof(mgen_str_int_map_t));
     mgen_str_int_map_t* map = malloc(sizeof(mgen_str_int_map_t));
     if (!map) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate map");
         return NULL;
     }
 
+    MGEN_PROFILE_ALLOC(capacity * sizeof(mgen_str_int_entry_t*));
     map->buckets = calloc(capacity, sizeof(mgen_str_int_entry_t*));
     if (!map->buckets) {
         free(map);
@@ -144,6 +325,12 @@ static mgen_str_int_map_t* mgen_str_int_map_new_with_capacity(size_t capacity) {
 
     map->bucket_count = capacity;
     map->size = 0;
+    map->old_buckets = NULL;
+    map->old_bucket_count = 0;
+    map->migrate_index = 0;
+    map->seed = mgen_str_hash_seed(map);
+    map->pool = NULL;
+    map->interned = false;
     return map;
 }
 
@@ -151,60 +338,172 @@ static mgen_str_int_map_t* mgen_str_int_map_new(void) {
     return mgen_str_int_map_new_with_capacity(DEFAULT_BUCKET_COUNT);
 }
 
-static bool mgen_str_int_map_insert(mgen_str_int_map_t* map, const char* key, int value) {
-    if (!map || !key) {
-        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map or key");
+static mgen_str_int_map_t* mgen_str_int_map_new_with_pool(mgen_memory_pool_t* pool) {
+    mgen_str_int_map_t* map = mgen_str_int_map_new_with_capacity(DEFAULT_BUCKET_COUNT);
+    if (map) {
+        map->pool = pool;
+    }
+    return map;
+}
+
+static mgen_str_int_map_t* mgen_str_int_map_new_interned(void) {
+    mgen_str_int_map_t* map = mgen_str_int_map_new_with_capacity(DEFAULT_BUCKET_COUNT);
+    if (map) {
+        map->interned = true;
+    }
+    return map;
+}
+
+static bool mgen_str_int_map_reserve(mgen_str_int_map_t* map, size_t count) {
+    if (!map) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map");
         return false;
     }
 
-    unsigned long hash = hash_string(key);
-    size_t index = hash % map->bucket_count;
+    size_t bucket_count = map->bucket_count;
+    while ((double)count > (double)bucket_count * LOAD_FACTOR_THRESHOLD) {
+        bucket_count *= 2;
+    }
+    if (bucket_count == map->bucket_count) {
+        return true;
+    }
+    return buckets_resize(map, bucket_count, false);
+}
 
-    // Check if key already exists
-    mgen_str_int_entry_t* entry = map->buckets[index];
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            // Update existing value
-            entry->value = value;
-            return false; // Updated, not inserted
-        }
-        entry = entry->next;
+/**
+ * Hash and length of *key; an interned map first replaces *key by its symbol
+ * (interning it when intern is set, unless it is a symbol already), leaving
+ * *key NULL when a lookup key was never interned and so cannot be present
+ */
+static size_t entry_key_hash(const mgen_str_int_map_t* map, const char** key, size_t* key_len, bool is_symbol,
+                             bool intern) {
+    if (!map->interned) {
+        return mgen_str_hash(*key, key_len, map->seed);
+    }
+    if (!is_symbol) {
+        *key = intern ? mgen_str_intern(*key) : mgen_str_intern_find(*key);
+    }
+    // Symbols compare by identity, so only new entries need the length
+    *key_len = 0;
+    return *key ? mgen_str_symbol_hash(*key) : 0;
+}
+
+/**
+ * Find the entry for key, adding one with value if absent (*inserted tells which)
+ * Returns NULL if a new entry cannot be allocated
+ */
+static mgen_str_int_entry_t* entry_find_or_add(mgen_str_int_map_t* map, const char* key, bool is_symbol, int value,
+                                               bool* inserted) {
+    buckets_migrate(map, STR_INT_MAP_MIGRATE_STEP);
+
+    size_t key_len;
+    size_t hash = entry_key_hash(map, &key, &key_len, is_symbol, true);
+
+    *inserted = false;
+    if (!key) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to intern key");
+        return NULL;
+    }
+    mgen_str_int_entry_t* entry = entry_find(map, key, key_len, hash);
+    if (entry) {
+        return entry;
+    }
+
+    // Keep the average chain under LOAD_FACTOR_THRESHOLD entries
+    if ((double)(map->size + 1) > (double)map->bucket_count * LOAD_FACTOR_THRESHOLD) {
+        buckets_resize(map, map->bucket_count * 2, true);
     }
 
     // Insert new entry at head of chain
-    mgen_str_int_entry_t* new_entry = entry_new(key, value);
+    if (map->interned) {
+        key_len = strlen(key);
+    }
+    mgen_str_int_entry_t* new_entry = entry_new(map, key, key_len, hash, value);
     if (!new_entry) {
-        return false;
+        return NULL;
     }
 
+    size_t index = hash & (map->bucket_count - 1);
     new_entry->next = map->buckets[index];
     map->buckets[index] = new_entry;
     map->size++;
 
-    return true; // Inserted
+    *inserted = true;
+    return new_entry;
 }
 
-static int* mgen_str_int_map_get(mgen_str_int_map_t* map, const char* key) {
+static bool str_int_map_insert(mgen_str_int_map_t* map, const char* key, bool is_symbol, int value) {
     if (!map || !key) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map or key");
+        return false;
+    }
+
+    bool inserted;
+    mgen_str_int_entry_t* entry = entry_find_or_add(map, key, is_symbol, value, &inserted);
+    if (entry && !inserted) {
+        // Update existing value
+        entry->value = value;
+    }
+    return inserted;
+}
+
+static bool mgen_str_int_map_insert(mgen_str_int_map_t* map, const char* key, int value) {
+    return str_int_map_insert(map, key, false, value);
+}
+
+static bool mgen_str_int_map_insert_symbol(mgen_str_int_map_t* map, const char* symbol, int value) {
+    return str_int_map_insert(map, symbol, true, value);
+}
+
+static int* str_int_map_get_or_insert(mgen_str_int_map_t* map, const char* key, bool is_symbol, int default_value) {
+    if (!map || !key) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map or key");
         return NULL;
     }
 
-    unsigned long hash = hash_string(key);
-    size_t index = hash % map->bucket_count;
+    bool inserted;
+    mgen_str_int_entry_t* entry = entry_find_or_add(map, key, is_symbol, default_value, &inserted);
+    return entry ? &entry->value : NULL;
+}
 
-    mgen_str_int_entry_t* entry = map->buckets[index];
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            return &entry->value;
-        }
-        entry = entry->next;
+/**
+ * Get the value for key, inserting default_value first if absent
+ * A counting update is one lookup: *mgen_str_int_map_get_or_insert(map, key, 0) += 1;
+ * Returns NULL for a NULL map or key, or if the entry cannot be allocated
+ */
+static int* mgen_str_int_map_get_or_insert(mgen_str_int_map_t* map, const char* key, int default_value) {
+    return str_int_map_get_or_insert(map, key, false, default_value);
+}
+
+static int* mgen_str_int_map_get_or_insert_symbol(mgen_str_int_map_t* map, const char* symbol, int default_value) {
+    return str_int_map_get_or_insert(map, symbol, true, default_value);
+}
+
+static int* str_int_map_get(mgen_str_int_map_t* map, const char* key, bool is_symbol) {
+    if (!map || !key) {
+        return NULL;
     }
 
-    return NULL;
+    size_t key_len;
+    size_t hash = entry_key_hash(map, &key, &key_len, is_symbol, false);
+    mgen_str_int_entry_t* entry = key ? entry_find(map, key, key_len, hash) : NULL;
+    return entry ? &entry->value : NULL;
+}
+
+static int* mgen_str_int_map_get(mgen_str_int_map_t* map, const char* key) {
+    return str_int_map_get(map, key, false);
+}
+
+static int* mgen_str_int_map_get_symbol(mgen_str_int_map_t* map, const char* symbol) {
+    return str_int_map_get(map, symbol, true);
 }
 
 static bool mgen_str_int_map_contains(mgen_str_int_map_t* map, const char* key) {
-    return mgen_str_int_map_get(map, key) != NULL;
+    return str_int_map_get(map, key, false) != NULL;
+}
+
+static bool mgen_str_int_map_contains_symbol(mgen_str_int_map_t* map, const char* symbol) {
+    return str_int_map_get(map, symbol, true) != NULL;
 }
 
 static bool mgen_str_int_map_remove(mgen_str_int_map_t* map, const char* key) {
@@ -212,20 +511,35 @@ static bool mgen_str_int_map_remove(mgen_str_int_map_t* map, const char* key) {
         return false;
     }
 
-    unsigned long hash = hash_string(key);
-    size_t index = hash % map->bucket_count;
+    buckets_migrate(map, STR_INT_MAP_MIGRATE_STEP);
 
-    mgen_str_int_entry_t** entry_ptr = &map->buckets[index];
-    while (*entry_ptr) {
-        mgen_str_int_entry_t* entry = *entry_ptr;
-        if (strcmp(entry->key, key) == 0) {
-            *entry_ptr = entry->next;
-            free(entry->key);
-            free(entry);
-            map->size--;
-            return true;
+    size_t key_len;
+    size_t hash = entry_key_hash(map, &key, &key_len, false, false);
+    if (!key) {
+        return false;
+    }
+
+    // Current array first, then the not-yet-migrated old bucket
+    mgen_str_int_entry_t** chains[2] = {&map->buckets[hash & (map->bucket_count - 1)], NULL};
+    if (map->old_buckets) {
+        chains[1] = &map->old_buckets[hash & (map->old_bucket_count - 1)];
+    }
+
+    for (int c = 0; c < 2 && chains[c]; c++) {
+        mgen_str_int_entry_t** entry_ptr = chains[c];
+        while (*entry_ptr) {
+            mgen_str_int_entry_t* entry = *entry_ptr;
+            if (entry_matches(map, entry, key, key_len, hash)) {
+                *entry_ptr = entry->next;
+                if (!map->interned) {
+                    free(entry->key);
+                }
+                entry_release(map, entry);
+                map->size--;
+                return true;
+            }
+            entry_ptr = &entry->next;
         }
-        entry_ptr = &entry->next;
     }
 
     return false;
@@ -242,11 +556,19 @@ static inline void mgen_str_int_map_clear(mgen_str_int_map_t* map) {
 
     for (size_t i = 0; i < map->bucket_count; i++) {
         if (map->buckets[i]) {
-            entry_free(map->buckets[i]);
+            entry_free(map, map->buckets[i]);
             map->buckets[i] = NULL;
         }
     }
 
+    for (size_t i = map->migrate_index; i < map->old_bucket_count; i++) {
+        entry_free(map, map->old_buckets[i]);
+    }
+    free(map->old_buckets);
+    map->old_buckets = NULL;
+    map->old_bucket_count = 0;
+    map->migrate_index = 0;
+
     map->size = 0;
 }
 
@@ -260,6 +582,44 @@ static void mgen_str_int_map_free(mgen_str_int_map_t* map) {
     free(map);
 }
 
+static inline mgen_str_int_entry_t* mgen_str_int_map_bucket_at(const mgen_str_int_map_t* map, size_t index) {
+    return index < map->old_bucket_count ? map->old_buckets[index] : map->buckets[index - map->old_bucket_count];
+}
+
+static inline void mgen_str_int_map_iter_seek(mgen_str_int_map_iter* iter) {
+    const mgen_str_int_map_t* map = iter->map;
+    size_t bucket_total = map->old_bucket_count + map->bucket_count;
+    while (iter->bucket_index < bucket_total && !mgen_str_int_map_bucket_at(map, iter->bucket_index)) {
+        iter->bucket_index++;
+    }
+    iter->ref = iter->bucket_index < bucket_total ? mgen_str_int_map_bucket_at(map, iter->bucket_index) : NULL;
+}
+
+static inline mgen_str_int_map_iter mgen_str_int_map_begin(const mgen_str_int_map_t* map) {
+    mgen_str_int_map_iter iter = {NULL, map, 0};
+    if (map) {
+        mgen_str_int_map_iter_seek(&iter);
+    }
+    return iter;
+}
+
+static inline void mgen_str_int_map_next(mgen_str_int_map_iter* iter) {
+    if (!iter->ref) {
+        return;
+    }
+    if (iter->ref->next) {
+        iter->ref = iter->ref->next;
+        return;
+    }
+    iter->bucket_index++;
+    mgen_str_int_map_iter_seek(iter);
+}
+
+static inline mgen_str_int_map_iter mgen_str_int_map_end(const mgen_str_int_map_t* map) {
+    mgen_str_int_map_iter iter = {NULL, map, map ? map->old_bucket_count + map->bucket_count : 0};
+    return iter;
+}
+
 
 // Implementation
 
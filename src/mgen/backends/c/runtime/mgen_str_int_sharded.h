@@ -0,0 +1,387 @@
+/**
+ * Sharded string -> int map for building counts on several threads
+ * stb-library style: static functions for single-file output
+ *
+ * Keys are spread over a power-of-two number of shards by the high bits of
+ * their hash (the shard maps pick buckets with the low bits). Each shard is a
+ * mgen_str_int_map_t behind its own mutex, so threads adding different keys
+ * rarely wait for each other.
+ *
+ * Counting jobs should go through mgen_str_int_sharded_count, which runs on
+ * the mgen_parallel pool: every participant counts its chunks into a private
+ * map without locking, and the private maps are merged into the shards at
+ * the end, taking each shard lock once per participant instead of once per
+ * key. Since counts are integer sums the result does not depend on how the
+ * iterations were split; only the order of entries within a shard does.
+ * Builds without threads (_WIN32, MGEN_NO_THREADS) drop the locks.
+ */
+
+#ifndef MGEN_STR_INT_SHARDED_H
+#define MGEN_STR_INT_SHARDED_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "mgen_error_handling.h"
+#include "mgen_parallel.h"
+#include "mgen_str_hash.h"
+#include "mgen_str_int_map.h"
+
+#if !defined(_WIN32) && !defined(MGEN_NO_THREADS)
+#define MGEN_STR_INT_SHARDED_THREADS 1
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Default shards per pool thread: enough that concurrent merges seldom meet on one lock
+#ifndef MGEN_STR_INT_SHARDS_PER_THREAD
+#define MGEN_STR_INT_SHARDS_PER_THREAD 8
+#endif
+
+typedef struct {
+#ifdef MGEN_STR_INT_SHARDED_THREADS
+    pthread_mutex_t lock;
+#endif
+    mgen_str_int_map_t* map;
+    char padding[64];                   // Keeps neighbouring locks off one cache line
+} mgen_str_int_shard_t;
+
+typedef struct {
+    mgen_str_int_shard_t* shards;
+    size_t shard_count;                 // Power of two
+    unsigned shard_shift;               // Hash bits below the shard index
+    uint64_t seed;                      // Seed of the shard-selecting hash
+} mgen_str_int_sharded_t;
+
+// Chunk of a counting job: adds the counts of iterations [begin, end) to local
+typedef void (*mgen_str_int_count_body_t)(void* ctx, size_t begin, size_t end, mgen_str_int_map_t* local);
+
+/**
+ * Create a sharded map with shard_count shards (rounded up to a power of two)
+ * 0 picks MGEN_STR_INT_SHARDS_PER_THREAD per mgen_parallel thread.
+ */
+
+/**
+ * Add delta to the count of key (inserting it at 0 first); safe from any thread
+ * Returns false if a new entry cannot be allocated
+ */
+
+/**
+ * Add every count of local, locking each shard once; safe from any thread
+ * local is left unchanged.
+ */
+
+/**
+ * Run body over [0, count) on the pool (split when count >= threshold)
+ * Each participant counts into a private map that is merged afterwards.
+ * Returns false if an entry could not be allocated along the way.
+ */
+
+/**
+ * Value for key, or NULL; read once the writers are done
+ */
+
+/**
+ * Number of distinct keys
+ */
+
+/**
+ * Add every count to out (a plain map, e.g. the generated dict); once the writers are done
+ */
+
+/**
+ * Free the shards and their keys
+ */
+
+
+// Implementation
+
+static inline void str_int_shard_lock(mgen_str_int_shard_t* shard) {
+#ifdef MGEN_STR_INT_SHARDED_THREADS
+    pthread_mutex_lock(&shard->lock);
+#else
+    (void)shard;
+#endif
+}
+
+static inline void str_int_shard_unlock(mgen_str_int_shard_t* shard) {
+#ifdef MGEN_STR_INT_SHARDED_THREADS
+    pthread_mutex_unlock(&shard->lock);
+#else
+    (void)shard;
+#endif
+}
+
+static inline size_t str_int_sharded_index(const mgen_str_int_sharded_t* sharded, size_t hash) {
+    return sharded->shard_count > 1 ? hash >> sharded->shard_shift : 0;
+}
+
+/**
+ * Shard of a plain map's entry, reusing its cached hash when both hash with the same seed
+ */
+static inline size_t str_int_sharded_entry_index(const mgen_str_int_sharded_t* sharded,
+                                                 const mgen_str_int_map_t* local, const mgen_str_int_entry_t* entry) {
+    size_t key_len;
+    size_t hash = !local->interned && local->seed == sharded->seed ? entry->hash
+                                                                   : mgen_str_hash(entry->key, &key_len, sharded->seed);
+    return str_int_sharded_index(sharded, hash);
+}
+
+static void mgen_str_int_sharded_free(mgen_str_int_sharded_t* sharded) {
+    if (!sharded) {
+        return;
+    }
+
+    for (size_t i = 0; i < sharded->shard_count; i++) {
+        mgen_str_int_map_free(sharded->shards[i].map);
+#ifdef MGEN_STR_INT_SHARDED_THREADS
+        pthread_mutex_destroy(&sharded->shards[i].lock);
+#endif
+    }
+    free(sharded->shards);
+    free(sharded);
+}
+
+static mgen_str_int_sharded_t* mgen_str_int_sharded_new(size_t shard_count) {
+    if (shard_count == 0) {
+        shard_count = mgen_parallel_threads() * MGEN_STR_INT_SHARDS_PER_THREAD;
+    }
+    size_t count = 1;
+    unsigned bits = 0;
+    while (count < shard_count) {
+        count *= 2;
+        bits++;
+    }
+
+    MGEN_PROFILE_ALLOC(sizeof(mgen_str_int_sharded_t));
+    mgen_str_int_sharded_t* sharded = malloc(sizeof(mgen_str_int_sharded_t));
+    if (!sharded) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate sharded map");
+        return NULL;
+    }
+
+    MGEN_PROFILE_ALLOC(count * sizeof(mgen_str_int_shard_t));
+    sharded->shards = calloc(count, sizeof(mgen_str_int_shard_t));
+    if (!sharded->shards) {
+        free(sharded);
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate shards");
+        return NULL;
+    }
+    sharded->shard_count = 0;
+    sharded->shard_shift = (unsigned)(sizeof(size_t) * CHAR_BIT) - bits;
+    sharded->seed = mgen_str_hash_seed(sharded);
+
+    for (size_t i = 0; i < count; i++) {
+        sharded->shards[i].map = mgen_str_int_map_new();
+        if (!sharded->shards[i].map) {
+            mgen_str_int_sharded_free(sharded);
+            return NULL;
+        }
+#ifdef MGEN_STR_INT_SHARDED_THREADS
+        pthread_mutex_init(&sharded->shards[i].lock, NULL);
+#endif
+        // Counted as it is set up, so a failure frees exactly the shards made so far
+        sharded->shard_count++;
+    }
+    return sharded;
+}
+
+static bool mgen_str_int_sharded_add(mgen_str_int_sharded_t* sharded, const char* key, int delta) {
+    if (!sharded || !key) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map or key");
+        return false;
+    }
+
+    size_t key_len;
+    mgen_str_int_shard_t* shard = &sharded->shards[str_int_sharded_index(sharded, mgen_str_hash(key, &key_len,
+                                                                                                sharded->seed))];
+    str_int_shard_lock(shard);
+    int* value = mgen_str_int_map_get_or_insert(shard->map, key, 0);
+    if (value) {
+        *value += delta;
+    }
+    str_int_shard_unlock(shard);
+    return value != NULL;
+}
+
+static bool mgen_str_int_sharded_merge(mgen_str_int_sharded_t* sharded, const mgen_str_int_map_t* local) {
+    if (!sharded || !local) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map");
+        return false;
+    }
+    size_t count = local->size;
+    if (count == 0) {
+        return true;
+    }
+
+    bool ok = true;
+    size_t* starts = calloc(sharded->shard_count + 1, sizeof(size_t));
+    const mgen_str_int_entry_t** order = malloc(count * sizeof(mgen_str_int_entry_t*));
+    if (!starts || !order) {
+        // No room to group the entries: lock per key instead
+        free(starts);
+        free(order);
+        for (mgen_str_int_map_iter it = mgen_str_int_map_begin(local); it.ref; mgen_str_int_map_next(&it)) {
+            ok &= mgen_str_int_sharded_add(sharded, it.ref->key, it.ref->value);
+        }
+        return ok;
+    }
+
+    // Counting sort of the entries by shard
+    for (mgen_str_int_map_iter it = mgen_str_int_map_begin(local); it.ref; mgen_str_int_map_next(&it)) {
+        starts[str_int_sharded_entry_index(sharded, local, it.ref) + 1]++;
+    }
+    for (size_t i = 0; i < sharded->shard_count; i++) {
+        starts[i + 1] += starts[i];
+    }
+    for (mgen_str_int_map_iter it = mgen_str_int_map_begin(local); it.ref; mgen_str_int_map_next(&it)) {
+        order[starts[str_int_sharded_entry_index(sharded, local, it.ref)]++] = it.ref;
+    }
+    // starts[i] now ends shard i's run (and starts shard i + 1's)
+
+    // Participants begin at different shards, so concurrent merges do not queue up on one lock
+    size_t first = mgen_parallel_participant() * sharded->shard_count / mgen_parallel_threads();
+    for (size_t step = 0; step < sharded->shard_count; step++) {
+        size_t index = (first + step) & (sharded->shard_count - 1);
+        size_t begin = index > 0 ? starts[index - 1] : 0;
+        size_t end = starts[index];
+        if (begin == end) {
+            continue;
+        }
+        mgen_str_int_shard_t* shard = &sharded->shards[index];
+        str_int_shard_lock(shard);
+        for (size_t i = begin; i < end; i++) {
+            int* value = mgen_str_int_map_get_or_insert(shard->map, order[i]->key, 0);
+            if (value) {
+                *value += order[i]->value;
+            } else {
+                ok = false;
+            }
+        }
+        str_int_shard_unlock(shard);
+    }
+
+    free(starts);
+    free(order);
+    return ok;
+}
+
+typedef struct {
+    mgen_str_int_sharded_t* sharded;
+    mgen_str_int_map_t** locals;        // One per participant
+    bool* failed;                       // Per local, written only by the task merging it
+    mgen_str_int_count_body_t body;
+    void* ctx;
+} mgen_str_int_count_job_t;
+
+static void str_int_sharded_count_chunk(void* arg, size_t begin, size_t end) {
+    mgen_str_int_count_job_t* job = arg;
+    job->body(job->ctx, begin, end, job->locals[mgen_parallel_participant()]);
+}
+
+static void str_int_sharded_merge_locals(void* arg, size_t begin, size_t end) {
+    mgen_str_int_count_job_t* job = arg;
+    for (size_t i = begin; i < end; i++) {
+        job->failed[i] = !mgen_str_int_sharded_merge(job->sharded, job->locals[i]);
+    }
+}
+
+static bool mgen_str_int_sharded_count(mgen_str_int_sharded_t* sharded, size_t count, size_t threshold,
+                                       mgen_str_int_count_body_t body, void* ctx) {
+    if (!sharded || !body) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map or body");
+        return false;
+    }
+
+    size_t participants = mgen_parallel_threads();
+    mgen_str_int_count_job_t job = {sharded, calloc(participants, sizeof(mgen_str_int_map_t*)),
+                                    calloc(participants, sizeof(bool)), body, ctx};
+    bool ok = job.locals && job.failed;
+    // Made here rather than on first use: creating maps (their seeds) is not thread-safe
+    for (size_t i = 0; ok && i < participants; i++) {
+        job.locals[i] = mgen_str_int_map_new();
+        ok = job.locals[i] != NULL;
+    }
+
+    if (ok) {
+        mgen_parallel_for(count, threshold, str_int_sharded_count_chunk, &job);
+        // One merge task per participant's map, which the pool spreads over the threads
+        mgen_parallel_for(participants, 2, str_int_sharded_merge_locals, &job);
+        for (size_t i = 0; i < participants; i++) {
+            ok &= !job.failed[i];
+        }
+    } else {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate counting buffers");
+    }
+
+    if (job.locals) {
+        for (size_t i = 0; i < participants; i++) {
+            mgen_str_int_map_free(job.locals[i]);
+        }
+    }
+    free(job.locals);
+    free(job.failed);
+    return ok;
+}
+
+static int* mgen_str_int_sharded_get(mgen_str_int_sharded_t* sharded, const char* key) {
+    if (!sharded || !key) {
+        return NULL;
+    }
+
+    size_t key_len;
+    mgen_str_int_shard_t* shard = &sharded->shards[str_int_sharded_index(sharded, mgen_str_hash(key, &key_len,
+                                                                                                sharded->seed))];
+    str_int_shard_lock(shard);
+    int* value = mgen_str_int_map_get(shard->map, key);
+    str_int_shard_unlock(shard);
+    return value;
+}
+
+static size_t mgen_str_int_sharded_size(mgen_str_int_sharded_t* sharded) {
+    if (!sharded) {
+        return 0;
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < sharded->shard_count; i++) {
+        str_int_shard_lock(&sharded->shards[i]);
+        size += mgen_str_int_map_size(sharded->shards[i].map);
+        str_int_shard_unlock(&sharded->shards[i]);
+    }
+    return size;
+}
+
+static bool mgen_str_int_sharded_collect(mgen_str_int_sharded_t* sharded, mgen_str_int_map_t* out) {
+    if (!sharded || !out) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL map");
+        return false;
+    }
+
+    // Shards hold disjoint keys, so out grows at most by their total
+    mgen_str_int_map_reserve(out, mgen_str_int_map_size(out) + mgen_str_int_sharded_size(sharded));
+    bool ok = true;
+    for (size_t i = 0; i < sharded->shard_count; i++) {
+        const mgen_str_int_map_t* map = sharded->shards[i].map;
+        for (mgen_str_int_map_iter it = mgen_str_int_map_begin(map); it.ref; mgen_str_int_map_next(&it)) {
+            int* value = mgen_str_int_map_get_or_insert(out, it.ref->key, 0);
+            if (value) {
+                *value += it.ref->value;
+            } else {
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_STR_INT_SHARDED_H
@@ -0,0 +1,169 @@
+/**
+ * Interned string table: one canonical copy ("symbol") per distinct string
+ * stb-library style: static functions for single-file output
+ *
+ * Equal strings intern to the same pointer, so containers keyed by symbols
+ * compare keys with == and hash the pointer instead of the bytes. Symbols
+ * live in an arena owned by the table and stay valid until
+ * mgen_str_intern_clear(); they must never be freed or modified.
+ *
+ * There is one table per translation unit, which for generated programs is
+ * the whole program. Generated code interns its string literals once at
+ * startup and passes the symbols to the *_symbol container functions.
+ */
+
+#ifndef MGEN_STR_INTERN_H
+#define MGEN_STR_INTERN_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
+#include "mgen_str_hash.h"
+#include "mgen_str_arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MGEN_STR_INTERN_FIRST_CAPACITY 64
+
+// Open-addressing slot; str is NULL when empty
+typedef struct {
+    const char* str;
+    size_t hash;
+    size_t len;
+} mgen_str_intern_slot_t;
+
+typedef struct {
+    mgen_str_intern_slot_t* slots;
+    size_t capacity;                    // Power of two, at most half full
+    size_t count;
+    uint64_t seed;
+    mgen_str_arena_t arena;             // Storage of the symbols
+} mgen_str_intern_table_t;
+
+static mgen_str_intern_table_t mgen_str_intern_table;
+
+/**
+ * Slot holding the string (data, len) with the given hash, or the empty slot it would go in
+ */
+static mgen_str_intern_slot_t* mgen_str_intern_probe(const char* data, size_t len, size_t hash) {
+    mgen_str_intern_table_t* table = &mgen_str_intern_table;
+    size_t mask = table->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        mgen_str_intern_slot_t* slot = &table->slots[i];
+        if (!slot->str || (slot->hash == hash && slot->len == len && memcmp(slot->str, data, len) == 0)) {
+            return slot;
+        }
+    }
+}
+
+/**
+ * Double the slot array (or allocate the first one)
+ */
+static bool mgen_str_intern_grow(void) {
+    mgen_str_intern_table_t* table = &mgen_str_intern_table;
+    size_t old_capacity = table->capacity;
+    mgen_str_intern_slot_t* old_slots = table->slots;
+    size_t capacity = old_capacity ? old_capacity * 2 : MGEN_STR_INTERN_FIRST_CAPACITY;
+
+    MGEN_PROFILE_ALLOC(capacity * sizeof(mgen_str_intern_slot_t));
+    mgen_str_intern_slot_t* slots = calloc(capacity, sizeof(mgen_str_intern_slot_t));
+    if (!slots) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow string intern table");
+        return false;
+    }
+    if (!old_slots) {
+        table->seed = mgen_str_hash_seed(table);
+    }
+
+    table->slots = slots;
+    table->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i].str) {
+            *mgen_str_intern_probe(old_slots[i].str, old_slots[i].len, old_slots[i].hash) = old_slots[i];
+        }
+    }
+    free(old_slots);
+    return true;
+}
+
+/**
+ * Symbol for len bytes of data (need not be NUL-terminated), interning a copy if new
+ * Returns NULL only if the copy cannot be allocated
+ */
+static const char* mgen_str_intern_n(const char* data, size_t len) {
+    mgen_str_intern_table_t* table = &mgen_str_intern_table;
+    if ((table->count + 1) * 2 > table->capacity && !mgen_str_intern_grow()) {
+        return NULL;
+    }
+
+    size_t hash = mgen_str_hash_bytes(data, len, table->seed);
+    mgen_str_intern_slot_t* slot = mgen_str_intern_probe(data, len, hash);
+    if (!slot->str) {
+        char* copy = mgen_str_arena_strndup(&table->arena, data, len);
+        if (!copy) {
+            return NULL;
+        }
+        slot->str = copy;
+        slot->hash = hash;
+        slot->len = len;
+        table->count++;
+    }
+    return slot->str;
+}
+
+/**
+ * Symbol for a NUL-terminated string, interning a copy if new
+ */
+static const char* mgen_str_intern(const char* str) {
+    return str ? mgen_str_intern_n(str, strlen(str)) : NULL;
+}
+
+/**
+ * Symbol for str if it was ever interned, NULL otherwise (never inserts)
+ */
+static const char* mgen_str_intern_find(const char* str) {
+    mgen_str_intern_table_t* table = &mgen_str_intern_table;
+    if (!str || table->count == 0) {
+        return NULL;
+    }
+    size_t len = strlen(str);
+    return mgen_str_intern_probe(str, len, mgen_str_hash_bytes(str, len, table->seed))->str;
+}
+
+/**
+ * Hash of a symbol by identity: equal strings share one pointer
+ */
+static inline size_t mgen_str_symbol_hash(const char* symbol) {
+    return (size_t)mgen_str_hash_mum((uint64_t)(uintptr_t)symbol ^ MGEN_STR_HASH_P0, MGEN_STR_HASH_P1);
+}
+
+/**
+ * Number of distinct strings interned so far
+ */
+static inline size_t mgen_str_intern_count(void) {
+    return mgen_str_intern_table.count;
+}
+
+/**
+ * Free every symbol; containers still holding symbols must be dropped first
+ */
+static void mgen_str_intern_clear(void) {
+    mgen_str_intern_table_t* table = &mgen_str_intern_table;
+    free(table->slots);
+    mgen_str_arena_drop(&table->arena);
+    table->slots = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_STR_INTERN_H
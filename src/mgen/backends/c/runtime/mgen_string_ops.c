@@ -5,6 +5,7 @@
 #include "mgen_string_ops.h"
 #include <stdarg.h>
 #include <stdbool.h>
+#include "mgen_ascii.h"
 
 // String array implementation
 mgen_string_array_t* mgen_string_array_new(void) {
@@ -69,7 +70,7 @@ char* mgen_join(const char* delimiter, mgen_string_array_t* strings) {
 
     if (!delimiter) delimiter = "";
 
-    // Calculate total length needed
+    // Size the result up front, then append each part once
     size_t total_len = 0;
     size_t delim_len = strlen(delimiter);
 
@@ -77,28 +78,24 @@ char* mgen_join(const char* delimiter, mgen_string_array_t* strings) {
         if (strings->strings[i]) {
             total_len += strlen(strings->strings[i]);
         }
-        if (i < strings->count - 1) {
-            total_len += delim_len;
-        }
     }
+    total_len += delim_len * (strings->count - 1);
 
-    char* result = malloc(total_len + 1);
-    if (!result) {
-        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for joined string");
+    mgen_buffer_t buffer;
+    if (mgen_buffer_init(&buffer, total_len + 1) != MGEN_OK) {
         return NULL;
     }
 
-    result[0] = '\0';
     for (size_t i = 0; i < strings->count; i++) {
         if (strings->strings[i]) {
-            strcat(result, strings->strings[i]);
+            mgen_buffer_append_str(&buffer, strings->strings[i]);
         }
         if (i < strings->count - 1) {
-            strcat(result, delimiter);
+            mgen_buffer_append(&buffer, delimiter, delim_len);
         }
     }
 
-    return result;
+    return mgen_buffer_detach(&buffer);
 }
 
 char* mgen_strdup(const char* str) {
@@ -124,13 +121,15 @@ char* mgen_str_upper(const char* str) {
         return NULL;
     }
 
-    char* result = mgen_strdup(str);
-    if (!result) return NULL;
-
-    for (char* p = result; *p; p++) {
-        *p = toupper((unsigned char)*p);
+    size_t len = strlen(str);
+    char* result = malloc(len + 1);
+    if (!result) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for string");
+        return NULL;
     }
 
+    mgen_ascii_upper_n(result, str, len);
+    result[len] = '\0';
     return result;
 }
 
@@ -140,13 +139,15 @@ char* mgen_str_lower(const char* str) {
         return NULL;
     }
 
-    char* result = mgen_strdup(str);
-    if (!result) return NULL;
-
-    for (char* p = result; *p; p++) {
-        *p = tolower((unsigned char)*p);
+    size_t len = strlen(str);
+    char* result = malloc(len + 1);
+    if (!result) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for string");
+        return NULL;
     }
 
+    mgen_ascii_lower_n(result, str, len);
+    result[len] = '\0';
     return result;
 }
 
@@ -156,31 +157,18 @@ char* mgen_str_strip(const char* str) {
         return NULL;
     }
 
-    // Find start (skip leading whitespace)
-    while (*str && isspace((unsigned char)*str)) {
-        str++;
-    }
-
-    if (!*str) {
-        // String was all whitespace
-        return mgen_strdup("");
-    }
-
-    // Find end (skip trailing whitespace)
-    const char* end = str + strlen(str) - 1;
-    while (end > str && isspace((unsigned char)*end)) {
-        end--;
-    }
+    const char* end = str + strlen(str);
+    str = mgen_ascii_skip_space(str, end);
+    end = mgen_ascii_trim_space(str, end);
 
-    // Calculate length and allocate
-    size_t len = end - str + 1;
+    size_t len = (size_t)(end - str);
     char* result = malloc(len + 1);
     if (!result) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for string");
         return NULL;
     }
 
-    strncpy(result, str, len);
+    memcpy(result, str, len);
     result[len] = '\0';
 
     return result;
@@ -232,7 +220,7 @@ int mgen_str_find(const char* str, const char* substring) {
         return -1;
     }
 
-    const char* found = strstr(str, substring);
+    const char* found = mgen_ascii_find(str, strlen(str), substring, strlen(substring));
     if (found) {
         return (int)(found - str);
     }
@@ -240,12 +228,22 @@ int mgen_str_find(const char* str, const char* substring) {
     return -1;  // Not found
 }
 
+int mgen_str_count(const char* str, const char* substring) {
+    if (!str || !substring) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String or substring is NULL");
+        return 0;
+    }
+
+    return (int)mgen_ascii_count(str, strlen(str), substring, strlen(substring));
+}
+
 char* mgen_str_replace(const char* str, const char* old_str, const char* new_str) {
     if (!str || !old_str || !new_str) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String arguments cannot be NULL");
         return NULL;
     }
 
+    size_t str_len = strlen(str);
     size_t old_len = strlen(old_str);
     size_t new_len = strlen(new_str);
 
@@ -254,19 +252,14 @@ char* mgen_str_replace(const char* str, const char* old_str, const char* new_str
     }
 
     // Count occurrences to calculate result size
-    const char* pos = str;
-    int count = 0;
-    while ((pos = strstr(pos, old_str)) != NULL) {
-        count++;
-        pos += old_len;
-    }
+    size_t count = mgen_ascii_count(str, str_len, old_str, old_len);
 
     if (count == 0) {
         return mgen_strdup(str);  // No replacements needed
     }
 
     // Calculate result size
-    size_t result_len = strlen(str) - count * old_len + count * new_len;
+    size_t result_len = str_len - count * old_len + count * new_len;
     char* result = malloc(result_len + 1);
     if (!result) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for string");
@@ -276,15 +269,17 @@ char* mgen_str_replace(const char* str, const char* old_str, const char* new_str
     // Build result string
     char* dest = result;
     const char* src = str;
+    const char* end = str + str_len;
+    const char* pos;
 
-    while ((pos = strstr(src, old_str)) != NULL) {
+    while ((pos = mgen_ascii_find(src, (size_t)(end - src), old_str, old_len)) != NULL) {
         // Copy part before match
-        size_t prefix_len = pos - src;
-        strncpy(dest, src, prefix_len);
+        size_t prefix_len = (size_t)(pos - src);
+        memcpy(dest, src, prefix_len);
         dest += prefix_len;
 
         // Copy replacement
-        strcpy(dest, new_str);
+        memcpy(dest, new_str, new_len);
         dest += new_len;
 
         // Move past the match
@@ -292,7 +287,7 @@ char* mgen_str_replace(const char* str, const char* old_str, const char* new_str
     }
 
     // Copy remaining part
-    strcpy(dest, src);
+    memcpy(dest, src, (size_t)(end - src) + 1);
 
     return result;
 }
@@ -306,41 +301,239 @@ mgen_string_array_t* mgen_str_split(const char* str, const char* delimiter) {
     mgen_string_array_t* result = mgen_string_array_new();
     if (!result) return NULL;
 
-    // Make a copy since strtok modifies the string
-    char* str_copy = mgen_strdup(str);
-    if (!str_copy) {
-        mgen_string_array_free(result);
+    // Tokens are scanned in place; only the returned strings are allocated
+    mgen_str_splitter_t splitter = mgen_str_splitter_init(str, delimiter);
+    mgen_strview_t token;
+
+    while (mgen_str_splitter_next_view(&splitter, &token)) {
+        char* token_copy = mgen_strview_to_cstr(token);
+        if (!token_copy || mgen_string_array_add(result, token_copy) != MGEN_OK) {
+            free(token_copy);
+            mgen_string_array_free(result);
+            return NULL;
+        }
+    }
+
+    return result;
+}
+
+// String view implementation
+
+mgen_strview_t mgen_strview_from_cstr(const char* str) {
+    mgen_strview_t view = {str, str ? strlen(str) : 0};
+    return view;
+}
+
+bool mgen_strview_eq(mgen_strview_t a, mgen_strview_t b) {
+    return a.len == b.len && (a.len == 0 || memcmp(a.data, b.data, a.len) == 0);
+}
+
+bool mgen_strview_eq_cstr(mgen_strview_t view, const char* str) {
+    if (!str) {
+        return false;
+    }
+
+    // strncmp stops at a shorter str; the terminator check rejects a longer one
+    return strncmp(view.data ? view.data : "", str, view.len) == 0 && str[view.len] == '\0';
+}
+
+size_t mgen_strview_hash(mgen_strview_t view) {
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < view.len; i++) {
+        hash ^= (unsigned char)view.data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+char* mgen_strview_to_cstr(mgen_strview_t view) {
+    char* result = malloc(view.len + 1);
+    if (!result) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for string");
         return NULL;
     }
 
-    char* token;
-    char* saveptr = NULL;  // For thread-safe strtok_r
+    if (view.len > 0) {
+        memcpy(result, view.data, view.len);
+    }
+    result[view.len] = '\0';
+    return result;
+}
+
+mgen_strview_t mgen_str_strip_view(const char* str) {
+    mgen_strview_t view = {str, 0};
+    if (!str) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String is NULL");
+        return view;
+    }
+
+    const char* end = str + strlen(str);
+    str = mgen_ascii_skip_space(str, end);
+    end = mgen_ascii_trim_space(str, end);
 
-    if (!delimiter) {
-        // Split on whitespace
-        token = strtok_r(str_copy, " \t\n\r\f\v", &saveptr);
-    } else {
-        // Split on delimiter
-        token = strtok_r(str_copy, delimiter, &saveptr);
+    view.data = str;
+    view.len = (size_t)(end - str);
+    return view;
+}
+
+mgen_strview_t mgen_str_strip_chars_view(const char* str, const char* chars) {
+    mgen_strview_t view = {str, 0};
+    if (!str) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String is NULL");
+        return view;
+    }
+
+    if (!chars || !*chars) {
+        return mgen_str_strip_view(str);
+    }
+
+    while (*str && strchr(chars, *str)) {
+        str++;
+    }
+
+    const char* end = str + strlen(str);
+    while (end > str && strchr(chars, end[-1])) {
+        end--;
+    }
+
+    view.data = str;
+    view.len = (size_t)(end - str);
+    return view;
+}
+
+mgen_str_splitter_t mgen_str_splitter_init(const char* str, const char* delimiter) {
+    mgen_str_splitter_t splitter = {0};
+    if (!str) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String is NULL");
+        return splitter;
+    }
+
+    if (delimiter && !*delimiter) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Empty separator");
+        return splitter;
+    }
+
+    splitter.cursor = str;
+    splitter.end = str + strlen(str);
+    splitter.delimiter = delimiter;
+    splitter.delimiter_len = delimiter ? strlen(delimiter) : 0;
+    return splitter;
+}
+
+bool mgen_str_splitter_next_view(mgen_str_splitter_t* splitter, mgen_strview_t* out) {
+    if (!splitter || !splitter->cursor) {
+        return false;
     }
 
-    while (token != NULL) {
-        char* token_copy = mgen_strdup(token);
-        if (token_copy) {
-            mgen_string_array_add(result, token_copy);
+    const char* start = splitter->cursor;
+
+    if (!splitter->delimiter) {
+        // Whitespace mode: runs of whitespace separate tokens, empty tokens are dropped
+        start = mgen_ascii_skip_space(start, splitter->end);
+        if (start == splitter->end) {
+            splitter->cursor = NULL;
+            return false;
         }
 
-        if (!delimiter) {
-            token = strtok_r(NULL, " \t\n\r\f\v", &saveptr);
+        const char* end = mgen_ascii_find_space(start, splitter->end);
+        splitter->cursor = end;
+        splitter->token.data = start;
+        splitter->token.len = (size_t)(end - start);
+    } else {
+        // Explicit separator: every occurrence splits, keeping empty tokens
+        const char* match = mgen_ascii_find(start, (size_t)(splitter->end - start), splitter->delimiter,
+                                            splitter->delimiter_len);
+        if (match) {
+            splitter->token.len = (size_t)(match - start);
+            splitter->cursor = match + splitter->delimiter_len;
         } else {
-            token = strtok_r(NULL, delimiter, &saveptr);
+            splitter->token.len = (size_t)(splitter->end - start);
+            splitter->cursor = NULL;
+        }
+        splitter->token.data = start;
+    }
+
+    if (out) {
+        *out = splitter->token;
+    }
+    return true;
+}
+
+const char* mgen_str_splitter_next(mgen_str_splitter_t* splitter) {
+    if (!mgen_str_splitter_next_view(splitter, NULL)) {
+        return NULL;
+    }
+
+    size_t needed = splitter->token.len + 1;
+    if (needed > splitter->scratch_capacity) {
+        size_t new_capacity = splitter->scratch_capacity ? splitter->scratch_capacity : 32;
+        while (new_capacity < needed) {
+            new_capacity *= 2;
+        }
+        char* new_scratch = realloc(splitter->scratch, new_capacity);
+        if (!new_scratch) {
+            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow split buffer");
+            splitter->cursor = NULL;
+            return NULL;
+        }
+        splitter->scratch = new_scratch;
+        splitter->scratch_capacity = new_capacity;
+    }
+
+    memcpy(splitter->scratch, splitter->token.data, splitter->token.len);
+    splitter->scratch[splitter->token.len] = '\0';
+    return splitter->scratch;
+}
+
+void mgen_str_splitter_free(mgen_str_splitter_t* splitter) {
+    if (!splitter) return;
+
+    free(splitter->scratch);
+    splitter->scratch = NULL;
+    splitter->scratch_capacity = 0;
+    splitter->cursor = NULL;
+}
+
+mgen_strview_array_t* mgen_str_split_views(const char* str, const char* delimiter) {
+    if (!str) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "String is NULL");
+        return NULL;
+    }
+
+    mgen_strview_array_t* result = calloc(1, sizeof(mgen_strview_array_t));
+    if (!result) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate view array");
+        return NULL;
+    }
+
+    mgen_str_splitter_t splitter = mgen_str_splitter_init(str, delimiter);
+    mgen_strview_t token;
+
+    while (mgen_str_splitter_next_view(&splitter, &token)) {
+        if (result->count >= result->capacity) {
+            size_t new_capacity = result->capacity == 0 ? 8 : result->capacity * 2;
+            mgen_strview_t* new_views = realloc(result->views, new_capacity * sizeof(mgen_strview_t));
+            if (!new_views) {
+                MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to resize view array");
+                mgen_strview_array_free(result);
+                return NULL;
+            }
+            result->views = new_views;
+            result->capacity = new_capacity;
         }
+        result->views[result->count++] = token;
     }
 
-    free(str_copy);
     return result;
 }
 
+void mgen_strview_array_free(mgen_strview_array_t* arr) {
+    if (!arr) return;
+
+    free(arr->views);
+    free(arr);
+}
+
 // F-string support functions
 
 char* mgen_int_to_string(int value) {
@@ -432,4 +625,77 @@ char* mgen_str_concat(const char* str1, const char* str2) {
     strcat(result, str2);
 
     return result;
-}
\ No newline at end of file
+}
+
+// Scope-allocated temporaries
+
+char* mgen_scope_str_concat(mgen_scope_allocator_t* scope, const char* str1, const char* str2) {
+    if (!str1 || !str2) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Cannot concatenate NULL strings");
+        return NULL;
+    }
+
+    size_t len1 = strlen(str1);
+    size_t len2 = strlen(str2);
+
+    char* result = mgen_scope_alloc(scope, len1 + len2 + 1);
+    if (!result) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for string concatenation");
+        return NULL;
+    }
+
+    memcpy(result, str1, len1);
+    memcpy(result + len1, str2, len2 + 1);
+    return result;
+}
+
+char* mgen_scope_int_to_string(mgen_scope_allocator_t* scope, int value) {
+    char* result = mgen_scope_alloc(scope, 12);
+    if (!result) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for int to string");
+        return NULL;
+    }
+    snprintf(result, 12, "%d", value);
+    return result;
+}
+
+char* mgen_scope_float_to_string(mgen_scope_allocator_t* scope, double value) {
+    char* result = mgen_scope_alloc(scope, 32);
+    if (!result) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for float to string");
+        return NULL;
+    }
+    snprintf(result, 32, "%g", value);
+    return result;
+}
+
+char* mgen_scope_sprintf_string(mgen_scope_allocator_t* scope, const char* format, ...) {
+    if (!format) {
+        return mgen_scope_str_concat(scope, "", "");
+    }
+
+    va_list args, args_copy;
+    va_start(args, format);
+    va_copy(args_copy, args);
+
+    int size = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    if (size < 0) {
+        va_end(args_copy);
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Failed to format string");
+        return NULL;
+    }
+
+    char* result = mgen_scope_alloc(scope, (size_t)size + 1);
+    if (!result) {
+        va_end(args_copy);
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for formatted string");
+        return NULL;
+    }
+
+    vsnprintf(result, (size_t)size + 1, format, args_copy);
+    va_end(args_copy);
+
+    return result;
+}
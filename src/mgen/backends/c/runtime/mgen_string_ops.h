@@ -14,6 +14,7 @@
 #include <ctype.h>
 #include <stdbool.h>
 #include "mgen_error_handling.h"
+#include "mgen_memory_ops.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -51,6 +52,99 @@ const char* mgen_string_array_get(mgen_string_array_t* arr, size_t index);
  */
 size_t mgen_string_array_size(mgen_string_array_t* arr);
 
+// Non-owning view of a string slice (not necessarily NUL-terminated)
+typedef struct {
+    const char* data;
+    size_t len;
+} mgen_strview_t;
+
+// Array of views into a source string (one allocation, no per-token copies)
+typedef struct {
+    mgen_strview_t* views;
+    size_t count;
+    size_t capacity;
+} mgen_strview_array_t;
+
+// Incremental str.split() over a source string that outlives the splitter
+typedef struct {
+    const char* cursor;     // Start of the unscanned remainder (NULL when exhausted)
+    const char* end;        // Terminating NUL of the source string
+    const char* delimiter;  // NULL splits on runs of whitespace
+    size_t delimiter_len;
+    mgen_strview_t token;   // Most recent token
+    char* scratch;          // NUL-terminated copy of token for mgen_str_splitter_next
+    size_t scratch_capacity;
+} mgen_str_splitter_t;
+
+/**
+ * Make a view covering a whole NUL-terminated string
+ */
+mgen_strview_t mgen_strview_from_cstr(const char* str);
+
+/**
+ * Compare two views byte-for-byte
+ */
+bool mgen_strview_eq(mgen_strview_t a, mgen_strview_t b);
+
+/**
+ * Compare a view against a NUL-terminated string without copying either
+ */
+bool mgen_strview_eq_cstr(mgen_strview_t view, const char* str);
+
+/**
+ * FNV-1a hash of the viewed bytes (same function the string containers use)
+ */
+size_t mgen_strview_hash(mgen_strview_t view);
+
+/**
+ * Copy a view into a new NUL-terminated string (caller must free)
+ */
+char* mgen_strview_to_cstr(mgen_strview_t view);
+
+/**
+ * Python str.strip() as a view into str (no allocation)
+ */
+mgen_strview_t mgen_str_strip_view(const char* str);
+
+/**
+ * Python str.strip(chars) as a view into str (no allocation)
+ */
+mgen_strview_t mgen_str_strip_chars_view(const char* str, const char* chars);
+
+/**
+ * Start splitting str by delimiter (whitespace if NULL)
+ * str must stay alive and unmodified while the splitter is in use
+ */
+mgen_str_splitter_t mgen_str_splitter_init(const char* str, const char* delimiter);
+
+/**
+ * Advance to the next token as a view into the source string
+ * Returns false when there are no more tokens
+ */
+bool mgen_str_splitter_next_view(mgen_str_splitter_t* splitter, mgen_strview_t* out);
+
+/**
+ * Advance to the next token and return it NUL-terminated in the splitter's
+ * scratch buffer (valid until the next call), or NULL when exhausted
+ */
+const char* mgen_str_splitter_next(mgen_str_splitter_t* splitter);
+
+/**
+ * Release the splitter's scratch buffer
+ */
+void mgen_str_splitter_free(mgen_str_splitter_t* splitter);
+
+/**
+ * Python str.split() returning views into str (whitespace if delimiter is NULL)
+ * Free with mgen_strview_array_free; str must outlive the result
+ */
+mgen_strview_array_t* mgen_str_split_views(const char* str, const char* delimiter);
+
+/**
+ * Free a view array (the viewed strings are not owned)
+ */
+void mgen_strview_array_free(mgen_strview_array_t* arr);
+
 /**
  * Python str.join() equivalent
  * Joins strings in array with delimiter (caller must free result)
@@ -87,6 +181,12 @@ char* mgen_str_strip_chars(const char* str, const char* chars);
  */
 int mgen_str_find(const char* str, const char* substring);
 
+/**
+ * Python str.count() equivalent
+ * Returns the number of non-overlapping occurrences of substring
+ */
+int mgen_str_count(const char* str, const char* substring);
+
 /**
  * Python str.replace() equivalent
  * Returns a new string with all occurrences replaced (caller must free)
@@ -96,6 +196,7 @@ char* mgen_str_replace(const char* str, const char* old_str, const char* new_str
 /**
  * Python str.split() equivalent
  * Returns an array of strings split by delimiter (whitespace if NULL)
+ * An explicit delimiter keeps empty fields, as Python does ("a,,b" -> 3 items)
  */
 mgen_string_array_t* mgen_str_split(const char* str, const char* delimiter);
 
@@ -135,6 +236,16 @@ char* mgen_sprintf_string(const char* format, ...);
  */
 char* mgen_str_concat(const char* str1, const char* str2);
 
+/**
+ * Scope-allocated variants of the temporary-string builders above
+ * Results live in scope and are released together by mgen_scope_free
+ * (used by generated code for function-local temporaries)
+ */
+char* mgen_scope_str_concat(mgen_scope_allocator_t* scope, const char* str1, const char* str2);
+char* mgen_scope_int_to_string(mgen_scope_allocator_t* scope, int value);
+char* mgen_scope_float_to_string(mgen_scope_allocator_t* scope, double value);
+char* mgen_scope_sprintf_string(mgen_scope_allocator_t* scope, const char* format, ...);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,298 @@
+/**
+ * Code point indexing of UTF-8 strings for len(), s[i], s[a:b] and for ch in s
+ * stb-library style: static functions for single-file output
+ *
+ * Python str operations count code points, not bytes. A view caches a
+ * string's byte size, code point count and whether it is pure ASCII, so
+ * len() is O(1) and ASCII strings index bytes directly. Non-ASCII strings
+ * get a sparse index on first use: the byte offset of every
+ * MGEN_UTF8_CHECKPOINT-th code point, so s[i] walks at most that many code
+ * points. Invalid UTF-8 is tolerated: every byte that is not a continuation
+ * byte (10xxxxxx) starts a code point.
+ */
+
+#ifndef MGEN_UTF8_H
+#define MGEN_UTF8_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MGEN_UTF8_CHECKPOINT 64
+
+// Slice bound standing for "to the end" (s[a:])
+#define MGEN_UTF8_END INT_MAX
+
+typedef struct {
+    const char* data;
+    size_t size;                        // Bytes, excluding the NUL
+    size_t length;                      // Code points: Python len()
+    bool ascii;                         // Code point i is byte i
+    size_t* checkpoints;                // Offset of code point k * MGEN_UTF8_CHECKPOINT; NULL until needed
+} mgen_utf8_str_t;
+
+// for ch in s: each code point NUL-terminated in ch, valid until the next call
+typedef struct {
+    const char* cursor;
+    char ch[5];
+} mgen_utf8_iter_t;
+
+static inline bool mgen_utf8_is_continuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+}
+
+/**
+ * Code points in size bytes of data
+ * Eight bytes at a time: a byte is a continuation byte iff bit 7 is set and
+ * bit 6 is clear. Per-byte counters are summed every 255 words before they overflow.
+ */
+static inline size_t mgen_utf8_count(const char* data, size_t size) {
+    const uint64_t ones = 0x0101010101010101ull;
+    size_t continuations = 0;
+    size_t i = 0;
+    while (i + sizeof(uint64_t) <= size) {
+        uint64_t counters = 0;
+        for (int words = 0; words < 255 && i + sizeof(uint64_t) <= size; words++, i += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            counters += (word & ~(word << 1)) >> 7 & ones;
+        }
+        // Pairs of byte counters into four 16-bit lanes, then add the lanes
+        uint64_t lanes = (counters & 0x00FF00FF00FF00FFull) + ((counters >> 8) & 0x00FF00FF00FF00FFull);
+        continuations += (size_t)((lanes * 0x0001000100010001ull) >> 48);
+    }
+    for (; i < size; i++) {
+        continuations += mgen_utf8_is_continuation((unsigned char)data[i]);
+    }
+    return size - continuations;
+}
+
+/**
+ * Python len(str) without a view: one pass over the string
+ */
+static inline size_t mgen_utf8_len(const char* str) {
+    return str ? mgen_utf8_count(str, strlen(str)) : 0;
+}
+
+/**
+ * View of a NUL-terminated string; the string must outlive it
+ */
+static inline mgen_utf8_str_t mgen_utf8_view(const char* str) {
+    mgen_utf8_str_t view = {str ? str : "", 0, 0, true, NULL};
+    view.size = strlen(view.data);
+    view.length = mgen_utf8_count(view.data, view.size);
+    view.ascii = view.length == view.size;
+    return view;
+}
+
+/**
+ * Free the view's index (the string itself is not owned)
+ */
+static inline void mgen_utf8_release(mgen_utf8_str_t* view) {
+    free(view->checkpoints);
+    view->checkpoints = NULL;
+}
+
+// Byte offset of the code point count code points after the one at offset
+static inline size_t mgen_utf8_advance(const char* data, size_t offset, size_t count) {
+    const unsigned char* p = (const unsigned char*)data + offset;
+    while (count--) {
+        p++;
+        while (mgen_utf8_is_continuation(*p)) {
+            p++;
+        }
+    }
+    return (size_t)(p - (const unsigned char*)data);
+}
+
+static inline bool mgen_utf8_build_checkpoints(mgen_utf8_str_t* view) {
+    size_t count = (view->length - 1) / MGEN_UTF8_CHECKPOINT + 1;
+    MGEN_PROFILE_ALLOC(count * sizeof(size_t));
+    size_t* checkpoints = malloc(count * sizeof(size_t));
+    if (!checkpoints) {
+        return false;
+    }
+    const unsigned char* data = (const unsigned char*)view->data;
+    size_t code_point = 0;
+    for (size_t i = 0; i < view->size; i++) {
+        if (!mgen_utf8_is_continuation(data[i])) {
+            if (code_point % MGEN_UTF8_CHECKPOINT == 0) {
+                checkpoints[code_point / MGEN_UTF8_CHECKPOINT] = i;
+            }
+            code_point++;
+        }
+    }
+    view->checkpoints = checkpoints;
+    return true;
+}
+
+/**
+ * Byte offset of code point index (0 <= index <= length)
+ * Builds the sparse index on first use; without memory it walks from the start.
+ */
+static inline size_t mgen_utf8_offset(mgen_utf8_str_t* view, size_t index) {
+    if (view->ascii || index == 0) {
+        return index;
+    }
+    if (index >= view->length) {
+        return view->size;
+    }
+    if (!view->checkpoints && (view->length <= MGEN_UTF8_CHECKPOINT || !mgen_utf8_build_checkpoints(view))) {
+        return mgen_utf8_advance(view->data, 0, index);
+    }
+    size_t base = view->checkpoints[index / MGEN_UTF8_CHECKPOINT];
+    return mgen_utf8_advance(view->data, base, index % MGEN_UTF8_CHECKPOINT);
+}
+
+// Copy of the bytes [begin, end) of the view
+static inline char* mgen_utf8_copy(const mgen_utf8_str_t* view, size_t begin, size_t end) {
+    MGEN_PROFILE_ALLOC(end - begin + 1);
+    char* result = malloc(end - begin + 1);
+    if (!result) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate memory for string");
+        return NULL;
+    }
+    memcpy(result, view->data + begin, end - begin);
+    result[end - begin] = '\0';
+    return result;
+}
+
+/**
+ * Python s[index] (negative counts from the end) as a new string
+ * Returns NULL and sets MGEN_ERROR_INDEX when out of range.
+ */
+static inline char* mgen_utf8_at(mgen_utf8_str_t* view, int index) {
+    long long i = index < 0 ? (long long)view->length + index : index;
+    if (i < 0 || (size_t)i >= view->length) {
+        MGEN_SET_ERROR(MGEN_ERROR_INDEX, "string index out of range");
+        return NULL;
+    }
+    size_t begin = mgen_utf8_offset(view, (size_t)i);
+    return mgen_utf8_copy(view, begin, mgen_utf8_advance(view->data, begin, 1));
+}
+
+// Python slice bound: negative counts from the end, then clamped to [0, length]
+static inline size_t mgen_utf8_bound(const mgen_utf8_str_t* view, int bound) {
+    long long b = bound < 0 ? (long long)view->length + bound : bound;
+    if (b < 0) {
+        return 0;
+    }
+    return (size_t)b > view->length ? view->length : (size_t)b;
+}
+
+/**
+ * Python s[start:stop] as a new string; pass 0 and MGEN_UTF8_END for omitted bounds
+ */
+static inline char* mgen_utf8_slice(mgen_utf8_str_t* view, int start, int stop) {
+    size_t first = mgen_utf8_bound(view, start);
+    size_t last = mgen_utf8_bound(view, stop);
+    if (last <= first) {
+        return mgen_utf8_copy(view, 0, 0);
+    }
+    size_t begin = mgen_utf8_offset(view, first);
+    size_t end = mgen_utf8_offset(view, last);
+    return mgen_utf8_copy(view, begin, end);
+}
+
+/**
+ * Python s[index] == other without materializing s[index]
+ * Returns false and sets MGEN_ERROR_INDEX when out of range.
+ */
+static inline bool mgen_utf8_char_is(mgen_utf8_str_t* view, int index, const char* other) {
+    long long i = index < 0 ? (long long)view->length + index : index;
+    if (i < 0 || (size_t)i >= view->length) {
+        MGEN_SET_ERROR(MGEN_ERROR_INDEX, "string index out of range");
+        return false;
+    }
+    size_t begin = mgen_utf8_offset(view, (size_t)i);
+    size_t size = mgen_utf8_advance(view->data, begin, 1) - begin;
+    // strncmp stops at the end of a shorter other
+    return strncmp(view->data + begin, other, size) == 0 && other[size] == '\0';
+}
+
+// Offset of code point index of a plain string, or -1 if the string is shorter
+static inline long long mgen_utf8_str_offset(const char* str, int index) {
+    if (index < 0) {
+        return -1;
+    }
+    const unsigned char* p = (const unsigned char*)str;
+    for (; index > 0 && *p; index--) {
+        p++;
+        while (mgen_utf8_is_continuation(*p)) {
+            p++;
+        }
+    }
+    return *p ? (long long)(p - (const unsigned char*)str) : -1;
+}
+
+/**
+ * s[index], s[index] == other and s[start:stop] on a plain string, for strings indexed once
+ * Non-negative indexes walk only up to the code point; negative ones count the string first.
+ */
+static inline char* mgen_utf8_str_at(const char* str, int index) {
+    long long begin = index >= 0 ? mgen_utf8_str_offset(str, index) : -1;
+    if (begin < 0) {
+        mgen_utf8_str_t view = mgen_utf8_view(str);
+        char* result = mgen_utf8_at(&view, index);
+        mgen_utf8_release(&view);
+        return result;
+    }
+    mgen_utf8_str_t view = {str, 0, 0, false, NULL};
+    return mgen_utf8_copy(&view, (size_t)begin, mgen_utf8_advance(str, (size_t)begin, 1));
+}
+
+static inline bool mgen_utf8_str_char_is(const char* str, int index, const char* other) {
+    long long begin = index >= 0 ? mgen_utf8_str_offset(str, index) : -1;
+    if (begin < 0) {
+        mgen_utf8_str_t view = mgen_utf8_view(str);
+        bool result = mgen_utf8_char_is(&view, index, other);
+        mgen_utf8_release(&view);
+        return result;
+    }
+    size_t size = mgen_utf8_advance(str, (size_t)begin, 1) - (size_t)begin;
+    return strncmp(str + begin, other, size) == 0 && other[size] == '\0';
+}
+
+static inline char* mgen_utf8_str_slice(const char* str, int start, int stop) {
+    mgen_utf8_str_t view = mgen_utf8_view(str);
+    char* result = mgen_utf8_slice(&view, start, stop);
+    mgen_utf8_release(&view);
+    return result;
+}
+
+static inline mgen_utf8_iter_t mgen_utf8_iter(const char* str) {
+    mgen_utf8_iter_t iter = {str ? str : "", {0}};
+    return iter;
+}
+
+/**
+ * Next code point, or NULL at the end of the string
+ */
+static inline const char* mgen_utf8_next(mgen_utf8_iter_t* iter) {
+    const char* start = iter->cursor;
+    if (!*start) {
+        return NULL;
+    }
+    size_t step = mgen_utf8_advance(start, 0, 1);
+    // A longer run of continuation bytes is invalid UTF-8: keep the first four bytes
+    size_t size = step < sizeof(iter->ch) ? step : sizeof(iter->ch) - 1;
+    memcpy(iter->ch, start, size);
+    iter->ch[size] = '\0';
+    iter->cursor = start + step;
+    return iter->ch;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGEN_UTF8_H
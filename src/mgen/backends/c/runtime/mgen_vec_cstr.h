@@ -3,6 +3,11 @@
  * Clean, type-safe implementation for code generation
  * stb-library style: static functions for single-file output
  * STC-compatible naming: vec_cstr
+ *
+ * String bytes are copied into a chunked arena owned by the vector, so a push
+ * is a bump allocation rather than a strdup. Element pointers are stable
+ * (chunks never move) and stay valid until clear/drop; vec_cstr_at keeps its
+ * pointer-to-pointer semantics.
  */
 
 #ifndef MGEN_VEC_CSTR_H
@@ -10,6 +15,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include "mgen_str_arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,117 +23,143 @@ extern "C" {
 
 // Dynamic array of C strings structure
 typedef struct {
-    char** data;         // Array of string pointers
-    size_t size;         // Number of strings
-    size_t capacity;     // Allocated capacity
+    char** data;             // Array of string pointers (into arena)
+    size_t size;             // Number of strings
+    size_t capacity;         // Allocated capacity
+    mgen_str_arena_t arena;  // Backing storage for string bytes
 } vec_cstr;
 
-/**
- * Create a new string vector
- * Initial capacity defaults to 8
- */
-
-/**
- * Append a string to the end (STC-compatible)
- * Makes a copy of the string (uses strdup)
- * No return value - for compatibility with STC vec_cstr_push(&vec, str)
- */
-
-/**
- * Get pointer to string at index (STC-compatible)
- * Returns pointer to string pointer if valid, NULL if out of bounds
- */
-
-/**
- * Get number of strings
- */
-
-/**
- * Get allocated capacity
- */
-
-/**
- * Remove last string (and free its memory)
- */
-
-/**
- * Clear all strings (free each string's memory)
- */
-
-/**
- * Free all memory (STC-compatible drop function)
- * Frees each string and the array itself
- */
-
-/**
- * Check if vector is empty
- */
-
-/**
- * Reserve capacity
- */
-
 /**
  * Dynamic array of C strings (char*) - Implementation
  * STC-compatible naming for drop-in replacement
  */
 
 #include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
 #include <stdlib.h>
 #include <string.h>
 
-#define DEFAULT_CAPACITY 8
-#define GROWTH_FACTOR 2
+#define VEC_CSTR_DEFAULT_CAPACITY 8
+#define VEC_CSTR_GROWTH_FACTOR 2
 
+/**
+ * Create a new string vector
+ * Initial capacity defaults to 8
+ */
 static vec_cstr vec_cstr_init(void) {
-    vec_cstr vec;
-    vec.capacity = DEFAULT_CAPACITY;
-    vec.size = 0;
-    vec.data = malloc(DEFAULT_CAPACITY * sizeof(char*));
+    vec_cstr vec = {0};
+    MGEN_PROFILE_ALLOC(VEC_CSTR_DEFAULT_CAPACITY * sizeof(char*));
+    vec.data = malloc(VEC_CSTR_DEFAULT_CAPACITY * sizeof(char*));
     if (!vec.data) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate string vector");
-        vec.capacity = 0;
+        return vec;
     }
+    vec.capacity = VEC_CSTR_DEFAULT_CAPACITY;
     return vec;
 }
 
-static void vec_cstr_grow(vec_cstr* vec) {
+static bool vec_cstr_grow(vec_cstr* vec) {
     // Handle first allocation if capacity is 0
-    size_t new_capacity = (vec->capacity == 0) ? DEFAULT_CAPACITY : vec->capacity * GROWTH_FACTOR;
+    size_t new_capacity = (vec->capacity == 0) ? VEC_CSTR_DEFAULT_CAPACITY : vec->capacity * VEC_CSTR_GROWTH_FACTOR;
+    MGEN_PROFILE_ALLOC(new_capacity * sizeof(char*));
     char** new_data = realloc(vec->data, new_capacity * sizeof(char*));
     if (!new_data) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow string vector");
-        return;
+        return false;
     }
     vec->data = new_data;
     vec->capacity = new_capacity;
+    return true;
 }
 
-static void vec_cstr_push(vec_cstr* vec, const char* str) {
+/**
+ * Append the first len bytes of str (need not be NUL-terminated)
+ * The vector stores its own NUL-terminated copy
+ */
+static void vec_cstr_push_n(vec_cstr* vec, const char* str, size_t len) {
     if (!vec) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL string vector");
         return;
     }
 
-    if (vec->size >= vec->capacity) {
-        vec_cstr_grow(vec);
+    if (vec->size >= vec->capacity && !vec_cstr_grow(vec)) {
+        return;
+    }
+
+    char* copy = mgen_str_arena_strndup(&vec->arena, str, len);
+    if (!copy) {
+        return;
+    }
+
+    vec->data[vec->size++] = copy;
+}
+
+/**
+ * Append a string to the end (STC-compatible)
+ * Makes a copy of the string in the vector's arena
+ * No return value - for compatibility with STC vec_cstr_push(&vec, str)
+ */
+static void vec_cstr_push(vec_cstr* vec, const char* str) {
+    if (!vec) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL string vector");
+        return;
     }
 
-    // Duplicate the string to take ownership
     // Handle NULL strings by storing NULL
-    if (str) {
-        vec->data[vec->size] = strdup(str);
-        if (!vec->data[vec->size]) {
-            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to duplicate string");
+    if (!str) {
+        if (vec->size >= vec->capacity && !vec_cstr_grow(vec)) {
             return;
         }
-    } else {
-        vec->data[vec->size] = NULL;
+        vec->data[vec->size++] = NULL;
+        return;
+    }
+
+    vec_cstr_push_n(vec, str, strlen(str));
+}
+
+/**
+ * Append every token of text split on delim (Python str.split semantics)
+ * Passing NULL or "" as delim splits on runs of whitespace and drops empty tokens.
+ * Tokens are copied straight from text into the arena: no per-token malloc.
+ */
+static void vec_cstr_extend_split(vec_cstr* vec, const char* text, const char* delim) {
+    if (!vec || !text) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL string vector or text");
+        return;
+    }
+
+    if (!delim || !*delim) {
+        const char* p = text;
+        while (*p) {
+            while (*p == ' ' || (*p >= '\t' && *p <= '\r')) {
+                p++;
+            }
+            if (!*p) {
+                break;
+            }
+            const char* start = p;
+            while (*p && *p != ' ' && !(*p >= '\t' && *p <= '\r')) {
+                p++;
+            }
+            vec_cstr_push_n(vec, start, (size_t)(p - start));
+        }
+        return;
     }
 
-    vec->size++;
+    size_t delim_len = strlen(delim);
+    const char* start = text;
+    const char* match;
+    while ((match = strstr(start, delim)) != NULL) {
+        vec_cstr_push_n(vec, start, (size_t)(match - start));
+        start = match + delim_len;
+    }
+    vec_cstr_push(vec, start);
 }
 
+/**
+ * Get pointer to string at index (STC-compatible)
+ * Returns pointer to string pointer if valid, NULL if out of bounds
+ */
 static char** vec_cstr_at(vec_cstr* vec, size_t index) {
     if (!vec) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL string vector");
@@ -142,60 +174,76 @@ static char** vec_cstr_at(vec_cstr* vec, size_t index) {
     return &vec->data[index];
 }
 
+/**
+ * Get number of strings
+ */
 static inline size_t vec_cstr_size(const vec_cstr* vec) {
     return vec ? vec->size : 0;
 }
 
+/**
+ * Get allocated capacity
+ */
 static inline size_t vec_cstr_capacity(const vec_cstr* vec) {
     return vec ? vec->capacity : 0;
 }
 
+/**
+ * Remove last string
+ * Its arena space is reclaimed when it was the most recent allocation
+ */
 static void vec_cstr_pop(vec_cstr* vec) {
     if (!vec || vec->size == 0) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "Empty or NULL string vector");
         return;
     }
 
-    // Free the last string before removing it
     vec->size--;
-    free(vec->data[vec->size]);
+    char* last = vec->data[vec->size];
+    if (last) {
+        mgen_str_arena_unwind(&vec->arena, last, strlen(last) + 1);
+    }
     vec->data[vec->size] = NULL;
 }
 
+/**
+ * Clear all strings (keep capacity and the largest arena chunk)
+ */
 static inline void vec_cstr_clear(vec_cstr* vec) {
     if (!vec) {
         return;
     }
 
-    // Free all strings
-    for (size_t i = 0; i < vec->size; i++) {
-        free(vec->data[i]);
-        vec->data[i] = NULL;
-    }
-
+    mgen_str_arena_reset(&vec->arena);
     vec->size = 0;
 }
 
+/**
+ * Free all memory (STC-compatible drop function)
+ * Frees the string arena and the pointer array
+ */
 static void vec_cstr_drop(vec_cstr* vec) {
     if (!vec) {
         return;
     }
 
-    // Free all strings
-    for (size_t i = 0; i < vec->size; i++) {
-        free(vec->data[i]);
-    }
-
+    mgen_str_arena_drop(&vec->arena);
     free(vec->data);
     vec->data = NULL;
     vec->size = 0;
     vec->capacity = 0;
 }
 
+/**
+ * Check if vector is empty
+ */
 static inline bool vec_cstr_empty(const vec_cstr* vec) {
     return !vec || vec->size == 0;
 }
 
+/**
+ * Reserve capacity
+ */
 static void vec_cstr_reserve(vec_cstr* vec, size_t new_capacity) {
     if (!vec) {
         MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL string vector");
@@ -206,6 +254,7 @@ static void vec_cstr_reserve(vec_cstr* vec, size_t new_capacity) {
         return; // Already have enough capacity
     }
 
+    MGEN_PROFILE_ALLOC(new_capacity * sizeof(char*));
     char** new_data = realloc(vec->data, new_capacity * sizeof(char*));
     if (!new_data) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to reserve capacity");
@@ -216,8 +265,42 @@ static void vec_cstr_reserve(vec_cstr* vec, size_t new_capacity) {
     vec->capacity = new_capacity;
 }
 
+/**
+ * Check whether str is an element (Python `str in vec`)
+ */
+static bool vec_cstr_contains(const vec_cstr* vec, const char* str) {
+    if (!vec || !str) {
+        return false;
+    }
+
+    for (size_t i = 0; i < vec->size; i++) {
+        if (vec->data[i] && strcmp(vec->data[i], str) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
 
-// Implementation
+/**
+ * Compare two string vectors element by element (Python `a == b`)
+ */
+static bool vec_cstr_equal(const vec_cstr* a, const vec_cstr* b) {
+    if (!a || !b) {
+        return a == b;
+    }
+    if (a->size != b->size) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a->size; i++) {
+        const char* x = a->data[i];
+        const char* y = b->data[i];
+        if (x != y && (!x || !y || strcmp(x, y) != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
 
 #ifdef __cplusplus
 }
@@ -9,9 +9,11 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,16 +30,18 @@ typedef struct {
 } vec_double;
 
 // Internal helper function
-static void vec_double_grow(vec_double* vec) {
+static bool vec_double_grow(vec_double* vec) {
     // Handle first allocation if capacity is 0
     size_t new_capacity = (vec->capacity == 0) ? VEC_DOUBLE_DEFAULT_CAPACITY : vec->capacity * VEC_DOUBLE_GROWTH_FACTOR;
+    MGEN_PROFILE_ALLOC(new_capacity * sizeof(double));
     double* new_data = realloc(vec->data, new_capacity * sizeof(double));
     if (!new_data) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow vector");
-        return;
+        return false;
     }
     vec->data = new_data;
     vec->capacity = new_capacity;
+    return true;
 }
 
 /**
@@ -48,6 +52,7 @@ static vec_double vec_double_init(void) {
     vec_double vec;
     vec.capacity = VEC_DOUBLE_DEFAULT_CAPACITY;
     vec.size = 0;
+    MGEN_PROFILE_ALLOC(VEC_DOUBLE_DEFAULT_CAPACITY * sizeof(double));
     vec.data = malloc(VEC_DOUBLE_DEFAULT_CAPACITY * sizeof(double));
     if (!vec.data) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate vector");
@@ -66,8 +71,8 @@ static void vec_double_push(vec_double* vec, double value) {
         return;
     }
 
-    if (vec->size >= vec->capacity) {
-        vec_double_grow(vec);
+    if (vec->size >= vec->capacity && !vec_double_grow(vec)) {
+        return;
     }
 
     vec->data[vec->size++] = value;
@@ -158,6 +163,7 @@ static void vec_double_reserve(vec_double* vec, size_t new_capacity) {
         return; // Already have enough capacity
     }
 
+    MGEN_PROFILE_ALLOC(new_capacity * sizeof(double));
     double* new_data = realloc(vec->data, new_capacity * sizeof(double));
     if (!new_data) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to reserve capacity");
@@ -168,6 +174,158 @@ static void vec_double_reserve(vec_double* vec, size_t new_capacity) {
     vec->capacity = new_capacity;
 }
 
+// Grow capacity to hold at least min_capacity elements (at least doubling)
+static bool vec_double_ensure(vec_double* vec, size_t min_capacity) {
+    if (min_capacity <= vec->capacity) {
+        return true;
+    }
+    size_t new_capacity = vec->capacity * VEC_DOUBLE_GROWTH_FACTOR;
+    if (new_capacity < min_capacity) {
+        new_capacity = min_capacity;
+    }
+    if (new_capacity > SIZE_MAX / sizeof(double)) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Vector size overflow");
+        return false;
+    }
+    MGEN_PROFILE_ALLOC(new_capacity * sizeof(double));
+    double* new_data = realloc(vec->data, new_capacity * sizeof(double));
+    if (!new_data) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow vector");
+        return false;
+    }
+    vec->data = new_data;
+    vec->capacity = new_capacity;
+    return true;
+}
+
+/**
+ * Append count elements from values with one capacity check and a memcpy
+ * values may point into the vector itself
+ */
+static void vec_double_extend_from_array(vec_double* vec, const double* values, size_t count) {
+    if (!vec || (!values && count > 0)) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL vector or values");
+        return;
+    }
+    if (count == 0) {
+        return;
+    }
+    if (count > SIZE_MAX - vec->size) {
+        MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Vector size overflow");
+        return;
+    }
+
+    // Growing may move the buffer: re-derive a self-referencing source afterwards
+    bool aliased = vec->data && values >= vec->data && values < vec->data + vec->size;
+    size_t offset = aliased ? (size_t)(values - vec->data) : 0;
+    if (!vec_double_ensure(vec, vec->size + count)) {
+        return;
+    }
+    if (aliased) {
+        values = vec->data + offset;
+    }
+
+    memcpy(vec->data + vec->size, values, count * sizeof(double));
+    vec->size += count;
+}
+
+/**
+ * Set the size to new_size without initializing new elements
+ * Returns the data pointer, or NULL (size unchanged) if allocation fails
+ */
+static double* vec_double_resize_uninitialized(vec_double* vec, size_t new_size) {
+    if (!vec) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL vector");
+        return NULL;
+    }
+    if (!vec_double_ensure(vec, new_size)) {
+        return NULL;
+    }
+    vec->size = new_size;
+    return vec->data;
+}
+
+/**
+ * Replace the contents with count copies of value (Python [value] * count)
+ */
+static void vec_double_fill(vec_double* vec, size_t count, double value) {
+    if (!vec_double_resize_uninitialized(vec, count)) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        vec->data[i] = value;
+    }
+}
+
+/**
+ * Create a new vector holding elements [start, stop) of src
+ * Bounds are clamped to the source size, as in Python slicing
+ */
+static vec_double vec_double_copy_range(const vec_double* src, size_t start, size_t stop) {
+    vec_double result = {0};
+    if (!src) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL vector");
+        return result;
+    }
+    if (stop > src->size) {
+        stop = src->size;
+    }
+    if (start < stop) {
+        vec_double_extend_from_array(&result, src->data + start, stop - start);
+    }
+    return result;
+}
+
+/**
+ * Insert count elements from values before index (index == size appends)
+ */
+static void vec_double_insert_range(vec_double* vec, size_t index, const double* values, size_t count) {
+    if (!vec || (!values && count > 0)) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL vector or values");
+        return;
+    }
+    if (index > vec->size) {
+        MGEN_SET_ERROR(MGEN_ERROR_INDEX, "Index out of bounds");
+        return;
+    }
+    if (count == 0) {
+        return;
+    }
+    if (vec->data && values >= vec->data && values < vec->data + vec->size) {
+        // Inserting a slice of the vector into itself: copy it out first
+        MGEN_PROFILE_ALLOC(count * sizeof(double));
+        double* copy = malloc(count * sizeof(double));
+        if (!copy) {
+            MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate insert buffer");
+            return;
+        }
+        memcpy(copy, values, count * sizeof(double));
+        vec_double_insert_range(vec, index, copy, count);
+        free(copy);
+        return;
+    }
+    if (count > SIZE_MAX - vec->size || !vec_double_ensure(vec, vec->size + count)) {
+        return;
+    }
+
+    memmove(vec->data + index + count, vec->data + index, (vec->size - index) * sizeof(double));
+    memcpy(vec->data + index, values, count * sizeof(double));
+    vec->size += count;
+}
+
+/**
+ * Replace every element x with fn(x)
+ */
+static void vec_double_map_inplace(vec_double* vec, double (*fn)(double)) {
+    if (!vec || !fn) {
+        MGEN_SET_ERROR(MGEN_ERROR_VALUE, "NULL vector or function");
+        return;
+    }
+    for (double* p = vec->data; p < vec->data + vec->size; p++) {
+        *p = fn(*p);
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -73,6 +73,7 @@ typedef struct {
  */
 
 #include "mgen_error_handling.h"
+#include "mgen_alloc_profile.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -83,6 +84,7 @@ static vec_vec_int vec_vec_int_init(void) {
     vec_vec_int vec;
     vec.capacity = DEFAULT_CAPACITY;
     vec.size = 0;
+    MGEN_PROFILE_ALLOC(DEFAULT_CAPACITY * sizeof(vec_int));
     vec.data = malloc(DEFAULT_CAPACITY * sizeof(vec_int));
     if (!vec.data) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to allocate 2D vector");
@@ -94,6 +96,7 @@ static vec_vec_int vec_vec_int_init(void) {
 static void vec_vec_int_grow(vec_vec_int* vec) {
     // Handle first allocation if capacity is 0
     size_t new_capacity = (vec->capacity == 0) ? DEFAULT_CAPACITY : vec->capacity * GROWTH_FACTOR;
+    MGEN_PROFILE_ALLOC(new_capacity * sizeof(vec_int));
     vec_int* new_data = realloc(vec->data, new_capacity * sizeof(vec_int));
     if (!new_data) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to grow 2D vector");
@@ -193,6 +196,7 @@ static void vec_vec_int_reserve(vec_vec_int* vec, size_t new_capacity) {
         return; // Already have enough capacity
     }
 
+    MGEN_PROFILE_ALLOC(new_capacity * sizeof(vec_int));
     vec_int* new_data = realloc(vec->data, new_capacity * sizeof(vec_int));
     if (!new_data) {
         MGEN_SET_ERROR(MGEN_ERROR_MEMORY, "Failed to reserve capacity");
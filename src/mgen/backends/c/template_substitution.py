@@ -5,6 +5,12 @@ This module substitutes type-specific placeholders in generic templates:
 - {{T_SUFFIX}} -> type suffix for names (e.g., "int", "str")
 - {{T_ZERO}} -> zero value (e.g., "0", "NULL")
 - Conditional blocks: {{#T_NEEDS_DROP}}...{{/T_NEEDS_DROP}}
+- Inverted blocks, kept when the flag is false: {{^T_NEEDS_COPY}}...{{/T_NEEDS_COPY}}
+
+Besides the type's own properties, templates can specialize on:
+- {{#T_IS_TRIVIAL}} elements are trivially relocatable (memcpy moves and bulk copies)
+- {{#T_IS_MEMCMP}} equal values are equal bytes (memcmp comparisons)
+- {{#T_CHECK_HASH}} comparing keys costs more than comparing their stored hashes
 """
 
 import re
@@ -19,7 +25,7 @@ class TemplateSubstitutionEngine:
 
     # Regex patterns for placeholders and conditional blocks
     PLACEHOLDER_PATTERN = re.compile(r"\{\{([A-Z_]+)\}\}")
-    CONDITIONAL_START_PATTERN = re.compile(r"\{\{#([A-Z_]+)\}\}")
+    CONDITIONAL_START_PATTERN = re.compile(r"\{\{([#^])([A-Z_]+)\}\}")
     CONDITIONAL_END_PATTERN = re.compile(r"\{\{/([A-Z_]+)\}\}")
 
     def __init__(self) -> None:
@@ -55,6 +61,14 @@ class TemplateSubstitutionEngine:
             "T_NEEDS_DROP": props.needs_drop,
             "T_NEEDS_COPY": props.needs_copy,
             "T_IS_POINTER": props.is_pointer,
+            # Elements can be moved with memcpy (bulk vector operations)
+            "T_IS_TRIVIAL": not props.needs_drop and not props.needs_copy,
+            "T_IS_INTEGER": props.is_integer,
+            "T_IS_FLOATING": props.is_floating,
+            "T_IS_STRING": props.compare_op == "strcmp",
+            # Specialization hooks
+            "T_IS_MEMCMP": props.is_integer,
+            "T_CHECK_HASH": not props.is_integer and not props.is_floating,
         }
 
         return self._substitute(template, context)
@@ -91,6 +105,12 @@ class TemplateSubstitutionEngine:
             "K_NEEDS_DROP": key_props.needs_drop,
             "K_NEEDS_COPY": key_props.needs_copy,
             "K_IS_POINTER": key_props.is_pointer,
+            "K_IS_TRIVIAL": not key_props.needs_drop and not key_props.needs_copy,
+            "K_IS_INTEGER": key_props.is_integer,
+            "K_IS_FLOATING": key_props.is_floating,
+            "K_IS_STRING": key_props.compare_op == "strcmp",
+            "K_IS_MEMCMP": key_props.is_integer,
+            "K_CHECK_HASH": not key_props.is_integer and not key_props.is_floating,
             # Value properties
             "V": val_props.c_type,
             "V_SUFFIX": val_props.suffix,
@@ -101,6 +121,11 @@ class TemplateSubstitutionEngine:
             "V_NEEDS_DROP": val_props.needs_drop,
             "V_NEEDS_COPY": val_props.needs_copy,
             "V_IS_POINTER": val_props.is_pointer,
+            "V_IS_TRIVIAL": not val_props.needs_drop and not val_props.needs_copy,
+            "KV_NEEDS_COPY": key_props.needs_copy or val_props.needs_copy,
+            # Entries are plain data: clearing the map is one memset
+            "KV_IS_TRIVIAL": not (key_props.needs_drop or key_props.needs_copy)
+            and not (val_props.needs_drop or val_props.needs_copy),
             # Combined suffix for type name
             "KV_SUFFIX": f"{key_props.suffix}_{val_props.suffix}",
         }
@@ -185,7 +210,7 @@ class TemplateSubstitutionEngine:
         return self.PLACEHOLDER_PATTERN.sub(replace_placeholder, template)
 
     def _process_conditionals(self, template: str, context: dict[str, Any]) -> str:
-        """Process conditional blocks like {{#VAR}}...{{/VAR}}.
+        """Process conditional blocks like {{#VAR}}...{{/VAR}} and inverted blocks {{^VAR}}...{{/VAR}}.
 
         Args:
             template: Template string
@@ -210,7 +235,8 @@ class TemplateSubstitutionEngine:
             result.append(template[pos : start_match.start()])
 
             # Find matching end tag
-            var_name = start_match.group(1)
+            inverted = start_match.group(1) == "^"
+            var_name = start_match.group(2)
             end_pattern = re.compile(rf"\{{\{{/{re.escape(var_name)}\}}\}}")
             end_match = end_pattern.search(template, start_match.end())
 
@@ -224,7 +250,7 @@ class TemplateSubstitutionEngine:
             block_content = template[start_match.end() : end_match.start()]
 
             # Evaluate condition
-            if var_name in context and context[var_name]:
+            if bool(context.get(var_name)) != inverted:
                 # Condition is true, include block (recursively process it)
                 result.append(self._process_conditionals(block_content, context))
             # else: condition is false, omit block
@@ -37,16 +37,16 @@ class TypeParameterExtractor:
     """Extracts type parameters from container type names."""
 
     # Pattern for vec_<T>
-    VEC_PATTERN = re.compile(r"^vec_([a-z_]+)$")
+    VEC_PATTERN = re.compile(r"^vec_([a-z0-9_]+)$")
 
     # Pattern for map_<K>_<V>
-    MAP_PATTERN = re.compile(r"^map_([a-z_]+)_([a-z_]+)$")
+    MAP_PATTERN = re.compile(r"^map_([a-z0-9_]+)_([a-z0-9_]+)$")
 
     # Pattern for set_<T>
-    SET_PATTERN = re.compile(r"^set_([a-z_]+)$")
+    SET_PATTERN = re.compile(r"^set_([a-z0-9_]+)$")
 
     # Pattern for vec_vec_<T> (nested vector)
-    VEC_VEC_PATTERN = re.compile(r"^vec_vec_([a-z_]+)$")
+    VEC_VEC_PATTERN = re.compile(r"^vec_vec_([a-z0-9_]+)$")
 
     def extract(self, container_type: str) -> Optional[ContainerTypeInfo]:
         """Extract type parameters from a container type name.
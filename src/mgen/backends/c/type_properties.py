@@ -22,6 +22,8 @@ class TypeProperties:
         zero_value: Default/zero value (e.g., "0", "NULL", "0.0")
         compare_op: Comparison operator/function (e.g., "==", "strcmp")
         hash_fn: Hash function name (e.g., "hash_int", "hash_string")
+        is_integer: Whether values are integers hashed by the templates' integer hash
+        is_floating: Whether values are floating point, hashed by their bits
     """
 
     name: str
@@ -34,6 +36,8 @@ class TypeProperties:
     zero_value: str
     compare_op: str
     hash_fn: str
+    is_integer: bool = False
+    is_floating: bool = False
 
 
 # Type registry: maps Python type names to their properties
@@ -49,6 +53,7 @@ TYPE_REGISTRY: dict[str, TypeProperties] = {
         zero_value="0",
         compare_op="==",
         hash_fn="hash_int",
+        is_integer=True,
     ),
     "float": TypeProperties(
         name="float",
@@ -61,6 +66,7 @@ TYPE_REGISTRY: dict[str, TypeProperties] = {
         zero_value="0.0f",
         compare_op="==",  # Note: float equality is tricky, but we use == for now
         hash_fn="hash_float",
+        is_floating=True,
     ),
     "double": TypeProperties(
         name="double",
@@ -73,6 +79,7 @@ TYPE_REGISTRY: dict[str, TypeProperties] = {
         zero_value="0.0",
         compare_op="==",
         hash_fn="hash_double",
+        is_floating=True,
     ),
     "bool": TypeProperties(
         name="bool",
@@ -85,6 +92,7 @@ TYPE_REGISTRY: dict[str, TypeProperties] = {
         zero_value="false",
         compare_op="==",
         hash_fn="hash_int",  # Reuse int hash for bool (0 or 1)
+        is_integer=True,
     ),
     "char": TypeProperties(
         name="char",
@@ -97,6 +105,21 @@ TYPE_REGISTRY: dict[str, TypeProperties] = {
         zero_value="'\\0'",
         compare_op="==",
         hash_fn="hash_int",  # Reuse int hash for char
+        is_integer=True,
+    ),
+    # 64-bit integers: the LLVM backend's int (i64) elements
+    "i64": TypeProperties(
+        name="i64",
+        c_type="long long",
+        suffix="i64",
+        is_pointer=False,
+        needs_drop=False,
+        needs_copy=False,
+        printf_fmt="%lld",
+        zero_value="0",
+        compare_op="==",
+        hash_fn="hash_i64",
+        is_integer=True,
     ),
     "str": TypeProperties(
         name="str",
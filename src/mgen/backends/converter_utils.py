@@ -5,7 +5,9 @@ converters to reduce code duplication while maintaining language-specific flexib
 """
 
 import ast
-from typing import Any, Optional
+from typing import Any, Optional, Union, cast
+
+from ..frontend.optimizers.compile_time_evaluator import StringDispatch, StringSwitch
 
 # ============================================================================
 # Common AST Analysis Utilities
@@ -78,6 +80,225 @@ def uses_builtin_functions(node: ast.Module) -> set[str]:
     return builtins
 
 
+def read_only_dict_literals(function: ast.FunctionDef) -> dict[str, ast.Dict]:
+    """Dict locals bound once to a literal and afterwards only read.
+
+    The binding must be a statement of the function body itself. Every other
+    use must be a lookup d[k], a membership test k in d / k not in d or
+    len(d), outside nested functions; anything else (stores, methods,
+    iteration, passing the dict on) disqualifies it.
+
+    Returns:
+        The dict literal of each such local, by name
+    """
+    literals: dict[str, ast.Dict] = {}
+    bindings: dict[str, int] = {}
+    for node in ast.walk(function):
+        if isinstance(node, ast.Name) and not isinstance(node.ctx, ast.Load):
+            bindings[node.id] = bindings.get(node.id, 0) + 1
+        elif isinstance(node, (ast.Global, ast.Nonlocal)):
+            for name in node.names:
+                bindings[name] = 2
+    for stmt in function.body:
+        target = stmt.target if isinstance(stmt, ast.AnnAssign) else None
+        if isinstance(stmt, ast.Assign) and len(stmt.targets) == 1:
+            target = stmt.targets[0]
+        value = getattr(stmt, "value", None)
+        if isinstance(target, ast.Name) and isinstance(value, ast.Dict) and bindings.get(target.id) == 1:
+            literals[target.id] = value
+
+    parents = {child: node for node in ast.walk(function) for child in ast.iter_child_nodes(node)}
+    for scope in ast.walk(function):
+        if scope is not function and isinstance(scope, (ast.FunctionDef, ast.AsyncFunctionDef, ast.Lambda)):
+            for node in ast.walk(scope):
+                if isinstance(node, ast.Name):
+                    literals.pop(node.id, None)
+    for node in ast.walk(function):
+        if not (isinstance(node, ast.Name) and isinstance(node.ctx, ast.Load) and node.id in literals):
+            continue
+        parent = parents.get(node)
+        if isinstance(parent, ast.Subscript) and parent.value is node and isinstance(parent.ctx, ast.Load):
+            if not isinstance(parent.slice, ast.Slice):
+                continue
+        if isinstance(parent, ast.Compare) and len(parent.ops) == 1 and parent.comparators[0] is node:
+            if isinstance(parent.ops[0], (ast.In, ast.NotIn)):
+                continue
+        if isinstance(parent, ast.Call) and isinstance(parent.func, ast.Name) and parent.func.id == "len":
+            if parent.args == [node] and not parent.keywords:
+                continue
+        literals.pop(node.id)
+    return literals
+
+
+# Field types a struct-of-arrays class may have: each field becomes one contiguous array
+SOA_FIELD_TYPES = frozenset({"int", "float", "bool"})
+
+
+def struct_of_arrays_classes(module: ast.Module) -> dict[str, dict[str, str]]:
+    """Classes whose lists can be stored as one contiguous array per field.
+
+    A candidate is a plain class (no bases, decorators or methods besides
+    __init__) whose __init__ only declares int, float or bool fields
+    (self.f: T = ...). It qualifies when it is only named in list[C]
+    annotations of parameters and of locals bound to [], and in C(...)
+    appended to such a local; and those lists are only used as xs[i].f,
+    v.f for v of `for v in xs`, len(xs), xs.append(C(...)) on locals, and
+    as arguments for list[C] parameters. Elements then never exist as
+    objects, so nothing can tell their fields apart from array slots.
+
+    Returns:
+        Field names and types of each qualifying class some list holds, by class name
+    """
+    candidates: dict[str, dict[str, str]] = {}
+    for stmt in module.body:
+        if isinstance(stmt, ast.ClassDef) and not (stmt.bases or stmt.keywords or stmt.decorator_list):
+            fields = _struct_of_arrays_fields(stmt)
+            if fields:
+                candidates[stmt.name] = fields
+
+    def list_class(annotation: Optional[ast.expr]) -> Optional[str]:
+        if isinstance(annotation, ast.Subscript) and isinstance(annotation.value, ast.Name):
+            element = annotation.slice
+            if annotation.value.id == "list" and isinstance(element, ast.Name) and element.id in candidates:
+                return element.id
+        return None
+
+    functions = [stmt for stmt in module.body if isinstance(stmt, ast.FunctionDef)]
+    parameters = {function.name: [list_class(arg.annotation) for arg in function.args.args] for function in functions}
+    disqualified: set[str] = set()
+    used: set[str] = set()
+    for stmt in module.body:
+        if not isinstance(stmt, ast.FunctionDef):
+            disqualified.update(node.id for node in ast.walk(stmt) if isinstance(node, ast.Name))
+    for function in functions:
+        _check_struct_of_arrays_uses(function, candidates, list_class, parameters, disqualified, used)
+    return {name: fields for name, fields in candidates.items() if name in used and name not in disqualified}
+
+
+def _struct_of_arrays_fields(class_node: ast.ClassDef) -> Optional[dict[str, str]]:
+    """Fields of a class with only an __init__ declaring scalar fields, or None."""
+    methods = [stmt for stmt in class_node.body if isinstance(stmt, ast.FunctionDef)]
+    others = [stmt for stmt in class_node.body if not isinstance(stmt, (ast.FunctionDef, ast.Pass, ast.Expr))]
+    if [method.name for method in methods] != ["__init__"] or others:
+        return None
+    init = methods[0]
+    parents = {child: node for node in ast.walk(init) for child in ast.iter_child_nodes(node)}
+    fields: dict[str, str] = {}
+    for node in ast.walk(init):
+        if not (isinstance(node, ast.Name) and node.id == "self") or isinstance(parents.get(node), ast.arguments):
+            continue
+        attribute = parents.get(node)
+        if not isinstance(attribute, ast.Attribute):
+            return None  # self escapes
+        if isinstance(attribute.ctx, ast.Load):
+            continue
+        declaration = parents.get(attribute)
+        if not (isinstance(declaration, ast.AnnAssign) and isinstance(declaration.annotation, ast.Name)):
+            return None
+        if declaration.annotation.id not in SOA_FIELD_TYPES or attribute.attr in fields:
+            return None
+        fields[attribute.attr] = declaration.annotation.id
+    return fields
+
+
+def _check_struct_of_arrays_uses(
+    function: ast.FunctionDef,
+    candidates: dict[str, dict[str, str]],
+    list_class: Any,
+    parameters: dict[str, list[Optional[str]]],
+    disqualified: set[str],
+    used: set[str],
+) -> None:
+    """Disqualify the candidate classes a function uses other than struct_of_arrays_classes allows."""
+    lists: dict[str, str] = {}
+    locals_: set[str] = set()
+    allowed: set[int] = set()  # ids of the list[C] annotations and bindings that are fine
+    for arg in function.args.args:
+        element = list_class(arg.annotation)
+        if element:
+            lists[arg.arg] = element
+            allowed.add(id(cast(ast.Subscript, arg.annotation).slice))
+    for node in ast.walk(function):
+        if isinstance(node, ast.AnnAssign) and isinstance(node.target, ast.Name) and list_class(node.annotation):
+            element = cast(str, list_class(node.annotation))
+            empty = isinstance(node.value, ast.List) and not node.value.elts
+            if not empty or node.target.id in lists:
+                disqualified.add(element)
+                continue
+            lists[node.target.id] = element
+            locals_.add(node.target.id)
+            allowed.update({id(cast(ast.Subscript, node.annotation).slice), id(node.target)})
+    loop_variables: dict[str, str] = {}
+    for node in ast.walk(function):
+        if isinstance(node, ast.For) and isinstance(node.iter, ast.Name) and node.iter.id in lists:
+            if not isinstance(node.target, ast.Name) or node.target.id in loop_variables or node.target.id in lists:
+                disqualified.add(lists[node.iter.id])
+                continue
+            loop_variables[node.target.id] = lists[node.iter.id]
+            allowed.add(id(node.target))
+    used.update(lists.values())
+
+    parents = {child: node for node in ast.walk(function) for child in ast.iter_child_nodes(node)}
+    for node in ast.walk(function):
+        if not isinstance(node, ast.Name) or id(node) in allowed:
+            continue
+        parent = parents.get(node)
+        if node.id in candidates:
+            # C(...) as the one argument of xs.append on a local list of C
+            append = parents.get(parent) if isinstance(parent, ast.Call) and parent.func is node else None
+            if not (isinstance(append, ast.Call) and append.args == [parent]):
+                disqualified.add(node.id)
+                continue
+            target = append.func.value if isinstance(append.func, ast.Attribute) else None
+            if not (isinstance(target, ast.Name) and target.id in locals_ and lists[target.id] == node.id):
+                disqualified.add(node.id)
+        elif node.id in loop_variables:
+            if not (isinstance(node.ctx, ast.Load) and isinstance(parent, ast.Attribute)):
+                disqualified.add(loop_variables[node.id])
+            elif parent.attr not in candidates[loop_variables[node.id]]:
+                disqualified.add(loop_variables[node.id])
+        elif node.id in lists and not _is_struct_of_arrays_use(
+            node, parents, candidates[lists[node.id]], node.id in locals_, lists[node.id], parameters
+        ):
+            disqualified.add(lists[node.id])
+    if function.returns is not None:
+        disqualified.update(node.id for node in ast.walk(function.returns) if isinstance(node, ast.Name))
+
+
+def _is_struct_of_arrays_use(
+    node: ast.Name,
+    parents: dict[ast.AST, ast.AST],
+    fields: dict[str, str],
+    is_local: bool,
+    element: str,
+    parameters: dict[str, list[Optional[str]]],
+) -> bool:
+    """Check one use of a struct-of-arrays list against the forms struct_of_arrays_classes allows."""
+    parent = parents.get(node)
+    if not isinstance(node.ctx, ast.Load):
+        return False
+    if isinstance(parent, ast.Attribute) and parent.attr == "append":
+        call = parents.get(parent)
+        if not (is_local and isinstance(call, ast.Call) and call.func is parent and len(call.args) == 1):
+            return False
+        item = call.args[0]
+        constructs = isinstance(item, ast.Call) and isinstance(item.func, ast.Name) and item.func.id == element
+        return constructs and isinstance(parents.get(call), ast.Expr)
+    if isinstance(parent, ast.Subscript) and parent.value is node and not isinstance(parent.slice, ast.Slice):
+        negative = isinstance(parent.slice, ast.UnaryOp) and isinstance(parent.slice.op, ast.USub)
+        field = parents.get(parent)
+        return not negative and isinstance(field, ast.Attribute) and field.attr in fields
+    if isinstance(parent, ast.For) and parent.iter is node:
+        return True
+    if isinstance(parent, ast.Call) and isinstance(parent.func, ast.Name) and node in parent.args:
+        if parent.func.id == "len":
+            return parent.args == [node] and not parent.keywords
+        signature = parameters.get(parent.func.id, [])
+        position = parent.args.index(node)
+        return position < len(signature) and signature[position] == element
+    return False
+
+
 def extract_instance_variables(class_node: ast.ClassDef) -> dict[str, Optional[ast.expr]]:
     """Extract instance variables from a class __init__ method.
 
@@ -268,6 +489,81 @@ def escape_string_for_c_family(s: str) -> str:
     return s.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n").replace("\r", "\\r").replace("\t", "\\t")
 
 
+def c_bytes_literal(data: bytes) -> str:
+    """Spell bytes as a C/C++ string literal, with octal escapes outside printable ASCII."""
+    chars = []
+    for byte in data:
+        char = chr(byte)
+        if char in '"\\':
+            chars.append("\\" + char)
+        elif 32 <= byte < 127 and not (char == "?" and chars and chars[-1] == "?"):
+            chars.append(char)
+        else:
+            chars.append(f"\\{byte:03o}")
+    return '"' + "".join(chars) + '"'
+
+
+def render_string_dispatch(
+    dispatch: StringDispatch, results: list[int], data: str, length: str, memcmp: str = "memcmp"
+) -> list[str]:
+    """Statements returning results[i] when a string is dispatch.keys[i], and -1 otherwise.
+
+    Shared by C and C++: a switch on length, nested switches on the bytes
+    where keys of one length differ, and one memcmp against the key left.
+    data and length spell the string's bytes and byte count.
+    """
+
+    def case_label(value: int, position: Optional[int]) -> str:
+        char = chr(value)
+        if position is not None and 32 <= value < 127 and char not in "'\\":
+            return f"'{char}'"
+        return str(value)
+
+    def render(node: Union[StringSwitch, int], indent: str) -> list[str]:
+        if isinstance(node, int):
+            key = dispatch.keys[node]
+            if not key:
+                return [f"{indent}return {results[node]};"]
+            return [f"{indent}return {memcmp}({data}, {c_bytes_literal(key)}, {len(key)}) == 0 ? {results[node]} : -1;"]
+        subject = length if node.position is None else f"(unsigned char){data}[{node.position}]"
+        lines = [f"{indent}switch ({subject}) {{"]
+        for value, child in node.cases.items():
+            lines.append(f"{indent}case {case_label(value, node.position)}:")
+            lines.extend(render(child, indent + "    "))
+        lines.append(f"{indent}}}")
+        lines.append(f"{indent}return -1;")
+        return lines
+
+    return render(dispatch.root, "")
+
+
+def line_directive(line: int, source_file: str) -> str:
+    """A C/C++ #line directive attributing the next generated line to line of the Python source."""
+    return f'#line {line} "{escape_string_for_c_family(source_file)}"'
+
+
+def restore_generated_lines(code: str, generated_file: str) -> str:
+    """Point the code after each source-mapped definition back at the generated file.
+
+    A #line directive maps every following line, so module-level code after a
+    function (structs, helpers, the next signature) would otherwise be
+    attributed to Python lines past the function's end. Each top-level closing
+    brace after a mapped line is followed by a #line naming generated_file and
+    the directive's own successor, as yacc does for its action code.
+    """
+    lines: list[str] = []
+    mapped = False
+    for text in code.split("\n"):
+        lines.append(text)
+        if text.lstrip().startswith("#line "):
+            mapped = True
+        elif mapped and text.startswith("}"):
+            # The directive is line len(lines) + 1; it names the line after it
+            lines.append(line_directive(len(lines) + 2, generated_file))
+            mapped = False
+    return "\n".join(lines)
+
+
 def to_snake_case(camel_str: str) -> str:
     """Convert CamelCase or mixedCase to snake_case.
 
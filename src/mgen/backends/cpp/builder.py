@@ -5,7 +5,15 @@ from pathlib import Path
 from typing import Any, Optional
 
 from ...common.makefilegen import MakefileGenerator
-from ..base import AbstractBuilder
+from ..base import (
+    OPENMP_FLAG,
+    RELEASE_COMPILE_FLAGS,
+    RELEASE_LINK_FLAGS,
+    AbstractBuilder,
+    fast_math_compile_flags,
+    uses_openmp,
+)
+from ..python_extension import extension_build_flags, extension_filename
 
 
 class CppBuilder(AbstractBuilder):
@@ -31,6 +39,11 @@ class CppBuilder(AbstractBuilder):
 
         # Extract flags from default_flags
         flags = [f for f in self.default_flags if not f.startswith("-std=")]
+        if self._uses_parallel_runtime(source_files):
+            flags.append("-pthread")
+        # Loops emitted with #pragma omp parallel for (parallel_loops preference)
+        openmp = [OPENMP_FLAG] if uses_openmp(source_files) else []
+        flags.extend(openmp)
         std = "c++17"  # Default
         for f in self.default_flags:
             if f.startswith("-std=c++"):
@@ -48,22 +61,49 @@ class CppBuilder(AbstractBuilder):
             std=std,
             use_stc=False,  # C++ doesn't use STC
             project_type="MGen",
+            ldflags=openmp,
         )
 
         return generator.generate_makefile()
 
     def compile_direct(self, source_file: str, output_dir: str, **kwargs: Any) -> bool:
-        """Compile C++ source directly to executable."""
+        """Compile C++ source directly to executable.
+
+        Keyword options:
+            profile (str): "release" adds LTO, section garbage collection and -fno-plt
+            cpu (str): Target CPU for -march (e.g. native)
+            debug (bool): Emit DWARF (-g), which carries the #line mapping of --source-map to the Python file
+            target_mode (str): "extension" builds the CPython module <stem><EXT_SUFFIX> instead of an executable
+            fast_math (tuple[str, ...]): FAST_MATH_FLAGS modes the program's float arithmetic is compiled with
+        """
         try:
             source_path = Path(source_file).absolute()
             out_dir = Path(output_dir).absolute()
-            output_path = out_dir / source_path.stem
+            extension = kwargs.get("target_mode") == "extension"
+            output_path = out_dir / (extension_filename(source_path.stem) if extension else source_path.stem)
 
             # Setup runtime environment (copy headers if needed)
             self._setup_runtime_environment(str(out_dir))
 
             # Build the compilation command
-            cmd = [self.compiler] + self.get_compile_flags() + [str(source_path), "-o", str(output_path)]
+            cmd = [self.compiler] + self.get_compile_flags()
+            if kwargs.get("profile") == "release":
+                cmd.extend(RELEASE_COMPILE_FLAGS)
+            cpu = kwargs.get("cpu")
+            if cpu and cpu != "generic":
+                cmd.append(f"-march={cpu}")
+            cmd.extend(fast_math_compile_flags(kwargs.get("fast_math", ())))
+            if kwargs.get("debug"):
+                cmd.append("-g")
+            if extension:
+                cmd.extend(extension_build_flags(source_path.stem))
+            cmd.extend([str(source_path), "-o", str(output_path)])
+            if self._uses_parallel_runtime([str(source_path)]):
+                cmd.append("-pthread")
+            if uses_openmp([str(source_path)]):
+                cmd.append(OPENMP_FLAG)
+            if kwargs.get("profile") == "release":
+                cmd.extend(RELEASE_LINK_FLAGS)
 
             # Execute compilation (don't set cwd to avoid path issues)
             result = subprocess.run(cmd, capture_output=True, text=True)
@@ -203,6 +243,17 @@ install(TARGETS {target_name} DESTINATION bin)
 
         return runtime_sources
 
+    def _uses_parallel_runtime(self, source_files: list[str]) -> bool:
+        """Check whether generated code enables the runtime's thread pool (needs -pthread)."""
+        for source_file in source_files:
+            try:
+                with open(source_file) as f:
+                    if "#define MGEN_PARALLEL" in f.read():
+                        return True
+            except (FileNotFoundError, IsADirectoryError):
+                continue
+        return False
+
     def _setup_runtime_environment(self, output_dir: str) -> None:
         """Setup runtime environment in the output directory."""
         output_path = Path(output_dir)
@@ -20,16 +20,33 @@ Supported Features:
 """
 
 import ast
-from typing import Any, Optional, Union
-
+import builtins
+import math
+import re
+from pathlib import Path
+from typing import Any, Optional, Union, cast
+
+from ...frontend.dict_updates import DictUpdate, match_dict_update
+from ...frontend.analyzers.call_graph import ClassHierarchy, class_hierarchy
+from ...frontend.analyzers.symbolic_executor import ValueRangeAnalyzer
+from ...frontend.immutability_analyzer import ImmutabilityAnalyzer
+from ...frontend.optimization_hints import OptimizationHintAnalyzer
+from ...frontend.optimizers.compile_time_evaluator import CompileTimeEvaluator, StringDispatch, StringMatchChain
+from ...frontend.optimizers.loop_analyzer import ParallelLoop
 from ..base import AbstractEmitter
 from ..converter_utils import (
     get_standard_binary_operator,
     get_standard_comparison_operator,
     get_standard_unary_operator,
+    line_directive,
+    read_only_dict_literals,
+    render_string_dispatch,
+    restore_generated_lines,
+    struct_of_arrays_classes,
 )
 from ..errors import TypeMappingError, UnsupportedFeatureError
-from ..preferences import BackendPreferences
+from ..preferences import BackendPreferences, CppPreferences
+from ..python_extension import plan_extension, render_cpp_extension
 from ..type_inference_strategies import InferenceContext
 from .factory import CppFactory
 from .type_inference import create_cpp_type_inference_engine
@@ -38,8 +55,16 @@ from .type_inference import create_cpp_type_inference_engine
 class MGenPythonToCppConverter:
     """Enhanced Python to C++ converter with MGen STL runtime integration."""
 
-    def __init__(self) -> None:
-        """Initialize converter with MGen STL runtime support."""
+    def __init__(self, preferences: Optional[BackendPreferences] = None) -> None:
+        """Initialize converter with MGen STL runtime support.
+
+        Args:
+            preferences: Backend preferences for controlling code generation
+        """
+        if preferences is None:
+            preferences = CppPreferences()
+        self.preferences = preferences
+
         self.type_mapping = {
             "int": "int",
             "float": "double",
@@ -58,14 +83,52 @@ class MGenPythonToCppConverter:
         self.includes_needed: set[str] = set()
         self.use_runtime = True
         self.append_map: dict[str, str] = {}  # container -> appended_item (from pre-pass)
+        self.single_use_views: set[str] = set()  # comprehension locals emitted as views (from pre-pass)
+        self.last_use_moves: set[int] = set()  # ids of Name nodes that are a local's last use (from pre-pass)
+        self.small_lists: dict[str, int] = {}  # local -> inline capacity for mgen::SmallVector (from pre-pass)
+        self.constant_tables: dict[str, tuple[str, list[Any]]] = {}  # local -> constexpr array (from pre-pass)
+        self.narrow_lists: dict[str, str] = {}  # int list local -> narrower element type (from pre-pass)
+        self.borrowed_params: dict[str, set[int]] = {}  # function -> positions of const& parameters (from pre-pass)
+        self.compile_time_evaluator = CompileTimeEvaluator()
+        # string_dispatch: str_match_N decision trees (emitted ahead of the functions) for string if/elif
+        # chains and read-only str dict literals; the current function's dicts map to their table prefix
+        # and key count
+        self.string_dispatch_functions: list[str] = []
+        self.constant_str_dicts: dict[str, tuple[str, int]] = {}
+        # soa_lists: fields of the classes whose lists are ClassSoA structs of one vector per field,
+        # and the list and index variable of each enclosing loop over such a list
+        self.soa_classes: dict[str, dict[str, str]] = {}
+        self.soa_loops: dict[str, tuple[str, str]] = {}
+        # instrument: (function, kind, line) of each probe, indexed by site id, and the
+        # function whose statements get loop probes (None outside one)
+        self.probe_sites: list[tuple[str, str, int]] = []
+        self.probe_function: Optional[str] = None
+        # Python file that #line directives attribute functions and statements to (None: no mapping)
+        self.source_file: Optional[str] = None
+        # Parameter and result types of each converted function, for the extension wrappers
+        self.function_signatures: dict[str, tuple[list[str], str]] = {}
+        # devirtualize: which classes are leaves of the program's hierarchy, and their field getters
+        self.class_hierarchy = ClassHierarchy()
+        # Loops proven parallel (parallel_loops preference), and whether one encloses the current statement
+        self.parallel_loops: dict[int, ParallelLoop] = {}
+        self.in_parallel_loop = False
         # Initialize type inference engine with C++-specific strategies
         self.type_inference_engine = create_cpp_type_inference_engine()
 
-    def convert_code(self, source_code: str) -> str:
-        """Convert Python source code to C++ code."""
+    def convert_code(self, source_code: str, source_file: Optional[str] = None) -> str:
+        """Convert Python source code to C++ code.
+
+        With source_file, #line directives attribute each function and statement
+        to its line in that file, for compiler diagnostics, debuggers and
+        profilers; the rest of the module keeps its lines in source_file's .cpp.
+        """
+        self.source_file = source_file
         try:
             tree = ast.parse(source_code)
-            return self._convert_module(tree)
+            code = self._convert_module(tree)
+            if source_file is None:
+                return code
+            return restore_generated_lines(code, Path(source_file).stem + ".cpp")
         except (UnsupportedFeatureError, TypeMappingError):
             # Re-raise our specific exceptions without wrapping
             raise
@@ -79,33 +142,105 @@ class MGenPythonToCppConverter:
         # Check for advanced features to enable appropriate includes
         self.uses_comprehensions = self._uses_comprehensions(node)
         self.uses_classes = self._uses_classes(node)
+        if self.preferences.get("parallel_loops", False):
+            self.parallel_loops = OptimizationHintAnalyzer().analyze(node).parallel
+        self.borrowed_params = self._analyze_borrowed_params(node)
+        self.soa_classes = struct_of_arrays_classes(node) if self.preferences.get("soa_lists", False) else {}
+        self.class_hierarchy = class_hierarchy(node) if self.preferences.get("devirtualize", True) else ClassHierarchy()
 
         # First pass: check for string methods to populate includes_needed
         self._detect_string_methods(node)
 
         # Add includes
+        self.probe_sites = []
+        self.function_signatures = {}
         parts.extend(self._generate_includes())
+        runtime_index = len(parts) - 1
         parts.append("")
 
         # Add using namespace for convenience
         parts.append("using namespace std;")
         parts.append("using namespace mgen;")
         parts.append("")
+        self.string_dispatch_functions = []
+        dispatch_index = len(parts)
 
         # Convert functions and classes
         for stmt in node.body:
             if isinstance(stmt, ast.FunctionDef):
-                parts.append(self._convert_function(stmt))
+                function = self._apply_container_preferences(self._convert_function(stmt))
+                if self.source_file is not None:
+                    function = f"{line_directive(stmt.lineno, self.source_file)}\n{function}"
+                parts.append(function)
                 parts.append("")
             elif isinstance(stmt, ast.ClassDef):
-                parts.append(self._convert_class(stmt))
+                parts.append(self._apply_container_preferences(self._convert_class(stmt)))
                 parts.append("")
             else:
                 # Handle other top-level statements if needed
                 parts.append(f"// TODO: Handle {type(stmt).__name__}")
 
+        for dispatch in reversed(self.string_dispatch_functions):
+            parts[dispatch_index:dispatch_index] = [dispatch, ""]
+
+        # Must precede the runtime header: switches on the probes and sizes their records
+        if self.probe_sites:
+            parts[runtime_index:runtime_index] = [
+                "#ifndef MGEN_NO_INSTRUMENT",
+                "#define MGEN_INSTRUMENT",
+                "#endif",
+                f"#define MGEN_INSTRUMENT_MAX_SITES {len(self.probe_sites)}",
+            ]
+
+        if self.preferences.get("target_mode", "executable") == "extension":
+            parts.append(self._apply_container_preferences(self._generate_extension_module(node)))
+            # Python.h precedes the standard headers, which it may configure
+            parts[runtime_index:runtime_index] = ["#define MGEN_PYTHON_EXTENSION"]
+            parts[0:0] = ["#define PY_SSIZE_T_CLEAN", "#include <Python.h>"]
+
         return "\n".join(parts)
 
+    # C++ parameter and result types the extension wrappers convert, by Python kind
+    EXTENSION_TYPES = {
+        "int": "int",
+        "float": "double",
+        "bool": "bool",
+        "str": "std::string",
+        "None": "void",
+        "list[int]": "std::vector<int>",
+        "list[float]": "std::vector<double>",
+    }
+
+    def _generate_extension_module(self, node: ast.Module) -> str:
+        """CPython wrappers of the module's functions (the "extension" target mode).
+
+        The wrappers convert arguments into values of the parameter types, so
+        list parameters accept buffers whether or not the function borrows them.
+        """
+        functions, skipped = plan_extension(node, self.function_signatures)
+        for function in list(functions):
+            # Representations chosen by other preferences (e.g. soa_lists, narrowing) have no wrapper
+            kinds = [(kind, cpp_type) for _, kind, cpp_type in function.parameters] + [function.result]
+            if any(self.EXTENSION_TYPES[kind] != cpp_type for kind, cpp_type in kinds):
+                functions.remove(function)
+                skipped.append(f"{function.name} (C++ representation of its signature)")
+        return render_cpp_extension(functions, skipped, [])
+
+    def _apply_container_preferences(self, code: str) -> str:
+        """Spell container types for the selected container implementation.
+
+        Type inference works with std::vector/std::unordered_map/std::unordered_set
+        names throughout; with flat_hash_containers or pmr_containers the emitted
+        declarations use the runtime's List/Dict/Set aliases instead, which
+        MGEN_FLAT_CONTAINERS and MGEN_PMR point at the selected containers (as
+        they do for comprehension results).
+        """
+        if self.preferences.get("pmr_containers", False):
+            code = code.replace("std::vector<", "mgen::List<")
+        elif not self.preferences.get("flat_hash_containers", False):
+            return code
+        return code.replace("std::unordered_map<", "mgen::Dict<").replace("std::unordered_set<", "mgen::Set<")
+
     def _generate_includes(self) -> list[str]:
         """Generate necessary C++ includes based on code analysis."""
         includes = [
@@ -116,11 +251,25 @@ class MGenPythonToCppConverter:
             "#include <unordered_map>",
             "#include <set>",
             "#include <unordered_set>",
+            "#include <tuple>",
             "#include <algorithm>",
             "#include <memory>",
             "#include <cassert>",
         ]
 
+        # Must precede the runtime header: selects the dict/set implementation
+        if self.preferences.get("flat_hash_containers", False):
+            includes.append("#define MGEN_FLAT_CONTAINERS")
+
+        # Must precede the runtime header: switches List/Dict/Set to std::pmr
+        if self.preferences.get("pmr_containers", False):
+            includes.append("#define MGEN_PMR")
+
+        # Must precede the runtime header: switches on its thread pool
+        if self.preferences.get("parallel", False):
+            includes.append("#define MGEN_PARALLEL")
+            includes.append(f"#define MGEN_PARALLEL_THRESHOLD {int(self.preferences.get('parallel_threshold', 100000))}")
+
         # Add MGen runtime
         includes.append('#include "runtime/mgen_cpp_runtime.hpp"')
 
@@ -165,7 +314,9 @@ class MGenPythonToCppConverter:
 
         # Get parameters with types
         params = []
-        for arg in node.args.args:
+        param_types = []
+        borrowed = set()
+        for position, arg in enumerate(node.args.args):
             param_name = arg.arg
             param_type = self._get_param_type(arg)
 
@@ -173,8 +324,20 @@ class MGenPythonToCppConverter:
             if param_name in nested_params and param_type == "std::vector<int>":
                 param_type = "std::vector<std::vector<int>>"
 
-            params.append(f"{param_type} {param_name}")
+            # Containers and strings only read in place are borrowed instead of copied
+            soa_type = self._soa_list_type(arg.annotation)
+            if soa_type:
+                # Element fields are written through the caller's arrays, as Python writes its objects
+                param_type = soa_type
+                params.append(f"{param_type}& {param_name}")
+            elif position in self.borrowed_params.get(node.name, ()):
+                params.append(f"const {param_type}& {param_name}")
+                borrowed.add(param_name)
+            else:
+                params.append(f"{param_type} {param_name}")
             self.variable_context[param_name] = param_type
+            param_types.append(param_type)
+        self.function_signatures[node.name] = (param_types, return_type)
 
         # Pre-pass 1: Build append map
         self.append_map = self._analyze_append_operations(node.body)
@@ -182,12 +345,42 @@ class MGenPythonToCppConverter:
         # Pre-pass 2: Infer all variable types (including nested containers)
         self._infer_all_variable_types(node.body)
 
+        # Pre-pass 3: Find comprehensions over constants, which become constexpr tables
+        self.constant_tables = self._analyze_constant_tables(node.body, {arg.arg for arg in node.args.args})
+
+        # Pre-pass 4: Find comprehension locals consumed once, which stay lazy views
+        self.single_use_views = self._analyze_single_use_comprehensions(node.body, {arg.arg for arg in node.args.args})
+
+        # Pre-pass 5: Find last uses of locals that can be moved from instead of copied
+        self.last_use_moves = self._analyze_last_uses(node.body, {arg.arg for arg in node.args.args} - borrowed)
+
+        # Pre-pass 6: Find short fixed-size lists that can live in inline storage
+        self.small_lists = self._analyze_small_lists(node.body, {arg.arg for arg in node.args.args})
+
+        # Pre-pass 7: Find int lists whose elements fit a narrower integer type
+        self.narrow_lists = self._analyze_narrow_lists(node)
+
+        # Pre-pass 8: Find read-only str dict literals, which become static lookup tables
+        if self.preferences.get("string_dispatch", True):
+            self.constant_str_dicts = self._plan_constant_str_dicts(node)
+
         # Generate function body
         body_parts = []
+        instrument = self.preferences.get("instrument", False)
+        if instrument:
+            self.probe_function = node.name
+            probe = self._open_probe("function", node.lineno)
         for stmt in node.body:
             converted = self._convert_statement(stmt)
             if converted.strip():
                 body_parts.append(converted)
+        self.probe_function = None
+
+        # Containers that cannot outlive the call come from an arena freed on return
+        if self._uses_scope_arena(node):
+            body_parts.insert(0, "        mgen::ScopedResource mgen_scope_resource;")
+        if instrument:
+            body_parts.insert(0, probe)
 
         body = "\n".join(body_parts)
 
@@ -197,8 +390,69 @@ class MGenPythonToCppConverter:
 
         self.current_function = None
         self.append_map = {}  # Clear after function
+        self.single_use_views = set()
+        self.last_use_moves = set()
+        self.small_lists = {}
+        self.constant_tables = {}
+        self.narrow_lists = {}
+        self.constant_str_dicts = {}
         return function
 
+    # Calls that may appear in a loop of an arena function: they allocate no
+    # containers, or (append, add) grow one geometrically
+    SCOPE_ARENA_LOOP_BUILTINS = frozenset(
+        {"len", "abs", "min", "max", "sum", "any", "all", "int", "float", "str", "bool", "print", "range",
+         "round", "enumerate", "zip", "isinstance"}
+    )
+    SCOPE_ARENA_LOOP_METHODS = frozenset(
+        {"append", "add", "get", "upper", "lower", "strip", "find", "replace", "startswith", "endswith", "join",
+         "keys", "values", "items"}
+    )
+
+    def _uses_scope_arena(self, node: ast.FunctionDef) -> bool:
+        """Check whether a function gets a per-call memory arena (pmr_containers).
+
+        The arena is released when the function returns, so the function must
+        return a scalar or string, and must not reach further than its own
+        frame (global, nonlocal, generators, nested functions). A monotonic arena
+        never reuses freed memory, so loops may not create containers, call user
+        functions or remove elements; growing a container with append()/add()
+        is fine, as it reallocates geometrically.
+        """
+        if not self.preferences.get("pmr_containers", False) or self.preferences.get("parallel", False):
+            return False
+
+        returns = node.returns
+        if not (
+            returns is None
+            or (isinstance(returns, ast.Constant) and returns.value is None)
+            or (isinstance(returns, ast.Name) and returns.id in ("int", "float", "bool", "str", "None"))
+        ):
+            return False
+
+        container_nodes = (ast.List, ast.Dict, ast.Set, ast.ListComp, ast.DictComp, ast.SetComp)
+        allocates = False
+        for child in ast.walk(node):
+            if isinstance(child, (ast.Global, ast.Nonlocal, ast.Yield, ast.YieldFrom, ast.AsyncFunctionDef)):
+                return False
+            if isinstance(child, (ast.FunctionDef, ast.ClassDef)) and child is not node:
+                return False
+            if isinstance(child, container_nodes) or (
+                isinstance(child, ast.Call) and isinstance(child.func, ast.Attribute) and child.func.attr == "split"
+            ):
+                allocates = True
+            if isinstance(child, (ast.For, ast.While)):
+                for inner in ast.walk(child):
+                    if isinstance(inner, container_nodes + (ast.Delete,)):
+                        return False
+                    if isinstance(inner, ast.Call):
+                        func = inner.func
+                        if isinstance(func, ast.Name) and func.id not in self.SCOPE_ARENA_LOOP_BUILTINS:
+                            return False
+                        if isinstance(func, ast.Attribute) and func.attr not in self.SCOPE_ARENA_LOOP_METHODS:
+                            return False
+        return allocates
+
     def _analyze_nested_subscripts(self, stmts: list[ast.stmt]) -> set[str]:
         """Detect variables used with nested subscripts like a[i][j]."""
         nested_vars: set[str] = set()
@@ -410,7 +664,9 @@ class MGenPythonToCppConverter:
 
         # Generate class parts
         parts = []
-        parts.append(f"class {class_name} {{")
+        # Nothing derives from a leaf class, so compilers may bind its calls statically
+        final = " final" if self.class_hierarchy.is_leaf(class_name) else ""
+        parts.append(f"class {class_name}{final} {{")
         parts.append("public:")
 
         # Add instance variables
@@ -438,8 +694,53 @@ class MGenPythonToCppConverter:
                 parts.append("")
 
         parts.append("};")
+        if class_name in self.soa_classes:
+            parts.append("")
+            parts.append(self._generate_soa_list(class_name, instance_vars))
         return "\n".join(parts)
 
+    def _generate_soa_list(self, class_name: str, instance_vars: dict[str, str]) -> str:
+        """Generate ClassSoA, the list of a struct_of_arrays_classes class: one vector per field.
+
+        Loops over one field then read consecutive memory, which the compiler
+        can vectorize. push_back and size() stand in for the vector's, so
+        appends and mgen::len() convert as for any list.
+        """
+        fields = {name: instance_vars[name] for name in self.soa_classes[class_name]}
+        lines = [f"struct {class_name}SoA {{"]
+        lines.extend(f"    std::vector<{cpp_type}> {name};" for name, cpp_type in fields.items())
+        lines.extend(["", f"    void push_back(const {class_name}& item) {{"])
+        lines.extend(f"        {name}.push_back(item.{name});" for name in fields)
+        lines.extend(["    }", "", "    size_t size() const {", f"        return {next(iter(fields))}.size();"])
+        lines.append("    }")
+        lines.append("};")
+        return "\n".join(lines)
+
+    def _soa_list_type(self, annotation: Optional[ast.expr]) -> Optional[str]:
+        """ClassSoA for a list[Class] annotation of a struct-of-arrays class, else None."""
+        if isinstance(annotation, ast.Subscript) and isinstance(annotation.value, ast.Name):
+            element = annotation.slice
+            if annotation.value.id == "list" and isinstance(element, ast.Name) and element.id in self.soa_classes:
+                return f"{element.id}SoA"
+        return None
+
+    def _is_soa_list(self, expr: ast.expr) -> bool:
+        """Check whether an expression names a struct-of-arrays list variable."""
+        if not isinstance(expr, ast.Name):
+            return False
+        cpp_type = self.variable_context.get(expr.id, "")
+        return cpp_type.endswith("SoA") and cpp_type[: -len("SoA")] in self.soa_classes
+
+    def _soa_field(self, expr: ast.Attribute) -> Optional[str]:
+        """The vector slot xs[i].f or v.f (v iterating xs) stands for, when xs is a struct-of-arrays list."""
+        if isinstance(expr.value, ast.Name) and expr.value.id in self.soa_loops:
+            soa, index = self.soa_loops[expr.value.id]
+            return f"{soa}.{expr.attr}[{index}]"
+        element = expr.value
+        if isinstance(element, ast.Subscript) and self._is_soa_list(element.value):
+            return f"{self._convert_expression(element.value)}.{expr.attr}[{self._convert_expression(element.slice)}]"
+        return None
+
     def _extract_instance_variables(self, class_node: ast.ClassDef) -> dict[str, str]:
         """Extract instance variables from __init__ method."""
         instance_vars = {}
@@ -546,9 +847,10 @@ class MGenPythonToCppConverter:
 
         body = "\n".join(body_parts)
 
-        # Build method
+        # Build method; a field getter does not change the object, so const receivers may call it
         param_str = ", ".join(params)
-        method_def = f"    {return_type} {method.name}({param_str}) {{\n{self._indent_block(body)}\n    }}"
+        qualifier = " const" if method.name in self.class_hierarchy.getters.get(class_name, {}) else ""
+        method_def = f"    {return_type} {method.name}({param_str}){qualifier} {{\n{self._indent_block(body)}\n    }}"
 
         self.current_function = None
         return method_def
@@ -657,18 +959,13 @@ class MGenPythonToCppConverter:
             # Handle method calls within class context
             if isinstance(expr.func, ast.Attribute):
                 if isinstance(expr.func.value, ast.Name) and expr.func.value.id == "self":
-                    # self.method() -> handle string methods and other method calls
+                    # self.method(): the receiver's class is known, so the call binds statically
                     method_name = expr.func.attr
-                    [self._convert_method_expression(arg, class_name) for arg in expr.args]
-
-                    # Handle string methods on self attributes
-                    if method_name in ["upper", "lower", "strip", "find", "replace", "split"]:
-                        obj_expr = f"this->{expr.func.attr}"  # This would be wrong for method calls
-                        # Actually, this case shouldn't happen - string methods are called on attributes
-                        pass
-
-                    # Regular method calls would need more complex handling
-                    return f"/* Method call: {method_name} */"
+                    args = [self._convert_method_expression(arg, class_name) for arg in expr.args]
+                    field = self._inlinable_getter(class_name, method_name)
+                    if field is not None and not args:
+                        return f"this->{field}"
+                    return f"this->{method_name}({', '.join(args)})"
                 else:
                     # Regular method/attribute calls
                     return self._convert_method_call(expr)
@@ -848,6 +1145,30 @@ class MGenPythonToCppConverter:
 
     def _convert_statement(self, stmt: ast.stmt) -> str:
         """Convert a Python statement to C++."""
+        if self.probe_function is not None and isinstance(stmt, (ast.For, ast.While)):
+            # A probe closes when its block ends: close it right after the loop
+            site = len(self.probe_sites)
+            probe = self._open_probe("loop", stmt.lineno)
+            loop = self._convert_single_statement(stmt)
+            converted = "\n".join([probe, loop, f"        MGEN_PROBE_CLOSE(mgen_probe_{site});"])
+        else:
+            converted = self._convert_single_statement(stmt)
+        if converted.strip() and self.source_file is not None:
+            return f"        {line_directive(stmt.lineno, self.source_file)}\n{converted}"
+        return converted
+
+    def _open_probe(self, kind: str, line: int) -> str:
+        """Register an instrumentation site in the current function and open its probe."""
+        assert self.probe_function is not None
+        site = len(self.probe_sites)
+        self.probe_sites.append((self.probe_function, kind, line))
+        return f'        MGEN_PROBE(mgen_probe_{site}, {site}, "{self.probe_function}", "{kind}", {line});'
+
+    def _convert_single_statement(self, stmt: ast.stmt) -> str:
+        """Convert one Python statement to C++ (no instrumentation)."""
+        update = match_dict_update(stmt)
+        if update is not None and self._is_numeric_map(update.container):
+            return self._convert_dict_update(update)
         if isinstance(stmt, ast.Return):
             return self._convert_return(stmt)
         elif isinstance(stmt, ast.Assign):
@@ -917,6 +1238,15 @@ class MGenPythonToCppConverter:
 
     def _convert_assignment(self, stmt: ast.Assign) -> str:
         """Convert assignment statement."""
+        if len(stmt.targets) == 1 and isinstance(stmt.targets[0], ast.Name):
+            if stmt.targets[0].id in self.constant_tables:
+                return self._convert_constant_table_declaration(stmt.targets[0].id)
+            if stmt.targets[0].id in self.constant_str_dicts:
+                return ""  # A static table (_plan_constant_str_dicts)
+        if len(stmt.targets) == 1 and self._is_single_use_view(stmt.targets[0], stmt.value):
+            return self._convert_view_assignment(stmt.targets[0], stmt.value)
+        if len(stmt.targets) == 1 and isinstance(stmt.targets[0], ast.Tuple):
+            return self._convert_tuple_assignment(stmt.targets[0], stmt.value)
         value_expr = self._convert_expression(stmt.value)
         statements = []
 
@@ -928,9 +1258,13 @@ class MGenPythonToCppConverter:
                 if var_name in self.variable_context:
                     # Variable already declared - just reassign
                     statements.append(f"        {var_name} = {value_expr};")
+                elif var_name in self.small_lists:
+                    statements.append(self._convert_small_list_declaration(var_name, stmt.value))
+                elif var_name in self.narrow_lists:
+                    statements.append(self._convert_narrow_list_declaration(var_name, stmt.value))
                 else:
                     # New variable - declare with type
-                    var_type = self._infer_type_from_value(stmt.value)
+                    var_type = self._tuple_type_of(stmt.value) or self._infer_type_from_value(stmt.value)
                     self.variable_context[var_name] = var_type
                     statements.append(f"        {var_type} {var_name} = {value_expr};")
             else:
@@ -942,6 +1276,20 @@ class MGenPythonToCppConverter:
 
     def _convert_annotated_assignment(self, stmt: ast.AnnAssign) -> str:
         """Convert annotated assignment (var: type = value)."""
+        soa_type = self._soa_list_type(stmt.annotation)
+        if isinstance(stmt.target, ast.Name) and soa_type:
+            self.variable_context[stmt.target.id] = soa_type
+            return f"        {soa_type} {stmt.target.id};"
+        if stmt.value is not None and self._is_single_use_view(stmt.target, stmt.value):
+            return self._convert_view_assignment(stmt.target, stmt.value)
+        if isinstance(stmt.target, ast.Name) and stmt.value is not None and stmt.target.id in self.constant_tables:
+            return self._convert_constant_table_declaration(stmt.target.id)
+        if isinstance(stmt.target, ast.Name) and stmt.target.id in self.constant_str_dicts:
+            return ""  # A static table (_plan_constant_str_dicts)
+        if isinstance(stmt.target, ast.Name) and stmt.value is not None and stmt.target.id in self.small_lists:
+            return self._convert_small_list_declaration(stmt.target.id, stmt.value)
+        if isinstance(stmt.target, ast.Name) and stmt.value is not None and stmt.target.id in self.narrow_lists:
+            return self._convert_narrow_list_declaration(stmt.target.id, stmt.value)
         if isinstance(stmt.target, ast.Name):
             var_name = stmt.target.id
 
@@ -1001,6 +1349,74 @@ class MGenPythonToCppConverter:
                 return f"        {target_expr} = {value_expr};"
         return ""
 
+    def _is_single_use_view(self, target: ast.expr, value: ast.expr) -> bool:
+        """Check whether an assignment binds a comprehension the pre-pass marked as a view."""
+        return isinstance(target, ast.Name) and isinstance(value, ast.ListComp) and target.id in self.single_use_views
+
+    def _convert_view_assignment(self, target: ast.Name, value: ast.ListComp) -> str:
+        """Bind a single-use comprehension as a lazy view instead of a vector."""
+        self.variable_context[target.id] = "auto"
+        return f"        auto {target.id} = {self._convert_comprehension_view(value)};"
+
+    def _convert_constant_table_declaration(self, var_name: str) -> str:
+        """Declare a comprehension folded at conversion time as a static constexpr std::array."""
+        element_type, values = self.constant_tables[var_name]
+        literals = self._constant_literals(element_type, values)
+
+        var_type = f"std::array<{element_type}, {len(values)}>"
+        self.variable_context[var_name] = var_type
+        rows = [", ".join(literals[i : i + 16]) for i in range(0, len(literals), 16)]
+        if len(rows) == 1:
+            return f"        static constexpr {var_type} {var_name} = {{{rows[0]}}};"
+        body = ",\n".join(f"            {row}" for row in rows)
+        return f"        static constexpr {var_type} {var_name} = {{\n{body}\n        }};"
+
+    def _constant_literals(self, element_type: str, values: list[Any]) -> list[str]:
+        """C++ literals for constant table values of element_type."""
+        if element_type == "bool":
+            return ["true" if value else "false" for value in values]
+        if element_type == "double":
+            return [repr(float(value)) for value in values]
+        if element_type == "long long":
+            # -2**63 has no literal form; spell it as an expression
+            return [f"{value}LL" if value != -(2**63) else "(-9223372036854775807LL - 1)" for value in values]
+        return [str(value) for value in values]
+
+    def _convert_small_list_declaration(self, var_name: str, value: ast.expr) -> str:
+        """Declare a short fixed-size list local as an mgen::SmallVector."""
+        capacity = self.small_lists[var_name]
+        list_type = self.variable_context.get(var_name) or self._infer_type_from_value(value)
+        if isinstance(value, ast.ListComp):
+            value_expr = self._convert_list_comprehension(value, small_capacity=capacity)
+        elif list_type.startswith("std::vector<"):
+            value_expr = self._convert_list_literal(value)
+        else:
+            # Element type unknown here: let C++ deduce it from the elements
+            value_expr = f"mgen::small_list({', '.join(self._convert_expression(elt) for elt in value.elts)})"
+
+        if list_type.startswith("std::vector<") and list_type.endswith(">"):
+            var_type = f"mgen::SmallVector<{list_type[len('std::vector<'):-1]}, {capacity}>"
+        else:
+            var_type = "auto"
+        self.variable_context[var_name] = var_type
+        return f"        {var_type} {var_name} = {value_expr};"
+
+    def _convert_narrow_list_declaration(self, var_name: str, value: ast.List) -> str:
+        """Declare an int list local with the narrower element type the pre-pass proved sufficient.
+
+        The local keeps its std::vector<int> type for inference, so code reading
+        its elements still sees int.
+        """
+        element_type = self.narrow_lists[var_name]
+        # Brace initialization rejects narrowing other than of constants in range
+        elements = [self._convert_expression(elt) for elt in value.elts]
+        elements = [
+            code if self._constant_int_value(elt) is not None else f"static_cast<{element_type}>({code})"
+            for elt, code in zip(value.elts, elements)
+        ]
+        self.variable_context[var_name] = "std::vector<int>"
+        return f"        std::vector<{element_type}> {var_name} = {{{', '.join(elements)}}};"
+
     def _convert_aug_assignment(self, stmt: ast.AugAssign) -> str:
         """Convert augmented assignment (+=, -=, etc.)."""
         target_expr = self._convert_expression(stmt.target)
@@ -1008,8 +1424,29 @@ class MGenPythonToCppConverter:
         op = self._get_aug_op(stmt.op)
         return f"        {target_expr} {op}= {value_expr};"
 
+    def _is_numeric_map(self, name: str) -> bool:
+        """Whether name is an unordered_map with int or double values."""
+        map_type = self.variable_context.get(name, "")
+        return map_type.startswith("std::unordered_map<") and map_type.endswith((", int>", ", double>"))
+
+    def _convert_dict_update(self, update: DictUpdate) -> str:
+        """Convert a counting update into one lookup (operator[] value-initializes a missing entry)."""
+        key = self._convert_expression(update.key)
+        increment = self._convert_expression(update.increment)
+        if update.default_is_zero:
+            return f"        {update.container}[{key}] += {increment};"
+        default = self._convert_expression(update.default)
+        return f"        {update.container}.try_emplace({key}, {default}).first->second += {increment};"
+
     def _convert_if(self, stmt: ast.If) -> str:
         """Convert if statement."""
+        if self.preferences.get("string_dispatch", True):
+            chain = self.compile_time_evaluator.string_match_chain(stmt)
+            # Loop variables are not in variable_context: they are auto, and compare with literals only as strings
+            string_types = ("std::string", "std::string_view", "auto")
+            if chain is not None and self.variable_context.get(chain.subject, "auto") in string_types:
+                return self._convert_string_match(chain)
+
         condition = self._convert_expression(stmt.test)
         then_body = self._convert_statements(stmt.body)
 
@@ -1027,6 +1464,86 @@ class MGenPythonToCppConverter:
 
         return if_part
 
+    def _convert_string_match(self, chain: StringMatchChain) -> str:
+        """Branch on the index str_match_N finds for the subject instead of comparing it with every literal.
+
+        The branches stay an if/else-if chain over that index, which compilers
+        turn into a jump table.
+        """
+        match = self._string_dispatch_function(chain.dispatch, chain.key_branches)
+        branch = match.replace("match", "branch")
+        parts = [f"        int {branch} = {match}({chain.subject});\n"]
+        for index, body in enumerate(chain.branches):
+            keyword = "        if" if index == 0 else " else if"
+            parts.append(f"{keyword} ({branch} == {index}) {{\n{self._convert_statements(body)}\n        }}")
+        if len(chain.orelse) == 1 and isinstance(chain.orelse[0], ast.If):
+            parts.append(f" else {self._convert_if(chain.orelse[0]).strip()}")
+        elif chain.orelse:
+            parts.append(f" else {{\n{self._convert_statements(chain.orelse)}\n        }}")
+        return "".join(parts)
+
+    def _string_dispatch_function(self, dispatch: StringDispatch, results: list[int]) -> str:
+        """Emit str_match_N(s): results[i] for the i-th key of dispatch, -1 for any other string."""
+        name = f"str_match_{len(self.string_dispatch_functions)}"
+        body = render_string_dispatch(dispatch, results, "s.data()", "s.size()", memcmp="std::memcmp")
+        lines = [f"static inline int {name}(std::string_view s) {{", *(f"    {line}" for line in body), "}"]
+        self.string_dispatch_functions.append("\n".join(lines))
+        return name
+
+    def _plan_constant_str_dicts(self, node: ast.FunctionDef) -> dict[str, tuple[str, int]]:
+        """Read-only dict literals with string keys, as static constexpr tables behind a str_match function.
+
+        Dicts read_only_dict_literals finds only looked up, probed and measured,
+        whose keys are string literals and whose values fold to numbers or bools,
+        need no unordered_map built per call. d[k] becomes str_table_N_at(k),
+        which throws std::out_of_range for a missing key, k in d tests
+        str_match_N(k) >= 0 and len(d) is the key count.
+
+        Returns:
+            The str_match function and key count of each such dict, by name
+        """
+        annotations = {
+            stmt.target.id: stmt.annotation
+            for stmt in node.body
+            if isinstance(stmt, ast.AnnAssign) and isinstance(stmt.target, ast.Name)
+        }
+        tables: dict[str, tuple[str, int]] = {}
+        for name, literal in read_only_dict_literals(node).items():
+            constant = self.compile_time_evaluator.constant_string_dict(literal)
+            if constant is None or not constant[0]:
+                continue
+            keys, values = constant
+            element_type = self._constant_table_element_type(values)
+            if name in annotations:
+                declared = self._convert_type_annotation(annotations[name])
+                if declared == "std::unordered_map<std::string, double>" and element_type in ("int", "long long"):
+                    element_type, values = "double", [float(value) for value in values]
+                elif declared != f"std::unordered_map<std::string, {element_type}>":
+                    continue
+            if element_type is None:
+                continue
+            dispatch = self.compile_time_evaluator.build_string_dispatch(keys)
+            match = self._string_dispatch_function(dispatch, list(range(len(keys))))
+            table = match.replace("match", "table")
+            literals = ", ".join(self._constant_literals(element_type, values))
+            self.string_dispatch_functions[-1] += "\n".join(
+                [
+                    "",
+                    "",
+                    f"static constexpr std::array<{element_type}, {len(values)}> {table}_values = {{{literals}}};",
+                    "",
+                    f"static inline {element_type} {table}_at(std::string_view s) {{",
+                    f"    int index = {match}(s);",
+                    "    if (index < 0) {",
+                    '        throw std::out_of_range("Key not in constant dict");',
+                    "    }",
+                    f"    return {table}_values[index];",
+                    "}",
+                ]
+            )
+            tables[name] = (match, len(keys))
+        return tables
+
     def _convert_while(self, stmt: ast.While) -> str:
         """Convert while loop."""
         condition = self._convert_expression(stmt.test)
@@ -1058,19 +1575,82 @@ class MGenPythonToCppConverter:
                 start = self._convert_expression(args[0])
                 stop = self._convert_expression(args[1])
                 step = self._convert_expression(args[2])
+                step_value = self._constant_int_value(args[2])
+                if step_value is None or step_value == 0:
+                    # Sign unknown at compile time: Range picks the direction (and rejects 0)
+                    body = self._convert_statements(stmt.body)
+                    return f"        for (int {target_name} : Range({start}, {stop}, {step})) {{\n{body}\n        }}"
                 init = f"int {target_name} = {start}"
-                condition = f"{target_name} < {stop}"
+                condition = f"{target_name} {'<' if step_value > 0 else '>'} {stop}"
                 update = f"{target_name} += {step}"
             else:
                 raise UnsupportedFeatureError("Invalid range() arguments")
 
+            # Only the outermost parallel loop forks threads
+            plan = None if self.in_parallel_loop else self.parallel_loops.get(stmt.lineno)
+            enclosing, self.in_parallel_loop = self.in_parallel_loop, self.in_parallel_loop or plan is not None
+            body = self._convert_statements(stmt.body)
+            self.in_parallel_loop = enclosing
+            # Checked after the body so the types of its locals are known
+            pragma = self._omp_parallel_for(plan) if plan is not None else None
+            prefix = f"        {pragma}\n" if pragma else ""
+            return f"{prefix}        for ({init}; {condition}; {update}) {{\n{body}\n        }}"
+        elif self._is_soa_list(stmt.iter):
+            # Struct-of-arrays lists are walked by index; target.f in the body is the f vector's slot
+            soa = cast(ast.Name, stmt.iter).id
+            index = f"{target_name}_soa_index"
+            self.soa_loops[target_name] = (soa, index)
             body = self._convert_statements(stmt.body)
-            return f"        for ({init}; {condition}; {update}) {{\n{body}\n        }}"
+            del self.soa_loops[target_name]
+            return f"        for (size_t {index} = 0; {index} < {soa}.size(); {index}++) {{\n{body}\n        }}"
         else:
-            # Range-based for loop for containers
-            iter_expr = self._convert_expression(stmt.iter)
+            # Range-based for loop for containers and fused comprehension views
+            if self._split_tokens_stay_local(stmt):
+                iter_expr = self._convert_string_view_operand(stmt.iter)
+            else:
+                iter_expr = self._convert_comprehension_source(stmt.iter)
+            if isinstance(stmt.target, ast.Tuple) and all(isinstance(elt, ast.Name) for elt in stmt.target.elts):
+                # for i, x in enumerate(...) / zip(...) -> structured binding
+                target_name = f"[{', '.join(elt.id for elt in stmt.target.elts)}]"
+            # Elements of a narrowed list are read as int
+            loop_type = "int" if isinstance(stmt.iter, ast.Name) and stmt.iter.id in self.narrow_lists else "auto"
             body = self._convert_statements(stmt.body)
-            return f"        for (auto {target_name} : {iter_expr}) {{\n{body}\n        }}"
+            return f"        for ({loop_type} {target_name} : {iter_expr}) {{\n{body}\n        }}"
+
+    # Types a parallel loop may share or privatize, and those its reductions may have:
+    # reassociating a floating-point sum across threads would change its result
+    OMP_REDUCTION_TYPES = frozenset({"int", "long", "long long", "int64_t", "size_t"})
+    OMP_SCALAR_TYPES = OMP_REDUCTION_TYPES | {"double", "float", "bool"}
+    # Vectors (of vectors) of numbers; std::vector<bool> packs elements into shared words
+    OMP_CONTAINER_TYPE = re.compile(r"(std::vector<)+(int|long|long long|int64_t|double|float)>+")
+
+    def _omp_parallel_for(self, plan: ParallelLoop) -> Optional[str]:
+        """Build the OpenMP pragma of a loop the analyzer proved parallel.
+
+        Returns None if a variable of the loop has a type OpenMP cannot share
+        safely (strings, hash containers, std::vector<bool>) or a reduction is
+        not integral, so the loop stays serial.
+        """
+        for name in plan.names - plan.loop_variables:
+            cpp_type = self.variable_context.get(name, "")
+            if name in plan.reductions:
+                if cpp_type not in self.OMP_REDUCTION_TYPES:
+                    return None
+            elif cpp_type not in self.OMP_SCALAR_TYPES and not self.OMP_CONTAINER_TYPE.fullmatch(cpp_type):
+                return None
+        pragma = "#pragma omp parallel for"
+        if plan.reductions:
+            pragma += f" reduction(+:{', '.join(plan.reductions)})"
+        return pragma
+
+    def _constant_int_value(self, expr: ast.expr) -> Optional[int]:
+        """Return the value of an integer literal such as 2 or -1, or None."""
+        if isinstance(expr, ast.UnaryOp) and isinstance(expr.op, ast.USub):
+            inner = self._constant_int_value(expr.operand)
+            return -inner if inner is not None else None
+        if isinstance(expr, ast.Constant) and isinstance(expr.value, int) and not isinstance(expr.value, bool):
+            return expr.value
+        return None
 
     def _convert_expression_statement(self, stmt: ast.Expr) -> str:
         """Convert expression statement."""
@@ -1085,6 +1665,8 @@ class MGenPythonToCppConverter:
         if isinstance(expr, ast.Constant):
             return self._convert_constant(expr)
         elif isinstance(expr, ast.Name):
+            if id(expr) in self.last_use_moves and self._is_movable_type(self.variable_context.get(expr.id, "")):
+                return f"std::move({expr.id})"
             return expr.id
         elif isinstance(expr, ast.BinOp):
             return self._convert_binary_op(expr)
@@ -1114,6 +1696,8 @@ class MGenPythonToCppConverter:
             return self._convert_subscript(expr)
         elif isinstance(expr, ast.JoinedStr):
             return self._convert_f_string(expr)
+        elif isinstance(expr, ast.Tuple):
+            return f"std::make_tuple({', '.join(self._convert_expression(element) for element in expr.elts)})"
         else:
             raise UnsupportedFeatureError(f"Unsupported expression type: {type(expr).__name__}")
 
@@ -1166,11 +1750,14 @@ class MGenPythonToCppConverter:
 
     def _convert_compare(self, expr: ast.Compare) -> str:
         """Convert comparison operations."""
-        left = self._convert_expression(expr.left)
+        # Ordering and equality only read their operands, so strip()/split() may borrow
+        borrows = all(isinstance(op, (ast.Eq, ast.NotEq, ast.Lt, ast.LtE, ast.Gt, ast.GtE)) for op in expr.ops)
+        convert_operand = self._convert_string_view_operand if borrows else self._convert_expression
+        left = convert_operand(expr.left)
         result = left
 
         for op, comparator in zip(expr.ops, expr.comparators):
-            right = self._convert_expression(comparator)
+            right = convert_operand(comparator)
 
             # Use standard comparison operator mapping from converter_utils
             cpp_op = get_standard_comparison_operator(op)
@@ -1181,6 +1768,10 @@ class MGenPythonToCppConverter:
                     cpp_op = "=="
                 elif isinstance(op, ast.IsNot):
                     cpp_op = "!="
+                elif isinstance(op, (ast.In, ast.NotIn)) and self._is_constant_str_dict(comparator):
+                    match, _ = self.constant_str_dicts[cast(ast.Name, comparator).id]
+                    result = f"({match}({result}) {'>=' if isinstance(op, ast.In) else '<'} 0)"
+                    continue
                 elif isinstance(op, ast.In):
                     # Use .count() or .find() for membership testing
                     result = f"({right}.count({result}) > 0)"
@@ -1199,7 +1790,15 @@ class MGenPythonToCppConverter:
         """Convert function calls."""
         if isinstance(expr.func, ast.Name):
             func_name = expr.func.id
-            args = [self._convert_expression(arg) for arg in expr.args]
+            if func_name in ("sum", "any", "all") and len(expr.args) == 1:
+                # A comprehension argument is consumed once: reduce over a fused view
+                args = [self._convert_comprehension_source(expr.args[0])]
+            elif func_name == "len" and len(expr.args) == 1:
+                if self._is_constant_str_dict(expr.args[0]):
+                    return str(self.constant_str_dicts[cast(ast.Name, expr.args[0]).id][1])
+                args = [self._convert_string_view_operand(expr.args[0])]
+            else:
+                args = [self._convert_expression(arg) for arg in expr.args]
 
             # Handle empty container constructors
             if func_name == "set" and len(args) == 0:
@@ -1229,6 +1828,14 @@ class MGenPythonToCppConverter:
             if func_name in builtin_map:
                 mapped_name = builtin_map[func_name]
                 if func_name == "print":
+                    if self.preferences.get("buffered_stdout", True):
+                        # Python str() of each argument into the runtime's stdout buffer
+                        return f"mgen::print({', '.join(args)})"
+                    # Streams print 8-bit integers as characters
+                    args = [
+                        f"static_cast<int>({code})" if self._reads_narrow_element(arg) else code
+                        for arg, code in zip(expr.args, args)
+                    ]
                     if args:
                         separator = ' << " " << '
                         return f"cout << {separator.join(args)} << endl"
@@ -1246,6 +1853,72 @@ class MGenPythonToCppConverter:
         else:
             return "/* Complex function call */"
 
+    def _string_method_receiver(self, expr: ast.Attribute) -> str:
+        """Convert the object a string method is called on."""
+        if isinstance(expr.value, ast.Attribute) and isinstance(expr.value.value, ast.Name) and expr.value.value.id == "self":
+            return f"this->{expr.value.attr}"
+        return self._convert_expression(expr.value)
+
+    def _is_borrowable_string_call(self, expr: ast.expr) -> bool:
+        """Check for s.strip(...) / s.split(...), which have string_view variants."""
+        return (
+            isinstance(expr, ast.Call)
+            and isinstance(expr.func, ast.Attribute)
+            and expr.func.attr in ("strip", "split")
+            and not expr.keywords
+            and len(expr.args) <= 1
+        )
+
+    def _convert_string_view_operand(self, expr: ast.expr) -> str:
+        """Convert an operand whose string result is only read where it is produced.
+
+        strip() and split() results that are compared or measured and then
+        dropped borrow the receiver's characters (StringOps::strip_view /
+        split_view) instead of allocating new strings.
+        """
+        if not (self._is_borrowable_string_call(expr) and isinstance(expr, ast.Call) and isinstance(expr.func, ast.Attribute)):
+            return self._convert_expression(expr)
+        args = [self._string_method_receiver(expr.func)] + [self._convert_expression(arg) for arg in expr.args]
+        return f"StringOps::{expr.func.attr}_view({', '.join(args)})"
+
+    def _split_tokens_stay_local(self, stmt: ast.For) -> bool:
+        """Check whether a for loop over name.split() can iterate string_views.
+
+        The receiver must be a variable the body does not rebind, so the views
+        stay valid, and the loop variable may only be compared, passed to len()
+        or printed, so no view is stored or converted to a std::string.
+        """
+        if not (
+            isinstance(stmt.target, ast.Name)
+            and self._is_borrowable_string_call(stmt.iter)
+            and isinstance(stmt.iter, ast.Call)
+            and isinstance(stmt.iter.func, ast.Attribute)
+            and stmt.iter.func.attr == "split"
+            and isinstance(stmt.iter.func.value, ast.Name)
+        ):
+            return False
+
+        receiver = stmt.iter.func.value.id
+        token = stmt.target.id
+        read_only_parents: list[ast.AST] = []
+        for body_stmt in stmt.body:
+            for node in ast.walk(body_stmt):
+                if isinstance(node, ast.Name) and node.id == receiver and not isinstance(node.ctx, ast.Load):
+                    return False
+                for child in ast.iter_child_nodes(node):
+                    if isinstance(child, ast.Name) and child.id == token:
+                        if not isinstance(child.ctx, ast.Load):
+                            return False
+                        read_only_parents.append(node)
+
+        for parent in read_only_parents:
+            if isinstance(parent, ast.Compare):
+                if not all(isinstance(op, (ast.Eq, ast.NotEq, ast.Lt, ast.LtE, ast.Gt, ast.GtE)) for op in parent.ops):
+                    return False
+            elif not (isinstance(parent, ast.Call) and isinstance(parent.func, ast.Name) and parent.func.id in ("len", "print")):
+                return False
+        return True
+
     def _convert_method_call(self, expr: ast.Call) -> str:
         """Convert method calls including string methods."""
         if isinstance(expr.func, ast.Attribute):
@@ -1311,11 +1984,9 @@ class MGenPythonToCppConverter:
             if method_name == "items":
                 return obj_expr  # Just return the map itself
 
-            # Handle dict.values() - extract values from map
-            # We'll use a lambda-based values extractor helper
-            if method_name == "values":
-                # Use a helper function from runtime to extract values
-                return f"mgen::values({obj_expr})"
+            # Handle dict.keys() / dict.values() - views over the map from the runtime
+            if method_name in ("keys", "values") and not expr.args:
+                return f"mgen::{method_name}({obj_expr})"
 
             # Handle set methods - map Python names to C++ names
             if method_name == "add":
@@ -1329,6 +2000,13 @@ class MGenPythonToCppConverter:
                 # In C++, erase() doesn't throw, so it matches discard() semantics
                 return f"{obj_expr}.erase({', '.join(args)})"
 
+            # A getter call on a leaf class receiver is the field read it wraps
+            if isinstance(expr.func.value, ast.Name) and not args:
+                receiver_type = self.variable_context.get(expr.func.value.id, "")
+                field = self._inlinable_getter(receiver_type, method_name)
+                if field is not None:
+                    return f"{obj_expr}.{field}"
+
             # Regular method calls
             if args:
                 return f"{obj_expr}.{method_name}({', '.join(args)})"
@@ -1337,136 +2015,134 @@ class MGenPythonToCppConverter:
 
         return "/* Unknown method call */"
 
+    def _inlinable_getter(self, class_name: str, method: str) -> Optional[str]:
+        """The field method returns on a class_name receiver, if no subclass can override it (devirtualize)."""
+        field = self.class_hierarchy.inlinable_getter(class_name, method)
+        if field is None or field not in self.defined_classes.get(class_name, {}).get("attributes", {}):
+            return None
+        return field
+
     def _convert_attribute(self, expr: ast.Attribute) -> str:
         """Convert attribute access."""
+        field = self._soa_field(expr)
+        if field:
+            return field
         obj_expr = self._convert_expression(expr.value)
         return f"{obj_expr}.{expr.attr}"
 
-    def _convert_list_comprehension(self, expr: ast.ListComp) -> str:
-        """Convert list comprehensions using STL and runtime helpers."""
-        # Extract comprehension components
-        element_expr = expr.elt
-        target = expr.generators[0].target
-        iter_expr = expr.generators[0].iter
-        conditions = expr.generators[0].ifs
+    def _comprehension_lambda(self, target: ast.expr, body: str) -> str:
+        """Build the per-element lambda of a comprehension or view.
 
-        if isinstance(iter_expr, ast.Call) and isinstance(iter_expr.func, ast.Name) and iter_expr.func.id == "range":
-            # Range-based comprehension
-            range_args = [self._convert_expression(arg) for arg in iter_expr.args]
-            range_call = f"Range({', '.join(range_args)})"
-
-            # Create lambda for transformation
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-            transform_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(element_expr)}; }}"
-
-            if conditions:
-                # With condition
-                condition_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(conditions[0])}; }}"
-                return f"list_comprehension({range_call}, {transform_lambda}, {condition_lambda})"
-            else:
-                # No condition
-                return f"list_comprehension({range_call}, {transform_lambda})"
-        else:
-            # Container iteration (like iterating over a vector)
-            container_expr = self._convert_expression(iter_expr)
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-            transform_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(element_expr)}; }}"
-
-            if conditions:
-                condition_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(conditions[0])}; }}"
-                return f"list_comprehension({container_expr}, {transform_lambda}, {condition_lambda})"
-            else:
-                return f"list_comprehension({container_expr}, {transform_lambda})"
+        Lambdas capture by reference so element expressions may use locals. Tuple
+        targets (zip, enumerate, dict.items()) bind the pair members by name, since
+        C++17 lambdas cannot take structured bindings as parameters.
+        """
+        if isinstance(target, ast.Tuple) and len(target.elts) == 2:
+            first = target.elts[0].id if isinstance(target.elts[0], ast.Name) else "k"
+            second = target.elts[1].id if isinstance(target.elts[1], ast.Name) else "v"
+            return (
+                f"[&](const auto& __pair) {{ const auto& {first} = __pair.first; "
+                f"const auto& {second} = __pair.second; return {body}; }}"
+            )
+        target_name = target.id if isinstance(target, ast.Name) else "x"
+        return f"[&](auto {target_name}) {{ return {body}; }}"
+
+    def _comprehension_condition(self, generator: ast.comprehension) -> Optional[str]:
+        """Build the filter lambda of a comprehension, or None if it has no conditions."""
+        if not generator.ifs:
+            return None
+        conditions = [self._convert_expression(cond) for cond in generator.ifs]
+        body = conditions[0] if len(conditions) == 1 else " && ".join(f"({c})" for c in conditions)
+        return self._comprehension_lambda(generator.target, body)
+
+    def _convert_comprehension_source(self, iter_expr: ast.expr) -> str:
+        """Convert the iterable of a comprehension or for loop.
+
+        A list comprehension in this position is consumed exactly once, so it is
+        emitted as a lazy view and fused into the consuming loop instead of being
+        materialized. range(), zip() and enumerate() map onto the runtime's
+        Range, zip and enumerate adaptors through the ordinary call conversion.
+        """
+        if isinstance(iter_expr, (ast.ListComp, ast.GeneratorExp)) and len(iter_expr.generators) == 1:
+            return self._convert_comprehension_view(iter_expr)
+        return self._convert_expression(iter_expr)
+
+    def _convert_comprehension_view(self, expr: Union[ast.ListComp, ast.GeneratorExp]) -> str:
+        """Convert a single-generator list comprehension or generator expression to map_view/filter_view."""
+        generator = expr.generators[0]
+        source = self._convert_comprehension_source(generator.iter)
+        condition_lambda = self._comprehension_condition(generator)
+        if condition_lambda:
+            source = f"filter_view({source}, {condition_lambda})"
+        if isinstance(expr.elt, ast.Name) and isinstance(generator.target, ast.Name) and expr.elt.id == generator.target.id:
+            # [x for x in src if ...] yields the (filtered) source unchanged
+            return source
+        transform_lambda = self._comprehension_lambda(generator.target, self._convert_expression(expr.elt))
+        return f"map_view({source}, {transform_lambda})"
+
+    def _convert_list_comprehension(self, expr: ast.ListComp, small_capacity: Optional[int] = None) -> str:
+        """Convert list comprehensions using STL and runtime helpers.
+
+        With small_capacity the result is collected into an mgen::SmallVector of
+        that inline capacity (the comprehension has no condition).
+        """
+        generator = expr.generators[0]
+        source = self._convert_comprehension_source(generator.iter)
+        transform_lambda = self._comprehension_lambda(generator.target, self._convert_expression(expr.elt))
+        condition_lambda = self._comprehension_condition(generator)
+
+        # Element and condition run concurrently on the pool, so they must not have side effects
+        helper = "list_comprehension"
+        if small_capacity is not None:
+            helper = f"small_list_comprehension<{small_capacity}>"
+        elif self.preferences.get("parallel", False) and self._is_side_effect_free(expr):
+            helper = "parallel_list_comprehension"
+
+        if condition_lambda:
+            return f"{helper}({source}, {transform_lambda}, {condition_lambda})"
+        return f"{helper}({source}, {transform_lambda})"
+
+    # Built-ins and string methods that only read their arguments
+    PURE_BUILTINS = frozenset(
+        {"abs", "min", "max", "len", "int", "float", "str", "bool", "sum", "any", "all", "round", "range", "zip", "enumerate"}
+    )
+    PURE_STRING_METHODS = frozenset({"upper", "lower", "strip", "find", "replace", "split"})
+
+    def _is_side_effect_free(self, expr: ast.expr) -> bool:
+        """Check that evaluating expr calls nothing but pure built-ins and string methods."""
+        for node in ast.walk(expr):
+            if isinstance(node, (ast.NamedExpr, ast.Await, ast.Yield, ast.YieldFrom)):
+                return False
+            if isinstance(node, ast.Call):
+                if isinstance(node.func, ast.Name) and node.func.id in self.PURE_BUILTINS:
+                    continue
+                if isinstance(node.func, ast.Attribute) and node.func.attr in self.PURE_STRING_METHODS:
+                    continue
+                return False
+        return True
 
     def _convert_dict_comprehension(self, expr: ast.DictComp) -> str:
         """Convert dictionary comprehensions using STL and runtime helpers."""
-        # Extract comprehension components
-        key_expr = expr.key
-        value_expr = expr.value
-        target = expr.generators[0].target
-        iter_expr = expr.generators[0].iter
-        conditions = expr.generators[0].ifs
-
-        if isinstance(iter_expr, ast.Call) and isinstance(iter_expr.func, ast.Name) and iter_expr.func.id == "range":
-            # Range-based comprehension
-            range_args = [self._convert_expression(arg) for arg in iter_expr.args]
-            range_call = f"Range({', '.join(range_args)})"
+        generator = expr.generators[0]
+        source = self._convert_comprehension_source(generator.iter)
+        pair_expr = f"std::make_pair({self._convert_expression(expr.key)}, {self._convert_expression(expr.value)})"
+        key_val_lambda = self._comprehension_lambda(generator.target, pair_expr)
+        condition_lambda = self._comprehension_condition(generator)
 
-            # Create lambda for key-value pairs
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-            key_val_lambda = f"[](auto {target_name}) {{ return std::make_pair({self._convert_expression(key_expr)}, {self._convert_expression(value_expr)}); }}"
-
-            if conditions:
-                # With condition
-                condition_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(conditions[0])}; }}"
-                return f"dict_comprehension({range_call}, {key_val_lambda}, {condition_lambda})"
-            else:
-                # No condition
-                return f"dict_comprehension({range_call}, {key_val_lambda})"
-        else:
-            # Container iteration (like iterating over a vector or map.items())
-            container_expr = self._convert_expression(iter_expr)
-
-            # Check if target is a tuple (e.g., for k, v in dict.items())
-            if isinstance(target, ast.Tuple) and len(target.elts) == 2:
-                # Tuple unpacking for pairs - use temporary pair and .first/.second
-                # Note: C++17 doesn't support structured bindings in lambda parameters
-                k_name = target.elts[0].id if isinstance(target.elts[0], ast.Name) else "k"
-                v_name = target.elts[1].id if isinstance(target.elts[1], ast.Name) else "v"
-                # Use pair.first and pair.second instead of structured bindings
-                key_val_lambda = f"[](const auto& __pair) {{ const auto& {k_name} = __pair.first; const auto& {v_name} = __pair.second; return std::make_pair({self._convert_expression(key_expr)}, {self._convert_expression(value_expr)}); }}"
-
-                if conditions:
-                    condition_lambda = f"[](const auto& __pair) {{ const auto& {k_name} = __pair.first; const auto& {v_name} = __pair.second; return {self._convert_expression(conditions[0])}; }}"
-                    return f"dict_comprehension({container_expr}, {key_val_lambda}, {condition_lambda})"
-                else:
-                    return f"dict_comprehension({container_expr}, {key_val_lambda})"
-            else:
-                # Simple target
-                target_name = target.id if isinstance(target, ast.Name) else "x"
-                key_val_lambda = f"[](auto {target_name}) {{ return std::make_pair({self._convert_expression(key_expr)}, {self._convert_expression(value_expr)}); }}"
-
-                if conditions:
-                    condition_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(conditions[0])}; }}"
-                    return f"dict_comprehension({container_expr}, {key_val_lambda}, {condition_lambda})"
-                else:
-                    return f"dict_comprehension({container_expr}, {key_val_lambda})"
+        if condition_lambda:
+            return f"dict_comprehension({source}, {key_val_lambda}, {condition_lambda})"
+        return f"dict_comprehension({source}, {key_val_lambda})"
 
     def _convert_set_comprehension(self, expr: ast.SetComp) -> str:
         """Convert set comprehensions using STL and runtime helpers."""
-        # Extract comprehension components
-        element_expr = expr.elt
-        target = expr.generators[0].target
-        iter_expr = expr.generators[0].iter
-        conditions = expr.generators[0].ifs
-
-        if isinstance(iter_expr, ast.Call) and isinstance(iter_expr.func, ast.Name) and iter_expr.func.id == "range":
-            # Range-based comprehension
-            range_args = [self._convert_expression(arg) for arg in iter_expr.args]
-            range_call = f"Range({', '.join(range_args)})"
-
-            # Create lambda for transformation
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-            transform_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(element_expr)}; }}"
+        generator = expr.generators[0]
+        source = self._convert_comprehension_source(generator.iter)
+        transform_lambda = self._comprehension_lambda(generator.target, self._convert_expression(expr.elt))
+        condition_lambda = self._comprehension_condition(generator)
 
-            if conditions:
-                # With condition
-                condition_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(conditions[0])}; }}"
-                return f"set_comprehension({range_call}, {transform_lambda}, {condition_lambda})"
-            else:
-                # No condition
-                return f"set_comprehension({range_call}, {transform_lambda})"
-        else:
-            # Container iteration (like iterating over a vector)
-            container_expr = self._convert_expression(iter_expr)
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-            transform_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(element_expr)}; }}"
-
-            if conditions:
-                condition_lambda = f"[](auto {target_name}) {{ return {self._convert_expression(conditions[0])}; }}"
-                return f"set_comprehension({container_expr}, {transform_lambda}, {condition_lambda})"
-            else:
-                return f"set_comprehension({container_expr}, {transform_lambda})"
+        if condition_lambda:
+            return f"set_comprehension({source}, {transform_lambda}, {condition_lambda})"
+        return f"set_comprehension({source}, {transform_lambda})"
 
     def _convert_list_literal(self, expr: ast.List) -> str:
         """Convert list literal to C++ initializer list."""
@@ -1505,75 +2181,118 @@ class MGenPythonToCppConverter:
             raise UnsupportedFeatureError("Slice operations not supported in C++ backend")
         else:
             # Simple subscript
+            position = self._tuple_position(expr)
+            if position is not None:
+                return f"std::get<{position}>({value_expr})"
             index_expr = self._convert_expression(expr.slice)
+            if self._is_constant_str_dict(expr.value):
+                match, _ = self.constant_str_dicts[cast(ast.Name, expr.value).id]
+                return f"{match.replace('match', 'table')}_at({index_expr})"
             return f"{value_expr}[{index_expr}]"
 
+    def _tuple_type_of(self, expr: ast.expr) -> Optional[str]:
+        """std::tuple<...> type of a tuple variable or of a call to a function returning one, else None."""
+        if isinstance(expr, ast.Name):
+            c_type = self.variable_context.get(expr.id, "")
+        elif (
+            isinstance(expr, ast.Call)
+            and isinstance(expr.func, ast.Name)
+            and expr.func.id in self.function_signatures
+        ):
+            c_type = self.function_signatures[expr.func.id][1]
+        else:
+            return None
+        return c_type if c_type.startswith("std::tuple<") else None
+
+    def _tuple_position(self, expr: ast.Subscript) -> Optional[int]:
+        """Element index of t[i] with t a std::tuple and i a constant (negative counts from the end)."""
+        tuple_type = self._tuple_type_of(expr.value)
+        index = expr.slice
+        negate = isinstance(index, ast.UnaryOp) and isinstance(index.op, ast.USub)
+        if negate:
+            index = index.operand  # type: ignore[attr-defined]
+        if tuple_type is None or not (isinstance(index, ast.Constant) and type(index.value) is int):
+            return None
+        arity = len(self._split_template_arguments(tuple_type[len("std::tuple<") : -1]))
+        position = -index.value if negate else index.value
+        if not -arity <= position < arity:
+            raise UnsupportedFeatureError(f"Tuple index {position} out of range for {arity} elements")
+        return position % arity
+
+    @staticmethod
+    def _split_template_arguments(arguments: str) -> list[str]:
+        """Split "int, std::tuple<int, int>" at its top-level commas."""
+        parts, depth, start = [], 0, 0
+        for i, char in enumerate(arguments):
+            depth += {"<": 1, ">": -1}.get(char, 0)
+            if char == "," and depth == 0:
+                parts.append(arguments[start:i].strip())
+                start = i + 1
+        parts.append(arguments[start:].strip())
+        return parts
+
+    def _convert_tuple_assignment(self, target: ast.Tuple, value: ast.expr) -> str:
+        """a, b = ...: a structured binding for new names, std::tie for declared ones.
+
+        The right side is a std::tuple value (std::make_tuple of a display), so every value is
+        read before any name is stored and x, y = y, x swaps without a heap allocation.
+        """
+        if not all(isinstance(element, ast.Name) for element in target.elts):
+            raise UnsupportedFeatureError("Tuple unpacking is only supported into simple names")
+        names = [cast(ast.Name, element).id for element in target.elts]
+        value_expr = self._convert_expression(value)
+        declared = [name in self.variable_context for name in names]
+        if all(declared):
+            return f"        std::tie({', '.join(names)}) = {value_expr};"
+        tuple_type = self._tuple_type_of(value)
+        element_types = self._split_template_arguments(tuple_type[len("std::tuple<") : -1]) if tuple_type else []
+        if not any(declared):
+            for position, name in enumerate(names):
+                self.variable_context[name] = element_types[position] if position < len(element_types) else "auto"
+            return f"        auto [{', '.join(names)}] = {value_expr};"
+        # Some names are new: unpack through a temporary
+        temp = f"mgen_tuple_{len(self.variable_context)}"
+        statements = [f"        auto {temp} = {value_expr};"]
+        for position, name in enumerate(names):
+            element = f"std::get<{position}>({temp})"
+            if name in self.variable_context:
+                statements.append(f"        {name} = {element};")
+            else:
+                self.variable_context[name] = "auto"
+                statements.append(f"        auto {name} = {element};")
+        return "\n".join(statements)
+
+    def _is_constant_str_dict(self, expr: ast.expr) -> bool:
+        """Check whether an expression names a dict _plan_constant_str_dicts made a static table."""
+        return isinstance(expr, ast.Name) and expr.id in self.constant_str_dicts
+
     def _convert_f_string(self, expr: ast.JoinedStr) -> str:
-        """Convert f-string to C++ string concatenation.
+        """Convert f-string to a single mgen::format() call.
+
+        mgen::format writes every piece into one preallocated string, formatting
+        numbers with std::to_chars as Python's str() would.
 
         Example:
-            f"Result: {x}" -> ("Result: " + std::to_string(x))
-            f"Count: {len(items)} items" -> ("Count: " + std::to_string(mgen::len(items)) + " items")
+            f"Result: {x}" -> mgen::format("Result: ", x)
+            f"Count: {len(items)} items" -> mgen::format("Count: ", mgen::len(items), " items")
         """
         parts: list[str] = []
+        has_expression = False
         for value in expr.values:
             if isinstance(value, ast.Constant):
                 # Literal string part
                 if isinstance(value.value, str):
-                    parts.append(f'"{value.value}"')
+                    parts.append(self._convert_constant(value))
             elif isinstance(value, ast.FormattedValue):
-                # Expression to be converted to string
-                expr_code = self._convert_expression(value.value)
-                parts.append(self._to_string_cpp(expr_code, value.value))
+                parts.append(self._convert_expression(value.value))
+                has_expression = True
 
         if len(parts) == 0:
             return '""'
-        elif len(parts) == 1:
+        elif not has_expression:
             return parts[0]
         else:
-            return "(" + " + ".join(parts) + ")"
-
-    def _to_string_cpp(self, expr_code: str, expr_node: ast.expr) -> str:
-        """Convert an expression to string in C++.
-
-        Args:
-            expr_code: The C++ code for the expression
-            expr_node: The original AST node (for type inference)
-
-        Returns:
-            C++ code that converts the expression to a string
-        """
-        # Try to infer the type of the expression
-        # For simple names, check variable context
-        if isinstance(expr_node, ast.Name):
-            var_name = expr_node.id
-            if var_name in self.variable_context:
-                cpp_type = self.variable_context[var_name]
-                if cpp_type == "std::string":
-                    return expr_code  # Already a string
-                elif cpp_type == "bool":
-                    # Convert bool to string ("true" or "false")
-                    return f'({expr_code} ? "true" : "false")'
-
-        # Check if it's already a string literal
-        if isinstance(expr_node, ast.Constant) and isinstance(expr_node.value, str):
-            return expr_code  # Already a string
-
-        # For boolean values
-        if isinstance(expr_node, ast.Constant) and isinstance(expr_node.value, bool):
-            # Convert bool to string ("true" or "false")
-            return f'({expr_code} ? "true" : "false")'
-
-        # Check for string method calls or operations that return strings
-        if isinstance(expr_node, ast.Call):
-            if isinstance(expr_node.func, ast.Attribute):
-                # String methods return strings
-                attr_name = expr_node.func.attr
-                if attr_name in {"lower", "upper", "strip", "replace", "join"}:
-                    return expr_code  # Already returns string
-
-        # Default: use std::to_string for numbers
-        return f"std::to_string({expr_code})"
+            return f"mgen::format({', '.join(parts)})"
 
     def _convert_statements(self, statements: list[ast.stmt]) -> str:
         """Convert multiple statements."""
@@ -1640,6 +2359,507 @@ class MGenPythonToCppConverter:
             return self._convert_type_annotation(arg.annotation)
         return "auto"
 
+    def _analyze_single_use_comprehensions(self, stmts: list[ast.stmt], params: set[str]) -> set[str]:
+        """Find locals assigned a list comprehension whose only use is iterating it once.
+
+        Such a local can be bound to a lazy view and fused into its consumer. The
+        single use must be the iterable of a for loop, a comprehension or a
+        sum()/any()/all() call in the statement right after the assignment, and that
+        statement must not rebind or call methods on anything the comprehension
+        reads, so the view sees the same data the vector would have held.
+        """
+        name_counts: dict[str, int] = {}
+        for stmt in stmts:
+            for node in ast.walk(stmt):
+                if isinstance(node, ast.Name):
+                    name_counts[node.id] = name_counts.get(node.id, 0) + 1
+
+        def iterated_names(stmt: ast.stmt) -> set[str]:
+            names: set[str] = set()
+            for node in ast.walk(stmt):
+                if isinstance(node, (ast.For, ast.comprehension)) and isinstance(node.iter, ast.Name):
+                    names.add(node.iter.id)
+                elif (
+                    isinstance(node, ast.Call)
+                    and isinstance(node.func, ast.Name)
+                    and node.func.id in ("sum", "any", "all")
+                    and len(node.args) == 1
+                    and isinstance(node.args[0], ast.Name)
+                ):
+                    names.add(node.args[0].id)
+            return names
+
+        def mutated_names(stmt: ast.stmt) -> set[str]:
+            names: set[str] = set()
+            for node in ast.walk(stmt):
+                if isinstance(node, ast.Name) and not isinstance(node.ctx, ast.Load):
+                    names.add(node.id)
+                elif isinstance(node, ast.Subscript) and not isinstance(node.ctx, ast.Load):
+                    if isinstance(node.value, ast.Name):
+                        names.add(node.value.id)
+                elif isinstance(node, ast.Call) and isinstance(node.func, ast.Attribute):
+                    if isinstance(node.func.value, ast.Name):
+                        names.add(node.func.value.id)
+            return names
+
+        single_use: set[str] = set()
+
+        def analyze_stmts(stmts: list[ast.stmt]) -> None:
+            for index, stmt in enumerate(stmts):
+                # Recursively analyze nested statements (loops, ifs, etc.)
+                if isinstance(stmt, (ast.For, ast.While, ast.If)):
+                    analyze_stmts(stmt.body)
+                    analyze_stmts(stmt.orelse)
+                    continue
+
+                if isinstance(stmt, ast.Assign) and len(stmt.targets) == 1:
+                    target = stmt.targets[0]
+                elif isinstance(stmt, ast.AnnAssign) and stmt.value is not None:
+                    target = stmt.target
+                else:
+                    continue
+                value = stmt.value
+                if not (
+                    isinstance(target, ast.Name)
+                    and isinstance(value, ast.ListComp)
+                    and len(value.generators) == 1
+                    and target.id not in params
+                    and index + 1 < len(stmts)
+                ):
+                    continue
+
+                comprehension_names = {node.id for node in ast.walk(value) if isinstance(node, ast.Name)}
+                consumer = stmts[index + 1]
+                if (
+                    target.id not in comprehension_names
+                    and target.id not in self.constant_tables
+                    and name_counts.get(target.id, 0) == 2
+                    and target.id in iterated_names(consumer)
+                    and not (comprehension_names & mutated_names(consumer))
+                ):
+                    single_use.add(target.id)
+
+        analyze_stmts(stmts)
+        return single_use
+
+    def _analyze_last_uses(self, stmts: list[ast.stmt], params: set[str]) -> set[int]:
+        """Find uses of locals after which the local is dead, so the value can be moved.
+
+        Only uses that hand the whole value over are candidates: an argument of a
+        user function call, of append() or add(), or the right-hand side of a plain
+        assignment. Backward liveness over the function body (loops iterated to a
+        fixpoint, break and continue jumping to the loop exit and head) decides
+        whether the local is read again. Returned values are left alone, since C++
+        already moves a returned local.
+        """
+        global_names: set[str] = set()
+        local_names = set(params)
+        for stmt in stmts:
+            for node in ast.walk(stmt):
+                if isinstance(node, ast.Global):
+                    global_names.update(node.names)
+                elif isinstance(node, ast.Name) and isinstance(node.ctx, ast.Store):
+                    local_names.add(node.id)
+        local_names -= global_names
+
+        def reads(node: Optional[ast.AST]) -> set[str]:
+            if node is None:
+                return set()
+            return {n.id for n in ast.walk(node) if isinstance(n, ast.Name) and isinstance(n.ctx, ast.Load)}
+
+        def bound_names(target: ast.expr) -> set[str]:
+            if isinstance(target, ast.Name):
+                return {target.id}
+            if isinstance(target, ast.Tuple):
+                return {elt.id for elt in target.elts if isinstance(elt, ast.Name)}
+            return set()
+
+        def candidates(stmt: ast.stmt) -> list[ast.Name]:
+            value = getattr(stmt, "value", None)
+            if isinstance(stmt, (ast.Assign, ast.AnnAssign)) and isinstance(value, ast.Name):
+                return [value]
+            if not isinstance(stmt, (ast.Expr, ast.Assign, ast.AnnAssign, ast.Return)) or not isinstance(value, ast.Call):
+                return []
+            func = value.func
+            if isinstance(func, ast.Attribute) and func.attr in ("append", "add"):
+                return [arg for arg in value.args if isinstance(arg, ast.Name)]
+            if isinstance(func, ast.Name) and not hasattr(builtins, func.id):
+                # Arguments bound to const& parameters are not copied in the first place
+                borrowed = self.borrowed_params.get(func.id, set())
+                return [arg for i, arg in enumerate(value.args) if isinstance(arg, ast.Name) and i not in borrowed]
+            return []
+
+        moves: set[int] = set()
+
+        def visit_block(block: list[ast.stmt], live: set[str], jumps: Optional[tuple[set[str], set[str]]], mark: bool) -> set[str]:
+            for stmt in reversed(block):
+                live = visit(stmt, live, jumps, mark)
+            return live
+
+        def visit_loop(stmt: ast.stmt, live_after: set[str], mark: bool) -> set[str]:
+            exit_live = live_after | visit_block(stmt.orelse, live_after, None, mark)
+            if isinstance(stmt, ast.For):
+                targets = bound_names(stmt.target)
+                # The loop walks the iterable in place, so it stays live throughout
+                always_live = exit_live | reads(stmt.iter)
+            else:
+                targets = set()
+                always_live = exit_live | reads(stmt.test)
+            head = set(always_live)
+            while True:
+                body_in = visit_block(stmt.body, head, (live_after, head), False)
+                new_head = always_live | (body_in - targets)
+                if new_head == head:
+                    break
+                head = new_head
+            if mark:
+                visit_block(stmt.body, head, (live_after, head), True)
+            return head
+
+        def visit(stmt: ast.stmt, live_after: set[str], jumps: Optional[tuple[set[str], set[str]]], mark: bool) -> set[str]:
+            if isinstance(stmt, ast.If):
+                return (
+                    visit_block(stmt.body, live_after, jumps, mark)
+                    | visit_block(stmt.orelse, live_after, jumps, mark)
+                    | reads(stmt.test)
+                )
+            if isinstance(stmt, (ast.For, ast.While)):
+                return visit_loop(stmt, live_after, mark)
+            if isinstance(stmt, ast.Break):
+                return set(jumps[0]) if jumps else set(live_after)
+            if isinstance(stmt, ast.Continue):
+                return set(jumps[1]) if jumps else set(live_after)
+            if not isinstance(stmt, (ast.Expr, ast.Assign, ast.AnnAssign, ast.AugAssign, ast.Return)):
+                # Anything else is treated as reading every name it mentions
+                return live_after | {n.id for n in ast.walk(stmt) if isinstance(n, ast.Name)}
+
+            if isinstance(stmt, ast.Return):
+                live_after = set()
+            defs: set[str] = set()
+            if isinstance(stmt, ast.Assign):
+                for target in stmt.targets:
+                    defs |= bound_names(target)
+            elif isinstance(stmt, ast.AnnAssign) and stmt.value is not None:
+                defs = bound_names(stmt.target)
+            stmt_reads = reads(stmt)
+            if isinstance(stmt, ast.AugAssign):
+                stmt_reads |= bound_names(stmt.target)
+
+            if mark:
+                for name in candidates(stmt):
+                    uses = sum(1 for n in ast.walk(stmt) if isinstance(n, ast.Name) and n.id == name.id)
+                    if name.id in local_names and name.id not in live_after and uses == 1:
+                        moves.add(id(name))
+            return (live_after - defs) | stmt_reads
+
+        visit_block(stmts, set(), None, True)
+        return moves
+
+    def _is_movable_type(self, cpp_type: str) -> bool:
+        """Check whether moving a value of this type saves a copy (containers and strings)."""
+        return cpp_type.startswith(("std::vector<", "std::unordered_map<", "std::unordered_set<", "std::string"))
+
+    def _analyze_borrowed_params(self, tree: ast.Module) -> dict[str, set[int]]:
+        """Find the parameter positions of module functions emitted as const&.
+
+        These are the borrowable parameters of the immutability analysis (only read
+        in place, never returned or stored) whose type is a vector, set or string.
+        Maps keep value semantics, since reads through operator[] need a mutable map.
+        """
+        borrowable = ImmutabilityAnalyzer().borrowable_parameters(tree)
+        return {
+            func.name: {
+                position
+                for position, arg in enumerate(func.args.args)
+                if arg.arg in borrowable.get(func.name, set())
+                and self._get_param_type(arg).startswith(("std::vector<", "std::unordered_set<", "std::string"))
+            }
+            for func in tree.body
+            if isinstance(func, ast.FunctionDef)
+        }
+
+    # Largest list kept in SmallVector inline storage
+    SMALL_LIST_MAX_INLINE = 8
+    # Built-ins that only read a list argument in place
+    SMALL_LIST_READERS = frozenset({"len", "sum", "min", "max", "any", "all"})
+
+    def _analyze_small_lists(self, stmts: list[ast.stmt], params: set[str]) -> dict[str, int]:
+        """Find list locals whose size is a small constant, mapped to that size.
+
+        A candidate is assigned exactly once, from a list literal of at most
+        SMALL_LIST_MAX_INLINE elements or an unfiltered comprehension over range(k)
+        or over another such list. Every other use must read it in place (indexing,
+        element stores, iteration, len()/sum()/min()/max()/any()/all()), so the
+        SmallVector type never meets code expecting a std::vector: lists that are
+        returned, passed to functions, stored in containers or grown keep the
+        std::vector type.
+        """
+        store_counts, global_names = self._local_binding_counts(stmts)
+        small: dict[str, int] = {}
+
+        def fixed_size(value: ast.expr) -> Optional[int]:
+            if isinstance(value, ast.List):
+                if any(isinstance(elt, ast.Starred) for elt in value.elts):
+                    return None
+                return len(value.elts)
+            if not (isinstance(value, ast.ListComp) and len(value.generators) == 1):
+                return None
+            generator = value.generators[0]
+            if generator.ifs or generator.is_async:
+                return None
+            source = generator.iter
+            if isinstance(source, ast.Name):
+                return small.get(source.id)
+            if isinstance(source, ast.List):
+                return fixed_size(source)
+            if isinstance(source, ast.Call) and isinstance(source.func, ast.Name) and source.func.id == "range":
+                bounds = [self._constant_int_value(arg) for arg in source.args]
+                if len(bounds) == 1 and bounds[0] is not None:
+                    return max(bounds[0], 0)
+                if len(bounds) == 2 and bounds[0] is not None and bounds[1] is not None:
+                    return max(bounds[1] - bounds[0], 0)
+            return None
+
+        for stmt in stmts:
+            for node in ast.walk(stmt):
+                if isinstance(node, ast.Assign) and len(node.targets) == 1:
+                    target = node.targets[0]
+                elif isinstance(node, ast.AnnAssign) and node.value is not None:
+                    target = node.target
+                else:
+                    continue
+                if not isinstance(target, ast.Name) or target.id in params or target.id in global_names:
+                    continue
+                if store_counts.get(target.id, 0) != 1 or target.id in self.single_use_views:
+                    continue
+                if target.id in self.constant_tables:
+                    continue
+                size = fixed_size(node.value)
+                if size is None or not 1 <= size <= self.SMALL_LIST_MAX_INLINE:
+                    continue
+                if self._list_used_in_place(stmts, target.id, allow_stores=True):
+                    small[target.id] = size
+
+        return small
+
+    # Element types of narrowed int lists, by (bits, signed)
+    NARROW_ELEMENT_TYPES = {(8, False): "uint8_t", (8, True): "int8_t", (16, False): "uint16_t", (16, True): "int16_t"}
+
+    def _analyze_narrow_lists(self, func: ast.FunctionDef) -> dict[str, str]:
+        """Find int list locals whose elements fit in 8 or 16 bits, mapped to that type.
+
+        The value-range analysis bounds every element a list local may hold. A
+        std::vector<int> local bound once, to a list literal, is stored with the
+        narrowest element type holding that range when every use keeps the
+        element type out of sight (_narrow_list_used_in_place), so the vector is
+        denser and nothing computes in the narrow type. Lists whose range is not
+        proven keep int elements.
+        """
+        params = {arg.arg for arg in func.args.args}
+        store_counts, global_names = self._local_binding_counts(func.body)
+        ranges = ValueRangeAnalyzer().analyze_function(func)
+        narrow: dict[str, str] = {}
+        for stmt in func.body:
+            for node in ast.walk(stmt):
+                if isinstance(node, ast.Assign) and len(node.targets) == 1:
+                    target = node.targets[0]
+                elif isinstance(node, ast.AnnAssign) and node.value is not None:
+                    target = node.target
+                else:
+                    continue
+                if not isinstance(target, ast.Name) or target.id in params or target.id in global_names:
+                    continue
+                name = target.id
+                if store_counts.get(name, 0) != 1 or name in self.small_lists or name in self.constant_tables:
+                    continue
+                if name in self.single_use_views or self.variable_context.get(name) != "std::vector<int>":
+                    continue
+                if not isinstance(node.value, ast.List) or any(isinstance(elt, ast.Starred) for elt in node.value.elts):
+                    continue
+                element_range = ranges.elements.get(name)
+                width = element_range.narrowest_integer_width() if element_range is not None else None
+                if width in self.NARROW_ELEMENT_TYPES and self._narrow_list_used_in_place(func.body, name):
+                    narrow[name] = self.NARROW_ELEMENT_TYPES[width]
+        return narrow
+
+    def _narrow_list_used_in_place(self, stmts: list[ast.stmt], name: str) -> bool:
+        """Check that no use of a list local depends on its element type.
+
+        Allowed uses are append(), len(), for loops (which bind an int) and
+        element stores and reads. An element read must be an operand of
+        arithmetic or a comparison, an index, a returned or stored value, or a
+        print() argument: each converts it to int.
+        """
+        parents: dict[int, ast.AST] = {}
+        uses: list[ast.Name] = []
+        for stmt in stmts:
+            for node in ast.walk(stmt):
+                for child in ast.iter_child_nodes(node):
+                    parents[id(child)] = node
+                if isinstance(node, ast.Name) and node.id == name and isinstance(node.ctx, ast.Load):
+                    uses.append(node)
+
+        for use in uses:
+            parent = parents.get(id(use))
+            if isinstance(parent, ast.Subscript) and parent.value is use and not isinstance(parent.slice, ast.Slice):
+                if isinstance(parent.ctx, ast.Store):
+                    continue
+                if not isinstance(parent.ctx, ast.Load) or not self._converts_element(parent, parents.get(id(parent))):
+                    return False
+            elif isinstance(parent, ast.Attribute) and parent.attr == "append":
+                call = parents.get(id(parent))
+                if not (isinstance(call, ast.Call) and call.func is parent and len(call.args) == 1):
+                    return False
+            elif isinstance(parent, ast.For):
+                if parent.iter is not use:
+                    return False
+            elif not (
+                isinstance(parent, ast.Call)
+                and isinstance(parent.func, ast.Name)
+                and parent.func.id == "len"
+                and parent.args == [use]
+            ):
+                return False
+        return True
+
+    def _converts_element(self, read: ast.Subscript, parent: Optional[ast.AST]) -> bool:
+        """Whether the context of an element read converts it to int."""
+        if isinstance(parent, (ast.BinOp, ast.UnaryOp, ast.Return)):
+            return True
+        if isinstance(parent, ast.Compare):
+            return not any(isinstance(op, (ast.In, ast.NotIn, ast.Is, ast.IsNot)) for op in parent.ops)
+        if isinstance(parent, ast.Subscript):
+            return parent.slice is read
+        if isinstance(parent, ast.AugAssign):
+            return parent.value is read
+        if isinstance(parent, ast.AnnAssign):
+            return parent.value is read and isinstance(parent.target, ast.Name)
+        if isinstance(parent, ast.Assign):
+            # A new local would be declared auto, so only element stores qualify
+            return parent.value is read and all(isinstance(target, ast.Subscript) for target in parent.targets)
+        return isinstance(parent, ast.Call) and isinstance(parent.func, ast.Name) and parent.func.id == "print"
+
+    def _reads_narrow_element(self, expr: ast.expr) -> bool:
+        """Check whether an expression reads an element of a narrowed list."""
+        return (
+            isinstance(expr, ast.Subscript)
+            and isinstance(expr.value, ast.Name)
+            and expr.value.id in self.narrow_lists
+        )
+
+    def _local_binding_counts(self, stmts: list[ast.stmt]) -> tuple[dict[str, int], set[str]]:
+        """Count the bindings of each name in a function body, and collect its global/nonlocal names."""
+        store_counts: dict[str, int] = {}
+        global_names: set[str] = set()
+        for stmt in stmts:
+            for node in ast.walk(stmt):
+                if isinstance(node, ast.Name) and isinstance(node.ctx, ast.Store):
+                    store_counts[node.id] = store_counts.get(node.id, 0) + 1
+                elif isinstance(node, (ast.Global, ast.Nonlocal)):
+                    global_names.update(node.names)
+        return store_counts, global_names
+
+    def _list_used_in_place(self, stmts: list[ast.stmt], name: str, allow_stores: bool) -> bool:
+        """Check that every read of a list local uses it in place.
+
+        In-place uses are indexing (and, with allow_stores, element stores),
+        iteration and the SMALL_LIST_READERS built-ins, none of which need the
+        local to be a std::vector.
+        """
+        parents: dict[int, ast.AST] = {}
+        uses: list[ast.Name] = []
+        for stmt in stmts:
+            for node in ast.walk(stmt):
+                for child in ast.iter_child_nodes(node):
+                    parents[id(child)] = node
+                if isinstance(node, ast.Name) and node.id == name and isinstance(node.ctx, ast.Load):
+                    uses.append(node)
+
+        for use in uses:
+            parent = parents.get(id(use))
+            if isinstance(parent, ast.Subscript):
+                if parent.value is not use or (not allow_stores and not isinstance(parent.ctx, ast.Load)):
+                    return False
+            elif isinstance(parent, (ast.For, ast.comprehension)):
+                if parent.iter is not use:
+                    return False
+            elif not (
+                isinstance(parent, ast.Call)
+                and isinstance(parent.func, ast.Name)
+                and parent.func.id in self.SMALL_LIST_READERS
+                and parent.args == [use]
+                and not parent.keywords
+            ):
+                return False
+        return True
+
+    # Largest comprehension folded into a constexpr table
+    CONSTANT_TABLE_MAX_ELEMENTS = 4096
+
+    def _analyze_constant_tables(self, stmts: list[ast.stmt], params: set[str]) -> dict[str, tuple[str, list[Any]]]:
+        """Find list locals bound to a comprehension that folds to constants.
+
+        The compile-time evaluator expands comprehensions over constant ranges or
+        literals (e.g. [i * i for i in range(256)]). A local assigned exactly
+        once, holding numbers only and read, but only in place (no element stores), is
+        emitted as a static constexpr std::array. Maps the name to its element
+        type and values.
+        """
+        store_counts, global_names = self._local_binding_counts(stmts)
+        read_names = {
+            node.id
+            for stmt in stmts
+            for node in ast.walk(stmt)
+            if isinstance(node, ast.Name) and isinstance(node.ctx, ast.Load)
+        }
+        tables: dict[str, tuple[str, list[Any]]] = {}
+        for stmt in stmts:
+            for node in ast.walk(stmt):
+                if isinstance(node, ast.Assign) and len(node.targets) == 1:
+                    target = node.targets[0]
+                elif isinstance(node, ast.AnnAssign) and node.value is not None:
+                    target = node.target
+                else:
+                    continue
+                if not (isinstance(target, ast.Name) and isinstance(node.value, ast.ListComp)):
+                    continue
+                if target.id in params or target.id in global_names or store_counts.get(target.id, 0) != 1:
+                    continue
+                if target.id not in read_names:
+                    continue
+                values = self.compile_time_evaluator.evaluate_list_comprehension(
+                    node.value, self.CONSTANT_TABLE_MAX_ELEMENTS
+                )
+                if not values:
+                    continue
+                element_type = self._constant_table_element_type(values)
+                if element_type in ("int", "long long") and self._is_float_list_annotation(node):
+                    element_type, values = "double", [float(value) for value in values]
+                if element_type and self._list_used_in_place(stmts, target.id, allow_stores=False):
+                    tables[target.id] = (element_type, values)
+        return tables
+
+    def _is_float_list_annotation(self, node: ast.stmt) -> bool:
+        """Check for an explicit list[float] annotation on an assignment."""
+        if not isinstance(node, ast.AnnAssign) or not isinstance(node.annotation, ast.Subscript):
+            return False
+        element = node.annotation.slice
+        return isinstance(element, ast.Name) and element.id == "float"
+
+    def _constant_table_element_type(self, values: list[Any]) -> Optional[str]:
+        """C++ element type holding every value exactly, or None for non-numeric tables."""
+        if all(isinstance(value, bool) for value in values):
+            return "bool"
+        if any(isinstance(value, bool) or not isinstance(value, (int, float)) for value in values):
+            return None
+        if any(isinstance(value, float) for value in values):
+            return "double" if all(math.isfinite(value) for value in values) else None
+        if all(-(2**31) <= value < 2**31 for value in values):
+            return "int"
+        if all(-(2**63) <= value < 2**63 for value in values):
+            return "long long"
+        return None
+
     def _analyze_append_operations(self, stmts: list[ast.stmt]) -> dict[str, str]:
         """Analyze append operations to detect what types are appended to containers.
 
@@ -1697,6 +2917,11 @@ class MGenPythonToCppConverter:
             elif base_type == "set":
                 element_type = self._convert_type_annotation(annotation.slice)
                 return f"std::unordered_set<{element_type}>"
+            elif base_type in ("tuple", "Tuple"):
+                # Fixed-arity tuples are values; tuple[int, ...] has no fixed type
+                elements = annotation.slice.elts if isinstance(annotation.slice, ast.Tuple) else [annotation.slice]
+                if not any(isinstance(element, ast.Constant) for element in elements):
+                    return f"std::tuple<{', '.join(self._convert_type_annotation(e) for e in elements)}>"
         return "auto"
 
     def _map_type(self, python_type: str) -> str:
@@ -1759,14 +2984,14 @@ class CppEmitter(AbstractEmitter):
         """Initialize the C++ emitter."""
         super().__init__(preferences)
         self.factory = CppFactory()
-        self.converter = MGenPythonToCppConverter()
+        self.converter = MGenPythonToCppConverter(preferences)
         self.indent_level = 0
         # Use preferences for indent size if available
         self.indent_size = preferences.get("indent_size", 4) if preferences else 4
 
     def emit_module(self, source_code: str, analysis_result: Optional[Any] = None) -> str:
         """Emit a complete C++ module from Python source."""
-        return self.converter.convert_code(source_code)
+        return self.converter.convert_code(source_code, self.source_file)
 
     def emit_statement(self, node: ast.stmt) -> str:
         """Emit a C++ statement from a Python AST node."""
@@ -35,14 +35,14 @@ class CppEmitter(AbstractEmitter):
         """Initialize the C++ emitter."""
         super().__init__(preferences)
         self.factory = CppFactory()
-        self.converter = MGenPythonToCppConverter()
+        self.converter = MGenPythonToCppConverter(preferences)
         self.indent_level = 0
         # Use preferences for indent size if available
         self.indent_size = preferences.get("indent_size", 4) if preferences else 4
 
     def emit_module(self, source_code: str, analysis_result: Optional[Any] = None) -> str:
         """Emit a complete C++ module from Python source."""
-        return self.converter.convert_code(source_code)
+        return self.converter.convert_code(source_code, self.source_file)
 
     def emit_statement(self, node: ast.stmt) -> str:
         """Emit a C++ statement from a Python AST node."""
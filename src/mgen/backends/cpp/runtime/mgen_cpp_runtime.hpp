@@ -10,17 +10,61 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
 #include <sstream>
 #include <cctype>
 #include <cmath>
 #include <stdexcept>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <functional>
+
+#ifdef MGEN_PARALLEL
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#endif
+
+#ifdef MGEN_PMR
+#include <memory_resource>
+#endif
+
+#ifdef MGEN_PYTHON_EXTENSION
+#include <exception>
+#endif
+
+#ifdef MGEN_INSTRUMENT
+#include <chrono>
+#include <mutex>
+#if defined(MGEN_INSTRUMENT_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace mgen {
 
@@ -43,6 +87,59 @@ public:
     explicit UnsupportedFeatureError(const std::string& msg) : MGenError("Unsupported feature: " + msg) {}
 };
 
+// ============================================================================
+// Memory Resources (opt-in: -DMGEN_PMR, the C++ "pmr_containers" preference)
+// ============================================================================
+
+// With MGEN_PMR, List, Dict and Set are the std::pmr containers. They allocate
+// from the default memory resource, which the runtime points at one global
+// pool at startup, so long-lived containers recycle blocks by size class.
+// A ScopedResource at the top of a function installs a monotonic arena (first
+// MGEN_PMR_SCOPE_BUFFER bytes on the stack, then chunks from the pool) for the
+// containers the function creates; they are released all at once when it
+// returns. The converter only emits one in functions whose containers cannot
+// outlive the call. The default resource is process-wide, so scoped arenas are
+// not used together with MGEN_PARALLEL.
+
+#ifdef MGEN_PMR
+#ifndef MGEN_PMR_SCOPE_BUFFER
+#define MGEN_PMR_SCOPE_BUFFER 1024
+#endif
+
+inline std::pmr::memory_resource* global_resource() {
+#ifdef MGEN_PARALLEL
+    static std::pmr::synchronized_pool_resource pool;
+#else
+    static std::pmr::unsynchronized_pool_resource pool;
+#endif
+    return &pool;
+}
+
+namespace detail {
+inline std::pmr::memory_resource* const installed_global_resource = std::pmr::set_default_resource(global_resource());
+}
+
+class ScopedResource {
+    alignas(std::max_align_t) unsigned char buffer_[MGEN_PMR_SCOPE_BUFFER];
+    std::pmr::monotonic_buffer_resource arena_;
+    std::pmr::memory_resource* previous_;
+
+public:
+    ScopedResource()
+        : arena_(buffer_, sizeof(buffer_), global_resource()), previous_(std::pmr::set_default_resource(&arena_)) {}
+    ~ScopedResource() { std::pmr::set_default_resource(previous_); }
+
+    ScopedResource(const ScopedResource&) = delete;
+    ScopedResource& operator=(const ScopedResource&) = delete;
+};
+
+template<typename T>
+using List = std::pmr::vector<T>;
+#else
+template<typename T>
+using List = std::vector<T>;
+#endif
+
 // ============================================================================
 // String Operations (Python str methods)
 // ============================================================================
@@ -62,15 +159,17 @@ public:
     }
 
     static std::string strip(const std::string& str) {
-        size_t start = str.find_first_not_of(" \t\n\r");
-        if (start == std::string::npos) return "";
-        size_t end = str.find_last_not_of(" \t\n\r");
-        return str.substr(start, end - start + 1);
+        return std::string(strip_view(str));
     }
 
     static std::string strip(const std::string& str, const std::string& chars) {
+        return std::string(strip_view(str, chars));
+    }
+
+    // strip() without copying: the view borrows str's characters
+    static std::string_view strip_view(std::string_view str, std::string_view chars = " \t\n\r") {
         size_t start = str.find_first_not_of(chars);
-        if (start == std::string::npos) return "";
+        if (start == std::string_view::npos) return std::string_view();
         size_t end = str.find_last_not_of(chars);
         return str.substr(start, end - start + 1);
     }
@@ -80,314 +179,2053 @@ public:
         return (pos == std::string::npos) ? -1 : static_cast<int>(pos);
     }
 
-    static std::string replace(const std::string& str, const std::string& old_str, const std::string& new_str) {
-        std::string result = str;
-        size_t pos = 0;
-        while ((pos = result.find(old_str, pos)) != std::string::npos) {
-            result.replace(pos, old_str.length(), new_str);
-            pos += new_str.length();
+    // Single pass: count the matches, size the result once, then copy the pieces
+    static std::string replace(std::string_view str, std::string_view old_str, std::string_view new_str) {
+        if (old_str.empty()) {
+            // Python inserts new_str before every character and at the end
+            std::string result;
+            result.reserve(str.size() + (str.size() + 1) * new_str.size());
+            for (char c : str) {
+                result.append(new_str);
+                result.push_back(c);
+            }
+            result.append(new_str);
+            return result;
+        }
+
+        size_t matches = 0;
+        for (size_t pos = str.find(old_str); pos != std::string_view::npos; pos = str.find(old_str, pos + old_str.size())) {
+            ++matches;
+        }
+        if (matches == 0) return std::string(str);
+
+        std::string result;
+        result.reserve(str.size() - matches * old_str.size() + matches * new_str.size());
+        size_t start = 0;
+        for (size_t pos = str.find(old_str); pos != std::string_view::npos; pos = str.find(old_str, start)) {
+            result.append(str, start, pos - start);
+            result.append(new_str);
+            start = pos + old_str.size();
         }
+        result.append(str, start, std::string_view::npos);
         return result;
     }
 
-    static std::vector<std::string> split(const std::string& str, const std::string& delimiter = " ") {
-        std::vector<std::string> result;
-        if (str.empty()) return result;
+    static List<std::string> split(const std::string& str, const std::string& delimiter = " ") {
+        List<std::string_view> pieces;
+        split_view(str, delimiter, pieces);
+        return List<std::string>(pieces.begin(), pieces.end());
+    }
+
+    // split() into views of str, reusing out's capacity across calls.
+    // An empty delimiter splits on runs of whitespace (Python's split()).
+    // out is any vector of string_view (std::vector or List).
+    template<typename Out>
+    static void split_view(std::string_view str, std::string_view delimiter, Out& out) {
+        out.clear();
+        if (str.empty()) return;
 
         if (delimiter.empty()) {
-            // Split on whitespace (Python default behavior)
-            std::stringstream ss(str);
-            std::string token;
-            while (ss >> token) {
-                result.push_back(token);
+            const char* whitespace = " \t\n\r\f\v";
+            size_t start = str.find_first_not_of(whitespace);
+            while (start != std::string_view::npos) {
+                size_t end = str.find_first_of(whitespace, start);
+                out.push_back(str.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start));
+                if (end == std::string_view::npos) break;
+                start = str.find_first_not_of(whitespace, end);
             }
         } else {
             size_t start = 0;
             size_t end = str.find(delimiter);
-            while (end != std::string::npos) {
-                result.push_back(str.substr(start, end - start));
-                start = end + delimiter.length();
+            while (end != std::string_view::npos) {
+                out.push_back(str.substr(start, end - start));
+                start = end + delimiter.size();
                 end = str.find(delimiter, start);
             }
-            result.push_back(str.substr(start));
+            out.push_back(str.substr(start));
         }
-        return result;
+    }
+
+    static std::vector<std::string_view> split_view(std::string_view str, std::string_view delimiter = " ") {
+        std::vector<std::string_view> out;
+        split_view(str, delimiter, out);
+        return out;
     }
 };
 
 // ============================================================================
-// Python Built-in Functions
+// String Formatting (f-strings and str())
 // ============================================================================
 
-template<typename T>
-T abs(T value) {
-    return std::abs(value);
+// format(args...) concatenates Python's str() of each argument: f"{n} items"
+// becomes format(n, " items"). Each argument first reports an upper bound on
+// its length, so the result is allocated once and numbers are written straight
+// into it with std::to_chars rather than through std::to_string or a stream.
+
+namespace detail {
+
+// Longest repr of a double, e.g. "-2.2250738585072014e-308"
+constexpr size_t float_repr_max = 24;
+
+// Shortest round-trip digits of a finite double in scientific form,
+// "[-]d[.ddd]e[+-]dd"; returns the end of the text in buf
+inline char* shortest_scientific(char* buf, char* last, double value) {
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(buf, last, value, std::chars_format::scientific).ptr;
+#else
+    // No floating-point to_chars: take the fewest digits that read back exactly
+    int written = 0;
+    for (int precision = 0; precision <= 16; ++precision) {
+        written = std::snprintf(buf, last - buf, "%.*e", precision, value);
+        if (std::strtod(buf, nullptr) == value) break;
+    }
+    return buf + written;
+#endif
 }
 
-template<typename Container>
-size_t len(const Container& container) {
-    return container.size();
+// Python's repr(float): fixed notation for exponents in [-4, 16), otherwise
+// d.ddde+XX; integral values keep a trailing ".0"
+inline char* write_float_repr(char* out, double value) {
+    if (std::isnan(value)) {
+        std::memcpy(out, "nan", 3);
+        return out + 3;
+    }
+    if (std::isinf(value)) {
+        if (value < 0) *out++ = '-';
+        std::memcpy(out, "inf", 3);
+        return out + 3;
+    }
+
+    char buf[32];
+    char* end = shortest_scientific(buf, buf + sizeof(buf), value);
+    const char* p = buf;
+    if (*p == '-') *out++ = *p++;
+    char digits[20] = {};
+    int count = 0;
+    for (; p != end && *p != 'e'; ++p) {
+        if (*p != '.') digits[count++] = *p;
+    }
+    int exponent = std::atoi(p + 1);
+
+    if (exponent >= -4 && exponent < 16) {
+        if (exponent < 0) {
+            *out++ = '0';
+            *out++ = '.';
+            for (int i = -1; i > exponent; --i) *out++ = '0';
+            std::memcpy(out, digits, count);
+            return out + count;
+        }
+        for (int i = 0; i <= exponent; ++i) *out++ = i < count ? digits[i] : '0';
+        *out++ = '.';
+        if (count > exponent + 1) {
+            std::memcpy(out, digits + exponent + 1, count - exponent - 1);
+            return out + count - exponent - 1;
+        }
+        *out++ = '0';
+        return out;
+    }
+
+    *out++ = digits[0];
+    if (count > 1) {
+        *out++ = '.';
+        std::memcpy(out, digits + 1, count - 1);
+        out += count - 1;
+    }
+    *out++ = 'e';
+    *out++ = exponent < 0 ? '-' : '+';
+    int magnitude = exponent < 0 ? -exponent : exponent;
+    if (magnitude < 10) *out++ = '0';
+    return std::to_chars(out, out + 3, magnitude).ptr;
 }
 
+// Strings become views (measured once); numbers and bools are kept as values
 template<typename T>
-bool bool_value(const T& value) {
-    if constexpr (std::is_arithmetic_v<T>) {
-        return value != 0;
-    } else if constexpr (std::is_same_v<T, std::string>) {
-        return !value.empty();
+auto format_piece(const T& value) {
+    if constexpr (std::is_same_v<T, bool> || std::is_arithmetic_v<T>) {
+        return value;
     } else {
-        return !value.empty();  // For containers
+        return std::string_view(value);
     }
 }
 
-template<typename Container>
-auto min(const Container& container) -> typename Container::value_type {
-    return *std::min_element(container.begin(), container.end());
+inline std::string_view format_piece(const char& value) {
+    return std::string_view(&value, 1);
 }
 
-template<typename Container>
-auto max(const Container& container) -> typename Container::value_type {
-    return *std::max_element(container.begin(), container.end());
+template<typename T>
+size_t format_size_bound(const T& piece) {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        return piece.size();
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return 5;
+    } else if constexpr (std::is_integral_v<T>) {
+        return std::numeric_limits<T>::digits10 + 2;
+    } else {
+        return float_repr_max;
+    }
 }
 
-template<typename Container>
-auto sum(const Container& container) -> typename Container::value_type {
-    using ValueType = typename Container::value_type;
-    ValueType result{};
-    for (const auto& item : container) {
-        result += item;
+template<typename T>
+char* format_write(char* out, const T& piece) {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        std::memcpy(out, piece.data(), piece.size());
+        return out + piece.size();
+    } else if constexpr (std::is_same_v<T, bool>) {
+        std::memcpy(out, piece ? "True" : "False", piece ? 4 : 5);
+        return out + (piece ? 4 : 5);
+    } else if constexpr (std::is_integral_v<T>) {
+        return std::to_chars(out, out + format_size_bound(piece), piece).ptr;
+    } else {
+        return write_float_repr(out, static_cast<double>(piece));
     }
+}
+
+template<typename... Pieces>
+std::string format_pieces(const Pieces&... pieces) {
+    std::string result;
+    result.resize((size_t{0} + ... + format_size_bound(pieces)));
+    char* out = result.data();
+    ((out = format_write(out, pieces)), ...);
+    result.resize(out - result.data());
     return result;
 }
 
-template<typename Container>
-bool any(const Container& container) {
-    for (const auto& item : container) {
-        if (bool_value(item)) {
-            return true;
+} // namespace detail
+
+template<typename... Args>
+std::string format(const Args&... args) {
+    return detail::format_pieces(detail::format_piece(args)...);
+}
+
+template<typename T>
+std::string str(const T& value) {
+    return format(value);
+}
+
+// ============================================================================
+// Standard Output (print())
+// ============================================================================
+
+// print(args...) formats Python's str() of each argument straight into one
+// MGEN_STDOUT_BUFFER_SIZE buffer, written with a single fwrite when it fills
+// up and at exit, instead of a stream insertion and an endl flush per line.
+// When stdout is a terminal every line is flushed, as Python does. The buffer
+// is not locked: only the main thread prints (parallel bodies are pure).
+
+#ifndef MGEN_STDOUT_BUFFER_SIZE
+#define MGEN_STDOUT_BUFFER_SIZE (64 * 1024)
+#endif
+
+class StdoutBuffer {
+public:
+    static constexpr size_t capacity = MGEN_STDOUT_BUFFER_SIZE;
+
+    StdoutBuffer() {
+#ifdef _WIN32
+        line_buffered_ = _isatty(_fileno(stdout)) != 0;
+#else
+        line_buffered_ = isatty(fileno(stdout)) != 0;
+#endif
+    }
+    StdoutBuffer(const StdoutBuffer&) = delete;
+    StdoutBuffer& operator=(const StdoutBuffer&) = delete;
+    ~StdoutBuffer() { flush(); }
+
+    void flush() {
+        if (size_ > 0) {
+            std::fwrite(data_, 1, size_, stdout);
+            size_ = 0;
         }
+        std::fflush(stdout);
     }
-    return false;
-}
 
-template<typename Container>
-bool all(const Container& container) {
-    for (const auto& item : container) {
-        if (!bool_value(item)) {
-            return false;
+    // Room for n more bytes (n <= capacity); commit() the end of what was written
+    char* reserve(size_t n) {
+        if (capacity - size_ < n) flush();
+        return data_ + size_;
+    }
+    void commit(char* end) { size_ = static_cast<size_t>(end - data_); }
+
+    void write(std::string_view text) {
+        if (text.size() > capacity / 2) {
+            flush();
+            std::fwrite(text.data(), 1, text.size(), stdout);
+            return;
         }
+        char* out = reserve(text.size());
+        std::memcpy(out, text.data(), text.size());
+        commit(out + text.size());
     }
-    return true;
+
+    void put(char c) {
+        char* out = reserve(1);
+        *out = c;
+        commit(out + 1);
+    }
+
+    void end_line() {
+        put('\n');
+        if (line_buffered_) flush();
+    }
+
+private:
+    char data_[capacity];
+    size_t size_ = 0;
+    bool line_buffered_ = false;
+};
+
+// Constructed on first print(); destroyed (flushed) at exit
+inline StdoutBuffer& stdout_buffer() {
+    static StdoutBuffer buffer;
+    return buffer;
 }
 
-// ============================================================================
-// STL Container Aliases (Python-like naming)
-// ============================================================================
+namespace detail {
 
 template<typename T>
-using List = std::vector<T>;
+void print_piece(StdoutBuffer& out, const T& piece) {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        out.write(piece);
+    } else {
+        out.commit(format_write(out.reserve(format_size_bound(piece)), piece));
+    }
+}
 
-template<typename K, typename V>
-using Dict = std::unordered_map<K, V>;
+} // namespace detail
 
-template<typename T>
-using Set = std::unordered_set<T>;
+template<typename... Args>
+void print(const Args&... args) {
+    StdoutBuffer& out = stdout_buffer();
+    bool first = true;
+    ((first ? void(first = false) : out.put(' '), detail::print_piece(out, detail::format_piece(args))), ...);
+    out.end_line();
+}
 
 // ============================================================================
-// Range Implementation (Python-like range)
+// Instrumentation (opt-in: the C++ "instrument" preference, mgen build --instrument)
 // ============================================================================
+// The converter declares a Probe at the top of every function and before every
+// loop (closed right after it), through MGEN_PROBE / MGEN_PROBE_CLOSE. A probe
+// counts entries and times the outermost activation of its site, so recursive
+// calls are counted but not timed twice. Each thread records into its own
+// block, registered once under a mutex, so probes take no lock or atomic. The
+// registry's destructor sums the blocks into a report keyed by Python function
+// and line, written to stderr or to the file MGEN_INSTRUMENT names. Building
+// with -DMGEN_NO_INSTRUMENT compiles the probes out; -DMGEN_INSTRUMENT_RDTSC
+// reports TSC cycles instead of steady_clock nanoseconds on x86.
+
+#ifdef MGEN_INSTRUMENT
+
+#ifndef MGEN_INSTRUMENT_MAX_SITES
+#define MGEN_INSTRUMENT_MAX_SITES 1024
+#endif
+
+struct ProbeRecord {
+    const char* function = nullptr;
+    const char* kind = nullptr;
+    int line = 0;
+    int depth = 0;  // Open activations on this thread
+    uint64_t calls = 0;
+    uint64_t elapsed = 0;
+    uint64_t start = 0;
+};
+
+struct ProbeBlock {
+    ProbeRecord records[MGEN_INSTRUMENT_MAX_SITES];
+};
+
+inline uint64_t probe_now() {
+#if defined(MGEN_INSTRUMENT_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+    return static_cast<uint64_t>(__rdtsc());
+#else
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+#endif
+}
+
+class ProbeRegistry {
+    std::mutex mutex_;
+    // Never freed: threads still alive at exit may keep recording into theirs
+    std::vector<ProbeBlock*> blocks_;
 
-class Range {
 public:
-    class Iterator {
-        int current;
-        int step;
-    public:
-        Iterator(int start, int step) : current(start), step(step) {}
-        Iterator& operator++() { current += step; return *this; }
-        int operator*() const { return current; }
-        bool operator!=(const Iterator& other) const { return current != other.current; }
-    };
+    ProbeBlock* add_block() {
+        ProbeBlock* block = new ProbeBlock();
+        std::lock_guard<std::mutex> lock(mutex_);
+        blocks_.push_back(block);
+        return block;
+    }
 
-private:
-    int start_, stop_, step_;
+    void dump(FILE* out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<ProbeRecord> totals;
+        for (size_t site = 0; site < MGEN_INSTRUMENT_MAX_SITES; site++) {
+            ProbeRecord total;
+            for (const ProbeBlock* block : blocks_) {
+                const ProbeRecord& record = block->records[site];
+                if (record.calls > 0) {
+                    total.function = record.function;
+                    total.kind = record.kind;
+                    total.line = record.line;
+                    total.calls += record.calls;
+                    total.elapsed += record.elapsed;
+                }
+            }
+            if (total.calls > 0) totals.push_back(total);
+        }
+        std::stable_sort(totals.begin(), totals.end(), [](const ProbeRecord& a, const ProbeRecord& b) {
+            return a.elapsed != b.elapsed ? a.elapsed > b.elapsed : a.calls > b.calls;
+        });
+#if defined(MGEN_INSTRUMENT_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+        const char* unit = "cycles";
+#else
+        const char* unit = "ns";
+#endif
+        std::fprintf(out, "%-24s %-8s %6s %12s %16s %14s\n", "function", "kind", "line", "calls", "total", "per call");
+        for (const ProbeRecord& total : totals) {
+            std::fprintf(out, "%-24s %-8s %6d %12llu %13llu %s %11llu %s\n", total.function, total.kind, total.line,
+                         static_cast<unsigned long long>(total.calls), static_cast<unsigned long long>(total.elapsed),
+                         unit, static_cast<unsigned long long>(total.elapsed / total.calls), unit);
+        }
+    }
+
+    ~ProbeRegistry() {
+        const char* path = std::getenv("MGEN_INSTRUMENT");
+        if (!path || !*path || std::strcmp(path, "-") == 0) {
+            dump(stderr);
+            return;
+        }
+        FILE* out = std::fopen(path, "w");
+        if (!out) {
+            std::fprintf(stderr, "mgen: cannot write instrumentation report to %s\n", path);
+            return;
+        }
+        dump(out);
+        std::fclose(out);
+    }
+};
+
+// Constructed on the first probe; reports when destroyed at exit
+inline ProbeRegistry& probe_registry() {
+    static ProbeRegistry registry;
+    return registry;
+}
+
+inline ProbeBlock& probe_block() {
+    static thread_local ProbeBlock* block = probe_registry().add_block();
+    return *block;
+}
+
+class Probe {
+    ProbeRecord* record_;
 
 public:
-    explicit Range(int stop) : start_(0), stop_(stop), step_(1) {}
-    Range(int start, int stop) : start_(start), stop_(stop), step_(1) {}
-    Range(int start, int stop, int step) : start_(start), stop_(stop), step_(step) {}
+    Probe(int site, const char* function, const char* kind, int line) : record_(&probe_block().records[site]) {
+        if (record_->calls == 0) {
+            record_->function = function;
+            record_->kind = kind;
+            record_->line = line;
+        }
+        record_->calls++;
+        if (record_->depth++ == 0) record_->start = probe_now();
+    }
+
+    Probe(const Probe&) = delete;
+    Probe& operator=(const Probe&) = delete;
+
+    // Closing twice is harmless: the destructor closes only a probe still open
+    void close() {
+        if (record_ && --record_->depth == 0) record_->elapsed += probe_now() - record_->start;
+        record_ = nullptr;
+    }
 
-    Iterator begin() const { return Iterator(start_, step_); }
-    Iterator end() const { return Iterator(stop_, step_); }
+    ~Probe() { close(); }
 };
 
+#define MGEN_PROBE(name, site, function, kind, line) mgen::Probe name((site), (function), (kind), (line))
+#define MGEN_PROBE_CLOSE(name) name.close()
+
+#else
+
+#define MGEN_PROBE(name, site, function, kind, line) ((void)0)
+#define MGEN_PROBE_CLOSE(name) ((void)0)
+
+#endif
+
 // ============================================================================
-// List Comprehension Helpers
+// CPython Extension Modules (opt-in: the C++ "target_mode" preference, mgen build --target-mode extension)
 // ============================================================================
+// Conversions for the METH_FASTCALL wrappers the converter appends to export
+// the module's functions to Python (see python_extension.py). A list argument
+// is copied into the function's vector: with one block copy from a contiguous
+// one-dimensional buffer of its element type (array('i'), array('d'), numpy
+// int32 or float64 arrays), item by item from any other sequence. Exceptions
+// the exported function throws become Python exceptions. Python.h precedes
+// this header; the module is built with MGEN_EXTENSION_NAME set to its
+// import name.
+
+#ifdef MGEN_PYTHON_EXTENSION
+
+#ifndef MGEN_EXTENSION_NAME
+#error "MGEN_EXTENSION_NAME must name the extension module (e.g. -DMGEN_EXTENSION_NAME=kernels)"
+#endif
+
+#define MGEN_PYEXT_STR_(name) #name
+#define MGEN_PYEXT_STR(name) MGEN_PYEXT_STR_(name)
+#define MGEN_PYEXT_INIT_(name) PyInit_##name
+#define MGEN_PYEXT_INIT(name) MGEN_PYEXT_INIT_(name)
 
-template<typename T, typename Func>
-auto list_comprehension(const Range& range, Func transform) -> std::vector<decltype(transform(0))> {
-    std::vector<decltype(transform(0))> result;
-    for (auto i : range) {
-        result.push_back(transform(i));
+inline bool py_arity(const char* function, Py_ssize_t nargs, Py_ssize_t expected) {
+    if (nargs != expected) {
+        PyErr_Format(PyExc_TypeError, "%s() takes %zd positional arguments but %zd were given", function, expected,
+                     nargs);
+        return false;
     }
-    return result;
+    return true;
 }
 
-template<typename T, typename Func, typename Pred>
-auto list_comprehension(const Range& range, Func transform, Pred condition) -> std::vector<decltype(transform(0))> {
-    std::vector<decltype(transform(0))> result;
-    for (auto i : range) {
-        if (condition(i)) {
-            result.push_back(transform(i));
-        }
+// Scalar arguments: false with a Python exception set when obj does not convert
+inline bool py_arg(PyObject* obj, int& out) {
+    int overflow = 0;
+    long value = PyLong_AsLongAndOverflow(obj, &overflow);
+    if (value == -1 && PyErr_Occurred()) {
+        return false;
     }
-    return result;
+    if (overflow || value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+        PyErr_SetString(PyExc_OverflowError, "Python int too large to convert to C int");
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
 }
 
-// Overloads for container iteration
-template<typename Container, typename Func>
-auto list_comprehension(const Container& container, Func transform)
-    -> std::vector<decltype(transform(*container.begin()))> {
-    std::vector<decltype(transform(*container.begin()))> result;
-    for (const auto& item : container) {
-        result.push_back(transform(item));
-    }
-    return result;
+inline bool py_arg(PyObject* obj, double& out) {
+    out = PyFloat_AsDouble(obj);
+    return !(out == -1.0 && PyErr_Occurred());
 }
 
-template<typename Container, typename Func, typename Pred>
-auto list_comprehension(const Container& container, Func transform, Pred condition)
-    -> std::vector<decltype(transform(*container.begin()))> {
-    std::vector<decltype(transform(*container.begin()))> result;
-    for (const auto& item : container) {
-        if (condition(item)) {
-            result.push_back(transform(item));
-        }
+inline bool py_arg(PyObject* obj, bool& out) {
+    int value = PyObject_IsTrue(obj);
+    out = value > 0;
+    return value >= 0;
+}
+
+inline bool py_arg(PyObject* obj, std::string& out) {
+    Py_ssize_t size = 0;
+    const char* text = PyUnicode_AsUTF8AndSize(obj, &size);
+    if (!text) {
+        return false;
     }
-    return result;
+    out.assign(text, static_cast<size_t>(size));
+    return true;
 }
 
-// ============================================================================
-// Dict Comprehension Helpers
-// ============================================================================
+namespace detail {
 
-template<typename Func>
-auto dict_comprehension(const Range& range, Func key_value_func)
-    -> std::unordered_map<decltype(key_value_func(0).first), decltype(key_value_func(0).second)> {
-    std::unordered_map<decltype(key_value_func(0).first), decltype(key_value_func(0).second)> result;
-    for (auto i : range) {
-        auto pair = key_value_func(i);
-        result[pair.first] = pair.second;
+// Whether a buffer format is one native item of type code ("i" for int, "d" for double)
+inline bool py_format_is(const char* format, char code) {
+    if (format && *format == '@') {
+        format++;
     }
-    return result;
+    return format && format[0] == code && format[1] == '\0';
 }
 
-template<typename Func, typename Pred>
-auto dict_comprehension(const Range& range, Func key_value_func, Pred condition)
-    -> std::unordered_map<decltype(key_value_func(0).first), decltype(key_value_func(0).second)> {
-    std::unordered_map<decltype(key_value_func(0).first), decltype(key_value_func(0).second)> result;
-    for (auto i : range) {
-        if (condition(i)) {
-            auto pair = key_value_func(i);
-            result[pair.first] = pair.second;
+} // namespace detail
+
+// List arguments, into any vector-like container of int, double, bool or std::string
+template<typename List>
+bool py_arg(PyObject* obj, List& out) {
+    using T = typename List::value_type;
+    if constexpr (std::is_same_v<T, int> || std::is_same_v<T, double>) {
+        if (PyObject_CheckBuffer(obj) && !PyUnicode_Check(obj) && !PyBytes_Check(obj)) {
+            Py_buffer view;
+            if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+                bool matches = view.ndim == 1 && view.itemsize == static_cast<Py_ssize_t>(sizeof(T)) &&
+                               detail::py_format_is(view.format, std::is_same_v<T, int> ? 'i' : 'd');
+                if (matches) {
+                    const T* items = static_cast<const T*>(view.buf);
+                    out.assign(items, items + view.len / view.itemsize);
+                }
+                PyBuffer_Release(&view);
+                if (matches) {
+                    return true;
+                }
+            }
+            // Strided, or another item type or shape: convert its items like any sequence
+            PyErr_Clear();
         }
     }
-    return result;
+    PyObject* items = PySequence_Fast(obj, "expected a sequence or a buffer of numbers");
+    if (!items) {
+        return false;
+    }
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(items);
+    out.clear();
+    out.reserve(static_cast<size_t>(size));
+    for (Py_ssize_t i = 0; i < size; i++) {
+        T value;
+        if (!py_arg(PySequence_Fast_GET_ITEM(items, i), value)) {
+            Py_DECREF(items);
+            return false;
+        }
+        out.push_back(std::move(value));
+    }
+    Py_DECREF(items);
+    return true;
 }
 
-// Overloads for container iteration
-template<typename Container, typename Func>
-auto dict_comprehension(const Container& container, Func key_value_func)
-    -> std::unordered_map<decltype(key_value_func(*container.begin()).first),
-                          decltype(key_value_func(*container.begin()).second)> {
-    std::unordered_map<decltype(key_value_func(*container.begin()).first),
-                       decltype(key_value_func(*container.begin()).second)> result;
-    for (const auto& item : container) {
-        auto pair = key_value_func(item);
-        result[pair.first] = pair.second;
-    }
-    return result;
+// Results: a new reference, or nullptr with a Python exception set
+inline PyObject* py_result(int value) { return PyLong_FromLong(value); }
+inline PyObject* py_result(double value) { return PyFloat_FromDouble(value); }
+inline PyObject* py_result(bool value) { return PyBool_FromLong(value); }
+
+inline PyObject* py_result(const std::string& value) {
+    return PyUnicode_FromStringAndSize(value.data(), static_cast<Py_ssize_t>(value.size()));
 }
 
-template<typename Container, typename Func, typename Pred>
-auto dict_comprehension(const Container& container, Func key_value_func, Pred condition)
-    -> std::unordered_map<decltype(key_value_func(*container.begin()).first),
-                          decltype(key_value_func(*container.begin()).second)> {
-    std::unordered_map<decltype(key_value_func(*container.begin()).first),
-                       decltype(key_value_func(*container.begin()).second)> result;
-    for (const auto& item : container) {
-        if (condition(item)) {
-            auto pair = key_value_func(item);
-            result[pair.first] = pair.second;
+template<typename List>
+PyObject* py_result(const List& items) {
+    PyObject* list = PyList_New(static_cast<Py_ssize_t>(items.size()));
+    Py_ssize_t i = 0;
+    for (auto it = items.begin(); list && it != items.end(); ++it, ++i) {
+        PyObject* item = py_result(*it);
+        if (!item) {
+            Py_DECREF(list);
+            return nullptr;
         }
+        PyList_SET_ITEM(list, i, item);
     }
-    return result;
+    return list;
+}
+
+// Raise the exception an exported function threw as its Python counterpart; returns nullptr
+inline PyObject* py_raise(std::exception_ptr error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::out_of_range& e) {
+        PyErr_SetString(PyExc_IndexError, e.what());
+    } catch (const std::invalid_argument& e) {
+        PyErr_SetString(PyExc_ValueError, e.what());
+    } catch (const std::bad_alloc&) {
+        PyErr_NoMemory();
+    } catch (const std::exception& e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+    } catch (...) {
+        PyErr_SetString(PyExc_RuntimeError, "unknown C++ exception");
+    }
+    return nullptr;
 }
 
+#endif // MGEN_PYTHON_EXTENSION
+
 // ============================================================================
-// Set Comprehension Helpers
+// Parallel Execution (opt-in: -DMGEN_PARALLEL, the C++ "parallel" preference)
 // ============================================================================
 
-template<typename Func>
-auto set_comprehension(const Range& range, Func transform) -> std::unordered_set<decltype(transform(0))> {
-    std::unordered_set<decltype(transform(0))> result;
-    for (auto i : range) {
-        result.insert(transform(i));
+// Reductions and parallel_list_comprehension split random-access inputs of at
+// least MGEN_PARALLEL_THRESHOLD elements across a persistent pool of worker
+// threads. Smaller inputs, other sources and calls made from inside a worker
+// stay serial. Floating-point sums may differ in the last bits from the serial
+// order, as with std::execution::par_unseq.
+
+#ifndef MGEN_PARALLEL_THRESHOLD
+#define MGEN_PARALLEL_THRESHOLD 100000
+#endif
+
+template<typename Source, typename = void>
+struct is_parallel_source : std::false_type {};
+
+template<typename Source>
+struct is_parallel_source<
+    Source,
+    std::void_t<decltype(std::declval<const Source&>().size()),
+                typename std::iterator_traits<decltype(std::begin(std::declval<const Source&>()))>::iterator_category>>
+    : std::is_base_of<std::random_access_iterator_tag,
+                      typename std::iterator_traits<decltype(std::begin(std::declval<const Source&>()))>::iterator_category> {};
+
+#ifdef MGEN_PARALLEL
+
+// Workers sleep until a job arrives, then claim chunk indices from a shared
+// counter (the calling thread claims them too), so faster threads take more
+// chunks. One job runs at a time; the first exception thrown by a chunk is
+// rethrown to the caller once every chunk has finished.
+class ParallelPool {
+    std::vector<std::thread> threads_;
+    std::mutex job_mutex_;   // Serializes callers of run()
+    std::mutex state_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t chunks_ = 0;
+    std::atomic<size_t> next_chunk_{0};
+    size_t busy_workers_ = 0;
+    unsigned long long generation_ = 0;
+    std::exception_ptr error_;
+    bool stopping_ = false;
+
+    static bool& inside_worker() {
+        static thread_local bool inside = false;
+        return inside;
     }
-    return result;
-}
 
-template<typename Func, typename Pred>
-auto set_comprehension(const Range& range, Func transform, Pred condition) -> std::unordered_set<decltype(transform(0))> {
-    std::unordered_set<decltype(transform(0))> result;
-    for (auto i : range) {
-        if (condition(i)) {
-            result.insert(transform(i));
+    void claim_chunks(const std::function<void(size_t)>& job) {
+        for (size_t chunk = next_chunk_++; chunk < chunks_; chunk = next_chunk_++) {
+            try {
+                job(chunk);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
         }
     }
-    return result;
-}
 
-// Overloads for container iteration
-template<typename Container, typename Func>
-auto set_comprehension(const Container& container, Func transform)
-    -> std::unordered_set<decltype(transform(*container.begin()))> {
-    std::unordered_set<decltype(transform(*container.begin()))> result;
-    for (const auto& item : container) {
-        result.insert(transform(item));
+    void worker_loop() {
+        inside_worker() = true;
+        unsigned long long seen = 0;
+        for (;;) {
+            const std::function<void(size_t)>* job;
+            {
+                std::unique_lock<std::mutex> lock(state_mutex_);
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+                job = job_;
+            }
+            claim_chunks(*job);
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            if (--busy_workers_ == 0) done_.notify_one();
+        }
     }
-    return result;
-}
 
-template<typename Container, typename Func, typename Pred>
-auto set_comprehension(const Container& container, Func transform, Pred condition)
-    -> std::unordered_set<decltype(transform(*container.begin()))> {
-    std::unordered_set<decltype(transform(*container.begin()))> result;
-    for (const auto& item : container) {
-        if (condition(item)) {
-            result.insert(transform(item));
+    ParallelPool() {
+        unsigned hardware = std::thread::hardware_concurrency();
+        for (unsigned i = 1; i < (hardware == 0 ? 1 : hardware); ++i) {
+            threads_.emplace_back([this] { worker_loop(); });
         }
     }
-    return result;
-}
 
-// ============================================================================
-// Dictionary Helper Functions
-// ============================================================================
+public:
+    ~ParallelPool() {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) thread.join();
+    }
 
-/**
- * Extract values from a map (Python dict.values())
- * Returns a vector of values for iteration
- */
-template<typename Map>
-auto values(const Map& map) -> std::vector<typename Map::mapped_type> {
-    std::vector<typename Map::mapped_type> result;
-    result.reserve(map.size());
-    for (const auto& [key, value] : map) {
-        result.push_back(value);
+    ParallelPool(const ParallelPool&) = delete;
+    ParallelPool& operator=(const ParallelPool&) = delete;
+
+    static ParallelPool& instance() {
+        static ParallelPool pool;
+        return pool;
     }
-    return result;
+
+    // Threads that share a job, including the caller
+    size_t concurrency() const { return threads_.size() + 1; }
+
+    // Call job(chunk) for every chunk in [0, chunks) and wait for all of them
+    void run(size_t chunks, const std::function<void(size_t)>& job) {
+        if (chunks <= 1 || threads_.empty() || inside_worker()) {
+            for (size_t chunk = 0; chunk < chunks; ++chunk) job(chunk);
+            return;
+        }
+
+        std::lock_guard<std::mutex> serialize(job_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            job_ = &job;
+            chunks_ = chunks;
+            next_chunk_ = 0;
+            busy_workers_ = threads_.size();
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        inside_worker() = true;
+        claim_chunks(job);
+        inside_worker() = false;
+
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(state_mutex_);
+            done_.wait(lock, [&] { return busy_workers_ == 0; });
+            job_ = nullptr;
+            error = error_;
+        }
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+// Number of chunks for n elements: a few per thread so uneven chunks balance out
+inline size_t parallel_chunk_count(size_t n) {
+    size_t chunks = ParallelPool::instance().concurrency() * 4;
+    return chunks < n ? chunks : n;
+}
+
+// Call body(chunk, first, last) for contiguous index ranges covering [0, n),
+// returning after every range is done. Chunk c covers [c * n / chunks, (c + 1) * n / chunks).
+template<typename Body>
+void parallel_for_ranges(size_t n, size_t chunks, const Body& body) {
+    ParallelPool::instance().run(chunks, [&](size_t chunk) {
+        body(chunk, chunk * n / chunks, (chunk + 1) * n / chunks);
+    });
+}
+
+template<typename Source>
+bool use_parallel(const Source& source) {
+    if constexpr (is_parallel_source<Source>::value) {
+        return source.size() >= MGEN_PARALLEL_THRESHOLD;
+    } else {
+        return false;
+    }
+}
+
+#endif  // MGEN_PARALLEL
+
+// ============================================================================
+// Python Built-in Functions
+// ============================================================================
+
+template<typename T>
+T abs(T value) {
+    return std::abs(value);
+}
+
+template<typename Container>
+size_t len(const Container& container) {
+    return container.size();
+}
+
+template<typename T>
+bool bool_value(const T& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        return value != 0;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return !value.empty();
+    } else {
+        return !value.empty();  // For containers
+    }
+}
+
+#ifdef MGEN_PARALLEL
+// Index of the element of a parallel source that wins under better(candidate,
+// current); ties keep the earlier element, as std::min_element does
+template<typename Container, typename Better>
+size_t parallel_select_index(const Container& container, Better better) {
+    size_t n = container.size();
+    size_t chunks = parallel_chunk_count(n);
+    auto first = std::begin(container);
+    std::vector<size_t> winners(chunks);
+    parallel_for_ranges(n, chunks, [&](size_t chunk, size_t lo, size_t hi) {
+        size_t winner = lo;
+        for (size_t i = lo + 1; i < hi; ++i) {
+            if (better(first[i], first[winner])) winner = i;
+        }
+        winners[chunk] = winner;
+    });
+    size_t winner = winners[0];
+    for (size_t c = 1; c < chunks; ++c) {
+        if (better(first[winners[c]], first[winner])) winner = winners[c];
+    }
+    return winner;
+}
+
+// True if pred holds for some element; chunks stop early once one has found it
+template<typename Container, typename Pred>
+bool parallel_any_of(const Container& container, Pred pred) {
+    std::atomic<bool> found{false};
+    auto first = std::begin(container);
+    parallel_for_ranges(container.size(), parallel_chunk_count(container.size()), [&](size_t, size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi && !found.load(std::memory_order_relaxed); ++i) {
+            if (pred(first[i])) found.store(true, std::memory_order_relaxed);
+        }
+    });
+    return found.load();
+}
+#endif  // MGEN_PARALLEL
+
+template<typename Container>
+auto min(const Container& container) -> typename Container::value_type {
+#ifdef MGEN_PARALLEL
+    if constexpr (is_parallel_source<Container>::value) {
+        if (use_parallel(container)) {
+            return std::begin(container)[parallel_select_index(container, [](const auto& a, const auto& b) { return a < b; })];
+        }
+    }
+#endif
+    return *std::min_element(container.begin(), container.end());
+}
+
+template<typename Container>
+auto max(const Container& container) -> typename Container::value_type {
+#ifdef MGEN_PARALLEL
+    if constexpr (is_parallel_source<Container>::value) {
+        if (use_parallel(container)) {
+            return std::begin(container)[parallel_select_index(container, [](const auto& a, const auto& b) { return b < a; })];
+        }
+    }
+#endif
+    return *std::max_element(container.begin(), container.end());
+}
+
+template<typename Container>
+auto sum(const Container& container) -> typename Container::value_type {
+    using ValueType = typename Container::value_type;
+#ifdef MGEN_PARALLEL
+    if constexpr (is_parallel_source<Container>::value) {
+        if (use_parallel(container)) {
+            size_t n = container.size();
+            size_t chunks = parallel_chunk_count(n);
+            auto first = std::begin(container);
+            std::vector<ValueType> partials(chunks);
+            parallel_for_ranges(n, chunks, [&](size_t chunk, size_t lo, size_t hi) {
+                ValueType partial{};
+                for (size_t i = lo; i < hi; ++i) {
+                    partial += first[i];
+                }
+                partials[chunk] = partial;
+            });
+            ValueType result{};
+            for (const auto& partial : partials) {
+                result += partial;
+            }
+            return result;
+        }
+    }
+#endif
+    ValueType result{};
+    for (const auto& item : container) {
+        result += item;
+    }
+    return result;
+}
+
+template<typename Container>
+bool any(const Container& container) {
+#ifdef MGEN_PARALLEL
+    if constexpr (is_parallel_source<Container>::value) {
+        if (use_parallel(container)) {
+            return parallel_any_of(container, [](const auto& item) { return bool_value(item); });
+        }
+    }
+#endif
+    for (const auto& item : container) {
+        if (bool_value(item)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename Container>
+bool all(const Container& container) {
+#ifdef MGEN_PARALLEL
+    if constexpr (is_parallel_source<Container>::value) {
+        if (use_parallel(container)) {
+            return !parallel_any_of(container, [](const auto& item) { return !bool_value(item); });
+        }
+    }
+#endif
+    for (const auto& item : container) {
+        if (!bool_value(item)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Flat Hash Containers (open addressing)
+// ============================================================================
+
+// FlatMap and FlatSet keep their elements in one array, probed linearly, next
+// to an array of control bytes: 0 empty, 1 erased, otherwise 0x80 | 7 bits of
+// the hash, so most mismatching probes never compare keys. Inserting does not
+// allocate except when the table grows, and reserve(n) sizes it once.
+// String keys hash transparently: find, count, contains, at and operator[]
+// take std::string_view or const char* without building a std::string.
+// Unlike std::unordered_map, inserting may move elements and invalidates
+// iterators and references.
+
+template<typename T>
+struct FlatHash : std::hash<T> {};
+
+template<>
+struct FlatHash<std::string> {
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const noexcept { return std::hash<std::string_view>{}(str); }
+};
+
+template<typename T>
+struct FlatEqual : std::equal_to<T> {};
+
+template<>
+struct FlatEqual<std::string> {
+    using is_transparent = void;
+    bool operator()(std::string_view a, std::string_view b) const noexcept { return a == b; }
+};
+
+namespace detail {
+
+struct PairKey {
+    template<typename Pair>
+    static const auto& get(const Pair& pair) { return pair.first; }
+};
+
+struct IdentityKey {
+    template<typename T>
+    static const T& get(const T& value) { return value; }
+};
+
+template<typename Hash, typename Q, typename = void>
+struct accepts_lookup_key : std::false_type {};
+
+template<typename Hash, typename Q>
+struct accepts_lookup_key<Hash, Q, std::void_t<typename Hash::is_transparent>> : std::true_type {};
+
+template<typename Value, typename Key, typename KeyOf, typename Hash, typename Eq>
+class FlatTable {
+protected:
+    static constexpr uint8_t kEmpty = 0;
+    static constexpr uint8_t kErased = 1;
+    static constexpr size_t kMinCapacity = 8;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    Value* slots_ = nullptr;
+    std::unique_ptr<uint8_t[]> ctrl_;
+    size_t capacity_ = 0;  // Zero or a power of two
+    size_t size_ = 0;
+    size_t erased_ = 0;
+    Hash hash_;
+    Eq eq_;
+
+    // Spread weak hashes (std::hash<int> is the identity) over every bit
+    static uint64_t mix(size_t hash) {
+        uint64_t x = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+        return x ^ (x >> 32);
+    }
+    static uint8_t tag_of(uint64_t mixed) { return static_cast<uint8_t>(0x80 | (mixed >> 57)); }
+    bool full(size_t i) const { return ctrl_[i] >= 0x80; }
+
+    // Keep at least 1/8 of the slots empty so every probe sequence ends
+    static size_t capacity_for(size_t count) {
+        size_t capacity = kMinCapacity;
+        while (capacity - capacity / 8 <= count) capacity *= 2;
+        return capacity;
+    }
+
+    template<typename Q>
+    size_t find_index(const Q& key) const {
+        if (size_ == 0) return npos;
+        uint64_t mixed = mix(hash_(key));
+        uint8_t tag = tag_of(mixed);
+        size_t mask = capacity_ - 1;
+        for (size_t i = mixed & mask;; i = (i + 1) & mask) {
+            uint8_t control = ctrl_[i];
+            if (control == kEmpty) return npos;
+            if (control == tag && eq_(KeyOf::get(slots_[i]), key)) return i;
+        }
+    }
+
+    // Index of key's element, constructing it from make() when it is missing
+    template<typename Q, typename Make>
+    std::pair<size_t, bool> find_or_insert(const Q& key, Make&& make) {
+        if (size_ + erased_ + 1 > capacity_ - capacity_ / 8) {
+            rehash(capacity_for(size_ + 1));
+        }
+        uint64_t mixed = mix(hash_(key));
+        uint8_t tag = tag_of(mixed);
+        size_t mask = capacity_ - 1;
+        size_t target = npos;
+        for (size_t i = mixed & mask;; i = (i + 1) & mask) {
+            uint8_t control = ctrl_[i];
+            if (control == kEmpty) {
+                if (target == npos) target = i;
+                break;
+            }
+            if (control == kErased) {
+                if (target == npos) target = i;
+            } else if (control == tag && eq_(KeyOf::get(slots_[i]), key)) {
+                return {i, false};
+            }
+        }
+        ::new (static_cast<void*>(slots_ + target)) Value(make());
+        if (ctrl_[target] == kErased) --erased_;
+        ctrl_[target] = tag;
+        ++size_;
+        return {target, true};
+    }
+
+    void erase_index(size_t i) {
+        slots_[i].~Value();
+        // A probe that reaches an erased slot just before an empty one would stop there anyway
+        ctrl_[i] = (ctrl_[(i + 1) & (capacity_ - 1)] == kEmpty) ? kEmpty : kErased;
+        if (ctrl_[i] == kErased) ++erased_;
+        --size_;
+    }
+
+    void rehash(size_t new_capacity) {
+        Value* old_slots = slots_;
+        std::unique_ptr<uint8_t[]> old_ctrl = std::move(ctrl_);
+        size_t old_capacity = capacity_;
+
+        slots_ = std::allocator<Value>().allocate(new_capacity);
+        ctrl_.reset(new uint8_t[new_capacity]());
+        capacity_ = new_capacity;
+        erased_ = 0;
+
+        size_t mask = new_capacity - 1;
+        for (size_t j = 0; j < old_capacity; ++j) {
+            if (old_ctrl[j] < 0x80) continue;
+            uint64_t mixed = mix(hash_(KeyOf::get(old_slots[j])));
+            size_t i = mixed & mask;
+            while (ctrl_[i] != kEmpty) i = (i + 1) & mask;
+            ::new (static_cast<void*>(slots_ + i)) Value(std::move(old_slots[j]));
+            ctrl_[i] = tag_of(mixed);
+            old_slots[j].~Value();
+        }
+        if (old_slots) std::allocator<Value>().deallocate(old_slots, old_capacity);
+    }
+
+    void destroy() {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (full(i)) slots_[i].~Value();
+        }
+        if (slots_) std::allocator<Value>().deallocate(slots_, capacity_);
+        slots_ = nullptr;
+        ctrl_.reset();
+        capacity_ = size_ = erased_ = 0;
+    }
+
+public:
+    using value_type = Value;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = Eq;
+
+    template<bool Const>
+    class Iter {
+        friend class FlatTable;
+        using Table = std::conditional_t<Const, const FlatTable, FlatTable>;
+        Table* table_;
+        size_t index_;
+        void settle() { while (index_ < table_->capacity_ && !table_->full(index_)) ++index_; }
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const Value*, Value*>;
+        using reference = std::conditional_t<Const, const Value&, Value&>;
+
+        Iter() : table_(nullptr), index_(0) {}
+        Iter(Table* table, size_t index) : table_(table), index_(index) { settle(); }
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        Iter(const Iter<false>& other) : table_(other.table_), index_(other.index_) {}
+
+        reference operator*() const { return table_->slots_[index_]; }
+        pointer operator->() const { return &table_->slots_[index_]; }
+        Iter& operator++() { ++index_; settle(); return *this; }
+        Iter operator++(int) { Iter old = *this; ++*this; return old; }
+        bool operator==(const Iter& other) const { return index_ == other.index_; }
+        bool operator!=(const Iter& other) const { return index_ != other.index_; }
+
+        template<bool> friend class Iter;
+    };
+
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+
+    FlatTable() = default;
+
+    FlatTable(const FlatTable& other) : hash_(other.hash_), eq_(other.eq_) {
+        if (other.size_ == 0) return;
+        slots_ = std::allocator<Value>().allocate(other.capacity_);
+        ctrl_.reset(new uint8_t[other.capacity_]());
+        capacity_ = other.capacity_;
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (other.full(i)) {
+                ::new (static_cast<void*>(slots_ + i)) Value(other.slots_[i]);
+                ++size_;
+            }
+            // Erased markers too: they keep the probe sequences through them intact
+            ctrl_[i] = other.ctrl_[i];
+        }
+        erased_ = other.erased_;
+    }
+
+    FlatTable(FlatTable&& other) noexcept
+        : slots_(other.slots_), ctrl_(std::move(other.ctrl_)), capacity_(other.capacity_),
+          size_(other.size_), erased_(other.erased_), hash_(std::move(other.hash_)), eq_(std::move(other.eq_)) {
+        other.slots_ = nullptr;
+        other.capacity_ = other.size_ = other.erased_ = 0;
+    }
+
+    FlatTable& operator=(FlatTable other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~FlatTable() { destroy(); }
+
+    void swap(FlatTable& other) noexcept {
+        std::swap(slots_, other.slots_);
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(erased_, other.erased_);
+        std::swap(hash_, other.hash_);
+        std::swap(eq_, other.eq_);
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, capacity_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, capacity_); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Room for count elements without growing
+    void reserve(size_t count) {
+        size_t needed = capacity_for(count);
+        if (needed > capacity_) rehash(needed);
+    }
+
+    void clear() {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (full(i)) slots_[i].~Value();
+        }
+        if (capacity_) std::fill(ctrl_.get(), ctrl_.get() + capacity_, kEmpty);
+        size_ = erased_ = 0;
+    }
+
+    iterator find(const Key& key) { return iterator_at(find_index(key)); }
+    const_iterator find(const Key& key) const { return iterator_at(find_index(key)); }
+    size_t count(const Key& key) const { return find_index(key) != npos ? 1 : 0; }
+    bool contains(const Key& key) const { return find_index(key) != npos; }
+
+    template<typename Q, typename = std::enable_if_t<accepts_lookup_key<Hash, Q>::value>>
+    iterator find(const Q& key) { return iterator_at(find_index(key)); }
+    template<typename Q, typename = std::enable_if_t<accepts_lookup_key<Hash, Q>::value>>
+    const_iterator find(const Q& key) const { return iterator_at(find_index(key)); }
+    template<typename Q, typename = std::enable_if_t<accepts_lookup_key<Hash, Q>::value>>
+    size_t count(const Q& key) const { return find_index(key) != npos ? 1 : 0; }
+    template<typename Q, typename = std::enable_if_t<accepts_lookup_key<Hash, Q>::value>>
+    bool contains(const Q& key) const { return find_index(key) != npos; }
+
+    std::pair<iterator, bool> insert(const Value& value) {
+        auto [index, inserted] = find_or_insert(KeyOf::get(value), [&]() -> const Value& { return value; });
+        return {iterator(this, index), inserted};
+    }
+
+    std::pair<iterator, bool> insert(Value&& value) {
+        auto [index, inserted] = find_or_insert(KeyOf::get(value), [&]() -> Value&& { return std::move(value); });
+        return {iterator(this, index), inserted};
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        return insert(Value(std::forward<Args>(args)...));
+    }
+
+    size_t erase(const Key& key) {
+        size_t index = find_index(key);
+        if (index == npos) return 0;
+        erase_index(index);
+        return 1;
+    }
+
+    iterator erase(const_iterator position) {
+        erase_index(position.index_);
+        return iterator(this, position.index_ + 1);
+    }
+
+protected:
+    iterator iterator_at(size_t index) { return index == npos ? end() : iterator(this, index); }
+    const_iterator iterator_at(size_t index) const { return index == npos ? end() : const_iterator(this, index); }
+};
+
+}  // namespace detail
+
+template<typename K, typename V, typename Hash = FlatHash<K>, typename Eq = FlatEqual<K>>
+class FlatMap : public detail::FlatTable<std::pair<K, V>, K, detail::PairKey, Hash, Eq> {
+    using Base = detail::FlatTable<std::pair<K, V>, K, detail::PairKey, Hash, Eq>;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+
+    FlatMap() = default;
+    FlatMap(std::initializer_list<value_type> init) {
+        this->reserve(init.size());
+        for (const auto& item : init) (*this)[item.first] = item.second;
+    }
+
+    // The index is taken before slots_ is read: inserting may reallocate it
+    V& operator[](const K& key) {
+        size_t index = this->find_or_insert(key, [&] { return value_type(key, V()); }).first;
+        return this->slots_[index].second;
+    }
+
+    V& operator[](K&& key) {
+        size_t index = this->find_or_insert(key, [&] { return value_type(std::move(key), V()); }).first;
+        return this->slots_[index].second;
+    }
+
+    // Looks up a string key as std::string_view; only an insert copies it into a std::string
+    template<typename Q, typename = std::enable_if_t<detail::accepts_lookup_key<Hash, Q>::value>>
+    V& operator[](const Q& key) {
+        size_t index = this->find_or_insert(key, [&] { return value_type(K(key), V()); }).first;
+        return this->slots_[index].second;
+    }
+
+    template<typename Q>
+    V& at(const Q& key) {
+        auto it = this->find(key);
+        if (it == this->end()) throw std::out_of_range("FlatMap::at: key not found");
+        return it->second;
+    }
+
+    template<typename Q>
+    const V& at(const Q& key) const {
+        auto it = this->find(key);
+        if (it == this->end()) throw std::out_of_range("FlatMap::at: key not found");
+        return it->second;
+    }
+
+    bool operator==(const FlatMap& other) const {
+        if (this->size() != other.size()) return false;
+        for (const auto& [key, value] : *this) {
+            auto it = other.find(key);
+            if (it == other.end() || !(it->second == value)) return false;
+        }
+        return true;
+    }
+    bool operator!=(const FlatMap& other) const { return !(*this == other); }
+};
+
+template<typename T, typename Hash = FlatHash<T>, typename Eq = FlatEqual<T>>
+class FlatSet : public detail::FlatTable<T, T, detail::IdentityKey, Hash, Eq> {
+public:
+    using key_type = T;
+    using value_type = T;
+
+    FlatSet() = default;
+    FlatSet(std::initializer_list<T> init) {
+        this->reserve(init.size());
+        for (const auto& item : init) this->insert(item);
+    }
+
+    bool operator==(const FlatSet& other) const {
+        if (this->size() != other.size()) return false;
+        for (const auto& item : *this) {
+            if (!other.contains(item)) return false;
+        }
+        return true;
+    }
+    bool operator!=(const FlatSet& other) const { return !(*this == other); }
+};
+
+// ============================================================================
+// Small Vector (inline storage)
+// ============================================================================
+
+// SmallVector<T, N> keeps up to N elements inside the object itself and only
+// allocates when it grows past them, so a short list built in a loop body
+// never touches the heap. Past N it behaves like std::vector (doubling growth,
+// pointers as iterators). Moving a heap-backed SmallVector steals the buffer;
+// moving an inline one moves the elements.
+
+template<typename T, size_t N>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs room for at least one inline element");
+
+    T* data_;
+    size_t size_ = 0;
+    size_t capacity_ = N;
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+
+    T* inline_data() { return reinterpret_cast<T*>(inline_); }
+    bool is_inline() const { return capacity_ == N; }
+
+    void grow_to(size_t capacity) {
+        T* data = std::allocator<T>().allocate(capacity);
+        std::uninitialized_move(data_, data_ + size_, data);
+        std::destroy(data_, data_ + size_);
+        release();
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    void release() {
+        if (!is_inline()) {
+            std::allocator<T>().deallocate(data_, capacity_);
+        }
+    }
+
+    // Take other's elements; this must be empty and inline
+    void steal(SmallVector& other) {
+        if (other.is_inline()) {
+            std::uninitialized_move(other.data_, other.data_ + other.size_, data_);
+            size_ = other.size_;
+            other.clear();
+        } else {
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inline_data();
+            other.size_ = 0;
+            other.capacity_ = N;
+        }
+    }
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() noexcept : data_(inline_data()) {}
+
+    SmallVector(std::initializer_list<T> init) : SmallVector() {
+        reserve(init.size());
+        std::uninitialized_copy(init.begin(), init.end(), data_);
+        size_ = init.size();
+    }
+
+    explicit SmallVector(size_t count, const T& value = T()) : SmallVector() {
+        reserve(count);
+        std::uninitialized_fill_n(data_, count, value);
+        size_ = count;
+    }
+
+    SmallVector(const SmallVector& other) : SmallVector() {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) : SmallVector() {
+        steal(other);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size_);
+            std::uninitialized_copy(other.begin(), other.end(), data_);
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            clear();
+            release();
+            data_ = inline_data();
+            capacity_ = N;
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        clear();
+        release();
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return capacity_; }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    T& operator[](size_t index) { return data_[index]; }
+    const T& operator[](size_t index) const { return data_[index]; }
+    T& at(size_t index) {
+        if (index >= size_) throw std::out_of_range("list index out of range");
+        return data_[index];
+    }
+    const T& at(size_t index) const {
+        if (index >= size_) throw std::out_of_range("list index out of range");
+        return data_[index];
+    }
+    T& front() { return data_[0]; }
+    const T& front() const { return data_[0]; }
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) {
+            grow_to(capacity);
+        }
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            // Build the element first: args may refer to an element about to move
+            T value(std::forward<Args>(args)...);
+            grow_to(capacity_ * 2);
+            ::new (static_cast<void*>(data_ + size_)) T(std::move(value));
+        } else {
+            ::new (static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+        }
+        return data_[size_++];
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() { data_[--size_].~T(); }
+
+    void clear() {
+        std::destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    void resize(size_t count, const T& value = T()) {
+        while (size_ > count) pop_back();
+        reserve(count);
+        while (size_ < count) emplace_back(value);
+    }
+
+    iterator insert(const_iterator pos, T value) {
+        size_t index = static_cast<size_t>(pos - data_);
+        emplace_back(std::move(value));
+        std::rotate(data_ + index, data_ + size_ - 1, data_ + size_);
+        return data_ + index;
+    }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        T* out = data_ + (first - data_);
+        T* tail = std::move(data_ + (last - data_), data_ + size_, out);
+        while (data_ + size_ != tail) pop_back();
+        return out;
+    }
+
+    bool operator==(const SmallVector& other) const {
+        return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(const SmallVector& other) const { return !(*this == other); }
+    bool operator<(const SmallVector& other) const {
+        return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
+    }
+};
+
+// A list literal whose element type the converter could not name:
+// small_list(a, b) is a SmallVector<common type, 2>
+template<typename... Args>
+SmallVector<std::common_type_t<std::decay_t<Args>...>, sizeof...(Args)> small_list(Args&&... args) {
+    SmallVector<std::common_type_t<std::decay_t<Args>...>, sizeof...(Args)> result;
+    (result.emplace_back(std::forward<Args>(args)), ...);
+    return result;
+}
+
+// ============================================================================
+// STL Container Aliases (Python-like naming)
+// ============================================================================
+
+// List is declared with the memory resources above, since StringOps returns lists
+
+// -DMGEN_FLAT_CONTAINERS (the C++ "flat_hash_containers" preference) backs
+// dicts and sets, including comprehension results, with FlatMap and FlatSet
+#ifdef MGEN_FLAT_CONTAINERS
+template<typename K, typename V>
+using Dict = FlatMap<K, V>;
+
+template<typename T>
+using Set = FlatSet<T>;
+#elif defined(MGEN_PMR)
+template<typename K, typename V>
+using Dict = std::pmr::unordered_map<K, V>;
+
+template<typename T>
+using Set = std::pmr::unordered_set<T>;
+#else
+template<typename K, typename V>
+using Dict = std::unordered_map<K, V>;
+
+template<typename T>
+using Set = std::unordered_set<T>;
+#endif
+
+// ============================================================================
+// Range Implementation (Python-like range)
+// ============================================================================
+
+// Sized, random-access view of start, start + step, ... up to (not including) stop.
+// Positions are 64-bit indices and values are start + index * step computed in
+// 64 bits, so end() and the trip count never overflow for any int arguments.
+class Range {
+public:
+    using value_type = int;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = int;
+
+    private:
+        long long start_;
+        long long step_;
+        difference_type index_;
+
+    public:
+        constexpr Iterator() : start_(0), step_(1), index_(0) {}
+        constexpr Iterator(long long start, long long step, difference_type index)
+            : start_(start), step_(step), index_(index) {}
+
+        constexpr int operator*() const { return static_cast<int>(start_ + index_ * step_); }
+        constexpr int operator[](difference_type n) const { return static_cast<int>(start_ + (index_ + n) * step_); }
+
+        constexpr Iterator& operator++() { ++index_; return *this; }
+        constexpr Iterator operator++(int) { Iterator old = *this; ++index_; return old; }
+        constexpr Iterator& operator--() { --index_; return *this; }
+        constexpr Iterator operator--(int) { Iterator old = *this; --index_; return old; }
+        constexpr Iterator& operator+=(difference_type n) { index_ += n; return *this; }
+        constexpr Iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+
+        constexpr friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+        constexpr friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+        constexpr friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+        constexpr friend difference_type operator-(const Iterator& a, const Iterator& b) { return a.index_ - b.index_; }
+
+        // Iterators of one Range compare by position
+        constexpr friend bool operator==(const Iterator& a, const Iterator& b) { return a.index_ == b.index_; }
+        constexpr friend bool operator!=(const Iterator& a, const Iterator& b) { return a.index_ != b.index_; }
+        constexpr friend bool operator<(const Iterator& a, const Iterator& b) { return a.index_ < b.index_; }
+        constexpr friend bool operator>(const Iterator& a, const Iterator& b) { return a.index_ > b.index_; }
+        constexpr friend bool operator<=(const Iterator& a, const Iterator& b) { return a.index_ <= b.index_; }
+        constexpr friend bool operator>=(const Iterator& a, const Iterator& b) { return a.index_ >= b.index_; }
+    };
+
+private:
+    long long start_;
+    long long step_;
+    difference_type size_;
+
+    // Number of values, as len(range(...)) in Python
+    static constexpr difference_type count(long long start, long long stop, long long step) {
+        if (step > 0 && stop > start) {
+            return static_cast<difference_type>((stop - start + step - 1) / step);
+        }
+        if (step < 0 && stop < start) {
+            return static_cast<difference_type>((start - stop - step - 1) / -step);
+        }
+        return 0;
+    }
+
+    constexpr Range(long long start, long long step, difference_type size, bool)
+        : start_(start), step_(step), size_(size) {}
+
+public:
+    constexpr explicit Range(int stop) : Range(0, stop, 1) {}
+    constexpr Range(int start, int stop) : Range(start, stop, 1) {}
+    constexpr Range(int start, int stop, int step)
+        : start_(start),
+          step_(step != 0 ? step : throw std::invalid_argument("range() arg 3 must not be zero")),
+          size_(count(start, stop, step)) {}
+
+    constexpr size_t size() const { return static_cast<size_t>(size_); }
+    constexpr bool empty() const { return size_ == 0; }
+    constexpr int operator[](difference_type index) const { return static_cast<int>(start_ + index * step_); }
+
+    constexpr Iterator begin() const { return Iterator(start_, step_, 0); }
+    constexpr Iterator end() const { return Iterator(start_, step_, size_); }
+
+    // Values at indices [first, last), e.g. one chunk of a range split across workers
+    constexpr Range subrange(difference_type first, difference_type last) const {
+        first = first < 0 ? 0 : (first > size_ ? size_ : first);
+        last = last < first ? first : (last > size_ ? size_ : last);
+        return Range(start_ + first * step_, step_, last - first, true);
+    }
+};
+
+// ============================================================================
+// Lazy Views (fused comprehension pipelines)
+// ============================================================================
+
+// A view keeps lvalue sources by reference and owns rvalue sources (ranges,
+// other views), so a chain of views is one object that is walked in one loop.
+// Elements are computed when dereferenced; nothing is materialized until a
+// comprehension helper, sum() or a for loop consumes the chain.
+
+template<typename T, typename = void>
+struct is_sized : std::false_type {};
+
+template<typename T>
+struct is_sized<T, std::void_t<decltype(std::declval<const T&>().size())>> : std::true_type {};
+
+template<typename Source>
+using view_iterator_t = decltype(std::begin(std::declval<const std::remove_reference_t<Source>&>()));
+
+template<typename Source, typename Func>
+class MapView {
+    Source source_;
+    Func func_;
+
+public:
+    using value_type = std::decay_t<decltype(std::declval<const Func&>()(*std::declval<view_iterator_t<Source>>()))>;
+
+    class Iterator {
+        view_iterator_t<Source> it_;
+        const Func* func_;
+    public:
+        Iterator(view_iterator_t<Source> it, const Func* func) : it_(it), func_(func) {}
+        Iterator& operator++() { ++it_; return *this; }
+        decltype(auto) operator*() const { return (*func_)(*it_); }
+        bool operator!=(const Iterator& other) const { return it_ != other.it_; }
+    };
+
+    MapView(Source source, Func func) : source_(std::forward<Source>(source)), func_(std::move(func)) {}
+
+    Iterator begin() const { const auto& src = source_; return Iterator(std::begin(src), &func_); }
+    Iterator end() const { const auto& src = source_; return Iterator(std::end(src), &func_); }
+
+    template<typename S = Source, typename = std::enable_if_t<is_sized<std::decay_t<S>>::value>>
+    size_t size() const { return source_.size(); }
+};
+
+template<typename Source, typename Pred>
+class FilterView {
+    Source source_;
+    Pred pred_;
+
+public:
+    using value_type = std::decay_t<decltype(*std::declval<view_iterator_t<Source>>())>;
+
+    class Iterator {
+        view_iterator_t<Source> it_;
+        view_iterator_t<Source> end_;
+        const Pred* pred_;
+        void skip() { while (it_ != end_ && !(*pred_)(*it_)) ++it_; }
+    public:
+        Iterator(view_iterator_t<Source> it, view_iterator_t<Source> end, const Pred* pred)
+            : it_(it), end_(end), pred_(pred) { skip(); }
+        Iterator& operator++() { ++it_; skip(); return *this; }
+        decltype(auto) operator*() const { return *it_; }
+        bool operator!=(const Iterator& other) const { return it_ != other.it_; }
+    };
+
+    FilterView(Source source, Pred pred) : source_(std::forward<Source>(source)), pred_(std::move(pred)) {}
+
+    Iterator begin() const { const auto& src = source_; return Iterator(std::begin(src), std::end(src), &pred_); }
+    Iterator end() const { const auto& src = source_; return Iterator(std::end(src), std::end(src), &pred_); }
+};
+
+template<typename First, typename Second>
+class ZipView {
+    First first_;
+    Second second_;
+
+public:
+    using value_type = std::pair<decltype(*std::declval<view_iterator_t<First>>()),
+                                 decltype(*std::declval<view_iterator_t<Second>>())>;
+
+    class Iterator {
+        view_iterator_t<First> a_;
+        view_iterator_t<Second> b_;
+    public:
+        Iterator(view_iterator_t<First> a, view_iterator_t<Second> b) : a_(a), b_(b) {}
+        Iterator& operator++() { ++a_; ++b_; return *this; }
+        value_type operator*() const { return value_type(*a_, *b_); }
+        // Stops at the end of the shorter source, as Python's zip()
+        bool operator!=(const Iterator& other) const { return a_ != other.a_ && b_ != other.b_; }
+    };
+
+    ZipView(First first, Second second) : first_(std::forward<First>(first)), second_(std::forward<Second>(second)) {}
+
+    Iterator begin() const { const auto& a = first_; const auto& b = second_; return Iterator(std::begin(a), std::begin(b)); }
+    Iterator end() const { const auto& a = first_; const auto& b = second_; return Iterator(std::end(a), std::end(b)); }
+
+    template<typename F = First, typename = std::enable_if_t<is_sized<std::decay_t<F>>::value && is_sized<std::decay_t<Second>>::value>>
+    size_t size() const { return std::min<size_t>(first_.size(), second_.size()); }
+};
+
+template<typename Source>
+class EnumerateView {
+    Source source_;
+
+public:
+    using value_type = std::pair<int, decltype(*std::declval<view_iterator_t<Source>>())>;
+
+    class Iterator {
+        view_iterator_t<Source> it_;
+        int index_;
+    public:
+        Iterator(view_iterator_t<Source> it, int index) : it_(it), index_(index) {}
+        Iterator& operator++() { ++it_; ++index_; return *this; }
+        value_type operator*() const { return value_type(index_, *it_); }
+        bool operator!=(const Iterator& other) const { return it_ != other.it_; }
+    };
+
+    explicit EnumerateView(Source source) : source_(std::forward<Source>(source)) {}
+
+    Iterator begin() const { const auto& src = source_; return Iterator(std::begin(src), 0); }
+    Iterator end() const { const auto& src = source_; return Iterator(std::end(src), 0); }
+
+    template<typename S = Source, typename = std::enable_if_t<is_sized<std::decay_t<S>>::value>>
+    size_t size() const { return source_.size(); }
+};
+
+template<typename Source, typename Func>
+MapView<Source, Func> map_view(Source&& source, Func func) {
+    return MapView<Source, Func>(std::forward<Source>(source), std::move(func));
+}
+
+template<typename Source, typename Pred>
+FilterView<Source, Pred> filter_view(Source&& source, Pred pred) {
+    return FilterView<Source, Pred>(std::forward<Source>(source), std::move(pred));
+}
+
+template<typename First, typename Second>
+ZipView<First, Second> zip(First&& first, Second&& second) {
+    return ZipView<First, Second>(std::forward<First>(first), std::forward<Second>(second));
+}
+
+template<typename Source>
+EnumerateView<Source> enumerate(Source&& source) {
+    return EnumerateView<Source>(std::forward<Source>(source));
+}
+
+// Reserve room for every element of a sized source (unfiltered comprehensions)
+template<typename Result, typename Source>
+void reserve_for(Result& result, const Source& source) {
+    if constexpr (is_sized<Source>::value) {
+        result.reserve(source.size());
+    }
+}
+
+// An element of a comprehension source: moved out when the source is a
+// temporary the helper owns, otherwise borrowed
+template<typename Source, typename T>
+decltype(auto) source_element(T& item) {
+    if constexpr (std::is_lvalue_reference_v<Source>) {
+        return item;
+    } else {
+        return std::move(item);
+    }
+}
+
+// ============================================================================
+// List Comprehension Helpers
+// ============================================================================
+
+// Sources are containers, Range or lazy views; each helper is the single loop
+// that drives the whole (fused) pipeline. Temporary sources (a call returning
+// a list) have their elements moved into the transform.
+template<typename Source, typename Func>
+auto list_comprehension(Source&& source, Func transform)
+    -> List<std::decay_t<decltype(transform(*std::begin(source)))>> {
+    List<std::decay_t<decltype(transform(*std::begin(source)))>> result;
+    reserve_for(result, source);
+    for (auto&& item : source) {
+        result.push_back(transform(source_element<Source>(item)));
+    }
+    return result;
+}
+
+template<typename Source, typename Func, typename Pred>
+auto list_comprehension(Source&& source, Func transform, Pred condition)
+    -> List<std::decay_t<decltype(transform(*std::begin(source)))>> {
+    List<std::decay_t<decltype(transform(*std::begin(source)))>> result;
+    for (auto&& item : source) {
+        if (condition(item)) {
+            result.push_back(transform(source_element<Source>(item)));
+        }
+    }
+    return result;
+}
+
+// A comprehension over a source of at most N elements (range(4), a short
+// literal), collected into inline storage
+template<size_t N, typename Source, typename Func>
+auto small_list_comprehension(Source&& source, Func transform)
+    -> SmallVector<std::decay_t<decltype(transform(*std::begin(source)))>, N> {
+    SmallVector<std::decay_t<decltype(transform(*std::begin(source)))>, N> result;
+    for (auto&& item : source) {
+        result.push_back(transform(source_element<Source>(item)));
+    }
+    return result;
+}
+
+// The converter emits these for comprehensions whose element and condition
+// expressions have no side effects. With MGEN_PARALLEL, large random-access
+// sources are transformed in chunks on the pool and the chunks are joined in
+// source order; otherwise they are list_comprehension.
+
+#ifdef MGEN_PARALLEL
+template<typename Source, typename Func, typename Pred>
+auto parallel_collect(const Source& source, const Func& transform, const Pred& condition)
+    -> List<std::decay_t<decltype(transform(*std::begin(source)))>> {
+    using T = std::decay_t<decltype(transform(*std::begin(source)))>;
+    size_t n = source.size();
+    size_t chunks = parallel_chunk_count(n);
+    auto first = std::begin(source);
+    std::vector<std::vector<T>> pieces(chunks);
+    parallel_for_ranges(n, chunks, [&](size_t chunk, size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            auto&& item = first[i];
+            if (condition(item)) {
+                pieces[chunk].push_back(transform(item));
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (const auto& piece : pieces) total += piece.size();
+    List<T> result;
+    result.reserve(total);
+    for (auto& piece : pieces) {
+        std::move(piece.begin(), piece.end(), std::back_inserter(result));
+    }
+    return result;
+}
+#endif  // MGEN_PARALLEL
+
+template<typename Source, typename Func>
+auto parallel_list_comprehension(const Source& source, Func transform)
+    -> List<std::decay_t<decltype(transform(*std::begin(source)))>> {
+#ifdef MGEN_PARALLEL
+    using T = std::decay_t<decltype(transform(*std::begin(source)))>;
+    if constexpr (is_parallel_source<Source>::value) {
+        if (use_parallel(source)) {
+            // vector<bool> packs bits, so its elements cannot be written from several threads
+            if constexpr (std::is_default_constructible_v<T> && !std::is_same_v<T, bool>) {
+                size_t n = source.size();
+                auto first = std::begin(source);
+                List<T> result(n);
+                parallel_for_ranges(n, parallel_chunk_count(n), [&](size_t, size_t lo, size_t hi) {
+                    for (size_t i = lo; i < hi; ++i) {
+                        result[i] = transform(first[i]);
+                    }
+                });
+                return result;
+            } else {
+                return parallel_collect(source, transform, [](const auto&) { return true; });
+            }
+        }
+    }
+#endif
+    return list_comprehension(source, transform);
+}
+
+template<typename Source, typename Func, typename Pred>
+auto parallel_list_comprehension(const Source& source, Func transform, Pred condition)
+    -> List<std::decay_t<decltype(transform(*std::begin(source)))>> {
+#ifdef MGEN_PARALLEL
+    if constexpr (is_parallel_source<Source>::value) {
+        if (use_parallel(source)) {
+            return parallel_collect(source, transform, condition);
+        }
+    }
+#endif
+    return list_comprehension(source, transform, condition);
+}
+
+// ============================================================================
+// Dict Comprehension Helpers
+// ============================================================================
+
+template<typename Source, typename Func>
+auto dict_comprehension(Source&& source, Func key_value_func)
+    -> Dict<std::decay_t<decltype(key_value_func(*std::begin(source)).first)>,
+            std::decay_t<decltype(key_value_func(*std::begin(source)).second)>> {
+    Dict<std::decay_t<decltype(key_value_func(*std::begin(source)).first)>,
+         std::decay_t<decltype(key_value_func(*std::begin(source)).second)>> result;
+    reserve_for(result, source);
+    for (auto&& item : source) {
+        auto pair = key_value_func(source_element<Source>(item));
+        result[std::move(pair.first)] = std::move(pair.second);
+    }
+    return result;
+}
+
+template<typename Source, typename Func, typename Pred>
+auto dict_comprehension(Source&& source, Func key_value_func, Pred condition)
+    -> Dict<std::decay_t<decltype(key_value_func(*std::begin(source)).first)>,
+            std::decay_t<decltype(key_value_func(*std::begin(source)).second)>> {
+    Dict<std::decay_t<decltype(key_value_func(*std::begin(source)).first)>,
+         std::decay_t<decltype(key_value_func(*std::begin(source)).second)>> result;
+    for (auto&& item : source) {
+        if (condition(item)) {
+            auto pair = key_value_func(source_element<Source>(item));
+            result[std::move(pair.first)] = std::move(pair.second);
+        }
+    }
+    return result;
+}
+
+// ============================================================================
+// Set Comprehension Helpers
+// ============================================================================
+
+template<typename Source, typename Func>
+auto set_comprehension(Source&& source, Func transform)
+    -> Set<std::decay_t<decltype(transform(*std::begin(source)))>> {
+    Set<std::decay_t<decltype(transform(*std::begin(source)))>> result;
+    reserve_for(result, source);
+    for (auto&& item : source) {
+        result.insert(transform(source_element<Source>(item)));
+    }
+    return result;
+}
+
+template<typename Source, typename Func, typename Pred>
+auto set_comprehension(Source&& source, Func transform, Pred condition)
+    -> Set<std::decay_t<decltype(transform(*std::begin(source)))>> {
+    Set<std::decay_t<decltype(transform(*std::begin(source)))>> result;
+    for (auto&& item : source) {
+        if (condition(item)) {
+            result.insert(transform(source_element<Source>(item)));
+        }
+    }
+    return result;
+}
+
+// ============================================================================
+// Dictionary Helper Functions
+// ============================================================================
+
+// keys(), values() and items() are views over the map, as in Python: nothing
+// is copied, elements are references into the map. A temporary map is moved
+// into the view, which then owns it.
+
+template<typename Map>
+auto keys(Map&& map) {
+    return map_view(std::forward<Map>(map), [](const auto& item) -> const auto& { return item.first; });
+}
+
+template<typename Map>
+auto values(Map&& map) {
+    return map_view(std::forward<Map>(map), [](const auto& item) -> const auto& { return item.second; });
+}
+
+template<typename Map>
+auto items(Map&& map) {
+    return map_view(std::forward<Map>(map), [](const auto& item) -> const auto& { return item; });
 }
 
 } // namespace mgen
@@ -1,8 +1,10 @@
 """Enhanced Go code emitter for MGen with comprehensive Python language support."""
 
 import ast
-from typing import Any, Optional
+from collections.abc import Callable
+from typing import Any, Optional, Union
 
+from ...frontend.dict_updates import DictUpdate, match_dict_update
 from ..converter_utils import (
     get_augmented_assignment_operator,
     get_standard_binary_operator,
@@ -11,6 +13,21 @@ from ..converter_utils import (
 from ..errors import TypeMappingError, UnsupportedFeatureError
 from ..type_inference_strategies import InferenceContext
 
+# The variable a comprehension's function literal builds its result in: no Python name starts with it
+COMPREHENSION_RESULT = "mgenResult"
+
+
+def _split_map_type(map_type: str) -> tuple[str, str]:
+    """The key and value types of a Go map type (interface{} for either if it is not one)."""
+    if not map_type.startswith("map["):
+        return "interface{}", "interface{}"
+    depth = 0
+    for index in range(3, len(map_type)):
+        depth += {"[": 1, "]": -1}.get(map_type[index], 0)
+        if depth == 0:
+            return map_type[4:index], map_type[index + 1 :]
+    return "interface{}", "interface{}"
+
 
 class MGenPythonToGoConverter:
     """Sophisticated Python-to-Go converter with comprehensive language support."""
@@ -984,6 +1001,9 @@ class MGenPythonToGoConverter:
 
     def _convert_statement(self, stmt: ast.stmt) -> str:
         """Convert a Python statement to Go."""
+        update = match_dict_update(stmt)
+        if update is not None and update.default_is_zero and self._is_numeric_map(update.container):
+            return self._convert_dict_update(update)
         if isinstance(stmt, ast.Return):
             return self._convert_return(stmt)
         elif isinstance(stmt, ast.Assign):
@@ -1183,6 +1203,19 @@ class MGenPythonToGoConverter:
 
         raise UnsupportedFeatureError(f"Complex augmented assignment target not supported: {ast.unparse(stmt.target)}")
 
+    def _is_numeric_map(self, name: str) -> bool:
+        """Whether name is a map with int or float64 values."""
+        map_type = self.variable_types.get(name, "")
+        return map_type.startswith("map[") and map_type.endswith(("]int", "]float64"))
+
+    def _convert_dict_update(self, update: DictUpdate) -> str:
+        """Convert a counting update into one map access (a missing key reads as 0)."""
+        key = self._convert_expression(update.key)
+        increment = update.increment
+        if isinstance(increment, ast.Constant) and type(increment.value) is int and increment.value == 1:
+            return f"    {update.container}[{key}]++"
+        return f"    {update.container}[{key}] += {self._convert_expression(increment)}"
+
     def _convert_if(self, stmt: ast.If) -> str:
         """Convert if statement."""
         condition = self._convert_expression(stmt.test)
@@ -1214,33 +1247,20 @@ class MGenPythonToGoConverter:
             range_args = [self._convert_expression(arg) for arg in stmt.iter.args]
             target_name = stmt.target.id if isinstance(stmt.target, ast.Name) else "i"
 
-            if len(range_args) == 1:
-                # range(n)
-                stop = range_args[0]
-                body = self._convert_statements(stmt.body)
-                return f"    for {target_name} := 0; {target_name} < {stop}; {target_name}++ {{\n{body}\n    }}"
-            elif len(range_args) == 2:
-                # range(start, stop)
-                start, stop = range_args
-                body = self._convert_statements(stmt.body)
-                return f"    for {target_name} := {start}; {target_name} < {stop}; {target_name}++ {{\n{body}\n    }}"
-            elif len(range_args) == 3:
-                # range(start, stop, step)
-                start, stop, step = range_args
-                body = self._convert_statements(stmt.body)
-                return f"    for {target_name} := {start}; {target_name} < {stop}; {target_name} += {step} {{\n{body}\n    }}"
-            else:
+            body = self._convert_statements(stmt.body)
+            if not 1 <= len(range_args) <= 3:
                 # Invalid range arguments
-                body = self._convert_statements(stmt.body)
                 return (
                     f"    for {target_name} := 0; {target_name} < 0; {target_name}++ {{\n{body}\n    }}"  # Empty loop
                 )
+            start, stop, step = ("0", range_args[0], "1") if len(range_args) == 1 else (range_args + ["1"])[:3]
+            header = self._range_loop_header(target_name, start, stop, step, stmt.iter.args)
+            return f"    {header} {{\n{body}\n    }}"
         else:
             # Iteration over container
-            container_expr = self._convert_expression(stmt.iter)
-            target_name = stmt.target.id if isinstance(stmt.target, ast.Name) else "item"
+            header, _ = self._range_over_container(stmt.target, stmt.iter, list(stmt.body))
             body = self._convert_statements(stmt.body)
-            return f"    for _, {target_name} := range {container_expr} {{\n{body}\n    }}"
+            return f"    {header} {{\n{body}\n    }}"
 
     def _convert_expression_statement(self, stmt: ast.Expr) -> str:
         """Convert expression statement."""
@@ -1597,177 +1617,154 @@ class MGenPythonToGoConverter:
         return f"map[interface{{}}]bool{{{{{elements_str}}}}}"
 
     def _convert_list_comprehension(self, expr: ast.ListComp) -> str:
-        """Convert list comprehensions using Go 1.18+ generics."""
-        # Extract comprehension components
-        element_expr = expr.elt
-        target = expr.generators[0].target
-        iter_expr = expr.generators[0].iter
-        conditions = expr.generators[0].ifs
+        """Convert a list comprehension to plain for loops appending to a preallocated slice."""
+        loop_var_types = self._comprehension_variable_types(expr.generators)
+        result_type = self._infer_comprehension_element_type(expr.elt, loop_var_types)
+        item = self._convert_expression(expr.elt)
+        return self._inline_comprehension(
+            expr,
+            f"[]{result_type}",
+            lambda size: f"make([]{result_type}, 0, {size})",
+            f"{COMPREHENSION_RESULT} = append({COMPREHENSION_RESULT}, {item})",
+        )
 
-        # Infer result type from element expression with loop variable context
-        loop_var_types = self._infer_loop_variable_type(expr.generators[0])
-        result_type = self._infer_comprehension_element_type(element_expr, loop_var_types)
+    def _convert_dict_comprehension(self, expr: ast.DictComp) -> str:
+        """Convert a dict comprehension to plain for loops filling a presized map."""
+        loop_var_types = self._comprehension_variable_types(expr.generators)
+        key_type = self._infer_comprehension_element_type(expr.key, loop_var_types)
+        value_type = self._infer_comprehension_element_type(expr.value, loop_var_types)
+        key = self._convert_expression(expr.key)
+        value = self._convert_expression(expr.value)
+        return self._inline_comprehension(
+            expr,
+            f"map[{key_type}]{value_type}",
+            lambda size: f"make(map[{key_type}]{value_type}, {size})",
+            f"{COMPREHENSION_RESULT}[{key}] = {value}",
+        )
 
-        if isinstance(iter_expr, ast.Call) and isinstance(iter_expr.func, ast.Name) and iter_expr.func.id == "range":
-            # Range-based comprehension
-            range_args = [self._convert_expression(arg) for arg in iter_expr.args]
-            range_call = f"mgen.NewRange({', '.join(range_args)})"
-
-            # Create transform function with proper types
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-            transform_expr = self._convert_expression(element_expr)
-            transform_lambda = f"func({target_name} int) {result_type} {{ return {transform_expr} }}"
-
-            if conditions:
-                # With condition
-                condition_expr = self._convert_expression(conditions[0])
-                condition_lambda = f"func({target_name} int) bool {{ return {condition_expr} }}"
-                return f"mgen.ListComprehensionFromRangeWithFilter[{result_type}]({range_call}, {transform_lambda}, {condition_lambda})"
-            else:
-                # No condition
-                return f"mgen.ListComprehensionFromRange[{result_type}]({range_call}, {transform_lambda})"
-        else:
-            # Container iteration - need to infer source type
-            source_type = self._infer_type_from_value(iter_expr)
-            # Extract element type from slice type (e.g., []int -> int)
-            element_type = source_type[2:] if source_type.startswith("[]") else "interface{}"
-
-            container_expr = self._convert_expression(iter_expr)
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-            transform_expr = self._convert_expression(element_expr)
-            transform_lambda = f"func({target_name} {element_type}) {result_type} {{ return {transform_expr} }}"
-
-            if conditions:
-                condition_expr = self._convert_expression(conditions[0])
-                condition_lambda = f"func({target_name} {element_type}) bool {{ return {condition_expr} }}"
-                return f"mgen.ListComprehensionWithFilter[{element_type}, {result_type}]({container_expr}, {transform_lambda}, {condition_lambda})"
-            else:
-                return f"mgen.ListComprehension[{element_type}, {result_type}]({container_expr}, {transform_lambda})"
+    def _convert_set_comprehension(self, expr: ast.SetComp) -> str:
+        """Convert a set comprehension to plain for loops filling a presized map[T]bool."""
+        loop_var_types = self._comprehension_variable_types(expr.generators)
+        element_type = self._infer_comprehension_element_type(expr.elt, loop_var_types)
+        element = self._convert_expression(expr.elt)
+        return self._inline_comprehension(
+            expr,
+            f"map[{element_type}]bool",
+            lambda size: f"make(map[{element_type}]bool, {size})",
+            f"{COMPREHENSION_RESULT}[{element}] = true",
+        )
 
-    def _convert_dict_comprehension(self, expr: ast.DictComp) -> str:
-        """Convert dictionary comprehensions using Go 1.18+ generics."""
-        # Extract comprehension components
-        key_expr = expr.key
-        value_expr = expr.value
-        target = expr.generators[0].target
-        iter_expr = expr.generators[0].iter
-
-        # Infer key and value types with loop variable context
-        loop_var_types = self._infer_loop_variable_type(expr.generators[0])
-        key_type = self._infer_comprehension_element_type(key_expr, loop_var_types)
-        value_type = self._infer_comprehension_element_type(value_expr, loop_var_types)
+    def _inline_comprehension(
+        self,
+        expr: Union[ast.ListComp, ast.DictComp, ast.SetComp],
+        result_type: str,
+        make: Callable[[str], str],
+        store: str,
+    ) -> str:
+        """Build a comprehension's result with for loops in an immediately called function literal.
+
+        The literal is one call per comprehension (which the Go compiler
+        inlines), instead of the runtime helpers' closure call per item. With
+        a single generator the result is created with room for every item it
+        can visit: the range length, or the len() of the source.
+        """
+        body = store
+        size = "0"
+        for generator in reversed(expr.generators):
+            if generator.ifs:
+                condition = " && ".join(f"({self._convert_expression(test)})" for test in generator.ifs)
+                body = f"if {condition} {{ {body} }}"
+            header, size = self._comprehension_loop(generator, expr)
+            body = f"{header} {{ {body} }}"
+        if len(expr.generators) > 1:
+            size = "0"
+        return (
+            f"func() {result_type} {{ {COMPREHENSION_RESULT} := {make(size)}; {body}; "
+            f"return {COMPREHENSION_RESULT} }}()"
+        )
 
+    def _comprehension_loop(
+        self, generator: ast.comprehension, comprehension: ast.expr
+    ) -> tuple[str, str]:
+        """The for header iterating one generator of a comprehension, and how many items it visits."""
+        target = generator.target
+        iter_expr = generator.iter
         if isinstance(iter_expr, ast.Call) and isinstance(iter_expr.func, ast.Name) and iter_expr.func.id == "range":
-            range_args = [self._convert_expression(arg) for arg in iter_expr.args]
-            range_call = f"mgen.NewRange({', '.join(range_args)})"
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-
-            key_transform = self._convert_expression(key_expr)
-            value_transform = self._convert_expression(value_expr)
-            transform_lambda = (
-                f"func({target_name} int) ({key_type}, {value_type}) {{ return {key_transform}, {value_transform} }}"
+            args = [self._convert_expression(arg) for arg in iter_expr.args]
+            start, stop, step = ("0", args[0], "1") if len(args) == 1 else (args + ["1"])[:3]
+            variable = target.id if isinstance(target, ast.Name) else "i"
+            return self._range_loop_header(variable, start, stop, step, iter_expr.args), (
+                f"mgen.RangeLen({start}, {stop}, {step})"
             )
 
-            return f"mgen.DictComprehensionFromRange[{key_type}, {value_type}]({range_call}, {transform_lambda})"
-        else:
-            # Handle tuple unpacking for dict iteration: {k: v for k, v in dict.items()}
-            if isinstance(target, ast.Tuple) and len(target.elts) == 2:
-                # Tuple unpacking from .items()
-                key_var = target.elts[0].id if isinstance(target.elts[0], ast.Name) else "k"
-                value_var = target.elts[1].id if isinstance(target.elts[1], ast.Name) else "v"
-
-                # Convert dict.items() to mgen.MapItems() call that returns []KV struct
-                container_expr = self._convert_expression(iter_expr)
-                key_transform = self._convert_expression(key_expr)
-                value_transform = self._convert_expression(value_expr)
-
-                # For Go, we need to convert map to slice of key-value pairs
-                # The mgen.MapItems() function will handle this
-                transform_lambda = f"func(kv mgen.KV[{key_type}, {value_type}]) ({key_type}, {value_type}) {{ {key_var}, {value_var} := kv.Key, kv.Value; return {key_transform}, {value_transform} }}"
-
-                # Check if we need to handle filtering
-                conditions = expr.generators[0].ifs
-                if conditions:
-                    condition_expr = self._convert_expression(conditions[0])
-                    # Detect which variables are used in the condition
-                    key_used = key_var in condition_expr
-                    value_used = value_var in condition_expr
-                    key_assign = key_var if key_used else "_"
-                    value_assign = value_var if value_used else "_"
-                    filter_lambda = f"func(kv mgen.KV[{key_type}, {value_type}]) bool {{ {key_assign}, {value_assign} := kv.Key, kv.Value; return {condition_expr} }}"
-                    return f"mgen.DictComprehensionWithFilter[mgen.KV[{key_type}, {value_type}], {key_type}, {value_type}]({container_expr}, {transform_lambda}, {filter_lambda})"
-                else:
-                    return f"mgen.DictComprehension[mgen.KV[{key_type}, {value_type}], {key_type}, {value_type}]({container_expr}, {transform_lambda})"
-            else:
-                # Non-tuple unpacking case
-                source_type = self._infer_type_from_value(iter_expr)
-                element_type = source_type[2:] if source_type.startswith("[]") else "interface{}"
-
-                container_expr = self._convert_expression(iter_expr)
-                target_name = target.id if isinstance(target, ast.Name) else "x"
-                key_transform = self._convert_expression(key_expr)
-                value_transform = self._convert_expression(value_expr)
-                transform_lambda = f"func({target_name} {element_type}) ({key_type}, {value_type}) {{ return {key_transform}, {value_transform} }}"
+        header, container = self._range_over_container(target, iter_expr, [comprehension])
+        return header, f"len({container})"
 
-                return f"mgen.DictComprehension[{element_type}, {key_type}, {value_type}]({container_expr}, {transform_lambda})"
+    def _range_over_container(self, target: ast.expr, iter_expr: ast.expr, scope: list[ast.AST]) -> tuple[str, str]:
+        """The Go for ... range header iterating a container, and the container expression.
 
-    def _convert_set_comprehension(self, expr: ast.SetComp) -> str:
-        """Convert set comprehensions using Go 1.18+ generics."""
-        # Extract comprehension components
-        element_expr = expr.elt
-        target = expr.generators[0].target
-        iter_expr = expr.generators[0].iter
-
-        # Infer element type for the set with loop variable context
-        loop_var_types = self._infer_loop_variable_type(expr.generators[0])
-        element_type = self._infer_comprehension_element_type(element_expr, loop_var_types)
+        dict.items(), keys() and values() range over the map itself instead of
+        a copy of its items; sets (map[T]bool) and dicts iterate their keys.
+        Loop variables unused in scope become _, since Go rejects them.
+        """
 
-        if isinstance(iter_expr, ast.Call) and isinstance(iter_expr.func, ast.Name) and iter_expr.func.id == "range":
-            range_args = [self._convert_expression(arg) for arg in iter_expr.args]
-            range_call = f"mgen.NewRange({', '.join(range_args)})"
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-            transform_expr = self._convert_expression(element_expr)
-            transform_lambda = f"func({target_name} int) {element_type} {{ return {transform_expr} }}"
+        def name(node: ast.expr) -> str:
+            if not isinstance(node, ast.Name):
+                return "_"
+            used = any(
+                isinstance(use, ast.Name) and use.id == node.id and isinstance(use.ctx, ast.Load)
+                for tree in scope
+                for use in ast.walk(tree)
+            )
+            return node.id if used else "_"
 
-            return f"mgen.SetComprehensionFromRange[{element_type}]({range_call}, {transform_lambda})"
+        if (
+            isinstance(iter_expr, ast.Call)
+            and isinstance(iter_expr.func, ast.Attribute)
+            and iter_expr.func.attr in ("items", "keys", "values")
+            and not iter_expr.args
+        ):
+            container = self._convert_expression(iter_expr.func.value)
+            method = iter_expr.func.attr
+            if method == "items" and isinstance(target, ast.Tuple) and len(target.elts) == 2:
+                variables = f"{name(target.elts[0])}, {name(target.elts[1])}"
+            elif method == "values":
+                variables = f"_, {name(target)}"
+            else:
+                variables = name(target)
         else:
-            source_type = self._infer_type_from_value(iter_expr)
-            container_expr = self._convert_expression(iter_expr)
-            target_name = target.id if isinstance(target, ast.Name) else "x"
-            transform_expr = self._convert_expression(element_expr)
-
-            # Extract element type from source (handle both slices and sets)
-            if source_type.startswith("[]"):
-                # Slice type: []int → int
-                source_element_type = source_type[2:]
-                transform_lambda = (
-                    f"func({target_name} {source_element_type}) {element_type} {{ return {transform_expr} }}"
-                )
-                return f"mgen.SetComprehension[{source_element_type}, {element_type}]({container_expr}, {transform_lambda})"
-            elif source_type.startswith("map[") and source_type.endswith("]bool"):
-                # Set type: map[int]bool → int - use SetComprehensionFromSet
-                source_element_type = source_type[4:-5]  # Remove "map[" prefix and "]bool" suffix
-                transform_lambda = (
-                    f"func({target_name} {source_element_type}) {element_type} {{ return {transform_expr} }}"
-                )
-
-                # Check if there's a filter condition
-                if expr.generators[0].ifs:
-                    # Has filter - use SetComprehensionFromSetWithFilter
-                    filter_conditions = " && ".join(
-                        [self._convert_expression(if_expr) for if_expr in expr.generators[0].ifs]
-                    )
-                    filter_lambda = f"func({target_name} {source_element_type}) bool {{ return {filter_conditions} }}"
-                    return f"mgen.SetComprehensionFromSetWithFilter[{source_element_type}, {element_type}]({container_expr}, {filter_lambda}, {transform_lambda})"
-                else:
-                    # No filter - use SetComprehensionFromSet
-                    return f"mgen.SetComprehensionFromSet[{source_element_type}, {element_type}]({container_expr}, {transform_lambda})"
+            container = self._convert_expression(iter_expr)
+            if self._infer_type_from_value(iter_expr).startswith("map["):
+                variables = name(target)
             else:
-                source_element_type = "interface{}"
-                transform_lambda = (
-                    f"func({target_name} {source_element_type}) {element_type} {{ return {transform_expr} }}"
-                )
-                return f"mgen.SetComprehension[{source_element_type}, {element_type}]({container_expr}, {transform_lambda})"
+                variables = f"_, {name(target)}"
+        if variables in ("_", "_, _"):
+            return f"for range {container}", container
+        return f"for {variables} := range {container}", container
+
+    def _range_loop_header(self, variable: str, start: str, stop: str, step: str, args: list[ast.expr]) -> str:
+        """The Go for header counting variable through range(start, stop, step)."""
+        if step == "1":
+            return f"for {variable} := {start}; {variable} < {stop}; {variable}++"
+        step_node = args[2] if len(args) == 3 else None
+        if (
+            isinstance(step_node, ast.UnaryOp)
+            and isinstance(step_node.op, ast.USub)
+            and isinstance(step_node.operand, ast.Constant)
+        ):
+            return f"for {variable} := {start}; {variable} > {stop}; {variable} += {step}"
+        if isinstance(step_node, ast.Constant):
+            return f"for {variable} := {start}; {variable} < {stop}; {variable} += {step}"
+        # The direction is only known at run time
+        condition = f"({step} > 0 && {variable} < {stop}) || ({step} < 0 && {variable} > {stop})"
+        return f"for {variable} := {start}; {condition}; {variable} += {step}"
+
+    def _comprehension_variable_types(self, generators: list[ast.comprehension]) -> dict[str, str]:
+        """The Go types of the variables every generator of a comprehension binds."""
+        types: dict[str, str] = {}
+        for generator in generators:
+            types.update(self._infer_loop_variable_type(generator))
+        return types
 
     def _convert_subscript(self, expr: ast.Subscript) -> str:
         """Convert subscript operation to Go array/map access."""
@@ -1879,7 +1876,23 @@ class MGenPythonToGoConverter:
         iter_expr = generator.iter
 
         loop_var_types = {}
-        if isinstance(target, ast.Name):
+        map_method = (
+            iter_expr.func.attr
+            if isinstance(iter_expr, ast.Call)
+            and isinstance(iter_expr.func, ast.Attribute)
+            and iter_expr.func.attr in ("items", "keys", "values")
+            else None
+        )
+        if map_method is not None:
+            assert isinstance(iter_expr, ast.Call) and isinstance(iter_expr.func, ast.Attribute)
+            key_type, value_type = _split_map_type(self._infer_type_from_value(iter_expr.func.value))
+            if map_method == "items" and isinstance(target, ast.Tuple) and len(target.elts) == 2:
+                for element, element_type in zip(target.elts, (key_type, value_type)):
+                    if isinstance(element, ast.Name):
+                        loop_var_types[element.id] = element_type
+            elif isinstance(target, ast.Name):
+                loop_var_types[target.id] = value_type if map_method == "values" else key_type
+        elif isinstance(target, ast.Name):
             # Infer type from iterator
             if (
                 isinstance(iter_expr, ast.Call)
@@ -1895,10 +1908,9 @@ class MGenPythonToGoConverter:
                     # Slice type: []int → int
                     element_type = iter_type[2:]
                     loop_var_types[target.id] = element_type
-                elif iter_type.startswith("map[") and iter_type.endswith("]bool"):
-                    # Set type: map[int]bool → int
-                    element_type = iter_type[4:-5]
-                    loop_var_types[target.id] = element_type
+                elif iter_type.startswith("map["):
+                    # Set type: map[int]bool → int, and a dict iterates its keys
+                    loop_var_types[target.id] = _split_map_type(iter_type)[0]
                 else:
                     loop_var_types[target.id] = "interface{}"
         return loop_var_types
@@ -1941,6 +1953,8 @@ class MGenPythonToGoConverter:
                 attr_name = expr.func.attr
                 if attr_name in ("upper", "lower", "strip", "replace"):
                     return "string"
+            elif isinstance(expr.func, ast.Name) and expr.func.id == "str":
+                return "string"
             return "int"  # Default
 
         return "int"  # Default to int
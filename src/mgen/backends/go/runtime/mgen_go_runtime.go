@@ -186,13 +186,29 @@ func NewRange(args ...int) Range {
 	}
 }
 
-// ToSlice converts range to integer slice
-func (r Range) ToSlice() []int {
-	if r.Step == 0 {
+// RangeLen returns how many values range(start, stop, step) yields; generated
+// comprehensions over ranges preallocate their results with it
+func RangeLen(start, stop, step int) int {
+	if step == 0 {
 		panic("range() step cannot be zero")
 	}
+	if step > 0 && start < stop {
+		return (stop - start + step - 1) / step
+	}
+	if step < 0 && start > stop {
+		return (start - stop - step - 1) / -step
+	}
+	return 0
+}
 
-	result := []int{}
+// Len returns how many values the range yields
+func (r Range) Len() int {
+	return RangeLen(r.Start, r.Stop, r.Step)
+}
+
+// ToSlice converts range to integer slice
+func (r Range) ToSlice() []int {
+	result := make([]int, 0, r.Len())
 	if r.Step > 0 {
 		for i := r.Start; i < r.Stop; i += r.Step {
 			result = append(result, i)
@@ -235,7 +251,7 @@ func ListComprehension[T any, R any](source []T, transform func(T) R) []R {
 
 // ListComprehensionFromRange creates slice from a Range
 func ListComprehensionFromRange[R any](source Range, transform func(int) R) []R {
-	result := []R{}
+	result := make([]R, 0, source.Len())
 	source.ForEach(func(i int) {
 		result = append(result, transform(i))
 	})
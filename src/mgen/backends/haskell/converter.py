@@ -139,6 +139,9 @@ class MGenPythonToHaskellConverter:
             extensions.append("{-# LANGUAGE OverloadedStrings #-}")
         if self.needed_imports:
             extensions.append("{-# LANGUAGE FlexibleInstances #-}")
+        if any(isinstance(child, ast.For) for child in ast.walk(node)):
+            # Loops become folds whose accumulators are bang patterns
+            extensions.append("{-# LANGUAGE BangPatterns #-}")
 
         if extensions:
             parts.extend(extensions)
@@ -152,9 +155,10 @@ class MGenPythonToHaskellConverter:
         base_imports = [
             "import MGenRuntime",
             "import Control.Monad (foldM)",
-            "import qualified Data.Map as Map",
+            "import Data.List (foldl')",
+            "import qualified Data.Map.Strict as Map",
             "import qualified Data.Set as Set",
-            "import Data.Map (Map)",
+            "import Data.Map.Strict (Map)",
             "import Data.Set (Set)",
         ]
 
@@ -1242,7 +1246,7 @@ main = printValue "Generated Haskell code executed successfully"'''
                                 return f"{result_var} = [[sum' [{accum_expr} | {k_var} <- {k_iterable}] | {j_var} <- {j_iterable}] | {var_name} <- {iterable}]"
                             else:
                                 # In IO context, generate using foldM
-                                return f"{result_var} <- foldM (\\acc {var_name} -> return (acc ++ [[sum' [{accum_expr} | {k_var} <- {k_iterable}] | {j_var} <- {j_iterable}]])) {result_var} ({iterable})"
+                                return f"{result_var} <- foldM (\\ !acc {var_name} -> return (acc ++ [[sum' [{accum_expr} | {k_var} <- {k_iterable}] | {j_var} <- {j_iterable}]])) {result_var} ({iterable})"
 
             # Detect word count pattern: for item in list: transform, then update dict
             if (
@@ -1295,10 +1299,10 @@ main = printValue "Generated Haskell code executed successfully"'''
 
                     # Generate fold for word count pattern
                     if dict_var and key_var and self.current_function != "main":
-                        # Pure context - use foldl with Map operations
+                        # Pure context - use foldl' with Map operations
                         # Use Map.empty as initial accumulator (assuming dict was initialized to empty)
                         return (
-                            f"{dict_var} = foldl (\\acc {var_name} -> let {key_var} = {key_expr} in "
+                            f"{dict_var} = foldl' (\\acc {var_name} -> let {key_var} = {key_expr} in "
                             f"Map.insertWith (+) {key_var} 1 acc) Map.empty ({iterable})"
                         )
 
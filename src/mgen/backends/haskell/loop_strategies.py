@@ -2,6 +2,10 @@
 
 Extends the base loop conversion system with Haskell-specific patterns
 like foldl/foldM, list comprehensions, and do-notation.
+
+Pure loops use the strict foldl', and foldM lambdas take the accumulator
+as a bang pattern, so loop-carried state is evaluated on every iteration
+instead of accumulating thunks.
 """
 
 import ast
@@ -126,7 +130,7 @@ class HaskellNestedListBuildingStrategy(ForLoopStrategy):
             return f"{matrix_var} = [[{append_expr} | {inner_var} <- {inner_iterable}] | {var_name} <- {iterable}]"
         else:
             # In IO context, use foldM
-            return f"{matrix_var} <- foldM (\\acc {var_name} -> return (acc ++ [[{append_expr} | {inner_var} <- {inner_iterable}]])) {matrix_var} ({iterable})"
+            return f"{matrix_var} <- foldM (\\ !acc {var_name} -> return (acc ++ [[{append_expr} | {inner_var} <- {inner_iterable}]])) {matrix_var} ({iterable})"
 
 
 class HaskellListAppendStrategy(ForLoopStrategy):
@@ -137,8 +141,8 @@ class HaskellListAppendStrategy(ForLoopStrategy):
             list.append(expr)
 
     Converts to:
-        list = foldl (\\acc i -> acc ++ [expr]) list iter  (pure)
-        list <- foldM (\\acc i -> return (acc ++ [expr])) list iter  (IO)
+        list = foldl' (\\acc i -> acc ++ [expr]) list iter  (pure)
+        list <- foldM (\\ !acc i -> return (acc ++ [expr])) list iter  (IO)
     """
 
     def can_handle(self, node: ast.For, context: LoopContext) -> bool:
@@ -159,7 +163,7 @@ class HaskellListAppendStrategy(ForLoopStrategy):
         )
 
     def convert(self, node: ast.For, context: LoopContext) -> str:
-        """Convert list append to foldl/foldM."""
+        """Convert list append to foldl'/foldM."""
         converter: MGenPythonToHaskellConverter = context.converter  # type: ignore
 
         var_name = converter._to_haskell_var_name(node.target.id) if isinstance(node.target, ast.Name) else "i"
@@ -173,9 +177,9 @@ class HaskellListAppendStrategy(ForLoopStrategy):
         append_expr = converter._convert_expression(call.args[0])
 
         if context.current_function != "main":
-            return f"{list_var} = foldl (\\acc {var_name} -> acc ++ [{append_expr}]) {list_var} ({iterable})"
+            return f"{list_var} = foldl' (\\acc {var_name} -> acc ++ [{append_expr}]) {list_var} ({iterable})"
         else:
-            return f"{list_var} <- foldM (\\acc {var_name} -> return (acc ++ [{append_expr}])) {list_var} ({iterable})"
+            return f"{list_var} <- foldM (\\ !acc {var_name} -> return (acc ++ [{append_expr}])) {list_var} ({iterable})"
 
 
 class HaskellAccumulationStrategy(ForLoopStrategy):
@@ -186,8 +190,8 @@ class HaskellAccumulationStrategy(ForLoopStrategy):
             var += expr
 
     Converts to:
-        var = foldl (\\acc i -> acc + expr) var iter  (pure)
-        var <- foldM (\\acc i -> return (acc + expr)) var iter  (IO)
+        var = foldl' (\\acc i -> acc + expr) var iter  (pure)
+        var <- foldM (\\ !acc i -> return (acc + expr)) var iter  (IO)
     """
 
     def can_handle(self, node: ast.For, context: LoopContext) -> bool:
@@ -199,7 +203,7 @@ class HaskellAccumulationStrategy(ForLoopStrategy):
         return isinstance(stmt, ast.AugAssign) and isinstance(stmt.target, ast.Name)
 
     def convert(self, node: ast.For, context: LoopContext) -> str:
-        """Convert accumulation to foldl/foldM."""
+        """Convert accumulation to foldl'/foldM."""
         converter: MGenPythonToHaskellConverter = context.converter  # type: ignore
 
         var_name = converter._to_haskell_var_name(node.target.id) if isinstance(node.target, ast.Name) else "i"
@@ -212,9 +216,9 @@ class HaskellAccumulationStrategy(ForLoopStrategy):
         op = converter._convert_operator(stmt.op)
 
         if context.current_function != "main":
-            return f"{var_name_target} = foldl (\\acc {var_name} -> acc {op} ({value_expr})) {var_name_target} ({iterable})"
+            return f"{var_name_target} = foldl' (\\acc {var_name} -> acc {op} ({value_expr})) {var_name_target} ({iterable})"
         else:
-            return f"{var_name_target} <- foldM (\\acc {var_name} -> return (acc {op} ({value_expr}))) {var_name_target} ({iterable})"
+            return f"{var_name_target} <- foldM (\\ !acc {var_name} -> return (acc {op} ({value_expr}))) {var_name_target} ({iterable})"
 
 
 class HaskellAssignmentInMainStrategy(ForLoopStrategy):
@@ -225,7 +229,7 @@ class HaskellAssignmentInMainStrategy(ForLoopStrategy):
             var = expr
 
     Converts to:
-        var <- foldM (\\acc i -> return (expr)) var iter
+        var <- foldM (\\ !acc i -> return (expr)) var iter
     """
 
     def can_handle(self, node: ast.For, context: LoopContext) -> bool:
@@ -251,7 +255,7 @@ class HaskellAssignmentInMainStrategy(ForLoopStrategy):
         updated_var = converter._to_haskell_var_name(stmt.targets[0].id)  # type: ignore
         value_expr = converter._convert_expression(stmt.value)
 
-        return f"{updated_var} <- foldM (\\acc {var_name} -> return ({value_expr})) {updated_var} ({iterable})"
+        return f"{updated_var} <- foldM (\\ !acc {var_name} -> return ({value_expr})) {updated_var} ({iterable})"
 
 
 def create_haskell_loop_converter() -> "ForLoopConverter":  # type: ignore[name-defined]
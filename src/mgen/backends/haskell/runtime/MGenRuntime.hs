@@ -1,3 +1,4 @@
+{-# LANGUAGE BangPatterns #-}
 {-# LANGUAGE OverloadedStrings #-}
 {-# LANGUAGE FlexibleInstances #-}
 {-# LANGUAGE TypeSynonymInstances #-}
@@ -14,6 +15,10 @@ Haskell's standard library and necessary language extensions. It supports
 string operations, comprehensions, built-in functions, and container operations
 that mirror Python's behavior while leveraging Haskell's type safety and
 functional programming paradigms.
+
+Dictionaries are value-strict ('Data.Map.Strict') and the folds below are
+strict left folds, so loop accumulators are evaluated as they are updated
+instead of building thunk chains.
 -}
 
 module MGenRuntime
@@ -41,9 +46,10 @@ module MGenRuntime
 
 import qualified Data.Char as Char
 import qualified Data.List as List
-import qualified Data.Map as Map
+import qualified Data.Map.Strict as Map
 import qualified Data.Set as Set
-import Data.Map (Map)
+import Data.List (foldl')
+import Data.Map.Strict (Map)
 import Data.Set (Set)
 
 
@@ -119,16 +125,16 @@ instance Len (Set a) where
 -- | Minimum function (Python's min())
 min' :: (Ord a) => [a] -> a
 min' [] = error "min() arg is an empty sequence"
-min' xs = minimum xs
+min' (x:xs) = foldl' min x xs
 
 -- | Maximum function (Python's max())
 max' :: (Ord a) => [a] -> a
 max' [] = error "max() arg is an empty sequence"
-max' xs = maximum xs
+max' (x:xs) = foldl' max x xs
 
 -- | Sum function (Python's sum())
 sum' :: (Num a) => [a] -> a
-sum' = sum
+sum' = foldl' (+) 0
 
 
 -- | Range type for Python-like range iteration
@@ -148,10 +154,12 @@ range3 = Range
 
 -- | Convert range to list for iteration
 rangeList :: Range -> [Int]
-rangeList (Range start stop step)
-    | step > 0 && start < stop = start : rangeList (Range (start + step) stop step)
-    | step < 0 && start > stop = start : rangeList (Range (start + step) stop step)
-    | otherwise = []
+rangeList (Range start stop step) = go start
+  where
+    go !i
+        | step > 0 && i < stop = i : go (i + step)
+        | step < 0 && i > stop = i : go (i + step)
+        | otherwise = []
 
 
 -- | Comprehensions module providing Python-like comprehensions
@@ -12,10 +12,27 @@ from ..base import AbstractBuilder
 class LLVMBuilder(AbstractBuilder):
     """Builder for compiling LLVM IR to native binaries."""
 
+    # Minimal C runtime linked into every program
+    RUNTIME_SOURCES = [
+        "vec_int_minimal.c",
+        "vec_vec_int_minimal.c",
+        "vec_str_minimal.c",
+        "map_str_int_minimal.c",
+        "map_int_int_minimal.c",
+        "set_int_minimal.c",
+        "mgen_llvm_string.c",
+    ]
+
+    # C backend container templates the int runtime wraps (the IR's int is i64),
+    # generated into the output directory next to the program
+    TEMPLATE_CONTAINERS = ["vec_i64", "set_i64", "map_i64_i64"]
+
     def __init__(self) -> None:
         """Initialize the LLVM builder."""
         self.llc_path = self._find_llvm_tool("llc")
         self.clang_path = self._find_llvm_tool("clang")
+        self.opt_path = self._find_llvm_tool("opt")
+        self.profdata_path = self._find_llvm_tool("llvm-profdata")
 
     def _find_llvm_tool(self, tool_name: str) -> str:
         """Find LLVM tool in common locations.
@@ -105,30 +122,64 @@ run: $(TARGET)
             **kwargs: Additional options:
                 - enable_asan (bool): Enable AddressSanitizer for memory error detection
                 - opt_level (int): Optimization level (0=O0, 1=O1, 2=O2, 3=O3, default=2)
+                - cpu (str): Target CPU: "native" for the host or an LLVM CPU name (default: generic baseline)
+                - features (str): LLVM feature overrides, e.g. "+avx2,-avx512f"
+                - pgo_generate (str): Build an instrumented binary that writes profiles into this directory
+                - pgo_use (str): Optimize with a profile: a .profdata file, or .profraw file(s) / a directory
+                  of them from a pgo_generate run (merged with llvm-profdata)
 
         Returns:
             True if compilation succeeded
         """
         enable_asan = kwargs.get("enable_asan", False)
         opt_level = kwargs.get("opt_level", 2)
+        cpu = kwargs.get("cpu")
+        features = kwargs.get("features")
+        pgo_generate = kwargs.get("pgo_generate")
+        pgo_use = kwargs.get("pgo_use")
         try:
             # Use absolute paths to avoid cwd issues
             source_path = Path(source_file).resolve()
             output_path = Path(output_dir).resolve()
             executable_name = source_path.stem
 
-            # Step 0: Apply LLVM optimization passes to IR
+            runtime_dir = Path(__file__).parent / "runtime"
+
+            # Step 0: Compile the runtime to bitcode, so the optimizer links it
+            # into the program and can inline its accessors. ASAN builds keep
+            # separately compiled (instrumented) runtime objects instead.
+            runtime_bitcode: list[bytes] = []
+            if not enable_asan:
+                bitcode_files = self._compile_runtime_bitcode(runtime_dir, output_path, opt_level)
+                if bitcode_files is None:
+                    return False
+                runtime_bitcode = [path.read_bytes() for path in bitcode_files]
+
+            # Step 1: Apply LLVM optimization passes to IR
             from .optimizer import LLVMOptimizer
 
             llvm_ir = source_path.read_text()
-            optimizer = LLVMOptimizer(opt_level=opt_level)
-            optimized_ir = optimizer.optimize(llvm_ir)
+            optimizer = LLVMOptimizer(opt_level=opt_level, cpu=cpu, features=features)
+
+            # PGO instruments or annotates the unoptimized program, so both runs
+            # see the same control flow and the passes below can use the weights
+            triple = optimizer.target_machine.triple
+            if pgo_generate:
+                pgo_ir = self._pgo_instrument(llvm_ir, triple, Path(pgo_generate).resolve(), executable_name)
+            elif pgo_use:
+                pgo_ir = self._pgo_annotate(llvm_ir, triple, Path(pgo_use).resolve(), output_path, executable_name)
+            else:
+                pgo_ir = llvm_ir
+            if pgo_ir is None:
+                return False
+
+            optimized_ir = optimizer.optimize(pgo_ir, runtime_bitcode=runtime_bitcode)
 
             # Write optimized IR to a new file
             optimized_path = output_path / f"{executable_name}.opt.ll"
             optimized_path.write_text(optimized_ir)
 
-            # Step 1: Compile optimized LLVM IR to object file using llc
+            # Step 2: Compile optimized LLVM IR to object file using llc
             object_file = output_path / f"{executable_name}.o"
             llc_cmd = [
                 self.llc_path,
@@ -137,51 +188,23 @@ run: $(TARGET)
                 "-o",
                 str(object_file),
             ]
+            # Generate code for the CPU the optimizer tuned for ("native" resolved to the host)
+            if optimizer.cpu_name:
+                llc_cmd.append(f"-mcpu={optimizer.cpu_name}")
+            if optimizer.cpu_features:
+                llc_cmd.append(f"-mattr={optimizer.cpu_features}")
 
             result = subprocess.run(llc_cmd, capture_output=True, text=True)
             if result.returncode != 0:
                 print(f"LLC compilation failed: {result.stderr}")
                 return False
 
-            # Step 2: Compile runtime libraries
-            runtime_dir = Path(__file__).parent / "runtime"
-            runtime_objects = []
-
-            # Compile each runtime C file
-            runtime_sources = [
-                "vec_int_minimal.c",
-                "vec_vec_int_minimal.c",
-                "vec_str_minimal.c",
-                "map_str_int_minimal.c",
-                "map_int_int_minimal.c",
-                "set_int_minimal.c",
-                "mgen_llvm_string.c",
-            ]
-
-            for runtime_source in runtime_sources:
-                runtime_c = runtime_dir / runtime_source
-                if runtime_c.exists():
-                    runtime_o = output_path / runtime_source.replace(".c", ".o")
-                    clang_compile_runtime_cmd = [
-                        self.clang_path,
-                        "-c",
-                        str(runtime_c),
-                        "-o",
-                        str(runtime_o),
-                        "-I",
-                        str(runtime_dir),  # Include runtime headers
-                    ]
-
-                    # Add ASAN flags if requested
-                    if enable_asan:
-                        clang_compile_runtime_cmd.extend(["-fsanitize=address", "-g"])
-
-                    result = subprocess.run(clang_compile_runtime_cmd, capture_output=True, text=True)
-                    if result.returncode != 0:
-                        print(f"Runtime compilation failed for {runtime_source}: {result.stderr}")
-                        return False
-
-                    runtime_objects.append(str(runtime_o))
+            runtime_objects: list[str] = []
+            if enable_asan:
+                asan_objects = self._compile_runtime_objects(runtime_dir, output_path, ["-fsanitize=address", "-g"])
+                if asan_objects is None:
+                    return False
+                runtime_objects = asan_objects
 
             # Step 3: Link object files to create executable using clang
             executable_path = output_path / executable_name
@@ -197,6 +220,10 @@ run: $(TARGET)
             if enable_asan:
                 clang_cmd.extend(["-fsanitize=address", "-g"])
 
+            # Instrumented binaries need the profile runtime
+            if pgo_generate:
+                clang_cmd.append("-fprofile-generate")
+
             result = subprocess.run(clang_cmd, capture_output=True, text=True)
             if result.returncode != 0:
                 print(f"Linking failed: {result.stderr}")
@@ -211,6 +238,168 @@ run: $(TARGET)
             print(f"Compilation error: {e}")
             return False
 
+    def _pgo_instrument(self, llvm_ir: str, triple: str, profile_dir: Path, executable_name: str) -> Optional[str]:
+        """Add profile counters to the program (opt's pgo-instr-gen and instrprof passes).
+
+        Each run of the instrumented binary writes <executable>-<pid>.profraw into
+        profile_dir ($LLVM_PROFILE_FILE overrides this).
+
+        Args:
+            llvm_ir: Unoptimized program IR
+            triple: Target triple the counters are lowered for
+            profile_dir: Directory for the raw profiles
+            executable_name: Prefix of the profile file names
+
+        Returns:
+            Instrumented IR, or None if opt failed
+        """
+        profile_dir.mkdir(parents=True, exist_ok=True)
+        # The profile runtime reads its output path from this global
+        pattern = f"{profile_dir / executable_name}-%p.profraw".encode() + b"\0"
+        escaped = "".join(chr(b) if 32 <= b < 127 and b not in (34, 92) else f"\\{b:02X}" for b in pattern)
+        llvm_ir += f'\n@__llvm_profile_filename = constant [{len(pattern)} x i8] c"{escaped}"\n'
+        return self._run_opt(llvm_ir, triple, ["-passes=pgo-instr-gen,instrprof"])
+
+    def _pgo_annotate(
+        self, llvm_ir: str, triple: str, profile: Path, output_path: Path, executable_name: str
+    ) -> Optional[str]:
+        """Attach branch weights and function entry counts from a profile (opt's pgo-instr-use pass).
+
+        Args:
+            llvm_ir: Unoptimized program IR, as generated for the instrumented build
+            triple: Target triple
+            profile: .profdata file, .profraw file or directory of .profraw files
+            output_path: Directory for the merged .profdata
+            executable_name: Name of the merged profile
+
+        Returns:
+            Annotated IR, or None if the profile could not be merged or applied
+        """
+        if profile.suffix == ".profdata":
+            profdata = profile
+        else:
+            raw_profiles = sorted(profile.glob("*.profraw")) if profile.is_dir() else [profile]
+            if not raw_profiles:
+                print(f"No .profraw files in {profile}: run the --pgo-generate build first")
+                return None
+            profdata = output_path / f"{executable_name}.profdata"
+            merge_cmd = [self.profdata_path, "merge", "-o", str(profdata), *map(str, raw_profiles)]
+            result = subprocess.run(merge_cmd, capture_output=True, text=True)
+            if result.returncode != 0:
+                print(f"Profile merge failed: {result.stderr}")
+                return None
+
+        return self._run_opt(llvm_ir, triple, ["-passes=pgo-instr-use", f"-pgo-test-profile-file={profdata}"])
+
+    def _run_opt(self, llvm_ir: str, triple: str, args: list[str]) -> Optional[str]:
+        """Run opt over IR text and return the transformed IR."""
+        opt_cmd = [self.opt_path, "-S", f"-mtriple={triple}", *args]
+        result = subprocess.run(opt_cmd, input=llvm_ir, capture_output=True, text=True)
+        if result.returncode != 0:
+            print(f"opt failed: {result.stderr}")
+            return None
+        return result.stdout
+
+    @classmethod
+    def runtime_sources(cls, runtime_dir: Path, output_path: Path) -> list[Path]:
+        """Write the templated containers into output_path and list every runtime C source.
+
+        Args:
+            runtime_dir: Directory holding the hand-written runtime sources and headers
+            output_path: Directory for the generated mgen_<container>.h/.c files
+
+        Returns:
+            Paths of the runtime sources; compile them with both directories on the include path
+        """
+        from ..c.container_codegen import ContainerCodeGenerator
+
+        generator = ContainerCodeGenerator()
+        sources = []
+        for container in cls.TEMPLATE_CONTAINERS:
+            generated = generator.generate_runtime_sources(container)
+            if generated is None:
+                raise RuntimeError(f"No runtime template for {container}")
+            header, implementation = generated
+            (output_path / f"mgen_{container}.h").write_text(header)
+            source = output_path / f"mgen_{container}.c"
+            source.write_text(implementation)
+            sources.append(source)
+        sources.extend(runtime_dir / name for name in cls.RUNTIME_SOURCES if (runtime_dir / name).exists())
+        return sources
+
+    def _compile_runtime_bitcode(self, runtime_dir: Path, output_path: Path, opt_level: int) -> Optional[list[Path]]:
+        """Compile each runtime C file to LLVM bitcode.
+
+        Args:
+            runtime_dir: Directory holding the runtime sources and headers
+            output_path: Directory for the .bc files
+            opt_level: Optimization level the program is built at
+
+        Returns:
+            Paths of the bitcode files, or None if a source failed to compile
+        """
+        bitcode_files = []
+        for runtime_c in self.runtime_sources(runtime_dir, output_path):
+            runtime_bc = output_path / f"{runtime_c.stem}.bc"
+            clang_cmd = [
+                self.clang_path,
+                "-c",
+                "-emit-llvm",
+                f"-O{opt_level}",
+                str(runtime_c),
+                "-o",
+                str(runtime_bc),
+                "-I",
+                str(runtime_dir),  # Include runtime headers
+                "-I",
+                str(output_path),  # Include generated container headers
+            ]
+
+            result = subprocess.run(clang_cmd, capture_output=True, text=True)
+            if result.returncode != 0:
+                print(f"Runtime bitcode compilation failed for {runtime_c.name}: {result.stderr}")
+                return None
+
+            bitcode_files.append(runtime_bc)
+        return bitcode_files
+
+    def _compile_runtime_objects(
+        self, runtime_dir: Path, output_path: Path, extra_flags: list[str]
+    ) -> Optional[list[str]]:
+        """Compile each runtime C file to a native object file.
+
+        Args:
+            runtime_dir: Directory holding the runtime sources and headers
+            output_path: Directory for the .o files
+            extra_flags: Additional clang flags (e.g. sanitizers)
+
+        Returns:
+            Paths of the object files, or None if a source failed to compile
+        """
+        runtime_objects = []
+        for runtime_c in self.runtime_sources(runtime_dir, output_path):
+            runtime_o = output_path / f"{runtime_c.stem}.o"
+            clang_cmd = [
+                self.clang_path,
+                "-c",
+                str(runtime_c),
+                "-o",
+                str(runtime_o),
+                "-I",
+                str(runtime_dir),  # Include runtime headers
+                "-I",
+                str(output_path),  # Include generated container headers
+                *extra_flags,
+            ]
+
+            result = subprocess.run(clang_cmd, capture_output=True, text=True)
+            if result.returncode != 0:
+                print(f"Runtime compilation failed for {runtime_c.name}: {result.stderr}")
+                return None
+
+            runtime_objects.append(str(runtime_o))
+        return runtime_objects
+
     def get_compile_flags(self) -> list[str]:
         """Get LLVM compilation flags.
 
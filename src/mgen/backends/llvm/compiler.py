@@ -2,28 +2,50 @@
 
 This module provides functionality to compile LLVM IR to machine code
 using llvmlite's binding to LLVM.
+
+Large modules can be compiled in parallel: the functions are split into
+partitions along the call graph's strongly connected components, and each
+partition is compiled to its own object file on a worker thread. Every
+worker parses a private copy of the module in its own LLVM context and
+marks the functions owned by other partitions available_externally, so
+their bodies are left out of its object. The IR is expected to be
+optimized already, so cross-function inlining has happened on the whole
+module before the split.
 """
 
+import os
 import subprocess
 import tempfile
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from typing import Optional
 
 from llvmlite import binding as llvm  # type: ignore[import-untyped]
 
+from ...frontend.analyzers.call_graph import strongly_connected_components
+from .target import create_target_machine
+
+# Linkages that keep a symbol private to its object file
+_LOCAL_LINKAGES = {llvm.Linkage.internal, llvm.Linkage.private}
+
 
 class LLVMCompiler:
     """Compile LLVM IR to machine code using llvmlite."""
 
-    def __init__(self) -> None:
-        """Initialize the LLVM compiler."""
-        # Initialize native target
-        llvm.initialize_native_target()
-        llvm.initialize_native_asmprinter()
+    def __init__(self, opt_level: int = 2, cpu: Optional[str] = None, features: Optional[str] = None) -> None:
+        """Initialize the LLVM compiler.
+
+        Args:
+            opt_level: Code generation optimization level (0-3)
+            cpu: CPU to generate code for: None for the generic baseline, "native" or an LLVM CPU name
+            features: LLVM feature overrides, e.g. "+avx2,-avx512f"
+        """
+        self.opt_level = opt_level
+        self.cpu = cpu
+        self.features = features
 
         # Create target machine for native platform
-        target = llvm.Target.from_default_triple()
-        self.target_machine = target.create_target_machine()
+        self.target_machine = create_target_machine(opt_level=opt_level, cpu=cpu, features=features)
 
     def compile_ir_to_object(self, llvm_ir: str, output_path: Optional[str] = None) -> bytes:
         """Compile LLVM IR to object file.
@@ -48,6 +70,130 @@ class LLVMCompiler:
 
         return obj_bytes
 
+    def compile_ir_to_objects(self, llvm_ir: str, jobs: Optional[int] = None) -> list[bytes]:
+        """Compile LLVM IR to one object file per partition, in parallel.
+
+        Args:
+            llvm_ir: LLVM IR as string
+            jobs: Number of partitions and worker threads (default: CPU count)
+
+        Returns:
+            Object file bytes for each partition; link all of them. A single
+            object if the module cannot be split or has one partition
+        """
+        llvm_module = llvm.parse_assembly(llvm_ir)
+        llvm_module.verify()
+
+        partitions = self.partition_functions(llvm_module, jobs or os.cpu_count() or 1)
+        if len(partitions) < 2:
+            return [self.target_machine.emit_object(llvm_module)]
+
+        with ThreadPoolExecutor(max_workers=len(partitions)) as pool:
+            futures = [
+                pool.submit(self._compile_partition, llvm_ir, owned, owns_data=(i == 0))
+                for i, owned in enumerate(partitions)
+            ]
+            return [future.result() for future in futures]
+
+    def partition_functions(self, llvm_module: llvm.ModuleRef, jobs: int) -> list[set[str]]:
+        """Split a module's function definitions into at most jobs balanced partitions.
+
+        Mutually recursive functions always share a partition. Components are
+        placed largest first into the partition with the fewest instructions.
+
+        Args:
+            llvm_module: Parsed LLVM module
+            jobs: Maximum number of partitions
+
+        Returns:
+            Names of the functions defined by each partition; empty if the
+            module should be compiled whole
+        """
+        if jobs < 2 or not self._is_splittable(llvm_module):
+            return []
+
+        sizes: dict[str, int] = {}
+        calls: dict[str, set[str]] = {}
+        for function in llvm_module.functions:
+            if function.is_declaration:
+                continue
+            sizes[function.name] = 0
+            calls[function.name] = set()
+            for block in function.blocks:
+                for instruction in block.instructions:
+                    sizes[function.name] += 1
+                    if instruction.opcode == "call":
+                        # The callee is the last operand
+                        *_, callee = instruction.operands
+                        calls[function.name].add(callee.name)
+
+        components = strongly_connected_components(calls)
+        components.sort(key=lambda component: sum(sizes[name] for name in component), reverse=True)
+
+        partitions: list[set[str]] = [set() for _ in range(min(jobs, len(components)))]
+        loads = [0] * len(partitions)
+        for component in components:
+            lightest = loads.index(min(loads))
+            partitions[lightest].update(component)
+            loads[lightest] += sum(sizes[name] for name in component)
+        return partitions
+
+    def _is_splittable(self, llvm_module: llvm.ModuleRef) -> bool:
+        """Check that every definition can be shared between partitions by name."""
+        for value in (*llvm_module.functions, *llvm_module.global_variables):
+            if value.is_declaration:
+                continue
+            # Unnamed symbols cannot be referenced across objects, and appending
+            # globals (llvm.global_ctors) would be emitted once per partition
+            if not value.name or value.linkage == llvm.Linkage.appending:
+                return False
+        return True
+
+    def _compile_partition(self, llvm_ir: str, owned: set[str], owns_data: bool) -> bytes:
+        """Compile the functions of one partition to an object file.
+
+        Runs on a worker thread, so it uses its own LLVM context and target
+        machine. Module-local symbols become hidden globals so the other
+        partitions' objects can reference them; definitions owned elsewhere
+        are made available_externally and left out of this object.
+
+        Args:
+            llvm_ir: LLVM IR of the whole module
+            owned: Functions this partition defines
+            owns_data: Whether this partition defines the global variables
+
+        Returns:
+            Object file bytes
+        """
+        llvm_module = llvm.parse_assembly(llvm_ir, context=llvm.create_context())
+
+        for function in llvm_module.functions:
+            if function.is_declaration:
+                continue
+            self._externalize(function)
+            if function.name not in owned:
+                function.linkage = "available_externally"
+
+        for variable in llvm_module.global_variables:
+            if variable.is_declaration:
+                continue
+            self._externalize(variable)
+            if not owns_data:
+                variable.linkage = "available_externally"
+
+        llvm_module.verify()
+        # Symbols now cross object boundaries, so generate PIC for the linker
+        target_machine = create_target_machine(
+            opt_level=self.opt_level, cpu=self.cpu, features=self.features, reloc="pic"
+        )
+        return target_machine.emit_object(llvm_module)
+
+    def _externalize(self, value: llvm.ValueRef) -> None:
+        """Give an internal or private definition hidden external linkage."""
+        if value.linkage in _LOCAL_LINKAGES:
+            value.linkage = "external"
+            value.visibility = "hidden"
+
     def compile_ir_to_executable(
         self,
         llvm_ir: str,
@@ -55,6 +201,7 @@ class LLVMCompiler:
         linker: str = "clang",
         link_args: Optional[list[str]] = None,
         enable_asan: bool = False,
+        jobs: int = 1,
     ) -> bool:
         """Compile LLVM IR to executable.
 
@@ -64,18 +211,27 @@ class LLVMCompiler:
             linker: Linker to use (default: clang)
             link_args: Additional linker arguments
             enable_asan: Enable AddressSanitizer for memory error detection
+            jobs: Partitions to compile in parallel (see compile_ir_to_objects);
+                0 for one per CPU
 
         Returns:
             True if successful, False otherwise
         """
-        # Create temporary object file
-        with tempfile.NamedTemporaryFile(suffix=".o", delete=False) as obj_file:
-            obj_path = obj_file.name
-            obj_bytes = self.compile_ir_to_object(llvm_ir, obj_path)
+        # Create temporary object files
+        obj_paths = []
+        if jobs == 1:
+            with tempfile.NamedTemporaryFile(suffix=".o", delete=False) as obj_file:
+                obj_paths.append(obj_file.name)
+                self.compile_ir_to_object(llvm_ir, obj_file.name)
+        else:
+            for obj_bytes in self.compile_ir_to_objects(llvm_ir, jobs or None):
+                with tempfile.NamedTemporaryFile(suffix=".o", delete=False) as obj_file:
+                    obj_file.write(obj_bytes)
+                    obj_paths.append(obj_file.name)
 
         try:
             # Link to executable
-            cmd = [linker, obj_path, "-o", output_path]
+            cmd = [linker, *obj_paths, "-o", output_path]
 
             # Add ASAN flags if requested
             if enable_asan:
@@ -92,8 +248,9 @@ class LLVMCompiler:
             return True
 
         finally:
-            # Clean up temporary object file
-            Path(obj_path).unlink(missing_ok=True)
+            # Clean up temporary object files
+            for obj_path in obj_paths:
+                Path(obj_path).unlink(missing_ok=True)
 
     def compile_and_run(
         self,
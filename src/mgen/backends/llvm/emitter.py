@@ -3,8 +3,11 @@
 import ast
 from typing import Any, Optional
 
+from ...frontend.escape_analysis import annotate_stack_allocations
+from ...frontend.ir_passes import optimize_ir_module
+from ...frontend.optimization_hints import annotate_ir_module
 from ...frontend.static_ir import build_ir_from_code
-from ..base import AbstractEmitter
+from ..base import AbstractEmitter, fast_math_modes
 from ..preferences import BackendPreferences
 from .ir_to_llvm import IRToLLVMConverter
 
@@ -30,7 +33,19 @@ class LLVMEmitter(AbstractEmitter):
         # Build Static IR from Python source
         ir_module = build_ir_from_code(source_code)
 
-        # Convert Static IR to LLVM IR
+        # Hoist and merge runtime calls, which the LLVM optimizer cannot move
+        optimization_level = self.preferences.get("optimization_level", 2) if self.preferences else 2
+        if optimization_level > 0:
+            optimize_ir_module(ir_module)
+        # Hot/cold functions and small constant loops, for the optimizer
+        annotate_ir_module(ir_module, source_code)
+        # Fixed-size lists that never leave their function go on the stack
+        annotate_stack_allocations(ir_module)
+
+        # Convert Static IR to LLVM IR, with DWARF line info when there is a file to point at
+        self.converter.source_file = self.source_file
+        # Reassociation lets float reductions vectorize, contraction forms FMAs
+        self.converter.fast_math = fast_math_modes(self.preferences.get("fast_math") if self.preferences else None)
         llvm_module = self.converter.visit_module(ir_module)
 
         # Return LLVM IR as text
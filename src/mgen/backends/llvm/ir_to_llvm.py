@@ -5,6 +5,7 @@ and generate corresponding LLVM IR instructions.
 """
 
 import ast
+from pathlib import Path
 from typing import Optional, Union
 
 from llvmlite import ir  # type: ignore[import-untyped]
@@ -24,6 +25,7 @@ from ...frontend.static_ir import (
     IRIf,
     IRLiteral,
     IRModule,
+    IRNode,
     IRReturn,
     IRType,
     IRTypeCast,
@@ -33,8 +35,26 @@ from ...frontend.static_ir import (
     IRVisitor,
     IRWhile,
 )
+from ...frontend.escape_analysis import STACK_ALLOCATE
+from ...frontend.optimization_hints import FUNCTION_COLD, FUNCTION_HOT, LOOP_UNROLL_FULL, LOOP_VECTORIZE
 from .runtime_decls import LLVMRuntimeDeclarations
 
+# Function attributes for each frontend optimization hint. Cold code is also
+# optimized for size, so the pipeline does not unroll or vectorize it.
+FUNCTION_HINT_ATTRIBUTES = {
+    FUNCTION_HOT: ("hot",),
+    FUNCTION_COLD: ("cold", "optsize"),
+}
+
+# Operators a linear recursion may combine its result with, and their identity.
+# Integer + and * are associative and commutative even when they wrap, so the
+# pending operations can be folded into an accumulator in any order.
+ACCUMULATOR_OPERATORS = {"+": 0, "*": 1}
+
+# Parameter types a self-recursive function may have to be turned into a
+# loop; pointer arguments could alias the current frame's stack lists
+TAIL_RECURSION_PARAMETER_TYPES = {IRDataType.INT, IRDataType.FLOAT, IRDataType.BOOL}
+
 
 class IRToLLVMConverter(IRVisitor):
     """Convert MGen Static IR to LLVM IR using the visitor pattern."""
@@ -53,6 +73,23 @@ class IRToLLVMConverter(IRVisitor):
         # Track current loop blocks for break/continue
         self.loop_exit_stack: list[ir.Block] = []
         self.loop_continue_stack: list[ir.Block] = []
+        # Functions defined by the module being converted
+        self.user_functions: set[str] = set()
+        # Self-recursion turned into a loop: parameter slots, the block
+        # after their initialization, and the accumulator (operator, slot)
+        self.param_ptrs: list[ir.AllocaInstr] = []
+        self.recursion_header: Optional[ir.Block] = None
+        self.recursion_accumulator: Optional[tuple[str, ir.AllocaInstr]] = None
+        # Value slots of the dict updates being lowered (__update_item__)
+        self.item_slots: list[ir.Instruction] = []
+        # Python file the DWARF line table points at (None: no debug info), its
+        # compile unit, and the subprogram of the function being converted
+        self.source_file: Optional[str] = None
+        self.debug_file: Optional[ir.DIValue] = None
+        self.debug_unit: Optional[ir.DIValue] = None
+        self.debug_scope: Optional[ir.DIValue] = None
+        # Fast-math flags of float arithmetic (the fast_math preference; empty: strict IEEE)
+        self.fast_math: tuple[str, ...] = ()
         # Runtime declarations for C library
         self.runtime = LLVMRuntimeDeclarations(self.module)
 
@@ -67,6 +104,8 @@ class IRToLLVMConverter(IRVisitor):
         """
         # Declare runtime library functions first
         self.runtime.declare_all()
+        if self.source_file is not None:
+            self._add_debug_unit(self.source_file)
 
         # Generate type declarations first (for structs, etc.)
         for type_decl in node.type_declarations:
@@ -77,6 +116,7 @@ class IRToLLVMConverter(IRVisitor):
             global_var.accept(self)
 
         # Generate functions
+        self.user_functions = {func.name for func in node.functions}
         for func in node.functions:
             func.accept(self)
 
@@ -99,6 +139,8 @@ class IRToLLVMConverter(IRVisitor):
         func_type = ir.FunctionType(ret_type, param_types)
         func = ir.Function(self.module, func_type, node.name)
 
+        self._add_function_hints(func, node.annotations.optimization_hints)
+
         # Store in symbol table
         self.func_symtab[node.name] = func
         self.current_function = func
@@ -106,20 +148,39 @@ class IRToLLVMConverter(IRVisitor):
         # Create entry block
         entry_block = func.append_basic_block(name="entry")
         self.builder = ir.IRBuilder(entry_block)
+        if self.debug_unit is not None:
+            # The prologue (parameter slots, tail-call setup) is attributed to the def line
+            self._add_debug_subprogram(func, node)
+            self.builder.debug_metadata = self._debug_location(node, self.builder.debug_metadata)
 
         # Clear variable symbol table for new function
         self.var_symtab = {}
 
         # Map parameters to LLVM function arguments
+        self.param_ptrs = []
         for i, param in enumerate(node.parameters):
             # Allocate stack space for parameter (enables taking address)
             param_ptr = self.builder.alloca(func.args[i].type, name=param.name)
             self.builder.store(func.args[i], param_ptr)
             self.var_symtab[param.name] = param_ptr
+            self.param_ptrs.append(param_ptr)
+
+        # Self-calls in return position jump back here instead of recursing
+        self.recursion_header = None
+        self.recursion_accumulator = None
+        operator = self._tail_recursion_operator(node)
+        if operator is not None:
+            if operator:
+                accumulator = self.builder.alloca(ret_type, name="tail_acc")
+                self.builder.store(ir.Constant(ret_type, ACCUMULATOR_OPERATORS[operator]), accumulator)
+                self.recursion_accumulator = (operator, accumulator)
+            self.recursion_header = func.append_basic_block(name="tailrecurse")
+            self.builder.branch(self.recursion_header)
+            self.builder.position_at_end(self.recursion_header)
 
         # Generate function body
         for stmt in node.body:
-            stmt.accept(self)
+            self._visit_statement(stmt)
 
         # Add implicit return if missing
         if not self.builder.block.is_terminated:
@@ -127,10 +188,116 @@ class IRToLLVMConverter(IRVisitor):
                 self.builder.ret_void()
             else:
                 # Return zero/null as default
-                self.builder.ret(ir.Constant(ret_type, 0))
+                self.builder.ret(self._accumulated(ir.Constant(ret_type, 0)))
 
+        self._hoist_allocas(func)
         return func
 
+    def _hoist_allocas(self, func: ir.Function) -> None:
+        """Move every alloca into the entry block.
+
+        Locals are allocated where they are first assigned, which may be a
+        loop body (or the body of a recursion turned into a loop); there an
+        alloca would claim new stack on every iteration, and mem2reg only
+        promotes entry-block allocas to registers. Allocas have constant
+        sizes and no operands besides, so hoisting them is always valid.
+
+        Args:
+            func: Fully generated LLVM function
+        """
+        entry = func.entry_basic_block
+        hoisted = []
+        for block in func.blocks[1:]:
+            allocas = [instr for instr in block.instructions if isinstance(instr, ir.AllocaInstr)]
+            for instr in allocas:
+                block.instructions.remove(instr)
+                instr.parent = entry
+            hoisted.extend(allocas)
+        entry.instructions[0:0] = hoisted
+
+    def _tail_recursion_operator(self, node: IRFunction) -> Optional[str]:
+        """Decide whether a function's returned self-calls can become loop back-edges.
+
+        Handles tail recursion (return f(...)) and linear recursion whose
+        result is combined with a call-free operand by one accumulator
+        operator (return n * f(n - 1)). Other self-calls stay ordinary calls.
+
+        Args:
+            node: IR function
+
+        Returns:
+            None if nothing is transformed, "" for plain tail recursion, or
+            the accumulator operator
+        """
+        if any(param.ir_type.base_type not in TAIL_RECURSION_PARAMETER_TYPES for param in node.parameters):
+            return None
+
+        found = False
+        operators = set()
+        for ret in self._returns(node):
+            recursion = self._split_recursive_return(ret.value, node.name)
+            if recursion is None:
+                continue
+            found = True
+            operator, _, _ = recursion
+            if operator:
+                operators.add(operator)
+
+        if not found or len(operators) > 1:
+            return None
+        if operators:
+            if node.return_type.base_type != IRDataType.INT:
+                return None
+            return operators.pop()
+        return ""
+
+    def _returns(self, node: IRNode) -> list[IRReturn]:
+        """Collect the return statements under a node."""
+        returns = []
+        for child in node.children:
+            if isinstance(child, IRReturn):
+                returns.append(child)
+            returns.extend(self._returns(child))
+        return returns
+
+    def _split_recursive_return(
+        self, value: Optional[IRExpression], function_name: str
+    ) -> Optional[tuple[str, IRFunctionCall, Optional[IRExpression]]]:
+        """Match `f(...)` or `e op f(...)` / `f(...) op e` with a call-free e.
+
+        Returns:
+            (operator or "", the self-call, e) or None
+        """
+        if isinstance(value, IRFunctionCall) and value.function_name == function_name:
+            return "", value, None
+        if isinstance(value, IRBinaryOperation) and value.operator in ACCUMULATOR_OPERATORS:
+            for call, operand in ((value.right, value.left), (value.left, value.right)):
+                if (
+                    isinstance(call, IRFunctionCall)
+                    and call.function_name == function_name
+                    and self._is_call_free(operand)
+                ):
+                    return value.operator, call, operand
+        return None
+
+    def _is_call_free(self, node: IRExpression) -> bool:
+        """Check an expression has no calls, so evaluating it early is unobservable."""
+        if isinstance(node, (IRFunctionCall, IRComprehension)):
+            return False
+        if isinstance(node, IRLiteral):
+            return not isinstance(node.value, (list, dict, set))
+        return all(isinstance(child, IRExpression) and self._is_call_free(child) for child in node.children)
+
+    def _accumulated(self, value: ir.Value) -> ir.Value:
+        """Combine a returned value with the recursion accumulator, if any."""
+        if self.recursion_accumulator is None or self.builder is None:
+            return value
+        operator, accumulator = self.recursion_accumulator
+        pending = self.builder.load(accumulator, name="tail_acc_val")
+        if operator == "+":
+            return self.builder.add(pending, value, name="tail_acc_ret")
+        return self.builder.mul(pending, value, name="tail_acc_ret")
+
     def visit_variable(self, node: IRVariable) -> Union[ir.AllocaInstr, ir.GlobalVariable]:
         """Visit a variable node (used for declarations).
 
@@ -301,13 +468,13 @@ class IRToLLVMConverter(IRVisitor):
         # Float operations
         elif node.result_type.base_type == IRDataType.FLOAT:
             if node.operator == "+":
-                return self.builder.fadd(left, right, name="fadd_tmp")
+                return self.builder.fadd(left, right, name="fadd_tmp", flags=self.fast_math)
             elif node.operator == "-":
-                return self.builder.fsub(left, right, name="fsub_tmp")
+                return self.builder.fsub(left, right, name="fsub_tmp", flags=self.fast_math)
             elif node.operator == "*":
-                return self.builder.fmul(left, right, name="fmul_tmp")
+                return self.builder.fmul(left, right, name="fmul_tmp", flags=self.fast_math)
             elif node.operator == "/":
-                return self.builder.fdiv(left, right, name="fdiv_tmp")
+                return self.builder.fdiv(left, right, name="fdiv_tmp", flags=self.fast_math)
 
         # Boolean operations (comparisons)
         elif node.result_type.base_type == IRDataType.BOOL:
@@ -478,23 +645,28 @@ class IRToLLVMConverter(IRVisitor):
                 vec_init_ptr_func = self.runtime.get_function("vec_int_init_ptr")
                 vec_push_func = self.runtime.get_function("vec_int_push")
 
-            # Allocate space for the vec struct on heap (not stack!)
-            # Calculate size of struct using GEP null trick
-            i64 = ir.IntType(64)
-            i8_ptr = ir.IntType(8).as_pointer()
-            null_ptr = ir.Constant(vec_type.as_pointer(), None)
-            size_gep = self.builder.gep(null_ptr, [ir.Constant(ir.IntType(32), 1)], name="size_gep")
-            struct_size = self.builder.ptrtoint(size_gep, i64, name="struct_size")
+            is_stack_list = STACK_ALLOCATE in node.annotations.optimization_hints
+            if is_stack_list and not is_2d_list and elem_type != IRDataType.STRING:
+                # Escape analysis proved the list local and fixed-size
+                vec_ptr = self._alloca_vec_int(node.annotations.intelligence_layer_data["stack_capacity"], "list_tmp")
+            else:
+                # Allocate space for the vec struct on heap (not stack!)
+                # Calculate size of struct using GEP null trick
+                i64 = ir.IntType(64)
+                i8_ptr = ir.IntType(8).as_pointer()
+                null_ptr = ir.Constant(vec_type.as_pointer(), None)
+                size_gep = self.builder.gep(null_ptr, [ir.Constant(ir.IntType(32), 1)], name="size_gep")
+                struct_size = self.builder.ptrtoint(size_gep, i64, name="struct_size")
 
-            # Get malloc function and allocate memory
-            malloc_func = self._get_or_create_c_function("malloc", i8_ptr, [i64])
-            raw_ptr = self.builder.call(malloc_func, [struct_size], name="list_malloc")
+                # Get malloc function and allocate memory
+                malloc_func = self._get_or_create_c_function("malloc", i8_ptr, [i64])
+                raw_ptr = self.builder.call(malloc_func, [struct_size], name="list_malloc")
 
-            # Cast i8* to struct pointer
-            vec_ptr = self.builder.bitcast(raw_ptr, vec_type.as_pointer(), name="list_tmp")
+                # Cast i8* to struct pointer
+                vec_ptr = self.builder.bitcast(raw_ptr, vec_type.as_pointer(), name="list_tmp")
 
-            # Initialize it by calling vec_init_ptr() which takes a pointer
-            self.builder.call(vec_init_ptr_func, [vec_ptr], name="")
+                # Initialize it by calling vec_init_ptr() which takes a pointer
+                self.builder.call(vec_init_ptr_func, [vec_ptr], name="")
 
             # If list has elements, push them
             if isinstance(node.value, list) and len(node.value) > 0:
@@ -649,17 +821,21 @@ class IRToLLVMConverter(IRVisitor):
         vec_int_init_ptr_func = self.runtime.get_function("vec_int_init_ptr")
         vec_int_push_func = self.runtime.get_function("vec_int_push")
 
-        # Calculate size and malloc the struct
         i64 = ir.IntType(64)
-        i8_ptr = ir.IntType(8).as_pointer()
-        null_ptr = ir.Constant(vec_int_type.as_pointer(), None)
-        size_gep = self.builder.gep(null_ptr, [ir.Constant(ir.IntType(32), 1)], name="size_gep")
-        struct_size = self.builder.ptrtoint(size_gep, i64, name="struct_size")
-        malloc_func = self._get_or_create_c_function("malloc", i8_ptr, [i64])
-        raw_ptr = self.builder.call(malloc_func, [struct_size], name="comp_malloc")
-        result_ptr = self.builder.bitcast(raw_ptr, vec_int_type.as_pointer(), name="comp_result")
+        if STACK_ALLOCATE in node.annotations.optimization_hints:
+            # Constant range, and escape analysis proved the result local
+            result_ptr = self._alloca_vec_int(node.annotations.intelligence_layer_data["stack_capacity"], "comp_result")
+        else:
+            # Calculate size and malloc the struct
+            i8_ptr = ir.IntType(8).as_pointer()
+            null_ptr = ir.Constant(vec_int_type.as_pointer(), None)
+            size_gep = self.builder.gep(null_ptr, [ir.Constant(ir.IntType(32), 1)], name="size_gep")
+            struct_size = self.builder.ptrtoint(size_gep, i64, name="struct_size")
+            malloc_func = self._get_or_create_c_function("malloc", i8_ptr, [i64])
+            raw_ptr = self.builder.call(malloc_func, [struct_size], name="comp_malloc")
+            result_ptr = self.builder.bitcast(raw_ptr, vec_int_type.as_pointer(), name="comp_result")
 
-        self.builder.call(vec_int_init_ptr_func, [result_ptr], name="")
+            self.builder.call(vec_int_init_ptr_func, [result_ptr], name="")
 
         # Process the comprehension (only single generator supported for now)
         if len(ast_node.generators) != 1:
@@ -1691,6 +1867,38 @@ class IRToLLVMConverter(IRVisitor):
                 vec_set_func = self.runtime.get_function("vec_int_set")
                 return self.builder.call(vec_set_func, [container_ptr, key_or_index, value], name="")
 
+        elif node.function_name == "__update_item__":
+            # dict[key] = value reading dict[key] -> one map_*_slot lookup, then a load and a store
+            if len(node.arguments) != 3:
+                raise RuntimeError("__update_item__() requires exactly 3 arguments (dict, key, value)")
+
+            container_ptr = node.arguments[0].accept(self)
+            key = node.arguments[1].accept(self)
+
+            pointee_type_str = str(container_ptr.type.pointee)
+            if "map_str_int" in pointee_type_str:
+                slot_func = self.runtime.get_function("map_str_int_slot")
+            elif "map_int_int" in pointee_type_str:
+                slot_func = self.runtime.get_function("map_int_int_slot")
+            else:
+                raise NotImplementedError(f"__update_item__ not supported for {container_ptr.type}")
+            slot = self.builder.call(slot_func, [container_ptr, key], name="dict_slot")
+
+            # __current_item__ in the value reads through the slot
+            self.item_slots.append(slot)
+            try:
+                value = node.arguments[2].accept(self)
+            finally:
+                self.item_slots.pop()
+            self.builder.store(value, slot)
+            return None
+
+        elif node.function_name == "__current_item__":
+            # Value of the dict entry being updated by the enclosing __update_item__
+            if not self.item_slots:
+                raise RuntimeError("__current_item__() used outside __update_item__()")
+            return self.builder.load(self.item_slots[-1], name="dict_item")
+
         elif node.function_name == "__contains__":
             # key in dict -> map_str_int_contains(dict_ptr, key)
             if len(node.arguments) != 2:
@@ -1997,11 +2205,51 @@ class IRToLLVMConverter(IRVisitor):
             raise RuntimeError("Builder not initialized - must be inside a function")
 
         if node.value:
+            if self.recursion_header is not None and self._emit_recursive_jump(node.value):
+                return
             ret_val = node.value.accept(self)
-            self.builder.ret(ret_val)
+            if (
+                isinstance(ret_val, ir.CallInstr)
+                and isinstance(node.value, IRFunctionCall)
+                and node.value.function_name in self.user_functions
+                and self.recursion_accumulator is None
+                and not any(isinstance(arg.type, ir.PointerType) for arg in ret_val.args)
+            ):
+                # Only scalars are passed, so the callee cannot see this frame
+                ret_val.tail = True
+            self.builder.ret(self._accumulated(ret_val))
         else:
             self.builder.ret_void()
 
+    def _emit_recursive_jump(self, value: IRExpression) -> bool:
+        """Turn a returned self-call into parameter updates and a jump to the function start.
+
+        Args:
+            value: Returned expression
+
+        Returns:
+            True if the return was emitted as a jump
+        """
+        if self.builder is None or self.current_function is None:
+            return False
+        recursion = self._split_recursive_return(value, self.current_function.name)
+        if recursion is None:
+            return False
+        operator, call, operand = recursion
+        if operator and (self.recursion_accumulator is None or self.recursion_accumulator[0] != operator):
+            return False
+
+        if operand is not None and self.recursion_accumulator is not None:
+            accumulator = self.recursion_accumulator[1]
+            self.builder.store(self._accumulated(operand.accept(self)), accumulator)
+
+        # Evaluate every argument before any parameter is overwritten
+        new_args = [arg.accept(self) for arg in call.arguments]
+        for param_ptr, arg in zip(self.param_ptrs, new_args):
+            self.builder.store(arg, param_ptr)
+        self.builder.branch(self.recursion_header)
+        return True
+
     def visit_break(self, node: IRBreak) -> None:
         """Convert IR break statement to LLVM branch to loop exit.
 
@@ -2068,14 +2316,14 @@ class IRToLLVMConverter(IRVisitor):
         # Generate then block
         self.builder.position_at_end(then_block)
         for stmt in node.then_body:
-            stmt.accept(self)
+            self._visit_statement(stmt)
         if not self.builder.block.is_terminated:
             self.builder.branch(merge_block)
 
         # Generate else block
         self.builder.position_at_end(else_block)
         for stmt in node.else_body:
-            stmt.accept(self)
+            self._visit_statement(stmt)
         if not self.builder.block.is_terminated:
             self.builder.branch(merge_block)
 
@@ -2111,7 +2359,7 @@ class IRToLLVMConverter(IRVisitor):
         # Generate body block
         self.builder.position_at_end(body_block)
         for stmt in node.body:
-            stmt.accept(self)
+            self._visit_statement(stmt)
         if not self.builder.block.is_terminated:
             self.builder.branch(cond_block)  # Loop back
 
@@ -2182,7 +2430,7 @@ class IRToLLVMConverter(IRVisitor):
         # Body
         self.builder.position_at_end(body_block)
         for stmt in node.body:
-            stmt.accept(self)
+            self._visit_statement(stmt)
         if not self.builder.block.is_terminated:
             self.builder.branch(inc_block)
 
@@ -2195,7 +2443,8 @@ class IRToLLVMConverter(IRVisitor):
             step_val = ir.Constant(loop_var_type, 1)
         next_val = self.builder.add(loop_var_val, step_val, name="for.inc")
         self.builder.store(next_val, loop_var_ptr)
-        self.builder.branch(cond_block)
+        latch = self.builder.branch(cond_block)
+        self._add_loop_hints(latch, node.annotations.optimization_hints)
 
         # Pop loop blocks from stack
         self.loop_exit_stack.pop()
@@ -2204,6 +2453,150 @@ class IRToLLVMConverter(IRVisitor):
         # Exit
         self.builder.position_at_end(exit_block)
 
+    def _alloca_vec_int(self, capacity: int, name: str) -> ir.Value:
+        """Create an empty vec_int whose storage is a stack buffer.
+
+        The struct and a [capacity x i64] buffer are allocated in the entry
+        block, so a site inside a loop reuses one frame slot; the struct is
+        reset at the site itself. The list must never grow past capacity,
+        since vec_int_grow would realloc the buffer.
+
+        Args:
+            capacity: Number of elements the buffer holds
+            name: Name for the struct alloca
+
+        Returns:
+            Pointer to the vec_int struct
+        """
+        if self.builder is None:
+            raise RuntimeError("Builder not initialized - must be inside a function")
+
+        i32 = ir.IntType(32)
+        i64 = ir.IntType(64)
+        with self.builder.goto_entry_block():
+            storage = self.builder.alloca(ir.ArrayType(i64, capacity), name=f"{name}_storage")
+            vec_ptr = self.builder.alloca(self.runtime.get_vec_int_type(), name=name)
+
+        zero = ir.Constant(i32, 0)
+        data = self.builder.gep(storage, [zero, zero], name=f"{name}_data")
+        self.builder.store(data, self.builder.gep(vec_ptr, [zero, zero]))
+        self.builder.store(ir.Constant(i64, 0), self.builder.gep(vec_ptr, [zero, ir.Constant(i32, 1)]))
+        self.builder.store(ir.Constant(i64, capacity), self.builder.gep(vec_ptr, [zero, ir.Constant(i32, 2)]))
+        return vec_ptr
+
+    def _add_debug_unit(self, source_file: str) -> None:
+        """Add the DWARF compile unit for the Python source, and the module flags LLVM requires with it.
+
+        Only line tables are emitted: enough for perf, callgrind and debuggers
+        to attribute samples and frames to Python lines.
+        """
+        path = Path(source_file)
+        i32 = ir.IntType(32)
+        self.debug_file = self.module.add_debug_info("DIFile", {"filename": path.name, "directory": str(path.parent)})
+        self.debug_unit = self.module.add_debug_info(
+            "DICompileUnit",
+            {
+                # The generated code has C semantics, and every DWARF consumer understands C
+                "language": ir.DIToken("DW_LANG_C99"),
+                "file": self.debug_file,
+                "producer": "mgen",
+                "runtimeVersion": 0,
+                "isOptimized": True,
+                "emissionKind": ir.DIToken("LineTablesOnly"),
+            },
+            is_distinct=True,
+        )
+        self.module.add_named_metadata("llvm.dbg.cu", self.debug_unit)
+        self.module.add_named_metadata("llvm.module.flags", [ir.Constant(i32, 2), "Dwarf Version", ir.Constant(i32, 4)])
+        self.module.add_named_metadata(
+            "llvm.module.flags", [ir.Constant(i32, 2), "Debug Info Version", ir.Constant(i32, 3)]
+        )
+
+    def _add_debug_subprogram(self, func: ir.Function, node: IRFunction) -> None:
+        """Attach a DISubprogram at the Python def line; statement locations are scoped to it."""
+        line = node.location.line if node.location else 0
+        subroutine_type = self.module.add_debug_info("DISubroutineType", {"types": self.module.add_metadata([None])})
+        self.debug_scope = self.module.add_debug_info(
+            "DISubprogram",
+            {
+                "name": node.name,
+                "scope": self.debug_file,
+                "file": self.debug_file,
+                "line": line,
+                "type": subroutine_type,
+                "isLocal": False,
+                "isDefinition": True,
+                "scopeLine": line,
+                "isOptimized": True,
+                "unit": self.debug_unit,
+            },
+            is_distinct=True,
+        )
+        func.set_metadata("dbg", self.debug_scope)
+
+    def _debug_location(self, node: IRNode, fallback: Optional[ir.DIValue]) -> ir.DIValue:
+        """The DILocation of a node's Python line and column, else fallback, else line 0 of the function."""
+        if node.location is not None and node.location.line > 0:
+            # col_offset counts from 0, DWARF columns from 1
+            line, column = node.location.line, node.location.column + 1
+        elif fallback is not None:
+            return fallback
+        else:
+            # Calls between functions with debug info must carry a location
+            line, column = 0, 0
+        return self.module.add_debug_info("DILocation", {"line": line, "column": column, "scope": self.debug_scope})
+
+    def _visit_statement(self, stmt: IRNode) -> None:
+        """Convert a statement, attributing its instructions to its Python line under debug info.
+
+        The enclosing location is restored afterwards, so a loop's increment and
+        back edge stay on the loop's own line rather than its last statement's.
+        """
+        if self.debug_unit is None or self.builder is None:
+            stmt.accept(self)
+            return
+        enclosing = self.builder.debug_metadata
+        self.builder.debug_metadata = self._debug_location(stmt, enclosing)
+        stmt.accept(self)
+        self.builder.debug_metadata = enclosing
+
+    def _add_function_hints(self, func: ir.Function, hints: list[str]) -> None:
+        """Add the function attributes for frontend optimization hints.
+
+        Args:
+            func: LLVM function
+            hints: Hints from the IR function's annotations
+        """
+        for hint in hints:
+            for attribute in FUNCTION_HINT_ATTRIBUTES.get(hint, ()):
+                try:
+                    func.attributes.add(attribute)
+                except ValueError:
+                    # Attribute unknown to this llvmlite release; it is only a hint
+                    pass
+
+    def _add_loop_hints(self, latch: ir.Instruction, hints: list[str]) -> None:
+        """Attach !llvm.loop metadata for frontend optimization hints.
+
+        Args:
+            latch: The loop's back-edge branch
+            hints: Hints from the IR loop's annotations
+        """
+        properties = []
+        if LOOP_UNROLL_FULL in hints:
+            properties.append(self.module.add_metadata(["llvm.loop.unroll.full"]))
+        if LOOP_VECTORIZE in hints:
+            # Width is left to the cost model for the selected --cpu
+            properties.append(self.module.add_metadata(["llvm.loop.vectorize.enable", ir.Constant(ir.IntType(1), 1)]))
+        if not properties:
+            return
+
+        # A loop ID is a node whose first operand is itself; add_metadata
+        # would unique it with other loops' IDs, so build it directly
+        loop_id = ir.values.MDValue(self.module, properties, name=str(len(self.module.metadata)))
+        loop_id.operands = (loop_id, *loop_id.operands)
+        latch.set_metadata("llvm.loop", loop_id)
+
     def visit_type_declaration(self, node: IRTypeDeclaration) -> None:
         """Visit a type declaration node (structs, unions, enums).
 
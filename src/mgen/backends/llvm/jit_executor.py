@@ -1,24 +1,44 @@
-"""JIT executor for LLVM backend using llvmlite execution engine.
+"""JIT executor for LLVM backend using llvmlite's ORC LLJIT.
 
 This module provides an alternative to AOT (ahead-of-time) compilation
-using llvmlite's MCJIT compiler for in-memory execution.
+using llvmlite's LLJIT for in-memory execution. Machine code is cached on
+disk, keyed by a hash of the IR, the optimization level and the host CPU,
+so running an unchanged program again skips code generation entirely.
+
+The cache lives in $MGEN_JIT_CACHE_DIR, or mgen/jit under the XDG cache
+directory (~/.cache by default).
 """
 
+import hashlib
+import os
+import tempfile
 from ctypes import CFUNCTYPE, c_int64
 from pathlib import Path
-from typing import Any, Optional
+from typing import Any, Optional, Union
 
+import llvmlite  # type: ignore[import-untyped]
 import llvmlite.binding as llvm  # type: ignore[import-untyped]
 
+from .target import create_target_machine, resolve_cpu
+
+
+def default_cache_dir() -> Path:
+    """Directory for cached JIT object code."""
+    if os.environ.get("MGEN_JIT_CACHE_DIR"):
+        return Path(os.environ["MGEN_JIT_CACHE_DIR"])
+    cache_home = os.environ.get("XDG_CACHE_HOME") or str(Path.home() / ".cache")
+    return Path(cache_home) / "mgen" / "jit"
+
 
 class LLVMJITExecutor:
-    """JIT executor for LLVM IR using llvmlite execution engine.
+    """JIT executor for LLVM IR using llvmlite's ORC LLJIT.
 
     This provides an alternative compilation mode that executes code
-    in-memory without generating object files or executables.
+    in-memory without generating executables.
 
     Benefits:
     - Faster development cycle (no llc/clang overhead)
+    - Repeat runs of unchanged IR load cached machine code instead of compiling
     - Useful for testing and debugging
     - Simpler build process
 
@@ -26,38 +46,102 @@ class LLVMJITExecutor:
     - Cannot produce standalone executables
     - Runtime dependency on llvmlite
     - Limited to in-process execution
+    - A cache miss compiles the whole module up front (llvmlite does not
+      expose ORC's lazy per-function compilation)
     """
 
-    def __init__(self) -> None:
-        """Initialize the JIT executor."""
+    def __init__(
+        self,
+        opt_level: int = 2,
+        cache_dir: Optional[Union[str, Path]] = None,
+        use_cache: bool = True,
+        cpu: Optional[str] = "native",
+        features: Optional[str] = None,
+    ) -> None:
+        """Initialize the JIT executor.
+
+        Args:
+            opt_level: Code generation optimization level (0-3)
+            cpu: CPU to generate code for (default: the host); None for the generic baseline
+            features: LLVM feature overrides, e.g. "-avx512f"
+            cache_dir: Directory for cached object code (default: default_cache_dir())
+            use_cache: Whether to read and write the object cache
+        """
         # Initialize LLVM native target and ASM printer
         # Note: llvm.initialize() is deprecated and handled automatically
         llvm.initialize_native_target()
         llvm.initialize_native_asmprinter()
 
-        self.engine: Optional[llvm.ExecutionEngine] = None
+        self.opt_level = opt_level
+        self.cache_dir = Path(cache_dir) if cache_dir is not None else default_cache_dir()
+        self.use_cache = use_cache
+
+        # Code only ever runs on this machine, so tune for the host by default;
+        # objects are cached per CPU and feature string
+        self.cpu_name, self.cpu_features = resolve_cpu(cpu, features)
+        self.target_machine = create_target_machine(
+            opt_level=opt_level, cpu=self.cpu_name, features=self.cpu_features, codemodel="jitdefault", jit=True
+        )
+
+        self.engine: Optional[llvm.LLJIT] = None
         self.modules: list[llvm.ModuleRef] = []
+        self.trackers: list[llvm.ResourceTracker] = []
+        self.cache_hits = 0
+        self.cache_misses = 0
 
-    def create_execution_engine(self) -> llvm.ExecutionEngine:
-        """Create MCJIT execution engine.
+    def create_execution_engine(self) -> llvm.LLJIT:
+        """Create the LLJIT instance that programs are linked into.
 
         Returns:
-            Execution engine instance
+            LLJIT instance
         """
-        # Create target machine
-        target = llvm.Target.from_default_triple()
-        target_machine = target.create_target_machine()
-
-        # Create backing module (empty module required by MCJIT)
-        backing_mod = llvm.parse_assembly("")
-        backing_mod.verify()
-
-        # Create MCJIT compiler
-        engine = llvm.create_mcjit_compiler(backing_mod, target_machine)
+        engine = llvm.create_lljit_compiler()
         self.engine = engine
 
         return engine
 
+    def cache_key(self, llvm_ir: str) -> str:
+        """Key for the object code of llvm_ir on this host at this opt level."""
+        digest = hashlib.sha256()
+        for part in (
+            llvm_ir,
+            str(self.opt_level),
+            self.target_machine.triple,
+            self.cpu_name,
+            self.cpu_features,
+            llvmlite.__version__,
+            ".".join(map(str, llvm.llvm_version_info)),
+        ):
+            digest.update(part.encode())
+            digest.update(b"\0")
+        return digest.hexdigest()
+
+    def _object_code(self, llvm_ir: str, mod: llvm.ModuleRef) -> bytes:
+        """Object code for the module, from the cache or freshly emitted."""
+        if not self.use_cache:
+            return self.target_machine.emit_object(mod)
+
+        cache_file = self.cache_dir / f"{self.cache_key(llvm_ir)}.o"
+        try:
+            object_code = cache_file.read_bytes()
+            self.cache_hits += 1
+            return object_code
+        except OSError:
+            pass
+
+        self.cache_misses += 1
+        object_code = self.target_machine.emit_object(mod)
+        try:
+            # Write then rename, so concurrent runs never load a partial file
+            self.cache_dir.mkdir(parents=True, exist_ok=True)
+            fd, tmp_name = tempfile.mkstemp(dir=self.cache_dir, suffix=".tmp")
+            with os.fdopen(fd, "wb") as tmp_file:
+                tmp_file.write(object_code)
+            os.replace(tmp_name, cache_file)
+        except OSError:
+            pass  # An unwritable cache only costs the next run a compile
+        return object_code
+
     def compile_ir(self, llvm_ir: str) -> llvm.ModuleRef:
         """Compile LLVM IR string to module.
 
@@ -82,11 +166,16 @@ class LLVMJITExecutor:
         except RuntimeError as e:
             raise RuntimeError(f"LLVM IR verification failed: {e}") from e
 
-        # Add module to execution engine
+        # Link the object code into the JIT; libc and other process symbols
+        # resolve against the running interpreter. Linking runs static constructors.
         assert self.engine is not None, "Execution engine should be initialized"
-        self.engine.add_module(mod)
-        self.engine.finalize_object()
-        self.engine.run_static_constructors()
+        library = llvm.JITLibraryBuilder()
+        library.add_object_img(self._object_code(llvm_ir, mod))
+        library.add_current_process()
+        for function in mod.functions:
+            if not function.is_declaration:
+                library.export_symbol(function.name)
+        self.trackers.append(library.link(self.engine, f"mgen_module_{len(self.trackers)}"))
 
         self.modules.append(mod)
         return mod
@@ -122,16 +211,15 @@ class LLVMJITExecutor:
         if self.engine is None:
             raise RuntimeError("No execution engine created")
 
-        try:
-            addr = self.engine.get_function_address(function_name)
-            # get_function_address returns 0 if function not found
-            if addr == 0:
-                raise RuntimeError(f"Function '{function_name}' not found")
-            return addr
-        except Exception as e:
-            if "not found" not in str(e):
-                raise RuntimeError(f"Function '{function_name}' not found: {e}") from e
-            raise
+        # Exported symbols of every linked module; later modules win
+        for tracker in reversed(self.trackers):
+            try:
+                addr = tracker[function_name]
+            except KeyError:
+                continue
+            if addr:
+                return int(addr)
+        raise RuntimeError(f"Function '{function_name}' not found")
 
     def execute_main(self) -> int:
         """Execute main() function and return result.
@@ -180,7 +268,8 @@ class LLVMJITExecutor:
     def cleanup(self) -> None:
         """Clean up execution engine resources."""
         if self.engine:
-            # Modules are owned by engine, will be cleaned up
+            # Dropping the trackers releases each module's code before the JIT
+            self.trackers.clear()
             self.engine = None
             self.modules.clear()
 
@@ -209,7 +298,8 @@ def jit_compile_and_run(llvm_ir_file: str, verbose: bool = False) -> int:
         mod = executor.compile_ir_file(llvm_ir_file)
 
         if verbose:
-            print("Compilation successful")
+            source = "object cache" if executor.cache_hits else "compiled"
+            print(f"Compilation successful ({source})")
             print("Executing main()...")
 
         # Execute main
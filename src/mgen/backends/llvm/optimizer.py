@@ -14,12 +14,24 @@ Example:
     >>> from mgen.backends.llvm.optimizer import LLVMOptimizer
     >>> optimizer = LLVMOptimizer(opt_level=2)
     >>> optimized_ir = optimizer.optimize(original_ir)
+
+Runtime bitcode passed to optimize() is linked into the module first, so the
+passes see the container and string runtime's definitions rather than opaque
+calls.
+
+The pipeline is the same for every function, but the emitter attaches the
+frontend's optimization hints (mgen.frontend.optimization_hints) to the IR it
+is given: hot and cold function attributes, with cold functions optimized for
+size, and !llvm.loop metadata that fully unrolls small constant loops and
+vectorizes loops the vectorization detector proves independent.
 """
 
-from typing import Any
+from typing import Any, Optional
 
 from llvmlite import binding as llvm  # type: ignore[import-untyped]
 
+from .target import create_target_machine, resolve_cpu
+
 
 class LLVMOptimizer:
     """Manages LLVM optimization passes for IR optimization.
@@ -30,36 +42,53 @@ class LLVMOptimizer:
 
     Attributes:
         opt_level: Optimization level (0-3)
+        cpu_name: CPU the passes tune for ("" for the generic baseline)
+        cpu_features: LLVM feature string for that CPU
         target_machine: LLVM target machine for platform-specific opts
     """
 
-    def __init__(self, opt_level: int = 2) -> None:
+    def __init__(
+        self,
+        opt_level: int = 2,
+        cpu: Optional[str] = None,
+        features: Optional[str] = None,
+        target_machine: Optional[llvm.TargetMachine] = None,
+    ) -> None:
         """Initialize the LLVM optimizer.
 
         Args:
             opt_level: Optimization level (0=none, 1=basic, 2=moderate, 3=aggressive)
+            cpu: CPU the passes tune for: None for the generic baseline, "native" or an LLVM CPU name
+            features: LLVM feature overrides, e.g. "+avx2,-avx512f"
+            target_machine: Optimize for this target instead of the host
+                (e.g. WebAssembly); cpu and features are then ignored
         """
         if not 0 <= opt_level <= 3:
             raise ValueError(f"Optimization level must be 0-3, got {opt_level}")
 
         self.opt_level = opt_level
 
-        # Initialize LLVM native target
-        llvm.initialize_native_target()
-        llvm.initialize_native_asmprinter()
-
-        # Create target machine for native platform
-        target = llvm.Target.from_default_triple()
-        self.target_machine = target.create_target_machine(opt=opt_level)
-
-    def optimize(self, llvm_ir: str) -> str:
+        # Target machine for the native triple; its CPU decides the vector
+        # widths the loop and SLP vectorizers cost against
+        if target_machine is not None:
+            self.cpu_name, self.cpu_features = "", ""
+            self.target_machine = target_machine
+        else:
+            self.cpu_name, self.cpu_features = resolve_cpu(cpu, features)
+            self.target_machine = create_target_machine(
+                opt_level=opt_level, cpu=self.cpu_name, features=self.cpu_features
+            )
+
+    def optimize(self, llvm_ir: str, runtime_bitcode: Optional[list[bytes]] = None) -> str:
         """Apply optimization passes to LLVM IR.
 
-        This method parses the IR, configures optimization passes based on
-        the optimization level, runs the passes, and returns optimized IR.
+        This method parses the IR, links in any runtime bitcode, configures
+        optimization passes based on the optimization level, runs the passes,
+        and returns optimized IR.
 
         Args:
             llvm_ir: LLVM IR as string
+            runtime_bitcode: LLVM bitcode of runtime libraries to link in before optimizing
 
         Returns:
             Optimized LLVM IR as string
@@ -75,6 +104,9 @@ class LLVMOptimizer:
         except Exception as e:
             raise ValueError(f"Failed to parse LLVM IR: {e}") from e
 
+        if runtime_bitcode:
+            self._link_runtime(llvm_module, runtime_bitcode)
+
         # Skip optimization for O0
         if self.opt_level == 0:
             return str(llvm_module)
@@ -101,6 +133,37 @@ class LLVMOptimizer:
         # Return optimized IR
         return str(llvm_module)
 
+    def _link_runtime(self, llvm_module: llvm.ModuleRef, runtime_bitcode: list[bytes]) -> None:
+        """Link runtime bitcode into the program module.
+
+        Linked runtime functions are made internal: the program is their only
+        caller, so the inliner can fold accessors such as vec_int_at and
+        vec_int_push into hot loops (where their bounds checks become loop
+        invariant) and global DCE drops whatever is left unused.
+
+        Args:
+            llvm_module: Parsed program module, modified in place
+            runtime_bitcode: Bitcode of each runtime library
+
+        Raises:
+            RuntimeError: If a runtime module fails to parse or link
+        """
+        # Generated IR leaves the triple empty (host target); match the runtime's
+        if not llvm_module.triple:
+            llvm_module.triple = self.target_machine.triple
+            llvm_module.data_layout = str(self.target_machine.target_data)
+
+        program_functions = {function.name for function in llvm_module.functions if not function.is_declaration}
+        try:
+            for bitcode in runtime_bitcode:
+                llvm_module.link_in(llvm.parse_bitcode(bitcode))
+        except Exception as e:
+            raise RuntimeError(f"Failed to link runtime bitcode: {e}") from e
+
+        for function in llvm_module.functions:
+            if not function.is_declaration and function.name not in program_functions:
+                function.linkage = "internal"
+
     def _configure_pipeline_options(self, pto: llvm.PipelineTuningOptions) -> None:
         """Configure pipeline tuning options based on optimization level.
 
@@ -260,4 +323,5 @@ class LLVMOptimizer:
             "vectorization_enabled": self.opt_level >= 2,
             "loop_unrolling_enabled": self.opt_level >= 2,
             "target_triple": self.target_machine.triple,
+            "target_cpu": self.cpu_name or "generic",
         }
@@ -110,10 +110,10 @@ void map_str_int_init_ptr(map_str_int* out) {
     *out = map_str_int_init();
 }
 
-// Set or update key-value pair
-void map_str_int_set(map_str_int* map, const char* key, long long value) {
+// Find or insert (with value 0) key, returning its value slot; valid until the next insertion
+long long* map_str_int_slot(map_str_int* map, const char* key) {
     if (!map || !key) {
-        fprintf(stderr, "map_str_int error: NULL pointer passed to map_str_int_set\n"); exit(1);
+        fprintf(stderr, "map_str_int error: NULL pointer passed to map_str_int_slot\n"); exit(1);
     }
 
     // Check if we need to grow
@@ -136,10 +136,16 @@ void map_str_int_set(map_str_int* map, const char* key, long long value) {
             fprintf(stderr, "map_str_int error: Memory allocation failed\n"); exit(1);
         }
         entry->is_occupied = 1;
+        entry->value = 0;
         map->size++;
     }
 
-    entry->value = value;
+    return &entry->value;
+}
+
+// Set or update key-value pair
+void map_str_int_set(map_str_int* map, const char* key, long long value) {
+    *map_str_int_slot(map, key) = value;
 }
 
 // Get value by key (returns 0 if key doesn't exist)
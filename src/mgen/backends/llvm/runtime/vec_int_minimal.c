@@ -1,47 +1,23 @@
 /**
- * Minimal vec_int runtime for LLVM backend
- * Single file implementation with all dependencies included
+ * vec_int runtime for LLVM backend
+ * The C backend's vec_T template instantiated for 64-bit elements (vec_i64,
+ * generated into the build directory by LLVMBuilder), wrapped in the
+ * calling convention of the generated IR: values instead of element pointers,
+ * and fatal errors on misuse.
  */
 
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdio.h>
+#include "mgen_vec_i64.h"
 
-// Error handling placeholder
-#define MGEN_SET_ERROR(code, msg) ((void)0)
-#define MGEN_ERROR_MEMORY 1
-#define MGEN_ERROR_VALUE 2
-
-#define VEC_INT_DEFAULT_CAPACITY 8
-#define VEC_INT_GROWTH_FACTOR 2
-
-// Dynamic integer array structure
-typedef struct {
-    long long* data;     // Array data (using long long for i64 compatibility)
-    size_t size;         // Number of elements
-    size_t capacity;     // Allocated capacity
-} vec_int;
-
-// Internal helper function
-static void vec_int_grow(vec_int* vec) {
-    size_t new_capacity = (vec->capacity == 0) ? VEC_INT_DEFAULT_CAPACITY : vec->capacity * VEC_INT_GROWTH_FACTOR;
-    long long* new_data = realloc(vec->data, new_capacity * sizeof(long long));
-    if (!new_data) {
-        fprintf(stderr, "vec_int error: Failed to allocate memory for capacity %zu\n", new_capacity);
-        exit(1);
-    }
-    vec->data = new_data;
-    vec->capacity = new_capacity;
-}
+// Same layout as the IR's struct.vec_int { i64*, i64, i64 }
+typedef vec_i64 vec_int;
 
 // Create a new integer vector
 vec_int vec_int_init(void) {
-    vec_int vec;
-    vec.capacity = VEC_INT_DEFAULT_CAPACITY;
-    vec.size = 0;
-    vec.data = malloc(VEC_INT_DEFAULT_CAPACITY * sizeof(long long));
+    vec_int vec = vec_i64_init();
     if (!vec.data) {
-        vec.capacity = 0;
         fprintf(stderr, "vec_int error: Failed to allocate initial memory\n");
         exit(1);
     }
@@ -63,12 +39,12 @@ void vec_int_push(vec_int* vec, long long value) {
         fprintf(stderr, "vec_int error: NULL pointer passed to vec_int_push\n");
         exit(1);
     }
-
-    if (vec->size >= vec->capacity) {
-        vec_int_grow(vec);
+    size_t size = vec->size;
+    vec_i64_push(vec, value);
+    if (vec->size == size) {
+        fprintf(stderr, "vec_int error: Failed to allocate memory for capacity %zu\n", size + 1);
+        exit(1);
     }
-
-    vec->data[vec->size++] = value;
 }
 
 // Get element at index
@@ -77,11 +53,12 @@ long long vec_int_at(vec_int* vec, size_t index) {
         fprintf(stderr, "vec_int error: NULL pointer passed to vec_int_at\n");
         exit(1);
     }
-    if (index >= vec->size) {
+    long long* element = vec_i64_at(vec, index);
+    if (!element) {
         fprintf(stderr, "vec_int error: Index %zu out of bounds (size = %zu)\n", index, vec->size);
         exit(1);
     }
-    return vec->data[index];
+    return *element;
 }
 
 // Set element at index
@@ -90,44 +67,32 @@ void vec_int_set(vec_int* vec, size_t index, long long value) {
         fprintf(stderr, "vec_int error: NULL pointer passed to vec_int_set\n");
         exit(1);
     }
-    if (index >= vec->size) {
+    long long* element = vec_i64_at(vec, index);
+    if (!element) {
         fprintf(stderr, "vec_int error: Index %zu out of bounds for set (size = %zu)\n", index, vec->size);
         exit(1);
     }
-    vec->data[index] = value;
+    *element = value;
 }
 
 // Get size of vector
 size_t vec_int_size(vec_int* vec) {
-    if (!vec) {
-        return 0;
-    }
-    return vec->size;
+    return vec_i64_size(vec);
 }
 
 // Free vector memory
 void vec_int_free(vec_int* vec) {
-    if (vec && vec->data) {
-        free(vec->data);
-        vec->data = NULL;
-        vec->size = 0;
-        vec->capacity = 0;
-    }
+    vec_i64_drop(vec);
 }
 
 // Get pointer to data array
 long long* vec_int_data(vec_int* vec) {
-    if (!vec) {
-        return NULL;
-    }
-    return vec->data;
+    return vec ? vec->data : NULL;
 }
 
 // Clear vector (keep capacity)
 void vec_int_clear(vec_int* vec) {
-    if (vec) {
-        vec->size = 0;
-    }
+    vec_i64_clear(vec);
 }
 
 // Reserve capacity
@@ -135,12 +100,9 @@ void vec_int_reserve(vec_int* vec, size_t new_capacity) {
     if (!vec || new_capacity <= vec->capacity) {
         return;
     }
-
-    long long* new_data = realloc(vec->data, new_capacity * sizeof(long long));
-    if (!new_data) {
+    vec_i64_reserve(vec, new_capacity);
+    if (vec->capacity < new_capacity) {
         fprintf(stderr, "vec_int error: Failed to reserve capacity %zu\n", new_capacity);
         exit(1);
     }
-    vec->data = new_data;
-    vec->capacity = new_capacity;
 }
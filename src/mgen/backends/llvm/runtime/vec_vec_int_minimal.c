@@ -5,18 +5,14 @@
 
 #include <stdlib.h>
 #include <stddef.h>
-#include <string.h>
 #include <stdio.h>
+#include "mgen_vec_i64.h"
 
 #define VEC_VEC_INT_DEFAULT_CAPACITY 8
 #define VEC_VEC_INT_GROWTH_FACTOR 2
 
-// vec_int structure (must match vec_int_minimal.c)
-typedef struct {
-    long long* data;
-    size_t size;
-    size_t capacity;
-} vec_int;
+// Rows are the vec_i64 template instances behind vec_int_minimal.c
+typedef vec_i64 vec_int;
 
 // vec_vec_int structure (2D array)
 typedef struct {
@@ -71,18 +67,11 @@ void vec_vec_int_push(vec_vec_int* vec, vec_int* row) {
         vec_vec_int_grow(vec);
     }
 
-    // Deep copy the row - allocate new memory and copy data
-    vec_int row_copy;
-    row_copy.size = row->size;
-    row_copy.capacity = row->capacity;
-    row_copy.data = malloc(row->capacity * sizeof(long long));
-    if (!row_copy.data) {
+    // Deep copy the row
+    vec_int row_copy = vec_i64_copy_range(row, 0, row->size);
+    if (row->size > 0 && !row_copy.data) {
         exit(1);
     }
-    // Copy the actual data elements
-    if (row->data && row->size > 0) {
-        memcpy(row_copy.data, row->data, row->size * sizeof(long long));
-    }
 
     // Store the deep copy in the array
     vec->data[vec->size++] = row_copy;
@@ -109,9 +98,7 @@ void vec_vec_int_free(vec_vec_int* vec) {
     if (vec && vec->data) {
         // Free each row's data
         for (size_t i = 0; i < vec->size; i++) {
-            if (vec->data[i].data) {
-                free(vec->data[i].data);
-            }
+            vec_i64_drop(&vec->data[i]);
         }
         // Free the array of rows
         free(vec->data);
@@ -126,9 +113,7 @@ void vec_vec_int_clear(vec_vec_int* vec) {
     if (vec) {
         // Free each row's data
         for (size_t i = 0; i < vec->size; i++) {
-            if (vec->data[i].data) {
-                free(vec->data[i].data);
-            }
+            vec_i64_drop(&vec->data[i]);
         }
         vec->size = 0;
     }
@@ -0,0 +1,15 @@
+/**
+ * Freestanding <ctype.h> for the WebAssembly build of the LLVM runtime (ASCII only).
+ * Implemented in mgen_wasm_libc.c.
+ */
+
+#ifndef MGEN_WASM_CTYPE_H
+#define MGEN_WASM_CTYPE_H
+
+int isspace(int c);
+int isdigit(int c);
+int isalpha(int c);
+int tolower(int c);
+int toupper(int c);
+
+#endif // MGEN_WASM_CTYPE_H
@@ -0,0 +1,17 @@
+/**
+ * Freestanding <stddef.h> for the WebAssembly build of the LLVM runtime.
+ *
+ * size_t is 64 bits even on wasm32: generated LLVM IR passes and stores
+ * sizes as i64 (vec_int is {i64*, i64, i64}), so the runtime has to agree.
+ */
+
+#ifndef MGEN_WASM_STDDEF_H
+#define MGEN_WASM_STDDEF_H
+
+typedef unsigned long long size_t;
+typedef long long ptrdiff_t;
+
+#define NULL ((void*)0)
+#define offsetof(type, member) __builtin_offsetof(type, member)
+
+#endif // MGEN_WASM_STDDEF_H
@@ -0,0 +1,25 @@
+/**
+ * Freestanding <stdio.h> for the WebAssembly build of the LLVM runtime.
+ *
+ * Only what the runtime's error paths and container repr use. fprintf()
+ * discards its output (every runtime error is followed by exit(), which
+ * traps); printf() is left undefined and becomes a host import, so the
+ * embedder decides where print() output goes.
+ */
+
+#ifndef MGEN_WASM_STDIO_H
+#define MGEN_WASM_STDIO_H
+
+#include <stddef.h>
+
+typedef struct mgen_wasm_file FILE;
+
+extern FILE* const stdout;
+extern FILE* const stderr;
+
+int fprintf(FILE* stream, const char* format, ...);
+int printf(const char* format, ...);
+int snprintf(char* out, size_t size, const char* format, ...);
+int sprintf(char* out, const char* format, ...);
+
+#endif // MGEN_WASM_STDIO_H
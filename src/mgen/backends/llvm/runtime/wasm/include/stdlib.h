@@ -0,0 +1,20 @@
+/**
+ * Freestanding <stdlib.h> for the WebAssembly build of the LLVM runtime.
+ * Implemented in mgen_wasm_libc.c.
+ */
+
+#ifndef MGEN_WASM_STDLIB_H
+#define MGEN_WASM_STDLIB_H
+
+#include <stddef.h>
+
+void* malloc(size_t size);
+void* calloc(size_t count, size_t size);
+void* realloc(void* ptr, size_t size);
+void free(void* ptr);
+
+// Traps: there is no process to exit from
+_Noreturn void exit(int status);
+_Noreturn void abort(void);
+
+#endif // MGEN_WASM_STDLIB_H
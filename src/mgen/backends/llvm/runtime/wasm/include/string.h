@@ -0,0 +1,27 @@
+/**
+ * Freestanding <string.h> for the WebAssembly build of the LLVM runtime.
+ * Implemented in mgen_wasm_libc.c.
+ */
+
+#ifndef MGEN_WASM_STRING_H
+#define MGEN_WASM_STRING_H
+
+#include <stddef.h>
+
+void* memcpy(void* dest, const void* src, size_t n);
+void* memmove(void* dest, const void* src, size_t n);
+void* memset(void* dest, int c, size_t n);
+int memcmp(const void* a, const void* b, size_t n);
+
+size_t strlen(const char* s);
+int strcmp(const char* a, const char* b);
+int strncmp(const char* a, const char* b, size_t n);
+char* strcpy(char* dest, const char* src);
+char* strncpy(char* dest, const char* src, size_t n);
+char* strcat(char* dest, const char* src);
+char* strchr(const char* s, int c);
+char* strstr(const char* haystack, const char* needle);
+char* strdup(const char* s);
+char* strtok_r(char* str, const char* delim, char** saveptr);
+
+#endif // MGEN_WASM_STRING_H
@@ -0,0 +1,451 @@
+/**
+ * Freestanding C library for the WebAssembly build of the LLVM runtime
+ *
+ * Provides the handful of libc functions the minimal runtime (vec/map/set/
+ * string) calls, so it can be compiled for wasm32-unknown-unknown without a
+ * WASI sysroot. Compile with -ffreestanding -fno-builtin and the headers in
+ * include/ ahead of the compiler's own.
+ *
+ * The allocator manages linear memory from __heap_base (set by wasm-ld)
+ * upwards: freed blocks go on an address-ordered free list and are merged
+ * with their neighbours, allocations are first fit, and memory.grow adds
+ * pages when the list has nothing large enough. Blocks are 16-byte aligned,
+ * so v128 loads and stores on runtime buffers never straddle a block.
+ */
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MGEN_WASM_PAGE_SIZE 65536
+#define MGEN_WASM_ALIGN 16
+
+// Header in front of every block; padded to MGEN_WASM_ALIGN bytes
+typedef struct mgen_wasm_block {
+    size_t size;                   // Payload bytes (multiple of MGEN_WASM_ALIGN)
+    struct mgen_wasm_block* next;  // Next free block by address (free blocks only)
+} mgen_wasm_block;
+
+_Static_assert(sizeof(mgen_wasm_block) <= MGEN_WASM_ALIGN, "block header must fit in one alignment unit");
+
+#define MGEN_WASM_HEADER MGEN_WASM_ALIGN
+#define BLOCK_PAYLOAD(block) ((void*)((char*)(block) + MGEN_WASM_HEADER))
+#define PAYLOAD_BLOCK(ptr) ((mgen_wasm_block*)((char*)(ptr) - MGEN_WASM_HEADER))
+#define BLOCK_END(block) ((char*)BLOCK_PAYLOAD(block) + (block)->size)
+
+extern unsigned char __heap_base;
+
+static char* heap_top = NULL;    // First byte past the last block
+static char* heap_limit = NULL;  // First byte past linear memory
+static mgen_wasm_block* free_list = NULL;
+
+static size_t align_up(size_t n) {
+    return (n + MGEN_WASM_ALIGN - 1) & ~(size_t)(MGEN_WASM_ALIGN - 1);
+}
+
+// Make room for `bytes` more past heap_top; returns 0 if memory cannot grow
+static int heap_reserve(size_t bytes) {
+    if (!heap_top) {
+        heap_top = (char*)align_up((size_t)&__heap_base);
+        heap_limit = (char*)((size_t)__builtin_wasm_memory_size(0) * MGEN_WASM_PAGE_SIZE);
+    }
+    if ((size_t)(heap_limit - heap_top) >= bytes) {
+        return 1;
+    }
+    size_t missing = bytes - (size_t)(heap_limit - heap_top);
+    size_t pages = (missing + MGEN_WASM_PAGE_SIZE - 1) / MGEN_WASM_PAGE_SIZE;
+    if (__builtin_wasm_memory_grow(0, pages) == (size_t)-1) {
+        return 0;
+    }
+    heap_limit += pages * MGEN_WASM_PAGE_SIZE;
+    return 1;
+}
+
+// Split the tail off a block when it is big enough to be a block of its own
+static void split_block(mgen_wasm_block* block, size_t size) {
+    if (block->size < size + MGEN_WASM_HEADER + MGEN_WASM_ALIGN) {
+        return;
+    }
+    mgen_wasm_block* rest = (mgen_wasm_block*)((char*)BLOCK_PAYLOAD(block) + size);
+    rest->size = block->size - size - MGEN_WASM_HEADER;
+    block->size = size;
+    free(BLOCK_PAYLOAD(rest));
+}
+
+void* malloc(size_t size) {
+    size = align_up(size ? size : 1);
+
+    // First fit from the free list
+    mgen_wasm_block** link = &free_list;
+    for (mgen_wasm_block* block = free_list; block; block = block->next) {
+        if (block->size >= size) {
+            *link = block->next;
+            split_block(block, size);
+            return BLOCK_PAYLOAD(block);
+        }
+        link = &block->next;
+    }
+
+    // Otherwise carve a new block off the top of the heap
+    if (size > (size_t)-1 - MGEN_WASM_HEADER || !heap_reserve(MGEN_WASM_HEADER + size)) {
+        return NULL;
+    }
+    mgen_wasm_block* block = (mgen_wasm_block*)heap_top;
+    block->size = size;
+    heap_top += MGEN_WASM_HEADER + size;
+    return BLOCK_PAYLOAD(block);
+}
+
+void free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    mgen_wasm_block* block = PAYLOAD_BLOCK(ptr);
+
+    // Insert in address order; link ends up pointing at the block
+    mgen_wasm_block** link = &free_list;
+    mgen_wasm_block** prev_link = NULL;
+    while (*link && *link < block) {
+        prev_link = link;
+        link = &(*link)->next;
+    }
+    block->next = *link;
+    *link = block;
+
+    // Merge with the following block, then with the preceding one
+    if (block->next && BLOCK_END(block) == (char*)block->next) {
+        block->size += MGEN_WASM_HEADER + block->next->size;
+        block->next = block->next->next;
+    }
+    if (prev_link && BLOCK_END(*prev_link) == (char*)block) {
+        mgen_wasm_block* prev = *prev_link;
+        prev->size += MGEN_WASM_HEADER + block->size;
+        prev->next = block->next;
+        block = prev;
+        link = prev_link;
+    }
+
+    // A free block at the top of the heap goes back to the bump region
+    if (BLOCK_END(block) == heap_top) {
+        *link = block->next;
+        heap_top = (char*)block;
+    }
+}
+
+void* calloc(size_t count, size_t size) {
+    if (size && count > (size_t)-1 / size) {
+        return NULL;
+    }
+    void* ptr = malloc(count * size);
+    if (ptr) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (!ptr) {
+        return malloc(size);
+    }
+    mgen_wasm_block* block = PAYLOAD_BLOCK(ptr);
+    size_t needed = align_up(size ? size : 1);
+    if (needed <= block->size) {
+        return ptr;
+    }
+
+    // The last block can grow in place: growing vectors usually are the last
+    if (BLOCK_END(block) == heap_top) {
+        if (!heap_reserve(needed - block->size)) {
+            return NULL;
+        }
+        heap_top += needed - block->size;
+        block->size = needed;
+        return ptr;
+    }
+
+    void* moved = malloc(size);
+    if (moved) {
+        memcpy(moved, ptr, block->size);
+        free(ptr);
+    }
+    return moved;
+}
+
+_Noreturn void exit(int status) {
+    (void)status;
+    __builtin_trap();
+}
+
+_Noreturn void abort(void) {
+    __builtin_trap();
+}
+
+// Error messages are dropped: the exit() that follows traps
+struct mgen_wasm_file {
+    int fd;
+};
+
+static struct mgen_wasm_file mgen_wasm_stdout = {1};
+static struct mgen_wasm_file mgen_wasm_stderr = {2};
+FILE* const stdout = &mgen_wasm_stdout;
+FILE* const stderr = &mgen_wasm_stderr;
+
+int fprintf(FILE* stream, const char* format, ...) {
+    (void)stream;
+    (void)format;
+    return 0;
+}
+
+// Formatting for the containers' repr: %d, %i and %u with l/ll/z, %s, %c and %%.
+// Like C99 vsnprintf, returns the full length and writes at most size - 1 bytes.
+static void format_put(char* out, size_t size, size_t* length, char c) {
+    if (*length + 1 < size) {
+        out[*length] = c;
+    }
+    (*length)++;
+}
+
+static int format_string(char* out, size_t size, const char* format, va_list args) {
+    size_t length = 0;
+    for (const char* p = format; *p; p++) {
+        if (*p != '%') {
+            format_put(out, size, &length, *p);
+            continue;
+        }
+        p++;
+        int longs = 0;
+        int is_size = 0;
+        for (; *p == 'l' || *p == 'z'; p++) {
+            if (*p == 'z') {
+                is_size = 1;
+            } else {
+                longs++;
+            }
+        }
+        if (*p == 'd' || *p == 'i' || *p == 'u') {
+            unsigned long long magnitude;
+            int negative = 0;
+            if (*p == 'u' || is_size) {
+                magnitude = is_size ? va_arg(args, size_t)
+                            : longs == 2 ? va_arg(args, unsigned long long)
+                            : longs == 1 ? va_arg(args, unsigned long)
+                                         : va_arg(args, unsigned int);
+            } else {
+                long long value = longs == 2 ? va_arg(args, long long)
+                                  : longs == 1 ? va_arg(args, long)
+                                               : va_arg(args, int);
+                negative = value < 0;
+                magnitude = negative ? 0ull - (unsigned long long)value : (unsigned long long)value;
+            }
+            char digits[24];
+            int count = 0;
+            do {
+                digits[count++] = (char)('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude);
+            if (negative) {
+                format_put(out, size, &length, '-');
+            }
+            while (count) {
+                format_put(out, size, &length, digits[--count]);
+            }
+        } else if (*p == 's') {
+            for (const char* s = va_arg(args, const char*); *s; s++) {
+                format_put(out, size, &length, *s);
+            }
+        } else if (*p == 'c') {
+            format_put(out, size, &length, (char)va_arg(args, int));
+        } else if (*p == '%') {
+            format_put(out, size, &length, '%');
+        } else if (!*p) {
+            break;
+        }
+    }
+    if (size > 0) {
+        out[length < size ? length : size - 1] = '\0';
+    }
+    return (int)length;
+}
+
+int snprintf(char* out, size_t size, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = format_string(out, size, format, args);
+    va_end(args);
+    return length;
+}
+
+int sprintf(char* out, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = format_string(out, (size_t)-1, format, args);
+    va_end(args);
+    return length;
+}
+
+// Memory and string functions. LLVM does not turn the loops inside
+// functions named memcpy/memset back into calls to themselves.
+
+void* memcpy(void* dest, const void* src, size_t n) {
+    unsigned char* d = dest;
+    const unsigned char* s = src;
+    while (n--) {
+        *d++ = *s++;
+    }
+    return dest;
+}
+
+void* memmove(void* dest, const void* src, size_t n) {
+    unsigned char* d = dest;
+    const unsigned char* s = src;
+    if (d < s) {
+        while (n--) {
+            *d++ = *s++;
+        }
+    } else {
+        while (n--) {
+            d[n] = s[n];
+        }
+    }
+    return dest;
+}
+
+void* memset(void* dest, int c, size_t n) {
+    unsigned char* d = dest;
+    while (n--) {
+        *d++ = (unsigned char)c;
+    }
+    return dest;
+}
+
+int memcmp(const void* a, const void* b, size_t n) {
+    const unsigned char* x = a;
+    const unsigned char* y = b;
+    for (; n; n--, x++, y++) {
+        if (*x != *y) {
+            return *x - *y;
+        }
+    }
+    return 0;
+}
+
+size_t strlen(const char* s) {
+    const char* end = s;
+    while (*end) {
+        end++;
+    }
+    return (size_t)(end - s);
+}
+
+int strcmp(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return (unsigned char)*a - (unsigned char)*b;
+}
+
+int strncmp(const char* a, const char* b, size_t n) {
+    for (; n; n--, a++, b++) {
+        if (*a != *b || !*a) {
+            return (unsigned char)*a - (unsigned char)*b;
+        }
+    }
+    return 0;
+}
+
+char* strcpy(char* dest, const char* src) {
+    char* d = dest;
+    while ((*d++ = *src++)) {
+    }
+    return dest;
+}
+
+char* strncpy(char* dest, const char* src, size_t n) {
+    size_t i = 0;
+    for (; i < n && src[i]; i++) {
+        dest[i] = src[i];
+    }
+    for (; i < n; i++) {
+        dest[i] = '\0';
+    }
+    return dest;
+}
+
+char* strcat(char* dest, const char* src) {
+    strcpy(dest + strlen(dest), src);
+    return dest;
+}
+
+char* strchr(const char* s, int c) {
+    for (;; s++) {
+        if (*s == (char)c) {
+            return (char*)s;
+        }
+        if (!*s) {
+            return NULL;
+        }
+    }
+}
+
+char* strstr(const char* haystack, const char* needle) {
+    size_t n = strlen(needle);
+    for (; *haystack; haystack++) {
+        if (strncmp(haystack, needle, n) == 0) {
+            return (char*)haystack;
+        }
+    }
+    return n == 0 ? (char*)haystack : NULL;
+}
+
+char* strdup(const char* s) {
+    size_t n = strlen(s) + 1;
+    char* copy = malloc(n);
+    if (copy) {
+        memcpy(copy, s, n);
+    }
+    return copy;
+}
+
+char* strtok_r(char* str, const char* delim, char** saveptr) {
+    char* s = str ? str : *saveptr;
+    while (*s && strchr(delim, *s)) {
+        s++;
+    }
+    if (!*s) {
+        *saveptr = s;
+        return NULL;
+    }
+    char* token = s;
+    while (*s && !strchr(delim, *s)) {
+        s++;
+    }
+    if (*s) {
+        *s++ = '\0';
+    }
+    *saveptr = s;
+    return token;
+}
+
+int isspace(int c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+int isdigit(int c) {
+    return c >= '0' && c <= '9';
+}
+
+int isalpha(int c) {
+    return (c | 32) >= 'a' && (c | 32) <= 'z';
+}
+
+int tolower(int c) {
+    return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+}
+
+int toupper(int c) {
+    return (c >= 'a' && c <= 'z') ? c - 32 : c;
+}
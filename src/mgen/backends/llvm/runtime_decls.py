@@ -457,6 +457,11 @@ class LLVMRuntimeDeclarations:
         func = ir.Function(self.module, func_type, name="map_str_int_get")
         self.function_decls["map_str_int_get"] = func
 
+        # long long* map_str_int_slot(map_str_int* map, const char* key)
+        func_type = ir.FunctionType(i64.as_pointer(), [map_str_int_ptr, i8_ptr])
+        func = ir.Function(self.module, func_type, name="map_str_int_slot")
+        self.function_decls["map_str_int_slot"] = func
+
         # int map_str_int_contains(map_str_int* map, const char* key)
         func_type = ir.FunctionType(i32, [map_str_int_ptr, i8_ptr])
         func = ir.Function(self.module, func_type, name="map_str_int_contains")
@@ -477,9 +482,11 @@ class LLVMRuntimeDeclarations:
 
         C struct definition:
             typedef struct {
-                map_int_entry* entries;
+                map_i64_i64_entry* entries;
                 size_t size;
                 size_t capacity;
+                size_t used;
+                uint32_t* index;
             } map_int_int;
 
         Returns:
@@ -497,13 +504,15 @@ class LLVMRuntimeDeclarations:
             return map_int_int_type
 
         # Define the struct body to match C definition
-        # map_int_entry* entries (opaque pointer)
+        # map_i64_i64_entry* entries (opaque pointer)
         i8_ptr = ir.IntType(8).as_pointer()
 
         map_int_int_type.set_body(
-            i8_ptr,  # entries: map_int_entry* (treated as opaque i8*)
+            i8_ptr,  # entries: map_i64_i64_entry* (treated as opaque i8*)
             ir.IntType(64),  # size: size_t
             ir.IntType(64),  # capacity: size_t
+            ir.IntType(64),  # used: size_t
+            i8_ptr,  # index: uint32_t* (treated as opaque i8*)
         )
 
         self.struct_types["map_int_int"] = map_int_int_type
@@ -527,6 +536,11 @@ class LLVMRuntimeDeclarations:
         func = ir.Function(self.module, func_type, name="map_int_int_set")
         self.function_decls["map_int_int_set"] = func
 
+        # long long* map_int_int_slot(map_int_int* map, long long key)
+        func_type = ir.FunctionType(i64.as_pointer(), [map_int_int_ptr, i64])
+        func = ir.Function(self.module, func_type, name="map_int_int_slot")
+        self.function_decls["map_int_int_slot"] = func
+
         # long long map_int_int_get(map_int_int* map, long long key)
         func_type = ir.FunctionType(i64, [map_int_int_ptr, i64])
         func = ir.Function(self.module, func_type, name="map_int_int_get")
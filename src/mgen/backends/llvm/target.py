@@ -0,0 +1,61 @@
+"""Target machine selection for the LLVM backend.
+
+By default code is generated for the triple's generic baseline CPU (e.g.
+x86-64), which runs on any machine of that architecture. Passing
+cpu="native" tunes for the host instead, enabling every feature it has
+(AVX2, AVX-512, ...) so the vectorizers can use its widest registers.
+
+Example:
+    >>> from mgen.backends.llvm.target import create_target_machine
+    >>> tm = create_target_machine(opt_level=3, cpu="native")
+    >>> tm = create_target_machine(cpu="skylake", features="-avx512f")
+"""
+
+from typing import Any, Optional
+
+from llvmlite import binding as llvm  # type: ignore[import-untyped]
+
+
+def resolve_cpu(cpu: Optional[str] = None, features: Optional[str] = None) -> tuple[str, str]:
+    """Resolve a CPU name and feature string for create_target_machine.
+
+    Args:
+        cpu: None or "" for the generic baseline, "native" for the host CPU,
+            or an LLVM CPU name (e.g. "skylake-avx512", "znver3")
+        features: Comma-separated LLVM features (e.g. "+avx2,-avx512f"); with
+            cpu="native" they are applied on top of the host's features
+
+    Returns:
+        (cpu_name, feature_string) as LLVM expects them
+    """
+    cpu_name = cpu or ""
+    feature_string = features or ""
+    if cpu_name == "native":
+        llvm.initialize_native_target()
+        cpu_name = llvm.get_host_cpu_name()
+        host_features = llvm.get_host_cpu_features().flatten()
+        # Later entries win, so explicit features override the host's
+        feature_string = ",".join(part for part in (host_features, feature_string) if part)
+    return cpu_name, feature_string
+
+
+def create_target_machine(
+    opt_level: int = 2, cpu: Optional[str] = None, features: Optional[str] = None, **options: Any
+) -> llvm.TargetMachine:
+    """Create a target machine for the default triple.
+
+    Args:
+        opt_level: Code generation optimization level (0-3)
+        cpu: CPU to generate code for (see resolve_cpu)
+        features: Feature overrides (see resolve_cpu)
+        **options: Further create_target_machine options (reloc, codemodel, jit, ...)
+
+    Returns:
+        LLVM target machine
+    """
+    llvm.initialize_native_target()
+    llvm.initialize_native_asmprinter()
+
+    cpu_name, feature_string = resolve_cpu(cpu, features)
+    target = llvm.Target.from_default_triple()
+    return target.create_target_machine(cpu=cpu_name, features=feature_string, opt=opt_level, **options)
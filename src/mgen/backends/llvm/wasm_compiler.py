@@ -11,12 +11,23 @@ IMPORTANT: This is experimental functionality. WebAssembly compilation requires:
 
 Current Status (v0.1.85-dev):
 - Phase 1: Pure function compilation to WASM objects ✅
+- Phase 1b: Full programs linked with a wasm build of the minimal runtime ✅
+  (requires clang with the WebAssembly target and wasm-ld)
 - Phase 2: JavaScript runtime bridge (planned)
 - Phase 3: WASI support (planned)
 - Phase 4: Emscripten integration (planned)
+
+Code is generated with the simd128 feature by default, so the loop and SLP
+vectorizers can use v128 operations. Full programs link the same vec/map/set/
+string runtime as native builds, compiled freestanding against runtime/wasm:
+a small libc whose allocator manages linear memory, growing it with
+memory.grow. printf() is left as an import for the embedder to provide.
 """
 
 import re
+import shutil
+import subprocess
+import tempfile
 from pathlib import Path
 from typing import Optional
 
@@ -27,11 +38,17 @@ try:
 except ImportError:
     LLVMLITE_AVAILABLE = False
 
+# WebAssembly features enabled unless the caller overrides them
+DEFAULT_WASM_FEATURES = "+simd128"
+
+# Linear memory reserved for the shadow stack of a linked module
+WASM_STACK_SIZE = 1024 * 1024
+
 
 class WebAssemblyCompiler:
     """Compiler for generating WebAssembly from LLVM IR."""
 
-    def __init__(self, target_triple: str = "wasm32-unknown-unknown") -> None:
+    def __init__(self, target_triple: str = "wasm32-unknown-unknown", features: str = DEFAULT_WASM_FEATURES) -> None:
         """Initialize WebAssembly compiler.
 
         Args:
@@ -40,6 +57,8 @@ class WebAssemblyCompiler:
                 - wasm64-unknown-unknown: WebAssembly 64-bit
                 - wasm32-wasi: WASI (WebAssembly System Interface)
                 - wasm32-unknown-emscripten: Emscripten toolchain
+            features: LLVM feature string, e.g. "+simd128,+bulk-memory";
+                "" for the MVP instruction set
 
         Raises:
             ImportError: If llvmlite is not available
@@ -49,6 +68,7 @@ class WebAssemblyCompiler:
             raise ImportError("llvmlite is required for WebAssembly compilation")
 
         self.target_triple = target_triple
+        self.features = features
 
         # Initialize LLVM targets
         llvm.initialize_all_targets()
@@ -146,13 +166,20 @@ class WebAssemblyCompiler:
             llvm_module.verify()
 
             # Create WebAssembly target machine
-            target_machine = self.target.create_target_machine(
-                cpu="generic",
-                features="",
-                opt=opt_level,
-                reloc="pic",
-                codemodel="default",
-            )
+            target_machine = self._create_target_machine(opt_level)
+
+            # Generated IR leaves the triple and data layout empty (host target)
+            if not llvm_module.triple:
+                llvm_module.triple = self.target_triple
+            if not llvm_module.data_layout:
+                llvm_module.data_layout = str(target_machine.target_data)
+
+            # Optimize against the wasm target, so vectorization uses simd128
+            if opt_level > 0:
+                from .optimizer import LLVMOptimizer
+
+                optimized_ir = LLVMOptimizer(opt_level, target_machine=target_machine).optimize(str(llvm_module))
+                llvm_module = llvm.parse_assembly(optimized_ir)
 
             # Emit object code or assembly
             if text_format:
@@ -167,6 +194,134 @@ class WebAssemblyCompiler:
         except Exception as e:
             raise ValueError(f"WebAssembly compilation failed: {e}") from e
 
+    def _create_target_machine(self, opt_level: int) -> "llvm.TargetMachine":
+        """Create a target machine for the wasm triple and features."""
+        return self.target.create_target_machine(
+            cpu="generic",
+            features=self.features,
+            opt=opt_level,
+            reloc="pic",
+            codemodel="default",
+        )
+
+    def compile_runtime(self, output_dir: Path, opt_level: int = 2) -> list[Path]:
+        """Compile the minimal C runtime and its freestanding libc to wasm objects.
+
+        Args:
+            output_dir: Directory for the object files
+            opt_level: Optimization level (0-3)
+
+        Returns:
+            Paths of the runtime object files
+
+        Raises:
+            RuntimeError: If clang is missing or a runtime source fails to compile
+        """
+        from .builder import LLVMBuilder
+
+        clang = shutil.which("clang")
+        if clang is None:
+            raise RuntimeError("clang with the WebAssembly target is required to compile the runtime")
+
+        runtime_dir = Path(__file__).parent / "runtime"
+        wasm_dir = runtime_dir / "wasm"
+        sources = LLVMBuilder.runtime_sources(runtime_dir, output_dir) + [wasm_dir / "mgen_wasm_libc.c"]
+
+        objects = []
+        for source in sources:
+            obj_path = output_dir / f"{source.stem}.wasm.o"
+            cmd = [
+                clang,
+                f"--target={self.target_triple}",
+                "-ffreestanding",
+                "-fno-builtin",
+                "-nostdlib",
+                f"-O{opt_level}",
+                *self._clang_feature_flags(),
+                # The freestanding headers shadow the compiler's stddef.h
+                "-isystem",
+                str(wasm_dir / "include"),
+                "-I",
+                str(runtime_dir),
+                "-I",
+                str(output_dir),
+                "-c",
+                str(source),
+                "-o",
+                str(obj_path),
+            ]
+            result = subprocess.run(cmd, capture_output=True, text=True)
+            if result.returncode != 0:
+                raise RuntimeError(f"Runtime compilation failed for {source.name}: {result.stderr}")
+            objects.append(obj_path)
+        return objects
+
+    def _clang_feature_flags(self) -> list[str]:
+        """Translate the LLVM feature string into clang -m flags (+simd128 -> -msimd128)."""
+        flags = []
+        for feature in filter(None, (part.strip() for part in self.features.split(","))):
+            name = feature.lstrip("+-")
+            flags.append(f"-mno-{name}" if feature.startswith("-") else f"-m{name}")
+        return flags
+
+    def link(self, objects: list[Path], output_path: Path) -> bool:
+        """Link wasm objects into a module that exports its functions.
+
+        Undefined functions (printf) become imports from the "env" module.
+
+        Args:
+            objects: Program and runtime object files
+            output_path: Output .wasm module
+
+        Returns:
+            True if linking succeeded
+
+        Raises:
+            RuntimeError: If wasm-ld is missing or linking fails
+        """
+        wasm_ld = shutil.which("wasm-ld")
+        if wasm_ld is None:
+            raise RuntimeError("wasm-ld is required to link WebAssembly modules")
+
+        cmd = [
+            wasm_ld,
+            "--no-entry",
+            "--export-dynamic",
+            "--allow-undefined",
+            "-z",
+            f"stack-size={WASM_STACK_SIZE}",
+            *[str(obj) for obj in objects],
+            "-o",
+            str(output_path),
+        ]
+        result = subprocess.run(cmd, capture_output=True, text=True)
+        if result.returncode != 0:
+            raise RuntimeError(f"wasm-ld failed: {result.stderr}")
+        return True
+
+    def build_with_runtime(self, ir_path: Path, output_path: Path, opt_level: int = 2) -> bool:
+        """Compile a whole MGen program, runtime included, to a linked wasm module.
+
+        Args:
+            ir_path: Path to MGen LLVM IR file (.ll)
+            output_path: Output WebAssembly module (.wasm)
+            opt_level: Optimization level (0-3)
+
+        Returns:
+            True if compilation and linking succeeded
+
+        Raises:
+            FileNotFoundError: If IR file doesn't exist
+            ValueError: If the program fails to compile
+            RuntimeError: If the runtime fails to compile or link
+        """
+        with tempfile.TemporaryDirectory() as tmp:
+            tmp_dir = Path(tmp)
+            program_obj = tmp_dir / f"{ir_path.stem}.o"
+            self.compile_mgen_ir(ir_path, program_obj, opt_level, pure_functions_only=False)
+            runtime_objects = self.compile_runtime(tmp_dir, opt_level)
+            return self.link([program_obj, *runtime_objects], output_path)
+
     def compile_mgen_ir(
         self,
         ir_path: Path,
@@ -201,7 +356,8 @@ class WebAssemblyCompiler:
         if pure_functions_only:
             ir_core = self.extract_pure_functions(full_ir)
         else:
-            ir_core = full_ir
+            # compile_to_wasm sets the triple; drop the host one
+            ir_core = re.sub(r"^target (triple|datalayout) = .*$", "", full_ir, flags=re.MULTILINE)
 
         # Build WebAssembly IR with proper target triple
         wasm_ir = f"""target triple = "{self.target_triple}"
@@ -222,7 +378,9 @@ class WebAssemblyCompiler:
         info = {
             "llvmlite_available": str(LLVMLITE_AVAILABLE),
             "status": "experimental",
-            "phase": "1 (pure functions)",
+            "phase": "1 (pure functions, or linked with runtime)",
+            "features": DEFAULT_WASM_FEATURES,
+            "runtime_toolchain": str(bool(shutil.which("clang") and shutil.which("wasm-ld"))),
         }
 
         if LLVMLITE_AVAILABLE:
@@ -252,6 +410,7 @@ def compile_to_webassembly(
     target: str = "wasm32-unknown-unknown",
     opt_level: int = 2,
     pure_only: bool = True,
+    features: str = DEFAULT_WASM_FEATURES,
 ) -> tuple[bool, Optional[str]]:
     """High-level function to compile MGen IR to WebAssembly.
 
@@ -260,26 +419,31 @@ def compile_to_webassembly(
         output_dir: Output directory for WebAssembly files
         target: WebAssembly target triple
         opt_level: Optimization level (0-3)
-        pure_only: Extract pure functions only (no runtime dependencies)
+        pure_only: Extract pure functions only (no runtime dependencies);
+            otherwise link the whole program with the wasm runtime
+        features: WebAssembly features (default: simd128)
 
     Returns:
         Tuple of (success, error_message)
     """
     try:
-        compiler = WebAssemblyCompiler(target_triple=target)
+        compiler = WebAssemblyCompiler(target_triple=target, features=features)
 
         # Generate both binary and text formats
         wasm_path = output_dir / f"{ir_path.stem}.wasm"
         wat_path = output_dir / f"{ir_path.stem}.wat"
 
         # Compile to binary format
-        compiler.compile_mgen_ir(
-            ir_path=ir_path,
-            output_path=wasm_path,
-            opt_level=opt_level,
-            pure_functions_only=pure_only,
-            text_format=False,
-        )
+        if pure_only:
+            compiler.compile_mgen_ir(
+                ir_path=ir_path,
+                output_path=wasm_path,
+                opt_level=opt_level,
+                pure_functions_only=True,
+                text_format=False,
+            )
+        else:
+            compiler.build_with_runtime(ir_path, wasm_path, opt_level)
 
         # Compile to text format
         compiler.compile_mgen_ir(
@@ -60,7 +60,7 @@ class CPreferences(BackendPreferences):
             {
                 # Container implementation preferences
                 "container_mode": "runtime",  # "runtime" or "generated" - how to implement containers
-                "use_stc_containers": True,  # Use Smart Template Containers (only for runtime mode)
+                "use_stc_containers": True,  # STC hmap/hset/vec; False selects the hand-written containers
                 # Code generation preferences
                 "inline_functions": False,  # Add inline keywords
                 "use_restrict_keywords": False,  # Use restrict pointers
@@ -69,6 +69,26 @@ class CPreferences(BackendPreferences):
                 "explicit_memory_management": True,  # Manual malloc/free
                 "bounds_checking": True,  # Array bounds checking
                 "null_pointer_checks": True,  # NULL pointer validation
+                "scope_temporaries": False,  # Free function-local temporary strings in one shot on return
+                "string_builder_loops": True,  # Build strings extended in loops in one growable buffer
+                "atomic_refcounts": False,  # Thread-safe retain/release for reference counted objects
+                "flat_matrices": True,  # Store rectangular list[list[int]] matrices in one row-major buffer
+                "parallel_loops": False,  # OpenMP parallel-for on loops proven free of loop-carried dependencies
+                "parallel": False,  # Parallel loops and pure comprehensions run on the mgen_parallel thread pool
+                "parallel_threshold": 100000,  # Iterations below which the pool stays serial
+                "container_lifetimes": True,  # Drop local containers after their last use, reusing dead buffers
+                "intern_strings": True,  # Key string maps by interned symbols, interning literal keys at startup
+                "buffered_stdout": True,  # print() fills one 64 KiB stdout buffer flushed when full and at exit
+                "slice_views": True,  # Pass read-only list slices as views of their source instead of copies
+                "bitset_sets": 65536,  # set[int] locals provably within [0, N) become bitsets (0 disables)
+                "string_dispatch": True,  # String if/elif chains and read-only str dicts become decision trees
+                "soa_lists": False,  # Lists of plain scalar-field classes store one array per field
+                "instrument": False,  # Count and time every function and loop, reported at exit (mgen_instrument.h)
+                "memoize_pure": False,  # Cache self-recursive pure int functions in memo tables (@cache forces)
+                "int_overflow": "wrap",  # "wrap" (C int) or "check": OverflowError where int + - * may overflow
+                "target_mode": "executable",  # "executable", or "extension": a CPython module (mgen_pyext.h)
+                "aligned_vectors": False,  # 64-byte-aligned numeric vec buffers and aligned restrict loop pointers
+                "fast_math": "",  # Float relaxations: comma-separated reassoc, contract, nnan, ninf, or fast
                 # Style preferences
                 "brace_style": "k&r",  # K&R, allman, gnu, etc.
                 "indent_size": 4,  # Indentation size
@@ -91,6 +111,8 @@ class CppPreferences(BackendPreferences):
                 "enable_concepts": False,  # C++20 concepts (if supported)
                 # STL and library preferences
                 "use_stl_containers": True,  # Use std::vector, std::map, etc.
+                "flat_hash_containers": False,  # Back dicts/sets with open-addressing mgen::FlatMap/FlatSet
+                "pmr_containers": False,  # std::pmr lists/dicts/sets: global pool plus per-call arenas (MGEN_PMR)
                 "prefer_algorithms": False,  # Use <algorithm> functions
                 "use_smart_pointers": False,  # std::unique_ptr, std::shared_ptr
                 "enable_move_semantics": False,  # Move constructors/assignment
@@ -99,6 +121,17 @@ class CppPreferences(BackendPreferences):
                 "use_range_based_loops": False,  # for (auto& x : container)
                 "inline_functions": False,  # Add inline keywords
                 "use_constexpr": False,  # constexpr functions
+                "buffered_stdout": True,  # print() as mgen::print into one 64 KiB stdout buffer instead of cout << endl
+                "string_dispatch": True,  # String if/elif chains and read-only str dicts become decision trees
+                "soa_lists": False,  # Lists of plain scalar-field classes store one vector per field
+                "devirtualize": True,  # Classes nothing derives from are final; their getter calls read the field
+                "instrument": False,  # Count and time every function and loop, reported at exit (MGEN_INSTRUMENT)
+                "target_mode": "executable",  # "executable", or "extension": a CPython module of the functions
+                "fast_math": "",  # Float relaxations: comma-separated reassoc, contract, nnan, ninf, or fast
+                # Parallelism preferences
+                "parallel": False,  # Large reductions/pure comprehensions run on a thread pool (MGEN_PARALLEL)
+                "parallel_threshold": 100000,  # Elements below which parallel helpers stay serial
+                "parallel_loops": False,  # OpenMP parallel-for on loops proven free of loop-carried dependencies
                 # Memory management preferences
                 "raii_style": True,  # Resource Acquisition Is Initialization
                 "exception_safety": True,  # Exception-safe code generation
@@ -138,6 +171,7 @@ class RustPreferences(BackendPreferences):
                 "use_iterators": True,  # Iterator chains over loops
                 "collect_strategy": "smart",  # smart, explicit, minimal
                 "use_hashmap": True,  # HashMap over BTreeMap
+                "hash_function": "siphash",  # siphash (std, DoS-resistant) or fxhash (runtime FxHashMap, faster)
                 # Code style preferences
                 "snake_case_conversion": True,  # Keep Python snake_case
                 "use_derives": True,  # #[derive(...)] attributes
@@ -246,6 +280,7 @@ class LLVMPreferences(BackendPreferences):
                 "lto": False,  # Link-time optimization
                 "vectorization": True,  # Auto-vectorization
                 "loop_unrolling": True,  # Loop unrolling optimization
+                "fast_math": "",  # Fast-math flags on float operations: comma-separated reassoc, contract, nnan, ninf
                 # Code generation preferences
                 "ssa_form": True,  # Generate SSA form (always true for LLVM)
                 "named_values": True,  # Use descriptive names for values
@@ -0,0 +1,279 @@
+"""CPython extension module output for the C and C++ backends.
+
+With the "extension" target mode the converters append a CPython module to
+the generated code instead of producing only a program: each module-level
+function with a supported signature gets a METH_FASTCALL wrapper that
+converts its arguments, releases the GIL for the call and converts the result
+back, so hot functions can be imported into an existing Python process and
+called without ctypes marshalling.
+
+Supported parameters are int, float, bool, str, list[int] and list[float];
+results are those (str only in C++, whose result owns its storage), their
+lists and None. List parameters accept any sequence and, fast, any contiguous
+one-dimensional buffer-protocol object of the matching C element type
+(array('i') or numpy int32 for list[int], array('d') or numpy float64 for
+list[float]). The C backend passes such buffers to functions that only read
+the list without copying them; C++ copies them once into its vector.
+
+The generated file is built as a shared library with MGEN_EXTENSION_NAME
+defined to the module name it is imported as (the builders use the input's
+stem).
+"""
+
+import ast
+import sys
+import sysconfig
+from dataclasses import dataclass
+from typing import Optional
+
+# Python kinds the wrappers convert, for parameters and results
+EXTENSION_PARAMETER_KINDS = frozenset({"int", "float", "bool", "str", "list[int]", "list[float]"})
+EXTENSION_RESULT_KINDS = frozenset({"int", "float", "bool", "None", "str", "list[int]", "list[float]"})
+
+# The program's entry point stays a program's: it is not exported
+EXTENSION_EXCLUDED_FUNCTIONS = frozenset({"main"})
+
+
+@dataclass
+class ExtensionFunction:
+    """A converted function exported to Python, with the kinds and target types of its signature."""
+
+    name: str
+    parameters: list[tuple[str, str, str]]  # (name, Python kind, target type)
+    result: tuple[str, str]  # (Python kind, target type)
+    signature: str  # Python signature, the wrapper's docstring
+
+
+def extension_filename(name: str) -> str:
+    """File name the import system finds module name under, e.g. name.cpython-311-x86_64-linux-gnu.so."""
+    return name + (sysconfig.get_config_var("EXT_SUFFIX") or ".so")
+
+
+def extension_build_flags(name: str) -> list[str]:
+    """Compiler flags building generated code as the extension module name, against this interpreter."""
+    flags = ["-shared", "-fPIC", f"-I{sysconfig.get_paths()['include']}", f"-DMGEN_EXTENSION_NAME={name}"]
+    if sys.platform == "darwin":
+        # The interpreter that imports the module provides the Python symbols
+        flags.extend(["-undefined", "dynamic_lookup"])
+    return flags
+
+
+def plan_extension(
+    module: ast.Module,
+    target_types: dict[str, tuple[list[str], str]],
+    result_kinds: frozenset[str] = EXTENSION_RESULT_KINDS,
+    borrowed_params: Optional[dict[str, set[int]]] = None,
+) -> tuple[list[ExtensionFunction], list[str]]:
+    """Choose the module-level functions to export and pair their Python kinds with their target types.
+
+    Args:
+        module: Converted module
+        target_types: Function name -> (parameter types, result type) as the converter emitted them
+        result_kinds: Result kinds the backend can hand back to Python
+        borrowed_params: Function name -> positions of parameters the callee only reads; when given,
+            list parameters must be among them (the wrapper lends the caller's buffer)
+
+    Returns:
+        (exported functions, reasons for the ones left out)
+    """
+    functions = []
+    skipped = []
+    for node in module.body:
+        if not isinstance(node, ast.FunctionDef) or node.name in EXTENSION_EXCLUDED_FUNCTIONS:
+            continue
+        if node.name not in target_types:
+            skipped.append(f"{node.name} (generator)")
+            continue
+        param_types, result_type = target_types[node.name]
+        kinds = [ast.unparse(arg.annotation) if arg.annotation else "int" for arg in node.args.args]
+        result = ast.unparse(node.returns) if node.returns else "None"
+        unsupported = [kind for kind in kinds if kind not in EXTENSION_PARAMETER_KINDS]
+        if node.args.vararg or node.args.kwarg or node.args.kwonlyargs:
+            skipped.append(f"{node.name} (variadic or keyword-only parameters)")
+        elif unsupported:
+            skipped.append(f"{node.name} (parameter type {unsupported[0]})")
+        elif result not in result_kinds:
+            skipped.append(f"{node.name} (result type {result})")
+        elif borrowed_params is not None and any(
+            kind.startswith("list[") and position not in borrowed_params.get(node.name, set())
+            for position, kind in enumerate(kinds)
+        ):
+            skipped.append(f"{node.name} (modifies or keeps a list parameter, which would alias the caller's buffer)")
+        else:
+            names = [arg.arg for arg in node.args.args]
+            params = ", ".join(f"{name}: {kind}" for name, kind in zip(names, kinds))
+            functions.append(
+                ExtensionFunction(
+                    node.name,
+                    list(zip(names, kinds, param_types)),
+                    (result, result_type),
+                    f"{node.name}({params}) -> {result}",
+                )
+            )
+    return functions, skipped
+
+
+# C element type and helper suffix of each list kind (see mgen_pyext.h)
+C_LIST_ELEMENTS = {"list[int]": ("int", "int"), "list[float]": ("double", "double")}
+
+C_SCALAR_CONVERTERS = {"int": "mgen_pyext_int", "float": "mgen_pyext_double", "bool": "mgen_pyext_bool"}
+C_RESULT_CONVERTERS = {"int": "PyLong_FromLong", "float": "PyFloat_FromDouble", "bool": "PyBool_FromLong"}
+
+
+def render_c_extension(functions: list[ExtensionFunction], skipped: list[str], init: list[str]) -> str:
+    """The CPython module for converted C functions: wrappers, method table and PyInit.
+
+    List arguments are held in mgen_pyext_array_t until the call returns;
+    each is viewed as the function's STC vec without copying.
+
+    Args:
+        functions: Exported functions
+        skipped: Comments naming the functions left out and why
+        init: Statements PyInit runs first (what main would have set up)
+    """
+    lines = _extension_banner(skipped)
+    for function in functions:
+        wrapper = f"mgen_py_{function.name}"
+        lists = [(name, kind) for name, kind, _ in function.parameters if kind in C_LIST_ELEMENTS]
+        lines.append(f"static PyObject* {wrapper}(PyObject* module, PyObject* const* args, Py_ssize_t nargs) {{")
+        lines.append("    (void)module;")
+        lines.append(f'    if (!mgen_pyext_arity("{function.name}", nargs, {len(function.parameters)})) {{')
+        lines.extend(["        return NULL;", "    }"])
+        for name, kind, c_type in function.parameters:
+            if kind in C_LIST_ELEMENTS:
+                lines.append(f"    mgen_pyext_array_t mgen_arg_{name} = {{0}};")
+            else:
+                lines.append(f"    {c_type} mgen_arg_{name};")
+        lines.append("    PyObject* result = NULL;")
+        arguments = []
+        for position, (name, kind, _) in enumerate(function.parameters):
+            if kind in C_LIST_ELEMENTS:
+                helper = f"mgen_pyext_{C_LIST_ELEMENTS[kind][1]}_array"
+                arguments.append(f"mgen_vec_{name}")
+            else:
+                helper = C_SCALAR_CONVERTERS.get(kind, "mgen_pyext_str")
+                arguments.append(f"mgen_arg_{name}")
+            lines.append(f"    if ({helper}(args[{position}], &mgen_arg_{name}) < 0) {{")
+            lines.extend(["        goto done;", "    }"])
+
+        # A block of its own, so the gotos above skip over its declarations
+        lines.append("    {")
+        for name, kind, c_type in function.parameters:
+            if kind in C_LIST_ELEMENTS:
+                element = C_LIST_ELEMENTS[kind][0]
+                view = f"mgen_arg_{name}"
+                lines.append(
+                    f"        {c_type} mgen_vec_{name} = "
+                    f"{{.data = ({element}*){view}.data, .size = {view}.size, .capacity = {view}.size}};"
+                )
+        kind, c_type = function.result
+        call = f"{function.name}({', '.join(arguments)})"
+        if kind != "None":
+            lines.append(f"        {c_type} value;")
+            call = f"value = {call}"
+        lines.extend(["        Py_BEGIN_ALLOW_THREADS", f"        {call};", "        Py_END_ALLOW_THREADS"])
+        if kind == "None":
+            lines.extend(["        Py_INCREF(Py_None);", "        result = Py_None;"])
+        elif kind in C_LIST_ELEMENTS:
+            suffix = C_LIST_ELEMENTS[kind][1]
+            lines.append(f"        result = mgen_pyext_{suffix}_list(value.data, {c_type}_size(&value));")
+            lines.append(f"        {c_type}_drop(&value);")
+        else:
+            lines.append(f"        result = {C_RESULT_CONVERTERS[kind]}(value);")
+        lines.extend(["    }", "done:"])
+        lines.extend(f"    mgen_pyext_release(&mgen_arg_{name});" for name, _ in lists)
+        lines.extend(["    return result;", "}", ""])
+    lines.extend(_module_definition(functions, init, "(PyCFunction)(void (*)(void)){}", "NULL"))
+    return "\n".join(lines)
+
+
+def render_cpp_extension(functions: list[ExtensionFunction], skipped: list[str], init: list[str]) -> str:
+    """The CPython module for converted C++ functions: wrappers, method table and PyInit.
+
+    Arguments are converted into locals of the function's own parameter types
+    (see mgen::py_arg in the runtime), which free themselves on every return;
+    exceptions the function throws are raised in Python (mgen::py_raise).
+
+    Args:
+        functions: Exported functions
+        skipped: Comments naming the functions left out and why
+        init: Statements PyInit runs first (what main would have set up)
+    """
+    lines = _extension_banner(skipped)
+    for function in functions:
+        wrapper = f"mgen_py_{function.name}"
+        lines.append(f"static PyObject* {wrapper}(PyObject* module, PyObject* const* args, Py_ssize_t nargs) {{")
+        lines.append("    (void)module;")
+        lines.append(f'    if (!mgen::py_arity("{function.name}", nargs, {len(function.parameters)})) {{')
+        lines.extend(["        return nullptr;", "    }"])
+        arguments = []
+        for position, (name, _, cpp_type) in enumerate(function.parameters):
+            lines.append(f"    {cpp_type} mgen_arg_{name};")
+            lines.append(f"    if (!mgen::py_arg(args[{position}], mgen_arg_{name})) {{")
+            lines.extend(["        return nullptr;", "    }"])
+            arguments.append(f"mgen_arg_{name}")
+        kind, cpp_type = function.result
+        call = f"{function.name}({', '.join(arguments)})"
+        if kind != "None":
+            lines.append(f"    {cpp_type} value{{}};")
+            call = f"value = {call}"
+        # An exception must not leave the block that holds the released thread state
+        lines.extend(["    std::exception_ptr error;", "    Py_BEGIN_ALLOW_THREADS", "    try {", f"        {call};"])
+        lines.extend(["    } catch (...) {", "        error = std::current_exception();", "    }"])
+        lines.extend(["    Py_END_ALLOW_THREADS", "    if (error) {", "        return mgen::py_raise(error);", "    }"])
+        if kind == "None":
+            lines.extend(["    Py_INCREF(Py_None);", "    return Py_None;"])
+        else:
+            lines.append("    return mgen::py_result(value);")
+        lines.extend(["}", ""])
+    lines.extend(_module_definition(
+        functions, init, "reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>({}))", "nullptr"
+    ))
+    return "\n".join(lines)
+
+
+def _extension_banner(skipped: list[str]) -> list[str]:
+    """The section header of the module code, listing what was not exported."""
+    lines = [
+        "// " + "=" * 76,
+        "// CPython extension module (build with MGEN_EXTENSION_NAME set to its import name)",
+        "// " + "=" * 76,
+        "",
+    ]
+    if skipped:
+        lines.extend(f"// Not exported: {reason}" for reason in skipped)
+        lines.append("")
+    return lines
+
+
+def _module_definition(functions: list[ExtensionFunction], init: list[str], cast: str, null: str) -> list[str]:
+    """The method table, module definition and PyInit function (shared by C and C++).
+
+    cast formats a wrapper as a PyCFunction, through void (*)(void) so that
+    compilers accept the METH_FASTCALL signature without warnings.
+    """
+    lines = ["static PyMethodDef mgen_py_methods[] = {"]
+    for function in functions:
+        pointer = cast.format(f"mgen_py_{function.name}")
+        lines.append(f'    {{"{function.name}", {pointer}, METH_FASTCALL, "{function.signature}"}},')
+    lines.extend([f"    {{{null}, {null}, 0, {null}}},", "};", ""])
+    lines.extend(
+        [
+            "static struct PyModuleDef mgen_py_module = {",
+            "    PyModuleDef_HEAD_INIT,",
+            "    MGEN_PYEXT_STR(MGEN_EXTENSION_NAME),",
+            f"    {null},",
+            "    -1,",
+            "    mgen_py_methods,",
+            f"    {null},",
+            f"    {null},",
+            f"    {null},",
+            f"    {null},",
+            "};",
+            "",
+            "PyMODINIT_FUNC MGEN_PYEXT_INIT(MGEN_EXTENSION_NAME)(void) {",
+        ]
+    )
+    lines.extend(f"    {statement}" for statement in init)
+    lines.extend(["    return PyModule_Create(&mgen_py_module);", "}"])
+    return lines
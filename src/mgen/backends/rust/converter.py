@@ -1,8 +1,10 @@
 """Enhanced Rust code emitter for MGen with comprehensive Python language support."""
 
 import ast
+import re
 from typing import Any, Optional
 
+from ...frontend.dict_updates import DictUpdate, match_dict_update
 from ...frontend.immutability_analyzer import ImmutabilityAnalyzer, MutabilityClass
 from ..converter_utils import (
     get_augmented_assignment_operator,
@@ -10,14 +12,60 @@ from ..converter_utils import (
     get_standard_comparison_operator,
 )
 from ..errors import TypeMappingError, UnsupportedFeatureError
+from ..preferences import BackendPreferences, RustPreferences
 from ..type_inference_strategies import InferenceContext
 
+# Hash functions for generated HashMap and HashSet types ("hash_function" preference)
+HASH_FUNCTIONS = ("siphash", "fxhash")
+
+# String methods whose result a surrounding string method only reads, with their borrowing variant
+BORROWED_STR_OPS = {"upper": "upper_cow", "lower": "lower_cow", "strip": "strip_str", "replace": "replace_cow"}
+
+# What a split() word may be passed to when it stays a &str into the split string
+STR_READERS = {"upper", "lower", "strip", "find", "replace", "split"}
+
+
+def _is_split_call(node: Optional[ast.AST]) -> bool:
+    """Whether node is text.split() or text.split("<literal>")."""
+    return (
+        isinstance(node, ast.Call)
+        and isinstance(node.func, ast.Attribute)
+        and node.func.attr == "split"
+        and not node.keywords
+        and (
+            not node.args
+            or len(node.args) == 1 and isinstance(node.args[0], ast.Constant) and isinstance(node.args[0].value, str)
+        )
+    )
+
+
+def _is_str_op(node: ast.AST) -> bool:
+    """Whether node calls a string method that has a borrowing variant (see BORROWED_STR_OPS)."""
+    return (
+        isinstance(node, ast.Call)
+        and isinstance(node.func, ast.Attribute)
+        and node.func.attr in BORROWED_STR_OPS
+        and not node.keywords
+        and not (node.func.attr == "strip" and node.args)
+    )
+
 
 class MGenPythonToRustConverter:
     """Sophisticated Python-to-Rust converter with comprehensive language support."""
 
-    def __init__(self) -> None:
-        """Initialize the converter."""
+    def __init__(self, preferences: Optional[BackendPreferences] = None) -> None:
+        """Initialize the converter.
+
+        Args:
+            preferences: Backend preferences for controlling code generation
+        """
+        if preferences is None:
+            preferences = RustPreferences()
+        self.preferences = preferences
+        self.hash_function = preferences.get("hash_function", "siphash")
+        if self.hash_function not in HASH_FUNCTIONS:
+            choices = ", ".join(HASH_FUNCTIONS)
+            raise ValueError(f"Unknown hash_function {self.hash_function!r}; expected one of {choices}")
         self.type_map = {
             "int": "i32",
             "float": "f64",
@@ -38,6 +86,9 @@ class MGenPythonToRustConverter:
         self.function_mut_params: dict[str, set[str]] = {}  # Track mutable parameters for each function
         self.immutability_analyzer = ImmutabilityAnalyzer()  # Backend-agnostic immutability analysis
         self.mutability_info: dict[str, dict[str, MutabilityClass]] = {}  # Immutability analysis results
+        self.borrowed_params: dict[str, dict[str, str]] = {}  # function -> parameter -> &[T] or &str type
+        self.split_iterators: set[str] = set()  # split() results iterated once as &str words (no Vec<String>)
+        self.split_loops: set[int] = set()  # ids of the for loops over those words
         self._type_inference_engine: Optional[Any] = None  # Lazy-initialized type inference engine
 
     @property
@@ -78,6 +129,7 @@ class MGenPythonToRustConverter:
 
             # Run immutability analysis on the module (backend-agnostic)
             self.mutability_info = self.immutability_analyzer.analyze_module(tree)
+            self.borrowed_params = self._analyze_borrowed_params(tree)
 
             return self._convert_module(tree)
         except UnsupportedFeatureError:
@@ -86,6 +138,118 @@ class MGenPythonToRustConverter:
         except Exception as e:
             raise TypeMappingError(f"Failed to convert Python code: {e}") from e
 
+    def _analyze_borrowed_params(self, tree: ast.Module) -> dict[str, dict[str, str]]:
+        """Find the Vec and String parameters passed as slices (&[T]) and &str.
+
+        These are the borrowable parameters of the immutability analysis: only read
+        in place and never returned or stored, so a borrow of the caller's value
+        (or of a literal) serves every use without cloning it.
+        """
+        borrowable = self.immutability_analyzer.borrowable_parameters(tree)
+        result: dict[str, dict[str, str]] = {}
+        for func in tree.body:
+            if not isinstance(func, ast.FunctionDef):
+                continue
+            borrowed = {}
+            for arg in func.args.args:
+                if arg.arg not in borrowable.get(func.name, set()) or not arg.annotation:
+                    continue
+                param_type = self._infer_parameter_type(arg, func)
+                if param_type.startswith("Vec<") and "Box<dyn" not in param_type:
+                    borrowed[arg.arg] = f"&[{param_type[4:-1]}]"
+                elif param_type == "String":
+                    borrowed[arg.arg] = "&str"
+            result[func.name] = borrowed
+        return result
+
+    def _find_split_iterations(self, func: ast.FunctionDef) -> tuple[set[str], set[int]]:
+        """Find the for loops over str.split() words that can borrow them from the split string.
+
+        A loop qualifies when it iterates split() directly, or a variable
+        assigned split() just for it (used nowhere else, with the split string
+        unchanged in between), and its variable is only read in place: the
+        receiver of a string method, or an argument of len() or print().
+        Such loops walk a split iterator of &str instead of a Vec<String>.
+
+        Returns:
+            The names of the split() variables and the ids of the loops
+        """
+        parents: dict[int, ast.AST] = {}
+        uses: dict[str, int] = {}
+        for node in ast.walk(func):
+            for child in ast.iter_child_nodes(node):
+                parents[id(child)] = node
+            if isinstance(node, ast.Name):
+                uses[node.id] = uses.get(node.id, 0) + 1
+
+        def borrows_only(loop: ast.For) -> bool:
+            if not isinstance(loop.target, ast.Name):
+                return False
+            word = loop.target.id
+            for statement in loop.body:
+                for node in ast.walk(statement):
+                    if not (isinstance(node, ast.Name) and node.id == word):
+                        continue
+                    if not isinstance(node.ctx, ast.Load):
+                        return False
+                    parent = parents.get(id(node))
+                    if isinstance(parent, ast.Attribute) and parent.attr in STR_READERS:
+                        if not isinstance(parents.get(id(parent)), ast.Call):
+                            return False
+                    elif not (
+                        isinstance(parent, ast.Call)
+                        and isinstance(parent.func, ast.Name)
+                        and parent.func.id in ("len", "print")
+                        and node in parent.args
+                    ):
+                        return False
+            return True
+
+        iterators: set[str] = set()
+        loops: set[int] = set()
+        for block_owner in ast.walk(func):
+            for field_name in ("body", "orelse", "finalbody"):
+                block = getattr(block_owner, field_name, None)
+                if not isinstance(block, list):
+                    continue
+                for index, loop in enumerate(block):
+                    if not isinstance(loop, ast.For) or not borrows_only(loop):
+                        continue
+                    if _is_split_call(loop.iter):
+                        loops.add(id(loop))
+                        continue
+                    if not isinstance(loop.iter, ast.Name) or uses.get(loop.iter.id) != 2:
+                        continue
+                    # The assignment and the loop are the only two uses of the name
+                    words = loop.iter.id
+                    for previous in reversed(block[:index]):
+                        target = previous.target if isinstance(previous, ast.AnnAssign) else None
+                        if isinstance(previous, ast.Assign) and len(previous.targets) == 1:
+                            target = previous.targets[0]
+                        if not (isinstance(target, ast.Name) and target.id == words):
+                            continue
+                        split = previous.value
+                        source = split.func.value if _is_split_call(split) else None
+                        between = block[block.index(previous) + 1 : index]
+                        if isinstance(source, ast.Name) and not any(
+                            isinstance(node, ast.Name) and node.id == source.id and not isinstance(node.ctx, ast.Load)
+                            for statement in between
+                            for node in ast.walk(statement)
+                        ):
+                            iterators.add(words)
+                            loops.add(id(loop))
+                        break
+        return iterators, loops
+
+    def _split_iterator(self, split: ast.Call) -> str:
+        """A split iterator of &str words for text.split() or text.split(literal)."""
+        text = self._convert_expression(split.func.value)
+        if split.args:
+            # The separator literal itself is a &'static str, which outlives the loop
+            separator = self._convert_expression(split.args[0]).removesuffix(".to_string()")
+            return f"StrOps::split_sep_iter(&{text}, {separator})"
+        return f"StrOps::split_iter(&{text})"
+
     def _convert_module(self, node: ast.Module) -> str:
         """Convert a Python module to Rust."""
         parts = []
@@ -144,7 +308,21 @@ class MGenPythonToRustConverter:
             parts.append("")
             parts.append(main_func)
 
-        return "\n".join(parts)
+        code = "\n".join(parts)
+        if self.hash_function == "fxhash":
+            code = self._use_fx_hash(code)
+        return code
+
+    def _use_fx_hash(self, code: str) -> str:
+        """Switch the generated maps and sets to the runtime's FxHashMap and FxHashSet.
+
+        They are std HashMap and HashSet with the FxHash hasher, which has no
+        new(): empty ones are made with default().
+        """
+        code = re.sub(r"(?<![\w:])(?:std::collections::)?HashMap::new\(\)", "FxHashMap::default()", code)
+        code = re.sub(r"(?<![\w:])(?:std::collections::)?HashSet::new\(\)", "FxHashSet::default()", code)
+        code = re.sub(r"(?<![\w:])(?:std::collections::)?HashMap<", "FxHashMap<", code)
+        return re.sub(r"(?<![\w:])(?:std::collections::)?HashSet<", "FxHashSet<", code)
 
     def _collect_required_imports(self, node: ast.Module) -> list[str]:
         """Collect required imports based on code features."""
@@ -621,10 +799,16 @@ class MGenPythonToRustConverter:
         self.function_mut_params[node.name] = mut_params
 
         # Build parameter list
+        borrowed = self.borrowed_params.get(node.name, {})
         params = []
         for arg in node.args.args:
             param_type = self._infer_parameter_type(arg, node)
 
+            if arg.arg in borrowed:
+                # Borrowed slice or string: callers pass a reference to their value
+                params.append(f"{arg.arg}: {borrowed[arg.arg]}")
+                continue
+
             # Rust-specific reference type selection based on mutability
             # Apply to collections only (Vec, HashMap, HashSet)
             if (
@@ -691,6 +875,7 @@ class MGenPythonToRustConverter:
         # Convert function body
         self.current_function = node.name
         self.current_function_node = node  # Store AST node for analysis
+        self.split_iterators, self.split_loops = self._find_split_iterations(node)
         self.declared_vars = set()  # Reset for new function
         self.variable_types = {}  # Reset variable type tracking for new function
         # Add parameters to declared variables and their types
@@ -699,6 +884,7 @@ class MGenPythonToRustConverter:
             param_type = self._infer_parameter_type(arg, node)
 
             # Store the parameter type with appropriate reference qualifier
+            # (a borrowed &[T] is tracked as &Vec<T> and a &str as String: both read alike)
             if (
                 param_type.startswith("Vec<")
                 or param_type.startswith("std::collections::HashMap<")
@@ -727,6 +913,9 @@ class MGenPythonToRustConverter:
 
     def _convert_statement(self, stmt: ast.stmt) -> str:
         """Convert a Python statement to Rust."""
+        update = match_dict_update(stmt)
+        if update is not None and self._numeric_map_value_type(update.container):
+            return self._convert_dict_update(update, stmt)
         if isinstance(stmt, ast.Return):
             return self._convert_return(stmt)
         elif isinstance(stmt, ast.Assign):
@@ -794,8 +983,17 @@ class MGenPythonToRustConverter:
             return f"    return {value_expr};"
         return "    return ();"
 
+    def _convert_split_iterator_assignment(self, name: str, split: ast.expr) -> str:
+        """Bind a split() result only its loop reads to the split iterator itself."""
+        assert isinstance(split, ast.Call)
+        self.declared_vars.add(name)
+        return f"    let {name} = {self._split_iterator(split)};"
+
     def _convert_assignment(self, stmt: ast.Assign) -> str:
         """Convert assignment statement."""
+        if len(stmt.targets) == 1 and isinstance(stmt.targets[0], ast.Name):
+            if stmt.targets[0].id in self.split_iterators:
+                return self._convert_split_iterator_assignment(stmt.targets[0].id, stmt.value)
         value_expr = self._convert_expression(stmt.value)
         statements = []
 
@@ -872,6 +1070,8 @@ class MGenPythonToRustConverter:
 
     def _convert_annotated_assignment(self, stmt: ast.AnnAssign) -> str:
         """Convert annotated assignment (type annotation)."""
+        if isinstance(stmt.target, ast.Name) and stmt.target.id in self.split_iterators:
+            return self._convert_split_iterator_assignment(stmt.target.id, stmt.value)
         if stmt.value:
             value_expr = self._convert_expression(stmt.value)
             # Infer type from value if possible, otherwise use annotation
@@ -933,6 +1133,63 @@ class MGenPythonToRustConverter:
 
         raise UnsupportedFeatureError(f"Complex augmented assignment target not supported: {ast.unparse(stmt.target)}")
 
+    def _numeric_map_value_type(self, name: str) -> Optional[str]:
+        """The value type of a HashMap with i32 or f64 values, or None."""
+        map_type = self.variable_types.get(name, "")
+        if "HashMap<" not in map_type:
+            return None
+        for value_type in ("i32", "f64"):
+            if map_type.endswith(f", {value_type}>"):
+                return value_type
+        return None
+
+    def _convert_dict_update(self, update: DictUpdate, stmt: ast.stmt) -> str:
+        """Convert a counting update into one lookup through the entry API."""
+        key = self._convert_expression(update.key)
+        if isinstance(update.key, ast.Name) and self.variable_types.get(update.key.id) == "String":
+            # entry() takes the key by value: &str parameters are copied, dead locals moved
+            if update.key.id in self.borrowed_params.get(self.current_function or "", {}):
+                key = f"{key}.to_string()"
+            elif not self._is_dead_after(update.key.id, stmt):
+                key = f"{key}.clone()"
+        increment = self._convert_expression(update.increment)
+        default = update.default
+        if self._numeric_map_value_type(update.container) == "f64" and isinstance(default, ast.Constant):
+            default = ast.Constant(float(default.value))
+        return f"    *{update.container}.entry({key}).or_insert({self._convert_expression(default)}) += {increment};"
+
+    def _is_dead_after(self, name: str, stmt: ast.stmt) -> bool:
+        """Whether a local is assigned earlier in stmt's block and not read after stmt anywhere.
+
+        Every execution of the block then reassigns it before stmt, so stmt may move it.
+        """
+        if self.current_function_node is None:
+            return False
+        for node in ast.walk(self.current_function_node):
+            for block in (getattr(node, "body", None), getattr(node, "orelse", None)):
+                if not isinstance(block, list) or not any(candidate is stmt for candidate in block):
+                    continue
+                position = next(i for i, candidate in enumerate(block) if candidate is stmt)
+                assigned = [
+                    i
+                    for i, candidate in enumerate(block[:position])
+                    if (isinstance(candidate, ast.Assign) and any(self._is_name(t, name) for t in candidate.targets))
+                    or (isinstance(candidate, ast.AnnAssign) and self._is_name(candidate.target, name))
+                ]
+                if not assigned:
+                    return False
+                # Reads between the last assignment and stmt are fine; any other read is not
+                live = {id(child) for candidate in block[assigned[-1] : position + 1] for child in ast.walk(candidate)}
+                return not any(
+                    self._is_name(child, name) and isinstance(child.ctx, ast.Load) and id(child) not in live
+                    for child in ast.walk(self.current_function_node)
+                )
+        return False
+
+    @staticmethod
+    def _is_name(node: ast.AST, name: str) -> bool:
+        return isinstance(node, ast.Name) and node.id == name
+
     def _convert_if(self, stmt: ast.If) -> str:
         """Convert if statement."""
         condition = self._convert_expression(stmt.test)
@@ -986,9 +1243,24 @@ class MGenPythonToRustConverter:
         else:
             # General iteration
             target = stmt.target.id if isinstance(stmt.target, ast.Name) else "item"
+            if id(stmt) in self.split_loops:
+                # The words are &str slices of the split string
+                self.variable_types[target] = "&str"
+                if isinstance(stmt.iter, ast.Call):
+                    iter_expr = self._split_iterator(stmt.iter)
+                    body = self._convert_statements(stmt.body)
+                    return f"    for {target} in {iter_expr} {{\n{body}\n    }}"
             iter_expr = self._convert_expression(stmt.iter)
             body = self._convert_statements(stmt.body)
-            return f"    for {target} in {iter_expr} {{\n{body}\n    }}"
+            pattern = target
+            if isinstance(stmt.iter, ast.Name) and self.variable_types.get(stmt.iter.id) in (
+                "&Vec<i32>",
+                "&Vec<f64>",
+                "&Vec<bool>",
+            ):
+                # A borrowed list yields references: copy the elements out
+                pattern = f"&{target}"
+            return f"    for {pattern} in {iter_expr} {{\n{body}\n    }}"
 
     def _convert_expression_statement(self, stmt: ast.Expr) -> str:
         """Convert expression statement."""
@@ -1283,7 +1555,7 @@ class MGenPythonToRustConverter:
                         return f"(Builtins::len_hashmap(&{args[0]}) as i32)"
                     elif arg_type.startswith("std::collections::HashSet<"):
                         return f"(Builtins::len_hashset(&{args[0]}) as i32)"
-                    elif arg_type == "String":
+                    elif arg_type in ("String", "&str"):
                         return f"(Builtins::len_string(&{args[0]}) as i32)"
                     elif arg_type == "i32":
                         # Unknown type inferred as i32 default - check if it's likely a string parameter
@@ -1340,15 +1612,18 @@ class MGenPythonToRustConverter:
                     # Check if this function has parameters that expect references
                     if func_name in self.mutability_info:
                         func_mutability = self.mutability_info[func_name]
+                        param_names = list(func_mutability.keys())
+                        borrowed = self.borrowed_params.get(func_name, {})
                         modified_args = []
 
                         for i, arg in enumerate(args):
                             arg_expr = expr.args[i]
 
+                            if i < len(param_names) and param_names[i] in borrowed:
+                                modified_args.append(self._borrowed_argument(arg, arg_expr))
                             # Only modify arguments that are simple variables
-                            if isinstance(arg_expr, ast.Name):
+                            elif isinstance(arg_expr, ast.Name):
                                 var_type = self.variable_types.get(arg_expr.id, "")
-                                param_names = list(func_mutability.keys())
 
                                 # Check if this parameter position has mutability info
                                 if i < len(param_names):
@@ -1389,14 +1664,52 @@ class MGenPythonToRustConverter:
         else:
             return "/* Complex function call */"
 
-    def _convert_method_call_expression(self, expr: ast.Call) -> str:
-        """Convert method calls on objects."""
+    def _convert_borrowed_str(self, expr: ast.expr) -> str:
+        """Convert a string expression that is only read, borrowing string method results."""
+        if _is_str_op(expr):
+            assert isinstance(expr, ast.Call)
+            return self._convert_method_call_expression(expr, borrowed=True)
+        return self._convert_expression(expr)
+
+    def _borrowed_argument(self, arg: str, arg_expr: ast.expr) -> str:
+        """Pass an argument to a &[T] or &str parameter without cloning it."""
+        if isinstance(arg_expr, ast.Constant) and isinstance(arg_expr.value, str) and arg.endswith(".to_string()"):
+            # The string literal itself is a &str
+            return arg[: -len(".to_string()")]
+        if isinstance(arg_expr, ast.Name) and (
+            arg_expr.id in self.borrowed_params.get(self.current_function or "", {})
+            or self.variable_types.get(arg_expr.id, "").startswith("&")
+        ):
+            # Already a reference (a borrowed parameter of the current function)
+            return arg
+        return f"&{arg}"
+
+    def _convert_method_call_expression(self, expr: ast.Call, borrowed: bool = False) -> str:
+        """Convert method calls on objects.
+
+        With borrowed, the caller only reads the result of a string method, so
+        it may be a &str or Cow<str> instead of a new String.
+        """
         if isinstance(expr.func, ast.Attribute):
-            obj_expr = self._convert_expression(expr.func.value)
             method_name = expr.func.attr
+            receiver = expr.func.value
+            if method_name in STR_READERS and _is_str_op(receiver):
+                assert isinstance(receiver, ast.Call) and isinstance(receiver.func, ast.Attribute)
+                if method_name == "strip" and not expr.args and receiver.func.attr in ("lower", "upper"):
+                    # Case mapping neither makes nor removes whitespace: strip before the one allocation
+                    inner = self._convert_borrowed_str(receiver.func.value)
+                    ops = BORROWED_STR_OPS if borrowed else {}
+                    case_op = ops.get(receiver.func.attr, receiver.func.attr)
+                    return f"StrOps::{case_op}(StrOps::strip_str(&{inner}))"
+                obj_expr = self._convert_method_call_expression(receiver, borrowed=True)
+            else:
+                obj_expr = self._convert_expression(receiver)
             args = [self._convert_expression(arg) for arg in expr.args]
 
             # Handle string methods
+            if borrowed and method_name in BORROWED_STR_OPS and not (method_name == "strip" and args):
+                call_args = "".join(f", &{arg}" for arg in args)
+                return f"StrOps::{BORROWED_STR_OPS[method_name]}(&{obj_expr}{call_args})"
             if method_name in ["upper", "lower", "strip", "find", "replace", "split"]:
                 if method_name == "upper":
                     return f"StrOps::upper(&{obj_expr})"
@@ -2170,3 +2483,4 @@ class MGenPythonToRustConverter:
 
         # Default fallback
         return "Default::default()"
+
@@ -14,7 +14,7 @@ class RustEmitter(AbstractEmitter):
     def __init__(self, preferences: Optional[BackendPreferences] = None) -> None:
         """Initialize Rust emitter."""
         super().__init__(preferences)
-        self.converter = MGenPythonToRustConverter()
+        self.converter = MGenPythonToRustConverter(self.preferences)
 
     def map_python_type(self, python_type: str) -> str:
         """Map Python type to Rust type."""
@@ -1,20 +1,29 @@
 // MGen Rust Runtime Library
 // Provides Python-like operations using only Rust standard library
 
+use std::borrow::Cow;
 use std::collections::{HashMap, HashSet};
 use std::fmt::Display;
-use std::hash::Hash;
+use std::hash::{BuildHasher, BuildHasherDefault, Hash, Hasher};
 
 // String operations using Rust standard library
 pub struct StrOps;
 
 impl StrOps {
     pub fn upper(s: &str) -> String {
-        s.to_uppercase()
+        if s.is_ascii() {
+            s.to_ascii_uppercase()
+        } else {
+            s.to_uppercase()
+        }
     }
 
     pub fn lower(s: &str) -> String {
-        s.to_lowercase()
+        if s.is_ascii() {
+            s.to_ascii_lowercase()
+        } else {
+            s.to_lowercase()
+        }
     }
 
     pub fn strip(s: &str) -> String {
@@ -44,8 +53,127 @@ impl StrOps {
     pub fn split_sep(s: &str, sep: &str) -> Vec<String> {
         s.split(sep).map(|s| s.to_string()).collect()
     }
+
+    // Borrowing variants, for results that are only read: the converter uses them for the receiver
+    // of another string method and for split() words that never leave their loop
+
+    pub fn upper_cow(s: &str) -> Cow<'_, str> {
+        if s.is_ascii() {
+            if s.bytes().any(|b| b.is_ascii_lowercase()) {
+                return Cow::Owned(s.to_ascii_uppercase());
+            }
+            return Cow::Borrowed(s);
+        }
+        if s.chars().all(|c| Self::maps_to_itself(c.to_uppercase(), c)) {
+            Cow::Borrowed(s)
+        } else {
+            Cow::Owned(s.to_uppercase())
+        }
+    }
+
+    pub fn lower_cow(s: &str) -> Cow<'_, str> {
+        if s.is_ascii() {
+            if s.bytes().any(|b| b.is_ascii_uppercase()) {
+                return Cow::Owned(s.to_ascii_lowercase());
+            }
+            return Cow::Borrowed(s);
+        }
+        if s.chars().all(|c| Self::maps_to_itself(c.to_lowercase(), c)) {
+            Cow::Borrowed(s)
+        } else {
+            Cow::Owned(s.to_lowercase())
+        }
+    }
+
+    fn maps_to_itself(mut mapped: impl Iterator<Item = char>, c: char) -> bool {
+        mapped.next() == Some(c) && mapped.next().is_none()
+    }
+
+    pub fn strip_str(s: &str) -> &str {
+        s.trim()
+    }
+
+    pub fn replace_cow<'a>(s: &'a str, old: &str, new: &str) -> Cow<'a, str> {
+        if s.contains(old) {
+            Cow::Owned(s.replace(old, new))
+        } else {
+            Cow::Borrowed(s)
+        }
+    }
+
+    pub fn split_iter(s: &str) -> std::str::SplitWhitespace<'_> {
+        s.split_whitespace()
+    }
+
+    pub fn split_sep_iter<'a>(s: &'a str, sep: &'a str) -> std::str::Split<'a, &'a str> {
+        s.split(sep)
+    }
+}
+
+// FxHash, the hash function of rustc: a multiply and rotate per word instead of SipHash's rounds.
+// Generated maps and sets use it with the "hash_function": "fxhash" preference; unlike SipHash it
+// is not randomly keyed, so inputs can be chosen to collide.
+#[derive(Default, Clone, Copy)]
+pub struct FxHasher {
+    hash: u64,
+}
+
+const FX_SEED: u64 = 0x51_7c_c1_b7_27_22_0a_95;
+
+impl FxHasher {
+    #[inline]
+    fn add_to_hash(&mut self, word: u64) {
+        self.hash = (self.hash.rotate_left(5) ^ word).wrapping_mul(FX_SEED);
+    }
+}
+
+impl Hasher for FxHasher {
+    #[inline]
+    fn write(&mut self, bytes: &[u8]) {
+        let mut chunks = bytes.chunks_exact(8);
+        for chunk in &mut chunks {
+            self.add_to_hash(u64::from_le_bytes(chunk.try_into().unwrap()));
+        }
+        let mut rest = chunks.remainder();
+        if rest.len() >= 4 {
+            self.add_to_hash(u32::from_le_bytes(rest[..4].try_into().unwrap()) as u64);
+            rest = &rest[4..];
+        }
+        for &byte in rest {
+            self.add_to_hash(byte as u64);
+        }
+    }
+
+    #[inline]
+    fn write_u8(&mut self, i: u8) {
+        self.add_to_hash(i as u64);
+    }
+
+    #[inline]
+    fn write_u32(&mut self, i: u32) {
+        self.add_to_hash(i as u64);
+    }
+
+    #[inline]
+    fn write_u64(&mut self, i: u64) {
+        self.add_to_hash(i);
+    }
+
+    #[inline]
+    fn write_usize(&mut self, i: usize) {
+        self.add_to_hash(i as u64);
+    }
+
+    #[inline]
+    fn finish(&self) -> u64 {
+        self.hash
+    }
 }
 
+pub type FxBuildHasher = BuildHasherDefault<FxHasher>;
+pub type FxHashMap<K, V> = HashMap<K, V, FxBuildHasher>;
+pub type FxHashSet<T> = HashSet<T, FxBuildHasher>;
+
 // Built-in operations using Rust standard library
 pub struct Builtins;
 
@@ -58,15 +186,15 @@ impl Builtins {
         s.chars().count()
     }
 
-    pub fn len_vec<T>(v: &Vec<T>) -> usize {
+    pub fn len_vec<T>(v: &[T]) -> usize {
         v.len()
     }
 
-    pub fn len_hashmap<K, V>(m: &HashMap<K, V>) -> usize {
+    pub fn len_hashmap<K, V, S>(m: &HashMap<K, V, S>) -> usize {
         m.len()
     }
 
-    pub fn len_hashset<T>(s: &HashSet<T>) -> usize {
+    pub fn len_hashset<T, S>(s: &HashSet<T, S>) -> usize {
         s.len()
     }
 
@@ -94,19 +222,19 @@ impl Builtins {
         a.max(b)
     }
 
-    pub fn sum_i32(vec: &Vec<i32>) -> i32 {
+    pub fn sum_i32(vec: &[i32]) -> i32 {
         vec.iter().sum()
     }
 
-    pub fn sum_f64(vec: &Vec<f64>) -> f64 {
+    pub fn sum_f64(vec: &[f64]) -> f64 {
         vec.iter().sum()
     }
 
-    pub fn any(vec: &Vec<bool>) -> bool {
+    pub fn any(vec: &[bool]) -> bool {
         vec.iter().any(|&x| x)
     }
 
-    pub fn all(vec: &Vec<bool>) -> bool {
+    pub fn all(vec: &[bool]) -> bool {
         vec.iter().all(|&x| x)
     }
 }
@@ -231,27 +359,29 @@ impl Comprehensions {
     }
 
     // Dict comprehensions
-    pub fn dict_comprehension<T, K, V, F>(
+    pub fn dict_comprehension<T, K, V, F, S>(
         iterable: Vec<T>,
         key_value_transform: F,
-    ) -> HashMap<K, V>
+    ) -> HashMap<K, V, S>
     where
         F: Fn(T) -> (K, V),
         K: Eq + Hash,
+        S: BuildHasher + Default,
     {
         iterable.into_iter().map(key_value_transform).collect()
     }
 
-    pub fn dict_comprehension_with_filter<T, K, V, F, P>(
+    pub fn dict_comprehension_with_filter<T, K, V, F, P, S>(
         iterable: Vec<T>,
         key_value_transform: F,
         predicate: P,
-    ) -> HashMap<K, V>
+    ) -> HashMap<K, V, S>
     where
         F: Fn(&T) -> (K, V),
         P: Fn(&T) -> bool,
         K: Eq + Hash,
         T: Clone,
+        S: BuildHasher + Default,
     {
         iterable.iter()
             .filter(|&item| predicate(item))
@@ -260,27 +390,29 @@ impl Comprehensions {
     }
 
     // Set comprehensions
-    pub fn set_comprehension<T, U, F>(
+    pub fn set_comprehension<T, U, F, S>(
         iterable: Vec<T>,
         transform: F,
-    ) -> HashSet<U>
+    ) -> HashSet<U, S>
     where
         F: Fn(T) -> U,
         U: Eq + Hash,
+        S: BuildHasher + Default,
     {
         iterable.into_iter().map(transform).collect()
     }
 
-    pub fn set_comprehension_with_filter<T, U, F, P>(
+    pub fn set_comprehension_with_filter<T, U, F, P, S>(
         iterable: Vec<T>,
         transform: F,
         predicate: P,
-    ) -> HashSet<U>
+    ) -> HashSet<U, S>
     where
         F: Fn(&T) -> U,
         P: Fn(&T) -> bool,
         U: Eq + Hash,
         T: Clone,
+        S: BuildHasher + Default,
     {
         iterable.iter()
             .filter(|&item| predicate(item))
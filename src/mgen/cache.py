@@ -0,0 +1,240 @@
+"""Content-addressed conversion cache for the MGen pipeline.
+
+Conversion is a pure function of a module's source, the sources of the local
+modules it imports, the pipeline options that affect code generation and the
+MGen code itself, so its result can be reused whenever none of them changed.
+A ConversionCache stores, per module:
+
+    - the generated source, warnings and file extension (entry.json)
+    - the phase results of the analysis and optimization phases
+      (phase_results.pickle), restored into PipelineResult on a hit
+
+Entries live under <cache_dir>/<key[:2]>/<key>/, so rebuilding a large
+project after a one-file edit only reconverts that file and the modules
+importing it. The build phase is not cached; it runs on the restored source.
+
+The key covers the MGen version and a fingerprint (path, size, mtime) of the
+installed package's files, so upgrading or editing MGen invalidates every
+entry. Entries are never evicted; `mgen clean` removes them with the build
+directory.
+
+Example:
+    >>> config = PipelineConfig(target_language="rust", cache_dir="build/.cache")
+    >>> MGenPipeline(config).convert("module.py").cached  # False, then True on the next run
+"""
+
+import ast
+import dataclasses
+import hashlib
+import json
+import os
+import pickle
+import tempfile
+from dataclasses import dataclass, field
+from functools import lru_cache
+from pathlib import Path
+from typing import Any, Optional, Union
+
+from . import __version__
+
+# Bumped when the entry layout changes
+CACHE_FORMAT_VERSION = 1
+
+
+@dataclass
+class CacheEntry:
+    """Cached output of converting one module."""
+
+    generated_code: str
+    file_extension: str
+    warnings: list[str] = field(default_factory=list)
+    phase_results: dict[Any, Any] = field(default_factory=dict)
+
+
+@lru_cache(maxsize=1)
+def code_fingerprint() -> str:
+    """Hash of the MGen package's file names, sizes and modification times.
+
+    Computed once per process; editing any source file or runtime library of
+    MGen changes it.
+    """
+    digest = hashlib.sha256(__version__.encode())
+    package_dir = Path(__file__).parent
+    for path in sorted(package_dir.rglob("*")):
+        if path.is_file() and "__pycache__" not in path.parts:
+            stat = path.stat()
+            digest.update(f"{path.relative_to(package_dir)}:{stat.st_size}:{stat.st_mtime_ns}\n".encode())
+    return digest.hexdigest()
+
+
+def user_cache_dir() -> Path:
+    """Per-user root for build artifacts shared across projects.
+
+    $MGEN_CACHE_DIR if set, else $XDG_CACHE_HOME/mgen, else ~/.cache/mgen.
+    """
+    if os.environ.get("MGEN_CACHE_DIR"):
+        return Path(os.environ["MGEN_CACHE_DIR"])
+    return Path(os.environ.get("XDG_CACHE_HOME") or Path.home() / ".cache") / "mgen"
+
+
+def local_dependencies(source_path: Path, source_code: str) -> list[Path]:
+    """Find the local modules a module imports, transitively.
+
+    A module is local if <name>.py (or <package>/<name>.py for dotted names)
+    exists next to the importing file. Unparseable modules contribute no
+    further dependencies.
+
+    Returns:
+        Dependency paths, sorted, excluding source_path itself
+    """
+    seen: set[Path] = set()
+    pending = [(source_path.resolve(), source_code)]
+    while pending:
+        path, code = pending.pop()
+        try:
+            tree = ast.parse(code)
+        except SyntaxError:
+            continue
+        for name in _imported_modules(tree):
+            candidate = (path.parent / (name.replace(".", "/") + ".py")).resolve()
+            if candidate in seen or candidate == source_path.resolve() or not candidate.is_file():
+                continue
+            seen.add(candidate)
+            pending.append((candidate, candidate.read_text()))
+    return sorted(seen)
+
+
+def _imported_modules(tree: ast.Module) -> list[str]:
+    """Module names named by the import statements of a module."""
+    names = []
+    for node in ast.walk(tree):
+        if isinstance(node, ast.Import):
+            names.extend(alias.name for alias in node.names)
+        elif isinstance(node, ast.ImportFrom) and node.level <= 1:
+            if node.module:
+                names.append(node.module)
+            else:
+                # from . import a, b
+                names.extend(alias.name for alias in node.names)
+    return names
+
+
+class ConversionCache:
+    """Stores and retrieves conversion results by content hash."""
+
+    def __init__(self, cache_dir: Union[str, Path]):
+        """Initialize the cache.
+
+        Args:
+            cache_dir: Directory holding the entries (created on first store)
+        """
+        self.cache_dir = Path(cache_dir)
+        self.hits = 0
+        self.misses = 0
+
+    def key(self, source_path: Path, source_code: str, options: dict[str, Any]) -> str:
+        """Compute the cache key of converting a module.
+
+        Args:
+            source_path: Path of the module (used to find local imports)
+            source_code: Source of the module
+            options: Pipeline options that affect code generation (JSON-serializable
+                after str() of unknown values)
+
+        Returns:
+            Hex digest identifying the conversion
+        """
+        digest = hashlib.sha256()
+        digest.update(f"mgen-cache-v{CACHE_FORMAT_VERSION}\n{code_fingerprint()}\n".encode())
+        digest.update(json.dumps(options, sort_keys=True, default=str).encode())
+        # The file name becomes part of the generated code (module and file names)
+        digest.update(f"\n{source_path.name}\n".encode())
+        digest.update(hashlib.sha256(source_code.encode()).digest())
+        for dependency in local_dependencies(source_path, source_code):
+            digest.update(f"\n{dependency.name}\n".encode())
+            digest.update(hashlib.sha256(dependency.read_bytes()).digest())
+        return digest.hexdigest()
+
+    def _entry_dir(self, key: str) -> Path:
+        return self.cache_dir / key[:2] / key
+
+    def load(self, key: str) -> Optional[CacheEntry]:
+        """Return the entry stored under key, or None (also for unreadable entries)."""
+        entry_dir = self._entry_dir(key)
+        try:
+            data = json.loads((entry_dir / "entry.json").read_text())
+        except (OSError, ValueError):
+            self.misses += 1
+            return None
+
+        phase_results: dict[Any, Any] = {}
+        try:
+            with open(entry_dir / "phase_results.pickle", "rb") as f:
+                phase_results = pickle.load(f)
+        except Exception:
+            # Phase results are informational; the generated code is what matters
+            pass
+
+        self.hits += 1
+        return CacheEntry(data["generated_code"], data["file_extension"], data.get("warnings", []), phase_results)
+
+    def store(self, key: str, entry: CacheEntry) -> None:
+        """Store an entry under key, replacing any previous one atomically.
+
+        Phase results that cannot be pickled are left out.
+        """
+        entry_dir = self._entry_dir(key)
+        entry_dir.mkdir(parents=True, exist_ok=True)
+        try:
+            phase_results: Optional[bytes] = pickle.dumps(entry.phase_results)
+        except Exception:
+            phase_results = None
+        if phase_results is not None:
+            _write_atomic(entry_dir / "phase_results.pickle", phase_results)
+        # entry.json last: its presence marks a complete entry
+        data = {
+            "generated_code": entry.generated_code,
+            "file_extension": entry.file_extension,
+            "warnings": entry.warnings,
+        }
+        _write_atomic(entry_dir / "entry.json", json.dumps(data).encode())
+
+
+def generation_options(config: Any) -> dict[str, Any]:
+    """The PipelineConfig fields that affect the generated source.
+
+    Build-only options (compiler, flags, PGO) are excluded: the build phase
+    runs on every conversion, cached or not. The target CPU and features are
+    included since the LLVM backend can specialize its IR for them.
+    """
+    preferences = config.backend_preferences
+    return {
+        "target_language": config.target_language,
+        "optimization_level": config.optimization_level.value,
+        "enable_advanced_analysis": config.enable_advanced_analysis,
+        "enable_optimizations": config.enable_optimizations,
+        "enable_formal_verification": config.enable_formal_verification,
+        "specialize_functions": config.specialize_functions,
+        "interchange_loops": config.interchange_loops,
+        "source_map": config.source_map,
+        "strict_verification": config.strict_verification,
+        "verification_timeout_ms": config.verification_timeout_ms,
+        "verification_budget": config.verification_budget,
+        "target_cpu": config.target_cpu,
+        "target_features": config.target_features,
+        "backend_preferences": (
+            [type(preferences).__name__, dataclasses.asdict(preferences)] if preferences is not None else None
+        ),
+    }
+
+
+def _write_atomic(path: Path, data: bytes) -> None:
+    """Write a file via a temporary file and rename, so readers never see partial contents."""
+    fd, temp_name = tempfile.mkstemp(dir=path.parent, prefix=f".{path.name}.")
+    try:
+        with os.fdopen(fd, "wb") as f:
+            f.write(data)
+        os.replace(temp_name, path)
+    except BaseException:
+        Path(temp_name).unlink(missing_ok=True)
+        raise
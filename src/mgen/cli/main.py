@@ -9,6 +9,9 @@ Usage:
     mgen convert input.py --target rust   # Convert to Rust (generates build/src/input.rs)
     mgen build input.py --target cpp      # Convert to C++ and create Makefile
     mgen build input.py --target go       # Convert to Go and compile
+    mgen build input.py --profile-pipeline trace.json  # Write a Chrome trace of the pipeline phases
+    mgen build input.py --no-cache        # Reconvert even if build/.cache holds an up-to-date result
+    mgen build input.py --profile release  # C/C++: LTO and linker dead-code elimination
     mgen backends                         # List available language backends
     mgen clean                            # Clean build directory
 """
@@ -19,6 +22,7 @@ import sys
 from pathlib import Path
 from typing import Optional, Union
 
+from ..backends.base import BUILD_PROFILES
 from ..backends.preferences import BackendPreferences, PreferencesRegistry
 from ..backends.registry import registry
 from ..common import log
@@ -26,7 +30,8 @@ from ..error_formatter import print_error, set_color_mode
 from ..errors import MGenError
 
 # Import the pipeline and backends
-from ..pipeline import BuildMode, MGenPipeline, OptimizationLevel, PipelineConfig, PipelinePhase
+from ..pipeline import BuildMode, MGenPipeline, OptimizationLevel, PipelineConfig, PipelinePhase, convert_modules
+from ..profiling import PipelineProfiler
 from .progress import progress_context
 
 BUILD_DIR = "build"
@@ -147,6 +152,35 @@ For more information, visit: https://github.com/your-org/mgen
         convert_parser.add_argument(
             "--progress", action="store_true", help="Show progress indicators during conversion"
         )
+        convert_parser.add_argument(
+            "--profile-pipeline",
+            metavar="TRACE",
+            help="Write per-phase and per-analyzer timing and peak memory as a Chrome trace JSON file",
+        )
+        convert_parser.add_argument(
+            "--no-cache", action="store_true", help="Always reconvert instead of reusing <build-dir>/.cache"
+        )
+        convert_parser.add_argument(
+            "--specialize",
+            action="store_true",
+            help="Clone functions for repeated literal arguments and per argument type, and redirect their calls",
+        )
+        convert_parser.add_argument(
+            "--interchange-loops",
+            action="store_true",
+            help="Interchange reduction loop nests over matrices (matrix products) so the innermost loop walks rows",
+        )
+        convert_parser.add_argument(
+            "--source-map",
+            action="store_true",
+            help="C, C++, LLVM: point the generated code at the Python file's lines (#line directives, DWARF)",
+        )
+        convert_parser.add_argument(
+            "--target-mode",
+            choices=["executable", "extension"],
+            default="executable",
+            help="C, C++: generate a program, or a CPython extension module exporting the functions",
+        )
 
         # Build command
         build_parser = subparsers.add_parser(
@@ -174,10 +208,75 @@ For more information, visit: https://github.com/your-org/mgen
             help="Set backend preferences (e.g., --prefer use_native_comprehensions=true)",
         )
         build_parser.add_argument("--compiler", help="Compiler to use (uses backend default if not specified)")
+        build_parser.add_argument(
+            "--cpu",
+            metavar="NAME",
+            help="Target CPU (LLVM, C, C++): native (this machine) or a name such as skylake-avx512 (default: generic)",
+        )
+        build_parser.add_argument(
+            "--profile",
+            choices=BUILD_PROFILES,
+            default="default",
+            help="Build profile: release adds LTO, -ffunction-sections/-fdata-sections with --gc-sections and "
+            "-fno-plt (C, C++)",
+        )
+        build_parser.add_argument(
+            "--features", metavar="LIST", help="LLVM target feature overrides, e.g. +avx2,-avx512f"
+        )
+        pgo_group = build_parser.add_mutually_exclusive_group()
+        pgo_group.add_argument(
+            "--pgo-generate",
+            nargs="?",
+            const="",
+            metavar="DIR",
+            help="C/LLVM: build an instrumented binary whose runs write profiles to DIR (default: <build-dir>/pgo)",
+        )
+        pgo_group.add_argument(
+            "--pgo-use",
+            metavar="PROFILE",
+            help="C/LLVM: optimize with profiles from a --pgo-generate build (its DIR, or a .profdata file)",
+        )
         build_parser.add_argument(
             "--dry-run", action="store_true", help="Show what would be built without actually compiling"
         )
         build_parser.add_argument("--progress", action="store_true", help="Show progress indicators during build")
+        build_parser.add_argument(
+            "--profile-pipeline",
+            metavar="TRACE",
+            help="Write per-phase and per-analyzer timing and peak memory as a Chrome trace JSON file",
+        )
+        build_parser.add_argument(
+            "--no-cache", action="store_true", help="Always reconvert instead of reusing <build-dir>/.cache"
+        )
+        build_parser.add_argument(
+            "--specialize",
+            action="store_true",
+            help="Clone functions for repeated literal arguments and per argument type, and redirect their calls",
+        )
+        build_parser.add_argument(
+            "--interchange-loops",
+            action="store_true",
+            help="Interchange reduction loop nests over matrices (matrix products) so the innermost loop walks rows",
+        )
+        build_parser.add_argument(
+            "--source-map",
+            action="store_true",
+            help="C, C++, LLVM: build with debug info attributing the generated code to the Python file's lines, "
+            "so perf, callgrind and debuggers report Python lines",
+        )
+        build_parser.add_argument(
+            "--instrument",
+            action="store_true",
+            help="C, C++: count and time every function and loop; runs report them at exit "
+            "(to stderr, or the file named by MGEN_INSTRUMENT)",
+        )
+        build_parser.add_argument(
+            "--target-mode",
+            choices=["executable", "extension"],
+            default="executable",
+            help="C, C++: build a program, or a CPython extension module (<name><EXT_SUFFIX>) whose functions "
+            "take lists or buffers such as array('d') and numpy arrays",
+        )
 
         # Clean command
         subparsers.add_parser("clean", help="Clean build directory")
@@ -228,9 +327,37 @@ For more information, visit: https://github.com/your-org/mgen
         )
         batch_parser.add_argument("-b", "--build", action="store_true", help="Build (compile) files after translation")
         batch_parser.add_argument("--compiler", help="Compiler to use (uses backend default if not specified)")
+        batch_parser.add_argument(
+            "--cpu",
+            metavar="NAME",
+            help="Target CPU (LLVM, C, C++): native (this machine) or a name such as skylake-avx512 (default: generic)",
+        )
+        batch_parser.add_argument(
+            "--profile",
+            choices=BUILD_PROFILES,
+            default="default",
+            help="Build profile: release adds LTO, -ffunction-sections/-fdata-sections with --gc-sections and "
+            "-fno-plt (C, C++)",
+        )
+        batch_parser.add_argument(
+            "--features", metavar="LIST", help="LLVM target feature overrides, e.g. +avx2,-avx512f"
+        )
         batch_parser.add_argument(
             "--progress", action="store_true", help="Show progress indicators during batch conversion"
         )
+        batch_parser.add_argument(
+            "-j",
+            "--jobs",
+            type=int,
+            nargs="?",
+            const=0,
+            default=1,
+            metavar="N",
+            help="Convert (and build) N modules in parallel, each after the modules it imports (-j alone: one per CPU)",
+        )
+        batch_parser.add_argument(
+            "--no-cache", action="store_true", help="Always reconvert instead of reusing <build-dir>/.cache"
+        )
 
         return parser
 
@@ -353,6 +480,22 @@ For more information, visit: https://github.com/your-org/mgen
         # For other languages, runtime libraries are typically handled by the language ecosystem
         # (e.g., Cargo for Rust, go mod for Go, standard library for C++)
 
+    def cache_dir(self, args: argparse.Namespace) -> Optional[str]:
+        """Conversion cache directory for a command: <build-dir>/.cache unless --no-cache is given."""
+        if getattr(args, "no_cache", False):
+            return None
+        return str(Path(args.build_dir) / ".cache")
+
+    def write_pipeline_profile(self, profiler: Optional[PipelineProfiler], trace_path: Optional[str]) -> None:
+        """Write a --profile-pipeline trace and log the per-phase summary."""
+        if profiler is None or not trace_path:
+            return
+        profiler.stop()
+        profiler.write_chrome_trace(trace_path)
+        for line in profiler.summary_lines():
+            self.log.info(line)
+        self.log.info(f"Pipeline profile written to {trace_path} (open in chrome://tracing or ui.perfetto.dev)")
+
     def convert_command(self, args: argparse.Namespace) -> int:
         """Execute convert command."""
         # Validate target language
@@ -370,6 +513,8 @@ For more information, visit: https://github.com/your-org/mgen
 
         # Parse backend preferences
         preferences = self.parse_preferences(target, getattr(args, "prefer", None))
+        if getattr(args, "target_mode", "executable") != "executable":
+            preferences.set("target_mode", args.target_mode)
 
         if self.verbose and preferences:
             self.log.info(f"Backend preferences: {preferences}")
@@ -408,7 +553,14 @@ For more information, visit: https://github.com/your-org/mgen
             build_mode=BuildMode.NONE,
             target_language=target,
             backend_preferences=preferences,
+            cache_dir=self.cache_dir(args),
+            specialize_functions=getattr(args, "specialize", False),
+            interchange_loops=getattr(args, "interchange_loops", False),
+            source_map=getattr(args, "source_map", False),
         )
+        trace_path = getattr(args, "profile_pipeline", None)
+        if trace_path:
+            config.profiler = PipelineProfiler()
 
         # Progress tracking
         show_progress = hasattr(args, "progress") and args.progress
@@ -473,6 +625,8 @@ For more information, visit: https://github.com/your-org/mgen
                 self.log.error(f"Pipeline error for {input_path}: {e}")
                 failed_files.append(str(input_path))
 
+        self.write_pipeline_profile(config.profiler, trace_path)
+
         # Summary
         if len(input_files) > 1:
             self.log.info(f"\nConversion summary: {len(successful_files)}/{len(input_files)} files succeeded")
@@ -499,6 +653,10 @@ For more information, visit: https://github.com/your-org/mgen
 
         # Parse backend preferences
         preferences = self.parse_preferences(target, getattr(args, "prefer", None))
+        if getattr(args, "instrument", False):
+            preferences.set("instrument", True)
+        if getattr(args, "target_mode", "executable") != "executable":
+            preferences.set("target_mode", args.target_mode)
 
         if self.verbose and preferences:
             self.log.info(f"Backend preferences: {preferences}")
@@ -557,15 +715,32 @@ For more information, visit: https://github.com/your-org/mgen
         if target == "c":
             include_dirs = [str(build_dir / "src")]  # Add runtime include path for C
 
+        # --pgo-generate without DIR collects profiles next to the executable
+        pgo_generate_dir = getattr(args, "pgo_generate", None)
+        if pgo_generate_dir == "":
+            pgo_generate_dir = str(build_dir / "pgo")
+
         config = PipelineConfig(
             optimization_level=self.get_optimization_level(args.optimization),
             output_dir=str(build_dir / "src"),
             build_mode=build_mode,
             target_language=target,
             compiler=getattr(args, "compiler", None),  # Use backend default if not specified
+            target_cpu=getattr(args, "cpu", None),
+            target_features=getattr(args, "features", None),
+            pgo_generate_dir=pgo_generate_dir,
+            pgo_use_profile=getattr(args, "pgo_use", None),
+            build_profile=getattr(args, "profile", "default"),
             include_dirs=include_dirs,
             backend_preferences=preferences,
+            cache_dir=self.cache_dir(args),
+            specialize_functions=getattr(args, "specialize", False),
+            interchange_loops=getattr(args, "interchange_loops", False),
+            source_map=getattr(args, "source_map", False),
         )
+        trace_path = getattr(args, "profile_pipeline", None)
+        if trace_path:
+            config.profiler = PipelineProfiler()
 
         # Progress tracking
         show_progress = hasattr(args, "progress") and args.progress
@@ -643,8 +818,15 @@ For more information, visit: https://github.com/your-org/mgen
                         else:
                             progress_indicator.finish("Build failed")
 
-                    if result.executable_path:
+                    if result.executable_path and preferences.get("target_mode") == "extension":
+                        self.log.info(f"Compilation successful! Extension module: {result.executable_path}")
+                    elif result.executable_path:
                         self.log.info(f"Compilation successful! Executable: {result.executable_path}")
+                        if pgo_generate_dir:
+                            self.log.info(
+                                f"Instrumented build: run it on representative input, then rebuild with "
+                                f"--pgo-use {pgo_generate_dir}"
+                            )
                     else:
                         self.log.error("Build failed: No executable produced")
                         sys.exit(1)
@@ -668,6 +850,8 @@ For more information, visit: https://github.com/your-org/mgen
             # Regular exceptions get standard formatting
             self.log.error(f"Pipeline error: {e}")
             return 1
+        finally:
+            self.write_pipeline_profile(config.profiler, trace_path)
 
     def _get_build_file_name(self, target_language: str) -> str:
         """Get the appropriate build file name for the target language."""
@@ -691,6 +875,36 @@ For more information, visit: https://github.com/your-org/mgen
 
         return 0
 
+    def batch_config(self, args: argparse.Namespace, target: str, output_dir: str) -> PipelineConfig:
+        """Pipeline configuration of the batch command."""
+        if args.build:
+            # Use DIRECT build mode to compile after translation
+            build_dir = Path(args.build_dir)
+            include_dirs = []
+            if target == "c":
+                include_dirs = [str(build_dir / "src")]  # Add runtime include path for C
+
+            return PipelineConfig(
+                optimization_level=self.get_optimization_level(args.optimization),
+                output_dir=str(build_dir / "src"),
+                build_mode=BuildMode.DIRECT,
+                target_language=target,
+                compiler=getattr(args, "compiler", None),
+                target_cpu=getattr(args, "cpu", None),
+                target_features=getattr(args, "features", None),
+                build_profile=getattr(args, "profile", "default"),
+                include_dirs=include_dirs,
+                cache_dir=self.cache_dir(args),
+            )
+        # Translation only mode
+        return PipelineConfig(
+            optimization_level=self.get_optimization_level(args.optimization),
+            output_dir=output_dir,
+            build_mode=BuildMode.NONE,
+            target_language=target,
+            cache_dir=self.cache_dir(args),
+        )
+
     def batch_command(self, args: argparse.Namespace) -> int:
         """Execute batch command."""
         import os
@@ -754,6 +968,14 @@ For more information, visit: https://github.com/your-org/mgen
         # Progress tracking
         show_progress = hasattr(args, "progress") and args.progress
 
+        # With -j, convert every module up front in a process pool; the loop below reports the results
+        parallel_results = {}
+        jobs = getattr(args, "jobs", 1)
+        if jobs != 1:
+            self.log.info(f"Converting with {jobs or os.cpu_count()} parallel jobs")
+            config = self.batch_config(args, target, output_dir)
+            parallel_results = dict(zip(python_files, convert_modules(python_files, config, jobs or None)))
+
         # Process each file
         successful_translations = 0
         failed_translations = 0
@@ -771,33 +993,13 @@ For more information, visit: https://github.com/your-org/mgen
                 self.log.info(f"[{i}/{len(python_files)}] Processing {filename}")
 
             try:
-                # Use the pipeline to convert the file
-                if build_after_translation:
-                    # Use DIRECT build mode to compile after translation
-                    build_dir = Path(args.build_dir)
-                    include_dirs = []
-                    if target == "c":
-                        include_dirs = [str(build_dir / "src")]  # Add runtime include path for C
-
-                    config = PipelineConfig(
-                        optimization_level=self.get_optimization_level(args.optimization),
-                        output_dir=str(build_dir / "src"),
-                        build_mode=BuildMode.DIRECT,
-                        target_language=target,
-                        compiler=getattr(args, "compiler", None),
-                        include_dirs=include_dirs,
-                    )
-                else:
-                    # Translation only mode
-                    config = PipelineConfig(
-                        optimization_level=self.get_optimization_level(args.optimization),
-                        output_dir=output_dir,
-                        build_mode=BuildMode.NONE,
-                        target_language=target,
-                    )
+                config = self.batch_config(args, target, output_dir)
 
+                if input_file in parallel_results:
+                    # Converted up front with -j
+                    result = parallel_results[input_file]
                 # Create progress callback if enabled
-                if show_progress:
+                elif show_progress:
                     file_title = f"[{i}/{len(python_files)}] {filename}"
 
                     with progress_context(file_title, enabled=True, verbose=self.verbose) as progress_indicator:
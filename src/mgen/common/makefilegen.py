@@ -9,9 +9,11 @@ high-performance C code generation projects.
 """
 
 import argparse
+import os
 import platform
 import subprocess
 import sys
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from typing import Callable, List, Optional, Union
 
@@ -42,12 +44,18 @@ def unique_list(lst: list) -> list:
 
 
 class Builder:
-    """Direct compilation builder for C/C++ projects with STC support."""
+    """Direct compilation builder for C/C++ projects with STC support.
+
+    Each source file is compiled to its own object in build_dir, in parallel,
+    and only when it, a header it includes (from the compiler's -MMD depfile)
+    or its compile command changed; the objects are then linked.
+    """
 
     def __init__(
         self,
         name: str = "main",
         source_dir: str = ".",
+        build_dir: str = "build",
         include_dirs: Optional[List[str]] = None,
         library_dirs: Optional[List[str]] = None,
         libraries: Optional[List[str]] = None,
@@ -60,10 +68,12 @@ class Builder:
         use_stc: bool = True,
         stc_include_path: Optional[str] = None,
         project_type: str = "MGen",
+        jobs: Optional[int] = None,
     ):
         self.log = log.config(self.__class__.__name__)
         self.name = name
         self.source_dir = Path(source_dir)
+        self.build_dir = Path(build_dir)
         self.include_dirs = include_dirs or []
         self.library_dirs = library_dirs or []
         self.libraries = libraries or []
@@ -76,6 +86,8 @@ class Builder:
         self.use_stc = use_stc
         self.stc_include_path = stc_include_path
         self.project_type = project_type
+        # Parallel compile jobs (default: one per CPU)
+        self.jobs = jobs
 
         # Auto-detect STC if requested
         if self.use_stc and not self.stc_include_path:
@@ -184,28 +196,112 @@ class Builder:
 
         return cmd
 
-    def build(self, verbose: bool = False) -> bool:
-        """Execute the build command."""
-        cmd = self.build_command()
+    def object_path(self, source: Path) -> Path:
+        """Object file of a source file (main.c -> <build_dir>/main.c.o)."""
+        return self.build_dir / f"{source.name}.o"
+
+    def compile_command(self, source: Path) -> List[str]:
+        """Generate the command compiling one source file to its object."""
+        cmd = [self.compiler, f"-std={self.std}"]
+        cmd.extend(self.flags)
+        cmd.extend(self.cppflags)
+        if self.compiler in ["g++", "clang++"]:
+            cmd.extend(self.cxxflags)
+        for inc_dir in self.include_dirs:
+            cmd.extend(["-I", str(inc_dir)])
+
+        obj = self.object_path(source)
+        # -MMD writes the headers the source includes, for is_up_to_date
+        cmd.extend(["-MMD", "-MF", str(obj.with_suffix(".d")), "-c", str(source), "-o", str(obj)])
+        return cmd
+
+    def link_command(self, objects: List[Path]) -> List[str]:
+        """Generate the command linking the objects into the executable."""
+        cmd = [self.compiler]
+        # Flags such as -O2, -fprofile-generate or -fsanitize also apply at link time
+        cmd.extend(self.flags)
+        for lib_dir in self.library_dirs:
+            cmd.extend(["-L", str(lib_dir)])
+        cmd.extend([str(obj) for obj in objects])
+        for lib in self.libraries:
+            cmd.extend(["-l", lib])
+        cmd.extend(self.ldflags)
+        cmd.extend(["-o", self.name])
+        return cmd
+
+    def is_up_to_date(self, source: Path) -> bool:
+        """Check whether a source's object is newer than the source and its headers.
+
+        The object is also stale when it was compiled with a different command.
+        """
+        obj = self.object_path(source)
+        command_file = obj.with_suffix(".cmd")
+        if not obj.exists() or not command_file.exists():
+            return False
+        if command_file.read_text() != " ".join(self.compile_command(source)):
+            return False
+        built = obj.stat().st_mtime_ns
+        dependencies = [source] + _depfile_prerequisites(obj.with_suffix(".d"))
+        return all(dep.exists() and dep.stat().st_mtime_ns <= built for dep in dependencies)
 
+    def build(self, verbose: bool = False, jobs: Optional[int] = None) -> bool:
+        """Compile the changed sources in parallel and link the executable.
+
+        Args:
+            verbose: Print the commands and their output
+            jobs: Parallel compile jobs (default: the builder's jobs, else one per CPU)
+        """
         self.log.debug(f"Building with STC support: {self.use_stc}")
         if self.use_stc and self.stc_include_path:
             self.log.debug(f"STC include path: {self.stc_include_path}")
-        self.log.debug(f"Build command: {' '.join(cmd)}")
-
         if verbose:
             print(f"Building with STC support: {self.use_stc}")
             if self.use_stc and self.stc_include_path:
                 print(f"STC include path: {self.stc_include_path}")
+
+        sources = self.get_source_files()
+        stale = [source for source in sources if not self.is_up_to_date(source)]
+        self.build_dir.mkdir(parents=True, exist_ok=True)
+        workers = jobs or self.jobs or os.cpu_count() or 1
+        self.log.debug(f"Compiling {len(stale)} of {len(sources)} sources with {workers} jobs")
+
+        with ThreadPoolExecutor(max_workers=workers) as pool:
+            compiled = list(pool.map(lambda source: self._compile(source, verbose), stale))
+        if not all(compiled):
+            return False
+
+        objects = [self.object_path(source) for source in sources]
+        executable = Path(self.name)
+        if not stale and executable.exists():
+            newest = max((obj.stat().st_mtime_ns for obj in objects), default=0)
+            if executable.stat().st_mtime_ns >= newest:
+                self.log.info(f"Build up to date: {self.name}")
+                return True
+        return self._run(self.link_command(objects), verbose, f"Build successful: {self.name}")
+
+    def _compile(self, source: Path, verbose: bool) -> bool:
+        """Compile one source, recording its command for is_up_to_date."""
+        cmd = self.compile_command(source)
+        command_file = self.object_path(source).with_suffix(".cmd")
+        command_file.unlink(missing_ok=True)
+        if not self._run(cmd, verbose, f"Compiled: {source.name}"):
+            return False
+        command_file.write_text(" ".join(cmd))
+        return True
+
+    def _run(self, cmd: List[str], verbose: bool, success_message: str) -> bool:
+        """Run a compiler command, logging its output."""
+        self.log.debug(f"Build command: {' '.join(cmd)}")
+        if verbose:
             print(f"Build command: {' '.join(cmd)}")
 
         try:
             result = subprocess.run(cmd, check=True, capture_output=True, text=True)
-            self.log.info(f"Build successful: {self.name}")
+            self.log.info(success_message)
             if result.stdout:
                 self.log.debug(f"stdout: {result.stdout}")
             if verbose:
-                print(f" Build successful: {self.name}")
+                print(f" {success_message}")
                 if result.stdout:
                     print(f"stdout: {result.stdout}")
             return True
@@ -227,6 +323,18 @@ class Builder:
             return False
 
 
+def _depfile_prerequisites(depfile: Path) -> List[Path]:
+    """Read the prerequisites of a make-style depfile written by -MMD (empty if missing)."""
+    try:
+        text = depfile.read_text()
+    except OSError:
+        return []
+    _, _, prerequisites = text.partition(": ")
+    # Escaped spaces are part of a file name; backslash-newlines continue the rule
+    names = prerequisites.replace("\\\n", " ").replace("\\ ", "\0").split()
+    return [Path(name.replace("\0", " ")) for name in names]
+
+
 class MakefileGenerator:
     """Generate sophisticated Makefiles for C/C++ projects with STC support."""
 
@@ -473,9 +581,11 @@ class MakefileGenerator:
             compile_cmd.append("$(INCLUDES)")
         if self.use_stc:
             compile_cmd.append("$(STC_FLAGS)")
-        compile_cmd.extend(["-c $< -o $@"])
+        # -MMD -MP: track included headers so edits recompile their users
+        compile_cmd.extend(["-MMD -MP -c $< -o $@"])
 
-        self.pattern_rule("$(BUILDDIR)/%.o", "$(SRCDIR)/%.c", [" ".join(compile_cmd)])
+        # The build directory is order-only, so objects can compile in parallel under make -j
+        self.pattern_rule("$(BUILDDIR)/%.o", "$(SRCDIR)/%.c | $(BUILDDIR)", [" ".join(compile_cmd)])
 
         # Main target
         link_cmd = ["$(CC)"]
@@ -488,7 +598,7 @@ class MakefileGenerator:
             link_cmd.append("$(LIBS)")
         link_cmd.extend(["-o $@"])
 
-        self.target(self.name, ["$(BUILDDIR)", "$(OBJECTS)"], [" ".join(link_cmd)])
+        self.target(self.name, ["$(OBJECTS)"], [" ".join(link_cmd)])
 
         # Clean target
         self.target("clean", commands=["@rm -rf $(BUILDDIR)", f"@rm -f {self.name}"], phony=True)
@@ -505,6 +615,7 @@ class MakefileGenerator:
 
         self.target("help", commands=help_commands, phony=True)
 
+        self.content.append("-include $(OBJECTS:.o=.d)")
         return self
 
     def generate_makefile(self) -> str:
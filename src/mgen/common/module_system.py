@@ -191,6 +191,23 @@ class ModuleResolver:
             return stdlib_module.functions.get(function_name)
         return None
 
+    def dependency_graph(self, module_files: list[Path]) -> dict[str, set[str]]:
+        """Map each module file's name to the names of the given modules it imports.
+
+        Imports of anything outside module_files (standard library, other
+        local modules) are not edges.
+        """
+        names = {path.stem for path in module_files}
+        for path in module_files:
+            self.add_search_path(path.parent.resolve())
+
+        graph: dict[str, set[str]] = {}
+        for path in module_files:
+            module_info = self.discover_module(path.stem)
+            dependencies = {dep.split(".")[0] for dep in module_info.dependencies} if module_info else set()
+            graph[path.stem] = (dependencies & names) - {path.stem}
+        return graph
+
     def get_compilation_order(self) -> list[str]:
         """Get the order in which modules should be compiled (dependency-first)."""
         # Simple topological sort for module dependencies
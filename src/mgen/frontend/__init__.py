@@ -85,6 +85,7 @@ from .optimizers import (
     LoopAnalysisReport,
     LoopAnalyzer,
     LoopInfo,
+    LoopNestOptimizer,
     LoopOptimization,
     MemoryAccess,
     OptimizationCandidate,
@@ -130,6 +131,7 @@ from .verifiers import (
     BoundsProver,
     CorrectnessProver,
     MemorySafetyProof,
+    ProofCache,
     ProofResult,
     TheoremProver,
 )
@@ -212,6 +214,7 @@ __all__ = [
     "LoopAnalysisReport",
     "LoopInfo",
     "LoopOptimization",
+    "LoopNestOptimizer",
     "FunctionSpecializer",
     "SpecializationReport",
     "FunctionProfile",
@@ -225,6 +228,7 @@ __all__ = [
     # Formal Verification
     "TheoremProver",
     "ProofResult",
+    "ProofCache",
     "BoundsProver",
     "MemorySafetyProof",
     "CorrectnessProver",
@@ -7,7 +7,16 @@ symbolic execution, bounds checking, and call graph analysis.
 from .bounds_checker import BoundsChecker, BoundsCheckingReport, BoundsViolation, MemoryRegion
 from .call_graph import CallGraphAnalyzer, CallGraphReport, CallPath, CallSite, FunctionNode
 from .static_analyzer import CFGNode, ControlFlowGraph, StaticAnalysisReport, StaticAnalyzer
-from .symbolic_executor import ExecutionPath, SymbolicExecutionReport, SymbolicExecutor, SymbolicState, SymbolicValue
+from .symbolic_executor import (
+    ExecutionPath,
+    SymbolicExecutionReport,
+    SymbolicExecutor,
+    SymbolicState,
+    SymbolicValue,
+    ValueRange,
+    ValueRangeAnalyzer,
+    ValueRanges,
+)
 
 __all__ = [
     "StaticAnalyzer",
@@ -19,6 +28,9 @@ __all__ = [
     "SymbolicValue",
     "SymbolicState",
     "ExecutionPath",
+    "ValueRange",
+    "ValueRanges",
+    "ValueRangeAnalyzer",
     "BoundsChecker",
     "BoundsCheckingReport",
     "MemoryRegion",
@@ -515,6 +515,9 @@ class CallGraphAnalyzer(BaseAnalyzer):
         # Calculate max call depth (simplified)
         metrics.max_call_depth = self._calculate_max_depth(call_graph)
 
+        edges = {name: node.local_calls for name, node in call_graph.items()}
+        metrics.strongly_connected_components = len(strongly_connected_components(edges))
+
         return metrics
 
     def _calculate_max_depth(self, call_graph: dict[str, FunctionNode]) -> int:
@@ -627,3 +630,129 @@ class CallGraphAnalyzer(BaseAnalyzer):
                 warnings.append(f"Function {node.name} appears to be unreachable")
 
         return warnings
+
+
+def strongly_connected_components(graph: dict[str, set[str]]) -> list[list[str]]:
+    """Group the nodes of a call graph into strongly connected components.
+
+    Mutually recursive functions end up in the same component; every other
+    function forms a component on its own. Components come out in reverse
+    topological order (callees before their callers). Iterative Tarjan, so
+    deep call chains do not hit the recursion limit.
+
+    Args:
+        graph: Function name -> names it calls; callees missing from the
+            keys (builtins, external functions) are ignored
+
+    Returns:
+        Components as lists of function names
+    """
+    index: dict[str, int] = {}
+    lowlink: dict[str, int] = {}
+    stack: list[str] = []
+    on_stack: set[str] = set()
+    components: list[list[str]] = []
+
+    for root in graph:
+        if root in index:
+            continue
+        work = [(root, iter(sorted(graph[root])))]
+        index[root] = lowlink[root] = len(index)
+        stack.append(root)
+        on_stack.add(root)
+
+        while work:
+            node, callees = work[-1]
+            callee = next(callees, None)
+            if callee is not None:
+                if callee not in graph:
+                    continue
+                if callee not in index:
+                    index[callee] = lowlink[callee] = len(index)
+                    stack.append(callee)
+                    on_stack.add(callee)
+                    work.append((callee, iter(sorted(graph[callee]))))
+                elif callee in on_stack:
+                    lowlink[node] = min(lowlink[node], index[callee])
+                continue
+
+            work.pop()
+            if work:
+                parent = work[-1][0]
+                lowlink[parent] = min(lowlink[parent], lowlink[node])
+            if lowlink[node] == index[node]:
+                component = []
+                while True:
+                    member = stack.pop()
+                    on_stack.discard(member)
+                    component.append(member)
+                    if member == node:
+                        break
+                components.append(component)
+
+    return components
+
+
+@dataclass
+class ClassHierarchy:
+    """Whole-program class hierarchy of a module: what may override what."""
+
+    # Class name -> names of the module's classes deriving from it, directly or not
+    subclasses: dict[str, set[str]] = field(default_factory=dict)
+    # Class name -> method name -> the field a trivial getter (return self.f) returns
+    getters: dict[str, dict[str, str]] = field(default_factory=dict)
+
+    def is_leaf(self, class_name: str) -> bool:
+        """Check that no class of the program derives from class_name, so none overrides its methods."""
+        return class_name in self.subclasses and not self.subclasses[class_name]
+
+    def inlinable_getter(self, class_name: str, method: str) -> Optional[str]:
+        """The field a call of method on a class_name receiver returns, when no override can intercept it."""
+        if not self.is_leaf(class_name):
+            return None
+        return self.getters[class_name].get(method)
+
+
+def class_hierarchy(module: ast.Module) -> ClassHierarchy:
+    """Build the class hierarchy of the top-level classes of a module.
+
+    Bases are matched by name; a class whose bases are not all classes of the
+    module may hide methods the analysis cannot see, so it has no getters.
+    """
+    classes = {stmt.name: stmt for stmt in module.body if isinstance(stmt, ast.ClassDef)}
+    parents = {
+        name: {base.id for base in node.bases if isinstance(base, ast.Name) and base.id in classes}
+        for name, node in classes.items()
+    }
+    hierarchy = ClassHierarchy()
+    for name in classes:
+        descendants: set[str] = set()
+        frontier = [child for child, bases in parents.items() if name in bases]
+        while frontier:
+            child = frontier.pop()
+            if child not in descendants:
+                descendants.add(child)
+                frontier.extend(grandchild for grandchild, bases in parents.items() if child in bases)
+        hierarchy.subclasses[name] = descendants - {name}
+    for name, node in classes.items():
+        known_bases = len(parents[name]) == len(node.bases)
+        hierarchy.getters[name] = _field_getters(node) if known_bases and not node.decorator_list else {}
+    return hierarchy
+
+
+def _field_getters(class_node: ast.ClassDef) -> dict[str, str]:
+    """Methods of a class that only take self and return one of its fields, with that field."""
+    getters: dict[str, str] = {}
+    for stmt in class_node.body:
+        if not isinstance(stmt, ast.FunctionDef) or stmt.decorator_list or len(stmt.args.args) != 1:
+            continue
+        body = stmt.body
+        if body and isinstance(body[0], ast.Expr) and isinstance(body[0].value, ast.Constant):
+            body = body[1:]  # Docstring
+        if len(body) != 1 or not isinstance(body[0], ast.Return):
+            continue
+        value = body[0].value
+        self_name = stmt.args.args[0].arg
+        if isinstance(value, ast.Attribute) and isinstance(value.value, ast.Name) and value.value.id == self_name:
+            getters[stmt.name] = value.attr
+    return getters
@@ -2,13 +2,17 @@
 
 This module provides symbolic execution capabilities for analyzing Python code paths,
 tracking symbolic values, and detecting potential runtime errors without actual execution.
+
+ValueRangeAnalyzer abstracts the same values to integer intervals: one range per
+local and per list local's elements, which backends use to store data in the
+narrowest fixed-width integer type that holds it (see narrowest_integer_width()).
 """
 
 import ast
 import time
 from dataclasses import dataclass, field
 from enum import Enum
-from typing import Any, Optional
+from typing import Any, Callable, Iterable, Optional
 
 from ..base import AnalysisContext, AnalysisLevel, AnalysisReport, BaseAnalyzer
 
@@ -688,3 +692,393 @@ class SymbolicExecutor(BaseAnalyzer):
             findings.append(f"Detected {total_errors} potential runtime errors")
 
         return findings
+
+
+@dataclass(frozen=True)
+class ValueRange:
+    """Closed interval of integer values; a None bound is unbounded."""
+
+    low: Optional[int] = None
+    high: Optional[int] = None
+
+    def union(self, other: "ValueRange") -> "ValueRange":
+        """Smallest range holding both ranges."""
+        low = None if self.low is None or other.low is None else min(self.low, other.low)
+        high = None if self.high is None or other.high is None else max(self.high, other.high)
+        return ValueRange(low, high)
+
+    def narrowest_integer_width(self) -> Optional[tuple[int, bool]]:
+        """Bits and signedness of the narrowest fixed-width integer holding the range.
+
+        Returns:
+            (bits, signed) with bits 8, 16, 32 or 64 (unsigned preferred when the
+            range is non-negative), or None when the range is unbounded or too wide
+        """
+        if self.low is None or self.high is None:
+            return None
+        for bits in (8, 16, 32, 64):
+            if self.low >= 0 and self.high < 2**bits:
+                return bits, False
+            if -(2 ** (bits - 1)) <= self.low and self.high < 2 ** (bits - 1):
+                return bits, True
+        return None
+
+
+UNBOUNDED = ValueRange()
+
+
+@dataclass
+class ValueRanges:
+    """Ranges of the names bound in one function."""
+
+    variables: dict[str, ValueRange] = field(default_factory=dict)
+    elements: dict[str, ValueRange] = field(default_factory=dict)
+
+
+class ValueRangeAnalyzer:
+    """Flow-insensitive integer value-range analysis of one function.
+
+    Every binding of a local is joined into one range per name, iterated to a
+    fixed point, so the range holds everywhere in the function. Element ranges
+    cover every value a list local may hold: its literal or comprehension
+    elements, appended and inserted values and element stores. A list read in
+    any way that could let another name store into it (passed to a call,
+    aliased, returned, extended) has unbounded elements. Bounds still growing
+    after WIDENING_ROUNDS rounds are widened to unbounded, so accumulators such
+    as `total += x` get no bound. Parameters and other names not bound in the
+    function are unbounded.
+
+    Ranges are of the Python values. % and // by a positive constant are
+    bounded for both floor and truncating division, so a backend emitting C
+    operators may rely on them too.
+    """
+
+    WIDENING_ROUNDS = 3
+
+    # List methods that neither store into the list nor let it escape
+    READ_METHODS = frozenset({"index", "count", "pop", "remove", "clear", "reverse", "sort"})
+    # Builtins that only read a list argument
+    READING_BUILTINS = frozenset({"len", "sum", "min", "max", "sorted", "any", "all", "print", "str"})
+
+    def analyze_function(self, func: ast.FunctionDef) -> ValueRanges:
+        """Compute the value and element ranges of the names bound in func.
+
+        Args:
+            func: Function to analyze
+
+        Returns:
+            Ranges for every name bound in the body; names whose values are not
+            integers are unbounded
+        """
+        parents: dict[int, ast.AST] = {}
+        for node in ast.walk(func):
+            for child in ast.iter_child_nodes(node):
+                parents[id(child)] = node
+
+        # Names whose bindings this analysis does not follow
+        unbounded: set[str] = {arg.arg for arg in func.args.args}
+        for node in ast.walk(func):
+            if isinstance(node, (ast.Global, ast.Nonlocal)):
+                unbounded.update(node.names)
+            elif isinstance(node, (ast.FunctionDef, ast.AsyncFunctionDef, ast.Lambda)) and node is not func:
+                unbounded.update(arg.arg for arg in node.args.args + node.args.kwonlyargs)
+
+        variable_defs: list[tuple[str, Callable[[], Optional[ValueRange]]]] = []
+        element_defs: list[tuple[str, Callable[[], Optional[ValueRange]]]] = []
+        escaped: set[str] = set()
+        self._variables: dict[str, ValueRange] = {}
+        self._elements: dict[str, ValueRange] = {}
+        self._bound: set[str] = set()
+
+        for node in ast.walk(func):
+            if not isinstance(node, ast.Name):
+                continue
+            parent = parents.get(id(node))
+            if isinstance(node.ctx, ast.Store):
+                self._bound.add(node.id)
+                variable_defs.append((node.id, self._binding_range(node, parent)))
+                element_defs.append((node.id, self._binding_elements(node, parent)))
+            elif isinstance(node.ctx, ast.Load):
+                update = self._element_update(node, parent, parents)
+                if update is not None:
+                    element_defs.append((node.id, update))
+                elif not self._reads_in_place(node, parent, parents):
+                    escaped.add(node.id)
+        # Another name may store anything into a list that escapes
+        element_defs.extend((name, lambda: UNBOUNDED) for name in escaped)
+        self._bound -= unbounded
+
+        for rounds in range(len(variable_defs) + len(element_defs) + self.WIDENING_ROUNDS + 2):
+            changed = self._join_round(self._variables, variable_defs, rounds >= self.WIDENING_ROUNDS)
+            changed |= self._join_round(self._elements, element_defs, rounds >= self.WIDENING_ROUNDS)
+            if not changed:
+                break
+        else:
+            # Widening bounds the rounds; this is only a guard
+            self._variables = {name: UNBOUNDED for name in self._variables}
+            self._elements = {name: UNBOUNDED for name in self._elements}
+
+        return ValueRanges(
+            {name: value for name, value in self._variables.items() if name in self._bound},
+            {name: value for name, value in self._elements.items() if name in self._bound},
+        )
+
+    def _join_round(
+        self,
+        ranges: dict[str, ValueRange],
+        defs: list[tuple[str, Callable[[], Optional[ValueRange]]]],
+        widen: bool,
+    ) -> bool:
+        """Join every definition into ranges once; report whether any range grew."""
+        changed = False
+        for name, evaluate in defs:
+            value = evaluate()
+            if value is None:
+                continue
+            old = ranges.get(name)
+            new = value if old is None else old.union(value)
+            if new == old:
+                continue
+            if widen and old is not None:
+                new = ValueRange(
+                    None if new.low != old.low else new.low,
+                    None if new.high != old.high else new.high,
+                )
+            ranges[name] = new
+            changed = True
+        return changed
+
+    def _binding_range(self, name: ast.Name, parent: Optional[ast.AST]) -> Callable[[], Optional[ValueRange]]:
+        """The range a Name store binds."""
+        if isinstance(parent, ast.Assign) and name in parent.targets:
+            value = parent.value
+            return lambda: self._range(value)
+        if isinstance(parent, (ast.AnnAssign, ast.NamedExpr)) and parent.target is name and parent.value is not None:
+            annotated = parent.value
+            return lambda: self._range(annotated)
+        if isinstance(parent, ast.AugAssign):
+            operator, operand = parent.op, parent.value
+            return lambda: self._binary_range(operator, self._variables.get(name.id), self._range(operand))
+        if isinstance(parent, (ast.For, ast.comprehension)) and parent.target is name:
+            iterable = parent.iter
+            return lambda: self._iteration_range(iterable)
+        return lambda: UNBOUNDED
+
+    def _binding_elements(self, name: ast.Name, parent: Optional[ast.AST]) -> Callable[[], Optional[ValueRange]]:
+        """The element range a Name store binds: a literal's elements, or nothing known."""
+        value: Optional[ast.expr] = None
+        if isinstance(parent, ast.Assign) and name in parent.targets:
+            value = parent.value
+        elif isinstance(parent, ast.AnnAssign) and parent.target is name:
+            value = parent.value
+            if value is None:
+                return lambda: None
+        if isinstance(value, ast.BinOp) and isinstance(value.op, ast.Mult) and isinstance(value.left, ast.List):
+            value = value.left
+        if isinstance(value, ast.List) and not any(isinstance(elt, ast.Starred) for elt in value.elts):
+            elts = value.elts
+            return lambda: self._union(self._range(elt) for elt in elts)
+        if isinstance(value, ast.ListComp):
+            element = value.elt
+            return lambda: self._range(element)
+        return lambda: UNBOUNDED
+
+    def _element_update(
+        self, name: ast.Name, parent: Optional[ast.AST], parents: dict[int, ast.AST]
+    ) -> Optional[Callable[[], Optional[ValueRange]]]:
+        """The values a list load stores into the list (append, insert, item stores), or None."""
+        if isinstance(parent, ast.Attribute) and parent.value is name:
+            call = parents.get(id(parent))
+            if isinstance(call, ast.Call) and call.func is parent and not call.keywords:
+                if parent.attr == "append" and len(call.args) == 1:
+                    appended = call.args[0]
+                    return lambda: self._range(appended)
+                if parent.attr == "insert" and len(call.args) == 2:
+                    inserted = call.args[1]
+                    return lambda: self._range(inserted)
+            return None
+        if not (isinstance(parent, ast.Subscript) and parent.value is name and isinstance(parent.ctx, ast.Store)):
+            return None
+        if isinstance(parent.slice, ast.Slice):
+            return lambda: UNBOUNDED
+        statement = parents.get(id(parent))
+        if isinstance(statement, ast.Assign) and parent in statement.targets:
+            stored = statement.value
+            return lambda: self._range(stored)
+        if isinstance(statement, ast.AugAssign):
+            operator, operand = statement.op, statement.value
+            return lambda: self._binary_range(operator, self._elements.get(name.id), self._range(operand))
+        return lambda: UNBOUNDED
+
+    def _reads_in_place(self, name: ast.Name, parent: Optional[ast.AST], parents: dict[int, ast.AST]) -> bool:
+        """Whether a load of a list cannot lead to a store into it by another name."""
+        if isinstance(parent, ast.Subscript):
+            return parent.value is name or parent.slice is name
+        if isinstance(parent, ast.Attribute):
+            call = parents.get(id(parent))
+            return parent.attr in self.READ_METHODS and isinstance(call, ast.Call) and call.func is parent
+        if isinstance(parent, (ast.For, ast.comprehension)):
+            return parent.iter is name
+        if isinstance(parent, ast.Call):
+            return isinstance(parent.func, ast.Name) and parent.func.id in self.READING_BUILTINS
+        return isinstance(parent, (ast.Compare, ast.BinOp, ast.UnaryOp, ast.BoolOp, ast.AugAssign))
+
+    def _iteration_range(self, iterable: ast.expr) -> Optional[ValueRange]:
+        """Range of a loop variable over range(...) or over a list local."""
+        if isinstance(iterable, ast.Name):
+            if iterable.id not in self._bound:
+                return UNBOUNDED
+            return self._elements.get(iterable.id)
+        if not (isinstance(iterable, ast.Call) and isinstance(iterable.func, ast.Name) and iterable.func.id == "range"):
+            return UNBOUNDED
+        args = iterable.args
+        if not 1 <= len(args) <= 3 or iterable.keywords:
+            return UNBOUNDED
+        step = self._constant(args[2]) if len(args) == 3 else 1
+        start = self._range(args[0]) if len(args) > 1 else ValueRange(0, 0)
+        stop = self._range(args[1] if len(args) > 1 else args[0])
+        if start is None or stop is None:
+            return None
+        if step is not None and step > 0:
+            return ValueRange(start.low, None if stop.high is None else stop.high - 1)
+        if step is not None and step < 0:
+            return ValueRange(None if stop.low is None else stop.low + 1, start.high)
+        return UNBOUNDED
+
+    def _range(self, expr: ast.expr) -> Optional[ValueRange]:
+        """Range of an expression; None while an operand has no value yet."""
+        if isinstance(expr, ast.Constant):
+            if isinstance(expr.value, bool):
+                return ValueRange(0, 1)
+            if isinstance(expr.value, int):
+                return ValueRange(expr.value, expr.value)
+            return UNBOUNDED
+        if isinstance(expr, ast.Name):
+            if expr.id not in self._bound:
+                return UNBOUNDED
+            return self._variables.get(expr.id)
+        if isinstance(expr, ast.BinOp):
+            return self._binary_range(expr.op, self._range(expr.left), self._range(expr.right))
+        if isinstance(expr, ast.UnaryOp):
+            if isinstance(expr.op, ast.Not):
+                return ValueRange(0, 1)
+            operand = self._range(expr.operand)
+            if operand is None or isinstance(expr.op, ast.UAdd):
+                return operand
+            negated = self._binary_range(ast.Sub(), ValueRange(0, 0), operand)
+            if isinstance(expr.op, ast.USub):
+                return negated
+            # ~x == -x - 1
+            return self._binary_range(ast.Sub(), negated, ValueRange(1, 1))
+        if isinstance(expr, ast.Compare):
+            return ValueRange(0, 1)
+        if isinstance(expr, ast.BoolOp):
+            return self._union(self._range(value) for value in expr.values)
+        if isinstance(expr, ast.IfExp):
+            return self._union([self._range(expr.body), self._range(expr.orelse)])
+        if isinstance(expr, ast.Subscript) and isinstance(expr.value, ast.Name):
+            if isinstance(expr.slice, ast.Slice) or expr.value.id not in self._bound:
+                return UNBOUNDED
+            return self._elements.get(expr.value.id)
+        if isinstance(expr, ast.Call) and isinstance(expr.func, ast.Name) and not expr.keywords:
+            return self._call_range(expr.func.id, expr.args)
+        return UNBOUNDED
+
+    def _call_range(self, func_name: str, args: list[ast.expr]) -> Optional[ValueRange]:
+        """Range of a builtin call result."""
+        if func_name == "len" and len(args) == 1:
+            return ValueRange(0, None)
+        if func_name == "ord" and len(args) == 1:
+            return ValueRange(0, 0x10FFFF)
+        if func_name == "bool" and len(args) == 1:
+            return ValueRange(0, 1)
+        if func_name == "int" and len(args) == 1:
+            return self._range(args[0])
+        if func_name == "abs" and len(args) == 1:
+            operand = self._range(args[0])
+            if operand is None:
+                return None
+            if operand.low is None or operand.high is None:
+                return ValueRange(0, None)
+            low = 0 if operand.low <= 0 <= operand.high else min(abs(operand.low), abs(operand.high))
+            return ValueRange(low, max(abs(operand.low), abs(operand.high)))
+        if func_name in ("min", "max") and len(args) >= 2:
+            ranges = [self._range(arg) for arg in args]
+            if any(value is None for value in ranges):
+                return None
+            lows = [value.low for value in ranges]  # type: ignore[union-attr]
+            highs = [value.high for value in ranges]  # type: ignore[union-attr]
+            known_lows = [low for low in lows if low is not None]
+            known_highs = [high for high in highs if high is not None]
+            # Any bounded operand bounds min() from above and max() from below
+            if func_name == "min":
+                return ValueRange(None if None in lows else min(known_lows), min(known_highs, default=None))
+            return ValueRange(max(known_lows, default=None), None if None in highs else max(known_highs))
+        return UNBOUNDED
+
+    def _binary_range(
+        self, op: ast.operator, left: Optional[ValueRange], right: Optional[ValueRange]
+    ) -> Optional[ValueRange]:
+        """Range of `left op right`."""
+        if left is None or right is None:
+            return None
+        if isinstance(op, ast.Add):
+            return ValueRange(self._add(left.low, right.low), self._add(left.high, right.high))
+        if isinstance(op, ast.Sub):
+            low = self._add(left.low, self._negate(right.high))
+            return ValueRange(low, self._add(left.high, self._negate(right.low)))
+        if isinstance(op, ast.Mult):
+            if None in (left.low, left.high, right.low, right.high):
+                # Products of non-negative values only grow
+                if left.low is not None and right.low is not None and left.low >= 0 and right.low >= 0:
+                    return ValueRange(left.low * right.low, None)
+                return UNBOUNDED
+            products = [a * b for a in (left.low, left.high) for b in (right.low, right.high)]  # type: ignore[operator]
+            return ValueRange(min(products), max(products))
+
+        divisor = right.low if right.low is not None and right.low == right.high else None
+        if isinstance(op, ast.Mod) and divisor is not None and divisor > 0:
+            # Floor modulo is in [0, d); truncating modulo of a negative value in (-d, 0]
+            non_negative = left.low is not None and left.low >= 0
+            if non_negative and left.high is not None and left.high < divisor:
+                return left
+            return ValueRange(0 if non_negative else -(divisor - 1), divisor - 1)
+        if isinstance(op, ast.FloorDiv) and divisor is not None and divisor > 0:
+            # Floor the low bound and truncate the high bound to cover both divisions
+            low = None if left.low is None else left.low // divisor
+            high = None if left.high is None else (left.high // divisor if left.high >= 0 else -(-left.high // divisor))
+            return ValueRange(low, high)
+        if isinstance(op, ast.BitAnd):
+            masks = [value.high for value in (left, right) if value.low is not None and value.low >= 0]
+            return ValueRange(0, min(masks)) if masks and None not in masks else UNBOUNDED
+        if isinstance(op, ast.RShift) and divisor is not None and 0 <= divisor < 64:
+            return ValueRange(
+                None if left.low is None else left.low >> divisor, None if left.high is None else left.high >> divisor
+            )
+        return UNBOUNDED
+
+    def _union(self, ranges: Iterable[Optional[ValueRange]]) -> Optional[ValueRange]:
+        """Join of the ranges that have a value."""
+        result: Optional[ValueRange] = None
+        for value in ranges:
+            if value is not None:
+                result = value if result is None else result.union(value)
+        return result
+
+    @staticmethod
+    def _constant(expr: ast.expr) -> Optional[int]:
+        """Value of an integer literal, including a negated one."""
+        if isinstance(expr, ast.UnaryOp) and isinstance(expr.op, ast.USub):
+            value = ValueRangeAnalyzer._constant(expr.operand)
+            return None if value is None else -value
+        if isinstance(expr, ast.Constant) and isinstance(expr.value, int) and not isinstance(expr.value, bool):
+            return expr.value
+        return None
+
+    @staticmethod
+    def _add(left: Optional[int], right: Optional[int]) -> Optional[int]:
+        return None if left is None or right is None else left + right
+
+    @staticmethod
+    def _negate(bound: Optional[int]) -> Optional[int]:
+        return None if bound is None else -bound
@@ -0,0 +1,172 @@
+"""Recognition of dict counting idioms.
+
+Python code usually counts with one of
+
+    if k in d:                      d[k] = d.get(k, 0) + e
+        d[k] = d[k] + e
+    else:
+        d[k] = e
+
+which a literal translation turns into up to three hash lookups per update.
+match_dict_update() recognizes both (and `d[k] += e` in the first branch) as
+a DictUpdate: add e to the entry of k, starting from default when k is
+absent. A backend lowers it to a single find-or-insert, for example
+`*map_get_or_insert(d, k, 0) += e` in C or the entry API in Rust.
+
+The key and the increment must be side-effect free and must not read the
+dict, so evaluating them once, before or after the lookup, changes nothing.
+
+Example:
+    >>> update = match_dict_update(ast.parse("d[w] = d.get(w, 0) + 1").body[0])
+    >>> update.container, ast.unparse(update.key), ast.unparse(update.default)
+    ('d', 'w', '0')
+"""
+
+import ast
+from dataclasses import dataclass
+from typing import Optional
+
+
+@dataclass
+class DictUpdate:
+    """`container[key] += increment`, with the entry starting at default when key is absent."""
+
+    container: str
+    key: ast.expr
+    increment: ast.expr
+    default: ast.expr
+
+    @property
+    def default_is_zero(self) -> bool:
+        """Whether the default is the 0 a value-initialized entry starts at."""
+        return _is_number(self.default) and self.default.value == 0  # type: ignore[attr-defined]
+
+
+def match_dict_update(stmt: ast.stmt) -> Optional[DictUpdate]:
+    """Recognize a counting update of one dict entry.
+
+    Args:
+        stmt: Statement to match
+
+    Returns:
+        The update, or None if stmt is not one of the recognized idioms
+    """
+    if isinstance(stmt, ast.Assign):
+        return _match_get_update(stmt)
+    if isinstance(stmt, ast.If):
+        return _match_membership_update(stmt)
+    return None
+
+
+def _match_get_update(stmt: ast.Assign) -> Optional[DictUpdate]:
+    """d[k] = d.get(k, default) + e (or e + d.get(k, default))."""
+    target = _subscript_target(stmt)
+    if target is None or not isinstance(stmt.value, ast.BinOp) or not isinstance(stmt.value.op, ast.Add):
+        return None
+    container, key = target
+    for read, increment in ((stmt.value.left, stmt.value.right), (stmt.value.right, stmt.value.left)):
+        if (
+            isinstance(read, ast.Call)
+            and isinstance(read.func, ast.Attribute)
+            and read.func.attr == "get"
+            and _is_name(read.func.value, container)
+            and len(read.args) == 2
+            and not read.keywords
+            and _same(read.args[0], key)
+            and _is_simple(read.args[1], container)
+            and _is_simple(increment, container)
+        ):
+            return DictUpdate(container, key, increment, read.args[1])
+    return None
+
+
+def _match_membership_update(stmt: ast.If) -> Optional[DictUpdate]:
+    """if k in d: d[k] = d[k] + e (or d[k] += e) else: d[k] = initial."""
+    test = stmt.test
+    if not (
+        isinstance(test, ast.Compare)
+        and len(test.ops) == 1
+        and isinstance(test.ops[0], ast.In)
+        and isinstance(test.comparators[0], ast.Name)
+        and len(stmt.body) == 1
+        and len(stmt.orelse) == 1
+    ):
+        return None
+    container = test.comparators[0].id
+    key = test.left
+    if not _is_simple(key, container):
+        return None
+
+    # Present: d[k] = d[k] + e, d[k] = e + d[k] or d[k] += e
+    update = stmt.body[0]
+    increment: Optional[ast.expr] = None
+    if isinstance(update, ast.AugAssign) and isinstance(update.op, ast.Add):
+        if _is_entry(update.target, container, key):
+            increment = update.value
+    elif isinstance(update, ast.Assign) and _assigns_entry(update, container, key):
+        value = update.value
+        if isinstance(value, ast.BinOp) and isinstance(value.op, ast.Add):
+            if _is_entry(value.left, container, key):
+                increment = value.right
+            elif _is_entry(value.right, container, key):
+                increment = value.left
+    if increment is None or not _is_simple(increment, container):
+        return None
+
+    # Absent: d[k] = initial, so the entry starts at initial - e
+    initial_stmt = stmt.orelse[0]
+    if not (isinstance(initial_stmt, ast.Assign) and _assigns_entry(initial_stmt, container, key)):
+        return None
+    initial = initial_stmt.value
+    if _same(initial, increment):
+        default: ast.expr = ast.Constant(0)
+    elif _is_number(initial) and _is_number(increment):
+        default = ast.Constant(initial.value - increment.value)  # type: ignore[attr-defined]
+    else:
+        return None
+    return DictUpdate(container, key, increment, ast.copy_location(default, initial))
+
+
+def _subscript_target(stmt: ast.Assign) -> Optional[tuple[str, ast.expr]]:
+    """The (dict name, key) of `name[key] = ...`, or None."""
+    if len(stmt.targets) != 1:
+        return None
+    target = stmt.targets[0]
+    if isinstance(target, ast.Subscript) and isinstance(target.value, ast.Name) and _is_simple(target.slice, ""):
+        return target.value.id, target.slice
+    return None
+
+
+def _assigns_entry(stmt: ast.Assign, container: str, key: ast.expr) -> bool:
+    """Whether stmt is `container[key] = ...`."""
+    target = _subscript_target(stmt)
+    return target is not None and target[0] == container and _same(target[1], key)
+
+
+def _is_entry(node: ast.expr, container: str, key: ast.expr) -> bool:
+    """Whether node is container[key]."""
+    return isinstance(node, ast.Subscript) and _is_name(node.value, container) and _same(node.slice, key)
+
+
+def _is_name(node: ast.expr, name: str) -> bool:
+    return isinstance(node, ast.Name) and node.id == name
+
+
+def _is_number(node: ast.expr) -> bool:
+    return isinstance(node, ast.Constant) and type(node.value) in (int, float)
+
+
+def _is_simple(node: ast.expr, container: str) -> bool:
+    """Whether node is names, constants and arithmetic only, without reading container."""
+    for child in ast.walk(node):
+        if isinstance(child, ast.Name):
+            if child.id == container:
+                return False
+        elif not isinstance(child, (ast.Constant, ast.BinOp, ast.UnaryOp, ast.operator, ast.unaryop, ast.expr_context)):
+            return False
+    return True
+
+
+def _same(left: ast.expr, right: ast.expr) -> bool:
+    """Structural equality, ignoring source positions."""
+    return ast.dump(left) == ast.dump(right)
@@ -0,0 +1,272 @@
+"""Escape analysis for list allocations in the Static IR.
+
+Finds list literals and range comprehensions whose result never outlives the
+function that creates it and never grows past its initial size, so a backend
+can place the vector's storage on the stack instead of the heap:
+
+    - the list is assigned to a local variable and only ever read, indexed,
+      stored into, measured with len(), tested with `in`, iterated over, or
+      passed to a user function whose parameter is itself non-capturing
+    - it is never returned, aliased to another variable, stored inside another
+      container, passed to print() or an unknown function, or appended to
+    - its element count is known at compile time and at most
+      MAX_STACK_LIST_ELEMENTS
+
+Parameter summaries are computed interprocedurally (optimistically, to a
+fixpoint), so recursive helpers such as an in-place quicksort do not make
+their argument escape.
+
+Eligible allocation sites get STACK_ALLOCATE in
+IRNode.annotations.optimization_hints and their capacity in
+intelligence_layer_data["stack_capacity"].
+
+Example:
+    >>> ir_module = build_ir_from_code(source_code)
+    >>> annotate_stack_allocations(ir_module)
+"""
+
+import ast
+from dataclasses import dataclass, field
+from typing import Optional
+
+from .static_ir import (
+    IRAssignment,
+    IRComprehension,
+    IRDataType,
+    IRExpression,
+    IRFunction,
+    IRFunctionCall,
+    IRLiteral,
+    IRModule,
+    IRNode,
+    IRVariable,
+    IRVariableReference,
+)
+
+STACK_ALLOCATE = "stack_allocate"
+
+# Largest list (in elements) worth a stack buffer; keeps frames small
+MAX_STACK_LIST_ELEMENTS = 256
+
+# Calls that only read or write elements of their first argument
+_NOCAPTURE_CALLS = {"__getitem__", "__setitem__", "__contains__", "len"}
+
+# Methods that may reallocate their receiver's storage
+_GROWING_METHODS = {"__method_append__", "__method_extend__", "__method_insert__"}
+
+
+@dataclass
+class _ListUses:
+    """Variables of one function that escape it or grow in it."""
+
+    escapes: set[str] = field(default_factory=set)
+    grows: set[str] = field(default_factory=set)
+
+    def captured(self) -> set[str]:
+        """Variables whose storage must stay on the heap."""
+        return self.escapes | self.grows
+
+
+class EscapeAnalyzer:
+    """Decides which list allocations may live on the stack."""
+
+    def __init__(self) -> None:
+        """Initialize the analyzer."""
+        # Function name -> indices of parameters that escape or grow
+        self.capturing_parameters: dict[str, set[int]] = {}
+
+    def analyze(self, ir_module: IRModule) -> list[tuple[IRExpression, int]]:
+        """Find the stack-allocatable list sites of a module.
+
+        Args:
+            ir_module: Static IR module
+
+        Returns:
+            (list literal or comprehension, element capacity) pairs
+        """
+        self._summarize_parameters(ir_module)
+        global_names = {variable.name for variable in ir_module.global_variables}
+
+        sites: list[tuple[IRExpression, int]] = []
+        for function in ir_module.functions:
+            uses = self._collect_uses(function)
+            excluded = uses.captured() | global_names | {param.name for param in function.parameters}
+            for node in _walk(function):
+                if isinstance(node, IRAssignment) and node.value is not None and node.target.name not in excluded:
+                    capacity = self._stack_capacity(node.value, node.target.name)
+                    if capacity is not None:
+                        sites.append((node.value, capacity))
+        return sites
+
+    def _summarize_parameters(self, ir_module: IRModule) -> None:
+        """Compute which parameters of each function capture their argument.
+
+        Starts from "no parameter captures" and grows the sets until stable,
+        so mutual and self recursion resolve to the least solution.
+        """
+        self.capturing_parameters = {function.name: set() for function in ir_module.functions}
+        changed = True
+        while changed:
+            changed = False
+            for function in ir_module.functions:
+                captured = self._collect_uses(function).captured()
+                indices = {i for i, param in enumerate(function.parameters) if param.name in captured}
+                if indices != self.capturing_parameters[function.name]:
+                    self.capturing_parameters[function.name] = indices
+                    changed = True
+
+    def _collect_uses(self, function: IRFunction) -> _ListUses:
+        """Record every variable of a function used in a capturing position."""
+        uses = _ListUses()
+        for stmt in function.body:
+            self._scan(stmt, uses)
+        return uses
+
+    def _scan(self, node: IRNode, uses: _ListUses) -> None:
+        """Scan a node; any variable reference not in a known-safe position escapes."""
+        if isinstance(node, IRVariableReference):
+            uses.escapes.add(node.variable.name)
+        elif isinstance(node, IRFunctionCall):
+            for index, arg in enumerate(node.arguments):
+                if isinstance(arg, IRVariableReference):
+                    self._scan_argument(node.function_name, index, arg.variable.name, uses)
+                else:
+                    self._scan(arg, uses)
+        elif isinstance(node, IRLiteral):
+            # Container elements are not IR children
+            if isinstance(node.value, list):
+                for element in node.value:
+                    if isinstance(element, IRNode):
+                        self._scan(element, uses)
+        elif isinstance(node, IRComprehension):
+            uses.escapes.update(_escaping_names(node.ast_node))
+        elif not isinstance(node, IRVariable):
+            for child in node.children:
+                self._scan(child, uses)
+
+    def _scan_argument(self, callee: str, index: int, name: str, uses: _ListUses) -> None:
+        """Classify a variable passed directly as a call argument."""
+        if index == 0 and callee in _NOCAPTURE_CALLS:
+            return
+        if index == 0 and callee in _GROWING_METHODS:
+            uses.grows.add(name)
+        elif callee not in self.capturing_parameters or index in self.capturing_parameters[callee]:
+            uses.escapes.add(name)
+
+    def _stack_capacity(self, value: IRExpression, target: str) -> Optional[int]:
+        """Return the element count of an eligible allocation, or None."""
+        if isinstance(value, IRLiteral):
+            elements = value.value
+            if value.result_type.base_type != IRDataType.LIST or not isinstance(elements, list):
+                return None
+            if not all(
+                isinstance(element, IRExpression) and element.result_type.base_type == IRDataType.INT
+                for element in elements
+            ):
+                return None
+            # The storage is reset before the elements are evaluated
+            if any(_references(element, target) for element in elements):
+                return None
+            count = len(elements)
+        elif isinstance(value, IRComprehension) and isinstance(value.ast_node, ast.ListComp):
+            count_or_none = _range_comprehension_length(value.ast_node)
+            names = {child.id for child in ast.walk(value.ast_node) if isinstance(child, ast.Name)}
+            if count_or_none is None or target in names:
+                return None
+            count = count_or_none
+        else:
+            return None
+
+        if not 0 < count <= MAX_STACK_LIST_ELEMENTS:
+            return None
+        return count
+
+
+def annotate_stack_allocations(ir_module: IRModule) -> list[tuple[IRExpression, int]]:
+    """Mark the list allocations of an IR module that may live on the stack.
+
+    Args:
+        ir_module: Static IR module, annotated in place
+
+    Returns:
+        The annotated (allocation site, capacity) pairs
+    """
+    sites = EscapeAnalyzer().analyze(ir_module)
+    for site, capacity in sites:
+        site.annotations.optimization_hints.append(STACK_ALLOCATE)
+        site.annotations.intelligence_layer_data["stack_capacity"] = capacity
+    return sites
+
+
+def _walk(node: IRNode) -> list[IRNode]:
+    """Return node and all of its IR descendants."""
+    nodes = [node]
+    for child in node.children:
+        nodes.extend(_walk(child))
+    return nodes
+
+
+def _references(node: IRNode, name: str) -> bool:
+    """Check whether an expression reads the given variable."""
+    if isinstance(node, IRVariableReference) and node.variable.name == name:
+        return True
+    if isinstance(node, IRLiteral) and isinstance(node.value, list):
+        if any(isinstance(element, IRNode) and _references(element, name) for element in node.value):
+            return True
+    if isinstance(node, IRComprehension):
+        return any(isinstance(child, ast.Name) and child.id == name for child in ast.walk(node.ast_node))
+    return any(_references(child, name) for child in node.children)
+
+
+def _escaping_names(comprehension: ast.expr) -> set[str]:
+    """Names a comprehension uses other than by iterating, indexing or len()."""
+    safe: set[int] = set()
+    for child in ast.walk(comprehension):
+        if isinstance(child, ast.comprehension) and isinstance(child.iter, ast.Name):
+            safe.add(id(child.iter))
+        elif isinstance(child, ast.Subscript) and isinstance(child.value, ast.Name):
+            safe.add(id(child.value))
+        elif (
+            isinstance(child, ast.Call)
+            and isinstance(child.func, ast.Name)
+            and child.func.id == "len"
+            and len(child.args) == 1
+            and isinstance(child.args[0], ast.Name)
+        ):
+            safe.add(id(child.args[0]))
+            safe.add(id(child.func))
+
+    # Comprehension targets are fresh scalars, not uses
+    targets = {
+        target.id
+        for generator in ast.walk(comprehension)
+        if isinstance(generator, ast.comprehension)
+        for target in ast.walk(generator.target)
+        if isinstance(target, ast.Name)
+    }
+    return {
+        child.id
+        for child in ast.walk(comprehension)
+        if isinstance(child, ast.Name) and id(child) not in safe and child.id not in targets
+    }
+
+
+def _range_comprehension_length(node: ast.ListComp) -> Optional[int]:
+    """Upper bound on a [... for x in range(constants)] comprehension's length."""
+    if len(node.generators) != 1:
+        return None
+    iterable = node.generators[0].iter
+    if not (isinstance(iterable, ast.Call) and isinstance(iterable.func, ast.Name) and iterable.func.id == "range"):
+        return None
+    if not 1 <= len(iterable.args) <= 3:
+        return None
+    try:
+        bounds = [ast.literal_eval(arg) for arg in iterable.args]
+    except ValueError:
+        return None
+    if not all(isinstance(bound, int) and not isinstance(bound, bool) for bound in bounds):
+        return None
+    if len(bounds) == 3 and bounds[2] == 0:
+        return None
+    # Filters can only shorten it
+    return len(range(*bounds))
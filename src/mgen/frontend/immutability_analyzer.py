@@ -3,10 +3,15 @@
 Analyzes Python functions to determine parameter mutability characteristics.
 This is a backend-agnostic analysis - backends interpret results according to
 their own semantics (e.g., Rust uses &T vs &mut T, C++ uses const& vs &).
+
+borrowable_parameters() narrows the read-only parameters to those a backend
+may pass by reference without copying: every use reads the argument in place
+and none lets it outlive the call.
 """
 
 import ast
 from enum import Enum
+from typing import Optional, Union
 
 
 class MutabilityClass(Enum):
@@ -53,6 +58,9 @@ class ImmutabilityAnalyzer:
         "symmetric_difference_update",
     }
 
+    # Builtins that only read their arguments
+    READING_BUILTINS = {"len", "print", "sum", "min", "max", "any", "all", "str"}
+
     def __init__(self) -> None:
         """Initialize the analyzer."""
         self.mutability_info: dict[str, dict[str, MutabilityClass]] = {}
@@ -236,6 +244,107 @@ class ImmutabilityAnalyzer:
         self.mutability_info = result
         return result
 
+    def borrowable_parameters(self, tree: ast.Module) -> dict[str, set[str]]:
+        """Find the parameters of module-level functions that can be borrowed.
+
+        A parameter is borrowable when it is not MUTABLE, never rebound, and each
+        use reads it in place: subscripted (without storing through the
+        subscript), iterated, passed to a reading builtin, compared, formatted,
+        used as the right operand of an operator, as the receiver of a
+        non-mutating method, or as a positional argument to a borrowable
+        parameter of another module function. Returning or assigning it whole
+        is not allowed, so a borrowed argument never escapes the call.
+
+        Args:
+            tree: Module AST
+
+        Returns:
+            Dictionary mapping function names to their borrowable parameter names
+        """
+        functions = {node.name: node for node in tree.body if isinstance(node, ast.FunctionDef)}
+        mutability = {name: self.analyze_function(func) for name, func in functions.items()}
+        parents: dict[ast.AST, ast.AST] = {}
+        for func in functions.values():
+            for node in ast.walk(func):
+                for child in ast.iter_child_nodes(node):
+                    parents[child] = node
+
+        # Uses that pass the parameter on, checked against the callees' results below
+        forwarded: dict[tuple[str, str], list[tuple[str, int]]] = {}
+        borrowable: dict[str, set[str]] = {}
+        for name, func in functions.items():
+            forwarded_params = [arg.arg for arg in func.args.args]
+            if func.args.vararg or func.args.kwarg:
+                forwarded_params = []
+            candidates = {
+                param for param in forwarded_params if mutability[name].get(param) != MutabilityClass.MUTABLE
+            }
+            for node in ast.walk(func):
+                if not (isinstance(node, ast.Name) and node.id in candidates):
+                    continue
+                use = self._borrowed_use(node, parents, functions)
+                if use is None:
+                    candidates.discard(node.id)
+                elif isinstance(use, tuple):
+                    forwarded.setdefault((name, node.id), []).append(use)
+            borrowable[name] = candidates
+
+        # Greatest fixpoint: recursion passing a parameter to itself stays borrowable
+        changed = True
+        while changed:
+            changed = False
+            for (name, param), callees in forwarded.items():
+                if param not in borrowable[name]:
+                    continue
+                for callee, position in callees:
+                    callee_params = functions[callee].args.args
+                    if position >= len(callee_params) or callee_params[position].arg not in borrowable[callee]:
+                        borrowable[name].discard(param)
+                        changed = True
+                        break
+        return borrowable
+
+    def _borrowed_use(
+        self, name: ast.Name, parents: dict[ast.AST, ast.AST], functions: dict[str, ast.FunctionDef]
+    ) -> Optional[Union[bool, tuple[str, int]]]:
+        """Classify one use of a parameter for borrowable_parameters().
+
+        Returns:
+            True for an in-place read, (callee, position) for an argument to a
+            module function, None for a use that rebinds, mutates or lets it escape
+        """
+        if not isinstance(name.ctx, ast.Load):
+            return None
+        node: ast.AST = name
+        parent = parents.get(node)
+        # Element reads: the container itself stays in place
+        while isinstance(parent, ast.Subscript) and parent.value is node:
+            node, parent = parent, parents.get(parent)
+        if node is not name:
+            if not isinstance(node.ctx, ast.Load):  # type: ignore[attr-defined]
+                return None
+            if isinstance(parent, ast.Attribute) and parent.attr in self.MUTATING_METHODS:
+                return None
+            return True
+
+        if isinstance(parent, ast.Attribute):
+            call = parents.get(parent)
+            if isinstance(call, ast.Call) and call.func is parent and parent.attr not in self.MUTATING_METHODS:
+                return True
+            return None
+        if isinstance(parent, (ast.For, ast.comprehension)) and parent.iter is node:
+            return True
+        if isinstance(parent, (ast.Compare, ast.FormattedValue)):
+            return True
+        if isinstance(parent, ast.BinOp) and parent.right is node:
+            return True
+        if isinstance(parent, ast.Call) and node in parent.args and isinstance(parent.func, ast.Name):
+            if parent.func.id in functions:
+                return (parent.func.id, parent.args.index(node))  # type: ignore[arg-type]
+            if parent.func.id in self.READING_BUILTINS:
+                return True
+        return None
+
     def get_parameter_mutability(self, func_name: str, param_name: str) -> MutabilityClass:
         """Get mutability classification for a specific parameter.
 
@@ -0,0 +1,671 @@
+"""Optimization passes over the Static IR.
+
+A backend lowering the Static IR sees each container and string operation as
+an opaque runtime call, so its own optimizer can neither move nor merge them.
+These passes rewrite the IR before lowering:
+
+    - LoopInvariantCodeMotion: pure builtin calls (len(), string methods,
+      dict reads) whose operands do not change in a loop are computed once in
+      a temporary before it, including the end of a range loop, which is
+      otherwise re-evaluated on every iteration
+    - CommonSubexpressionElimination: a pure call repeated within a statement
+      is computed once, and `d[k] = d[k] <op> e` on a dict becomes
+      __update_item__(d, k, value), which looks the key up once and reads
+      (__current_item__) and writes the value through that slot
+    - StrengthReduction: `i * c` in a range loop with constant step, where c
+      does not change in the loop, becomes a temporary advanced by step * c at
+      the top of each iteration
+
+Only calls that cannot fail are moved, so computing one before a loop that
+never runs, or outside the branch that guarded it, changes no behavior. A
+container read is invariant only if the loop performs no mutation and no
+unknown call that could reach a container of the same kind, which also
+covers aliases.
+
+Example:
+    >>> ir_module = build_ir_from_code(source_code)
+    >>> IRPassManager.default().run(ir_module)
+    {'licm': 2, 'cse': 1, 'strength_reduction': 1}
+"""
+
+import ast
+from typing import Any, Optional
+
+from .static_ir import (
+    IRAssignment,
+    IRBinaryOperation,
+    IRComprehension,
+    IRDataType,
+    IRExpression,
+    IRExpressionStatement,
+    IRFor,
+    IRFunction,
+    IRFunctionCall,
+    IRIf,
+    IRLiteral,
+    IRModule,
+    IRNode,
+    IRReturn,
+    IRStatement,
+    IRType,
+    IRTypeCast,
+    IRVariable,
+    IRVariableReference,
+    IRWhile,
+)
+
+# Calls without side effects that cannot fail, so they may be computed early
+PURE_CALLS = {
+    "len",
+    "abs",
+    "min",
+    "max",
+    "__contains__",
+    "__method_lower__",
+    "__method_upper__",
+    "__method_strip__",
+    "__method_replace__",
+    "__method_split__",
+    "__method_startswith__",
+    "__method_endswith__",
+    "__method_keys__",
+    "__method_values__",
+}
+
+# Calls that do not modify their arguments (list indexing can fail, so it is not pure)
+READING_CALLS = PURE_CALLS | {"print", "__getitem__", "__set_get_nth__", "__method_join__", "__current_item__"}
+
+# Operators that cannot trap (division by zero is undefined behavior in LLVM)
+PURE_OPERATORS = {"+", "-", "*", "<", "<=", ">", ">=", "==", "!=", "and", "or", "&", "|", "^", "<<", ">>"}
+
+_CONTAINER_TYPES = {IRDataType.LIST, IRDataType.DICT, IRDataType.SET}
+
+# Result types a temporary can hold (lists also need their element type)
+_TEMPORARY_TYPES = {IRDataType.INT, IRDataType.FLOAT, IRDataType.BOOL, IRDataType.STRING, IRDataType.LIST}
+
+
+class IRPass:
+    """A rewrite of the IR functions of a module, in place."""
+
+    name = "pass"
+
+    def run_on_function(self, function: IRFunction, temporaries: "_Temporaries") -> int:
+        """Rewrite one function and return the number of rewrites."""
+        raise NotImplementedError
+
+
+class IRPassManager:
+    """Runs a sequence of IR passes over every function of a module."""
+
+    def __init__(self, passes: list[IRPass]):
+        """Initialize the pass manager.
+
+        Args:
+            passes: Passes to run, in order
+        """
+        self.passes = passes
+
+    @classmethod
+    def default(cls) -> "IRPassManager":
+        """The standard pipeline: LICM, then CSE, then strength reduction."""
+        return cls([LoopInvariantCodeMotion(), CommonSubexpressionElimination(), StrengthReduction()])
+
+    def run(self, ir_module: IRModule) -> dict[str, int]:
+        """Run the passes over an IR module, rewriting it in place.
+
+        Returns:
+            Number of rewrites made by each pass, by pass name
+        """
+        counts = {ir_pass.name: 0 for ir_pass in self.passes}
+        for function in ir_module.functions:
+            temporaries = _Temporaries(function)
+            for ir_pass in self.passes:
+                counts[ir_pass.name] += ir_pass.run_on_function(function, temporaries)
+        return counts
+
+
+class LoopInvariantCodeMotion(IRPass):
+    """Compute pure calls whose operands a loop does not change once before it."""
+
+    name = "licm"
+
+    def run_on_function(self, function: IRFunction, temporaries: "_Temporaries") -> int:
+        """Hoist loop-invariant pure calls out of every loop of a function."""
+        return self._run_on_block(function, function.body, temporaries)
+
+    def _run_on_block(self, owner: IRNode, block: list[IRStatement], temporaries: "_Temporaries") -> int:
+        count = 0
+        index = 0
+        while index < len(block):
+            stmt = block[index]
+            hoisted: list[IRStatement] = []
+            if isinstance(stmt, (IRFor, IRWhile)):
+                hoisted = self._hoist(stmt, temporaries)
+                for offset, assignment in enumerate(hoisted):
+                    _insert_statement(owner, block, index + offset, assignment)
+                index += len(hoisted)
+                count += len(hoisted)
+            # Inner loops hoist what varies in the outer loop but not in themselves
+            for inner in _statement_blocks(stmt):
+                count += self._run_on_block(stmt, inner, temporaries)
+            index += 1
+        return count
+
+    def _hoist(self, loop: IRStatement, temporaries: "_Temporaries") -> list[IRStatement]:
+        """Replace the invariant pure calls evaluated on every iteration of a loop by temporaries."""
+        effects = _LoopEffects(loop)
+        slots = []
+        if isinstance(loop, IRWhile):
+            slots.append((loop, "condition", None))
+        else:
+            assert isinstance(loop, IRFor)
+            slots.append((loop, "end", None))
+            if loop.step is not None:
+                slots.append((loop, "step", None))
+        for stmt in loop.body:  # type: ignore[attr-defined]
+            slots.extend(_statement_slots(stmt, recursive=True))
+
+        found = [call for holder, attr, index in slots for call in _invariant_calls(holder, attr, index, effects)]
+        # Keys before any rewrite, which changes the keys of enclosing expressions
+        keys = [_key(expr) for _, _, _, expr in found]
+        candidates: dict[tuple[Any, ...], IRExpression] = {}
+        for key, (_, _, _, expr) in zip(keys, found):
+            assert key is not None
+            candidates.setdefault(key, expr)
+
+        # Smallest first, so a hoisted expression can use the temporaries of the ones it contains
+        hoisted: dict[tuple[Any, ...], IRVariable] = {}
+        assignments: list[IRStatement] = []
+        for key, expr in sorted(candidates.items(), key=lambda item: len(_walk_expression(item[1]))):
+            pending = list(_expression_slots(expr))
+            while pending:
+                parent, attr, index = pending.pop()
+                inner = _get(parent, attr, index)
+                inner_key = _key(inner)
+                if inner_key in hoisted:
+                    _replace(parent, attr, index, IRVariableReference(hoisted[inner_key], inner.location))
+                else:
+                    pending.extend(_expression_slots(inner))
+            variable = temporaries.new("licm", expr.result_type)
+            hoisted[key] = variable
+            assignments.append(IRAssignment(variable, expr, expr.location))
+        for key, (parent, attr, index, expr) in zip(keys, found):
+            assert key is not None
+            _replace(parent, attr, index, IRVariableReference(hoisted[key], expr.location))
+        return assignments
+
+
+class CommonSubexpressionElimination(IRPass):
+    """Compute repeated pure calls of a statement once; fuse dict read-modify-writes."""
+
+    name = "cse"
+
+    def run_on_function(self, function: IRFunction, temporaries: "_Temporaries") -> int:
+        """Eliminate common subexpressions in every statement of a function."""
+        return self._run_on_block(function, function.body, temporaries)
+
+    def _run_on_block(self, owner: IRNode, block: list[IRStatement], temporaries: "_Temporaries") -> int:
+        count = 0
+        index = 0
+        while index < len(block):
+            if self._fuse_item_update(owner, block, index):
+                count += 1
+            assignments = self._share_repeated_calls(block[index], temporaries)
+            for offset, assignment in enumerate(assignments):
+                _insert_statement(owner, block, index + offset, assignment)
+            index += len(assignments)
+            count += len(assignments)
+            for inner in _statement_blocks(block[index]):
+                count += self._run_on_block(block[index], inner, temporaries)
+            index += 1
+        return count
+
+    def _share_repeated_calls(self, stmt: IRStatement, temporaries: "_Temporaries") -> list[IRStatement]:
+        """Move pure calls occurring more than once in a statement into temporaries."""
+        slots = _statement_slots(stmt, recursive=False)
+        if isinstance(stmt, IRWhile):
+            # The condition is re-evaluated on every iteration
+            slots = []
+        roots = [_get(holder, attr, index) for holder, attr, index in slots]
+        # Another call could change what the repeated call reads; the statement's own call runs last
+        for root in roots:
+            calls = _walk_expression(root)
+            if isinstance(stmt, IRExpressionStatement) and calls and calls[0] is root:
+                calls = calls[1:]
+            if any(isinstance(node, IRFunctionCall) and node.function_name not in READING_CALLS for node in calls):
+                return []
+
+        occurrences: dict[tuple[Any, ...], list[tuple[IRNode, str, Optional[int], IRExpression]]] = {}
+        for holder, attr, index in slots:
+            for found in _pure_calls(holder, attr, index):
+                key = _key(found[3])
+                assert key is not None
+                occurrences.setdefault(key, []).append(found)
+
+        assignments: list[IRStatement] = []
+        for found_list in occurrences.values():
+            if len(found_list) < 2:
+                continue
+            expr = found_list[0][3]
+            variable = temporaries.new("cse", expr.result_type)
+            assignments.append(IRAssignment(variable, expr, expr.location))
+            for parent, attr, index, _ in found_list:
+                _replace(parent, attr, index, IRVariableReference(variable, expr.location))
+        return assignments
+
+    def _fuse_item_update(self, owner: IRNode, block: list[IRStatement], index: int) -> bool:
+        """Rewrite `d[k] = <value reading d[k]>` on a dict into a single-lookup __update_item__."""
+        stmt = block[index]
+        if not isinstance(stmt, IRExpressionStatement):
+            return False
+        call = stmt.expression
+        if not (isinstance(call, IRFunctionCall) and call.function_name == "__setitem__" and len(call.arguments) == 3):
+            return False
+        container, key, value = call.arguments
+        if not (
+            isinstance(container, IRVariableReference)
+            and container.result_type.base_type == IRDataType.DICT
+            and _key(key) is not None
+        ):
+            return False
+
+        name = container.variable.name
+        reads = []
+        for node in _walk_expression(value):
+            if isinstance(node, IRFunctionCall) and node.function_name not in READING_CALLS:
+                return False
+            if (
+                isinstance(node, IRFunctionCall)
+                and node.function_name == "__getitem__"
+                and isinstance(node.arguments[0], IRVariableReference)
+                and node.arguments[0].variable.name == name
+                and _key(node.arguments[1]) == _key(key)
+            ):
+                reads.append(node)
+        if not reads:
+            return False
+        # The slot must stay valid while the value is computed: nothing else may touch the dict
+        read_ids = {id(read.arguments[0]) for read in reads}
+        if any(
+            isinstance(node, IRVariableReference) and node.variable.name == name and id(node) not in read_ids
+            for node in _walk_expression(value)
+        ):
+            return False
+
+        holder: IRNode = call
+        slots = [(holder, "arguments", 2)]
+        while slots:
+            parent, attr, slot_index = slots.pop()
+            expr = _get(parent, attr, slot_index)
+            if any(expr is read for read in reads):
+                current = IRFunctionCall("__current_item__", [], expr.result_type, expr.location)
+                _replace(parent, attr, slot_index, current)
+            else:
+                slots.extend(_expression_slots(expr))
+
+        update = IRFunctionCall("__update_item__", [container, key, call.arguments[2]], call.result_type, call.location)
+        fused = IRExpressionStatement(update, stmt.location)
+        _replace_statement(owner, block, index, fused)
+        return True
+
+
+class StrengthReduction(IRPass):
+    """Replace loop variable multiplications by a temporary advanced each iteration."""
+
+    name = "strength_reduction"
+
+    def run_on_function(self, function: IRFunction, temporaries: "_Temporaries") -> int:
+        """Reduce `i * c` in every range loop of a function."""
+        return self._run_on_block(function, function.body, temporaries)
+
+    def _run_on_block(self, owner: IRNode, block: list[IRStatement], temporaries: "_Temporaries") -> int:
+        count = 0
+        index = 0
+        while index < len(block):
+            stmt = block[index]
+            for inner in _statement_blocks(stmt):
+                count += self._run_on_block(stmt, inner, temporaries)
+            if isinstance(stmt, IRFor):
+                initializers = self._reduce(stmt, temporaries)
+                for offset, assignment in enumerate(initializers):
+                    _insert_statement(owner, block, index + offset, assignment)
+                index += len(initializers)
+                count += len(initializers)
+            index += 1
+        return count
+
+    def _reduce(self, loop: IRFor, temporaries: "_Temporaries") -> list[IRStatement]:
+        """Reduce the multiplications of one loop; return the initializers to place before it."""
+        step = 1 if loop.step is None else loop.step.value if isinstance(loop.step, IRLiteral) else None
+        if not isinstance(step, int) or isinstance(step, bool) or step == 0:
+            return []
+        if loop.variable.ir_type.base_type != IRDataType.INT or _key(loop.start) is None:
+            return []
+        effects = _LoopEffects(loop)
+        name = loop.variable.name
+        # The loop variable must only change through the loop's own increment
+        if any(
+            isinstance(node, IRAssignment) and node.target.name == name
+            for stmt in loop.body
+            for node in _walk_statement(stmt)
+        ):
+            return []
+
+        reduced: dict[tuple[Any, ...], IRVariable] = {}
+        initializers: list[IRStatement] = []
+        increments: list[IRStatement] = []
+        for stmt in loop.body:
+            for holder, attr, index in _statement_slots(stmt, recursive=True):
+                for parent, child_attr, child_index, factor in self._products(holder, attr, index, name, effects):
+                    factor_key = _key(factor)
+                    assert factor_key is not None
+                    if factor_key not in reduced:
+                        variable = temporaries.new("sr", IRType(IRDataType.INT))
+                        reduced[factor_key] = variable
+                        initializers.append(
+                            IRAssignment(
+                                variable, _int_op(_int_op(loop.start, "-", _int(step)), "*", factor), loop.location
+                            )
+                        )
+                        advance = _int_op(IRVariableReference(variable), "+", _int_op(_int(step), "*", factor))
+                        increments.append(IRAssignment(variable, advance, loop.location))
+                    _replace(parent, child_attr, child_index, IRVariableReference(reduced[factor_key]))
+        for offset, increment in enumerate(increments):
+            _insert_statement(loop, loop.body, offset, increment)
+        return initializers
+
+    def _products(
+        self, holder: IRNode, attr: str, index: Optional[int], name: str, effects: "_LoopEffects"
+    ) -> list[tuple[IRNode, str, Optional[int], IRExpression]]:
+        """Find `name * c` and `c * name` with c invariant in the loop, with their slots."""
+        found = []
+        expr = _get(holder, attr, index)
+        is_product = isinstance(expr, IRBinaryOperation) and expr.operator == "*"
+        if is_product and expr.result_type.base_type == IRDataType.INT:
+            for variable_side, factor in ((expr.left, expr.right), (expr.right, expr.left)):
+                if (
+                    isinstance(variable_side, IRVariableReference)
+                    and variable_side.variable.name == name
+                    and factor.result_type.base_type == IRDataType.INT
+                    and isinstance(factor, (IRLiteral, IRVariableReference))
+                    and effects.invariant(factor)
+                ):
+                    return [(holder, attr, index, factor)]
+        for child_holder, child_attr, child_index in _expression_slots(expr):
+            found.extend(self._products(child_holder, child_attr, child_index, name, effects))
+        return found
+
+
+class _Temporaries:
+    """Fresh local variables of one function."""
+
+    def __init__(self, function: IRFunction):
+        self.function = function
+        self.counter = 0
+
+    def new(self, prefix: str, ir_type: IRType) -> IRVariable:
+        variable = IRVariable(f"__{prefix}_{self.counter}", ir_type)
+        self.counter += 1
+        self.function.add_local_variable(variable)
+        return variable
+
+
+class _LoopEffects:
+    """What a loop may change: variables it assigns and kinds of container it may mutate."""
+
+    def __init__(self, loop: IRStatement):
+        self.assigned: set[str] = set()
+        self.mutated_kinds: set[IRDataType] = set()
+        self.any_mutation = False
+        self.calls_user_functions = False
+        for node in _walk_statement(loop):
+            if isinstance(node, IRAssignment):
+                self.assigned.add(node.target.name)
+            elif isinstance(node, IRFor):
+                self.assigned.add(node.variable.name)
+            elif isinstance(node, IRComprehension):
+                # Its targets are locals too, and its elements may call anything
+                names = {child.id for child in ast.walk(node.ast_node) if isinstance(child, ast.Name)}
+                self.assigned.update(names)
+                self.any_mutation = True
+            elif isinstance(node, IRFunctionCall) and node.function_name not in READING_CALLS:
+                if not node.function_name.startswith("__"):
+                    self.calls_user_functions = True
+                # __setitem__ and methods modify their receiver; user functions any container argument
+                arguments = node.arguments[:1] if node.function_name.startswith("__") else node.arguments
+                for argument in arguments:
+                    if isinstance(argument, IRVariableReference):
+                        if argument.result_type.base_type in _CONTAINER_TYPES:
+                            self.mutated_kinds.add(argument.result_type.base_type)
+                    elif argument.result_type.base_type not in (IRDataType.INT, IRDataType.FLOAT, IRDataType.BOOL):
+                        self.any_mutation = True
+
+    def invariant(self, expr: IRExpression) -> bool:
+        """Check whether an expression reads only what the loop leaves unchanged."""
+        for node in _walk_expression(expr):
+            if not isinstance(node, IRVariableReference):
+                continue
+            variable = node.variable
+            if variable.name in self.assigned:
+                return False
+            # A user function may assign a global
+            if variable.is_global and self.calls_user_functions:
+                return False
+            kind = node.result_type.base_type
+            if kind in _CONTAINER_TYPES and (self.any_mutation or kind in self.mutated_kinds):
+                return False
+        return True
+
+
+def _key(expr: IRNode) -> Optional[tuple[Any, ...]]:
+    """Structural identity of a pure expression, or None if it is not pure."""
+    if isinstance(expr, IRVariableReference):
+        return ("var", expr.variable.name)
+    if isinstance(expr, IRLiteral):
+        if isinstance(expr.value, (list, dict, tuple)):
+            return None
+        return ("literal", expr.result_type.base_type, type(expr.value).__name__, expr.value)
+    if isinstance(expr, IRBinaryOperation):
+        if expr.operator not in PURE_OPERATORS:
+            return None
+        left, right = _key(expr.left), _key(expr.right)
+        if left is None or right is None:
+            return None
+        return ("binary", expr.operator, left, right)
+    if isinstance(expr, IRFunctionCall):
+        if not _is_pure_call(expr):
+            return None
+        arguments = [_key(argument) for argument in expr.arguments]
+        if any(argument is None for argument in arguments):
+            return None
+        return ("call", expr.function_name, *arguments)
+    return None
+
+
+def _is_pure_call(call: IRFunctionCall) -> bool:
+    """Check whether a call is side-effect free and cannot fail (dict reads default to 0)."""
+    if call.function_name == "__getitem__":
+        return bool(call.arguments) and call.arguments[0].result_type.base_type == IRDataType.DICT
+    if call.function_name in ("min", "max"):
+        # min() and max() of a container fail when it is empty
+        return len(call.arguments) >= 2
+    return call.function_name in PURE_CALLS
+
+
+def _storable(ir_type: IRType) -> bool:
+    """Check whether a temporary of this type can be declared."""
+    if ir_type.base_type == IRDataType.LIST:
+        return ir_type.element_type is not None
+    return ir_type.base_type in _TEMPORARY_TYPES
+
+
+def _only_read(holder: IRNode, expr: IRExpression) -> bool:
+    """Check whether a fresh container is used in place by a reading call, so one copy can serve every iteration.
+
+    Bound to a variable, passed on or used as a receiver, it may be mutated or kept across iterations.
+    """
+    if expr.result_type.base_type not in _CONTAINER_TYPES:
+        return True
+    return isinstance(holder, IRFunctionCall) and holder.function_name in READING_CALLS
+
+
+def _invariant_calls(
+    holder: IRNode, attr: str, index: Optional[int], effects: _LoopEffects
+) -> list[tuple[IRNode, str, Optional[int], IRExpression]]:
+    """Find the largest invariant pure expressions containing a call below a slot."""
+    expr = _get(holder, attr, index)
+    if (
+        _key(expr) is not None
+        and _storable(expr.result_type)
+        and _only_read(holder, expr)
+        and any(isinstance(node, IRFunctionCall) for node in _walk_expression(expr))
+        and effects.invariant(expr)
+    ):
+        return [(holder, attr, index, expr)]
+    found = []
+    for child in _expression_slots(expr):
+        found.extend(_invariant_calls(*child, effects))
+    return found
+
+
+def _pure_calls(
+    holder: IRNode, attr: str, index: Optional[int]
+) -> list[tuple[IRNode, str, Optional[int], IRExpression]]:
+    """Find the outermost pure calls below a slot."""
+    expr = _get(holder, attr, index)
+    if isinstance(expr, IRFunctionCall) and _key(expr) is not None and _storable(expr.result_type):
+        return [(holder, attr, index, expr)]
+    found = []
+    for child in _expression_slots(expr):
+        found.extend(_pure_calls(*child))
+    return found
+
+
+def _expression_slots(expr: IRNode) -> list[tuple[IRNode, str, Optional[int]]]:
+    """The (holder, attribute, list index) positions of an expression's operands."""
+    if isinstance(expr, IRBinaryOperation):
+        return [(expr, "left", None), (expr, "right", None)]
+    if isinstance(expr, IRTypeCast):
+        return [(expr, "value", None)]
+    if isinstance(expr, IRFunctionCall):
+        return [(expr, "arguments", i) for i in range(len(expr.arguments))]
+    return []
+
+
+def _statement_slots(stmt: IRStatement, recursive: bool) -> list[tuple[IRNode, str, Optional[int]]]:
+    """The expression positions of a statement, and of nested statements if recursive."""
+    slots: list[tuple[IRNode, str, Optional[int]]] = []
+    if isinstance(stmt, IRAssignment) and stmt.value is not None:
+        slots.append((stmt, "value", None))
+    elif isinstance(stmt, IRExpressionStatement):
+        slots.append((stmt, "expression", None))
+    elif isinstance(stmt, IRReturn) and stmt.value is not None:
+        slots.append((stmt, "value", None))
+    elif isinstance(stmt, (IRIf, IRWhile)):
+        slots.append((stmt, "condition", None))
+    elif isinstance(stmt, IRFor):
+        slots.extend([(stmt, "start", None), (stmt, "end", None)])
+        if stmt.step is not None:
+            slots.append((stmt, "step", None))
+    if recursive:
+        for block in _statement_blocks(stmt):
+            for inner in block:
+                slots.extend(_statement_slots(inner, recursive=True))
+    return slots
+
+
+def _statement_blocks(stmt: IRStatement) -> list[list[IRStatement]]:
+    """The statement lists nested in a statement."""
+    if isinstance(stmt, IRIf):
+        return [stmt.then_body, stmt.else_body]
+    if isinstance(stmt, (IRWhile, IRFor)):
+        return [stmt.body]
+    return []
+
+
+def _walk_expression(expr: IRNode) -> list[IRNode]:
+    """Return an expression and all of its operands, including list literal elements."""
+    nodes = [expr]
+    if isinstance(expr, IRLiteral) and isinstance(expr.value, list):
+        for element in expr.value:
+            if isinstance(element, IRNode):
+                nodes.extend(_walk_expression(element))
+            elif isinstance(element, tuple):
+                nodes.extend(node for part in element if isinstance(part, IRNode) for node in _walk_expression(part))
+    for holder, attr, index in _expression_slots(expr):
+        nodes.extend(_walk_expression(_get(holder, attr, index)))
+    return nodes
+
+
+def _walk_statement(stmt: IRStatement) -> list[IRNode]:
+    """Return a statement, its nested statements and all of their expressions."""
+    nodes: list[IRNode] = [stmt]
+    for holder, attr, index in _statement_slots(stmt, recursive=False):
+        nodes.extend(_walk_expression(_get(holder, attr, index)))
+    for block in _statement_blocks(stmt):
+        for inner in block:
+            nodes.extend(_walk_statement(inner))
+    return nodes
+
+
+def _get(holder: IRNode, attr: str, index: Optional[int]) -> IRExpression:
+    value = getattr(holder, attr)
+    return value[index] if index is not None else value  # type: ignore[no-any-return]
+
+
+def _replace(holder: IRNode, attr: str, index: Optional[int], new: IRExpression) -> None:
+    """Replace the expression in a slot, keeping the holder's children in step."""
+    old = _get(holder, attr, index)
+    if index is None:
+        setattr(holder, attr, new)
+    else:
+        getattr(holder, attr)[index] = new
+    for position, child in enumerate(holder.children):
+        if child is old:
+            holder.children[position] = new
+            break
+    new.parent = holder
+
+
+def _insert_statement(owner: IRNode, block: list[IRStatement], index: int, stmt: IRStatement) -> None:
+    """Insert a statement into a block of owner."""
+    block.insert(index, stmt)
+    stmt.parent = owner
+    owner.children.append(stmt)
+
+
+def _replace_statement(owner: IRNode, block: list[IRStatement], index: int, stmt: IRStatement) -> None:
+    """Replace a statement in a block of owner."""
+    old = block[index]
+    block[index] = stmt
+    stmt.parent = owner
+    for position, child in enumerate(owner.children):
+        if child is old:
+            owner.children[position] = stmt
+            break
+
+
+def _int(value: int) -> IRLiteral:
+    return IRLiteral(value, IRType(IRDataType.INT))
+
+
+def _int_op(left: IRExpression, operator: str, right: IRExpression) -> IRExpression:
+    """Build an integer operation, folding literal operands."""
+    if isinstance(left, IRLiteral) and isinstance(right, IRLiteral):
+        values = {"+": left.value + right.value, "-": left.value - right.value, "*": left.value * right.value}
+        return _int(values[operator])
+    if operator == "*" and isinstance(left, IRLiteral) and left.value == 1:
+        return right
+    return IRBinaryOperation(left, operator, right, IRType(IRDataType.INT))
+
+
+def optimize_ir_module(ir_module: IRModule) -> dict[str, int]:
+    """Run the default IR pass pipeline over a module.
+
+    Args:
+        ir_module: Static IR module, rewritten in place
+
+    Returns:
+        Number of rewrites made by each pass, by pass name
+    """
+    return IRPassManager.default().run(ir_module)
@@ -0,0 +1,332 @@
+"""Per-function and per-loop optimization hints for code generation.
+
+Turns the results of the loop analyzer and the performance analyzer's
+structure extractors into hints attached to Static IR nodes
+(IRNode.annotations.optimization_hints), so a backend can spend optimization
+effort where it pays off:
+
+    - FUNCTION_HOT: the function contains a loop nest or is tree-recursive
+    - FUNCTION_COLD: straight-line code only ever called outside loops
+    - LOOP_UNROLL_FULL: an innermost range loop with a small constant trip
+      count and no calls in its body
+    - LOOP_VECTORIZE: a range loop the vectorization detector finds free of
+      control flow, calls, aliasing and loop-carried dependencies (integer
+      reductions excepted)
+
+Range loops the loop analyzer proves free of loop-carried dependencies and
+shared container mutation also get a ParallelLoop plan (reductions, private
+names) in OptimizationHints.parallel, for backends that emit threaded loops.
+
+This is a backend-agnostic analysis - backends map the hints onto their own
+mechanisms (e.g. LLVM function attributes and !llvm.loop metadata, C loop
+pragmas).
+
+Example:
+    >>> ir_module = build_ir_from_code(source_code)
+    >>> annotate_ir_module(ir_module, source_code)
+"""
+
+import ast
+from dataclasses import dataclass, field
+from typing import Optional
+
+from .base import AnalysisContext
+from .optimizers.loop_analyzer import LoopAnalyzer, LoopInfo, LoopType, ParallelLoop, pure_functions
+from .optimizers.vectorization_detector import (
+    VectorizationCandidate,
+    VectorizationConstraint,
+    VectorizationDetector,
+    VectorizationType,
+)
+from .static_ir import IRFor, IRFunction, IRModule, IRNode
+from .verifiers.performance_analyzer import AlgorithmStructureExtractor, ComplexityPatternAnalyzer
+
+FUNCTION_HOT = "hot"
+FUNCTION_COLD = "cold"
+LOOP_UNROLL_FULL = "unroll_full"
+LOOP_VECTORIZE = "vectorize"
+
+# Largest constant trip count worth unrolling completely
+MAX_FULL_UNROLL_TRIP_COUNT = 16
+
+# Builtins that lower to a few instructions rather than a call
+_INLINE_BUILTINS = {"abs", "len", "max", "min", "range"}
+
+# Detector constraints that rule out asserting the loop's iterations independent
+# Augmented assignments whose integer updates may be applied in any order
+_REDUCTION_OPERATORS = (ast.Add, ast.Sub, ast.Mult, ast.BitAnd, ast.BitOr, ast.BitXor)
+
+_VECTORIZE_BLOCKERS = {
+    VectorizationConstraint.ALIASING,
+    VectorizationConstraint.CONTROL_FLOW,
+    VectorizationConstraint.FUNCTION_CALLS,
+    VectorizationConstraint.IRREGULAR_ACCESS,
+    VectorizationConstraint.SIDE_EFFECTS,
+}
+
+
+@dataclass
+class OptimizationHints:
+    """Hints for one module, keyed by function name and loop source line."""
+
+    functions: dict[str, set[str]] = field(default_factory=dict)
+    loops: dict[int, set[str]] = field(default_factory=dict)
+    # Loops whose iterations may run on different threads, keyed by source line
+    parallel: dict[int, ParallelLoop] = field(default_factory=dict)
+
+
+@dataclass
+class _FunctionProfile:
+    """What the analyzers found in one function."""
+
+    max_loop_depth: int
+    recursive_calls: int
+    loops: list[LoopInfo]
+    loop_nodes: dict[int, ast.For]
+    vectorizable_lines: set[int]
+    # (callee, loop depth of the call site)
+    calls: list[tuple[str, int]]
+
+
+class OptimizationHintAnalyzer:
+    """Derives optimization hints from loop structure and call sites."""
+
+    def analyze(self, tree: ast.Module) -> OptimizationHints:
+        """Analyze every top-level function of a module.
+
+        Args:
+            tree: Parsed module
+
+        Returns:
+            Hints per function and per loop
+        """
+        pure = pure_functions(tree)
+        profiles = {
+            node.name: self._profile_function(node, pure) for node in tree.body if isinstance(node, ast.FunctionDef)
+        }
+
+        hints = OptimizationHints()
+        hot = {name for name, profile in profiles.items() if profile.max_loop_depth >= 2 or profile.recursive_calls >= 2}
+
+        # Call sites inside a loop, or anywhere in a hot function, run often
+        call_depths: dict[str, list[int]] = {}
+        for caller, profile in profiles.items():
+            for callee, depth in profile.calls:
+                call_depths.setdefault(callee, []).append(max(depth, 1) if caller in hot else depth)
+
+        for name, profile in profiles.items():
+            function_hints = set()
+            if name in hot:
+                function_hints.add(FUNCTION_HOT)
+            elif self._is_cold(name, profile, call_depths.get(name)):
+                function_hints.add(FUNCTION_COLD)
+            if function_hints:
+                hints.functions[name] = function_hints
+
+            for loop in profile.loops:
+                loop_hints = self._loop_hints(loop, profile.loop_nodes.get(loop.line_number))
+                if not loop_hints and loop.line_number in profile.vectorizable_lines:
+                    loop_hints = {LOOP_VECTORIZE}
+                if loop.parallel_plan is not None:
+                    hints.parallel[loop.line_number] = loop.parallel_plan
+                if loop_hints:
+                    hints.loops[loop.line_number] = loop_hints
+
+        return hints
+
+    def _profile_function(self, node: ast.FunctionDef, pure: set[str]) -> _FunctionProfile:
+        """Run the loop and structure analyzers over one function (pure: the module's pure functions)."""
+        structure = AlgorithmStructureExtractor()
+        structure.visit(node)
+        complexity = ComplexityPatternAnalyzer()
+        complexity.visit(node)
+
+        context = AnalysisContext(source_code="", ast_node=node, metadata={"pure_functions": pure})
+        result = LoopAnalyzer().optimize(context)
+        report = result.metadata.get("report") if result.success else None
+
+        annotations = {arg.arg: arg.annotation for arg in node.args.args if arg.annotation is not None}
+        for child in ast.walk(node):
+            if isinstance(child, ast.AnnAssign) and isinstance(child.target, ast.Name):
+                annotations[child.target.id] = child.annotation
+        int_names = {name for name, annotation in annotations.items() if _annotation_base(annotation) == "int"}
+        list_names = {name for name, annotation in annotations.items() if _annotation_base(annotation) == "list"}
+        vectorization = VectorizationDetector().analyze(node)
+
+        return _FunctionProfile(
+            max_loop_depth=complexity.max_loop_depth,
+            recursive_calls=len(structure.recursive_calls),
+            loops=report.loops_found if report else [],
+            loop_nodes={child.lineno: child for child in ast.walk(node) if isinstance(child, ast.For)},
+            vectorizable_lines={
+                candidate.loop_node.lineno
+                for candidate in vectorization.candidates
+                if self._is_independent(candidate, int_names, list_names)
+            },
+            calls=[(call["function"], call["depth"]) for call in complexity.function_calls],
+        )
+
+    def _is_cold(self, name: str, profile: _FunctionProfile, call_depths: Optional[list[int]]) -> bool:
+        """Check whether a function runs a bounded number of times per program run.
+
+        Functions without loops or recursion, called only from straight-line
+        code, are not worth unrolling or vectorizing for.
+        """
+        if name == "main" or not call_depths:
+            return False
+        if profile.max_loop_depth > 0 or profile.recursive_calls > 0:
+            return False
+        return all(depth == 0 for depth in call_depths)
+
+    def _loop_hints(self, loop: LoopInfo, node: Optional[ast.For]) -> set[str]:
+        """Pick hints for one loop; only innermost range loops get any."""
+        if node is None or loop.loop_type != LoopType.FOR_RANGE or loop.inner_loops:
+            return set()
+        if loop.has_break or loop.has_early_exit:
+            return set()
+
+        # Unrolling around a call only multiplies call sites for the inliner
+        if any(self._is_call(child) for child in ast.walk(node)):
+            return set()
+
+        trip_count = loop.bounds.total_iterations
+        if loop.bounds.is_constant and trip_count is not None and 0 < trip_count <= MAX_FULL_UNROLL_TRIP_COUNT:
+            return {LOOP_UNROLL_FULL}
+        return set()
+
+    def _is_independent(self, candidate: VectorizationCandidate, int_names: set[str], list_names: set[str]) -> bool:
+        """Check whether a detected candidate's iterations may run in any order.
+
+        The detector treats every subscript as an array access, so loops
+        subscripting anything but a list (e.g. dict stores) are left alone.
+        Stores must index with i + c: any other index (a[i] in out[a[i]],
+        2 * i) may hit one element from two iterations. The hint also permits
+        reassociating reductions, so only integer accumulators updated by
+        x op= e or x = x + e qualify: reordering a float sum, or s = s * 2 + e,
+        changes its result.
+        """
+        loop = candidate.loop_node
+        if candidate.constraints & _VECTORIZE_BLOCKERS:
+            return False
+        for child in ast.walk(loop):
+            if isinstance(child, ast.Subscript):
+                base = child.value
+                while isinstance(base, ast.Subscript):
+                    base = base.value
+                if not (isinstance(base, ast.Name) and base.id in list_names):
+                    return False
+        if not (
+            isinstance(loop, ast.For)
+            and isinstance(loop.iter, ast.Call)
+            and isinstance(loop.iter.func, ast.Name)
+            and loop.iter.func.id == "range"
+        ):
+            return False
+        if not isinstance(loop.target, ast.Name):
+            return False
+        index = loop.target.id
+        for child in ast.walk(loop):
+            if isinstance(child, ast.Assign):
+                targets = child.targets
+            elif isinstance(child, (ast.AugAssign, ast.AnnAssign)):
+                targets = [child.target]
+            else:
+                continue
+            for target in targets:
+                if isinstance(target, ast.Subscript) and not _is_offset_of(target.slice, index):
+                    return False
+                if isinstance(target, ast.Name) and not _is_reduction_update(child, target.id):
+                    return False
+        if VectorizationConstraint.DATA_DEPENDENCIES in candidate.constraints:
+            if candidate.vectorization_type not in (VectorizationType.REDUCTION_LOOP, VectorizationType.DOT_PRODUCT):
+                return False
+            for child in ast.walk(loop):
+                accumulator = None
+                if isinstance(child, ast.AugAssign) and isinstance(child.target, ast.Name):
+                    accumulator = child.target.id
+                elif isinstance(child, ast.Assign) and isinstance(child.targets[0], ast.Name):
+                    if _mentions(child.value, child.targets[0].id):
+                        accumulator = child.targets[0].id
+                if isinstance(child, ast.AugAssign) and accumulator is None:
+                    return False
+                if accumulator is not None and accumulator not in int_names:
+                    return False
+        return True
+
+    def _is_call(self, node: ast.AST) -> bool:
+        """Check for a call that is not range() or a builtin lowered inline."""
+        if not isinstance(node, ast.Call):
+            return False
+        return not (isinstance(node.func, ast.Name) and node.func.id in _INLINE_BUILTINS)
+
+
+def _is_offset_of(index: ast.expr, name: str) -> bool:
+    """Check for name, name + c or name - c with c an integer constant."""
+    if isinstance(index, ast.Name):
+        return index.id == name
+    return (
+        isinstance(index, ast.BinOp)
+        and isinstance(index.op, (ast.Add, ast.Sub))
+        and isinstance(index.left, ast.Name)
+        and index.left.id == name
+        and isinstance(index.right, ast.Constant)
+        and type(index.right.value) is int
+    )
+
+
+def _mentions(node: ast.AST, name: str) -> bool:
+    """Check whether node reads the variable name."""
+    return any(isinstance(child, ast.Name) and child.id == name for child in ast.walk(node))
+
+
+def _is_reduction_update(statement: ast.stmt, name: str) -> bool:
+    """Check that an assignment to a scalar carries nothing between iterations but a reduction.
+
+    Fresh values (v = xs[i] * k) and x op= e or x = x + e with e free of x
+    are fine; any other use of the old value (s = s * 2 + e) is a recurrence.
+    """
+    if isinstance(statement, ast.AugAssign):
+        return isinstance(statement.op, _REDUCTION_OPERATORS) and not _mentions(statement.value, name)
+    value = statement.value
+    if value is None or not _mentions(value, name):
+        return True
+    if not (isinstance(value, ast.BinOp) and isinstance(value.op, ast.Add)):
+        return False
+    if isinstance(value.left, ast.Name) and value.left.id == name:
+        return not _mentions(value.right, name)
+    return isinstance(value.right, ast.Name) and value.right.id == name and not _mentions(value.left, name)
+
+
+def _annotation_base(annotation: ast.expr) -> Optional[str]:
+    """Return the outer type name of an annotation (list for list[int])."""
+    if isinstance(annotation, ast.Subscript):
+        annotation = annotation.value
+    return annotation.id if isinstance(annotation, ast.Name) else None
+
+
+def annotate_ir_module(ir_module: IRModule, source_code: str) -> OptimizationHints:
+    """Attach optimization hints to the functions and loops of an IR module.
+
+    Args:
+        ir_module: Static IR built from source_code, annotated in place
+        source_code: Python source the IR was built from
+
+    Returns:
+        The hints that were attached
+    """
+    hints = OptimizationHintAnalyzer().analyze(ast.parse(source_code))
+
+    for ir_function in ir_module.functions:
+        ir_function.annotations.optimization_hints.extend(sorted(hints.functions.get(ir_function.name, ())))
+        _annotate_loops(ir_function, hints)
+
+    return hints
+
+
+def _annotate_loops(node: IRNode, hints: OptimizationHints) -> None:
+    """Attach loop hints to every loop under node, matched by source line."""
+    for child in node.children:
+        if isinstance(child, IRFor) and child.location is not None:
+            child.annotations.optimization_hints.extend(sorted(hints.loops.get(child.location.line, ())))
+        if not isinstance(child, IRFunction):
+            _annotate_loops(child, hints)
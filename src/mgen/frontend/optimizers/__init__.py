@@ -1,13 +1,14 @@
 """Optimizers module for the Intelligence Layer.
 
 This module contains various code optimizers including compile-time evaluation,
-loop optimization, function specialization, and vectorization.
+loop optimization, loop interchange, function specialization, and vectorization.
 """
 
 from .compile_time_evaluator import CompileTimeEvaluator, CompileTimeReport, ConstantValue, OptimizationCandidate
 from .function_specializer import FunctionProfile, FunctionSpecializer, SpecializationReport
 from .function_specializer import SpecializationCandidate as FunctionSpecializationCandidate
 from .loop_analyzer import LoopAnalysisReport, LoopAnalyzer, LoopInfo, LoopOptimization
+from .loop_nest_optimizer import LoopNestOptimizer
 from .vectorization_detector import (
     MemoryAccess,
     VectorizationCandidate,
@@ -26,6 +27,7 @@ __all__ = [
     "LoopAnalysisReport",
     "LoopInfo",
     "LoopOptimization",
+    "LoopNestOptimizer",
     "FunctionSpecializer",
     "SpecializationReport",
     "FunctionProfile",
@@ -5,10 +5,11 @@ simplification capabilities for static Python code optimization.
 """
 
 import ast
+import copy
 import operator as op
 from dataclasses import dataclass, field
 from enum import Enum
-from typing import Any, Optional, cast
+from typing import Any, Optional, Union, cast
 
 from ..base import AnalysisContext, BaseOptimizer, OptimizationLevel, OptimizationResult
 
@@ -78,6 +79,42 @@ class CompileTimeReport:
     limitations: list[str] = field(default_factory=list)
 
 
+@dataclass
+class StringSwitch:
+    """One switch of a string dispatch tree: on the key length, or on the byte at one position."""
+
+    # None switches on the length
+    position: Optional[int]
+    # Case value -> nested switch, or the index of the one key left (which a full compare confirms)
+    cases: dict[int, Union["StringSwitch", int]]
+
+
+@dataclass
+class StringDispatch:
+    """Decision tree built at conversion time that finds a constant string key in O(1).
+
+    The root switches on the length; among keys of equal length each switch
+    picks the byte position that splits them most, until one key remains.
+    A lookup therefore reads the length, a few bytes and compares one key.
+    """
+
+    keys: list[bytes]  # UTF-8
+    root: StringSwitch
+
+
+@dataclass
+class StringMatchChain:
+    """An if/elif chain whose conditions compare one name with string literals."""
+
+    subject: str
+    # Bodies of the matching branches in order, and what runs when no key matches
+    branches: list[list[ast.stmt]]
+    orelse: list[ast.stmt]
+    dispatch: StringDispatch
+    # Branch taken for each key of dispatch (the first branch naming it)
+    key_branches: list[int]
+
+
 class CompileTimeEvaluator(BaseOptimizer):
     """Optimizer for compile-time computation and constant folding."""
 
@@ -159,6 +196,189 @@ class CompileTimeEvaluator(BaseOptimizer):
                 metadata={"error": str(e), "error_type": type(e).__name__},
             )
 
+    def evaluate_list_comprehension(self, node: ast.ListComp, max_elements: int = 4096) -> Optional[list[Any]]:
+        """Evaluate a list comprehension over constant iterables to its element values.
+
+        Each generator must iterate range() with constant arguments or a literal
+        list/tuple, and every condition and the element must fold to a constant
+        once the loop variables are bound. Returns None when that is not the case
+        or the result would exceed max_elements.
+        """
+        saved_constants = self._constants
+        self._constants = {}
+        values: list[Any] = []
+        try:
+            if not self._expand_generators(node, 0, values, max_elements, CompileTimeReport()):
+                return None
+        finally:
+            self._constants = saved_constants
+        return values
+
+    def _expand_generators(
+        self, node: ast.ListComp, index: int, values: list[Any], max_elements: int, report: CompileTimeReport
+    ) -> bool:
+        """Bind generator index's variable to each value in turn, appending folded elements."""
+        if index == len(node.generators):
+            element = self._fold_to_constant(node.elt, report)
+            if element is None or len(values) >= max_elements:
+                return False
+            values.append(element.value)
+            return True
+
+        generator = node.generators[index]
+        if generator.is_async or not isinstance(generator.target, ast.Name):
+            return False
+        items = self._constant_iterable(generator.iter, max_elements, report)
+        if items is None:
+            return False
+
+        for item in items:
+            self._constants[generator.target.id] = ConstantValue(value=item, type_name=type(item).__name__)
+            keep = True
+            for condition in generator.ifs:
+                folded = self._fold_to_constant(condition, report)
+                if folded is None:
+                    return False
+                if not folded.value:
+                    keep = False
+                    break
+            if keep and not self._expand_generators(node, index + 1, values, max_elements, report):
+                return False
+        return True
+
+    def _constant_iterable(self, node: ast.expr, max_elements: int, report: CompileTimeReport) -> Optional[list[Any]]:
+        """Values of range(<constants>) or of a literal list/tuple, or None."""
+        if isinstance(node, (ast.List, ast.Tuple)):
+            items = []
+            for element in node.elts:
+                folded = self._fold_to_constant(element, report)
+                if folded is None:
+                    return None
+                items.append(folded.value)
+            return items
+
+        if not (isinstance(node, ast.Call) and isinstance(node.func, ast.Name) and node.func.id == "range"):
+            return None
+        if node.keywords or not 1 <= len(node.args) <= 3:
+            return None
+        bounds = []
+        for arg in node.args:
+            folded = self._fold_to_constant(arg, report)
+            if folded is None or not isinstance(folded.value, int) or isinstance(folded.value, bool):
+                return None
+            bounds.append(folded.value)
+        if len(bounds) == 3 and bounds[2] == 0:
+            return None
+        span = range(*bounds)
+        if len(span) > max_elements:
+            return None
+        return list(span)
+
+    def build_string_dispatch(self, keys: list[str]) -> StringDispatch:
+        """Build the length-then-byte dispatch tree over distinct constant keys."""
+        encoded = [key.encode("utf-8") for key in keys]
+        by_length: dict[int, list[int]] = {}
+        for index, key in enumerate(encoded):
+            by_length.setdefault(len(key), []).append(index)
+        root = StringSwitch(None, {})
+        for length, indices in sorted(by_length.items()):
+            root.cases[length] = self._split_keys(encoded, indices, length)
+        return StringDispatch(encoded, root)
+
+    def _split_keys(self, keys: list[bytes], indices: list[int], length: int) -> Union[StringSwitch, int]:
+        """Switch on the byte that separates the most of these equal-length keys, recursively."""
+        if len(indices) == 1:
+            return indices[0]
+        # Distinct keys of one length differ somewhere, so some position has two values or more
+        position = max(range(length), key=lambda p: (len({keys[i][p] for i in indices}), -p))
+        groups: dict[int, list[int]] = {}
+        for index in indices:
+            groups.setdefault(keys[index][position], []).append(index)
+        return StringSwitch(
+            position, {byte: self._split_keys(keys, group, length) for byte, group in sorted(groups.items())}
+        )
+
+    def string_match_chain(self, node: ast.If, min_keys: int = 3) -> Optional[StringMatchChain]:
+        """Recognize if s == "a": ... elif s == "b" or s in ("c", "d"): ... over one name s.
+
+        The leading branches whose conditions only compare the same name with
+        string literals (==, or of ==, in a literal tuple/list/set) form the
+        chain; the first branch that does not becomes its else part. Keys named
+        again by a later branch keep the earlier one, as Python would. Returns
+        None for chains naming fewer than min_keys distinct keys.
+        """
+        subject: Optional[str] = None
+        branches: list[list[ast.stmt]] = []
+        keys: list[str] = []
+        key_branches: list[int] = []
+        current: Optional[ast.If] = node
+        orelse: list[ast.stmt] = []
+        while current is not None:
+            matched = self._string_match_keys(current.test)
+            if matched is None or (subject is not None and matched[0] != subject):
+                orelse = [current]
+                break
+            subject = matched[0]
+            for key in matched[1]:
+                if key not in keys:
+                    keys.append(key)
+                    key_branches.append(len(branches))
+            branches.append(current.body)
+            if len(current.orelse) == 1 and isinstance(current.orelse[0], ast.If):
+                current = current.orelse[0]
+            else:
+                orelse = current.orelse
+                current = None
+        if subject is None or len(keys) < min_keys:
+            return None
+        return StringMatchChain(subject, branches, orelse, self.build_string_dispatch(keys), key_branches)
+
+    def _string_match_keys(self, test: ast.expr) -> Optional[tuple[str, list[str]]]:
+        """(name, keys) for name == "k", "k" == name, name in ("k", ...) and or-combinations of them."""
+        if isinstance(test, ast.BoolOp) and isinstance(test.op, ast.Or):
+            parts = [self._string_match_keys(value) for value in test.values]
+            names = {part[0] for part in parts if part is not None}
+            if None in parts or len(names) != 1:
+                return None
+            return names.pop(), [key for part in parts if part is not None for key in part[1]]
+        if not (isinstance(test, ast.Compare) and len(test.ops) == 1):
+            return None
+        left, right = test.left, test.comparators[0]
+        if isinstance(test.ops[0], ast.Eq):
+            if isinstance(right, ast.Name):
+                left, right = right, left
+            if isinstance(left, ast.Name) and isinstance(right, ast.Constant) and isinstance(right.value, str):
+                return left.id, [right.value]
+        if isinstance(test.ops[0], ast.In) and isinstance(left, ast.Name):
+            if isinstance(right, (ast.Tuple, ast.List, ast.Set)) and right.elts:
+                if all(isinstance(e, ast.Constant) and isinstance(e.value, str) for e in right.elts):
+                    return left.id, [cast(ast.Constant, e).value for e in right.elts]
+        return None
+
+    def constant_string_dict(self, node: ast.Dict) -> Optional[tuple[list[str], list[Any]]]:
+        """Keys and values of a dict literal with string literal keys and constant values, or None.
+
+        A repeated key keeps its last value, as in Python.
+        """
+        saved_constants = self._constants
+        self._constants = {}
+        entries: dict[str, Any] = {}
+        try:
+            for key, value in zip(node.keys, node.values):
+                if not (isinstance(key, ast.Constant) and isinstance(key.value, str)):
+                    return None
+                folded = self._fold_to_constant(value, CompileTimeReport())
+                if folded is None:
+                    return None
+                entries[key.value] = folded.value
+        finally:
+            self._constants = saved_constants
+        return list(entries), list(entries.values())
+
+    def _fold_to_constant(self, node: ast.expr, report: CompileTimeReport) -> Optional[ConstantValue]:
+        """Fold a copy of node with the current constants, returning its value if constant."""
+        return self._evaluate_expression(self._optimize_node(copy.deepcopy(node), report))
+
     def _optimize_ast(self, node: ast.AST, report: CompileTimeReport) -> ast.AST:
         """Optimize the AST by performing compile-time evaluation."""
         # Create a copy to avoid modifying the original
@@ -95,6 +95,8 @@ class LoopInfo:
     side_effects: list[str] = field(default_factory=list)
     is_vectorizable: bool = False
     is_parallelizable: bool = False
+    # How the iterations can run concurrently, if is_parallelizable
+    parallel_plan: Optional["ParallelLoop"] = None
     estimated_complexity: str = "O(n)"
 
 
@@ -129,6 +131,22 @@ class LoopAnalysisReport:
     c_compatibility_issues: list[str] = field(default_factory=list)
 
 
+@dataclass
+class ParallelLoop:
+    """A range loop whose iterations may run concurrently, and how."""
+
+    # Scalars only ever updated with x += e (e not reading x)
+    reductions: list[str] = field(default_factory=list)
+    # Names assigned before use in every iteration and not live outside the loop
+    private: list[str] = field(default_factory=list)
+    # Lists stored to only at the loop variable's index
+    written: list[str] = field(default_factory=list)
+    # Every variable name the loop references (for backends' type checks)
+    names: set[str] = field(default_factory=set)
+    # The loop's own and its inner range loops' variables, all integers
+    loop_variables: set[str] = field(default_factory=set)
+
+
 class LoopAnalyzer(BaseOptimizer):
     """Analyzer and optimizer for loop constructs."""
 
@@ -137,6 +155,9 @@ class LoopAnalyzer(BaseOptimizer):
         self._current_nesting = 0
         self._loop_stack: list[LoopInfo] = []
         self._variables_in_scope: dict[str, LoopVariable] = {}
+        # Function enclosing the loops being analyzed, and the module's pure functions
+        self._scope: Optional[ast.FunctionDef] = None
+        self._pure_functions: set[str] = set()
 
     def optimize(self, context: AnalysisContext) -> OptimizationResult:
         """Perform loop analysis and optimization."""
@@ -145,6 +166,10 @@ class LoopAnalyzer(BaseOptimizer):
             self._current_nesting = 0
             self._loop_stack.clear()
             self._variables_in_scope.clear()
+            self._scope = context.ast_node if isinstance(context.ast_node, ast.FunctionDef) else None
+            self._pure_functions = (context.metadata or {}).get("pure_functions") or (
+                pure_functions(context.ast_node) if isinstance(context.ast_node, ast.Module) else set()
+            )
 
             report = LoopAnalysisReport()
 
@@ -199,6 +224,11 @@ class LoopAnalyzer(BaseOptimizer):
             self._analyze_for_loop(node, report)
         elif isinstance(node, ast.While):
             self._analyze_while_loop(node, report)
+        elif isinstance(node, ast.FunctionDef):
+            enclosing, self._scope = self._scope, node
+            for child in ast.iter_child_nodes(node):
+                self._visit_node_for_loops(child, report)
+            self._scope = enclosing
         else:
             # Only visit child nodes if current node is not a loop
             # This prevents double-counting nested loops
@@ -232,7 +262,7 @@ class LoopAnalyzer(BaseOptimizer):
 
         # Check for vectorization potential
         loop_info.is_vectorizable = self._check_vectorizable(loop_info)
-        loop_info.is_parallelizable = self._check_parallelizable(loop_info)
+        loop_info.is_parallelizable = self._check_parallelizable(loop_info, node)
 
         # Estimate complexity
         loop_info.estimated_complexity = self._estimate_loop_complexity(loop_info)
@@ -246,6 +276,9 @@ class LoopAnalyzer(BaseOptimizer):
         if loop_info.is_vectorizable:
             report.vectorizable_loops += 1
 
+        if loop_info.is_parallelizable:
+            report.parallelizable_loops += 1
+
         if loop_info.pattern == LoopPattern.COMPLEX:
             report.complex_loops += 1
 
@@ -470,6 +503,9 @@ class LoopAnalyzer(BaseOptimizer):
         self._analyze_loop_body(node.body, nested_info, report)
         self._current_nesting -= 1
 
+        if isinstance(node, ast.For):
+            nested_info.is_parallelizable = self._check_parallelizable(nested_info, node)
+
         # Add nested loop to report
         report.loops_found.append(nested_info)
         report.total_loops += 1
@@ -527,8 +563,20 @@ class LoopAnalyzer(BaseOptimizer):
 
         return True
 
-    def _check_parallelizable(self, loop_info: LoopInfo) -> bool:
-        """Check if a loop is potentially parallelizable."""
+    def _check_parallelizable(self, loop_info: LoopInfo, node: Optional[ast.For] = None) -> bool:
+        """Check if a loop is potentially parallelizable.
+
+        Range loops get the dependence test of parallel_loop_plan, whose plan
+        (reductions, private names) is kept in parallel_plan; other loops only
+        the coarse checks below.
+        """
+        if node is not None and loop_info.loop_type == LoopType.FOR_RANGE:
+            plan = parallel_loop_plan(node, self._scope, self._pure_functions)
+            if plan is None:
+                return False
+            loop_info.parallel_plan = plan
+            return True
+
         # Basic parallelization requirements
         if loop_info.has_early_exit or loop_info.has_break or loop_info.has_continue:
             return False
@@ -744,3 +792,415 @@ class LoopAnalyzer(BaseOptimizer):
                     safety_analysis[opt_type_key] = False
 
         return safety_analysis
+
+
+# Builtins without side effects that parallel loops and pure functions may call
+PARALLEL_SAFE_BUILTINS = frozenset({"abs", "bool", "float", "int", "len", "max", "min", "range"})
+
+# Statements and expressions a parallel loop body may consist of
+_PARALLEL_STATEMENTS = (ast.Assign, ast.AnnAssign, ast.AugAssign, ast.If, ast.For, ast.Pass)
+_PARALLEL_EXPRESSIONS = (
+    ast.Attribute,
+    ast.BinOp,
+    ast.BoolOp,
+    ast.Call,
+    ast.Compare,
+    ast.Constant,
+    ast.IfExp,
+    ast.Name,
+    ast.Subscript,
+    ast.UnaryOp,
+)
+
+
+def pure_functions(module: ast.Module) -> set[str]:
+    """Find the module's functions that neither mutate shared state nor perform I/O.
+
+    A function is pure if it declares no globals, reads no module-level
+    variable other than constants, stores to no subscript or attribute, calls
+    no methods (math functions excepted) and calls only side-effect-free
+    builtins and other pure functions.
+    """
+    functions = {node.name: node for node in module.body if isinstance(node, ast.FunctionDef)}
+    shared = _mutable_globals(module)
+    pure = set(functions)
+    changed = True
+    while changed:
+        changed = False
+        for name in sorted(pure):
+            if not _has_pure_body(functions[name], pure, shared):
+                pure.discard(name)
+                changed = True
+    return pure
+
+
+# Parameter and result annotations a memo table can store
+_MEMO_KEY_TYPES = frozenset({"int", "bool"})
+_MEMO_RESULT_TYPES = frozenset({"int", "bool", "float"})
+
+
+def memoized_functions(module: ast.Module, automatic: bool) -> set[str]:
+    """Find the module's pure functions whose results a fixed-size table may cache.
+
+    A candidate takes int/bool parameters only and returns int, bool or float;
+    methods, main and generators never qualify. @cache and @lru_cache force a
+    candidate's caching and @lru_cache(maxsize=0) suppresses it, as in Python;
+    with automatic, undecorated candidates that call themselves are cached too.
+    The purity requirement stands either way: a table may evict, so a cached
+    call must be safe to repeat.
+    """
+    pure = pure_functions(module)
+    memoized = set()
+    for node in module.body:
+        if not isinstance(node, ast.FunctionDef) or node.name not in pure or node.name == "main":
+            continue
+        parameters = node.args
+        if parameters.vararg or parameters.kwarg or parameters.kwonlyargs or not parameters.args:
+            continue
+        annotations = [arg.annotation for arg in parameters.args] + [node.returns]
+        names = [annotation.id if isinstance(annotation, ast.Name) else None for annotation in annotations]
+        if any(name not in _MEMO_KEY_TYPES for name in names[:-1]) or names[-1] not in _MEMO_RESULT_TYPES:
+            continue
+        if any(isinstance(child, (ast.Yield, ast.YieldFrom)) for child in ast.walk(node)):
+            continue
+        decorated = _cache_decorator(node)
+        recursive = any(
+            isinstance(child, ast.Call) and isinstance(child.func, ast.Name) and child.func.id == node.name
+            for child in ast.walk(node)
+        )
+        if decorated or (decorated is None and automatic and recursive):
+            memoized.add(node.name)
+    return memoized
+
+
+def _cache_decorator(function: ast.FunctionDef) -> Optional[bool]:
+    """True for @cache / @lru_cache, False for @lru_cache(maxsize=0), None when undecorated."""
+    for decorator in function.decorator_list:
+        call = decorator if isinstance(decorator, ast.Call) else None
+        target = call.func if call else decorator
+        name = target.attr if isinstance(target, ast.Attribute) else target.id if isinstance(target, ast.Name) else None
+        if name not in ("cache", "lru_cache"):
+            continue
+        size = call.args[0] if call and call.args else None
+        for keyword in call.keywords if call else []:
+            if keyword.arg == "maxsize":
+                size = keyword.value
+        return not (isinstance(size, ast.Constant) and size.value == 0)
+    return None
+
+
+def parallel_loop_plan(
+    loop: ast.For, scope: Optional[ast.FunctionDef] = None, pure: Optional[set[str]] = None
+) -> Optional[ParallelLoop]:
+    """Prove the iterations of a range loop independent of each other.
+
+    The test is conservative. Iterations may only share scalars they read but
+    never store, reductions (scalars only updated with x += e or x = x + e)
+    and lists they store to solely at the loop variable's index (a[i] = ...,
+    a[i][j] += ...) and read only there or through len(). Any other name the
+    body stores must be assigned before it is read in every iteration and be
+    unused outside the loop, so each thread can keep its own copy. The body
+    may only call side-effect-free builtins, math functions and pure module
+    functions, and may not break, continue, return or raise. Distinct list
+    names are assumed not to alias, as for vectorization hints.
+
+    Args:
+        loop: The loop
+        scope: Function containing the loop; without it no name can be
+            proven private and no store proven to target a list
+        pure: Module functions known to be pure (see pure_functions)
+
+    Returns:
+        How to run the loop in parallel, or None if that may change its result
+    """
+    pure = pure or set()
+    if not (isinstance(loop.target, ast.Name) and not loop.orelse and _is_range_call(loop.iter)):
+        return None
+    step = loop.iter.args[2] if len(loop.iter.args) == 3 else None
+    if step is not None and not (isinstance(step, ast.Constant) and isinstance(step.value, int) and step.value > 0):
+        return None
+    index = loop.target.id
+
+    # Annotations are types, not values the iterations share
+    annotations = {
+        id(node)
+        for stmt in loop.body
+        for child in ast.walk(stmt)
+        if isinstance(child, ast.AnnAssign)
+        for node in ast.walk(child.annotation)
+    }
+    nodes = [node for stmt in loop.body for node in ast.walk(stmt) if id(node) not in annotations]
+    parents = {child: node for node in nodes for child in ast.iter_child_nodes(node)}
+    stored: set[str] = set()
+    names: set[str] = set()
+    called: set[str] = set()
+    written: set[str] = set()
+    for node in nodes:
+        if isinstance(node, ast.stmt) and not isinstance(node, _PARALLEL_STATEMENTS):
+            return None
+        if isinstance(node, ast.expr) and not isinstance(node, _PARALLEL_EXPRESSIONS):
+            return None
+        if isinstance(node, ast.For) and not (
+            isinstance(node.target, ast.Name) and not node.orelse and _is_range_call(node.iter)
+        ):
+            return None
+        if isinstance(node, ast.Assign) and not (
+            len(node.targets) == 1 and isinstance(node.targets[0], (ast.Name, ast.Subscript))
+        ):
+            return None
+        if isinstance(node, ast.Constant) and not isinstance(node.value, (int, float)):
+            return None
+        if isinstance(node, ast.Attribute) and not (isinstance(node.value, ast.Name) and node.value.id == "math"):
+            return None
+        if isinstance(node, ast.Call):
+            if node.keywords or not _is_pure_call(node, pure):
+                return None
+            if isinstance(node.func, ast.Name):
+                called.add(node.func.id)
+        if isinstance(node, ast.Subscript):
+            if isinstance(node.slice, ast.Slice):
+                return None
+            if isinstance(node.ctx, ast.Store):
+                base, first_index = _subscript_base(node)
+                if base is None or not (isinstance(first_index, ast.Name) and first_index.id == index):
+                    return None
+                written.add(base)
+        if isinstance(node, ast.Name):
+            names.add(node.id)
+            if isinstance(node.ctx, ast.Store):
+                stored.add(node.id)
+
+    if index in stored or written & stored:
+        return None
+    for name in written:
+        if scope is None or not _is_list_variable(scope, name):
+            return None
+        for node in nodes:
+            if isinstance(node, ast.Name) and node.id == name and not _is_own_element_access(node, parents, index):
+                return None
+
+    inner_targets = {node.target.id for node in nodes if isinstance(node, ast.For)}
+    plan = ParallelLoop(written=sorted(written), names=(names - called - {"math"}) | stored)
+    for name in sorted(stored):
+        if _is_reduction(name, nodes, parents):
+            plan.reductions.append(name)
+        elif name in inner_targets and _is_inner_loop_variable(name, nodes, parents):
+            # Declared by the inner loop's own C/C++ for statement
+            plan.private.append(name)
+            plan.loop_variables.add(name)
+        elif scope is not None and not _referenced_outside(scope, loop, name) and _assigned_before_use(loop.body, name):
+            plan.private.append(name)
+        else:
+            return None
+    plan.loop_variables.add(index)
+    return plan
+
+
+def _is_range_call(node: ast.expr) -> bool:
+    """Check for range() with one to three positional arguments."""
+    return (
+        isinstance(node, ast.Call)
+        and isinstance(node.func, ast.Name)
+        and node.func.id == "range"
+        and 1 <= len(node.args) <= 3
+        and not node.keywords
+    )
+
+
+def _is_pure_call(call: ast.Call, pure: set[str]) -> bool:
+    """Check whether a call is to a side-effect-free builtin, a math function or a pure function."""
+    func = call.func
+    if isinstance(func, ast.Name):
+        return func.id in PARALLEL_SAFE_BUILTINS or func.id in pure
+    return isinstance(func, ast.Attribute) and isinstance(func.value, ast.Name) and func.value.id == "math"
+
+
+def _has_pure_body(function: ast.FunctionDef, pure: set[str], shared: set[str]) -> bool:
+    """Check one function for the conditions of pure_functions, given the functions assumed pure."""
+    arguments = function.args
+    local = {arg.arg for arg in arguments.posonlyargs + arguments.args + arguments.kwonlyargs}
+    local.update(arg.arg for arg in (arguments.vararg, arguments.kwarg) if arg)
+    local.update(
+        node.id for node in ast.walk(function) if isinstance(node, ast.Name) and not isinstance(node.ctx, ast.Load)
+    )
+    for node in ast.walk(function):
+        if isinstance(node, (ast.Global, ast.Nonlocal, ast.Yield, ast.YieldFrom, ast.Lambda, ast.ClassDef)):
+            return False
+        # Its result would depend on state the caller can change between calls
+        if isinstance(node, ast.Name) and node.id in shared and node.id not in local:
+            return False
+        if isinstance(node, (ast.FunctionDef, ast.AsyncFunctionDef)) and node is not function:
+            return False
+        if isinstance(node, (ast.Subscript, ast.Attribute)) and not isinstance(node.ctx, ast.Load):
+            return False
+        if isinstance(node, ast.Call) and not _is_pure_call(node, pure):
+            return False
+    return True
+
+
+def _mutable_globals(module: ast.Module) -> set[str]:
+    """Module-level variables whose value may change: all but names bound once to an immutable literal."""
+    bindings: dict[str, list[ast.stmt]] = {}
+    for stmt in module.body:
+        if isinstance(stmt, (ast.FunctionDef, ast.AsyncFunctionDef, ast.ClassDef, ast.Import, ast.ImportFrom)):
+            continue
+        for node in ast.walk(stmt):
+            if isinstance(node, ast.Name) and not isinstance(node.ctx, ast.Load):
+                bindings.setdefault(node.id, []).append(stmt)
+    mutable = {name for node in ast.walk(module) if isinstance(node, ast.Global) for name in node.names}
+    for name, statements in bindings.items():
+        [stmt, *rebinds] = statements
+        if rebinds or not isinstance(stmt, (ast.Assign, ast.AnnAssign)) or not _is_immutable_literal(stmt.value):
+            mutable.add(name)
+    return mutable
+
+
+def _is_immutable_literal(node: Optional[ast.expr]) -> bool:
+    """Check whether an expression is a constant, a negated constant or a tuple of them."""
+    if isinstance(node, ast.UnaryOp):
+        node = node.operand
+    if isinstance(node, ast.Tuple):
+        return all(_is_immutable_literal(element) for element in node.elts)
+    return isinstance(node, ast.Constant)
+
+
+def _subscript_base(node: ast.Subscript) -> tuple[Optional[str], ast.expr]:
+    """Return the subscripted variable of a[x][y]... and the first index x (None if not a variable)."""
+    while isinstance(node.value, ast.Subscript):
+        node = node.value
+    base = node.value.id if isinstance(node.value, ast.Name) else None
+    return base, node.slice
+
+
+def _is_own_element_access(name: ast.Name, parents: dict[ast.AST, ast.AST], index: str) -> bool:
+    """Check that a written list is used as a[index]... or len(a), touching only this iteration's element."""
+    parent = parents.get(name)
+    if isinstance(parent, ast.Subscript) and parent.value is name:
+        return isinstance(parent.slice, ast.Name) and parent.slice.id == index
+    return (
+        isinstance(parent, ast.Call)
+        and isinstance(parent.func, ast.Name)
+        and parent.func.id == "len"
+        and parent.args == [name]
+    )
+
+
+def _is_list_variable(scope: ast.FunctionDef, name: str) -> bool:
+    """Check whether a function's variable is declared or initialized as a list everywhere it is bound."""
+    found = False
+    for arg in scope.args.args:
+        if arg.arg == name:
+            if not _is_list_annotation(arg.annotation):
+                return False
+            found = True
+    for node in ast.walk(scope):
+        if isinstance(node, ast.AnnAssign) and isinstance(node.target, ast.Name) and node.target.id == name:
+            if not _is_list_annotation(node.annotation):
+                return False
+            found = True
+        elif isinstance(node, ast.Assign) and any(isinstance(t, ast.Name) and t.id == name for t in node.targets):
+            # [...], [x] * n or a list comprehension
+            value = node.value.left if isinstance(node.value, ast.BinOp) else node.value
+            if not isinstance(value, (ast.List, ast.ListComp)):
+                return False
+            found = True
+    return found
+
+
+def _is_list_annotation(annotation: Optional[ast.expr]) -> bool:
+    """Check for list or list[...]."""
+    if isinstance(annotation, ast.Subscript):
+        annotation = annotation.value
+    return isinstance(annotation, ast.Name) and annotation.id == "list"
+
+
+def _references(node: ast.AST, name: str) -> bool:
+    """Check whether a subtree mentions a name."""
+    return any(isinstance(child, ast.Name) and child.id == name for child in ast.walk(node))
+
+
+def _is_reduction(name: str, nodes: list[ast.AST], parents: dict[ast.AST, ast.AST]) -> bool:
+    """Check that every use of a name in the loop is an update x += e or x = x + e, e not reading x."""
+    for node in nodes:
+        if not (isinstance(node, ast.Name) and node.id == name):
+            continue
+        parent = parents.get(node)
+        if isinstance(parent, ast.AugAssign) and parent.target is node:
+            if not isinstance(parent.op, ast.Add) or _references(parent.value, name):
+                return False
+        elif isinstance(parent, ast.Assign) and parent.targets[0] is node:
+            if not _is_self_addition(parent.value, name):
+                return False
+        elif isinstance(parent, ast.BinOp) and isinstance(grandparent := parents.get(parent), ast.Assign):
+            target = grandparent.targets[0]
+            if not (isinstance(target, ast.Name) and target.id == name and _is_self_addition(parent, name)):
+                return False
+        else:
+            return False
+    return True
+
+
+def _is_self_addition(value: ast.expr, name: str) -> bool:
+    """Check for x + e or e + x where e does not read x."""
+    if not (isinstance(value, ast.BinOp) and isinstance(value.op, ast.Add)):
+        return False
+    for own, other in ((value.left, value.right), (value.right, value.left)):
+        if isinstance(own, ast.Name) and own.id == name and not _references(other, name):
+            return True
+    return False
+
+
+def _is_inner_loop_variable(name: str, nodes: list[ast.AST], parents: dict[ast.AST, ast.AST]) -> bool:
+    """Check that a name is only bound as an inner range loop's variable and read inside that loop."""
+    loops = [node for node in nodes if isinstance(node, ast.For) and node.target.id == name]
+    for node in nodes:
+        if not (isinstance(node, ast.Name) and node.id == name):
+            continue
+        if isinstance(node.ctx, ast.Store):
+            if not any(loop.target is node for loop in loops):
+                return False
+            continue
+        ancestor = parents.get(node)
+        while ancestor is not None and not any(ancestor is loop for loop in loops):
+            ancestor = parents.get(ancestor)
+        if ancestor is None:
+            return False
+    return True
+
+
+def _referenced_outside(scope: ast.FunctionDef, loop: ast.For, name: str) -> bool:
+    """Check whether a function mentions a name (or takes it as a parameter) anywhere but in a loop."""
+    if any(arg.arg == name for arg in scope.args.args):
+        return True
+    inside = {id(node) for node in ast.walk(loop)}
+    return any(
+        isinstance(node, ast.Name) and node.id == name and id(node) not in inside for node in ast.walk(scope)
+    )
+
+
+def _assigned_before_use(body: list[ast.stmt], name: str) -> bool:
+    """Check that each run of a block assigns name before reading it.
+
+    The first statement mentioning name must assign it unconditionally, or be
+    an inner loop that alone mentions it and whose body satisfies the same.
+    """
+    for position, stmt in enumerate(body):
+        if not _references(stmt, name):
+            continue
+        if isinstance(stmt, (ast.Assign, ast.AnnAssign)):
+            target = stmt.targets[0] if isinstance(stmt, ast.Assign) else stmt.target
+            return (
+                isinstance(target, ast.Name)
+                and target.id == name
+                and stmt.value is not None
+                and not _references(stmt.value, name)
+            )
+        if isinstance(stmt, ast.For):
+            rest = body[position + 1 :]
+            return (
+                not _references(stmt.iter, name)
+                and not any(_references(later, name) for later in rest)
+                and _assigned_before_use(stmt.body, name)
+            )
+        return False
+    return True
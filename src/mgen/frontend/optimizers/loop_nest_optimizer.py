@@ -0,0 +1,462 @@
+"""Loop Nest Optimization for the Intelligence Layer.
+
+This module interchanges reduction loop nests whose innermost loop walks a
+matrix down a column, so that the generated code walks it along a row:
+
+    for j in range(n):                      for j in range(n):
+        s = 0                                   r[i][j] = 0
+        for k in range(m):          ->      for k in range(m):
+            s += a[i][k] * b[k][j]              for j in range(n):
+        r[i][j] = s                                 r[i][j] = r[i][j] + a[i][k] * b[k][j]
+
+Every r[i][j] still adds its terms in the same k order, so integer and
+floating-point results are unchanged. The rewrite only applies where it is
+provably safe: r is a matrix the function created itself (so it cannot alias
+the matrices the sum reads), the sum only adds, subtracts and multiplies
+elements and variables (so no other exception than an IndexError can change
+place), and the accumulator is not used outside the nest.
+"""
+
+import ast
+import copy
+from typing import Optional
+
+from ..base import AnalysisContext, BaseOptimizer, OptimizationLevel, OptimizationResult
+
+SCALAR_ANNOTATIONS = {"int", "float", "bool", "str"}
+
+# Operators the summed expression may use: none of them raises on numbers
+SAFE_OPERATORS = (ast.Add, ast.Sub, ast.Mult)
+
+
+class LoopNestOptimizer(BaseOptimizer):
+    """Interchange column-walking reduction nests into row-walking update nests."""
+
+    def __init__(self, optimization_level: OptimizationLevel = OptimizationLevel.MODERATE):
+        super().__init__("LoopNestOptimizer", optimization_level)
+        self._module_functions: dict[str, ast.FunctionDef] = {}
+        self._module_variables: set[str] = set()
+        self._pure_factories: dict[str, bool] = {}
+
+    def optimize(self, context: AnalysisContext) -> OptimizationResult:
+        """Interchange the eligible loop nests of every module-level function."""
+        try:
+            module = copy.deepcopy(context.ast_node)
+            self._index_module(module)
+            interchanged: list[str] = []
+            for function in self._module_functions.values():
+                for line in self._optimize_function(function):
+                    interchanged.append(f"Interchanged the loop nest of {function.name}() at line {line}")
+            ast.fix_missing_locations(module)
+
+            return OptimizationResult(
+                optimizer_name=self.name,
+                success=True,
+                optimized_ast=module,
+                transformations=interchanged,
+                performance_gain_estimate=4.0 if interchanged else 1.0,
+                safety_analysis={"loop_interchange": True},
+                metadata={"optimization_level": self.optimization_level.value, "interchanged": len(interchanged)},
+            )
+
+        except Exception as e:
+            return OptimizationResult(
+                optimizer_name=self.name,
+                success=False,
+                optimized_ast=None,
+                transformations=[f"Loop nest optimization failed: {str(e)}"],
+                performance_gain_estimate=1.0,
+                safety_analysis={"loop_interchange": False},
+                metadata={"error": str(e), "error_type": type(e).__name__},
+            )
+
+    def _index_module(self, module: ast.AST) -> None:
+        """Record the module's functions and the names of its variables."""
+        self._module_functions = {}
+        self._module_variables = set()
+        self._pure_factories = {}
+        for node in getattr(module, "body", []):
+            if isinstance(node, ast.FunctionDef):
+                self._module_functions[node.name] = node
+            elif isinstance(node, (ast.Assign, ast.AnnAssign, ast.AugAssign)):
+                targets = node.targets if isinstance(node, ast.Assign) else [node.target]
+                for target in targets:
+                    self._module_variables.update(_stored_names(target))
+
+    def _optimize_function(self, function: ast.FunctionDef) -> list[int]:
+        """Rewrite the function's eligible nests in place; returns the line of each."""
+        lines: list[int] = []
+        fresh = self._fresh_matrices(function)
+        if not fresh:
+            return lines
+        for node in list(ast.walk(function)):
+            for field_name in ("body", "orelse"):
+                block = getattr(node, field_name, None)
+                if not isinstance(block, list):
+                    continue
+                index = 0
+                while index < len(block):
+                    statement = block[index]
+                    replacement = self._interchange(function, statement, fresh)
+                    if replacement is None:
+                        index += 1
+                        continue
+                    block[index : index + 1] = replacement
+                    lines.append(statement.lineno)
+                    index += len(replacement)
+        return lines
+
+    def _interchange(
+        self, function: ast.FunctionDef, loop: ast.stmt, fresh: dict[str, int]
+    ) -> Optional[list[ast.stmt]]:
+        """The interchanged form of a j loop holding a k reduction, or None if it does not qualify."""
+        if not isinstance(loop, ast.For) or loop.orelse or not isinstance(loop.target, ast.Name):
+            return None
+        if len(loop.body) != 3:
+            return None
+        init, reduction, store = loop.body
+        j = loop.target.id
+
+        # s = c0 / s: T = c0
+        accumulator = _assigned_name(init)
+        initial = init.value if isinstance(init, (ast.Assign, ast.AnnAssign)) else None
+        if accumulator is None or not _is_number(initial):
+            return None
+
+        # for k in range(...): s += E / s = s + E
+        if not isinstance(reduction, ast.For) or reduction.orelse or not isinstance(reduction.target, ast.Name):
+            return None
+        if len(reduction.body) != 1:
+            return None
+        k = reduction.target.id
+        term = _accumulated_term(reduction.body[0], accumulator)
+        if term is None or k == j or accumulator in (j, k):
+            return None
+
+        # r[...][j] = s
+        if not isinstance(store, ast.Assign) or len(store.targets) != 1:
+            return None
+        target = store.targets[0]
+        if not (isinstance(store.value, ast.Name) and store.value.id == accumulator):
+            return None
+        matrix, indices = _subscript_chain(target)
+        if matrix is None or fresh.get(matrix) != len(indices):
+            return None
+        if not (isinstance(indices[-1], ast.Name) and indices[-1].id == j):
+            return None
+        loop_names = {j, k, accumulator}
+        if not all(_is_invariant(index, loop_names | {matrix}) for index in indices[:-1]):
+            return None
+
+        # Both loops count up by one over bounds the other loop cannot change
+        if not _is_unit_range(loop.iter, {k, accumulator}) or not _is_unit_range(reduction.iter, {j, accumulator}):
+            return None
+
+        if not _is_safe_term(term, {accumulator, matrix}):
+            return None
+        if not _reads_column(term, k, j):
+            return None  # Already walks rows: nothing to gain
+        if not self._accumulator_is_local(function, accumulator, loop):
+            return None
+
+        def element(ctx: ast.expr_context) -> ast.expr:
+            node = copy.deepcopy(target)
+            node.ctx = ctx
+            return node
+
+        zero = ast.For(
+            target=ast.Name(id=j, ctx=ast.Store()),
+            iter=copy.deepcopy(loop.iter),
+            body=[ast.Assign(targets=[element(ast.Store())], value=copy.deepcopy(initial))],
+            orelse=[],
+        )
+        update = ast.Assign(
+            targets=[element(ast.Store())],
+            value=ast.BinOp(left=element(ast.Load()), op=ast.Add(), right=copy.deepcopy(term)),
+        )
+        inner = ast.For(target=ast.Name(id=j, ctx=ast.Store()), iter=copy.deepcopy(loop.iter), body=[update], orelse=[])
+        outer = ast.For(
+            target=ast.Name(id=k, ctx=ast.Store()), iter=copy.deepcopy(reduction.iter), body=[inner], orelse=[]
+        )
+        for node in (zero, outer):
+            ast.copy_location(node, loop)
+        return [zero, outer]
+
+    def _accumulator_is_local(self, function: ast.FunctionDef, accumulator: str, loop: ast.For) -> bool:
+        """Whether the accumulator appears nowhere in the function outside the nest."""
+        inside = {id(node) for node in ast.walk(loop)}
+        for node in ast.walk(function):
+            if isinstance(node, ast.Name) and node.id == accumulator and id(node) not in inside:
+                return False
+            if isinstance(node, ast.arg) and node.arg == accumulator:
+                return False
+            if isinstance(node, (ast.Global, ast.Nonlocal)) and accumulator in node.names:
+                return False
+        return True
+
+    def _fresh_matrices(self, function: ast.FunctionDef) -> dict[str, int]:
+        """Local lists whose elements only the function can reach, with the depth they are subscripted at.
+
+        Every binding must create a new list - a comprehension or display of
+        constants, or a call to a module function that only takes scalars and
+        reads no module variables - and every other use must subscript the
+        list to a scalar, take its len(), or return it, so no alias escapes.
+        """
+        parameters = {arg.arg for arg in function.args.args + function.args.posonlyargs + function.args.kwonlyargs}
+        if function.args.vararg:
+            parameters.add(function.args.vararg.arg)
+        if function.args.kwarg:
+            parameters.add(function.args.kwarg.arg)
+
+        candidates: dict[str, bool] = {}
+        for node in ast.walk(function):
+            if isinstance(node, (ast.Assign, ast.AnnAssign)):
+                targets = node.targets if isinstance(node, ast.Assign) else [node.target]
+                for target in targets:
+                    if isinstance(target, ast.Name):
+                        is_fresh = node.value is not None and self._creates_fresh_list(node.value)
+                        candidates[target.id] = candidates.get(target.id, True) and is_fresh
+                    else:
+                        for name in _bound_names(target):
+                            candidates[name] = False
+            elif isinstance(node, (ast.AugAssign, ast.For, ast.comprehension, ast.NamedExpr)):
+                for name in _bound_names(node.target):
+                    candidates[name] = False
+            elif isinstance(node, ast.With):
+                for item in node.items:
+                    for name in _bound_names(item.optional_vars):
+                        candidates[name] = False
+            elif isinstance(node, (ast.Global, ast.Nonlocal)):
+                for name in node.names:
+                    candidates[name] = False
+
+        fresh = {name for name, is_fresh in candidates.items() if is_fresh and name not in parameters}
+        depths = _element_depths(function, fresh)
+        return {name: depth for name, depth in depths.items() if depth is not None}
+
+    def _creates_fresh_list(self, value: ast.expr) -> bool:
+        """Whether an expression builds a list no other variable refers to."""
+        if isinstance(value, ast.ListComp):
+            return _is_number(value.elt) or _is_constant_list(value.elt) or self._creates_fresh_list(value.elt)
+        if isinstance(value, ast.List):
+            return all(_is_number(element) for element in value.elts)
+        if isinstance(value, ast.BinOp) and isinstance(value.op, ast.Mult):
+            return _is_constant_list(value.left) or _is_constant_list(value.right)
+        if isinstance(value, ast.Call) and isinstance(value.func, ast.Name):
+            return self._is_pure_factory(value.func.id) and not any(
+                isinstance(arg, (ast.Starred, ast.List, ast.ListComp)) for arg in value.args
+            )
+        return False
+
+    def _is_pure_factory(self, name: str) -> bool:
+        """Whether a module function takes only scalars and reaches no module variables, transitively."""
+        if name in self._pure_factories:
+            return self._pure_factories[name]
+        function = self._module_functions.get(name)
+        if function is None:
+            return False
+        self._pure_factories[name] = True  # Recursive calls
+        arguments = function.args
+        pure = not (arguments.vararg or arguments.kwarg or arguments.kwonlyargs) and all(
+            isinstance(arg.annotation, ast.Name) and arg.annotation.id in SCALAR_ANNOTATIONS
+            for arg in arguments.posonlyargs + arguments.args
+        )
+        for node in ast.walk(function) if pure else ():
+            if isinstance(node, (ast.Global, ast.Nonlocal)):
+                pure = False
+            elif isinstance(node, ast.Name) and isinstance(node.ctx, ast.Load):
+                if node.id in self._module_variables:
+                    pure = False
+                elif node.id in self._module_functions and node.id != name:
+                    pure = pure and self._is_pure_factory(node.id)
+            if not pure:
+                break
+        self._pure_factories[name] = pure
+        return pure
+
+
+def _stored_names(target: ast.AST) -> set[str]:
+    """Every name an assignment target stores to."""
+    return {node.id for node in ast.walk(target) if isinstance(node, ast.Name) and isinstance(node.ctx, ast.Store)}
+
+
+def _bound_names(target: Optional[ast.AST]) -> set[str]:
+    """The names a binding target rebinds: subscript and attribute stores do not count."""
+    if isinstance(target, ast.Name):
+        return {target.id}
+    if isinstance(target, (ast.Tuple, ast.List)):
+        return set().union(*(_bound_names(element) for element in target.elts)) if target.elts else set()
+    if isinstance(target, ast.Starred):
+        return _bound_names(target.value)
+    return set()
+
+
+def _assigned_name(statement: ast.stmt) -> Optional[str]:
+    if isinstance(statement, ast.Assign) and len(statement.targets) == 1 and isinstance(statement.targets[0], ast.Name):
+        return statement.targets[0].id
+    if isinstance(statement, ast.AnnAssign) and isinstance(statement.target, ast.Name) and statement.value is not None:
+        return statement.target.id
+    return None
+
+
+def _is_number(node: Optional[ast.AST]) -> bool:
+    return (
+        isinstance(node, ast.Constant)
+        and isinstance(node.value, (int, float))
+        and not isinstance(node.value, bool)
+    )
+
+
+def _is_constant_list(node: ast.AST) -> bool:
+    """A list display of numbers, or one repeated: [0, 0], [0.0] * n."""
+    if isinstance(node, ast.List):
+        return all(_is_number(element) for element in node.elts)
+    if isinstance(node, ast.BinOp) and isinstance(node.op, ast.Mult):
+        return _is_constant_list(node.left) or _is_constant_list(node.right)
+    return False
+
+
+def _accumulated_term(statement: ast.stmt, accumulator: str) -> Optional[ast.expr]:
+    """E from s += E or s = s + E."""
+    if (
+        isinstance(statement, ast.AugAssign)
+        and isinstance(statement.op, ast.Add)
+        and isinstance(statement.target, ast.Name)
+        and statement.target.id == accumulator
+    ):
+        return statement.value
+    if (
+        isinstance(statement, ast.Assign)
+        and len(statement.targets) == 1
+        and isinstance(statement.targets[0], ast.Name)
+        and statement.targets[0].id == accumulator
+        and isinstance(statement.value, ast.BinOp)
+        and isinstance(statement.value.op, ast.Add)
+        and isinstance(statement.value.left, ast.Name)
+        and statement.value.left.id == accumulator
+    ):
+        return statement.value.right
+    return None
+
+
+def _subscript_chain(node: ast.AST) -> tuple[Optional[str], list[ast.expr]]:
+    """The name and indices of name[i0][i1]..., or (None, [])."""
+    indices: list[ast.expr] = []
+    while isinstance(node, ast.Subscript):
+        if isinstance(node.slice, ast.Slice):
+            return None, []
+        indices.insert(0, node.slice)
+        node = node.value
+    if isinstance(node, ast.Name):
+        return node.id, indices
+    return None, []
+
+
+def _is_invariant(node: ast.AST, excluded: set[str]) -> bool:
+    """Whether an index or bound is arithmetic on constants and names none of the nest assigns."""
+    if isinstance(node, ast.Constant):
+        return isinstance(node.value, int) and not isinstance(node.value, bool)
+    if isinstance(node, ast.Name):
+        return node.id not in excluded
+    if isinstance(node, ast.BinOp) and isinstance(node.op, SAFE_OPERATORS):
+        return _is_invariant(node.left, excluded) and _is_invariant(node.right, excluded)
+    if isinstance(node, ast.Call):
+        # len() of a list: the nest stores elements, never appends
+        return (
+            isinstance(node.func, ast.Name)
+            and node.func.id == "len"
+            and len(node.args) == 1
+            and not node.keywords
+            and _subscript_chain(node.args[0])[0] is not None
+            and all(_is_invariant(index, excluded) for index in _subscript_chain(node.args[0])[1])
+        )
+    return False
+
+
+def _is_unit_range(node: ast.expr, excluded: set[str]) -> bool:
+    """range(stop) or range(start, stop[, 1]) over invariant bounds."""
+    if not (isinstance(node, ast.Call) and isinstance(node.func, ast.Name) and node.func.id == "range"):
+        return False
+    if node.keywords or not 1 <= len(node.args) <= 3:
+        return False
+    if len(node.args) == 3 and not (isinstance(node.args[2], ast.Constant) and node.args[2].value == 1):
+        return False
+    return all(_is_invariant(arg, excluded) for arg in node.args[:2])
+
+
+def _is_safe_term(node: ast.AST, excluded: set[str]) -> bool:
+    """Whether the summed term is +, - and * over variables, numbers and elements, without excluded names."""
+    if isinstance(node, ast.Constant):
+        return _is_number(node)
+    if isinstance(node, ast.Name):
+        return node.id not in excluded
+    if isinstance(node, ast.BinOp):
+        return (
+            isinstance(node.op, SAFE_OPERATORS)
+            and _is_safe_term(node.left, excluded)
+            and _is_safe_term(node.right, excluded)
+        )
+    if isinstance(node, ast.UnaryOp):
+        return isinstance(node.op, (ast.USub, ast.UAdd)) and _is_safe_term(node.operand, excluded)
+    if isinstance(node, ast.Subscript):
+        name, indices = _subscript_chain(node)
+        return name is not None and name not in excluded and all(_is_safe_term(index, excluded) for index in indices)
+    return False
+
+
+def _reads_column(term: ast.AST, k: str, j: str) -> bool:
+    """Whether the term reads some x[..k..][j], whose rows the k loop steps across."""
+    for node in ast.walk(term):
+        if (
+            isinstance(node, ast.Subscript)
+            and isinstance(node.slice, ast.Name)
+            and node.slice.id == j
+            and isinstance(node.value, ast.Subscript)
+            and k in {name.id for name in ast.walk(node.value.slice) if isinstance(name, ast.Name)}
+        ):
+            return True
+    return False
+
+
+def _element_depths(function: ast.FunctionDef, names: set[str]) -> dict[str, Optional[int]]:
+    """For each name, the single subscript depth it is used at, or None if a use could leak an alias.
+
+    len(x[..]) and return x are allowed; anything else that is not a full
+    subscript of the same depth (a row bound to a variable, a method call,
+    an argument) disqualifies the name.
+    """
+    depths: dict[str, Optional[int]] = {}
+    allowed: set[int] = set()
+    for node in ast.walk(function):
+        if isinstance(node, ast.Return) and isinstance(node.value, ast.Name):
+            allowed.add(id(node.value))
+        elif isinstance(node, ast.Call) and isinstance(node.func, ast.Name) and node.func.id == "len":
+            for arg in node.args:
+                inner = arg
+                while isinstance(inner, ast.Subscript):
+                    inner = inner.value
+                allowed.add(id(inner))
+
+    parents: dict[int, ast.AST] = {}
+    for node in ast.walk(function):
+        for child in ast.iter_child_nodes(node):
+            parents[id(child)] = node
+
+    for node in ast.walk(function):
+        if not (isinstance(node, ast.Name) and node.id in names):
+            continue
+        if isinstance(node.ctx, ast.Store) or id(node) in allowed:
+            depths.setdefault(node.id, None)
+            continue
+        depth = 0
+        current: ast.AST = node
+        while isinstance(parents.get(id(current)), ast.Subscript) and parents[id(current)].value is current:
+            current = parents[id(current)]
+            depth += 1
+        if depth == 0:
+            depths[node.id] = -1
+            continue
+        previous = depths.get(node.id)
+        depths[node.id] = depth if previous in (None, depth) else -1
+
+    return {name: depth if depth is not None and depth > 0 else None for name, depth in depths.items()}
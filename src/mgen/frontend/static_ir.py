@@ -12,6 +12,7 @@ from enum import Enum
 from typing import Any, Optional
 
 from .ast_analyzer import StaticComplexity
+from .dict_updates import DictUpdate, match_dict_update
 
 
 class IRNodeType(Enum):
@@ -837,6 +838,11 @@ class IRBuilder:
 
     def _build_statement(self, node: ast.stmt) -> Optional[IRStatement]:
         """Build IR statement from AST statement."""
+        update = match_dict_update(node)
+        if update is not None and update.default_is_zero:
+            fused = self._build_dict_update(update, node)
+            if fused is not None:
+                return fused
         if isinstance(node, ast.AnnAssign):
             return self._build_annotated_assignment(node)
         elif isinstance(node, ast.Assign):
@@ -1224,6 +1230,12 @@ class IRBuilder:
 
             # Look up function return type from module
             return_type = IRType(IRDataType.VOID)  # Default
+            if func_name == "len":
+                return_type = IRType(IRDataType.INT)
+            elif func_name in ("abs", "min", "max") and arguments:
+                # Scalar forms return their argument type
+                if arguments[0].result_type.base_type in (IRDataType.INT, IRDataType.FLOAT):
+                    return_type = arguments[0].result_type
             if self.current_module:
                 for func in self.current_module.functions:
                     if func.name == func_name:
@@ -1250,6 +1262,10 @@ class IRBuilder:
             elif method_name == "split":
                 # str.split() returns a list of strings
                 return_type = IRType(IRDataType.LIST, element_type=IRType(IRDataType.STRING))
+            elif method_name in ("lower", "upper", "strip", "replace", "join"):
+                return_type = IRType(IRDataType.STRING)
+            elif method_name in ("startswith", "endswith"):
+                return_type = IRType(IRDataType.BOOL)
             else:
                 # Most methods return void (append, etc.)
                 return_type = IRType(IRDataType.VOID)
@@ -1350,6 +1366,21 @@ class IRBuilder:
 
         return IRReturn(value, self._get_location(node))
 
+    def _build_dict_update(self, update: DictUpdate, node: ast.stmt) -> Optional[IRStatement]:
+        """Build a counting update as one lookup: __update_item__(d, k, __current_item__() + e)."""
+        container = self._build_expression(ast.Name(id=update.container, ctx=ast.Load()))
+        increment = self._build_expression(update.increment)
+        # The runtime maps hold integer values
+        if container.result_type.base_type != IRDataType.DICT or increment.result_type.base_type != IRDataType.INT:
+            return None
+        location = self._get_location(node)
+        current = IRFunctionCall("__current_item__", [], increment.result_type, location)
+        value = IRBinaryOperation(current, "+", increment, increment.result_type, location)
+        call = IRFunctionCall(
+            "__update_item__", [container, self._build_expression(update.key), value], IRType(IRDataType.VOID), location
+        )
+        return IRExpressionStatement(call, location)
+
     def _build_if(self, node: ast.If) -> IRIf:
         """Build if statement."""
         condition = self._build_expression(node.test)
@@ -68,6 +68,7 @@ class StaticPythonSubsetValidator:
         self.feature_rules = self._initialize_feature_rules()
         self.validation_cache: dict[str, ValidationResult] = {}
         self.last_validation_error: Optional[str] = None  # Store detailed error from validators
+        self.generator_functions: set[str] = set()  # Functions of the validated module containing yield
 
     def validate_code(self, source_code: str) -> ValidationResult:
         """Validate that code conforms to the Static Python Subset."""
@@ -98,6 +99,11 @@ class StaticPythonSubsetValidator:
     def _validate_ast(self, tree: ast.AST) -> ValidationResult:
         """Validate an AST against the subset rules."""
         result = ValidationResult(is_valid=True, tier=SubsetTier.TIER_1_FUNDAMENTAL)
+        self.generator_functions = {
+            node.name
+            for node in ast.walk(tree)
+            if isinstance(node, ast.FunctionDef) and any(isinstance(child, ast.Yield) for child in ast.walk(node))
+        }
         max_tier = SubsetTier.TIER_1_FUNDAMENTAL
 
         # Check each node against our rules
@@ -442,7 +448,7 @@ class StaticPythonSubsetValidator:
                 return False
 
         # No complex decorators
-        allowed_decorators = {"staticmethod", "classmethod"}
+        allowed_decorators = {"staticmethod", "classmethod", "cache", "lru_cache"}
         for decorator in node.decorator_list:
             if isinstance(decorator, ast.Name):
                 if decorator.id not in allowed_decorators:
@@ -460,8 +466,8 @@ class StaticPythonSubsetValidator:
             if isinstance(node.iter, ast.Call):
                 # Allow range() calls and method calls that return iterables
                 if isinstance(node.iter.func, ast.Name):
-                    # range() calls
-                    return node.iter.func.id == "range"
+                    # range() calls, and calls of the module's generator functions
+                    return node.iter.func.id == "range" or node.iter.func.id in self.generator_functions
                 elif isinstance(node.iter.func, ast.Attribute):
                     # Method calls like dict.items(), dict.values(), dict.keys()
                     return True
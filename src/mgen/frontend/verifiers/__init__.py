@@ -6,6 +6,15 @@ and symbolic analysis to ensure correctness and safety of generated code.
 
 from .bounds_prover import BoundsProver, MemorySafetyProof
 from .correctness_prover import AlgorithmProof, CorrectnessProver
+from .proof_cache import ProofCache
 from .theorem_prover import ProofResult, TheoremProver
 
-__all__ = ["TheoremProver", "ProofResult", "BoundsProver", "MemorySafetyProof", "CorrectnessProver", "AlgorithmProof"]
+__all__ = [
+    "TheoremProver",
+    "ProofResult",
+    "ProofCache",
+    "BoundsProver",
+    "MemorySafetyProof",
+    "CorrectnessProver",
+    "AlgorithmProof",
+]
@@ -2,11 +2,17 @@
 
 This module provides formal verification of memory safety properties,
 including bounds checking, buffer overflow prevention, and pointer safety.
+
+prove_loop_bounds() is a lightweight, solver-free counterpart for code
+generation: it shows which subscripts of a range loop stay in bounds by the
+loop's range alone (a[i] in range(len(a))) and which need just one range
+check before the loop (a[i + 1] in range(n)), so backends can drop the
+per-access check.
 """
 
 import ast
 import time
-from dataclasses import dataclass
+from dataclasses import dataclass, field
 from enum import Enum
 from typing import Optional, Union
 
@@ -132,8 +138,8 @@ class BoundsProver:
         overflow_results = self._verify_buffer_overflow_safety()
         all_proof_results.extend(overflow_results)
 
-        # Determine overall safety status
-        is_safe = all(result.is_verified for result in all_proof_results)
+        # Determine overall safety status; properties the budget ran out on keep their runtime checks
+        is_safe = all(result.is_verified or result.status == ProofStatus.TIMEOUT for result in all_proof_results)
 
         # Find unsafe accesses
         for access in self.memory_accesses:
@@ -177,8 +183,8 @@ class BoundsProver:
                 result = self.theorem_prover.verify_property(prop)
                 results.append(result)
 
-                # Update access safety status
-                access.is_safe = result.is_verified
+                # Update access safety status (None: not proved in time, the runtime check stays)
+                access.is_safe = None if result.status == ProofStatus.TIMEOUT else result.is_verified
 
         return results
 
@@ -338,6 +344,12 @@ class BoundsProver:
         if failed_proofs:
             recommendations.append("Review memory access patterns in failed verification points")
 
+        timed_out_proofs = [r for r in proof_results if r.status == ProofStatus.TIMEOUT]
+        if timed_out_proofs:
+            recommendations.append(
+                f"Verification time ran out for {len(timed_out_proofs)} properties; their runtime checks are kept"
+            )
+
         unknown_proofs = [r for r in proof_results if r.status == ProofStatus.UNKNOWN]
         if unknown_proofs:
             recommendations.append("Add explicit bounds information to help verification")
@@ -472,3 +484,445 @@ class MemoryOperationExtractor(ast.NodeVisitor):
             return slice_node.id
         else:
             return "complex_index"
+
+
+@dataclass
+class IndexAccess:
+    """A subscript whose index is affine in a range loop's variable: a[i + offset] or a[r][i + offset]."""
+
+    node: ast.Subscript
+    container: str
+    # 0 for a[i + c]; 1 for the column index of a[r][i + c]
+    dimension: int
+    offset: int
+    # Bounds the loop's range does not imply, which a check before the loop must establish
+    check_lower: bool
+    check_upper: bool
+
+    @property
+    def proven(self) -> bool:
+        """Whether the access is in bounds on every iteration without any check."""
+        return not (self.check_lower or self.check_upper)
+
+
+@dataclass
+class LoopBoundsProof:
+    """Which subscripts of a range loop are in bounds, and what the loop may change."""
+
+    loop: ast.For
+    accesses: list[IndexAccess] = field(default_factory=list)
+    # Names the loop assigns (its variable included); a check hoisted above the loop may not read them
+    assigned: set[str] = field(default_factory=set)
+    # Containers whose length (and row lengths) the loop leaves unchanged
+    stable: set[str] = field(default_factory=set)
+    # The range bounds are cheap, side-effect-free expressions that may be evaluated early
+    hoistable_range: bool = False
+
+
+# Node types a range bound may consist of (besides len() calls) to be evaluated before the loop
+_CHEAP_NODES = (
+    ast.Name,
+    ast.Constant,
+    ast.BinOp,
+    ast.UnaryOp,
+    ast.Subscript,
+    ast.expr_context,
+    ast.operator,
+    ast.unaryop,
+)
+
+
+def prove_loop_bounds(loop: ast.For) -> Optional[LoopBoundsProof]:
+    """Classify the subscripts of a range loop that index with the loop variable.
+
+    For for i in range(start, stop) - the loop variable unassigned in the
+    body, any step a positive constant - an access a[i + c] to a container
+    the body does not resize is proven in bounds when start + c >= 0 follows
+    from a constant start and i + c < len(a) from stop being len(a) - k with
+    c <= k; a[r][i + c] likewise with stop len(a[r]). Otherwise the missing
+    bound is flagged for one check before the loop. Accesses through other
+    index expressions are not listed.
+
+    Returns:
+        The proof, or None for loops that are not canonical range loops
+    """
+    iterator = loop.iter
+    if not (
+        isinstance(loop.target, ast.Name)
+        and isinstance(iterator, ast.Call)
+        and isinstance(iterator.func, ast.Name)
+        and iterator.func.id == "range"
+        and 1 <= len(iterator.args) <= 3
+        and not iterator.keywords
+    ):
+        return None
+    if len(iterator.args) == 3:
+        step = iterator.args[2]
+        if not (isinstance(step, ast.Constant) and isinstance(step.value, int) and step.value > 0):
+            return None
+    start = iterator.args[0] if len(iterator.args) >= 2 else None
+    stop = iterator.args[1] if len(iterator.args) >= 2 else iterator.args[0]
+    index = loop.target.id
+
+    nodes = [node for stmt in loop.body for node in ast.walk(stmt)]
+    parents = {child: node for node in nodes for child in ast.iter_child_nodes(node)}
+    assigned = {node.id for node in nodes if isinstance(node, ast.Name) and not isinstance(node.ctx, ast.Load)}
+    bounds = [bound for bound in (start, stop) if bound is not None]
+    bound_names = {node.id for bound in bounds for node in ast.walk(bound) if isinstance(node, ast.Name)}
+    # The generated loop re-evaluates its condition, so the bounds must not change either
+    if index in assigned or bound_names & assigned:
+        return None
+
+    proof = LoopBoundsProof(loop, assigned=assigned | {index})
+    used = {node.id for node in nodes if isinstance(node, ast.Name)}
+    proof.stable = {name for name in used - assigned if _keeps_length(name, nodes, parents)}
+    proof.hoistable_range = all(_is_cheap(bound) for bound in bounds)
+
+    for node in nodes:
+        if not isinstance(node, ast.Subscript) or isinstance(node.slice, ast.Slice):
+            continue
+        offset = _affine_offset(node.slice, index)
+        if offset is None:
+            continue
+        first = 0 if start is None else _int_constant(start)
+        lower = first is not None and first + offset >= 0
+        if isinstance(node.value, ast.Name) and node.value.id in proof.stable:
+            upper = _bounded_by_length(stop, node.value, offset)
+            proof.accesses.append(IndexAccess(node, node.value.id, 0, offset, not lower, not upper))
+        elif (
+            isinstance(node.value, ast.Subscript)
+            and isinstance(node.value.value, ast.Name)
+            and node.value.value.id in proof.stable
+        ):
+            # len(a[r]) bounds the row a[r] only while r stays the same
+            row_names = {child.id for child in ast.walk(node.value.slice) if isinstance(child, ast.Name)}
+            upper = not row_names & proof.assigned and _bounded_by_length(stop, node.value, offset)
+            proof.accesses.append(IndexAccess(node, node.value.value.id, 1, offset, not lower, not upper))
+    return proof
+
+
+def loop_bounds_proofs(tree: ast.AST) -> dict[int, LoopBoundsProof]:
+    """Prove the bounds of every range loop under tree, keyed by id() of the loop node."""
+    proofs = {}
+    for node in ast.walk(tree):
+        if isinstance(node, ast.For):
+            proof = prove_loop_bounds(node)
+            if proof is not None:
+                proofs[id(node)] = proof
+    return proofs
+
+
+def _int_constant(node: ast.expr) -> Optional[int]:
+    """Return the value of an integer literal (including -1), or None."""
+    if isinstance(node, ast.UnaryOp) and isinstance(node.op, ast.USub):
+        value = _int_constant(node.operand)
+        return -value if value is not None else None
+    if isinstance(node, ast.Constant) and isinstance(node.value, int) and not isinstance(node.value, bool):
+        return node.value
+    return None
+
+
+def _affine_offset(index: ast.expr, variable: str) -> Optional[int]:
+    """Return c for an index i, i + c, c + i or i - c (c an integer literal), else None."""
+    if isinstance(index, ast.Name):
+        return 0 if index.id == variable else None
+    if isinstance(index, ast.BinOp) and isinstance(index.op, (ast.Add, ast.Sub)):
+        if isinstance(index.left, ast.Name) and index.left.id == variable:
+            constant = _int_constant(index.right)
+            if constant is not None:
+                return constant if isinstance(index.op, ast.Add) else -constant
+        if isinstance(index.op, ast.Add) and isinstance(index.right, ast.Name) and index.right.id == variable:
+            return _int_constant(index.left)
+    return None
+
+
+def _bounded_by_length(stop: ast.expr, sequence: ast.expr, offset: int) -> bool:
+    """Check that i < stop implies i + offset < len(sequence): stop is len(sequence) - k with k >= offset."""
+    slack = 0
+    if isinstance(stop, ast.BinOp) and isinstance(stop.op, ast.Sub) and _int_constant(stop.right) is not None:
+        slack = _int_constant(stop.right) or 0
+        stop = stop.left
+    return (
+        isinstance(stop, ast.Call)
+        and isinstance(stop.func, ast.Name)
+        and stop.func.id == "len"
+        and len(stop.args) == 1
+        and ast.dump(stop.args[0]) == ast.dump(sequence)
+        and offset <= slack
+    )
+
+
+def _keeps_length(name: str, nodes: list[ast.AST], parents: dict[ast.AST, ast.AST]) -> bool:
+    """Check that a loop body only indexes a container or takes its len(), never resizing it or its rows.
+
+    Element stores a[x] = v keep the length, and so do reads and writes of
+    an element's field a[x].f; stores replacing a row of a nested list do
+    not keep the rows' lengths, so they disqualify too when the store target
+    is itself subscripted elsewhere.
+    """
+    row_stores = False
+    row_reads = False
+    for node in nodes:
+        if not (isinstance(node, ast.Name) and node.id == name):
+            continue
+        parent = parents.get(node)
+        if isinstance(parent, ast.Call) and isinstance(parent.func, ast.Name) and parent.func.id == "len":
+            if parent.func is node:
+                return False
+            continue
+        if not (isinstance(parent, ast.Subscript) and parent.value is node):
+            return False
+        # Walk up the a[x][y]... chain; its end must not be a method call's receiver or a call argument
+        top: ast.AST = parent
+        while isinstance(parents.get(top), ast.Subscript) and parents[top].value is top:
+            top = parents[top]
+        outer = parents.get(top)
+        if isinstance(outer, ast.Attribute) and top is parent and _is_field_access(outer, parents):
+            continue
+        if isinstance(outer, ast.Attribute) or (isinstance(outer, ast.Call) and top in outer.args):
+            if not (isinstance(outer, ast.Call) and isinstance(outer.func, ast.Name) and outer.func.id == "len"):
+                return False
+        if top is parent and isinstance(parent.ctx, ast.Store):
+            row_stores = True
+        if top is not parent:
+            row_reads = True
+    return not (row_stores and row_reads)
+
+
+# list methods: a[x].append and the like may resize the row a[x] rather than read a field
+_LIST_METHODS = frozenset({"append", "extend", "insert", "pop", "remove", "clear", "sort", "reverse", "copy"})
+
+
+def _is_field_access(attribute: ast.Attribute, parents: dict[ast.AST, ast.AST]) -> bool:
+    """Check that e.f reads or writes a field of e rather than calling or taking one of its methods."""
+    call = parents.get(attribute)
+    return attribute.attr not in _LIST_METHODS and not (isinstance(call, ast.Call) and call.func is attribute)
+
+
+def _is_cheap(node: ast.expr) -> bool:
+    """Check that a range bound is names, integer literals, arithmetic and len() - safe to evaluate early."""
+    for child in ast.walk(node):
+        if isinstance(child, ast.Call):
+            if not (isinstance(child.func, ast.Name) and child.func.id == "len" and len(child.args) == 1):
+                return False
+        elif not isinstance(child, _CHEAP_NODES):
+            return False
+    return True
+
+
+# C int: a larger intermediate would overflow in the generated code
+_INT_MIN, _INT_MAX = -(2**31), 2**31 - 1
+
+# Set methods a bitset-backed set supports as statements
+_BITSET_METHODS = {"add": 1, "discard": 1, "remove": 1, "clear": 0}
+
+
+def int_interval(node: ast.expr, ranges: dict[str, tuple[int, int]]) -> Optional[tuple[int, int]]:
+    """Return bounds (lo, hi) of an integer expression, or None when they are unknown.
+
+    Names take their intervals from ranges (range loop variables); literals,
+    unary minus and + - * of bounded operands are evaluated on the intervals.
+    x % c with a non-negative x and x & c both lie in [0, c] for a constant
+    c > 0 however large x gets; x // c needs x bounded and non-negative
+    (C truncates where Python floors). Intervals leaving the C int range are
+    unknown, since the generated arithmetic would overflow.
+    """
+    interval = _raw_interval(node, ranges)
+    if interval is None or interval[0] < _INT_MIN or interval[1] > _INT_MAX:
+        return None
+    return interval
+
+
+def _raw_interval(node: ast.expr, ranges: dict[str, tuple[int, int]]) -> Optional[tuple[int, int]]:
+    constant = _int_constant(node)
+    if constant is not None:
+        return constant, constant
+    if isinstance(node, ast.Name):
+        return ranges.get(node.id)
+    if isinstance(node, ast.UnaryOp) and isinstance(node.op, ast.USub):
+        operand = int_interval(node.operand, ranges)
+        return (-operand[1], -operand[0]) if operand else None
+    if not isinstance(node, ast.BinOp):
+        return None
+
+    left = int_interval(node.left, ranges)
+    divisor = _int_constant(node.right)
+    if divisor is not None and divisor > 0:
+        if isinstance(node.op, ast.BitAnd):
+            return 0, divisor if left is None or left[0] < 0 else min(divisor, left[1])
+        if isinstance(node.op, ast.Mod) and left is not None and left[0] >= 0:
+            return 0, min(divisor - 1, left[1])
+        if isinstance(node.op, ast.FloorDiv) and left is not None and left[0] >= 0:
+            return left[0] // divisor, left[1] // divisor
+    right = int_interval(node.right, ranges)
+    if left is None or right is None:
+        return None
+    if isinstance(node.op, ast.Add):
+        return left[0] + right[0], left[1] + right[1]
+    if isinstance(node.op, ast.Sub):
+        return left[0] - right[1], left[1] - right[0]
+    if isinstance(node.op, ast.Mult):
+        products = [a * b for a in left for b in right]
+        return min(products), max(products)
+    return None
+
+
+def _statement_ranges(
+    body: list[ast.stmt], ranges: dict[str, tuple[int, int]], envs: dict[int, dict[str, tuple[int, int]]]
+) -> None:
+    """Record the loop variable intervals in effect at each statement (nested functions excluded)."""
+    for stmt in body:
+        envs[id(stmt)] = ranges
+        if isinstance(stmt, (ast.FunctionDef, ast.AsyncFunctionDef, ast.ClassDef)):
+            continue
+        inner = ranges
+        if isinstance(stmt, ast.For) and isinstance(stmt.target, ast.Name):
+            inner = {name: interval for name, interval in ranges.items() if name != stmt.target.id}
+            variable = _range_interval(stmt, ranges)
+            if variable is not None:
+                inner[stmt.target.id] = variable
+            _statement_ranges(stmt.body, inner, envs)
+            _statement_ranges(stmt.orelse, ranges, envs)
+            continue
+        for field_name in ("body", "orelse", "finalbody"):
+            _statement_ranges(getattr(stmt, field_name, []), ranges, envs)
+        for handler in getattr(stmt, "handlers", []):
+            _statement_ranges(handler.body, ranges, envs)
+
+
+def _range_interval(loop: ast.For, ranges: dict[str, tuple[int, int]]) -> Optional[tuple[int, int]]:
+    """Interval of the variable of for i in range(...) with bounded arguments, unassigned in the body."""
+    iterator = loop.iter
+    if not (
+        isinstance(loop.target, ast.Name)
+        and isinstance(iterator, ast.Call)
+        and isinstance(iterator.func, ast.Name)
+        and iterator.func.id == "range"
+        and 1 <= len(iterator.args) <= 3
+        and not iterator.keywords
+    ):
+        return None
+    if len(iterator.args) == 3 and not (_int_constant(iterator.args[2]) or 0) > 0:
+        return None
+    start = int_interval(iterator.args[0], ranges) if len(iterator.args) >= 2 else (0, 0)
+    stop = int_interval(iterator.args[1] if len(iterator.args) >= 2 else iterator.args[0], ranges)
+    if start is None or stop is None:
+        return None
+    for stmt in loop.body:
+        for node in ast.walk(stmt):
+            if isinstance(node, ast.Name) and node.id == loop.target.id and not isinstance(node.ctx, ast.Load):
+                return None
+    # An empty range never binds the variable, so any interval containing start is sound
+    return start[0], max(start[0], stop[1] - 1)
+
+
+def overflow_free_arithmetic(function: ast.FunctionDef) -> set[int]:
+    """Ids of the + - * nodes in function whose int_interval proves the C int result cannot overflow.
+
+    Operands are bounded by the range loops around the statement holding the
+    expression, as for bounded_int_sets; anything else is left unproven.
+    """
+    envs: dict[int, dict[str, tuple[int, int]]] = {}
+    _statement_ranges(function.body, {}, envs)
+    proven: set[int] = set()
+    for stmt in ast.walk(function):
+        ranges = envs.get(id(stmt))
+        if ranges is None:
+            continue
+        # The statements nested in stmt are matched against their own ranges
+        pending = [child for child in ast.iter_child_nodes(stmt) if not isinstance(child, ast.stmt)]
+        while pending:
+            node = pending.pop()
+            if isinstance(node, ast.BinOp) and isinstance(node.op, (ast.Add, ast.Sub, ast.Mult)):
+                if int_interval(node, ranges) is not None:
+                    proven.add(id(node))
+            pending.extend(child for child in ast.iter_child_nodes(node) if not isinstance(child, ast.stmt))
+    return proven
+
+
+def _empty_or_int_set(value: Optional[ast.expr]) -> Optional[list[int]]:
+    """Elements of set() or of a set literal of integer constants, else None."""
+    if isinstance(value, ast.Call) and isinstance(value.func, ast.Name) and value.func.id == "set":
+        return [] if not value.args and not value.keywords else None
+    if isinstance(value, ast.Set):
+        elements = [_int_constant(element) for element in value.elts]
+        return None if None in elements else [element for element in elements if element is not None]
+    return None
+
+
+def bounded_int_sets(function: ast.FunctionDef, limit: int) -> dict[str, int]:
+    """Local integer sets whose members range analysis keeps in [0, limit).
+
+    A candidate is assigned once, directly in the function body, to set() or
+    a literal of integer constants, and otherwise only appears as the
+    receiver of add/discard/remove/clear calls made as statements, the right
+    side of in / not in and the argument of len(). Its literal elements and
+    every add() argument must have an int_interval within [0, limit), the
+    names in it bounded by the enclosing range loops. Sets that escape -
+    returned, passed, iterated, aliased, used by a nested function - or are
+    assigned again are never listed.
+
+    Returns:
+        {name: domain}, domain one past the largest value the set may hold
+    """
+    declarations: dict[str, ast.stmt] = {}
+    domains: dict[str, int] = {}
+    for stmt in function.body:
+        if isinstance(stmt, ast.AnnAssign) and isinstance(stmt.target, ast.Name):
+            target, value = stmt.target, stmt.value
+        elif isinstance(stmt, ast.Assign) and len(stmt.targets) == 1 and isinstance(stmt.targets[0], ast.Name):
+            target, value = stmt.targets[0], stmt.value
+        else:
+            continue
+        elements = _empty_or_int_set(value)
+        if elements is not None and target.id not in declarations:
+            declarations[target.id] = stmt
+            domains[target.id] = 0 if not elements else max(elements) + 1
+            if any(element < 0 or element >= limit for element in elements):
+                domains[target.id] = -1
+
+    envs: dict[int, dict[str, tuple[int, int]]] = {}
+    _statement_ranges(function.body, {}, envs)
+    parents = {child: node for node in ast.walk(function) for child in ast.iter_child_nodes(node)}
+    nested = {
+        node.id
+        for scope in ast.walk(function)
+        if scope is not function and isinstance(scope, (ast.FunctionDef, ast.AsyncFunctionDef, ast.Lambda))
+        for node in ast.walk(scope)
+        if isinstance(node, ast.Name)
+    }
+
+    for node in ast.walk(function):
+        if not isinstance(node, ast.Name) or node.id not in declarations or domains[node.id] < 0:
+            continue
+        name = node.id
+        parent = parents.get(node)
+        if parent is declarations[name] and isinstance(node.ctx, ast.Store):
+            continue
+        if isinstance(parent, ast.Compare) and len(parent.ops) == 1 and parent.comparators[0] is node:
+            if isinstance(parent.ops[0], (ast.In, ast.NotIn)):
+                continue
+        if isinstance(parent, ast.Call) and isinstance(parent.func, ast.Name) and parent.func.id == "len":
+            if parent.args == [node] and not parent.keywords:
+                continue
+        call = parents.get(parent)
+        statement = parents.get(call)
+        if (
+            isinstance(parent, ast.Attribute)
+            and parent.attr in _BITSET_METHODS
+            and isinstance(call, ast.Call)
+            and call.func is parent
+            and len(call.args) == _BITSET_METHODS[parent.attr]
+            and not call.keywords
+            and isinstance(statement, ast.Expr)
+            and id(statement) in envs
+        ):
+            if parent.attr != "add":
+                continue
+            interval = int_interval(call.args[0], envs[id(statement)])
+            if interval is not None and interval[0] >= 0 and interval[1] < limit:
+                domains[name] = max(domains[name], interval[1] + 1)
+                continue
+        domains[name] = -1
+
+    return {name: domain for name, domain in domains.items() if domain >= 0 and name not in nested}
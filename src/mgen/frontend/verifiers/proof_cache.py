@@ -0,0 +1,92 @@
+"""Persistent Cache of Z3 Proof Results.
+
+TheoremProver looks every query up here before calling Z3. Entries are keyed
+by the hash of the normalized formula (see TheoremProver.formula_key): the
+formula is simplified and its free constants renamed in order of first
+occurrence, so "0 <= offset_a < size_a" and "0 <= offset_b < size_b" share
+one entry, across functions and across builds.
+
+Only definite verdicts (proved, disproved) are stored. A query that timed out
+or came back unknown is asked again next time, when the budget may allow it
+to finish. Counterexamples are stored under the canonical constant names and
+mapped back to the caller's names on a hit.
+
+The pipeline keeps the cache in <cache_dir>/proofs.json next to the
+conversion cache, so `mgen clean` removes both.
+"""
+
+import json
+import os
+import tempfile
+from pathlib import Path
+from typing import Any, Optional, Union
+
+# Bumped when the file layout changes
+PROOF_CACHE_FORMAT_VERSION = 1
+
+
+class ProofCache:
+    """Stores verdicts of Z3 queries by normalized formula hash."""
+
+    def __init__(self, path: Union[str, Path]):
+        """Initialize the cache.
+
+        Args:
+            path: JSON file holding the entries (read on first use, written by save())
+        """
+        self.path = Path(path)
+        self.hits = 0
+        self.misses = 0
+        self._entries: Optional[dict[str, dict[str, Any]]] = None
+        self._dirty = False
+
+    def _load(self) -> dict[str, dict[str, Any]]:
+        if self._entries is None:
+            self._entries = {}
+            try:
+                data = json.loads(self.path.read_text())
+                if data.get("version") == PROOF_CACHE_FORMAT_VERSION:
+                    self._entries = data.get("proofs", {})
+            except (OSError, ValueError, AttributeError):
+                # Missing or unreadable cache: start empty
+                pass
+        return self._entries
+
+    def get(self, key: str) -> Optional[dict[str, Any]]:
+        """Return the entry stored under key ({"status", "counterexample"}), or None."""
+        entry = self._load().get(key)
+        if entry is None:
+            self.misses += 1
+        else:
+            self.hits += 1
+        return entry
+
+    def put(self, key: str, status: str, counterexample: Optional[dict[str, str]] = None) -> None:
+        """Record the verdict of a query.
+
+        Args:
+            key: Normalized formula hash
+            status: ProofStatus value ("proved" or "disproved")
+            counterexample: Model of a disproved query, by canonical constant name
+        """
+        self._load()[key] = {"status": status, "counterexample": counterexample}
+        self._dirty = True
+
+    def __len__(self) -> int:
+        return len(self._load())
+
+    def save(self) -> None:
+        """Write the entries if any were added, replacing the file atomically."""
+        if not self._dirty or self._entries is None:
+            return
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        data = json.dumps({"version": PROOF_CACHE_FORMAT_VERSION, "proofs": self._entries}, sort_keys=True)
+        fd, temp_name = tempfile.mkstemp(dir=self.path.parent, prefix=f".{self.path.name}.")
+        try:
+            with os.fdopen(fd, "w") as f:
+                f.write(data)
+            os.replace(temp_name, self.path)
+        except BaseException:
+            Path(temp_name).unlink(missing_ok=True)
+            raise
+        self._dirty = False
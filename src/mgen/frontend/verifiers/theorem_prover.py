@@ -2,11 +2,18 @@
 
 This module provides integration with the Z3 theorem prover for formal verification
 of code properties, memory safety, and algorithm correctness.
+
+Each query runs under a per-query timeout, and an optional budget caps the
+total solver time of a TheoremProver: once it is spent, the remaining
+properties come back as TIMEOUT without calling Z3, and callers keep the
+runtime checks those proofs would have removed. With a ProofCache, verdicts
+are reused across functions and builds.
 """
 
 from __future__ import annotations
 
 import ast
+import hashlib
 import time
 from dataclasses import dataclass
 from enum import Enum
@@ -23,6 +30,7 @@ except ImportError:
 
 
 from ..base import AnalysisContext
+from .proof_cache import ProofCache
 
 
 class ProofStatus(Enum):
@@ -87,20 +95,25 @@ class ProofResult:
 
     @property
     def is_safe(self) -> bool:
-        """Returns True if no counterexample was found (proved or unknown)."""
-        return self.status in [ProofStatus.PROVED, ProofStatus.UNKNOWN]
+        """Returns True if no counterexample was found (proved, unknown or timed out)."""
+        return self.status in [ProofStatus.PROVED, ProofStatus.UNKNOWN, ProofStatus.TIMEOUT]
 
 
 class TheoremProver:
     """Z3-based theorem prover for formal verification."""
 
-    def __init__(self, timeout: int = 30000):  # 30 seconds default
+    def __init__(self, timeout: int = 30000, budget: float | None = None, cache: ProofCache | None = None):
         """Initialize the theorem prover.
 
         Args:
-            timeout: Timeout in milliseconds for Z3 solver
+            timeout: Timeout in milliseconds for each Z3 query (default 30 seconds)
+            budget: Total Z3 time in seconds across queries, or None for no limit
+            cache: Persistent cache of verdicts by normalized formula
         """
         self.timeout = timeout
+        self.budget = budget
+        self.cache = cache
+        self.time_spent = 0.0
         self.z3_available = Z3_AVAILABLE
         self.solver = None
 
@@ -116,6 +129,31 @@ class TheoremProver:
             PropertyType.LOOP_INVARIANT: self._create_loop_invariant_template,
         }
 
+    @property
+    def budget_exhausted(self) -> bool:
+        """Returns True once the queries have used up the time budget."""
+        return self.budget is not None and self.time_spent >= self.budget
+
+    def reset_budget(self) -> None:
+        """Start a new budget period (e.g. for the next module)."""
+        self.time_spent = 0.0
+
+    def formula_key(self, formula: Any) -> tuple[str, dict[str, str]]:
+        """Hash a formula up to the names of its free constants.
+
+        Args:
+            formula: Z3 formula
+
+        Returns:
+            (hex digest, mapping of the formula's constant names to canonical names)
+        """
+        simplified = z3.simplify(formula)
+        constants = _free_constants(simplified)
+        canonical = [z3.Const(f"v!{i}", constant.sort()) for i, constant in enumerate(constants)]
+        normalized = z3.substitute(simplified, *zip(constants, canonical)) if constants else simplified
+        digest = hashlib.sha256(f"{z3.get_version_string()}\n{normalized.sexpr()}".encode()).hexdigest()
+        return digest, {str(constant): str(name) for constant, name in zip(constants, canonical)}
+
     def verify_property(self, prop: ProofProperty) -> ProofResult:
         """Verify a single property using Z3.
 
@@ -123,7 +161,8 @@ class TheoremProver:
             prop: Property to verify
 
         Returns:
-            ProofResult with verification outcome
+            ProofResult with verification outcome (TIMEOUT without a solver call
+            once the budget is exhausted)
         """
         if not self.z3_available:
             return ProofResult(
@@ -136,9 +175,25 @@ class TheoremProver:
         start_time = time.time()
 
         try:
-            # Create fresh solver for this property
+            key, names = self.formula_key(prop.z3_formula) if self.cache is not None else ("", {})
+            cached = self.cache.get(key) if self.cache is not None else None
+            if cached is not None:
+                return self._cached_result(prop, cached, names)
+
+            if self.budget_exhausted:
+                return ProofResult(
+                    proof_property=prop,
+                    status=ProofStatus.TIMEOUT,
+                    proof_time=0.0,
+                    error_message="Verification budget exhausted; runtime checks are kept",
+                )
+
+            # Create fresh solver for this property, bounded by what is left of the budget
+            timeout = self.timeout
+            if self.budget is not None:
+                timeout = max(1, min(timeout, int((self.budget - self.time_spent) * 1000)))
             solver = z3.Solver()
-            solver.set("timeout", self.timeout)
+            solver.set("timeout", timeout)
 
             # Add the negation of the property (looking for counterexample)
             negated_formula = z3.Not(prop.z3_formula)
@@ -147,11 +202,16 @@ class TheoremProver:
             # Check satisfiability
             result = solver.check()
             proof_time = time.time() - start_time
+            self.time_spent += proof_time
 
             if result == z3.sat:
                 # Found counterexample - property is false
                 model_result = solver.model()  # type: ignore[func-returns-value]
                 counterexample = self._extract_counterexample(model_result) if model_result else {}
+                if self.cache is not None:
+                    self.cache.put(
+                        key, ProofStatus.DISPROVED.value, {names.get(k, k): v for k, v in counterexample.items()}
+                    )
                 return ProofResult(
                     proof_property=prop,
                     status=ProofStatus.DISPROVED,
@@ -161,12 +221,21 @@ class TheoremProver:
                 )
             elif result == z3.unsat:
                 # No counterexample - property is true
+                if self.cache is not None:
+                    self.cache.put(key, ProofStatus.PROVED.value)
                 return ProofResult(
                     proof_property=prop,
                     status=ProofStatus.PROVED,
                     proof_time=proof_time,
                     verification_steps=[f"Z3 proved property in {proof_time:.3f}s"],
                 )
+            elif solver.reason_unknown() in ("timeout", "canceled"):
+                return ProofResult(
+                    proof_property=prop,
+                    status=ProofStatus.TIMEOUT,
+                    proof_time=proof_time,
+                    error_message=f"Z3 timed out after {timeout} ms; runtime checks are kept",
+                )
             else:
                 # Unknown result (timeout or undecidable)
                 return ProofResult(
@@ -181,6 +250,17 @@ class TheoremProver:
                 proof_property=prop, status=ProofStatus.ERROR, proof_time=time.time() - start_time, error_message=str(e)
             )
 
+    def _cached_result(self, prop: ProofProperty, entry: dict[str, Any], names: dict[str, str]) -> ProofResult:
+        """Rebuild the ProofResult of a cache hit, with the counterexample in the property's names."""
+        status = ProofStatus(entry["status"])
+        if status == ProofStatus.DISPROVED:
+            original = {canonical: name for name, canonical in names.items()}
+            counterexample = {original.get(k, k): v for k, v in (entry.get("counterexample") or {}).items()}
+            return ProofResult(proof_property=prop, status=status, proof_time=0.0, counterexample=counterexample)
+        return ProofResult(
+            proof_property=prop, status=status, proof_time=0.0, verification_steps=["Reused cached Z3 proof"]
+        )
+
     def verify_multiple_properties(self, properties: list[ProofProperty]) -> list[ProofResult]:
         """Verify multiple properties efficiently.
 
@@ -367,6 +447,26 @@ class TheoremProver:
         )
 
 
+def _free_constants(formula: Any) -> list[Any]:
+    """Uninterpreted constants of a formula in order of first occurrence."""
+    constants: list[Any] = []
+    seen: set[int] = set()
+    stack = [formula]
+    while stack:
+        expr = stack.pop()
+        if expr.get_id() in seen:
+            continue
+        seen.add(expr.get_id())
+        if z3.is_quantifier(expr):
+            stack.append(expr.body())
+        elif z3.is_const(expr) and expr.decl().kind() == z3.Z3_OP_UNINTERPRETED:
+            constants.append(expr)
+        elif z3.is_app(expr):
+            # Reversed so children are visited left to right
+            stack.extend(reversed(expr.children()))
+    return constants
+
+
 class SafetyPropertyExtractor(ast.NodeVisitor):
     """AST visitor to extract safety properties from Python code."""
 
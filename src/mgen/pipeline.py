@@ -21,18 +21,30 @@ Usage:
 
     # With build
     result = pipeline.convert("my_module.py", build_mode=BuildMode.DIRECT)
+
+    # Several modules in parallel, each after the modules it imports
+    results = convert_modules(["a.py", "b.py"], PipelineConfig(target_language="rust"), jobs=4)
 """
 
 import ast
+import dataclasses
+import os
 from collections.abc import Callable
+from concurrent.futures import FIRST_COMPLETED, Future, ProcessPoolExecutor, wait
+from contextlib import AbstractContextManager, nullcontext
 from dataclasses import dataclass, field
 from enum import Enum
 from pathlib import Path
 from typing import Any, Optional, Union
 
+from .backends.base import fast_math_modes
 from .backends.preferences import BackendPreferences
+from .backends.python_extension import extension_filename
 from .backends.registry import registry
+from .cache import CacheEntry, ConversionCache, generation_options
 from .common import log
+from .common.module_system import ModuleResolver
+from .profiling import PipelineProfiler
 
 # Import frontend analysis components
 try:
@@ -47,7 +59,9 @@ try:
         FunctionSpecializer,
         ImmutabilityAnalyzer,
         LoopAnalyzer,
+        LoopNestOptimizer,
         MutabilityClass,
+        ProofCache,
         StaticAnalyzer,
         StaticPythonSubsetValidator,
         SymbolicExecutor,
@@ -121,6 +135,11 @@ class PipelineConfig:
     build_mode: BuildMode = BuildMode.NONE
     compiler: Optional[str] = None
     compiler_flags: Optional[list[str]] = None
+    target_cpu: Optional[str] = None  # LLVM/C/C++: "native" or a CPU name (default: generic baseline)
+    target_features: Optional[str] = None  # LLVM: feature overrides, e.g. "+avx2,-avx512f"
+    pgo_generate_dir: Optional[str] = None  # C/LLVM: build instrumented, profiles written here
+    pgo_use_profile: Optional[str] = None  # C/LLVM: profile from an instrumented run to optimize with
+    build_profile: str = "default"  # C/C++: "release" adds LTO and linker section garbage collection
     include_dirs: Optional[list[str]] = None
     libraries: Optional[list[str]] = None
     enable_advanced_analysis: bool = True
@@ -129,8 +148,15 @@ class PipelineConfig:
     strict_verification: bool = (
         False  # Halt code generation on verification failures (requires enable_formal_verification)
     )
+    verification_timeout_ms: int = 2000  # Z3 time limit per query
+    verification_budget: Optional[float] = 20.0  # Z3 seconds per module; unproved accesses keep runtime checks
     backend_preferences: Optional[BackendPreferences] = None
     progress_callback: Optional[Callable[[PipelinePhase, str], None]] = None
+    profiler: Optional[PipelineProfiler] = None  # Records per-phase and per-analyzer timing and memory
+    cache_dir: Optional[str] = None  # Reuse conversions of unchanged modules stored here (see mgen.cache)
+    specialize_functions: bool = False  # Clone functions per literal argument and argument type (FunctionSpecializer)
+    interchange_loops: bool = False  # Make reduction nests over matrices walk rows innermost (LoopNestOptimizer)
+    source_map: bool = False  # C/C++/LLVM: map generated code to the .py lines (#line, DWARF) and build with -g
 
     def __post_init__(self) -> None:
         """Initialize default values."""
@@ -161,6 +187,7 @@ class PipelineResult:
     errors: list[str] = field(default_factory=list)
     warnings: list[str] = field(default_factory=list)
     generated_files: list[str] = field(default_factory=list)
+    cached: bool = False  # Phases 1-6 were skipped and their output restored from the conversion cache
 
 
 def _map_optimization_level(pipeline_level: OptimizationLevel) -> "FrontendOptimizationLevel":
@@ -189,6 +216,7 @@ class MGenPipeline:
 
         self.config = config
         self.log = log.config(self.__class__.__name__)
+        self.cache = ConversionCache(config.cache_dir) if config.cache_dir else None
         self._init_components()
 
     def _report_progress(self, phase: PipelinePhase, message: str) -> None:
@@ -201,6 +229,18 @@ class MGenPipeline:
         if self.config.progress_callback:
             self.config.progress_callback(phase, message)
 
+    def _profile(self, name: str, category: str = "analyzer", **args: Any) -> AbstractContextManager[Any]:
+        """Profile a block as a span when a profiler is configured.
+
+        Args:
+            name: Span name
+            category: Span category (see PipelineProfiler.span)
+            **args: Extra values recorded with the span
+        """
+        if self.config.profiler is None:
+            return nullcontext()
+        return self.config.profiler.span(name, category, **args)
+
     def _init_components(self) -> None:
         """Initialize pipeline components."""
         # Get backend for target language
@@ -251,9 +291,17 @@ class MGenPipeline:
                 else:
                     mode = "strict mode" if self.config.strict_verification else "warning mode"
                     self.log.info(f"Formal verification enabled in {mode} (Z3 available)")
-                    self.bounds_prover = BoundsProver()
-                    self.correctness_prover = CorrectnessProver()
-                    self.theorem_prover = TheoremProver()
+                    # Verdicts are kept next to the conversion cache and reused by later builds
+                    proof_cache = None
+                    if self.config.cache_dir:
+                        proof_cache = ProofCache(Path(self.config.cache_dir) / "proofs.json")
+                    self.theorem_prover = TheoremProver(
+                        timeout=self.config.verification_timeout_ms,
+                        budget=self.config.verification_budget,
+                        cache=proof_cache,
+                    )
+                    self.bounds_prover = BoundsProver(self.theorem_prover)
+                    self.correctness_prover = CorrectnessProver(self.theorem_prover)
             else:
                 if self.config.strict_verification:
                     self.log.warning(
@@ -302,57 +350,43 @@ class MGenPipeline:
             success=True, input_file=str(input_path), output_files={}, target_language=self.config.target_language
         )
 
+        with self._profile(input_path.name, "file", target=self.config.target_language):
+            return self._run_phases(input_path, output_dir, result)
+
+    def _run_phases(self, input_path: Path, output_dir: Path, result: PipelineResult) -> PipelineResult:
+        """Run the seven pipeline phases on one input file."""
         try:
             self.log.info(f"Starting pipeline conversion for: {input_path} -> {self.config.target_language}")
 
             # Read input file
             source_code = input_path.read_text()
 
-            # Phase 1: Validation
-            self.log.debug("Starting validation phase")
-            self._report_progress(PipelinePhase.VALIDATION, "Validating Python code")
-            if not self._validation_phase(source_code, input_path, result):
-                self.log.error("Validation phase failed")
-                return result
-
-            # Phase 2: Analysis
-            self.log.debug("Starting analysis phase")
-            self._report_progress(PipelinePhase.ANALYSIS, "Analyzing AST and types")
-            analysis_result = self._analysis_phase(source_code, result)
-            if analysis_result is None:
-                self.log.error("Analysis phase failed")
+            cache_key = None
+            if self.cache is not None:
+                cache_key = self.cache.key(input_path, source_code, generation_options(self.config))
+                if self._restore_cached(cache_key, input_path, output_dir, result):
+                    self.log.info(f"Using cached conversion of {input_path}")
+                    self._report_progress(PipelinePhase.GENERATION, "Reusing cached conversion")
+                    cache_key = None
+                elif not self._convert_phases(source_code, input_path, output_dir, result):
+                    return result
+            elif not self._convert_phases(source_code, input_path, output_dir, result):
                 return result
 
-            # Phase 3: Python Optimization
-            self.log.debug("Starting Python optimization phase")
-            self._report_progress(PipelinePhase.PYTHON_OPTIMIZATION, "Optimizing Python IR")
-            optimized_analysis = self._python_optimization_phase(source_code, analysis_result, result)
-
-            # Phase 4: Mapping (language-agnostic to target-specific)
-            self.log.debug("Starting mapping phase")
-            self._report_progress(PipelinePhase.MAPPING, f"Mapping to {self.config.target_language.upper()}")
-            mapped_result = self._mapping_phase(optimized_analysis, result)
-
-            # Phase 5: Target Optimization
-            self.log.debug("Starting target optimization phase")
-            self._report_progress(
-                PipelinePhase.TARGET_OPTIMIZATION, f"Optimizing {self.config.target_language.upper()} code"
-            )
-            target_optimized = self._target_optimization_phase(mapped_result, result)
-
-            # Phase 6: Generation
-            self.log.debug("Starting generation phase")
-            self._report_progress(PipelinePhase.GENERATION, f"Generating {self.config.target_language.upper()} source")
-            if not self._generation_phase(source_code, target_optimized, output_dir, result):
-                self.log.error("Generation phase failed")
-                return result
+            if cache_key is not None and result.success and result.generated_code is not None:
+                entry = CacheEntry(
+                    result.generated_code, self.backend.get_file_extension(), list(result.warnings), result.phase_results
+                )
+                self.cache.store(cache_key, entry)  # type: ignore[union-attr]
 
             # Phase 7: Build
             if self.config.build_mode != BuildMode.NONE:
                 self.log.debug(f"Starting build phase with mode: {self.config.build_mode}")
                 build_msg = "Compiling" if self.config.build_mode == BuildMode.DIRECT else "Generating build file"
                 self._report_progress(PipelinePhase.BUILD, build_msg)
-                if not self._build_phase(output_dir, result):
+                with self._profile(PipelinePhase.BUILD.value, "phase"):
+                    built = self._build_phase(output_dir, result)
+                if not built:
                     self.log.error("Build phase failed")
                     return result
 
@@ -365,6 +399,135 @@ class MGenPipeline:
             result.errors.append(f"Pipeline error: {str(e)}")
             return result
 
+    def _convert_phases(self, source_code: str, input_path: Path, output_dir: Path, result: PipelineResult) -> bool:
+        """Run phases 1-6 (validation through generation); returns False if a phase failed."""
+        # Typed clones stand in for unannotated originals, so specialization precedes validation
+        if self.config.specialize_functions:
+            source_code = self._specialize_functions(source_code)
+        if self.config.interchange_loops:
+            source_code = self._interchange_loops(source_code)
+
+        # Phase 1: Validation
+        self.log.debug("Starting validation phase")
+        self._report_progress(PipelinePhase.VALIDATION, "Validating Python code")
+        with self._profile(PipelinePhase.VALIDATION.value, "phase"):
+            valid = self._validation_phase(source_code, input_path, result)
+        if not valid:
+            self.log.error("Validation phase failed")
+            return False
+
+        # Phase 2: Analysis
+        self.log.debug("Starting analysis phase")
+        self._report_progress(PipelinePhase.ANALYSIS, "Analyzing AST and types")
+        with self._profile(PipelinePhase.ANALYSIS.value, "phase"):
+            analysis_result = self._analysis_phase(source_code, result)
+        if analysis_result is None:
+            self.log.error("Analysis phase failed")
+            return False
+
+        # Phase 3: Python Optimization
+        self.log.debug("Starting Python optimization phase")
+        self._report_progress(PipelinePhase.PYTHON_OPTIMIZATION, "Optimizing Python IR")
+        with self._profile(PipelinePhase.PYTHON_OPTIMIZATION.value, "phase"):
+            optimized_analysis = self._python_optimization_phase(source_code, analysis_result, result)
+
+        # Phase 4: Mapping (language-agnostic to target-specific)
+        self.log.debug("Starting mapping phase")
+        self._report_progress(PipelinePhase.MAPPING, f"Mapping to {self.config.target_language.upper()}")
+        with self._profile(PipelinePhase.MAPPING.value, "phase"):
+            mapped_result = self._mapping_phase(optimized_analysis, result)
+
+        # Phase 5: Target Optimization
+        self.log.debug("Starting target optimization phase")
+        self._report_progress(
+            PipelinePhase.TARGET_OPTIMIZATION, f"Optimizing {self.config.target_language.upper()} code"
+        )
+        with self._profile(PipelinePhase.TARGET_OPTIMIZATION.value, "phase"):
+            target_optimized = self._target_optimization_phase(mapped_result, result)
+
+        # Phase 6: Generation
+        self.log.debug("Starting generation phase")
+        self._report_progress(PipelinePhase.GENERATION, f"Generating {self.config.target_language.upper()} source")
+        with self._profile(PipelinePhase.GENERATION.value, "phase"):
+            generated = self._generation_phase(source_code, target_optimized, output_dir, result)
+        if not generated:
+            self.log.error("Generation phase failed")
+            return False
+
+        return True
+
+    def _specialize_functions(self, source_code: str) -> str:
+        """Add the FunctionSpecializer's constant and typed function clones to a module and redirect their calls.
+
+        Later phases see the specialized source, so their line numbers refer to it.
+
+        Returns:
+            The specialized source, or source_code if nothing was specialized
+        """
+        if not FRONTEND_AVAILABLE:
+            return source_code
+        try:
+            tree = ast.parse(source_code)
+        except SyntaxError:
+            return source_code  # Reported by the validation phase
+
+        level = _map_optimization_level(self.config.optimization_level)
+        context = AnalysisContext(
+            source_code=source_code, ast_node=tree, analysis_result=None, optimization_level=level
+        )
+        with self._profile("specialize_functions", "optimizer"):
+            specialization = FunctionSpecializer(level).optimize(context)
+        if not specialization.success or not specialization.metadata.get("specializations_created"):
+            return source_code
+        return ast.unparse(specialization.optimized_ast)
+
+    def _interchange_loops(self, source_code: str) -> str:
+        """Apply the LoopNestOptimizer's loop interchanges to a module.
+
+        Every backend then converts the interchanged nests; like specialization,
+        later phases report line numbers of the rewritten source.
+
+        Returns:
+            The rewritten source, or source_code if no nest qualified
+        """
+        if not FRONTEND_AVAILABLE:
+            return source_code
+        try:
+            tree = ast.parse(source_code)
+        except SyntaxError:
+            return source_code  # Reported by the validation phase
+
+        level = _map_optimization_level(self.config.optimization_level)
+        context = AnalysisContext(
+            source_code=source_code, ast_node=tree, analysis_result=None, optimization_level=level
+        )
+        with self._profile("interchange_loops", "optimizer"):
+            interchange = LoopNestOptimizer(level).optimize(context)
+        if not interchange.success or not interchange.metadata.get("interchanged"):
+            return source_code
+        for transformation in interchange.transformations:
+            self.log.debug(transformation)
+        return ast.unparse(interchange.optimized_ast)
+
+    def _restore_cached(self, key: str, input_path: Path, output_dir: Path, result: PipelineResult) -> bool:
+        """Restore the output of phases 1-6 from the conversion cache; returns False on a miss."""
+        entry = self.cache.load(key) if self.cache is not None else None
+        if entry is None:
+            return False
+        source_file_path = output_dir / (input_path.stem + entry.file_extension)
+        source_file_path.write_text(entry.generated_code)
+
+        result.cached = True
+        result.generated_code = entry.generated_code
+        result.output_files[f"{self.config.target_language}_source"] = str(source_file_path)
+        result.generated_files.append(str(source_file_path))
+        result.warnings.extend(entry.warnings)
+        result.phase_results.update(entry.phase_results)
+        generation = result.phase_results.setdefault(PipelinePhase.GENERATION, {})
+        if isinstance(generation, dict):
+            generation["source_file"] = str(source_file_path)
+        return True
+
     def _validation_phase(self, source_code: str, input_path: Path, result: PipelineResult) -> bool:
         """Phase 1: Validate static-python style and translatability."""
         try:
@@ -373,7 +536,8 @@ class MGenPipeline:
 
             if FRONTEND_AVAILABLE and self.config.enable_advanced_analysis:
                 # Validate Python subset compatibility
-                validation_result = self.subset_validator.validate_code(source_code)
+                with self._profile("subset_validation"):
+                    validation_result = self.subset_validator.validate_code(source_code)
                 result.phase_results[PipelinePhase.VALIDATION] = validation_result
 
                 if not validation_result.is_valid:
@@ -384,7 +548,8 @@ class MGenPipeline:
                 # Check memory safety constraints for C/C++ targets
                 if MEMORY_SAFETY_AVAILABLE and self.config.target_language in ["c", "cpp"]:
                     memory_safety_checker = MemorySafetyChecker(language=self.config.target_language)
-                    memory_warnings = memory_safety_checker.check_code(source_code)
+                    with self._profile("memory_safety"):
+                        memory_warnings = memory_safety_checker.check_code(source_code)
 
                     # Add memory safety warnings/errors
                     for warning in memory_warnings:
@@ -409,6 +574,7 @@ class MGenPipeline:
 
                     # Parse AST for verification
                     tree = ast.parse(source_code)
+                    self.bounds_prover.theorem_prover.reset_budget()
 
                     # Verify each function
                     for node in ast.walk(tree):
@@ -424,7 +590,8 @@ class MGenPipeline:
                             )
 
                             # Run bounds verification
-                            proof = self.bounds_prover.verify_memory_safety(context)
+                            with self._profile("bounds_prover", "verifier", function=node.name):
+                                proof = self.bounds_prover.verify_memory_safety(context)
 
                             # Report verification results
                             if not proof.is_safe:
@@ -446,6 +613,8 @@ class MGenPipeline:
                                         f"Fix unsafe memory accesses or disable strict_verification mode."
                                     )
                                     self.log.error(f"Verification failed in strict mode: {proof.summary}")
+                                    if self.bounds_prover.theorem_prover.cache is not None:
+                                        self.bounds_prover.theorem_prover.cache.save()
                                     return False
 
                             # Add verification recommendations
@@ -457,6 +626,9 @@ class MGenPipeline:
 
                             self.log.debug(f"Verification complete: {proof.summary}")
 
+                    if self.bounds_prover.theorem_prover.cache is not None:
+                        self.bounds_prover.theorem_prover.cache.save()
+
             else:
                 # Basic validation - just check if it parses
                 result.phase_results[PipelinePhase.VALIDATION] = {"basic_parse": True}
@@ -477,7 +649,8 @@ class MGenPipeline:
         try:
             if FRONTEND_AVAILABLE and self.config.enable_advanced_analysis:
                 # Use comprehensive AST analysis
-                analysis_result = self.ast_analyzer.analyze(source_code)
+                with self._profile("ast_analysis"):
+                    analysis_result = self.ast_analyzer.analyze(source_code)
                 result.phase_results[PipelinePhase.ANALYSIS] = {"ast_analysis": analysis_result}
 
                 if not analysis_result.convertible:
@@ -502,26 +675,31 @@ class MGenPipeline:
                 )
 
                 # Static analysis (control flow, data flow)
-                static_report = self.static_analyzer.analyze(analysis_context)
+                with self._profile("static_analysis"):
+                    static_report = self.static_analyzer.analyze(analysis_context)
                 advanced_analysis["static_analysis"] = static_report
 
                 # Symbolic execution
-                symbolic_report = self.symbolic_executor.analyze(analysis_context)
+                with self._profile("symbolic_execution"):
+                    symbolic_report = self.symbolic_executor.analyze(analysis_context)
                 advanced_analysis["symbolic_execution"] = symbolic_report
 
                 # Bounds checking
-                bounds_report = self.bounds_checker.analyze(analysis_context)
+                with self._profile("bounds_checking"):
+                    bounds_report = self.bounds_checker.analyze(analysis_context)
                 advanced_analysis["bounds_checking"] = bounds_report
 
                 # Call graph analysis
-                call_graph_report = self.call_graph_analyzer.analyze(analysis_context)
+                with self._profile("call_graph"):
+                    call_graph_report = self.call_graph_analyzer.analyze(analysis_context)
                 advanced_analysis["call_graph"] = call_graph_report
 
                 # Flow-sensitive type inference
                 type_inference_results: dict[str, dict[str, Any]] = {}
                 for node in ast.walk(ast_root):
                     if isinstance(node, ast.FunctionDef):
-                        func_inference = self.type_inference_engine.analyze_function_signature_enhanced(node)
+                        with self._profile("type_inference", function=node.name):
+                            func_inference = self.type_inference_engine.analyze_function_signature_enhanced(node)
                         type_inference_results[node.name] = func_inference
                         self.log.debug(f"Type inference completed for function: {node.name}")
 
@@ -529,13 +707,15 @@ class MGenPipeline:
 
                 # Immutability analysis
                 immutability_analyzer = ImmutabilityAnalyzer()
-                immutability_results = immutability_analyzer.analyze_module(ast_root)
+                with self._profile("immutability"):
+                    immutability_results = immutability_analyzer.analyze_module(ast_root)
                 advanced_analysis["immutability"] = immutability_results
                 self.log.debug(f"Immutability analysis completed for {len(immutability_results)} functions")
 
                 # Python constraint checking (uses immutability results)
                 python_constraint_checker = PythonConstraintChecker(immutability_results=immutability_results)
-                constraint_violations = python_constraint_checker.check_code(source_code)
+                with self._profile("python_constraints"):
+                    constraint_violations = python_constraint_checker.check_code(source_code)
                 advanced_analysis["python_constraints"] = constraint_violations
 
                 # Add warnings/errors from constraint violations
@@ -611,19 +791,23 @@ class MGenPipeline:
                 optimizations = {}
 
                 # Compile-time evaluation
-                compile_time_result = self.compile_time_evaluator.optimize(context)
+                with self._profile("compile_time_evaluation", "optimizer"):
+                    compile_time_result = self.compile_time_evaluator.optimize(context)
                 optimizations["compile_time"] = compile_time_result
 
                 # Loop analysis
-                loop_result = self.loop_analyzer.optimize(context)
+                with self._profile("loop_analysis", "optimizer"):
+                    loop_result = self.loop_analyzer.optimize(context)
                 optimizations["loops"] = loop_result
 
                 # Function specialization
-                specialization_result = self.function_specializer.optimize(context)
+                with self._profile("function_specialization", "optimizer"):
+                    specialization_result = self.function_specializer.optimize(context)
                 optimizations["specialization"] = specialization_result
 
                 # Vectorization detection
-                vectorization_result = self.vectorization_detector.optimize(context)
+                with self._profile("vectorization_detection", "optimizer"):
+                    vectorization_result = self.vectorization_detector.optimize(context)
                 optimizations["vectorization"] = vectorization_result
 
                 result.phase_results[PipelinePhase.PYTHON_OPTIMIZATION] = optimizations
@@ -688,7 +872,9 @@ class MGenPipeline:
         """Phase 6: Target language code generation."""
         try:
             # Generate code using selected backend
-            generated_code = self.emitter.emit_module(source_code, analysis_result)
+            self.emitter.source_file = str(Path(result.input_file).resolve()) if self.config.source_map else None
+            with self._profile("emit_module", "emitter", backend=self.backend.get_name()):
+                generated_code = self.emitter.emit_module(source_code, analysis_result)
 
             # Write source file with correct extension
             file_extension = self.backend.get_file_extension()
@@ -741,19 +927,42 @@ class MGenPipeline:
                 }
                 opt_level = opt_level_map.get(self.config.optimization_level, 2)
 
-                # Check if builder supports opt_level parameter (LLVM does)
+                direct_options: dict[str, Any] = {"opt_level": opt_level}
+                if self.config.target_cpu:
+                    direct_options["cpu"] = self.config.target_cpu
+                if self.config.target_features:
+                    direct_options["features"] = self.config.target_features
+                if self.config.pgo_generate_dir:
+                    direct_options["pgo_generate"] = self.config.pgo_generate_dir
+                if self.config.pgo_use_profile:
+                    direct_options["pgo_use"] = self.config.pgo_use_profile
+                if self.config.build_profile != "default":
+                    direct_options["profile"] = self.config.build_profile
+                if self.config.source_map:
+                    direct_options["debug"] = True
+                preferences = self.config.backend_preferences
+                extension = preferences is not None and preferences.get("target_mode") == "extension"
+                if extension:
+                    direct_options["target_mode"] = "extension"
+                fast_math = fast_math_modes(preferences.get("fast_math") if preferences is not None else None)
+                if fast_math:
+                    direct_options["fast_math"] = fast_math
+
+                # Pass the options to builders that take them, by name or via **kwargs (LLVM does)
                 import inspect
 
-                sig = inspect.signature(self.builder.compile_direct)
-                if "opt_level" in sig.parameters:
-                    success = self.builder.compile_direct(
-                        str(source_file_path), str(output_dir), opt_level=opt_level
-                    )
+                params = inspect.signature(self.builder.compile_direct).parameters
+                takes_options = "opt_level" in params or any(
+                    param.kind is inspect.Parameter.VAR_KEYWORD for param in params.values()
+                )
+                if takes_options:
+                    success = self.builder.compile_direct(str(source_file_path), str(output_dir), **direct_options)
                 else:
                     success = self.builder.compile_direct(str(source_file_path), str(output_dir))
 
                 if success:
-                    executable_path = output_dir / source_file_path.stem
+                    stem = source_file_path.stem
+                    executable_path = output_dir / (extension_filename(stem) if extension else stem)
                     result.executable_path = str(executable_path)
                     result.output_files["executable"] = str(executable_path)
                 else:
@@ -793,3 +1002,69 @@ def convert_python_to_language(
     )
     pipeline = MGenPipeline(config)
     return pipeline.convert(input_path, output_path)
+
+
+def convert_modules(
+    input_paths: list[Union[str, Path]], config: PipelineConfig, jobs: Optional[int] = None
+) -> list[PipelineResult]:
+    """Convert several modules in a process pool, each after the modules it imports.
+
+    Every module gets a fresh pipeline in a worker process. A module whose
+    imported module failed is not converted; import cycles do not block (when
+    no module is ready the remaining ones are started anyway). With jobs > 1
+    the config's progress_callback and profiler are dropped, since they cannot
+    cross process boundaries.
+
+    Args:
+        input_paths: Python files to convert
+        config: Pipeline configuration shared by all modules
+        jobs: Worker processes (default: one per CPU; 1 converts in this process)
+
+    Returns:
+        One result per input, in input order
+    """
+    paths = [Path(path) for path in input_paths]
+    graph = ModuleResolver().dependency_graph(paths)
+    workers = jobs or os.cpu_count() or 1
+    worker_config = config if workers == 1 else dataclasses.replace(config, progress_callback=None, profiler=None)
+
+    results: dict[Path, PipelineResult] = {}
+    finished: set[str] = set()
+    failed: set[str] = set()
+
+    def record(path: Path, result: PipelineResult) -> None:
+        results[path] = result
+        finished.add(path.stem)
+        if not result.success:
+            failed.add(path.stem)
+
+    pending = list(paths)
+    running: dict[Future[PipelineResult], Path] = {}
+    with ProcessPoolExecutor(max_workers=workers) if workers > 1 else nullcontext() as pool:
+        while pending or running:
+            ready = [path for path in pending if graph[path.stem] <= finished] or ([] if running else list(pending))
+            for path in ready:
+                pending.remove(path)
+                blocked = graph[path.stem] & failed
+                if blocked:
+                    message = f"Not converted: imported module(s) failed: {', '.join(sorted(blocked))}"
+                    record(path, PipelineResult(False, str(path), {}, config.target_language, errors=[message]))
+                elif pool is None:
+                    record(path, _convert_module(worker_config, path))
+                else:
+                    running[pool.submit(_convert_module, worker_config, path)] = path
+            if running:
+                done, _ = wait(running, return_when=FIRST_COMPLETED)
+                for future in done:
+                    path = running.pop(future)
+                    try:
+                        record(path, future.result())
+                    except Exception as e:
+                        error = f"Pipeline error: {e}"
+                        record(path, PipelineResult(False, str(path), {}, config.target_language, errors=[error]))
+    return [results[path] for path in paths]
+
+
+def _convert_module(config: PipelineConfig, input_path: Path) -> PipelineResult:
+    """Convert one module with a fresh pipeline (runs in convert_modules' workers)."""
+    return MGenPipeline(config).convert(input_path)
@@ -0,0 +1,169 @@
+"""Phase and analyzer profiling for the MGen pipeline.
+
+A PipelineProfiler records nested spans - one per pipeline phase and one per
+analyzer, optimizer, verifier or emitter call inside it - with their wall
+time, CPU time and peak Python heap usage, and writes them as a Chrome trace
+(chrome://tracing, https://ui.perfetto.dev) so slow translation units can be
+diagnosed directly.
+
+Peak memory comes from tracemalloc, which is started for the profiler's
+lifetime; it slows the pipeline down, so profile timings are comparable with
+each other but not with unprofiled runs.
+
+Example:
+    >>> profiler = PipelineProfiler()
+    >>> pipeline = MGenPipeline(PipelineConfig(target_language="rust", profiler=profiler))
+    >>> pipeline.convert("module.py")
+    >>> profiler.write_chrome_trace("trace.json")
+"""
+
+import json
+import os
+import threading
+import time
+import tracemalloc
+from collections.abc import Iterator
+from contextlib import contextmanager
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Optional, Union
+
+
+@dataclass
+class ProfileSpan:
+    """One timed region of a pipeline run."""
+
+    name: str
+    category: str
+    start: float
+    wall_time: float = 0.0
+    cpu_time: float = 0.0
+    # Highest traced heap size while the span was open, in bytes
+    peak_memory: int = 0
+    depth: int = 0
+    args: dict[str, Any] = field(default_factory=dict)
+
+
+class PipelineProfiler:
+    """Collects nested profiling spans across one or more pipeline runs."""
+
+    def __init__(self, trace_memory: bool = True) -> None:
+        """Initialize the profiler.
+
+        Args:
+            trace_memory: Record peak memory per span with tracemalloc
+        """
+        self.spans: list[ProfileSpan] = []
+        self.trace_memory = trace_memory
+        self._origin = time.perf_counter()
+        # Open spans, innermost last, with their CPU time at entry
+        self._stack: list[tuple[ProfileSpan, float]] = []
+        self._started_tracemalloc = False
+        if trace_memory and not tracemalloc.is_tracing():
+            tracemalloc.start()
+            self._started_tracemalloc = True
+
+    @contextmanager
+    def span(self, name: str, category: str = "analyzer", **args: Any) -> Iterator[ProfileSpan]:
+        """Time the enclosed block as a span.
+
+        Args:
+            name: Span name shown in the trace (e.g. "analysis", "static_analysis")
+            category: "file", "phase", "analyzer", "optimizer", "verifier", "emitter" or "build"
+            **args: Extra values shown with the span in the trace viewer
+        """
+        record = ProfileSpan(name, category, time.perf_counter() - self._origin, depth=len(self._stack), args=args)
+        if self.trace_memory:
+            self._close_peak_window()
+        self._stack.append((record, time.process_time()))
+        try:
+            yield record
+        finally:
+            _, cpu_start = self._stack.pop()
+            record.cpu_time = time.process_time() - cpu_start
+            record.wall_time = time.perf_counter() - self._origin - record.start
+            if self.trace_memory:
+                record.peak_memory = max(record.peak_memory, tracemalloc.get_traced_memory()[1])
+                if self._stack:
+                    parent = self._stack[-1][0]
+                    parent.peak_memory = max(parent.peak_memory, record.peak_memory)
+                tracemalloc.reset_peak()
+            self.spans.append(record)
+
+    def _close_peak_window(self) -> None:
+        """Credit the peak since the last reset to the open span, then reset it.
+
+        tracemalloc has one peak counter; resetting it at every span boundary
+        and folding each child's peak into its parent keeps every span's peak
+        exact.
+        """
+        if self._stack:
+            parent = self._stack[-1][0]
+            parent.peak_memory = max(parent.peak_memory, tracemalloc.get_traced_memory()[1])
+        tracemalloc.reset_peak()
+
+    def stop(self) -> None:
+        """Stop tracemalloc if this profiler started it."""
+        if self._started_tracemalloc:
+            tracemalloc.stop()
+            self._started_tracemalloc = False
+
+    def totals(self, category: Optional[str] = None) -> dict[str, tuple[float, float]]:
+        """Sum wall and CPU time per span name.
+
+        Args:
+            category: Only include spans of this category
+
+        Returns:
+            name -> (wall seconds, CPU seconds)
+        """
+        totals: dict[str, tuple[float, float]] = {}
+        for record in self.spans:
+            if category is None or record.category == category:
+                wall, cpu = totals.get(record.name, (0.0, 0.0))
+                totals[record.name] = (wall + record.wall_time, cpu + record.cpu_time)
+        return totals
+
+    def chrome_trace(self) -> dict[str, Any]:
+        """Build the Chrome trace event format representation of the spans.
+
+        Each span becomes a complete ("X") event; wall time is the event's
+        duration, CPU time and peak memory are in its args.
+        """
+        pid, tid = os.getpid(), threading.get_ident()
+        events: list[dict[str, Any]] = [
+            {"name": "process_name", "ph": "M", "pid": pid, "tid": tid, "args": {"name": "mgen"}},
+        ]
+        for record in sorted(self.spans, key=lambda span: (span.start, span.depth)):
+            args = {"cpu_ms": round(record.cpu_time * 1e3, 3), **record.args}
+            if self.trace_memory:
+                args["peak_memory_kb"] = round(record.peak_memory / 1024, 1)
+            events.append(
+                {
+                    "name": record.name,
+                    "cat": record.category,
+                    "ph": "X",
+                    "ts": round(record.start * 1e6, 3),
+                    "dur": round(record.wall_time * 1e6, 3),
+                    "pid": pid,
+                    "tid": tid,
+                    "args": args,
+                }
+            )
+        return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+    def write_chrome_trace(self, path: Union[str, Path]) -> None:
+        """Write the spans as a Chrome trace JSON file."""
+        Path(path).write_text(json.dumps(self.chrome_trace(), indent=1) + "\n")
+
+    def summary_lines(self) -> list[str]:
+        """Summarize the phases as text lines: wall time, CPU time and peak memory."""
+        lines = [f"{'Phase':<24} {'Wall (ms)':>10} {'CPU (ms)':>10} {'Peak (KB)':>10}"]
+        peaks: dict[str, int] = {}
+        for record in self.spans:
+            if record.category == "phase":
+                peaks[record.name] = max(peaks.get(record.name, 0), record.peak_memory)
+        for name, (wall, cpu) in self.totals("phase").items():
+            peak = f"{peaks[name] / 1024:.0f}" if self.trace_memory else "-"
+            lines.append(f"{name:<24} {wall * 1e3:>10.1f} {cpu * 1e3:>10.1f} {peak:>10}")
+        return lines
@@ -8,13 +8,31 @@ def fibonacci(n: int) -> int:
     return fibonacci(n - 1) + fibonacci(n - 2)
 
 
+def fibonacci_index(limit: int) -> int:
+    """Smallest n whose Fibonacci number reaches limit."""
+    n: int = 0
+    current: int = 0
+    following: int = 1
+    while current < limit:
+        next_value: int = current + following
+        current = following
+        following = next_value
+        n += 1
+    return n
+
+
 def main() -> int:
     """Run Fibonacci benchmark."""
-    # Calculate Fibonacci numbers up to n=30
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
+    # The recursive call count grows like fib(n): n = 30 at 1x, about 5 more per 10x
+    n: int = fibonacci_index(832040 * scale)
+
+    # Sum fib(0) .. fib(n - 1) so every call contributes to the output
     result: int = 0
-    for i in range(30):
-        result = fibonacci(i)
+    for i in range(n):
+        result += fibonacci(i)
 
-    # Print final result
     print(result)
     return 0
@@ -2,20 +2,20 @@
 from __future__ import annotations
 
 
-def create_matrix(rows: int, cols: int, value: int) -> list[list[int]]:
-    """Create a matrix filled with a value."""
+def create_matrix(size: int, seed: int) -> list[list[int]]:
+    """Create a square matrix of small values that vary with position and seed."""
     matrix: list[list[int]] = []
-    for i in range(rows):
+    for i in range(size):
         row: list[int] = []
-        for j in range(cols):
-            row.append(value)
+        for j in range(size):
+            row.append((i * size + j + seed) % 10)
         matrix.append(row)
     return matrix
 
 
 def matrix_multiply(a: list[list[int]], b: list[list[int]], size: int) -> list[list[int]]:
     """Multiply two square matrices."""
-    result: list[list[int]] = create_matrix(size, size, 0)
+    result: list[list[int]] = create_matrix(size, 0)
 
     for i in range(size):
         for j in range(size):
@@ -27,20 +27,34 @@ def matrix_multiply(a: list[list[int]], b: list[list[int]], size: int) -> list[l
     return result
 
 
+def matrix_sum(matrix: list[list[int]], size: int) -> int:
+    """Sum every element of a square matrix, modulo a prime so large scales do not overflow."""
+    total: int = 0
+    for i in range(size):
+        for j in range(size):
+            total = (total + matrix[i][j]) % 1000003
+    return total
+
+
 def main() -> int:
     """Run matrix multiplication benchmark."""
-    # Create two 20x20 matrices
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
+    # 20x20 matrices at 1x; the element count grows with scale
     size: int = 20
-    matrix_a: list[list[int]] = create_matrix(size, size, 2)
-    matrix_b: list[list[int]] = create_matrix(size, size, 3)
+    while size * size < 400 * scale:
+        size += 1
 
-    # Multiply matrices 10 times for benchmarking
+    # Multiply 10 different pairs and sum every product so none can be skipped
+    checksum: int = 0
     result: list[list[int]] = []
     for iteration in range(10):
+        matrix_a: list[list[int]] = create_matrix(size, iteration)
+        matrix_b: list[list[int]] = create_matrix(size, iteration + 1)
         result = matrix_multiply(matrix_a, matrix_b, size)
+        checksum += matrix_sum(result, size)
 
-    # Print result from center of matrix
-    center: int = size // 2
-    print(result[center][center])
+    print(checksum)
 
     return 0
@@ -32,19 +32,23 @@ def quicksort(arr: list, low: int, high: int) -> int:
 
 def main() -> int:
     """Run quicksort benchmark."""
-    # Create array with numbers in reverse order
-    arr: list = [100, 95, 90, 85, 80, 75, 70, 65, 60, 55,
-                 50, 45, 40, 35, 30, 25, 20, 15, 10, 5]
-
-    # Sort the array multiple times for benchmarking
-    for iteration in range(100):
-        # Reset array
-        test_arr: list = [100, 95, 90, 85, 80, 75, 70, 65, 60, 55,
-                          50, 45, 40, 35, 30, 25, 20, 15, 10, 5]
-        quicksort(test_arr, 0, 19)
-
-    # Final sort and print first element
-    quicksort(arr, 0, 19)
-    print(arr[0])
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
+    # Sort 10 different arrays of 1000 * scale elements
+    length: int = 1000 * scale
+    seed: int = 1
+    checksum: int = 0
+    for iteration in range(10):
+        arr: list[int] = []
+        for i in range(length):
+            # Linear congruential generator, so every backend sorts the same values
+            seed = (seed * 75 + 74) % 65537
+            arr.append(seed)
+        quicksort(arr, 0, length - 1)
+        # Smallest, median and largest element depend on the whole sort
+        checksum += arr[0] + arr[length // 2] + arr[length - 1]
+
+    print(checksum)
 
     return 0
@@ -1,14 +1,19 @@
 """Word count benchmark - String and dictionary operations performance."""
 
 
-def count_words(text: str) -> dict:
-    """Count word frequencies in text."""
+def count_words(text: str, count: int) -> dict[str, int]:
+    """Count the frequencies of count words drawn pseudo-randomly from text."""
     # Split text into words
-    words: list = text.split()
+    words: list[str] = text.split()
 
     # Count word frequencies
     word_counts: dict[str, int] = {}
-    for word in words:
+    seed: int = 7
+    for i in range(count):
+        # Linear congruential generator, so every backend counts the same words
+        seed = (seed * 75 + 74) % 65537
+        word: str = words[seed % len(words)]
+
         # Convert to lowercase and strip
         clean_word: str = word.lower().strip()
 
@@ -23,13 +28,15 @@ def count_words(text: str) -> dict:
 
 def main() -> int:
     """Run word count benchmark."""
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
     # Sample text with repeated words
     text: str = "the quick brown fox jumps over the lazy dog the fox is quick and the dog is lazy"
 
-    # Count words multiple times for benchmarking
+    # Count 18000 words per scale unit, as many as 1000 passes over the sample
     result: dict[str, int] = {}
-    for iteration in range(1000):
-        result = count_words(text)
+    result = count_words(text, 18000 * scale)
 
     # Print count of most common word
     the_count: int = 0
@@ -0,0 +1,46 @@
+/**
+ * Microbenchmark interface for the C runtime containers
+ *
+ * Each container implementation exposes one mbench_suite whose operations
+ * run over a whole key array, so the driver's timing and indirect calls
+ * stay outside the measured loops. Every operation returns a checksum the
+ * driver validates (hit counts, miss counts, iteration totals), which also
+ * keeps the compiler from discarding the work.
+ */
+
+#ifndef MBENCH_H
+#define MBENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Keys for one run: ints for int-keyed containers, strings for string-keyed ones
+typedef struct {
+    const int* ints;
+    const char* const* strs;
+    size_t count;
+} mbench_keys;
+
+typedef struct {
+    const char* container;  // Runtime container this suite measures (e.g. "map_int_int")
+    const char* impl;       // "mgen" or "stc"
+    bool string_keys;
+
+    void* (*create)(void);
+    // Insert every key; returns the number of new entries
+    size_t (*insert)(void* c, const mbench_keys* keys);
+    // Look up every key; returns the number found
+    size_t (*lookup)(void* c, const mbench_keys* keys);
+    // Visit every entry; returns the number visited
+    size_t (*iterate)(void* c);
+    // Erase every key; returns the number erased
+    size_t (*erase)(void* c, const mbench_keys* keys);
+    void (*destroy)(void* c);
+} mbench_suite;
+
+extern const mbench_suite mbench_mgen_suites[];
+extern const size_t mbench_mgen_suite_count;
+extern const mbench_suite mbench_stc_suites[];
+extern const size_t mbench_stc_suite_count;
+
+#endif  // MBENCH_H
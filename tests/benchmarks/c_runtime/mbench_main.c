@@ -0,0 +1,359 @@
+/**
+ * Microbenchmark driver for the C runtime containers
+ *
+ * Times insert, lookup-hit, lookup-miss, iterate, erase and teardown for
+ * every MGen runtime container and its STC counterpart, over several key
+ * distributions and sizes. Each (container, implementation, distribution,
+ * size, operation) result is printed as one JSON object per line:
+ *
+ *     {"container": "map_int_int", "impl": "mgen", "distribution": "random",
+ *      "size": 1000, "operation": "insert", "ns_per_op_median": 21.4, ...}
+ *
+ * Usage:
+ *     mbench [--sizes 1000,10000,...] [--rounds N] [--container NAME]
+ *
+ * Exits with status 1 if any container returns a wrong hit or miss count.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mbench.h"
+
+#define MAX_SIZES 16
+#define MIN_ROUNDS 3
+#define MAX_ROUNDS 25
+// Rounds are chosen so each measurement covers roughly this many operations
+#define TARGET_OPS_PER_MEASUREMENT 1000000
+
+typedef enum { OP_INSERT, OP_LOOKUP_HIT, OP_LOOKUP_MISS, OP_ITERATE, OP_ERASE, OP_TEARDOWN, OP_COUNT } mbench_op;
+
+static const char* const OP_NAMES[OP_COUNT] = {
+    "insert", "lookup_hit", "lookup_miss", "iterate", "erase", "teardown",
+};
+
+typedef enum { DIST_SEQUENTIAL, DIST_RANDOM, DIST_STRIDED } int_distribution;
+
+static const char* const INT_DISTRIBUTION_NAMES[] = {"sequential", "random", "strided"};
+static const char* const STRING_DISTRIBUTION_NAMES[] = {"short", "long"};
+
+// One key set: keys to insert, the same keys in shuffled order, and absent keys
+typedef struct {
+    int* hit_ints;
+    int* shuffled_ints;
+    int* miss_ints;
+    char** hit_strs;
+    char** shuffled_strs;
+    char** miss_strs;
+    size_t count;
+} key_set;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * Bijective 32-bit mix, so scrambled keys are distinct and reproducible
+ */
+static uint32_t scramble(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+static int int_key(int_distribution distribution, size_t i) {
+    switch (distribution) {
+    case DIST_SEQUENTIAL:
+        return (int)i;
+    case DIST_RANDOM:
+        return (int)(scramble((uint32_t)i) & 0x7fffffffU);
+    case DIST_STRIDED:
+        return (int)(i * 64);
+    }
+    return 0;
+}
+
+/**
+ * Key guaranteed absent from the first n keys of a distribution
+ */
+static int int_miss_key(int_distribution distribution, size_t n, size_t i) {
+    switch (distribution) {
+    case DIST_SEQUENTIAL:
+        return (int)(n + i);
+    case DIST_RANDOM:
+        // Setting the top bit keeps misses disjoint from the 31-bit hit keys
+        return (int)(scramble((uint32_t)(n + i)) | 0x80000000U);
+    case DIST_STRIDED:
+        return (int)(i * 64 + 1);
+    }
+    return 0;
+}
+
+static char* string_key(size_t distribution, uint32_t value) {
+    char buffer[64];
+    if (distribution == 0) {
+        snprintf(buffer, sizeof(buffer), "%08x", value);
+    } else {
+        snprintf(buffer, sizeof(buffer), "mgen-benchmark/long-key/%010u/payload", value);
+    }
+    return strdup(buffer);
+}
+
+/**
+ * Fisher-Yates shuffle of an index permutation with a fixed seed
+ */
+static size_t* shuffled_indices(size_t n) {
+    size_t* order = malloc(n * sizeof(size_t));
+    for (size_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    uint32_t state = 0x6d67656e;
+    for (size_t i = n; i > 1; i--) {
+        state = scramble(state + (uint32_t)i);
+        size_t j = state % i;
+        size_t tmp = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = tmp;
+    }
+    return order;
+}
+
+static key_set make_int_keys(int_distribution distribution, size_t n) {
+    key_set keys = {0};
+    keys.count = n;
+    keys.hit_ints = malloc(n * sizeof(int));
+    keys.shuffled_ints = malloc(n * sizeof(int));
+    keys.miss_ints = malloc(n * sizeof(int));
+    size_t* order = shuffled_indices(n);
+    for (size_t i = 0; i < n; i++) {
+        keys.hit_ints[i] = int_key(distribution, i);
+        keys.miss_ints[i] = int_miss_key(distribution, n, i);
+    }
+    for (size_t i = 0; i < n; i++) {
+        keys.shuffled_ints[i] = keys.hit_ints[order[i]];
+    }
+    free(order);
+    return keys;
+}
+
+static key_set make_string_keys(size_t distribution, size_t n) {
+    key_set keys = {0};
+    keys.count = n;
+    keys.hit_strs = malloc(n * sizeof(char*));
+    keys.shuffled_strs = malloc(n * sizeof(char*));
+    keys.miss_strs = malloc(n * sizeof(char*));
+    // Positions for vector lookups, in the same shuffled order
+    keys.shuffled_ints = malloc(n * sizeof(int));
+    size_t* order = shuffled_indices(n);
+    for (size_t i = 0; i < n; i++) {
+        keys.hit_strs[i] = string_key(distribution, scramble((uint32_t)i) & 0x7fffffffU);
+        keys.miss_strs[i] = string_key(distribution, scramble((uint32_t)(n + i)) | 0x80000000U);
+    }
+    for (size_t i = 0; i < n; i++) {
+        keys.shuffled_strs[i] = keys.hit_strs[order[i]];
+        keys.shuffled_ints[i] = (int)order[i];
+    }
+    free(order);
+    return keys;
+}
+
+static void free_keys(key_set* keys) {
+    if (keys->hit_strs) {
+        for (size_t i = 0; i < keys->count; i++) {
+            free(keys->hit_strs[i]);
+            free(keys->miss_strs[i]);
+        }
+    }
+    free(keys->hit_ints);
+    free(keys->shuffled_ints);
+    free(keys->miss_ints);
+    free(keys->hit_strs);
+    free(keys->shuffled_strs);
+    free(keys->miss_strs);
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static size_t default_rounds(size_t n) {
+    size_t rounds = TARGET_OPS_PER_MEASUREMENT / (n ? n : 1);
+    if (rounds < MIN_ROUNDS) {
+        return MIN_ROUNDS;
+    }
+    return rounds > MAX_ROUNDS ? MAX_ROUNDS : rounds;
+}
+
+/**
+ * Run every operation of one suite over one key set
+ *
+ * Returns 0 on success, 1 if a hit or miss count was wrong.
+ */
+static int bench_suite(const mbench_suite* suite, const char* distribution, const key_set* keys, size_t rounds) {
+    size_t n = keys->count;
+    mbench_keys hits = {keys->hit_ints, (const char* const*)keys->hit_strs, n};
+    mbench_keys shuffled = {keys->shuffled_ints, (const char* const*)keys->shuffled_strs, n};
+    mbench_keys misses = {keys->miss_ints, (const char* const*)keys->miss_strs, n};
+    // The vector has no keyed lookup, so its miss measurement is skipped
+    bool has_misses = strcmp(suite->container, "vec_cstr") != 0;
+
+    double* samples[OP_COUNT];
+    size_t checksums[OP_COUNT] = {0};
+    for (int op = 0; op < OP_COUNT; op++) {
+        samples[op] = malloc(rounds * sizeof(double));
+    }
+
+    int failed = 0;
+    for (size_t round = 0; round < rounds; round++) {
+        void* container = suite->create();
+        double start = now_ns();
+        size_t added = suite->insert(container, &hits);
+        samples[OP_INSERT][round] = now_ns() - start;
+
+        start = now_ns();
+        size_t found = suite->lookup(container, &shuffled);
+        samples[OP_LOOKUP_HIT][round] = now_ns() - start;
+
+        size_t missed = 0;
+        if (has_misses) {
+            start = now_ns();
+            missed = suite->lookup(container, &misses);
+            samples[OP_LOOKUP_MISS][round] = now_ns() - start;
+        }
+
+        start = now_ns();
+        size_t visited = suite->iterate(container);
+        samples[OP_ITERATE][round] = now_ns() - start;
+
+        start = now_ns();
+        size_t erased = suite->erase(container, &shuffled);
+        samples[OP_ERASE][round] = now_ns() - start;
+
+        // Teardown is measured on a fully populated container
+        suite->insert(container, &hits);
+        start = now_ns();
+        suite->destroy(container);
+        samples[OP_TEARDOWN][round] = now_ns() - start;
+
+        if (added != n || found != n || missed != 0 || visited != n || erased != n) {
+            fprintf(stderr, "mbench: %s/%s/%s/%zu: inserted %zu, found %zu, missed %zu, visited %zu, erased %zu\n",
+                    suite->impl, suite->container, distribution, n, added, found, missed, visited, erased);
+            failed = 1;
+        }
+        checksums[OP_INSERT] = added;
+        checksums[OP_LOOKUP_HIT] = found;
+        checksums[OP_LOOKUP_MISS] = missed;
+        checksums[OP_ITERATE] = visited;
+        checksums[OP_ERASE] = erased;
+    }
+
+    for (int op = 0; op < OP_COUNT; op++) {
+        if (op == OP_LOOKUP_MISS && !has_misses) {
+            free(samples[op]);
+            continue;
+        }
+        qsort(samples[op], rounds, sizeof(double), compare_doubles);
+        double median = rounds % 2 ? samples[op][rounds / 2]
+                                   : (samples[op][rounds / 2 - 1] + samples[op][rounds / 2]) / 2;
+        printf("{\"container\": \"%s\", \"impl\": \"%s\", \"distribution\": \"%s\", \"size\": %zu, "
+               "\"operation\": \"%s\", \"ns_per_op_median\": %.3f, \"ns_per_op_min\": %.3f, \"rounds\": %zu, "
+               "\"checksum\": %zu}\n",
+               suite->container, suite->impl, distribution, n, OP_NAMES[op], median / (double)n,
+               samples[op][0] / (double)n, rounds, checksums[op]);
+        free(samples[op]);
+    }
+    fflush(stdout);
+    return failed;
+}
+
+static size_t parse_sizes(const char* text, size_t* sizes) {
+    size_t count = 0;
+    char* copy = strdup(text);
+    for (char* token = strtok(copy, ","); token && count < MAX_SIZES; token = strtok(NULL, ",")) {
+        // Accept scientific notation (1e6) as well as plain integers
+        double value = strtod(token, NULL);
+        if (value >= 1) {
+            sizes[count++] = (size_t)value;
+        }
+    }
+    free(copy);
+    return count;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--sizes N,N,...] [--rounds N] [--container NAME]\n", program);
+}
+
+int main(int argc, char** argv) {
+    size_t sizes[MAX_SIZES] = {1000, 10000, 100000, 1000000};
+    size_t size_count = 4;
+    size_t rounds_override = 0;
+    const char* only_container = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            size_count = parse_sizes(argv[++i], sizes);
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds_override = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--container") == 0 && i + 1 < argc) {
+            only_container = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (size_count == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const mbench_suite* groups[] = {mbench_mgen_suites, mbench_stc_suites};
+    const size_t group_counts[] = {mbench_mgen_suite_count, mbench_stc_suite_count};
+
+    int failed = 0;
+    for (size_t s = 0; s < size_count; s++) {
+        size_t n = sizes[s];
+        size_t rounds = rounds_override ? rounds_override : default_rounds(n);
+
+        for (int distribution = DIST_SEQUENTIAL; distribution <= DIST_STRIDED; distribution++) {
+            key_set keys = make_int_keys((int_distribution)distribution, n);
+            for (size_t g = 0; g < 2; g++) {
+                for (size_t k = 0; k < group_counts[g]; k++) {
+                    const mbench_suite* suite = &groups[g][k];
+                    if (suite->string_keys || (only_container && strcmp(only_container, suite->container) != 0)) {
+                        continue;
+                    }
+                    failed |= bench_suite(suite, INT_DISTRIBUTION_NAMES[distribution], &keys, rounds);
+                }
+            }
+            free_keys(&keys);
+        }
+
+        for (size_t distribution = 0; distribution < 2; distribution++) {
+            key_set keys = make_string_keys(distribution, n);
+            for (size_t g = 0; g < 2; g++) {
+                for (size_t k = 0; k < group_counts[g]; k++) {
+                    const mbench_suite* suite = &groups[g][k];
+                    if (!suite->string_keys || (only_container && strcmp(only_container, suite->container) != 0)) {
+                        continue;
+                    }
+                    failed |= bench_suite(suite, STRING_DISTRIBUTION_NAMES[distribution], &keys, rounds);
+                }
+            }
+            free_keys(&keys);
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,250 @@
+/**
+ * Microbenchmark suites for the MGen runtime containers
+ */
+
+#include <stdlib.h>
+
+#include "mbench.h"
+#include "mgen_map_int_int.h"
+#include "mgen_set_int.h"
+#include "mgen_set_str.h"
+#include "mgen_str_int_map.h"
+#include "mgen_vec_cstr.h"
+
+// ========== map_int_int ==========
+
+static void* map_int_int_bench_create(void) {
+    map_int_int* map = malloc(sizeof(map_int_int));
+    *map = map_int_int_init();
+    return map;
+}
+
+static size_t map_int_int_bench_insert(void* c, const mbench_keys* keys) {
+    size_t added = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        added += map_int_int_insert(c, keys->ints[i], (int)i);
+    }
+    return added;
+}
+
+static size_t map_int_int_bench_lookup(void* c, const mbench_keys* keys) {
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        found += map_int_int_get(c, keys->ints[i]) != NULL;
+    }
+    return found;
+}
+
+static size_t map_int_int_bench_iterate(void* c) {
+    size_t visited = 0;
+    for (map_int_int_iter it = map_int_int_begin(c); it.ref; map_int_int_next(&it)) {
+        visited += it.ref->value >= 0;
+    }
+    return visited;
+}
+
+static size_t map_int_int_bench_erase(void* c, const mbench_keys* keys) {
+    size_t erased = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        erased += map_int_int_remove(c, keys->ints[i]);
+    }
+    return erased;
+}
+
+static void map_int_int_bench_destroy(void* c) {
+    map_int_int_drop(c);
+    free(c);
+}
+
+// ========== set_int ==========
+
+static void* set_int_bench_create(void) {
+    set_int* set = malloc(sizeof(set_int));
+    *set = set_int_init();
+    return set;
+}
+
+static size_t set_int_bench_insert(void* c, const mbench_keys* keys) {
+    size_t added = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        added += set_int_insert(c, keys->ints[i]);
+    }
+    return added;
+}
+
+static size_t set_int_bench_lookup(void* c, const mbench_keys* keys) {
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        found += set_int_contains(c, keys->ints[i]);
+    }
+    return found;
+}
+
+static size_t set_int_bench_iterate(void* c) {
+    size_t visited = 0;
+    for (set_int_iter it = set_int_begin(c); it.ref; set_int_next(&it)) {
+        visited++;
+    }
+    return visited;
+}
+
+static size_t set_int_bench_erase(void* c, const mbench_keys* keys) {
+    size_t erased = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        erased += set_int_remove(c, keys->ints[i]);
+    }
+    return erased;
+}
+
+static void set_int_bench_destroy(void* c) {
+    set_int_drop(c);
+    free(c);
+}
+
+// ========== set_str ==========
+
+static void* set_str_bench_create(void) {
+    set_str* set = malloc(sizeof(set_str));
+    *set = set_str_init();
+    return set;
+}
+
+static size_t set_str_bench_insert(void* c, const mbench_keys* keys) {
+    size_t added = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        added += set_str_insert(c, keys->strs[i]);
+    }
+    return added;
+}
+
+static size_t set_str_bench_lookup(void* c, const mbench_keys* keys) {
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        found += set_str_contains(c, keys->strs[i]);
+    }
+    return found;
+}
+
+static size_t set_str_bench_iterate(void* c) {
+    size_t visited = 0;
+    for (set_str_iter it = set_str_begin(c); it.ref; set_str_next(&it)) {
+        visited += (*it.ref)[0] != '\0';
+    }
+    return visited;
+}
+
+static size_t set_str_bench_erase(void* c, const mbench_keys* keys) {
+    size_t erased = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        erased += set_str_erase(c, keys->strs[i]);
+    }
+    return erased;
+}
+
+static void set_str_bench_destroy(void* c) {
+    set_str_drop(c);
+    free(c);
+}
+
+// ========== str_int_map ==========
+
+static void* str_int_map_bench_create(void) {
+    return mgen_str_int_map_new();
+}
+
+static size_t str_int_map_bench_insert(void* c, const mbench_keys* keys) {
+    size_t added = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        added += mgen_str_int_map_insert(c, keys->strs[i], (int)i);
+    }
+    return added;
+}
+
+static size_t str_int_map_bench_lookup(void* c, const mbench_keys* keys) {
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        found += mgen_str_int_map_get(c, keys->strs[i]) != NULL;
+    }
+    return found;
+}
+
+static size_t str_int_map_bench_iterate(void* c) {
+    size_t visited = 0;
+    for (mgen_str_int_map_iter it = mgen_str_int_map_begin(c); it.ref; mgen_str_int_map_next(&it)) {
+        visited += it.ref->value >= 0;
+    }
+    return visited;
+}
+
+static size_t str_int_map_bench_erase(void* c, const mbench_keys* keys) {
+    size_t erased = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        erased += mgen_str_int_map_remove(c, keys->strs[i]);
+    }
+    return erased;
+}
+
+static void str_int_map_bench_destroy(void* c) {
+    mgen_str_int_map_free(c);
+}
+
+// ========== vec_cstr ==========
+
+static void* vec_cstr_bench_create(void) {
+    vec_cstr* vec = malloc(sizeof(vec_cstr));
+    *vec = vec_cstr_init();
+    return vec;
+}
+
+static size_t vec_cstr_bench_insert(void* c, const mbench_keys* keys) {
+    for (size_t i = 0; i < keys->count; i++) {
+        vec_cstr_push(c, keys->strs[i]);
+    }
+    return keys->count;
+}
+
+// Lookup by position: the driver passes the shuffled hit keys, so index by them
+static size_t vec_cstr_bench_lookup(void* c, const mbench_keys* keys) {
+    vec_cstr* vec = c;
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        size_t index = (size_t)keys->ints[i] % vec->size;
+        found += (*vec_cstr_at(vec, index))[0] != '\0';
+    }
+    return found;
+}
+
+static size_t vec_cstr_bench_iterate(void* c) {
+    vec_cstr* vec = c;
+    size_t visited = 0;
+    for (size_t i = 0; i < vec->size; i++) {
+        visited += vec->data[i][0] != '\0';
+    }
+    return visited;
+}
+
+// Erase from the back, the only erase the runtime vector has
+static size_t vec_cstr_bench_erase(void* c, const mbench_keys* keys) {
+    for (size_t i = 0; i < keys->count; i++) {
+        vec_cstr_pop(c);
+    }
+    return keys->count;
+}
+
+static void vec_cstr_bench_destroy(void* c) {
+    vec_cstr_drop(c);
+    free(c);
+}
+
+#define MBENCH_SUITE(container, strings, prefix)                                                         \
+    {container, "mgen", strings, prefix##_bench_create, prefix##_bench_insert, prefix##_bench_lookup, \
+     prefix##_bench_iterate, prefix##_bench_erase, prefix##_bench_destroy}
+
+const mbench_suite mbench_mgen_suites[] = {
+    MBENCH_SUITE("map_int_int", false, map_int_int),
+    MBENCH_SUITE("set_int", false, set_int),
+    MBENCH_SUITE("set_str", true, set_str),
+    MBENCH_SUITE("str_int_map", true, str_int_map),
+    MBENCH_SUITE("vec_cstr", true, vec_cstr),
+};
+const size_t mbench_mgen_suite_count = sizeof(mbench_mgen_suites) / sizeof(mbench_mgen_suites[0]);
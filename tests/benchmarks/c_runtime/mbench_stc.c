@@ -0,0 +1,272 @@
+/**
+ * Microbenchmark suites for the STC containers the runtime replaces
+ *
+ * Same operations as mbench_mgen.c, so the two implementations are measured
+ * under identical key sets and access orders.
+ */
+
+#include <stdlib.h>
+
+#include "mbench.h"
+
+#define i_implement
+#include "stc/cstr.h"
+
+#define T stc_imap, int, int
+#include "stc/hashmap.h"
+
+#define T stc_iset, int
+#include "stc/hashset.h"
+
+#define T stc_sset, cstr, (c_keypro)
+#include "stc/hashset.h"
+
+#define T stc_smap, cstr, int, (c_keypro)
+#include "stc/hashmap.h"
+
+#define T stc_svec, cstr, (c_keypro)
+#include "stc/vec.h"
+
+// ========== map_int_int ==========
+
+static void* stc_imap_bench_create(void) {
+    stc_imap* map = malloc(sizeof(stc_imap));
+    *map = stc_imap_init();
+    return map;
+}
+
+static size_t stc_imap_bench_insert(void* c, const mbench_keys* keys) {
+    size_t added = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        added += stc_imap_insert(c, keys->ints[i], (int)i).inserted;
+    }
+    return added;
+}
+
+static size_t stc_imap_bench_lookup(void* c, const mbench_keys* keys) {
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        found += stc_imap_get(c, keys->ints[i]) != NULL;
+    }
+    return found;
+}
+
+static size_t stc_imap_bench_iterate(void* c) {
+    size_t visited = 0;
+    const stc_imap* container = c;
+    for (c_each(it, stc_imap, *container)) {
+        visited += it.ref->second >= 0;
+    }
+    return visited;
+}
+
+static size_t stc_imap_bench_erase(void* c, const mbench_keys* keys) {
+    size_t erased = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        erased += stc_imap_erase(c, keys->ints[i]);
+    }
+    return erased;
+}
+
+static void stc_imap_bench_destroy(void* c) {
+    stc_imap_drop(c);
+    free(c);
+}
+
+// ========== set_int ==========
+
+static void* stc_iset_bench_create(void) {
+    stc_iset* set = malloc(sizeof(stc_iset));
+    *set = stc_iset_init();
+    return set;
+}
+
+static size_t stc_iset_bench_insert(void* c, const mbench_keys* keys) {
+    size_t added = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        added += stc_iset_insert(c, keys->ints[i]).inserted;
+    }
+    return added;
+}
+
+static size_t stc_iset_bench_lookup(void* c, const mbench_keys* keys) {
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        found += stc_iset_contains(c, keys->ints[i]);
+    }
+    return found;
+}
+
+static size_t stc_iset_bench_iterate(void* c) {
+    size_t visited = 0;
+    const stc_iset* container = c;
+    for (c_each(it, stc_iset, *container)) {
+        visited++;
+    }
+    return visited;
+}
+
+static size_t stc_iset_bench_erase(void* c, const mbench_keys* keys) {
+    size_t erased = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        erased += stc_iset_erase(c, keys->ints[i]);
+    }
+    return erased;
+}
+
+static void stc_iset_bench_destroy(void* c) {
+    stc_iset_drop(c);
+    free(c);
+}
+
+// ========== set_str ==========
+
+static void* stc_sset_bench_create(void) {
+    stc_sset* set = malloc(sizeof(stc_sset));
+    *set = stc_sset_init();
+    return set;
+}
+
+static size_t stc_sset_bench_insert(void* c, const mbench_keys* keys) {
+    size_t added = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        added += stc_sset_emplace(c, keys->strs[i]).inserted;
+    }
+    return added;
+}
+
+static size_t stc_sset_bench_lookup(void* c, const mbench_keys* keys) {
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        found += stc_sset_contains(c, keys->strs[i]);
+    }
+    return found;
+}
+
+static size_t stc_sset_bench_iterate(void* c) {
+    size_t visited = 0;
+    const stc_sset* container = c;
+    for (c_each(it, stc_sset, *container)) {
+        visited += cstr_size(it.ref) > 0;
+    }
+    return visited;
+}
+
+static size_t stc_sset_bench_erase(void* c, const mbench_keys* keys) {
+    size_t erased = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        erased += stc_sset_erase(c, keys->strs[i]);
+    }
+    return erased;
+}
+
+static void stc_sset_bench_destroy(void* c) {
+    stc_sset_drop(c);
+    free(c);
+}
+
+// ========== str_int_map ==========
+
+static void* stc_smap_bench_create(void) {
+    stc_smap* map = malloc(sizeof(stc_smap));
+    *map = stc_smap_init();
+    return map;
+}
+
+static size_t stc_smap_bench_insert(void* c, const mbench_keys* keys) {
+    size_t added = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        added += stc_smap_emplace(c, keys->strs[i], (int)i).inserted;
+    }
+    return added;
+}
+
+static size_t stc_smap_bench_lookup(void* c, const mbench_keys* keys) {
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        found += stc_smap_get(c, keys->strs[i]) != NULL;
+    }
+    return found;
+}
+
+static size_t stc_smap_bench_iterate(void* c) {
+    size_t visited = 0;
+    const stc_smap* container = c;
+    for (c_each(it, stc_smap, *container)) {
+        visited += it.ref->second >= 0;
+    }
+    return visited;
+}
+
+static size_t stc_smap_bench_erase(void* c, const mbench_keys* keys) {
+    size_t erased = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        erased += stc_smap_erase(c, keys->strs[i]);
+    }
+    return erased;
+}
+
+static void stc_smap_bench_destroy(void* c) {
+    stc_smap_drop(c);
+    free(c);
+}
+
+// ========== vec_cstr ==========
+
+static void* stc_svec_bench_create(void) {
+    stc_svec* vec = malloc(sizeof(stc_svec));
+    *vec = stc_svec_init();
+    return vec;
+}
+
+static size_t stc_svec_bench_insert(void* c, const mbench_keys* keys) {
+    for (size_t i = 0; i < keys->count; i++) {
+        stc_svec_emplace_back(c, keys->strs[i]);
+    }
+    return keys->count;
+}
+
+static size_t stc_svec_bench_lookup(void* c, const mbench_keys* keys) {
+    stc_svec* vec = c;
+    size_t size = (size_t)stc_svec_size(vec);
+    size_t found = 0;
+    for (size_t i = 0; i < keys->count; i++) {
+        size_t index = (size_t)keys->ints[i] % size;
+        found += cstr_size(stc_svec_at(vec, (isize)index)) > 0;
+    }
+    return found;
+}
+
+static size_t stc_svec_bench_iterate(void* c) {
+    size_t visited = 0;
+    const stc_svec* container = c;
+    for (c_each(it, stc_svec, *container)) {
+        visited += cstr_size(it.ref) > 0;
+    }
+    return visited;
+}
+
+static size_t stc_svec_bench_erase(void* c, const mbench_keys* keys) {
+    for (size_t i = 0; i < keys->count; i++) {
+        stc_svec_pop(c);
+    }
+    return keys->count;
+}
+
+static void stc_svec_bench_destroy(void* c) {
+    stc_svec_drop(c);
+    free(c);
+}
+
+#define MBENCH_SUITE(container, strings, prefix)                                                        \
+    {container, "stc", strings, prefix##_bench_create, prefix##_bench_insert, prefix##_bench_lookup, \
+     prefix##_bench_iterate, prefix##_bench_erase, prefix##_bench_destroy}
+
+const mbench_suite mbench_stc_suites[] = {
+    MBENCH_SUITE("map_int_int", false, stc_imap),
+    MBENCH_SUITE("set_int", false, stc_iset),
+    MBENCH_SUITE("set_str", true, stc_sset),
+    MBENCH_SUITE("str_int_map", true, stc_smap),
+    MBENCH_SUITE("vec_cstr", true, stc_svec),
+};
+const size_t mbench_stc_suite_count = sizeof(mbench_stc_suites) / sizeof(mbench_stc_suites[0]);
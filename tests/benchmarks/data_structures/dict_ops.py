@@ -41,15 +41,18 @@ def dict_operations() -> int:
 
 def main() -> int:
     """Run dictionary operations benchmark."""
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
     result1: int = 0
     result2: int = 0
 
-    # Run comprehensions benchmark 200 times
-    for i in range(200):
+    # Run comprehensions benchmark 200 times per scale unit
+    for i in range(200 * scale):
         result1 = dict_comprehensions()
 
-    # Run basic operations benchmark 200 times
-    for i in range(200):
+    # Run basic operations benchmark 200 times per scale unit
+    for i in range(200 * scale):
         result2 = dict_operations()
 
     # Print combined result
@@ -40,15 +40,18 @@ def set_operations() -> int:
 
 def main() -> int:
     """Run set operations benchmark."""
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
     result1: int = 0
     result2: int = 0
 
-    # Run comprehensions benchmark 100 times
-    for i in range(100):
+    # Run comprehensions benchmark 100 times per scale unit
+    for i in range(100 * scale):
         result1 = set_comprehensions()
 
-    # Run basic operations benchmark 100 times
-    for i in range(100):
+    # Run basic operations benchmark 100 times per scale unit
+    for i in range(100 * scale):
         result2 = set_operations()
 
     # Print combined result
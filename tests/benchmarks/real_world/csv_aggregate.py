@@ -0,0 +1,47 @@
+"""CSV aggregation benchmark - String splitting and grouped sums."""
+
+
+def sample_rows() -> list[str]:
+    """Return a sample of region,product,quantity rows."""
+    rows: list[str] = [
+        "north,widget,3",
+        "south,gadget,2",
+        "east,widget,1",
+        "west,gizmo,1",
+        "north,gizmo,2",
+        "central,gadget,3",
+        "south,widget,1",
+        "east,gizmo,2",
+    ]
+    return rows
+
+
+def aggregate(rows: list[str], repeats: int) -> dict[str, int]:
+    """Sum quantities per region over repeats passes of the rows."""
+    # Quantity column values; the subset has no portable str-to-int conversion
+    quantities: dict[str, int] = {}
+    quantities["1"] = 1
+    quantities["2"] = 2
+    quantities["3"] = 3
+    totals: dict[str, int] = {}
+    for repeat in range(repeats):
+        for row in rows:
+            fields: list[str] = row.split(",")
+            region: str = fields[0].strip()
+            amount: int = quantities[fields[2]]
+            if region in totals:
+                totals[region] = totals[region] + amount
+            else:
+                totals[region] = amount
+    return totals
+
+
+def main() -> int:
+    """Run CSV aggregation benchmark."""
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
+    rows: list[str] = sample_rows()
+    totals: dict[str, int] = aggregate(rows, 500 * scale)
+    print(totals["north"])
+    return 0
@@ -0,0 +1,57 @@
+"""Graph BFS benchmark - Adjacency lists and queue-driven traversal."""
+
+
+def make_graph(nodes: int, degree: int) -> list[list[int]]:
+    """Generate a pseudo-random directed graph that contains a ring through every node."""
+    graph: list[list[int]] = []
+    seed: int = 7
+    for i in range(nodes):
+        edges: list[int] = []
+        edges.append((i + 1) % nodes)
+        for j in range(degree - 1):
+            # Linear congruential generator, so every backend builds the same graph
+            seed = (seed * 75 + 74) % 65537
+            # The offset from i keeps large graphs connected beyond the generator's period
+            edges.append((i * 7 + seed) % nodes)
+        graph.append(edges)
+    return graph
+
+
+def bfs_distance_sum(graph: list[list[int]], start: int) -> int:
+    """Sum of shortest-path distances (in edges) from start to every node."""
+    # Distance + 1 per node, 0 while unvisited
+    level: list[int] = []
+    for i in range(len(graph)):
+        level.append(0)
+
+    queue: list[int] = []
+    queue.append(start)
+    level[start] = 1
+    head: int = 0
+    total: int = 0
+    while head < len(queue):
+        node: int = queue[head]
+        head += 1
+        total += level[node] - 1
+        for k in range(len(graph[node])):
+            neighbor: int = graph[node][k]
+            if level[neighbor] == 0:
+                level[neighbor] = level[node] + 1
+                queue.append(neighbor)
+    return total
+
+
+def main() -> int:
+    """Run graph BFS benchmark."""
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
+    graph: list[list[int]] = make_graph(1000 * scale, 4)
+
+    # BFS from several sources
+    result: int = 0
+    for source in range(10):
+        result += bfs_distance_sum(graph, source)
+
+    print(result)
+    return 0
@@ -0,0 +1,65 @@
+"""Log parsing benchmark - Tokenizing structured log lines."""
+
+
+def sample_log() -> list[str]:
+    """Return a sample of access log lines."""
+    lines: list[str] = [
+        "INFO service=api status=200 latency=12",
+        "INFO service=auth status=200 latency=8",
+        "WARN service=search status=404 latency=30",
+        "ERROR service=api status=500 latency=250",
+        "INFO service=billing status=200 latency=45",
+        "ERROR service=billing status=500 latency=120",
+        "INFO service=api status=200 latency=12",
+        "WARN service=auth status=404 latency=8",
+    ]
+    return lines
+
+
+def parse_log(lines: list[str], repeats: int) -> dict[str, int]:
+    """Count lines per level and sum the latency of failed requests per service."""
+    # Numeric field values; the subset has no portable str-to-int conversion
+    numbers: dict[str, int] = {}
+    numbers["8"] = 8
+    numbers["12"] = 12
+    numbers["30"] = 30
+    numbers["45"] = 45
+    numbers["120"] = 120
+    numbers["250"] = 250
+    numbers["200"] = 200
+    numbers["404"] = 404
+    numbers["500"] = 500
+
+    stats: dict[str, int] = {}
+    for repeat in range(repeats):
+        for line in lines:
+            fields: list[str] = line.split(" ")
+            level: str = fields[0].strip()
+            if level in stats:
+                stats[level] = stats[level] + 1
+            else:
+                stats[level] = 1
+
+            status_field: list[str] = fields[2].split("=")
+            if numbers[status_field[1]] >= 500:
+                service_field: list[str] = fields[1].split("=")
+                latency_field: list[str] = fields[3].split("=")
+                service: str = service_field[1].strip()
+                latency: int = numbers[latency_field[1]]
+                if service in stats:
+                    stats[service] = stats[service] + latency
+                else:
+                    stats[service] = latency
+    return stats
+
+
+def main() -> int:
+    """Run log parsing benchmark."""
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
+    lines: list[str] = sample_log()
+    stats: dict[str, int] = parse_log(lines, 500 * scale)
+    print(stats["ERROR"])
+    print(stats["api"])
+    return 0
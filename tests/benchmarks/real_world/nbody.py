@@ -0,0 +1,43 @@
+"""N-body benchmark - Floating point simulation of a small planetary system."""
+
+
+def simulate(steps: int, dt: float) -> int:
+    """Advance five bodies under softened pairwise gravity; return their kinetic energy * 1000."""
+    # Positive, non-integral literals: some backends print whole floats as integers
+    x: list[float] = [4.25, 5.5, 2.5, 6.5, 1.75]
+    y: list[float] = [4.25, 4.5, 5.25, 2.5, 3.5]
+    vx: list[float] = [0.01, 0.1, 0.2, 0.05, 0.15]
+    vy: list[float] = [0.01, 0.8, 0.6, 0.4, 0.3]
+    mass: list[float] = [10.5, 0.5, 0.8, 0.3, 0.4]
+    bodies: int = 5
+
+    for step in range(steps):
+        for i in range(bodies):
+            for j in range(i + 1, bodies):
+                dx: float = x[i] - x[j]
+                dy: float = y[i] - y[j]
+                # Softened inverse-square force avoids a square root
+                dist2: float = dx * dx + dy * dy + 0.01
+                magnitude: float = dt / (dist2 * dist2)
+                vx[i] = vx[i] - dx * mass[j] * magnitude
+                vy[i] = vy[i] - dy * mass[j] * magnitude
+                vx[j] = vx[j] + dx * mass[i] * magnitude
+                vy[j] = vy[j] + dy * mass[i] * magnitude
+        for i in range(bodies):
+            x[i] = x[i] + dt * vx[i]
+            y[i] = y[i] + dt * vy[i]
+
+    energy: float = 0.5 * mass[0] * (vx[0] * vx[0] + vy[0] * vy[0])
+    for i in range(1, bodies):
+        energy += 0.5 * mass[i] * (vx[i] * vx[i] + vy[i] * vy[i])
+    # Truncated to an integer, so every backend prints the same text
+    return int(energy / 0.001)
+
+
+def main() -> int:
+    """Run n-body benchmark."""
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
+    print(simulate(10000 * scale, 0.001))
+    return 0
@@ -0,0 +1,51 @@
+"""Tokenizer benchmark - Classifying the tokens of JSON-like text."""
+
+
+def sample_document() -> list[str]:
+    """Return JSON-like records with space-separated tokens (single-quoted, so no escapes are needed)."""
+    records: list[str] = [
+        "{ 'id' : 17 , 'name' : 'widget' , 'tags' : [ 1 , 22 , 333 ] , 'ok' : true }",
+        "{ 'id' : 18 , 'name' : 'gadget' , 'tags' : [ ] , 'ok' : false }",
+        "{ 'id' : 19 , 'name' : 'gizmo' , 'parent' : null , 'ok' : true }",
+        "[ 4 , 8 , 15 , 16 , 23 , 42 ]",
+    ]
+    return records
+
+
+def tokenize(records: list[str], repeats: int) -> list[int]:
+    """Count tokens by kind: [punctuation, string, keyword, number]."""
+    kinds: dict[str, int] = {}
+    kinds["{"] = 0
+    kinds["}"] = 0
+    kinds["["] = 0
+    kinds["]"] = 0
+    kinds[":"] = 0
+    kinds[","] = 0
+    kinds["true"] = 2
+    kinds["false"] = 2
+    kinds["null"] = 2
+
+    counts: list[int] = [0, 0, 0, 0]
+    for repeat in range(repeats):
+        for record in records:
+            tokens: list[str] = record.split(" ")
+            for token in tokens:
+                kind: int = 3
+                if token in kinds:
+                    kind = kinds[token]
+                elif token.find("'") == 0:
+                    kind = 1
+                counts[kind] = counts[kind] + 1
+    return counts
+
+
+def main() -> int:
+    """Run tokenizer benchmark."""
+    # Input size multiplier, rewritten by scripts/benchmark.py --scales
+    scale: int = 1
+
+    records: list[str] = sample_document()
+    counts: list[int] = tokenize(records, 500 * scale)
+    for count in counts:
+        print(count)
+    return 0
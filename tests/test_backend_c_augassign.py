@@ -440,4 +440,44 @@ def test_calculator() -> int:
     assert "self->value *= 2;" in c_code
     assert "temp -= b;" in c_code
     assert "temp |= 1;" in c_code  # 0x01 becomes 1
-    assert "#include" in c_code  # Should have includes
\ No newline at end of file
+    assert "#include" in c_code  # Should have includes
+
+
+class TestAugmentedAssignmentDictUpdates:
+    """Test counting updates become a single find-or-insert."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCConverter()
+
+    def test_membership_counting_uses_get_or_insert(self):
+        """Test `if k in d: d[k] = d[k] + 1 else: d[k] = 1` on a string map."""
+        python_code = """
+def count(text: str) -> int:
+    counts: dict[str, int] = {"": 0}
+    words: list = text.split()
+    for word in words:
+        if word in counts:
+            counts[word] = counts[word] + 1
+        else:
+            counts[word] = 1
+    return len(counts)
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "*mgen_str_int_map_get_or_insert(counts, word, 0) += 1;" in c_code
+        assert "mgen_str_int_map_contains(counts, word)" not in c_code
+
+    def test_get_with_default_uses_stc_insert(self):
+        """Test `d[k] = d.get(k, 5) + 2` on an int map keeps the default."""
+        python_code = """
+def main() -> int:
+    xs: list[int] = [4, 1, 4]
+    c: dict[int, int] = {}
+    for x in xs:
+        c[x] = c.get(x, 5) + 2
+    return 0
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "map_int_int_insert(&c, x, 5).ref->second += 2;" in c_code
@@ -253,6 +253,72 @@ def mod_test(a: int, b: int) -> int:
         assert "return (a % b);" in c_code
 
 
+class TestPy2CTuples:
+    """Test fixed-arity tuples lowered to value structs."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCConverter()
+
+    def test_tuple_return_uses_struct(self):
+        """Test a tuple return type declares a struct returned by value."""
+        python_code = """
+def divmod_pair(a: int, b: int) -> tuple[int, int]:
+    return a % b, a - b
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "typedef struct { int f0; int f1; } mgen_tuple_int_int;" in c_code
+        assert "mgen_tuple_int_int divmod_pair(int a, int b)" in c_code
+        assert "return (mgen_tuple_int_int){(a % b), (a - b)};" in c_code
+
+    def test_tuple_unpacking_reads_fields(self):
+        """Test unpacking a returned tuple reads the struct fields."""
+        python_code = """
+def label(n: int) -> tuple[str, int]:
+    return ("n", n)
+
+def main() -> int:
+    name, count = label(5)
+    return count
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "typedef struct { char* f0; int f1; } mgen_tuple_str_int;" in c_code
+        assert "mgen_tuple_str_int mgen_tuple_tmp_1 = label(5);" in c_code
+        assert "char* name = mgen_tuple_tmp_1.f0;" in c_code
+        assert "int count = mgen_tuple_tmp_1.f1;" in c_code
+
+    def test_tuple_swap_uses_scalar_temporaries(self):
+        """Test a, b = b, a + b evaluates the right side before assigning."""
+        python_code = """
+def fib(n: int) -> int:
+    a: int = 0
+    b: int = 1
+    for i in range(n):
+        a, b = b, a + b
+    return a
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "int mgen_tuple_tmp_1 = b;" in c_code
+        assert "int mgen_tuple_tmp_2 = (a + b);" in c_code
+        assert "a = mgen_tuple_tmp_1;" in c_code
+        assert "b = mgen_tuple_tmp_2;" in c_code
+        assert "typedef struct" not in c_code
+
+    def test_tuple_subscript_reads_field(self):
+        """Test constant indices, including negative ones, become field accesses."""
+        python_code = """
+def first_last(p: tuple[int, float]) -> float:
+    return p[0] + p[-1]
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "double first_last(mgen_tuple_int_double p)" in c_code
+        assert "(p.f0 + p.f1)" in c_code
+
+
 class TestPy2CErrorHandling:
     """Test error handling and edge cases."""
 
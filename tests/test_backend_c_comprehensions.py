@@ -1,9 +1,20 @@
 """Tests for Python comprehensions support in C backend."""
 
+import re
+
 import pytest
 
 from mgen.backends.c.converter import MGenPythonToCConverter
 from mgen.backends.errors import UnsupportedFeatureError
+from mgen.backends.preferences import CPreferences
+
+
+def assert_sized_range_loop(c_code: str, var: str, start: str, stop: str, step: int = 1) -> None:
+    """Assert a list comprehension loops over range() bounds hoisted into locals."""
+    bounds = re.search(rf"int (\w+)_start = {re.escape(start)};\n\s*int \1_stop = {re.escape(stop)};", c_code)
+    assert bounds, c_code
+    prefix = bounds.group(1)
+    assert f"for (int {var} = {prefix}_start; {var} < {prefix}_stop; {var} += {step})" in c_code
 
 class TestListComprehensions:
     """Test list comprehension conversion functionality."""
@@ -22,7 +33,7 @@ def test_list_comp() -> list:
 
         # Should contain vector initialization and loop
         assert "vec_int" in c_code
-        assert "for (int x = 0; x < 5; x += 1)" in c_code
+        assert_sized_range_loop(c_code, "x", "0", "5")
         assert "vec_int_push" in c_code
 
     def test_list_comprehension_with_expression(self):
@@ -34,7 +45,7 @@ def test_list_comp_expr() -> list:
         c_code = self.converter.convert_code(python_code)
 
         assert "vec_int" in c_code
-        assert "for (int x = 0; x < 3; x += 1)" in c_code
+        assert_sized_range_loop(c_code, "x", "0", "3")
         assert "(x * 2)" in c_code
 
     def test_list_comprehension_with_condition(self):
@@ -46,7 +57,7 @@ def test_list_comp_condition() -> list:
         c_code = self.converter.convert_code(python_code)
 
         assert "vec_int" in c_code
-        assert "for (int x = 0; x < 10; x += 1)" in c_code
+        assert_sized_range_loop(c_code, "x", "0", "10")
         assert "if (((x % 2) == 0))" in c_code
 
     def test_list_comprehension_with_range_start_stop(self):
@@ -58,7 +69,7 @@ def test_list_comp_range(start: int, stop: int) -> list:
         c_code = self.converter.convert_code(python_code)
 
         assert "vec_int" in c_code
-        assert "for (int i = start; i < stop; i += 1)" in c_code
+        assert_sized_range_loop(c_code, "i", "start", "stop")
 
     def test_list_comprehension_with_range_step(self):
         """Test list comprehension with range(start, stop, step)."""
@@ -69,7 +80,7 @@ def test_list_comp_step() -> list:
         c_code = self.converter.convert_code(python_code)
 
         assert "vec_int" in c_code
-        assert "for (int i = 0; i < 10; i += 2)" in c_code
+        assert_sized_range_loop(c_code, "i", "0", "10", 2)
 
     def test_list_comprehension_complex_expression(self):
         """Test list comprehension with complex expression."""
@@ -247,6 +258,105 @@ def test_multiple_conditions() -> set:
             self.converter.convert_code(python_code)
 
 
+class TestSizedListComprehensions:
+    """Test list comprehensions over range() sized with one allocation up front."""
+
+    def test_runtime_mode_reserves_trip_count(self):
+        """Runtime-mode comprehensions reserve the trip count before pushing."""
+        python_code = """
+def evens(n: int) -> list:
+    return [i for i in range(1, n, 3) if i % 2 == 0]
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert "((long long)" in c_code and "+ 2) / 3)" in c_code
+        assert re.search(r"vec_int_reserve\(&\w+, \w+_count\);", c_code)
+        assert "vec_int_resize_uninitialized" not in c_code
+
+    def test_generated_mode_fills_in_place(self):
+        """Unfiltered comprehensions over generated vectors store straight into the sized buffer."""
+        preferences = CPreferences()
+        preferences.set("container_mode", "generated")
+        python_code = """
+def squares(n: int) -> list:
+    return [x * x for x in range(n)]
+"""
+        c_code = MGenPythonToCConverter(preferences).convert_code(python_code)
+
+        assert "vec_int_resize_uninitialized(&" in c_code
+        assert re.search(r"int x = \w+_start \+ \(int\)\w+_k;", c_code)
+        assert re.search(r"\w+_out\[\w+_k\] = \(x \* x\);", c_code)
+        assert "vec_int_push(&" not in c_code.split("squares(")[1]
+
+    def test_generated_mode_slice_copies_range(self):
+        """Contiguous slices of generated vectors copy one range instead of pushing."""
+        preferences = CPreferences()
+        preferences.set("container_mode", "generated")
+        python_code = """
+def head(n: int) -> int:
+    values: list[int] = [x for x in range(n)]
+    first: list[int] = values[1:4]
+    return len(first)
+"""
+        c_code = MGenPythonToCConverter(preferences).convert_code(python_code)
+
+        assert "vec_int_copy_range(&values, (size_t)(1), (size_t)(4))" in c_code
+
+    def test_unknown_step_keeps_push_loop(self):
+        """A non-constant step has no computable trip count and keeps the plain loop."""
+        python_code = """
+def stepped(n: int, k: int) -> list:
+    return [i for i in range(0, n, k)]
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert "for (int i = 0; i < n; i += k)" in c_code
+        assert "_reserve(" not in c_code
+
+
+class TestReservedHashComprehensions:
+    """Test dict and set comprehensions over range() reserved to their final size."""
+
+    def test_distinct_keys_reserve_trip_count(self):
+        """Keys that differ on every iteration reserve the trip count before inserting."""
+        python_code = """
+def index(n: int) -> dict:
+    return {i: i * i for i in range(n)}
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert re.search(r"size_t \w+_count = n > 0 \? \(size_t\)\(\(long long\)n - 0\) : 0;", c_code)
+        assert re.search(r"map_int_int_reserve\(&\w+, \w+_count\);", c_code)
+        assert "for (int i = 0; i < n; i += 1)" in c_code
+
+    def test_call_bounds_are_evaluated_once(self):
+        """range() bounds with calls are hoisted so the count and the loop share one evaluation."""
+        python_code = """
+def limit(n: int) -> int:
+    return n * 2
+
+def odds(n: int) -> set:
+    return {x * 3 for x in range(1, limit(n), 2)}
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert re.search(r"int \w+_stop = limit\(n\);", c_code)
+        assert re.search(r"set_int_reserve\(&\w+, \w+_count\);", c_code)
+        assert re.search(r"for \(int x = \w+_start; x < \w+_stop; x \+= 2\)", c_code)
+
+    def test_colliding_or_filtered_keys_do_not_reserve(self):
+        """Keys that may repeat, and filtered comprehensions, keep growing on demand."""
+        python_code = """
+def buckets(n: int) -> set:
+    return {x % 5 for x in range(n)}
+
+def evens(n: int) -> dict:
+    return {i: i for i in range(n) if i % 2 == 0}
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert "_reserve(" not in c_code
+
 class TestComprehensionsIntegration:
     """Test comprehensions integration with other features."""
 
@@ -265,7 +375,7 @@ def test_assignment() -> int:
 
         # Should handle assignment and comprehension
         assert "vec_int" in c_code
-        assert "for (int x = 0; x < 3; x += 1)" in c_code
+        assert_sized_range_loop(c_code, "x", "0", "3")
         assert "(x * 2)" in c_code
 
     def test_comprehension_with_function_calls(self):
@@ -281,7 +391,7 @@ def test_with_function() -> list:
 
         # Should handle function calls in comprehension
         assert "helper(x)" in c_code
-        assert "for (int x = 0; x < 3; x += 1)" in c_code
+        assert_sized_range_loop(c_code, "x", "0", "3")
 
     def test_nested_comprehensions_error(self):
         """Test that nested comprehensions raise appropriate error."""
@@ -315,7 +425,7 @@ def test_class_comprehension() -> list:
 
         # Should handle class instantiation in comprehension
         assert "Point_new(i, (i * 2))" in c_code
-        assert "for (int i = 0; i < 2; i += 1)" in c_code
+        assert_sized_range_loop(c_code, "i", "0", "2")
 
     def test_mixed_comprehension_types(self):
         """Test function using multiple comprehension types."""
@@ -350,7 +460,10 @@ def test_comp() -> {comp_type}:
 
     c_code = converter.convert_code(python_code)
     assert expected_container in c_code
-    assert "for (int x = 0; x < 3; x += 1)" in c_code
+    if comp_type == "list":
+        assert_sized_range_loop(c_code, "x", "0", "3")
+    else:
+        assert "for (int x = 0; x < 3; x += 1)" in c_code
 
 
 @pytest.mark.integration
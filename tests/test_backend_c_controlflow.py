@@ -99,3 +99,25 @@ def nested_test(n: int) -> int:
         assert "for (int i = 0; i < n; i += 1)" in c_code
         assert "if (((i % 2) == 0))" in c_code
 
+
+    def test_independent_loop_is_marked_for_vectorization(self):
+        """Test loops the vectorization detector proves independent get MGEN_LOOP_INDEPENDENT."""
+        python_code = """
+def dot(xs: list[int], ys: list[int], n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        total += xs[i] * ys[i]
+    return total
+
+def fsum(xs: list[float], n: int) -> float:
+    total: float = 0.0
+    for i in range(n):
+        total += xs[i]
+    return total
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        # Both versions of the loop behind the hoisted range check are marked
+        assert "MGEN_LOOP_INDEPENDENT\n        for (int i = 0; i < n; i += 1)" in c_code
+        # Reordering a float sum would change its result
+        assert c_code.count("MGEN_LOOP_INDEPENDENT") == 2
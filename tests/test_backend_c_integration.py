@@ -1,15 +1,23 @@
 """Integration tests for C backend components (emitter, builder, containers, factory)."""
 
+import ast
+import os
+import shutil
+import subprocess
 import tempfile
 from pathlib import Path
+from unittest import mock
 
 import pytest
 
-from mgen.backends.c.builder import CBuilder
+from mgen.backends.base import fast_math_compile_flags, fast_math_modes
+from mgen.backends.c.builder import BASE_FLAGS, CBuilder
 from mgen.backends.c.containers import CContainerSystem
 from mgen.backends.c.converter import MGenPythonToCConverter
 from mgen.backends.c.emitter import CEmitter
 from mgen.backends.c.factory import CFactory
+from mgen.backends.errors import UnsupportedFeatureError
+from mgen.backends.preferences import CPreferences
 
 
 class TestEnhancedCEmitter:
@@ -164,6 +172,122 @@ class TestCBuilderEnhanced:
             assert len(headers) > 0
             assert "mgen_error_handling.h" in headers
 
+    def test_runtime_sources_follow_program_includes(self, tmp_path):
+        """Test only the runtime modules a program includes, directly or through the runtime, are built in."""
+        if not self.builder.use_runtime:
+            pytest.skip("runtime not available")
+
+        program = tmp_path / "fib.c"
+        program.write_text('#include <stdio.h>\n#include "mgen_python_ops.h"\nint main(void) { return 0; }\n')
+        names = [Path(src).name for src in self.builder.runtime_sources_for([str(program)])]
+        assert "mgen_python_ops.c" in names
+        assert "mgen_error_handling.c" in names
+        assert "mgen_file_ops.c" not in names
+        assert "mgen_string_ops.c" not in names
+
+        program.write_text('#include "mgen_file_ops.h"\n')
+        names = [Path(src).name for src in self.builder.runtime_sources_for([str(program)])]
+        assert {"mgen_file_ops.c", "mgen_string_ops.c", "mgen_memory_ops.c"} <= set(names)
+
+        missing = str(tmp_path / "not_written_yet.c")
+        assert self.builder.runtime_sources_for([missing]) == self.builder.get_runtime_sources()
+
+    def test_fast_math_modes(self):
+        """Test fast_math preference values parse into modes and map onto compiler options."""
+        assert fast_math_modes("") == ()
+        assert fast_math_modes(True) == ("fast",)
+        assert fast_math_modes("reassoc, contract") == ("reassoc", "contract")
+        assert fast_math_compile_flags(("nnan", "ninf")) == ["-ffinite-math-only"]
+        assert "-ffp-contract=fast" in fast_math_compile_flags(("contract",))
+        with pytest.raises(ValueError, match="approx"):
+            fast_math_modes("approx")
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_fast_math_reaches_the_program_not_the_runtime_archive(self, tmp_path):
+        """Test the program is compiled with the fast_math options and the cached runtime archive without."""
+        source = tmp_path / "fsum.c"
+        source.write_text('#include <stdio.h>\nint main(void) { printf("%.1f\\n", 0.5 * 3); return 0; }\n')
+        commands = []
+        run = subprocess.run
+
+        def record(cmd, *args, **kwargs):
+            commands.append(cmd)
+            return run(cmd, *args, **kwargs)
+
+        with mock.patch.dict(os.environ, {"MGEN_CACHE_DIR": str(tmp_path / "cache")}):
+            with mock.patch("subprocess.run", record):
+                assert self.builder.compile_direct(str(source), str(tmp_path), fast_math=("reassoc", "contract"))
+        program = next(cmd for cmd in commands if str(source) in cmd)
+
+        assert "-fassociative-math" in program
+        assert "-ffp-contract=fast" in program
+        assert not any("-ffp-contract=fast" in cmd for cmd in commands if cmd is not program)
+        assert run([str(tmp_path / "fsum")], capture_output=True, text=True).stdout == "1.5\n"
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_pgo_generate_then_use(self):
+        """Test an instrumented build writes profiles that a second build consumes."""
+        c_code = """
+#include <stdio.h>
+int main(void) {
+    long total = 0;
+    for (int i = 0; i < 100000; i++) {
+        total += (i % 97 == 0) ? i * 3 : 1;
+    }
+    printf("%ld\\n", total);
+    return 0;
+}
+"""
+        with tempfile.TemporaryDirectory() as temp_dir:
+            source = Path(temp_dir) / "hot.c"
+            source.write_text(c_code)
+            profile_dir = Path(temp_dir) / "pgo"
+
+            assert self.builder.compile_direct(str(source), temp_dir, pgo_generate=str(profile_dir))
+            training = subprocess.run([str(Path(temp_dir) / "hot")], capture_output=True, text=True, check=True)
+            assert list(profile_dir.rglob("*.gcda"))
+
+            assert self.builder.compile_direct(str(source), temp_dir, pgo_use=str(profile_dir))
+            optimized = subprocess.run([str(Path(temp_dir) / "hot")], capture_output=True, text=True, check=True)
+            assert optimized.stdout == training.stdout
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_runtime_archive_is_cached(self, tmp_path):
+        """Test the runtime is archived once per flag set and linked into programs."""
+        if not self.builder.use_runtime:
+            pytest.skip("runtime not available")
+
+        with mock.patch.dict(os.environ, {"MGEN_CACHE_DIR": str(tmp_path / "cache")}):
+            archive = self.builder.runtime_archive()
+            assert archive is not None and archive.name == "libmgenrt.a"
+            assert archive.is_relative_to(tmp_path)
+            assert self.builder.runtime_archive() == archive
+            assert self.builder.runtime_archive(lto=True) != archive
+
+            source = tmp_path / "uses_runtime.c"
+            source.write_text(
+                '#include <stdio.h>\n#include "mgen_error_handling.h"\n'
+                'int main(void) { mgen_clear_error(); printf("ok\\n"); return 0; }\n'
+            )
+            assert self.builder.compile_direct(str(source), str(tmp_path), opt_level=3)
+        result = subprocess.run([str(tmp_path / "uses_runtime")], capture_output=True, text=True, check=True)
+        assert result.stdout == "ok\n"
+
+    @pytest.mark.skipif(shutil.which("gcc") is None or shutil.which("nm") is None, reason="gcc or nm not available")
+    def test_release_profile_drops_unreferenced_code(self, tmp_path):
+        """Test the release profile links with LTO and removes functions nothing calls."""
+        source = tmp_path / "prog.c"
+        source.write_text(
+            "#include <stdio.h>\n"
+            "int unused_helper(int x) { return x * 3; }\n"
+            'int main(void) { printf("%d\\n", 7); return 0; }\n'
+        )
+        binary = tmp_path / "prog"
+
+        assert self.builder.compile_direct(str(source), str(tmp_path), profile="release")
+        assert "unused_helper" not in subprocess.run(["nm", str(binary)], capture_output=True, text=True).stdout
+        assert subprocess.run([str(binary)], capture_output=True, text=True, check=True).stdout == "7\n"
+
 
 class TestCFactoryEnhanced:
     """Test enhanced C factory with integrated capabilities."""
@@ -308,3 +432,1762 @@ def test_enhanced_c_backend_comprehensive(sample_python_functions):
         assert len(c_code) > 100  # Should be substantial
         assert "#include" in c_code  # Should have includes
         assert "(" in c_code and ")" in c_code  # Should have function syntax
+
+
+class TestCRuntimePreferences:
+    """Test C preferences that configure the runtime headers."""
+
+    def test_atomic_refcounts_define(self):
+        """The atomic refcount define precedes the runtime includes only when requested."""
+        python_code = """
+def main() -> int:
+    return 0
+"""
+        plain = MGenPythonToCConverter().convert_code(python_code)
+        assert "MGEN_ATOMIC_REFCOUNTS" not in plain
+
+        preferences = CPreferences()
+        preferences.set("atomic_refcounts", True)
+        c_code = MGenPythonToCConverter(preferences).convert_code(python_code)
+        assert "#define MGEN_ATOMIC_REFCOUNTS" in c_code
+        assert c_code.index("#define MGEN_ATOMIC_REFCOUNTS") < c_code.index('#include "mgen_memory_ops.h"')
+
+
+class TestParallelLoops:
+    """Test the parallel_loops preference: OpenMP parallel-for on independent loops."""
+
+    CODE = """
+def scale(xs: list[int], k: int) -> int:
+    total: int = 0
+    for i in range(len(xs)):
+        v: int = xs[i] * k
+        xs[i] = v % 1000
+        total += v
+    return total
+
+
+def main() -> int:
+    xs: list[int] = []
+    for i in range(50000):
+        xs.append(i % 97)
+    print(scale(xs, 3))
+    print(scale(xs, 7))
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        preferences = CPreferences()
+        preferences.set("parallel_loops", True)
+        self.converter = MGenPythonToCConverter(preferences)
+
+    def test_independent_loop_gets_reduction_pragma(self):
+        """Test loops without loop-carried dependencies run in parallel with their sums reduced."""
+        c_code = self.converter.convert_code(self.CODE)
+
+        assert (
+            "#pragma omp parallel for reduction(+:total)\n    for (int i = 0; i < vec_int_size(&xs); i += 1)"
+            in c_code
+        )
+        # append() grows a shared list
+        assert c_code.count("#pragma omp") == 1
+
+    def test_float_reduction_stays_serial(self):
+        """Test floating-point sums keep their serial order, which fixes their rounding."""
+        python_code = """
+def fsum(xs: list[float]) -> float:
+    s: float = 0.0
+    for i in range(len(xs)):
+        s += xs[i]
+    return s
+"""
+        assert "#pragma omp" not in self.converter.convert_code(python_code)
+
+    def test_default_preferences_stay_serial(self):
+        """Test no OpenMP pragmas are emitted unless requested."""
+        assert "#pragma omp" not in MGenPythonToCConverter().convert_code(self.CODE)
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_parallel_program_matches_serial_result(self, tmp_path):
+        """Test the builder links OpenMP and the threaded program computes the serial result."""
+        source = tmp_path / "scale.c"
+        source.write_text(self.converter.convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        with mock.patch.dict(os.environ, {"OMP_NUM_THREADS": "4"}):
+            result = subprocess.run([str(tmp_path / "scale")], capture_output=True, text=True, check=True)
+
+        xs = [i % 97 for i in range(50000)]
+        first = sum(x * 3 for x in xs)
+        xs = [x * 3 % 1000 for x in xs]
+        assert result.stdout.split() == [str(first), str(sum(x * 7 for x in xs))]
+
+
+class TestFlatMatrices:
+    """Test row-major mat_int selection for rectangular list[list[int]] matrices."""
+
+    MATMUL = """
+def create_matrix(rows: int, cols: int, value: int) -> list[list[int]]:
+    matrix: list[list[int]] = []
+    for i in range(rows):
+        row: list[int] = []
+        for j in range(cols):
+            row.append(value)
+        matrix.append(row)
+    return matrix
+
+
+def multiply(a: list[list[int]], b: list[list[int]]) -> list[list[int]]:
+    result: list[list[int]] = create_matrix(len(a), len(b[0]), 0)
+    for i in range(len(a)):
+        for j in range(len(b[0])):
+            total: int = 0
+            for k in range(len(b)):
+                total += a[i][k] * b[k][j]
+            result[i][j] = total
+    return result
+
+
+def main() -> int:
+    a: list[list[int]] = create_matrix(3, 4, 2)
+    b: list[list[int]] = create_matrix(4, 2, 3)
+    c: list[list[int]] = multiply(a, b)
+    print(c[1][1])
+    return 0
+"""
+
+    def test_rectangular_matrices_are_flat(self):
+        """Fill-pattern rows of loop-invariant length use one row-major buffer."""
+        c_code = MGenPythonToCConverter().convert_code(self.MATMUL)
+
+        assert '#include "mgen_mat_int.h"' in c_code
+        assert "vec_vec_int" not in c_code
+        assert "mat_int create_matrix(int rows, int cols, int value)" in c_code
+        assert "mat_int multiply(mat_int a, mat_int b)" in c_code
+        assert "mat_int matrix = {0};" in c_code
+        assert "mat_int_append_row(&matrix, row.data, (size_t)row.size); vec_int_drop(&row);" in c_code
+        assert "*mat_int_at(&a, i, k) * *mat_int_at(&b, k, j)" in c_code
+        assert "*mat_int_at(&result, i, j) = total;" in c_code
+        assert "mat_int_rows(&a)" in c_code
+        assert "mat_int_cols(&b)" in c_code
+
+    def test_ragged_rows_stay_nested(self):
+        """Rows whose length depends on the outer loop keep vec_vec_int."""
+        python_code = """
+def triangle(n: int) -> list[list[int]]:
+    matrix: list[list[int]] = []
+    for i in range(n):
+        row: list[int] = []
+        for j in range(i + 1):
+            row.append(j)
+        matrix.append(row)
+    return matrix
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert "vec_vec_int triangle(int n)" in c_code
+        assert "mat_int" not in c_code
+
+    def test_row_used_after_append_stays_nested(self):
+        """A row that is modified after being appended keeps vec_vec_int."""
+        python_code = """
+def build(n: int) -> list[list[int]]:
+    matrix: list[list[int]] = []
+    for i in range(n):
+        row: list[int] = []
+        for j in range(n):
+            row.append(j)
+        matrix.append(row)
+        row.append(i)
+    return matrix
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert "vec_vec_int build(int n)" in c_code
+        assert "mat_int" not in c_code
+
+    def test_flat_matrices_preference(self):
+        """The flat_matrices preference restores nested vectors."""
+        preferences = CPreferences()
+        preferences.set("flat_matrices", False)
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.MATMUL)
+
+        assert "mat_int" not in c_code
+        assert "vec_vec_int multiply(vec_vec_int a, vec_vec_int b)" in c_code
+
+
+class TestBoundsCheckElision:
+    """Test unchecked element access for subscripts range loops keep in bounds."""
+
+    CODE = """
+def total(xs: list[int]) -> int:
+    t: int = 0
+    for i in range(len(xs)):
+        t += xs[i]
+    return t
+
+
+def pairs(xs: list[int], n: int) -> int:
+    t: int = 0
+    for i in range(1, n):
+        t += xs[i - 1] * xs[i]
+    return t
+
+
+def main() -> int:
+    xs: list[int] = [1, 2, 3, 4]
+    print(total(xs))
+    print(pairs(xs, 4))
+    return 0
+"""
+
+    def test_proven_subscripts_are_unchecked(self):
+        """Test a[i] in range(len(a)) indexes the buffer directly."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "t += xs.data[i];" in c_code
+        assert "t += *vec_int_at(&xs, i);" not in c_code
+
+    def test_affine_subscripts_hoist_one_range_check(self):
+        """Test a[i - 1] in range(1, n) is checked once before the loop, keeping the checked loop as fallback."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "if (((1) >= (n) || ((n) - 1 < (int)vec_int_size(&xs)))) {" in c_code
+        assert "t += (xs.data[(i - 1)] * xs.data[i]);" in c_code
+        assert "} else {" in c_code
+        assert "t += (*vec_int_at(&xs, (i - 1)) * *vec_int_at(&xs, i));" in c_code
+
+    def test_negative_offset_from_zero_stays_checked(self):
+        """Test a[i - 1] in range(len(a)) is not proven: i = 0 reads before the buffer."""
+        code = """
+def wrap(a: list[int]) -> int:
+    t: int = 0
+    for i in range(len(a)):
+        t += a[i - 1]
+    return t
+"""
+        c_code = MGenPythonToCConverter().convert_code(code)
+
+        assert "if (((0) >= (vec_int_size(&a)) || ((0) - 1 >= 0))) {" in c_code
+        assert "t += *vec_int_at(&a, (i - 1));" in c_code
+
+    def test_flat_matrix_product_is_unchecked(self):
+        """Test the checks of a matrix product's nest are hoisted above its outermost loop."""
+        c_code = MGenPythonToCConverter().convert_code(TestFlatMatrices.MATMUL)
+
+        assert "total += (a.data[(i) * a.stride + (k)] * b.data[(k) * b.stride + (j)]);" in c_code
+        assert "result.data[(i) * result.stride + (j)] = total;" in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_unchecked_program_computes_python_result(self, tmp_path):
+        """Test the program taking the unchecked versions prints what Python does."""
+        source = tmp_path / "bounds.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "bounds")], capture_output=True, text=True)
+
+        assert result.stdout.split() == ["10", "20"]
+
+
+class TestHashCursorLoops:
+    """Test that dict views are iterated with the containers' begin/next cursors."""
+
+    def test_items_loop_binds_first_and_second(self):
+        """for k, v in d.items() walks a map_int_int cursor without a callback."""
+        python_code = """
+def total(a: dict[int, int]) -> int:
+    s: int = 0
+    for k, v in a.items():
+        s += k * v
+    return s
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert "map_int_int_iter iter_" in c_code
+        assert "= map_int_int_begin(&a);" in c_code
+        assert ".ref->first;" in c_code
+        assert ".ref->second;" in c_code
+        assert "s += (k * v);" in c_code
+
+    def test_str_keyed_map_cursor(self):
+        """A dict[str, int] iterates the string map cursor and binds char* keys."""
+        python_code = """
+def count(b: dict[str, int]) -> int:
+    n: int = 0
+    for name in b.keys():
+        n += 1
+    return n
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert "mgen_str_int_map_iter iter_" in c_code
+        assert "= mgen_str_int_map_begin(b);" in c_code
+        assert "char* name = iter_" in c_code
+
+
+class TestVecMembershipAndEquality:
+    """Test that `in` and `==` on lists call type-specialized vector helpers."""
+
+    SOURCE = """
+def has(lst: list[int], x: int) -> bool:
+    return x in lst
+
+
+def same(a: list[int], b: list[int]) -> bool:
+    return a != b
+"""
+
+    def test_runtime_mode_uses_stc_find_and_eq(self):
+        """STC vectors of comparable elements are declared with i_use_cmp for find/eq."""
+        c_code = MGenPythonToCConverter().convert_code(self.SOURCE)
+
+        assert "#define i_key int\n#define i_use_cmp\n" in c_code
+        assert "return (vec_int_find(&lst, x).ref != NULL);" in c_code
+        assert "return (!vec_int_eq(&a, &b));" in c_code
+        assert "vec_contains_" not in c_code
+
+    def test_generated_mode_uses_template_helpers(self):
+        """Generated vectors use the contains/equal functions emitted with the container."""
+        preferences = CPreferences()
+        preferences.set("container_mode", "generated")
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.SOURCE)
+
+        assert "return vec_int_contains(&lst, x);" in c_code
+        assert "return (!vec_int_equal(&a, &b));" in c_code
+        assert "bool vec_int_contains(const vec_int* vec, int value) {" in c_code
+
+
+class TestContainerLifetimes:
+    """Test that function-local containers are dropped after their last use."""
+
+    CODE = """
+def work(n: int) -> int:
+    evens: list[int] = []
+    for i in range(n):
+        evens.append(i * 2)
+    a: int = len(evens)
+    seen: set[int] = set()
+    for e in evens:
+        seen.add(e % 7)
+    odds: list[int] = []
+    for j in range(n):
+        odds.append(2 * j + 1)
+    return a + len(seen) + odds[2]
+
+
+def early(n: int) -> int:
+    first: list[int] = [1, 2, 3]
+    if n > 5:
+        return first[0]
+    return first[2] + n
+
+
+def main() -> int:
+    print(work(10))
+    print(early(3))
+    print(early(8))
+    return 0
+"""
+
+    def test_dead_buffer_is_recycled(self):
+        """Test a list declared after another list's last use takes over its buffer."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "vec_int odds = evens;\n    vec_int_clear(&odds);" in c_code
+        assert "vec_int_drop(&evens);" not in c_code
+
+    def test_live_containers_are_dropped_at_returns(self):
+        """Test every return computes its value before dropping the containers still live."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "set_int_drop(&seen);" in c_code
+        assert "vec_int_drop(&odds);" in c_code
+        assert c_code.count("vec_int_drop(&first);") == 2
+        assert "return first.data[0];" not in c_code
+
+    def test_lifetimes_can_be_disabled(self):
+        """Test the container_lifetimes preference turns the drops off."""
+        preferences = CPreferences()
+        preferences.set("container_lifetimes", False)
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.CODE)
+
+        assert "_drop(&" not in c_code
+        assert "vec_int odds = evens;" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_managed_program_computes_python_result(self, tmp_path):
+        """Test the program with drops and recycled buffers prints what Python does."""
+        source = tmp_path / "lifetimes.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "lifetimes")], capture_output=True, text=True)
+
+        assert result.stdout.split() == ["22", "6", "1"]
+
+
+class TestInternedStringKeys:
+    """Test that string maps are keyed by interned symbols and literal keys are interned at startup."""
+
+    CODE = """
+def score(text: str) -> int:
+    counts: dict[str, int] = {"the": 0}
+    for w in text.split():
+        counts[w] = counts.get(w, 0) + 1
+    total: int = counts["the"]
+    if "fox" in counts:
+        total += counts["fox"]
+    return total
+
+
+def main() -> int:
+    print(score("the fox saw the dog"))
+    return 0
+"""
+
+    def test_literal_keys_use_symbols(self):
+        """Test each literal key gets one symbol, interned when main starts."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "static const char* str_sym_0;" in c_code
+        assert 'str_sym_0 = mgen_str_intern("the");' in c_code
+        assert 'str_sym_1 = mgen_str_intern("fox");' in c_code
+        assert "int main(void) {\n    mgen_intern_literals();" in c_code
+        assert "mgen_str_int_map_t* counts = mgen_str_int_map_new_interned();" in c_code
+        assert "mgen_str_int_map_insert_symbol(counts, str_sym_0, 0);" in c_code
+        assert "*mgen_str_int_map_get_symbol(counts, str_sym_0)" in c_code
+        assert "mgen_str_int_map_contains_symbol(counts, str_sym_1)" in c_code
+        assert "*mgen_str_int_map_get_or_insert(counts, w, 0) += 1;" in c_code
+
+    def test_interning_can_be_disabled(self):
+        """Test the intern_strings preference keeps copied keys and plain literals."""
+        preferences = CPreferences()
+        preferences.set("intern_strings", False)
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.CODE)
+
+        assert "mgen_str_int_map_new();" in c_code
+        assert 'mgen_str_int_map_contains(counts, "fox")' in c_code
+        assert "str_sym_" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_interned_program_computes_python_result(self, tmp_path):
+        """Test the program with interned keys prints what Python does."""
+        source = tmp_path / "interned.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "interned")], capture_output=True, text=True)
+
+        assert result.stdout.split() == ["3"]
+
+
+class TestGeneratorCoroutines:
+    """Test that generator functions become STC coroutines consumed one value at a time."""
+
+    CODE = """
+from typing import Iterator
+
+
+def evens(n: int) -> Iterator[int]:
+    for i in range(n):
+        if i % 2 == 0:
+            yield i
+
+
+def scaled(xs: list[int], k: int) -> Iterator[int]:
+    total: int = 0
+    for x in xs:
+        total += x
+        yield x * k + total
+    yield total
+
+
+def countdown(n: int) -> Iterator[int]:
+    m: int = n
+    while m > 0:
+        yield m
+        m -= 1
+        if m == 2:
+            return
+
+
+def loops() -> int:
+    acc: int = 0
+    for e in evens(10):
+        acc += e
+    xs: list[int] = [1, 2, 3]
+    for v in scaled(xs, 10):
+        acc += v
+    return acc
+
+
+def main() -> int:
+    print(loops())
+    print(sum(evens(7)))
+    print(sum(countdown(9)))
+    print(any(countdown(5)))
+    return 0
+"""
+
+    def test_generator_state_lives_in_frame(self):
+        """Test parameters, locals and loop indices become frame fields the body reaches through co."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert '#include "stc/coroutine.h"' in c_code
+        assert "typedef struct {\n    cco_base base;\n    int n;\n    int i;\n    int yielded;\n} evens_gen;" in c_code
+        assert "int evens(evens_gen* co) {\n    cco_async (co) {" in c_code
+        assert "for (co->i = 0; co->i < co->n; co->i += 1) {" in c_code
+        assert "co->yielded = co->i;\n" in c_code
+        assert "cco_yield;" in c_code
+        assert "size_t loop_idx_0;" in c_code
+        assert "co->x = *vec_int_at(&co->xs, co->loop_idx_0);" in c_code
+        assert "cco_exit();" in c_code
+
+    def test_consumers_resume_the_coroutine(self):
+        """Test for loops and sum()/any() drive a frame instead of materializing a list."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "scaled_gen gen_" in c_code
+        assert "= {.xs = xs, .k = 10};" in c_code
+        assert "while (evens(&gen_" in c_code
+        assert ".yielded; sum_" in c_code
+        assert "while (!any_" in c_code
+
+    def test_unsupported_generator_use_is_rejected(self):
+        """Test a generator call outside a loop or reduction reports an unsupported feature."""
+        code = self.CODE.replace("print(loops())", "g: int = evens(3)")
+
+        with pytest.raises(UnsupportedFeatureError):
+            MGenPythonToCConverter().convert_code(code)
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_coroutine_program_computes_python_result(self, tmp_path):
+        """Test the program with coroutines prints what Python does."""
+        source = tmp_path / "coroutines.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "coroutines")], capture_output=True, text=True)
+
+        assert result.stdout.split() == ["96", "12", "42", "1"]
+
+
+class TestContainerStrategy:
+    """Test STC containers are the default and the hand-written ones the fallback."""
+
+    CODE = """
+def fill(n: int) -> list[int]:
+    out: list[int] = []
+    for i in range(n):
+        out.append(i * 3 % 11)
+    return out
+
+
+def distinct(xs: list[int]) -> int:
+    seen: set[int] = set()
+    for x in xs:
+        seen.add(x)
+    return len(seen)
+
+
+def tally(xs: list[int]) -> int:
+    counts: dict[int, int] = {}
+    for x in xs:
+        counts[x] = counts.get(x, 0) + 1
+    return counts[3]
+
+
+def words(text: str) -> int:
+    freq: dict[str, int] = {"a": 0}
+    for w in text.split():
+        freq[w] = freq.get(w, 0) + 1
+    return freq["a"]
+
+
+def main() -> int:
+    xs: list[int] = fill(40)
+    print(distinct(xs))
+    print(tally(xs))
+    print(words("a b a c a"))
+    return 0
+"""
+
+    def _hand_written(self) -> CPreferences:
+        preferences = CPreferences()
+        preferences.set("use_stc_containers", False)
+        return preferences
+
+    def test_stc_is_default(self):
+        """Test the default strategy instantiates STC hmap, hset and vec."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert '#include "stc/hmap.h"' in c_code
+        assert '#include "stc/hset.h"' in c_code
+        assert "map_int_int_get(&counts, 3)->second" in c_code
+
+    def test_hand_written_fallback(self):
+        """Test use_stc_containers=False emits the hand-written containers inline instead."""
+        c_code = MGenPythonToCConverter(self._hand_written()).convert_code(self.CODE)
+
+        assert "stc/" not in c_code
+        assert "#define i_key" not in c_code
+        assert "static int* map_int_int_get(map_int_int* map, int key) {" in c_code
+        assert "*map_int_int_get(&counts, 3)" in c_code
+        assert "mgen_str_int_map_t* mgen_str_int_map_new" in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_strategies_compute_the_same_result(self, tmp_path):
+        """Test STC and hand-written containers both print what Python does."""
+        for name, preferences in (("stc", CPreferences()), ("hand_written", self._hand_written())):
+            source = tmp_path / f"{name}.c"
+            source.write_text(MGenPythonToCConverter(preferences).convert_code(self.CODE))
+
+            assert CBuilder().compile_direct(str(source), str(tmp_path))
+            result = subprocess.run([str(tmp_path / name)], capture_output=True, text=True)
+
+            assert result.stdout.split() == ["11", "4", "3"]
+
+
+class TestSorting:
+    """Test sorted() and list.sort() lower to the type-specialized sorts of mgen_sort.h."""
+
+    CODE = """
+def neg(x: int) -> int:
+    return -x
+
+
+def parity(x: int) -> int:
+    return x % 2
+
+
+def first_sorted(xs: list[int]) -> int:
+    ys: list[int] = sorted(xs)
+    return ys[0] * 100 + ys[len(ys) - 1]
+
+
+def sort_in_place(xs: list[int]) -> int:
+    xs.sort(reverse=True)
+    return xs[1]
+
+
+def by_key(xs: list[int]) -> int:
+    ys: list[int] = sorted(xs, key=neg)
+    zs: list[int] = sorted(xs, key=parity, reverse=True)
+    return ys[0] * 1000 + zs[0] * 10 + zs[4]
+
+
+def shortest(text: str) -> int:
+    ws: list[str] = text.split()
+    ws.sort(key=len)
+    first: str = ws[0]
+    return len(first)
+
+
+def longest(text: str) -> int:
+    ws: list[str] = sorted(text.split(), key=len, reverse=True)
+    first: str = ws[0]
+    return len(first)
+
+
+def main() -> int:
+    xs: list[int] = [5, 3, 9, 1, 7, 2]
+    print(first_sorted(xs))
+    print(sort_in_place(xs))
+    print(by_key(xs))
+    print(shortest("ccc a bb dddd"))
+    print(longest("ccc a bb dddd"))
+    return 0
+"""
+
+    def test_sorts_are_specialized(self):
+        """Test plain sorts call the int sort and key sorts sort by a key array computed once."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert '#include "mgen_sort.h"' in c_code
+        assert "= vec_int_clone(xs); mgen_sort_int(sorted_" in c_code
+        assert "mgen_sort_int(xs.data, (size_t)vec_int_size(&xs)); mgen_sort_int_reverse(xs.data," in c_code
+        assert "= neg(sorted_" in c_code
+        assert "sort_keys_" in c_code and ", true); free(sort_keys_" in c_code
+        assert "(int)mgen_utf8_len(ws->strings[sort_idx_" in c_code
+        assert "qsort" not in c_code
+
+    def test_stc_strings_instantiate_cstr_sort(self):
+        """Test sorting an STC list of str instantiates the sort for cstr elements."""
+        code = """
+def names() -> int:
+    ns: list[str] = []
+    ns.append("pear")
+    ns.append("fig")
+    ns.sort()
+    return len(ns)
+"""
+        c_code = MGenPythonToCConverter().convert_code(code)
+
+        assert "#define MGEN_SORT_T cstr\n" in c_code
+        assert "mgen_sort_cstr(ns.data, (size_t)vec_cstr_size(&ns));" in c_code
+
+    def test_unsupported_key_is_rejected(self):
+        """Test a key that is not a module function or len fails conversion."""
+        code = """
+def f(xs: list[int]) -> int:
+    ys: list[int] = sorted(xs, key=abs)
+    return ys[0]
+"""
+        with pytest.raises(UnsupportedFeatureError):
+            MGenPythonToCConverter().convert_code(code)
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_sorted_program_computes_python_result(self, tmp_path):
+        """Test both container strategies sort like Python."""
+        hand_written = CPreferences()
+        hand_written.set("use_stc_containers", False)
+        for name, preferences in (("stc", CPreferences()), ("hand_written", hand_written)):
+            source = tmp_path / f"{name}.c"
+            source.write_text(MGenPythonToCConverter(preferences).convert_code(self.CODE))
+
+            assert CBuilder().compile_direct(str(source), str(tmp_path))
+            result = subprocess.run([str(tmp_path / name)], capture_output=True, text=True)
+
+            assert result.stdout.split() == ["109", "7", "9091", "1", "4"]
+
+
+class TestStringCodePoints:
+    """Test len(), s[i], s[a:b] and for ch in s count code points through mgen_utf8.h."""
+
+    CODE = """
+def size(s: str) -> int:
+    return len(s)
+
+
+def pick(s: str, i: int) -> str:
+    return s[i]
+
+
+def middle(s: str) -> str:
+    return s[1:4]
+
+
+def tail(s: str) -> str:
+    return s[-3:]
+
+
+def vowels(s: str) -> int:
+    n: int = 0
+    for ch in s:
+        if ch == "é":
+            n += 1
+    return n
+
+
+def matches(s: str, c: str) -> int:
+    hits: int = 0
+    for i in range(len(s)):
+        if s[i] == c:
+            hits += 1
+    return hits
+
+
+def main() -> int:
+    print(size("héllo wörld"))
+    a: str = pick("héllo", -4)
+    print(a)
+    b: str = middle("été chaud")
+    print(b)
+    c: str = tail("naïve")
+    print(c)
+    print(vowels("été été"))
+    print(matches("été été", "t"))
+    return 0
+"""
+
+    def test_loop_indexing_uses_cached_view(self):
+        """Test a str parameter indexed in a loop gets one view, released on return."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert '#include "mgen_utf8.h"' in c_code
+        assert "mgen_utf8_str_t s_utf8 = mgen_utf8_view(s);" in c_code
+        assert "i < (int)s_utf8.length" in c_code
+        assert "mgen_utf8_char_is(&s_utf8, i, c)" in c_code
+        assert "mgen_utf8_release(&s_utf8);" in c_code
+        assert c_code.count("mgen_utf8_view(") == 1
+
+    def test_one_off_access_walks_the_string(self):
+        """Test indexing outside a loop, slicing and iteration need no view."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "return (int)mgen_utf8_len(s);" in c_code
+        assert "return mgen_utf8_str_at(s, i);" in c_code
+        assert "mgen_utf8_str_slice(s, (-3), MGEN_UTF8_END)" in c_code
+        assert "(ch = mgen_utf8_next(&chars_" in c_code
+
+    def test_stepped_string_slice_is_rejected(self):
+        """Test a string slice with a step fails conversion."""
+        code = """
+def evens(s: str) -> str:
+    return s[::2]
+"""
+        with pytest.raises(UnsupportedFeatureError):
+            MGenPythonToCConverter().convert_code(code)
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_program_counts_code_points_like_python(self, tmp_path):
+        """Test the compiled program matches Python on non-ASCII text."""
+        source = tmp_path / "utf8.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "utf8")], capture_output=True, text=True)
+
+        assert result.stdout.split("\n")[:6] == ["11", "é", "té ", "ïve", "4", "2"]
+
+
+class TestBufferedStdout:
+    """Test print() writes into the mgen_stdout buffer."""
+
+    CODE = """
+def main() -> int:
+    n: int = 3
+    x: float = 2.5
+    name: str = "abc"
+    flag: bool = True
+    print(n)
+    print(name, n, x, flag)
+    print()
+    return 0
+"""
+
+    def test_print_calls_write_into_buffer(self):
+        """Test each argument is written by type, the last one ending the line."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert '#include "mgen_stdout.h"' in c_code
+        assert "mgen_print_int(n);" in c_code
+        assert (
+            "(mgen_stdout_str(name), mgen_stdout_char(' '), mgen_stdout_int(n), mgen_stdout_char(' '), "
+            "mgen_stdout_double(x), mgen_stdout_char(' '), mgen_print_bool(flag));"
+        ) in c_code
+        assert "mgen_stdout_newline();" in c_code
+        assert "printf(" not in c_code
+
+    def test_printf_without_buffered_stdout(self):
+        """Test print() stays printf when buffered_stdout is off."""
+        preferences = CPreferences()
+        preferences.set("buffered_stdout", False)
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.CODE)
+
+        assert 'printf("%d\\n", n);' in c_code
+        assert 'printf("%s %d %f %s\\n", name, n, x, flag ? "true" : "false");' in c_code
+        assert "mgen_stdout" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_buffered_output_is_flushed_at_exit(self, tmp_path):
+        """Test the compiled program prints the same text printf did."""
+        source = tmp_path / "out.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "out")], capture_output=True, text=True)
+
+        assert result.stdout == "3\nabc 3 2.500000 true\n\n"
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_printing_program_compiles_without_warnings(self, tmp_path):
+        """Test mgen_stdout.h compiles warning-free under the builder's strict C11 flags."""
+        source = tmp_path / "warn.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE))
+        runtime = CBuilder().runtime_dir
+
+        build = subprocess.run(
+            ["gcc", *BASE_FLAGS, "-Werror", f"-I{runtime}", "-c", str(source), "-o", str(tmp_path / "warn.o")],
+            capture_output=True,
+            text=True,
+        )
+        assert build.returncode == 0, build.stderr
+
+    LIST_CODE = """
+def main() -> int:
+    nums: list[int] = [3, -1, 40]
+    vals: list[float] = [1.5, 2.0, 0.1]
+    empty: list[int] = []
+    print(nums)
+    print("vals:", vals)
+    print(empty)
+    return 0
+"""
+
+    def test_lists_stream_their_repr(self):
+        """Test a list argument is written from its items, with no repr string built."""
+        c_code = MGenPythonToCConverter().convert_code(self.LIST_CODE)
+
+        assert "mgen_print_int_list(nums.data, (size_t)nums.size);" in c_code
+        assert (
+            '(mgen_stdout_str("vals:"), mgen_stdout_char(\' \'), mgen_print_double_list(vals.data, (size_t)vals.size));'
+        ) in c_code
+
+    def test_lists_without_buffered_stdout_flush(self):
+        """Test list output goes through the buffer and is flushed before later printf() calls."""
+        preferences = CPreferences()
+        preferences.set("buffered_stdout", False)
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.LIST_CODE)
+
+        assert "(mgen_print_int_list(nums.data, (size_t)nums.size), mgen_stdout_flush());" in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_list_output_matches_python(self, tmp_path):
+        """Test the compiled program prints lists as Python does."""
+        source = tmp_path / "lists.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.LIST_CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "lists")], capture_output=True, text=True)
+
+        assert result.stdout == "[3, -1, 40]\nvals: [1.5, 2.0, 0.1]\n[]\n"
+
+
+class TestSliceViews:
+    """Test read-only list slices alias their source instead of copying it."""
+
+    CODE = """
+def count_below(xs: list[int], limit: int) -> int:
+    if len(xs) == 0:
+        return 0
+    mid: int = len(xs) // 2
+    here: int = 0
+    if xs[mid] < limit:
+        here = 1
+    return count_below(xs[:mid], limit) + count_below(xs[mid + 1:], limit) + here
+
+
+def grow(xs: list[int], ys: list[int]) -> int:
+    xs.append(0)
+    return len(ys)
+
+
+def main() -> int:
+    data: list[int] = [5, 1, 9, 3, 7, 2, 8]
+    print(count_below(data[-5:], 6))
+    print(grow(data, data[2:]))
+    return 0
+"""
+
+    def test_borrowed_slices_become_views(self):
+        """Test slices passed to borrowed parameters share the source's elements."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert '#include "mgen_stc_bridge.h"' in c_code
+        assert c_code.count("mgen_slice_range((size_t)vec_int_size(&xs)") == 2
+        assert "mgen_slice_range((size_t)vec_int_size(&data), (-5), MGEN_SLICE_END" in c_code
+        assert "(vec_int){.data = xs.data + " in c_code
+
+    def test_slices_next_to_their_source_are_copied(self):
+        """Test a slice passed with its (mutable) source in the same call stays a copy."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        grow_call = c_code[c_code.index("grow(data, ") :]
+        assert grow_call.index("vec_int_push(&slice_result_") < grow_call.index(";\n    return 0;")
+
+    def test_copies_without_slice_views(self):
+        """Test every slice is copied when slice_views is off."""
+        preferences = CPreferences()
+        preferences.set("slice_views", False)
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.CODE)
+
+        assert "mgen_slice_range" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_views_compute_the_same_results(self, tmp_path):
+        """Test the compiled program matches Python, negative bounds included."""
+        source = tmp_path / "out.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "out")], capture_output=True, text=True)
+
+        assert result.stdout == "2\n5\n"
+
+
+class TestAnnotatedScalarContainers:
+    """Test dict[K, V] and set[T] annotations over scalars select their own containers."""
+
+    CODE = """
+def main() -> int:
+    d: dict[int, float] = {}
+    for i in range(10):
+        d[i] = i * 0.5
+    s: set[float] = set()
+    for i in range(10):
+        s.add(i * 0.25)
+    s.add(0.5)
+    total: float = 0.0
+    for i in range(10):
+        total = total + d[i]
+    print(len(d))
+    print(len(s))
+    print(total)
+    if 0.75 in s:
+        print(1)
+    return 0
+"""
+
+    def test_float_values_and_keys_keep_their_type(self):
+        """Test the annotation wins over the int default of usage inference."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "map_int_double d = {0};" in c_code
+        assert "set_double s = {0};" in c_code
+        assert "#define i_type map_int_double" in c_code
+        assert "#define i_type set_double" in c_code
+
+    def test_generated_mode_instantiates_templates(self):
+        """Test generated mode emits the templated map_int_double and set_double."""
+        preferences = CPreferences()
+        preferences.set("container_mode", "generated")
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.CODE)
+
+        assert "Generated Container: map_int_double" in c_code
+        assert "Generated Container: set_double" in c_code
+        assert "STC_ENABLED" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_both_modes_compute_python_result(self, tmp_path):
+        """Test the STC and generated programs print what Python prints."""
+        for mode in ("stc", "generated"):
+            preferences = CPreferences()
+            preferences.set("container_mode", mode)
+            source = tmp_path / mode / "out.c"
+            source.parent.mkdir()
+            source.write_text(MGenPythonToCConverter(preferences).convert_code(self.CODE))
+
+            assert CBuilder().compile_direct(str(source), str(source.parent))
+            result = subprocess.run([str(source.parent / "out")], capture_output=True, text=True)
+
+            assert result.stdout == "10\n10\n22.500000\n1\n"
+
+
+class TestParallelPool:
+    """Test the parallel preference: loops and comprehensions on the mgen_parallel thread pool."""
+
+    CODE = """
+def square(x: int) -> int:
+    return x * x
+
+
+def scale(xs: list[int], k: int) -> int:
+    total: int = 0
+    count: int = 0
+    for i in range(len(xs)):
+        v: int = xs[i] * k
+        xs[i] = v % 1000
+        total += v
+        count += 1
+    return total + count
+
+
+def main() -> int:
+    n: int = 300000
+    k: int = 3
+    xs: list[int] = [square(i % 1000) % 97 + k for i in range(n)]
+    ys: list[int] = [x * 2 + k for x in xs]
+    print(scale(xs, 3))
+    print(scale(ys, 7))
+    print(xs[n - 1])
+    print(ys[5])
+    return 0
+"""
+
+    def convert(self, **settings):
+        """Convert CODE with the given C preferences."""
+        preferences = CPreferences()
+        for name, value in settings.items():
+            preferences.set(name, value)
+        return MGenPythonToCConverter(preferences).convert_code(self.CODE)
+
+    def test_loops_and_comprehensions_are_outlined(self):
+        """Test the reduction loop and both comprehensions become chunk functions run by the pool."""
+        c_code = self.convert(parallel=True)
+
+        assert '#include "mgen_parallel.h"' in c_code
+        chunk = "static void scale_parallel_1(void* mgen_arg, size_t mgen_begin, size_t mgen_end, long long* mgen_sums)"
+        assert chunk in c_code
+        assert "    vec_int xs = mgen_ctx->xs;\n" in c_code
+        assert "mgen_sums[1] += total;" in c_code
+        assert "total += (int)scale_parallel_1_sums[1];" in c_code
+        assert "mgen_parallel_for(comp_result_" in c_code
+        assert "mgen_parallel_map(xs.data, sizeof(int), " in c_code
+        # The chunk functions precede the functions they were outlined from
+        assert c_code.index("static void main_parallel_2(") < c_code.index("int main(void)")
+        assert "#pragma omp" not in c_code
+
+    def test_openmp_and_default_preferences(self):
+        """Test parallel_loops keeps its OpenMP pragmas and neither preference stays serial."""
+        assert "mgen_parallel" not in self.convert()
+        c_code = self.convert(parallel=True, parallel_loops=True)
+        assert "#pragma omp parallel for reduction(+:count, total)" in c_code
+        assert "mgen_parallel" not in c_code
+
+    def test_impure_elements_stay_serial(self):
+        """Test comprehensions calling functions with side effects are not run on the pool."""
+        python_code = """
+def log(x: int) -> int:
+    print(x)
+    return x
+
+
+def main() -> int:
+    xs: list[int] = [log(i) for i in range(10)]
+    return len(xs)
+"""
+        preferences = CPreferences()
+        preferences.set("parallel", True)
+        assert "mgen_parallel" not in MGenPythonToCConverter(preferences).convert_code(python_code)
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_pool_program_matches_python(self, tmp_path):
+        """Test the threaded program computes what Python does in both container modes."""
+        for mode in ("stc", "generated"):
+            source = tmp_path / mode / "pool.c"
+            source.parent.mkdir()
+            source.write_text(self.convert(parallel=True, parallel_threshold=1000, container_mode=mode))
+
+            assert CBuilder().compile_direct(str(source), str(source.parent))
+            with mock.patch.dict(os.environ, {"MGEN_NUM_THREADS": "4"}):
+                result = subprocess.run([str(source.parent / "pool")], capture_output=True, text=True, check=True)
+
+            assert result.stdout == "46056000\n220128000\n204\n413\n"
+
+
+class TestBitsetSets:
+    """Test set[int] locals with range-bounded values become dense bitsets."""
+
+    CODE = """
+def count_unique(xs: list[int]) -> int:
+    seen: set[int] = set()
+    for x in xs:
+        seen.add(x)
+    return len(seen)
+
+
+def main() -> int:
+    hit: set[int] = {1, 2, 3}
+    for i in range(100):
+        hit.add(i * 7 % 64 + 3)
+    hit.discard(2)
+    misses: int = 0
+    for k in range(300):
+        if k not in hit:
+            misses += 1
+    print(len(hit))
+    print(misses)
+    xs: list[int] = [4, 4, -1]
+    print(count_unique(xs))
+    return 0
+"""
+
+    def test_bounded_sets_use_bitsets(self):
+        """Test bounded sets are sized for their domain and sets of unknown values stay hash sets."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert '#include "mgen_bitset_int.h"' in c_code
+        assert "bitset_int hit = {0};\n    bitset_int_reserve(&hit, 67);" in c_code
+        assert "if ((!bitset_int_contains(&hit, k)))" in c_code
+        assert "bitset_int_drop(&hit);" in c_code
+        # Loop elements over a list have no bounds
+        assert "set_int seen = {0};" in c_code
+
+    def test_preference_zero_keeps_hash_sets(self):
+        """Test bitset_sets=0 turns the representation off."""
+        preferences = CPreferences()
+        preferences.set("bitset_sets", 0)
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.CODE)
+
+        assert "bitset_int" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_both_modes_compute_python_result(self, tmp_path):
+        """Test the STC and generated programs print what Python prints."""
+        for mode in ("stc", "generated"):
+            preferences = CPreferences()
+            preferences.set("container_mode", mode)
+            source = tmp_path / mode / "out.c"
+            source.parent.mkdir()
+            source.write_text(MGenPythonToCConverter(preferences).convert_code(self.CODE))
+
+            assert CBuilder().compile_direct(str(source), str(source.parent))
+            result = subprocess.run([str(source.parent / "out")], capture_output=True, text=True)
+
+            assert result.stdout == "65\n235\n2\n"
+
+
+class TestStringDispatch:
+    """Test string if/elif chains and read-only str dicts compiled to length-then-byte switches."""
+
+    CODE = """
+def score(word: str) -> int:
+    table: dict[str, int] = {"if": 1, "else": 2, "while": 3, "for": 4, "return": 5}
+    if word in table:
+        return table[word] + len(table)
+    return 0
+
+
+def kind(op: str) -> int:
+    if op == "add":
+        return 1
+    elif op == "sub" or op == "minus":
+        return 2
+    elif op == "mul":
+        return 3
+    else:
+        return 0
+
+
+def classify(words: list[str]) -> int:
+    n: int = 0
+    for w in words:
+        if w == "stop":
+            n += 10
+        elif w in ("skip", "pass"):
+            n += 0
+        elif w == "":
+            n += 100
+        else:
+            n += 1
+    return n
+
+
+def main() -> int:
+    print(score("while") + score("x") + kind("sub") + kind("mul") + kind("?"))
+    words: list[str] = ["x", "skip", "", "y", "stop", "z"]
+    print(classify(words))
+    return 0
+
+"""
+
+    def test_chains_and_constant_dicts_use_dispatch_functions(self):
+        """Test the dict becomes a static table and each chain branches on one str_match call."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "static const int str_table_0_values[5] = {1, 2, 3, 4, 5};" in c_code
+        assert "if ((str_match_0(word) >= 0)) {\n        return (str_table_0_at(word) + 5);" in c_code
+        assert "mgen_str_int_map_new" not in c_code
+        assert "int str_branch_1 = str_match_1(op);" in c_code
+        assert 'case \'s\':\n            return memcmp(s, "sub", 3) == 0 ? 1 : -1;' in c_code
+        # Loop elements of a vec_cstr are STC strings
+        assert "int str_branch_2 = str_match_2(cstr_str(&w));" in c_code
+
+    def test_preference_off_keeps_strcmp_chains(self):
+        """Test string_dispatch=False keeps the comparisons and the runtime map."""
+        preferences = CPreferences()
+        preferences.set("string_dispatch", False)
+        # Membership in a literal tuple needs the dispatch: leave classify() out
+        c_code = MGenPythonToCConverter(preferences).convert_code(self.CODE.split("def classify")[0])
+
+        assert "str_match" not in c_code
+        assert 'strcmp(op, "add") == 0' in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_dispatch_program_computes_python_result(self, tmp_path):
+        """Test the generated program prints what Python prints."""
+        source = tmp_path / "dispatch.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "dispatch")], capture_output=True, text=True)
+
+        assert result.stdout == "13\n113\n"
+
+
+class TestStructOfArraysLists:
+    """Test lists of plain scalar-field classes stored as one array per field (soa_lists)."""
+
+    CODE = """
+class Particle:
+    def __init__(self, x: float, v: float) -> None:
+        self.x: float = x
+        self.v: float = v
+        self.hits: int = 0
+
+
+def step(ps: list[Particle], dt: float) -> None:
+    for p in ps:
+        p.x += p.v * dt
+        if p.x > 10.0:
+            p.hits += 1
+
+
+def total(ps: list[Particle]) -> float:
+    s: float = 0.0
+    for i in range(len(ps)):
+        s += ps[i].x + ps[i].hits
+    return s
+
+
+def main() -> int:
+    ps: list[Particle] = []
+    for i in range(10):
+        ps.append(Particle(i * 1.0, 2.0))
+    step(ps, 0.5)
+    step(ps, 0.5)
+    ps[0].v = -1.0
+    step(ps, 2.0)
+    t: float = total(ps)
+    print(t)
+    print(len(ps))
+    return 0
+"""
+
+    def converter(self, enabled: bool = True) -> MGenPythonToCConverter:
+        """Converter with soa_lists set."""
+        preferences = CPreferences()
+        preferences.set("soa_lists", enabled)
+        return MGenPythonToCConverter(preferences)
+
+    def test_lists_become_field_arrays(self):
+        """Test the SoA struct, field loops over its arrays and bounds-checked accessors only where unproven."""
+        c_code = self.converter().convert_code(self.CODE)
+
+        assert "typedef struct Particle_soa {\n    double* x;\n    double* v;\n    int* hits;" in c_code
+        assert "void step(Particle_soa ps, double dt)" in c_code
+        assert "ps.x[loop_idx_" in c_code and "+= (ps.v[loop_idx_" in c_code
+        # range(len(ps)) proves ps[i] in bounds; ps[0] needs the check
+        assert "s += (ps.x[i] + ps.hits[i]);" in c_code
+        assert "(*Particle_soa_v_at(&ps, 0)) = (-1.0);" in c_code
+        assert "Particle_soa_push(&ps, Particle_new((i * 1.0), 2.0));" in c_code
+        assert "Particle_soa_drop(&ps);" in c_code
+
+    def test_escaping_elements_keep_structs(self):
+        """Test a class whose elements are used as values, or whose lists escape, is left alone."""
+        code = """
+class Point:
+    def __init__(self, x: int) -> None:
+        self.x: int = x
+
+
+class Cell:
+    def __init__(self, v: int) -> None:
+        self.v: int = v
+
+
+def first(ps: list[Point]) -> Point:
+    return ps[0]
+
+
+def cells() -> list[Cell]:
+    cs: list[Cell] = []
+    cs.append(Cell(1))
+    return cs
+"""
+        from mgen.backends.converter_utils import struct_of_arrays_classes
+
+        assert struct_of_arrays_classes(ast.parse(code)) == {}
+        assert struct_of_arrays_classes(ast.parse(self.CODE)) == {
+            "Particle": {"x": "float", "v": "float", "hits": "int"}
+        }
+        assert "Particle_soa" not in self.converter(enabled=False).convert_code(self.CODE)
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_soa_program_computes_python_result(self, tmp_path):
+        """Test the generated program prints what Python prints."""
+        source = tmp_path / "soa.c"
+        source.write_text(self.converter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "soa")], capture_output=True, text=True)
+
+        assert result.stdout.split() == ["105.000000", "10"]
+
+
+class TestCheckedIntArithmetic:
+    """Test int_overflow="check" reports OverflowError where int arithmetic may overflow."""
+
+    CODE = """
+def triangle(n: int) -> int:
+    total: int = 0
+    for i in range(1000):
+        total += i * 2 + 1
+    return total
+
+
+def grow(x: int, rounds: int) -> int:
+    for r in range(rounds):
+        x = x * 3
+    return x
+
+
+def main() -> int:
+    print(triangle(1000))
+    print(grow(7, 10))
+    print(grow(7, 30))
+    return 0
+"""
+
+    def converter(self, mode: str = "check") -> MGenPythonToCConverter:
+        """Converter with int_overflow set."""
+        preferences = CPreferences()
+        preferences.set("int_overflow", mode)
+        return MGenPythonToCConverter(preferences)
+
+    def test_only_unproven_arithmetic_is_checked(self):
+        """Test range-bounded operands stay plain C while accumulators and unbounded values are checked."""
+        c_code = self.converter().convert_code(self.CODE)
+
+        assert '#include "mgen_checked_int.h"' in c_code
+        assert "total = mgen_int_add(total, ((i * 2) + 1));" in c_code
+        assert "x = mgen_int_mul(x, 3);" in c_code
+
+    def test_wrap_keeps_c_arithmetic(self):
+        """Test the default emits plain C operators."""
+        c_code = self.converter("wrap").convert_code(self.CODE)
+
+        assert "mgen_int_" not in c_code
+        assert "total += ((i * 2) + 1);" in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_overflow_stops_the_program(self, tmp_path):
+        """Test in-range results match Python and the first overflow exits like an uncaught OverflowError."""
+        source = tmp_path / "checked.c"
+        source.write_text(self.converter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "checked")], capture_output=True, text=True)
+
+        assert result.returncode == 1
+        assert result.stdout.split() == ["1000000", "413343"]
+        assert "OverflowError: 903981141 * 3 = 2711943423" in result.stderr
+
+
+class TestMemoizedPureFunctions:
+    """Test memoize_pure caches pure recursive functions in per-thread memo tables."""
+
+    CODE = """
+from functools import cache, lru_cache
+
+
+def fibonacci(n: int) -> int:
+    if n <= 1:
+        return n
+    return fibonacci(n - 1) + fibonacci(n - 2)
+
+
+@cache
+def paths(r: int, c: int) -> int:
+    if r == 0 or c == 0:
+        return 1
+    return paths(r - 1, c) + paths(r, c - 1)
+
+
+@lru_cache(maxsize=0)
+def slow(n: int) -> int:
+    if n <= 1:
+        return n
+    return slow(n - 1) + slow(n - 2)
+
+
+def main() -> int:
+    print(fibonacci(30))
+    print(paths(16, 16))
+    print(slow(20))
+    return 0
+"""
+
+    def converter(self, enabled: bool = True) -> MGenPythonToCConverter:
+        """Converter with memoize_pure set."""
+        preferences = CPreferences()
+        preferences.set("memoize_pure", enabled)
+        return MGenPythonToCConverter(preferences)
+
+    def test_recursive_calls_go_through_the_table(self):
+        """Test the wrapper looks up its table before calling the original body."""
+        c_code = self.converter().convert_code(self.CODE)
+
+        assert "static MGEN_THREAD_LOCAL fibonacci_memo_entry fibonacci_memo[MGEN_MEMO_SLOTS];" in c_code
+        assert "static int fibonacci_compute(int n) {" in c_code
+        assert "return (fibonacci((n - 1)) + fibonacci((n - 2)));" in c_code
+        assert "mgen_memo_entry->used && mgen_memo_entry->keys[0] == r && mgen_memo_entry->keys[1] == c)" in c_code
+        assert "slow_memo" not in c_code
+        assert c_code.count("#define MGEN_MEMO_SLOTS") == 1
+
+    def test_cache_decorator_forces_memoization(self):
+        """Test @cache is honoured without the preference and other functions are left alone."""
+        c_code = self.converter(enabled=False).convert_code(self.CODE)
+
+        assert "static int paths_compute(int r, int c) {" in c_code
+        assert "fibonacci_memo" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_memoized_program_computes_python_result(self, tmp_path):
+        """Test the generated program prints what Python prints."""
+        source = tmp_path / "memo.c"
+        source.write_text(self.converter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "memo")], capture_output=True, text=True)
+
+        assert result.stdout.split() == ["832040", "601080390", "6765"]
+
+
+class TestInstrumentedBuild:
+    """Test instrument probes every function and loop and reports them at exit."""
+
+    CODE = """
+def fib(n: int) -> int:
+    if n <= 1:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+
+def work(n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        if i == 5:
+            return total
+        total += i
+    return total
+
+
+def main() -> int:
+    print(fib(15))
+    print(work(3))
+    print(work(10))
+    return 0
+"""
+
+    def converter(self, enabled: bool = True) -> MGenPythonToCConverter:
+        """Converter with instrument set."""
+        preferences = CPreferences()
+        preferences.set("instrument", enabled)
+        return MGenPythonToCConverter(preferences)
+
+    def test_functions_and_loops_get_probes(self):
+        """Test each function opens a probe and each loop's probe closes after the loop."""
+        c_code = self.converter().convert_code(self.CODE)
+
+        assert '#include "mgen_instrument.h"' in c_code
+        assert "#define MGEN_INSTRUMENT_MAX_SITES 4" in c_code
+        assert 'MGEN_PROBE(mgen_probe_0, 0, "fib", "function", 2);' in c_code
+        assert 'MGEN_PROBE(mgen_probe_2, 2, "work", "loop", 10);' in c_code
+        assert "    }\n    MGEN_PROBE_CLOSE(mgen_probe_2);" in c_code
+
+    def test_preference_off_emits_no_probes(self):
+        """Test the default build carries no instrumentation."""
+        c_code = self.converter(enabled=False).convert_code(self.CODE)
+
+        assert "MGEN_PROBE" not in c_code
+        assert "mgen_instrument.h" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_instrumented_program_reports_at_exit(self, tmp_path):
+        """Test the program still prints what Python prints and reports each site on stderr."""
+        source = tmp_path / "probed.c"
+        source.write_text(self.converter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path))
+        result = subprocess.run([str(tmp_path / "probed")], capture_output=True, text=True)
+
+        assert result.stdout.split() == ["610", "3", "10"]
+        report = [line.split() for line in result.stderr.splitlines()]
+        assert report[0][:4] == ["function", "kind", "line", "calls"]
+        assert ["fib", "function", "2", "1973"] in [row[:4] for row in report]
+        assert ["work", "loop", "10", "2"] in [row[:4] for row in report]
+
+
+class TestSourceMapping:
+    """Test source_file makes #line directives attribute the generated C to the Python lines."""
+
+    CODE = """
+def square_sum(n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        total += i * i
+    return total
+
+
+def main() -> int:
+    print(square_sum(10))
+    return 0
+"""
+
+    def test_functions_and_statements_carry_their_python_line(self):
+        """Test each def and statement is preceded by #line, and module code after a function is reset."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE, "/src/mapped.py")
+        lines = c_code.splitlines()
+
+        assert lines[lines.index("int square_sum(int n) {") - 1] == '#line 2 "/src/mapped.py"'
+        assert '    #line 4 "/src/mapped.py"\n    for (int i = 0; i < n; i += 1) {' in c_code
+        assert '        #line 5 "/src/mapped.py"\n        total += (i * i);' in c_code
+        # A reset names the generated file and its own successor line
+        reset = next(i for i, line in enumerate(lines) if line.startswith('#line') and "mapped.c" in line)
+        assert lines[reset - 1] == "}"
+        assert lines[reset] == f'#line {reset + 2} "mapped.c"'
+
+    def test_no_source_file_emits_no_directives(self):
+        """Test the default conversion is unmapped."""
+        assert "#line" not in MGenPythonToCConverter().convert_code(self.CODE)
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_debug_build_points_dwarf_at_python_file(self, tmp_path):
+        """Test a -g build runs unchanged and its line table names the Python file."""
+        source = tmp_path / "mapped.c"
+        source.write_text(MGenPythonToCConverter().convert_code(self.CODE, str(tmp_path / "mapped.py")))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path), debug=True)
+        result = subprocess.run([str(tmp_path / "mapped")], capture_output=True, text=True)
+
+        assert result.stdout.split() == ["285"]
+        assert b"mapped.py" in (tmp_path / "mapped").read_bytes()
+
+
+def import_extension(path: Path, name: str):
+    """Import the extension module built at path."""
+    import importlib.util
+
+    spec = importlib.util.spec_from_file_location(name, path)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+
+class TestExtensionModule:
+    """Test the extension target mode exports the functions as a CPython module."""
+
+    CODE = """
+def dot(xs: list[float], ys: list[float]) -> float:
+    total: float = 0.0
+    for i in range(len(xs)):
+        total += xs[i] * ys[i]
+    return total
+
+
+def scale(xs: list[int], k: int) -> list[int]:
+    out: list[int] = []
+    for x in xs:
+        out.append(x * k)
+    return out
+
+
+def grow(xs: list[int]) -> int:
+    xs.append(1)
+    return len(xs)
+
+
+def main() -> int:
+    return 0
+"""
+
+    def converter(self) -> MGenPythonToCConverter:
+        """Converter in extension mode."""
+        preferences = CPreferences()
+        preferences.set("target_mode", "extension")
+        return MGenPythonToCConverter(preferences)
+
+    def test_borrowed_lists_are_lent_as_vec_views(self):
+        """Test a wrapper views the argument's buffer as the vec and the mutating function stays unexported."""
+        c_code = self.converter().convert_code(self.CODE)
+
+        assert c_code.startswith("#define PY_SSIZE_T_CLEAN\n#include <Python.h>\n")
+        assert "if (mgen_pyext_double_array(args[0], &mgen_arg_xs) < 0) {" in c_code
+        assert "vec_double mgen_vec_xs = {.data = (double*)mgen_arg_xs.data" in c_code
+        assert "// Not exported: grow (modifies or keeps a list parameter" in c_code
+        assert '{"dot", (PyCFunction)(void (*)(void))mgen_py_dot, METH_FASTCALL' in c_code
+        assert '"main"' not in c_code
+
+    def test_executable_mode_has_no_wrappers(self):
+        """Test the default target mode emits no Python API."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "Python.h" not in c_code
+        assert "mgen_py_" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_module_takes_buffers_and_sequences(self, tmp_path):
+        """Test the built module computes on array buffers, strided views and lists, and checks its arguments."""
+        from array import array
+
+        from mgen.backends.python_extension import extension_filename
+
+        source = tmp_path / "ckernels.c"
+        source.write_text(self.converter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path), target_mode="extension")
+        module = import_extension(tmp_path / extension_filename("ckernels"), "ckernels")
+
+        assert module.dot(array("d", [1.0, 2.0, 3.0]), [4.0, 5.0, 6.0]) == 32.0
+        assert module.scale(array("i", [1, 2, 3]), 2) == [2, 4, 6]
+        assert module.scale(memoryview(array("i", range(6)))[::2], 10) == [0, 20, 40]
+        assert module.scale((7,), 3) == [21]
+        assert module.dot.__doc__ == "dot(xs: list[float], ys: list[float]) -> float"
+        assert not hasattr(module, "grow")
+        with pytest.raises(TypeError):
+            module.dot([1.0])
+        with pytest.raises(OverflowError):
+            module.scale([1], 2**40)
+
+
+class TestAlignedVectors:
+    """Test aligned_vectors allocates numeric vectors aligned and hoists aligned restrict pointers for loops."""
+
+    CODE = """
+def shift(xs: list[float], k: float) -> float:
+    total: float = 0.0
+    for i in range(len(xs)):
+        total = total + xs[i] * k
+    return total
+
+
+def main() -> int:
+    xs: list[float] = []
+    ys: list[float] = []
+    for i in range(1000):
+        xs.append(i * 0.5)
+        ys.append(0.0)
+    n: int = len(xs)
+    for i in range(n):
+        ys[i] = xs[i] * 2.0 + 1.0
+    print(ys[999])
+    print(shift(ys, 0.5))
+    return 0
+"""
+
+    def converter(self) -> MGenPythonToCConverter:
+        """A converter with aligned_vectors on."""
+        preferences = CPreferences()
+        preferences.set("aligned_vectors", True)
+        return MGenPythonToCConverter(preferences)
+
+    def test_numeric_vectors_use_aligned_allocator(self):
+        """Test vec_double is instantiated with the mgen_aligned STC allocator."""
+        c_code = self.converter().convert_code(self.CODE)
+
+        assert '#include "mgen_aligned_alloc.h"\n#define i_allocator mgen_aligned\n#define i_type vec_double' in c_code
+
+    def test_independent_loop_over_local_vectors_gets_aligned_pointers(self):
+        """Test the in-bounds version of the loop reads and writes through hoisted restrict pointers."""
+        c_code = self.converter().convert_code(self.CODE)
+
+        assert "double* MGEN_RESTRICT xs_aligned = MGEN_ASSUME_ALIGNED(xs.data);" in c_code
+        assert "ys_aligned[i] = ((xs_aligned[i] * 2.0) + 1.0);" in c_code
+
+    def test_parameters_are_not_assumed_aligned(self):
+        """Test a parameter, which may be a slice view or a caller's buffer, keeps its own pointer."""
+        c_code = self.converter().convert_code(self.CODE)
+        shift = c_code[c_code.index("double shift(") : c_code.index("int main(")]
+
+        assert "MGEN_ASSUME_ALIGNED" not in shift
+
+    def test_default_preferences_keep_plain_allocation(self):
+        """Test the preference is off by default."""
+        c_code = MGenPythonToCConverter().convert_code(self.CODE)
+
+        assert "i_allocator" not in c_code
+        assert "MGEN_ASSUME_ALIGNED" not in c_code
+
+    @pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+    def test_aligned_program_computes_python_result(self, tmp_path):
+        """Test the aligned program prints what Python does."""
+        source = tmp_path / "aligned.c"
+        source.write_text(self.converter().convert_code(self.CODE))
+
+        assert CBuilder().compile_direct(str(source), str(tmp_path), opt_level=3)
+        result = subprocess.run([str(tmp_path / "aligned")], capture_output=True, text=True)
+
+        assert [float(value) for value in result.stdout.split()] == [1000.0, 250250.0]
@@ -4,6 +4,7 @@ import pytest
 
 from mgen.backends.c.converter import MGenPythonToCConverter
 from mgen.backends.errors import UnsupportedFeatureError
+from mgen.backends.preferences import CPreferences
 
 
 class TestStringMethodsBasics:
@@ -76,6 +77,18 @@ def test_find() -> int:
         assert 'char* text = "hello world";' in c_code
         assert 'mgen_str_find(text, "world")' in c_code
 
+    def test_string_count_method(self):
+        """Test str.count() method."""
+        python_code = """
+def test_count() -> int:
+    text: str = "banana"
+    return text.count("an")
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert 'char* text = "banana";' in c_code
+        assert 'mgen_str_count(text, "an")' in c_code
+
     def test_string_replace_method(self):
         """Test str.replace() method."""
         python_code = """
@@ -291,6 +304,155 @@ def test_unsupported() -> str:
             self.converter.convert_code(python_code)
 
 
+class TestScopedStringTemporaries:
+    """Test the scope_temporaries preference for function-local strings."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        preferences = CPreferences()
+        preferences.set("scope_temporaries", True)
+        self.converter = MGenPythonToCConverter(preferences)
+
+    def test_loop_concatenation_uses_scope(self):
+        """Test temporaries go to the scope and the result is copied out on return."""
+        python_code = """
+def label(n: int) -> str:
+    out: str = ""
+    for i in range(n):
+        out = str(i) + out
+    return out
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "mgen_scope_allocator_t* mgen_scope = mgen_scope_new();" in c_code
+        assert "mgen_scope_str_concat(mgen_scope, mgen_scope_int_to_string(mgen_scope, i), out)" in c_code
+        assert "= mgen_strdup(out);" in c_code
+        assert "mgen_scope_free(mgen_scope);" in c_code
+
+    def test_fstring_and_void_function(self):
+        """Test f-strings are scoped and void functions free the scope at the end."""
+        python_code = """
+def greet(name: str, count: int) -> None:
+    print(f"Hello {name}: {count}")
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert 'mgen_scope_sprintf_string(mgen_scope, "Hello %s: %s", name, mgen_scope_int_to_string(mgen_scope, count))' in c_code
+        assert "count)));\n    mgen_scope_free(mgen_scope);\n}" in c_code
+
+    def test_escaping_and_string_free_functions_are_not_scoped(self):
+        """Test functions that may keep a temporary, or build none, stay heap-allocated."""
+        python_code = """
+def collect(items: list, n: int) -> None:
+    items.append(str(n))
+
+def add(a: int, b: int) -> int:
+    return a + b
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "mgen_scope" not in c_code
+        assert "mgen_int_to_string(n)" in c_code
+
+    def test_default_preferences_do_not_scope(self):
+        """Test the preference is off by default."""
+        python_code = """
+def label(n: int) -> str:
+    return "n=" + str(n)
+"""
+        c_code = MGenPythonToCConverter().convert_code(python_code)
+
+        assert "mgen_scope" not in c_code
+        assert 'return mgen_str_concat("n=", mgen_int_to_string(n));' in c_code
+
+
+class TestStringBuilderLoops:
+    """Test loops that extend a string are built in one mgen_buffer_t."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCConverter()
+
+    def test_range_loop_appends_pieces_with_hint(self):
+        """Test appends are split into typed pieces and the buffer is sized from range()."""
+        python_code = """
+def build(n: int) -> str:
+    out: str = ""
+    for i in range(n):
+        out = out + str(i) + ","
+        out += f"[{i}]"
+    return out
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "mgen_str_concat" not in c_code
+        assert "mgen_buffer_capacity_hint(n, 25));" in c_code
+        assert "mgen_buffer_append_int(&out_buf_" in c_code
+        assert 'sizeof(",") - 1);' in c_code
+        assert "out = mgen_buffer_detach(&out_buf_" in c_code
+        assert c_code.index("mgen_buffer_detach") > c_code.index("for (int i = 0;")
+
+    def test_while_loop_appends_strings(self):
+        """Test while loops use the buffer without a capacity hint."""
+        python_code = """
+def repeat(text: str, times: int) -> str:
+    acc: str = ""
+    k: int = 0
+    while k < times:
+        acc += text
+        k += 1
+    return acc
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "mgen_buffer_init(&acc_buf_" in c_code
+        assert ", 0);" in c_code
+        assert "mgen_buffer_append_str(&acc_buf_" in c_code and ", text);" in c_code
+
+    def test_loop_reading_accumulator_keeps_concat(self):
+        """Test the string stays a plain concatenation when the loop also reads it."""
+        python_code = """
+def progress(n: int) -> str:
+    s: str = ""
+    for i in range(n):
+        s = s + "#"
+        print(s)
+    return s
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "mgen_buffer" not in c_code
+        assert 's = mgen_str_concat(s, "#");' in c_code
+
+    def test_augmented_string_concat_outside_loop(self):
+        """Test += on a string concatenates instead of doing pointer arithmetic."""
+        python_code = """
+def wrap(text: str) -> str:
+    out: str = "<"
+    out += text
+    return out
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "out = mgen_str_concat(out, text);" in c_code
+
+    def test_preference_disables_builder(self):
+        """Test string_builder_loops can be switched off."""
+        preferences = CPreferences()
+        preferences.set("string_builder_loops", False)
+        python_code = """
+def build(n: int) -> str:
+    out: str = ""
+    for i in range(n):
+        out += "x"
+    return out
+"""
+        c_code = MGenPythonToCConverter(preferences).convert_code(python_code)
+
+        assert "mgen_buffer" not in c_code
+        assert 'out = mgen_str_concat(out, "x");' in c_code
+
+
 class TestStringMethodsIntegration:
     """Test string methods integration with other features."""
 
@@ -327,6 +489,38 @@ def test_loop() -> str:
         assert "for (int i = 0; i < 3; i += 1)" in c_code
         assert "result = mgen_str_upper(result);" in c_code
 
+    def test_split_loop_borrows_tokens(self):
+        """Test for-loop over str.split() scans tokens in place."""
+        python_code = """
+def count_words(text: str) -> int:
+    n: int = 0
+    for w in text.split(","):
+        if w == "the":
+            n += 1
+    return n
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert 'mgen_str_splitter_init(text, ",")' in c_code
+        assert "(w = mgen_str_splitter_next(&" in c_code
+        assert "mgen_str_splitter_free(&" in c_code
+        assert "mgen_str_split(" not in c_code
+
+    def test_split_loop_materializes_escaping_tokens(self):
+        """Test tokens bound to another variable fall back to owned strings."""
+        python_code = """
+def last_word(text: str) -> str:
+    last: str = ""
+    for w in text.split():
+        last = w
+    return last
+"""
+        c_code = self.converter.convert_code(python_code)
+
+        assert "mgen_str_split(text, NULL)" in c_code
+        assert "const char* w = mgen_string_array_get(" in c_code
+        assert "mgen_str_splitter" not in c_code
+
     def test_string_methods_with_oop(self):
         """Test string methods used with object-oriented features."""
         python_code = """
@@ -330,4 +330,42 @@ def test_string_concat(base: str, suffix: str) -> str:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "base += suffix;" in cpp_code
\ No newline at end of file
+        assert "base += suffix;" in cpp_code
+
+
+class TestDictUpdateAssignment:
+    """Test counting updates become a single map access."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_membership_counting_uses_subscript(self):
+        """Test `if k in d: d[k] = d[k] + 1 else: d[k] = 1` becomes one operator[]."""
+        python_code = """
+def count(words: list[str]) -> dict[str, int]:
+    counts: dict[str, int] = {}
+    for word in words:
+        if word in counts:
+            counts[word] = counts[word] + 1
+        else:
+            counts[word] = 1
+    return counts
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "counts[word] += 1;" in cpp_code
+        assert "counts.count(word)" not in cpp_code
+
+    def test_get_with_default_uses_try_emplace(self):
+        """Test `d[k] = d.get(k, 5) + n` keeps a non-zero default."""
+        python_code = """
+def tally(keys: list[int], n: int) -> dict[int, int]:
+    c: dict[int, int] = {}
+    for k in keys:
+        c[k] = c.get(k, 5) + n
+    return c
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "c.try_emplace(k, 5).first->second += n;" in cpp_code
@@ -4,6 +4,7 @@ import pytest
 
 from mgen.backends.cpp.converter import MGenPythonToCppConverter
 from mgen.backends.errors import UnsupportedFeatureError
+from mgen.backends.preferences import CppPreferences
 
 class TestCppBasicsConversion:
     """Test basic conversion functionality."""
@@ -33,7 +34,7 @@ def greet(name: str) -> str:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "std::string greet(std::string name)" in cpp_code
+        assert "std::string greet(const std::string& name)" in cpp_code
         assert 'return ("Hello " + name);' in cpp_code
 
     def test_function_with_multiple_types(self):
@@ -55,8 +56,8 @@ def print_message(msg: str) -> None:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "void print_message(std::string msg)" in cpp_code
-        assert "cout << msg << endl;" in cpp_code
+        assert "void print_message(const std::string& msg)" in cpp_code
+        assert "mgen::print(msg);" in cpp_code
 
     def test_auto_type_inference(self):
         """Test automatic type inference when annotations are missing."""
@@ -164,6 +165,32 @@ def test_for_range(start: int, stop: int) -> int:
 
         assert "for (int i = start; i < stop; i++)" in cpp_code
 
+    def test_for_range_with_negative_step(self):
+        """Test a negative literal step counts down with a > condition."""
+        python_code = """
+def test_for_down(n: int) -> int:
+    total = 0
+    for i in range(n, 0, -2):
+        total = total + i
+    return total
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "for (int i = n; i > 0; i += (-2))" in cpp_code
+
+    def test_for_range_with_variable_step(self):
+        """Test a step of unknown sign iterates a Range, which handles either direction."""
+        python_code = """
+def test_for_step(start: int, stop: int, step: int) -> int:
+    total = 0
+    for i in range(start, stop, step):
+        total = total + i
+    return total
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "for (int i : Range(start, stop, step))" in cpp_code
+
 
 class TestCppExpressions:
     """Test expression conversion."""
@@ -243,6 +270,20 @@ def test_print(msg: str) -> None:
 """
         cpp_code = self.converter.convert_code(python_code)
 
+        assert "mgen::print(msg);" in cpp_code
+        assert 'mgen::print("Hello", "World");' in cpp_code
+
+    def test_print_without_buffered_stdout(self):
+        """Test print() stays a cout insertion when buffered_stdout is off."""
+        python_code = """
+def test_print(msg: str) -> None:
+    print(msg)
+    print("Hello", "World")
+"""
+        preferences = CppPreferences()
+        preferences.set("buffered_stdout", False)
+        cpp_code = MGenPythonToCppConverter(preferences).convert_code(python_code)
+
         assert "cout << msg << endl;" in cpp_code
         assert 'cout << "Hello" << " " << "World" << endl;' in cpp_code
 
@@ -274,4 +315,62 @@ def test_range() -> None:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "Range(10)" in cpp_code
\ No newline at end of file
+        assert "Range(10)" in cpp_code
+
+
+class TestCppTuples:
+    """Test fixed-arity tuples lowered to std::tuple values."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_tuple_return_type(self):
+        """Test a tuple return type becomes std::tuple built with make_tuple."""
+        python_code = """
+def pair(a: int, b: float) -> tuple[int, float]:
+    return a, b
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "#include <tuple>" in cpp_code
+        assert "std::tuple<int, double> pair(int a, double b)" in cpp_code
+        assert "return std::make_tuple(a, b);" in cpp_code
+
+    def test_unpacking_new_names_uses_structured_binding(self):
+        """Test unpacking into new names declares a structured binding."""
+        python_code = """
+def label(n: int) -> tuple[str, int]:
+    return ("n", n)
+
+def main() -> int:
+    name, count = label(5)
+    return count
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "auto [name, count] = label(5);" in cpp_code
+
+    def test_unpacking_declared_names_uses_tie(self):
+        """Test a swap of declared names assigns through std::tie."""
+        python_code = """
+def fib(n: int) -> int:
+    a: int = 0
+    b: int = 1
+    for i in range(n):
+        a, b = b, a + b
+    return a
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "std::tie(a, b) = std::make_tuple(b, (a + b));" in cpp_code
+
+    def test_tuple_subscript_uses_get(self):
+        """Test constant indices, including negative ones, become std::get."""
+        python_code = """
+def first_last(p: tuple[int, float]) -> float:
+    return p[0] + p[-1]
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "(std::get<0>(p) + std::get<1>(p))" in cpp_code
@@ -1,9 +1,17 @@
 """Tests for Python comprehensions support in C++ backend."""
 
+import shutil
+import subprocess
+import tempfile
+from pathlib import Path
+
 import pytest
 
 from mgen.backends.cpp.converter import MGenPythonToCppConverter
 from mgen.backends.errors import UnsupportedFeatureError
+from mgen.backends.preferences import CppPreferences
+
+CPP_RUNTIME_HEADER = Path(__file__).parent.parent / "src" / "mgen" / "backends" / "cpp" / "runtime" / "mgen_cpp_runtime.hpp"
 
 class TestListComprehensions:
     """Test list comprehension conversion functionality."""
@@ -271,4 +279,210 @@ def test_types() -> None:
 
         assert "list_comprehension" in cpp_code
         assert "dict_comprehension" in cpp_code
-        assert "set_comprehension" in cpp_code
\ No newline at end of file
+        assert "set_comprehension" in cpp_code
+
+
+class TestFusedComprehensionPipelines:
+    """Test that intermediate comprehensions consumed once become lazy views."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_nested_comprehension_is_fused(self):
+        """Test an inner comprehension becomes a view instead of a vector."""
+        python_code = """
+def fused(n: int) -> list:
+    return [y + 1 for y in [x * 2 for x in range(n)] if y > 2]
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert cpp_code.count("list_comprehension") == 1
+        assert "list_comprehension(map_view(Range(n), [&](auto x) { return (x * 2); })" in cpp_code
+
+    def test_filtered_inner_comprehension_uses_filter_view(self):
+        """Test a filtered inner comprehension becomes filter_view then map_view."""
+        python_code = """
+def fused(n: int) -> int:
+    return sum([x * x for x in range(n) if x % 2 == 0])
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "mgen::sum(map_view(filter_view(Range(n)" in cpp_code
+        assert "list_comprehension" not in cpp_code
+
+    def test_single_use_local_is_bound_as_view(self):
+        """Test a local consumed only by the next statement is bound with auto."""
+        python_code = """
+def fused(n: int) -> int:
+    squares: list[int] = [x * x for x in range(n)]
+    total: int = sum(squares)
+    return total
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "auto squares = map_view(Range(n)" in cpp_code
+        assert "mgen::sum(squares)" in cpp_code
+
+    def test_reused_local_stays_materialized(self):
+        """Test a comprehension local used twice is still a vector."""
+        python_code = """
+def reused(n: int) -> int:
+    squares: list[int] = [x * x for x in range(n)]
+    total: int = sum(squares)
+    return total + len(squares)
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "auto squares" not in cpp_code
+        assert "list_comprehension(Range(n)" in cpp_code
+
+    def test_local_whose_source_is_mutated_stays_materialized(self):
+        """Test no view is bound when the consumer mutates the comprehension's source."""
+        python_code = """
+def mutated(items: list[int]) -> int:
+    doubled: list[int] = [x * 2 for x in items]
+    for d in doubled:
+        items.append(d)
+    return len(items)
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "auto doubled" not in cpp_code
+        assert "list_comprehension(items" in cpp_code
+
+    def test_zip_source_binds_tuple_target(self):
+        """Test a zip iterable binds both tuple target names."""
+        python_code = """
+def pairs(a: list[int], b: list[int]) -> list:
+    return [x - y for x, y in zip(a, b)]
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "list_comprehension(zip(a, b), [&](const auto& __pair)" in cpp_code
+        assert "const auto& x = __pair.first; const auto& y = __pair.second;" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_fused_pipeline_compiles_and_runs(self):
+        """Test fused views, zip and enumerate compile and match Python's result."""
+        python_code = """
+def pipeline(n: int, k: int) -> int:
+    squares: list[int] = [x * x for x in range(n)]
+    total: int = sum(squares)
+    evens: list[int] = [s + k for s in [x * 3 for x in range(n)] if s % 2 == 0]
+    weighted: list[int] = [i * v for i, v in enumerate(evens)]
+    for p in [a - b for a, b in zip(weighted, evens) if a > b]:
+        total = total + p
+    for i, v in enumerate(evens):
+        total = total + i * v
+    return total + len(weighted)
+
+def main() -> int:
+    print(pipeline(10, 1))
+    return 0
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "pipeline.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "pipeline"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        assert result.stdout.strip() == "606"
+
+
+class TestParallelPreference:
+    """Test the opt-in parallel preference for reductions and comprehensions."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        preferences = CppPreferences()
+        preferences.set("parallel", True)
+        preferences.set("parallel_threshold", 5000)
+        self.converter = MGenPythonToCppConverter(preferences)
+
+    def test_parallel_defines_precede_runtime(self):
+        """Test the thread pool is switched on before the runtime header is included."""
+        python_code = """
+def total(n: int) -> int:
+    return sum([x % 7 for x in range(n)])
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        define = cpp_code.index("#define MGEN_PARALLEL\n")
+        assert "#define MGEN_PARALLEL_THRESHOLD 5000" in cpp_code
+        assert define < cpp_code.index('#include "runtime/mgen_cpp_runtime.hpp"')
+
+    def test_default_preferences_stay_serial(self):
+        """Test parallel helpers are not emitted unless requested."""
+        python_code = """
+def squares(n: int) -> list:
+    return [x * x for x in range(n)]
+"""
+        cpp_code = MGenPythonToCppConverter().convert_code(python_code)
+
+        assert "MGEN_PARALLEL" not in cpp_code
+        assert "parallel_list_comprehension" not in cpp_code
+
+    def test_pure_comprehension_is_parallel(self):
+        """Test a comprehension without side effects uses the parallel helper."""
+        python_code = """
+def lengths(words: list[str]) -> list:
+    return [len(w.strip()) for w in words if w != ""]
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "parallel_list_comprehension(words" in cpp_code
+
+    def test_comprehension_calling_user_function_stays_serial(self):
+        """Test a comprehension that calls a user function keeps the serial helper."""
+        python_code = """
+def squares(n: int) -> list:
+    return [record(x) for x in range(n)]
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "parallel_list_comprehension" not in cpp_code
+        assert "list_comprehension(Range(n)" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_parallel_program_matches_serial_result(self):
+        """Test parallel reductions and comprehensions compute the serial results."""
+        python_code = """
+def crunch(n: int) -> int:
+    values: list[int] = [x * 7 % 1000 for x in range(n)]
+    evens: list[int] = [v // 2 for v in values if v % 2 == 0]
+    return sum(values) + min(values) + max(values) + sum(evens) + len(evens)
+
+def main() -> int:
+    print(crunch(60000))
+    return 0
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "crunch.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "crunch"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-pthread", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        values = [x * 7 % 1000 for x in range(60000)]
+        evens = [v // 2 for v in values if v % 2 == 0]
+        assert result.stdout.strip() == str(sum(values) + min(values) + max(values) + sum(evens) + len(evens))
@@ -1,9 +1,16 @@
 """Tests for C++ backend f-string support."""
 
+import shutil
+import subprocess
+import tempfile
+from pathlib import Path
+
 import pytest
 
 from mgen.backends.cpp.converter import MGenPythonToCppConverter
 
+CPP_RUNTIME_HEADER = Path(__file__).parent.parent / "src" / "mgen" / "backends" / "cpp" / "runtime" / "mgen_cpp_runtime.hpp"
+
 
 class TestCppFStringConversion:
     """Test f-string conversion functionality."""
@@ -20,9 +27,9 @@ def greet(name: str) -> str:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "std::string greet(std::string name)" in cpp_code
-        # F-string should be converted to string concatenation
-        assert '("Hello " + name)' in cpp_code or '"Hello " + name' in cpp_code
+        assert "std::string greet(const std::string& name)" in cpp_code
+        # F-string should be converted to a single format call
+        assert 'mgen::format("Hello ", name)' in cpp_code
 
     def test_f_string_with_int(self):
         """Test f-string with integer variable."""
@@ -33,9 +40,9 @@ def format_number(x: int) -> str:
         cpp_code = self.converter.convert_code(python_code)
 
         assert "std::string format_number(int x)" in cpp_code
-        # Should use std::to_string for int
-        assert "std::to_string(x)" in cpp_code
-        assert '"Result: "' in cpp_code
+        # Numbers are passed to mgen::format as-is
+        assert 'mgen::format("Result: ", x)' in cpp_code
+        assert "std::to_string" not in cpp_code
 
     def test_f_string_with_multiple_parts(self):
         """Test f-string with multiple expressions."""
@@ -45,10 +52,8 @@ def format_info(count: int, name: str) -> str:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "std::string format_info(int count, std::string name)" in cpp_code
-        assert "std::to_string(count)" in cpp_code
-        assert '"Count: "' in cpp_code
-        assert '" items for "' in cpp_code
+        assert "std::string format_info(int count, const std::string& name)" in cpp_code
+        assert 'mgen::format("Count: ", count, " items for ", name)' in cpp_code
 
     def test_f_string_with_expression(self):
         """Test f-string with an expression."""
@@ -59,9 +64,8 @@ def calculate_message(x: int, y: int) -> str:
         cpp_code = self.converter.convert_code(python_code)
 
         assert "std::string calculate_message(int x, int y)" in cpp_code
-        # Expression should be wrapped in std::to_string
-        assert "std::to_string((x + y))" in cpp_code
-        assert '"Sum: "' in cpp_code
+        # Expression should be passed as one format argument
+        assert 'mgen::format("Sum: ", (x + y))' in cpp_code
 
     def test_f_string_with_bool(self):
         """Test f-string with boolean variable."""
@@ -72,9 +76,8 @@ def format_bool(flag: bool) -> str:
         cpp_code = self.converter.convert_code(python_code)
 
         assert "std::string format_bool(bool flag)" in cpp_code
-        # Boolean should be converted to "true" or "false"
-        assert '(flag ? "true" : "false")' in cpp_code
-        assert '"Status: "' in cpp_code
+        # mgen::format prints booleans as Python does ("True" / "False")
+        assert 'mgen::format("Status: ", flag)' in cpp_code
 
     def test_f_string_with_float(self):
         """Test f-string with float variable."""
@@ -85,8 +88,7 @@ def format_float(value: float) -> str:
         cpp_code = self.converter.convert_code(python_code)
 
         assert "std::string format_float(double value)" in cpp_code
-        assert "std::to_string(value)" in cpp_code
-        assert '"Value: "' in cpp_code
+        assert 'mgen::format("Value: ", value)' in cpp_code
 
     def test_f_string_only_literal(self):
         """Test f-string with only literal parts (no expressions)."""
@@ -108,9 +110,8 @@ def format_length(items: list[int]) -> str:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "std::string format_length(std::vector<int> items)" in cpp_code
-        assert "std::to_string(mgen::len(items))" in cpp_code
-        assert '"Length: "' in cpp_code
+        assert "std::string format_length(const std::vector<int>& items)" in cpp_code
+        assert 'mgen::format("Length: ", mgen::len(items))' in cpp_code
 
     def test_f_string_in_variable_assignment(self):
         """Test f-string used in variable assignment."""
@@ -123,8 +124,7 @@ def create_message(x: int) -> str:
 
         assert "std::string create_message(int x)" in cpp_code
         assert "std::string msg" in cpp_code
-        assert "std::to_string(x)" in cpp_code
-        assert '"Number: "' in cpp_code
+        assert 'mgen::format("Number: ", x)' in cpp_code
 
     def test_nested_f_string_expressions(self):
         """Test f-string with nested expressions."""
@@ -136,8 +136,7 @@ def complex_format(a: int, b: int, c: int) -> str:
 
         assert "std::string complex_format(int a, int b, int c)" in cpp_code
         # Expression should be properly parenthesized
-        assert "std::to_string((a + (b * c)))" in cpp_code
-        assert '"Result: "' in cpp_code
+        assert 'mgen::format("Result: ", (a + (b * c)))' in cpp_code
 
     def test_f_string_empty_expression(self):
         """Test that empty f-string parts work correctly."""
@@ -147,8 +146,49 @@ def format_edge(start: str, end: str) -> str:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "std::string format_edge(std::string start, std::string end)" in cpp_code
-        # Should handle strings without std::to_string
-        assert "start" in cpp_code
-        assert "end" in cpp_code
-        assert '" to "' in cpp_code
+        assert "std::string format_edge(const std::string& start, const std::string& end)" in cpp_code
+        assert 'mgen::format(start, " to ", end)' in cpp_code
+
+
+class TestCppFormatRuntime:
+    """Test mgen::format output against Python's str() formatting."""
+
+    REPORT = """
+def report(count: int, ratio: float, name: str, done: bool) -> str:
+    return f"{name}: {count} items, ratio {ratio}, done={done}, next {count + 1}"
+
+def main() -> int:
+    print(report(3, 0.1, "alpha", True))
+    print(report(-12, 2.0, "beta", False))
+    print(str(1e16) + " " + str(1.5e-7) + " " + str(12345))
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_format_matches_python_str(self):
+        """Test ints, floats and bools print exactly as in Python."""
+        cpp_code = self.converter.convert_code(self.REPORT)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "report.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "report"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        assert result.stdout.splitlines() == [
+            "alpha: 3 items, ratio 0.1, done=True, next 4",
+            "beta: -12 items, ratio 2.0, done=False, next -11",
+            "1e+16 1.5e-07 12345",
+        ]
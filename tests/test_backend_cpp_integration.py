@@ -1,9 +1,17 @@
 """Integration tests for C++ backend - end-to-end functionality."""
 
+import shutil
+import subprocess
+import tempfile
+from pathlib import Path
+
 import pytest
 
 from mgen.backends.cpp.converter import MGenPythonToCppConverter
 from mgen.backends.errors import UnsupportedFeatureError
+from mgen.backends.preferences import CppPreferences
+
+CPP_RUNTIME_HEADER = Path(__file__).parent.parent / "src" / "mgen" / "backends" / "cpp" / "runtime" / "mgen_cpp_runtime.hpp"
 
 class TestCppIntegrationBasic:
     """Test basic integration scenarios."""
@@ -41,7 +49,7 @@ def main() -> None:
         # Check main function
         assert "void main()" in cpp_code
         assert "int result = factorial(5);" in cpp_code or "auto result = factorial(5);" in cpp_code
-        assert "cout << result << endl;" in cpp_code
+        assert "mgen::print(result);" in cpp_code
 
     def test_program_with_multiple_functions(self):
         """Test program with multiple interacting functions."""
@@ -82,8 +90,9 @@ def format_greeting(name: str) -> str:
 
         assert "StringOps::strip(text)" in cpp_code
         assert "StringOps::upper(cleaned)" in cpp_code
-        assert "std::string process_text(std::string text)" in cpp_code
-        assert "std::string format_greeting(std::string name)" in cpp_code
+        # Both strings are only read, so they are borrowed rather than copied or moved
+        assert "std::string process_text(const std::string& text)" in cpp_code
+        assert "std::string format_greeting(const std::string& name)" in cpp_code
         assert ("std::string processed_name = process_text(name);" in cpp_code or
                 "auto processed_name = process_text(name);" in cpp_code)
 
@@ -122,7 +131,7 @@ def create_account() -> BankAccount:
         cpp_code = self.converter.convert_code(python_code)
 
         # Check class definition
-        assert "class BankAccount {" in cpp_code
+        assert "class BankAccount final {" in cpp_code
         assert "std::string account_number;" in cpp_code
         assert "double balance;" in cpp_code
 
@@ -162,8 +171,8 @@ class Rectangle:
         cpp_code = self.converter.convert_code(python_code)
 
         # Check both classes
-        assert "class Point {" in cpp_code
-        assert "class Rectangle {" in cpp_code
+        assert "class Point final {" in cpp_code
+        assert "class Rectangle final {" in cpp_code
 
         # Check Point class
         assert "Point(int x, int y)" in cpp_code
@@ -220,7 +229,7 @@ def analyze_text(text: str) -> dict:
         cpp_code = self.converter.convert_code(python_code)
 
         # Check class
-        assert "class TextProcessor {" in cpp_code
+        assert "class TextProcessor final {" in cpp_code
         assert "std::string prefix;" in cpp_code
 
         # Check string methods
@@ -307,4 +316,1107 @@ def complex_calc(a: int, b: int, c: int) -> int:
 
         # Should handle complex expression parsing
         assert "((a + b) * (c - a)) + (b * c)" in cpp_code or \
-               "((a + b) * (c - a))" in cpp_code and "(b * c)" in cpp_code
\ No newline at end of file
+               "((a + b) * (c - a))" in cpp_code and "(b * c)" in cpp_code
+
+
+class TestCppFlatHashContainers:
+    """Test the flat_hash_containers preference (mgen::FlatMap / FlatSet)."""
+
+    WORD_COUNT = """
+def count_words(text: str) -> dict[str, int]:
+    counts: dict[str, int] = {}
+    for word in text.split(" "):
+        if word in counts:
+            counts[word] = counts[word] + 1
+        else:
+            counts[word] = 1
+    return counts
+
+def main() -> int:
+    counts: dict[str, int] = count_words("the fox and the dog and the cat")
+    seen: set[int] = {n % 3 for n in range(10)}
+    squares: dict[int, int] = {x: x * x for x in range(5)}
+    print(counts["the"] + len(counts) + len(seen) + squares[4])
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        preferences = CppPreferences()
+        preferences.set("flat_hash_containers", True)
+        self.converter = MGenPythonToCppConverter(preferences)
+
+    def test_declarations_use_runtime_aliases(self):
+        """Test dict and set declarations go through mgen::Dict / mgen::Set."""
+        cpp_code = self.converter.convert_code(self.WORD_COUNT)
+
+        assert "#define MGEN_FLAT_CONTAINERS" in cpp_code
+        assert "mgen::Dict<std::string, int> count_words(const std::string& text)" in cpp_code
+        assert "mgen::Set<int> seen" in cpp_code
+        assert "std::unordered_map<" not in cpp_code
+        assert "std::unordered_set<" not in cpp_code
+
+    def test_default_keeps_std_containers(self):
+        """Test the default output still declares std::unordered_map."""
+        cpp_code = MGenPythonToCppConverter().convert_code(self.WORD_COUNT)
+
+        assert "MGEN_FLAT_CONTAINERS" not in cpp_code
+        assert "std::unordered_map<std::string, int> count_words(const std::string& text)" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_flat_containers_program_runs(self):
+        """Test a word count over FlatMap/FlatSet compiles and matches Python."""
+        cpp_code = self.converter.convert_code(self.WORD_COUNT)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "words.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "words"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        # "the" x3, five distinct words, three residues, 4 * 4
+        assert result.stdout.strip() == str(3 + 5 + 3 + 16)
+
+
+class TestCppMoveOnLastUse:
+    """Test last-use analysis emitting std::move and the dict view helpers."""
+
+    GRID = """
+def grid(n: int) -> list[list[int]]:
+    rows: list[list[int]] = []
+    for i in range(n):
+        row: list[int] = []
+        for j in range(n):
+            row.append(i * j)
+        rows.append(row)
+    return rows
+
+def total(xs: list[int]) -> int:
+    s: int = 0
+    for x in xs:
+        s += x
+    return s
+
+def main() -> int:
+    g: list[list[int]] = grid(4)
+    last: list[int] = g[3]
+    d: dict[str, int] = {"ab": 1, "c": 2}
+    t: int = 0
+    for k in d.keys():
+        t += len(k)
+    print(total(last) + len(g) + t + sum(d.values()))
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_row_moved_into_outer_list(self):
+        """Test a row rebuilt every iteration is moved into the list that collects it."""
+        cpp_code = self.converter.convert_code(self.GRID)
+
+        assert "rows.push_back(std::move(row));" in cpp_code
+        assert "row.push_back((i * j));" in cpp_code
+
+    def test_loop_carried_value_not_moved(self):
+        """Test a value still read on the next iteration is copied."""
+        code = """
+def snapshots(n: int) -> list[list[int]]:
+    acc: list[int] = []
+    out: list[list[int]] = []
+    for i in range(n):
+        acc.append(i)
+        out.append(acc)
+    return out
+"""
+        cpp_code = self.converter.convert_code(code)
+
+        assert "out.push_back(acc);" in cpp_code
+        assert "std::move" not in cpp_code
+
+    def test_iterated_container_not_moved_in_loop(self):
+        """Test the iterable of a for loop is not moved from inside the loop."""
+        code = """
+def consume(xs: list[int]) -> int:
+    return len(xs)
+
+def walk(items: list[int]) -> int:
+    n: int = 0
+    for x in items:
+        n = consume(items)
+    return n
+"""
+        cpp_code = self.converter.convert_code(code)
+
+        assert "consume(items)" in cpp_code
+        assert "std::move(items)" not in cpp_code
+
+    def test_value_used_later_not_moved(self):
+        """Test an argument that is read again afterwards is copied."""
+        code = """
+def consume(xs: list[int]) -> int:
+    xs.append(0)
+    return len(xs)
+
+def twice(xs: list[int]) -> int:
+    a: int = consume(xs)
+    b: int = consume(xs)
+    return a + b
+"""
+        cpp_code = self.converter.convert_code(code)
+
+        assert "int a = consume(xs);" in cpp_code
+        assert "int b = consume(std::move(xs));" in cpp_code
+
+    def test_dict_keys_and_values_are_views(self):
+        """Test dict.keys() and dict.values() go through the runtime views."""
+        cpp_code = self.converter.convert_code(self.GRID)
+
+        assert "mgen::keys(d)" in cpp_code
+        assert "mgen::sum(mgen::values(d))" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_moves_program_runs(self):
+        """Test the generated program compiles and matches Python."""
+        cpp_code = self.converter.convert_code(self.GRID)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "grid.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "grid"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        # Row 3 is 0 3 6 9, four rows, key lengths 2 + 1, values 1 + 2
+        assert result.stdout.strip() == str(18 + 4 + 3 + 3)
+
+
+class TestCppSmallVectorLists:
+    """Test short fixed-size list locals emitted as mgen::SmallVector."""
+
+    PAIRS = """
+def score(n: int) -> int:
+    s: int = 0
+    for i in range(n):
+        pair = [i, i + 1]
+        squares: list[int] = [k * i for k in range(4)]
+        s += pair[0] * pair[1] + sum(squares) + max(squares) + len(pair)
+    return s
+
+def main() -> int:
+    weights: list[int] = [3, 1, 2]
+    weights[1] = 5
+    print(score(5) + weights[0] + weights[1])
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_literal_read_in_place_uses_inline_storage(self):
+        """Test an indexed, element-assigned literal becomes a SmallVector of its length."""
+        cpp_code = self.converter.convert_code(self.PAIRS)
+
+        assert "mgen::SmallVector<int, 3> weights = {3, 1, 2};" in cpp_code
+        assert "weights[1] = 5;" in cpp_code
+
+    def test_fixed_size_comprehension_uses_inline_storage(self):
+        """Test a comprehension over range(4) is collected into SmallVector<T, 4>."""
+        cpp_code = self.converter.convert_code(self.PAIRS)
+
+        assert "mgen::SmallVector<int, 4> squares = small_list_comprehension<4>(Range(4)" in cpp_code
+
+    def test_untyped_literal_deduces_element_type(self):
+        """Test a literal of expressions without a known element type uses small_list()."""
+        cpp_code = self.converter.convert_code(self.PAIRS)
+
+        assert "auto pair = mgen::small_list(i, (i + 1));" in cpp_code
+
+    def test_escaping_lists_keep_std_vector(self):
+        """Test lists that are returned, passed on or grown stay std::vector."""
+        code = """
+def total(xs: list[int]) -> int:
+    return sum(xs)
+
+def make() -> list[int]:
+    out: list[int] = [1, 2]
+    return out
+
+def use() -> int:
+    a: list[int] = [1, 2]
+    b: list[int] = [3, 4]
+    b.append(5)
+    return total(a) + len(b)
+"""
+        cpp_code = self.converter.convert_code(code)
+
+        assert "SmallVector" not in cpp_code
+        assert "std::vector<int> out = {1, 2};" in cpp_code
+        assert "std::vector<uint8_t> b = {3, 4};" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_small_vector_program_runs(self):
+        """Test the generated program compiles and matches Python."""
+        cpp_code = self.converter.convert_code(self.PAIRS)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "pairs.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "pairs"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        expected = sum(i * (i + 1) + 6 * i + 3 * i + 2 for i in range(5)) + 3 + 5
+        assert result.stdout.strip() == str(expected)
+
+
+class TestCppPmrContainers:
+    """Test the pmr_containers preference (std::pmr containers and per-call arenas)."""
+
+    REQUEST = """
+def handle(line: str) -> int:
+    words: list[str] = line.split(" ")
+    seen: set[str] = {w for w in words}
+    counts: dict[str, int] = {}
+    for w in words:
+        if w in counts:
+            counts[w] = counts[w] + 1
+        else:
+            counts[w] = 1
+    return len(words) + len(seen) * 10 + counts["a"] * 100
+
+def squares(n: int) -> list[int]:
+    out: list[int] = []
+    for i in range(n):
+        out.append(i * i)
+    return out
+
+def main() -> int:
+    total: int = 0
+    for i in range(3):
+        total += handle("a b a c")
+    print(total + sum(squares(4)))
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        preferences = CppPreferences()
+        preferences.set("pmr_containers", True)
+        self.converter = MGenPythonToCppConverter(preferences)
+
+    def test_declarations_use_runtime_aliases(self):
+        """Test list/dict/set declarations go through mgen::List / Dict / Set."""
+        cpp_code = self.converter.convert_code(self.REQUEST)
+
+        assert "#define MGEN_PMR" in cpp_code
+        assert "mgen::List<std::string> words" in cpp_code
+        assert "mgen::Dict<std::string, int> counts" in cpp_code
+        assert "mgen::List<int> squares(int n)" in cpp_code
+        assert "std::vector<" not in cpp_code
+
+    def test_scope_arena_only_where_containers_stay_local(self):
+        """Test only a function whose containers die with the call gets an arena."""
+        cpp_code = self.converter.convert_code(self.REQUEST)
+
+        handle = cpp_code[cpp_code.index("int handle("):cpp_code.index("mgen::List<int> squares(")]
+        assert "mgen::ScopedResource mgen_scope_resource;" in handle
+        # Returns a list, and main calls a user function in a loop
+        assert cpp_code.count("ScopedResource") == 1
+
+    def test_loop_creating_containers_keeps_pool(self):
+        """Test a loop that builds a new list each iteration does not use a monotonic arena."""
+        code = """
+def churn(n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        row: list[int] = [i, i + 1]
+        total += row[0]
+    return total
+"""
+        cpp_code = self.converter.convert_code(code)
+
+        assert "ScopedResource" not in cpp_code
+
+    def test_default_has_no_pmr(self):
+        """Test the default output keeps std containers and no arena."""
+        cpp_code = MGenPythonToCppConverter().convert_code(self.REQUEST)
+
+        assert "MGEN_PMR" not in cpp_code
+        assert "ScopedResource" not in cpp_code
+        assert "std::vector<std::string> words" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_pmr_program_runs(self):
+        """Test the pmr program compiles and matches Python."""
+        cpp_code = self.converter.convert_code(self.REQUEST)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "request.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "request"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        # Per call: 4 words, 3 distinct, "a" twice; squares 0 + 1 + 4 + 9
+        assert result.stdout.strip() == str(3 * (4 + 30 + 200) + 14)
+
+
+class TestCppConstantTables:
+    """Test comprehensions over constant ranges folded into constexpr std::array tables."""
+
+    TABLES = """
+def checksum(n: int) -> int:
+    squares = [i * i for i in range(20)]
+    halves: list[float] = [i for i in range(4)]
+    odd = [i % 2 == 1 for i in range(4)]
+    total: int = 0
+    for k in range(n):
+        total += squares[k % 20] + int(halves[k % 4] / 2.0)
+        if odd[k % 4]:
+            total += 1
+    return total + sum(squares) + len(squares)
+
+def main() -> int:
+    print(checksum(50))
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_constant_comprehension_becomes_constexpr_array(self):
+        """Test a comprehension over range(20) is emitted as a wrapped constexpr table."""
+        cpp_code = self.converter.convert_code(self.TABLES)
+
+        assert "static constexpr std::array<int, 20> squares = {" in cpp_code
+        assert "0, 1, 4, 9, 16, 25" in cpp_code
+        assert "list_comprehension(Range(20)" not in cpp_code
+
+    def test_element_types_follow_values_and_annotation(self):
+        """Test bool tables use true/false and list[float] annotations give double tables."""
+        cpp_code = self.converter.convert_code(self.TABLES)
+
+        assert "static constexpr std::array<bool, 4> odd = {false, true, false, true};" in cpp_code
+        assert "static constexpr std::array<double, 4> halves = {0.0, 1.0, 2.0, 3.0};" in cpp_code
+
+    def test_mutated_or_dynamic_comprehensions_stay_vectors(self):
+        """Test tables that are written, escape or depend on runtime values are not folded."""
+        code = """
+def total(xs: list[int]) -> int:
+    return sum(xs)
+
+def use(n: int) -> int:
+    a = [i for i in range(3)]
+    a[0] = 7
+    b = [i for i in range(3)]
+    c = [i * n for i in range(3)]
+    return a[0] + total(b) + c[1]
+"""
+        cpp_code = self.converter.convert_code(code)
+
+        assert "constexpr" not in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_constant_table_program_runs(self):
+        """Test the generated program compiles and matches Python."""
+        cpp_code = self.converter.convert_code(self.TABLES)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "tables.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "tables"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        expected = sum((k % 20) ** 2 + (k % 4) // 2 + k % 2 for k in range(50)) + sum(i * i for i in range(20)) + 20
+        assert result.stdout.strip() == str(expected)
+
+
+class TestCppParallelLoops:
+    """Test the parallel_loops preference: OpenMP parallel-for on independent loops."""
+
+    CODE = """
+def square(x: int) -> int:
+    return x * x
+
+def table(rows: list[list[int]], n: int) -> int:
+    for i in range(n):
+        for j in range(n):
+            rows[i][j] = square(i) + j
+    total: int = 0
+    for i in range(n):
+        for j in range(n):
+            total += rows[i][j]
+    return total
+
+def main() -> int:
+    n: int = 200
+    rows: list[list[int]] = []
+    for i in range(n):
+        row: list[int] = []
+        for j in range(n):
+            row.append(0)
+        rows.append(row)
+    print(table(rows, n))
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        preferences = CppPreferences()
+        preferences.set("parallel_loops", True)
+        self.converter = MGenPythonToCppConverter(preferences)
+
+    def test_outer_loops_get_pragmas(self):
+        """Test only the outermost loop of each independent nest forks threads."""
+        cpp_code = self.converter.convert_code(self.CODE)
+        lines = [line.strip() for line in cpp_code.splitlines()]
+
+        pragmas = [(line, lines[index + 1]) for index, line in enumerate(lines) if line.startswith("#pragma omp")]
+        assert pragmas == [
+            ("#pragma omp parallel for", "for (int i = 0; i < n; i++) {"),
+            ("#pragma omp parallel for reduction(+:total)", "for (int i = 0; i < n; i++) {"),
+        ]
+        assert "#pragma omp" not in MGenPythonToCppConverter().convert_code(self.CODE)
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_parallel_program_matches_serial_result(self):
+        """Test the threaded program computes the serial result."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "table.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "table"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-fopenmp", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        assert result.stdout.strip() == str(sum(i * i + j for i in range(200) for j in range(200)))
+
+
+class TestCppBorrowedParameters:
+    """Test read-only container and string parameters passed as const&."""
+
+    CODE = """
+def search(xs: list[int], target: int, lo: int, hi: int) -> int:
+    if lo >= hi:
+        return -1
+    mid: int = (lo + hi) // 2
+    if xs[mid] == target:
+        return mid
+    if xs[mid] < target:
+        return search(xs, target, mid + 1, hi)
+    return search(xs, target, lo, mid)
+
+def shout(word: str) -> int:
+    return len(word.upper())
+
+def passthrough(xs: list[int]) -> list[int]:
+    return xs
+
+def main() -> int:
+    xs: list[int] = []
+    for i in range(50):
+        xs.append(i * 3)
+    ys: list[int] = passthrough(xs)
+    print(search(xs, 42, 0, len(xs)) + search(ys, 7, 0, len(ys)) + shout("abc"))
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_read_only_parameters_are_const_references(self):
+        """Test recursion keeps borrowing the list while a returned parameter stays by value."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        assert "int search(const std::vector<int>& xs, int target, int lo, int hi)" in cpp_code
+        assert "int shout(const std::string& word)" in cpp_code
+        assert "std::vector<int> passthrough(std::vector<int> xs)" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_borrowing_program_runs(self):
+        """Test the program with const& parameters compiles and matches Python."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "search.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "search"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        # 42 is at index 14, 7 is missing, "ABC" has 3 characters
+        assert result.stdout.strip() == str(14 - 1 + 3)
+
+
+class TestCppNarrowIntegerLists:
+    """Test int list locals stored with the narrowest element type their value range allows."""
+
+    CODE = """
+def digest(n: int) -> int:
+    digits: list[int] = []
+    for i in range(n):
+        digits.append((i * 37) % 10)
+    offsets: list[int] = [0, -300, 0, 0, 0, 0, 0, 0, 0]
+    for j in range(9):
+        offsets[j] = 2 * j - 300
+    total: int = 0
+    for d in digits:
+        total += d * 1000
+    print(digits[3])
+    return total + offsets[8] + len(digits)
+
+def sums(n: int) -> list[int]:
+    running: list[int] = [0, 0, 0, 0, 0, 0, 0, 0, 0]
+    for i in range(n):
+        running[i % 9] += i
+    return running
+
+def main() -> int:
+    print(digest(40))
+    print(len(sums(5)))
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_bounded_lists_use_narrow_element_types(self):
+        """Test digit lists become uint8_t and small signed offsets int16_t."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        assert "std::vector<uint8_t> digits = {};" in cpp_code
+        assert "std::vector<int16_t> offsets = {0, (-300), 0, 0, 0, 0, 0, 0, 0};" in cpp_code
+        assert "for (int d : digits)" in cpp_code
+        assert "mgen::print(digits[3])" in cpp_code
+
+    def test_unbounded_or_escaping_lists_keep_int(self):
+        """Test an accumulated list and a returned list keep int elements."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        assert "std::vector<int> running = {0, 0, 0, 0, 0, 0, 0, 0, 0};" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_narrow_list_program_runs(self):
+        """Test the program with narrowed lists compiles and matches Python."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "digest.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "digest"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        digits = [(i * 37) % 10 for i in range(40)]
+        assert result.stdout.split() == [str(digits[3]), str(sum(digits) * 1000 + 16 - 300 + 40), "9"]
+
+
+class TestCppStringDispatch:
+    """Test string if/elif chains and read-only str dicts compiled to length-then-byte switches."""
+
+    CODE = """
+def score(word: str) -> int:
+    table: dict[str, int] = {"if": 1, "else": 2, "while": 3, "for": 4, "return": 5}
+    if word in table:
+        return table[word] + len(table)
+    return 0
+
+
+def kind(op: str) -> int:
+    if op == "add":
+        return 1
+    elif op == "sub" or op == "minus":
+        return 2
+    elif op == "mul":
+        return 3
+    else:
+        return 0
+
+
+def classify(words: list[str]) -> int:
+    n: int = 0
+    for w in words:
+        if w == "stop":
+            n += 10
+        elif w in ("skip", "pass"):
+            n += 0
+        elif w == "":
+            n += 100
+        else:
+            n += 1
+    return n
+
+
+def main() -> int:
+    print(score("while") + score("x") + kind("sub") + kind("mul") + kind("?"))
+    words: list[str] = ["x", "skip", "", "y", "stop", "z"]
+    print(classify(words))
+    return 0
+
+
+def weight(name: str) -> float:
+    table: dict[str, float] = {"a": 1, "bb": 2.5}
+    if name in table:
+        return table[name]
+    return -1.0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_chains_and_constant_dicts_use_dispatch_functions(self):
+        """Test dicts become constexpr tables behind str_match and chains branch on its index."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        assert "static constexpr std::array<int, 5> str_table_0_values = {1, 2, 3, 4, 5};" in cpp_code
+        assert "return (str_table_0_at(word) + 5);" in cpp_code
+        assert "int str_branch_1 = str_match_1(op);" in cpp_code
+        assert 'return std::memcmp(s.data(), "sub", 3) == 0 ? 1 : -1;' in cpp_code
+        assert "int str_branch_2 = str_match_2(w);" in cpp_code
+        # An int-valued literal annotated dict[str, float] keeps double values
+        assert "static constexpr std::array<double, 2> str_table_3_values = {1.0, 2.5};" in cpp_code
+        assert "std::unordered_map" not in cpp_code.split("using namespace mgen;")[1]
+
+    def test_preference_off_keeps_comparisons(self):
+        """Test string_dispatch=False keeps == chains and unordered_map tables."""
+        preferences = CppPreferences()
+        preferences.set("string_dispatch", False)
+        # Membership in a literal tuple needs the dispatch: leave classify() out
+        cpp_code = MGenPythonToCppConverter(preferences).convert_code(self.CODE.split("def classify")[0])
+
+        assert "str_match" not in cpp_code
+        assert '(op == "add")' in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_dispatch_program_runs(self):
+        """Test the generated program compiles and matches Python."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "dispatch.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "dispatch"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        assert result.stdout.split() == ["13", "113"]
+
+
+class TestCppStructOfArraysLists:
+    """Test lists of plain scalar-field classes stored as one vector per field (soa_lists)."""
+
+    CODE = """
+class Particle:
+    def __init__(self, x: float, v: float) -> None:
+        self.x: float = x
+        self.v: float = v
+        self.hits: int = 0
+
+
+def step(ps: list[Particle], dt: float) -> None:
+    for p in ps:
+        p.x += p.v * dt
+        if p.x > 10.0:
+            p.hits += 1
+
+
+def total(ps: list[Particle]) -> float:
+    s: float = 0.0
+    for i in range(len(ps)):
+        s += ps[i].x + ps[i].hits
+    return s
+
+
+def main() -> int:
+    ps: list[Particle] = []
+    for i in range(10):
+        ps.append(Particle(i * 1.0, 2.0))
+    step(ps, 0.5)
+    step(ps, 0.5)
+    ps[0].v = -1.0
+    step(ps, 2.0)
+    t: float = total(ps)
+    print(t)
+    print(len(ps))
+    return 0
+"""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        preferences = CppPreferences()
+        preferences.set("soa_lists", True)
+        self.converter = MGenPythonToCppConverter(preferences)
+
+    def test_lists_become_field_vectors(self):
+        """Test the SoA struct and loops indexing its vectors in place of element objects."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        assert "struct ParticleSoA {\n    std::vector<double> x;\n    std::vector<double> v;" in cpp_code
+        assert "void step(ParticleSoA& ps, double dt)" in cpp_code
+        assert "for (size_t p_soa_index = 0; p_soa_index < ps.size(); p_soa_index++)" in cpp_code
+        assert "ps.x[p_soa_index] += (ps.v[p_soa_index] * dt);" in cpp_code
+        assert "ps.v[0] = (-1.0);" in cpp_code
+        assert "std::vector<Particle>" not in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_soa_program_runs(self):
+        """Test the generated program compiles and matches Python."""
+        cpp_code = self.converter.convert_code(self.CODE)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "soa.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "soa"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        assert result.stdout.split() == ["105.0", "10"]
+
+
+class TestCppDevirtualizedMethods:
+    """Test leaf classes are final and their getter calls read the field."""
+
+    CODE = """
+class Counter:
+    def __init__(self, start: int) -> None:
+        self.count: int = start
+
+    def get(self) -> int:
+        return self.count
+
+    def bump(self, by: int) -> None:
+        self.count += by
+
+    def doubled(self) -> int:
+        return self.get() * 2
+
+
+class Base:
+    def __init__(self) -> None:
+        self.v: int = 1
+
+    def value(self) -> int:
+        return self.v
+
+
+class Derived(Base):
+    def value(self) -> int:
+        return 2
+
+
+def run(n: int) -> int:
+    c: Counter = Counter(0)
+    for i in range(n):
+        c.bump(i)
+    return c.get() + c.doubled()
+
+
+def main() -> int:
+    print(run(10))
+    return 0
+"""
+
+    def test_leaf_classes_are_final(self):
+        """Test final marks only classes nothing derives from."""
+        cpp_code = MGenPythonToCppConverter().convert_code(self.CODE)
+
+        assert "class Counter final {" in cpp_code
+        assert "class Derived final {" in cpp_code
+        assert "class Base {" in cpp_code
+
+    def test_getter_calls_read_the_field(self):
+        """Test getter calls on leaf receivers and self become field reads."""
+        cpp_code = MGenPythonToCppConverter().convert_code(self.CODE)
+
+        assert "int get() const {" in cpp_code
+        assert "return (c.count + c.doubled());" in cpp_code
+        assert "return (this->count * 2);" in cpp_code
+        assert "/* Method call" not in cpp_code
+
+    def test_preference_off_keeps_classes_open(self):
+        """Test devirtualize=False emits classes and calls unchanged."""
+        preferences = CppPreferences()
+        preferences.set("devirtualize", False)
+        cpp_code = MGenPythonToCppConverter(preferences).convert_code(self.CODE)
+
+        assert "class Counter {" in cpp_code
+        assert "c.get()" in cpp_code
+        assert "this->get()" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_devirtualized_program_runs(self):
+        """Test the generated program compiles and matches Python."""
+        cpp_code = MGenPythonToCppConverter().convert_code(self.CODE)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "methods.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "methods"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        assert result.stdout.split() == ["135"]
+
+
+class TestCppInstrumentedBuild:
+    """Test instrument declares a probe per function and loop and reports them at exit."""
+
+    CODE = """
+def work(n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        if i == 5:
+            return total
+        total += i
+    return total
+
+
+def main() -> int:
+    print(work(3))
+    print(work(10))
+    return 0
+"""
+
+    def converter(self, enabled: bool = True) -> MGenPythonToCppConverter:
+        """Converter with instrument set."""
+        preferences = CppPreferences()
+        preferences.set("instrument", enabled)
+        return MGenPythonToCppConverter(preferences)
+
+    def test_probes_precede_runtime_include(self):
+        """Test the instrumentation switch comes before the runtime header and loops close their probe."""
+        cpp_code = self.converter().convert_code(self.CODE)
+
+        assert "#define MGEN_INSTRUMENT_MAX_SITES 3" in cpp_code
+        assert cpp_code.index("#define MGEN_INSTRUMENT\n") < cpp_code.index('#include "runtime/mgen_cpp_runtime.hpp"')
+        assert 'MGEN_PROBE(mgen_probe_1, 1, "work", "loop", 4);' in cpp_code
+        assert "MGEN_PROBE_CLOSE(mgen_probe_1);" in cpp_code
+
+    def test_preference_off_emits_no_probes(self):
+        """Test the default build carries no instrumentation."""
+        cpp_code = self.converter(enabled=False).convert_code(self.CODE)
+
+        assert "MGEN_PROBE" not in cpp_code
+        assert "MGEN_INSTRUMENT" not in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_instrumented_program_reports_at_exit(self):
+        """Test the program still prints what Python prints and reports each site on stderr."""
+        cpp_code = self.converter().convert_code(self.CODE)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "probed.cpp"
+            source.write_text(cpp_code)
+            binary = Path(tmpdir) / "probed"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+        assert result.stdout.split() == ["3", "10"]
+        report = [line.split()[:4] for line in result.stderr.splitlines()]
+        assert ["work", "function", "2", "2"] in report
+        assert ["work", "loop", "4", "2"] in report
+
+
+class TestCppSourceMapping:
+    """Test source_file makes #line directives attribute the generated C++ to the Python lines."""
+
+    CODE = """
+def square_sum(n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        total += i * i
+    return total
+
+
+def main() -> int:
+    print(square_sum(10))
+    return 0
+"""
+
+    def test_functions_and_statements_carry_their_python_line(self):
+        """Test each def and statement is preceded by #line, and module code after a function is reset."""
+        cpp_code = MGenPythonToCppConverter().convert_code(self.CODE, "/src/mapped.py")
+        lines = cpp_code.splitlines()
+
+        assert lines[lines.index("int square_sum(int n) {") - 1] == '#line 2 "/src/mapped.py"'
+        assert '#line 5 "/src/mapped.py"' in cpp_code
+        reset = next(i for i, line in enumerate(lines) if line.startswith("#line") and "mapped.cpp" in line)
+        assert lines[reset] == f'#line {reset + 2} "mapped.cpp"'
+        assert "#line" not in MGenPythonToCppConverter().convert_code(self.CODE)
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_debug_build_points_dwarf_at_python_file(self):
+        """Test a -g build runs unchanged and its line table names the Python file."""
+        with tempfile.TemporaryDirectory() as tmpdir:
+            runtime_dir = Path(tmpdir) / "runtime"
+            runtime_dir.mkdir()
+            shutil.copy(CPP_RUNTIME_HEADER, runtime_dir)
+            source = Path(tmpdir) / "mapped.cpp"
+            source.write_text(MGenPythonToCppConverter().convert_code(self.CODE, str(Path(tmpdir) / "mapped.py")))
+            binary = Path(tmpdir) / "mapped"
+            subprocess.run(
+                ["g++", "-std=c++17", "-O2", "-g", "-I", tmpdir, str(source), "-o", str(binary)],
+                check=True,
+                capture_output=True,
+            )
+            result = subprocess.run([str(binary)], capture_output=True, text=True, check=True)
+
+            assert result.stdout.split() == ["285"]
+            assert b"mapped.py" in binary.read_bytes()
+
+
+class TestCppExtensionModule:
+    """Test the extension target mode exports the functions as a CPython module."""
+
+    CODE = """
+def dot(xs: list[float], ys: list[float]) -> float:
+    total: float = 0.0
+    for i in range(len(xs)):
+        total += xs[i] * ys[i]
+    return total
+
+
+def grow(xs: list[int]) -> list[int]:
+    xs.append(len(xs))
+    return xs
+
+
+def shout(name: str) -> str:
+    return name.upper()
+"""
+
+    def converter(self) -> MGenPythonToCppConverter:
+        """Converter in extension mode."""
+        preferences = CppPreferences()
+        preferences.set("target_mode", "extension")
+        return MGenPythonToCppConverter(preferences)
+
+    def test_wrappers_follow_the_runtime_switch(self):
+        """Test Python.h comes first, the runtime switch precedes its header and the wrapper catches exceptions."""
+        cpp_code = self.converter().convert_code(self.CODE)
+
+        assert cpp_code.startswith("#define PY_SSIZE_T_CLEAN\n#include <Python.h>\n")
+        runtime_include = cpp_code.index('#include "runtime/mgen_cpp_runtime.hpp"')
+        assert cpp_code.index("#define MGEN_PYTHON_EXTENSION") < runtime_include
+        assert "    std::vector<double> mgen_arg_xs;\n    if (!mgen::py_arg(args[0], mgen_arg_xs)) {" in cpp_code
+        assert "        return mgen::py_raise(error);" in cpp_code
+        assert "PyMODINIT_FUNC MGEN_PYEXT_INIT(MGEN_EXTENSION_NAME)(void) {" in cpp_code
+
+    @pytest.mark.skipif(shutil.which("g++") is None, reason="g++ not available")
+    def test_module_takes_buffers_and_sequences(self, tmp_path):
+        """Test the built module copies buffers and lists into its vectors and returns fresh Python objects."""
+        import importlib.util
+        from array import array
+
+        from mgen.backends.cpp.builder import CppBuilder
+        from mgen.backends.python_extension import extension_filename
+
+        source = tmp_path / "cppkernels.cpp"
+        source.write_text(self.converter().convert_code(self.CODE))
+
+        assert CppBuilder().compile_direct(str(source), str(tmp_path), target_mode="extension")
+        spec = importlib.util.spec_from_file_location("cppkernels", tmp_path / extension_filename("cppkernels"))
+        module = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(module)
+
+        assert module.dot(array("d", [1.0, 2.0]), [3.0, 4.0]) == 11.0
+        values = array("i", [5, 6])
+        assert module.grow(values) == [5, 6, 2]
+        assert values == array("i", [5, 6])
+        assert module.shout("mgen") == "MGEN"
+        with pytest.raises(TypeError):
+            module.shout(3)
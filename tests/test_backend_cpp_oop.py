@@ -23,7 +23,7 @@ class Point:
         cpp_code = self.converter.convert_code(python_code)
 
         # Check class definition
-        assert "class Point {" in cpp_code
+        assert "class Point final {" in cpp_code
         assert "public:" in cpp_code
         assert "int x;" in cpp_code
         assert "int y;" in cpp_code
@@ -50,7 +50,7 @@ class Rectangle:
         cpp_code = self.converter.convert_code(python_code)
 
         # Check class structure
-        assert "class Rectangle {" in cpp_code
+        assert "class Rectangle final {" in cpp_code
         assert "int width;" in cpp_code
         assert "int height;" in cpp_code
 
@@ -140,7 +140,7 @@ class EmptyClass:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "class EmptyClass {" in cpp_code
+        assert "class EmptyClass final {" in cpp_code
         assert "EmptyClass()" in cpp_code
         assert "void do_nothing()" in cpp_code
 
@@ -243,8 +243,8 @@ class Circle:
         cpp_code = self.converter.convert_code(python_code)
 
         # Check both classes are generated
-        assert "class Point {" in cpp_code
-        assert "class Circle {" in cpp_code
+        assert "class Point final {" in cpp_code
+        assert "class Circle final {" in cpp_code
 
         # Check Point class
         assert "Point(int x, int y)" in cpp_code
@@ -271,7 +271,7 @@ def process_data(d: Data) -> int:
         cpp_code = self.converter.convert_code(python_code)
 
         # Check class
-        assert "class Data {" in cpp_code
+        assert "class Data final {" in cpp_code
         assert "Data(int value)" in cpp_code
 
         # Check function (simplified - attribute access)
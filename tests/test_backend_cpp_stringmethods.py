@@ -188,7 +188,7 @@ def check_text(text: str) -> bool:
 """
         cpp_code = self.converter.convert_code(python_code)
 
-        assert "if ((StringOps::strip(text) == \"\"))" in cpp_code
+        assert "if ((StringOps::strip_view(text) == \"\"))" in cpp_code
 
     def test_string_method_with_numeric_result(self):
         """Test string method that returns numeric value."""
@@ -247,4 +247,73 @@ def test_returns(text: str) -> int:
         cpp_code = self.converter.convert_code(python_code)
 
         assert "int pos = StringOps::find(text, \"test\");" in cpp_code
-        assert "return pos;" in cpp_code
\ No newline at end of file
+        assert "return pos;" in cpp_code
+
+
+class TestStringViewBorrowing:
+    """Test that strip()/split() results that do not escape use string_view variants."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToCppConverter()
+
+    def test_len_of_split_borrows(self):
+        """Test len(text.split(...)) counts views instead of copied strings."""
+        python_code = """
+def count_fields(text: str) -> int:
+    return len(text.split(","))
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert 'mgen::len(StringOps::split_view(text, ","))' in cpp_code
+
+    def test_stored_strip_result_is_owned(self):
+        """Test a strip() result assigned to a variable stays a std::string."""
+        python_code = """
+def clean(text: str) -> str:
+    result: str = text.strip()
+    return result
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "std::string result = StringOps::strip(text);" in cpp_code
+        assert "strip_view" not in cpp_code
+
+    def test_loop_over_split_tokens_borrows(self):
+        """Test tokens that are only compared and measured are views into the line."""
+        python_code = """
+def score(line: str) -> int:
+    total = 0
+    for word in line.split(" "):
+        if word == "bonus":
+            total = total + 10
+        total = total + len(word)
+    return total
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert 'for (auto word : StringOps::split_view(line, " "))' in cpp_code
+
+    def test_loop_storing_tokens_copies(self):
+        """Test tokens appended to a list are owned strings."""
+        python_code = """
+def collect(line: str) -> list[str]:
+    words: list[str] = []
+    for word in line.split(","):
+        words.append(word)
+    return words
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert 'for (auto word : StringOps::split(line, ","))' in cpp_code
+        assert "split_view" not in cpp_code
+
+    def test_membership_test_does_not_borrow(self):
+        """Test `in` keeps the owned strip() result, since containers are keyed by std::string."""
+        python_code = """
+def known(text: str, names: set[str]) -> bool:
+    return text.strip() in names
+"""
+        cpp_code = self.converter.convert_code(python_code)
+
+        assert "names.count(StringOps::strip(text))" in cpp_code
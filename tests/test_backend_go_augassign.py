@@ -290,4 +290,42 @@ def test_account() -> float:
         assert "obj.Balance -= amount" in go_code
         assert "obj.Balance *= (1 + rate)" in go_code
         assert "account := NewBankAccount(1000)" in go_code
-        assert "account.Deposit(500)" in go_code
\ No newline at end of file
+        assert "account.Deposit(500)" in go_code
+
+
+class TestGoAugAssignDictUpdates:
+    """Test counting updates become a single map access."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToGoConverter()
+
+    def test_membership_counting_uses_increment(self):
+        """Test `if k in d: d[k] = d[k] + 1 else: d[k] = 1` becomes `d[k]++`."""
+        python_code = """
+def count(words: list[str]) -> dict[str, int]:
+    counts: dict[str, int] = {}
+    for word in words:
+        if word in counts:
+            counts[word] = counts[word] + 1
+        else:
+            counts[word] = 1
+    return counts
+"""
+        go_code = self.converter.convert_code(python_code)
+
+        assert "counts[word]++" in go_code
+        assert "_, ok := counts[word]" not in go_code
+
+    def test_get_with_zero_default_uses_add_assign(self):
+        """Test `d[k] = d.get(k, 0) + n` relies on the zero value of a missing key."""
+        python_code = """
+def tally(keys: list[int], n: int) -> dict[int, int]:
+    c: dict[int, int] = {}
+    for k in keys:
+        c[k] = c.get(k, 0) + n
+    return c
+"""
+        go_code = self.converter.convert_code(python_code)
+
+        assert "c[k] += n" in go_code
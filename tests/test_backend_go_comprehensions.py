@@ -21,9 +21,11 @@ def test_list_comp() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        # Should contain comprehension call with Range
-        assert "mgen.ListComprehension" in go_code
-        assert "mgen.NewRange(5)" in go_code
+        # Should be an inlined loop appending to a preallocated slice
+        assert "mgenResult := make([]int, 0, mgen.RangeLen(0, 5, 1))" in go_code
+        assert "for x := 0; x < 5; x++" in go_code
+        assert "mgenResult = append(mgenResult, x)" in go_code
+        assert "mgen.ListComprehension" not in go_code
 
     def test_list_comprehension_with_expression(self):
         """Test list comprehension with expression transformation."""
@@ -33,11 +35,8 @@ def test_list_comp_expr() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.ListComprehension" in go_code
-        assert "mgen.NewRange(3)" in go_code
-        # Should contain lambda expression
-        # Lambda signature updated for generics
-        assert "(x * 2)" in go_code
+        assert "for x := 0; x < 3; x++" in go_code
+        assert "mgenResult = append(mgenResult, (x * 2))" in go_code
 
     def test_list_comprehension_with_condition(self):
         """Test list comprehension with if condition."""
@@ -47,10 +46,9 @@ def test_list_comp_if() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.ListComprehension" in go_code  # Either ListComprehension or ListComprehensionFromRangeWithFilter
-        assert "mgen.NewRange(10)" in go_code
-        # Should contain condition lambda
-        assert "(x % 2) == 0" in go_code
+        assert "for x := 0; x < 10; x++" in go_code
+        # Condition guards the append inside the loop body
+        assert "if (((x % 2) == 0)) { mgenResult = append(mgenResult, x) }" in go_code
 
     def test_list_comprehension_range_start_stop(self):
         """Test list comprehension with range(start, stop)."""
@@ -60,7 +58,8 @@ def test_range_start_stop() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.NewRange(2, 8)" in go_code
+        assert "mgen.RangeLen(2, 8, 1)" in go_code
+        assert "for x := 2; x < 8; x++" in go_code
 
     def test_list_comprehension_range_step(self):
         """Test list comprehension with range(start, stop, step)."""
@@ -70,7 +69,8 @@ def test_range_step() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.NewRange(0, 10, 2)" in go_code
+        assert "mgen.RangeLen(0, 10, 2)" in go_code
+        assert "for x := 0; x < 10; x += 2" in go_code
 
     def test_list_comprehension_complex_expression(self):
         """Test list comprehension with complex expression."""
@@ -80,8 +80,7 @@ def test_complex_expr() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.ListComprehension" in go_code
-        assert "((x * x) + 1)" in go_code
+        assert "mgenResult = append(mgenResult, ((x * x) + 1))" in go_code
 
     def test_list_comprehension_with_variable(self):
         """Test list comprehension using variable in range."""
@@ -91,7 +90,29 @@ def test_with_var(n: int) -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.NewRange(n)" in go_code
+        assert "mgen.RangeLen(0, n, 1)" in go_code
+        assert "for x := 0; x < n; x++" in go_code
+
+    def test_list_comprehension_negative_step(self):
+        """Test that a negative constant step counts down."""
+        python_code = """
+def test_countdown(n: int) -> list:
+    return [x for x in range(n, 0, -1)]
+"""
+        go_code = self.converter.convert_code(python_code)
+
+        assert "for x := n; x > 0; x += (-1)" in go_code
+
+    def test_list_comprehension_over_dict_items(self):
+        """Test that items() ranges over the map without building pairs."""
+        python_code = """
+def test_items(d: dict[str, int]) -> list:
+    return [k + str(v) for k, v in d.items()]
+"""
+        go_code = self.converter.convert_code(python_code)
+
+        assert "func() []string { mgenResult := make([]string, 0, len(d))" in go_code
+        assert "for k, v := range d" in go_code
 
 
 class TestGoDictComprehensions:
@@ -109,9 +130,9 @@ def test_dict_comp() -> dict:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.DictComprehension" in go_code
-        assert "mgen.NewRange(3)" in go_code
-        # Dict comprehension now uses generics with specific types
+        assert "mgenResult := make(map[int]int, mgen.RangeLen(0, 3, 1))" in go_code
+        assert "mgenResult[x] = (x * 2)" in go_code
+        assert "mgen.DictComprehension" not in go_code
 
     def test_dict_comprehension_with_condition(self):
         """Test dictionary comprehension with condition."""
@@ -121,10 +142,7 @@ def test_dict_comp_if() -> dict:
 """
         go_code = self.converter.convert_code(python_code)
 
-        # Note: Dict comprehensions with filters would be complex in Go
-        # For now, just check basic structure
-        assert "mgen.DictComprehension" in go_code
-        assert "mgen.NewRange(5)" in go_code
+        assert "if ((x > 2)) { mgenResult[x] = (x * x) }" in go_code
 
     def test_dict_comprehension_string_keys(self):
         """Test dictionary comprehension with string keys."""
@@ -134,8 +152,8 @@ def test_dict_str_keys() -> dict:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.DictComprehension" in go_code
-        assert "mgen.NewRange(3)" in go_code
+        assert "map[string]int" in go_code
+        assert "for x := 0; x < 3; x++" in go_code
 
     def test_dict_comprehension_complex_values(self):
         """Test dictionary comprehension with complex value expressions."""
@@ -145,8 +163,7 @@ def test_dict_complex() -> dict:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.DictComprehension" in go_code
-        assert "((x * x) + x)" in go_code
+        assert "mgenResult[x] = ((x * x) + x)" in go_code
 
 
 class TestGoSetComprehensions:
@@ -164,8 +181,9 @@ def test_set_comp() -> set:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.SetComprehension" in go_code
-        assert "mgen.NewRange(5)" in go_code
+        assert "mgenResult := make(map[int]bool, mgen.RangeLen(0, 5, 1))" in go_code
+        assert "mgenResult[x] = true" in go_code
+        assert "mgen.SetComprehension" not in go_code
 
     def test_set_comprehension_with_condition(self):
         """Test set comprehension with condition."""
@@ -175,9 +193,7 @@ def test_set_comp_if() -> set:
 """
         go_code = self.converter.convert_code(python_code)
 
-        # Note: Set comprehensions with filters would need complex handling
-        assert "mgen.SetComprehension" in go_code
-        assert "mgen.NewRange(10)" in go_code
+        assert "if (((x % 3) == 0)) { mgenResult[x] = true }" in go_code
 
     def test_set_comprehension_with_expression(self):
         """Test set comprehension with expression transformation."""
@@ -187,8 +203,7 @@ def test_set_comp_expr() -> set:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.SetComprehension" in go_code
-        assert "(x * x)" in go_code
+        assert "mgenResult[(x * x)] = true" in go_code
 
     def test_set_comprehension_deduplication(self):
         """Test set comprehension that would naturally deduplicate."""
@@ -198,8 +213,7 @@ def test_set_dedup() -> set:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.SetComprehension" in go_code
-        assert "(x % 3)" in go_code
+        assert "mgenResult[(x % 3)] = true" in go_code
 
 
 class TestGoComprehensionsAdvanced:
@@ -217,7 +231,7 @@ def test_func_call() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.ListComprehension" in go_code
+        assert "for x := 0; x < 6; x++" in go_code
         # Should contain abs function call
         assert "mgen.Abs" in go_code
 
@@ -233,7 +247,7 @@ class NumberProcessor:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.ListComprehension" in go_code
+        assert "for x := 0; x < n; x++" in go_code
         assert "obj.Multiplier" in go_code
 
     def test_nested_comprehensions_simple(self):
@@ -246,8 +260,9 @@ def test_nested() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        # Should have two separate comprehensions
-        assert go_code.count("mgen.ListComprehension") >= 1
+        # Should have two separate comprehensions, the second ranging over the slice
+        assert go_code.count("mgenResult := make(") == 2
+        assert "for _, y := range inner" in go_code
 
     def test_comprehension_return_types(self):
         """Test that comprehensions generate appropriate return types."""
@@ -259,9 +274,9 @@ def test_types() -> None:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.ListComprehension" in go_code
-        assert "mgen.DictComprehension" in go_code
-        assert "mgen.SetComprehension" in go_code
+        assert "func() []int {" in go_code
+        assert "func() map[int]int {" in go_code
+        assert "func() map[int]bool {" in go_code
 
     def test_comprehension_with_multiple_variables(self):
         """Test comprehension with multiple loop variables (simplified)."""
@@ -272,6 +287,5 @@ def test_multi_vars() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        # For now, just check that we get basic comprehension structure
-        # Full nested comprehensions would be complex in Go
-        assert "mgen.ListComprehension" in go_code
\ No newline at end of file
+        # Generators become nested loops in source order
+        assert "for x := 0; x < 3; x++ { for y := 0; y < 2; y++ {" in go_code
\ No newline at end of file
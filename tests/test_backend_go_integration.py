@@ -195,9 +195,9 @@ def filter_data() -> list:
 """
         go_code = self.converter.convert_code(python_code)
 
-        assert "mgen.ListComprehension" in go_code
-        assert "mgen.DictComprehension" in go_code
-        assert "mgen.NewRange(" in go_code
+        assert "mgenResult := make([]int, 0, mgen.RangeLen(0, n, 1))" in go_code
+        assert "mgenResult := make(map[int]int, mgen.RangeLen(0, n, 1))" in go_code
+        assert "for _, x := range squares" in go_code
 
     def test_mixed_features_program(self):
         """Test program combining multiple advanced features."""
@@ -227,8 +227,8 @@ def analyze_text(text: str) -> dict:
         assert "mgen.StrOps.Upper" in go_code
 
         # Check comprehensions
-        assert "mgen.DictComprehension" in go_code
-        assert "mgen.ListComprehension" in go_code
+        assert "for _, word := range words" in go_code
+        assert "mgenResult = append(mgenResult" in go_code
 
     def test_control_flow_with_functions(self):
         """Test complex control flow with function calls."""
@@ -338,8 +338,8 @@ def main() -> None:
         # Verify method functionality
         assert "obj.Count +=" in go_code
         assert "mgen.Len" in go_code  # Generic len function
-        assert "mgen.ListComprehension" in go_code
-        assert "mgen.DictComprehension" in go_code
+        assert "mgenResult = append(mgenResult" in go_code
+        assert "mgenResult[" in go_code
 
         # Verify main function
         assert "processor := NewDataProcessor" in go_code
@@ -199,10 +199,25 @@ def test_augassign_in_loop(numbers: list) -> int:
 """
         haskell_code = self.converter.convert_code(python_code)
 
-        # In Haskell, accumulation in loops is implemented using foldl
+        # In Haskell, accumulation in loops is implemented using the strict foldl'
         # This is the idiomatic functional approach
-        assert "total = foldl" in haskell_code
-        assert "acc + (num)" in haskell_code
+        assert "total = foldl' (\\acc num -> acc + (num))" in haskell_code
+        assert "import Data.List (foldl')" in haskell_code
+
+    def test_augmented_assignment_in_main_loop_is_strict(self):
+        """Test that IO-context accumulation forces the accumulator each iteration."""
+        python_code = """
+def main() -> None:
+    total: int = 0
+    for i in range(1000000):
+        total += i
+    print(total)
+"""
+        haskell_code = self.converter.convert_code(python_code)
+
+        assert "{-# LANGUAGE BangPatterns #-}" in haskell_code
+        assert "total <- foldM (\\ !acc i -> return (acc + (i))) total" in haskell_code
+        assert "import qualified Data.Map.Strict as Map" in haskell_code
 
     def test_augmented_assignment_with_attributes(self):
         """Test augmented assignment on object attributes."""
@@ -157,6 +157,28 @@ class TestLLVMBuilder:
         assert isinstance(flags, list)
         assert "-filetype=obj" in flags
 
+    @pytest.mark.skipif(shutil.which("opt") is None, reason="opt not available")
+    def test_pgo_instrumentation_writes_to_profile_dir(self):
+        """Test --pgo-generate adds counters and bakes in the profile output path."""
+        builder = LLVMBackend().get_builder()
+        builder.opt_path = shutil.which("opt")
+        llvm_ir = """
+define i64 @main() {
+entry:
+  ret i64 0
+}
+"""
+
+        with tempfile.TemporaryDirectory() as temp_dir:
+            profile_dir = Path(temp_dir) / "pgo"
+            instrumented = builder._pgo_instrument(llvm_ir, "x86_64-pc-linux-gnu", profile_dir, "prog")
+
+            assert profile_dir.is_dir()
+
+        assert instrumented is not None
+        assert "__profc_main" in instrumented
+        assert f'c"{profile_dir}/prog-%p.profraw\\00"' in instrumented
+
 
 class TestEndToEnd:
     """End-to-end tests for LLVM backend."""
@@ -1354,3 +1354,49 @@ def main() -> int:
             assert "42" in result.stdout
         finally:
             Path(exe_path).unlink(missing_ok=True)
+
+    def test_llvmlite_parallel_partitions(self) -> None:
+        """Test a module split into partitions compiled on separate threads links and runs."""
+        python_code = """
+def is_even(n: int) -> bool:
+    if n == 0:
+        return True
+    return is_odd(n - 1)
+
+def is_odd(n: int) -> bool:
+    if n == 0:
+        return False
+    return is_even(n - 1)
+
+def square(x: int) -> int:
+    return x * x
+
+def main() -> int:
+    if is_even(10):
+        return square(6)
+    return 1
+"""
+        llvm_ir = self._convert_to_llvm(python_code)
+
+        from mgen.backends.llvm import LLVMCompiler
+        from llvmlite import binding as llvm
+        import tempfile
+        compiler = LLVMCompiler()
+
+        # Mutual recursion stays together
+        partitions = compiler.partition_functions(llvm.parse_assembly(llvm_ir), jobs=8)
+        assert len(partitions) >= 3
+        assert any({"is_even", "is_odd"} <= partition for partition in partitions)
+        assert len(compiler.compile_ir_to_objects(llvm_ir, jobs=3)) == 3
+
+        with tempfile.NamedTemporaryFile(suffix="", delete=False) as exe_file:
+            exe_path = exe_file.name
+
+        try:
+            assert compiler.compile_ir_to_executable(llvm_ir, exe_path, jobs=3)
+            import subprocess
+            result = subprocess.run([exe_path], capture_output=True, text=True)
+            assert result.returncode == 36
+        finally:
+            from pathlib import Path
+            Path(exe_path).unlink(missing_ok=True)
@@ -367,4 +367,45 @@ def test_chaining() -> int:
         assert "a += b;" in rust_code
         assert "b *= c;" in rust_code
         assert "c -= 1;" in rust_code
-        assert "a += (b + c);" in rust_code
\ No newline at end of file
+        assert "a += (b + c);" in rust_code
+
+
+class TestRustAugAssignDictUpdates:
+    """Test counting updates use the entry API."""
+
+    def setup_method(self):
+        """Set up test fixtures."""
+        self.converter = MGenPythonToRustConverter()
+
+    def test_membership_counting_moves_dead_key(self):
+        """Test a key computed in the loop body and not read later is moved into entry()."""
+        python_code = """
+def count(text: str) -> dict:
+    counts: dict[str, int] = {}
+    words: list = text.split()
+    for word in words:
+        clean: str = word.lower()
+        if clean in counts:
+            counts[clean] = counts[clean] + 1
+        else:
+            counts[clean] = 1
+    return counts
+"""
+        rust_code = self.converter.convert_code(python_code)
+
+        assert "*counts.entry(clean).or_insert(0) += 1;" in rust_code
+        assert "contains_key" not in rust_code
+
+    def test_get_with_default_clones_live_key(self):
+        """Test a key read after the update is cloned, and the default is kept."""
+        python_code = """
+def tally(keys: list[int]) -> int:
+    c: dict[str, int] = {}
+    name: str = "a"
+    c[name] = c.get(name, 5) + 2
+    print(name)
+    return len(c)
+"""
+        rust_code = self.converter.convert_code(python_code)
+
+        assert "*c.entry(name.clone()).or_insert(5) += 2;" in rust_code
@@ -32,7 +32,7 @@ def greet(name: str):
 """
         rust_code = self.converter.convert_code(python_code)
 
-        assert "fn greet(name: String)" in rust_code
+        assert "fn greet(name: &str)" in rust_code
         assert 'print_value(("Hello, ".to_string() + name))' in rust_code
 
     def test_function_with_multiple_parameters(self):
@@ -65,7 +65,7 @@ def print_message(msg: str) -> None:
 """
         rust_code = self.converter.convert_code(python_code)
 
-        assert "fn print_message(msg: String)" in rust_code  # No return type specified
+        assert "fn print_message(msg: &str)" in rust_code  # No return type specified
         assert "print_value(msg)" in rust_code
 
 
@@ -368,10 +368,39 @@ def process_numbers(numbers: list[int]) -> int:
 """
         rust_code = self.converter.convert_code(python_code)
 
-        # Immutability analysis detects read-only parameter, generates immutable reference
-        assert "fn process_numbers(numbers: &Vec<i32>) -> i32" in rust_code
+        # Immutability analysis detects read-only parameter, generates a borrowed slice
+        assert "fn process_numbers(numbers: &[i32]) -> i32" in rust_code
         assert "let mut total: i32 = 0;" in rust_code
 
+    def test_borrowed_slice_and_str_parameters(self):
+        """Test read-only lists and strings are borrowed as &[T] and &str without cloning at call sites."""
+        python_code = """
+def search(xs: list[int], target: int, lo: int, hi: int) -> int:
+    if lo >= hi:
+        return -1
+    mid: int = (lo + hi) // 2
+    if xs[mid] < target:
+        return search(xs, target, mid + 1, hi)
+    return search(xs, target, lo, mid)
+
+def name_len(word: str) -> int:
+    return len(word)
+
+def main() -> None:
+    xs: list[int] = [1, 2, 3]
+    w: str = "hey"
+    print(search(xs, 2, 0, 3) + name_len(w) + name_len("yo"))
+"""
+        rust_code = self.converter.convert_code(python_code)
+
+        assert "fn search(xs: &[i32], target: i32, lo: i32, hi: i32) -> i32" in rust_code
+        assert "fn name_len(word: &str) -> i32" in rust_code
+        # The recursive call passes the borrow on; literals are already &str
+        assert "search(xs, target, (mid + 1), hi)" in rust_code
+        assert "search(&xs, 2, 0, 3)" in rust_code
+        assert 'name_len(&w)' in rust_code and 'name_len("yo")' in rust_code
+        assert ".clone()" not in rust_code
+
     def test_subscripted_dict_type(self):
         """Test subscripted dict type annotation (Python 3.9+)."""
         python_code = """
@@ -278,4 +278,75 @@ def string_analysis(text: str) -> None:
 
         assert "StrOps::upper(&text)" in rust_code
         assert "StrOps::find(&text" in rust_code
-        assert "StrOps::split(&text)" in rust_code
\ No newline at end of file
+        assert "StrOps::split(&text)" in rust_code
+    def test_intermediate_results_are_borrowed(self):
+        """Test that results only read by another string method are &str or Cow<str>, not new Strings."""
+        python_code = """
+def process_text(text: str) -> str:
+    return text.strip().lower().replace(" ", "_").upper()
+
+def clean(word: str) -> str:
+    return word.lower().strip()
+"""
+        rust_code = self.converter.convert_code(python_code)
+
+        assert (
+            'StrOps::upper(&StrOps::replace_cow(&StrOps::lower_cow(&StrOps::strip_str(&text)), &" ".to_string(), '
+            '&"_".to_string()))' in rust_code
+        )
+        # Stripping first leaves one allocation, for the lowercase copy
+        assert "StrOps::lower(StrOps::strip_str(&word))" in rust_code
+
+    def test_split_words_read_in_place_are_not_collected(self):
+        """Test that loops only reading split() words iterate &str slices of the string."""
+        python_code = """
+def count(text: str, line: str) -> int:
+    total: int = 0
+    words: list = text.split()
+    for word in words:
+        total += len(word.strip())
+    for field in line.split(","):
+        print(field.upper())
+    return total
+
+def keep(text: str) -> list[str]:
+    kept: list[str] = []
+    for word in text.split():
+        kept.append(word)
+    return kept
+"""
+        rust_code = self.converter.convert_code(python_code)
+
+        assert "let words = StrOps::split_iter(&text);" in rust_code
+        assert 'for field in StrOps::split_sep_iter(&line, ",") {' in rust_code
+        # A word stored in a list still needs its own String
+        assert "for word in StrOps::split(&text) {" in rust_code
+
+    def test_fxhash_preference(self):
+        """Test that the fxhash hash_function gives generated maps and sets the runtime's FxHash hasher."""
+        from mgen.backends.preferences import RustPreferences
+
+        python_code = """
+def tally(text: str) -> dict[str, int]:
+    counts: dict[str, int] = {}
+    seen: set[int] = set()
+    for word in text.split():
+        key: str = word.lower()
+        if key in counts:
+            counts[key] = counts[key] + 1
+        else:
+            counts[key] = 1
+    return counts
+"""
+        preferences = RustPreferences()
+        preferences.set("hash_function", "fxhash")
+        rust_code = MGenPythonToRustConverter(preferences).convert_code(python_code)
+
+        assert "-> FxHashMap<String, i32>" in rust_code
+        assert "let mut counts: FxHashMap<String, i32> = FxHashMap::default();" in rust_code
+        assert "FxHashSet::default()" in rust_code
+        assert "std::collections::Hash" not in rust_code
+
+        preferences.set("hash_function", "ahash")
+        with pytest.raises(ValueError, match="hash_function"):
+            MGenPythonToRustConverter(preferences)
@@ -0,0 +1,2880 @@
+"""Tests that compile and run the C runtime containers and helpers directly."""
+
+import os
+import shutil
+import subprocess
+import tempfile
+from pathlib import Path
+from unittest import mock
+
+import pytest
+
+from mgen.backends.c.container_codegen import ContainerCodeGenerator
+
+RUNTIME_DIR = Path(__file__).parent.parent / "src" / "mgen" / "backends" / "c" / "runtime"
+
+pytestmark = pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+
+
+def compile_and_run(source: str, extra_flags: tuple[str, ...] = (), runtime_sources: tuple[str, ...] = ()) -> str:
+    """Compile a C program against the runtime headers and return its stdout."""
+    with tempfile.TemporaryDirectory() as tmpdir:
+        tmp = Path(tmpdir)
+        c_file = tmp / "harness.c"
+        c_file.write_text(source)
+        exe = tmp / "harness"
+
+        cmd = ["gcc", "-std=c11", "-Wall", "-O2", *extra_flags, f"-I{RUNTIME_DIR}", str(c_file)]
+        cmd.extend(str(RUNTIME_DIR / name) for name in ("mgen_error_handling.c", *runtime_sources))
+        cmd.extend(["-o", str(exe)])
+
+        build = subprocess.run(cmd, capture_output=True, text=True)
+        assert build.returncode == 0, build.stderr
+
+        run = subprocess.run([str(exe)], capture_output=True, text=True, timeout=30)
+        assert run.returncode == 0, run.stdout + run.stderr
+        return run.stdout
+
+
+MAP_INT_INT_CHURN = """
+#include <stdio.h>
+#include MAP_HEADER
+
+#define RANGE 50000
+
+int main(void) {
+    map_int_int m = {0};
+    static int ref[RANGE];
+    static bool has[RANGE];
+    unsigned s = 12345;
+
+    for (int it = 0; it < 400000; it++) {
+        s = s * 1103515245u + 12345u;
+        int k = (int)((s >> 8) % RANGE);
+        int key = k - RANGE / 2;
+        int op = (s >> 3) & 3;
+        if (op < 2) {
+            if (map_int_int_insert(&m, key, it) == has[k]) { printf("insert mismatch\\n"); return 1; }
+            has[k] = true;
+            ref[k] = it;
+        } else if (op == 2) {
+            if (map_int_int_remove(&m, key) != has[k]) { printf("remove mismatch\\n"); return 1; }
+            has[k] = false;
+        } else {
+            int* v = map_int_int_get(&m, key);
+            if ((v != NULL) != has[k] || (v && *v != ref[k])) { printf("get mismatch\\n"); return 1; }
+        }
+    }
+
+    size_t live = 0;
+    for (int k = 0; k < RANGE; k++) {
+        live += has[k];
+    }
+    if (live != map_int_int_size(&m)) { printf("size mismatch\\n"); return 1; }
+
+    map_int_int_drop(&m);
+    printf("OK\\n");
+    return 0;
+}
+"""
+
+
+class TestMapIntIntRuntime:
+    """Test the open-addressing map_int_int runtime header."""
+
+    def test_churn_matches_reference(self):
+        """Random insert/update/remove/get sequence agrees with a reference array."""
+        source = MAP_INT_INT_CHURN.replace("MAP_HEADER", '"mgen_map_int_int.h"')
+        assert compile_and_run(source) == "OK\n"
+
+    def test_churn_portable_probing(self):
+        """Scalar group probing (no SIMD) behaves identically."""
+        source = MAP_INT_INT_CHURN.replace("MAP_HEADER", '"mgen_map_int_int.h"')
+        assert compile_and_run(source, extra_flags=("-DMGEN_NO_SIMD",)) == "OK\n"
+
+    def test_reserve_avoids_rehash(self):
+        """Inserts within a reserved capacity reuse the same slot storage."""
+        source = """
+#include <stdio.h>
+#include "mgen_map_int_int.h"
+
+int main(void) {
+    map_int_int m = map_int_int_init();
+    map_int_int_reserve(&m, 1000);
+    mgen_map_int_int_slot_t* slots = m.slots;
+    for (int i = 0; i < 1000; i++) {
+        map_int_int_insert(&m, i * 31, i);
+    }
+    printf("%d %zu %d\\n", m.slots == slots, map_int_int_size(&m), *map_int_int_get(&m, 310));
+    map_int_int_clear(&m);
+    printf("%d %d\\n", map_int_int_empty(&m), map_int_int_contains(&m, 310));
+    map_int_int_drop(&m);
+    return 0;
+}
+"""
+        assert compile_and_run(source) == "1 1000 10\n1 0\n"
+
+    def test_generated_mode_emission_compiles(self):
+        """The inline (generated mode) emission is self-contained and correct."""
+        generated = ContainerCodeGenerator().generate_container("map_int_int")
+        assert generated is not None
+        assert "Generated Container: map_int_int" in generated
+        assert "MGEN_SET_ERROR" not in generated
+
+        prelude = "#include <stdio.h>\n#include <stdlib.h>\n#include <stdbool.h>\n"
+        source = MAP_INT_INT_CHURN.replace("#include MAP_HEADER", generated)
+        assert compile_and_run(prelude + source) == "OK\n"
+
+
+STR_CONTAINERS_CHURN = """
+#include <stdio.h>
+CONTAINER_HEADERS
+
+#define RANGE 5000
+
+int main(void) {
+    map_str_str m = {0};
+    set_str s = {0};
+    static int ref[RANGE];
+    static bool has[RANGE];
+    char key[32];
+    char value[48];
+    unsigned seed = 777;
+
+    for (int it = 0; it < 100000; it++) {
+        seed = seed * 1103515245u + 12345u;
+        int k = (int)((seed >> 8) % RANGE);
+        int op = (seed >> 3) & 3;
+        snprintf(key, sizeof key, "k%d", k * 7919);
+        if (op < 2) {
+            snprintf(value, sizeof value, "value-%d", it % (k + 1) ? it : it * 1000);
+            map_str_str_insert(&m, key, value);
+            if (set_str_insert(&s, key) == has[k]) { printf("set insert mismatch\\n"); return 1; }
+            has[k] = true;
+            ref[k] = it % (k + 1) ? it : it * 1000;
+        } else if (op == 2) {
+            map_str_str_erase(&m, key);
+            if (set_str_erase(&s, key) != has[k]) { printf("set erase mismatch\\n"); return 1; }
+            has[k] = false;
+        } else {
+            char** v = map_str_str_get(&m, key);
+            if ((v != NULL) != has[k] || set_str_contains(&s, key) != has[k]) { printf("lookup mismatch\\n"); return 1; }
+            snprintf(value, sizeof value, "value-%d", ref[k]);
+            if (v && strcmp(*v, value) != 0) { printf("value mismatch\\n"); return 1; }
+        }
+    }
+
+    size_t live = 0;
+    for (int k = 0; k < RANGE; k++) {
+        live += has[k];
+    }
+    if (live != map_str_str_size(&m) || live != set_str_size(&s)) { printf("size mismatch\\n"); return 1; }
+
+    map_str_str_drop(&m);
+    set_str_drop(&s);
+    printf("OK\\n");
+    return 0;
+}
+"""
+
+
+class TestStringContainersRuntime:
+    """Test the arena-backed map_str_str and set_str runtime headers."""
+
+    def test_churn_matches_reference(self):
+        """Insert/update/erase/lookup agree with a reference, including tombstone reuse."""
+        headers = '#include "mgen_map_str_str.h"\n#include "mgen_set_str.h"'
+        source = STR_CONTAINERS_CHURN.replace("CONTAINER_HEADERS", headers)
+        assert compile_and_run(source) == "OK\n"
+
+    def test_arena_uses_few_chunks(self):
+        """Thousands of keys live in a handful of chunks that clear() recycles."""
+        source = """
+#include <stdio.h>
+#include "mgen_map_str_str.h"
+
+int main(void) {
+    map_str_str m = {0};
+    char key[32];
+    for (int i = 0; i < 10000; i++) {
+        snprintf(key, sizeof key, "word%d", i);
+        map_str_str_insert(&m, key, "v");
+    }
+    printf("%zu %d\\n", map_str_str_size(&m), m.arena.chunk_count < 16);
+
+    // Updating with a value that fits reuses the existing arena space
+    size_t chunks = m.arena.chunk_count;
+    for (int i = 0; i < 10000; i++) {
+        snprintf(key, sizeof key, "word%d", i);
+        map_str_str_insert(&m, key, "w");
+    }
+    printf("%d %s\\n", m.arena.chunk_count == chunks, *map_str_str_get(&m, "word42"));
+
+    map_str_str_clear(&m);
+    printf("%zu %zu\\n", map_str_str_size(&m), m.arena.chunk_count);
+    map_str_str_drop(&m);
+    return 0;
+}
+"""
+        assert compile_and_run(source) == "10000 1\n1 w\n0 1\n"
+
+    def test_generated_mode_emission_compiles(self):
+        """Both string containers can be generated into one translation unit."""
+        codegen = ContainerCodeGenerator()
+        generated = codegen.generate_container("map_str_str") + codegen.generate_container("set_str")
+        assert "MGEN_SET_ERROR" not in generated
+
+        prelude = "#include <stdio.h>\n#include <stdlib.h>\n#include <stdbool.h>\n"
+        source = STR_CONTAINERS_CHURN.replace("CONTAINER_HEADERS", generated)
+        assert compile_and_run(prelude + source) == "OK\n"
+
+
+VEC_CSTR_PROGRAM = """
+#include <stdio.h>
+VEC_CSTR_HEADER
+
+int main(void) {
+    vec_cstr words = {0};
+    vec_cstr_extend_split(&words, "  the quick\\tbrown  fox\\n", NULL);
+    vec_cstr_extend_split(&words, "a,,b", ",");
+    vec_cstr_push(&words, "tail");
+    for (size_t i = 0; i < vec_cstr_size(&words); i++) {
+        printf("[%s]", *vec_cstr_at(&words, i));
+    }
+    printf(" %zu\\n", vec_cstr_size(&words));
+
+    // Pointers stay stable while the vector keeps growing
+    char* first = *vec_cstr_at(&words, 0);
+    for (int i = 0; i < 20000; i++) {
+        vec_cstr_push(&words, "word");
+    }
+    printf("%d %s %d\\n", first == *vec_cstr_at(&words, 0), first, words.arena.chunk_count < 16);
+
+    vec_cstr_pop(&words);
+    vec_cstr_clear(&words);
+    vec_cstr_push(&words, "again");
+    printf("%zu %s\\n", vec_cstr_size(&words), *vec_cstr_at(&words, 0));
+    vec_cstr_drop(&words);
+    return 0;
+}
+"""
+
+VEC_CSTR_EXPECTED = "[the][quick][brown][fox][a][][b][tail] 8\n1 the 1\n1 again\n"
+
+
+class TestVecCstrRuntime:
+    """Test the arena-backed vec_cstr runtime header."""
+
+    def test_push_split_and_clear(self):
+        """Split/push store arena copies and vec_cstr_at keeps char** semantics."""
+        source = VEC_CSTR_PROGRAM.replace("VEC_CSTR_HEADER", '#include "mgen_vec_cstr.h"')
+        assert compile_and_run(source) == VEC_CSTR_EXPECTED
+
+    def test_generated_mode_emission_compiles(self):
+        """vec_cstr is emitted from the runtime header alongside other string containers."""
+        codegen = ContainerCodeGenerator()
+        generated = codegen.generate_container("vec_cstr") + codegen.generate_container("set_str")
+
+        prelude = "#include <stdio.h>\n#include <stdlib.h>\n#include <stdbool.h>\n"
+        source = VEC_CSTR_PROGRAM.replace("VEC_CSTR_HEADER", generated)
+        assert compile_and_run(prelude + source) == VEC_CSTR_EXPECTED
+
+
+STRVIEW_PROGRAM = """
+#include <stdio.h>
+#include "mgen_string_ops.h"
+
+int main(void) {
+    const char* text = "  alpha beta\\tgamma  ";
+    mgen_strview_array_t* words = mgen_str_split_views(text, NULL);
+    for (size_t i = 0; i < words->count; i++) {
+        printf("[%.*s]", (int)words->views[i].len, words->views[i].data);
+    }
+    printf(" %d\\n", words->views[0].data == text + 2);
+    mgen_strview_array_free(words);
+
+    mgen_str_splitter_t splitter = mgen_str_splitter_init("a,,b,", ",");
+    const char* field;
+    while ((field = mgen_str_splitter_next(&splitter)) != NULL) {
+        printf("<%s>", field);
+    }
+    mgen_str_splitter_free(&splitter);
+
+    mgen_strview_t stripped = mgen_str_strip_view("  hi  ");
+    mgen_strview_t trimmed = mgen_str_strip_chars_view("xxhixx", "x");
+    printf(" %d %d %d", mgen_strview_eq(stripped, trimmed), mgen_strview_eq_cstr(stripped, "hi"),
+           mgen_strview_eq_cstr(stripped, "hit"));
+    printf(" %d\\n", mgen_strview_hash(stripped) == mgen_strview_hash(mgen_strview_from_cstr("hi")));
+
+    mgen_string_array_t* parts = mgen_str_split("x--y----z", "--");
+    for (size_t i = 0; i < mgen_string_array_size(parts); i++) {
+        printf("(%s)", mgen_string_array_get(parts, i));
+    }
+    printf("\\n");
+    mgen_string_array_free(parts);
+    return 0;
+}
+"""
+
+
+class TestStringViewRuntime:
+    """Test the zero-copy string view API in mgen_string_ops."""
+
+    def test_views_follow_python_split_semantics(self):
+        """Views point into the source and split/strip match Python's str methods."""
+        output = compile_and_run(STRVIEW_PROGRAM, runtime_sources=("mgen_string_ops.c", "mgen_memory_ops.c"))
+        assert output == "[alpha][beta][gamma] 1\n<a><><b><> 1 1 0 1\n(x)(y)()(z)\n"
+
+
+LINE_READER_PROGRAM = """
+#include <stdio.h>
+#include "mgen_file_ops.h"
+
+int main(void) {
+    // Long lines every so often force lines to straddle read blocks
+    FILE* out = fopen(PATH, "w");
+    for (int i = 0; i < 20000; i++) {
+        fprintf(out, "line %d%s\\n", i, i % 997 == 0 ? " ................................................" : "");
+    }
+    fputs("tail", out);
+    fclose(out);
+
+    mgen_file_t* file = mgen_open(PATH, "r");
+    size_t count = 0, bytes = 0, length;
+    const char* line;
+    while ((line = mgen_file_next_line(file, &length)) != NULL) {
+        if (strlen(line) != length) { printf("length mismatch\\n"); return 1; }
+        count++;
+        bytes += length;
+    }
+    printf("%zu %d\\n", count, (long)bytes == mgen_getsize(PATH));
+    mgen_close(file);
+
+    // readline/read/readlines can be mixed on one handle
+    file = mgen_open(PATH, "r");
+    char* first = mgen_readline(file);
+    char* next = mgen_read(file, 6);
+    mgen_string_array_t* rest = mgen_readlines(file);
+    printf("%s[%s] %zu %s\\n", first, next, mgen_string_array_size(rest),
+           mgen_string_array_get(rest, mgen_string_array_size(rest) - 1));
+    free(first);
+    free(next);
+    mgen_string_array_free(rest);
+    mgen_close(file);
+    return 0;
+}
+"""
+
+
+class TestFileLineReaderRuntime:
+    """Test the block-buffered line reader in mgen_file_ops."""
+
+    def test_line_iteration_and_mixed_reads(self, tmp_path):
+        """Lines stream through the block buffer and interleave with read()."""
+        path = tmp_path / "lines.txt"
+        source = LINE_READER_PROGRAM.replace("PATH", f'"{path}"')
+        output = compile_and_run(source, runtime_sources=("mgen_file_ops.c", "mgen_string_ops.c", "mgen_memory_ops.c"))
+        first = "line 0 ................................................\n"
+        assert output == f"20001 1\n{first}[line 1] 20000 tail\n"
+
+    def test_mmap_file_views_contents(self, tmp_path):
+        """mgen_mmap_file maps regular files and copies unmappable ones."""
+        path = tmp_path / "data.txt"
+        path.write_text("alpha beta\ngamma\n")
+        empty = tmp_path / "empty.txt"
+        empty.write_text("")
+        source = f"""
+#include <stdio.h>
+#include "mgen_file_ops.h"
+
+int main(void) {{
+    mgen_mapped_file_t mapped;
+    if (mgen_mmap_file("{path}", &mapped) != MGEN_OK) return 1;
+    size_t lines = 0;
+    for (size_t i = 0; i < mapped.length; i++) {{
+        lines += mapped.data[i] == '\\n';
+    }}
+    printf("%zu %d %zu\\n", mapped.length, mapped.is_mapped, lines);
+    mgen_munmap_file(&mapped);
+
+    if (mgen_mmap_file("{empty}", &mapped) != MGEN_OK) return 1;
+    printf("%zu %d\\n", mapped.length, mgen_strview_eq_cstr(mgen_mapped_file_view(&mapped), ""));
+    mgen_munmap_file(&mapped);
+
+    printf("%d\\n", mgen_mmap_file("{tmp_path}/missing", &mapped) == MGEN_ERROR_FILE_NOT_FOUND);
+    return 0;
+}}
+"""
+        output = compile_and_run(source, runtime_sources=("mgen_file_ops.c", "mgen_string_ops.c", "mgen_memory_ops.c"))
+        assert output == "17 1 2\n0 1\n1\n"
+
+
+CSV_READER_PROGRAM = """
+#include <stdio.h>
+#include "mgen_file_ops.h"
+
+int main(void) {
+    FILE* out = fopen(PATH, "w");
+    fputs("id,name,score\\r\\n", out);
+    fputs("1,\\"Smith, J\\",3.5\\n", out);
+    fputs("\\n", out);
+    fputs("2,\\"say \\"\\"hi\\"\\"\\",-0.25e2\\n", out);
+    fputs("3,\\"two\\nlines\\",7\\n", out);
+    fputs("4,5\\" disk,,\\n", out);
+    for (int i = 0; i < 3000; i++) {
+        fprintf(out, "%d,field number %d with some padding,%d.%d\\n", i, i, i, i % 10);
+    }
+    fputs("last,\\"open", out);
+    fclose(out);
+
+    mgen_file_t* file = mgen_open(PATH, "r");
+    mgen_csv_reader_t reader = mgen_csv_reader_init(file, ',');
+    for (int record = 0; record < 6 && mgen_csv_reader_next(&reader); record++) {
+        printf("%zu:", reader.field_count);
+        for (size_t i = 0; i < reader.field_count; i++) {
+            printf("[%.*s]", (int)reader.fields[i].len, reader.fields[i].data);
+        }
+        printf("\\n");
+    }
+    long long ids = 0;
+    double scores = 0;
+    size_t records = 0;
+    while (mgen_csv_reader_next(&reader)) {
+        long long id;
+        double score;
+        if (reader.field_count == 3 && mgen_csv_parse_int(reader.fields[0], &id) &&
+            mgen_csv_parse_double(reader.fields[2], &score)) {
+            ids += id;
+            scores += score;
+        } else {
+            mgen_clear_error();
+            printf("%zu:[%.*s][%.*s]\\n", reader.field_count, (int)reader.fields[0].len, reader.fields[0].data,
+                   (int)reader.fields[1].len, reader.fields[1].data);
+        }
+        records++;
+    }
+    printf("%zu %lld %.1f\\n", records, ids, scores);
+    mgen_csv_reader_free(&reader);
+    mgen_close(file);
+
+    const char* ints[] = {" 42 ", "-9223372036854775808", "9223372036854775808", "+7", "1x", "", "-"};
+    for (int i = 0; i < 7; i++) {
+        long long value = 0;
+        bool ok = mgen_csv_parse_int(mgen_strview_from_cstr(ints[i]), &value);
+        printf("%d:%lld ", ok, value);
+        mgen_clear_error();
+    }
+    printf("\\n");
+    const char* doubles[] = {"0.1", "-2.5e-3", "1e22", "123456789012345678901", "1e-400", "inf",
+                             ".5", "5.", "e5", "1e", " 3 "};
+    for (int i = 0; i < 11; i++) {
+        double value = 0;
+        bool ok = mgen_csv_parse_double(mgen_strview_from_cstr(doubles[i]), &value);
+        printf("%d:%.17g ", ok, value);
+        mgen_clear_error();
+    }
+    printf("\\n");
+    return 0;
+}
+"""
+
+
+class TestCsvReaderRuntime:
+    """Test the streaming record reader and field parsers in mgen_file_ops."""
+
+    EXPECTED_RECORDS = (
+        "3:[id][name][score]\n3:[1][Smith, J][3.5]\n0:\n3:[2][say \"hi\"][-0.25e2]\n"
+        "3:[3][two\nlines][7]\n4:[4][5\" disk][][]\n2:[last][open]\n3001 4498500 4499850.0\n"
+    )
+    EXPECTED_NUMBERS = (
+        "1:42 1:-9223372036854775808 0:0 1:7 0:0 0:0 0:0 \n"
+        "1:0.10000000000000001 1:-0.0025000000000000001 1:1e+22 1:1.2345678901234568e+20 1:0 1:inf 1:0.5 1:5 "
+        "0:0 0:1 1:3 \n"
+    )
+
+    def test_records_and_fields(self, tmp_path):
+        """Quoted, escaped, multi-line and blank records split like csv.reader; fields parse exactly."""
+        source = CSV_READER_PROGRAM.replace("PATH", f'"{tmp_path / "data.csv"}"')
+        output = compile_and_run(source, runtime_sources=("mgen_file_ops.c", "mgen_string_ops.c", "mgen_memory_ops.c"))
+        assert output == self.EXPECTED_RECORDS + self.EXPECTED_NUMBERS
+
+    def test_portable_delimiter_scan(self, tmp_path):
+        """The scalar delimiter scan splits records the same way."""
+        source = CSV_READER_PROGRAM.replace("PATH", f'"{tmp_path / "data.csv"}"')
+        output = compile_and_run(
+            source,
+            extra_flags=("-DMGEN_ASCII_NO_SIMD",),
+            runtime_sources=("mgen_file_ops.c", "mgen_string_ops.c", "mgen_memory_ops.c"),
+        )
+        assert output == self.EXPECTED_RECORDS + self.EXPECTED_NUMBERS
+
+
+WRITE_BEHIND_PROGRAM = """
+#include <stdio.h>
+#include "mgen_file_ops.h"
+
+int main(void) {
+    mgen_file_t* file = mgen_open(PATH, "w");
+    if (mgen_file_write_behind(file, 4096) != MGEN_OK) return 1;
+    char line[64];
+    size_t expected = 0;
+    for (int i = 0; i < 200000; i++) {
+        int n = snprintf(line, sizeof(line), "%d,%d\\n", i, i * 31);
+        if (mgen_write(file, line) != n) return 2;
+        expected += (size_t)n;
+    }
+    // Larger than both buffers together
+    static char big[20000];
+    memset(big, 'z', sizeof(big) - 1);
+    mgen_write(file, big);
+    expected += sizeof(big) - 1;
+    mgen_error_t flushed = mgen_flush(file);
+    printf("%d %d\\n", flushed == MGEN_OK, (size_t)mgen_getsize(PATH) == expected);
+    mgen_write(file, "end\\n");
+    printf("%d\\n", mgen_close(file) == MGEN_OK);
+
+    char* text = mgen_read_file(PATH);
+    size_t lines = 0;
+    for (char* p = text; *p; p++) lines += *p == '\\n';
+    printf("%zu %.12s %s", lines, text + 1288880, text + strlen(text) - 8);
+    free(text);
+
+    // Background write errors surface at the barrier
+    file = mgen_open("/dev/full", "w");
+    mgen_file_write_behind(file, 0);
+    for (int i = 0; i < 1000; i++) mgen_write(file, "0123456789abcdef0123456789abcdef0123456789abcdef");
+    flushed = mgen_flush(file);
+    printf("\\n%d %s\\n", flushed != MGEN_OK, mgen_error_name(mgen_get_last_error()));
+    mgen_clear_error();
+    mgen_close(file);
+    return 0;
+}
+"""
+
+
+class TestWriteBehindRuntime:
+    """Test write-behind output through mgen_file_write_behind."""
+
+    @pytest.mark.skipif(not os.path.exists("/dev/full"), reason="needs /dev/full")
+    def test_writes_flush_and_close_in_order(self, tmp_path):
+        """Buffered writes reach the file in order at the flush and close barriers; errors surface there."""
+        source = WRITE_BEHIND_PROGRAM.replace("PATH", f'"{tmp_path / "out.csv"}"')
+        output = compile_and_run(
+            source,
+            extra_flags=("-pthread",),
+            runtime_sources=("mgen_file_ops.c", "mgen_string_ops.c", "mgen_memory_ops.c"),
+        )
+        assert output == "1 1\n1\n200001 6\n95417,2957 zzzzend\n\n1 RuntimeError\n"
+
+
+ERROR_THREADS_PROGRAM = """
+#include <pthread.h>
+#include <stdio.h>
+#include "mgen_error_handling.h"
+
+static void* worker(void* arg) {
+    int id = *(int*)arg;
+    for (int i = 0; i < 100000; i++) {
+        if (i % 2) {
+            MGEN_SET_ERROR_FMT(MGEN_ERROR_INDEX, "thread %d", id);
+        } else {
+            MGEN_SET_ERROR(MGEN_ERROR_KEY, "static message");
+        }
+    }
+    // Last iteration formatted this thread's own message
+    char expected[32];
+    snprintf(expected, sizeof expected, "thread %d", id);
+    return (void*)(long)(mgen_get_last_error() == MGEN_ERROR_INDEX && strcmp(mgen_get_last_error_message(), expected) == 0);
+}
+
+int main(void) {
+    pthread_t threads[4];
+    int ids[4] = {0, 1, 2, 3};
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, worker, &ids[i]);
+    }
+    int ok = 1;
+    for (int i = 0; i < 4; i++) {
+        void* result;
+        pthread_join(threads[i], &result);
+        ok &= result != NULL;
+    }
+
+    // The main thread never raised anything
+    printf("%d %d\\n", ok, mgen_has_error());
+    MGEN_SET_ERROR(MGEN_ERROR_VALUE, "literal");
+    printf("%s %s\\n", mgen_error_name(mgen_get_last_error()), mgen_get_last_error_message());
+    mgen_clear_error();
+    printf("%d [%s]\\n", mgen_has_error(), mgen_get_last_error_message());
+    return 0;
+}
+"""
+
+
+class TestErrorHandlingRuntime:
+    """Test the per-thread error context."""
+
+    def test_error_context_is_thread_local(self):
+        """Each thread sees only the errors it raised itself."""
+        output = compile_and_run(ERROR_THREADS_PROGRAM, extra_flags=("-pthread",))
+        assert output == "1 0\nValueError literal\n0 []\n"
+
+
+EXCEPTION_PROGRAM = """
+#include <pthread.h>
+#include <stdio.h>
+#include "mgen_python_ops.h"
+
+static int parse_digit(int c) {
+    mgen_assert_return(c >= '0' && c <= '9', "not a digit", -1);
+    return c - '0';
+}
+
+// Each frame checks once after the call and unwinds with the exception still set
+static int parse_pair(const char* s) {
+    int high = parse_digit(s[0]);
+    MGEN_PROPAGATE(-1);
+    int low = parse_digit(s[1]);
+    MGEN_PROPAGATE(-1);
+    return high * 10 + low;
+}
+
+static void* worker(void* arg) {
+    (void)arg;
+    mgen_raise_exception(MGEN_ERROR_KEY, "worker");
+    return (void*)(long)(mgen_get_exception()->type == MGEN_ERROR_KEY);
+}
+
+int main(void) {
+    int ok = parse_pair("42");
+    printf("%d %d\\n", ok, mgen_has_exception());
+    int bad = parse_pair("4x");
+    printf("%d %d %s\\n", bad, mgen_has_exception(), mgen_get_exception()->message);
+    mgen_clear_exception();
+
+    pthread_t thread;
+    void* raised;
+    pthread_create(&thread, NULL, worker, NULL);
+    pthread_join(thread, &raised);
+    // The worker's exception stays on the worker's thread
+    printf("%d %d\\n", raised != NULL, mgen_has_exception());
+    return 0;
+}
+"""
+
+
+class TestExceptionRuntime:
+    """Test status-return exception propagation and the per-thread exception slot."""
+
+    def test_propagation_and_thread_local_slot(self):
+        """Raises unwind through MGEN_PROPAGATE frames and never leak across threads."""
+        output = compile_and_run(EXCEPTION_PROGRAM, extra_flags=("-pthread",), runtime_sources=("mgen_python_ops.c",))
+        assert output == "42 0\n-1 1 not a digit\n1 0\n"
+
+
+MEMORY_POOL_PROGRAM = """
+#include <stdio.h>
+#include <stdint.h>
+#include "mgen_set_int.h"
+#include "mgen_str_int_map.h"
+
+int main(void) {
+    mgen_memory_pool_t* pool = mgen_memory_pool_new(256);
+    int* first = mgen_memory_pool_alloc(pool, sizeof(int));
+    *first = 42;
+    int aligned = 1;
+    for (int i = 0; i < 10000; i++) {
+        void* p = mgen_memory_pool_alloc(pool, (size_t)(i % 40) + 1);
+        aligned &= ((uintptr_t)p % MGEN_POOL_ALIGNMENT) == 0;
+    }
+    void* big = mgen_memory_pool_alloc_aligned(pool, 100000, 64);
+    aligned &= ((uintptr_t)big % 64) == 0;
+    // Earlier blocks never move while the pool grows
+    printf("%d %d\\n", *first, aligned);
+
+    void* a = mgen_memory_pool_alloc(pool, 24);
+    mgen_memory_pool_release(pool, a, 24);
+    printf("%d\\n", mgen_memory_pool_alloc(pool, 17) == a);
+    mgen_memory_pool_reset(pool);
+
+    set_int s = set_int_init_with_pool(pool);
+    mgen_str_int_map_t* m = mgen_str_int_map_new_with_pool(pool);
+    char key[16];
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 1000; i++) {
+            set_int_insert(&s, i);
+            snprintf(key, sizeof key, "k%d", i);
+            mgen_str_int_map_insert(m, key, i);
+        }
+        for (int i = 0; i < 1000; i += 2) {
+            set_int_remove(&s, i);
+            snprintf(key, sizeof key, "k%d", i);
+            mgen_str_int_map_remove(m, key);
+        }
+    }
+    printf("%zu %zu %d %d\\n", set_int_size(&s), mgen_str_int_map_size(m), set_int_contains(&s, 7), *mgen_str_int_map_get(m, "k7"));
+    set_int_drop(&s);
+    mgen_str_int_map_free(m);
+    mgen_memory_pool_free(pool);
+    return 0;
+}
+"""
+
+
+class TestMemoryPoolRuntime:
+    """Test the chunked, size-class memory pool and the containers that use it."""
+
+    def test_pool_blocks_are_stable_aligned_and_recycled(self):
+        """Growth never moves blocks, released blocks are reused, pooled containers work."""
+        output = compile_and_run(MEMORY_POOL_PROGRAM, runtime_sources=("mgen_memory_ops.c",))
+        assert output == "42 1\n1\n500 500 1 7\n"
+
+
+SCOPE_STRINGS_PROGRAM = """
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_string_ops.h"
+
+int main(void) {
+    mgen_scope_allocator_t* scope = mgen_scope_new();
+    char* out = "";
+    for (int i = 0; i < 2000; i++) {
+        out = mgen_scope_str_concat(scope, out, mgen_scope_int_to_string(scope, i % 10));
+    }
+    char* label = mgen_scope_sprintf_string(scope, "%s=%s", "pi", mgen_scope_float_to_string(scope, 3.5));
+    char* kept = mgen_strdup(out);
+    printf("%zu %c%c %s\\n", strlen(out), out[0], out[1999], label);
+    mgen_scope_free(scope);
+    printf("%zu\\n", strlen(kept));
+    free(kept);
+    return 0;
+}
+"""
+
+
+class TestScopeStringRuntime:
+    """Test the scope-allocated string helpers used for function-local temporaries."""
+
+    def test_scope_strings_survive_until_scope_free(self):
+        """Scoped temporaries stay valid for the scope's lifetime and copies outlive it."""
+        output = compile_and_run(SCOPE_STRINGS_PROGRAM, runtime_sources=("mgen_string_ops.c", "mgen_memory_ops.c"))
+        assert output == "2000 09 pi=3.5\n2000\n"
+
+
+ALLOC_PROFILE_PROGRAM = """
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "mgen_memory_ops.h"
+#include "mgen_vec_int.h"
+
+static void* worker(void* arg) {
+    (void)arg;
+    vec_int v = {0};
+    for (int i = 0; i < 1000; i++) {
+        vec_int_push(&v, i);
+    }
+    vec_int_drop(&v);
+    for (int i = 0; i < 100; i++) {
+        void* p = MGEN_MALLOC(24);
+        mgen_free(&p);
+    }
+    return NULL;
+}
+
+int main(void) {
+    mgen_alloc_profile_enable(1);
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    mgen_alloc_site_t sites[8];
+    size_t count = mgen_alloc_profile_snapshot(sites, 8);
+    for (size_t i = 0; i < count; i++) {
+        const char* base = strrchr(sites[i].file, '/');
+        printf("%s %zu %zu %zu\\n", base ? base + 1 : sites[i].file, sites[i].count, sites[i].bytes,
+               sites[i].histogram[1]);
+    }
+
+    mgen_alloc_profile_reset();
+    mgen_alloc_profile_enable(10);
+    for (int i = 0; i < 1000; i++) {
+        void* p = MGEN_MALLOC(100);
+        mgen_free(&p);
+    }
+    mgen_alloc_profile_dump(stdout);
+    return 0;
+}
+"""
+
+
+class TestAllocationProfilerRuntime:
+    """Test the per-call-site sampling allocation profiler."""
+
+    def test_sites_are_counted_across_threads_and_sampled(self):
+        """Sites aggregate atomically across threads; sampled counts are scaled by the interval."""
+        output = compile_and_run(
+            ALLOC_PROFILE_PROGRAM,
+            extra_flags=("-pthread", "-DMGEN_ALLOC_PROFILE"),
+            runtime_sources=("mgen_memory_ops.c", "mgen_alloc_profile.c"),
+        )
+        lines = output.splitlines()
+        assert lines[:2] == ["harness.c 400 9600 400", "mgen_vec_int.h 32 32640 4"]
+        assert lines[2:4] == ["# mgen allocation profile v1", "# sample_interval 10"]
+        assert lines[4].startswith("# site\tallocs\tbytes\t<=16 <=32")
+        assert len(lines) == 6
+        site, allocs, size, histogram = lines[5].split("\t")
+        assert site.startswith("harness.c:")
+        assert (allocs, size) == ("1000", "100000")
+        assert histogram.split() == ["0", "0", "0", "1000"] + ["0"] * 8
+
+
+BUFFER_PROGRAM = """
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "mgen_string_ops.h"
+
+int main(void) {
+    mgen_buffer_t buf;
+    mgen_buffer_init(&buf, mgen_buffer_capacity_hint(-5, 10));
+    mgen_buffer_reserve(&buf, 1000);
+    size_t reserved = buf.capacity;
+    for (int i = -3; i < 1000; i++) {
+        mgen_buffer_append_int(&buf, i);
+    }
+    printf("%d %zu\\n", reserved >= 1001, mgen_buffer_size(&buf));
+    mgen_buffer_clear(&buf);
+
+    long long ints[] = {0, 7, -42, 1234567890123LL, LLONG_MIN};
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        mgen_buffer_append_int(&buf, ints[i]);
+        mgen_buffer_append_char(&buf, ' ');
+    }
+    double floats[] = {3.0, -0.0, 2.5, 1e6, 123456.7, -1e-5, 0.1};
+    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%g", floats[i]);
+        size_t before = mgen_buffer_size(&buf);
+        mgen_buffer_append_float(&buf, floats[i]);
+        if (strcmp(mgen_buffer_cstr(&buf) + before, expected) != 0) {
+            printf("float mismatch %s\\n", expected);
+        }
+        mgen_buffer_append_char(&buf, ' ');
+    }
+
+    const char* data = buf.data;
+    char* owned = mgen_buffer_detach(&buf);
+    printf("%d %s\\n", owned == data, owned);
+    free(owned);
+
+    char* empty = mgen_buffer_detach(&buf);
+    printf("[%s] %zu\\n", empty, buf.capacity);
+    free(empty);
+    mgen_buffer_destroy(&buf);
+
+    mgen_string_array_t* parts = mgen_str_split("a,,b,c", ",");
+    char* joined = mgen_join("--", parts);
+    printf("%s\\n", joined);
+    free(joined);
+    mgen_string_array_free(parts);
+    return 0;
+}
+"""
+
+
+class TestBufferRuntime:
+    """Test mgen_buffer_t growth, number formatting and zero-copy detach."""
+
+    def test_reserve_format_and_detach(self):
+        """Reserved buffers do not regrow, numbers match printf, detach hands over the bytes."""
+        output = compile_and_run(BUFFER_PROGRAM, runtime_sources=("mgen_string_ops.c", "mgen_memory_ops.c"))
+        assert output == (
+            "1 2896\n"
+            "1 0 7 -42 1234567890123 -9223372036854775808 3 -0 2.5 1e+06 123457 -1e-05 0.1 \n"
+            "[] 0\n"
+            "a----b--c\n"
+        )
+
+
+REFCOUNT_PROGRAM = """
+#include <pthread.h>
+#include <stdio.h>
+#include "mgen_memory_ops.h"
+
+static int destroyed = 0;
+
+static void on_destroy(void* data) {
+    (void)data;
+    destroyed++;
+}
+
+static void* worker(void* arg) {
+    mgen_refcounted_t* obj = arg;
+    for (int i = 0; i < 100000; i++) {
+        mgen_refcounted_retain_atomic(obj);
+        mgen_refcounted_release_atomic(obj);
+    }
+    mgen_refcounted_release_atomic(obj);
+    return NULL;
+}
+
+int main(void) {
+    mgen_refcounted_t* local = mgen_refcounted_new(sizeof(int), on_destroy);
+    mgen_refcounted_retain(local);
+    mgen_refcounted_release(local);
+    printf("%d %d\\n", mgen_refcounted_count(local), destroyed);
+    mgen_refcounted_release(local);
+
+    mgen_refcounted_t* shared = mgen_refcounted_new(sizeof(int), on_destroy);
+    mgen_weak_ref_t weak = mgen_refcounted_downgrade(shared);
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        mgen_refcounted_retain_atomic(shared);
+        pthread_create(&threads[i], NULL, worker, shared);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    printf("%d %d\\n", mgen_refcounted_count(shared), destroyed);
+
+    mgen_refcounted_t* upgraded = mgen_refcounted_upgrade(weak);
+    printf("%d %d\\n", mgen_refcounted_count(upgraded), destroyed);
+    mgen_refcounted_release_atomic(upgraded);
+    mgen_refcounted_release_atomic(shared);
+    printf("%d %d\\n", mgen_refcounted_upgrade(weak) == NULL, destroyed);
+    mgen_weak_ref_release(weak);
+    return 0;
+}
+"""
+
+
+class TestRefcountedRuntime:
+    """Test the plain and atomic reference counting variants and weak references."""
+
+    def test_atomic_refcounts_and_weak_upgrade(self):
+        """Atomic retain/release survives contention; weak upgrade fails after the last release."""
+        output = compile_and_run(
+            REFCOUNT_PROGRAM, extra_flags=("-pthread",), runtime_sources=("mgen_memory_ops.c",)
+        )
+        assert output == "1 0\n1 1\n2 1\n1 2\n"
+
+
+REDUCTION_PROGRAM = """
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "mgen_python_ops.h"
+
+int main(void) {
+    size_t n = 100003;
+    int* ints = malloc(n * sizeof(int));
+    double* floats = malloc(n * sizeof(double));
+    unsigned s = 7;
+    for (size_t i = 0; i < n; i++) {
+        s = s * 1103515245u + 12345u;
+        ints[i] = (int)((s >> 8) % 2001) - 1000;
+        floats[i] = (double)((s >> 4) % 100000) / 7.0 - 5000.0;
+    }
+    ints[n / 2] = -5000;
+    ints[n - 1] = 7000;
+    floats[3] = NAN;
+
+    printf("%d %d %d\\n", mgen_min_int_array(ints, n), mgen_max_int_array(ints, n), mgen_sum_int_array(ints, n));
+    printf("%.17g %.17g\\n", mgen_min_float_array(floats, n), mgen_max_float_array(floats, n));
+    for (size_t k = 1; k <= 40; k++) {
+        printf("%d %d %.17g|", mgen_max_int_array(ints, k), mgen_sum_int_array(ints, k),
+               mgen_sum_float_array(floats + 4, k));
+    }
+    printf("\\n");
+
+    // Signed zeros: the first zero wins; all-NaN input gives NaN
+    double zeros[12] = {1, 0.0, -0.0, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    double nans[9] = {NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN};
+    printf("%d %d\\n", signbit(mgen_min_float_array(zeros, 12)) == 0, isnan(mgen_max_float_array(nans, 9)) != 0);
+
+    // Partial sums may leave int range as long as the total fits
+    int swing[20];
+    for (int i = 0; i < 20; i++) {
+        swing[i] = (i % 2) ? -2000000000 : 2000000000;
+    }
+    swing[19] = -1999999995;
+    int big[2] = {2000000000, 2000000000};
+    int total = mgen_sum_int_array(swing, 20);
+    printf("%d %d\\n", total, mgen_sum_int_array(big, 2) == 0 && mgen_has_exception());
+
+    // 0.1 is inexact: one million additions drift under sequential summation
+    size_t m = 1000000;
+    double* tenths = malloc(m * sizeof(double));
+    for (size_t i = 0; i < m; i++) {
+        tenths[i] = 0.1;
+    }
+    printf("%d %d\\n", fabs(mgen_sum_float_array(tenths, m) - 100000.0) < 1e-9,
+           mgen_sum_float_array_compensated(tenths, m) == 100000.0);
+    free(tenths);
+    free(floats);
+    free(ints);
+    return 0;
+}
+"""
+
+
+class TestArrayReductionRuntime:
+    """Test the vectorized min/max/sum array kernels against the scalar fallback."""
+
+    def test_simd_and_scalar_paths_agree(self):
+        """Dispatched kernels give bit-identical results to the MGEN_NO_SIMD build."""
+        simd = compile_and_run(REDUCTION_PROGRAM, runtime_sources=("mgen_python_ops.c",))
+        scalar = compile_and_run(
+            REDUCTION_PROGRAM, extra_flags=("-DMGEN_NO_SIMD",), runtime_sources=("mgen_python_ops.c",)
+        )
+        assert simd == scalar
+        lines = simd.splitlines()
+        assert lines[0].startswith("-5000 7000 ")
+        assert lines[3:] == ["1 1", "5 1", "1 1"]
+
+
+VEC_BULK_PROGRAM = """
+#include <stdio.h>
+#include "mgen_vec_int.h"
+#include "mgen_vec_double.h"
+
+static int triple(int x) {
+    return 3 * x;
+}
+
+static void print_vec(const vec_int* v) {
+    for (size_t i = 0; i < v->size; i++) {
+        printf(i ? " %d" : "%d", v->data[i]);
+    }
+    printf("\\n");
+}
+
+int main(void) {
+    vec_int v = {0};
+    int* out = vec_int_resize_uninitialized(&v, 5);
+    for (int i = 0; i < 5; i++) {
+        out[i] = i;
+    }
+    printf("%zu %zu\\n", v.size, v.capacity);
+
+    int more[3] = {10, 11, 12};
+    vec_int_extend_from_array(&v, more, 3);
+    vec_int_extend_from_array(&v, v.data, 4);
+    print_vec(&v);
+
+    vec_int_insert_range(&v, 1, more, 2);
+    vec_int_insert_range(&v, 0, v.data + 10, 3);
+    print_vec(&v);
+
+    vec_int slice = vec_int_copy_range(&v, 2, 100);
+    vec_int_map_inplace(&slice, triple);
+    print_vec(&slice);
+    vec_int empty = vec_int_copy_range(&v, 8, 3);
+    printf("%zu\\n", empty.size);
+
+    vec_int_fill(&v, 4, 7);
+    print_vec(&v);
+
+    vec_double d = {0};
+    vec_double_fill(&d, 1000, 0.5);
+    double total = 0;
+    for (size_t i = 0; i < d.size; i++) {
+        total += d.data[i];
+    }
+    printf("%zu %g\\n", d.capacity, total);
+
+    vec_int_drop(&empty);
+    vec_int_drop(&slice);
+    vec_int_drop(&v);
+    vec_double_drop(&d);
+    return 0;
+}
+"""
+
+
+class TestVecBulkRuntime:
+    """Test the bulk vec_int/vec_double operations used by sized comprehensions."""
+
+    def test_bulk_operations(self):
+        """Bulk appends, inserts (including from the vector itself), ranges, fill and map."""
+        output = compile_and_run(VEC_BULK_PROGRAM)
+        assert output.splitlines() == [
+            "5 5",
+            "0 1 2 3 4 10 11 12 0 1 2 3",
+            "0 1 2 0 10 11 1 2 3 4 10 11 12 0 1 2 3",
+            "6 0 30 33 3 6 9 12 30 33 36 0 3 6 9",
+            "0",
+            "7 7 7 7",
+            "1000 500",
+        ]
+
+
+MAT_PROGRAM = """
+#include <stdio.h>
+#include "mgen_mat_int.h"
+#include "mgen_mat_double.h"
+
+int main(void) {
+    mat_int m = {0};
+    int row[5];
+    for (int i = 0; i < 20; i++) {
+        for (int j = 0; j < 5; j++) {
+            row[j] = i * 10 + j;
+        }
+        mat_int_append_row(&m, row, 5);
+    }
+    printf("%zu %zu %d %d\\n", mat_int_rows(&m), mat_int_cols(&m), *mat_int_at(&m, 19, 4), mat_int_row(&m, 3)[2]);
+
+    mat_int_append_row(&m, row, 4);
+    printf("%d %zu\\n", mgen_get_last_error() == MGEN_ERROR_VALUE, mat_int_rows(&m));
+    mgen_clear_error();
+    printf("%d\\n", mat_int_at(&m, 0, 5) == NULL && mgen_get_last_error() == MGEN_ERROR_INDEX);
+    mgen_clear_error();
+
+    mat_int view = mat_int_view(&m, 2, 1, 3, 3);
+    *mat_int_at(&view, 0, 0) = -1;
+    printf("%zu %zu %d %d\\n", view.stride, view.cols, *mat_int_at(&view, 2, 2), *mat_int_at(&m, 2, 1));
+
+    // Odd sizes cross tile boundaries; compare against the naive triple loop
+    size_t n = 70, inner = 131, p = 67;
+    mat_int a = mat_int_new(n, inner, 0);
+    mat_int b = mat_int_new(inner, p, 0);
+    for (size_t i = 0; i < n; i++)
+        for (size_t k = 0; k < inner; k++)
+            *mat_int_at(&a, i, k) = (int)((i * 7 + k * 3) % 11) - 5;
+    for (size_t k = 0; k < inner; k++)
+        for (size_t j = 0; j < p; j++)
+            *mat_int_at(&b, k, j) = (int)((k * 5 + j) % 13) - 6;
+    mat_int c = mat_int_matmul(&a, &b);
+    int mismatches = 0;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < p; j++) {
+            int expected = 0;
+            for (size_t k = 0; k < inner; k++)
+                expected += *mat_int_at(&a, i, k) * *mat_int_at(&b, k, j);
+            mismatches += expected != *mat_int_at(&c, i, j);
+        }
+    }
+    printf("%zu %zu %d\\n", mat_int_rows(&c), mat_int_cols(&c), mismatches);
+
+    mat_int bad = mat_int_matmul(&a, &a);
+    printf("%d %zu\\n", mgen_get_last_error() == MGEN_ERROR_VALUE, mat_int_rows(&bad));
+    mgen_clear_error();
+
+    mat_int sub = mat_int_view(&a, 1, 1, 2, 2);
+    mat_int sub_sq = mat_int_matmul(&sub, &sub);
+    int a11 = *mat_int_at(&a, 1, 1), a12 = *mat_int_at(&a, 1, 2), a21 = *mat_int_at(&a, 2, 1);
+    printf("%d\\n", *mat_int_at(&sub_sq, 0, 0) == a11 * a11 + a12 * a21);
+
+    mat_double d = mat_double_new(2, 3, 1.5);
+    mat_double e = mat_double_new(3, 2, 2.0);
+    mat_double f = mat_double_matmul(&d, &e);
+    printf("%g %zu\\n", *mat_double_at(&f, 1, 1), mat_double_cols(&f));
+
+    mat_int_drop(&view);
+    mat_int_drop(&m);
+    mat_int_drop(&a);
+    mat_int_drop(&b);
+    mat_int_drop(&c);
+    mat_int_drop(&sub_sq);
+    mat_double_drop(&d);
+    mat_double_drop(&e);
+    mat_double_drop(&f);
+    return 0;
+}
+"""
+
+
+class TestMatrixRuntime:
+    """Test the row-major mat_int/mat_double matrices."""
+
+    def test_matrix_operations(self):
+        """Rows, bounds checks, strided views and tiled multiplication."""
+        output = compile_and_run(MAT_PROGRAM)
+        assert output.splitlines() == [
+            "20 5 194 32",
+            "1 20",
+            "1",
+            "5 3 43 -1",
+            "70 67 0",
+            "1 0",
+            "1",
+            "9 2",
+        ]
+
+
+SET_INT_DISTRIBUTION_PROGRAM = """
+#include <stdio.h>
+#include "mgen_set_int.h"
+
+// Insert n keys base + i * stride, check membership and report the table shape
+static void run(const char* name, int base, int stride, int n) {
+    set_int s = {0};
+    for (int i = 0; i < n; i++) {
+        set_int_insert(&s, base + i * stride);
+    }
+    int missing = 0, extra = 0;
+    for (int i = 0; i < n; i++) {
+        missing += !set_int_contains(&s, base + i * stride);
+        extra += set_int_contains(&s, base + i * stride + 1) && stride > 1;
+    }
+
+    size_t max_chain = 0;
+    for (size_t b = 0; b < s.bucket_count; b++) {
+        size_t chain = 0;
+        for (mgen_set_int_entry_t* e = s.buckets[b]; e; e = e->next) {
+            chain++;
+        }
+        max_chain = chain > max_chain ? chain : max_chain;
+    }
+    int power_of_two = (s.bucket_count & (s.bucket_count - 1)) == 0;
+    printf("%s %zu %d %d %d %d\\n", name, set_int_size(&s), missing, extra, power_of_two,
+           s.bucket_count >= set_int_size(&s) && max_chain <= 12);
+    set_int_drop(&s);
+}
+
+int main(void) {
+    run("seq", 0, 1, 100000);
+    run("stride16", 0, 16, 100000);
+    run("stride4096", 3, 4096, 100000);
+    run("negative", -1, -7, 100000);
+
+    set_int s = set_int_init();
+    for (int i = 0; i < 5000; i++) {
+        set_int_insert(&s, i << 16);
+    }
+    for (int i = 0; i < 5000; i += 2) {
+        set_int_remove(&s, i << 16);
+    }
+    int ok = set_int_size(&s) == 2500;
+    for (int i = 0; i < 5000; i++) {
+        ok &= set_int_contains(&s, i << 16) == (i % 2 == 1);
+    }
+    printf("%d\\n", ok);
+    set_int_drop(&s);
+    return 0;
+}
+"""
+
+
+class TestSetIntRuntime:
+    """Test the Fibonacci-hashed set_int table."""
+
+    def test_key_distributions(self):
+        """Sequential, strided and negative keys grow the table and keep chains short."""
+        output = compile_and_run(SET_INT_DISTRIBUTION_PROGRAM, runtime_sources=("mgen_memory_ops.c",))
+        assert output.splitlines() == [
+            "seq 100000 0 0 1 1",
+            "stride16 100000 0 0 1 1",
+            "stride4096 100000 0 0 1 1",
+            "negative 100000 0 0 1 1",
+            "1",
+        ]
+
+
+INCREMENTAL_REHASH_PROGRAM = """
+#include <stdio.h>
+#include "mgen_set_int.h"
+#include "mgen_str_int_map.h"
+
+// Every value inserted so far is reachable by lookup and by iteration
+static int set_int_intact(const set_int* s, int n) {
+    long long sum = 0;
+    size_t count = 0;
+    for (set_int_iter it = set_int_begin(s); it.ref; set_int_next(&it)) {
+        sum += *it.ref;
+        count++;
+    }
+    int ok = count == (size_t)n && sum == 3LL * n * (n - 1) / 2;
+    for (int i = 0; i < n; i++) {
+        ok &= set_int_contains(s, i * 3);
+    }
+    return ok;
+}
+
+int main(void) {
+    // Each doubling starts a migration; check the set right as it begins
+    set_int s = {0};
+    int migrations = 0, intact = 1;
+    for (int i = 0; i < 100000; i++) {
+        set_int_insert(&s, i * 3);
+        if (s.old_buckets && s.migrate_index == 0) {
+            migrations++;
+            intact &= set_int_intact(&s, i + 1);
+        }
+    }
+    intact &= set_int_intact(&s, 100000);
+    printf("set %d %d %zu\\n", migrations, intact, set_int_size(&s));
+    set_int_drop(&s);
+
+    // Removing while a migration is in progress, then clearing mid-migration
+    set_int t = {0};
+    for (int i = 0; i <= 1024; i++) {
+        set_int_insert(&t, i);
+    }
+    int removed_ok = t.old_buckets != NULL;
+    for (int i = 0; i <= 1024; i += 2) {
+        removed_ok &= set_int_remove(&t, i);
+    }
+    for (int i = 0; i <= 1024; i++) {
+        removed_ok &= set_int_contains(&t, i) == (i % 2 == 1);
+    }
+    for (int i = 2000; i <= 4100; i++) {
+        set_int_insert(&t, i);
+    }
+    int mid_clear = t.old_buckets != NULL;
+    set_int_clear(&t);
+    set_int_insert(&t, 7);
+    printf("remove %d %zu %d %d\\n", removed_ok, set_int_size(&t), mid_clear, set_int_contains(&t, 7));
+    set_int_drop(&t);
+
+    // reserve() sizes the table once: no later growth or migration
+    set_int r = {0};
+    set_int_reserve(&r, 100000);
+    size_t reserved = r.bucket_count;
+    int migrated = 0;
+    for (int i = 0; i < 100000; i++) {
+        set_int_insert(&r, i);
+        migrated |= r.old_buckets != NULL;
+    }
+    printf("reserve %d %d\\n", r.bucket_count == reserved, migrated);
+    set_int_drop(&r);
+
+    // Same for the string-keyed map
+    mgen_str_int_map_t* m = mgen_str_int_map_new();
+    char key[32];
+    int map_migrations = 0, map_ok = 1;
+    for (int i = 0; i < 50000; i++) {
+        snprintf(key, sizeof key, "k%d", i);
+        mgen_str_int_map_insert(m, key, i);
+        if (m->old_buckets && m->migrate_index == 0) {
+            map_migrations++;
+            for (int j = 0; j <= i; j += 7) {
+                snprintf(key, sizeof key, "k%d", j);
+                int* v = mgen_str_int_map_get(m, key);
+                map_ok &= v && *v == j;
+            }
+        }
+    }
+    for (int i = 0; i < 50000; i += 2) {
+        snprintf(key, sizeof key, "k%d", i);
+        map_ok &= mgen_str_int_map_remove(m, key);
+    }
+    map_ok &= mgen_str_int_map_size(m) == 25000;
+    mgen_str_int_map_t* reserved_map = mgen_str_int_map_new();
+    mgen_str_int_map_reserve(reserved_map, 50000);
+    size_t map_reserved = reserved_map->bucket_count;
+    for (int i = 0; i < 50000; i++) {
+        snprintf(key, sizeof key, "k%d", i);
+        mgen_str_int_map_insert(reserved_map, key, i);
+    }
+    printf("map %d %d %d\\n", map_migrations, map_ok, reserved_map->bucket_count == map_reserved);
+    mgen_str_int_map_free(m);
+    mgen_str_int_map_free(reserved_map);
+    return 0;
+}
+"""
+
+
+class TestIncrementalRehashRuntime:
+    """Test load-factor-driven incremental rehashing in set_int and mgen_str_int_map."""
+
+    def test_migration_and_reserve(self):
+        """Lookups, iteration, removal and clear stay correct mid-migration; reserve avoids growth."""
+        output = compile_and_run(INCREMENTAL_REHASH_PROGRAM, runtime_sources=("mgen_memory_ops.c",))
+        assert output.splitlines() == [
+            "set 13 1 100000",
+            "remove 1 1 1 1",
+            "reserve 1 0",
+            "map 13 1 1",
+        ]
+
+STRING_HASH_PROGRAM = """
+#include <stdio.h>
+#include "mgen_str_int_map.h"
+#include "mgen_map_str_str.h"
+
+int main(void) {
+    // Every length exercises a different read pattern; all prefixes must differ
+    char text[101];
+    for (int i = 0; i < 100; i++) {
+        text[i] = (char)('a' + (i * 7) % 26);
+    }
+    text[100] = '\\0';
+    static size_t hashes[101];
+    int agree = 1, distinct = 1, seeded = 1;
+    for (size_t len = 0; len <= 100; len++) {
+        char buf[101];
+        memcpy(buf, text, len);
+        buf[len] = '\\0';
+        size_t measured;
+        hashes[len] = mgen_str_hash(buf, &measured, 0);
+        agree &= measured == len && hashes[len] == mgen_str_hash_bytes(text, len, 0);
+        seeded &= hashes[len] != mgen_str_hash_bytes(text, len, 12345);
+        for (size_t j = 0; j < len; j++) {
+            distinct &= hashes[j] != hashes[len];
+        }
+    }
+    printf("%d %d %d\\n", agree, distinct, seeded);
+
+    // The table grows and entries keep their cached hashes across relinks
+    mgen_str_int_map_t* m = mgen_str_int_map_new();
+    char key[32];
+    for (int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof key, "key-%d", i);
+        mgen_str_int_map_insert(m, key, i);
+    }
+    for (int i = 0; i < 5000; i += 2) {
+        snprintf(key, sizeof key, "key-%d", i);
+        mgen_str_int_map_remove(m, key);
+    }
+    int ok = mgen_str_int_map_size(m) == 2500;
+    for (int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof key, "key-%d", i);
+        int* v = mgen_str_int_map_get(m, key);
+        ok &= (i % 2 == 1) ? (v && *v == i) : (v == NULL);
+    }
+    int power_of_two = (m->bucket_count & (m->bucket_count - 1)) == 0;
+    printf("%d %d %d\\n", ok, power_of_two, m->bucket_count >= 4096);
+
+    // Seeds are per container, fixed unless MGEN_STR_HASH_RANDOMIZE is defined
+    mgen_str_int_map_t* other = mgen_str_int_map_new();
+    map_str_str s = {0};
+    map_str_str_insert(&s, "k", "v");
+    printf("%d %d %s\\n", m->seed == other->seed, m->seed == 0 && s.seed == 0, *map_str_str_get(&s, "k"));
+    mgen_str_int_map_free(m);
+    mgen_str_int_map_free(other);
+    map_str_str_drop(&s);
+    return 0;
+}
+"""
+
+
+class TestStringHashRuntime:
+    """Test the shared word-at-a-time string hash and the containers using it."""
+
+    def test_hash_and_map_growth(self):
+        """Hash covers every length, str_int_map grows, and seeds default to 0."""
+        output = compile_and_run(STRING_HASH_PROGRAM, runtime_sources=("mgen_memory_ops.c",))
+        assert output.splitlines() == ["1 1 1", "1 1 1", "1 1 v"]
+
+    def test_randomized_seeds(self):
+        """MGEN_STR_HASH_RANDOMIZE gives each container its own seed."""
+        output = compile_and_run(
+            STRING_HASH_PROGRAM, extra_flags=("-DMGEN_STR_HASH_RANDOMIZE",), runtime_sources=("mgen_memory_ops.c",)
+        )
+        assert output.splitlines() == ["1 1 1", "1 1 1", "0 0 v"]
+
+
+STRING_INTERN_PROGRAM = """
+#include <stdio.h>
+#include "mgen_str_int_map.h"
+
+int main(void) {
+    // Equal strings share one symbol; find never inserts
+    char buf[8] = "the";
+    const char* the = mgen_str_intern("the");
+    printf("%d %d %d\\n", mgen_str_intern(buf) == the, mgen_str_intern_find("fox") == NULL,
+           (int)mgen_str_intern_count());
+
+    // An interned map counts dynamic keys and symbols in the same entries
+    mgen_str_int_map_t* m = mgen_str_int_map_new_interned();
+    char key[32];
+    for (int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof key, "w%d", i % 1000);
+        *mgen_str_int_map_get_or_insert(m, key, 0) += 1;
+    }
+    *mgen_str_int_map_get_or_insert_symbol(m, the, 0) += 7;
+    mgen_str_int_map_insert(m, "the", 9 + *mgen_str_int_map_get(m, "the"));
+    printf("%zu %d %d %d %d\\n", mgen_str_int_map_size(m), *mgen_str_int_map_get(m, "w999"),
+           *mgen_str_int_map_get_symbol(m, the), mgen_str_int_map_contains(m, "nope"),
+           mgen_str_int_map_contains_symbol(m, mgen_str_intern("w5")));
+
+    // Removing never frees a symbol, and iterated keys are the symbols themselves
+    int removed = mgen_str_int_map_remove(m, "w5");
+    int removed_missing = mgen_str_int_map_remove(m, "never");
+    int keys_are_symbols = 1;
+    for (mgen_str_int_map_iter it = mgen_str_int_map_begin(m); it.ref; mgen_str_int_map_next(&it)) {
+        keys_are_symbols &= mgen_str_intern_find(it.ref->key) == it.ref->key && it.ref->key_len == strlen(it.ref->key);
+    }
+    printf("%d %d %zu %d %d\\n", removed, removed_missing, mgen_str_int_map_size(m), keys_are_symbols,
+           mgen_str_intern_find("w5") != NULL);
+    mgen_str_int_map_free(m);
+    mgen_str_intern_clear();
+    printf("%d\\n", (int)mgen_str_intern_count());
+    return 0;
+}
+"""
+
+
+class TestStringInternRuntime:
+    """Test the string intern table and the str_int_map keyed by its symbols."""
+
+    def test_interned_map(self):
+        """Interned maps compare symbols, accept plain keys, and never free the shared keys."""
+        output = compile_and_run(STRING_INTERN_PROGRAM, runtime_sources=("mgen_memory_ops.c",))
+        assert output.splitlines() == ["1 1 1", "1001 5 16 0 1", "1 0 1000 1 1", "0"]
+
+
+HASH_CURSOR_PROGRAM = """
+#include <stdio.h>
+#include "mgen_map_int_int.h"
+#include "mgen_map_str_str.h"
+#include "mgen_set_str.h"
+#include "mgen_set_int.h"
+#include "mgen_str_int_map.h"
+
+int main(void) {
+    // Slots freed by remove are skipped; refs expose first/second like STC
+    map_int_int a = {0};
+    for (int i = 0; i < 1000; i++) {
+        map_int_int_insert(&a, i, i * 2);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        map_int_int_remove(&a, i);
+    }
+    long long key_sum = 0, value_sum = 0;
+    size_t count = 0;
+    for (map_int_int_iter it = map_int_int_begin(&a); it.ref; map_int_int_next(&it)) {
+        key_sum += it.ref->first;
+        value_sum += it.ref->second;
+        count++;
+    }
+    map_int_int empty = {0};
+    printf("%zu %lld %lld %d\\n", count, key_sum, value_sum, map_int_int_begin(&empty).ref == NULL);
+    map_int_int_drop(&a);
+
+    map_str_str b = {0};
+    map_str_str_insert(&b, "x", "1");
+    map_str_str_insert(&b, "y", "22");
+    map_str_str_insert(&b, "x", "333");
+    size_t total = 0;
+    for (map_str_str_iter it = map_str_str_begin(&b); it.ref; map_str_str_next(&it)) {
+        total += strlen(it.ref->first) + strlen(it.ref->second);
+    }
+    printf("%zu %d\\n", total, map_str_str_end(&b).ref == NULL);
+    map_str_str_drop(&b);
+
+    set_str c = {0};
+    set_str_insert(&c, "one");
+    set_str_insert(&c, "three");
+    set_str_insert(&c, "one");
+    total = 0;
+    for (set_str_iter it = set_str_begin(&c); it.ref; set_str_next(&it)) {
+        total += strlen(*it.ref);
+    }
+    printf("%zu\\n", total);
+    set_str_drop(&c);
+
+    // Chained containers walk both tables while a migration is pending
+    mgen_str_int_map_t* d = mgen_str_int_map_new();
+    char key[32];
+    int saw_migration = 0;
+    for (int i = 0; i < 3000; i++) {
+        snprintf(key, sizeof key, "k%d", i);
+        mgen_str_int_map_insert(d, key, i);
+        saw_migration |= d->old_buckets != NULL;
+    }
+    count = 0;
+    value_sum = 0;
+    for (mgen_str_int_map_iter it = mgen_str_int_map_begin(d); it.ref; mgen_str_int_map_next(&it)) {
+        value_sum += it.ref->second;
+        count++;
+    }
+    printf("%d %d %lld %d\\n", saw_migration, count == mgen_str_int_map_size(d), value_sum,
+           mgen_str_int_map_end(d).ref == NULL);
+    mgen_str_int_map_free(d);
+
+    set_int e = {0};
+    for (int i = 0; i < 100; i++) {
+        set_int_insert(&e, i);
+    }
+    printf("%d\\n", set_int_end(&e).ref == NULL);
+    set_int_drop(&e);
+    return 0;
+}
+"""
+
+
+class TestHashCursorRuntime:
+    """Test the begin/next/end cursors shared by every hash container."""
+
+    def test_cursors_visit_each_live_entry(self):
+        """Each cursor visits every live entry once and end() has a NULL ref."""
+        output = compile_and_run(HASH_CURSOR_PROGRAM, runtime_sources=("mgen_memory_ops.c",))
+        assert output.splitlines() == ["500 250000 500000 1", "7 1", "8", "1 1 4498500 1", "1"]
+
+
+SPECIALIZED_HELPERS_PROGRAM = """
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+GENERATED_CONTAINERS
+
+int main(void) {
+    // Long enough for whole scan blocks plus a tail
+    vec_int a = {0}, b = {0};
+    for (int i = 0; i < 100; i++) {
+        vec_int_push(&a, i * 3);
+        vec_int_push(&b, i * 3);
+    }
+    printf("%d %d %d %d\\n", vec_int_contains(&a, 0), vec_int_contains(&a, 297), vec_int_contains(&a, 298),
+           vec_int_equal(&a, &b));
+    *vec_int_at(&b, 40) = 1;
+    printf("%d %d\\n", vec_int_equal(&a, &b), vec_int_equal(&a, &a));
+
+    vec_int small = {0};
+    vec_int_push(&small, 1);
+    vec_int_push(&small, -2);
+    char* repr = vec_int_repr(&small);
+    vec_int empty = {0};
+    char* empty_repr = vec_int_repr(&empty);
+    printf("%s %s\\n", repr, empty_repr);
+    free(repr);
+    free(empty_repr);
+
+    // Element-wise == follows Python: 0.0 == -0.0
+    vec_double x = {0}, y = {0};
+    vec_double_push(&x, 0.0);
+    vec_double_push(&y, -0.0);
+    printf("%d %d\\n", vec_double_equal(&x, &y), vec_double_contains(&y, 0.0));
+
+    vec_cstr words = {0}, same = {0};
+    vec_cstr_push(&words, "ab");
+    vec_cstr_push(&words, "cd");
+    vec_cstr_push(&same, "ab");
+    vec_cstr_push(&same, "cd");
+    printf("%d %d %d\\n", vec_cstr_contains(&words, "cd"), vec_cstr_contains(&words, "c"),
+           vec_cstr_equal(&words, &same));
+
+    vec_int_drop(&a);
+    vec_int_drop(&b);
+    vec_int_drop(&small);
+    vec_double_drop(&x);
+    vec_double_drop(&y);
+    vec_cstr_drop(&words);
+    vec_cstr_drop(&same);
+    return 0;
+}
+"""
+
+
+class TestSpecializedVecHelpers:
+    """Test the per-instantiation contains/equal/repr helpers emitted for generated vectors."""
+
+    def test_generated_helpers(self):
+        """Template and specialized vectors get type-specialized helpers with Python semantics."""
+        codegen = ContainerCodeGenerator()
+        generated = "".join(codegen.generate_container(name) for name in ("vec_int", "vec_double", "vec_cstr"))
+        source = SPECIALIZED_HELPERS_PROGRAM.replace("GENERATED_CONTAINERS", generated)
+        assert compile_and_run(source).splitlines() == ["1 1 0 1", "0 1", "[1, -2] []", "1 1", "1 0 1"]
+
+
+SORT_PROGRAM = """
+#include <stdio.h>
+#include "mgen_sort.h"
+
+static unsigned long long state = 88172645463325252ull;
+
+static unsigned long long next_random(void) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Pattern p value at index i of n: random, few distinct, sorted, reversed, constant, mostly sorted
+static int pattern(int p, size_t i, size_t n) {
+    switch (p) {
+    case 0: return (int)next_random();
+    case 1: return (int)(next_random() % 4) - 2;
+    case 2: return (int)i;
+    case 3: return (int)(n - i);
+    case 4: return 7;
+    default: return i % 97 == 0 ? (int)next_random() : (int)i;
+    }
+}
+
+int main(void) {
+    // Around the insertion, ninther and radix thresholds, and long enough to hit heapsort guards
+    size_t sizes[] = {0, 1, 2, 23, 24, 25, 128, 129, 1000, MGEN_SORT_RADIX_MIN - 1, MGEN_SORT_RADIX_MIN, 50000};
+    int failures = 0;
+    for (int p = 0; p < 6; p++) {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            size_t n = sizes[s];
+            int* a = malloc((n + 1) * sizeof(int));
+            int* b = malloc((n + 1) * sizeof(int));
+            int* c = malloc((n + 1) * sizeof(int));
+            double* d = malloc((n + 1) * sizeof(double));
+            double* e = malloc((n + 1) * sizeof(double));
+            for (size_t i = 0; i < n; i++) {
+                a[i] = b[i] = c[i] = pattern(p, i, n);
+                d[i] = e[i] = a[i] * 0.25;
+            }
+            mgen_sort_int(a, n);
+            mgen_sort_int_stable(c, n);
+            qsort(b, n, sizeof(int), compare_int);
+            mgen_sort_double(d, n);
+            qsort(e, n, sizeof(double), compare_double);
+            if (n && (memcmp(a, b, n * sizeof(int)) || memcmp(c, b, n * sizeof(int)) ||
+                      memcmp(d, e, n * sizeof(double)))) {
+                failures++;
+            }
+            mgen_sort_int_reverse(a, n);
+            for (size_t i = 1; i < n; i++) {
+                failures += a[i - 1] < a[i];
+            }
+
+            // Elements are their original indices; equal keys must keep ascending indices
+            int* keys = malloc((n + 1) * sizeof(int));
+            for (size_t i = 0; i < n; i++) {
+                keys[i] = (int)(next_random() % 5);
+            }
+            for (int reverse = 0; reverse < 2; reverse++) {
+                for (size_t i = 0; i < n; i++) {
+                    a[i] = (int)i;
+                }
+                mgen_sort_by_int_keys(a, n, sizeof(int), keys, reverse);
+                for (size_t i = 1; i < n; i++) {
+                    int before = keys[a[i - 1]], after = keys[a[i]];
+                    bool ordered = reverse ? before > after : before < after;
+                    failures += !(ordered || (before == after && a[i - 1] < a[i]));
+                }
+            }
+            free(keys);
+            free(a);
+            free(b);
+            free(c);
+            free(d);
+            free(e);
+        }
+    }
+
+    char* words[] = {"pear", "apple", "fig", "apple", "kiwi"};
+    mgen_sort_str(words, 5);
+    double weights[] = {2.5, 0.5, 1.5};
+    int labels[] = {10, 20, 30};
+    mgen_sort_by_double_keys(labels, 3, sizeof(int), weights, false);
+    printf("%d\\n", failures);
+    printf("%s %s %s %s %s\\n", words[0], words[1], words[2], words[3], words[4]);
+    printf("%d %d %d\\n", labels[0], labels[1], labels[2]);
+    return 0;
+}
+"""
+
+
+class TestSortRuntime:
+    """Test the type-specialized pdqsort, radix, stable and key sorts."""
+
+    def test_sorts_agree_with_qsort(self):
+        """Every sort orders like qsort across sizes and input patterns; key sorts are stable."""
+        output = compile_and_run(SORT_PROGRAM)
+        assert output.splitlines() == ["0", "apple apple fig kiwi pear", "20 30 10"]
+
+
+ASCII_PROGRAM = """
+#include <stdio.h>
+#include "mgen_ascii.h"
+#include "mgen_string_ops.h"
+
+static unsigned int state = 12345;
+
+static unsigned int next_random(void) {
+    state = state * 1103515245u + 12345u;
+    return state >> 16;
+}
+
+static size_t reference_count(const char* hay, const char* needle) {
+    size_t len = strlen(needle), count = 0;
+    if (len == 0) return strlen(hay) + 1;
+    for (const char* p = hay; (p = strstr(p, needle)) != NULL; p += len) count++;
+    return count;
+}
+
+int main(void) {
+    // Small alphabets force many candidates (and the strstr hand-over); the last one mixes
+    // in whitespace, case-range edges and bytes >= 0x80
+    static const char alphabet[] = "aAbzZ \\t\\n\\r\\v\\f@[`{09\\x80\\xe9\\xff";
+    char hay[300], needle[40], out[300];
+    int mismatches = 0;
+    for (int it = 0; it < 50000; it++) {
+        size_t letters = (it % 4 == 3) ? sizeof(alphabet) - 1 : (size_t)(it % 4 + 1);
+        size_t hay_len = next_random() % 290, needle_len = next_random() % (it % 7 ? 6 : 35);
+        for (size_t i = 0; i < hay_len; i++) hay[i] = alphabet[next_random() % letters];
+        for (size_t i = 0; i < needle_len; i++) needle[i] = alphabet[next_random() % letters];
+        hay[hay_len] = needle[needle_len] = 0;
+
+        mismatches += mgen_ascii_find(hay, hay_len, needle, needle_len) != strstr(hay, needle);
+        mismatches += mgen_ascii_count(hay, hay_len, needle, needle_len) != reference_count(hay, needle);
+        mgen_ascii_upper_n(out, hay, hay_len);
+        for (size_t i = 0; i < hay_len; i++) mismatches += (unsigned char)out[i] != toupper((unsigned char)hay[i]);
+        mgen_ascii_lower_n(out, hay, hay_len);
+        for (size_t i = 0; i < hay_len; i++) mismatches += (unsigned char)out[i] != tolower((unsigned char)hay[i]);
+
+        const char* end = hay + hay_len;
+        const char* p = hay;
+        while (p < end && isspace((unsigned char)*p)) p++;
+        mismatches += mgen_ascii_skip_space(hay, end) != p;
+        for (p = hay; p < end && !isspace((unsigned char)*p); p++) {}
+        mismatches += mgen_ascii_find_space(hay, end) != p;
+    }
+    for (int c = 0; c < 256; c++) {
+        mismatches += mgen_ascii_isspace((unsigned char)c) != (isspace(c) != 0);
+        mismatches += mgen_ascii_isalpha((unsigned char)c) != (isalpha(c) != 0);
+        mismatches += mgen_ascii_isalnum((unsigned char)c) != (isalnum(c) != 0);
+        mismatches += mgen_ascii_lower((unsigned char)c) != tolower(c);
+        mismatches += mgen_ascii_upper((unsigned char)c) != toupper(c);
+    }
+    printf("%d\\n", mismatches);
+
+    // The string operations built on top
+    char* upper = mgen_str_upper("Mixed case text, long enough for a block: \\xc3\\xa9t\\xc3\\xa9!");
+    char* stripped = mgen_str_strip(" \\t  padded on both sides of the text \\n\\r ");
+    char* replaced = mgen_str_replace("a-b-c-d-e-f-g-h-i-j-k-l-m-n-o-p-q", "-", "--");
+    printf("%s|%s|%s\\n", upper, stripped, replaced);
+    printf("%d %d %d %d\\n", mgen_str_count("banana bandana", "an"), mgen_str_count("aaaa", "aa"),
+           mgen_str_count("abc", ""), mgen_str_find("the quick brown fox jumps over the lazy dog", "lazy"));
+    mgen_string_array_t* words = mgen_str_split("  one\\ttwo   three\\n four five six seven eight  ", NULL);
+    mgen_string_array_t* fields = mgen_str_split("x::y::::z", "::");
+    printf("%zu %s %s %zu %s\\n", mgen_string_array_size(words), mgen_string_array_get(words, 2),
+           mgen_string_array_get(words, 7), mgen_string_array_size(fields), mgen_string_array_get(fields, 2));
+    free(upper);
+    free(stripped);
+    free(replaced);
+    mgen_string_array_free(words);
+    mgen_string_array_free(fields);
+    return 0;
+}
+"""
+
+
+class TestAsciiRuntime:
+    """Test the ASCII fast paths against <ctype.h> and strstr()."""
+
+    EXPECTED = [
+        "0",
+        "MIXED CASE TEXT, LONG ENOUGH FOR A BLOCK: \u00e9T\u00e9!|padded on both sides of the text|"
+        "a--b--c--d--e--f--g--h--i--j--k--l--m--n--o--p--q",
+        "4 2 4 35",
+        "8 three eight 4 ",
+    ]
+
+    def test_simd_paths_match_reference(self):
+        """Block-at-a-time search, case conversion and whitespace scans match the byte-wise functions."""
+        output = compile_and_run(ASCII_PROGRAM, runtime_sources=("mgen_string_ops.c", "mgen_memory_ops.c"))
+        assert output.splitlines() == self.EXPECTED
+
+    def test_portable_paths_match_reference(self):
+        """The word-at-a-time fallback used without SSE2/NEON gives the same results."""
+        output = compile_and_run(
+            ASCII_PROGRAM,
+            extra_flags=("-DMGEN_ASCII_NO_SIMD",),
+            runtime_sources=("mgen_string_ops.c", "mgen_memory_ops.c"),
+        )
+        assert output.splitlines() == self.EXPECTED
+
+
+UTF8_PROGRAM = """
+#include <stdio.h>
+#include "mgen_utf8.h"
+
+int main(void) {
+    // 1000 code points cycling through 1-, 2-, 3- and 4-byte encodings, so the
+    // sparse index has several checkpoints
+    static const char* parts[] = {"a", "\\xc3\\xa9", "\\xe2\\x82\\xac", "\\xf0\\x9f\\x98\\x80"};
+    static char text[5000];
+    size_t size = 0;
+    for (int i = 0; i < 1000; i++) {
+        const char* part = parts[(i * 7) % 4];
+        memcpy(text + size, part, strlen(part));
+        size += strlen(part);
+    }
+
+    mgen_utf8_str_t view = mgen_utf8_view(text);
+    int mismatches = 0;
+    for (int i = -1000; i < 1000; i++) {
+        const char* expected = parts[((i + 1000) * 7) % 4];
+        char* ch = mgen_utf8_at(&view, i);
+        char* plain = mgen_utf8_str_at(text, i);
+        mismatches += strcmp(ch, expected) != 0 || strcmp(plain, expected) != 0;
+        mismatches += !mgen_utf8_char_is(&view, i, expected) || mgen_utf8_char_is(&view, i, "ab");
+        mismatches += !mgen_utf8_str_char_is(text, i, expected);
+        free(ch);
+        free(plain);
+    }
+    mgen_utf8_iter_t iter = mgen_utf8_iter(text);
+    int count = 0;
+    for (const char* ch; (ch = mgen_utf8_next(&iter)) != NULL; count++) {
+        mismatches += strcmp(ch, parts[(count * 7) % 4]) != 0;
+    }
+    printf("%zu %zu %d %d %d\\n", view.size, view.length, view.ascii, count, mismatches);
+
+    // Python clamping of slice bounds
+    char* a = mgen_utf8_slice(&view, 998, MGEN_UTF8_END);
+    char* b = mgen_utf8_slice(&view, -1, 5000);
+    char* c = mgen_utf8_slice(&view, 700, 100);
+    char* d = mgen_utf8_slice(&view, 130, 200);
+    printf("%zu %zu %zu %zu\\n", mgen_utf8_len(a), mgen_utf8_len(b), strlen(c), mgen_utf8_len(d));
+    free(a);
+    free(b);
+    free(c);
+    free(d);
+
+    // Out of range sets IndexError; ASCII strings index bytes directly
+    char* out = mgen_utf8_at(&view, 1000);
+    printf("%d %d ", out == NULL, mgen_get_last_error() == MGEN_ERROR_INDEX);
+    mgen_utf8_release(&view);
+    mgen_utf8_str_t ascii = mgen_utf8_view("hello");
+    char* e = mgen_utf8_slice(&ascii, 1, -1);
+    printf("%d %s %zu\\n", ascii.ascii, e, mgen_utf8_len("\\x80\\x80x"));
+    free(e);
+    return 0;
+}
+"""
+
+
+class TestUtf8Runtime:
+    """Test code point views, their sparse index, iteration and slicing."""
+
+    def test_code_point_indexing(self):
+        """Indexing through the sparse index agrees with walking and iterating the string."""
+        output = compile_and_run(UTF8_PROGRAM)
+        assert output.splitlines() == ["2500 1000 0 1000 0", "2 1 0 70", "1 1 1 ell 1"]
+
+
+STDOUT_PROGRAM = """
+#include <limits.h>
+#include "mgen_stdout.h"
+
+int main(void) {
+    long long checksum = 0;
+    for (int i = -1000; i < 200000; i += 7) {
+        mgen_print_int(i);
+        checksum += i;
+    }
+    mgen_stdout_int(LLONG_MIN);
+    mgen_stdout_char(' ');
+    mgen_print_int(LLONG_MAX);
+
+    // Writes larger than half the buffer bypass it without reordering output
+    static char big[MGEN_STDOUT_BUFFER_SIZE];
+    memset(big, 'x', sizeof(big) - 1);
+    mgen_stdout_str("<");
+    mgen_stdout_str(big);
+    mgen_print_str(">");
+
+    mgen_print_double(-0.125);
+    mgen_print_bool(false);
+    mgen_stdout_flush();
+    printf("%lld\\n", checksum);
+    return 0;
+}
+"""
+
+
+class TestStdoutRuntime:
+    """Test the buffered print() writer in mgen_stdout.h."""
+
+    def test_buffered_lines_match_printf(self):
+        """Output through the buffer is what printf would have written, in order."""
+        output = compile_and_run(STDOUT_PROGRAM)
+        numbers = list(range(-1000, 200000, 7))
+        big = "x" * (64 * 1024 - 1)
+        expected = "".join(f"{i}\n" for i in numbers)
+        expected += "-9223372036854775808 9223372036854775807\n"
+        expected += f"<{big}>\n-0.125000\nfalse\n{sum(numbers)}\n"
+        assert output == expected
+
+
+CONTAINER_REPR_PROGRAM = """
+#include <stdio.h>
+#include "mgen_container_ops.h"
+#include "mgen_stdout.h"
+
+typedef struct { const char* key; double value; } entry_t;
+static entry_t entries[] = {{"a", 1.0}, {"it's", -0.5}};
+
+static size_t int_size(void* vec) { (void)vec; return 4; }
+static void* int_at(void* vec, size_t i) { return (int*)vec + i; }
+static size_t str_size(void* vec) { (void)vec; return 3; }
+static void* str_at(void* vec, size_t i) { return (const char**)vec + i; }
+static char* int_repr(const void* element) { return mgen_int_to_string(*(const int*)element); }
+
+static void iter_entries(void* map, void (*callback)(void*, void*, void*), void* userdata) {
+    (void)map;
+    for (size_t i = 0; i < 2; i++) {
+        callback(&entries[i].key, &entries[i].value, userdata);
+    }
+}
+
+int main(void) {
+    int ints[] = {7, -12, 0, 100000};
+    const char* strs[] = {"plain", "it's", "tab\\there"};
+    double doubles[] = {2.0, 0.1, 1e300, -3.25};
+
+    mgen_buffer_t out;
+    mgen_buffer_init(&out, 0);
+    mgen_vec_repr_append(&out, ints, int_size, int_at, mgen_repr_append_int);
+    mgen_buffer_append_char(&out, ' ');
+    mgen_vec_repr_append(&out, strs, str_size, str_at, mgen_repr_append_str);
+    mgen_buffer_append_char(&out, ' ');
+    mgen_hmap_repr_append(&out, entries, iter_entries, mgen_repr_append_str, mgen_repr_append_double);
+    printf("%s\\n", mgen_buffer_cstr(&out));
+
+    mgen_buffer_clear(&out);
+    for (int i = 0; i < 4; i++) {
+        mgen_repr_append_double(&out, &doubles[i]);
+        mgen_buffer_append_char(&out, ' ');
+    }
+    bool flag = true;
+    mgen_repr_append_bool(&out, &flag);
+    printf("%s\\n", mgen_buffer_cstr(&out));
+    mgen_buffer_destroy(&out);
+
+    char* legacy = mgen_vec_repr(ints, int_size, int_at, int_repr);
+    printf("%s\\n", legacy);
+    free(legacy);
+
+    mgen_print_int_list(ints, 4);
+    mgen_print_double_list(doubles, 4);
+    mgen_print_str_list((char* const*)strs, 3);
+    mgen_print_int_list(ints, 0);
+    return 0;
+}
+"""
+
+
+class TestContainerReprRuntime:
+    """Test container repr() written into one mgen_buffer_t or straight to the stdout buffer."""
+
+    def test_repr_matches_python(self):
+        """Elements are appended as Python's repr() formats them."""
+        output = compile_and_run(
+            CONTAINER_REPR_PROGRAM, (), ("mgen_container_ops.c", "mgen_string_ops.c", "mgen_memory_ops.c")
+        )
+
+        strs = ["plain", "it's", "tab\there"]
+        doubles = [2.0, 0.1, 1e300, -3.25]
+        assert output.splitlines() == [
+            f"[7, -12, 0, 100000] {strs!r} {{'a': 1.0, \"it's\": -0.5}}",
+            " ".join(repr(d) for d in doubles) + " True",
+            "[7, -12, 0, 100000]",
+            "[7, -12, 0, 100000]",
+            repr(doubles),
+            repr(strs),
+            "[]",
+        ]
+
+
+SLICE_VIEW_PROGRAM = """
+#include <stdio.h>
+#include "mgen_stc_bridge.h"
+
+static void show(mgen_vec_view_t view) {
+    printf("[");
+    for (size_t i = 0; i < view.length; i++) {
+        printf(i ? " %d" : "%d", *(int*)mgen_vec_view_at(&view, i));
+    }
+    printf("]\\n");
+}
+
+int main(void) {
+    int data[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    size_t n = sizeof(data) / sizeof(data[0]);
+    show(mgen_vec_slice_impl(data, n, sizeof(int), 2, 7, 1));
+    show(mgen_vec_slice_impl(data, n, sizeof(int), -3, MGEN_SLICE_NONE, 1));
+    show(mgen_vec_slice_impl(data, n, sizeof(int), MGEN_SLICE_NONE, MGEN_SLICE_NONE, 3));
+    show(mgen_vec_slice_impl(data, n, sizeof(int), MGEN_SLICE_NONE, MGEN_SLICE_NONE, -1));
+    show(mgen_vec_slice_impl(data, n, sizeof(int), 8, 1, -2));
+    show(mgen_vec_slice_impl(data, n, sizeof(int), -100, 100, 4));
+    show(mgen_vec_slice_impl(data, n, sizeof(int), 7, 2, 1));
+    show(mgen_vec_slice_impl(data, n, sizeof(int), 0, 5, 0));
+    printf("%d\\n", mgen_get_last_error() == MGEN_ERROR_VALUE);
+
+    size_t first;
+    size_t length = mgen_slice_range(n, -4, MGEN_SLICE_END, &first);
+    printf("%zu %zu\\n", first, length);
+    length = mgen_slice_range(n, 3, -9, &first);
+    printf("%zu %zu\\n", first, length);
+    return 0;
+}
+"""
+
+
+class TestSliceViewRuntime:
+    """Test the non-owning slice views of mgen_stc_bridge.h."""
+
+    def test_views_follow_python_slice_semantics(self):
+        """Views select the elements Python's slice of the list would, without copying."""
+        output = compile_and_run(
+            SLICE_VIEW_PROGRAM, runtime_sources=("mgen_stc_bridge.c", "mgen_string_ops.c", "mgen_memory_ops.c")
+        )
+        data = list(range(10))
+        slices = [data[2:7], data[-3:], data[::3], data[::-1], data[8:1:-2], data[-100:100:4], data[7:2], []]
+        expected = "".join("[" + " ".join(map(str, s)) + "]\n" for s in slices)
+        assert output == expected + "1\n6 4\n3 0\n"
+
+
+LLVM_RUNTIME_DIR = RUNTIME_DIR.parent.parent / "llvm" / "runtime"
+
+LLVM_INT_RUNTIME_PROGRAM = """
+#include <stdio.h>
+#include "mgen_vec_i64.h"
+#include "mgen_set_i64.h"
+#include "mgen_map_i64_i64.h"
+
+typedef vec_i64 vec_int;
+typedef set_i64 set_int;
+typedef map_i64_i64 map_int_int;
+
+// The functions the LLVM backend's IR calls
+void vec_int_init_ptr(vec_int* out);
+void vec_int_push(vec_int* vec, long long value);
+long long vec_int_at(vec_int* vec, size_t index);
+void vec_int_set(vec_int* vec, size_t index, long long value);
+size_t vec_int_size(vec_int* vec);
+void vec_int_free(vec_int* vec);
+void set_int_init_ptr(set_int* out);
+bool set_int_insert(set_int* set, long long value);
+bool set_int_contains(const set_int* set, long long value);
+size_t set_int_size(const set_int* set);
+long long set_int_get_nth_element(const set_int* set, size_t n);
+void set_int_drop(set_int* set);
+void map_int_int_init_ptr(map_int_int* out);
+long long* map_int_int_slot(map_int_int* map, long long key);
+void map_int_int_set(map_int_int* map, long long key, long long value);
+long long map_int_int_get(map_int_int* map, long long key);
+int map_int_int_contains(map_int_int* map, long long key);
+size_t map_int_int_capacity(map_int_int* map);
+int map_int_int_entry_is_occupied(map_int_int* map, size_t index);
+long long map_int_int_entry_value(map_int_int* map, size_t index);
+void map_int_int_free(map_int_int* map);
+
+int main(void) {
+    vec_int v;
+    vec_int_init_ptr(&v);
+    for (long long i = 0; i < 1000; i++) {
+        vec_int_push(&v, i * 5000000000LL);
+    }
+    vec_int_set(&v, 3, -1);
+    printf("%zu %lld %lld\\n", vec_int_size(&v), vec_int_at(&v, 3), vec_int_at(&v, 999));
+    vec_int_free(&v);
+
+    set_int s;
+    set_int_init_ptr(&s);
+    for (long long i = 0; i < 500; i++) {
+        set_int_insert(&s, i % 100);
+    }
+    long long sum = 0;
+    for (size_t i = 0; i < set_int_size(&s); i++) {
+        sum += set_int_get_nth_element(&s, i);
+    }
+    printf("%zu %lld %d %d\\n", set_int_size(&s), sum, set_int_contains(&s, 42), set_int_contains(&s, 100));
+    set_int_drop(&s);
+
+    map_int_int m;
+    map_int_int_init_ptr(&m);
+    for (long long i = 0; i < 300; i++) {
+        *map_int_int_slot(&m, i % 50) += 1;
+    }
+    map_int_int_set(&m, 7, 70);
+    long long values = 0;
+    for (size_t i = 0; i < map_int_int_capacity(&m); i++) {
+        if (map_int_int_entry_is_occupied(&m, i)) {
+            values += map_int_int_entry_value(&m, i);
+        }
+    }
+    printf("%lld %lld %lld %d\\n", map_int_int_get(&m, 7), map_int_int_get(&m, 99), values,
+           map_int_int_contains(&m, 49));
+    map_int_int_free(&m);
+    return 0;
+}
+"""
+
+
+class TestLLVMTemplateRuntime:
+    """Test the LLVM backend's int containers over the C backend's templates."""
+
+    def test_adapters_over_generated_i64_containers(self):
+        """vec_int, set_int and map_int_int keep the IR's calling convention on vec/set/map_i64."""
+        codegen = ContainerCodeGenerator()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            tmp = Path(tmpdir)
+            sources = []
+            for container in ("vec_i64", "set_i64", "map_i64_i64"):
+                header, implementation = codegen.generate_runtime_sources(container)
+                (tmp / f"mgen_{container}.h").write_text(header)
+                (tmp / f"mgen_{container}.c").write_text(implementation)
+                sources.append(str(tmp / f"mgen_{container}.c"))
+            for name in ("vec_int_minimal.c", "set_int_minimal.c", "map_int_int_minimal.c"):
+                sources.append(str(LLVM_RUNTIME_DIR / name))
+            (tmp / "harness.c").write_text(LLVM_INT_RUNTIME_PROGRAM)
+            exe = tmp / "harness"
+
+            cmd = ["gcc", "-std=c11", "-Wall", "-Werror", "-O2", f"-I{tmp}", str(tmp / "harness.c"), *sources]
+            build = subprocess.run([*cmd, "-o", str(exe)], capture_output=True, text=True)
+            assert build.returncode == 0, build.stderr
+            run = subprocess.run([str(exe)], capture_output=True, text=True, timeout=30)
+
+        assert run.returncode == 0, run.stderr
+        assert run.stdout == "1000 -1 4995000000000\n100 4950 1 0\n70 0 364 1\n"
+
+
+TEMPLATED_CONTAINERS_CHURN = """
+#include <stdio.h>
+CONTAINER_HEADERS
+
+#define RANGE 4000
+
+int main(void) {
+    map_double_int m = {0};
+    set_double s = {0};
+    map_str_double names = {0};
+    static int ref[RANGE];
+    static bool has[RANGE];
+    char key[32];
+    unsigned seed = 4242;
+
+    for (int it = 0; it < 200000; it++) {
+        seed = seed * 1103515245u + 12345u;
+        int k = (int)((seed >> 8) % RANGE);
+        int op = (seed >> 3) & 3;
+        // Keys collide in few buckets: multiples of 1024 share their low hash bits only by chance
+        double x = (k - RANGE / 2) * 0.5;
+        snprintf(key, sizeof key, "k%d", k);
+        if (op < 2) {
+            map_double_int_insert(&m, x, it);
+            if (set_double_insert(&s, x) == has[k]) { printf("set insert mismatch\\n"); return 1; }
+            map_str_double_insert(&names, key, x);
+            has[k] = true;
+            ref[k] = it;
+        } else if (op == 2) {
+            map_double_int_erase(&m, x);
+            map_str_double_erase(&names, key);
+            if (set_double_erase(&s, x) != has[k]) { printf("set erase mismatch\\n"); return 1; }
+            has[k] = false;
+        } else {
+            int* v = map_double_int_get(&m, x);
+            double* d = map_str_double_get(&names, key);
+            if ((v != NULL) != has[k] || (d != NULL) != has[k] || set_double_contains(&s, x) != has[k]) {
+                printf("lookup mismatch\\n");
+                return 1;
+            }
+            if (v && (*v != ref[k] || *d != x)) { printf("value mismatch\\n"); return 1; }
+        }
+    }
+
+    size_t live = 0;
+    for (int k = 0; k < RANGE; k++) {
+        live += has[k];
+    }
+    if (live != map_double_int_size(&m) || live != set_double_size(&s) || live != map_str_double_size(&names)) {
+        printf("size mismatch\\n");
+        return 1;
+    }
+
+    // 0.0 == -0.0 is one key, as in Python
+    set_double_clear(&s);
+    set_double_insert(&s, 0.0);
+    printf("%d %zu\\n", set_double_insert(&s, -0.0), set_double_size(&s));
+
+    vec_int a = {0};
+    vec_int b = {0};
+    for (int i = 0; i < 100; i++) {
+        vec_int_push(&a, i);
+        vec_int_push(&b, i);
+    }
+    printf("%d", vec_int_equal(&a, &b));
+    *vec_int_at(&b, 99) = -1;
+    printf(" %d\\n", vec_int_equal(&a, &b));
+
+    map_double_int_drop(&m);
+    set_double_drop(&s);
+    map_str_double_drop(&names);
+    vec_int_drop(&a);
+    vec_int_drop(&b);
+    printf("OK\\n");
+    return 0;
+}
+"""
+
+
+TEMPLATED_MAP_ORDER = """
+#include <stdio.h>
+CONTAINER_HEADERS
+
+int main(void) {
+    map_int_double d = {0};
+    for (int i = 0; i < 1000; i++) map_int_double_insert(&d, (i * 7919) % 1000, i);
+    for (int i = 0; i < 1000; i += 3) map_int_double_erase(&d, (i * 7919) % 1000);
+    map_int_double_insert(&d, 919, -1);
+    map_int_double_insert(&d, 0, 5);
+    // Sliding window: erased entries are compacted away instead of growing the table
+    for (int r = 0; r < 100000; r++) {
+        map_int_double_insert(&d, 5000 + r, r);
+        map_int_double_erase(&d, 4990 + r);
+    }
+    int shown = 0;
+    for (map_int_double_iter it = map_int_double_begin(&d); it.ref; map_int_double_next(&it)) {
+        printf(shown++ ? " %d" : "%d", it.ref->key);
+    }
+    printf("\\n");
+
+    map_str_double names = {0};
+    char key[16];
+    for (int i = 0; i < 100; i++) {
+        snprintf(key, sizeof key, "k%d", 99 - i);
+        map_str_double_insert(&names, key, i);
+    }
+    map_str_double_erase(&names, "k99");
+    map_str_double_insert(&names, "k5", -5);
+    map_str_double_insert(&names, "k99", 99);
+    shown = 0;
+    for (map_str_double_iter it = map_str_double_begin(&names); it.ref; map_str_double_next(&it)) {
+        printf(shown++ ? " %s" : "%s", it.ref->key);
+    }
+    printf("\\n%zu %zu %d\\n", map_int_double_size(&d), map_str_double_size(&names), d.capacity <= 2048);
+    map_int_double_drop(&d);
+    map_str_double_drop(&names);
+    return d.capacity == 0 && names.capacity == 0 ? 0 : 1;
+}
+"""
+
+
+class TestTemplatedContainersRuntime:
+    """Test template-generated containers for float and str keys against a reference model."""
+
+    def test_float_and_string_keys_churn(self):
+        """Insert/erase churn keeps probe chains intact; -0.0 and 0.0 are one key; vec_int compares by memcmp."""
+        codegen = ContainerCodeGenerator()
+        generated = "".join(
+            codegen.generate_container(container)
+            for container in ("vec_int", "set_double", "map_double_int", "map_str_double")
+        )
+        assert "memcmp(a->data, b->data" in generated
+
+        prelude = "#include <stdio.h>\n#include <stdlib.h>\n#include <stdbool.h>\n#include <string.h>\n"
+        prelude += "#include <stdint.h>\n"
+        source = TEMPLATED_CONTAINERS_CHURN.replace("CONTAINER_HEADERS", generated)
+        assert compile_and_run(prelude + source, extra_flags=("-Wextra", "-Werror")) == "0 1\n1 0\nOK\n"
+
+    def test_maps_iterate_in_insertion_order(self):
+        """Template maps iterate like Python dicts: updates keep their place, re-added keys go last."""
+        codegen = ContainerCodeGenerator()
+        generated = "".join(codegen.generate_container(container) for container in ("map_int_double", "map_str_double"))
+        prelude = "#include <stdio.h>\n#include <stdlib.h>\n#include <stdbool.h>\n#include <string.h>\n"
+        prelude += "#include <stdint.h>\n"
+        output = compile_and_run(prelude + TEMPLATED_MAP_ORDER.replace("CONTAINER_HEADERS", generated))
+
+        # The same operations on Python dicts
+        d = {}
+        for i in range(1000):
+            d[(i * 7919) % 1000] = i
+        for i in range(0, 1000, 3):
+            del d[(i * 7919) % 1000]
+        d[919] = -1
+        d[0] = 5
+        for r in range(100000):
+            d[5000 + r] = r
+            d.pop(4990 + r, None)
+        names = {f"k{99 - i}": i for i in range(100)}
+        del names["k99"]
+        names["k5"] = -5
+        names["k99"] = 99
+        expected = [" ".join(map(str, d)), " ".join(names), f"{len(d)} {len(names)} 1"]
+        assert output == "\n".join(expected) + "\n"
+
+
+PARALLEL_PROGRAM = """
+#include <stdio.h>
+#include <stdlib.h>
+#include "mgen_parallel.h"
+
+typedef struct { const int* xs; int* out; int k; } ctx_t;
+
+static void scale(void* arg, size_t begin, size_t end) {
+    ctx_t* ctx = arg;
+    for (size_t i = begin; i < end; i++) {
+        // Uneven work: later iterations loop longer
+        int v = ctx->xs[i];
+        for (size_t j = 0; j < i % 64; j++) v = (v * 31 + ctx->k) % 1000003;
+        ctx->out[i] = v;
+    }
+}
+
+static void sums(void* arg, size_t begin, size_t end, long long* s) {
+    ctx_t* ctx = arg;
+    for (size_t i = begin; i < end; i++) {
+        s[0] += ctx->out[i];
+        s[1] += 1;
+    }
+}
+
+static void nested(void* arg, size_t begin, size_t end, long long* s) {
+    long long inner[2] = {0, 0};
+    mgen_parallel_reduce(end - begin, 1, sums, arg, inner, 2);
+    s[0] += inner[1];
+}
+
+static void square(void* ctx, const void* in, void* out) {
+    (void)ctx;
+    *(double*)out = (double)*(const int*)in * *(const int*)in;
+}
+
+int main(void) {
+    size_t n = 1000000;
+    int* xs = malloc(n * sizeof(int));
+    int* out = malloc(n * sizeof(int));
+    int* ref = malloc(n * sizeof(int));
+    double* sq = malloc(n * sizeof(double));
+    for (size_t i = 0; i < n; i++) xs[i] = (int)(i % 977);
+    ctx_t ctx = {xs, ref, 7};
+    scale(&ctx, 0, n);
+    ctx.out = out;
+    for (int round = 0; round < 20; round++) {
+        mgen_parallel_for(n, 1000, scale, &ctx);
+        for (size_t i = 0; i < n; i++) {
+            if (out[i] != ref[i]) { printf("mismatch %zu\\n", i); return 1; }
+        }
+    }
+    long long s[2] = {0, 0};
+    mgen_parallel_reduce(n, 1000, sums, &ctx, s, 2);
+    long long expect = 0;
+    for (size_t i = 0; i < n; i++) expect += ref[i];
+    // Chunks of the outer job run their inner reductions serially
+    long long t[1] = {0};
+    mgen_parallel_reduce(n, 1000, nested, &ctx, t, 1);
+    mgen_parallel_map(xs, sizeof(int), sq, sizeof(double), n, 1000, square, NULL);
+    // Below the threshold the caller adds to the existing sums itself
+    long long small[2] = {5, 0};
+    mgen_parallel_reduce(10, 1000, sums, &ctx, small, 2);
+    printf("%d %d %lld %.0f %lld %d\\n", s[0] == expect, (int)s[1], t[0], sq[n - 1], small[1],
+           mgen_parallel_threads() >= 1);
+    return 0;
+}
+"""
+
+
+class TestParallelRuntime:
+    """Test the mgen_parallel work-stealing pool against serial results."""
+
+    def test_pool_matches_serial_results(self):
+        """Uneven chunks, sums, nested calls, buffer maps and short ranges give the serial results."""
+        for threads in ("4", "1"):
+            with mock.patch.dict(os.environ, {"MGEN_NUM_THREADS": threads}):
+                output = compile_and_run(PARALLEL_PROGRAM, ("-Wextra", "-Werror", "-pthread"), ("mgen_parallel.c",))
+            assert output == "1 1000000 1000000 278784 10 1\n"
+
+    def test_serial_without_threads(self):
+        """MGEN_NO_THREADS builds run every job on the caller."""
+        output = compile_and_run(PARALLEL_PROGRAM, ("-DMGEN_NO_THREADS",), ("mgen_parallel.c",))
+        assert output == "1 1000000 1000000 278784 10 1\n"
+
+
+SHARDED_COUNT_PROGRAM = """
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mgen_str_int_sharded.h"
+
+#define WORDS 200000
+#define VOCAB 5000
+
+typedef struct { char (*words)[16]; } ctx_t;
+
+static void count_words(void* arg, size_t begin, size_t end, mgen_str_int_map_t* local) {
+    ctx_t* ctx = arg;
+    for (size_t i = begin; i < end; i++) {
+        *mgen_str_int_map_get_or_insert(local, ctx->words[i], 0) += 1;
+    }
+}
+
+static mgen_str_int_sharded_t* direct;
+
+static void add_directly(void* arg, size_t begin, size_t end) {
+    ctx_t* ctx = arg;
+    for (size_t i = begin; i < end; i++) {
+        mgen_str_int_sharded_add(direct, ctx->words[i], 2);
+    }
+}
+
+int main(void) {
+    static char words[WORDS][16];
+    static int ref[VOCAB];
+    unsigned s = 42;
+    for (size_t i = 0; i < WORDS; i++) {
+        s = s * 1103515245u + 12345u;
+        // Skewed: low word numbers are far more frequent
+        unsigned w = ((s >> 8) % (VOCAB - 7)) * ((s >> 20) % 4 == 0) + ((s >> 3) % 7);
+        snprintf(words[i], sizeof words[i], "w%u", w);
+        ref[w]++;
+    }
+    ctx_t ctx = {words};
+
+    mgen_str_int_sharded_t* counts = mgen_str_int_sharded_new(0);
+    direct = mgen_str_int_sharded_new(3);
+    if (!mgen_str_int_sharded_count(counts, WORDS, 1000, count_words, &ctx)) return 1;
+    // A second job adds to the same shards
+    if (!mgen_str_int_sharded_count(counts, WORDS, 1000, count_words, &ctx)) return 1;
+    mgen_parallel_for(WORDS, 1000, add_directly, &ctx);
+
+    size_t distinct = 0;
+    for (unsigned w = 0; w < VOCAB; w++) {
+        char key[16];
+        snprintf(key, sizeof key, "w%u", w);
+        int* a = mgen_str_int_sharded_get(counts, key);
+        int* b = mgen_str_int_sharded_get(direct, key);
+        if (!ref[w]) {
+            if (a || b) { printf("unexpected %s\\n", key); return 1; }
+            continue;
+        }
+        distinct++;
+        if (!a || *a != 2 * ref[w] || !b || *b != 2 * ref[w]) { printf("mismatch %s\\n", key); return 1; }
+    }
+
+    mgen_str_int_map_t* out = mgen_str_int_map_new();
+    mgen_str_int_map_insert(out, "w0", 1000);
+    mgen_str_int_sharded_collect(counts, out);
+    printf("%d %d %d %d\\n", mgen_str_int_sharded_size(counts) == distinct,
+           mgen_str_int_sharded_size(direct) == distinct, mgen_str_int_map_size(out) == distinct,
+           *mgen_str_int_map_get(out, "w0") == 1000 + 2 * ref[0]);
+    mgen_str_int_map_free(out);
+    mgen_str_int_sharded_free(counts);
+    mgen_str_int_sharded_free(direct);
+    return 0;
+}
+"""
+
+
+BITSET_PROGRAM = """
+#include <stdio.h>
+#include "mgen_bitset_int.h"
+
+static void show(const bitset_int* set) {
+    printf("%zu:", bitset_int_size(set));
+    for (int v = -2; v < 70000; v++) {
+        if (bitset_int_contains(set, v)) {
+            printf(" %d", v);
+        }
+    }
+    printf("\\n");
+}
+
+int main(void) {
+    bitset_int a = {0};
+    bitset_int b = {0};
+    bitset_int_reserve(&b, 100);
+    for (int i = 0; i < 200; i++) {
+        bitset_int_insert(&a, i * 7 % 130);
+        bitset_int_insert(&b, i * 3 % 97);
+    }
+    bool first = bitset_int_insert(&a, 5);
+    printf("%d %d\\n", first, bitset_int_insert(&a, 131));
+    first = bitset_int_erase(&a, 131);
+    printf("%d %d\\n", first, bitset_int_erase(&a, 131));
+    first = bitset_int_contains(&a, -1);
+    printf("%d %d\\n", first, bitset_int_insert(&a, -1));
+    bitset_int_insert(&a, 65535);
+    show(&a);
+
+    bitset_int u = {0};
+    bitset_int_union_with(&u, &a);
+    printf("%d\\n", bitset_int_equal(&u, &a));
+    bitset_int_union_with(&u, &b);
+    show(&u);
+    bitset_int_intersect_with(&u, &b);
+    printf("%d\\n", bitset_int_equal(&u, &b));
+    bitset_int_difference_with(&u, &a);
+    show(&u);
+    bitset_int_intersect_with(&a, &b);
+    show(&a);
+
+    bitset_int_clear(&b);
+    printf("%d %zu\\n", bitset_int_empty(&b), bitset_int_size(&b));
+    bitset_int_drop(&a);
+    bitset_int_drop(&b);
+    bitset_int_drop(&u);
+    return 0;
+}
+"""
+
+
+class TestBitsetRuntime:
+    """Test the dense bitset set of mgen_bitset_int.h."""
+
+    def test_set_algebra_matches_python(self):
+        """Membership, erase and the word-wide union/intersection/difference match Python sets."""
+        output = compile_and_run(BITSET_PROGRAM)
+        a = {i * 7 % 130 for i in range(200)} | {65535}
+        b = {i * 3 % 97 for i in range(200)}
+
+        def show(values: set[int]) -> str:
+            return f"{len(values)}:" + "".join(f" {v}" for v in sorted(values)) + "\n"
+
+        expected = "0 1\n1 0\n0 0\n" + show(a) + "1\n" + show(a | b) + "1\n" + show(b - a) + show(a & b)
+        assert output == expected + "1 0\n"
+
+
+class TestShardedStrIntMap:
+    """Test the sharded string -> int map and its pool counting jobs."""
+
+    def test_parallel_counts_match_serial(self):
+        """Pooled counting, direct concurrent adds and collecting into a plain map give the serial counts."""
+        for threads in ("4", "1"):
+            with mock.patch.dict(os.environ, {"MGEN_NUM_THREADS": threads}):
+                output = compile_and_run(SHARDED_COUNT_PROGRAM, ("-pthread",), ("mgen_parallel.c", "mgen_memory_ops.c"))
+            assert output == "1 1 1 1\n"
+
+    def test_without_threads(self):
+        """MGEN_NO_THREADS builds count on the caller without locks."""
+        output = compile_and_run(
+            SHARDED_COUNT_PROGRAM, ("-DMGEN_NO_THREADS",), ("mgen_parallel.c", "mgen_memory_ops.c")
+        )
+        assert output == "1 1 1 1\n"
+
+
+SNAPSHOT_PROGRAM = """
+#include <stdio.h>
+#include "mgen_snapshot.h"
+
+#define i_type vec_int
+#define i_key int
+#include "stc/vec.h"
+
+#define i_type vec_double
+#define i_key double
+#include "stc/vec.h"
+
+static int sum(vec_int xs) {
+    int total = 0;
+    for (isize i = 0; i < xs.size; i++) total += xs.data[i];
+    return total;
+}
+
+int main(void) {
+    vec_int ids = {0};
+    for (int i = 0; i < 10000; i++) vec_int_push(&ids, i * 3);
+    vec_double weights = {0};
+    vec_double_push(&weights, 0.5);
+    vec_double_push(&weights, -2.25);
+    map_str_str table = {0};
+    char key[32], value[32];
+    for (int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof key, "key%d", i);
+        snprintf(value, sizeof value, "value%d", i * i);
+        map_str_str_insert(&table, key, value);
+    }
+    map_str_str_insert(&table, "", "empty key");
+    map_str_str empty = {0};
+
+    if (mgen_container_save(vec_int, "DIR/ids.snap", &ids) != MGEN_OK) return 1;
+    if (mgen_container_save(vec_double, "DIR/weights.snap", &weights) != MGEN_OK) return 1;
+    if (mgen_container_save(map_str_str, "DIR/table.snap", &table) != MGEN_OK) return 1;
+    if (mgen_container_save(map_str_str, "DIR/empty.snap", &empty) != MGEN_OK) return 1;
+
+    // In place: the mapped items and slot table
+    mgen_snapshot_t snapshot;
+    if (mgen_snapshot_open("DIR/ids.snap", MGEN_SNAPSHOT_INT, &snapshot) != MGEN_OK) return 1;
+    printf("%zu %d\\n", mgen_snapshot_size(&snapshot), sum(MGEN_SNAPSHOT_VEC_VIEW(vec_int, &snapshot)));
+    mgen_snapshot_close(&snapshot);
+    if (mgen_snapshot_open("DIR/table.snap", MGEN_SNAPSHOT_STR_STR, &snapshot) != MGEN_OK) return 1;
+    printf("%zu %s %s %s %d\\n", mgen_snapshot_size(&snapshot), mgen_snapshot_str_str_get(&snapshot, "key4999"),
+           mgen_snapshot_str_str_get(&snapshot, "key7"), mgen_snapshot_str_str_get(&snapshot, ""),
+           mgen_snapshot_str_str_get(&snapshot, "key5000") == NULL);
+    mgen_snapshot_close(&snapshot);
+    if (mgen_snapshot_open("DIR/empty.snap", MGEN_SNAPSHOT_STR_STR, &snapshot) != MGEN_OK) return 1;
+    printf("%zu %d\\n", mgen_snapshot_size(&snapshot), mgen_snapshot_str_str_get(&snapshot, "key") == NULL);
+    mgen_snapshot_close(&snapshot);
+
+    // Loaded back into owned containers, replacing what they held
+    vec_int loaded = {0};
+    vec_int_push(&loaded, 42);
+    if (mgen_container_load(vec_int, "DIR/ids.snap", &loaded) != MGEN_OK) return 1;
+    vec_int_push(&loaded, 1);
+    vec_double loaded_weights = {0};
+    if (mgen_container_load(vec_double, "DIR/weights.snap", &loaded_weights) != MGEN_OK) return 1;
+    map_str_str loaded_table = {0};
+    if (mgen_container_load(map_str_str, "DIR/table.snap", &loaded_table) != MGEN_OK) return 1;
+    map_str_str_insert(&loaded_table, "key7", "changed");
+    printf("%d %d %g %s %s %zu\\n", (int)loaded.size, sum(loaded), loaded_weights.data[1],
+           *map_str_str_get(&loaded_table, "key12"), *map_str_str_get(&loaded_table, "key7"),
+           map_str_str_size(&loaded_table));
+
+    // The wrong kind and damaged files are rejected
+    printf("%d %d %d\\n", mgen_snapshot_open("DIR/ids.snap", MGEN_SNAPSHOT_DOUBLE, &snapshot) == MGEN_ERROR_VALUE,
+           mgen_snapshot_open("DIR/truncated.snap", MGEN_SNAPSHOT_STR_STR, &snapshot) == MGEN_ERROR_VALUE,
+           mgen_container_load(vec_int, "DIR/missing.snap", &loaded) != MGEN_OK);
+
+    vec_int_drop(&ids);
+    vec_int_drop(&loaded);
+    vec_double_drop(&weights);
+    vec_double_drop(&loaded_weights);
+    map_str_str_drop(&table);
+    map_str_str_drop(&loaded_table);
+    return 0;
+}
+"""
+
+
+class TestSnapshotRuntime:
+    """Test binary container snapshots written by mgen_container_save and used in place or loaded."""
+
+    def test_save_open_and_load(self, tmp_path):
+        """Vec and map snapshots read back in place and into owned containers; bad files are rejected."""
+        (tmp_path / "truncated.snap").write_bytes(b"MGENSNAP" + bytes(20))
+        stc = RUNTIME_DIR.parent / "ext" / "stc" / "include"
+        output = compile_and_run(
+            SNAPSHOT_PROGRAM.replace("DIR", str(tmp_path)),
+            (f"-I{stc}",),
+            ("mgen_file_ops.c", "mgen_string_ops.c", "mgen_memory_ops.c"),
+        )
+
+        total = sum(i * 3 for i in range(10000))
+        assert output.splitlines() == [
+            f"10000 {total}",
+            "5001 value24990001 value49 empty key 1",
+            "0 1",
+            f"10001 {total + 1} -2.25 value144 changed 5001",
+            "1 1 1",
+        ]
+        # A 64-byte aligned header, then the raw items
+        assert (tmp_path / "ids.snap").stat().st_size == 128 + 10000 * 4
+
+
+ALIGNED_VEC_PROGRAM = """
+#include <stdint.h>
+#include <stdio.h>
+#include "mgen_aligned_alloc.h"
+#define i_allocator mgen_aligned
+#define i_type vec_double
+#define i_key double
+#include "stc/vec.h"
+
+int main(void) {
+    vec_double v = {0};
+    int misaligned = 0;
+    for (int i = 0; i < 10000; i++) {
+        vec_double_push(&v, i * 0.5);
+        misaligned += ((uintptr_t)v.data % MGEN_VEC_ALIGNMENT) != 0;
+    }
+    double* MGEN_RESTRICT data = MGEN_ASSUME_ALIGNED(v.data);
+    double total = 0.0;
+    for (ptrdiff_t i = 0; i < v.size; i++) {
+        total += data[i];
+    }
+    vec_double copy = vec_double_clone(v);
+    misaligned += ((uintptr_t)copy.data % MGEN_VEC_ALIGNMENT) != 0;
+    printf("%d %.1f %.1f\\n", misaligned, total, copy.data[9999]);
+    vec_double_drop(&copy);
+    vec_double_drop(&v);
+    return 0;
+}
+"""
+
+
+class TestAlignedVectorRuntime:
+    """Test the mgen_aligned STC allocator behind the aligned_vectors preference."""
+
+    def test_buffers_stay_aligned_as_they_grow(self):
+        """Every reallocation and clone is MGEN_VEC_ALIGNMENT-aligned and keeps the items."""
+        stc = RUNTIME_DIR.parent / "ext" / "stc" / "include"
+        output = compile_and_run(ALIGNED_VEC_PROGRAM, (f"-I{stc}",))
+
+        assert output.split() == ["0", str(sum(i * 0.5 for i in range(10000))), "4999.5"]
+
+
+RCSTR_PROGRAM = """
+#include <stdio.h>
+#include "mgen_rcstr.h"
+
+int main(void) {
+    mgen_rcstr_t hello = mgen_rcstr_new("hello");
+    mgen_rcstr_t alias = mgen_rcstr_retain(hello);
+    printf("%d %d %zu\\n", alias == hello, mgen_rcstr_refcount(hello), mgen_rcstr_len(hello));
+
+    // Copy on write: the other holder keeps the original bytes
+    char* bytes = mgen_rcstr_mutable(&alias);
+    bytes[0] = 'j';
+    printf("%s %s %d %d\\n", hello, alias, mgen_rcstr_refcount(hello), mgen_rcstr_refcount(alias));
+
+    // Unshared appends grow in place once capacity has doubled
+    mgen_rcstr_t text = mgen_rcstr_new("");
+    int moves = 0;
+    for (int i = 0; i < 1000; i++) {
+        const char* before = text;
+        mgen_rcstr_append(&text, "ab");
+        moves += text != before;
+    }
+    printf("%zu %zu %d\\n", mgen_rcstr_len(text), strlen(text), moves < 20);
+
+    // Appending to a shared string leaves the other holder untouched
+    mgen_rcstr_t base = mgen_rcstr_retain(hello);
+    mgen_rcstr_append(&base, " world");
+    printf("%s|%s %d\\n", hello, base, mgen_rcstr_refcount(hello));
+
+    mgen_rcstr_t whole = mgen_rcstr_slice(base, 0, 100);
+    mgen_rcstr_t tail = mgen_rcstr_slice(base, -5, 11);
+    mgen_rcstr_t empty = mgen_rcstr_slice(base, 3, 1);
+    printf("%d %s [%s]\\n", whole == base, tail, empty);
+
+    // Containers share their elements
+    vec_rcstr names = {0};
+    for (int i = 0; i < 100; i++) {
+        vec_rcstr_push(&names, hello);
+    }
+    vec_rcstr_push_owned(&names, mgen_rcstr_concat(hello, "!"));
+    vec_rcstr_push_cstr(&names, "literal");
+    vec_rcstr copy = vec_rcstr_clone(&names);
+    vec_rcstr_set(&copy, 0, tail);
+    printf("%zu %d %s %s %s\\n", vec_rcstr_size(&copy), mgen_rcstr_refcount(hello), vec_rcstr_at(&copy, 0),
+           vec_rcstr_at(&names, 100), vec_rcstr_at(&copy, 101));
+    vec_rcstr_drop(&copy);
+    vec_rcstr_drop(&names);
+    printf("%d %d\\n", mgen_rcstr_refcount(hello), mgen_rcstr_refcount(tail));
+
+    mgen_rcstr_release(empty);
+    mgen_rcstr_release(whole);
+    mgen_rcstr_release(tail);
+    mgen_rcstr_release(base);
+    mgen_rcstr_release(text);
+    mgen_rcstr_release(alias);
+    mgen_rcstr_release(hello);
+    return 0;
+}
+"""
+
+
+class TestSharedStringRuntime:
+    """Test the copy-on-write reference counted strings of mgen_rcstr.h."""
+
+    @pytest.mark.parametrize("flags", [(), ("-DMGEN_ATOMIC_REFCOUNTS",)])
+    def test_sharing_and_copy_on_write(self, flags):
+        """Retains share one buffer; writes and shorter slices copy; vec_rcstr holds references."""
+        output = compile_and_run(RCSTR_PROGRAM, flags, ("mgen_memory_ops.c",))
+
+        assert output.splitlines() == [
+            "1 2 5",
+            "hello jello 1 1",
+            "2000 2000 1",
+            "hello|hello world 1",
+            "1 world []",
+            "102 200 world hello! literal",
+            "1 1",
+        ]
@@ -0,0 +1,90 @@
+"""Tests for the content-addressed conversion cache."""
+
+import tempfile
+from pathlib import Path
+
+from mgen.backends.preferences import PreferencesRegistry
+from mgen.cache import ConversionCache, generation_options, local_dependencies
+from mgen.pipeline import MGenPipeline, PipelineConfig, PipelinePhase
+
+SOURCE = "def add(x: int, y: int) -> int:\n    return x + y\n"
+
+
+class TestConversionCache:
+    """Test cache hits, misses and key invalidation."""
+
+    def setup_method(self):
+        """Create a module and a cache directory."""
+        self.temp_dir = tempfile.TemporaryDirectory()
+        self.root = Path(self.temp_dir.name)
+        self.source = self.root / "module.py"
+        self.source.write_text(SOURCE)
+        self.cache_dir = self.root / ".cache"
+        self.output_dir = self.root / "out"
+        self.output_dir.mkdir()
+
+    def teardown_method(self):
+        """Remove the temporary files."""
+        self.temp_dir.cleanup()
+
+    def convert(self, target="c", **options):
+        """Convert the module with a fresh pipeline using the cache."""
+        config = PipelineConfig(target_language=target, cache_dir=str(self.cache_dir), **options)
+        return MGenPipeline(config).convert(str(self.source), str(self.output_dir))
+
+    def test_second_conversion_is_cached(self):
+        """Test that an unchanged module is restored from the cache with identical output."""
+        first = self.convert()
+        assert first.success, first.errors
+        assert not first.cached
+
+        generated = Path(first.output_files["c_source"])
+        generated.unlink()
+        second = self.convert()
+        assert second.success, second.errors
+        assert second.cached
+        assert second.generated_code == first.generated_code
+        assert generated.read_text() == first.generated_code
+        assert PipelinePhase.ANALYSIS in second.phase_results
+
+    def test_source_edit_misses(self):
+        """Test that editing the module invalidates its entry."""
+        self.convert()
+        self.source.write_text(SOURCE + "\n\ndef sub(x: int, y: int) -> int:\n    return x - y\n")
+        result = self.convert()
+        assert result.success, result.errors
+        assert not result.cached
+        assert "sub" in result.generated_code
+
+    def test_imported_module_edit_changes_key(self):
+        """Test that editing a local module imported by the source changes the key."""
+        helper = self.root / "helper.py"
+        helper.write_text("def one() -> int:\n    return 1\n")
+        code = "from helper import one\n" + SOURCE
+        cache = ConversionCache(self.cache_dir)
+        options = generation_options(PipelineConfig(target_language="c"))
+
+        assert local_dependencies(self.source, code) == [helper.resolve()]
+        before = cache.key(self.source, code, options)
+        helper.write_text("def one() -> int:\n    return 2\n")
+        assert cache.key(self.source, code, options) != before
+
+    def test_options_change_key(self):
+        """Test that the target language and backend preferences are part of the key."""
+        cache = ConversionCache(self.cache_dir)
+        c_config = PipelineConfig(target_language="c")
+        key = cache.key(self.source, SOURCE, generation_options(c_config))
+        assert cache.key(self.source, SOURCE, generation_options(PipelineConfig(target_language="rust"))) != key
+
+        c_config.backend_preferences = PreferencesRegistry.create_preferences("c")
+        c_config.backend_preferences.set("use_stc_containers", False)
+        assert cache.key(self.source, SOURCE, generation_options(c_config)) != key
+
+    def test_unreadable_entry_is_a_miss(self):
+        """Test that a corrupt entry is ignored and reconverted."""
+        self.convert()
+        for entry in self.cache_dir.rglob("entry.json"):
+            entry.write_text("{")
+        result = self.convert()
+        assert result.success, result.errors
+        assert not result.cached
@@ -7,6 +7,7 @@ It ensures that:
 3. Output matches expected results
 """
 
+import shutil
 import subprocess
 import tempfile
 from pathlib import Path
@@ -14,6 +15,7 @@ from typing import Optional
 
 import pytest
 
+from mgen.common.makefilegen import Builder
 from mgen.pipeline import MGenPipeline, PipelineConfig, BuildMode
 from mgen.backends.registry import registry
 
@@ -291,3 +293,50 @@ class TestCrossBackendConsistency:
 
         assert success, f"Backend {backend} failed: {stderr}"
         assert stdout == "HELLO", f"Backend {backend} output mismatch: got '{stdout}'"
+
+
+@pytest.mark.skipif(shutil.which("gcc") is None, reason="gcc not available")
+class TestIncrementalBuilder:
+    """Test per-file object compilation in makefilegen's Builder."""
+
+    def setup_method(self):
+        """Create a two-file C project whose library includes a header."""
+        self.temp_dir = tempfile.TemporaryDirectory()
+        root = Path(self.temp_dir.name)
+        (root / "src").mkdir()
+        self.header = root / "src" / "value.h"
+        self.header.write_text("#define VALUE 1\n")
+        (root / "src" / "value.c").write_text('#include "value.h"\nint value(void) { return VALUE; }\n')
+        (root / "src" / "main.c").write_text(
+            '#include <stdio.h>\nint value(void);\nint main(void) { printf("%d", value()); return 0; }\n'
+        )
+        self.executable = root / "app"
+        self.builder = Builder(
+            name=str(self.executable), source_dir=str(root / "src"), build_dir=str(root / "obj"), use_stc=False
+        )
+
+    def teardown_method(self):
+        """Remove the project."""
+        self.temp_dir.cleanup()
+
+    def stale_sources(self):
+        """Names of the sources the next build would recompile."""
+        sources = self.builder.get_source_files()
+        return sorted(source.name for source in sources if not self.builder.is_up_to_date(source))
+
+    def test_only_changed_sources_recompile(self):
+        """Test that a header edit recompiles only the files that include it."""
+        assert self.builder.build(jobs=2)
+        assert subprocess.run([str(self.executable)], capture_output=True, text=True).stdout == "1"
+        assert self.stale_sources() == []
+
+        self.header.write_text("#define VALUE 2\n")
+        assert self.stale_sources() == ["value.c"]
+        assert self.builder.build(jobs=2)
+        assert subprocess.run([str(self.executable)], capture_output=True, text=True).stdout == "2"
+
+    def test_flag_change_recompiles(self):
+        """Test that changing the compile flags invalidates every object."""
+        assert self.builder.build()
+        self.builder.flags.append("-O1")
+        assert self.stale_sources() == ["main.c", "value.c"]
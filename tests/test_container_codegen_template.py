@@ -37,8 +37,8 @@ class TestContainerCodeGenTemplate:
         assert "vec_str" in code
         assert "char** data;" in code
         assert "void vec_str_push(vec_str* vec, const char* value)" in code
-        # Should have strdup for ownership
-        assert "strdup" in code
+        # Should copy pushed strings for ownership
+        assert "vec->data[vec->size] = vec_str_dup(value);" in code
         assert "vec_str_drop" in code
 
     def test_generate_from_template_map_str_int(self):
@@ -78,8 +78,26 @@ class TestContainerCodeGenTemplate:
         assert "set_str" in code
         assert "char* value;" in code
         assert "bool set_str_insert(set_str* set, const char* value)" in code
-        # Should have strdup for ownership
-        assert "strdup" in code
+        # Owns a copy of every key; cached hashes are compared before strcmp
+        assert "set->buckets[idx].value = set_str_dup(value);" in code
+        assert "set->buckets[idx].hash == hash && set_str_same(" in code
+
+    def test_generate_from_template_float_keys(self):
+        """Test set_double and map_double_int hash bits and compare keys without the cached hash."""
+        code = self.codegen.generate_from_template("set_double")
+        assert code is not None
+        assert "static inline size_t hash_double(double value)" in code
+        assert "return a == b;" in code
+        assert "hash == hash" not in code
+
+        code = self.codegen.generate_from_template("map_double_int")
+        assert code is not None
+        assert "void map_double_int_insert(map_double_int* map, double key, int value)" in code
+
+    def test_generate_from_template_memcmp_equality(self):
+        """Test that vectors of integers compare with one memcmp and others elementwise."""
+        assert "memcmp(a->data, b->data" in self.codegen.generate_from_template("vec_int")
+        assert "memcmp(" not in self.codegen.generate_from_template("vec_double")
 
     def test_generate_from_template_vec_vec_int_returns_none(self):
         """Test that vec_vec_int returns None (not yet supported by templates)."""
@@ -91,6 +109,22 @@ class TestContainerCodeGenTemplate:
         code = self.codegen.generate_from_template("vec_unknown")
         assert code is None
 
+    def test_generate_runtime_sources_set_i64(self):
+        """Test instantiating a template as a separately compiled header and source."""
+        header, source = self.codegen.generate_runtime_sources("set_i64")
+        assert "#ifndef MGEN_SET_i64_H" in header
+        assert "typedef struct" in header
+        assert '#include "mgen_set_i64.h"' in source
+        assert "bool set_i64_insert(set_i64* set, long long value)" in source
+        assert "static inline size_t hash_i64(long long value)" in source
+        assert "MGEN_SET_ERROR" not in source
+        assert "mgen_error_handling.h" not in source
+
+    def test_generate_runtime_sources_unsupported(self):
+        """Test that nested vectors and unknown types have no runtime sources."""
+        assert self.codegen.generate_runtime_sources("vec_vec_i64") is None
+        assert self.codegen.generate_runtime_sources("vec_unknown") is None
+
     def test_generate_container_uses_templates(self):
         """Test that generate_container uses templates for supported types."""
         # vec_int should use template
@@ -174,3 +208,24 @@ class TestTemplateVsHardcoded:
         # Hardcoded uses str_int_map naming (different convention)
         assert "str_int_map_insert" in hardcoded_code
         assert "str_int_map_get" in hardcoded_code
+
+    def test_template_code_keeps_inline_cursors(self):
+        """Test that header-inline cursor functions survive header stripping."""
+        code = self.codegen.generate_from_template("map_int_double")
+        assert code is not None
+        assert "map_int_double_iter" in code
+        assert "static inline map_int_double_iter map_int_double_begin(const map_int_double* map) {" in code
+        assert "map_int_double_next" in code
+        assert "map_int_double_end" in code
+        assert 'extern "C"' not in code
+        assert code.count("{") == code.count("}")
+
+    def test_template_code_has_equality_helpers(self):
+        """Test that map and set templates emit type-specialized equality."""
+        map_code = self.codegen.generate_from_template("map_int_double")
+        assert "bool map_int_double_equal(const map_int_double* a, const map_int_double* b) {" in map_code
+        assert "if (*other != it.ref->value) {" in map_code
+        assert "strcmp(*other" not in map_code
+
+        set_code = self.codegen.generate_from_template("set_double")
+        assert "bool set_double_equal(const set_double* a, const set_double* b) {" in set_code
@@ -1,5 +1,6 @@
 """Tests for the CGen Frontend - Static Python Analysis Layer."""
 
+import ast
 import sys
 from pathlib import Path
 
@@ -18,7 +19,9 @@ from mgen.frontend import (
     AnalysisLevel,
     BoundsChecker,
     CallGraphAnalyzer,
+    FunctionSpecializer,
     InferenceMethod,
+    LoopNestOptimizer,
     IRDataType,
     OptimizationLevel,
     PythonConstraintChecker,
@@ -238,6 +241,26 @@ def simple(x: int) -> int:
 
         assert result.conversion_strategy == "direct_conversion"
 
+    def test_generator_loops_accepted(self):
+        """Test that a for loop may iterate a call of a generator function in the module, but no other call."""
+        code = """
+def evens(n: int) -> Iterator[int]:
+    for i in range(n):
+        yield i * 2
+
+
+def total(n: int) -> int:
+    t: int = 0
+    for e in evens(n):
+        t += e
+    return t
+"""
+        validator = StaticPythonSubsetValidator()
+
+        assert "Validation failed for Control Flow" not in validator.validate_code(code).violations
+        other = code.replace("evens(n):", "other(n):")
+        assert "Validation failed for Control Flow" in validator.validate_code(other).violations
+
 
 class TestStaticIR:
     """Test the Static IR generation."""
@@ -323,6 +346,438 @@ def loop_function(n: int) -> int:
         const_int = IRType(IRDataType.INT, is_const=True)
         assert const_int.to_c_declaration("var") == "const int var"
 
+    def test_optimization_hints_annotate_ir(self):
+        """Test hot/cold function and loop unroll hints are attached to the IR."""
+        from mgen.frontend.optimization_hints import annotate_ir_module
+        from mgen.frontend.static_ir import IRFor
+
+        code = """
+def scale(x: int) -> int:
+    return x * 3
+
+def fib(n: int) -> int:
+    if n <= 1:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+def weights() -> int:
+    total: int = 0
+    for i in range(4):
+        total += i * i
+    return total
+
+def main() -> int:
+    s: int = scale(5)
+    for i in range(100):
+        s += weights() + fib(10)
+    print(s)
+    return 0
+"""
+        ir_module = build_ir_from_code(code)
+        annotate_ir_module(ir_module, code)
+
+        functions = {func.name: func for func in ir_module.functions}
+        assert functions["scale"].annotations.optimization_hints == ["cold"]
+        assert functions["fib"].annotations.optimization_hints == ["hot"]
+        # Called from a loop, so neither hot nor cold
+        assert functions["weights"].annotations.optimization_hints == []
+        assert functions["main"].annotations.optimization_hints == []
+
+        small_loop = next(stmt for stmt in functions["weights"].body if isinstance(stmt, IRFor))
+        assert small_loop.annotations.optimization_hints == ["unroll_full"]
+        # Too many iterations, and a call in the body
+        main_loop = next(stmt for stmt in functions["main"].body if isinstance(stmt, IRFor))
+        assert main_loop.annotations.optimization_hints == []
+
+    def test_vectorization_hints_need_independent_iterations(self):
+        """Test only detector candidates with reorderable iterations get vectorize hints."""
+        from mgen.frontend.optimization_hints import OptimizationHintAnalyzer
+
+        code = """
+def dot(xs: list[int], ys: list[int], n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        total += xs[i] * ys[i]
+    return total
+
+def fsum(xs: list[float], n: int) -> float:
+    total: float = 0.0
+    for i in range(n):
+        total += xs[i]
+    return total
+
+def fill(n: int) -> int:
+    table: dict = {}
+    for i in range(n):
+        table[i] = i * 3
+    return len(table)
+"""
+        hints = OptimizationHintAnalyzer().analyze(ast.parse(code))
+
+        # Integer dot product; the float sum and the dict stores are left alone
+        assert hints.loops == {4: {"vectorize"}}
+
+    def test_vectorization_hints_reject_scatters_and_recurrences(self):
+        """Test stores off i + c and non-additive recurrences get no vectorize hint."""
+        from mgen.frontend.optimization_hints import OptimizationHintAnalyzer
+
+        code = """
+def scatter(a: list[int], out: list[int]) -> None:
+    for i in range(len(a)):
+        out[a[i]] = i
+
+def strided(a: list[int], out: list[int], n: int) -> None:
+    for i in range(n):
+        out[2 * i] = a[i]
+
+def doubling(a: list[int], n: int) -> int:
+    s: int = 0
+    for i in range(n):
+        s = s * 2 + a[i]
+    return s
+
+def shifted(a: list[int], out: list[int], n: int) -> None:
+    for i in range(n):
+        out[i + 1] = a[i] * 2
+
+def running(a: list[int], n: int) -> int:
+    s: int = 0
+    for i in range(n):
+        s = s + a[i]
+    return s
+"""
+        hints = OptimizationHintAnalyzer().analyze(ast.parse(code))
+
+        # Repeated a[i] values or s's old value tie iterations together; the offset store and the sum do not
+        assert hints.loops == {17: {"vectorize"}, 22: {"vectorize"}}
+
+    def test_parallel_loop_plans_need_independent_iterations(self):
+        """Test only loops without loop-carried dependencies or shared mutation get a parallel plan."""
+        from mgen.frontend.optimization_hints import OptimizationHintAnalyzer
+
+        code = """
+def square(x: int) -> int:
+    return x * x
+
+def scale(xs: list[int], k: int) -> int:
+    total: int = 0
+    for i in range(len(xs)):
+        v: int = square(xs[i]) * k
+        xs[i] = v
+        total += v
+    return total
+
+def prefix(xs: list[int]) -> None:
+    for i in range(1, len(xs)):
+        xs[i] = xs[i] + xs[i - 1]
+
+def last(n: int) -> int:
+    t: int = 0
+    for i in range(n):
+        t = i * 2
+    return t
+
+def show(n: int) -> None:
+    for i in range(n):
+        print(i)
+
+def fill(rows: list[list[int]], n: int) -> None:
+    for i in range(n):
+        for j in range(n):
+            rows[i][j] = i + j
+"""
+        hints = OptimizationHintAnalyzer().analyze(ast.parse(code))
+
+        # prefix() reads the previous element, last() keeps the final t, show() does I/O;
+        # the inner loop of fill() stores at rows[i], not at its own index
+        assert sorted(hints.parallel) == [7, 28]
+        plan = hints.parallel[7]
+        assert plan.reductions == ["total"]
+        assert plan.private == ["v"]
+        assert plan.written == ["xs"]
+        assert hints.parallel[28].private == ["j"]
+
+    def test_loop_bounds_proofs_classify_affine_subscripts(self):
+        """Test range loops prove a[i + c] in bounds from len() and flag the bounds left to check."""
+        from mgen.frontend.verifiers.bounds_prover import loop_bounds_proofs
+
+        code = """
+def f(a: list[int], m: list[list[int]], n: int) -> int:
+    t: int = 0
+    for i in range(1, len(a) - 1):
+        t += a[i - 1] + a[i + 1]
+    for i in range(n):
+        t += a[i + 2]
+    for i in range(len(a)):
+        t += a[i - 1]
+    for r in range(len(m)):
+        for c in range(len(m[r])):
+            t += m[r][c]
+    for i in range(len(a)):
+        a.append(t)
+    for i in range(n):
+        i = i + 1
+    return t
+"""
+        tree = ast.parse(code)
+        proofs = {proof.loop.lineno: proof for proof in loop_bounds_proofs(tree).values()}
+
+        # i = i + 1 changes the loop variable
+        assert sorted(proofs) == [4, 6, 8, 10, 11, 13]
+        assert all(access.proven for access in proofs[4].accesses)
+        [access] = proofs[6].accesses
+        assert (access.offset, access.check_lower, access.check_upper) == (2, False, True)
+        assert proofs[6].hoistable_range
+        # The implicit start is 0, so a[i - 1] reads a[-1] first
+        [access] = proofs[8].accesses
+        assert (access.offset, access.check_lower, access.check_upper) == (-1, True, False)
+        [access] = proofs[11].accesses
+        assert (access.container, access.dimension, access.proven) == ("m", 1, True)
+        # append() resizes a
+        assert proofs[13].accesses == [] and "a" not in proofs[13].stable
+
+    def test_bounded_int_sets_follow_range_loop_intervals(self):
+        """Test sets whose adds range analysis bounds are listed with their domains, escaping ones are not."""
+        from mgen.frontend.verifiers.bounds_prover import bounded_int_sets
+
+        code = """
+def f(n: int) -> set[int]:
+    grid: set[int] = set()
+    masks: set[int] = {1, 2}
+    wide: set[int] = set()
+    loose: set[int] = set()
+    shared: set[int] = set()
+    kept: set[int] = set()
+    for i in range(100):
+        for j in range(i, 200, 3):
+            grid.add(i * 200 + j)
+        masks.add(n & 255)
+        wide.add(i * 1000)
+        loose.add(n % 7)
+        shared.add(i)
+        kept.add(i)
+    grid.discard(n)
+    masks.clear()
+    t: int = len(grid) + len(shared)
+    if n in masks or n not in wide:
+        t += 1
+    print(shared)
+    return kept
+"""
+        sets = bounded_int_sets(ast.parse(code).body[0], 65536)
+
+        # i * 1000 reaches 99000; n % 7 may be negative in C; shared and kept escape
+        assert sets == {"grid": 20000, "masks": 256}
+        assert bounded_int_sets(ast.parse(code).body[0], 256) == {"masks": 256}
+
+    def test_string_dispatch_splits_keys_by_length_then_byte(self):
+        """Test dispatch trees, string match chains and constant string dicts from the evaluator."""
+        from mgen.frontend.optimizers.compile_time_evaluator import CompileTimeEvaluator, StringSwitch
+
+        evaluator = CompileTimeEvaluator()
+        dispatch = evaluator.build_string_dispatch(["add", "sub", "mul", "minus", ""])
+        assert dispatch.root.position is None and sorted(dispatch.root.cases) == [0, 3, 5]
+        three = dispatch.root.cases[3]
+        assert isinstance(three, StringSwitch) and three.position == 0
+        assert three.cases == {ord("a"): 0, ord("m"): 2, ord("s"): 1}
+
+        code = """
+if op == "add" or "plus" == op:
+    pass
+elif op in ("sub", "add"):
+    pass
+elif op == 1:
+    pass
+else:
+    pass
+"""
+        chain = evaluator.string_match_chain(ast.parse(code).body[0])
+        assert chain is not None and chain.subject == "op" and len(chain.branches) == 2
+        # "add" keeps the first branch naming it; op == 1 starts the else part
+        assert chain.dispatch.keys == [b"add", b"plus", b"sub"] and chain.key_branches == [0, 0, 1]
+        assert isinstance(chain.orelse[0], ast.If)
+        two_keys = ast.parse('if a == "x":\n    pass\nelif a == "y":\n    pass').body[0]
+        assert evaluator.string_match_chain(two_keys) is None
+
+        table = ast.parse('{"a": 1, "b": 2 * 3, "a": -4}', mode="eval").body
+        assert evaluator.constant_string_dict(table) == (["a", "b"], [-4, 6])
+        assert evaluator.constant_string_dict(ast.parse('{"a": n}', mode="eval").body) is None
+
+    def test_borrowable_parameters_exclude_escaping_and_mutated_arguments(self):
+        """Test only parameters read in place, also through recursive calls, are borrowable."""
+        from mgen.frontend.immutability_analyzer import ImmutabilityAnalyzer
+
+        code = """
+def search(xs: list[int], target: int, lo: int, hi: int) -> int:
+    if lo >= hi:
+        return -1
+    mid: int = (lo + hi) // 2
+    if xs[mid] < target:
+        return search(xs, target, mid + 1, hi)
+    return search(xs, target, lo, mid)
+
+def first(xs: list[int]) -> list[int]:
+    return xs
+
+def grow(m: list[list[int]], word: str) -> None:
+    m[0].append(len(word))
+
+def outer(m: list[list[int]], word: str) -> int:
+    grow(m, word)
+    return len(m) + len(word.upper())
+"""
+        borrowable = ImmutabilityAnalyzer().borrowable_parameters(ast.parse(code))
+
+        assert "xs" in borrowable["search"]
+        # Returned whole, mutated through an element, passed on to a mutating call
+        assert borrowable["first"] == set()
+        assert borrowable["grow"] == {"word"}
+        assert borrowable["outer"] == {"word"}
+
+    def test_escape_analysis_marks_local_fixed_size_lists(self):
+        """Test only non-escaping, non-growing lists of known size are stack allocated."""
+        from mgen.frontend.escape_analysis import annotate_stack_allocations
+
+        code = """
+def total(xs: list[int]) -> int:
+    s: int = 0
+    for x in xs:
+        s += x
+    return s
+
+def keep(xs: list[int]) -> list[int]:
+    return xs
+
+def main() -> int:
+    a: list[int] = [1, 2, 3]
+    squares: list[int] = [i * i for i in range(10)]
+    grown: list[int] = [7]
+    grown.append(8)
+    kept: list[int] = [9, 9]
+    alias: list[int] = keep(kept)
+    copied: list[int] = [x + 1 for x in a]
+    print(total(a) + total(squares) + grown[1] + alias[0] + copied[0])
+    return 0
+"""
+        ir_module = build_ir_from_code(code)
+        sites = annotate_stack_allocations(ir_module)
+
+        # total() only reads its argument; keep() returns it
+        assert [(site.location.line, capacity) for site, capacity in sites] == [(12, 3), (13, 10)]
+        for site, capacity in sites:
+            assert site.annotations.optimization_hints == ["stack_allocate"]
+            assert site.annotations.intelligence_layer_data["stack_capacity"] == capacity
+
+    def test_ir_passes_hoist_len_fuse_dict_update_and_reduce_index_products(self):
+        """Test LICM, dict update fusion and strength reduction on the Static IR."""
+        from mgen.frontend.ir_passes import IRPassManager
+        from mgen.frontend.static_ir import IRAssignment, IRExpressionStatement, IRFor, IRFunctionCall
+
+        code = """
+def count(text: str, n: int) -> int:
+    counts: dict[str, int] = {}
+    for w in text.split():
+        counts[w] = counts[w] + 1
+    total: int = 0
+    for i in range(len(text)):
+        total = total + i * n
+    return total
+"""
+        ir_module = build_ir_from_code(code)
+        counts = IRPassManager.default().run(ir_module)
+        assert counts == {"licm": 3, "cse": 1, "strength_reduction": 1}
+
+        body = ir_module.functions[0].body
+        # text.split() once before the loop, its length from the same temporary
+        split, length, words = body[1], body[2], body[3]
+        assert isinstance(split, IRAssignment) and split.value.function_name == "__method_split__"
+        assert isinstance(length, IRAssignment) and length.value.arguments[0].variable is split.target
+        assert isinstance(words, IRFor) and words.end.variable is length.target
+        update = words.body[1]
+        assert isinstance(update, IRExpressionStatement)
+        assert update.expression.function_name == "__update_item__"
+        assert update.expression.arguments[2].left.function_name == "__current_item__"
+
+        # i * n becomes a temporary advanced by n at the top of the loop
+        loop = body[-2]
+        assert isinstance(loop, IRFor) and loop.variable.name == "i"
+        reduced = loop.body[0]
+        assert isinstance(reduced, IRAssignment) and reduced.target.name.startswith("__sr_")
+        assert loop.body[1].value.right.variable is reduced.target
+        assert not any(
+            isinstance(node, IRFunctionCall) and node.function_name == "len" for node in [loop.end, *loop.end.children]
+        )
+
+    def test_ir_passes_keep_calls_a_loop_may_invalidate(self):
+        """Test reads of containers a loop may mutate, directly or through a call, stay in the loop."""
+        from mgen.frontend.ir_passes import IRPassManager
+
+        code = """
+def grow(ys: list[int]) -> None:
+    ys.append(0)
+
+def f(xs: list[int], ys: list[int]) -> int:
+    t: int = 0
+    for i in range(len(xs)):
+        ys.append(i)
+        t = t + len(xs)
+    for j in range(3):
+        grow(ys)
+        t = t + len(xs) + xs[0]
+    return t
+"""
+        ir_module = build_ir_from_code(code)
+        counts = IRPassManager.default().run(ir_module)
+
+        # ys may alias xs; list indexing can fail, so it is never moved
+        assert counts == {"licm": 0, "cse": 0, "strength_reduction": 0}
+
+    def test_ir_passes_keep_fresh_lists_a_loop_binds(self):
+        """Test a list-returning call bound to a variable is rebuilt on every iteration."""
+        from mgen.frontend.ir_passes import IRPassManager
+        from mgen.frontend.static_ir import IRAssignment, IRFor
+
+        code = """
+def f(s: str, n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        parts: list[str] = s.split(",")
+        parts.append("x")
+        total = total + len(parts)
+    return total
+"""
+        ir_module = build_ir_from_code(code)
+        counts = IRPassManager.default().run(ir_module)
+
+        # Hoisting would share one list that grows by one item per iteration
+        assert counts["licm"] == 0
+        loop = ir_module.functions[0].body[1]
+        assert isinstance(loop, IRFor)
+        split = loop.body[0]
+        assert isinstance(split, IRAssignment) and split.value.function_name == "__method_split__"
+
+    def test_match_dict_update_recognizes_counting_idioms(self):
+        """Test both counting idioms match and updates with side effects or other keys do not."""
+        from mgen.frontend.dict_updates import match_dict_update
+
+        def match(code: str):
+            return match_dict_update(ast.parse(code).body[0])
+
+        update = match("d[w] = d.get(w, 0) + 1")
+        assert update.container == "d" and ast.unparse(update.key) == "w" and update.default_is_zero
+
+        update = match("if w in d:\n    d[w] += n\nelse:\n    d[w] = n")
+        assert ast.unparse(update.increment) == "n" and update.default_is_zero
+
+        # The absent branch sets 3, so the entry starts at 3 - 1
+        update = match("if w in d:\n    d[w] = 1 + d[w]\nelse:\n    d[w] = 3")
+        assert update.default.value == 2
+
+        assert match("d[w] = d.get(w, 0) + f()") is None
+        assert match("d[w] = d.get(v, 0) + 1") is None
+        assert match("d[w] = d.get(w, 0) + d[v]") is None
+        assert match("if w in d:\n    d[w] = d[w] + 1\nelse:\n    d[v] = 1") is None
+
 
 class TestFrontendIntegration:
     """Integration tests for frontend components."""
@@ -486,6 +941,37 @@ def max_value(x: int, y: int) -> int:
         # Should have path analysis information
         assert report.metadata is not None
 
+    def test_value_range_analyzer_bounds_locals_and_list_elements(self):
+        """Test ranges through loops, % and appends, and widening of accumulators and escaping lists."""
+        from mgen.frontend.analyzers.symbolic_executor import ValueRange, ValueRangeAnalyzer
+
+        code = """
+def f(n: int, xs: list[int]) -> int:
+    digits: list[int] = []
+    for i in range(n):
+        digits.append(i % 10)
+    offsets: list[int] = [-5, 3]
+    for j in range(10, 0, -1):
+        offsets.append(j * -20)
+    total: int = 0
+    for d in digits:
+        total += d
+    shared: list[int] = [1, 2]
+    xs = shared
+    return total
+"""
+        ranges = ValueRangeAnalyzer().analyze_function(ast.parse(code).body[0])
+
+        assert ranges.variables["i"] == ValueRange(0, None)
+        assert ranges.variables["j"] == ValueRange(1, 10)
+        assert ranges.variables["d"] == ValueRange(0, 9)
+        assert ranges.variables["total"] == ValueRange(0, None)
+        assert ranges.elements["digits"].narrowest_integer_width() == (8, False)
+        assert ranges.elements["offsets"] == ValueRange(-200, 3)
+        assert ranges.elements["offsets"].narrowest_integer_width() == (16, True)
+        # Aliased by a parameter, so anything may be stored into it
+        assert ranges.elements["shared"].narrowest_integer_width() is None
+
     def test_bounds_checker_basic(self):
         """Test BoundsChecker on simple code."""
         code = """
@@ -540,6 +1026,122 @@ def main(value: int) -> int:
         # Should have detected function calls
         assert report.metadata is not None
 
+    def test_call_graph_strongly_connected_components(self):
+        """Test mutually recursive functions share a component, callees first."""
+        from mgen.frontend.analyzers.call_graph import strongly_connected_components
+
+        graph = {
+            "main": {"is_even", "print"},
+            "is_even": {"is_odd"},
+            "is_odd": {"is_even", "base"},
+            "base": set(),
+        }
+        components = strongly_connected_components(graph)
+
+        assert [sorted(component) for component in components] == [["base"], ["is_even", "is_odd"], ["main"]]
+
+    def test_class_hierarchy_leaves_and_getters(self):
+        """Test only getters of classes without subclasses are inlinable."""
+        from mgen.frontend.analyzers.call_graph import class_hierarchy
+
+        module = ast.parse(
+            """
+class Shape:
+    def __init__(self) -> None:
+        self.sides: int = 0
+
+    def count(self) -> int:
+        return self.sides
+
+
+class Square(Shape):
+    def area(self) -> int:
+        return self.sides * 2
+
+
+class Tile(Square):
+    def count(self) -> int:
+        return 4
+"""
+        )
+        hierarchy = class_hierarchy(module)
+
+        assert hierarchy.subclasses["Shape"] == {"Square", "Tile"}
+        assert not hierarchy.is_leaf("Shape") and hierarchy.is_leaf("Tile")
+        assert hierarchy.inlinable_getter("Shape", "count") is None
+        assert hierarchy.inlinable_getter("Square", "area") is None
+        assert not hierarchy.is_leaf("Unknown")
+
+    def test_memoized_functions_follow_cache_decorators(self):
+        """Test pure self-recursive int functions are memoized, @cache forces it and maxsize=0 suppresses it."""
+        from mgen.frontend.optimizers.loop_analyzer import memoized_functions
+
+        module = ast.parse(
+            """
+def fib(n: int) -> int:
+    return n if n <= 1 else fib(n - 1) + fib(n - 2)
+
+
+@cache
+def square(n: int) -> int:
+    return n * n
+
+
+@lru_cache(maxsize=0)
+def steps(n: int) -> int:
+    return 0 if n == 0 else steps(n - 1) + 1
+
+
+def halve(x: float) -> float:
+    return x if x < 1.0 else halve(x / 2.0)
+
+
+def log(n: int) -> int:
+    print(n)
+    return n if n == 0 else log(n - 1)
+"""
+        )
+
+        assert memoized_functions(module, automatic=True) == {"fib", "square"}
+        assert memoized_functions(module, automatic=False) == {"square"}
+
+    def test_memoized_functions_skip_readers_of_mutable_globals(self):
+        """Test a function reading a module variable that changes is not pure; constants and locals are fine."""
+        from mgen.frontend.optimizers.loop_analyzer import memoized_functions, pure_functions
+
+        module = ast.parse(
+            """
+LIMIT: int = 10
+offset: int = 0
+weights: list[int] = [1, 2, 3]
+
+
+def shifted(n: int) -> int:
+    return n + offset if n <= 0 else shifted(n - 1)
+
+
+def weighted(n: int) -> int:
+    return weights[0] * n if n <= 0 else weighted(n - 1)
+
+
+def capped(n: int) -> int:
+    return min(n, LIMIT) if n <= 0 else capped(n - 1)
+
+
+def shadowed(n: int) -> int:
+    offset: int = 1
+    return n + offset if n <= 0 else shadowed(n - 1)
+
+
+def bump() -> None:
+    global offset
+    offset += 1
+"""
+        )
+
+        assert pure_functions(module) == {"capped", "shadowed"}
+        assert memoized_functions(module, automatic=True) == {"capped", "shadowed"}
+
     def test_vectorization_detector_basic(self):
         """Test VectorizationDetector on loop code."""
         code = """
@@ -568,6 +1170,115 @@ def sum_array(arr: list[int]) -> int:
         assert report.success
         assert report.execution_time_ms >= 0
 
+    def test_function_specializer_clones_for_constants_and_types(self):
+        """Test FunctionSpecializer folds repeated literal arguments and monomorphizes generic helpers."""
+        import ast
+
+        code = """
+def scale(x: int, k: int) -> int:
+    if k == 1:
+        return x
+    return x * k
+
+def add(a, b):
+    return a + b
+
+def main() -> int:
+    y: float = 1.5
+    print(scale(3, 2) + scale(4, 2) + scale(5, 7))
+    print(add(1, 2))
+    print(add(y, 2.0))
+    return 0
+"""
+        context = AnalysisContext(source_code=code, ast_node=ast.parse(code), analysis_result=None)
+        result = FunctionSpecializer().optimize(context)
+        assert result.success
+        module = result.optimized_ast
+        functions = {node.name: node for node in module.body if isinstance(node, ast.FunctionDef)}
+
+        # The folded k == 1 branch is gone; add() itself has no types and no calls left
+        assert ast.unparse(functions["scale_const_k_2"]) == "def scale_const_k_2(x: int) -> int:\n    return x * 2"
+        assert ast.unparse(functions["add_typed_float_float"].args) == "a: float, b: float"
+        assert ast.unparse(functions["add_typed_int_int"].returns) == "int"
+        assert list(functions) == ["scale", "scale_const_k_2", "add_typed_int_int", "add_typed_float_float", "main"]
+        main_source = ast.unparse(functions["main"])
+        assert "scale_const_k_2(3) + scale_const_k_2(4) + scale(5, 7)" in main_source
+        assert "add_typed_int_int(1, 2)" in main_source and "add_typed_float_float(y, 2.0)" in main_source
+
+    def test_loop_nest_optimizer_interchanges_column_reductions(self):
+        """Test LoopNestOptimizer makes a matrix product walk rows innermost without changing its result."""
+        code = """
+def create_matrix(rows: int, cols: int, value: float) -> list[list[float]]:
+    matrix: list[list[float]] = []
+    for i in range(rows):
+        row: list[float] = []
+        for j in range(cols):
+            row.append(value + (i * 7 + j) % 5 * 0.1)
+        matrix.append(row)
+    return matrix
+
+def multiply(a: list[list[float]], b: list[list[float]], n: int) -> list[list[float]]:
+    result: list[list[float]] = create_matrix(n, n, 0.0)
+    for i in range(n):
+        for j in range(n):
+            total: float = 0.0
+            for k in range(len(b)):
+                total += a[i][k] * b[k][j]
+            result[i][j] = total
+    return result
+"""
+        context = AnalysisContext(source_code=code, ast_node=ast.parse(code), analysis_result=None)
+        result = LoopNestOptimizer().optimize(context)
+        assert result.success
+        assert result.metadata["interchanged"] == 1
+        functions = {node.name: node for node in result.optimized_ast.body if isinstance(node, ast.FunctionDef)}
+        assert "\n".join(ast.unparse(statement) for statement in functions["multiply"].body[1].body) == (
+            "for j in range(n):\n"
+            "    result[i][j] = 0.0\n"
+            "for k in range(len(b)):\n"
+            "    for j in range(n):\n"
+            "        result[i][j] = result[i][j] + a[i][k] * b[k][j]"
+        )
+
+        # Every element adds its terms in the same order: the floats match exactly
+        original: dict = {}
+        interchanged: dict = {}
+        exec(code, original)
+        exec(ast.unparse(result.optimized_ast), interchanged)
+        a = original["create_matrix"](6, 6, 1.5)
+        b = original["create_matrix"](6, 6, -0.25)
+        assert interchanged["multiply"](a, b, 6) == original["multiply"](a, b, 6)
+
+    def test_loop_nest_optimizer_leaves_unsafe_nests(self):
+        """Test LoopNestOptimizer skips nests whose interchange could change what they compute."""
+        nest = """
+    for i in range(n):
+        for j in range(n):
+            s: int = 0
+            for k in range(n):
+                s += {term}
+            {result}[i][j] = s
+"""
+        cases = {
+            # The result matrix may be one of the inputs
+            "def f(a: list[list[int]], r: list[list[int]], n: int) -> None:"
+            + nest.format(term="a[i][k] * r[k][j]", result="r"),
+            # A row of the result escapes into a variable the sum reads
+            "def f(a: list[list[int]], n: int) -> int:\n    r = [[0] * n for _ in range(n)]\n    row = r[0]"
+            + nest.format(term="a[k][j] * row[k]", result="r") + "    return 0",
+            # Division can raise in a different place
+            "def f(a: list[list[int]], n: int) -> list[list[int]]:\n    r = [[0] * n for _ in range(n)]"
+            + nest.format(term="a[k][j] // a[i][k]", result="r") + "    return r",
+            # The inner loop already walks rows
+            "def f(a: list[list[int]], n: int) -> list[list[int]]:\n    r = [[0] * n for _ in range(n)]"
+            + nest.format(term="a[i][k] * a[j][k]", result="r") + "    return r",
+        }
+        for code in cases:
+            context = AnalysisContext(source_code=code, ast_node=ast.parse(code), analysis_result=None)
+            result = LoopNestOptimizer().optimize(context)
+            assert result.success, code
+            assert result.metadata["interchanged"] == 0, code
+
     def test_flow_sensitive_type_inference(self):
         """Test flow-sensitive type inference."""
         code = """
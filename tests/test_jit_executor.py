@@ -1,7 +1,7 @@
 """Tests for LLVM JIT executor.
 
 This module tests the JIT compilation and execution functionality
-of the LLVM backend using llvmlite's execution engine.
+of the LLVM backend using llvmlite's ORC LLJIT.
 """
 
 import subprocess
@@ -158,3 +158,50 @@ def test_jit_missing_function():
 
     finally:
         executor.cleanup()
+
+
+@pytest.mark.skipif(not LLVM_AVAILABLE, reason="llvmlite binding not available")
+def test_jit_object_cache_reused():
+    """Test a second run of unchanged IR loads cached object code."""
+    from mgen.backends.llvm.jit_executor import LLVMJITExecutor
+
+    llvm_ir = """
+    define i64 @main() {
+        ret i64 7
+    }
+    """
+
+    with tempfile.TemporaryDirectory() as cache_dir:
+        first = LLVMJITExecutor(cache_dir=cache_dir)
+        try:
+            first.compile_ir(llvm_ir)
+            assert first.execute_main() == 7
+            assert (first.cache_hits, first.cache_misses) == (0, 1)
+        finally:
+            first.cleanup()
+
+        second = LLVMJITExecutor(cache_dir=cache_dir)
+        try:
+            second.compile_ir(llvm_ir)
+            assert second.execute_main() == 7
+            assert (second.cache_hits, second.cache_misses) == (1, 0)
+        finally:
+            second.cleanup()
+
+        assert len(list(Path(cache_dir).glob("*.o"))) == 1
+
+
+@pytest.mark.skipif(not LLVM_AVAILABLE, reason="llvmlite binding not available")
+def test_jit_cache_key_covers_ir_and_opt_level():
+    """Test changed IR or optimization level never reuses a cached object."""
+    from mgen.backends.llvm.jit_executor import LLVMJITExecutor
+
+    llvm_ir = "define i64 @main() {\n    ret i64 1\n}\n"
+
+    with tempfile.TemporaryDirectory() as cache_dir:
+        o2 = LLVMJITExecutor(opt_level=2, cache_dir=cache_dir)
+        o0 = LLVMJITExecutor(opt_level=0, cache_dir=cache_dir)
+
+        assert o2.cache_key(llvm_ir) == LLVMJITExecutor(opt_level=2, cache_dir=cache_dir).cache_key(llvm_ir)
+        assert o2.cache_key(llvm_ir) != o0.cache_key(llvm_ir)
+        assert o2.cache_key(llvm_ir) != o2.cache_key(llvm_ir.replace("1", "2"))
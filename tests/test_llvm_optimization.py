@@ -259,3 +259,227 @@ class TestLLVMOptimizer:
         assert "add i64" in optimized
         assert "mul i64" in optimized
         assert "ret i64" in optimized
+
+    def test_runtime_bitcode_is_linked_and_inlined(self) -> None:
+        """Test runtime bitcode is linked in, so its accessors inline into loops."""
+        from llvmlite import binding as llvm
+
+        runtime_ir = """
+        define i64 @checked_at(i64 %index, i64 %size) {
+        entry:
+          %ok = icmp ult i64 %index, %size
+          br i1 %ok, label %in_bounds, label %out_of_bounds
+
+        in_bounds:
+          %value = mul i64 %index, 3
+          ret i64 %value
+
+        out_of_bounds:
+          ret i64 -1
+        }
+
+        define i64 @unused_helper(i64 %x) {
+        entry:
+          ret i64 %x
+        }
+        """
+        program_ir = """
+        declare i64 @checked_at(i64, i64)
+
+        define i64 @total(i64 %n) {
+        entry:
+          br label %loop
+
+        loop:
+          %i = phi i64 [ 0, %entry ], [ %i_next, %loop ]
+          %sum = phi i64 [ 0, %entry ], [ %sum_next, %loop ]
+          %item = call i64 @checked_at(i64 %i, i64 %n)
+          %sum_next = add i64 %sum, %item
+          %i_next = add i64 %i, 1
+          %cmp = icmp slt i64 %i_next, %n
+          br i1 %cmp, label %loop, label %exit
+
+        exit:
+          ret i64 %sum_next
+        }
+        """
+        runtime_bitcode = llvm.parse_assembly(runtime_ir).as_bitcode()
+
+        optimizer = LLVMOptimizer(opt_level=2)
+        optimized = optimizer.optimize(program_ir, runtime_bitcode=[runtime_bitcode])
+
+        # The call is inlined and the now-internal runtime definitions are dropped
+        assert "call i64 @checked_at" not in optimized
+        assert "declare i64 @checked_at" not in optimized
+        assert "unused_helper" not in optimized
+        assert "define i64 @total" in optimized
+
+    def test_target_cpu_selection(self) -> None:
+        """Test the generic baseline default, host detection and feature overrides."""
+        from llvmlite import binding as llvm
+
+        generic = LLVMOptimizer(opt_level=2)
+        assert generic.get_optimization_info()["target_cpu"] == "generic"
+        assert generic.cpu_features == ""
+
+        native = LLVMOptimizer(opt_level=2, cpu="native", features="-avx512f")
+        assert native.cpu_name == llvm.get_host_cpu_name()
+        # Explicit overrides come after the host features, so they win
+        assert native.cpu_features.endswith(",-avx512f")
+
+        named = LLVMOptimizer(opt_level=2, cpu="x86-64-v3", features="+fma")
+        assert (named.cpu_name, named.cpu_features) == ("x86-64-v3", "+fma")
+
+    def test_frontend_hints_become_attributes_and_loop_metadata(self) -> None:
+        """Test cold helpers get cold/optsize and small constant loops are fully unrolled."""
+        from mgen.backends.llvm.emitter import LLVMEmitter
+
+        code = """
+def scale(x: int) -> int:
+    return x * 3
+
+def weights() -> int:
+    total: int = 0
+    for i in range(4):
+        total += i * i
+    return total
+
+def main() -> int:
+    s: int = scale(5)
+    for i in range(100):
+        s += weights()
+    return s
+"""
+        llvm_ir = LLVMEmitter().emit_module(code)
+
+        scale_define = next(line for line in llvm_ir.splitlines() if line.startswith("define") and '@"scale"' in line)
+        assert "cold" in scale_define
+        assert "optsize" in scale_define
+        assert "!llvm.loop" in llvm_ir
+        assert '!"llvm.loop.unroll.full"' in llvm_ir
+
+        # The hinted loop folds to sum(i * i for i in range(4))
+        optimized = LLVMOptimizer(opt_level=1).optimize(llvm_ir)
+        weights_body = optimized[optimized.index("@weights(") :]
+        weights_body = weights_body[: weights_body.index("}")]
+        assert "ret i64 14" in weights_body
+
+    def test_independent_loop_gets_vectorize_metadata(self) -> None:
+        """Test loops the vectorization detector proves independent carry llvm.loop.vectorize.enable."""
+        from mgen.backends.llvm.emitter import LLVMEmitter
+
+        code = """
+def dot(xs: list[int], ys: list[int], n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        total += xs[i] * ys[i]
+    return total
+"""
+        llvm_ir = LLVMEmitter().emit_module(code)
+
+        assert '!"llvm.loop.vectorize.enable", i1 true' in llvm_ir
+        LLVMOptimizer(opt_level=2).optimize(llvm_ir)
+
+    def test_fast_math_preference_flags_float_arithmetic(self) -> None:
+        """Test fast_math puts its flags on float operations only, and is off by default."""
+        from mgen.backends.llvm.emitter import LLVMEmitter
+        from mgen.backends.preferences import LLVMPreferences
+
+        code = """
+def fsum(xs: list[float], n: int) -> float:
+    total: float = 0.0
+    for i in range(n):
+        total = total + xs[i] * 2.0
+    return total + float(n + 1)
+"""
+        assert "reassoc" not in LLVMEmitter().emit_module(code)
+
+        preferences = LLVMPreferences()
+        preferences.set("fast_math", "reassoc,contract")
+        llvm_ir = LLVMEmitter(preferences).emit_module(code)
+
+        assert "fadd reassoc contract double" in llvm_ir
+        assert "fmul reassoc contract double" in llvm_ir
+        assert "add reassoc" not in llvm_ir.replace("fadd reassoc", "")
+        LLVMOptimizer(opt_level=2).optimize(llvm_ir)
+
+    def test_source_file_adds_dwarf_line_tables(self) -> None:
+        """Test a source file gives each function a DISubprogram and each statement its Python line."""
+        from mgen.backends.llvm.emitter import LLVMEmitter
+
+        code = """
+def square_sum(n: int) -> int:
+    total: int = 0
+    for i in range(n):
+        total += i * i
+    return total
+"""
+        emitter = LLVMEmitter()
+        emitter.source_file = "/src/mapped.py"
+        llvm_ir = emitter.emit_module(code)
+
+        assert '!DIFile(directory: "/src", filename: "mapped.py")' in llvm_ir
+        assert "emissionKind: LineTablesOnly" in llvm_ir
+        assert 'name: "square_sum"' in llvm_ir
+        assert "line: 5, scope:" in llvm_ir
+        assert '!"Debug Info Version", i32 3' in llvm_ir
+        assert "!dbg" in llvm_ir
+        # The verifier accepts the metadata, and unmapped modules carry none
+        LLVMOptimizer(opt_level=2).optimize(llvm_ir)
+        assert "!dbg" not in LLVMEmitter().emit_module(code)
+
+    def test_non_escaping_list_uses_stack_storage(self) -> None:
+        """Test a fixed-size local list gets an alloca buffer instead of malloc."""
+        from mgen.backends.llvm.emitter import LLVMEmitter
+
+        code = """
+def main() -> int:
+    total: int = 0
+    for n in range(100):
+        xs: list[int] = [n, n + 1, n + 2]
+        xs[0] = xs[2]
+        total += xs[0] + len(xs)
+    return total
+"""
+        llvm_ir = LLVMEmitter().emit_module(code)
+
+        assert "alloca [3 x i64]" in llvm_ir
+        assert "list_malloc" not in llvm_ir
+        LLVMOptimizer(opt_level=2).optimize(llvm_ir)
+
+    def test_linear_recursion_becomes_loop(self) -> None:
+        """Test tail and accumulator recursion jump back to the function start instead of calling."""
+        from mgen.backends.llvm.emitter import LLVMEmitter
+
+        code = """
+def fact(n: int) -> int:
+    if n <= 1:
+        return 1
+    return n * fact(n - 1)
+
+def gcd(a: int, b: int) -> int:
+    if b == 0:
+        return a
+    return gcd(b, a % b)
+
+def fib(n: int) -> int:
+    if n < 2:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+def common(n: int) -> int:
+    return gcd(n, 2 * n)
+
+def main() -> int:
+    return fact(5) + common(18) + fib(10)
+"""
+        llvm_ir = LLVMEmitter().emit_module(code)
+
+        assert llvm_ir.count("tailrecurse") >= 4
+        assert "tail_acc" in llvm_ir
+        assert 'call i64 @"fact"(' not in llvm_ir.split('define i64 @"fact"')[1].split("define")[0]
+        assert 'call i64 @"gcd"(' not in llvm_ir.split('define i64 @"gcd"')[1].split("define")[0]
+        # Tree recursion is not linear and keeps its calls
+        assert 'call i64 @"fib"(' in llvm_ir.split('define i64 @"fib"')[1].split("define")[0]
+        assert 'tail call i64 @"gcd"' in llvm_ir
+        LLVMOptimizer(opt_level=2).optimize(llvm_ir)
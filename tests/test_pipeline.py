@@ -5,7 +5,8 @@ from pathlib import Path
 
 import pytest
 
-from mgen.pipeline import MGenPipeline, PipelineConfig, BuildMode, OptimizationLevel
+from mgen.pipeline import MGenPipeline, PipelineConfig, BuildMode, OptimizationLevel, convert_modules
+from mgen.profiling import PipelineProfiler
 from mgen.backends.registry import registry
 
 
@@ -119,6 +120,50 @@ class TestMGenPipeline:
             # Clean up
             Path(temp_python_file).unlink()
 
+    def test_direct_build_passes_target_options(self):
+        """Test opt level, CPU and features reach builders that take keyword options."""
+        config = PipelineConfig(
+            target_language="c",
+            optimization_level=OptimizationLevel.AGGRESSIVE,
+            build_mode=BuildMode.DIRECT,
+            target_cpu="native",
+            target_features="-avx512f",
+        )
+        pipeline = MGenPipeline(config)
+        received = {}
+
+        def compile_direct(source_file, output_dir, **kwargs):
+            received.update(kwargs)
+            return True
+
+        pipeline.builder.compile_direct = compile_direct
+
+        with tempfile.TemporaryDirectory() as temp_dir:
+            source = Path(temp_dir) / "prog.py"
+            source.write_text("def main() -> int:\n    return 0\n")
+            pipeline.convert(str(source), temp_dir)
+
+        assert received == {"opt_level": 3, "cpu": "native", "features": "-avx512f"}
+
+    def test_direct_build_passes_pgo_options(self):
+        """Test PGO generate/use settings reach the builder as keyword options."""
+        received = []
+
+        def compile_direct(source_file, output_dir, **kwargs):
+            received.append(kwargs)
+            return True
+
+        with tempfile.TemporaryDirectory() as temp_dir:
+            source = Path(temp_dir) / "prog.py"
+            source.write_text("def main() -> int:\n    return 0\n")
+            for pgo in ({"pgo_generate_dir": "/tmp/pgo"}, {"pgo_use_profile": "/tmp/pgo"}):
+                pipeline = MGenPipeline(PipelineConfig(target_language="c", build_mode=BuildMode.DIRECT, **pgo))
+                pipeline.builder.compile_direct = compile_direct
+                pipeline.convert(str(source), temp_dir)
+
+        assert received[0]["pgo_generate"] == "/tmp/pgo" and "pgo_use" not in received[0]
+        assert received[1]["pgo_use"] == "/tmp/pgo" and "pgo_generate" not in received[1]
+
     def test_pipeline_error_handling(self):
         """Test pipeline error handling."""
         pipeline = MGenPipeline(target_language="c")
@@ -129,6 +174,154 @@ class TestMGenPipeline:
         assert len(result.errors) > 0
 
 
+class TestFunctionSpecialization:
+    """Test the specialize_functions option."""
+
+    SOURCE = """def add(a, b):
+    return a + b
+
+
+def main() -> int:
+    print(add(1, 2))
+    return 0
+"""
+
+    def test_typed_clones_are_converted(self):
+        """Test that a generic helper is converted through its typed clone."""
+        with tempfile.TemporaryDirectory() as temp_dir:
+            source = Path(temp_dir) / "module.py"
+            source.write_text(self.SOURCE)
+            config = PipelineConfig(target_language="c", specialize_functions=True)
+            result = MGenPipeline(config).convert(str(source), temp_dir)
+
+        assert result.success, result.errors
+        assert "int add_typed_int_int(int a, int b)" in result.generated_code
+        assert "add_typed_int_int(1, 2)" in result.generated_code
+
+    def test_generic_helper_is_rejected_by_default(self):
+        """Test that without specialization the unannotated helper fails validation."""
+        with tempfile.TemporaryDirectory() as temp_dir:
+            source = Path(temp_dir) / "module.py"
+            source.write_text(self.SOURCE)
+            result = MGenPipeline(PipelineConfig(target_language="c")).convert(str(source), temp_dir)
+
+        assert not result.success
+
+
+class TestLoopInterchange:
+    """Test the interchange_loops option."""
+
+    SOURCE = """def multiply(a: list[list[int]], b: list[list[int]], n: int) -> list[list[int]]:
+    result: list[list[int]] = [[0] * n for _ in range(n)]
+    for i in range(n):
+        for j in range(n):
+            total: int = 0
+            for k in range(n):
+                total += a[i][k] * b[k][j]
+            result[i][j] = total
+    return result
+
+
+def main() -> int:
+    a: list[list[int]] = [[1, 2], [3, 4]]
+    print(multiply(a, a, 2)[1][0])
+    return 0
+"""
+
+    def test_reduction_nest_walks_rows_innermost(self):
+        """Test that the converted nest updates result rows instead of summing b's columns."""
+        with tempfile.TemporaryDirectory() as temp_dir:
+            source = Path(temp_dir) / "module.py"
+            source.write_text(self.SOURCE)
+            baseline = MGenPipeline(PipelineConfig(target_language="c")).convert(str(source), temp_dir)
+            config = PipelineConfig(target_language="c", interchange_loops=True)
+            result = MGenPipeline(config).convert(str(source), temp_dir)
+
+        assert baseline.success and result.success, result.errors
+        assert "total" in baseline.generated_code
+        assert "total" not in result.generated_code
+
+
+class TestPipelineProfiling:
+    """Test per-phase and per-analyzer profiling of pipeline runs."""
+
+    def setup_method(self):
+        """Profile one conversion."""
+        self.profiler = PipelineProfiler()
+        with tempfile.TemporaryDirectory() as temp_dir:
+            source = Path(temp_dir) / "module.py"
+            source.write_text("def add(x: int, y: int) -> int:\n    return x + y\n")
+            config = PipelineConfig(target_language="c", profiler=self.profiler)
+            self.result = MGenPipeline(config).convert(str(source), temp_dir)
+        self.profiler.stop()
+
+    def test_phases_and_analyzers_are_timed(self):
+        """Test that every phase run gets a span, with analyzer spans nested inside."""
+        assert self.result.success, self.result.errors
+        phases = [span.name for span in self.profiler.spans if span.category == "phase"]
+        assert phases == [
+            "validation", "analysis", "python_optimization", "mapping", "target_optimization", "generation"
+        ]
+        names = {span.name for span in self.profiler.spans}
+        assert {"static_analysis", "type_inference", "loop_analysis", "emit_module"} <= names
+        file_span = next(span for span in self.profiler.spans if span.category == "file")
+        for span in self.profiler.spans:
+            assert span.wall_time >= 0 and span.cpu_time >= 0
+            assert span is file_span or span.depth > 0
+        # Children never peak higher than their enclosing phase
+        analysis = next(span for span in self.profiler.spans if span.name == "analysis")
+        static = next(span for span in self.profiler.spans if span.name == "static_analysis")
+        assert 0 < static.peak_memory <= analysis.peak_memory <= file_span.peak_memory
+
+    def test_chrome_trace_format(self):
+        """Test that spans are exported as complete events in start order."""
+        trace = self.profiler.chrome_trace()
+        events = [event for event in trace["traceEvents"] if event["ph"] == "X"]
+        assert len(events) == len(self.profiler.spans)
+        assert events[0]["cat"] == "file"
+        assert [event["ts"] for event in events] == sorted(event["ts"] for event in events)
+        assert all({"cpu_ms", "peak_memory_kb"} <= event["args"].keys() for event in events)
+        assert "validation" in self.profiler.summary_lines()[1]
+
+
+class TestConvertModules:
+    """Test dependency-aware parallel conversion of several modules."""
+
+    def setup_method(self):
+        """Create modules where app imports util and uses_bad imports an invalid module."""
+        self.temp_dir = tempfile.TemporaryDirectory()
+        root = Path(self.temp_dir.name)
+        sources = {
+            "app.py": "from util import double\n\n\ndef main() -> int:\n    return double(2)\n",
+            "util.py": "def double(x: int) -> int:\n    return x * 2\n",
+            "bad.py": "def broken(:\n",
+            "uses_bad.py": "from bad import broken\n\n\ndef main() -> int:\n    return 0\n",
+        }
+        self.paths = []
+        for name, code in sources.items():
+            (root / name).write_text(code)
+            self.paths.append(root / name)
+        self.config = PipelineConfig(target_language="rust", output_dir=str(root / "out"))
+
+    def teardown_method(self):
+        """Remove the modules."""
+        self.temp_dir.cleanup()
+
+    def test_parallel_results_in_input_order(self):
+        """Test that a process pool converts independent modules and keeps input order."""
+        results = convert_modules(self.paths, self.config, jobs=2)
+        assert [Path(result.input_file).name for result in results] == ["app.py", "util.py", "bad.py", "uses_bad.py"]
+        assert results[0].success and results[1].success
+        assert "fn double" in results[1].generated_code
+
+    def test_failed_import_blocks_dependents(self):
+        """Test that a module is not converted when a module it imports failed."""
+        results = convert_modules(self.paths, self.config, jobs=1)
+        assert not results[2].success
+        assert not results[3].success
+        assert "bad" in results[3].errors[0]
+
+
 class TestPipelineIntegration:
     """Integration tests for pipeline functionality."""
 
@@ -218,6 +218,19 @@ after"""
         assert "after" in result
         assert "should not appear" not in result
 
+    def test_inverted_conditional(self):
+        """Test that inverted blocks appear exactly when the flag is false."""
+        template = "{{#T_NEEDS_COPY}}copy{{/T_NEEDS_COPY}}{{^T_NEEDS_COPY}}assign{{/T_NEEDS_COPY}}"
+        assert self.engine.substitute_vec_template(template, "int") == "assign"
+        assert self.engine.substitute_vec_template(template, "str") == "copy"
+
+    def test_specialization_hooks(self):
+        """Test the memcmp, hash check and trivial-relocation hooks per element type."""
+        template = "{{#T_IS_MEMCMP}}M{{/T_IS_MEMCMP}}{{#T_CHECK_HASH}}H{{/T_CHECK_HASH}}{{#T_IS_TRIVIAL}}T{{/T_IS_TRIVIAL}}"
+        assert self.engine.substitute_vec_template(template, "int") == "MT"
+        assert self.engine.substitute_vec_template(template, "double") == "T"
+        assert self.engine.substitute_vec_template(template, "str") == "H"
+
     def test_multiple_same_placeholders(self):
         """Test that same placeholder is substituted consistently."""
         template = "{{T}} func({{T}} a, {{T}} b) { {{T}} c = a + b; return c; }"
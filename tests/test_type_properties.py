@@ -48,6 +48,16 @@ class TestTypeProperties:
         assert props.compare_op == "strcmp"
         assert props.hash_fn == "hash_string"
 
+    def test_i64_properties(self):
+        """Test 64-bit integer type properties (LLVM backend containers)."""
+        props = get_type_properties("i64")
+        assert props.c_type == "long long"
+        assert props.suffix == "i64"
+        assert props.printf_fmt == "%lld"
+        assert props.is_integer is True
+        assert get_type_properties("int").is_integer is True
+        assert get_type_properties("float").is_integer is False
+
     def test_unknown_type_raises(self):
         """Test that unknown type raises ValueError."""
         with pytest.raises(ValueError, match="Unknown type: unknown"):
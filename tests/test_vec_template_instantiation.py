@@ -102,9 +102,9 @@ class TestVecTemplateInstantiation:
         assert "vec_str vec_str_init(void)" in result
         assert "malloc(DEFAULT_CAPACITY * sizeof(char*))" in result
 
-        # Check push function - should use strdup for strings
+        # Check push function - should copy strings
         assert "vec_str_push(vec_str* vec, const char* value)" in result
-        assert "strdup(value)" in result
+        assert "vec_str_dup(value)" in result
         assert "if (value)" in result
         assert "vec->data[vec->size] = NULL;" in result  # NULL handling
 
@@ -130,6 +130,24 @@ class TestVecTemplateInstantiation:
         assert "vec_float_push(vec_float* vec, float value)" in result
         assert "#ifndef MGEN_VEC_float_H" in result
 
+    def test_instantiate_contains_and_equal(self):
+        """Test that contains/equal compare trivial elements in blocks and strings with strcmp."""
+        template = (self.template_dir / "vec_T.c.tmpl").read_text()
+
+        int_result = self.engine.substitute_vec_template(template, "int")
+        assert "bool vec_int_contains(const vec_int* vec, int value)" in int_result
+        assert "found |= data[i + j] == value;" in int_result
+        assert "memcmp(a->data, b->data, a->size * sizeof(int))" in int_result
+        assert "char* vec_int_repr(const vec_int* vec)" in int_result
+
+        double_result = self.engine.substitute_vec_template(template, "double")
+        assert "differ |= a->data[i + j] != b->data[i + j];" in double_result
+
+        str_result = self.engine.substitute_vec_template(template, "str")
+        assert "bool vec_str_contains(const vec_str* vec, const char* value)" in str_result
+        assert "strcmp(vec->data[i], value) == 0" in str_result
+        assert "found |=" not in str_result
+
     def test_vec_T_no_placeholders_remain(self):
         """Test that all placeholders are substituted."""
         template_path = self.template_dir / "vec_T.c.tmpl"
@@ -12,8 +12,9 @@ src_path = project_root / "src"
 if str(src_path) not in sys.path:
     sys.path.insert(0, str(src_path))
 
-from mgen.frontend import AnalysisContext, BoundsProver, CorrectnessProver, TheoremProver
+from mgen.frontend import AnalysisContext, BoundsProver, CorrectnessProver, ProofCache, TheoremProver
 from mgen.frontend.base import AnalysisLevel
+from mgen.frontend.verifiers.theorem_prover import ProofProperty, ProofResult, ProofStatus, PropertyType
 
 # Check if Z3 is available
 try:
@@ -129,6 +130,82 @@ class TestTheoremProver:
         assert prover.z3_available == Z3_AVAILABLE
 
 
+    def test_timed_out_proof_is_not_a_failure(self):
+        """Test that a property the budget ran out on counts as safe but not verified."""
+        prop = ProofProperty("p", PropertyType.BOUNDS_CHECKING, "index in bounds", "mock_formula")
+        result = ProofResult(proof_property=prop, status=ProofStatus.TIMEOUT, proof_time=0.0)
+        assert result.is_safe
+        assert not result.is_verified
+
+    def test_budget_accounting(self):
+        """Test that the budget is reported exhausted once spent and can be reset."""
+        prover = TheoremProver(timeout=100, budget=0.5)
+        assert not prover.budget_exhausted
+        prover.time_spent = 0.5
+        assert prover.budget_exhausted
+        prover.reset_budget()
+        assert not prover.budget_exhausted
+        assert not TheoremProver().budget_exhausted
+
+    @pytest.mark.skipif(not Z3_AVAILABLE, reason="Z3 not available")
+    def test_exhausted_budget_skips_the_solver(self):
+        """Test that properties after the budget is spent come back as TIMEOUT."""
+        prover = TheoremProver(budget=0.0)
+        result = prover.verify_property(prover.create_bounds_check_property("arr", "i", 10))
+        assert result.status == ProofStatus.TIMEOUT
+        assert result.proof_time == 0.0
+
+    @pytest.mark.skipif(not Z3_AVAILABLE, reason="Z3 not available")
+    def test_cached_proof_reused_across_names(self, tmp_path):
+        """Test that a verdict is reused for a formula differing only in constant names."""
+        cache = ProofCache(tmp_path / "proofs.json")
+        x, n = z3.Int("x"), z3.Int("n")
+        first = TheoremProver(cache=cache).verify_property(
+            ProofProperty("a", PropertyType.BOUNDS_CHECKING, "x < n", z3.Implies(x < n, x <= n))
+        )
+        assert first.status == ProofStatus.PROVED
+        cache.save()
+
+        reloaded = ProofCache(tmp_path / "proofs.json")
+        y, m = z3.Int("y"), z3.Int("m")
+        second = TheoremProver(cache=reloaded, budget=0.0).verify_property(
+            ProofProperty("b", PropertyType.BOUNDS_CHECKING, "y < m", z3.Implies(y < m, y <= m))
+        )
+        assert second.status == ProofStatus.PROVED
+        assert reloaded.hits == 1
+
+
+class TestProofCache:
+    """Test the persistent proof result cache."""
+
+    def test_round_trip(self, tmp_path):
+        """Test that stored verdicts survive a save and reload."""
+        cache = ProofCache(tmp_path / "proofs.json")
+        assert cache.get("abc") is None
+        cache.put("abc", "disproved", {"v!0": "-1"})
+        cache.save()
+
+        reloaded = ProofCache(tmp_path / "proofs.json")
+        assert reloaded.get("abc") == {"status": "disproved", "counterexample": {"v!0": "-1"}}
+        assert len(reloaded) == 1
+        assert (cache.misses, reloaded.hits) == (1, 1)
+
+    def test_unreadable_file_starts_empty(self, tmp_path):
+        """Test that a corrupt or foreign cache file is ignored."""
+        path = tmp_path / "proofs.json"
+        path.write_text("{not json")
+        assert len(ProofCache(path)) == 0
+        path.write_text('{"version": 0, "proofs": {"abc": {"status": "proved"}}}')
+        assert ProofCache(path).get("abc") is None
+
+    def test_save_without_changes_writes_nothing(self, tmp_path):
+        """Test that save() leaves the file alone when no verdict was added."""
+        cache = ProofCache(tmp_path / "sub" / "proofs.json")
+        cache.get("abc")
+        cache.save()
+        assert not (tmp_path / "sub").exists()
+
+
 class TestCorrectnessProver:
     """Test the correctness prover for algorithm verification."""
 
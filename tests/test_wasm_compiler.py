@@ -1,5 +1,7 @@
 """Tests for WebAssembly compilation functionality."""
 
+import shutil
+
 import pytest
 from pathlib import Path
 from mgen.backends.llvm.wasm_compiler import (
@@ -176,6 +178,67 @@ recurse:
         # (though this isn't guaranteed for all functions)
         assert all(size > 0 for size in sizes.values())
 
+    def test_simd128_enabled_by_default(self, tmp_path):
+        """Test the default simd128 feature lets the optimizer vectorize with v128 ops."""
+        loop_ir = """
+target triple = "wasm32-unknown-unknown"
+
+define void @add_arrays(i32* noalias %a, i32* noalias %b, i32 %n) {
+entry:
+  %empty = icmp sle i32 %n, 0
+  br i1 %empty, label %exit, label %loop
+loop:
+  %i = phi i32 [0, %entry], [%next, %loop]
+  %pa = getelementptr i32, i32* %a, i32 %i
+  %pb = getelementptr i32, i32* %b, i32 %i
+  %x = load i32, i32* %pa
+  %y = load i32, i32* %pb
+  %sum = add i32 %x, %y
+  store i32 %sum, i32* %pa
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, %n
+  br i1 %done, label %exit, label %loop
+exit:
+  ret void
+}
+"""
+        simd_path = tmp_path / "simd.wat"
+        WebAssemblyCompiler().compile_to_wasm(loop_ir, simd_path, opt_level=2, text_format=True)
+        assert "i32x4.add" in simd_path.read_text()
+
+        mvp_path = tmp_path / "mvp.wat"
+        WebAssemblyCompiler(features="").compile_to_wasm(loop_ir, mvp_path, opt_level=2, text_format=True)
+        assert "v128" not in mvp_path.read_text()
+
+    def test_clang_feature_flags(self):
+        """Test LLVM feature strings map onto clang -m flags for the runtime build."""
+        compiler = WebAssemblyCompiler(features="+simd128,-sign-ext")
+        assert compiler._clang_feature_flags() == ["-msimd128", "-mno-sign-ext"]
+
+    @pytest.mark.skipif(
+        not (shutil.which("clang") and shutil.which("wasm-ld")),
+        reason="clang and wasm-ld required to build the wasm runtime",
+    )
+    def test_build_with_runtime(self, tmp_path):
+        """Test a list- and dict-using program links against the wasm runtime."""
+        from mgen.backends.llvm.emitter import LLVMEmitter
+
+        code = """
+def count(n: int) -> int:
+    values: list[int] = []
+    seen: dict[int, int] = {}
+    for i in range(n):
+        values.append(i * 2)
+        seen[i % 7] = i
+    return len(values) + len(seen)
+"""
+        ir_path = tmp_path / "count.ll"
+        ir_path.write_text(LLVMEmitter().emit_module(code))
+
+        wasm_path = tmp_path / "count.wasm"
+        assert WebAssemblyCompiler().build_with_runtime(ir_path, wasm_path)
+        assert wasm_path.read_bytes()[:4] == b"\0asm"
+
     def test_get_info(self):
         """Test getting WebAssembly compiler information."""
         info = WebAssemblyCompiler.get_info()